@@ -1,7 +1,46 @@
-from flask import Flask, render_template
+import json
+import math
+
+from flask import Flask, Response, jsonify, render_template, request
+
+import config
+from grading import GradingQueue, QueueFull, RateLimited, RateLimiter
+from outcomes import report_outcome
+from summaries import Summaries
 
 app = Flask(__name__, template_folder="../templates")
 
+if config.REDIS_URL:
+    # Submissions are graded by worker nodes (worker.py), and their state is
+    # held in Redis, such that any frontend serves any submission.
+    import redis
+
+    from shared import SharedGradingQueue
+    from summaries import SharedSummaries
+
+    client = redis.Redis.from_url(config.REDIS_URL)
+    grading = SharedGradingQueue(
+        client, config.GRADING_SHARDS, config.GRADING_QUEUE_SIZE
+    )
+    summaries = SharedSummaries(client)
+else:
+    summaries = Summaries()
+
+    def on_result(submission, result):
+        summaries.record(submission, result)
+        report_outcome(
+            submission, result, config.LTI_CONSUMER_KEY, config.LTI_CONSUMER_SECRET
+        )
+
+    grading = GradingQueue(
+        config.RIPES_COMMAND,
+        config.GRADING_WORKERS,
+        config.GRADING_QUEUE_SIZE,
+        on_result,
+    )
+# Submissions are rate limited per frontend.
+rate_limiter = RateLimiter(config.SUBMISSIONS_PER_MINUTE, config.SUBMISSION_BURST)
+
 
 @app.route("/", methods=["GET"])
 def main_page():
@@ -15,4 +54,129 @@ def task(task_id):
 
 @app.route("/user/<user_id>", methods=["GET"])
 def user_summary(user_id):
-    return render_template("summary.html", user_id=user_id)
+    return render_template(
+        "summary.html", user_id=user_id, tasks=sorted_tasks(summaries.user(user_id))
+    )
+
+
+@app.route("/gradebook", methods=["GET"])
+def gradebook():
+    users = sorted(summaries.gradebook().items())
+    return render_template(
+        "gradebook.html",
+        users=[(user_id, sorted_tasks(tasks)) for user_id, tasks in users],
+    )
+
+
+def sorted_tasks(tasks):
+    """Returns the (task, summary) pairs of `tasks` in order of the tasks."""
+    return sorted(tasks.items(), key=lambda item: [int(n) for n in item[0].split(".")])
+
+
+@app.route("/api/users/<user_id>/summary", methods=["GET"])
+def user_summary_api(user_id):
+    return jsonify(summaries.user(user_id))
+
+
+@app.route("/api/gradebook", methods=["GET"])
+def gradebook_api():
+    return jsonify(summaries.gradebook())
+
+
+def error(status, message, retry_after=None):
+    response = jsonify({"status": "rejected", "error": message})
+    response.status_code = status
+    if retry_after is not None:
+        response.headers["Retry-After"] = str(max(1, math.ceil(retry_after)))
+    return response
+
+
+@app.route("/api/submissions", methods=["POST"])
+def submit():
+    """Enqueues a submission for grading. Takes a JSON object or form with the
+    fields user_id, task ("<section>.<number>"), program and optionally
+    processor, lis_outcome_service_url and lis_result_sourcedid."""
+    fields = request.get_json(silent=True) or request.form
+    user_id = fields.get("user_id")
+    program = fields.get("program")
+    try:
+        section, number = (int(v) for v in fields.get("task", "").split("."))
+    except ValueError:
+        return error(400, "Expected a task of the form <section>.<number>")
+    if not user_id or not program:
+        return error(400, "Expected a user_id and a program")
+
+    try:
+        rate_limiter.acquire(user_id)
+    except RateLimited as e:
+        return error(429, "Too many submissions", e.retry_after)
+
+    submission = {
+        "user_id": user_id,
+        "task": {"section": section, "number": number},
+        "program": program,
+    }
+    for key in ("processor", "lis_outcome_service_url", "lis_result_sourcedid"):
+        if fields.get(key):
+            submission[key] = fields.get(key)
+    try:
+        submission_id = grading.submit(submission)
+    except QueueFull:
+        # Clients are asked to retry once a share of the queue has drained.
+        return error(503, "Grading queue is full", 5)
+    response = jsonify(
+        {"id": submission_id, "status": "queued", "pending": grading.pending()}
+    )
+    response.status_code = 202
+    response.headers["Location"] = f"/api/submissions/{submission_id}"
+    return response
+
+
+@app.route("/api/submissions/<submission_id>", methods=["GET"])
+def submission_status(submission_id):
+    status = grading.status(submission_id)
+    if status is None:
+        return error(404, "Unknown submission")
+    return jsonify(status)
+
+
+def event(name, data):
+    return f"event: {name}\ndata: {json.dumps(data)}\n\n"
+
+
+@app.route("/api/submissions/<submission_id>/events", methods=["GET"])
+def submission_events(submission_id):
+    """Streams the grading of a submission as Server-Sent Events, instead of
+    polling its status: a "status" event per change of its status, a "test"
+    event with the answer of each test as it completes, and a final "graded"
+    event with the status and result of the submission, after which the
+    stream ends."""
+    if grading.status(submission_id) is None:
+        return error(404, "Unknown submission")
+
+    def events():
+        version, status, tests = 0, None, 0
+        while True:
+            update = grading.wait(submission_id, version, config.EVENT_KEEPALIVE)
+            if update is None:
+                # The result expired.
+                return
+            if update[0] == version:
+                yield ": keepalive\n\n"
+                continue
+            version, current = update
+            for test in current["progress"][tests:]:
+                yield event("test", dict(test, id=submission_id))
+            tests = len(current["progress"])
+            if current["status"] == "graded":
+                yield event("graded", current)
+                return
+            if current["status"] != status:
+                status = current["status"]
+                yield event("status", {"id": submission_id, "status": status})
+
+    response = Response(events(), mimetype="text/event-stream")
+    response.headers["Cache-Control"] = "no-cache"
+    # Events are not to be buffered by a reverse proxy.
+    response.headers["X-Accel-Buffering"] = "no"
+    return response
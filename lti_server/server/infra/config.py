@@ -0,0 +1,35 @@
+"""Configuration of the web frontend (app.py) and of the grading workers
+(worker.py), through the environment."""
+
+import os
+import shlex
+
+RIPES_COMMAND = shlex.split(os.environ.get("RIPES_COMMAND", "Ripes"))
+RIPES_COMMAND += ["--mode", "cli", "--server"]
+if "RIPES_TASKS" in os.environ:
+    RIPES_COMMAND += ["--tasks", os.environ["RIPES_TASKS"]]
+if "RIPES_TASK_CACHE" in os.environ:
+    RIPES_COMMAND += ["--taskcache", os.environ["RIPES_TASK_CACHE"]]
+GRADING_WORKERS = int(os.environ.get("GRADING_WORKERS", os.cpu_count() or 1))
+GRADING_QUEUE_SIZE = int(os.environ.get("GRADING_QUEUE_SIZE", 256))
+SUBMISSIONS_PER_MINUTE = float(os.environ.get("SUBMISSIONS_PER_MINUTE", 6))
+SUBMISSION_BURST = int(os.environ.get("SUBMISSION_BURST", 3))
+# Seconds between comments keeping idle event streams open through proxies.
+EVENT_KEEPALIVE = float(os.environ.get("EVENT_KEEPALIVE", 15))
+LTI_CONSUMER_KEY = os.environ.get("LTI_CONSUMER_KEY")
+LTI_CONSUMER_SECRET = os.environ.get("LTI_CONSUMER_SECRET")
+
+# With a Redis URL, submissions are graded by worker.py processes through a
+# queue and result store in Redis (see shared.py); otherwise by the worker
+# threads of the web frontend.
+REDIS_URL = os.environ.get("REDIS_URL")
+# Number of queues over which the tasks are sharded. Must be equal for every
+# frontend and worker.
+GRADING_SHARDS = int(os.environ.get("GRADING_SHARDS", 8))
+# Shards pulled by a worker, as comma-separated indices; by default all.
+WORKER_SHARDS = [
+    int(shard)
+    for shard in os.environ.get(
+        "WORKER_SHARDS", ",".join(map(str, range(GRADING_SHARDS)))
+    ).split(",")
+]
@@ -0,0 +1,254 @@
+"""Grading of submissions by a pool of long-lived Ripes processes.
+
+Submissions are put on a bounded queue, from which a fixed number of worker
+threads take them. Each worker owns a Ripes process running the CLI server mode
+(``--mode cli --server``), such that Ripes is started once per worker rather
+than once per submission, and writes one grading request per submission to it.
+A full queue rejects new submissions instead of growing without bound, such
+that a deadline spike degrades to clients retrying rather than to a backlog
+which is never worked off.
+"""
+
+import itertools
+import json
+import logging
+import queue
+import subprocess
+import threading
+import time
+
+
+class QueueFull(Exception):
+    """Raised when a submission is rejected because the queue is full."""
+
+
+class RateLimited(Exception):
+    """Raised when a user submits faster than the rate limit allows."""
+
+    def __init__(self, retry_after):
+        super().__init__(retry_after)
+        self.retry_after = retry_after
+
+
+class RateLimiter:
+    """Token bucket per user: each user may submit `burst` submissions at
+    once, and regains one submission every `60 / per_minute` seconds.
+
+    A full bucket is the same as no bucket, such that the buckets of users
+    which have been idle for `idle_seconds` after their bucket filled up are
+    dropped, rather than kept for every user which ever submitted."""
+
+    def __init__(self, per_minute, burst, idle_seconds=600):
+        self._rate = per_minute / 60.0
+        self._burst = burst
+        self._idle_seconds = idle_seconds
+        self._buckets = {}
+        self._last_sweep = 0.0
+        self._lock = threading.Lock()
+
+    def __len__(self):
+        with self._lock:
+            return len(self._buckets)
+
+    def _full_since(self, tokens, last):
+        return last + (self._burst - tokens) / self._rate
+
+    def _sweep(self, now):
+        # Sweeps at most once per idle period, such that acquiring a token
+        # stays constant time on average.
+        if now - self._last_sweep < self._idle_seconds:
+            return
+        self._last_sweep = now
+        self._buckets = {
+            user_id: (tokens, last)
+            for user_id, (tokens, last) in self._buckets.items()
+            if now - self._full_since(tokens, last) < self._idle_seconds
+        }
+
+    def acquire(self, user_id, now=None):
+        if now is None:
+            now = time.monotonic()
+        with self._lock:
+            self._sweep(now)
+            tokens, last = self._buckets.get(user_id, (self._burst, now))
+            tokens = min(self._burst, tokens + (now - last) * self._rate)
+            if tokens < 1:
+                raise RateLimited((1 - tokens) / self._rate)
+            self._buckets[user_id] = (tokens - 1, now)
+
+
+class RipesWorker:
+    """A Ripes process in server mode. Requests are answered in order, one
+    line of JSON per request."""
+
+    def __init__(self, command):
+        self._command = command
+        self._process = None
+
+    def grade(self, request, on_progress=None):
+        """Grades `request`. Progress lines written ahead of the response are
+        passed to `on_progress(progress)`, if given."""
+        # A Ripes process which died (e.g. crashed on a submission) is
+        # restarted for the next request.
+        if self._process is None or self._process.poll() is not None:
+            self._process = subprocess.Popen(
+                self._command,
+                stdin=subprocess.PIPE,
+                stdout=subprocess.PIPE,
+                text=True,
+                bufsize=1,
+            )
+        try:
+            self._process.stdin.write(json.dumps(request) + "\n")
+            self._process.stdin.flush()
+            while True:
+                line = self._process.stdout.readline()
+                if not line:
+                    break
+                response = json.loads(line)
+                if response.get("status") != "progress":
+                    return response
+                if on_progress:
+                    on_progress(response)
+        except (BrokenPipeError, OSError):
+            pass
+        self._process.kill()
+        self._process = None
+        return {"status": "failed", "errors": ["Grading worker exited"]}
+
+
+def new_submission(submission, submission_id):
+    """Returns the state of `submission`, a dict with the fields of a Ripes
+    grading request and optional LTI outcome fields, once enqueued as
+    `submission_id`. Each change of the state increments its version."""
+    return dict(submission, id=submission_id, status="queued", progress=[], version=1)
+
+
+def submission_status(submission):
+    """Returns the status of a submission as served to clients."""
+    status = {
+        key: submission[key] for key in ("id", "status", "result") if key in submission
+    }
+    status["progress"] = list(submission["progress"])
+    return status
+
+
+def grade_submission(worker, submission, update, on_result):
+    """Grades `submission` with the RipesWorker `worker`. Its status, the
+    answer of each test as the test completes, and its result are recorded
+    by `update(submission, **fields)`, after which the result is passed to
+    `on_result(submission, result)`."""
+    update(submission, status="grading")
+    request = {
+        key: submission[key]
+        for key in ("id", "task", "program", "processor", "extensions")
+        if key in submission
+    }
+    request["progress"] = True
+
+    def progress(response):
+        test = {key: response.get(key) for key in ("test", "tests", "answer")}
+        # Progress is only recorded by the worker grading the submission.
+        update(submission, progress=submission["progress"] + [test])
+
+    result = worker.grade(request, progress)
+    update(submission, status="graded", result=result)
+    try:
+        on_result(submission, result)
+    except Exception:
+        # A failure to report a result must not stop the worker.
+        logging.exception("Failed to report submission %s", submission["id"])
+
+
+class GradingQueue:
+    """Bounded queue of submissions, consumed by `workers` Ripes processes.
+    Results are passed to `on_result(submission, result)` from the worker
+    threads, and are kept for polling until `result_ttl` seconds after
+    grading. The answer of each test is recorded as the test completes, and
+    each change of a submission increments its version, for which `wait`
+    blocks."""
+
+    def __init__(self, command, workers, capacity, on_result, result_ttl=3600):
+        self._queue = queue.Queue(maxsize=capacity)
+        self._on_result = on_result
+        self._result_ttl = result_ttl
+        self._ids = itertools.count(1)
+        self._submissions = {}
+        self._lock = threading.Lock()
+        self._changed = threading.Condition(self._lock)
+        for _ in range(workers):
+            threading.Thread(
+                target=self._work, args=(RipesWorker(command),), daemon=True
+            ).start()
+
+    def submit(self, submission):
+        """Enqueues `submission`, a dict with the fields of a Ripes grading
+        request and optional LTI outcome fields. Returns its id."""
+        submission_id = str(next(self._ids))
+        submission = new_submission(submission, submission_id)
+        with self._lock:
+            self._expire()
+            self._submissions[submission_id] = submission
+        try:
+            self._queue.put_nowait(submission)
+        except queue.Full:
+            with self._lock:
+                del self._submissions[submission_id]
+            raise QueueFull()
+        return submission_id
+
+    def status(self, submission_id):
+        with self._lock:
+            return self._status(submission_id)
+
+    def wait(self, submission_id, version, timeout):
+        """Waits up to `timeout` seconds for the submission to change after
+        `version` (0 for any version). Returns the version and status of the
+        submission, or None if it is unknown."""
+        with self._changed:
+            self._changed.wait_for(
+                lambda: self._version(submission_id) != version, timeout
+            )
+            status = self._status(submission_id)
+            if status is None:
+                return None
+            return self._version(submission_id), status
+
+    def _version(self, submission_id):
+        submission = self._submissions.get(submission_id)
+        return submission["version"] if submission else None
+
+    def _status(self, submission_id):
+        submission = self._submissions.get(submission_id)
+        return submission_status(submission) if submission else None
+
+    def _update(self, submission, **fields):
+        with self._changed:
+            submission.update(fields)
+            submission["version"] += 1
+            if submission["status"] == "graded":
+                submission["graded"] = time.monotonic()
+            self._changed.notify_all()
+
+    def pending(self):
+        return self._queue.qsize()
+
+    def _expire(self):
+        now = time.monotonic()
+        expired = [
+            key
+            for key, submission in self._submissions.items()
+            if now - submission.get("graded", now) > self._result_ttl
+        ]
+        for key in expired:
+            del self._submissions[key]
+        if expired:
+            self._changed.notify_all()
+
+    def _work(self, worker):
+        while True:
+            submission = self._queue.get()
+            try:
+                grade_submission(worker, submission, self._update, self._on_result)
+            finally:
+                self._queue.task_done()
@@ -0,0 +1,164 @@
+"""Grading through a queue and result store shared in Redis, such that web
+frontends and grading workers scale independently across machines.
+
+Frontends (app.py with REDIS_URL set) enqueue each submission on the queue
+of the shard of its task, and serve the status of submissions from the
+store. Workers (worker.py) run Ripes processes pulling submissions from the
+queues of the shards they serve, such that the submissions of a task are
+graded by the same workers, whose Ripes processes have its catalogue and
+processors warm, and write the state of each submission to the store as it
+is graded. Neither holds state of its own: any frontend serves any
+submission, and grading capacity is added by starting more workers.
+
+Keys:
+- ripes:ids: counter of the submission ids.
+- ripes:queue:<shard>: list of the JSON submissions to grade.
+- ripes:submission:<id>: JSON state of a submission, which expires
+  `result_ttl` seconds after grading.
+- ripes:changed:<id>: channel on which each change of a submission is
+  published.
+"""
+
+import json
+import threading
+import time
+import zlib
+
+from grading import (
+    QueueFull,
+    RipesWorker,
+    grade_submission,
+    new_submission,
+    submission_status,
+)
+
+# Submissions which are not graded within a day are dropped, e.g. those of a
+# worker which died while grading them.
+QUEUED_TTL = 24 * 3600
+
+
+def shard_of(task, shards):
+    """Returns the shard of `task`, {"section", "number"}, out of `shards`.
+    Unlike hash(), shards are equal across processes."""
+    return zlib.crc32(f"{task['section']}.{task['number']}".encode()) % shards
+
+
+def _queue_key(shard):
+    return f"ripes:queue:{shard}"
+
+
+def _submission_key(submission_id):
+    return f"ripes:submission:{submission_id}"
+
+
+def _channel(submission_id):
+    return f"ripes:changed:{submission_id}"
+
+
+class SharedStore:
+    """State of the submissions, in Redis."""
+
+    def __init__(self, client, result_ttl):
+        self._client = client
+        self._result_ttl = result_ttl
+
+    def load(self, submission_id):
+        data = self._client.get(_submission_key(submission_id))
+        return json.loads(data) if data is not None else None
+
+    def save(self, submission):
+        ttl = self._result_ttl if submission["status"] == "graded" else QUEUED_TTL
+        self._client.set(
+            _submission_key(submission["id"]), json.dumps(submission), ex=ttl
+        )
+        self._client.publish(_channel(submission["id"]), submission["version"])
+
+
+class SharedGradingQueue:
+    """Frontend of the shared queue, with the interface of GradingQueue.
+    Submissions are rejected once `capacity` submissions are pending over
+    all shards."""
+
+    def __init__(self, client, shards, capacity, result_ttl=3600):
+        self._client = client
+        self._shards = shards
+        self._capacity = capacity
+        self._store = SharedStore(client, result_ttl)
+
+    def submit(self, submission):
+        """Enqueues `submission`, a dict with the fields of a Ripes grading
+        request and optional LTI outcome fields. Returns its id."""
+        # Concurrent submissions may overshoot the capacity by the number of
+        # frontends, which bounds the queue all the same.
+        if self.pending() >= self._capacity:
+            raise QueueFull()
+        submission_id = str(self._client.incr("ripes:ids"))
+        submission = new_submission(submission, submission_id)
+        self._store.save(submission)
+        shard = shard_of(submission["task"], self._shards)
+        self._client.rpush(_queue_key(shard), json.dumps(submission))
+        return submission_id
+
+    def status(self, submission_id):
+        submission = self._store.load(submission_id)
+        return submission_status(submission) if submission else None
+
+    def wait(self, submission_id, version, timeout):
+        """Waits up to `timeout` seconds for the submission to change after
+        `version` (0 for any version). Returns the version and status of the
+        submission, or None if it is unknown."""
+        # Subscribing ahead of loading the submission, no change is missed.
+        pubsub = self._client.pubsub(ignore_subscribe_messages=True)
+        pubsub.subscribe(_channel(submission_id))
+        try:
+            deadline = time.monotonic() + timeout
+            while True:
+                submission = self._store.load(submission_id)
+                if submission is None:
+                    return None
+                remaining = deadline - time.monotonic()
+                if submission["version"] != version or remaining <= 0:
+                    return submission["version"], submission_status(submission)
+                pubsub.get_message(timeout=remaining)
+        finally:
+            pubsub.close()
+
+    def pending(self):
+        pipeline = self._client.pipeline()
+        for shard in range(self._shards):
+            pipeline.llen(_queue_key(shard))
+        return sum(pipeline.execute())
+
+
+class SharedGradingWorkers:
+    """`workers` Ripes processes grading the submissions of the queues of
+    `shards`, in order of preference. Results are passed to
+    `on_result(submission, result)` from the worker threads."""
+
+    def __init__(self, client, command, shards, workers, on_result, result_ttl=3600):
+        self._client = client
+        self._keys = [_queue_key(shard) for shard in shards]
+        self._on_result = on_result
+        self._store = SharedStore(client, result_ttl)
+        self._threads = [
+            threading.Thread(target=self._work, args=(RipesWorker(command),))
+            for _ in range(workers)
+        ]
+        for thread in self._threads:
+            thread.start()
+
+    def join(self):
+        for thread in self._threads:
+            thread.join()
+
+    def _update(self, submission, **fields):
+        submission.update(fields)
+        submission["version"] += 1
+        self._store.save(submission)
+
+    def _work(self, worker):
+        while True:
+            # BLPOP pops from the first non-empty queue of the keys.
+            _, data = self._client.blpop(self._keys)
+            submission = json.loads(data)
+            grade_submission(worker, submission, self._update, self._on_result)
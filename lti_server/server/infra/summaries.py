@@ -0,0 +1,105 @@
+"""Summaries of the graded submissions of each user, per task: the number of
+attempts, the best grade, performance score and cycle count, and the status
+of the latest attempt. Summaries are updated as each result is written,
+such that summary and gradebook pages read them instead of the results of
+every submission."""
+
+import json
+import re
+import threading
+
+# The cycles of each passed test in a report of Ripes.
+PASSED_CYCLES = re.compile(r"^Test \d+: passed, (\d+) cycles", re.MULTILINE)
+
+
+def task_key(task):
+    return f"{task['section']}.{task['number']}"
+
+
+def summarize(entry, submission, result):
+    """Returns the summary of a task, `entry` (None before the first
+    attempt), updated with the `result` of `submission`."""
+    entry = dict(entry or {"attempts": 0})
+    entry["attempts"] += 1
+    entry["latest_submission"] = submission["id"]
+    if result.get("status") != "ok" or not result.get("tests"):
+        entry["latest_status"] = result.get("status", "failed")
+        return entry
+
+    passed = result["passed"] == result["tests"]
+    entry["latest_status"] = "passed" if passed else "failed"
+    entry["best_grade"] = max(
+        entry.get("best_grade", 0.0), result["passed"] / result["tests"]
+    )
+    if "score" in result:
+        entry["best_score"] = max(entry.get("best_score", 0.0), result["score"])
+    if passed:
+        # Cycles are compared for submissions passing every test.
+        cycles = sum(int(c) for c in PASSED_CYCLES.findall(result.get("report", "")))
+        if cycles and cycles < entry.get("best_cycles", cycles + 1):
+            entry["best_cycles"] = cycles
+    return entry
+
+
+class Summaries:
+    """Summaries held in memory, for a frontend grading in-process."""
+
+    def __init__(self):
+        self._users = {}
+        self._lock = threading.Lock()
+
+    def record(self, submission, result):
+        key = task_key(submission["task"])
+        with self._lock:
+            tasks = self._users.setdefault(submission["user_id"], {})
+            tasks[key] = summarize(tasks.get(key), submission, result)
+
+    def user(self, user_id):
+        """Returns the summary of each task attempted by `user_id`."""
+        with self._lock:
+            return dict(self._users.get(user_id, {}))
+
+    def gradebook(self):
+        """Returns the summaries of every user."""
+        with self._lock:
+            return {user_id: dict(tasks) for user_id, tasks in self._users.items()}
+
+
+class SharedSummaries:
+    """Summaries held in Redis, shared by the frontends and grading workers
+    of shared.py: a hash ripes:user:<user_id> of the JSON summary of each
+    task, and the set ripes:users of the users with summaries."""
+
+    def __init__(self, client):
+        self._client = client
+
+    def record(self, submission, result):
+        user_key = f"ripes:user:{submission['user_id']}"
+        key = task_key(submission["task"])
+
+        # Workers grading attempts of the same user concurrently retry on a
+        # conflicting update.
+        def update(pipeline):
+            data = pipeline.hget(user_key, key)
+            entry = summarize(json.loads(data) if data else None, submission, result)
+            pipeline.multi()
+            pipeline.hset(user_key, key, json.dumps(entry))
+            pipeline.sadd("ripes:users", submission["user_id"])
+
+        self._client.transaction(update, user_key)
+
+    def user(self, user_id):
+        """Returns the summary of each task attempted by `user_id`."""
+        tasks = self._client.hgetall(f"ripes:user:{user_id}")
+        return {key.decode(): json.loads(data) for key, data in tasks.items()}
+
+    def gradebook(self):
+        """Returns the summaries of every user."""
+        users = sorted(user.decode() for user in self._client.smembers("ripes:users"))
+        pipeline = self._client.pipeline()
+        for user_id in users:
+            pipeline.hgetall(f"ripes:user:{user_id}")
+        return {
+            user_id: {key.decode(): json.loads(data) for key, data in tasks.items()}
+            for user_id, tasks in zip(users, pipeline.execute())
+        }
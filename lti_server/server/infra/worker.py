@@ -0,0 +1,42 @@
+"""Grading worker node: grades the submissions enqueued by the web frontends
+on the shared queue in Redis (see shared.py), with GRADING_WORKERS Ripes
+processes pulling from the shards of WORKER_SHARDS.
+
+    REDIS_URL=redis://queue:6379 WORKER_SHARDS=0,1,2,3 python worker.py
+"""
+
+import logging
+
+import redis
+
+import config
+from outcomes import report_outcome
+from shared import SharedGradingWorkers
+from summaries import SharedSummaries
+
+if __name__ == "__main__":
+    logging.basicConfig(level=logging.INFO)
+    if not config.REDIS_URL:
+        raise SystemExit("REDIS_URL is not set")
+    logging.info(
+        "Grading shards %s of %d with %d workers",
+        config.WORKER_SHARDS,
+        config.GRADING_SHARDS,
+        config.GRADING_WORKERS,
+    )
+    client = redis.Redis.from_url(config.REDIS_URL)
+    summaries = SharedSummaries(client)
+
+    def on_result(submission, result):
+        summaries.record(submission, result)
+        report_outcome(
+            submission, result, config.LTI_CONSUMER_KEY, config.LTI_CONSUMER_SECRET
+        )
+
+    SharedGradingWorkers(
+        client,
+        config.RIPES_COMMAND,
+        config.WORKER_SHARDS,
+        config.GRADING_WORKERS,
+        on_result,
+    ).join()
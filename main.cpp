@@ -5,10 +5,20 @@
 #include <QResource>
 #include <QTimer>
 #include <iostream>
+#include <memory>
+#include <optional>
 
+#include "src/cli/batchrunner.h"
+#include "src/cli/benchmark.h"
 #include "src/cli/clioptions.h"
 #include "src/cli/clirunner.h"
+#include "src/cli/comparison.h"
+#include "src/cli/designspace.h"
+#include "src/cli/regrader.h"
+#include "src/cli/simulationserver.h"
 #include "src/mainwindow.h"
+#include "src/taskcheck/taskchecker.h"
+#include "src/tracespans.h"
 
 using namespace std;
 
@@ -24,6 +34,20 @@ void initParser(QCommandLineParser &parser, Ripes::CLIModeOptions &options) {
   parser.setApplicationDescription(helpText);
   QCommandLineOption modeOption("mode", "Ripes mode [gui, cli]", "mode", "gui");
   parser.addOption(modeOption);
+  parser.addOption(QCommandLineOption(
+      "tasks", "Path to the JSON task catalogue of the task tab.", "path"));
+  parser.addOption(QCommandLineOption(
+      "taskcache",
+      "Directory in which the reports of graded tasks are cached. Identical "
+      "submissions for the same task, processor and catalogue version are "
+      "graded once.",
+      "path"));
+  parser.addOption(QCommandLineOption(
+      "tracestartup",
+      "Records the phases of starting up and of loading processors and "
+      "programs, and writes them to <path> in the Chrome Trace Event format "
+      "once Ripes exits.",
+      "path"));
   Ripes::addCLIOptions(parser, options);
 }
 
@@ -55,8 +79,30 @@ CommandLineParseResult parseCommandLine(QCommandLineParser &parser,
   }
 }
 
-int guiMode(QApplication &app) {
+/// Returns whether @p argv selects the command line interface, or requests
+/// the help text. Both run without initializing the GUI subsystem, and thus
+/// without a display.
+bool isCLIInvocation(int argc, char **argv) {
+  bool cli = false;
+  for (int i = 1; i < argc; ++i) {
+    const QByteArray arg = argv[i];
+    // As the parser, the last mode which is provided is used.
+    if (arg == "--mode" && i + 1 < argc)
+      cli = QByteArray(argv[++i]) == "cli";
+    else if (arg.startsWith("--mode="))
+      cli = arg == "--mode=cli";
+    else if (arg == "-h" || arg == "-?" || arg == "--help" ||
+             arg == "--help-all")
+      return true;
+  }
+  return cli;
+}
+
+int guiMode() {
+  std::optional<Ripes::TraceSpan> span(std::in_place,
+                                       "MainWindow construction");
   Ripes::MainWindow m;
+  span.reset();
 
 #ifdef Q_OS_WASM
   // In the WASM build, we'll just want a full-screen application that can't be
@@ -72,7 +118,7 @@ int guiMode(QApplication &app) {
   m.setWindowState(Qt::WindowMaximized);
   QTimer::singleShot(100, &m, [&m] { m.fitToView(); });
 
-  return app.exec();
+  return QApplication::exec();
 }
 
 int CLIMode(QCommandLineParser &parser, Ripes::CLIModeOptions &options) {
@@ -82,23 +128,24 @@ int CLIMode(QCommandLineParser &parser, Ripes::CLIModeOptions &options) {
     parser.showHelp();
     return 0;
   }
+  if (options.batch.enabled())
+    return Ripes::BatchRunner(options).run();
+  if (options.server)
+    return Ripes::SimulationServer(options).run();
+  if (options.benchmark)
+    return Ripes::Benchmark(options).run();
+  if (!options.regrade.isEmpty())
+    return Ripes::Regrader(options).run();
+  if (!options.dse.isEmpty())
+    return Ripes::DesignSpaceExplorer(options).run();
+  if (options.compare.enabled())
+    return Ripes::ComparisonRunner(options).run();
   return Ripes::CLIRunner(options).run();
 }
 
-int main(int argc, char **argv) {
-  Q_INIT_RESOURCE(icons);
-  Q_INIT_RESOURCE(examples);
-  Q_INIT_RESOURCE(layouts);
-  Q_INIT_RESOURCE(fonts);
-
-  QApplication app(argc, argv);
-  QCoreApplication::setApplicationName("Ripes");
-
-  QCommandLineParser parser;
-  Ripes::CLIModeOptions options;
-  initParser(parser, options);
-  QString err;
-  switch (parseCommandLine(parser, err)) {
+int run(CommandLineParseResult mode, QCommandLineParser &parser,
+        Ripes::CLIModeOptions &options, const QString &err) {
+  switch (mode) {
   case CommandLineError:
     std::cerr << "ERROR: " << err.toStdString() << std::endl;
     parser.showHelp();
@@ -107,8 +154,49 @@ int main(int argc, char **argv) {
     parser.showHelp();
     return 0;
   case CommandLineGUI:
-    return guiMode(app);
+    return guiMode();
   case CommandLineCLI:
     return CLIMode(parser, options);
   }
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  // The CLI requires neither a display nor the resources of the GUI, such
+  // that it starts quickly and runs in display-less environments.
+  const bool cli = isCLIInvocation(argc, argv);
+  std::unique_ptr<QCoreApplication> app;
+  if (cli) {
+    app = std::make_unique<QCoreApplication>(argc, argv);
+  } else {
+    Q_INIT_RESOURCE(icons);
+    Q_INIT_RESOURCE(examples);
+    Q_INIT_RESOURCE(layouts);
+    Q_INIT_RESOURCE(fonts);
+    app = std::make_unique<QApplication>(argc, argv);
+  }
+  // Tasks are graded by the CLI server mode as well.
+  Q_INIT_RESOURCE(tasks);
+  QCoreApplication::setApplicationName("Ripes");
+
+  QCommandLineParser parser;
+  Ripes::CLIModeOptions options;
+  initParser(parser, options);
+  QString err;
+  const auto mode = parseCommandLine(parser, err);
+  // Tasks are graded both by the task tab and by the CLI server mode.
+  if (parser.isSet("tasks"))
+    TaskChecker::setCataloguePath(parser.value("tasks"));
+  if (parser.isSet("taskcache"))
+    TaskChecker::setResultCacheDirectory(parser.value("taskcache"));
+  const QString tracePath = parser.value("tracestartup");
+  if (!tracePath.isEmpty())
+    Ripes::TraceSpans::enable();
+  const int result = run(mode, parser, options, err);
+  if (!tracePath.isEmpty()) {
+    const QString traceError = Ripes::TraceSpans::write(tracePath);
+    if (!traceError.isEmpty())
+      std::cerr << "ERROR: " << traceError.toStdString() << std::endl;
+  }
+  return result;
 }
@@ -1,4 +1,5 @@
 #include "assembler.h"
+#include "isa/mips32isainfo.h"
 
 namespace Ripes {
 namespace Assembler {
@@ -11,6 +12,9 @@ constructAssemblerDynamic(const std::shared_ptr<const ISAInfoBase> &isa) {
   } else if (auto rv64isa =
                  std::dynamic_pointer_cast<const ISAInfo<ISA::RV64I>>(isa)) {
     return std::make_shared<ISA_Assembler<ISA::RV64I>>(rv64isa);
+  } else if (auto mipsisa =
+                 std::dynamic_pointer_cast<const ISAInfo<ISA::MIPS32I>>(isa)) {
+    return std::make_shared<ISA_Assembler<ISA::MIPS32I>>(mipsisa);
   }
 
   throw std::runtime_error(
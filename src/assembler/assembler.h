@@ -1,9 +1,11 @@
 #pragma once
 
+#include <QHash>
 #include <QRegularExpression>
 
 #include <cstdint>
 #include <numeric>
+#include <optional>
 #include <set>
 #include <variant>
 
@@ -17,6 +19,8 @@
 #include "isa/isainfo.h"
 #include "isa/pseudoinstruction.h"
 #include "matcher.h"
+#include "parallelfor.h"
+#include "programcache.h"
 #include "ripessettings.h"
 
 namespace Ripes {
@@ -32,7 +36,7 @@ namespace Assembler {
     assert(result.errors.size() != 0);                                         \
     return result;                                                             \
   }                                                                            \
-  auto resName = std::get<resType>(passFunction##_res);
+  auto resName = std::get<resType>(std::move(passFunction##_res));
 
 /**
  * A macro for running an assembler operation which may throw an error or return
@@ -73,6 +77,23 @@ public:
            const QString &sourceHash = QString()) const override {
     AssembleResult result;
 
+    QString cacheKey;
+    if (m_programCaching) {
+      cacheKey = ProgramCache::key(programLines, *m_isa, m_sectionBasePointers,
+                                   symbols);
+      if (auto program = ProgramCache::get().find(cacheKey)) {
+        result.program = *program;
+        result.program.sourceHash = sourceHash;
+        return result;
+      }
+    }
+
+    if (m_incremental) {
+      m_lineCache.rotate();
+    } else {
+      m_lineCache.clear();
+    }
+
     /// by default, emit to .text until otherwise specified
     setCurrentSegment(Location::unknown(), ".text");
     m_symbolMap.clear();
@@ -84,7 +105,7 @@ public:
     runPass(tokenizedLines, SourceProgram, pass0, programLines);
 
     /// Pseudo instruction expansion
-    runPass(expandedLines, SourceProgram, pass1, tokenizedLines);
+    runPass(expandedLines, SourceProgram, pass1, std::move(tokenizedLines));
 
     /** Assemble. During assembly, we generate:
      * - linkageMap: Recording offsets of instructions which require linkage
@@ -100,6 +121,8 @@ public:
     result.program = program;
     result.program.sourceHash = sourceHash;
     result.program.entryPoint = m_sectionBasePointers.at(".text");
+    if (m_programCaching)
+      ProgramCache::get().insert(cacheKey, result.program);
     return result;
   }
 
@@ -165,6 +188,13 @@ public:
     return opres;
   }
 
+  unsigned instructionSize(const VInt word) const override {
+    auto match = m_matcher->matchInstruction(word);
+    if (match.isError())
+      return 0;
+    return match.value()->size();
+  }
+
   const Matcher &getMatcher() { return *m_matcher; }
 
   std::set<QString> getOpcodes() const override {
@@ -221,11 +251,289 @@ protected:
 
   using LinkRequests = std::vector<LinkRequest>;
 
+public:
+  /**
+   * @brief The ObjectFile struct
+   * A relocatable object, assembled from a single source file. The sections of
+   * the object start at address 0, and its labels are recorded relative to
+   * their section, along with the link requests of its instructions, such that
+   * the object is placed and its symbols resolved once linked (see link()).
+   */
+  struct ObjectFile {
+    struct Definition {
+      Symbol symbol;
+      unsigned line;
+      Section section;
+      AInt offset;
+    };
+
+    QString name;
+    std::map<Section, ProgramSection> sections;
+    // Labels of the object, in order of definition.
+    std::vector<Definition> definitions;
+    // Symbols defined through .equ, which do not depend on the placement of
+    // the object.
+    std::vector<SymbolMap::AbsSymbol> constants;
+    // Symbols exported to the other objects through .global or .globl.
+    std::set<QString> globals;
+    LinkRequests relocations;
+    Program::SourceMapping sourceMapping;
+    // Number of source lines of the object.
+    unsigned lines = 0;
+  };
+
+  struct ObjectResult {
+    Errors errors;
+    std::shared_ptr<const ObjectFile> object;
+  };
+
+  struct SourceFile {
+    QString name;
+    QStringList lines;
+  };
+
+  /**
+   * @brief assembleObject
+   * Assembles the source file @p lines into a relocatable object, deferring
+   * the resolution of all symbols to link(). Instructions may refer to the
+   * labels of the object and to the labels exported by other objects, whereas
+   * data directives are evaluated during assembly, and may thus only refer to
+   * constants.
+   */
+  ObjectResult assembleObject(const QStringList &lines,
+                              const QString &name = QString()) const {
+    ObjectResult result;
+
+    setCurrentSegment(Location::unknown(), ".text");
+    m_symbolMap.clear();
+
+    runPass(tokenizedLines, SourceProgram, pass0, lines);
+    runPass(expandedLines, SourceProgram, pass1, std::move(tokenizedLines));
+
+    auto object = std::make_shared<ObjectFile>();
+    runPass(program, Program, pass2, expandedLines, object->relocations,
+            &object->definitions);
+
+    object->name = name;
+    object->lines = lines.size();
+    for (auto &section : program.sections) {
+      section.second.address = 0;
+    }
+    object->sections = std::move(program.sections);
+    object->sourceMapping = std::move(program.sourceMapping);
+    object->constants = m_symbolMap.abs;
+    for (const auto &line : expandedLines) {
+      if (line.directive == ".global" || line.directive == ".globl") {
+        object->globals.insert(line.tokens.begin(), line.tokens.end());
+      }
+    }
+    result.object = object;
+    return result;
+  }
+
+  /**
+   * @brief link
+   * Links @p objects into a program. The sections of the objects are placed in
+   * order from the section base pointers, each aligned to its .align
+   * directives and the instruction alignment of the ISA. The labels of each
+   * object are then defined at their placed addresses, along with the labels
+   * exported by the other objects, and the link requests of the object are
+   * resolved. Source lines are numbered as if the objects were concatenated.
+   */
+  AssembleResult
+  link(const std::vector<std::shared_ptr<const ObjectFile>> &objects) const {
+    AssembleResult result;
+    Program &program = result.program;
+    for (const auto &iter : m_sectionBasePointers) {
+      ProgramSection sec;
+      sec.name = iter.first;
+      sec.address = iter.second;
+      program.sections[iter.first] = sec;
+    }
+
+    // Place the sections of each object, recording their offsets within the
+    // sections of the program.
+    std::vector<std::map<Section, AInt>> placements(objects.size());
+    std::vector<unsigned> lineOffsets(objects.size());
+    unsigned lines = 0;
+    for (auto object : llvm::enumerate(objects)) {
+      lineOffsets[object.index()] = lines;
+      lines += object.value()->lines;
+      for (const auto &iter : object.value()->sections) {
+        ProgramSection &section = program.sections.at(iter.first);
+        const AInt alignment = std::lcm<AInt>(iter.second.alignment,
+                                              m_isa->instrByteAlignment());
+        const AInt misalignment =
+            (section.address + section.size()) % alignment;
+        if (misalignment != 0)
+          section.reserve(alignment - misalignment);
+        section.alignment = std::lcm(section.alignment, alignment);
+        placements[object.index()][iter.first] = section.size();
+        section.append(iter.second.data);
+        section.reserve(iter.second.zeroBytes);
+      }
+    }
+
+    auto placedAddress = [&](size_t object, const Section &section,
+                             AInt offset) -> AInt {
+      return program.sections.at(section).address +
+             placements[object].at(section) + offset;
+    };
+
+    // Collect the labels exported by each object.
+    struct Export {
+      Symbol symbol;
+      AInt address;
+    };
+    std::map<QString, Export> exports;
+    for (auto object : llvm::enumerate(objects)) {
+      for (const auto &def : object.value()->definitions) {
+        if (def.symbol.isLocal() || !object.value()->globals.count(def.symbol))
+          continue;
+        const AInt address =
+            placedAddress(object.index(), def.section, def.offset);
+        if (!exports.emplace(def.symbol.v, Export{def.symbol, address})
+                 .second) {
+          const Error error(Location(def.line),
+                            "Multiple definitions of global symbol '" +
+                                def.symbol.v + "'");
+          result.errors.push_back(objectError(error, object.value()->name,
+                                              lineOffsets[object.index()]));
+        }
+      }
+    }
+    if (!result.errors.empty())
+      return result;
+
+    for (auto object : llvm::enumerate(objects)) {
+      const ObjectFile &obj = *object.value();
+      const unsigned lineOffset = lineOffsets[object.index()];
+
+      m_symbolMap.clear();
+      for (const auto &constant : obj.constants) {
+        m_symbolMap.setAbsSymbol(constant.symbol, constant.value);
+      }
+      for (const auto &def : obj.definitions) {
+        const AInt address =
+            placedAddress(object.index(), def.section, def.offset);
+        if (auto err = m_symbolMap.addSymbol(def.line, def.symbol, address)) {
+          result.errors.push_back(objectError(*err, obj.name, lineOffset));
+          continue;
+        }
+        if (!def.symbol.isLocal())
+          program.symbols[address] = def.symbol;
+      }
+      // Labels of the object take precedence over those of other objects.
+      for (const auto &iter : exports) {
+        if (!m_symbolMap.id(iter.first))
+          m_symbolMap.setAbsSymbol(iter.second.symbol, iter.second.address);
+      }
+
+      for (const LinkRequest &req : obj.relocations) {
+        ProgramSection &section = program.sections.at(req.section);
+        const AInt offset = placements[object.index()].at(req.section) +
+                            req.offset;
+        if (auto err = resolveLinkRequest(req, section.address + offset,
+                                          section.data, offset)) {
+          result.errors.push_back(objectError(*err, obj.name, lineOffset));
+        }
+      }
+
+      const AInt textOffset = placements[object.index()].at(TEXT_SECTION_NAME);
+      for (const auto &iter : obj.sourceMapping) {
+        auto &mapped = program.sourceMapping[textOffset + iter.first];
+        for (const unsigned line : iter.second) {
+          mapped.insert(line + lineOffset);
+        }
+      }
+    }
+
+    program.entryPoint = m_sectionBasePointers.at(TEXT_SECTION_NAME);
+    return result;
+  }
+
+  /**
+   * @brief assembleFiles
+   * Assembles each of @p files into an object and links the objects into a
+   * program (see assembleObject and link). The objects of the previous call
+   * are reused for files of unchanged contents, such that editing a file only
+   * reassembles that file before relinking, akin to separate compilation.
+   */
+  AssembleResult assembleFiles(const std::vector<SourceFile> &files) const {
+    AssembleResult result;
+
+    if (m_incremental) {
+      m_lineCache.rotate();
+    } else {
+      m_lineCache.clear();
+    }
+
+    // Only the objects of the latest assembly are retained.
+    QHash<QString, std::shared_ptr<const ObjectFile>> objectCache;
+    std::vector<std::shared_ptr<const ObjectFile>> objects;
+    unsigned lineOffset = 0;
+    for (const auto &file : files) {
+      const QString key =
+          file.name + QChar(0x1f) +
+          ProgramCache::key(file.lines, *m_isa, m_sectionBasePointers, nullptr);
+      std::shared_ptr<const ObjectFile> object = m_objectCache.value(key);
+      if (!object) {
+        auto objectRes = assembleObject(file.lines, file.name);
+        m_assembledObjects++;
+        for (const auto &err : objectRes.errors) {
+          result.errors.push_back(objectError(err, file.name, lineOffset));
+        }
+        object = objectRes.object;
+      }
+      lineOffset += file.lines.size();
+      if (!object)
+        continue;
+      objectCache.insert(key, object);
+      objects.push_back(object);
+    }
+    m_objectCache = std::move(objectCache);
+    if (!result.errors.empty())
+      return result;
+
+    return link(objects);
+  }
+
+  /// Returns the number of objects assembled by assembleFiles(), rather than
+  /// reused from a previous call.
+  unsigned assembledObjects() const { return m_assembledObjects; }
+
+protected:
+  /// Returns @p error of the object @p name, at the source line numbering of
+  /// the concatenated objects.
+  static Error objectError(const Error &error, const QString &name,
+                           unsigned lineOffset) {
+    const Location location = error.isKnownSourceLine()
+                                  ? Location(error.sourceLine() + lineOffset)
+                                  : Location::unknown();
+    const QString prefix = name.isEmpty() ? QString() : name + ": ";
+    return Error(location, prefix + error.errorMessage());
+  }
+
   /**
    * @brief pass0
-   * Line tokenization and source line recording
+   * Line tokenization and source line recording. The tokenization of a line
+   * does not depend on any other line, and is performed in parallel, whereas
+   * symbol definitions and early directives are processed serially in program
+   * order.
    */
   std::variant<Errors, SourceProgram> pass0(const QStringList &program) const {
+    std::vector<std::optional<TokenizedSrcLine>> lines(program.size());
+    std::vector<std::optional<Error>> lineErrors(program.size());
+    parallelFor(program.size(), s_parallelChunkSize,
+                [&](size_t begin, size_t end) {
+                  for (size_t i = begin; i < end; ++i) {
+                    if (program.at(i).isEmpty())
+                      continue;
+                    lines[i].emplace(i);
+                    lineErrors[i] = tokenizeLine(*lines[i], program.at(i));
+                  }
+                });
+
     Errors errors;
     SourceProgram tokenizedLines;
     tokenizedLines.reserve(program.size());
@@ -240,21 +548,20 @@ protected:
      * line).
      */
     Symbols carry;
-    for (auto line : llvm::enumerate(program)) {
-      if (line.value().isEmpty())
+    for (auto line : llvm::enumerate(lines)) {
+      if (!line.value())
         continue;
-      TokenizedSrcLine tsl(line.index());
-      runOperation(tokens, tokenize, tsl, line.value());
-
-      runOperation(remainingTokens, splitCommentFromLine, tokens);
-
-      // Symbols precede directives
-      runOperation(symbolsAndRest, splitSymbolsFromLine, tsl, remainingTokens);
-
-      tsl.symbols = symbolsAndRest.first;
+      if (auto &err = lineErrors.at(line.index())) {
+        errors.push_back(*err);
+        continue;
+      }
+      TokenizedSrcLine &tsl = *line.value();
+      if (m_incremental)
+        m_lineCache.insertTokenized(program.at(line.index()),
+                                    {tsl.symbols, tsl.directive, tsl.tokens});
 
       bool uniqueSymbols = true;
-      for (const auto &s : symbolsAndRest.first) {
+      for (const auto &s : tsl.symbols) {
         if (!s.isLegal())
           errors.push_back(Error(tsl, "Illegal symbol '" + s.v + "'"));
 
@@ -268,31 +575,24 @@ protected:
       if (!uniqueSymbols) {
         continue;
       }
-      symbols.insert(symbolsAndRest.first.begin(), symbolsAndRest.first.end());
+      symbols.insert(tsl.symbols.begin(), tsl.symbols.end());
 
-      runOperation(directiveAndRest, splitDirectivesFromLine, tsl,
-                   symbolsAndRest.second);
-      tsl.directive = directiveAndRest.first;
-
-      // Parse (and remove) relocation hints from the tokens.
-      runOperation(finalTokens, splitRelocationsFromLine,
-                   directiveAndRest.second);
-
-      tsl.tokens = finalTokens;
       if (tsl.tokens.empty() && tsl.directive.isEmpty()) {
         if (!tsl.symbols.empty()) {
           carry.insert(tsl.symbols.begin(), tsl.symbols.end());
         }
-      } else {
-        tsl.symbols.insert(carry.begin(), carry.end());
-        carry.clear();
-        tokenizedLines.push_back(tsl);
+        continue;
       }
+      tsl.symbols.insert(carry.begin(), carry.end());
+      carry.clear();
+      tokenizedLines.push_back(std::move(tsl));
 
-      if (!tsl.directive.isEmpty() && m_earlyDirectives.count(tsl.directive)) {
+      const TokenizedSrcLine &srcLine = tokenizedLines.back();
+      if (!srcLine.directive.isEmpty() &&
+          m_earlyDirectives.count(srcLine.directive)) {
         bool wasDirective; // unused
         runOperation(directiveBytes, assembleDirective,
-                     DirectiveArg{tsl, nullptr}, wasDirective, false);
+                     DirectiveArg{srcLine, nullptr}, wasDirective, false);
       }
     }
 
@@ -305,10 +605,11 @@ protected:
 
   /**
    * @brief pass1
-   * Pseudo-op expansion. If @return errors is empty, pass succeeded.
+   * Pseudo-op expansion. If @return errors is empty, pass succeeded. The lines
+   * of @p tokenizedLines are moved, rather than copied, into the result.
    */
   std::variant<Errors, SourceProgram>
-  pass1(const SourceProgram &tokenizedLines) const {
+  pass1(SourceProgram &&tokenizedLines) const {
     Errors errors;
     SourceProgram expandedLines;
     expandedLines.reserve(tokenizedLines.size());
@@ -325,15 +626,15 @@ protected:
           TokenizedSrcLine tsl(tokenizedLine.value().sourceLine());
           tsl.tokens = eop.value();
           if (eop.index() == 0) {
-            tsl.directive = tokenizedLine.value().directive;
-            tsl.symbols = tokenizedLine.value().symbols;
+            tsl.directive = std::move(tokenizedLine.value().directive);
+            tsl.symbols = std::move(tokenizedLine.value().symbols);
           }
-          expandedLines.push_back(tsl);
+          expandedLines.push_back(std::move(tsl));
         }
       } else {
-        // This was not a pseudoinstruction; just add line to the set of
+        // This was not a pseudoinstruction; just move the line to the set of
         // expanded lines
-        expandedLines.push_back(tokenizedLine.value());
+        expandedLines.push_back(std::move(tokenizedLine.value()));
       }
     }
 
@@ -350,9 +651,29 @@ protected:
    * In the following, current size of the program is used as an analog for the
    * offset of the to-be-assembled instruction in the program. This is then used
    * for symbol resolution.
+   * The machine code of instructions does not depend on their address, and is
+   * encoded in parallel ahead of the serial layout of the program.
+   * If @p definitions is set, labels are recorded relative to their section
+   * rather than defined in the symbol map (see assembleObject).
    */
-  std::variant<Errors, Program> pass2(const SourceProgram &tokenizedLines,
-                                      LinkRequests &needsLinkage) const {
+  std::variant<Errors, Program>
+  pass2(const SourceProgram &tokenizedLines, LinkRequests &needsLinkage,
+        std::vector<ObjectFile::Definition> *definitions =
+            nullptr) const {
+    std::vector<std::optional<AssembleRes>> encodedLines(tokenizedLines.size());
+    std::vector<std::shared_ptr<InstructionBase>> assembledWith(
+        tokenizedLines.size());
+    parallelFor(tokenizedLines.size(), s_parallelChunkSize,
+                [&](size_t begin, size_t end) {
+                  for (size_t i = begin; i < end; ++i) {
+                    // Lines without a directive are instructions.
+                    const auto &line = tokenizedLines.at(i);
+                    if (line.directive.isEmpty())
+                      encodedLines[i] =
+                          encodeInstruction(line, assembledWith[i]);
+                  }
+                });
+
     // Initialize program with initialized segments:
     Program program;
     for (const auto &iter : m_sectionBasePointers) {
@@ -367,11 +688,20 @@ protected:
     ProgramSection *currentSection = &program.sections.at(m_currentSection);
 
     bool wasDirective;
-    for (const auto &line : tokenizedLines) {
+    for (auto lineIt : llvm::enumerate(tokenizedLines)) {
+      const auto &line = lineIt.value();
       // Get offset of currently emitting position in memory relative to section
       // position
-      VInt addr_offset = currentSection->data.size();
+      VInt addr_offset = currentSection->size();
       for (const auto &s : line.symbols) {
+        if (definitions) {
+          // Record symbol position relative to its section, to be placed by
+          // the linker
+          definitions->push_back(
+              {s, static_cast<unsigned>(line.sourceLine()), m_currentSection,
+               addr_offset});
+          continue;
+        }
         // Record symbol position as its absolute address in memory
         auto res = m_symbolMap.addSymbol(
             line, s,
@@ -388,12 +718,20 @@ protected:
       // Currently emitting segment may have changed during the assembler
       // directive; refresh state
       currentSection = &program.sections.at(m_currentSection);
-      addr_offset = currentSection->data.size();
+      addr_offset = currentSection->size();
       if (!wasDirective) {
+        auto &encoded = *encodedLines.at(lineIt.index());
+        if (encoded.isError()) {
+          errors.push_back(encoded.error());
+          continue;
+        }
+        const auto &machineCode = encoded.value();
         /// Maintain a pointer to the instruction that was assembled.
-        std::shared_ptr<InstructionBase> assembledWith;
-        runOperation(machineCode, assembleInstruction, line, assembledWith);
-        assert(assembledWith && "Expected the assembler instruction to be set");
+        const auto &instr = assembledWith.at(lineIt.index());
+        assert(instr && "Expected the assembler instruction to be set");
+        if (m_incremental)
+          m_lineCache.insertEncoded(LineCache::tokensKey(line.tokens),
+                                    {machineCode, instr});
         program.sourceMapping[addr_offset].insert(line.sourceLine());
 
         if (!machineCode.linksWithSymbol.symbol.isEmpty()) {
@@ -420,12 +758,12 @@ protected:
           break;
         }
 
-        currentSection->data.append(
-            QByteArray(reinterpret_cast<char *>(&machineCode.instruction),
-                       assembledWith->size()));
+        currentSection->append(
+            QByteArray(reinterpret_cast<const char *>(&machineCode.instruction),
+                       instr->size()));
       }
       // This was a directive; append any assembled bytes to the segment.
-      currentSection->data.append(directiveBytes);
+      currentSection->append(directiveBytes);
     }
     if (errors.size() != 0) {
       return {errors};
@@ -434,8 +772,8 @@ protected:
     // Register address symbols in program struct.
     /// @todo: also consider relative symbols here.
     for (const auto &iter : m_symbolMap.abs) {
-      if (iter.first.is(Symbol::Type::Address)) {
-        program.symbols[iter.second] = iter.first;
+      if (iter.symbol.is(Symbol::Type::Address)) {
+        program.symbols[iter.value] = iter.symbol;
       }
     }
 
@@ -446,57 +784,11 @@ protected:
   pass3(Program &program, const LinkRequests &needsLinkage) const {
     Errors errors;
     for (const LinkRequest &linkRequest : needsLinkage) {
-      const auto &symbol = linkRequest.fieldRequest.symbol;
-      Reg_T symbolValue;
-
-      // Add the special __address__ symbol indicating the address of the
-      // instruction itself. Not done through addSymbol given that we redefine
-      // this symbol on each line.
-      const Reg_T linkRequestAddress = linkReqAddress(linkRequest);
-      m_symbolMap.abs["__address__"] = linkRequestAddress;
-
-      // Expression evaluation also performs symbol evaluation
-      auto exprRes = evalExpr(linkRequest, symbol);
-      if (auto *err = std::get_if<Error>(&exprRes)) {
-        errors.push_back(*err);
-        continue;
-      } else {
-        symbolValue = std::get<ExprEvalVT>(exprRes);
-      }
-
-      if (!linkRequest.fieldRequest.relocation.isEmpty()) {
-        auto relocRes = m_relocationsMap.at(linkRequest.fieldRequest.relocation)
-                            .get()
-                            ->handle(symbolValue, linkRequestAddress);
-        if (auto *error = std::get_if<Error>(&relocRes)) {
-          errors.push_back(*error);
-          continue;
-        }
-        symbolValue = std::get<Reg_T>(relocRes);
-      }
-
-      QByteArray &section = program.sections.at(linkRequest.section).data;
-
-      // Decode instruction at link-request position
-      assert(static_cast<unsigned>(section.size()) >=
-                 (linkRequest.offset + linkRequest.instrAlignment) &&
-             "Error: position of link request is not within program");
-      Instr_T instr =
-          *reinterpret_cast<Instr_T *>(section.data() + linkRequest.offset);
-
-      // Re-apply immediate resolution using the value acquired from the symbol
-      // map
-      assert(linkRequest.fieldRequest.resolveSymbol &&
-             "Something other than an immediate field has requested linkage?");
-      if (auto res = linkRequest.fieldRequest.resolveSymbol(
-              linkRequest, symbolValue, instr, linkReqAddress(linkRequest));
-          res.isError()) {
-        errors.push_back(res.error());
-        continue;
-      }
-
-      // Finally, overwrite the instruction in the section
-      *reinterpret_cast<Instr_T *>(section.data() + linkRequest.offset) = instr;
+      if (auto error = resolveLinkRequest(
+              linkRequest, linkReqAddress(linkRequest),
+              program.sections.at(linkRequest.section).data,
+              linkRequest.offset))
+        errors.push_back(*error);
     }
     if (errors.size() != 0) {
       return {errors};
@@ -505,6 +797,132 @@ protected:
     }
   }
 
+  /**
+   * @brief resolveLinkRequest
+   * Resolves the symbol requested by @p linkRequest, for the instruction at
+   * @p address, and writes the resolved instruction at @p offset of the
+   * section data @p section.
+   */
+  std::optional<Error> resolveLinkRequest(const LinkRequest &linkRequest,
+                                          const Reg_T address,
+                                          QByteArray &section,
+                                          const VInt offset) const {
+    const auto &symbol = linkRequest.fieldRequest.symbol;
+    Reg_T symbolValue;
+
+    // Add the special __address__ symbol indicating the address of the
+    // instruction itself. Not done through addSymbol given that we redefine
+    // this symbol on each line.
+    m_symbolMap.setAbsSymbol("__address__", address);
+
+    // Expression evaluation also performs symbol evaluation
+    auto exprRes = evalExpr(linkRequest, symbol);
+    if (auto *err = std::get_if<Error>(&exprRes)) {
+      return *err;
+    } else {
+      symbolValue = std::get<ExprEvalVT>(exprRes);
+    }
+
+    if (!linkRequest.fieldRequest.relocation.isEmpty()) {
+      auto relocRes = m_relocationsMap.at(linkRequest.fieldRequest.relocation)
+                          .get()
+                          ->handle(symbolValue, address);
+      if (auto *error = std::get_if<Error>(&relocRes)) {
+        return *error;
+      }
+      symbolValue = std::get<Reg_T>(relocRes);
+    }
+
+    // Decode instruction at link-request position
+    assert(static_cast<unsigned>(section.size()) >=
+               (offset + linkRequest.instrAlignment) &&
+           "Error: position of link request is not within program");
+    Instr_T instr = *reinterpret_cast<Instr_T *>(section.data() + offset);
+
+    // Re-apply immediate resolution using the value acquired from the symbol
+    // map
+    assert(linkRequest.fieldRequest.resolveSymbol &&
+           "Something other than an immediate field has requested linkage?");
+    if (auto res = linkRequest.fieldRequest.resolveSymbol(
+            linkRequest, symbolValue, instr, address);
+        res.isError()) {
+      return res.error();
+    }
+
+    // Finally, overwrite the instruction in the section
+    *reinterpret_cast<Instr_T *>(section.data() + offset) = instr;
+    return {};
+  }
+
+  /**
+   * @brief tokenizeLine
+   * Tokenizes source line @p line into @p tsl, separating the symbols,
+   * directive and relocation hints from the remaining tokens. In incremental
+   * mode, the tokenization of an identical source line of the previous
+   * assembly is reused.
+   * Only reads the line cache, and may be called concurrently.
+   */
+  std::optional<Error> tokenizeLine(TokenizedSrcLine &tsl,
+                                    const QString &line) const {
+    if (m_incremental) {
+      if (auto *cached = m_lineCache.findTokenized(line)) {
+        tsl.symbols = cached->symbols;
+        tsl.directive = cached->directive;
+        tsl.tokens = cached->tokens;
+        return {};
+      }
+    }
+
+    auto tokens = tokenize(tsl, line);
+    if (tokens.isError())
+      return tokens.error();
+
+    auto remainingTokens = splitCommentFromLine(tokens.value());
+    if (remainingTokens.isError())
+      return remainingTokens.error();
+
+    // Symbols precede directives
+    auto symbolsAndRest = splitSymbolsFromLine(tsl, remainingTokens.value());
+    if (symbolsAndRest.isError())
+      return symbolsAndRest.error();
+    tsl.symbols = symbolsAndRest.value().first;
+
+    auto directiveAndRest =
+        splitDirectivesFromLine(tsl, symbolsAndRest.value().second);
+    if (directiveAndRest.isError())
+      return directiveAndRest.error();
+    tsl.directive = directiveAndRest.value().first;
+
+    // Parse (and remove) relocation hints from the tokens.
+    LineTokens rest = directiveAndRest.value().second;
+    auto finalTokens = splitRelocationsFromLine(rest);
+    if (finalTokens.isError())
+      return finalTokens.error();
+    tsl.tokens = finalTokens.value();
+    return {};
+  }
+
+  /**
+   * @brief encodeInstruction
+   * Assembles @p line as per assembleInstruction. In incremental mode, the
+   * machine code of an instruction with identical tokens in the previous
+   * assembly is reused. The machine code does not depend on the address of
+   * the instruction, given that symbol references are resolved in pass3.
+   * Only reads the line cache, and may be called concurrently.
+   */
+  AssembleRes
+  encodeInstruction(const TokenizedSrcLine &line,
+                    std::shared_ptr<InstructionBase> &assembledWith) const {
+    if (m_incremental) {
+      if (auto *cached =
+              m_lineCache.findEncoded(LineCache::tokensKey(line.tokens))) {
+        assembledWith = cached->assembledWith;
+        return {cached->machineCode};
+      }
+    }
+    return assembleInstruction(line, assembledWith);
+  }
+
   virtual Result<std::vector<LineTokens>>
   expandPseudoOp(const TokenizedSrcLine &line) const {
     if (line.tokens.empty()) {
@@ -642,6 +1060,96 @@ protected:
   std::unique_ptr<Matcher> m_matcher;
 
   std::shared_ptr<const ISAInfoBase> m_isa;
+
+  /**
+   * @brief The LineCache struct
+   * The tokenized source lines and instruction encodings of the current and
+   * the previous assembly, for incremental assembling. Entries of the previous
+   * assembly which are not reused by the current assembly are dropped once
+   * the next assembly starts, such that the cache is bounded by the size of
+   * the program.
+   * Lookups may be performed concurrently, whereas insertions are performed
+   * serially in between the parallel phases of a pass.
+   */
+  struct LineCache {
+    struct TokenizedLine {
+      Symbols symbols;
+      QString directive;
+      LineTokens tokens;
+    };
+    struct EncodedLine {
+      InstrRes machineCode;
+      std::shared_ptr<InstructionBase> assembledWith;
+    };
+
+    /// Returns a key identifying @p tokens, including their relocations.
+    static QString tokensKey(const LineTokens &tokens) {
+      QString key;
+      for (const auto &token : tokens)
+        key += token.relocation() + QChar(0x1e) + token + QChar(0x1f);
+      return key;
+    }
+
+    const TokenizedLine *findTokenized(const QString &line) const {
+      return find(tokenized, prevTokenized, line);
+    }
+    void insertTokenized(const QString &line, const TokenizedLine &value) {
+      tokenized.insert(line, value);
+    }
+    const EncodedLine *findEncoded(const QString &key) const {
+      return find(encoded, prevEncoded, key);
+    }
+    void insertEncoded(const QString &key, const EncodedLine &value) {
+      encoded.insert(key, value);
+    }
+
+    /// Starts a new assembly. The entries of an assembly which failed before
+    /// using a cache are retained.
+    void rotate() {
+      if (!tokenized.isEmpty())
+        prevTokenized = std::move(tokenized);
+      if (!encoded.isEmpty())
+        prevEncoded = std::move(encoded);
+      tokenized.clear();
+      encoded.clear();
+    }
+    void clear() {
+      tokenized.clear();
+      prevTokenized.clear();
+      encoded.clear();
+      prevEncoded.clear();
+    }
+
+  private:
+    template <typename T>
+    static const T *find(const QHash<QString, T> &current,
+                         const QHash<QString, T> &previous,
+                         const QString &key) {
+      auto it = current.constFind(key);
+      if (it != current.constEnd())
+        return &*it;
+      auto prevIt = previous.constFind(key);
+      if (prevIt != previous.constEnd())
+        return &*prevIt;
+      return nullptr;
+    }
+
+    QHash<QString, TokenizedLine> tokenized;
+    QHash<QString, TokenizedLine> prevTokenized;
+    QHash<QString, EncodedLine> encoded;
+    QHash<QString, EncodedLine> prevEncoded;
+  };
+  mutable LineCache m_lineCache;
+
+  /// Objects of the latest call to assembleFiles(), keyed by the name and
+  /// contents of their source file. The link requests of an object refer to
+  /// the instructions of the ISA, and the objects are thus not cached on
+  /// disk.
+  mutable QHash<QString, std::shared_ptr<const ObjectFile>> m_objectCache;
+  mutable unsigned m_assembledObjects = 0;
+
+  // Minimum number of lines processed by each thread of a parallel phase.
+  static constexpr size_t s_parallelChunkSize = 2048;
 };
 
 /// An Assembler and QObject (workaround because QObject cannot be directly
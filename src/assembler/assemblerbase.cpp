@@ -40,13 +40,10 @@ AssembleResult AssemblerBase::assembleRaw(const QString &program,
 /// the expression evaluator.
 ExprEvalRes AssemblerBase::evalExpr(const Location &location,
                                     const QString &expr) const {
-  auto relativeMap = m_symbolMap.copyRelativeTo(location.sourceLine());
-
-  auto symbolValue = relativeMap.find(expr);
-  if (symbolValue != relativeMap.end()) {
-    return symbolValue->second;
+  if (auto symbolValue = m_symbolMap.value(expr, location.sourceLine())) {
+    return *symbolValue;
   } else {
-    return evaluate(location, expr, &relativeMap);
+    return evaluate(location, expr, m_symbolMap);
   }
 }
 
@@ -74,8 +71,8 @@ Result<LineTokens> AssemblerBase::tokenize(const Location &location,
   if (auto *error = std::get_if<Error>(&quoteTokenized))
     return {*error};
 
-  auto joinedtokens =
-      joinParentheses(location, std::get<QStringList>(quoteTokenized));
+  auto joinedtokens = joinParentheses(
+      location, std::get<std::vector<QStringView>>(quoteTokenized));
   if (auto *err = std::get_if<Error>(&joinedtokens))
     return *err;
 
@@ -118,21 +115,23 @@ AssemblerBase::splitSymbolsFromLine(const Location &location,
   LineTokens splitTokens;
   splitTokens.reserve(tokens.size());
   for (const auto &token : tokens) {
-    if (token.startsWith('\"') && token.endsWith('\"')) {
-      // Skip quoted strings.
+    if ((token.startsWith('\"') && token.endsWith('\"')) ||
+        !token.contains(':')) {
+      // Skip quoted strings, and share tokens which need no splitting.
       splitTokens.push_back(token);
       continue;
     }
-    Token buffer;
-    for (const auto &ch : token) {
-      buffer.append(ch);
-      if (ch == ':') {
-        splitTokens.push_back(buffer);
-        buffer.clear();
+    const QStringView view(token);
+    qsizetype begin = 0;
+    for (qsizetype i = 0; i < view.size(); ++i) {
+      if (view.at(i) == ':') {
+        splitTokens.push_back(
+            Token(view.sliced(begin, i + 1 - begin).toString()));
+        begin = i + 1;
       }
     }
-    if (!buffer.isEmpty()) {
-      splitTokens.push_back(buffer);
+    if (begin < view.size()) {
+      splitTokens.push_back(Token(view.sliced(begin).toString()));
     }
   }
 
@@ -49,6 +49,17 @@ public:
   AssembleResult assembleRaw(const QString &program,
                              const SymbolMap *symbols = nullptr) const;
 
+  /// Enables incremental assembling, wherein the tokenization and machine code
+  /// of source lines are reused across calls to assemble() for unchanged
+  /// lines. Intended for repeatedly assembling a program which is being
+  /// edited.
+  void setIncremental(bool enabled) { m_incremental = enabled; }
+  bool isIncremental() const { return m_incremental; }
+
+  /// Enables looking up and storing assembled programs in the ProgramCache,
+  /// such that assembling an unchanged program is a lookup.
+  void setProgramCaching(bool enabled) { m_programCaching = enabled; }
+
   /// Disassembles an input program relative to the provided base address.
   virtual DisassembleResult disassemble(const Program &program,
                                         const AInt baseAddress = 0) const = 0;
@@ -59,6 +70,10 @@ public:
                                           const ReverseSymbolMap &symbols,
                                           const AInt baseAddress = 0) const = 0;
 
+  /// Returns the size in bytes of the instruction encoded by @p word, or 0 if
+  /// @p word does not encode a known instruction.
+  virtual unsigned instructionSize(const VInt word) const = 0;
+
   /// Returns the set of opcodes (as strings) which are supported by this
   /// assembler.
   virtual std::set<QString> getOpcodes() const = 0;
@@ -133,6 +148,9 @@ protected:
   DirectiveVec m_directives;
   DirectiveMap m_directivesMap;
   EarlyDirectives m_earlyDirectives;
+
+  bool m_incremental = false;
+  bool m_programCaching = false;
 };
 
 } // namespace Assembler
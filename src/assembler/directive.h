@@ -14,10 +14,13 @@ namespace Assembler {
 class AssemblerBase;
 
 /// A directive argument consists of a tokenized source line as well as the
-/// program section of which the directive handler should work on.
+/// program section of which the directive handler should work on. Handlers
+/// may append to the section directly, such as to reserve zero bytes (see
+/// ProgramSection::reserve), rather than returning the bytes. The section is
+/// not set for early directives.
 struct DirectiveArg {
   const TokenizedSrcLine &line;
-  const ProgramSection *section;
+  ProgramSection *section;
 };
 
 /// An assembler directive represents a function which may be activated through
@@ -1,7 +1,12 @@
 #include "expreval.h"
 
+#include <QHash>
+
+#include <array>
+#include <functional>
 #include <iostream>
 #include <memory>
+#include <mutex>
 
 #include "assembler_defines.h"
 #include "binutils.h"
@@ -32,8 +37,13 @@ struct Nothing : Printable {
 };
 
 struct Literal : Printable {
-  explicit Literal(const QString &_v) : v(_v) {}
+  // Immediate literals are converted once, upon parsing the expression.
+  explicit Literal(const QString &_v) : v(_v) {
+    immediate = getImmediate(v, isImmediate);
+  }
   QString v;
+  bool isImmediate = false;
+  int64_t immediate = 0;
   void print(std::ostream &str) const override;
 };
 
@@ -230,8 +240,10 @@ ExprRes parseLeft(const Location &loc, const QString &s, int &pos, int &depth) {
   }
 }
 
+using SymbolResolver = std::function<std::optional<VIntS>(const QString &)>;
+
 VIntS evaluate(const std::shared_ptr<Expr> &expr,
-               const AbsoluteSymbolMap *variables) {
+               const SymbolResolver &variables) {
   // There is a bug in GCC for variant visitors on incomplete variant types
   // (recursive), So instead we'll macro our way towards something that looks
   // like a pattern match for the variant type.
@@ -274,15 +286,12 @@ VIntS evaluate(const std::shared_ptr<Expr> &expr,
   }
   FiExpr;
   IfExpr(Literal, v) {
-    bool ok = false;
-    auto value = getImmediate(v->v, ok);
-    if (!ok) {
-      if (variables != nullptr) {
-        auto it = variables->find(v->v);
-        if (it != variables->end()) {
-          value = it->second;
-          ok = true;
-        }
+    bool ok = v->isImmediate;
+    VIntS value = v->immediate;
+    if (!ok && variables) {
+      if (auto symbolValue = variables(v->v)) {
+        value = *symbolValue;
+        ok = true;
       }
     }
 
@@ -298,13 +307,62 @@ VIntS evaluate(const std::shared_ptr<Expr> &expr,
   Q_UNREACHABLE();
 }
 
+namespace {
+
+/**
+ * @brief The ExprCache class
+ * Expressions are parsed once into an expression tree, which is cached by the
+ * expression string and evaluated anew against the symbols of each
+ * evaluation. Expression trees are immutable once parsed, and thus shared
+ * between threads evaluating the same expression. Expressions which fail to
+ * parse are not cached, given that the error refers to the location of the
+ * expression.
+ */
+class ExprCache {
+public:
+  static ExprCache &get() {
+    static ExprCache cache;
+    return cache;
+  }
+
+  ExprRes parse(const Location &loc, const QString &s) {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      auto it = m_exprs.constFind(s);
+      if (it != m_exprs.constEnd())
+        return {it.value()};
+    }
+
+    QString sNoWhitespace = s;
+    sNoWhitespace.replace(" ", "");
+    int pos = 0;
+    int depth = 0;
+    auto exprTree = parseLeft(loc, sNoWhitespace, pos, depth);
+    if (exprTree.isError())
+      return exprTree;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // The cache is cleared once full, rather than tracking the use of each
+    // expression.
+    if (m_exprs.size() >= s_capacity)
+      m_exprs.clear();
+    m_exprs.insert(s, exprTree.value());
+    return exprTree;
+  }
+
+private:
+  ExprCache() {}
+
+  // Maximum number of distinct expressions kept.
+  static constexpr int s_capacity = 1 << 14;
+
+  std::mutex m_mutex;
+  QHash<QString, std::shared_ptr<Expr>> m_exprs;
+};
+
 ExprEvalRes evaluate(const Location &loc, const QString &s,
-                     const AbsoluteSymbolMap *variables) {
-  QString sNoWhitespace = s;
-  sNoWhitespace.replace(" ", "");
-  int pos = 0;
-  int depth = 0;
-  auto exprTree = parseLeft(loc, sNoWhitespace, pos, depth);
+                     const SymbolResolver &variables) {
+  auto exprTree = ExprCache::get().parse(loc, s);
   if (auto *err = std::get_if<Error>(&exprTree)) {
     return *err;
   }
@@ -315,6 +373,184 @@ ExprEvalRes evaluate(const Location &loc, const QString &s,
     return {Error(loc, e.what())};
   }
 }
+} // namespace
+
+ExprEvalRes evaluate(const Location &loc, const QString &s,
+                     const AbsoluteSymbolMap *variables) {
+  if (variables == nullptr)
+    return evaluate(loc, s, SymbolResolver());
+  return evaluate(loc, s, [&](const QString &name) -> std::optional<VIntS> {
+    auto it = variables->find(name);
+    if (it != variables->end())
+      return it->second;
+    return {};
+  });
+}
+
+ExprEvalRes evaluate(const Location &loc, const QString &s,
+                     const SymbolMap &symbols) {
+  const unsigned line = loc.sourceLine();
+  return evaluate(loc, s, [&](const QString &name) {
+    return symbols.value(name, line);
+  });
+}
+
+namespace {
+
+/// Emits the postfix code of @p expr, and returns the depth of the stack
+/// required to evaluate it.
+Result<unsigned> emitCode(const Location &loc,
+                          const std::shared_ptr<Expr> &expr,
+                          const CompiledExpr::Binder &binder,
+                          std::vector<CompiledExpr::Instr> &code) {
+  using Op = CompiledExpr::Op;
+  IfExpr(Literal, v) {
+    if (v->isImmediate) {
+      code.push_back({Op::Constant, v->immediate});
+      return {1u};
+    }
+    const auto binding = binder ? binder(v->v) : std::nullopt;
+    if (!binding)
+      return {Error(loc, "Unknown symbol '" + v->v + "'")};
+    code.push_back(
+        {binding->kind == CompiledExpr::Binding::Constant ? Op::Constant
+                                                           : Op::Operand,
+         binding->value});
+    return {1u};
+  }
+  FiExpr;
+  IfExpr(Nothing, v) {
+    Q_UNUSED(v);
+    code.push_back({Op::Constant, 0});
+    return {1u};
+  }
+  FiExpr;
+
+  const auto binary = [&](const auto *v, Op op) -> Result<unsigned> {
+    auto lhs = emitCode(loc, v->lhs, binder, code);
+    if (lhs.isError())
+      return lhs;
+    auto rhs = emitCode(loc, v->rhs, binder, code);
+    if (rhs.isError())
+      return rhs;
+    code.push_back({op});
+    return {std::max(lhs.value(), rhs.value() + 1)};
+  };
+  IfExpr(Add, v) { return binary(v, Op::Add); }
+  FiExpr;
+  IfExpr(Sub, v) { return binary(v, Op::Sub); }
+  FiExpr;
+  IfExpr(Mul, v) { return binary(v, Op::Mul); }
+  FiExpr;
+  IfExpr(Div, v) { return binary(v, Op::Div); }
+  FiExpr;
+  IfExpr(Mod, v) { return binary(v, Op::Mod); }
+  FiExpr;
+  IfExpr(And, v) { return binary(v, Op::And); }
+  FiExpr;
+  IfExpr(Or, v) { return binary(v, Op::Or); }
+  FiExpr;
+  IfExpr(SignExtend, v) { return binary(v, Op::SignExtend); }
+  FiExpr;
+
+  Q_UNREACHABLE();
+}
+
+struct Comparison {
+  const char *token;
+  CompiledExpr::Op op;
+};
+// Two-character operators are matched first.
+constexpr Comparison s_comparisons[] = {
+    {"==", CompiledExpr::Op::Eq}, {"!=", CompiledExpr::Op::Ne},
+    {"<=", CompiledExpr::Op::Le}, {">=", CompiledExpr::Op::Ge},
+    {"<", CompiledExpr::Op::Lt},  {">", CompiledExpr::Op::Gt}};
+
+} // namespace
+
+Result<CompiledExpr> CompiledExpr::compile(const Location &loc,
+                                           const QString &s,
+                                           const Binder &binder) {
+  // Comparisons split the expression into two expressions, outside of any
+  // parentheses.
+  QStringList sides = {s};
+  std::optional<Op> comparison;
+  int depth = 0;
+  for (int i = 0; i < s.size() && !comparison; i++) {
+    const QChar ch = s.at(i);
+    depth += ch == '(' ? 1 : ch == ')' ? -1 : 0;
+    if (depth != 0)
+      continue;
+    for (const auto &cmp : s_comparisons) {
+      if (s.mid(i).startsWith(cmp.token)) {
+        comparison = cmp.op;
+        sides = {s.left(i), s.mid(i + qstrlen(cmp.token))};
+        break;
+      }
+    }
+  }
+
+  CompiledExpr compiled;
+  unsigned stackDepth = 0;
+  for (int i = 0; i < sides.size(); i++) {
+    // Whitespace is not part of the expression grammar.
+    const QString side =
+        QString(sides.at(i)).remove(QRegularExpression("\\s"));
+    if (side.contains(QRegularExpression("[=!<>]")) || side.isEmpty())
+      return {Error(loc, "Invalid condition '" + s + "'")};
+    auto tree = ExprCache::get().parse(loc, side);
+    if (auto *err = std::get_if<Error>(&tree))
+      return {*err};
+    auto sideDepth = emitCode(loc, std::get<std::shared_ptr<Expr>>(tree),
+                              binder, compiled.m_code);
+    if (auto *err = std::get_if<Error>(&sideDepth))
+      return {*err};
+    // The right-hand side is evaluated above the value of the left-hand side.
+    stackDepth = std::max(stackDepth, sideDepth.value() + i);
+  }
+  if (comparison)
+    compiled.m_code.push_back({*comparison});
+  if (stackDepth > s_maxDepth)
+    return {Error(loc, "Expression '" + s + "' is too deeply nested")};
+  return {compiled};
+}
+
+ExprEvalVT CompiledExpr::evaluate(const Operands &operands) const {
+  std::array<ExprEvalVT, s_maxDepth> stack;
+  unsigned top = 0;
+  for (const auto &instr : m_code) {
+    if (instr.op == Op::Constant) {
+      stack[top++] = instr.value;
+      continue;
+    }
+    if (instr.op == Op::Operand) {
+      stack[top++] = operands(instr.value);
+      continue;
+    }
+    const ExprEvalVT rhs = stack[--top];
+    ExprEvalVT &lhs = stack[top - 1];
+    switch (instr.op) {
+      // clang-format off
+    case Op::Add: lhs += rhs; break;
+    case Op::Sub: lhs -= rhs; break;
+    case Op::Mul: lhs *= rhs; break;
+    case Op::Div: lhs = rhs == 0 ? 0 : lhs / rhs; break;
+    case Op::Mod: lhs = rhs == 0 ? 0 : lhs % rhs; break;
+    case Op::And: lhs &= rhs; break;
+    case Op::Or: lhs |= rhs; break;
+    case Op::SignExtend: lhs = vsrtl::signextend(lhs, rhs); break;
+    case Op::Eq: lhs = lhs == rhs; break;
+    case Op::Ne: lhs = lhs != rhs; break;
+    case Op::Lt: lhs = lhs < rhs; break;
+    case Op::Le: lhs = lhs <= rhs; break;
+    case Op::Gt: lhs = lhs > rhs; break;
+    case Op::Ge: lhs = lhs >= rhs; break;
+    default: Q_UNREACHABLE();
+      // clang-format on
+    }
+  }
+  return top == 0 ? 0 : stack[top - 1];
+}
 
 bool couldBeExpression(const QString &s) {
   return std::any_of(s_exprTokens.begin(), s_exprTokens.end(),
@@ -3,7 +3,10 @@
 #include "assembler_defines.h"
 #include "isa/symbolmap.h"
 #include <QRegularExpression>
+#include <functional>
+#include <optional>
 #include <variant>
+#include <vector>
 
 namespace Ripes {
 namespace Assembler {
@@ -25,6 +28,70 @@ using ExprEvalRes = Result<ExprEvalVT>;
 ExprEvalRes evaluate(const Location &, const QString &,
                      const AbsoluteSymbolMap *variables = nullptr);
 
+/// Evaluates an expression with symbols resolved through @p symbols, with
+/// relative symbols resolved relative to the source line of the location.
+ExprEvalRes evaluate(const Location &, const QString &,
+                     const SymbolMap &symbols);
+
+/**
+ * @brief The CompiledExpr class
+ * An expression compiled into bytecode for a stack machine, for expressions
+ * which are evaluated many times against changing values, such as the
+ * conditions of breakpoints. Besides the operators of evaluate, the
+ * expression may compare two expressions through one of ==, !=, <, <=, > and
+ * >=, which evaluates to 1 or 0. Symbols are bound once upon compilation,
+ * either to a constant or to an operand, the value of which is read upon each
+ * evaluation.
+ */
+class CompiledExpr {
+public:
+  struct Binding {
+    enum Kind { Constant, Operand };
+    Kind kind = Constant;
+    /// The value of a constant, or the index of an operand.
+    ExprEvalVT value = 0;
+  };
+  using Binder = std::function<std::optional<Binding>(const QString &)>;
+  using Operands = std::function<ExprEvalVT(unsigned)>;
+
+  static Result<CompiledExpr> compile(const Location &, const QString &,
+                                      const Binder &binder);
+
+  /// Evaluates the expression, reading operand i through @p operands(i).
+  /// Division and remainder by zero evaluate to 0.
+  ExprEvalVT evaluate(const Operands &operands) const;
+
+  enum class Op : uint8_t {
+    Constant,
+    Operand,
+    Add,
+    Sub,
+    Mul,
+    Div,
+    Mod,
+    And,
+    Or,
+    SignExtend,
+    Eq,
+    Ne,
+    Lt,
+    Le,
+    Gt,
+    Ge
+  };
+  struct Instr {
+    Op op;
+    ExprEvalVT value = 0;
+  };
+  const std::vector<Instr> &code() const { return m_code; }
+
+  // Maximum depth of the evaluation stack, ie. of nested operators.
+  static constexpr unsigned s_maxDepth = 64;
+
+private:
+  std::vector<Instr> m_code;
+};
+
 /**
  * @brief couldBeExpression
  * @returns true if we have probably cause that the string is an expression and
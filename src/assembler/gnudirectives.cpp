@@ -1,6 +1,13 @@
 #include "gnudirectives.h"
 #include "assembler.h"
 
+#include <QFile>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
 namespace Ripes {
 namespace Assembler {
 
@@ -27,14 +34,20 @@ DirectiveVec gnuDirectives() {
   add_directive(directives, stringDirective());
   add_directive(directives, ascizDirective());
   add_directive(directives, zeroDirective());
+  add_directive(directives, spaceDirective(".space"));
+  add_directive(directives, spaceDirective(".skip"));
+  add_directive(directives, fillDirective());
+  add_directive(directives, incbinDirective());
   add_directive(directives, byteDirective());
-  add_directive(directives, doubleDirective());
+  add_directive(directives, dwordDirective());
   add_directive(directives, wordDirective());
   add_directive(directives, halfDirective());
   add_directive(directives, shortDirective());
   add_directive(directives, twoByteDirective());
   add_directive(directives, fourByteDirective());
   add_directive(directives, longDirective());
+  add_directive(directives, floatDirective());
+  add_directive(directives, doubleDirective());
   add_directive(directives, equDirective());
   add_directive(directives, alignDirective());
 
@@ -93,6 +106,45 @@ Result<QByteArray> dataFunctor(const AssemblerBase *assembler,
   }
 }
 
+/**
+ * @brief floatFunctor
+ * Assembles each argument as an IEEE 754 floating-point number of type @p T.
+ * Besides decimal numbers, the arguments may be "nan", "inf" and "-inf".
+ */
+template <typename T>
+Result<QByteArray> floatFunctor(const AssemblerBase *,
+                                const DirectiveArg &arg) {
+  if (arg.line.tokens.length() < 1) {
+    return {Error(arg.line, "Invalid number of arguments (expected >1)")};
+  }
+  QByteArray bytes;
+  for (const auto &token : arg.line.tokens) {
+    const QString str = QString(token).toLower();
+    T value;
+    if (str == "nan" || str == "+nan") {
+      value = std::numeric_limits<T>::quiet_NaN();
+    } else if (str == "inf" || str == "+inf") {
+      value = std::numeric_limits<T>::infinity();
+    } else if (str == "-inf") {
+      value = -std::numeric_limits<T>::infinity();
+    } else {
+      bool ok;
+      value = static_cast<T>(str.toDouble(&ok));
+      if (!ok) {
+        return {Error(arg.line,
+                      QString("Invalid floating-point value '%1'").arg(str))};
+      }
+    }
+    char raw[sizeof(T)];
+    std::memcpy(raw, &value, sizeof(T));
+    // Values are stored in little-endian order, such as integer data.
+    if constexpr (Q_BYTE_ORDER == Q_BIG_ENDIAN)
+      std::reverse(std::begin(raw), std::end(raw));
+    bytes.append(raw, sizeof(T));
+  }
+  return {bytes};
+}
+
 Result<QByteArray> stringFunctor(const AssemblerBase *,
                                  const DirectiveArg &arg) {
   if (arg.line.tokens.length() != 1) {
@@ -108,7 +160,15 @@ Directive ascizDirective() { return Directive(".asciz", &stringFunctor); }
 
 Directive byteDirective() { return Directive(".byte", &dataFunctor<1>); }
 
-Directive doubleDirective() { return Directive(".dword", &dataFunctor<8>); }
+Directive dwordDirective() { return Directive(".dword", &dataFunctor<8>); }
+
+Directive floatDirective() {
+  return Directive(".float", &floatFunctor<float>);
+}
+
+Directive doubleDirective() {
+  return Directive(".double", &floatFunctor<double>);
+}
 
 Directive wordDirective() { return Directive(".word", &dataFunctor<4>); }
 
@@ -169,13 +229,155 @@ Directive zeroDirective() {
     }
     int64_t value;
     getImmediateErroring(arg.line.tokens.at(0), value, arg.line);
-    QByteArray bytes;
-    bytes.fill(0x0, value);
-    return {bytes};
+    if (value < 0) {
+      return {Error(arg.line, ".zero size must be positive")};
+    }
+    arg.section->reserve(value);
+    return {QByteArray()};
   };
   return Directive(".zero", zeroFunctor);
 }
 
+/**
+ * @brief spaceDirective
+ * Generates the directive @p name (.space or .skip), which emits <size> bytes
+ * of the value <fill> (default 0). Zero bytes are reserved rather than
+ * materialized (see ProgramSection::reserve).
+ */
+Directive spaceDirective(const QString &name) {
+  auto spaceFunctor = [name](const AssemblerBase *assembler,
+                             const DirectiveArg &arg) -> Result<QByteArray> {
+    if (arg.line.tokens.length() == 0 || arg.line.tokens.length() > 2) {
+      return {Error(
+          arg.line,
+          "Invalid number of arguments (expected at least 1, at most 2)")};
+    }
+    int64_t size, fill = 0;
+    getImmediateErroring(arg.line.tokens.at(0), size, arg.line);
+    if (arg.line.tokens.size() > 1) {
+      getImmediateErroring(arg.line.tokens.at(1), fill, arg.line);
+    }
+    if (size < 0) {
+      return {Error(arg.line, name + " size must be positive")};
+    }
+    if (fill < 0 || fill > UINT8_MAX) {
+      return {Error(arg.line, name + " fill value must be in range [0;255]")};
+    }
+    if (fill == 0) {
+      arg.section->reserve(size);
+      return {QByteArray()};
+    }
+    return {QByteArray(size, static_cast<char>(fill))};
+  };
+  return Directive(name, spaceFunctor);
+}
+
+/**
+ * @brief fillDirective
+ * .fill <repeat>[, <size>[, <value>]] emits <repeat> copies of the
+ * little-endian <size>-byte (default 1, at most 8) <value> (default 0). As for
+ * .space, zero values are reserved rather than materialized.
+ */
+Directive fillDirective() {
+  auto fillFunctor = [](const AssemblerBase *assembler,
+                        const DirectiveArg &arg) -> Result<QByteArray> {
+    if (arg.line.tokens.length() == 0 || arg.line.tokens.length() > 3) {
+      return {Error(
+          arg.line,
+          "Invalid number of arguments (expected at least 1, at most 3)")};
+    }
+    int64_t repeat, size = 1, value = 0;
+    getImmediateErroring(arg.line.tokens.at(0), repeat, arg.line);
+    if (arg.line.tokens.size() > 1) {
+      getImmediateErroring(arg.line.tokens.at(1), size, arg.line);
+    }
+    if (arg.line.tokens.size() > 2) {
+      getImmediateErroring(arg.line.tokens.at(2), value, arg.line);
+    }
+    if (repeat < 0) {
+      return {Error(arg.line, ".fill repeat count must be positive")};
+    }
+    if (size < 0 || size > 8) {
+      return {Error(arg.line, ".fill size must be in range [0;8]")};
+    }
+    if (value == 0) {
+      arg.section->reserve(repeat * size);
+      return {QByteArray()};
+    }
+    QByteArray pattern;
+    for (int64_t i = 0; i < size; ++i) {
+      pattern.append(static_cast<char>(value & 0xff));
+      value >>= 8;
+    }
+    return {pattern.repeated(repeat)};
+  };
+  return Directive(".fill", fillFunctor);
+}
+
+/**
+ * @brief incbinDirective
+ * .incbin "<file>"[, <skip>[, <count>]] places <count> bytes (default: up to
+ * the end of the file) of the file, starting at offset <skip>, in the current
+ * section. The file is memory-mapped and copied into the section, without
+ * being tokenized. Relative paths are resolved against the working directory.
+ */
+Directive incbinDirective() {
+  auto incbinFunctor = [](const AssemblerBase *assembler,
+                          const DirectiveArg &arg) -> Result<QByteArray> {
+    if (arg.line.tokens.length() == 0 || arg.line.tokens.length() > 3) {
+      return {Error(
+          arg.line,
+          "Invalid number of arguments (expected at least 1, at most 3)")};
+    }
+    QString path = arg.line.tokens.at(0);
+    path.remove('\"');
+    int64_t skip = 0, count = -1;
+    if (arg.line.tokens.size() > 1) {
+      getImmediateErroring(arg.line.tokens.at(1), skip, arg.line);
+    }
+    if (arg.line.tokens.size() > 2) {
+      getImmediateErroring(arg.line.tokens.at(2), count, arg.line);
+      if (count < 0) {
+        return {Error(arg.line, ".incbin count must be positive")};
+      }
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+      return {Error(arg.line, "Could not open file '" + path + "'")};
+    }
+    const int64_t fileSize = file.size();
+    if (skip < 0 || skip > fileSize) {
+      return {Error(arg.line,
+                    QString(".incbin skip must be in range [0;%1]")
+                        .arg(fileSize))};
+    }
+    if (count < 0) {
+      count = fileSize - skip;
+    } else if (count > fileSize - skip) {
+      return {Error(arg.line, QString(".incbin of %1 bytes at offset %2 "
+                                      "exceeds the %3 bytes of '%4'")
+                                  .arg(count)
+                                  .arg(skip)
+                                  .arg(fileSize)
+                                  .arg(path))};
+    }
+    if (count == 0) {
+      return {QByteArray()};
+    }
+    // The mapping is valid until the file is closed, and is therefore
+    // appended to the section directly.
+    const uchar *bytes = file.map(skip, count);
+    if (!bytes) {
+      return {Error(arg.line, "Could not map file '" + path + "'")};
+    }
+    arg.section->append(QByteArray::fromRawData(
+        reinterpret_cast<const char *>(bytes), count));
+    return {QByteArray()};
+  };
+  return Directive(".incbin", incbinFunctor);
+}
+
 Directive equDirective() {
   auto equFunctor = [](const AssemblerBase *assembler,
                        const DirectiveArg &arg) -> Result<QByteArray> {
@@ -227,8 +429,8 @@ Directive alignDirective() {
     if (boundary == 0) {
       return {QByteArray()};
     }
-    int byteOffset =
-        (arg.section->address + arg.section->data.size()) % boundary;
+    arg.section->alignment = std::lcm<AInt>(arg.section->alignment, boundary);
+    int byteOffset = (arg.section->address + arg.section->size()) % boundary;
     int bytesToSkip = byteOffset != 0 ? boundary - byteOffset : 0;
     if (max > 0 && bytesToSkip > max) {
       return {QByteArray()};
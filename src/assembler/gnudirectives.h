@@ -15,14 +15,19 @@ namespace Assembler {
 DirectiveVec gnuDirectives();
 
 Directive zeroDirective();
+Directive spaceDirective(const QString &name);
+Directive fillDirective();
+Directive incbinDirective();
 Directive stringDirective();
 Directive ascizDirective();
 
-Directive doubleDirective();
+Directive dwordDirective();
 Directive wordDirective();
 Directive halfDirective();
 Directive shortDirective();
 Directive byteDirective();
+Directive floatDirective();
+Directive doubleDirective();
 Directive twoByteDirective();
 Directive fourByteDirective();
 Directive longDirective();
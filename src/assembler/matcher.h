@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <numeric>
@@ -25,6 +26,7 @@ class Matcher {
     std::vector<MatchNode> children;
     std::shared_ptr<InstructionBase> instruction;
     void matchOnExtraMatchConds() { m_matchOnExtraMatchConds = true; }
+    bool matchesOnExtraMatchConds() const { return m_matchOnExtraMatchConds; }
 
     bool matches(const Instr_T &instr) const {
       return m_matchOnExtraMatchConds ? instruction->matchesWithExtras(instr)
@@ -68,13 +70,55 @@ class Matcher {
     }
   };
 
+  /// An instruction of the dispatch table, matched by the bits of the OpParts
+  /// along its path in the match tree.
+  struct DispatchLeaf {
+    Instr_T mask;
+    Instr_T value;
+    const InstructionBase *instruction;
+  };
+
+  /// A contiguous range of instruction bits forming part of a dispatch key.
+  struct KeyRange {
+    unsigned shift;
+    Instr_T mask;
+    unsigned offset;
+  };
+
+  /// A level of the dispatch table, indexed by the key formed by its ranges.
+  struct DispatchLevel {
+    std::vector<KeyRange> key;
+    size_t firstSlot;
+  };
+
+  /// A slot either refers to the next level of the dispatch table, or to the
+  /// leaves [begin, end) which are checked in order.
+  struct DispatchSlot {
+    int next = -1;
+    unsigned begin = 0;
+    unsigned end = 0;
+  };
+
 public:
   Matcher(const std::vector<std::shared_ptr<InstructionBase>> &instructions)
-      : m_matchRoot(buildMatchTree(instructions)) {}
+      : m_matchRoot(buildMatchTree(instructions)) {
+    buildDispatchTable();
+  }
   void print() const { m_matchRoot.print(); }
 
   Result<const InstructionBase *>
   matchInstruction(const Instr_T &instruction) const {
+    auto match = matchInstructionTable(instruction);
+    if (match == nullptr) {
+      return Error(0, "Unknown instruction");
+    }
+    return match;
+  }
+
+  /// Matches @p instruction by walking the match tree. Equivalent to
+  /// matchInstruction, which uses the dispatch table derived from the tree.
+  Result<const InstructionBase *>
+  matchInstructionTree(const Instr_T &instruction) const {
     auto match = matchInstructionRec(instruction, m_matchRoot, true);
     if (match == nullptr) {
       return Error(0, "Unknown instruction");
@@ -83,6 +127,136 @@ public:
   }
 
 private:
+  /**
+   * @brief matchInstructionTable
+   * Each level of the dispatch table is indexed by the instruction bits which
+   * are identifying for all instructions reaching that level, i.e. the opcode
+   * (or compressed quadrant) at the first levels and the funct fields below.
+   * Matching an instruction is thus a few indexed loads, followed by checking
+   * the few instructions which remain in the final slot.
+   */
+  const InstructionBase *matchInstructionTable(Instr_T instruction) const {
+    const DispatchSlot *slot = &m_rootSlot;
+    while (slot->next >= 0) {
+      const DispatchLevel &level = m_levels[slot->next];
+      size_t key = 0;
+      for (const auto &range : level.key)
+        key |= ((instruction >> range.shift) & range.mask) << range.offset;
+      slot = &m_slots[level.firstSlot + key];
+    }
+    for (unsigned i = slot->begin; i < slot->end; ++i) {
+      const auto &leaf = m_leaves[i];
+      if ((instruction & leaf.mask) == leaf.value &&
+          leaf.instruction->matchesWithExtras(instruction))
+        return leaf.instruction;
+    }
+    return nullptr;
+  }
+
+  /// Flattens the match tree into leaves in the order in which
+  /// matchInstructionRec visits them, such that the first matching leaf is
+  /// the instruction matched by the tree.
+  static void collectLeaves(const MatchNode &node, Instr_T mask, Instr_T value,
+                            bool isRoot, std::vector<DispatchLeaf> &leaves) {
+    if (!isRoot && !node.matchesOnExtraMatchConds()) {
+      const Instr_T partMask = node.match.range.getMask()
+                               << node.match.range.start;
+      const Instr_T partValue = node.match.range.apply(node.match.value);
+      // OpParts on the path which disagree on a bit can never match.
+      if ((mask & partMask) & (value ^ partValue))
+        return;
+      mask |= partMask;
+      value |= partValue;
+    }
+    if (!node.children.empty()) {
+      for (const auto &child : node.children)
+        collectLeaves(child, mask, value, false, leaves);
+    } else if (node.instruction) {
+      leaves.push_back({mask, value, node.instruction.get()});
+    }
+  }
+
+  void buildDispatchTable() {
+    std::vector<DispatchLeaf> leaves;
+    collectLeaves(m_matchRoot, 0, 0, true, leaves);
+    m_rootSlot = buildDispatchSlot(leaves, 0);
+  }
+
+  /// Returns the slot dispatching @p leaves, of which the bits in @p usedBits
+  /// have already been dispatched on.
+  DispatchSlot buildDispatchSlot(const std::vector<DispatchLeaf> &leaves,
+                                 Instr_T usedBits) {
+    Instr_T common = ~usedBits;
+    for (const auto &leaf : leaves)
+      common &= leaf.mask;
+
+    if (leaves.size() <= 1 || common == 0) {
+      DispatchSlot slot;
+      slot.begin = m_leaves.size();
+      m_leaves.insert(m_leaves.end(), leaves.begin(), leaves.end());
+      slot.end = m_leaves.size();
+      return slot;
+    }
+
+    // Dispatch on (at most s_maxKeyBits of) the bits which every leaf
+    // constrains, grouped into contiguous ranges.
+    DispatchLevel level;
+    unsigned keyBits = 0;
+    Instr_T keyMask = 0;
+    for (unsigned bit = 0; bit < sizeof(Instr_T) * 8; ++bit) {
+      if (!((common >> bit) & 1))
+        continue;
+      if (keyBits == s_maxKeyBits)
+        break;
+      if (keyBits != 0 && ((keyMask >> (bit - 1)) & 1)) {
+        level.key.back().mask = (level.key.back().mask << 1) | 1;
+      } else {
+        level.key.push_back({bit, 1, keyBits});
+      }
+      keyMask |= Instr_T(1) << bit;
+      keyBits++;
+    }
+
+    const auto keyOf = [&](Instr_T value) {
+      size_t key = 0;
+      for (const auto &range : level.key)
+        key |= ((value >> range.shift) & range.mask) << range.offset;
+      return key;
+    };
+
+    // Group the leaves per key, retaining their order within each group.
+    std::vector<std::pair<size_t, DispatchLeaf>> keyed;
+    for (const auto &leaf : leaves)
+      keyed.push_back({keyOf(leaf.value), leaf});
+    std::stable_sort(keyed.begin(), keyed.end(),
+                     [](const auto &a, const auto &b) {
+                       return a.first < b.first;
+                     });
+
+    const int levelIdx = m_levels.size();
+    level.firstSlot = m_slots.size();
+    const size_t firstSlot = level.firstSlot;
+    m_levels.push_back(level);
+    m_slots.resize(m_slots.size() + (size_t(1) << keyBits));
+
+    for (auto it = keyed.begin(); it != keyed.end();) {
+      auto groupEnd = std::find_if(it, keyed.end(), [&](const auto &entry) {
+        return entry.first != it->first;
+      });
+      std::vector<DispatchLeaf> group;
+      for (auto leafIt = it; leafIt != groupEnd; ++leafIt)
+        group.push_back(leafIt->second);
+      // m_slots may be reallocated while building the group.
+      const DispatchSlot slot = buildDispatchSlot(group, usedBits | keyMask);
+      m_slots[firstSlot + it->first] = slot;
+      it = groupEnd;
+    }
+
+    DispatchSlot slot;
+    slot.next = levelIdx;
+    return slot;
+  }
+
   const InstructionBase *matchInstructionRec(const Instr_T &instruction,
                                              const MatchNode &node,
                                              bool isRoot) const {
@@ -168,6 +342,14 @@ private:
   }
 
   MatchNode m_matchRoot;
+
+  // Maximum number of bits dispatched on by a single level of the dispatch
+  // table.
+  static constexpr unsigned s_maxKeyBits = 12;
+  DispatchSlot m_rootSlot;
+  std::vector<DispatchLevel> m_levels;
+  std::vector<DispatchSlot> m_slots;
+  std::vector<DispatchLeaf> m_leaves;
 };
 
 } // namespace Assembler
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace Ripes {
+
+/**
+ * @brief parallelFor
+ * Calls @p f(begin, end) for consecutive chunks of the range [0, @p n), one
+ * chunk per hardware thread, with each chunk spanning at least @p minChunk
+ * elements. The first chunk is processed by the calling thread. Returns once
+ * all chunks have been processed. Ranges spanning a single chunk are processed
+ * by the calling thread only, such that small inputs do not incur the cost of
+ * starting threads.
+ */
+template <typename F>
+void parallelFor(size_t n, size_t minChunk, const F &f) {
+  const size_t threads = std::max(1u, std::thread::hardware_concurrency());
+  const size_t chunks =
+      std::min(threads, (n + minChunk - 1) / std::max<size_t>(minChunk, 1));
+  if (chunks <= 1) {
+    f(size_t(0), n);
+    return;
+  }
+
+  const size_t chunkSize = (n + chunks - 1) / chunks;
+  std::vector<std::thread> workers;
+  workers.reserve(chunks - 1);
+  for (size_t begin = chunkSize; begin < n; begin += chunkSize) {
+    const size_t end = std::min(n, begin + chunkSize);
+    workers.emplace_back([&f, begin, end] { f(begin, end); });
+  }
+  f(size_t(0), std::min(n, chunkSize));
+  for (auto &worker : workers)
+    worker.join();
+}
+
+/**
+ * @brief parallelFor
+ * Calls @p f(i) for each index i in [0, @p n), from one thread per core.
+ * Contrary to the chunked variant, indices are handed out one at a time and in
+ * order, such that calls of varying duration, as whole test programs, do not
+ * hold up the remaining indices.
+ */
+template <typename F>
+void parallelFor(size_t n, const F &f) {
+  std::atomic<size_t> next = 0;
+  const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+  const size_t nThreads = std::min(n, cores);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < nThreads; ++i) {
+    threads.emplace_back([&] {
+      for (size_t idx = next++; idx < n; idx = next++)
+        f(idx);
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+}
+
+} // namespace Ripes
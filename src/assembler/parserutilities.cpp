@@ -20,32 +20,55 @@ bool matchedParens(std::vector<QChar> &parensStack, QChar end) {
   return (toMatch == '[' && end == ']') || (toMatch == '(' && end == ')');
 }
 
+/// Returns the concatenation of @p pieces, allocated once.
+static QString joinViews(const std::vector<QStringView> &pieces) {
+  if (pieces.size() == 1)
+    return pieces.front().toString();
+  qsizetype length = 0;
+  for (const auto &piece : pieces)
+    length += piece.size();
+  QString joined;
+  joined.reserve(length);
+  for (const auto &piece : pieces)
+    joined.append(piece);
+  return joined;
+}
+
 Result<LineTokens> joinParentheses(const Location &loc,
-                                   const QStringList &tokens) {
+                                   const std::vector<QStringView> &tokens) {
   LineTokens outtokens;
+  outtokens.reserve(tokens.size());
   std::vector<QChar> parensStack;
 
-  QString tokenBuffer;
+  // Pieces of the token being joined, excluding top-level parentheses.
+  std::vector<QStringView> pieces;
   auto commitBuffer = [&]() {
-    if (!tokenBuffer.isEmpty()) {
-      outtokens << Token(tokenBuffer);
-      tokenBuffer.clear();
+    if (!pieces.empty()) {
+      outtokens << Token(joinViews(pieces));
+      pieces.clear();
     }
   };
 
   for (const auto &token : tokens) {
-    if (token.startsWith("\"") && token.endsWith("\"")) {
+    if (token.startsWith('"') && token.endsWith('"')) {
       // String literal; ignore parentheses inside
-      outtokens << Token(token);
+      outtokens << Token(token.toString());
       continue;
     }
-    for (const auto &ch : token) {
+    // Start of the run of characters of the token not yet added to pieces.
+    qsizetype begin = 0;
+    auto addRun = [&](qsizetype end) {
+      if (end > begin)
+        pieces.push_back(token.sliced(begin, end - begin));
+      begin = end + 1;
+    };
+    for (qsizetype i = 0; i < token.size(); ++i) {
+      const QChar ch = token.at(i);
       switch (ch.unicode()) {
       case '(':
       case '[':
-        if (!parensStack.empty()) {
-          tokenBuffer.append(ch);
-        } else {
+        if (parensStack.empty()) {
+          addRun(i);
           commitBuffer();
         }
         parensStack.push_back(ch);
@@ -54,9 +77,8 @@ Result<LineTokens> joinParentheses(const Location &loc,
       case ')': {
         if (matchedParens(parensStack, ch)) {
           if (parensStack.empty()) {
+            addRun(i);
             commitBuffer();
-          } else {
-            tokenBuffer.append(ch);
           }
         } else {
           return {Error(loc, "Unmatched parenthesis")};
@@ -64,10 +86,10 @@ Result<LineTokens> joinParentheses(const Location &loc,
         break;
       }
       default:
-        tokenBuffer.append(ch);
         break;
       }
     }
+    addRun(token.size());
     if (parensStack.empty()) {
       commitBuffer();
     }
@@ -80,36 +102,36 @@ Result<LineTokens> joinParentheses(const Location &loc,
   }
 }
 
-Result<QStringList> tokenizeQuotes(const Location &location,
-                                   const QString &line) {
-  QStringList tokens;
+Result<std::vector<QStringView>> tokenizeQuotes(const Location &location,
+                                                QStringView line) {
+  std::vector<QStringView> tokens;
   bool inQuotes = false;
   bool escape = false;
-  QString substr;
-  auto pushSubstr = [&] {
-    tokens.push_back(substr);
-    substr.clear();
+  // Start of the current token.
+  qsizetype begin = 0;
+  auto pushToken = [&](qsizetype end) {
+    if (end > begin)
+      tokens.push_back(line.sliced(begin, end - begin));
+    begin = end;
   };
-  for (auto &ch : line) {
+  for (qsizetype i = 0; i < line.size(); ++i) {
+    const QChar ch = line.at(i);
     if (inQuotes) {
       if (!escape) {
-        if (inQuotes && ch == '"') {
+        if (ch == '"') {
           inQuotes = false;
-          substr += ch;
-          pushSubstr();
+          pushToken(i + 1);
           continue;
         }
         if (ch == '\\')
           escape = true;
       } else
         escape = false;
-      substr.push_back(ch);
     } else {
       if (ch == ' ' || ch == ',' || ch == '\t') {
-        if (!substr.isEmpty())
-          pushSubstr();
-      } else
-        substr.push_back(ch);
+        pushToken(i);
+        begin = i + 1;
+      }
       if (ch == '\"')
         inQuotes = true;
     }
@@ -118,8 +140,7 @@ Result<QStringList> tokenizeQuotes(const Location &location,
   if (inQuotes)
     return {Error(location, "Missing terminating '\"' character.")};
 
-  tokens.push_back(substr);
-  tokens.removeAll(QLatin1String(""));
+  pushToken(line.size());
   return {tokens};
 }
 
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <QStringList>
+#include <QStringView>
 #include <variant>
+#include <vector>
 
 #include "assembler_defines.h"
 #include "isa/isa_defines.h"
@@ -14,12 +16,14 @@ namespace Assembler {
  * @brief joinParentheses takes a number of tokens and merges together tokens
  * contained within top-level parentheses. For example: [lw, x10, (B, +,
  * (3*2))(x10)] => [lw, x10, B + 3*2), x10]
+ * Each resulting token is allocated once, from the views of @p tokens.
  */
 Result<LineTokens> joinParentheses(const Location &location,
-                                   const QStringList &tokens);
+                                   const std::vector<QStringView> &tokens);
 
-/// Quote-aware string tokenization.
-Result<QStringList> tokenizeQuotes(const Location &location,
-                                   const QString &line);
+/// Quote-aware string tokenization. The tokens are views into @p line, such
+/// that no strings are allocated.
+Result<std::vector<QStringView>> tokenizeQuotes(const Location &location,
+                                                QStringView line);
 } // namespace Assembler
 } // namespace Ripes
@@ -2,8 +2,21 @@
 
 #include "processorhandler.h"
 
+#include <algorithm>
+#include <cstring>
+
 namespace Ripes {
 
+void ProgramSection::append(const QByteArray &bytes) {
+  if (bytes.isEmpty())
+    return;
+  if (zeroBytes != 0) {
+    data.append(QByteArray(zeroBytes, 0));
+    zeroBytes = 0;
+  }
+  data.append(bytes);
+}
+
 const ProgramSection *Program::getSection(const QString &name) const {
   const auto secIter =
       std::find_if(sections.begin(), sections.end(),
@@ -16,49 +29,135 @@ const ProgramSection *Program::getSection(const QString &name) const {
   return &secIter->second;
 }
 
+void DisassembledProgram::setLayout(VInt base, unsigned count,
+                                    unsigned instrBytes,
+                                    const DisassembleFunc &disassemble) {
+  clear();
+  m_base = base;
+  m_count = count;
+  m_instrBytes = instrBytes;
+  m_disassemble = disassemble;
+}
+
+void DisassembledProgram::setLayout(VInt base, std::vector<uint32_t> offsets,
+                                    const DisassembleFunc &disassemble) {
+  clear();
+  m_base = base;
+  m_count = offsets.size();
+  m_offsets = std::move(offsets);
+  m_disassemble = disassemble;
+  // Instructions are located in constant time if they are all halfword
+  // aligned, as is the case for compressed programs.
+  if (!m_offsets.empty() &&
+      std::all_of(m_offsets.begin(), m_offsets.end(),
+                  [](uint32_t offset) { return offset % 2 == 0; })) {
+    m_halfwordIndex.assign(m_offsets.back() / 2 + 1, s_noIndex);
+    for (unsigned idx = 0; idx < m_count; ++idx)
+      m_halfwordIndex[m_offsets[idx] / 2] = idx;
+  }
+}
+
 void DisassembledProgram::clear() {
-  addressToDisresMap.clear();
-  indexToAddressMap.clear();
-  addressToIndexMap.clear();
+  m_base = 0;
+  m_count = 0;
+  m_instrBytes = 0;
+  m_offsets.clear();
+  m_halfwordIndex.clear();
+  m_disassemble = nullptr;
+  m_pages.clear();
+  m_pageIndex.clear();
 }
 
-bool DisassembledProgram::empty() const { return addressToDisresMap.empty(); }
+bool DisassembledProgram::empty() const { return !m_disassemble; }
 
-std::optional<VInt> DisassembledProgram::indexToAddress(unsigned idx) const {
-  auto it = indexToAddressMap.find(idx);
-  if (it != indexToAddressMap.end())
-    return it->second;
-  return std::nullopt;
+size_t DisassembledProgram::bytes() const {
+  size_t bytes = m_offsets.capacity() * sizeof(uint32_t) +
+                 m_halfwordIndex.capacity() * sizeof(unsigned);
+  for (const auto &[idx, page] : m_pages) {
+    bytes += page.capacity() * sizeof(QString);
+    for (const auto &instr : page)
+      bytes += instr.capacity() * sizeof(QChar);
+  }
+  return bytes;
 }
 
-std::optional<unsigned> DisassembledProgram::addressToIndex(VInt addr) const {
-  auto it = addressToIndexMap.find(addr);
-  if (it != addressToIndexMap.end())
-    return it->second;
-  return std::nullopt;
+std::optional<VInt> DisassembledProgram::indexToAddress(unsigned idx) const {
+  if (idx >= m_count)
+    return std::nullopt;
+  return m_base + (m_instrBytes != 0 ? VInt(idx) * m_instrBytes
+                                     : VInt(m_offsets[idx]));
 }
 
-void DisassembledProgram::set(unsigned int idx, VInt address,
-                              const QString &disres) {
-  assert(indexToAddressMap.count(idx) == 0);
-  assert(addressToDisresMap.count(address) == 0);
-  indexToAddressMap[idx] = address;
-  addressToIndexMap[address] = idx;
-  addressToDisresMap[address] = disres;
+std::optional<unsigned> DisassembledProgram::addressToIndex(VInt addr) const {
+  if (addr < m_base)
+    return std::nullopt;
+  const VInt offset = addr - m_base;
+  if (m_instrBytes != 0) {
+    if (offset % m_instrBytes != 0 || offset / m_instrBytes >= m_count)
+      return std::nullopt;
+    return offset / m_instrBytes;
+  }
+  if (!m_halfwordIndex.empty()) {
+    if (offset % 2 != 0 || offset / 2 >= m_halfwordIndex.size() ||
+        m_halfwordIndex[offset / 2] == s_noIndex)
+      return std::nullopt;
+    return m_halfwordIndex[offset / 2];
+  }
+  auto it = std::lower_bound(m_offsets.begin(), m_offsets.end(), offset);
+  if (it == m_offsets.end() || *it != offset)
+    return std::nullopt;
+  return it - m_offsets.begin();
 }
 
 std::optional<QString> DisassembledProgram::getFromAddr(VInt address) const {
-  auto it = addressToDisresMap.find(address);
-  if (it != addressToDisresMap.end())
-    return {it->second};
+  if (auto idx = addressToIndex(address))
+    return getFromIdx(*idx);
   return {};
 }
 
 std::optional<QString> DisassembledProgram::getFromIdx(unsigned idx) const {
-  auto it = indexToAddressMap.find(idx);
-  if (it != indexToAddressMap.end())
-    return getFromAddr(it->second);
-  return {};
+  if (idx >= m_count)
+    return {};
+  return page(idx / s_pageSize).at(idx % s_pageSize);
+}
+
+const DisassembledProgram::Page &
+DisassembledProgram::page(unsigned pageIdx) const {
+  auto it = m_pageIndex.find(pageIdx);
+  if (it != m_pageIndex.end()) {
+    m_pages.splice(m_pages.begin(), m_pages, it->second);
+    return m_pages.front().second;
+  }
+
+  Page page;
+  const unsigned first = pageIdx * s_pageSize;
+  const unsigned last = std::min(m_count, first + s_pageSize);
+  page.reserve(last - first);
+  for (unsigned idx = first; idx < last; ++idx)
+    page.push_back(m_disassemble(*indexToAddress(idx)));
+
+  m_pages.emplace_front(pageIdx, std::move(page));
+  m_pageIndex[pageIdx] = m_pages.begin();
+  if (m_pages.size() > s_maxPages) {
+    m_pageIndex.erase(m_pages.back().first);
+    m_pages.pop_back();
+  }
+  return m_pages.front().second;
+}
+
+/// Returns the instruction word of @p bytes bytes at @p offset of @p data.
+/// Bytes beyond the end of @p data are read as zero.
+static VInt readInstrWord(const QByteArray &data, VInt offset, unsigned bytes) {
+  VInt word = 0;
+  const VInt available = std::min<VInt>(bytes, data.size() - offset);
+  std::memcpy(&word, data.constData() + offset, available);
+  return word;
+}
+
+const SymbolIndex &Program::symbolIndex() const {
+  if (!m_symbolIndex)
+    m_symbolIndex = std::make_shared<SymbolIndex>(symbols);
+  return *m_symbolIndex;
 }
 
 const DisassembledProgram &Program::getDisassembled() const {
@@ -68,31 +167,38 @@ const DisassembledProgram &Program::getDisassembled() const {
     return disassembled;
   }
   if (disassembled.empty()) {
-    auto &assembler = ProcessorHandler::getAssembler();
-    auto &memory = ProcessorHandler::getMemory();
-    auto &symbols = ProcessorHandler::getProgram()->symbols;
-
-    // Initialize caching
-    const unsigned instrBytes = ProcessorHandler::currentISA()->instrBytes();
-    const VInt textSectionBaseAddr = textSection->address;
-    unsigned line = 0;
-    for (AInt addr = 0;
-         addr < static_cast<AInt>(ProcessorHandler::getCurrentProgramSize());) {
-      const VInt disassembleAddr = addr + textSectionBaseAddr;
-      auto disRes =
-          assembler->disassemble(memory.readMem(disassembleAddr, instrBytes),
-                                 symbols, disassembleAddr);
-      // todo(mortbopet): shouldn't we do something about the possibility of the
-      // disassembling returning an error?
-      const VInt realAddr = textSectionBaseAddr + addr;
-      disassembled.set(line, realAddr, disRes.repr);
-      if (disRes.err.has_value()) {
-        // Error during disassembled; we'll just have to increment the address
-        // counter by the default instruction size of the ISA.
-        addr += instrBytes;
-      } else
-        addr += disRes.bytesDisassembled;
-      ++line;
+    const auto &isa = ProcessorHandler::currentISA();
+    const unsigned instrBytes = isa->instrBytes();
+    const VInt base = textSection->address;
+    const VInt size = textSection->data.size();
+
+    // Instructions are disassembled from the text section of this program,
+    // using the assembler of the processor at the time of disassembly.
+    const auto disassemble = [this, instrBytes](VInt address) {
+      const auto *text = getSection(TEXT_SECTION_NAME);
+      const VInt word =
+          readInstrWord(text->data, address - text->address, instrBytes);
+      return ProcessorHandler::getAssembler()
+          ->disassemble(word, symbols, address)
+          .repr;
+    };
+
+    if (isa->instrByteAlignment() == instrBytes) {
+      const unsigned count = (size + instrBytes - 1) / instrBytes;
+      disassembled.setLayout(base, count, instrBytes, disassemble);
+    } else {
+      // Variable-width instructions; locate each instruction by its size. An
+      // unknown instruction is skipped by the default instruction size of
+      // the ISA.
+      auto &assembler = ProcessorHandler::getAssembler();
+      std::vector<uint32_t> offsets;
+      for (VInt offset = 0; offset < size;) {
+        offsets.push_back(offset);
+        const unsigned bytes = assembler->instructionSize(
+            readInstrWord(textSection->data, offset, instrBytes));
+        offset += bytes != 0 ? bytes : instrBytes;
+      }
+      disassembled.setLayout(base, std::move(offsets), disassemble);
     }
   }
   return disassembled;
@@ -102,7 +208,26 @@ QString Program::calculateHash(const QByteArray &data) {
   return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
 }
 
+void Program::setSourceLoader(SourceLoader loader) {
+  m_sourceLoader = std::move(loader);
+}
+
+void Program::loadSource() const {
+  if (!m_sourceLoader)
+    return;
+  // The loader is released once called, along with any state it holds.
+  auto loader = std::move(m_sourceLoader);
+  m_sourceLoader = nullptr;
+  loader(sourceMapping, sourceHash);
+}
+
+const Program::SourceMapping &Program::getSourceMapping() const {
+  loadSource();
+  return sourceMapping;
+}
+
 bool Program::isSameSource(const QByteArray &data) const {
+  loadSource();
   /// We consider no source program to be equal to this program if no source
   /// hash has been set.
   if (sourceHash.isEmpty())
@@ -5,12 +5,18 @@
 #include <QMap>
 #include <QMetaType>
 #include <QString>
+#include <functional>
+#include <list>
+#include <memory>
 #include <optional>
 #include <set>
+#include <unordered_map>
 #include <vector>
 
 #include "isa/isa_defines.h"
 #include "isa/isa_types.h"
+#include "memoryfootprint.h"
+#include "symbolindex.h"
 
 namespace Ripes {
 
@@ -40,13 +46,53 @@ struct ProgramSection {
   QString name;
   AInt address;
   QByteArray data;
+  // Zero bytes following the data, which are not materialized. Memory which
+  // is not initialized reads as zero, such that large zero-filled regions
+  // occupy no memory until written.
+  AInt zeroBytes = 0;
+  // Alignment in bytes required of the address of the section, as requested
+  // by its .align directives. Only used when linking objects.
+  AInt alignment = 1;
+
+  /// Returns the size of the section, including its trailing zero bytes.
+  AInt size() const { return data.size() + zeroBytes; }
+  /// Appends @p bytes to the section, materializing its zero bytes first.
+  void append(const QByteArray &bytes);
+  /// Appends @p bytes zero bytes to the section, without materializing them.
+  void reserve(AInt bytes) { zeroBytes += bytes; }
 };
 
+/**
+ * @brief The DisassembledProgram class
+ * A lazily disassembled text section. Only the layout of the instructions is
+ * determined up front; as arithmetic for fixed-width instructions, or as a
+ * sorted vector of instruction offsets for variable-width instructions.
+ * Instructions are disassembled in pages of s_pageSize instructions upon first
+ * access, and the least recently used pages are evicted once more than
+ * s_maxPages pages are held.
+ */
 class DisassembledProgram {
 public:
-  /// Associates the given address and index with the disassembled instruction
-  /// string
-  void set(unsigned idx, VInt address, const QString &disres);
+  /// Returns the disassembled instruction at the given address.
+  using DisassembleFunc = std::function<QString(VInt address)>;
+
+  DisassembledProgram() = default;
+  // The disassembly refers to the program which owns it, and is therefore not
+  // copied along with the program.
+  DisassembledProgram(const DisassembledProgram &) {}
+  DisassembledProgram &operator=(const DisassembledProgram &) {
+    clear();
+    return *this;
+  }
+
+  /// Sets a layout of @p count instructions of @p instrBytes bytes, starting
+  /// at @p base.
+  void setLayout(VInt base, unsigned count, unsigned instrBytes,
+                 const DisassembleFunc &disassemble);
+  /// Sets a layout of instructions at the sorted @p offsets relative to
+  /// @p base.
+  void setLayout(VInt base, std::vector<uint32_t> offsets,
+                 const DisassembleFunc &disassemble);
 
   /// Returns the disassembled instruction for the given index.
   std::optional<QString> getFromIdx(unsigned idx) const;
@@ -63,16 +109,39 @@ public:
   /// Returns true if no disassembled program has been set.
   bool empty() const;
 
-  unsigned numInstructions() const { return indexToAddressMap.size(); }
+  unsigned numInstructions() const { return m_count; }
 
-private:
-  /// An ordered map of [instruction address : disassembled instruction]
-  std::map<VInt, QString> addressToDisresMap;
+  /// Returns the bytes held by the layout and the disassembled pages.
+  size_t bytes() const;
 
-  /// Ordered maps of the index of a given disassembled instruction to its
-  /// address.
-  std::map<unsigned, VInt> indexToAddressMap;
-  std::map<VInt, unsigned> addressToIndexMap;
+private:
+  using Page = std::vector<QString>;
+  using PageList = std::list<std::pair<unsigned, Page>>;
+  static constexpr unsigned s_pageSize = 256;
+  static constexpr unsigned s_maxPages = 64;
+
+  /// Returns the page of disassembled instructions containing index
+  /// @p pageIdx * s_pageSize, disassembling it if not already held.
+  const Page &page(unsigned pageIdx) const;
+
+  VInt m_base = 0;
+  unsigned m_count = 0;
+  // Width of all instructions, or 0 if instructions are located through
+  // m_offsets.
+  unsigned m_instrBytes = 0;
+  std::vector<uint32_t> m_offsets;
+  // Index of the instruction at each halfword offset, if all of m_offsets are
+  // halfword aligned.
+  static constexpr unsigned s_noIndex = ~0u;
+  std::vector<unsigned> m_halfwordIndex;
+  DisassembleFunc m_disassemble;
+
+  // Disassembled pages, in most recently used order.
+  mutable PageList m_pages;
+  mutable std::unordered_map<unsigned, PageList::iterator> m_pageIndex;
+
+  MemoryFootprint::Source m_footprint{MemoryFootprint::Disassembly,
+                                      [this] { return bytes(); }};
 };
 
 /**
@@ -87,32 +156,55 @@ public:
   // lines}
   using SourceMapping = std::map<VInt, std::set<unsigned>>;
 
+  /// Loads the source mapping and source hash of a program, such as from the
+  /// debug information of an ELF file.
+  using SourceLoader =
+      std::function<void(SourceMapping &mapping, QString &sourceHash)>;
+
   AInt entryPoint = 0;
   std::map<QString, ProgramSection> sections;
   ReverseSymbolMap symbols;
-  SourceMapping sourceMapping;
+  // The source mapping and source hash are mutable, since they may be loaded
+  // upon first use. Use getSourceMapping() and isSameSource() to read them.
+  mutable SourceMapping sourceMapping;
+  // Owner of memory referenced by the section data, such as a memory-mapped
+  // ELF file.
+  std::shared_ptr<const void> backing;
 
   // Hash of the source code which this program resulted from. Expected to be a
   // SHA-1 hash (fastest).
-  QString sourceHash;
+  mutable QString sourceHash;
   // Returns true if data is equal to the sourceHash of this program.
   bool isSameSource(const QByteArray &data) const;
 
+  /// Defers loading the source mapping and source hash to @p loader, which is
+  /// called upon the first use of either.
+  void setSourceLoader(SourceLoader loader);
+
   /// Returns the program section corresponding to the provided name. Return
   /// nullptr if no section was found with the given name.
   const ProgramSection *getSection(const QString &name) const;
 
-  /// Returns the disassembled version of this program. The result is an ordered
-  /// map of [instruction address : disassembled instruction]
+  /// Returns the disassembled version of this program. Instructions are
+  /// disassembled upon being accessed.
   const DisassembledProgram &getDisassembled() const;
   const SourceMapping &getSourceMapping() const;
 
+  /// Returns the index of the symbols of this program, which is built upon
+  /// first use. The symbols must not be modified thereafter.
+  const SymbolIndex &symbolIndex() const;
+
   /// Calculates a hash used for source identification.
   static QString calculateHash(const QByteArray &data);
 
 private:
+  void loadSource() const;
+
   /// A caching of the disassembled version of this program.
   mutable DisassembledProgram disassembled;
+  mutable SourceLoader m_sourceLoader;
+  // Shared by copies of the program, which share its symbols.
+  mutable std::shared_ptr<const SymbolIndex> m_symbolIndex;
 };
 
 } // namespace Ripes
@@ -0,0 +1,207 @@
+#include "programcache.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+namespace Ripes {
+namespace Assembler {
+
+namespace {
+
+constexpr quint32 c_programCacheMagic = 0x52504743; // "RPGC"
+constexpr quint32 c_programCacheVersion = 2;
+
+void writeProgram(QDataStream &out, const Program &program) {
+  out << c_programCacheMagic << c_programCacheVersion;
+  out << quint64(program.entryPoint) << program.sourceHash;
+
+  out << quint32(program.sections.size());
+  for (const auto &section : program.sections)
+    out << section.second.name << quint64(section.second.address)
+        << section.second.data << quint64(section.second.zeroBytes);
+
+  out << quint32(program.symbols.size());
+  for (const auto &symbol : program.symbols)
+    out << quint64(symbol.first) << symbol.second.v
+        << quint32(symbol.second.type);
+
+  out << quint32(program.sourceMapping.size());
+  for (const auto &mapping : program.sourceMapping) {
+    out << quint64(mapping.first) << quint32(mapping.second.size());
+    for (const unsigned line : mapping.second)
+      out << quint32(line);
+  }
+}
+
+bool readProgram(QDataStream &in, Program &program) {
+  quint32 magic, version;
+  in >> magic >> version;
+  if (magic != c_programCacheMagic || version != c_programCacheVersion)
+    return false;
+
+  quint64 entryPoint;
+  in >> entryPoint >> program.sourceHash;
+  program.entryPoint = entryPoint;
+
+  quint32 count;
+  in >> count;
+  for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+    ProgramSection section;
+    quint64 address, zeroBytes;
+    in >> section.name >> address >> section.data >> zeroBytes;
+    section.address = address;
+    section.zeroBytes = zeroBytes;
+    program.sections[section.name] = section;
+  }
+
+  in >> count;
+  for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+    quint64 address;
+    Symbol symbol;
+    quint32 type;
+    in >> address >> symbol.v >> type;
+    symbol.type = type;
+    program.symbols[address] = symbol;
+  }
+
+  in >> count;
+  for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+    quint64 address;
+    quint32 lines;
+    in >> address >> lines;
+    auto &mapping = program.sourceMapping[address];
+    for (quint32 j = 0; j < lines && in.status() == QDataStream::Ok; ++j) {
+      quint32 line;
+      in >> line;
+      mapping.insert(line);
+    }
+  }
+  return in.status() == QDataStream::Ok;
+}
+
+} // namespace
+
+QString ProgramCache::key(const QStringList &programLines,
+                          const ISAInfoBase &isa,
+                          const std::map<Section, AInt> &sectionBases,
+                          const SymbolMap *symbols) {
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+  // Fields are separated by characters which cannot occur within them, such
+  // that distinct inputs cannot hash identical byte sequences.
+  const auto add = [&](const QString &field) {
+    hash.addData(field.toUtf8());
+    hash.addData(QByteArrayView("\x1f", 1));
+  };
+
+  add(QString::number(programLines.size()));
+  for (const auto &line : programLines) {
+    add(line);
+    // The files included by .incbin are identified by their size and
+    // modification time, such that modified files are reassembled.
+    const int incbin = line.indexOf(".incbin");
+    if (incbin < 0)
+      continue;
+    const int begin = line.indexOf('"', incbin);
+    const int end = begin < 0 ? -1 : line.indexOf('"', begin + 1);
+    if (end < 0)
+      continue;
+    const QFileInfo file(line.mid(begin + 1, end - begin - 1));
+    add(QString::number(file.size()) + "@" +
+        QString::number(file.lastModified().toMSecsSinceEpoch()));
+  }
+
+  add(isa.name());
+  QStringList extensions = isa.enabledExtensions();
+  extensions.sort();
+  add(extensions.join(","));
+
+  for (const auto &base : sectionBases)
+    add(base.first + "=" + QString::number(base.second));
+
+  if (symbols) {
+    for (const auto &symbol : symbols->abs)
+      add(symbol.symbol.v + "=" + QString::number(symbol.value) + ":" +
+          QString::number(symbol.symbol.type));
+    for (const auto &relSymbol : symbols->rel)
+      for (const auto &def : relSymbol.second)
+        add(QString::number(relSymbol.first) + "@" +
+            QString::number(def.line) + "=" + QString::number(def.value));
+  }
+  return hash.result().toHex();
+}
+
+std::optional<Program> ProgramCache::find(const QString &key) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_index.find(key);
+  if (it != m_index.end()) {
+    m_entries.splice(m_entries.begin(), m_entries, it.value());
+    return m_entries.front().second;
+  }
+
+  if (m_directory.isEmpty())
+    return {};
+  QFile file(filePath(key));
+  if (!file.open(QIODevice::ReadOnly))
+    return {};
+  QDataStream in(&file);
+  Program program;
+  if (!readProgram(in, program))
+    return {};
+  insertInMemory(key, program);
+  return program;
+}
+
+void ProgramCache::insert(const QString &key, const Program &program) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  insertInMemory(key, program);
+
+  if (m_directory.isEmpty())
+    return;
+  // Written through a temporary file, such that concurrent runs of Ripes
+  // sharing the directory never observe a partially written program.
+  QSaveFile file(filePath(key));
+  if (!file.open(QIODevice::WriteOnly))
+    return;
+  QDataStream out(&file);
+  writeProgram(out, program);
+  file.commit();
+}
+
+void ProgramCache::setDirectory(const QString &path) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_directory = path;
+  if (!m_directory.isEmpty())
+    QDir().mkpath(m_directory);
+}
+
+void ProgramCache::clear() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_entries.clear();
+  m_index.clear();
+}
+
+QString ProgramCache::filePath(const QString &key) const {
+  return QDir(m_directory).filePath(key + ".rpc");
+}
+
+void ProgramCache::insertInMemory(const QString &key, const Program &program) {
+  auto it = m_index.find(key);
+  if (it != m_index.end()) {
+    m_entries.erase(it.value());
+    m_index.erase(it);
+  }
+  m_entries.emplace_front(key, program);
+  m_index.insert(key, m_entries.begin());
+  if (m_entries.size() > s_capacity) {
+    m_index.remove(m_entries.back().first);
+    m_entries.pop_back();
+  }
+}
+
+} // namespace Assembler
+} // namespace Ripes
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+#include <list>
+#include <map>
+#include <mutex>
+#include <optional>
+
+#include "assembler_defines.h"
+#include "isa/isainfo.h"
+#include "isa/symbolmap.h"
+#include "program.h"
+
+namespace Ripes {
+namespace Assembler {
+
+/**
+ * @brief The ProgramCache class
+ * A content-addressed cache of assembled programs. Programs are keyed by a
+ * hash of everything which determines the output of the assembler: the source
+ * lines, the size and modification time of the files they include, the ISA
+ * and its enabled extensions, the section base addresses and any predefined
+ * symbols. Only programs which assembled without errors are cached.
+ *
+ * The most recently used programs are kept in memory. If a directory is set,
+ * programs are furthermore persisted to disk, such that identical sources are
+ * not reassembled across runs of Ripes.
+ */
+class ProgramCache {
+public:
+  static ProgramCache &get() {
+    static ProgramCache cache;
+    return cache;
+  }
+
+  /// Returns the key identifying the assembly of @p programLines.
+  static QString key(const QStringList &programLines, const ISAInfoBase &isa,
+                     const std::map<Section, AInt> &sectionBases,
+                     const SymbolMap *symbols);
+
+  /// Returns the program cached for @p key, if any.
+  std::optional<Program> find(const QString &key);
+  void insert(const QString &key, const Program &program);
+
+  /// Sets the directory in which programs are persisted. An empty path
+  /// disables persistence.
+  void setDirectory(const QString &path);
+  /// Clears the in-memory cache. Persisted programs are retained.
+  void clear();
+
+private:
+  ProgramCache() {}
+  QString filePath(const QString &key) const;
+  void insertInMemory(const QString &key, const Program &program);
+
+  // Maximum number of programs kept in memory.
+  static constexpr unsigned s_capacity = 32;
+
+  std::mutex m_mutex;
+  // Cached programs, in most recently used order.
+  std::list<std::pair<QString, Program>> m_entries;
+  QHash<QString, std::list<std::pair<QString, Program>>::iterator> m_index;
+  QString m_directory;
+};
+
+} // namespace Assembler
+} // namespace Ripes
@@ -0,0 +1,89 @@
+#include "symbolindex.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace Ripes {
+
+namespace {
+
+/// Returns true if the characters of @p query appear in @p name in order.
+bool isSubsequence(const QString &query, const QString &name) {
+  int i = 0;
+  for (const QChar ch : name) {
+    if (i < query.size() && ch == query.at(i))
+      i++;
+  }
+  return i == query.size();
+}
+
+} // namespace
+
+SymbolIndex::SymbolIndex(const ReverseSymbolMap &symbols) {
+  m_entries.reserve(symbols.size());
+  m_folded.reserve(symbols.size());
+  for (const auto &[address, symbol] : symbols) {
+    m_entries.push_back({address, symbol.v});
+    m_folded.push_back(symbol.v.toCaseFolded());
+  }
+  m_byName.resize(m_entries.size());
+  std::iota(m_byName.begin(), m_byName.end(), 0u);
+  std::sort(m_byName.begin(), m_byName.end(), [&](unsigned a, unsigned b) {
+    if (m_folded[a] != m_folded[b])
+      return m_folded[a] < m_folded[b];
+    return m_entries[a].name < m_entries[b].name;
+  });
+}
+
+std::vector<unsigned>::const_iterator
+SymbolIndex::lowerBound(const QString &folded) const {
+  return std::lower_bound(m_byName.begin(), m_byName.end(), folded,
+                          [&](unsigned entry, const QString &key) {
+                            return m_folded[entry] < key;
+                          });
+}
+
+std::optional<AInt> SymbolIndex::address(const QString &name) const {
+  const QString folded = name.toCaseFolded();
+  auto it = lowerBound(folded);
+  for (; it != m_byName.end() && m_folded[*it] == folded; ++it) {
+    if (m_entries[*it].name == name)
+      return m_entries[*it].address;
+  }
+  return {};
+}
+
+std::vector<unsigned> SymbolIndex::withPrefix(const QString &prefix) const {
+  const QString folded = prefix.toCaseFolded();
+  auto it = lowerBound(folded);
+  std::vector<unsigned> matches;
+  for (; it != m_byName.end() && m_folded[*it].startsWith(folded); ++it)
+    matches.push_back(*it);
+  return matches;
+}
+
+std::vector<unsigned> SymbolIndex::search(const QString &query) const {
+  if (query.isEmpty()) {
+    std::vector<unsigned> all(m_entries.size());
+    std::iota(all.begin(), all.end(), 0u);
+    return all;
+  }
+
+  std::vector<unsigned> matches = withPrefix(query);
+  const QString folded = query.toCaseFolded();
+  std::vector<unsigned> fuzzy;
+  // Names are visited in name order, such that each kind of match is ordered.
+  for (const unsigned entry : m_byName) {
+    const QString &name = m_folded[entry];
+    if (name.startsWith(folded))
+      continue;
+    if (name.contains(folded))
+      matches.push_back(entry);
+    else if (isSubsequence(folded, name))
+      fuzzy.push_back(entry);
+  }
+  matches.insert(matches.end(), fuzzy.begin(), fuzzy.end());
+  return matches;
+}
+
+} // namespace Ripes
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <QString>
+
+#include <optional>
+#include <vector>
+
+#include "isa/isa_defines.h"
+
+namespace Ripes {
+
+/**
+ * @brief The SymbolIndex class
+ * An index of the symbols of a program, built once per program (see
+ * Program::symbolIndex). Symbols are held in address order, alongside their
+ * order by name, such that exact and prefix lookups are binary searches.
+ * Searches are case-insensitive.
+ */
+class SymbolIndex {
+public:
+  struct Entry {
+    AInt address = 0;
+    QString name;
+  };
+
+  explicit SymbolIndex(const ReverseSymbolMap &symbols);
+
+  /// Entries, in address order.
+  const std::vector<Entry> &entries() const { return m_entries; }
+
+  /// Returns the address of the symbol named @p name (case-sensitive).
+  std::optional<AInt> address(const QString &name) const;
+
+  /// Returns the indices of the entries whose name starts with @p prefix, in
+  /// name order.
+  std::vector<unsigned> withPrefix(const QString &prefix) const;
+
+  /**
+   * @brief search
+   * Returns the indices of the entries matching @p query. Names starting with
+   * @p query come first, followed by names containing it, followed by names
+   * containing its characters in order (e.g. "pst" matches "print_string").
+   * Matches are ordered by name within each of these kinds. An empty query
+   * matches all entries, in address order.
+   */
+  std::vector<unsigned> search(const QString &query) const;
+
+private:
+  /// Returns the first entry in name order whose folded name is not less than
+  /// @p folded.
+  std::vector<unsigned>::const_iterator lowerBound(const QString &folded) const;
+
+  std::vector<Entry> m_entries;
+  // Case-folded names, by entry.
+  std::vector<QString> m_folded;
+  // Entries, ordered by their folded and then by their exact name.
+  std::vector<unsigned> m_byName;
+};
+
+} // namespace Ripes
@@ -0,0 +1,179 @@
+#include "accesstrace.h"
+
+#include "binutils.h"
+
+#include <climits>
+
+namespace Ripes {
+
+static constexpr char s_magic[] = "RIPESMAT";
+static constexpr qint64 s_magicSize = sizeof(s_magic) - 1;
+static constexpr char s_version = 2;
+// Version 1 traces are identical, except for never recording the PC of data
+// accesses.
+static constexpr char s_minVersion = 1;
+static constexpr int s_bufferSize = 1 << 16;
+
+AccessTraceWriter::~AccessTraceWriter() { close(); }
+
+bool AccessTraceWriter::open(const QString &path, QString &errorMessage) {
+  close();
+  m_file.setFileName(path);
+  if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    errorMessage = "Failed to open access trace file '" + path + "'";
+    return false;
+  }
+  m_buffer.clear();
+  m_buffer.append(s_magic, s_magicSize);
+  m_buffer.append(s_version);
+  m_prevInstrAddress = 0;
+  m_prevDataAddress = 0;
+  m_prevDataPc = 0;
+  m_cycles = 0;
+  return true;
+}
+
+void AccessTraceWriter::close() {
+  if (!m_file.isOpen())
+    return;
+  flush();
+  m_file.close();
+}
+
+void AccessTraceWriter::flush() {
+  m_file.write(m_buffer);
+  m_buffer.clear();
+}
+
+void AccessTraceWriter::writeDelta(AInt address, AInt &previous) {
+  const AIntS delta = static_cast<AIntS>(address - previous);
+  previous = address;
+  // Zig-zag encoding maps small negative deltas to small unsigned values.
+  AInt value = (static_cast<AInt>(delta) << 1) ^
+               static_cast<AInt>(delta >> (sizeof(AInt) * CHAR_BIT - 1));
+  do {
+    uchar byte = value & 0x7F;
+    value >>= 7;
+    if (value != 0)
+      byte |= 0x80;
+    m_buffer.append(static_cast<char>(byte));
+  } while (value != 0);
+}
+
+void AccessTraceWriter::record(const MemoryAccess &instrAccess,
+                               const MemoryAccess &dataAccess) {
+  if (!m_file.isOpen())
+    return;
+
+  const bool hasInstr = instrAccess.type == MemoryAccess::Read;
+  const bool hasData = dataAccess.type != MemoryAccess::None;
+  const bool hasDataPc = hasData && dataAccess.pc != 0;
+  uchar flags = 0;
+  if (hasInstr)
+    flags |= 1 | (log2Ceil(instrAccess.bytes) & 0b11) << 1;
+  if (hasData)
+    flags |= (dataAccess.type & 0b11) << 3 |
+             (log2Ceil(dataAccess.bytes) & 0b11) << 5;
+  if (hasDataPc)
+    flags |= 1 << 7;
+  m_buffer.append(static_cast<char>(flags));
+  if (hasInstr)
+    writeDelta(instrAccess.address, m_prevInstrAddress);
+  if (hasData)
+    writeDelta(dataAccess.address, m_prevDataAddress);
+  if (hasDataPc)
+    writeDelta(dataAccess.pc, m_prevDataPc);
+
+  m_cycles++;
+  if (m_buffer.size() >= s_bufferSize)
+    flush();
+}
+
+bool AccessTraceReader::open(const QString &path, QString &errorMessage) {
+  m_file.setFileName(path);
+  if (!m_file.open(QIODevice::ReadOnly)) {
+    errorMessage = "Failed to open access trace file '" + path + "'";
+    return false;
+  }
+  m_size = m_file.size();
+  m_data = m_size > 0 ? m_file.map(0, m_size) : nullptr;
+  if (m_data == nullptr) {
+    m_contents = m_file.readAll();
+    m_data = reinterpret_cast<const uchar *>(m_contents.constData());
+    m_size = m_contents.size();
+  }
+
+  if (m_size <= s_magicSize ||
+      QByteArray(reinterpret_cast<const char *>(m_data), s_magicSize) !=
+          QByteArray(s_magic, s_magicSize)) {
+    errorMessage = "'" + path + "' is not a Ripes memory access trace";
+    return false;
+  }
+  if (m_data[s_magicSize] < s_minVersion || m_data[s_magicSize] > s_version) {
+    errorMessage = "Unsupported version of memory access trace '" + path + "'";
+    return false;
+  }
+  m_pos = s_magicSize + 1;
+  m_prevInstrAddress = 0;
+  m_prevDataAddress = 0;
+  m_prevDataPc = 0;
+  m_cycles = 0;
+  m_error = false;
+  return true;
+}
+
+bool AccessTraceReader::readDelta(AInt &previous) {
+  AInt value = 0;
+  unsigned shift = 0;
+  uchar byte;
+  do {
+    if (m_pos == m_size || shift >= sizeof(AInt) * CHAR_BIT) {
+      m_error = true;
+      return false;
+    }
+    byte = m_data[m_pos++];
+    value |= static_cast<AInt>(byte & 0x7F) << shift;
+    shift += 7;
+  } while (byte & 0x80);
+
+  const AInt delta = (value >> 1) ^ (~(value & 1) + 1);
+  previous += delta;
+  return true;
+}
+
+bool AccessTraceReader::next(MemoryAccess &instrAccess,
+                             MemoryAccess &dataAccess) {
+  if (m_pos >= m_size || m_error)
+    return false;
+
+  const uchar flags = m_data[m_pos++];
+  instrAccess = MemoryAccess();
+  dataAccess = MemoryAccess();
+  if (flags & 1) {
+    if (!readDelta(m_prevInstrAddress))
+      return false;
+    instrAccess.type = MemoryAccess::Read;
+    instrAccess.address = m_prevInstrAddress;
+    instrAccess.bytes = 1u << ((flags >> 1) & 0b11);
+  }
+  const unsigned dataType = (flags >> 3) & 0b11;
+  if (dataType != MemoryAccess::None) {
+    if (dataType > MemoryAccess::Write || !readDelta(m_prevDataAddress)) {
+      m_error = true;
+      return false;
+    }
+    dataAccess.type = static_cast<MemoryAccess::Type>(dataType);
+    dataAccess.address = m_prevDataAddress;
+    dataAccess.bytes = 1u << ((flags >> 5) & 0b11);
+    if (flags & (1 << 7)) {
+      if (!readDelta(m_prevDataPc))
+        return false;
+      dataAccess.pc = m_prevDataPc;
+    }
+  }
+
+  m_cycles++;
+  return true;
+}
+
+} // namespace Ripes
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+
+#include "processors/interface/ripesprocessor.h"
+
+namespace Ripes {
+
+/**
+ * Binary memory access trace format
+ *
+ * A trace records the instruction and data memory accesses of a processor, one
+ * record per cycle. The file starts with the 8-byte magic "RIPESMAT" followed
+ * by a version byte. Each record consists of a flags byte:
+ *  - bit 0:    instruction access present (always a read)
+ *  - bits 1-2: log2 of the number of bytes of the instruction access
+ *  - bits 3-4: data access type (MemoryAccess::Type)
+ *  - bits 5-6: log2 of the number of bytes of the data access
+ *  - bit 7:    PC of the data access present
+ * followed by the address of the instruction access, the address of the data
+ * access and the PC of the data access, if present. Each address is stored as
+ * a zig-zag encoded LEB128 delta to the previous address of the same stream,
+ * such that sequential accesses require a single byte.
+ */
+class AccessTraceWriter {
+public:
+  AccessTraceWriter() {}
+  ~AccessTraceWriter();
+
+  /// Creates the trace file at @p path. Returns false and sets
+  /// @p errorMessage on failure.
+  bool open(const QString &path, QString &errorMessage);
+  void close();
+  bool isOpen() const { return m_file.isOpen(); }
+
+  /// Appends a record for a single cycle.
+  void record(const MemoryAccess &instrAccess, const MemoryAccess &dataAccess);
+  long long cycles() const { return m_cycles; }
+
+private:
+  void writeDelta(AInt address, AInt &previous);
+  void flush();
+
+  QFile m_file;
+  QByteArray m_buffer;
+  AInt m_prevInstrAddress = 0;
+  AInt m_prevDataAddress = 0;
+  AInt m_prevDataPc = 0;
+  long long m_cycles = 0;
+};
+
+class AccessTraceReader {
+public:
+  AccessTraceReader() {}
+
+  /// Opens the trace file at @p path. Returns false and sets @p errorMessage
+  /// on failure.
+  bool open(const QString &path, QString &errorMessage);
+
+  /// Reads the record of the next cycle. Returns false at the end of the trace,
+  /// or if the trace is malformed (see error()).
+  bool next(MemoryAccess &instrAccess, MemoryAccess &dataAccess);
+  bool error() const { return m_error; }
+  long long cycles() const { return m_cycles; }
+
+private:
+  bool readDelta(AInt &previous);
+
+  QFile m_file;
+  // The trace is read through a memory mapping of the file, if supported by
+  // the platform, or else from m_contents.
+  QByteArray m_contents;
+  const uchar *m_data = nullptr;
+  qint64 m_size = 0;
+  qint64 m_pos = 0;
+  AInt m_prevInstrAddress = 0;
+  AInt m_prevDataAddress = 0;
+  AInt m_prevDataPc = 0;
+  long long m_cycles = 0;
+  bool m_error = false;
+};
+
+} // namespace Ripes
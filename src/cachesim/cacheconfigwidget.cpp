@@ -20,9 +20,11 @@ CacheConfigWidget::CacheConfigWidget(QWidget *parent)
 
   // Gather a list of all items in this widget which will trigger a modification
   // to the current configuration
-  m_configItems = {
-      m_ui->presets,           m_ui->ways,   m_ui->lines, m_ui->blocks,
-      m_ui->replacementPolicy, m_ui->wrMiss, m_ui->wrHit};
+  m_configItems = {m_ui->presets,           m_ui->ways,
+                   m_ui->lines,             m_ui->blocks,
+                   m_ui->replacementPolicy, m_ui->wrMiss,
+                   m_ui->wrHit,             m_ui->prefetcher,
+                   m_ui->prefetchDegree};
 }
 
 void CacheConfigWidget::setCache(const std::shared_ptr<CacheSim> &cache) {
@@ -31,6 +33,7 @@ void CacheConfigWidget::setCache(const std::shared_ptr<CacheSim> &cache) {
   setupEnumCombobox(m_ui->replacementPolicy, s_cacheReplPolicyStrings);
   setupEnumCombobox(m_ui->wrHit, s_cacheWritePolicyStrings);
   setupEnumCombobox(m_ui->wrMiss, s_cacheWriteAllocateStrings);
+  setupEnumCombobox(m_ui->prefetcher, s_prefetcherTypeStrings);
 
   m_ui->ways->setValue(m_cache->getWaysBits());
   m_ui->lines->setValue(m_cache->getLineBits());
@@ -59,6 +62,17 @@ void CacheConfigWidget::setCache(const std::shared_ptr<CacheSim> &cache) {
             m_cache->setWriteAllocatePolicy(
                 qvariant_cast<WriteAllocPolicy>(m_ui->wrMiss->itemData(index)));
           });
+  const auto setPrefetcher = [=] {
+    PrefetchConfig config;
+    config.type = getEnumValue<PrefetcherType>(m_ui->prefetcher);
+    config.degree = m_ui->prefetchDegree->value();
+    m_cache->setPrefetcher(config);
+  };
+  connect(m_ui->prefetcher,
+          QOverload<int>::of(&QComboBox::currentIndexChanged), cache.get(),
+          setPrefetcher);
+  connect(m_ui->prefetchDegree, QOverload<int>::of(&QSpinBox::valueChanged),
+          cache.get(), setPrefetcher);
   connect(m_ui->savePresetButton, &QPushButton::clicked, this,
           &CacheConfigWidget::storePreset);
   m_ui->savePresetButton->setIcon(QIcon(":/icons/save.svg"));
@@ -159,6 +173,10 @@ void CacheConfigWidget::handleConfigurationChanged() {
   setEnumIndex(m_ui->wrHit, m_cache->getWritePolicy());
   setEnumIndex(m_ui->wrMiss, m_cache->getWriteAllocPolicy());
   setEnumIndex(m_ui->replacementPolicy, m_cache->getReplacementPolicy());
+  setEnumIndex(m_ui->prefetcher, m_cache->getPrefetchConfig().type);
+  m_ui->prefetchDegree->setValue(m_cache->getPrefetchConfig().degree);
+  m_ui->prefetchDegree->setEnabled(m_cache->getPrefetchConfig().type !=
+                                   PrefetcherType::None);
 
   if (!m_justSetPreset) {
     m_ui->presets->setCurrentIndex(-1);
@@ -50,4 +50,5 @@ private:
 Q_DECLARE_METATYPE(Ripes::WritePolicy);
 Q_DECLARE_METATYPE(Ripes::WriteAllocPolicy);
 Q_DECLARE_METATYPE(Ripes::ReplPolicy);
+Q_DECLARE_METATYPE(Ripes::PrefetcherType);
 Q_DECLARE_METATYPE(Ripes::CachePreset);
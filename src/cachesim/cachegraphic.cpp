@@ -3,25 +3,18 @@
 #include <QGraphicsLineItem>
 #include <QGraphicsRectItem>
 #include <QGraphicsScene>
+#include <QGraphicsSceneHoverEvent>
 #include <QGraphicsSimpleTextItem>
+#include <QPainter>
 #include <QPen>
+#include <QStyleOptionGraphicsItem>
+
+#include <algorithm>
+#include <cmath>
 
 #include "processorhandler.h"
 #include "radix.h"
 
-namespace {
-
-// Return a set of all keys in a map
-template <typename TK, typename TV>
-std::set<TK> keys(std::map<TK, TV> const &input_map) {
-  std::set<TK> keyset;
-  for (auto const &element : input_map) {
-    keyset.insert(element.first);
-  }
-  return keyset;
-}
-} // namespace
-
 namespace Ripes {
 
 /**
@@ -77,6 +70,15 @@ private:
 
 CacheGraphic::CacheGraphic(CacheSim &cache)
     : QGraphicsObject(nullptr), m_cache(cache), m_fm(m_font) {
+  // Only the exposed area of the cache table is painted.
+  setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+  setAcceptHoverEvents(true);
+
+  // Changes are collected and applied at most once per frame.
+  m_updateTimer.setSingleShot(true);
+  m_updateTimer.setInterval(s_updateInterval);
+  connect(&m_updateTimer, &QTimer::timeout, this, [this] { applyUpdates(); });
+
   // Connect to CacheSim::dataChanged using QueuedConnection, to ensure allow
   // for cross thread signalling (CacheSim is executed in the same thread as the
   // simulator).
@@ -90,186 +92,200 @@ CacheGraphic::CacheGraphic(CacheSim &cache)
   cacheInvalidated();
 }
 
-void CacheGraphic::updateLineReplFields(unsigned lineIdx) {
-  auto *cacheLine = m_cache.getLine(lineIdx);
-
-  if (cacheLine == nullptr) {
-    // Nothing to do
-    return;
-  }
-
-  if (m_cacheTextItems.at(0).at(0).lru == nullptr) {
-    // The current cache configuration does not have any replacement field
-    return;
-  }
-
-  for (const auto &way : m_cacheTextItems[lineIdx]) {
-    // If LRU was just initialized, the actual (software) LRU value may be very
-    // large. Mask to the number of actual LRU bits.
-    unsigned lruVal = cacheLine->at(way.first).lru;
-    lruVal &= vsrtl::generateBitmask(m_cache.getWaysBits());
-    const QString lruText = QString::number(lruVal);
-    way.second.lru->setText(lruText);
-
-    // LRU text might have changed; update LRU field position to center in
-    // column
-    const qreal y = lineIdx * m_lineHeight + way.first * m_setHeight;
-    const qreal x =
-        m_widthBeforeLRU + m_lruWidth / 2 - m_fm.horizontalAdvance(lruText) / 2;
-
-    way.second.lru->setPos(x, y);
-  }
-}
-
 QString CacheGraphic::addressString() const {
   return "0x" +
          QString("0").repeated(ProcessorHandler::currentISA()->bytes() * 2);
 }
 
-void CacheGraphic::updateWay(unsigned lineIdx, unsigned wayIdx) {
-  const auto &it = m_cacheTextItems.find(lineIdx);
-  if (it == m_cacheTextItems.end()) {
-    return;
-  }
-  const auto &wayIt = it->second.find(wayIdx);
-  if (wayIt == it->second.end()) {
-    return;
-  }
-  CacheWay &way = wayIt->second;
+QRectF CacheGraphic::lineRect(unsigned lineIdx) const {
+  return QRectF(m_tableRect.left(), lineIdx * m_lineHeight,
+                m_tableRect.width(), m_lineHeight);
+}
 
-  CacheSim::CacheWay simWay = CacheSim::CacheWay();
+QRectF CacheGraphic::blockColumnRect(unsigned blockIdx) const {
+  return QRectF(m_widthBeforeBlocks + blockIdx * m_blockWidth, 0, m_blockWidth,
+                m_cacheHeight);
+}
 
-  if (auto *cacheLine = m_cache.getLine(lineIdx)) {
-    simWay = cacheLine->at(wayIdx);
-  };
+std::optional<CacheGraphic::BlockIndex>
+CacheGraphic::blockAt(const QPointF &pos) const {
+  if (pos.x() < m_widthBeforeBlocks || pos.x() >= m_cacheWidth || pos.y() < 0 ||
+      pos.y() >= m_cacheHeight)
+    return {};
+  const unsigned row = pos.y() / m_setHeight;
+  return BlockIndex{row / m_cache.getWays(), row % m_cache.getWays(),
+                    static_cast<unsigned>((pos.x() - m_widthBeforeBlocks) /
+                                          m_blockWidth)};
+}
 
-  const unsigned bytes = ProcessorHandler::currentISA()->bytes();
-  // ======================== Update block text fields ======================
-  if (simWay.valid) {
-    for (int i = 0; i < m_cache.getBlocks(); ++i) {
-      QGraphicsSimpleTextItem *blockTextItem = nullptr;
-      if (way.blocks.count(i) == 0) {
-        // Block text item has not yet been created
-        const qreal x =
-            m_widthBeforeBlocks + i * m_blockWidth +
-            (m_blockWidth / 2 - m_fm.horizontalAdvance(addressString()) / 2);
-        const qreal y = lineIdx * m_lineHeight + wayIdx * m_setHeight;
-
-        way.blocks[i] = createGraphicsTextItemSP(x, y);
-        blockTextItem = way.blocks[i].get();
-      } else {
-        blockTextItem = way.blocks.at(i).get();
-      }
+std::optional<AInt> CacheGraphic::addressAt(const QPointF &pos) const {
+  const auto index = blockAt(pos);
+  if (!index)
+    return {};
+  const CacheSim::CacheWay way = m_cache.getWay(index->line, index->way);
+  if (!way.valid)
+    return {};
+  return m_cache.buildAddress(way.tag, index->line, index->block);
+}
 
-      // Update block text
-      const AInt addressForBlock = m_cache.buildAddress(simWay.tag, lineIdx, i);
-      const auto data =
-          ProcessorHandler::getMemory().readMemConst(addressForBlock, bytes);
-      const QString text = encodeRadixValue(
-          data, Radix::Hex, ProcessorHandler::currentISA()->bytes());
-      blockTextItem->setText(text);
-      QString tooltip =
-          "Address: " +
-          encodeRadixValue(addressForBlock, Radix::Hex,
-                           ProcessorHandler::currentISA()->bytes());
-      if (simWay.dirtyBlocks.count(i)) {
+void CacheGraphic::hoverMoveEvent(QGraphicsSceneHoverEvent *event) {
+  // The tooltip of the item is set to that of the block being hovered.
+  QString tooltip;
+  if (const auto index = blockAt(event->pos())) {
+    const CacheSim::CacheWay way = m_cache.getWay(index->line, index->way);
+    if (way.valid) {
+      tooltip = "Address: " +
+                encodeRadixValue(
+                    m_cache.buildAddress(way.tag, index->line, index->block),
+                    Radix::Hex, ProcessorHandler::currentISA()->bytes());
+      if (way.isDirtyBlock(index->block))
         tooltip += "\n> Dirty";
-      }
-      blockTextItem->setToolTip(tooltip);
-      // Store the address within the userrole of the block text. Doing this, we
-      // are able to easily retrieve the address for the block if the block is
-      // clicked.
-      blockTextItem->setData(Qt::UserRole,
-                             QVariant::fromValue(addressForBlock));
     }
-  } else {
-    // The way is invalid so no block text should be present
-    way.blocks.clear();
   }
+  setToolTip(tooltip);
+  QGraphicsObject::hoverMoveEvent(event);
+}
 
-  // =========================== Update dirty field =========================
-  if (way.dirty) {
-    way.dirty->setText(QString::number(simWay.dirty));
-  }
+void CacheGraphic::paint(QPainter *painter,
+                         const QStyleOptionGraphicsItem *option, QWidget *) {
+  const QRectF rect = option->exposedRect.intersected(m_tableRect);
+  if (rect.isEmpty() || m_cache.getLines() == 0 || m_cache.getWays() == 0)
+    return;
+  painter->save();
+  paintTable(painter, rect);
+  painter->restore();
+}
+
+void CacheGraphic::paintText(QPainter *painter, const QString &text, qreal x,
+                             qreal y) const {
+  // Text is positioned by its top left corner, as graphics text items are.
+  painter->drawText(QPointF(x, y + m_fm.ascent()), text);
+}
 
-  // =========================== Update valid field =========================
-  if (way.valid) {
-    way.valid->setText(QString::number(simWay.valid));
+void CacheGraphic::paintTable(QPainter *painter, const QRectF &rect) const {
+  const auto clampedIndex = [](qreal v, int count) {
+    return static_cast<unsigned>(
+        std::clamp(static_cast<int>(std::floor(v)), 0, count - 1));
+  };
+  const unsigned firstLine =
+      clampedIndex(rect.top() / m_lineHeight, m_cache.getLines());
+  const unsigned lastLine =
+      clampedIndex(rect.bottom() / m_lineHeight, m_cache.getLines());
+  const int blocks = m_cache.getBlocks();
+  const unsigned firstBlock = clampedIndex(
+      (rect.left() - m_widthBeforeBlocks) / m_blockWidth, blocks);
+  const unsigned lastBlock = clampedIndex(
+      (rect.right() - m_widthBeforeBlocks) / m_blockWidth, blocks);
+
+  // Highlighting is painted beneath the contents of the cells.
+  paintHighlighting(painter);
+
+  painter->setFont(m_font);
+  painter->setPen(Qt::black);
+  for (unsigned lineIdx = firstLine; lineIdx <= lastLine; ++lineIdx) {
+    for (int wayIdx = 0; wayIdx < m_cache.getWays(); ++wayIdx)
+      paintWay(painter, lineIdx, wayIdx, firstBlock, lastBlock);
+
+    // Line index number
+    const QString text = QString::number(lineIdx);
+    paintText(painter, text, -m_fm.horizontalAdvance(text) * 1.2,
+              lineIdx * m_lineHeight + m_lineHeight / 2 - m_setHeight / 2);
   }
 
-  // ============================ Update tag field ==========================
-  if (simWay.valid) {
-    QGraphicsSimpleTextItem *tagTextItem = way.tag.get();
-    if (tagTextItem == nullptr) {
-      const qreal x =
-          m_widthBeforeTag +
-          (m_tagWidth / 2 - m_fm.horizontalAdvance(addressString()) / 2);
-      const qreal y = lineIdx * m_lineHeight + wayIdx * m_setHeight;
-      way.tag = createGraphicsTextItemSP(x, y);
-      tagTextItem = way.tag.get();
-    }
-    const QString tagText = encodeRadixValue(
-        simWay.tag, Radix::Hex, ProcessorHandler::currentISA()->bytes());
-    tagTextItem->setText(tagText);
-  } else {
-    // The way is invalid so no tag text should be present
-    if (way.tag) {
-      way.tag.reset();
+  // Line and set separators of the exposed lines
+  QPen setPen = painter->pen();
+  setPen.setStyle(Qt::DashLine);
+  for (unsigned lineIdx = firstLine; lineIdx <= lastLine + 1; ++lineIdx) {
+    const qreal y = lineIdx * m_lineHeight;
+    painter->drawLine(QLineF(0, y, m_cacheWidth, y));
+    if (lineIdx > lastLine)
+      break;
+    painter->save();
+    painter->setPen(setPen);
+    for (int wayIdx = 1; wayIdx < m_cache.getWays(); ++wayIdx) {
+      const qreal setY = y + wayIdx * m_setHeight;
+      painter->drawLine(QLineF(0, setY, m_cacheWidth, setY));
     }
+    painter->restore();
   }
+}
+
+void CacheGraphic::paintWay(QPainter *painter, unsigned lineIdx,
+                            unsigned wayIdx, unsigned firstBlock,
+                            unsigned lastBlock) const {
+  const CacheSim::CacheWay way = m_cache.getWay(lineIdx, wayIdx);
+  const qreal y = lineIdx * m_lineHeight + wayIdx * m_setHeight;
+  const unsigned bytes = ProcessorHandler::currentISA()->bytes();
 
-  // ==================== Update dirty blocks highlighting ==================
-  const std::set<unsigned> graphicDirtyBlocks = keys(way.dirtyBlocks);
-  std::set<unsigned> newDirtyBlocks;
-  std::set<unsigned> dirtyBlocksToDelete;
-  std::set_difference(
-      graphicDirtyBlocks.begin(), graphicDirtyBlocks.end(),
-      simWay.dirtyBlocks.begin(), simWay.dirtyBlocks.end(),
-      std::inserter(dirtyBlocksToDelete, dirtyBlocksToDelete.begin()));
-  std::set_difference(simWay.dirtyBlocks.begin(), simWay.dirtyBlocks.end(),
-                      graphicDirtyBlocks.begin(), graphicDirtyBlocks.end(),
-                      std::inserter(newDirtyBlocks, newDirtyBlocks.begin()));
-
-  // Delete blocks which are not in sync with the current dirty status of the
-  // way
-  for (const unsigned &blockToDelete : dirtyBlocksToDelete) {
-    way.dirtyBlocks.erase(blockToDelete);
+  // Dirty blocks are highlighted beneath the block text
+  for (unsigned i = firstBlock; i <= lastBlock; ++i) {
+    if (!way.isDirtyBlock(i))
+      continue;
+    painter->save();
+    painter->setOpacity(0.4);
+    painter->fillRect(QRectF(m_widthBeforeBlocks + i * m_blockWidth, y,
+                             m_blockWidth, m_setHeight),
+                      Qt::darkCyan);
+    painter->restore();
   }
-  // Create all required new blocks
-  for (const auto &blockIdx : newDirtyBlocks) {
-    const auto topLeft = QPointF(blockIdx * m_blockWidth + m_widthBeforeBlocks,
-                                 lineIdx * m_lineHeight + wayIdx * m_setHeight);
-    const auto bottomRight =
-        QPointF((blockIdx + 1) * m_blockWidth + m_widthBeforeBlocks,
-                lineIdx * m_lineHeight + (wayIdx + 1) * m_setHeight);
-    way.dirtyBlocks[blockIdx] =
-        std::make_unique<QGraphicsRectItem>(QRectF(topLeft, bottomRight), this);
-
-    const auto &dirtyRectItem = way.dirtyBlocks[blockIdx];
-    dirtyRectItem->setZValue(-1);
-    dirtyRectItem->setOpacity(0.4);
-    dirtyRectItem->setBrush(Qt::darkCyan);
+
+  // Control bits
+  const qreal bitX = m_bitWidth / 2 - m_fm.horizontalAdvance("0") / 2;
+  paintText(painter, QString::number(way.valid), bitX, y);
+  if (m_cache.getWritePolicy() == WritePolicy::WriteBack)
+    paintText(painter, QString::number(way.dirty), m_widthBeforeDirty + bitX,
+              y);
+  if (m_cache.getReplacementPolicy() == ReplPolicy::LRU &&
+      m_cache.getWays() > 1) {
+    // The software LRU value of invalid ways may be very large. Mask to the
+    // number of actual LRU bits.
+    const unsigned lruVal =
+        way.lru & vsrtl::generateBitmask(m_cache.getWaysBits());
+    const QString lruText = QString::number(lruVal);
+    paintText(painter, lruText,
+              m_widthBeforeLRU + m_lruWidth / 2 -
+                  m_fm.horizontalAdvance(lruText) / 2,
+              y);
   }
-}
 
-QGraphicsSimpleTextItem *
-CacheGraphic::tryCreateGraphicsTextItem(QGraphicsSimpleTextItem **item, qreal x,
-                                        qreal y) {
-  if (*item == nullptr) {
-    *item = new QGraphicsSimpleTextItem(this);
-    (*item)->setFont(m_font);
-    (*item)->setPos(x, y);
+  if (!way.valid)
+    return;
+
+  // Tag and blocks of valid ways
+  const qreal textOffset =
+      m_blockWidth / 2 - m_fm.horizontalAdvance(addressString()) / 2;
+  paintText(painter, encodeRadixValue(way.tag, Radix::Hex, bytes),
+            m_widthBeforeTag + textOffset, y);
+  for (unsigned i = firstBlock; i <= lastBlock; ++i) {
+    const AInt addressForBlock = m_cache.buildAddress(way.tag, lineIdx, i);
+    const auto data =
+        ProcessorHandler::getMemory().readMemConst(addressForBlock, bytes);
+    paintText(painter, encodeRadixValue(data, Radix::Hex, bytes),
+              m_widthBeforeBlocks + i * m_blockWidth + textOffset, y);
   }
-  return *item;
 }
 
-std::unique_ptr<QGraphicsSimpleTextItem>
-CacheGraphic::createGraphicsTextItemSP(qreal x, qreal y) {
-  std::unique_ptr<QGraphicsSimpleTextItem> ptr =
-      std::make_unique<QGraphicsSimpleTextItem>(this);
-  ptr->setFont(m_font);
-  ptr->setPos(x, y);
-  return ptr;
+void CacheGraphic::paintHighlighting(QPainter *painter) const {
+  if (!m_highlighted)
+    return;
+  const auto &index = m_highlighted->index;
+
+  // Cache line and cache block indexed by the transaction
+  painter->save();
+  painter->setOpacity(0.25);
+  painter->fillRect(QRectF(0, index.line * m_lineHeight, m_cacheWidth,
+                           m_lineHeight),
+                    Qt::yellow);
+  painter->fillRect(blockColumnRect(index.block), Qt::yellow);
+
+  // The accessed block
+  painter->setOpacity(m_highlighted->isHit ? 0.4 : 0.8);
+  painter->fillRect(QRectF(m_widthBeforeBlocks + index.block * m_blockWidth,
+                           index.line * m_lineHeight +
+                               index.way * m_setHeight,
+                           m_blockWidth, m_setHeight),
+                    m_highlighted->isHit ? Qt::green : Qt::red);
+  painter->restore();
 }
 
 void CacheGraphic::drawIndexingItems() {
@@ -394,8 +410,11 @@ void CacheGraphic::drawIndexingItems() {
 
 void CacheGraphic::cacheInvalidated() {
   // Remove all items
-  m_highlightingItems.clear();
-  m_cacheTextItems.clear();
+  prepareGeometryChange();
+  m_highlighted.reset();
+  m_pendingTransaction.reset();
+  m_changedLines.clear();
+  m_updateTimer.stop();
   m_addressTextItem = nullptr;
   m_blockIndexingLine = nullptr;
   m_lineIndexingLine = nullptr;
@@ -475,34 +494,13 @@ void CacheGraphic::cacheInvalidated() {
   }
 
   m_cacheWidth = width;
-
-  // Draw cache line rows
-  for (int i = 0; i <= m_cache.getLines(); ++i) {
-    qreal verticalAdvance = i * m_lineHeight;
-    new QGraphicsLineItem(0, verticalAdvance, m_cacheWidth, verticalAdvance,
-                          this);
-
-    if (i < m_cache.getLines()) {
-      // Draw cache set rows
-      for (int j = 1; j < m_cache.getWays(); j++) {
-        verticalAdvance += m_setHeight;
-        auto *setLine = new QGraphicsLineItem(0, verticalAdvance, m_cacheWidth,
-                                              verticalAdvance, this);
-        auto pen = setLine->pen();
-        pen.setStyle(Qt::DashLine);
-        setLine->setPen(pen);
-      }
-    }
-  }
-
-  // Draw line index numbers
-  for (int i = 0; i < m_cache.getLines(); ++i) {
-    const QString text = QString::number(i);
-
-    const qreal y = i * m_lineHeight + m_lineHeight / 2 - m_setHeight / 2;
-    const qreal x = -m_fm.horizontalAdvance(text) * 1.2;
-    drawText(text, x, y);
-  }
+  // The rows and cells of the table are painted, given that a cache may have a
+  // very large number of lines.
+  const qreal indexWidth =
+      m_fm.horizontalAdvance(QString::number(std::max(m_cache.getLines(), 1))) *
+      1.2;
+  m_tableRect = QRectF(-indexWidth, 0, indexWidth + m_cacheWidth, m_cacheHeight)
+                    .adjusted(-1, -1, 1, 1);
 
   // Draw index column text
   const QString indexText = "Index";
@@ -515,17 +513,7 @@ void CacheGraphic::cacheInvalidated() {
     drawIndexingItems();
   }
 
-  initializeControlBits();
-
-  // Update all entries in the cache
-  for (int lineIdx = 0; lineIdx < m_cache.getLines(); lineIdx++) {
-    if (const auto *line = m_cache.getLine(lineIdx)) {
-      for (const auto &way : *line) {
-        updateWay(lineIdx, way.first);
-      }
-      updateLineReplFields(lineIdx);
-    }
-  }
+  update();
 
   if (auto *_scene = scene()) {
     // Invalidate the scene rect to resize it to the current dimensions of the
@@ -538,20 +526,16 @@ void CacheGraphic::updateAddressing(
     bool valid, const CacheSim::CacheTransaction &transaction) {
   if (m_indexingVisible) {
     if (valid) {
-      const auto &it = m_cacheTextItems.find(transaction.index.line);
-      if (it == m_cacheTextItems.end()) {
-        return;
-      }
-      const auto &wayIt = it->second.find(transaction.index.way);
-      if (wayIt == it->second.end()) {
+      if (transaction.index.line >= static_cast<unsigned>(m_cache.getLines()) ||
+          transaction.index.way >= static_cast<unsigned>(m_cache.getWays())) {
         return;
       }
 
-      const CacheWay &way = wayIt->second;
       m_addressTextItem->setText(
           QString::number(transaction.address, 2).rightJustified(32, '0'));
 
-      if (way.tag) {
+      if (m_cache.getWay(transaction.index.line, transaction.index.way)
+              .valid) {
         QPolygonF lineIndexingPoly;
         m_lineIndexingLine->setVisible(true);
         lineIndexingPoly << m_lineIndexStartPoint;
@@ -590,19 +574,35 @@ void CacheGraphic::updateAddressing(
   }
 }
 
-void CacheGraphic::wayInvalidated(unsigned lineIdx, unsigned wayIdx) {
-  updateWay(lineIdx, wayIdx);
-  updateLineReplFields(lineIdx);
+void CacheGraphic::wayInvalidated(unsigned lineIdx, unsigned) {
+  m_changedLines.insert(lineIdx);
+  scheduleUpdate();
 }
 
 void CacheGraphic::dataChanged(CacheSim::CacheTransaction transaction) {
-  if (transaction.type != MemoryAccess::None) {
-    wayInvalidated(transaction.index.line, transaction.index.way);
-    updateAddressing(true, transaction);
-    updateHighlighting(true, transaction);
-  } else {
-    updateHighlighting(false, transaction);
-    updateAddressing(false, transaction);
+  if (transaction.type != MemoryAccess::None)
+    m_changedLines.insert(transaction.index.line);
+  m_pendingTransaction = transaction;
+  scheduleUpdate();
+}
+
+void CacheGraphic::scheduleUpdate() {
+  if (!m_updateTimer.isActive())
+    m_updateTimer.start();
+}
+
+void CacheGraphic::applyUpdates() {
+  for (const unsigned lineIdx : m_changedLines)
+    update(lineRect(lineIdx));
+  m_changedLines.clear();
+
+  // Only the latest of the transactions since the previous update is shown.
+  if (m_pendingTransaction) {
+    const CacheSim::CacheTransaction transaction = *m_pendingTransaction;
+    m_pendingTransaction.reset();
+    const bool active = transaction.type != MemoryAccess::None;
+    updateAddressing(active, transaction);
+    updateHighlighting(active, transaction);
   }
 }
 
@@ -627,86 +627,19 @@ QGraphicsSimpleTextItem *CacheGraphic::drawText(const QString &text, qreal x,
 
 void CacheGraphic::updateHighlighting(
     bool active, const CacheSim::CacheTransaction &transaction) {
-  m_highlightingItems.clear();
-
-  if (active) {
-    // Redraw highlighting rectangles indicating the current indexing
-
-    // Draw cache line highlighting rectangle
-    QPointF topLeft = QPointF(0, transaction.index.line * m_lineHeight);
-    QPointF bottomRight =
-        QPointF(m_cacheWidth, (transaction.index.line + 1) * m_lineHeight);
-    m_highlightingItems.emplace_back(std::make_unique<QGraphicsRectItem>(
-        QRectF(topLeft, bottomRight), this));
-    auto *lineRectItem = m_highlightingItems.rbegin()->get();
-    lineRectItem->setZValue(-2);
-    lineRectItem->setOpacity(0.25);
-    lineRectItem->setBrush(Qt::yellow);
-
-    // Draw cache block highlighting rectangle
-    topLeft = QPointF(
-        transaction.index.block * m_blockWidth + m_widthBeforeBlocks, 0);
-    bottomRight = QPointF((transaction.index.block + 1) * m_blockWidth +
-                              m_widthBeforeBlocks,
-                          m_cacheHeight);
-    m_highlightingItems.emplace_back(std::make_unique<QGraphicsRectItem>(
-        QRectF(topLeft, bottomRight), this));
-    auto *blockRectItem = m_highlightingItems.rbegin()->get();
-    blockRectItem->setZValue(-2);
-    blockRectItem->setOpacity(0.25);
-    blockRectItem->setBrush(Qt::yellow);
-
-    // Draw highlighting on the currently accessed block
-    topLeft =
-        QPointF(transaction.index.block * m_blockWidth + m_widthBeforeBlocks,
-                transaction.index.line * m_lineHeight +
-                    transaction.index.way * m_setHeight);
-    bottomRight = QPointF((transaction.index.block + 1) * m_blockWidth +
-                              m_widthBeforeBlocks,
-                          transaction.index.line * m_lineHeight +
-                              (transaction.index.way + 1) * m_setHeight);
-    m_highlightingItems.emplace_back(std::make_unique<QGraphicsRectItem>(
-        QRectF(topLeft, bottomRight), this));
-    auto *hitRectItem = m_highlightingItems.rbegin()->get();
-    hitRectItem->setZValue(-1);
-    if (transaction.isHit) {
-      hitRectItem->setOpacity(0.4);
-      hitRectItem->setBrush(Qt::green);
-    } else {
-      hitRectItem->setOpacity(0.8);
-      hitRectItem->setBrush(Qt::red);
-    }
-  }
-}
-
-void CacheGraphic::initializeControlBits() {
-  for (int lineIdx = 0; lineIdx < m_cache.getLines(); lineIdx++) {
-    auto &line = m_cacheTextItems[lineIdx];
-    for (int setIdx = 0; setIdx < m_cache.getWays(); setIdx++) {
-      const qreal y = lineIdx * m_lineHeight + setIdx * m_setHeight;
-      qreal x;
-
-      // Create valid field
-      x = m_bitWidth / 2 - m_fm.horizontalAdvance("0") / 2;
-      line[setIdx].valid = drawText("0", x, y);
-
-      if (m_cache.getWritePolicy() == WritePolicy::WriteBack) {
-        // Create dirty bit field
-        x = m_widthBeforeDirty + m_bitWidth / 2 -
-            m_fm.horizontalAdvance("0") / 2;
-        line[setIdx].dirty = drawText("0", x, y);
-      }
-
-      if (m_cache.getReplacementPolicy() == ReplPolicy::LRU &&
-          m_cache.getWays() > 1) {
-        // Create LRU field
-        const QString lruText = QString::number(m_cache.getWays() - 1);
-        x = m_widthBeforeLRU + m_lruWidth / 2 -
-            m_fm.horizontalAdvance(lruText) / 2;
-        line[setIdx].lru = drawText(lruText, x, y);
-      }
-    }
-  }
+  // Repaint the areas of the previous and the current highlighting.
+  const auto updateHighlighted = [this] {
+    if (!m_highlighted)
+      return;
+    update(lineRect(m_highlighted->index.line));
+    update(blockColumnRect(m_highlighted->index.block));
+  };
+  updateHighlighted();
+  if (active)
+    m_highlighted = transaction;
+  else
+    m_highlighted.reset();
+  updateHighlighted();
 }
 
 } // namespace Ripes
@@ -6,21 +6,41 @@
 #include <QFontMetrics>
 #include <QGraphicsItem>
 #include <QObject>
+#include <QTimer>
 #include <memory>
+#include <optional>
+#include <set>
 
 namespace Ripes {
 class FancyPolyLine;
 
+/**
+ * @brief The CacheGraphic class
+ * Graphical view of a cache simulator. The cells of the cache table are painted
+ * from the state of the cache simulator, and only for the area of the table
+ * which is exposed, such that the cost of drawing the table does not grow with
+ * the number of lines in the cache. Changes to the cache only repaint the lines
+ * which they touched, and are applied at most once per frame.
+ */
 class CacheGraphic : public QGraphicsObject {
 public:
   CacheGraphic(CacheSim &cache);
 
-  QRectF boundingRect() const override { return childrenBoundingRect(); };
+  QRectF boundingRect() const override {
+    return childrenBoundingRect().united(m_tableRect);
+  };
 
-  void paint(QPainter *, const QStyleOptionGraphicsItem *,
-             QWidget * = nullptr) override {}
+  void paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
+             QWidget * = nullptr) override;
   bool indexingVisible() const { return m_indexingVisible; }
 
+  /**
+   * @brief addressAt
+   * @returns the address of the cache block at @p pos, in item coordinates, if
+   * @p pos is within a block of a valid cache way.
+   */
+  std::optional<AInt> addressAt(const QPointF &pos) const;
+
 public slots:
   /**
    * @brief dataChanged
@@ -54,40 +74,40 @@ public slots:
 
   void setIndexingVisible(bool visible);
 
+protected:
+  void hoverMoveEvent(QGraphicsSceneHoverEvent *event) override;
+
 private:
-  // Data structure modelling the cache; keeping graphics text items for each
-  // entry All text items which are not always present are stored as
-  // unqiue_ptr's to facilitate easy deletion when undoing changes to the cache
-  struct CacheWay {
-    std::map<unsigned, std::unique_ptr<QGraphicsSimpleTextItem>> blocks;
-    std::unique_ptr<QGraphicsSimpleTextItem> tag = nullptr;
-    QGraphicsSimpleTextItem *lru = nullptr;
-    QGraphicsSimpleTextItem *valid = nullptr;
-    QGraphicsSimpleTextItem *dirty = nullptr;
-    std::map<unsigned, std::unique_ptr<QGraphicsRectItem>> dirtyBlocks;
+  /// Location of a block within the cache table.
+  struct BlockIndex {
+    unsigned line;
+    unsigned way;
+    unsigned block;
   };
+  std::optional<BlockIndex> blockAt(const QPointF &pos) const;
 
-  using CacheLine = std::map<unsigned, CacheWay>;
+  /// Paints the cells of the cache table within @p rect.
+  void paintTable(QPainter *painter, const QRectF &rect) const;
+  void paintWay(QPainter *painter, unsigned lineIdx, unsigned wayIdx,
+                unsigned firstBlock, unsigned lastBlock) const;
+  void paintHighlighting(QPainter *painter) const;
+  void paintText(QPainter *painter, const QString &text, qreal x,
+                 qreal y) const;
+
+  /// Rectangles of the cache table covering @p lineIdx and @p blockIdx.
+  QRectF lineRect(unsigned lineIdx) const;
+  QRectF blockColumnRect(unsigned blockIdx) const;
+
+  /// Schedules the pending changes to be applied within the next frame.
+  void scheduleUpdate();
+  void applyUpdates();
 
-  /**
-   * @brief initializeControlBits
-   * Constructs all of the "Valid" and "LRU" text items within the cache
-   */
-  void initializeControlBits();
   void updateHighlighting(bool active,
                           const CacheSim::CacheTransaction &transaction);
   QGraphicsSimpleTextItem *drawText(const QString &text, const QPointF &pos,
                                     const QFont *otherFont = nullptr);
   QGraphicsSimpleTextItem *drawText(const QString &text, qreal x, qreal y,
                                     const QFont *otherFont = nullptr);
-  QGraphicsSimpleTextItem *
-  tryCreateGraphicsTextItem(QGraphicsSimpleTextItem **item, qreal x, qreal y);
-  std::unique_ptr<QGraphicsSimpleTextItem> createGraphicsTextItemSP(qreal x,
-                                                                    qreal y);
-
-  // Graphical update functions
-  void updateLineReplFields(unsigned lineIdx);
-  void updateWay(unsigned lineIdx, unsigned wayIdx);
   void updateAddressing(bool valid,
                         const CacheSim::CacheTransaction &transaction);
   void drawIndexingItems();
@@ -96,7 +116,15 @@ private:
   QFont m_font = QFont(Fonts::monospace, 12);
   CacheSim &m_cache;
 
-  std::vector<std::unique_ptr<QGraphicsRectItem>> m_highlightingItems;
+  // The transaction which is highlighted in the cache table, if any.
+  std::optional<CacheSim::CacheTransaction> m_highlighted;
+
+  // Changes which have not yet been applied to the graphic; the latest
+  // transaction, and the lines which were changed.
+  std::optional<CacheSim::CacheTransaction> m_pendingTransaction;
+  std::set<unsigned> m_changedLines;
+  QTimer m_updateTimer;
+  static constexpr int s_updateInterval = 16; // ms
 
   QFontMetricsF m_fm;
 
@@ -115,22 +143,12 @@ private:
   qreal m_widthBeforeLRU = 0;
   qreal m_widthBeforeDirty = 0;
   qreal m_lruWidth = 0;
+  // Bounds of the cache table, including the line index column.
+  QRectF m_tableRect;
 
   static constexpr qreal z_grid = 0;
   static constexpr qreal z_wires = -1;
 
-  /**
-   * @brief m_cacheTextItems
-   * All text items in the cache are managed in @var m_cacheTextItems.
-   * This object models the hierarchy of the cache, and stores all currently
-   * initialized text items for the cache. The object is indexed similarly to
-   * how the cache simulator is indexed. As such, a cache transaction is used to
-   * traverse the object.
-   * All items are lazily initialized in calls to dataChanged(). This prevents
-   * initializing a ton of items if a user has created a very large cache.
-   */
-  std::map<unsigned, CacheLine> m_cacheTextItems;
-
   // Addressing related items which are moved around when addressing changes
   QGraphicsSimpleTextItem *m_addressTextItem = nullptr;
   FancyPolyLine *m_lineIndexingLine = nullptr;
@@ -0,0 +1,329 @@
+#include "cachehierarchy.h"
+
+#include "l1cacheshim.h"
+#include "processorhandler.h"
+
+#include <QStringList>
+
+#include <algorithm>
+#include <map>
+
+namespace Ripes {
+
+static double missRate(const CacheSim &cache) {
+  const unsigned accesses = cache.getHits() + cache.getMisses();
+  return accesses == 0 ? 0 : static_cast<double>(cache.getMisses()) / accesses;
+}
+
+CacheHierarchy::CacheHierarchy(const CacheHierarchyConfig &config)
+    : m_config(config) {
+  const auto createCache = [](const CachePreset &preset,
+                              const PrefetchConfig &prefetch) {
+    auto cache = std::make_shared<CacheSim>(nullptr);
+    cache->setPreset(preset);
+    cache->setPrefetcher(prefetch);
+    cache->setRecordHistory(false);
+    return cache;
+  };
+  m_l1i = createCache(m_config.l1i, m_config.l1iPrefetch);
+  m_l1d = createCache(m_config.l1d, m_config.l1dPrefetch);
+  if (m_config.l2) {
+    m_l2 = createCache(*m_config.l2, m_config.l2Prefetch);
+    m_l2->setInclusionPolicy(m_config.l2Inclusion);
+    if (m_config.l2Inclusion == InclusionPolicy::Inclusive)
+      m_l2->setEvictionListener(
+          [this](AInt address) { backInvalidate(address); });
+  }
+  if (m_config.dram) {
+    m_dram = std::make_shared<DRAMSim>(*m_config.dram);
+    if (m_l2)
+      m_l2->setNextLevelCache(m_dram);
+  }
+
+  const std::shared_ptr<CacheInterface> nextLevel =
+      m_l2 ? std::shared_ptr<CacheInterface>(m_l2) : m_dram;
+  const auto attach = [&](CacheSim &l1, const CachePreset &preset,
+                          unsigned victimEntries,
+                          std::shared_ptr<VictimCache> &victim) {
+    if (victimEntries == 0) {
+      l1.setNextLevelCache(nextLevel);
+      return;
+    }
+    victim = std::make_shared<VictimCache>(victimEntries, 4u << preset.blocks);
+    victim->setNextLevelCache(nextLevel);
+    l1.setNextLevelCache(victim);
+  };
+  attach(*m_l1i, m_config.l1i, m_config.l1iVictim, m_l1iVictim);
+  attach(*m_l1d, m_config.l1d, m_config.l1dVictim, m_l1dVictim);
+
+  if (m_config.stall && m_config.storeBuffer.entries != 0) {
+    m_storeBuffer = std::make_unique<StoreBuffer>(
+        m_config.storeBuffer, 4u << m_config.l1d.blocks,
+        [this](const MemoryAccess &access) {
+          return accessPenalty(*m_l1d, access);
+        });
+  }
+}
+
+CacheHierarchy::~CacheHierarchy() {
+  // The processor may outlive the hierarchy.
+  if (m_stalledProcessor &&
+      m_stalledProcessor == ProcessorHandler::getProcessorNonConst())
+    m_stalledProcessor->memoryLatency = {};
+}
+
+void CacheHierarchy::attachToProcessor() {
+  auto *proc = ProcessorHandler::getProcessorNonConst();
+  if (m_config.stall &&
+      (proc->features() & RipesProcessor::Features::hasMemoryStalls)) {
+    m_stalledProcessor = proc;
+    proc->memoryLatency = [this](const MemoryAccess &instrAccess,
+                                 const MemoryAccess &dataAccess) {
+      return stallingAccess(instrAccess, dataAccess);
+    };
+    QObject::connect(ProcessorHandler::get(), &ProcessorHandler::processorReset,
+                     m_l1i.get(), [this] { reset(); });
+    return;
+  }
+  m_l1iShim = std::make_unique<L1CacheShim>(L1CacheShim::CacheType::InstrCache,
+                                            nullptr);
+  m_l1dShim =
+      std::make_unique<L1CacheShim>(L1CacheShim::CacheType::DataCache, nullptr);
+  m_l1iShim->setNextLevelCache(m_l1i);
+  m_l1dShim->setNextLevelCache(m_l1d);
+}
+
+void CacheHierarchy::access(const MemoryAccess &instrAccess,
+                            const MemoryAccess &dataAccess) {
+  if (instrAccess.type == MemoryAccess::Read)
+    m_l1i->access(instrAccess.address, MemoryAccess::Read,
+                  instrAccess.address);
+  if (dataAccess.type != MemoryAccess::None)
+    m_l1d->access(dataAccess.address, dataAccess.type, dataAccess.pc);
+}
+
+const VictimCache *CacheHierarchy::victimCache(const CacheSim &l1) const {
+  if (&l1 == m_l1i.get())
+    return m_l1iVictim.get();
+  if (&l1 == m_l1d.get())
+    return m_l1dVictim.get();
+  return nullptr;
+}
+
+void CacheHierarchy::backInvalidate(AInt address) {
+  const AInt l2Bytes = 4u << m_config.l2->blocks;
+  const AInt block = address & ~(l2Bytes - 1);
+  for (const auto &[l1, victim] :
+       {std::pair{m_l1i.get(), m_l1iVictim.get()},
+        std::pair{m_l1d.get(), m_l1dVictim.get()}}) {
+    const AInt l1Bytes = l1->getBlocks() * 4u;
+    for (AInt a = block; a < block + l2Bytes; a += l1Bytes) {
+      std::optional<bool> dirty = l1->invalidate(a);
+      if (victim && !dirty)
+        dirty = victim->invalidate(a);
+      if (!dirty)
+        continue;
+      m_backInvalidations++;
+      // The block is more recent than the copy of the L2 cache.
+      if (*dirty) {
+        m_dirtyBackInvalidations++;
+        if (m_dram)
+          m_dram->access(a, MemoryAccess::Write);
+      }
+    }
+  }
+}
+
+unsigned CacheHierarchy::accessPenalty(CacheSim &l1,
+                                       const MemoryAccess &access) {
+  const unsigned l1Misses = l1.getMisses();
+  const VictimCache *victim = victimCache(l1);
+  const unsigned victimHits = victim ? victim->hits() : 0;
+  const unsigned l2Misses = m_l2 ? m_l2->getMisses() : 0;
+  if (m_dram)
+    m_dram->markReads();
+  l1.access(access.address, access.type, access.pc);
+  if (l1.getMisses() == l1Misses)
+    return 0;
+  const unsigned victimLatency = victim ? m_config.victimLatency : 0;
+  if (victim && victim->hits() != victimHits)
+    return victimLatency;
+  // The fetch of the missed block is the first read of the DRAM, preceding
+  // those of any prefetches.
+  const unsigned memory = m_dram ? m_dram->firstReadLatency().value_or(0)
+                                 : m_config.memoryLatency;
+  if (!m_l2)
+    return victimLatency + memory;
+  return victimLatency + m_config.l2Latency +
+         (m_l2->getMisses() != l2Misses ? memory : 0);
+}
+
+RipesProcessor::MemoryLatency
+CacheHierarchy::stallingAccess(const MemoryAccess &instrAccess,
+                               const MemoryAccess &dataAccess) {
+  // Stores drain in the cycles preceding the accesses.
+  if (m_storeBuffer)
+    m_storeBuffer->advance(m_cycle);
+  RipesProcessor::MemoryLatency latency;
+  if (instrAccess.type == MemoryAccess::Read) {
+    MemoryAccess access = instrAccess;
+    access.pc = instrAccess.address;
+    latency.instr = accessPenalty(*m_l1i, access);
+  }
+  if (dataAccess.type != MemoryAccess::None)
+    latency.data = m_storeBuffer ? bufferedAccess(dataAccess)
+                                 : accessPenalty(*m_l1d, dataAccess);
+  // The memory system is occupied for the larger penalty, also if the
+  // processor only stalls for the data access (see
+  // RipesProcessor::delayFetch).
+  const unsigned penalty = std::max(latency.instr, latency.data);
+  m_stallCycles += penalty;
+  if (m_storeBuffer)
+    m_storeBuffer->sample(1 + penalty);
+  m_cycle += 1 + penalty;
+  return latency;
+}
+
+unsigned CacheHierarchy::bufferedAccess(const MemoryAccess &access) {
+  if (access.type == MemoryAccess::Write)
+    return m_storeBuffer->store(access, m_cycle);
+  bool forwarded;
+  const unsigned stall = m_storeBuffer->load(access, m_cycle, forwarded);
+  return forwarded ? stall : stall + accessPenalty(*m_l1d, access);
+}
+
+void CacheHierarchy::reset() {
+  // Resetting an L1 cache resets its victim cache and the L2 cache as well.
+  m_l1i->reset();
+  m_l1d->reset();
+  m_backInvalidations = 0;
+  m_dirtyBackInvalidations = 0;
+  if (m_storeBuffer)
+    m_storeBuffer->reset();
+  m_stallCycles = 0;
+  m_cycle = 0;
+}
+
+double CacheHierarchy::memoryLatency() const {
+  return m_dram ? m_dram->averageReadLatency() : m_config.memoryLatency;
+}
+
+double CacheHierarchy::nextLevelPenalty() const {
+  if (m_l2)
+    return m_config.l2Latency + missRate(*m_l2) * memoryLatency();
+  return memoryLatency();
+}
+
+double CacheHierarchy::missPenalty(const CacheSim &l1) const {
+  if (const auto *victim = victimCache(l1))
+    return m_config.victimLatency +
+           (1 - victim->hitRate()) * nextLevelPenalty();
+  return nextLevelPenalty();
+}
+
+double CacheHierarchy::amat(const CacheSim &l1) const {
+  return m_config.l1Latency + missRate(l1) * missPenalty(l1);
+}
+
+double CacheHierarchy::stallCycles() const {
+  if (stallsProcessor())
+    return m_stallCycles;
+  return m_l1i->getMisses() * missPenalty(*m_l1i) +
+         m_l1d->getMisses() * missPenalty(*m_l1d);
+}
+
+QVariantMap CacheHierarchy::report(bool json) const {
+  const auto levelReport = [json](const CacheSim &cache, unsigned latency) {
+    QVariantMap m;
+    m["hits"] = cache.getHits();
+    m["misses"] = cache.getMisses();
+    m["writebacks"] = cache.getWritebacks();
+    m["hit rate"] = cache.getHitRate();
+    m["latency"] = latency;
+    m["evictions"] = cache.getEvictions();
+    m["valid blocks"] = cache.getOccupancy();
+    m["occupancy"] = static_cast<double>(cache.getOccupancy()) /
+                     (cache.getLines() * cache.getWays());
+
+    // The JSON report lists the misses of every set, whereas the text report
+    // only lists the sets which missed, as "<set>:<misses>".
+    const auto &lineMisses = cache.getLineMisses();
+    if (json) {
+      QVariantList sets;
+      for (const unsigned misses : lineMisses)
+        sets << misses;
+      m["set misses"] = sets;
+    } else {
+      QStringList sets;
+      for (unsigned i = 0; i < lineMisses.size(); ++i)
+        if (lineMisses[i] != 0)
+          sets << QString::number(i) + ":" + QString::number(lineMisses[i]);
+      m["set misses"] = sets.join(" ");
+    }
+
+    const auto &prefetch = cache.getPrefetchConfig();
+    if (prefetch.type != PrefetcherType::None) {
+      const auto &stats = cache.getPrefetchStats();
+      m["prefetcher"] = s_prefetcherTypeStrings.at(prefetch.type);
+      m["prefetch degree"] = prefetch.degree;
+      m["prefetches"] = stats.issued;
+      m["useful prefetches"] = stats.useful;
+      m["prefetch accuracy"] = stats.accuracy();
+      m["prefetch coverage"] = stats.coverage(cache.getMisses());
+      m["prefetch pollution"] = stats.pollution;
+    }
+    return m;
+  };
+
+  QVariantMap m;
+  m["L1I"] = levelReport(*m_l1i, m_config.l1Latency);
+  m["L1D"] = levelReport(*m_l1d, m_config.l1Latency);
+  for (const auto &[name, victim] :
+       {std::pair{"L1I victim", m_l1iVictim.get()},
+        std::pair{"L1D victim", m_l1dVictim.get()}}) {
+    if (!victim)
+      continue;
+    QVariantMap vc = victim->report();
+    vc["latency"] = m_config.victimLatency;
+    m[name] = vc;
+  }
+  if (m_l2) {
+    QVariantMap l2 = levelReport(*m_l2, m_config.l2Latency);
+    static const std::map<InclusionPolicy, QString> inclusionNames = {
+        {InclusionPolicy::NonInclusive, "non-inclusive"},
+        {InclusionPolicy::Inclusive, "inclusive"},
+        {InclusionPolicy::Exclusive, "exclusive"}};
+    l2["inclusion"] = inclusionNames.at(m_config.l2Inclusion);
+    if (m_config.l2Inclusion == InclusionPolicy::Inclusive) {
+      l2["back invalidations"] = m_backInvalidations;
+      l2["dirty back invalidations"] = m_dirtyBackInvalidations;
+    } else if (m_config.l2Inclusion == InclusionPolicy::Exclusive) {
+      l2["victim fills"] = m_l2->getVictimFills();
+    }
+    m["L2"] = l2;
+  }
+  m["memory latency"] = memoryLatency();
+  if (m_dram)
+    m["DRAM"] = m_dram->report();
+  m["L1I AMAT"] = amat(*m_l1i);
+  m["L1D AMAT"] = amat(*m_l1d);
+  m["stall cycles"] = stallCycles();
+  if (m_storeBuffer && stallsProcessor()) {
+    const auto &stats = m_storeBuffer->stats();
+    QVariantMap sb;
+    sb["entries"] = m_config.storeBuffer.entries;
+    sb["write combining"] = m_config.storeBuffer.writeCombining;
+    sb["stores"] = stats.stores;
+    sb["combined stores"] = stats.combined;
+    sb["drained entries"] = stats.drained;
+    sb["forwarded loads"] = stats.forwarded;
+    sb["full stall cycles"] = stats.fullStalls;
+    sb["conflict stall cycles"] = stats.conflictStalls;
+    sb["average occupancy"] = stats.averageOccupancy(m_cycle);
+    sb["max occupancy"] = stats.maxOccupancy;
+    m["store buffer"] = sb;
+  }
+  return m;
+}
+
+} // namespace Ripes
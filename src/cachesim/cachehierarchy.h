@@ -0,0 +1,166 @@
+#pragma once
+
+#include <QVariantMap>
+
+#include <memory>
+#include <optional>
+
+#include "cachesim.h"
+#include "dramsim.h"
+#include "storebuffer.h"
+#include "victimcache.h"
+
+namespace Ripes {
+
+class L1CacheShim;
+
+/// Configuration of a CacheHierarchy. Latencies are given in cycles.
+struct CacheHierarchyConfig {
+  CachePreset l1i;
+  CachePreset l1d;
+  // Unified second-level cache, shared by the L1 caches.
+  std::optional<CachePreset> l2;
+  // Inclusion of the blocks of the L1 caches in the L2 cache.
+  InclusionPolicy l2Inclusion = InclusionPolicy::NonInclusive;
+  // Entries of the victim caches behind the L1 caches; 0 for none.
+  unsigned l1iVictim = 0;
+  unsigned l1dVictim = 0;
+
+  PrefetchConfig l1iPrefetch;
+  PrefetchConfig l1dPrefetch;
+  PrefetchConfig l2Prefetch;
+
+  unsigned l1Latency = 1;
+  unsigned victimLatency = 1;
+  unsigned l2Latency = 10;
+  unsigned memoryLatency = 100;
+  // DRAM behind the last level, replacing the fixed memory latency.
+  std::optional<DRAMConfig> dram;
+  // Stall the processor on misses of the L1 caches, rather than observing its
+  // accesses (see CacheHierarchy::attachToProcessor).
+  bool stall = false;
+  // Buffer the stores of a stalled processor in front of the L1 data cache.
+  StoreBufferConfig storeBuffer;
+};
+
+/**
+ * @brief The CacheHierarchy class
+ * A headless chain of split L1 instruction and data caches, an optional unified
+ * L2 cache and main memory. Misses and writebacks of an L1 cache are
+ * propagated to the L2 cache (see CacheSim::setNextLevelCache), through a
+ * victim cache behind the L1 cache, if configured (see VictimCache).
+ *
+ * The L2 cache may be inclusive or exclusive of the L1 caches (see
+ * CacheSim::setInclusionPolicy). The blocks evicted from an inclusive L2 cache
+ * are back-invalidated in the L1 caches and victim caches, writing dirty
+ * blocks back to memory.
+ *
+ * Each level is assigned an access latency, from which the average memory
+ * access time (AMAT) of the L1 caches is computed as
+ *   AMAT = latency + miss rate * miss penalty,
+ * where the miss penalty is the AMAT of the next level, or the memory latency
+ * for the last level. A miss of an L1 cache with a victim cache is first
+ * looked up in the victim cache, adding its latency to the miss penalty, and
+ * is served by it on a hit. With a DRAM model (see DRAMSim), the memory
+ * latency is its average read latency, and a stalled access stalls for the
+ * latency of its own DRAM read. Stalls are estimated as the misses of the L1
+ * caches times their miss penalty, assuming that L1 hits are pipelined and
+ * that writebacks are buffered.
+ *
+ * If configured to stall, the processor is stalled on every miss of an L1
+ * cache for the miss penalty of the access; the latency of the L2 cache, and
+ * the memory latency if the L2 cache misses as well. The accesses of the
+ * instruction and data caches in a cycle overlap, such that the cycle stalls
+ * for the larger of their penalties. With a store buffer (see StoreBuffer),
+ * stores enter the buffer instead, and stall only on a full buffer; the
+ * buffer drains into the L1 data cache in the background, in the cycles of
+ * the processor.
+ *
+ * The caches keep no access history (see CacheSim::setRecordHistory), and are
+ * thus not suited for the graphical views.
+ */
+class CacheHierarchy {
+public:
+  CacheHierarchy(const CacheHierarchyConfig &config);
+  ~CacheHierarchy();
+
+  /// Drives the L1 caches from the memory accesses of the processor of the
+  /// ProcessorHandler, through L1CacheShims. If configured to stall, and the
+  /// processor has memory stalls, the caches are instead accessed through
+  /// RipesProcessor::memoryLatency, and are reset along with the processor.
+  void attachToProcessor();
+  /// Returns whether the caches stall the processor on misses.
+  bool stallsProcessor() const { return m_stalledProcessor != nullptr; }
+
+  /// Performs the memory accesses of a single cycle, for trace-driven
+  /// simulation.
+  void access(const MemoryAccess &instrAccess, const MemoryAccess &dataAccess);
+
+  CacheSim &l1i() { return *m_l1i; }
+  CacheSim &l1d() { return *m_l1d; }
+  CacheSim *l2() { return m_l2.get(); }
+  /// The victim cache behind @p l1, if configured.
+  const VictimCache *victimCache(const CacheSim &l1) const;
+  /// Returns the number of blocks invalidated in the L1 and victim caches by
+  /// evictions of an inclusive L2 cache.
+  unsigned backInvalidations() const { return m_backInvalidations; }
+  const DRAMSim *dram() const { return m_dram.get(); }
+  /// The store buffer of a stalled processor, if configured.
+  const StoreBuffer *storeBuffer() const { return m_storeBuffer.get(); }
+  const CacheHierarchyConfig &config() const { return m_config; }
+
+  /// Returns the average memory access time of an L1 cache, in cycles.
+  double amat(const CacheSim &l1) const;
+  /// Returns the number of stall cycles due to misses of the L1 caches; the
+  /// cycles stalled if the caches stall the processor, and otherwise an
+  /// estimate.
+  double stallCycles() const;
+  /// Returns the fixed memory latency, or the average read latency of the
+  /// DRAM.
+  double memoryLatency() const;
+
+  /// Returns the statistics of each level, including a per-set miss histogram
+  /// and the prefetch statistics of levels with a prefetcher, and the AMAT and
+  /// stall estimates. If @p json is set, the histograms are given as lists
+  /// rather than as text.
+  QVariantMap report(bool json = false) const;
+
+private:
+  /// Returns the miss penalty of the L1 cache @p l1.
+  double missPenalty(const CacheSim &l1) const;
+  /// Returns the penalty of a miss of an L1 cache served by the L2 cache or
+  /// memory.
+  double nextLevelPenalty() const;
+  /// Invalidates the block at @p address, evicted from an inclusive L2 cache,
+  /// in the L1 and victim caches.
+  void backInvalidate(AInt address);
+  /// Performs an access of @p l1 and returns its miss penalty in cycles, or 0
+  /// if the access hit.
+  unsigned accessPenalty(CacheSim &l1, const MemoryAccess &access);
+  RipesProcessor::MemoryLatency stallingAccess(const MemoryAccess &instrAccess,
+                                               const MemoryAccess &dataAccess);
+  /// Performs a data access through the store buffer, and returns the cycles
+  /// it stalls.
+  unsigned bufferedAccess(const MemoryAccess &access);
+  void reset();
+
+  CacheHierarchyConfig m_config;
+  std::shared_ptr<CacheSim> m_l1i;
+  std::shared_ptr<CacheSim> m_l1d;
+  std::shared_ptr<CacheSim> m_l2;
+  std::shared_ptr<VictimCache> m_l1iVictim;
+  std::shared_ptr<VictimCache> m_l1dVictim;
+  std::shared_ptr<DRAMSim> m_dram;
+  std::unique_ptr<L1CacheShim> m_l1iShim;
+  std::unique_ptr<L1CacheShim> m_l1dShim;
+  std::unique_ptr<StoreBuffer> m_storeBuffer;
+
+  RipesProcessor *m_stalledProcessor = nullptr;
+  unsigned long long m_stallCycles = 0;
+  unsigned m_backInvalidations = 0;
+  unsigned m_dirtyBackInvalidations = 0;
+  // Cycles of the stalled processor, including stalls.
+  long long m_cycle = 0;
+};
+
+} // namespace Ripes
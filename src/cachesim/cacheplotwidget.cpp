@@ -3,16 +3,24 @@
 
 #include <QCheckBox>
 #include <QClipboard>
+#include <QDialog>
+#include <QDialogButtonBox>
 #include <QFileDialog>
+#include <QHeaderView>
 #include <QPushButton>
+#include <QTableWidget>
 #include <QToolBar>
+#include <QVBoxLayout>
 #include <QtCharts/QAreaSeries>
 #include <QtCharts/QChartView>
 #include <QtCharts/QLineSeries>
+#include <QtCharts/QLogValueAxis>
 #include <QtCharts/QValueAxis>
 
 #include <algorithm>
 
+#include "binutils.h"
+#include "cachesweep.h"
 #include "colors.h"
 #include "enumcombobox.h"
 #include "processorhandler.h"
@@ -22,10 +30,6 @@
 
 namespace Ripes {
 
-static QPointF stepPoint(const QPointF &p1, const QPointF &p2) {
-  return QPointF(p2.x(), p1.y());
-}
-
 CachePlotWidget::CachePlotWidget(QWidget *parent)
     : QWidget(parent), m_ui(new Ui::CachePlotWidget) {
   m_ui->setupUi(this);
@@ -101,14 +105,18 @@ void CachePlotWidget::setCache(const std::shared_ptr<CacheSim> &cache) {
 
   connect(m_cache.get(), &CacheSim::hitrateChanged, this,
           &CachePlotWidget::updateHitrate);
-  connect(m_cache.get(), &CacheSim::configurationChanged, [=] {
+  const auto configurationChanged = [=] {
     m_ui->size->setText(QString::number(m_cache->getCacheSize().bits));
-  });
-  m_ui->size->setText(QString::number(m_cache->getCacheSize().bits));
+    m_ui->prefetchStats->setVisible(m_cache->getPrefetchConfig().type !=
+                                    PrefetcherType::None);
+  };
+  connect(m_cache.get(), &CacheSim::configurationChanged, configurationChanged);
+  configurationChanged();
 
   const auto plotUpdateFunc = [=]() {
     updateRatioPlot();
     updateAllowedRange(RangeChangeSource::Cycles);
+    updatePlotSeries();
     updatePlotAxes();
   };
   connect(ProcessorHandler::get(), &ProcessorHandler::processorClockedNonRun,
@@ -241,6 +249,97 @@ void CachePlotWidget::setupPlotActions() {
   m_ui->savePlot->setDefaultAction(m_savePlotAction);
   connect(m_savePlotAction, &QAction::triggered, this,
           &CachePlotWidget::savePlot);
+
+  const QIcon sweepIcon = QIcon(":/icons/analytics.svg");
+  m_sweepAction = new QAction("Compare cache configurations", this);
+  m_sweepAction->setIcon(sweepIcon);
+  m_ui->sweepConfigs->setDefaultAction(m_sweepAction);
+  connect(m_sweepAction, &QAction::triggered, this,
+          &CachePlotWidget::showCacheSweep);
+}
+
+void CachePlotWidget::showCacheSweep() {
+  // Sweep configurations of up to twice/half the block and line counts, and up
+  // to four times the associativity of the current configuration.
+  const auto around = [](int value, int delta) {
+    return CacheSweep::Range{std::max(0, value - delta), value + delta};
+  };
+  const int blocks = m_cache->getBlockBits();
+  const int ways = m_cache->getWaysBits();
+  CacheSweep sweep(log2Ceil(ProcessorHandler::currentISA()->bytes()),
+                   around(blocks, 1), around(m_cache->getLineBits(), 1),
+                   {std::max(0, ways - 2), ways + 2});
+  m_cache->getAccessHistory().forEach(
+      0, UINT_MAX, [&](unsigned, const CacheSim::CacheAccessTrace &trace) {
+        sweep.access(trace.lastTransaction.address);
+      });
+  const auto results = sweep.results();
+
+  QDialog dialog(this);
+  dialog.setWindowTitle("Cache Configuration Comparison");
+  auto *layout = new QVBoxLayout(&dialog);
+
+  // Plot hit rate against cache size for each associativity, at the current
+  // block size.
+  auto *chart = new QChart();
+  std::map<int, QLineSeries *> seriesPerWays;
+  for (const auto &result : results) {
+    if (result.blocks != blocks)
+      continue;
+    auto &series = seriesPerWays[result.ways];
+    if (series == nullptr) {
+      series = new QLineSeries(chart);
+      series->setName(QString::number(1 << result.ways) + "-way");
+    }
+    series->append(result.words(), result.hitRate() * 100);
+  }
+  for (const auto &series : seriesPerWays)
+    chart->addSeries(series.second);
+  auto *axisX = new QLogValueAxis();
+  axisX->setBase(2);
+  axisX->setLabelFormat("%d");
+  axisX->setTitleText("Cache size (words)");
+  auto *axisY = new QValueAxis();
+  axisY->setRange(0, 100);
+  axisY->setTitleText("Hit rate (%)");
+  chart->addAxis(axisX, Qt::AlignBottom);
+  chart->addAxis(axisY, Qt::AlignLeft);
+  for (const auto &series : seriesPerWays) {
+    series.second->attachAxis(axisX);
+    series.second->attachAxis(axisY);
+  }
+  auto *chartView = new QChartView(chart, &dialog);
+  chartView->setRenderHint(QPainter::Antialiasing);
+  chartView->setMinimumSize(480, 320);
+  layout->addWidget(chartView);
+
+  auto *table = new QTableWidget(results.size(), 5, &dialog);
+  table->setHorizontalHeaderLabels(
+      {"Blocks", "Lines", "Ways", "Size (words)", "Hit rate"});
+  table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  table->verticalHeader()->setVisible(false);
+  for (unsigned i = 0; i < results.size(); ++i) {
+    const auto &result = results.at(i);
+    const QStringList row = {QString::number(1 << result.blocks),
+                             QString::number(1 << result.lines),
+                             QString::number(1 << result.ways),
+                             QString::number(result.words()),
+                             QString::number(result.hitRate(), 'f', 4)};
+    for (int j = 0; j < row.size(); ++j)
+      table->setItem(i, j, new QTableWidgetItem(row.at(j)));
+  }
+  table->resizeColumnsToContents();
+  layout->addWidget(table);
+
+  auto *buttons = new QDialogButtonBox(QDialogButtonBox::Close, &dialog);
+  auto *copyButton =
+      buttons->addButton("Copy to clipboard", QDialogButtonBox::ActionRole);
+  connect(copyButton, &QPushButton::clicked, this,
+          [&] { QApplication::clipboard()->setText(sweep.toTable()); });
+  connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+  layout->addWidget(buttons);
+
+  dialog.exec();
 }
 
 void CachePlotWidget::savePlot() {
@@ -289,6 +388,7 @@ void CachePlotWidget::copyPlotDataToClipboard() const {
 
 void CachePlotWidget::rangeChanged(const RangeChangeSource src) {
   updateAllowedRange(src);
+  updatePlotSeries();
   if (m_plot) {
     m_plot->axes(Qt::Horizontal)
         .constFirst()
@@ -303,16 +403,17 @@ void CachePlotWidget::variablesChanged() {
   resetRatioPlot();
   updateRatioPlot();
   updateAllowedRange(RangeChangeSource::Cycles);
+  updatePlotSeries();
   updatePlotAxes();
 }
 
 std::map<CachePlotWidget::Variable, QList<QPoint>>
 CachePlotWidget::gatherData(unsigned fromCycle) const {
   std::map<Variable, QList<QPoint>> cacheData;
-  const auto &trace = m_cache->getAccessTrace();
+  const auto &history = m_cache->getAccessHistory();
 
   for (int i = 0; i < N_TraceVars; ++i) {
-    cacheData[static_cast<Variable>(i)].reserve(trace.size());
+    cacheData[static_cast<Variable>(i)].reserve(history.lastRecordedCycle());
   }
 
   // Gather data up until the end of the trace or the maximum plotted cycles
@@ -322,52 +423,28 @@ CachePlotWidget::gatherData(unsigned fromCycle) const {
     return {};
   }
 
-  for (auto it = trace.upper_bound(fromCycle);
-       it != trace.lower_bound(maxCycles); it++) {
-    const auto &entry = it->second;
-    Q_ASSERT(it->first <= maxCycles);
-    cacheData[Variable::Writes].append(QPoint(it->first, entry.writes));
-    cacheData[Variable::Reads].append(QPoint(it->first, entry.reads));
-    cacheData[Variable::Hits].append(QPoint(it->first, entry.hits));
-    cacheData[Variable::Misses].append(QPoint(it->first, entry.misses));
-    cacheData[Variable::Writebacks].append(QPoint(it->first, entry.writebacks));
-    cacheData[Variable::Accesses].append(
-        QPoint(it->first, entry.hits + entry.misses));
-    cacheData[Variable::WasHit].append(
-        QPoint(it->first, entry.lastTransaction.isHit));
-    cacheData[Variable::WasMiss].append(
-        QPoint(it->first, !entry.lastTransaction.isHit));
-  }
+  history.forEach(fromCycle, maxCycles,
+                  [&](unsigned cycle, const CacheSim::CacheAccessTrace &entry) {
+                    cacheData[Variable::Writes].append(
+                        QPoint(cycle, entry.writes));
+                    cacheData[Variable::Reads].append(
+                        QPoint(cycle, entry.reads));
+                    cacheData[Variable::Hits].append(QPoint(cycle, entry.hits));
+                    cacheData[Variable::Misses].append(
+                        QPoint(cycle, entry.misses));
+                    cacheData[Variable::Writebacks].append(
+                        QPoint(cycle, entry.writebacks));
+                    cacheData[Variable::Accesses].append(
+                        QPoint(cycle, entry.hits + entry.misses));
+                    cacheData[Variable::WasHit].append(
+                        QPoint(cycle, entry.lastTransaction.isHit));
+                    cacheData[Variable::WasMiss].append(
+                        QPoint(cycle, !entry.lastTransaction.isHit));
+                  });
 
   return cacheData;
 }
 
-void resample(QLineSeries *series, unsigned target, double &step) {
-  QVector<QPointF> newPoints;
-  const auto &oldPoints = series->points();
-  step = (oldPoints.last().x() / static_cast<double>(target)) *
-         2; // *2 to account for steps
-  newPoints.reserve(target);
-  for (int i = 0; i < oldPoints.size(); i += step) {
-    newPoints << oldPoints.at(i);
-  }
-
-#if !defined(QT_NO_DEBUG)
-  // sanity check
-  QPointF plast = QPointF(0, 0);
-  bool first = true;
-  for (const auto &p : std::as_const(newPoints)) {
-    if (!first) {
-      Q_ASSERT(p.x() - plast.x() < step * 1.1);
-      first = false;
-    }
-    plast = p;
-  }
-#endif
-
-  series->replace(newPoints);
-}
-
 void CachePlotWidget::updatePlotAxes() {
   m_plot->createDefaultAxes();
 
@@ -407,30 +484,8 @@ void CachePlotWidget::updateRatioPlot() {
     return;
   }
 
-  // convenience function to move a series on/off the chart based on the number
-  // of points to be added. We have to remove series due to append(QList(...))
-  // calling redraw _for each_ point in the list. Not removing the series for
-  // low nNewPoints avoids a flicker in plot labels. Everything is a balance...
-  const auto plotMover = [=](QLineSeries *series, bool visible) {
-    if (nNewPoints > 2) {
-      if (visible) {
-        this->m_plot->addSeries(series);
-      } else {
-        this->m_plot->removeSeries(series);
-      }
-    }
-  };
-
   m_lastCyclePlotted = newCacheData.at(Accesses).last().x();
 
-  QList<QPointF> newPoints;
-  QList<QPointF> newWindowPoints;
-  QPointF lastPoint;
-  if (m_series->points().size() > 0) {
-    lastPoint = m_series->points().constLast();
-  } else {
-    lastPoint = QPointF(-1, 0);
-  }
   for (int i = 0; i < nNewPoints; ++i) {
     // Cummulative plot. For the unary variable, "Accesses" is just used to
     // index into the cache data for accessing the x variable.
@@ -446,59 +501,34 @@ void CachePlotWidget::updateRatioPlot() {
       ratio = static_cast<double>(p1.y()) / p2.y();
       ratio *= 100.0;
     }
-    bool skipPoint = false;
-    const QPointF newPoint = QPointF(p1.x(), ratio);
-    if (lastPoint.x() >= 0) {
-      if (newPoint.x() - lastPoint.x() < m_xStep) {
-        // Skip point; irrelevant at the current sampling level
-        skipPoint = true;
-      }
-    }
-    if (!skipPoint) {
-      newPoints << stepPoint(lastPoint, newPoint);
-      newPoints << newPoint;
-      m_maxY = ratio > m_maxY ? ratio : m_maxY;
-      m_minY = ratio < m_minY ? ratio : m_minY;
-      lastPoint = newPoint;
-    }
+    m_ratioData.append(p1.x(), ratio);
+    m_maxY = ratio > m_maxY ? ratio : m_maxY;
+    m_minY = ratio < m_minY ? ratio : m_minY;
 
     // Moving average plot
     if (m_ui->showMAvg->isChecked()) {
-      m_mavgData.push(newPoint.y());
+      m_mavgWindow.push(ratio);
       const double wAvg =
-          std::accumulate(m_mavgData.begin(), m_mavgData.end(), 0.0) /
-          m_mavgData.size();
-      newWindowPoints << QPointF(p1.x(), wAvg);
+          std::accumulate(m_mavgWindow.begin(), m_mavgWindow.end(), 0.0) /
+          m_mavgWindow.size();
+      m_mavgData.append(p1.x(), wAvg);
     }
   }
 
-  if (newPoints.size() == 0 && newWindowPoints.size() == 0) {
-    return;
-  }
-
-  plotMover(m_series, false);
-  m_series->append(newPoints);
-  if (m_ui->showMAvg->isChecked()) {
-    plotMover(m_mavgSeries, false);
-    m_mavgSeries->append(newWindowPoints);
-  }
-
-  // Determine whether to resample;
-  // *2 the allowed points to account for the addition of step points.
-  // *2 to account for the fact that the setting specifies the minimum # of
-  // points, and we resample at a 2x ratio
-  const int maxPoints =
-      RipesSettings::value(RIPES_SETTING_CACHE_MAXPOINTS).toInt() * 2 * 2;
-  if (m_series->points().size() >= maxPoints) {
-    resample(m_series, maxPoints / 2, m_xStep);
-  }
+  updatePlotWarningButton();
+}
 
-  plotMover(m_series, true);
+void CachePlotWidget::updatePlotSeries() {
+  // Only the visible range is decimated, such that zooming and panning is
+  // independent of the number of cycles plotted.
+  const unsigned buckets =
+      RipesSettings::value(RIPES_SETTING_CACHE_MAXPOINTS).toUInt();
+  const unsigned fromCycle = m_ui->rangeSlider->minimumPosition();
+  const unsigned toCycle = m_ui->rangeSlider->maximumPosition();
+  m_series->replace(m_ratioData.decimate(fromCycle, toCycle, buckets));
   if (m_ui->showMAvg->isChecked()) {
-    plotMover(m_mavgSeries, true);
+    m_mavgSeries->replace(m_mavgData.decimate(fromCycle, toCycle, buckets));
   }
-
-  updatePlotWarningButton();
 }
 
 void CachePlotWidget::updatePlotWarningButton() {
@@ -512,11 +542,12 @@ void CachePlotWidget::resetRatioPlot() {
   m_minY = DBL_MAX;
   m_series->clear();
   m_mavgSeries->clear();
+  m_ratioData.clear();
+  m_mavgData.clear();
   m_lastCyclePlotted = 0;
-  m_xStep = 1;
 
   if (m_ui->showMAvg->isChecked()) {
-    m_mavgData = FixedQueue<double>(m_ui->windowCycles->value());
+    m_mavgWindow = FixedQueue<double>(m_ui->windowCycles->value());
     m_mavgSeries->setVisible(true);
   } else {
     m_mavgSeries->setVisible(false);
@@ -534,6 +565,14 @@ void CachePlotWidget::updateHitrate() {
   m_ui->hits->setText(QString::number(m_cache->getHits()));
   m_ui->misses->setText(QString::number(m_cache->getMisses()));
   m_ui->writebacks->setText(QString::number(m_cache->getWritebacks()));
+
+  const auto &prefetchStats = m_cache->getPrefetchStats();
+  m_ui->pfAccuracy->setText(
+      QString::number(prefetchStats.accuracy(), 'G', 4));
+  m_ui->pfCoverage->setText(
+      QString::number(prefetchStats.coverage(m_cache->getMisses()), 'G', 4));
+  m_ui->prefetches->setText(QString::number(prefetchStats.issued));
+  m_ui->pfPollution->setText(QString::number(prefetchStats.pollution));
 }
 
 } // namespace Ripes
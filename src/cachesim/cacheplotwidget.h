@@ -5,6 +5,7 @@
 #include <QtCharts/QChartGlobal>
 
 #include "cachesim.h"
+#include "decimationpyramid.h"
 #include "float.h"
 #include <queue>
 
@@ -76,30 +77,41 @@ private:
   void showSizeBreakdown();
   void copyPlotDataToClipboard() const;
   void savePlot();
+  /**
+   * @brief showCacheSweep
+   * Evaluates a grid of cache configurations around the current configuration
+   * on the access trace of the cache (see CacheSweep), and displays the hit
+   * rates in a dialog.
+   */
+  void showCacheSweep();
+  /**
+   * @brief updateRatioPlot
+   * Appends the ratio (and moving average) of the cycles simulated since the
+   * last update to the decimated plot data.
+   */
   void updateRatioPlot();
+  /**
+   * @brief updatePlotSeries
+   * Replaces the plotted series by the decimated plot data of the range
+   * selected by the range slider.
+   */
+  void updatePlotSeries();
   void updatePlotAxes();
   void updateAllowedRange(const RangeChangeSource src);
   void updatePlotWarningButton();
 
-  /**
-   * @brief resampleToScreen
-   * Resamples @param series to only contain as many points as would be visible
-   * on the associated plot view
-   */
-  void resampleToScreen(QLineSeries *series);
-
   void resetRatioPlot();
   QChart *m_plot = nullptr;
   QLineSeries *m_series = nullptr;
   double m_maxY = -DBL_MAX;
   double m_minY = DBL_MAX;
   int64_t m_lastCyclePlotted = 0;
-  double m_xStep = 1.0;
-  static constexpr int s_resamplingRatio = 2;
+  DecimationPyramid m_ratioData;
 
   QLineSeries *m_mavgSeries = nullptr;
   // N last computations of the change in ratio value
-  FixedQueue<double> m_mavgData;
+  FixedQueue<double> m_mavgWindow;
+  DecimationPyramid m_mavgData;
 
   Ui::CachePlotWidget *m_ui;
   std::shared_ptr<CacheSim> m_cache;
@@ -109,6 +121,7 @@ private:
 
   QAction *m_copyDataAction = nullptr;
   QAction *m_savePlotAction = nullptr;
+  QAction *m_sweepAction = nullptr;
   QAction *m_ratioMarkerAction = nullptr;
   QAction *m_mavgMarkerAction = nullptr;
 
@@ -2,9 +2,11 @@
 #include "binutils.h"
 
 #include "processorhandler.h"
+#include "ripessettings.h"
 
 #include <QApplication>
 #include <QThread>
+#include <algorithm>
 #include <random>
 #include <utility>
 
@@ -16,12 +18,30 @@ void CacheInterface::reset() {
   }
 }
 
+void CacheInterface::evict(AInt address, bool dirty, AInt pc) {
+  if (dirty)
+    access(address, MemoryAccess::Write, pc);
+}
+
 void CacheInterface::reverse() {
   if (m_nextLevelCache) {
     static_cast<CacheInterface *>(m_nextLevelCache.get())->reverse();
   }
 }
 
+void CacheInterface::setAccessCycle(std::optional<unsigned> cycle) {
+  m_accessCycle = cycle;
+  if (m_nextLevelCache) {
+    static_cast<CacheInterface *>(m_nextLevelCache.get())
+        ->setAccessCycle(cycle);
+  }
+}
+
+unsigned CacheInterface::accessCycle() const {
+  return m_accessCycle ? *m_accessCycle
+                       : ProcessorHandler::getProcessor()->getCycleCount();
+}
+
 CacheSim::CacheSim(QObject *parent) : CacheInterface(parent) {
   m_byteOffset = log2Ceil(ProcessorHandler::currentISA()->bytes());
   m_wordBits = ProcessorHandler::currentISA()->bits();
@@ -33,42 +53,147 @@ CacheSim::CacheSim(QObject *parent) : CacheInterface(parent) {
     emit cacheInvalidated();
   });
 
+  m_maxRecordedCycles =
+      RipesSettings::value(RIPES_SETTING_CACHE_MAXCYCLES).toUInt();
+  connect(RipesSettings::getObserver(RIPES_SETTING_CACHE_MAXCYCLES),
+          &SettingObserver::modified, this, [=](const QVariant &value) {
+            m_maxRecordedCycles = value.toUInt();
+          });
+
   updateConfiguration();
 }
 
-void CacheSim::updateCacheLineReplFields(CacheLine &line, unsigned wayIdx) {
-  if (getReplacementPolicy() == ReplPolicy::LRU) {
+void CacheSim::updateCacheLineReplFields(unsigned lineIdx, unsigned wayIdx,
+                                         bool fill) {
+  switch (getReplacementPolicy()) {
+  case ReplPolicy::Random:
+    break;
+  case ReplPolicy::LRU: {
+    const unsigned base = wayIndex(lineIdx, 0);
     // Find previous LRU value for the updated index
-    const unsigned preLRU = line[wayIdx].lru;
+    const unsigned preLRU = m_lru[base + wayIdx];
 
     // All indicies which are currently more recent than preLRU shall be
     // incremented
-    for (auto &set : line) {
-      if (set.second.valid && set.second.lru < preLRU) {
-        set.second.lru++;
+    for (unsigned i = base; i < base + getWays(); ++i) {
+      if (m_valid[i] && m_lru[i] < preLRU) {
+        m_lru[i]++;
       }
     }
 
     // Upgrade @p lruIdx to the most recently used
-    line[wayIdx].lru = 0;
+    m_lru[base + wayIdx] = 0;
+    break;
+  }
+  case ReplPolicy::PLRU: {
+    // Point each node on the path from the root to the accessed way away from
+    // the way.
+    unsigned node = 1;
+    for (int level = getWaysBits() - 1; level >= 0; --level) {
+      const unsigned direction = (wayIdx >> level) & 1;
+      setReplBits(lineIdx, node - 1, 1, direction ^ 1);
+      node = 2 * node + direction;
+    }
+    break;
+  }
+  case ReplPolicy::FIFO:
+    if (fill)
+      setReplBits(lineIdx, 0, replStateBits(), (wayIdx + 1) % getWays());
+    break;
+  case ReplPolicy::SRRIP:
+  case ReplPolicy::BRRIP: {
+    if (!fill) {
+      // Hit priority: predict a near-immediate re-reference.
+      setReplBits(lineIdx, 2 * wayIdx, 2, 0);
+      break;
+    }
+    // The victim was chosen as the way with the largest RRPV. Age all ways
+    // such that the victim would have reached the distant RRPV, as the
+    // victim search of the hardware would have done.
+    const uint64_t age = s_maxRRPV - getReplBits(lineIdx, 2 * wayIdx, 2);
+    if (age != 0) {
+      for (int i = 0; i < getWays(); ++i)
+        setReplBits(lineIdx, 2 * i, 2,
+                    std::min<uint64_t>(s_maxRRPV,
+                                       getReplBits(lineIdx, 2 * i, 2) + age));
+    }
+    // SRRIP inserts with a long re-reference interval. BRRIP inserts with a
+    // distant interval, except for every s_brripLongInterval'th fill.
+    uint64_t rrpv = s_maxRRPV - 1;
+    if (getReplacementPolicy() == ReplPolicy::BRRIP)
+      rrpv = m_brripFills++ % s_brripLongInterval == 0 ? s_maxRRPV - 1
+                                                       : s_maxRRPV;
+    setReplBits(lineIdx, 2 * wayIdx, 2, rrpv);
+    break;
+  }
   }
 }
 
-void CacheSim::revertCacheLineReplFields(CacheLine &line,
-                                         const CacheWay &oldWay,
-                                         unsigned wayIdx) {
+void CacheSim::revertCacheLineReplFields(const CacheTrace &trace) {
+  const unsigned lineIdx = trace.transaction.index.line;
+  const unsigned wayIdx = trace.transaction.index.way;
+  const CacheWay &oldWay = trace.oldWay;
   if (getReplacementPolicy() == ReplPolicy::LRU) {
+    const unsigned base = wayIndex(lineIdx, 0);
     // All indicies which are currently less than or equal to the old LRU shall
     // be decremented
-    for (auto &set : line) {
-      if (set.second.valid && set.second.lru <= oldWay.lru) {
-        set.second.lru--;
+    for (unsigned i = base; i < base + getWays(); ++i) {
+      if (m_valid[i] && m_lru[i] <= oldWay.lru) {
+        m_lru[i]--;
       }
     }
 
     // Revert the oldWay LRU
-    line[wayIdx].lru = oldWay.lru;
+    m_lru[base + wayIdx] = oldWay.lru;
+  } else if (!trace.replState.empty()) {
+    std::copy(trace.replState.begin(), trace.replState.end(),
+              m_replState.begin() + lineIdx * m_replStateWords);
+    if (getReplacementPolicy() == ReplPolicy::BRRIP && !trace.transaction.isHit)
+      m_brripFills--;
+  }
+}
+
+unsigned CacheSim::replStateBits() const {
+  switch (getReplacementPolicy()) {
+  case ReplPolicy::PLRU:
+    return std::max(1, getWays() - 1);
+  case ReplPolicy::FIFO:
+    return std::max(1, getWaysBits());
+  case ReplPolicy::SRRIP:
+  case ReplPolicy::BRRIP:
+    return 2 * getWays();
+  default:
+    return 0;
+  }
+}
+
+uint64_t CacheSim::getReplBits(unsigned lineIdx, unsigned offset,
+                               unsigned width) const {
+  const uint64_t word = m_replState[lineIdx * m_replStateWords + offset / 64];
+  return (word >> (offset % 64)) & ((uint64_t(1) << width) - 1);
+}
+
+void CacheSim::setReplBits(unsigned lineIdx, unsigned offset, unsigned width,
+                           uint64_t value) {
+  uint64_t &word = m_replState[lineIdx * m_replStateWords + offset / 64];
+  const uint64_t mask = ((uint64_t(1) << width) - 1) << (offset % 64);
+  word = (word & ~mask) | ((value << (offset % 64)) & mask);
+}
+
+std::vector<uint64_t> CacheSim::getReplState(unsigned lineIdx) const {
+  const auto begin = m_replState.begin() + lineIdx * m_replStateWords;
+  return std::vector<uint64_t>(begin, begin + m_replStateWords);
+}
+
+unsigned CacheSim::plruVictim(unsigned lineIdx) const {
+  unsigned node = 1;
+  unsigned way = 0;
+  for (int level = 0; level < getWaysBits(); ++level) {
+    const unsigned direction = getReplBits(lineIdx, node - 1, 1);
+    way = (way << 1) | direction;
+    node = 2 * node + direction;
   }
+  return way;
 }
 
 CacheSim::CacheSize CacheSim::getCacheSize() const {
@@ -93,6 +218,20 @@ CacheSim::CacheSize CacheSim::getCacheSize() const {
     componentBits = getWaysBits() * entries;
     size.components.push_back("LRU bits: " + QString::number(componentBits));
     size.bits += componentBits;
+  } else if (replStateBits() != 0) {
+    // Per-line replacement state bits
+    componentBits = replStateBits() * getLines();
+    size.components.push_back(s_cacheReplPolicyStrings.at(m_replPolicy) +
+                              " bits: " + QString::number(componentBits));
+    size.bits += componentBits;
+  }
+
+  if (m_prefetcher) {
+    // Prefetched bits
+    componentBits = entries; // 1 bit per entry
+    size.components.push_back("Prefetched bits: " +
+                              QString::number(componentBits));
+    size.bits += componentBits;
   }
 
   // Tag bits
@@ -108,120 +247,122 @@ CacheSim::CacheSize CacheSim::getCacheSize() const {
   return size;
 }
 
-std::pair<unsigned, CacheSim::CacheWay *>
-CacheSim::locateEvictionWay(const CacheTransaction &transaction) {
-  auto &cacheLine = m_cacheLines[transaction.index.line];
-
-  std::pair<unsigned, CacheSim::CacheWay *> ew;
-  ew.first = s_invalidIndex;
-  ew.second = nullptr;
+unsigned
+CacheSim::locateEvictionWay(const CacheTransaction &transaction) const {
+  const unsigned base = wayIndex(transaction.index.line, 0);
+  unsigned ew = s_invalidIndex;
 
   // Locate a new way based on replacement policy.
   if (m_replPolicy == ReplPolicy::Random) {
     // Select a random way
-    ew.first = std::rand() % getWays();
-    ew.second = &cacheLine[ew.first];
+    ew = std::rand() % getWays();
   } else if (m_replPolicy == ReplPolicy::LRU) {
     if (getWays() == 1) {
       // Nothing to do if we are in LRU and only have 1 set.
-      ew.first = 0;
-      ew.second = &cacheLine[ew.first];
+      ew = 0;
     } else {
-      // Lazily initialize all ways in the cacheline before starting to iterate.
-      for (int i = 0; i < getWays(); ++i)
-        cacheLine[i];
-
       // If there is an invalid cache line, select that.
-      auto it =
-          std::find_if(cacheLine.begin(), cacheLine.end(),
-                       [=](const auto &way) { return !way.second.valid; });
-      if (it != cacheLine.end()) {
-        ew.first = it->first;
-        ew.second = &it->second;
+      for (int i = 0; i < getWays(); ++i) {
+        if (!m_valid[base + i]) {
+          ew = i;
+          break;
+        }
       }
-      if (ew.second == nullptr) {
+      if (ew == s_invalidIndex) {
         // Else, Find LRU way.
-        for (auto &way : cacheLine) {
-          if (static_cast<long>(way.second.lru) == getWays() - 1) {
-            ew.first = way.first;
-            ew.second = &way.second;
+        for (int i = 0; i < getWays(); ++i) {
+          if (static_cast<long>(m_lru[base + i]) == getWays() - 1) {
+            ew = i;
             break;
           }
         }
       }
     }
+  } else if (m_replPolicy == ReplPolicy::FIFO) {
+    // Ways are filled and replaced in round-robin order.
+    ew = getReplBits(transaction.index.line, 0, replStateBits());
+  } else {
+    // If there is an invalid cache line, select that.
+    for (int i = 0; i < getWays(); ++i) {
+      if (!m_valid[base + i]) {
+        ew = i;
+        break;
+      }
+    }
+    if (ew == s_invalidIndex) {
+      if (m_replPolicy == ReplPolicy::PLRU) {
+        ew = plruVictim(transaction.index.line);
+      } else {
+        // Select the first way with the most distant re-reference prediction.
+        uint64_t maxRRPV = 0;
+        for (int i = 0; i < getWays(); ++i) {
+          const uint64_t rrpv = getReplBits(transaction.index.line, 2 * i, 2);
+          if (ew == s_invalidIndex || rrpv > maxRRPV) {
+            ew = i;
+            maxRRPV = rrpv;
+          }
+        }
+      }
+    }
   }
 
-  Q_ASSERT(ew.first != s_invalidIndex && "Unable to locate way for eviction");
-  Q_ASSERT(ew.second != nullptr && "Unable to locate way for eviction");
+  Q_ASSERT(ew != s_invalidIndex && "Unable to locate way for eviction");
   return ew;
 }
 
 CacheSim::CacheWay CacheSim::evictAndUpdate(CacheTransaction &transaction) {
-  const auto [wayIdx, wayPtr] = locateEvictionWay(transaction);
+  const unsigned wayIdx = locateEvictionWay(transaction);
+  const unsigned idx = wayIndex(transaction.index.line, wayIdx);
 
   CacheWay eviction;
 
-  if (!wayPtr->valid) {
+  if (!m_valid[idx]) {
     // Record that this was an invalid->valid transition
     transaction.transToValid = true;
   } else {
     // Store the old way info in our eviction trace, in case of rollbacks
-    eviction = *wayPtr;
+    eviction = getWay(transaction.index.line, wayIdx);
 
     if (eviction.dirty) {
       // The eviction will result in a writeback
       transaction.isWriteback = true;
     }
+    m_evictions++;
+    if (m_evictionListener)
+      m_evictionListener(buildAddress(eviction.tag, transaction.index.line, 0));
   }
 
   // Invalidate the target way
-  *wayPtr = CacheWay();
+  writeWay(transaction.index.line, wayIdx, CacheWay());
 
   // Set required values in way, reflecting the newly loaded address
-  wayPtr->valid = true;
-  wayPtr->dirty = false;
-  wayPtr->tag = getTag(transaction.address);
+  m_valid[idx] = true;
+  m_dirty[idx] = false;
+  m_tags[idx] = getTag(transaction.address);
   transaction.tagChanged = true;
   transaction.index.way = wayIdx;
 
   return eviction;
 }
 
-unsigned CacheSim::getHits() const {
-  if (m_accessTrace.size() == 0) {
-    return 0;
-  } else {
-    auto &trace = m_accessTrace.rbegin()->second;
-    return trace.hits;
-  }
-}
+unsigned CacheSim::getHits() const { return m_history.totals().hits; }
 
-unsigned CacheSim::getMisses() const {
-  if (m_accessTrace.size() == 0) {
-    return 0;
-  } else {
-    auto &trace = m_accessTrace.rbegin()->second;
-    return trace.misses;
-  }
-}
+unsigned CacheSim::getMisses() const { return m_history.totals().misses; }
 
 unsigned CacheSim::getWritebacks() const {
-  if (m_accessTrace.size() == 0) {
-    return 0;
-  } else {
-    auto &trace = m_accessTrace.rbegin()->second;
-    return trace.writebacks;
-  }
+  return m_history.totals().writebacks + m_prefetchStats.writebacks +
+         m_fillWritebacks;
+}
+
+unsigned CacheSim::getOccupancy() const {
+  return std::count(m_valid.begin(), m_valid.end(), true);
 }
 
 double CacheSim::getHitRate() const {
-  if (m_accessTrace.size() == 0) {
+  const auto &totals = m_history.totals();
+  if (totals.hits + totals.misses == 0)
     return 0;
-  } else {
-    auto &trace = m_accessTrace.rbegin()->second;
-    return static_cast<double>(trace.hits) / (trace.hits + trace.misses);
-  }
+  return static_cast<double>(totals.hits) / (totals.hits + totals.misses);
 }
 
 void CacheSim::analyzeCacheAccess(CacheTransaction &transaction) const {
@@ -229,50 +370,172 @@ void CacheSim::analyzeCacheAccess(CacheTransaction &transaction) const {
   transaction.index.block = getBlockIdx(transaction.address);
 
   transaction.isHit = false;
-  if (m_cacheLines.count(transaction.index.line) != 0) {
-    for (const auto &way : m_cacheLines.at(transaction.index.line)) {
-      if ((way.second.tag == getTag(transaction.address)) && way.second.valid) {
-        transaction.index.way = way.first;
-        transaction.isHit = true;
-        break;
-      }
+  const VInt tag = getTag(transaction.address);
+  const unsigned base = wayIndex(transaction.index.line, 0);
+  for (int i = 0; i < getWays(); ++i) {
+    if (m_tags[base + i] == tag && m_valid[base + i]) {
+      transaction.index.way = i;
+      transaction.isHit = true;
+      break;
     }
   }
 }
 
 void CacheSim::pushAccessTrace(const CacheTransaction &transaction) {
-  // Access traces are pushed in sorted order into the access trace map; indexed
-  // by a key corresponding to the cycle of the access.
-  const unsigned currentCycle =
-      ProcessorHandler::getProcessor()->getCycleCount();
-
-  const CacheAccessTrace &mostRecentTrace =
-      m_accessTrace.size() == 0 ? CacheAccessTrace()
-                                : m_accessTrace.rbegin()->second;
+  auto &counts = m_pcAccesses[transaction.pc];
+  counts.accesses++;
+  if (!transaction.isHit) {
+    m_lineMisses[transaction.index.line]++;
+    counts.misses++;
+    m_addressMisses[transaction.address]++;
+  }
+  if (!m_recordHistory) {
+    // Only accumulate the statistics of all accesses.
+    m_history.push(0, transaction, false);
+    return;
+  }
 
-  m_accessTrace[currentCycle] = CacheAccessTrace(mostRecentTrace, transaction);
+  const unsigned currentCycle = accessCycle();
+  m_history.push(currentCycle, transaction,
+                 currentCycle <= m_maxRecordedCycles);
 
   if (!ProcessorHandler::isRunning()) {
     emit hitrateChanged();
   }
 }
 
-void CacheSim::popAccessTrace() {
-  Q_ASSERT(m_accessTrace.size() > 0);
-  // The access trace should have an entry
-  m_accessTrace.erase(m_accessTrace.rbegin()->first);
+void CacheSim::popAccessTrace(const CacheTransaction &transaction) {
+  Q_ASSERT(!m_history.empty());
+  m_history.pop(transaction);
+  auto counts = m_pcAccesses.find(transaction.pc);
+  Q_ASSERT(counts != m_pcAccesses.end());
+  if (!transaction.isHit) {
+    m_lineMisses[transaction.index.line]--;
+    counts->second.misses--;
+    auto misses = m_addressMisses.find(transaction.address);
+    if (--misses->second == 0)
+      m_addressMisses.erase(misses);
+  }
+  if (--counts->second.accesses == 0)
+    m_pcAccesses.erase(counts);
   emit hitrateChanged();
 }
 
-void CacheSim::access(AInt address, MemoryAccess::Type type) {
+void CacheSim::AccessHistory::push(unsigned cycle,
+                                   const CacheTransaction &transaction,
+                                   bool record) {
+  // Recorded accesses must remain a prefix of all accesses.
+  record &= m_entries.size() == m_accesses;
+  if (record) {
+    if (m_entries.size() % s_checkpointInterval == 0)
+      m_checkpoints.push_back(m_totals);
+    uint8_t flags = 0;
+    if (transaction.type == MemoryAccess::Write)
+      flags |= Write;
+    if (transaction.isHit)
+      flags |= Hit;
+    if (transaction.isWriteback)
+      flags |= Writeback;
+    m_entries.push_back({transaction.address, cycle, flags});
+  }
+  m_totals = CacheAccessTrace(m_totals, transaction);
+  m_accesses++;
+}
+
+void CacheSim::AccessHistory::pop(const CacheTransaction &transaction) {
+  Q_ASSERT(m_accesses > 0);
+  if (m_entries.size() == m_accesses) {
+    m_entries.pop_back();
+    if (m_entries.size() % s_checkpointInterval == 0)
+      m_checkpoints.pop_back();
+  }
+  m_accesses--;
+
+  m_totals.reads -= transaction.type == MemoryAccess::Read ? 1 : 0;
+  m_totals.writes -= transaction.type == MemoryAccess::Write ? 1 : 0;
+  m_totals.writebacks -= transaction.isWriteback ? 1 : 0;
+  m_totals.hits -= transaction.isHit ? 1 : 0;
+  m_totals.misses -= transaction.isHit ? 0 : 1;
+  m_totals.lastTransaction = CacheTransaction();
+}
+
+void CacheSim::AccessHistory::clear() {
+  m_totals = CacheAccessTrace();
+  m_accesses = 0;
+  m_entries.clear();
+  m_checkpoints.clear();
+}
+
+void CacheSim::AccessHistory::forEach(
+    unsigned fromCycle, unsigned toCycle,
+    const std::function<void(unsigned, const CacheAccessTrace &)> &f) const {
+  // Locate the first entry past fromCycle, and resume from the checkpoint
+  // preceding it.
+  const auto first = std::upper_bound(
+      m_entries.begin(), m_entries.end(), fromCycle,
+      [](unsigned cycle, const Entry &entry) { return cycle < entry.cycle; });
+  if (first == m_entries.end())
+    return;
+  size_t i = first - m_entries.begin();
+  size_t j = i - i % s_checkpointInterval;
+  CacheAccessTrace trace = m_checkpoints.at(j / s_checkpointInterval);
+
+  const auto apply = [&](const Entry &entry) {
+    CacheTransaction transaction;
+    transaction.address = entry.address;
+    transaction.type =
+        entry.flags & Write ? MemoryAccess::Write : MemoryAccess::Read;
+    transaction.isHit = entry.flags & Hit;
+    transaction.isWriteback = entry.flags & Writeback;
+    trace = CacheAccessTrace(trace, transaction);
+  };
+  for (; j < i; ++j)
+    apply(m_entries[j]);
+
+  for (; i < m_entries.size() && m_entries[i].cycle < toCycle; ++i) {
+    apply(m_entries[i]);
+    // Report once per cycle, after its last access.
+    if (i + 1 == m_entries.size() ||
+        m_entries[i + 1].cycle != m_entries[i].cycle)
+      f(m_entries[i].cycle, trace);
+  }
+}
+
+void CacheSim::access(AInt address, MemoryAccess::Type type, AInt pc) {
   address = address & ~0b11; // Disregard unaligned accesses
   CacheTrace trace;
   CacheWay oldWay;
   CacheTransaction transaction;
   transaction.address = address;
+  transaction.pc = pc;
   transaction.type = type;
 
+  if (m_inclusionPolicy == InclusionPolicy::Exclusive &&
+      type == MemoryAccess::Read) {
+    exclusiveRead(transaction);
+    return;
+  }
+
   analyzeCacheAccess(transaction);
+  if (m_recordHistory)
+    trace.replState = getReplState(transaction.index.line);
+
+  // === Prefetch bookkeeping ===
+  if (transaction.isHit) {
+    const unsigned idx =
+        wayIndex(transaction.index.line, transaction.index.way);
+    if (m_prefetched[idx]) {
+      transaction.prefetchHit = true;
+      m_prefetchStats.useful++;
+    }
+  } else if (!m_pollutionFilter.empty()) {
+    const AInt block = buildAddress(getTag(address), transaction.index.line, 0);
+    if (m_pollutionFilter.erase(block) != 0) {
+      transaction.pollution = true;
+      trace.filterErased = true;
+      m_prefetchStats.pollution++;
+    }
+  }
 
   if (!transaction.isHit) {
     if (type == MemoryAccess::Read ||
@@ -281,7 +544,7 @@ void CacheSim::access(AInt address, MemoryAccess::Type type) {
       oldWay = evictAndUpdate(transaction);
     }
   } else {
-    oldWay = m_cacheLines[transaction.index.line][transaction.index.way];
+    oldWay = getWay(transaction.index.line, transaction.index.way);
   }
 
   // === Update dirty and LRU bits ===
@@ -294,19 +557,19 @@ void CacheSim::access(AInt address, MemoryAccess::Type type) {
       getWriteAllocPolicy() == WriteAllocPolicy::NoWriteAllocate;
 
   if (!writeMissNoAlloc) {
-    // Lazily ensure that the located way has been initialized
-    m_cacheLines[transaction.index.line][transaction.index.way];
-
     if (type == MemoryAccess::Write &&
         getWritePolicy() == WritePolicy::WriteBack) {
-      CacheWay &way =
-          m_cacheLines[transaction.index.line][transaction.index.way];
-      way.dirty = true;
-      way.dirtyBlocks.insert(transaction.index.block);
+      const unsigned idx =
+          wayIndex(transaction.index.line, transaction.index.way);
+      m_dirty[idx] = true;
+      m_dirtyBlocks[idx * m_dirtyBlockWords + transaction.index.block / 64] |=
+          uint64_t(1) << (transaction.index.block % 64);
     }
 
-    updateCacheLineReplFields(m_cacheLines[transaction.index.line],
-                              transaction.index.way);
+    updateCacheLineReplFields(transaction.index.line, transaction.index.way,
+                              !transaction.isHit);
+    m_prefetched[wayIndex(transaction.index.line, transaction.index.way)] =
+        false;
   } else {
     // In case of a write miss with no write allocate, the value is always
     // written through to memory (a writeback)
@@ -322,11 +585,16 @@ void CacheSim::access(AInt address, MemoryAccess::Type type) {
 
   // ===========================
 
+  accessNextLevel(transaction, oldWay, writeMissNoAlloc);
+
   // At this point, no further changes shall be made to the transaction.
   // We record the transaction as well as a possible eviction
   trace.oldWay = oldWay;
   trace.transaction = transaction;
-  pushTrace(trace);
+  if (m_recordHistory) {
+    trace.cycle = accessCycle();
+    pushTrace(trace);
+  }
   pushAccessTrace(transaction);
 
   // === Some sanity checking ===
@@ -343,35 +611,197 @@ void CacheSim::access(AInt address, MemoryAccess::Type type) {
   }
 
   // ===========================
+  if (m_prefetcher) {
+    m_prefetchQueue.clear();
+    m_prefetcher->access(
+        {address, pc, transaction.isHit, transaction.prefetchHit},
+        m_prefetchQueue);
+    for (const AInt prefetchAddress : m_prefetchQueue)
+      prefetch(prefetchAddress, pc);
+  }
+
   if (writeMissNoAlloc) {
     // There are no graphical changes to perform since nothing is pulled into
     // the cache upon a missed write without write allocation
     return;
   }
 
-  if (!ProcessorHandler::isRunning()) {
+  if (m_recordHistory && !ProcessorHandler::isRunning()) {
     emit dataChanged(transaction);
   }
 }
 
+void CacheSim::exclusiveRead(CacheTransaction &transaction) {
+  analyzeCacheAccess(transaction);
+  if (transaction.isHit) {
+    const unsigned idx =
+        wayIndex(transaction.index.line, transaction.index.way);
+    if (m_dirty[idx]) {
+      transaction.isWriteback = true;
+      if (m_nextLevelCache)
+        m_nextLevelCache->access(
+            buildAddress(m_tags[idx], transaction.index.line, 0),
+            MemoryAccess::Write, transaction.pc);
+    }
+    writeWay(transaction.index.line, transaction.index.way, CacheWay());
+  } else if (m_nextLevelCache) {
+    m_nextLevelCache->access(transaction.address, MemoryAccess::Read,
+                             transaction.pc);
+  }
+  pushAccessTrace(transaction);
+}
+
+void CacheSim::evict(AInt address, bool dirty, AInt pc) {
+  if (m_inclusionPolicy != InclusionPolicy::Exclusive) {
+    CacheInterface::evict(address, dirty, pc);
+    return;
+  }
+
+  // The evicted block is filled into this cache, without counting as an
+  // access.
+  CacheTransaction transaction;
+  transaction.address = address & ~0b11;
+  transaction.pc = pc;
+  transaction.type = MemoryAccess::Write;
+  analyzeCacheAccess(transaction);
+  CacheWay oldWay;
+  if (!transaction.isHit) {
+    oldWay = evictAndUpdate(transaction);
+    m_victimFills++;
+  }
+  const unsigned idx = wayIndex(transaction.index.line, transaction.index.way);
+  m_dirty[idx] = m_dirty[idx] || dirty;
+  m_prefetched[idx] = false;
+  updateCacheLineReplFields(transaction.index.line, transaction.index.way,
+                            !transaction.isHit);
+  if (!transaction.isHit && !transaction.transToValid) {
+    if (oldWay.dirty)
+      m_fillWritebacks++;
+    if (m_nextLevelCache)
+      m_nextLevelCache->evict(
+          buildAddress(oldWay.tag, transaction.index.line, 0), oldWay.dirty,
+          pc);
+  }
+}
+
+std::optional<bool> CacheSim::invalidate(AInt address) {
+  CacheTransaction transaction;
+  transaction.address = address & ~0b11;
+  analyzeCacheAccess(transaction);
+  if (!transaction.isHit)
+    return {};
+  const bool dirty =
+      m_dirty[wayIndex(transaction.index.line, transaction.index.way)];
+  writeWay(transaction.index.line, transaction.index.way, CacheWay());
+  return dirty;
+}
+
+void CacheSim::prefetch(AInt address, AInt pc) {
+  CacheTrace trace;
+  CacheTransaction transaction;
+  transaction.address = address & ~0b11;
+  transaction.pc = pc;
+  transaction.type = MemoryAccess::Read;
+
+  analyzeCacheAccess(transaction);
+  if (transaction.isHit)
+    return;
+
+  if (m_recordHistory)
+    trace.replState = getReplState(transaction.index.line);
+  const CacheWay oldWay = evictAndUpdate(transaction);
+  const unsigned lineIdx = transaction.index.line;
+  const unsigned wayIdx = transaction.index.way;
+  updateCacheLineReplFields(lineIdx, wayIdx, true);
+  m_prefetched[wayIndex(lineIdx, wayIdx)] = true;
+  m_prefetchStats.issued++;
+  if (transaction.isWriteback)
+    m_prefetchStats.writebacks++;
+
+  // Track the evicted block for attributing subsequent misses to pollution.
+  const AInt block =
+      buildAddress(getTag(transaction.address), transaction.index.line, 0);
+  trace.filterErased = m_pollutionFilter.erase(block) != 0;
+  if (!transaction.transToValid)
+    trace.filterInserted =
+        m_pollutionFilter.insert(buildAddress(oldWay.tag, lineIdx, 0)).second;
+
+  accessNextLevel(transaction, oldWay, false);
+
+  if (m_recordHistory) {
+    trace.cycle = accessCycle();
+    trace.transaction = transaction;
+    trace.oldWay = oldWay;
+    trace.prefetch = true;
+    pushTrace(trace);
+    if (!ProcessorHandler::isRunning())
+      emit wayInvalidated(lineIdx, wayIdx);
+  }
+}
+
+void CacheSim::accessNextLevel(const CacheTransaction &transaction,
+                               const CacheWay &oldWay, bool writeMissNoAlloc) {
+  if (!m_nextLevelCache)
+    return;
+
+  if (!transaction.isHit && !writeMissNoAlloc) {
+    // Fetch the missed block, and then hand the evicted block to the next
+    // level, which writes it back if dirty. The fetch precedes the eviction,
+    // such that the blocks swap with a next level holding victims.
+    m_nextLevelCache->access(transaction.address, MemoryAccess::Read,
+                             transaction.pc);
+    if (!transaction.transToValid)
+      m_nextLevelCache->evict(
+          buildAddress(oldWay.tag, transaction.index.line, 0), oldWay.dirty,
+          transaction.pc);
+  }
+
+  // Writes which are not retained by this cache are written through.
+  if (transaction.type == MemoryAccess::Write &&
+      (writeMissNoAlloc || getWritePolicy() == WritePolicy::WriteThrough))
+    m_nextLevelCache->access(transaction.address, MemoryAccess::Write,
+                             transaction.pc);
+}
+
 void CacheSim::undo() {
   if (m_traceStack.size() == 0)
     return;
 
   const auto trace = popTrace();
-  popAccessTrace();
-
   const auto &oldWay = trace.oldWay;
   const unsigned &lineIdx = trace.transaction.index.line;
   const unsigned &wayIdx = trace.transaction.index.way;
-  auto &line = m_cacheLines.at(lineIdx);
-  auto &way = line.at(wayIdx);
+
+  if (trace.prefetch) {
+    m_prefetchStats.issued--;
+    if (trace.transaction.isWriteback)
+      m_prefetchStats.writebacks--;
+    if (trace.filterInserted)
+      m_pollutionFilter.erase(buildAddress(oldWay.tag, lineIdx, 0));
+  } else {
+    popAccessTrace(trace.transaction);
+    if (trace.transaction.prefetchHit)
+      m_prefetchStats.useful--;
+    if (trace.transaction.pollution)
+      m_prefetchStats.pollution--;
+  }
+  if (trace.filterErased)
+    m_pollutionFilter.insert(
+        buildAddress(getTag(trace.transaction.address), lineIdx, 0));
+
+  if (wayIdx == s_invalidIndex) {
+    // A write miss without write allocation does not modify the cache.
+    emit dataChanged(m_traceStack.size() > 0 ? m_traceStack.begin()->transaction
+                                             : CacheTransaction());
+    return;
+  }
+
+  CacheWay way = getWay(lineIdx, wayIdx);
 
   // Case 1: A cache way was transitioned to valid. In this case, we simply
   // invalidate the cache way
   if (trace.transaction.transToValid) {
     // Invalidate the way
-    Q_ASSERT(m_cacheLines.at(lineIdx).count(wayIdx) != 0);
     way = CacheWay();
   }
   // Case 2: A miss occurred on a valid entry. In this case, we have to restore
@@ -379,11 +809,16 @@ void CacheSim::undo() {
   // - Restore the old entry which was evicted
   else if (!trace.transaction.isHit) {
     way = oldWay;
+    m_evictions--;
+  }
+  // Case 3: Else, it was a cache hit; Revert replacement fields, dirty
+  // blocks and the prefetch state
+  else {
+    way.prefetched = oldWay.prefetched;
   }
-  // Case 3: Else, it was a cache hit; Revert replacement fields and dirty
-  // blocks
   way.dirtyBlocks = oldWay.dirtyBlocks;
-  revertCacheLineReplFields(line, oldWay, wayIdx);
+  writeWay(lineIdx, wayIdx, way);
+  revertCacheLineReplFields(trace);
 
   // Notify that changes to the way has been performed
   emit wayInvalidated(lineIdx, wayIdx);
@@ -406,7 +841,10 @@ CacheSim::CacheTrace CacheSim::popTrace() {
 
 void CacheSim::pushTrace(const CacheTrace &eviction) {
   m_traceStack.push_front(eviction);
-  if (m_traceStack.size() > vsrtl::core::ClockedComponent::reverseStackSize()) {
+  // Retain the modifications of as many cycles as may be reversed.
+  while (m_traceStack.back().cycle +
+             vsrtl::core::ClockedComponent::reverseStackSize() <
+         eviction.cycle) {
     m_traceStack.pop_back();
   }
 }
@@ -438,29 +876,115 @@ unsigned CacheSim::getBlockIdx(const AInt address) const {
   return maskedAddress;
 }
 
-const CacheSim::CacheLine *CacheSim::getLine(unsigned idx) const {
-  if (m_cacheLines.count(idx)) {
-    return &m_cacheLines.at(idx);
-  } else {
-    return nullptr;
-  }
+CacheSim::CacheWay CacheSim::getWay(unsigned lineIdx, unsigned wayIdx) const {
+  const unsigned idx = wayIndex(lineIdx, wayIdx);
+  CacheWay way;
+  if (idx >= m_valid.size())
+    return way;
+
+  way.tag = m_tags[idx];
+  way.valid = m_valid[idx];
+  way.dirty = m_dirty[idx];
+  way.lru = m_lru[idx];
+  way.prefetched = m_prefetched[idx];
+  const auto dirtyBegin = m_dirtyBlocks.begin() + idx * m_dirtyBlockWords;
+  way.dirtyBlocks.assign(dirtyBegin, dirtyBegin + m_dirtyBlockWords);
+  return way;
+}
+
+CacheSim::State CacheSim::saveState() const {
+  return {m_tags,       m_valid,       m_dirty,     m_lru,
+          m_prefetched, m_dirtyBlocks, m_replState, m_brripFills};
+}
+
+bool CacheSim::restoreState(const State &state) {
+  if (state.tags.size() != m_tags.size() ||
+      state.valid.size() != m_valid.size() ||
+      state.dirty.size() != m_dirty.size() ||
+      state.lru.size() != m_lru.size() ||
+      state.prefetched.size() != m_prefetched.size() ||
+      state.dirtyBlocks.size() != m_dirtyBlocks.size() ||
+      state.replState.size() != m_replState.size())
+    return false;
+
+  m_tags = state.tags;
+  m_valid = state.valid;
+  m_dirty = state.dirty;
+  m_lru = state.lru;
+  m_prefetched = state.prefetched;
+  m_dirtyBlocks = state.dirtyBlocks;
+  m_replState = state.replState;
+  m_brripFills = state.brripFills;
+  m_traceStack.clear();
+  emit cacheInvalidated();
+  return true;
+}
+
+void CacheSim::writeWay(unsigned lineIdx, unsigned wayIdx,
+                        const CacheWay &way) {
+  const unsigned idx = wayIndex(lineIdx, wayIdx);
+  m_tags[idx] = way.tag;
+  m_valid[idx] = way.valid;
+  m_dirty[idx] = way.dirty;
+  m_lru[idx] = way.lru;
+  m_prefetched[idx] = way.prefetched;
+  for (unsigned i = 0; i < m_dirtyBlockWords; ++i)
+    m_dirtyBlocks[idx * m_dirtyBlockWords + i] =
+        i < way.dirtyBlocks.size() ? way.dirtyBlocks[i] : 0;
+}
+
+void CacheSim::initializeStorage() {
+  const unsigned entries = getLines() * getWays();
+  const CacheWay invalid;
+  m_tags.assign(entries, invalid.tag);
+  m_valid.assign(entries, invalid.valid);
+  m_dirty.assign(entries, invalid.dirty);
+  m_lru.assign(entries, invalid.lru);
+  m_prefetched.assign(entries, invalid.prefetched);
+  m_dirtyBlockWords = (getBlocks() + 63) / 64;
+  m_dirtyBlocks.assign(entries * m_dirtyBlockWords, 0);
+
+  // RRIP policies initialize all ways with the distant RRPV (all ones).
+  const bool rrip = m_replPolicy == ReplPolicy::SRRIP ||
+                    m_replPolicy == ReplPolicy::BRRIP;
+  m_replStateWords = (replStateBits() + 63) / 64;
+  m_replState.assign(getLines() * m_replStateWords, rrip ? ~uint64_t(0) : 0);
+  m_brripFills = 0;
+  m_lineMisses.assign(getLines(), 0);
+  m_pcAccesses.clear();
+  m_addressMisses.clear();
+  m_evictions = 0;
+  m_victimFills = 0;
+  m_fillWritebacks = 0;
+}
+
+size_t CacheSim::getStateBytes() const {
+  const auto bytes = [](const auto &v) { return v.capacity() * sizeof(v[0]); };
+  return bytes(m_tags) + bytes(m_valid) + bytes(m_dirty) + bytes(m_lru) +
+         bytes(m_prefetched) + bytes(m_dirtyBlocks) + bytes(m_replState) +
+         bytes(m_lineMisses) +
+         m_pcAccesses.size() * (sizeof(AInt) + sizeof(AccessCounts)) +
+         m_addressMisses.size() * (sizeof(AInt) + sizeof(unsigned));
 }
 
 void CacheSim::reverse() {
-  if (m_accessTrace.size() == 0) {
+  if (m_traceStack.size() == 0) {
     // Nothing to reverse
     return;
   }
 
   const unsigned cycleToUndo =
       ProcessorHandler::getProcessor()->getCycleCount() + 1;
-  if (m_accessTrace.rbegin()->first != cycleToUndo) {
+  if (m_traceStack.front().cycle != cycleToUndo) {
     // No cache access in this cycle
     return;
   }
 
-  // It is now safe to undo the cycle at the top of our access stack(s).
-  undo();
+  // It is now safe to undo the cycle at the top of our access stack(s). A
+  // cache shared by multiple caches may have been accessed multiple times
+  // within the cycle.
+  while (m_traceStack.size() > 0 && m_traceStack.front().cycle == cycleToUndo)
+    undo();
 
   CacheInterface::reverse();
 }
@@ -482,13 +1006,14 @@ void CacheSim::reset() {
 
   m_isResetting = true;
 
-  m_cacheLines.clear();
-  m_accessTrace.clear();
+  initializeStorage();
+  m_history.clear();
   m_traceStack.clear();
 
   m_wordBits = ProcessorHandler::currentISA()->bits();
   m_byteOffset = log2Ceil(ProcessorHandler::currentISA()->bytes());
   recalculateMasks();
+  resetPrefetcher();
   m_isResetting = false;
 
   emit hitrateChanged();
@@ -501,9 +1026,18 @@ void CacheSim::updateConfiguration() {
   // Recalculate masks
   m_byteOffset = log2Ceil(ProcessorHandler::currentISA()->bytes());
   recalculateMasks();
+  initializeStorage();
+  resetPrefetcher();
   emit configurationChanged();
 }
 
+void CacheSim::resetPrefetcher() {
+  m_prefetcher =
+      Prefetcher::create(m_prefetchConfig, m_byteOffset + getBlockBits());
+  m_prefetchStats = PrefetchStats();
+  m_pollutionFilter.clear();
+}
+
 void CacheSim::setBlocks(unsigned blocks) {
   m_blocks = blocks;
   updateConfiguration();
@@ -545,4 +1079,9 @@ void CacheSim::setPreset(const CachePreset &preset) {
   updateConfiguration();
 }
 
+void CacheSim::setPrefetcher(const PrefetchConfig &config) {
+  m_prefetchConfig = config;
+  updateConfiguration();
+}
+
 } // namespace Ripes
@@ -1,13 +1,21 @@
 #pragma once
 
+#include <cstdint>
+#include <deque>
+#include <functional>
 #include <map>
 #include <math.h>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <QDataStream>
 #include <QObject>
 
 #include "../external/VSRTL/core/vsrtl_register.h"
+#include "memoryfootprint.h"
+#include "prefetcher.h"
 #include "processors/RISC-V/rv_memory.h"
 #include "processors/interface/ripesprocessor.h"
 
@@ -16,7 +24,10 @@ class CacheSim;
 
 enum WriteAllocPolicy { WriteAllocate, NoWriteAllocate };
 enum WritePolicy { WriteThrough, WriteBack };
-enum ReplPolicy { Random, LRU };
+enum ReplPolicy { Random, LRU, PLRU, FIFO, SRRIP, BRRIP };
+/// The inclusion of the blocks of the caches above a cache in that cache (see
+/// CacheSim::setInclusionPolicy).
+enum class InclusionPolicy { NonInclusive, Inclusive, Exclusive };
 
 struct CachePreset {
   QString name;
@@ -64,10 +75,18 @@ public:
   /**
    * @brief access
    * A function called by the logical "child" of this cache, indicating that it
-   * desires to access this cache
+   * desires to access this cache. @p pc is the address of the instruction
+   * performing the access, if known.
    */
-  virtual void access(AInt address, MemoryAccess::Type type) = 0;
-  void setNextLevelCache(const std::shared_ptr<CacheSim> &cache) {
+  virtual void access(AInt address, MemoryAccess::Type type, AInt pc = 0) = 0;
+  /**
+   * @brief evict
+   * Called by the logical child of this cache when it evicts the valid block
+   * at @p address, such that this cache may retain it. By default, dirty
+   * blocks are written back and clean blocks are dropped.
+   */
+  virtual void evict(AInt address, bool dirty, AInt pc = 0);
+  void setNextLevelCache(const std::shared_ptr<CacheInterface> &cache) {
     m_nextLevelCache = cache;
   }
 
@@ -79,12 +98,25 @@ public:
   virtual void reset();
   virtual void reverse();
 
+  /**
+   * @brief setAccessCycle
+   * Sets the processor cycle of subsequent accesses to this cache and the
+   * caches above it, for caches which are accessed outside of the processor
+   * thread (see CacheWorker). If unset, accesses are associated with the
+   * current cycle of the processor.
+   */
+  void setAccessCycle(std::optional<unsigned> cycle);
+
 protected:
+  unsigned accessCycle() const;
+  std::optional<unsigned> m_accessCycle;
+
   /**
    * @brief m_nextLevelCache
-   * Pointer to the next level (logical parent) cache.
+   * Pointer to the next level (logical parent) cache, or the memory behind
+   * the last level (see DRAMSim).
    */
-  std::shared_ptr<CacheSim> m_nextLevelCache;
+  std::shared_ptr<CacheInterface> m_nextLevelCache;
 };
 
 class CacheSim : public CacheInterface {
@@ -97,15 +129,31 @@ public:
     std::vector<QString> components;
   };
 
+  /**
+   * @brief The CacheWay struct
+   * A copy of the state of a single way of the cache. The cache itself stores
+   * its ways in flat arrays (see m_tags); CacheWay is used for exchanging way
+   * state with the graphical view and for the undo trace.
+   */
   struct CacheWay {
     VInt tag = -1;
-    std::set<unsigned> dirtyBlocks;
+    // Bitmask of dirty blocks; bit (i % 64) of word (i / 64) is set if block i
+    // is dirty.
+    std::vector<uint64_t> dirtyBlocks;
     bool dirty = false;
     bool valid = false;
+    // True if the way was filled by a prefetch, and has not yet been accessed.
+    bool prefetched = false;
 
     // LRU algorithm relies on invalid cache ways to have an initial high value.
     // -1 ensures maximum value for all way sizes.
     unsigned lru = -1;
+
+    bool isDirtyBlock(unsigned blockIdx) const {
+      const unsigned word = blockIdx / 64;
+      return word < dirtyBlocks.size() &&
+             (dirtyBlocks[word] >> (blockIdx % 64)) & 1;
+    }
   };
 
   struct CacheIndex {
@@ -126,6 +174,8 @@ public:
 
   struct CacheTransaction {
     AInt address;
+    // Address of the instruction performing the access (see access()).
+    AInt pc = 0;
     CacheIndex index;
 
     bool isHit = false;
@@ -136,6 +186,9 @@ public:
         false; // True if the cacheline just transitioned from invalid to valid
     bool tagChanged =
         false; // True if transToValid or the previous entry was evicted
+    bool prefetchHit = false; // True if the access hit an unused prefetched way
+    bool pollution =
+        false; // True if the access missed a block evicted by a prefetch
   };
 
   struct CacheAccessTrace {
@@ -159,30 +212,155 @@ public:
     }
   };
 
-  using CacheLine = std::map<unsigned, CacheWay>;
+  /**
+   * @brief The AccessHistory class
+   * Records the access statistics of the cache over time, for plotting.
+   * Cumulative statistics of all accesses are always maintained, whereas the
+   * individual accesses are only recorded up until the maximum number of
+   * plotted cycles (RIPES_SETTING_CACHE_MAXCYCLES). Accesses are stored
+   * compactly, and the cumulative statistics are checkpointed every
+   * s_checkpointInterval accesses, from which the statistics at any recorded
+   * access are reconstructed.
+   */
+  class AccessHistory {
+  public:
+    void push(unsigned cycle, const CacheTransaction &transaction, bool record);
+    /// Removes the most recent access, being @p transaction.
+    void pop(const CacheTransaction &transaction);
+    void clear();
+
+    /// Returns the cumulative statistics of all accesses.
+    const CacheAccessTrace &totals() const { return m_totals; }
+    bool empty() const { return m_accesses == 0; }
+    /// Returns the cycle of the last recorded access.
+    unsigned lastRecordedCycle() const {
+      return m_entries.empty() ? 0 : m_entries.back().cycle;
+    }
+    /// Returns the bytes held by the recorded accesses.
+    size_t bytes() const {
+      return m_entries.capacity() * sizeof(Entry) +
+             m_checkpoints.capacity() * sizeof(CacheAccessTrace);
+    }
+
+    /**
+     * @brief forEach
+     * Calls @p f with the cumulative statistics at each recorded cycle in
+     * (@p fromCycle, @p toCycle) which had any accesses. If multiple accesses
+     * occurred within a cycle, the statistics include all of them, and
+     * lastTransaction is the last access of the cycle.
+     */
+    void forEach(unsigned fromCycle, unsigned toCycle,
+                 const std::function<void(unsigned cycle,
+                                          const CacheAccessTrace &trace)> &f)
+        const;
+
+  private:
+    static constexpr unsigned s_checkpointInterval = 1024;
+    enum EntryFlags : uint8_t { Write = 1, Hit = 2, Writeback = 4 };
+    struct Entry {
+      AInt address;
+      unsigned cycle;
+      uint8_t flags;
+    };
+
+    CacheAccessTrace m_totals;
+    unsigned m_accesses = 0;
+    // Recorded accesses. Being bounded by a cycle, these are always a prefix of
+    // all accesses.
+    std::vector<Entry> m_entries;
+    // Cumulative statistics preceding every s_checkpointInterval'th entry.
+    std::vector<CacheAccessTrace> m_checkpoints;
+  };
 
   CacheSim(QObject *parent);
   void setWritePolicy(WritePolicy policy);
   void setWriteAllocatePolicy(WriteAllocPolicy policy);
   void setReplacementPolicy(ReplPolicy policy);
 
-  void access(AInt address, MemoryAccess::Type type) override;
+  void access(AInt address, MemoryAccess::Type type, AInt pc = 0) override;
+  void evict(AInt address, bool dirty, AInt pc = 0) override;
   void undo();
   void reset() override;
 
+  /**
+   * @brief setInclusionPolicy
+   * Sets the inclusion policy of this cache with respect to the caches above
+   * it. A non-inclusive cache (the default) is filled by the misses of the
+   * caches above it, independently of their evictions. An inclusive cache is
+   * additionally required to hold every block held above it, which the owner
+   * of the hierarchy enforces by invalidating the blocks evicted from this
+   * cache in the caches above it (see setEvictionListener). An exclusive
+   * cache only holds the blocks evicted from the caches above it: reads are
+   * served around it on a miss, and move the block up on a hit, writing it
+   * back if dirty, as the block is filled clean above.
+   *
+   * Exclusive caches and invalidations do not record an undo trace, and are
+   * thus only suited for caches without history (see setRecordHistory).
+   */
+  void setInclusionPolicy(InclusionPolicy policy) {
+    m_inclusionPolicy = policy;
+  }
+  InclusionPolicy getInclusionPolicy() const { return m_inclusionPolicy; }
+  /// Sets a function called with the address of every valid block evicted
+  /// from the cache.
+  void setEvictionListener(const std::function<void(AInt address)> &listener) {
+    m_evictionListener = listener;
+  }
+  /// Invalidates the block containing @p address, if present. Returns whether
+  /// the block was dirty, or nothing if it was not present.
+  std::optional<bool> invalidate(AInt address);
+
+  /**
+   * @brief setRecordHistory
+   * If disabled, the cache keeps only the accumulated access statistics instead
+   * of the access history and the undo trace, and does not notify the
+   * graphical view of accesses. Used for trace-driven simulation, where
+   * accesses are not associated with cycles of the processor. Enabled by
+   * default.
+   */
+  void setRecordHistory(bool enabled) { m_recordHistory = enabled; }
+
   WriteAllocPolicy getWriteAllocPolicy() const { return m_wrAllocPolicy; }
   ReplPolicy getReplacementPolicy() const { return m_replPolicy; }
   WritePolicy getWritePolicy() const { return m_wrPolicy; }
+  const PrefetchConfig &getPrefetchConfig() const { return m_prefetchConfig; }
+  const PrefetchStats &getPrefetchStats() const { return m_prefetchStats; }
 
-  const std::map<unsigned, CacheAccessTrace> &getAccessTrace() const {
-    return m_accessTrace;
-  }
+  const AccessHistory &getAccessHistory() const { return m_history; }
 
   double getHitRate() const;
   unsigned getHits() const;
   unsigned getMisses() const;
   unsigned getWritebacks() const;
+  /// Returns the number of valid blocks replaced by fills of the cache.
+  unsigned getEvictions() const { return m_evictions; }
+  /// Returns the number of blocks filled into an exclusive cache by the
+  /// evictions of the caches above it.
+  unsigned getVictimFills() const { return m_victimFills; }
+  /// Returns the number of valid ways.
+  unsigned getOccupancy() const;
+  /// Returns the number of demand misses to each line (set) of the cache.
+  const std::vector<unsigned> &getLineMisses() const { return m_lineMisses; }
+
+  struct AccessCounts {
+    unsigned accesses = 0;
+    unsigned misses = 0;
+  };
+  /// Returns the demand accesses and misses of the cache per address of the
+  /// instruction performing them (the pc of access()). Accesses of the next
+  /// level cache are attributed to the instruction causing them.
+  const std::unordered_map<AInt, AccessCounts> &getPCAccesses() const {
+    return m_pcAccesses;
+  }
+  /// Returns the number of demand misses to each (word-aligned) address.
+  const std::unordered_map<AInt, unsigned> &getAddressMisses() const {
+    return m_addressMisses;
+  }
   CacheSize getCacheSize() const;
+  /// Returns the number of bytes allocated for the simulated state of the
+  /// cache (its ways, replacement state and miss statistics), excluding
+  /// the access history and the undo trace.
+  size_t getStateBytes() const;
 
   AInt buildAddress(unsigned tag, unsigned lineIdx, unsigned blockIdx) const;
 
@@ -193,9 +371,9 @@ public:
     return 32 - 2 /*byte offset*/ - getBlockBits() - getLineBits();
   }
 
-  int getBlocks() const { return static_cast<int>(std::pow(2, m_blocks)); }
-  int getWays() const { return static_cast<int>(std::pow(2, m_ways)); }
-  int getLines() const { return static_cast<int>(std::pow(2, m_lines)); }
+  int getBlocks() const { return 1 << m_blocks; }
+  int getWays() const { return 1 << m_ways; }
+  int getLines() const { return 1 << m_lines; }
   unsigned getBlockMask() const { return m_blockMask; }
   unsigned getTagMask() const { return m_tagMask; }
   unsigned getLineMask() const { return m_lineMask; }
@@ -204,13 +382,43 @@ public:
   unsigned getBlockIdx(const AInt address) const;
   unsigned getTag(const AInt address) const;
 
-  const CacheLine *getLine(unsigned idx) const;
+  /**
+   * @brief getWay
+   * Returns a copy of the current state of way @p wayIdx in line @p lineIdx.
+   */
+  CacheWay getWay(unsigned lineIdx, unsigned wayIdx) const;
+
+  /**
+   * @brief The State struct
+   * The contents of the cache, being the ways and the replacement state of
+   * every line, as stored by the cache (see m_tags and m_replState).
+   */
+  struct State {
+    std::vector<VInt> tags;
+    std::vector<uint8_t> valid;
+    std::vector<uint8_t> dirty;
+    std::vector<unsigned> lru;
+    std::vector<uint8_t> prefetched;
+    std::vector<uint64_t> dirtyBlocks;
+    std::vector<uint64_t> replState;
+    unsigned brripFills = 0;
+  };
+  State saveState() const;
+  /**
+   * @brief restoreState
+   * Restores the contents of the cache from @p state, as saved by a cache of
+   * the same configuration. The access statistics and the prefetcher are left
+   * as is, and accesses prior to the restored state cannot be undone. Returns
+   * false if @p state does not match the configuration of the cache.
+   */
+  bool restoreState(const State &state);
 
 public slots:
   void setBlocks(unsigned blocks);
   void setLines(unsigned lines);
   void setWays(unsigned ways);
   void setPreset(const Ripes::CachePreset &preset);
+  void setPrefetcher(const Ripes::PrefetchConfig &config);
 
   /**
    * @brief reverse
@@ -241,16 +449,43 @@ signals:
 
 private:
   struct CacheTrace {
+    unsigned cycle;
     CacheTransaction transaction;
     CacheWay oldWay;
+    // True if the transaction was a prefetch rather than a demand access.
+    bool prefetch = false;
+    // True if the prefetch added the evicted block to m_pollutionFilter.
+    bool filterInserted = false;
+    // True if the transaction removed its block from m_pollutionFilter.
+    bool filterErased = false;
+    // Replacement state of the accessed line prior to the transaction (see
+    // m_replState).
+    std::vector<uint64_t> replState;
   };
 
-  std::pair<unsigned, CacheSim::CacheWay *>
-  locateEvictionWay(const CacheTransaction &transaction);
+  /**
+   * @brief prefetch
+   * Brings the block containing @p address into the cache, if not present,
+   * without counting as a demand access. @p pc is the instruction whose access
+   * triggered the prefetch.
+   */
+  void prefetch(AInt address, AInt pc);
+
+  unsigned locateEvictionWay(const CacheTransaction &transaction) const;
   CacheWay evictAndUpdate(CacheTransaction &transaction);
+  /**
+   * @brief accessNextLevel
+   * Propagates the traffic resulting from @p transaction to the next level
+   * cache, if any: block fetches on allocating misses, followed by the
+   * evicted blocks (see CacheInterface::evict), and written-through writes.
+   */
+  void accessNextLevel(const CacheTransaction &transaction,
+                       const CacheWay &oldWay, bool writeMissNoAlloc);
+  /// Performs a read of an exclusive cache (see setInclusionPolicy).
+  void exclusiveRead(CacheTransaction &transaction);
   void analyzeCacheAccess(CacheTransaction &transaction) const;
   void pushAccessTrace(const CacheTransaction &transaction);
-  void popAccessTrace();
+  void popAccessTrace(const CacheTransaction &transaction);
 
   /**
    * @brief updateConfiguration
@@ -282,36 +517,105 @@ private:
   unsigned m_wordBits = -1;
 
   /**
-   * @brief m_cacheLines
-   * The datastructure for storing our cache hierachy, as per the current cache
-   * configuration.
+   * @brief m_tags, m_valid, m_dirty, m_lru, m_prefetched, m_dirtyBlocks
+   * The state of the cache, stored as flat arrays indexed by
+   * (line * getWays() + way), as per the current cache configuration. The
+   * dirty block bitmask of a way occupies m_dirtyBlockWords consecutive words
+   * of m_dirtyBlocks.
+   */
+  std::vector<VInt> m_tags;
+  std::vector<uint8_t> m_valid;
+  std::vector<uint8_t> m_dirty;
+  std::vector<unsigned> m_lru;
+  std::vector<uint8_t> m_prefetched;
+  std::vector<uint64_t> m_dirtyBlocks;
+  unsigned m_dirtyBlockWords = 1;
+
+  /**
+   * @brief initializeStorage
+   * (Re)allocates the cache state arrays for the current cache configuration,
+   * with all ways invalid.
+   */
+  void initializeStorage();
+  /**
+   * @brief resetPrefetcher
+   * Recreates the prefetcher for the current configuration, and clears the
+   * prefetch statistics.
    */
-  std::map<unsigned, CacheLine> m_cacheLines;
+  void resetPrefetcher();
+  unsigned wayIndex(unsigned lineIdx, unsigned wayIdx) const {
+    return (lineIdx << m_ways) + wayIdx;
+  }
+  void writeWay(unsigned lineIdx, unsigned wayIdx, const CacheWay &way);
 
-  void updateCacheLineReplFields(CacheLine &line, unsigned wayIdx);
+  /**
+   * @brief updateCacheLineReplFields
+   * Updates the replacement fields of a cacheline upon an access to way
+   * @p wayIdx, which was either hit or, if @p fill, filled with a new block.
+   */
+  void updateCacheLineReplFields(unsigned lineIdx, unsigned wayIdx, bool fill);
   /**
    * @brief revertCacheLineReplFields
    * Called whenever undoing a transaction to the cache. Reverts a cacheline's
    * replacement fields according to the configured replacement policy.
    */
-  void revertCacheLineReplFields(CacheLine &line, const CacheWay &oldWay,
-                                 unsigned wayIdx);
+  void revertCacheLineReplFields(const CacheTrace &trace);
+
+  /**
+   * @brief m_replState
+   * The replacement state of each line for the tree-PLRU, FIFO and RRIP
+   * policies, stored as m_replStateWords words per line:
+   *  - PLRU: a binary tree of getWays() - 1 bits, where node n (numbered from
+   *    1, in breadth-first order) is stored at bit n - 1. A node points towards
+   *    the subtree to replace next.
+   *  - FIFO: the index of the way to replace next.
+   *  - SRRIP/BRRIP: a 2-bit re-reference prediction value (RRPV) per way.
+   * All updates on hits are O(1) (or O(log ways) for PLRU); RRIP policies age
+   * the ways of a line on misses.
+   */
+  std::vector<uint64_t> m_replState;
+  unsigned m_replStateWords = 0;
+  // Number of fills under BRRIP, for inserting every s_brripLongInterval'th
+  // block with a long rather than distant re-reference interval.
+  unsigned m_brripFills = 0;
+  static constexpr uint64_t s_maxRRPV = 3;
+  static constexpr unsigned s_brripLongInterval = 32;
+
+  /// Returns the number of bits of replacement state per line (see
+  /// m_replState).
+  unsigned replStateBits() const;
+  uint64_t getReplBits(unsigned lineIdx, unsigned offset, unsigned width) const;
+  void setReplBits(unsigned lineIdx, unsigned offset, unsigned width,
+                   uint64_t value);
+  std::vector<uint64_t> getReplState(unsigned lineIdx) const;
+  unsigned plruVictim(unsigned lineIdx) const;
 
   /**
-   * @brief m_accessTrace
-   * The access trace stack contains cache access statistics for each simulation
-   * cycle. Contrary to the TraceStack (m_traceStack).
+   * @brief m_history
+   * The access statistics of the cache over time. Contrary to the TraceStack
+   * (m_traceStack), this is bounded by the maximum number of plotted cycles
+   * rather than the undo depth.
    */
-  std::map<unsigned, CacheAccessTrace> m_accessTrace;
+  AccessHistory m_history;
+  unsigned m_maxRecordedCycles = 0;
+  // Number of demand misses to each line, for per-set miss histograms.
+  std::vector<unsigned> m_lineMisses;
+  // Demand accesses and misses per instruction, and misses per address, for
+  // attributing misses to the instructions and data of a program.
+  std::unordered_map<AInt, AccessCounts> m_pcAccesses;
+  std::unordered_map<AInt, unsigned> m_addressMisses;
 
   /**
    * @brief m_traceStack
    * The following information is used to track all most-recent modifications
-   * made to the stack. The stack is of a fixed sized which is equal to the undo
-   * stack of VSRTL memory elements. Storing all modifications allows us to
-   * rollback any changes performed to the cache, when clock cycles are undone.
+   * made to the stack. The stack spans the cycles of the undo stack of VSRTL
+   * memory elements. Storing all modifications allows us to rollback any
+   * changes performed to the cache, when clock cycles are undone.
    */
   std::deque<CacheTrace> m_traceStack;
+  MemoryFootprint::Source m_footprint{MemoryFootprint::CacheTraces, [this] {
+    return m_history.bytes() + m_traceStack.size() * sizeof(CacheTrace);
+  }};
 
   /**
    * @brief m_isResetting
@@ -324,12 +628,34 @@ private:
    */
   bool m_isResetting = false;
 
+  bool m_recordHistory = true;
+
+  InclusionPolicy m_inclusionPolicy = InclusionPolicy::NonInclusive;
+  std::function<void(AInt address)> m_evictionListener;
+  unsigned m_evictions = 0;
+  unsigned m_victimFills = 0;
+  // Writebacks of the blocks evicted by victim fills.
+  unsigned m_fillWritebacks = 0;
+
+  PrefetchConfig m_prefetchConfig;
+  std::unique_ptr<Prefetcher> m_prefetcher;
+  PrefetchStats m_prefetchStats;
+  std::vector<AInt> m_prefetchQueue;
+  /**
+   * @brief m_pollutionFilter
+   * The block addresses of blocks which were evicted by prefetches. A demand
+   * miss to any of these is attributed to cache pollution by the prefetcher.
+   */
+  std::unordered_set<AInt> m_pollutionFilter;
+
   CacheTrace popTrace();
   void pushTrace(const CacheTrace &trace);
 };
 
 const static std::map<ReplPolicy, QString> s_cacheReplPolicyStrings{
-    {ReplPolicy::Random, "Random"}, {ReplPolicy::LRU, "LRU"}};
+    {ReplPolicy::Random, "Random"}, {ReplPolicy::LRU, "LRU"},
+    {ReplPolicy::PLRU, "Tree-PLRU"}, {ReplPolicy::FIFO, "FIFO"},
+    {ReplPolicy::SRRIP, "SRRIP"},   {ReplPolicy::BRRIP, "BRRIP"}};
 const static std::map<WriteAllocPolicy, QString> s_cacheWriteAllocateStrings{
     {WriteAllocPolicy::WriteAllocate, "Write allocate"},
     {WriteAllocPolicy::NoWriteAllocate, "No write allocate"}};
@@ -0,0 +1,104 @@
+#include "cachesweep.h"
+
+#include <QStringList>
+#include <QVariantMap>
+
+#include <algorithm>
+
+#include "binutils.h"
+
+namespace Ripes {
+
+CacheSweep::CacheSweep(unsigned byteOffset, const Range &blocks,
+                       const Range &lines, const Range &ways)
+    : m_byteOffset(byteOffset), m_ways(ways), m_maxWays(1u << ways.max) {
+  for (int b = blocks.min; b <= blocks.max; ++b) {
+    for (int l = lines.min; l <= lines.max; ++l) {
+      Geometry geometry;
+      geometry.blocks = b;
+      geometry.lines = l;
+      geometry.stacks.resize((1u << l) * m_maxWays);
+      geometry.depths.resize(1u << l, 0);
+      geometry.distances.resize(m_maxWays, 0);
+      m_geometries.push_back(std::move(geometry));
+    }
+  }
+}
+
+void CacheSweep::access(AInt address) {
+  m_accesses++;
+  for (auto &geometry : m_geometries)
+    access(geometry, address);
+}
+
+void CacheSweep::access(Geometry &geometry, AInt address) {
+  const AInt block = address >> (m_byteOffset + geometry.blocks);
+  const unsigned line = block & vsrtl::generateBitmask(geometry.lines);
+  const auto stack = geometry.stacks.begin() + line * m_maxWays;
+  unsigned &depth = geometry.depths[line];
+
+  const auto it = std::find(stack, stack + depth, block);
+  if (it != stack + depth) {
+    geometry.distances[it - stack]++;
+    std::rotate(stack, it, it + 1);
+  } else {
+    // Miss in all configurations; push the block onto the stack, dropping the
+    // least recently used block if the stack is full.
+    if (depth < m_maxWays)
+      depth++;
+    std::rotate(stack, stack + depth - 1, stack + depth);
+    *stack = block;
+  }
+}
+
+std::vector<CacheSweep::Result> CacheSweep::results() const {
+  std::vector<Result> results;
+  for (const auto &geometry : m_geometries) {
+    for (int w = m_ways.min; w <= m_ways.max; ++w) {
+      Result result;
+      result.blocks = geometry.blocks;
+      result.lines = geometry.lines;
+      result.ways = w;
+      for (unsigned d = 0; d < (1u << w); ++d)
+        result.hits += geometry.distances[d];
+      result.misses = m_accesses - result.hits;
+      results.push_back(result);
+    }
+  }
+  return results;
+}
+
+QVariantList CacheSweep::toVariantList() const {
+  QVariantList list;
+  for (const auto &result : results()) {
+    QVariantMap m;
+    m["blocks"] = result.blocks;
+    m["lines"] = result.lines;
+    m["ways"] = result.ways;
+    m["size (words)"] = result.words();
+    m["hits"] = result.hits;
+    m["misses"] = result.misses;
+    m["hit rate"] = result.hitRate();
+    list << m;
+  }
+  return list;
+}
+
+QString CacheSweep::toTable() const {
+  QString table =
+      "blocks\tlines\tways\tsize (words)\thits\tmisses\thit rate\n";
+  for (const auto &result : results()) {
+    table += QStringList({QString::number(result.blocks),
+                          QString::number(result.lines),
+                          QString::number(result.ways),
+                          QString::number(result.words()),
+                          QString::number(result.hits),
+                          QString::number(result.misses),
+                          QString::number(result.hitRate(), 'f', 4)})
+                 .join('\t') +
+             '\n';
+  }
+  return table;
+}
+
+} // namespace Ripes
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <QString>
+#include <QVariantList>
+
+#include <cstdint>
+#include <vector>
+
+#include "isa/isa_types.h"
+
+namespace Ripes {
+
+/**
+ * @brief The CacheSweep class
+ * Computes the hit rates of a grid of cache configurations from a single pass
+ * over a memory access stream, using LRU stack-distance (Mattson) analysis.
+ *
+ * For each combination of block and line count, an LRU stack is maintained per
+ * cache line (set). The depth at which an accessed block is found in the stack
+ * of its line is its stack distance; an access with stack distance d hits in
+ * every configuration of that geometry with more than d ways. The stacks are
+ * truncated at the largest way count of the sweep.
+ *
+ * Like CachePreset, all configuration parameters are given as log2 values. The
+ * analysis models LRU replacement with write allocation; reads and writes are
+ * thus treated alike.
+ */
+class CacheSweep {
+public:
+  /// An inclusive range of log2 configuration values.
+  struct Range {
+    int min = 0;
+    int max = 0;
+  };
+
+  struct Result {
+    int blocks;
+    int lines;
+    int ways;
+    long long hits = 0;
+    long long misses = 0;
+
+    double hitRate() const {
+      return hits + misses == 0 ? 0
+                                : static_cast<double>(hits) / (hits + misses);
+    }
+    /// Data capacity of the cache in words.
+    unsigned words() const { return 1u << (blocks + lines + ways); }
+  };
+
+  /// @p byteOffset is the number of address bits addressing the bytes of a
+  /// word.
+  CacheSweep(unsigned byteOffset, const Range &blocks, const Range &lines,
+             const Range &ways);
+
+  void access(AInt address);
+
+  /// Returns the results of all configurations of the sweep, ordered by
+  /// blocks, lines and ways.
+  std::vector<Result> results() const;
+  long long accesses() const { return m_accesses; }
+
+  /// Returns the results as a list of maps, suitable for reporting.
+  QVariantList toVariantList() const;
+  /// Returns the results as a tab-separated table with a header row.
+  QString toTable() const;
+
+private:
+  /// Stack distance analysis of a single block/line geometry.
+  struct Geometry {
+    int blocks;
+    int lines;
+    // LRU stacks of block addresses, m_maxWays entries per line, most recently
+    // used first.
+    std::vector<AInt> stacks;
+    std::vector<unsigned> depths;
+    // Number of accesses per stack distance.
+    std::vector<long long> distances;
+  };
+
+  void access(Geometry &geometry, AInt address);
+
+  unsigned m_byteOffset;
+  Range m_ways;
+  unsigned m_maxWays;
+  std::vector<Geometry> m_geometries;
+  long long m_accesses = 0;
+};
+
+} // namespace Ripes
@@ -1,6 +1,6 @@
 #include "cacheview.h"
+#include "cachegraphic.h"
 
-#include <QGraphicsSimpleTextItem>
 #include <QWheelEvent>
 #include <qmath.h>
 
@@ -17,15 +17,15 @@ CacheView::CacheView(QWidget *parent) : QGraphicsView(parent) {
 }
 
 void CacheView::mousePressEvent(QMouseEvent *event) {
-  // If we press on a cache data block, get the address stored for that block
-  // and emit a signal indicating that the address was selected through the
-  // cache
+  // If we press on a cache data block, get the address of that block and emit
+  // a signal indicating that the address was selected through the cache
   const auto viewItems = items(event->pos());
   for (const auto &item : std::as_const(viewItems)) {
-    if (auto *textItem = dynamic_cast<QGraphicsSimpleTextItem *>(item)) {
-      const QVariant userData = textItem->data(Qt::UserRole);
-      if (userData.isValid()) {
-        emit cacheAddressSelected(userData.toULongLong());
+    if (auto *cacheGraphic = dynamic_cast<CacheGraphic *>(item)) {
+      const auto address = cacheGraphic->addressAt(
+          cacheGraphic->mapFromScene(mapToScene(event->pos())));
+      if (address.has_value()) {
+        emit cacheAddressSelected(*address);
         break;
       }
     }
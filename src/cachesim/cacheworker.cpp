@@ -0,0 +1,57 @@
+#include "cacheworker.h"
+
+namespace Ripes {
+
+CacheWorker::CacheWorker(const std::shared_ptr<CacheInterface> &cache)
+    : m_cache(cache), m_queue(s_queueSize) {
+  m_thread = std::thread([this] { run(); });
+}
+
+CacheWorker::~CacheWorker() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_wake.notify_one();
+  m_thread.join();
+}
+
+void CacheWorker::push(const Access &access) {
+  while (!m_queue.push(access)) {
+    notify();
+    std::this_thread::yield();
+  }
+  m_pushed++;
+}
+
+void CacheWorker::notify() {
+  // Locking the mutex ensures that the worker is either waiting, or will
+  // observe the enqueued accesses before waiting.
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_wake.notify_one();
+}
+
+void CacheWorker::drain() {
+  notify();
+  while (m_performed.load(std::memory_order_acquire) != m_pushed)
+    std::this_thread::yield();
+}
+
+void CacheWorker::run() {
+  Access access;
+  while (true) {
+    while (m_queue.pop(access)) {
+      m_cache->setAccessCycle(access.cycle);
+      m_cache->access(access.address, access.type, access.pc);
+      m_cache->setAccessCycle(std::nullopt);
+      m_performed.fetch_add(1, std::memory_order_release);
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_wake.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+    if (m_stop && m_queue.empty())
+      return;
+  }
+}
+
+} // namespace Ripes
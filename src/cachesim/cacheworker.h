@@ -0,0 +1,61 @@
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "cachesim.h"
+#include "spscqueue.h"
+
+namespace Ripes {
+
+/**
+ * @brief The CacheWorker class
+ * Performs the accesses to a cache simulator on a dedicated worker thread.
+ * Accesses are enqueued by a single producer (see L1CacheShim) through a
+ * lock-free queue, such that simulating the cache does not lengthen the
+ * critical path of the processor simulation.
+ *
+ * The cache, and any cache above it, must not be accessed by any other thread
+ * until drain() has returned.
+ */
+class CacheWorker {
+public:
+  struct Access {
+    AInt address = 0;
+    AInt pc = 0;
+    // The processor cycle in which the access was performed.
+    unsigned cycle = 0;
+    MemoryAccess::Type type = MemoryAccess::None;
+  };
+
+  CacheWorker(const std::shared_ptr<CacheInterface> &cache);
+  ~CacheWorker();
+
+  /// Enqueues @p access. If the queue is full, waits for the worker to catch
+  /// up.
+  void push(const Access &access);
+  /// Wakes up the worker to perform the enqueued accesses.
+  void notify();
+  /// Waits until all enqueued accesses have been performed.
+  void drain();
+
+private:
+  void run();
+
+  static constexpr size_t s_queueSize = 1 << 16;
+
+  std::shared_ptr<CacheInterface> m_cache;
+  SPSCQueue<Access> m_queue;
+  // Number of accesses enqueued by the producer, and performed by the worker.
+  uint64_t m_pushed = 0;
+  std::atomic<uint64_t> m_performed{0};
+
+  std::mutex m_mutex;
+  std::condition_variable m_wake;
+  bool m_stop = false;
+  std::thread m_thread;
+};
+
+} // namespace Ripes
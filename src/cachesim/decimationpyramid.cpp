@@ -0,0 +1,129 @@
+#include "decimationpyramid.h"
+
+#include <algorithm>
+
+namespace Ripes {
+
+void DecimationPyramid::merge(Bucket &bucket, float value, unsigned cycle) {
+  if (!bucket.valid) {
+    bucket = {value, value, cycle, cycle, true};
+    return;
+  }
+  if (value < bucket.min) {
+    bucket.min = value;
+    bucket.minCycle = cycle;
+  }
+  if (value > bucket.max) {
+    bucket.max = value;
+    bucket.maxCycle = cycle;
+  }
+}
+
+void DecimationPyramid::merge(Bucket &bucket, const Bucket &other) {
+  if (!other.valid)
+    return;
+  merge(bucket, other.min, other.minCycle);
+  merge(bucket, other.max, other.maxCycle);
+}
+
+void DecimationPyramid::clear() {
+  m_points.clear();
+  m_levels.clear();
+}
+
+void DecimationPyramid::append(unsigned cycle, double value) {
+  Q_ASSERT(m_points.empty() || cycle > m_points.back().cycle);
+  const float v = value;
+  if (m_levels.empty())
+    m_levels.resize(1);
+
+  // The previous value holds until this cycle, and thus extends through any
+  // level 0 buckets up until the bucket of this cycle.
+  auto &base = m_levels.front();
+  const unsigned idx = cycle / s_baseWidth;
+  while (base.size() <= idx) {
+    Bucket bucket;
+    const unsigned start = base.size() * s_baseWidth;
+    if (!m_points.empty() && start < cycle)
+      merge(bucket, m_points.back().value, start);
+    base.push_back(bucket);
+  }
+  merge(base[idx], v, cycle);
+  m_points.push_back({cycle, v});
+
+  // Recompute the buckets of each level which cover buckets of the level below
+  // that changed, until reaching a level of a single bucket.
+  for (unsigned level = 1; m_levels[level - 1].size() > 1; ++level) {
+    if (level == m_levels.size())
+      m_levels.emplace_back();
+    const auto &lower = m_levels[level - 1];
+    auto &buckets = m_levels[level];
+    const size_t first = buckets.empty() ? 0 : buckets.size() - 1;
+    buckets.resize((lower.size() + 1) / 2);
+    for (size_t i = first; i < buckets.size(); ++i) {
+      buckets[i] = lower[2 * i];
+      if (2 * i + 1 < lower.size())
+        merge(buckets[i], lower[2 * i + 1]);
+    }
+  }
+}
+
+QList<QPointF> DecimationPyramid::exact(unsigned fromCycle,
+                                        unsigned toCycle) const {
+  // Start from the value holding at fromCycle, and end with the first value
+  // past toCycle, such that the plot spans the entire range.
+  auto it = std::upper_bound(
+      m_points.begin(), m_points.end(), fromCycle,
+      [](unsigned cycle, const Point &point) { return cycle < point.cycle; });
+  if (it != m_points.begin())
+    --it;
+
+  QList<QPointF> points;
+  for (; it != m_points.end(); ++it) {
+    if (!points.empty())
+      points << QPointF(it->cycle, points.constLast().y());
+    points << QPointF(it->cycle, it->value);
+    if (it->cycle > toCycle)
+      break;
+  }
+  return points;
+}
+
+QList<QPointF> DecimationPyramid::decimate(unsigned fromCycle, unsigned toCycle,
+                                           unsigned buckets) const {
+  if (m_points.empty() || toCycle < fromCycle)
+    return {};
+  buckets = std::max(buckets, 1u);
+  const unsigned range = toCycle - fromCycle + 1;
+  if (range / s_baseWidth <= buckets)
+    return exact(fromCycle, toCycle);
+
+  // Select the finest level with no more than the requested number of buckets
+  // within the range.
+  unsigned level = 0;
+  while (level + 1 < m_levels.size() &&
+         (range >> level) / s_baseWidth > buckets)
+    level++;
+  const unsigned width = s_baseWidth << level;
+  const auto &levelBuckets = m_levels[level];
+
+  QList<QPointF> points;
+  for (size_t i = fromCycle / width;
+       i <= toCycle / width && i < levelBuckets.size(); ++i) {
+    const auto &bucket = levelBuckets[i];
+    if (!bucket.valid)
+      continue;
+    // Emit the extremes of the bucket in the order in which they occurred.
+    const QPointF min(bucket.minCycle, bucket.min);
+    const QPointF max(bucket.maxCycle, bucket.max);
+    if (bucket.minCycle == bucket.maxCycle)
+      points << min;
+    else if (bucket.minCycle < bucket.maxCycle)
+      points << min << max;
+    else
+      points << max << min;
+  }
+  return points;
+}
+
+} // namespace Ripes
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <QList>
+#include <QPointF>
+
+#include <vector>
+
+namespace Ripes {
+
+/**
+ * @brief The DecimationPyramid class
+ * Min/max decimation of a step function over cycles, for plotting. Each value
+ * holds from the cycle at which it was appended until the next appended value.
+ *
+ * Level 0 of the pyramid holds the minimum and maximum value within each
+ * bucket of s_baseWidth cycles, and each subsequent level holds buckets of
+ * twice the width of the level below. Appending a value updates the last
+ * bucket of each level, and decimating any range of cycles reads a single
+ * level, such that the cost of rendering a range depends on the number of
+ * points rendered rather than on the number of cycles in the range.
+ */
+class DecimationPyramid {
+public:
+  /// Appends @p value at @p cycle. Cycles must be strictly increasing.
+  void append(unsigned cycle, double value);
+  void clear();
+  bool empty() const { return m_points.empty(); }
+
+  /**
+   * @brief decimate
+   * Returns the points of a line plot of the values within [@p fromCycle,
+   * @p toCycle], with approximately @p buckets points per min/max pair. If
+   * the exact values fit within @p buckets buckets of level 0, the exact step
+   * function is returned.
+   */
+  QList<QPointF> decimate(unsigned fromCycle, unsigned toCycle,
+                          unsigned buckets) const;
+
+private:
+  static constexpr unsigned s_baseWidth = 16;
+
+  struct Point {
+    unsigned cycle;
+    float value;
+  };
+  struct Bucket {
+    float min = 0;
+    float max = 0;
+    unsigned minCycle = 0;
+    unsigned maxCycle = 0;
+    // Buckets preceding the first value are invalid.
+    bool valid = false;
+  };
+
+  static void merge(Bucket &bucket, float value, unsigned cycle);
+  static void merge(Bucket &bucket, const Bucket &other);
+  QList<QPointF> exact(unsigned fromCycle, unsigned toCycle) const;
+
+  std::vector<Point> m_points;
+  std::vector<std::vector<Bucket>> m_levels;
+};
+
+} // namespace Ripes
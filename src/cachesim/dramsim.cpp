@@ -0,0 +1,75 @@
+#include "dramsim.h"
+
+#include <algorithm>
+
+namespace Ripes {
+
+DRAMSim::DRAMSim(const DRAMConfig &config, QObject *parent)
+    : CacheInterface(parent), m_config(config), m_openRows(config.banks) {}
+
+void DRAMSim::access(AInt address, MemoryAccess::Type type, AInt) {
+  const AInt row = address / m_config.rowBytes;
+  auto &openRow = m_openRows.at(row % m_config.banks);
+  const AInt bankRow = row / m_config.banks;
+
+  unsigned latency = m_config.tRCD + m_config.tCAS;
+  if (openRow == bankRow) {
+    latency = m_config.tCAS;
+    m_rowHits++;
+  } else if (openRow) {
+    latency += m_config.tRP;
+    m_rowConflicts++;
+  } else {
+    m_rowMisses++;
+  }
+  if (m_config.policy == RowPolicy::Open)
+    openRow = bankRow;
+
+  if (type == MemoryAccess::Write) {
+    m_writes++;
+    return;
+  }
+  m_reads++;
+  m_readCycles += latency;
+  if (!m_firstReadLatency)
+    m_firstReadLatency = latency;
+}
+
+void DRAMSim::reset() {
+  std::fill(m_openRows.begin(), m_openRows.end(), std::nullopt);
+  m_firstReadLatency.reset();
+  m_reads = 0;
+  m_writes = 0;
+  m_readCycles = 0;
+  m_rowHits = 0;
+  m_rowMisses = 0;
+  m_rowConflicts = 0;
+}
+
+double DRAMSim::averageReadLatency() const {
+  if (m_reads == 0)
+    return m_config.tRCD + m_config.tCAS;
+  return static_cast<double>(m_readCycles) / m_reads;
+}
+
+QVariantMap DRAMSim::report() const {
+  QVariantMap m;
+  m["banks"] = m_config.banks;
+  m["row bytes"] = m_config.rowBytes;
+  m["page policy"] = m_config.policy == RowPolicy::Open ? "open" : "closed";
+  m["tRCD"] = m_config.tRCD;
+  m["tCAS"] = m_config.tCAS;
+  m["tRP"] = m_config.tRP;
+  m["reads"] = m_reads;
+  m["writes"] = m_writes;
+  m["row hits"] = m_rowHits;
+  m["row misses"] = m_rowMisses;
+  m["row conflicts"] = m_rowConflicts;
+  const unsigned long long accesses = m_reads + m_writes;
+  m["row hit rate"] =
+      accesses == 0 ? 0.0 : static_cast<double>(m_rowHits) / accesses;
+  m["average read latency"] = averageReadLatency();
+  return m;
+}
+
+} // namespace Ripes
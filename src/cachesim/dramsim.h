@@ -0,0 +1,88 @@
+#pragma once
+
+#include <QVariantMap>
+
+#include <optional>
+#include <vector>
+
+#include "cachesim.h"
+
+namespace Ripes {
+
+enum class RowPolicy { Open, Closed };
+
+/// Configuration of a DRAMSim. Timings are given in processor cycles.
+struct DRAMConfig {
+  // Number of banks and bytes of a row of each bank; powers of two.
+  unsigned banks = 8;
+  unsigned rowBytes = 2048;
+  RowPolicy policy = RowPolicy::Open;
+  // Row activation (RAS to CAS), column access and precharge latencies.
+  unsigned tRCD = 30;
+  unsigned tCAS = 30;
+  unsigned tRP = 30;
+};
+
+/**
+ * @brief The DRAMSim class
+ * A DRAM timing model behind the last level of a cache hierarchy. Addresses
+ * are interleaved across the banks row by row; an address maps to column
+ * (address % rowBytes) of row (address / rowBytes / banks) of bank
+ * (address / rowBytes % banks).
+ *
+ * Each bank holds a row buffer. With an open page policy, a row stays open
+ * after an access, such that an access to the open row (a row hit) takes
+ * tCAS, an access to a bank without an open row tRCD + tCAS, and an access to
+ * another row (a row conflict) tRP + tRCD + tCAS. With a closed page policy,
+ * rows are precharged after every access, in the background, such that every
+ * access takes tRCD + tCAS.
+ *
+ * Accesses are served one at a time; the model captures the row-buffer
+ * locality of the access order rather than bank parallelism, and the state of
+ * the banks is not restored by reverse().
+ */
+class DRAMSim : public CacheInterface {
+public:
+  DRAMSim(const DRAMConfig &config, QObject *parent = nullptr);
+
+  void access(AInt address, MemoryAccess::Type type, AInt pc = 0) override;
+  void reset() override;
+
+  /// Forgets the latency of the first read since the previous call; see
+  /// firstReadLatency().
+  void markReads() { m_firstReadLatency.reset(); }
+  /// Returns the latency of the first read since markReads() was called, if
+  /// any; the demand fetch of a miss, which precedes any prefetches it
+  /// triggers.
+  std::optional<unsigned> firstReadLatency() const {
+    return m_firstReadLatency;
+  }
+
+  const DRAMConfig &config() const { return m_config; }
+  unsigned long long reads() const { return m_reads; }
+  unsigned long long writes() const { return m_writes; }
+  unsigned long long rowHits() const { return m_rowHits; }
+  unsigned long long rowMisses() const { return m_rowMisses; }
+  unsigned long long rowConflicts() const { return m_rowConflicts; }
+  /// Returns the average latency of the reads, or tRCD + tCAS if no read was
+  /// performed.
+  double averageReadLatency() const;
+
+  /// Returns the access and row buffer statistics.
+  QVariantMap report() const;
+
+private:
+  DRAMConfig m_config;
+  // The open row of each bank, if any.
+  std::vector<std::optional<AInt>> m_openRows;
+  std::optional<unsigned> m_firstReadLatency;
+
+  unsigned long long m_reads = 0;
+  unsigned long long m_writes = 0;
+  unsigned long long m_readCycles = 0;
+  unsigned long long m_rowHits = 0;
+  unsigned long long m_rowMisses = 0;
+  unsigned long long m_rowConflicts = 0;
+};
+
+} // namespace Ripes
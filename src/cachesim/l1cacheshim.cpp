@@ -1,6 +1,7 @@
 #include "l1cacheshim.h"
 
 #include "processorhandler.h"
+#include "processors/interface/simprofiler.h"
 
 namespace Ripes {
 
@@ -15,19 +16,43 @@ L1CacheShim::L1CacheShim(CacheType type, QObject *parent)
   // (direct connection).
   connect(ProcessorHandler::get(), &ProcessorHandler::processorClocked, this,
           &L1CacheShim::processorWasClocked, Qt::DirectConnection);
+  connect(ProcessorHandler::get(), &ProcessorHandler::processorClockedBatch,
+          this, &L1CacheShim::processorWasClockedBatch, Qt::DirectConnection);
   connect(ProcessorHandler::get(), &ProcessorHandler::processorReversed, this,
           &L1CacheShim::processorReversed);
+  // Accesses performed asynchronously must be completed before the cache is
+  // shown, be it once running finishes or whilst refreshing a paced run. The
+  // handler thereby precedes any view of the cache, regardless of the order in
+  // which the views connected.
+  connect(
+      ProcessorHandler::get(), &ProcessorHandler::aboutToPresentState, this,
+      [=] {
+        if (m_worker)
+          m_worker->drain();
+      },
+      Qt::DirectConnection);
 
   processorReset();
 }
 
-void L1CacheShim::access(AInt, MemoryAccess::Type) {
+void L1CacheShim::access(AInt, MemoryAccess::Type, AInt) {
   // Should never occur; the shim determines accesses based on investigating the
   // associated memory.
   Q_ASSERT(false);
 }
 
+void L1CacheShim::setAsynchronous(bool enabled) {
+  if (m_worker)
+    m_worker->drain();
+  m_worker.reset();
+  if (enabled && m_nextLevelCache)
+    m_worker = std::make_unique<CacheWorker>(m_nextLevelCache);
+}
+
 void L1CacheShim::processorReset() {
+  if (m_worker)
+    m_worker->drain();
+
   // Propagate a reset through the cache hierarchy
   CacheInterface::reset();
 
@@ -40,33 +65,71 @@ void L1CacheShim::processorReset() {
 }
 
 void L1CacheShim::processorReversed() {
+  if (m_worker)
+    m_worker->drain();
   // Start propagating a reverse call through the cache hierarchy
   CacheInterface::reverse();
 }
 
 void L1CacheShim::processorWasClocked() {
+  // Single-stepped cycles are reflected in the graphical view immediately, and
+  // are thus performed synchronously.
+  if (m_worker)
+    m_worker->drain();
+  const auto *proc = ProcessorHandler::getProcessor();
+  // Memory is not accessed anew in cycles stalled on memory.
+  if (proc->memoryStalled())
+    recordAccess(MemoryAccess(), MemoryAccess(), proc->getCycleCount(), false);
+  else
+    recordAccess(proc->instrMemAccess(), proc->dataMemAccess(),
+                 proc->getCycleCount(), false);
+}
+
+void L1CacheShim::setTraceWriter(
+    const std::shared_ptr<AccessTraceWriter> &writer) {
+  m_traceWriter = writer;
+  if (m_traceWriter) {
+    const auto *proc = ProcessorHandler::getProcessor();
+    m_traceWriter->record(proc->instrMemAccess(), proc->dataMemAccess());
+  }
+}
+
+void L1CacheShim::processorWasClockedBatch() {
+  for (const auto &record : ProcessorHandler::getProcessor()->clockBatch())
+    recordAccess(record.instrAccess, record.dataAccess, record.cycle,
+                 m_worker != nullptr);
+  if (m_worker)
+    m_worker->notify();
+}
+
+void L1CacheShim::recordAccess(const MemoryAccess &instrAccess,
+                               const MemoryAccess &dataAccess, unsigned cycle,
+                               bool async) {
+  SimProfiler::Scope profile(SimProfiler::Caches);
+  if (m_traceWriter)
+    m_traceWriter->record(instrAccess, dataAccess);
+
+  if (!m_nextLevelCache)
+    return;
+
+  // Determine whether the memory is being accessed in the current cycle, and
+  // if so, the access type.
+  CacheWorker::Access access;
   if (m_type == CacheType::DataCache) {
-    const auto dataAccess = ProcessorHandler::getProcessor()->dataMemAccess();
-
-    // Determine whether the memory is being accessed in the current cycle, and
-    // if so, the access type.
-    switch (dataAccess.type) {
-    case MemoryAccess::Write:
-      m_nextLevelCache->access(dataAccess.address, MemoryAccess::Write);
-      break;
-    case MemoryAccess::Read:
-      m_nextLevelCache->access(dataAccess.address, MemoryAccess::Read);
-      break;
-    case MemoryAccess::None:
-    default:
-      break;
-    }
+    if (dataAccess.type == MemoryAccess::None)
+      return;
+    access = {dataAccess.address, dataAccess.pc, cycle, dataAccess.type};
   } else {
-    const auto instrAccess = ProcessorHandler::getProcessor()->instrMemAccess();
-    if (instrAccess.type == MemoryAccess::Read) {
-      m_nextLevelCache->access(instrAccess.address, MemoryAccess::Read);
-    }
+    if (instrAccess.type != MemoryAccess::Read)
+      return;
+    access = {instrAccess.address, instrAccess.address, cycle,
+              MemoryAccess::Read};
   }
+
+  if (async)
+    m_worker->push(access);
+  else
+    m_nextLevelCache->access(access.address, access.type, access.pc);
 }
 
 } // namespace Ripes
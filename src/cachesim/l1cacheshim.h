@@ -2,7 +2,9 @@
 
 #include <QObject>
 
+#include "accesstrace.h"
 #include "cachesim.h"
+#include "cacheworker.h"
 
 #include "VSRTL/core/vsrtl_memory.h"
 #include "isa/isa_types.h"
@@ -19,14 +21,38 @@ class L1CacheShim : public CacheInterface {
 public:
   enum class CacheType { DataCache, InstrCache };
   L1CacheShim(CacheType type, QObject *parent);
-  void access(AInt address, MemoryAccess::Type type) override;
+  void access(AInt address, MemoryAccess::Type type, AInt pc = 0) override;
 
   void setType(CacheType type);
 
+  /**
+   * @brief setTraceWriter
+   * Records both the instruction and data memory accesses of every subsequent
+   * processor cycle to @p writer, irrespective of the type of this shim. The
+   * accesses of the current cycle are recorded immediately. Reversing or
+   * resetting the processor does not affect the recorded trace. Pass nullptr
+   * to stop recording.
+   */
+  void setTraceWriter(const std::shared_ptr<AccessTraceWriter> &writer);
+
+  /**
+   * @brief setAsynchronous
+   * If @p enabled, the accesses of a running processor are performed on a
+   * worker thread of the next level cache (see CacheWorker), rather than on the
+   * processor thread. Accesses outside of a run, resets and reversals remain
+   * synchronous. The next level cache must be set beforehand, and must not be
+   * shared with other caches.
+   */
+  void setAsynchronous(bool enabled);
+
 private:
   void processorReset();
   void processorWasClocked();
+  void processorWasClockedBatch();
   void processorReversed();
+  void recordAccess(const MemoryAccess &instrAccess,
+                    const MemoryAccess &dataAccess, unsigned cycle,
+                    bool async);
 
   /**
    * @brief m_memory
@@ -35,6 +61,9 @@ private:
    * the given type of the memory.
    */
   CacheType m_type;
+
+  std::shared_ptr<AccessTraceWriter> m_traceWriter;
+  std::unique_ptr<CacheWorker> m_worker;
 };
 
 } // namespace Ripes
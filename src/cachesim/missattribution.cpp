@@ -0,0 +1,135 @@
+#include "missattribution.h"
+
+#include <QTextStream>
+#include <QVariantMap>
+
+#include <algorithm>
+#include <map>
+
+namespace Ripes {
+
+static void sortByMisses(std::vector<MissAttribution::Entry> &entries) {
+  std::stable_sort(entries.begin(), entries.end(),
+                   [](const auto &lhs, const auto &rhs) {
+                     if (lhs.misses != rhs.misses)
+                       return lhs.misses > rhs.misses;
+                     return lhs.address < rhs.address;
+                   });
+}
+
+static QString hex(AInt address) {
+  return "0x" + QString::number(address, 16).rightJustified(8, '0');
+}
+
+MissAttribution::MissAttribution(const CacheSim &cache,
+                                 const std::shared_ptr<const Program> &program)
+    : m_cache(cache), m_program(program) {}
+
+std::vector<MissAttribution::Entry>
+MissAttribution::instructions(unsigned top) const {
+  std::vector<Entry> entries;
+  for (const auto &[pc, counts] : m_cache.getPCAccesses())
+    if (counts.misses != 0)
+      entries.push_back({QString(), pc, counts.accesses, counts.misses});
+  sortByMisses(entries);
+  // Only the reported instructions are disassembled.
+  if (entries.size() > top)
+    entries.resize(top);
+  if (m_program) {
+    const auto &disassembled = m_program->getDisassembled();
+    for (auto &entry : entries)
+      entry.name = disassembled.getFromAddr(entry.address).value_or(QString());
+  }
+  return entries;
+}
+
+std::vector<MissAttribution::Entry> MissAttribution::symbols() const {
+  std::map<QString, Entry> bySymbol;
+  for (const auto &[address, misses] : m_cache.getAddressMisses()) {
+    Entry entry{s_unmapped};
+    if (m_program) {
+      for (const auto &[name, section] : m_program->sections) {
+        if (address < section.address ||
+            address >= section.address + section.size())
+          continue;
+        entry = {name, section.address};
+        auto symbol = m_program->symbols.upper_bound(address);
+        if (symbol != m_program->symbols.begin() &&
+            (--symbol)->first >= section.address)
+          entry = {symbol->second.v, symbol->first};
+        break;
+      }
+    }
+    auto it = bySymbol.try_emplace(entry.name, entry);
+    it.first->second.misses += misses;
+  }
+  std::vector<Entry> entries;
+  for (const auto &it : bySymbol)
+    entries.push_back(it.second);
+  sortByMisses(entries);
+  return entries;
+}
+
+QVariant MissAttribution::report(unsigned top, bool json) const {
+  const unsigned total = m_cache.getMisses();
+  const auto share = [&](unsigned misses) {
+    return total == 0 ? 0.0 : static_cast<double>(misses) / total;
+  };
+  const auto instrEntries = instructions(top);
+  auto symbolEntries = symbols();
+  if (symbolEntries.size() > top)
+    symbolEntries.resize(top);
+
+  if (json) {
+    const auto toList = [&](const std::vector<Entry> &entries,
+                            const QString &nameKey, bool accesses) {
+      QVariantList list;
+      for (const auto &entry : entries) {
+        QVariantMap m;
+        m[nameKey] = entry.name;
+        m["address"] = hex(entry.address);
+        m["misses"] = entry.misses;
+        m["miss share"] = share(entry.misses);
+        if (accesses) {
+          m["accesses"] = entry.accesses;
+          m["miss rate"] = entry.missRate();
+        }
+        list << m;
+      }
+      return list;
+    };
+    QVariantMap m;
+    m["misses"] = total;
+    m["instructions"] = toList(instrEntries, "instruction", true);
+    m["symbols"] = toList(symbolEntries, "symbol", false);
+    return m;
+  }
+
+  QString out;
+  QTextStream stream(&out);
+  stream << "Misses: " << total << "\n";
+  stream << "Missing instructions\n";
+  stream << qSetFieldWidth(12) << Qt::right << "misses" << "%" << "accesses"
+         << "miss rate" << qSetFieldWidth(0) << "  " << Qt::left << "address"
+         << "    instruction\n";
+  for (const auto &entry : instrEntries) {
+    stream << qSetFieldWidth(12) << Qt::right << entry.misses
+           << QString::number(share(entry.misses) * 100, 'f', 2)
+           << entry.accesses << QString::number(entry.missRate(), 'f', 4)
+           << qSetFieldWidth(0) << "  " << Qt::left << hex(entry.address)
+           << "  " << entry.name << "\n";
+  }
+  stream << "Missing symbols\n";
+  stream << qSetFieldWidth(12) << Qt::right << "misses" << "%"
+         << qSetFieldWidth(0) << "  " << Qt::left << "address"
+         << "    symbol\n";
+  for (const auto &entry : symbolEntries) {
+    stream << qSetFieldWidth(12) << Qt::right << entry.misses
+           << QString::number(share(entry.misses) * 100, 'f', 2)
+           << qSetFieldWidth(0) << "  " << Qt::left << hex(entry.address)
+           << "  " << entry.name << "\n";
+  }
+  return out;
+}
+
+} // namespace Ripes
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <QString>
+#include <QVariant>
+
+#include <memory>
+#include <vector>
+
+#include "assembler/program.h"
+#include "cachesim.h"
+
+namespace Ripes {
+
+/**
+ * @brief The MissAttribution class
+ * Attributes the demand misses of a cache to the instructions performing the
+ * accesses (see CacheSim::getPCAccesses), and to the symbols of a program
+ * containing the missed addresses; the data symbols for a data cache, and the
+ * functions for an instruction cache. A missed address is attributed to the
+ * closest preceding symbol within the section containing it, or otherwise to
+ * the section itself. Misses outside of the sections of the program, such as
+ * to the stack or the heap, are attributed to s_unmapped.
+ */
+class MissAttribution {
+public:
+  static constexpr const char *s_unmapped = "[unmapped]";
+
+  struct Entry {
+    QString name;
+    AInt address = 0;
+    // Symbols are not attributed any accesses, only misses.
+    unsigned accesses = 0;
+    unsigned misses = 0;
+
+    double missRate() const {
+      return accesses == 0 ? 0 : static_cast<double>(misses) / accesses;
+    }
+  };
+
+  MissAttribution(const CacheSim &cache,
+                  const std::shared_ptr<const Program> &program);
+
+  /// Returns the @p top instructions with the most misses, sorted by misses.
+  /// Entries are named by their disassembled instruction, if within the
+  /// program.
+  std::vector<Entry> instructions(unsigned top) const;
+  /// Returns the misses per symbol, sorted by misses. Entries are addressed by
+  /// their symbol, or by their section if attributed to its start.
+  std::vector<Entry> symbols() const;
+
+  /// Returns the @p top instructions and symbols with the most misses as
+  /// tables, or a map thereof if @p json is set.
+  QVariant report(unsigned top, bool json) const;
+
+private:
+  const CacheSim &m_cache;
+  std::shared_ptr<const Program> m_program;
+};
+
+} // namespace Ripes
@@ -0,0 +1,240 @@
+#include "mmu.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace Ripes {
+
+static constexpr unsigned s_pageOffsetBits = 12;
+
+// Bits of a page table entry.
+static constexpr unsigned s_valid = 1 << 0;
+static constexpr unsigned s_read = 1 << 1;
+static constexpr unsigned s_write = 1 << 2;
+static constexpr unsigned s_execute = 1 << 3;
+static constexpr unsigned s_ppnOffset = 10;
+
+static AInt levelPageBytes(unsigned level, unsigned vpnBits) {
+  return AInt(1) << (s_pageOffsetBits + level * vpnBits);
+}
+
+TLBSim::TLBSim(const TLBConfig &config, unsigned levels, unsigned vpnBits)
+    : m_config(config), m_levels(levels), m_vpnBits(vpnBits),
+      m_entries(1u << (config.sets + config.ways)) {}
+
+AInt TLBSim::pageBytes(unsigned level) const {
+  return levelPageBytes(level, m_vpnBits);
+}
+
+std::optional<PageTranslation> TLBSim::lookup(AInt address) {
+  ++m_time;
+  const unsigned ways = 1u << m_config.ways;
+  for (unsigned level = 0; level < m_levels; ++level) {
+    const AInt vpn = address >> (s_pageOffsetBits + level * m_vpnBits);
+    const auto set = m_entries.begin() + setIndex(vpn) * ways;
+    for (auto entry = set; entry != set + ways; ++entry) {
+      if (entry->valid && entry->translation.level == level &&
+          entry->translation.vpn == vpn) {
+        entry->used = m_time;
+        m_hits++;
+        return entry->translation;
+      }
+    }
+  }
+  m_misses++;
+  return {};
+}
+
+void TLBSim::insert(const PageTranslation &translation) {
+  ++m_time;
+  const unsigned ways = 1u << m_config.ways;
+  const auto set = m_entries.begin() + setIndex(translation.vpn) * ways;
+  auto victim = std::find_if(set, set + ways,
+                             [](const Entry &entry) { return !entry.valid; });
+  if (victim == set + ways) {
+    if (m_config.policy == ReplPolicy::Random) {
+      victim = set + std::rand() % ways;
+    } else if (m_config.policy == ReplPolicy::FIFO) {
+      victim = std::min_element(set, set + ways,
+                                [](const Entry &lhs, const Entry &rhs) {
+                                  return lhs.filled < rhs.filled;
+                                });
+    } else {
+      victim = std::min_element(set, set + ways,
+                                [](const Entry &lhs, const Entry &rhs) {
+                                  return lhs.used < rhs.used;
+                                });
+    }
+  }
+  *victim = {true, translation, m_time, m_time};
+}
+
+void TLBSim::reset() {
+  std::fill(m_entries.begin(), m_entries.end(), Entry());
+  m_time = 0;
+  m_hits = 0;
+  m_misses = 0;
+}
+
+double TLBSim::hitRate() const {
+  const unsigned lookups = m_hits + m_misses;
+  return lookups == 0 ? 0 : static_cast<double>(m_hits) / lookups;
+}
+
+AInt TLBSim::reach() const {
+  AInt bytes = 0;
+  for (const auto &entry : m_entries)
+    if (entry.valid)
+      bytes += pageBytes(entry.translation.level);
+  return bytes;
+}
+
+MMU::MMU(const MMUConfig &config, const MemoryReader &read)
+    : m_config(config), m_read(read),
+      m_vpnBits(config.mode == PagingMode::Sv32 ? 10 : 9),
+      m_instr(config.itlb, levels(), m_vpnBits),
+      m_data(config.dtlb, levels(), m_vpnBits) {}
+
+unsigned MMU::levels() const {
+  return m_config.mode == PagingMode::Sv32 ? 2 : 3;
+}
+
+AInt MMU::pageBytes(unsigned level) const {
+  return levelPageBytes(level, m_vpnBits);
+}
+
+void MMU::access(const MemoryAccess &instrAccess,
+                 const MemoryAccess &dataAccess) {
+  if (instrAccess.type == MemoryAccess::Read)
+    translate(instrAccess.address, MemoryAccess::Read, /*fetch=*/true);
+  if (dataAccess.type != MemoryAccess::None)
+    translate(dataAccess.address, dataAccess.type, /*fetch=*/false);
+}
+
+std::optional<AInt> MMU::translate(AInt address, MemoryAccess::Type type,
+                                   bool fetch) {
+  Side &side = fetch ? m_instr : m_data;
+  auto translation = side.tlb.lookup(address);
+  if (!translation) {
+    translation = walk(address, side);
+    if (!translation) {
+      side.faults++;
+      return {};
+    }
+    side.tlb.insert(*translation);
+  }
+  const auto translated = physical(*translation, address, type, fetch);
+  if (!translated)
+    side.faults++;
+  return translated;
+}
+
+std::optional<PageTranslation> MMU::walk(AInt address, Side &side) {
+  side.walks++;
+  const auto shift = [&](unsigned level) {
+    return s_pageOffsetBits + level * m_vpnBits;
+  };
+  if (!m_config.root) {
+    const unsigned level = std::min(m_config.pageLevel, levels() - 1);
+    side.entryReads += levels() - level;
+    const AInt vpn = address >> shift(level);
+    return PageTranslation{level, vpn, vpn, s_read | s_write | s_execute};
+  }
+
+  const unsigned entryBytes = m_config.mode == PagingMode::Sv32 ? 4 : 8;
+  const AInt ppnMask =
+      (AInt(1) << (m_config.mode == PagingMode::Sv32 ? 22 : 44)) - 1;
+  AInt table = *m_config.root;
+  for (unsigned level = levels(); level-- > 0;) {
+    const AInt index = (address >> shift(level)) & ((1u << m_vpnBits) - 1);
+    const VInt entry = m_read(table + index * entryBytes, entryBytes);
+    side.entryReads++;
+    if (!(entry & s_valid) || ((entry & s_write) && !(entry & s_read)))
+      return {};
+    const AInt ppn = (entry >> s_ppnOffset) & ppnMask;
+    if (entry & (s_read | s_execute)) {
+      // The page number of a superpage must be aligned to its size.
+      if (ppn & ((AInt(1) << (level * m_vpnBits)) - 1))
+        return {};
+      return PageTranslation{level, address >> shift(level),
+                             ppn >> (level * m_vpnBits),
+                             static_cast<unsigned>(entry) &
+                                 (s_read | s_write | s_execute)};
+    }
+    table = ppn << s_pageOffsetBits;
+  }
+  // The last level holds no leaf.
+  return {};
+}
+
+std::optional<AInt> MMU::physical(const PageTranslation &translation,
+                                  AInt address, MemoryAccess::Type type,
+                                  bool fetch) const {
+  const unsigned required = fetch                        ? s_execute
+                            : type == MemoryAccess::Write ? s_write
+                                                          : s_read;
+  if (!(translation.permissions & required))
+    return {};
+  const AInt bytes = pageBytes(translation.level);
+  return translation.ppn * bytes + (address & (bytes - 1));
+}
+
+void MMU::reset() {
+  for (auto *side : {&m_instr, &m_data}) {
+    side->tlb.reset();
+    side->walks = 0;
+    side->entryReads = 0;
+    side->faults = 0;
+  }
+}
+
+unsigned long long MMU::walks() const {
+  return m_instr.walks + m_data.walks;
+}
+
+unsigned long long MMU::pageFaults() const {
+  return m_instr.faults + m_data.faults;
+}
+
+unsigned long long MMU::stallCycles() const {
+  return (m_instr.entryReads + m_data.entryReads) * m_config.walkLatency;
+}
+
+QVariantMap MMU::sideReport(const Side &side) const {
+  QVariantMap m;
+  const auto &config = side.tlb.config();
+  m["entries"] = side.tlb.entries();
+  m["sets"] = 1u << config.sets;
+  m["ways"] = 1u << config.ways;
+  m["hits"] = side.tlb.hits();
+  m["misses"] = side.tlb.misses();
+  m["hit rate"] = side.tlb.hitRate();
+  m["page walks"] = side.walks;
+  m["page table reads"] = side.entryReads;
+  m["page faults"] = side.faults;
+  m["walk cycles"] = side.entryReads * m_config.walkLatency;
+  m["reach bytes"] = static_cast<qulonglong>(side.tlb.reach());
+  return m;
+}
+
+QVariantMap MMU::report() const {
+  QVariantMap m;
+  m["mode"] = m_config.mode == PagingMode::Sv32 ? "Sv32" : "Sv39";
+  if (m_config.root) {
+    m["page table"] =
+        "0x" + QString::number(*m_config.root, 16).rightJustified(8, '0');
+  } else {
+    m["page table"] = "identity";
+    m["page bytes"] = static_cast<qulonglong>(
+        pageBytes(std::min(m_config.pageLevel, levels() - 1)));
+  }
+  m["itlb"] = sideReport(m_instr);
+  m["dtlb"] = sideReport(m_data);
+  m["page walks"] = walks();
+  m["page faults"] = pageFaults();
+  m["walk latency"] = m_config.walkLatency;
+  m["stall cycles"] = stallCycles();
+  return m;
+}
+
+} // namespace Ripes
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <QVariantMap>
+
+#include <functional>
+#include <optional>
+#include <vector>
+
+#include "cachesim.h"
+
+namespace Ripes {
+
+enum class PagingMode { Sv32, Sv39 };
+
+/// Configuration of a TLBSim, in log2 values.
+struct TLBConfig {
+  unsigned sets = 0;
+  unsigned ways = 5;
+  // One of LRU, FIFO or Random.
+  ReplPolicy policy = ReplPolicy::LRU;
+};
+
+/// Configuration of an MMU. Latencies are given in cycles.
+struct MMUConfig {
+  PagingMode mode = PagingMode::Sv32;
+  // Physical address of the root page table in memory. If unset, virtual
+  // addresses are mapped onto the identical physical addresses, in pages of
+  // level pageLevel.
+  std::optional<AInt> root;
+  // Level of the pages of the identity mapping; 0 for base pages of 4 KiB,
+  // 1 for megapages (4 MiB in Sv32, 2 MiB in Sv39) and 2 for gigapages of
+  // 1 GiB (Sv39).
+  unsigned pageLevel = 0;
+  TLBConfig itlb;
+  TLBConfig dtlb;
+  // Latency of reading a page table entry during a page walk.
+  unsigned walkLatency = 100;
+};
+
+/// A translation of a page of virtual memory.
+struct PageTranslation {
+  // Page level of the translation (see MMUConfig::pageLevel).
+  unsigned level = 0;
+  // Virtual and physical page numbers, in pages of the level.
+  AInt vpn = 0;
+  AInt ppn = 0;
+  // The R, W and X bits of the leaf page table entry.
+  unsigned permissions = 0;
+};
+
+/**
+ * @brief The TLBSim class
+ * A set-associative translation lookaside buffer. Entries translate pages of
+ * any level; an entry is placed in the set indexed by the low bits of its
+ * page number, such that a lookup probes one set per page level.
+ */
+class TLBSim {
+public:
+  TLBSim(const TLBConfig &config, unsigned levels, unsigned vpnBits);
+
+  /// Returns the translation of @p address if held by the TLB, and counts the
+  /// lookup as a hit or a miss.
+  std::optional<PageTranslation> lookup(AInt address);
+  /// Inserts @p translation, evicting an entry of its set if full.
+  void insert(const PageTranslation &translation);
+  void reset();
+
+  const TLBConfig &config() const { return m_config; }
+  unsigned entries() const { return m_entries.size(); }
+  unsigned hits() const { return m_hits; }
+  unsigned misses() const { return m_misses; }
+  double hitRate() const;
+  /// Returns the number of bytes of memory translated by the valid entries.
+  AInt reach() const;
+
+private:
+  struct Entry {
+    bool valid = false;
+    PageTranslation translation;
+    // Times of the last lookup and of the insertion of the entry.
+    unsigned long long used = 0;
+    unsigned long long filled = 0;
+  };
+  AInt pageBytes(unsigned level) const;
+  unsigned setIndex(AInt vpn) const {
+    return vpn & ((1u << m_config.sets) - 1);
+  }
+
+  TLBConfig m_config;
+  unsigned m_levels;
+  unsigned m_vpnBits;
+  std::vector<Entry> m_entries;
+  unsigned long long m_time = 0;
+  unsigned m_hits = 0;
+  unsigned m_misses = 0;
+};
+
+/**
+ * @brief The MMU class
+ * A trace-driven model of virtual memory translation through Sv32 or Sv39
+ * page tables, with split instruction and data TLBs. Accesses missing their
+ * TLB walk the page tables from the root, reading one page table entry per
+ * level until reaching a leaf, such that the walks of superpages are shorter
+ * and their entries reach further. Each read costs MMUConfig::walkLatency
+ * cycles, which are reported as estimated stall cycles.
+ *
+ * Page tables are read from memory through a MemoryReader, and thus may be
+ * built by the program itself. Invalid entries, misaligned superpages and
+ * accesses not permitted by the R, W and X bits of their leaf are counted as
+ * page faults, and are not translated. Without a root page table, a walk of
+ * an identity mapping is modelled, which reads no memory.
+ */
+class MMU {
+public:
+  using MemoryReader = std::function<VInt(AInt address, unsigned bytes)>;
+
+  MMU(const MMUConfig &config, const MemoryReader &read = {});
+
+  /// Translates the memory accesses of a single cycle, for trace-driven
+  /// simulation.
+  void access(const MemoryAccess &instrAccess, const MemoryAccess &dataAccess);
+  /// Translates @p address, accessed by an instruction fetch if @p fetch is
+  /// set and otherwise by a load or store of @p type. Returns the physical
+  /// address, or nothing on a page fault.
+  std::optional<AInt> translate(AInt address, MemoryAccess::Type type,
+                                bool fetch);
+  void reset();
+
+  const MMUConfig &config() const { return m_config; }
+  const TLBSim &itlb() const { return m_instr.tlb; }
+  const TLBSim &dtlb() const { return m_data.tlb; }
+  unsigned levels() const;
+  /// Returns the number of bytes of a page of @p level.
+  AInt pageBytes(unsigned level) const;
+  unsigned long long walks() const;
+  unsigned long long pageFaults() const;
+  /// Returns the cycles spent walking the page tables.
+  unsigned long long stallCycles() const;
+
+  /// Returns the statistics of each TLB and of their page walks.
+  QVariantMap report() const;
+
+private:
+  struct Side {
+    Side(const TLBConfig &config, unsigned levels, unsigned vpnBits)
+        : tlb(config, levels, vpnBits) {}
+    TLBSim tlb;
+    unsigned long long walks = 0;
+    unsigned long long entryReads = 0;
+    unsigned long long faults = 0;
+  };
+
+  /// Walks the page tables for the page of @p address, counting the walk in
+  /// @p side.
+  std::optional<PageTranslation> walk(AInt address, Side &side);
+  /// Returns the physical address of @p address within @p translation,
+  /// if permitted.
+  std::optional<AInt> physical(const PageTranslation &translation,
+                               AInt address, MemoryAccess::Type type,
+                               bool fetch) const;
+  QVariantMap sideReport(const Side &side) const;
+
+  MMUConfig m_config;
+  MemoryReader m_read;
+  unsigned m_vpnBits;
+  Side m_instr;
+  Side m_data;
+};
+
+} // namespace Ripes
@@ -0,0 +1,120 @@
+#include "prefetcher.h"
+
+#include <algorithm>
+
+namespace Ripes {
+
+std::unique_ptr<Prefetcher> Prefetcher::create(const PrefetchConfig &config,
+                                               unsigned blockBits) {
+  switch (config.type) {
+  case PrefetcherType::None:
+    return nullptr;
+  case PrefetcherType::NextLine:
+    return std::make_unique<NextLinePrefetcher>(blockBits, config.degree);
+  case PrefetcherType::Stride:
+    return std::make_unique<StridePrefetcher>(blockBits, config.degree);
+  case PrefetcherType::Stream:
+    return std::make_unique<StreamPrefetcher>(blockBits, config.degree);
+  }
+  return nullptr;
+}
+
+void NextLinePrefetcher::access(const Access &access,
+                                std::vector<AInt> &prefetches) {
+  if (access.hit && !access.prefetchHit)
+    return;
+  const AInt accessBlock = block(access.address);
+  for (unsigned i = 1; i <= m_degree; ++i)
+    prefetches.push_back(blockAddress(accessBlock + i));
+}
+
+StridePrefetcher::StridePrefetcher(unsigned blockBits, unsigned degree)
+    : Prefetcher(blockBits, degree), m_table(s_entries) {}
+
+void StridePrefetcher::access(const Access &access,
+                              std::vector<AInt> &prefetches) {
+  auto &entry = m_table[(access.pc >> 2) % s_entries];
+  if (!entry.valid || entry.pc != access.pc) {
+    entry = Entry();
+    entry.pc = access.pc;
+    entry.address = access.address;
+    entry.valid = true;
+    return;
+  }
+
+  const AIntS stride = static_cast<AIntS>(access.address - entry.address);
+  const bool correct = stride == entry.stride;
+  switch (entry.state) {
+  case State::Initial:
+    entry.state = correct ? State::Steady : State::Transient;
+    break;
+  case State::Transient:
+    entry.state = correct ? State::Steady : State::NoPrediction;
+    break;
+  case State::Steady:
+    // Keep the stride of a steady entry on a single misprediction.
+    entry.state = correct ? State::Steady : State::Initial;
+    break;
+  case State::NoPrediction:
+    entry.state = correct ? State::Transient : State::NoPrediction;
+    break;
+  }
+  if (!correct && entry.state != State::Initial)
+    entry.stride = stride;
+  entry.address = access.address;
+
+  if (entry.state != State::Steady || entry.stride == 0)
+    return;
+  for (unsigned i = 1; i <= m_degree; ++i)
+    prefetches.push_back(access.address + entry.stride * static_cast<AIntS>(i));
+}
+
+StreamPrefetcher::StreamPrefetcher(unsigned blockBits, unsigned degree)
+    : Prefetcher(blockBits, degree), m_streams(s_streams) {}
+
+void StreamPrefetcher::access(const Access &access,
+                              std::vector<AInt> &prefetches) {
+  if (access.hit && !access.prefetchHit)
+    return;
+  m_accesses++;
+
+  // A stream matches an access within the prefetched blocks ahead of it, or,
+  // if its direction is not yet established, an access adjacent to it.
+  const AInt accessBlock = block(access.address);
+  const AIntS window = m_degree + 1;
+  auto it = std::find_if(
+      m_streams.begin(), m_streams.end(), [&](const Stream &stream) {
+        if (!stream.valid)
+          return false;
+        const AIntS distance = static_cast<AIntS>(accessBlock - stream.block);
+        if (stream.direction == 0)
+          return distance == 1 || distance == -1;
+        const AIntS ahead = distance * stream.direction;
+        return ahead > 0 && ahead <= window;
+      });
+
+  if (it == m_streams.end()) {
+    // Allocate a new stream in place of the least recently used one.
+    it = std::min_element(m_streams.begin(), m_streams.end(),
+                          [](const Stream &lhs, const Stream &rhs) {
+                            return lhs.valid == rhs.valid
+                                       ? lhs.lastUse < rhs.lastUse
+                                       : !lhs.valid;
+                          });
+    *it = Stream();
+    it->block = accessBlock;
+    it->lastUse = m_accesses;
+    it->valid = true;
+    return;
+  }
+
+  if (it->direction == 0)
+    it->direction = accessBlock > it->block ? 1 : -1;
+  it->block = accessBlock;
+  it->lastUse = m_accesses;
+  for (unsigned i = 1; i <= m_degree; ++i)
+    prefetches.push_back(
+        blockAddress(accessBlock + static_cast<AIntS>(i) * it->direction));
+}
+
+} // namespace Ripes
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <QString>
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "isa/isa_types.h"
+
+namespace Ripes {
+
+enum class PrefetcherType { None, NextLine, Stride, Stream };
+
+const static std::map<PrefetcherType, QString> s_prefetcherTypeStrings{
+    {PrefetcherType::None, "None"},
+    {PrefetcherType::NextLine, "Next-line"},
+    {PrefetcherType::Stride, "Stride"},
+    {PrefetcherType::Stream, "Stream"}};
+
+struct PrefetchConfig {
+  PrefetcherType type = PrefetcherType::None;
+  // Number of blocks which are prefetched ahead of the access stream.
+  unsigned degree = 1;
+};
+
+/// Prefetch statistics of a cache.
+struct PrefetchStats {
+  // Blocks brought into the cache by prefetches.
+  long long issued = 0;
+  // Prefetched blocks which were subsequently hit by a demand access.
+  long long useful = 0;
+  // Demand misses to blocks which were evicted by prefetches.
+  long long pollution = 0;
+  // Writebacks of dirty blocks evicted by prefetches.
+  long long writebacks = 0;
+
+  /// Fraction of prefetched blocks which were used.
+  double accuracy() const {
+    return issued == 0 ? 0 : static_cast<double>(useful) / issued;
+  }
+  /// Fraction of the misses in absence of prefetching which were eliminated,
+  /// given the number of remaining demand @p misses.
+  double coverage(long long misses) const {
+    const long long total = useful + misses;
+    return total == 0 ? 0 : static_cast<double>(useful) / total;
+  }
+};
+
+/**
+ * @brief The Prefetcher class
+ * A hardware prefetcher placed in front of a CacheSim. The prefetcher is
+ * trained on the demand accesses to the cache, and returns the addresses of
+ * the blocks which should be prefetched into the cache.
+ */
+class Prefetcher {
+public:
+  struct Access {
+    AInt address;
+    // Address of the instruction performing the access.
+    AInt pc;
+    bool hit;
+    // True if the access hit a block which was brought in by a prefetch and
+    // not yet used.
+    bool prefetchHit;
+  };
+
+  Prefetcher(unsigned blockBits, unsigned degree)
+      : m_blockBits(blockBits), m_degree(degree) {}
+  virtual ~Prefetcher() {}
+
+  /// Trains the prefetcher on @p access, and appends the addresses of the
+  /// blocks to prefetch to @p prefetches.
+  virtual void access(const Access &access, std::vector<AInt> &prefetches) = 0;
+
+  /// Returns a prefetcher as per @p config, or nullptr if no prefetcher is
+  /// configured. @p blockBits is the number of address bits addressing the
+  /// bytes of a cache block.
+  static std::unique_ptr<Prefetcher> create(const PrefetchConfig &config,
+                                            unsigned blockBits);
+
+protected:
+  AInt block(AInt address) const { return address >> m_blockBits; }
+  AInt blockAddress(AInt block) const { return block << m_blockBits; }
+
+  unsigned m_blockBits;
+  unsigned m_degree;
+};
+
+/**
+ * @brief The NextLinePrefetcher class
+ * Prefetches the blocks following a block which missed, or which was hit for
+ * the first time after being prefetched (tagged prefetching).
+ */
+class NextLinePrefetcher : public Prefetcher {
+public:
+  using Prefetcher::Prefetcher;
+  void access(const Access &access, std::vector<AInt> &prefetches) override;
+};
+
+/**
+ * @brief The StridePrefetcher class
+ * A reference prediction table (Chen & Baer), indexed by the address of the
+ * accessing instruction. Each entry tracks the last address and stride of an
+ * instruction, and prefetches along the stride once the stride has been
+ * observed repeatedly.
+ */
+class StridePrefetcher : public Prefetcher {
+public:
+  StridePrefetcher(unsigned blockBits, unsigned degree);
+  void access(const Access &access, std::vector<AInt> &prefetches) override;
+
+private:
+  static constexpr unsigned s_entries = 64;
+  enum class State { Initial, Transient, Steady, NoPrediction };
+  struct Entry {
+    AInt pc = 0;
+    AInt address = 0;
+    AIntS stride = 0;
+    State state = State::Initial;
+    bool valid = false;
+  };
+  std::vector<Entry> m_table;
+};
+
+/**
+ * @brief The StreamPrefetcher class
+ * Tracks a number of streams of misses to consecutive blocks. Once the
+ * direction of a stream has been established, the blocks ahead of the stream
+ * are prefetched on each miss or prefetch hit within the stream.
+ */
+class StreamPrefetcher : public Prefetcher {
+public:
+  StreamPrefetcher(unsigned blockBits, unsigned degree);
+  void access(const Access &access, std::vector<AInt> &prefetches) override;
+
+private:
+  static constexpr unsigned s_streams = 8;
+  struct Stream {
+    AInt block = 0;
+    // Direction of the stream (1 or -1), or 0 if not yet established.
+    int direction = 0;
+    unsigned lastUse = 0;
+    bool valid = false;
+  };
+  std::vector<Stream> m_streams;
+  unsigned m_accesses = 0;
+};
+
+} // namespace Ripes
@@ -0,0 +1,174 @@
+#include "reuseanalysis.h"
+
+#include <QStringList>
+#include <QVariantList>
+
+#include <algorithm>
+#include <numeric>
+
+namespace Ripes {
+
+static constexpr size_t s_minCapacity = 1024;
+
+ReuseAnalysis::ReuseAnalysis(unsigned byteOffset, unsigned blocks,
+                             unsigned window)
+    : m_blockBits(byteOffset + blocks), m_window(std::max(window, 1u)) {}
+
+void ReuseAnalysis::mark(size_t time, int delta) {
+  for (size_t i = time; i < m_tree.size(); i += i & (~i + 1))
+    m_tree[i] += delta;
+}
+
+long long ReuseAnalysis::marks(size_t time) const {
+  long long sum = 0;
+  for (size_t i = time; i > 0; i -= i & (~i + 1))
+    sum += m_tree[i];
+  return sum;
+}
+
+void ReuseAnalysis::compact() {
+  std::vector<Block *> blocks;
+  blocks.reserve(m_blocks.size());
+  for (auto &it : m_blocks)
+    blocks.push_back(&it.second);
+  std::sort(blocks.begin(), blocks.end(),
+            [](const Block *lhs, const Block *rhs) {
+              return lhs->time < rhs->time;
+            });
+
+  // The most recent accesses to the blocks are renumbered in order, and the
+  // tree is rebuilt in linear time.
+  const size_t capacity = std::max(2 * blocks.size(), s_minCapacity);
+  m_tree.assign(capacity + 1, 0);
+  for (size_t i = 1; i <= blocks.size(); ++i) {
+    blocks[i - 1]->time = i;
+    m_tree[i] = 1;
+  }
+  for (size_t i = 1; i <= capacity; ++i) {
+    const size_t parent = i + (i & (~i + 1));
+    if (parent <= capacity)
+      m_tree[parent] += m_tree[i];
+  }
+  m_time = blocks.size();
+}
+
+void ReuseAnalysis::access(AInt address, long long cycle) {
+  m_accesses++;
+
+  const long long windowIndex = cycle / m_window;
+  if (windowIndex > m_windowIndex) {
+    // Windows without accesses have an empty working set.
+    m_workingSets.push_back(m_workingSet);
+    m_workingSets.resize(windowIndex, 0);
+    m_windowIndex = windowIndex;
+    m_workingSet = 0;
+  }
+  const long long windowStart = m_windowIndex * m_window;
+
+  if (m_time + 1 >= m_tree.size())
+    compact();
+  const size_t time = ++m_time;
+  auto [it, inserted] = m_blocks.try_emplace(address >> m_blockBits);
+  Block &block = it->second;
+  if (inserted) {
+    m_coldAccesses++;
+    m_workingSet++;
+  } else {
+    long long distance = marks(time - 1) - marks(block.time);
+    unsigned bucket = 0;
+    for (; distance != 0; distance >>= 1)
+      bucket++;
+    if (bucket >= m_histogram.size())
+      m_histogram.resize(bucket + 1, 0);
+    m_histogram[bucket]++;
+    mark(block.time, -1);
+    if (block.cycle < windowStart)
+      m_workingSet++;
+  }
+  mark(time, 1);
+  block.time = time;
+  block.cycle = cycle;
+}
+
+double ReuseAnalysis::hitRate(unsigned log2Blocks) const {
+  if (m_accesses == 0)
+    return 0;
+  const size_t buckets =
+      std::min(static_cast<size_t>(log2Blocks) + 1, m_histogram.size());
+  const long long hits = std::accumulate(
+      m_histogram.begin(), m_histogram.begin() + buckets, 0LL);
+  return static_cast<double>(hits) / m_accesses;
+}
+
+std::vector<unsigned> ReuseAnalysis::workingSets() const {
+  auto sets = m_workingSets;
+  if (m_accesses != 0)
+    sets.push_back(m_workingSet);
+  return sets;
+}
+
+/// Returns the range of reuse distances of histogram bucket @p bucket.
+static QString distances(unsigned bucket) {
+  if (bucket <= 1)
+    return QString::number(bucket);
+  return QString::number(1ull << (bucket - 1)) + "-" +
+         QString::number((1ull << bucket) - 1);
+}
+
+QVariantMap ReuseAnalysis::toVariantMap() const {
+  QVariantMap m;
+  m["block bytes"] = blockBytes();
+  m["accesses"] = m_accesses;
+  m["cold accesses"] = m_coldAccesses;
+  QVariantList histogram;
+  for (unsigned i = 0; i < m_histogram.size(); ++i) {
+    QVariantMap bucket;
+    bucket["distance"] = distances(i);
+    bucket["accesses"] = m_histogram[i];
+    bucket["LRU blocks"] = 1ull << i;
+    bucket["LRU hit rate"] = hitRate(i);
+    histogram << bucket;
+  }
+  m["histogram"] = histogram;
+
+  auto sets = workingSets();
+  QVariantMap workingSet;
+  workingSet["window cycles"] = m_window;
+  workingSet["windows"] = static_cast<qulonglong>(sets.size());
+  if (!sets.empty()) {
+    const double total = std::accumulate(sets.begin(), sets.end(), 0.0);
+    workingSet["mean blocks"] = total / sets.size();
+    workingSet["max blocks"] = *std::max_element(sets.begin(), sets.end());
+    std::nth_element(sets.begin(), sets.begin() + sets.size() / 2, sets.end());
+    workingSet["median blocks"] = sets[sets.size() / 2];
+  }
+  m["working set"] = workingSet;
+  return m;
+}
+
+QString ReuseAnalysis::toTable() const {
+  QString table = "distance\taccesses\tLRU blocks\tLRU hit rate\n";
+  for (unsigned i = 0; i < m_histogram.size(); ++i) {
+    table += QStringList({distances(i), QString::number(m_histogram[i]),
+                          QString::number(1ull << i),
+                          QString::number(hitRate(i), 'f', 4)})
+                 .join('\t') +
+             '\n';
+  }
+  table += "cold\t" + QString::number(m_coldAccesses) + "\n";
+
+  const auto workingSet = toVariantMap()["working set"].toMap();
+  table += "\nWorking set (blocks of " + QString::number(blockBytes()) +
+           " bytes, windows of " + QString::number(m_window) + " cycles):\n";
+  table += "windows\tmean\tmedian\tmax\n";
+  table += QStringList({workingSet["windows"].toString(),
+                        QString::number(workingSet["mean blocks"].toDouble(),
+                                        'f', 1),
+                        workingSet["median blocks"].toString(),
+                        workingSet["max blocks"].toString()})
+               .join('\t') +
+           '\n';
+  return table;
+}
+
+} // namespace Ripes
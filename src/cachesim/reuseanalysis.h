@@ -0,0 +1,95 @@
+#pragma once
+
+#include <QString>
+#include <QVariantMap>
+
+#include <unordered_map>
+#include <vector>
+
+#include "isa/isa_types.h"
+
+namespace Ripes {
+
+/**
+ * @brief The ReuseAnalysis class
+ * Computes the reuse-distance histogram of a memory access stream, and its
+ * working-set size over windows of cycles.
+ *
+ * The reuse distance of an access is the number of distinct blocks accessed
+ * since the previous access to its block. An access of reuse distance d hits
+ * in a fully associative LRU cache of more than d blocks, such that the
+ * histogram predicts the hit rate of every cache capacity from a single pass.
+ * Distances are counted in O(log n) per access by a Fenwick tree over the
+ * accesses, in which the most recent access to each block is marked; the
+ * distance of an access is the number of marks following the previous access
+ * to its block. The tree is compacted once full, such that it holds at most
+ * twice as many accesses as there are distinct blocks.
+ *
+ * The working set of a window is the set of distinct blocks accessed within
+ * it. Windows are consecutive, non-overlapping ranges of a fixed number of
+ * cycles, starting from cycle 0.
+ *
+ * As in CacheSweep, blocks are given as a log2 number of words.
+ */
+class ReuseAnalysis {
+public:
+  /// @p byteOffset is the number of address bits addressing the bytes of a
+  /// word, @p blocks the log2 number of words of a block and @p window the
+  /// number of cycles of a working-set window.
+  ReuseAnalysis(unsigned byteOffset, unsigned blocks, unsigned window);
+
+  void access(AInt address, long long cycle);
+
+  long long accesses() const { return m_accesses; }
+  /// Returns the number of first accesses to a block, which have no reuse
+  /// distance.
+  long long coldAccesses() const { return m_coldAccesses; }
+  /// Returns the number of accesses per reuse distance bucket, where bucket 0
+  /// holds distance 0 and bucket i > 0 the distances [2^(i-1), 2^i).
+  const std::vector<long long> &histogram() const { return m_histogram; }
+  /// Returns the hit rate of a fully associative LRU cache of 2^@p log2Blocks
+  /// blocks.
+  double hitRate(unsigned log2Blocks) const;
+
+  /// Returns the working-set sizes, in blocks, of each window up to and
+  /// including the window of the most recent access.
+  std::vector<unsigned> workingSets() const;
+  unsigned blockBytes() const { return 1u << m_blockBits; }
+  unsigned window() const { return m_window; }
+
+  /// Returns the results as a map, suitable for reporting.
+  QVariantMap toVariantMap() const;
+  /// Returns the results as tab-separated tables with header rows.
+  QString toTable() const;
+
+private:
+  /// Adds @p delta to the mark of access @p time.
+  void mark(size_t time, int delta);
+  /// Returns the number of marks of the accesses in [1 : time].
+  long long marks(size_t time) const;
+  /// Renumbers the most recent accesses to each block consecutively from 1.
+  void compact();
+
+  struct Block {
+    size_t time = 0;
+    long long cycle = 0;
+  };
+
+  unsigned m_blockBits;
+  unsigned m_window;
+  // Fenwick tree over the accesses, indexed from 1 by access time.
+  std::vector<int> m_tree;
+  size_t m_time = 0;
+  std::unordered_map<AInt, Block> m_blocks;
+
+  long long m_accesses = 0;
+  long long m_coldAccesses = 0;
+  std::vector<long long> m_histogram;
+
+  // Working-set sizes of the completed windows, and of the current window.
+  std::vector<unsigned> m_workingSets;
+  long long m_windowIndex = 0;
+  unsigned m_workingSet = 0;
+};
+
+} // namespace Ripes
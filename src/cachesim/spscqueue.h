@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace Ripes {
+
+/**
+ * @brief The SPSCQueue class
+ * A bounded, lock-free queue between a single producer and a single consumer
+ * thread. The capacity is rounded up to a power of two. Each side caches the
+ * last observed index of the other side, such that the shared indices are only
+ * read when the queue appears to be full or empty.
+ */
+template <typename T>
+class SPSCQueue {
+public:
+  explicit SPSCQueue(size_t capacity) {
+    size_t size = 1;
+    while (size < capacity)
+      size <<= 1;
+    m_buffer.resize(size);
+    m_mask = size - 1;
+  }
+
+  /// Enqueues @p value. Returns false if the queue is full. May only be called
+  /// by the producer.
+  bool push(const T &value) {
+    const size_t head = m_head.load(std::memory_order_relaxed);
+    if (head - m_cachedTail > m_mask) {
+      m_cachedTail = m_tail.load(std::memory_order_acquire);
+      if (head - m_cachedTail > m_mask)
+        return false;
+    }
+    m_buffer[head & m_mask] = value;
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// Dequeues the oldest value into @p value. Returns false if the queue is
+  /// empty. May only be called by the consumer.
+  bool pop(T &value) {
+    const size_t tail = m_tail.load(std::memory_order_relaxed);
+    if (tail == m_cachedHead) {
+      m_cachedHead = m_head.load(std::memory_order_acquire);
+      if (tail == m_cachedHead)
+        return false;
+    }
+    value = m_buffer[tail & m_mask];
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool empty() const {
+    return m_head.load(std::memory_order_acquire) ==
+           m_tail.load(std::memory_order_acquire);
+  }
+
+private:
+  std::vector<T> m_buffer;
+  size_t m_mask = 0;
+
+  // The producer and consumer indices are kept on separate cache lines to
+  // avoid false sharing.
+  alignas(64) std::atomic<size_t> m_head{0};
+  size_t m_cachedTail = 0;
+  alignas(64) std::atomic<size_t> m_tail{0};
+  size_t m_cachedHead = 0;
+};
+
+} // namespace Ripes
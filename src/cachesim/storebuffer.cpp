@@ -0,0 +1,100 @@
+#include "storebuffer.h"
+
+#include <algorithm>
+
+namespace Ripes {
+
+StoreBuffer::StoreBuffer(const StoreBufferConfig &config, unsigned blockBytes,
+                         const WriteFunction &write)
+    : m_config(config), m_blockBytes(blockBytes), m_write(write) {}
+
+void StoreBuffer::advance(long long now) {
+  while (!m_entries.empty()) {
+    Entry &entry = m_entries.front();
+    if (entry.done < 0) {
+      const long long start = std::max(m_portFree, entry.ready);
+      if (start > now)
+        break;
+      const MemoryAccess access{MemoryAccess::Write, entry.begin,
+                                unsigned(entry.end - entry.begin), entry.pc};
+      entry.done = start + 1 + m_write(access);
+    }
+    if (entry.done > now)
+      break;
+    m_portFree = entry.done;
+    m_entries.pop_front();
+    m_stats.drained++;
+  }
+}
+
+long long StoreBuffer::drainThrough(size_t index, long long now) {
+  const long long target = m_stats.drained + index + 1;
+  long long cycle = now;
+  advance(cycle);
+  while (m_stats.drained < target) {
+    const Entry &front = m_entries.front();
+    cycle = front.done >= 0 ? front.done
+                            : std::max({cycle, m_portFree, front.ready});
+    advance(cycle);
+  }
+  return cycle;
+}
+
+unsigned StoreBuffer::store(const MemoryAccess &store, long long now) {
+  m_stats.stores++;
+  if (m_config.writeCombining && !m_entries.empty()) {
+    Entry &youngest = m_entries.back();
+    if (youngest.done < 0 && youngest.end == store.address &&
+        youngest.begin / m_blockBytes ==
+            (store.address + store.bytes - 1) / m_blockBytes) {
+      youngest.end += store.bytes;
+      m_stats.combined++;
+      return 0;
+    }
+  }
+
+  unsigned stall = 0;
+  if (m_entries.size() >= m_config.entries) {
+    stall = drainThrough(0, now) - now;
+    m_stats.fullStalls += stall;
+  }
+  m_entries.push_back({store.address, store.address + store.bytes, store.pc,
+                       now + stall + 1});
+  return stall;
+}
+
+unsigned StoreBuffer::load(const MemoryAccess &load, long long now,
+                           bool &forwarded) {
+  forwarded = false;
+  const AInt begin = load.address;
+  const AInt end = begin + load.bytes;
+  // The youngest overlapping store holds the latest data of the bytes.
+  for (size_t i = m_entries.size(); i-- > 0;) {
+    const Entry &entry = m_entries.at(i);
+    if (entry.end <= begin || end <= entry.begin)
+      continue;
+    if (entry.begin <= begin && end <= entry.end) {
+      forwarded = true;
+      m_stats.forwarded++;
+      return 0;
+    }
+    const unsigned stall = drainThrough(i, now) - now;
+    m_stats.conflictStalls += stall;
+    return stall;
+  }
+  return 0;
+}
+
+void StoreBuffer::sample(long long cycles) {
+  m_stats.occupancy += cycles * m_entries.size();
+  m_stats.maxOccupancy =
+      std::max(m_stats.maxOccupancy, unsigned(m_entries.size()));
+}
+
+void StoreBuffer::reset() {
+  m_entries.clear();
+  m_portFree = 0;
+  m_stats = StoreBufferStats();
+}
+
+} // namespace Ripes
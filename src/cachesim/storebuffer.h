@@ -0,0 +1,111 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+
+#include "processors/interface/ripesprocessor.h"
+
+namespace Ripes {
+
+struct StoreBufferConfig {
+  // Entries of the store buffer. 0 disables the buffer, such that stores
+  // access the data cache as they execute.
+  unsigned entries = 0;
+  // Merge a store to the bytes following those of the youngest entry, within
+  // the same cache block, into the entry.
+  bool writeCombining = false;
+};
+
+/// Statistics of a store buffer.
+struct StoreBufferStats {
+  // Stores entering the buffer, and of these, stores merged into an entry.
+  long long stores = 0;
+  long long combined = 0;
+  // Entries written to the data cache.
+  long long drained = 0;
+  // Loads forwarded the data of a buffered store.
+  long long forwarded = 0;
+  // Cycles stalled on a full buffer, and on loads partially overlapping a
+  // buffered store, which wait for the store to drain.
+  long long fullStalls = 0;
+  long long conflictStalls = 0;
+  // Sum of the occupied entries of each cycle, and the maximum occupancy.
+  long long occupancy = 0;
+  unsigned maxOccupancy = 0;
+
+  double averageOccupancy(long long cycles) const {
+    return cycles == 0 ? 0 : static_cast<double>(occupancy) / cycles;
+  }
+};
+
+/**
+ * @brief The StoreBuffer class
+ * A FIFO of stores between the memory stage of a processor and its data cache.
+ * Stores retire into the buffer rather than stalling on the data cache, and
+ * the buffer drains its oldest entry to the cache through a single write port,
+ * the port being occupied by an entry for the latency of its write. Stores
+ * only stall once the buffer is full, until its oldest entry has drained.
+ *
+ * Loads whose bytes are covered by a buffered store are forwarded the data of
+ * the store, without accessing the data cache. Loads overlapping a buffered
+ * store only in part wait for the store to drain.
+ *
+ * With write combining, a store to the bytes following those of the youngest
+ * entry, within the same cache block, is merged into the entry unless the
+ * entry has started draining, such that sequential stores drain as a single
+ * write.
+ *
+ * Time is given as a cycle count which must never decrease.
+ */
+class StoreBuffer {
+public:
+  /// Writes a drained entry to the data cache, returning the cycles beyond the
+  /// first, which the write takes.
+  using WriteFunction = std::function<unsigned(const MemoryAccess &access)>;
+
+  StoreBuffer(const StoreBufferConfig &config, unsigned blockBytes,
+              const WriteFunction &write);
+
+  /// Drains the entries whose drain starts by cycle @p now.
+  void advance(long long now);
+  /// Buffers @p store in cycle @p now, and returns the cycles stalled on a
+  /// full buffer.
+  unsigned store(const MemoryAccess &store, long long now);
+  /// Looks up @p load in the buffer in cycle @p now, returning the cycles
+  /// stalled on an overlapping store. @p forwarded is set if the load is
+  /// forwarded the data of a buffered store, in which case it does not access
+  /// the data cache.
+  unsigned load(const MemoryAccess &load, long long now, bool &forwarded);
+  /// Accounts the occupancy of the buffer over @p cycles cycles.
+  void sample(long long cycles);
+  void reset();
+
+  const StoreBufferConfig &config() const { return m_config; }
+  const StoreBufferStats &stats() const { return m_stats; }
+  unsigned occupancy() const { return m_entries.size(); }
+
+private:
+  struct Entry {
+    AInt begin;
+    AInt end;
+    AInt pc;
+    // Cycle from which the entry may drain.
+    long long ready;
+    // Cycle in which the entry has drained, once it has started draining.
+    long long done = -1;
+  };
+
+  /// Drains the buffer until the entry at @p index (from the front) has
+  /// drained, returning the cycle of its completion.
+  long long drainThrough(size_t index, long long now);
+
+  StoreBufferConfig m_config;
+  unsigned m_blockBytes;
+  WriteFunction m_write;
+  std::deque<Entry> m_entries;
+  // Cycle from which the write port is free.
+  long long m_portFree = 0;
+  StoreBufferStats m_stats;
+};
+
+} // namespace Ripes
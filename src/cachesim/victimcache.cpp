@@ -0,0 +1,114 @@
+#include "victimcache.h"
+
+#include <algorithm>
+
+namespace Ripes {
+
+VictimCache::VictimCache(unsigned entries, unsigned blockBytes,
+                         QObject *parent)
+    : CacheInterface(parent), m_entries(entries), m_blockBytes(blockBytes) {}
+
+VictimCache::Entry *VictimCache::find(AInt address) {
+  const AInt block = address / m_blockBytes;
+  auto it = std::find_if(m_entries.begin(), m_entries.end(),
+                         [block](const Entry &entry) {
+                           return entry.valid && entry.block == block;
+                         });
+  return it == m_entries.end() ? nullptr : &*it;
+}
+
+void VictimCache::access(AInt address, MemoryAccess::Type type, AInt pc) {
+  Entry *entry = find(address);
+  if (type == MemoryAccess::Write) {
+    // Writes through the L1 cache update a held block.
+    if (entry)
+      entry->dirty = true;
+    else if (m_nextLevelCache)
+      m_nextLevelCache->access(address, type, pc);
+    return;
+  }
+
+  if (!entry) {
+    m_misses++;
+    if (m_nextLevelCache)
+      m_nextLevelCache->access(address, type, pc);
+    return;
+  }
+  m_hits++;
+  if (entry->dirty) {
+    m_writebacks++;
+    if (m_nextLevelCache)
+      m_nextLevelCache->access(entry->block * m_blockBytes,
+                               MemoryAccess::Write, pc);
+  }
+  *entry = Entry();
+}
+
+void VictimCache::evict(AInt address, bool dirty, AInt pc) {
+  ++m_time;
+  if (Entry *entry = find(address)) {
+    entry->dirty |= dirty;
+    entry->used = m_time;
+    return;
+  }
+  auto victim = std::find_if(m_entries.begin(), m_entries.end(),
+                             [](const Entry &entry) { return !entry.valid; });
+  if (victim == m_entries.end()) {
+    victim = std::min_element(m_entries.begin(), m_entries.end(),
+                              [](const Entry &lhs, const Entry &rhs) {
+                                return lhs.used < rhs.used;
+                              });
+    m_evictions++;
+    if (victim->dirty)
+      m_writebacks++;
+    if (m_nextLevelCache)
+      m_nextLevelCache->evict(victim->block * m_blockBytes, victim->dirty, pc);
+  }
+  *victim = {true, dirty, address / m_blockBytes, m_time};
+  m_insertions++;
+}
+
+std::optional<bool> VictimCache::invalidate(AInt address) {
+  Entry *entry = find(address);
+  if (!entry)
+    return {};
+  const bool dirty = entry->dirty;
+  *entry = Entry();
+  return dirty;
+}
+
+void VictimCache::reset() {
+  std::fill(m_entries.begin(), m_entries.end(), Entry());
+  m_time = 0;
+  m_hits = 0;
+  m_misses = 0;
+  m_insertions = 0;
+  m_evictions = 0;
+  m_writebacks = 0;
+  CacheInterface::reset();
+}
+
+unsigned VictimCache::occupancy() const {
+  return std::count_if(m_entries.begin(), m_entries.end(),
+                       [](const Entry &entry) { return entry.valid; });
+}
+
+double VictimCache::hitRate() const {
+  const unsigned lookups = m_hits + m_misses;
+  return lookups == 0 ? 0 : static_cast<double>(m_hits) / lookups;
+}
+
+QVariantMap VictimCache::report() const {
+  QVariantMap m;
+  m["entries"] = entries();
+  m["hits"] = m_hits;
+  m["misses"] = m_misses;
+  m["hit rate"] = hitRate();
+  m["insertions"] = m_insertions;
+  m["evictions"] = m_evictions;
+  m["writebacks"] = m_writebacks;
+  m["occupancy"] = occupancy();
+  return m;
+}
+
+} // namespace Ripes
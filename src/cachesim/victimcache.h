@@ -0,0 +1,70 @@
+#pragma once
+
+#include <QVariantMap>
+
+#include <optional>
+#include <vector>
+
+#include "cachesim.h"
+
+namespace Ripes {
+
+/**
+ * @brief The VictimCache class
+ * A small fully associative cache between an L1 cache and the next level,
+ * holding the blocks evicted from the L1 cache (see CacheInterface::evict).
+ * A fetch of the L1 cache hitting a held block moves the block back up, and
+ * otherwise is forwarded to the next level. As the L1 cache fetches before
+ * evicting (see CacheSim::accessNextLevel), the missed and the evicted block
+ * swap places on a hit, such that blocks conflicting in a set of the L1 cache
+ * are served from the victim cache.
+ *
+ * Entries are replaced in LRU order, handing the replaced block to the next
+ * level. A dirty block moving back up is written back, as the L1 cache fills
+ * it clean.
+ */
+class VictimCache : public CacheInterface {
+public:
+  /// @p blockBytes is the number of bytes of a block of the L1 cache.
+  VictimCache(unsigned entries, unsigned blockBytes, QObject *parent = nullptr);
+
+  void access(AInt address, MemoryAccess::Type type, AInt pc = 0) override;
+  void evict(AInt address, bool dirty, AInt pc = 0) override;
+  void reset() override;
+  /// Invalidates the block containing @p address, if present. Returns whether
+  /// the block was dirty, or nothing if it was not present.
+  std::optional<bool> invalidate(AInt address);
+
+  unsigned entries() const { return m_entries.size(); }
+  /// Returns the number of valid entries.
+  unsigned occupancy() const;
+  unsigned hits() const { return m_hits; }
+  unsigned misses() const { return m_misses; }
+  double hitRate() const;
+  unsigned insertions() const { return m_insertions; }
+  unsigned evictions() const { return m_evictions; }
+  unsigned writebacks() const { return m_writebacks; }
+
+  QVariantMap report() const;
+
+private:
+  struct Entry {
+    bool valid = false;
+    bool dirty = false;
+    AInt block = 0;
+    unsigned long long used = 0;
+  };
+  Entry *find(AInt address);
+
+  std::vector<Entry> m_entries;
+  unsigned m_blockBytes;
+  unsigned long long m_time = 0;
+
+  unsigned m_hits = 0;
+  unsigned m_misses = 0;
+  unsigned m_insertions = 0;
+  unsigned m_evictions = 0;
+  unsigned m_writebacks = 0;
+};
+
+} // namespace Ripes
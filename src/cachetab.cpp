@@ -47,6 +47,14 @@ void CacheTab::tabVisibilityChanged(bool visible) {
   }
 }
 
+std::shared_ptr<const CacheSim> CacheTab::instructionCache() const {
+  return m_ui->cacheTabWidget->instructionCache();
+}
+
+std::shared_ptr<const CacheSim> CacheTab::dataCache() const {
+  return m_ui->cacheTabWidget->dataCache();
+}
+
 CacheTab::~CacheTab() { delete m_ui; }
 
 } // namespace Ripes
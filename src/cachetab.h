@@ -2,10 +2,12 @@
 
 #include "ripestab.h"
 #include <QWidget>
+#include <memory>
 
 #include "isa/isa_types.h"
 
 namespace Ripes {
+class CacheSim;
 
 namespace Ui {
 class CacheTab;
@@ -20,6 +22,10 @@ public:
 
   void tabVisibilityChanged(bool visible) override;
 
+  /// Returns the simulators of the L1 instruction and data caches.
+  std::shared_ptr<const CacheSim> instructionCache() const;
+  std::shared_ptr<const CacheSim> dataCache() const;
+
 signals:
   void focusAddressChanged(Ripes::AInt address);
 
@@ -28,6 +28,14 @@ void CacheTabWidget::flipTabs() {
   m_ui->tabWidget->setCurrentIndex(0);
 }
 
+std::shared_ptr<const CacheSim> CacheTabWidget::instructionCache() const {
+  return m_ui->instructionCacheWidget->getCacheSim();
+}
+
+std::shared_ptr<const CacheSim> CacheTabWidget::dataCache() const {
+  return m_ui->dataCacheWidget->getCacheSim();
+}
+
 CacheTabWidget::CacheTabWidget(QWidget *parent)
     : QWidget(parent), m_ui(new Ui::CacheTabWidget) {
   m_ui->setupUi(this);
@@ -40,6 +48,11 @@ CacheTabWidget::CacheTabWidget(QWidget *parent)
   m_l1dShim->setNextLevelCache(m_ui->dataCacheWidget->getCacheSim());
   m_l1iShim->setNextLevelCache(m_ui->instructionCacheWidget->getCacheSim());
 
+  // Simulate each cache on its own thread while running, such that the caches
+  // do not slow down the processor simulation.
+  m_l1dShim->setAsynchronous(true);
+  m_l1iShim->setAsynchronous(true);
+
 #ifdef N_CACHES_ENABLED
   m_addTabIdx = m_ui->tabWidget->addTab(new QLabel("Placeholder"),
                                         QIcon((":/icons/plus.svg")), QString());
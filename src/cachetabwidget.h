@@ -26,6 +26,10 @@ public:
    */
   void flipTabs();
 
+  /// Returns the simulators of the L1 instruction and data caches.
+  std::shared_ptr<const CacheSim> instructionCache() const;
+  std::shared_ptr<const CacheSim> dataCache() const;
+
 signals:
   void focusAddressChanged(unsigned address);
   void cacheFocusChanged(Ripes::CacheWidget *cacheInFocus);
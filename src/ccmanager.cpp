@@ -6,9 +6,20 @@
 #include "ripessettings.h"
 #include "utilities/systemutils.h"
 
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFutureWatcher>
 #include <QProcess>
 #include <QProgressDialog>
+#include <QPromise>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QStandardPaths>
 #include <QTextDocument>
+#include <QThread>
+
+#include <list>
+#include <utility>
 
 namespace Ripes {
 
@@ -17,6 +28,28 @@ const static std::vector<QString> s_validAutodetectedCCs = {
     "riscv64-unknown-elf-c++"};
 const static QString s_testprogram = "int main() { return 0; }";
 
+/// Marks the cache entry at @p path as the most recently used.
+static void touch(const QString &path) {
+  QFile entry(path);
+  if (entry.open(QIODevice::ReadWrite))
+    entry.setFileTime(QDateTime::currentDateTime(),
+                      QFileDevice::FileModificationTime);
+}
+
+/// Returns the names and contents of the headers in the directory of the
+/// source @p file, which an object compiled from it may include.
+static QByteArray localHeaders(const QString &file) {
+  QByteArray headers;
+  const QDir dir = QFileInfo(file).dir();
+  for (const auto &header : dir.entryInfoList({"*.h"}, QDir::Files,
+                                              QDir::Name)) {
+    QFile content(header.absoluteFilePath());
+    if (content.open(QIODevice::ReadOnly))
+      headers += header.fileName().toUtf8() + '\0' + content.readAll() + '\0';
+  }
+  return headers;
+}
+
 QString indentString(const QString &string, int indent) {
   auto subStrings = string.split("\n");
   auto indentedStrings = QStringList();
@@ -43,6 +76,10 @@ QString CCManager::CompileError::toString(const CompileCommand &cc) const {
 }
 
 CCManager::CCManager() {
+  setCacheDirectory(
+      QStandardPaths::writableLocation(QStandardPaths::CacheLocation) +
+      QDir::separator() + "cc");
+
   if (RipesSettings::value(RIPES_SETTING_CCPATH) == "") {
     // No previous compiler path has been set. Try to autodetect a valid
     // compiler within the current path
@@ -76,6 +113,7 @@ bool CCManager::trySetCC(const QString &CC) {
     m_currentCC = CC;
   } else {
     m_currentCC = QString();
+    m_currentCCVersion = QString();
   }
   emit ccChanged(res);
   return res.success;
@@ -134,8 +172,146 @@ CCManager::CCRes CCManager::compile(const QStringList &files, QString outname,
   const auto cc = createCompileCommand(files, outname);
   res.cc = cc;
 
-  // Run compiler
+  const QString cached = cachePath(files);
+  if (!cached.isEmpty() && QFile::exists(cached)) {
+    // Entries may be removed concurrently by another instance, in which case
+    // the sources are compiled as usual.
+    QFile::remove(outname);
+    if (QFile::copy(cached, outname) &&
+        LoadDialog::validateELFFile(QFile(outname)).valid) {
+      touch(cached);
+      res.success = true;
+      res.cached = true;
+      return res;
+    }
+  }
+
+  m_aborted = false;
+  m_errored = false;
+  m_stderr.clear();
+  // Multiple translation units are compiled separately, such that only
+  // changed sources are recompiled.
+  if (files.size() > 1)
+    compileSeparately(files, outname, showProgressdiag);
+  else
+    runCompiler(cc, showProgressdiag);
+
+  auto elfInfo = LoadDialog::validateELFFile(QFile(outname));
+  res.success = elfInfo.valid;
+  res.errorOutput.errMsg = elfInfo.errorMessage;
+  res.aborted = m_aborted;
+  // Failed compilations are not cached.
+  if (res.success && !res.aborted && !cached.isEmpty())
+    insertCached(outname, cached);
+
+  return res;
+#else
+  CCRes res;
+  res.success = false;
+  return res;
+#endif
+}
+
+QFuture<CCManager::CCRes> CCManager::compileAsync(const QString &rawsource,
+                                                  bool syntaxOnly) {
+  auto promise = std::make_shared<QPromise<CCRes>>();
+  promise->start();
+  QFuture<CCRes> future = promise->future();
+  const auto resolve = [promise](const CCRes &res) {
+    promise->addResult(res);
+    promise->finish();
+  };
+
+  CCRes res;
+#ifdef RIPES_WITH_QPROCESS
+  // Each compilation has its own source, such that a cancelled compiler which
+  // is still exiting never observes the source of the next compilation.
+  const QString stem =
+      m_asyncDir.filePath(QString::number(m_asyncCompilations++));
+  QFile source(stem + ".c");
+  if (!m_asyncDir.isValid() || !source.open(QIODevice::WriteOnly)) {
+    res.errorOutput.errMsg = "Failed to write '" + source.fileName() + "'";
+    resolve(res);
+    return future;
+  }
+  source.write(rawsource.toUtf8());
+  source.close();
+
+  res.inFiles << source.fileName();
+  const QString peripheralSymbolsHeader = IOManager::get().cSymbolsHeaderpath();
+  if (!peripheralSymbolsHeader.isEmpty())
+    res.inFiles << peripheralSymbolsHeader;
+  if (!syntaxOnly)
+    res.outFile = stem + ".out";
+  res.cc = syntaxOnly ? createSyntaxCommand(res.inFiles)
+                      : createCompileCommand(res.inFiles, res.outFile);
+
+  const QString cached = syntaxOnly ? QString() : cachePath(res.inFiles);
+  if (!cached.isEmpty() && QFile::exists(cached) &&
+      QFile::copy(cached, res.outFile) &&
+      LoadDialog::validateELFFile(QFile(res.outFile)).valid) {
+    touch(cached);
+    QFile::remove(source.fileName());
+    res.success = true;
+    res.cached = true;
+    resolve(res);
+    return future;
+  }
+
+  // The process is driven by its signals in the GUI thread, and deletes
+  // itself once the compiler has exited.
+  auto *process = new QProcess(this);
+  auto *watcher = new QFutureWatcher<CCRes>(process);
+  connect(watcher, &QFutureWatcher<CCRes>::canceled, process, &QProcess::kill);
+  watcher->setFuture(future);
+  const auto done = [=](CCRes result) {
+    QFile::remove(result.inFiles.first());
+    result.aborted = future.isCanceled();
+    // Results of cancelled futures are discarded.
+    resolve(result);
+    process->deleteLater();
+  };
+  connect(process,
+          QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+          [=](int exitCode, QProcess::ExitStatus status) {
+            CCRes result = res;
+            result.errorOutput._stdout = process->readAllStandardOutput();
+            result.errorOutput._stderr = process->readAllStandardError();
+            if (syntaxOnly) {
+              result.success = status == QProcess::NormalExit && exitCode == 0;
+            } else {
+              const auto elfInfo =
+                  LoadDialog::validateELFFile(QFile(result.outFile));
+              result.success = elfInfo.valid;
+              result.errorOutput.errMsg = elfInfo.errorMessage;
+              if (result.success && !future.isCanceled() && !cached.isEmpty())
+                insertCached(result.outFile, cached);
+            }
+            done(result);
+          });
+  connect(process, &QProcess::errorOccurred, this,
+          [=](QProcess::ProcessError error) {
+            // Other errors are followed by the process finishing.
+            if (error != QProcess::FailedToStart)
+              return;
+            CCRes result = res;
+            result.errorOutput.errMsg = process->errorString();
+            done(result);
+          });
+  process->setWorkingDirectory(res.cc.bin.absolutePath());
+  process->setProgram(res.cc.bin.absoluteFilePath());
+  process->setArguments(res.cc.args);
+  process->start();
+#else
+  Q_UNUSED(rawsource);
+  Q_UNUSED(syntaxOnly);
+  resolve(res);
+#endif
+  return future;
+}
 
+#ifdef RIPES_WITH_QPROCESS
+void CCManager::runCompiler(const CompileCommand &cc, bool showProgressdiag) {
   /**
    * 1. m_process will itself spawn its own thread to execute the compiler.
    * 2. QProcess should not be started in a separate QThread, so it is started
@@ -144,22 +320,25 @@ CCManager::CCRes CCManager::compile(const QStringList &files, QString outname,
    * 4. To facilitate all of this, we have to spin on the process state in a
    * separate thread, to not block the execution of the progress dialog.
    */
-  m_aborted = false;
-  m_errored = false;
   m_process.close();
-  QProgressDialog progressDiag =
-      QProgressDialog("Executing compiler...", "Abort", 0, 0, nullptr);
-  connect(&progressDiag, &QProgressDialog::canceled, &m_process,
-          &QProcess::kill);
-  connect(&progressDiag, &QProgressDialog::canceled, &m_process,
-          [this] { m_aborted = true; });
-  connect(&m_process,
-          QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-          &progressDiag, &QProgressDialog::reset);
-  connect(&m_process, &QProcess::errorOccurred, &progressDiag,
-          &QProgressDialog::reset);
   connect(&m_process, &QProcess::errorOccurred, this,
           [this]() { m_errored = true; });
+  // The dialog is only constructed when shown, such that compilers may be
+  // run without a GUI (ie. from the CLI).
+  std::unique_ptr<QProgressDialog> progressDiag;
+  if (showProgressdiag) {
+    progressDiag = std::make_unique<QProgressDialog>(
+        "Executing compiler...", "Abort", 0, 0, nullptr);
+    connect(progressDiag.get(), &QProgressDialog::canceled, &m_process,
+            &QProcess::kill);
+    connect(progressDiag.get(), &QProgressDialog::canceled, &m_process,
+            [this] { m_aborted = true; });
+    connect(&m_process,
+            QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            progressDiag.get(), &QProgressDialog::reset);
+    connect(&m_process, &QProcess::errorOccurred, progressDiag.get(),
+            &QProgressDialog::reset);
+  }
   m_process.setWorkingDirectory(cc.bin.absolutePath());
   m_process.setProgram(cc.bin.absoluteFilePath());
   m_process.setArguments(cc.args);
@@ -171,32 +350,158 @@ CCManager::CCRes CCManager::compile(const QStringList &files, QString outname,
    * not remove the race condition. Such race condition seems inherintly tied to
    * how QDialog::exec works and no proper fix has been able to be found
    * (yet).*/
-  if (!m_errored && showProgressdiag) {
-    progressDiag.exec();
+  if (!m_errored && progressDiag) {
+    progressDiag->exec();
   }
   m_process.waitForFinished();
+}
 
-  auto elfInfo = LoadDialog::validateELFFile(QFile(outname));
-  res.success = elfInfo.valid;
-  res.errorOutput.errMsg = elfInfo.errorMessage;
-  res.aborted = m_aborted;
+std::vector<bool>
+CCManager::runCompilers(const std::vector<CompileCommand> &commands,
+                        bool showProgressdiag) {
+  std::unique_ptr<QProgressDialog> progressDiag;
+  if (showProgressdiag) {
+    progressDiag = std::make_unique<QProgressDialog>(
+        "Executing compiler...", "Abort", 0, static_cast<int>(commands.size()),
+        nullptr);
+    progressDiag->setWindowModality(Qt::ApplicationModal);
+  }
 
-  return res;
-#else
-  CCRes res;
-  res.success = false;
-  return res;
-#endif
+  // At most one compiler per core runs at a time. Processes are polled rather
+  // than awaited, such that the progress dialog remains responsive.
+  const size_t maxRunning = std::max(1, QThread::idealThreadCount());
+  std::vector<bool> succeeded(commands.size(), false);
+  std::list<std::pair<size_t, std::unique_ptr<QProcess>>> running;
+  size_t next = 0;
+  size_t finished = 0;
+  bool failed = false;
+  while (!failed && (next < commands.size() || !running.empty())) {
+    while (next < commands.size() && running.size() < maxRunning) {
+      auto process = std::make_unique<QProcess>();
+      process->setWorkingDirectory(commands.at(next).bin.absolutePath());
+      process->setProgram(commands.at(next).bin.absoluteFilePath());
+      process->setArguments(commands.at(next).args);
+      process->start();
+      running.emplace_back(next++, std::move(process));
+    }
+    for (auto it = running.begin(); it != running.end();) {
+      QProcess &process = *it->second;
+      if (process.state() != QProcess::NotRunning &&
+          !process.waitForFinished(10)) {
+        ++it;
+        continue;
+      }
+      if (process.error() == QProcess::UnknownError &&
+          process.exitStatus() == QProcess::NormalExit &&
+          process.exitCode() == 0) {
+        succeeded[it->first] = true;
+      } else {
+        failed = true;
+        m_stderr += process.readAllStandardError();
+      }
+      it = running.erase(it);
+      if (progressDiag)
+        progressDiag->setValue(++finished);
+    }
+    if (progressDiag) {
+      QCoreApplication::processEvents();
+      if (progressDiag->wasCanceled()) {
+        m_aborted = true;
+        failed = true;
+      }
+    }
+  }
+  for (auto &process : running) {
+    process.second->kill();
+    process.second->waitForFinished();
+  }
+  return succeeded;
 }
 
+void CCManager::compileSeparately(const QStringList &files,
+                                  const QString &outname,
+                                  bool showProgressdiag) {
+  // Objects are cached alongside the executables, or otherwise for the
+  // lifetime of the manager.
+  const QString objectDir = m_cacheDirectory.isEmpty()
+                                ? m_objectDir.path()
+                                : QDir(m_cacheDirectory).filePath("objects");
+  QDir().mkpath(objectDir);
+
+  QStringList objects;
+  std::vector<CompileCommand> commands;
+  std::vector<std::pair<QString, QString>> compiled;
+  for (const auto &file : files) {
+    QFile source(file);
+    if (!source.open(QIODevice::ReadOnly)) {
+      m_stderr += "Failed to open '" + file + "'\n";
+      return;
+    }
+    const QString object = QDir(objectDir).filePath(
+        cacheKey({source.readAll(), localHeaders(file)}, true) + ".o");
+    objects << object;
+    if (!m_verifying && QFile::exists(object)) {
+      touch(object);
+      continue;
+    }
+    // Objects are compiled to a file of this process, and are moved into
+    // place once compiled, such that concurrent instances sharing the cache
+    // never observe a partially written object.
+    const QString temporary =
+        object + "." + QString::number(QCoreApplication::applicationPid());
+    commands.push_back(createObjectCommand(file, temporary));
+    compiled.emplace_back(temporary, object);
+  }
+
+  const auto succeeded = runCompilers(commands, showProgressdiag);
+  bool allSucceeded = true;
+  for (size_t i = 0; i < compiled.size(); ++i) {
+    const auto &[temporary, object] = compiled.at(i);
+    // Another instance may have placed the object first.
+    if (!succeeded.at(i) || !QFile::rename(temporary, object))
+      QFile::remove(temporary);
+    allSucceeded &= succeeded.at(i);
+  }
+  if (!allSucceeded)
+    return;
+  trimCache(objectDir, "*.o");
+
+  runCompilers({createLinkCommand(objects, outname)}, showProgressdiag);
+}
+#endif
+
 QString CCManager::getError() {
 #ifdef RIPES_WITH_QPROCESS
+  // Errors of separately compiled translation units are collected, since
+  // these are compiled by separate processes.
+  if (!get().m_stderr.isEmpty())
+    return get().m_stderr;
   return get().m_process.readAllStandardError();
 #else
   return QString();
 #endif
 }
 
+Errors CCManager::parseErrors(const QString &stderrOutput,
+                             const QString &file) {
+  // Diagnostics are reported as "file:line:column: error: message".
+  static const QRegularExpression diagnostic(
+      R"(^(.+?):(\d+):(?:\d+:)?\s*(?:fatal )?error:\s*(.*)$)",
+      QRegularExpression::MultilineOption);
+  const QString fileName = QFileInfo(file).fileName();
+  Errors errors;
+  auto it = diagnostic.globalMatch(stderrOutput);
+  while (it.hasNext()) {
+    const auto match = it.next();
+    if (QFileInfo(match.captured(1)).fileName() != fileName)
+      continue;
+    const int line = match.captured(2).toInt();
+    if (line > 0)
+      errors.push_back(Error(Location(line - 1), match.captured(3)));
+  }
+  return errors;
+}
+
 static QStringList sanitizedArguments(const QString &args) {
   QStringList arglist = args.split(" ");
   for (const auto invArg : {"", " ", "-"}) {
@@ -205,24 +510,8 @@ static QStringList sanitizedArguments(const QString &args) {
   return arglist;
 }
 
-CCManager::CompileCommand
-CCManager::createCompileCommand(const QStringList &files,
-                                const QString &outname) const {
+CCManager::CompileCommand CCManager::baseCommand() const {
   const auto &currentISA = ProcessorHandler::currentISA();
-
-  /**
-   * @brief s_baseCC
-   * Base compiler command.
-   * - %1: path to compiler executable
-   * - %2: machine architecture
-   * - %3: machine ABI
-   * - %4: user compiler arguments
-   * - -x c: Enforce compilation as C language (allows us to use C++ compilers)
-   * - %5: input source file
-   * - %6: output executable
-   * - %7: user linker arguments
-   */
-  QStringList compileCommand;
   CompileCommand cc;
 
   // Compiler path
@@ -237,6 +526,25 @@ CCManager::createCompileCommand(const QStringList &files,
   // Substitute additional CC arguments
   cc.args << sanitizedArguments(
       RipesSettings::value(RIPES_SETTING_CCARGS).toString());
+  return cc;
+}
+
+CCManager::CompileCommand
+CCManager::createCompileCommand(const QStringList &files,
+                                const QString &outname) const {
+  /**
+   * @brief s_baseCC
+   * Base compiler command.
+   * - %1: path to compiler executable
+   * - %2: machine architecture
+   * - %3: machine ABI
+   * - %4: user compiler arguments
+   * - -x c: Enforce compilation as C language (allows us to use C++ compilers)
+   * - %5: input source file
+   * - %6: output executable
+   * - %7: user linker arguments
+   */
+  CompileCommand cc = baseCommand();
 
   // Enforce compilation as C language (allows us to use C++ compilers)
   cc.args << "-x"
@@ -252,10 +560,123 @@ CCManager::createCompileCommand(const QStringList &files,
   return cc;
 }
 
+CCManager::CompileCommand
+CCManager::createSyntaxCommand(const QStringList &files) const {
+  CompileCommand cc = baseCommand();
+  cc.args << "-x"
+          << "c"
+          << "-fsyntax-only" << files;
+  return cc;
+}
+
+CCManager::CompileCommand
+CCManager::createObjectCommand(const QString &file,
+                               const QString &object) const {
+  CompileCommand cc = baseCommand();
+  cc.args << "-x"
+          << "c"
+          << "-c" << file << "-o" << object;
+  return cc;
+}
+
+CCManager::CompileCommand
+CCManager::createLinkCommand(const QStringList &objects,
+                             const QString &outname) const {
+  CompileCommand cc = baseCommand();
+  cc.args << objects << "-o" << outname;
+  cc.args << sanitizedArguments(
+      RipesSettings::value(RIPES_SETTING_LDARGS).toString());
+  return cc;
+}
+
+void CCManager::setCacheDirectory(const QString &path) {
+  m_cacheDirectory = path;
+  if (!m_cacheDirectory.isEmpty())
+    QDir().mkpath(m_cacheDirectory);
+}
+
+QString CCManager::compilerVersion(const QString &CC) {
+#ifdef RIPES_WITH_QPROCESS
+  QProcess process;
+  process.start(CC, {"--version"});
+  if (process.waitForFinished(5000))
+    return QString(process.readAllStandardOutput()).section('\n', 0, 0);
+#endif
+  // Compilers not reporting a version are identified by their executable.
+  const QFileInfo info(CC);
+  return QString::number(info.size()) + "@" +
+         QString::number(info.lastModified().toMSecsSinceEpoch());
+}
+
+QString CCManager::cacheKey(const QByteArrayList &sources,
+                            bool object) const {
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+  // Fields are hashed individually, such that distinct inputs cannot hash
+  // identical byte sequences.
+  const auto add = [&](const QByteArray &field) {
+    hash.addData(QCryptographicHash::hash(field, QCryptographicHash::Sha1));
+  };
+  for (const auto &source : sources)
+    add(source);
+  add(QFileInfo(m_currentCC).absoluteFilePath().toUtf8());
+  add(m_currentCCVersion.toUtf8());
+  // The command with placeholders for the files holds the ISA and the
+  // compiler (and linker) arguments.
+  const auto cc = object ? createObjectCommand("${input}", "${output}")
+                         : createCompileCommand({"${input}"}, "${output}");
+  add(cc.toString().toUtf8());
+  return hash.result().toHex();
+}
+
+QString CCManager::cachePath(const QStringList &files) const {
+  if (m_cacheDirectory.isEmpty())
+    return QString();
+  QByteArrayList sources;
+  for (const auto &file : files) {
+    QFile source(file);
+    if (!source.open(QIODevice::ReadOnly))
+      return QString();
+    sources << source.readAll();
+  }
+  return QDir(m_cacheDirectory).filePath(cacheKey(sources, false) + ".elf");
+}
+
+void CCManager::insertCached(const QString &outname,
+                             const QString &path) const {
+  QFile executable(outname);
+  if (!executable.open(QIODevice::ReadOnly))
+    return;
+  // Written through a temporary file, such that concurrent instances sharing
+  // the directory never observe a partially written executable.
+  QSaveFile entry(path);
+  if (!entry.open(QIODevice::WriteOnly))
+    return;
+  entry.write(executable.readAll());
+  if (entry.commit())
+    trimCache(m_cacheDirectory, "*.elf");
+}
+
+void CCManager::trimCache(const QString &directory,
+                          const QString &pattern) const {
+  // Least recently used entries are removed first.
+  const QFileInfoList entries =
+      QDir(directory).entryInfoList({pattern}, QDir::Files,
+                                    QDir::Time | QDir::Reversed);
+  qint64 total = 0;
+  for (const auto &info : entries)
+    total += info.size();
+  // The most recently used entry is always kept.
+  for (int i = 0; i + 1 < entries.size() && total > m_cacheSizeLimit; ++i) {
+    if (QFile::remove(entries.at(i).absoluteFilePath()))
+      total -= entries.at(i).size();
+  }
+}
+
 CCManager::CCRes CCManager::verifyCC(const QString &CCPath) {
 #ifdef RIPES_WITH_QPROCESS
   // Try to set CCPath as current compiler, and compile test program
   m_currentCC = CCPath;
+  m_currentCCVersion = compilerVersion(CCPath);
 
   CCRes res;
   const auto compilerExecInfo = QFileInfo(m_currentCC);
@@ -272,7 +693,14 @@ CCManager::CCRes CCManager::verifyCC(const QString &CCPath) {
     goto verifyCC_end;
   }
 
-  res = compileRaw(s_testprogram, QString(), false);
+  {
+    // The compiler is verified by compiling, rather than by the cache.
+    const QString cacheDirectory = std::exchange(m_cacheDirectory, QString());
+    m_verifying = true;
+    res = compileRaw(s_testprogram, QString(), false);
+    m_verifying = false;
+    m_cacheDirectory = cacheDirectory;
+  }
 
   if (!res.success) {
     res.errorOutput._stdout = QString(m_process.readAllStandardOutput());
@@ -2,13 +2,18 @@
 
 #include <QDir>
 #include <QFile>
+#include <QFuture>
 #include <QObject>
 #include <QProcess>
 #include <QString>
+#include <QTemporaryDir>
 
 QT_FORWARD_DECLARE_CLASS(QTextDocument)
 
 #include <memory>
+#include <vector>
+
+#include "isa/isa_defines.h"
 
 namespace Ripes {
 
@@ -16,6 +21,22 @@ namespace Ripes {
  * @brief The CCManager class
  * Manages the detection, verification and execution of a valid C/C++ compiler
  * suitable for the ISAs targetted by the various processor models of Ripes.
+ *
+ * Compiled executables are cached in a directory, keyed by a hash of
+ * everything which determines the output of the compiler: the contents of the
+ * sources, the compiler and its version, and the compile command, which
+ * includes the ISA and the compiler and linker arguments. Entries are written
+ * atomically, such that the directory may be shared between concurrent
+ * instances of Ripes, and the least recently used entries are removed once the
+ * entries exceed the size limit of the cache.
+ *
+ * Multiple sources are compiled to objects by one compiler per core, and are
+ * then linked. Objects are cached by the contents of their source and the
+ * headers next to it, such that only the changed sources of a project are
+ * recompiled.
+ *
+ * Sources may also be compiled asynchronously, without a progress dialog,
+ * such that the editor remains usable while compiling.
  */
 class CCManager : public QObject {
   Q_OBJECT
@@ -41,6 +62,8 @@ public:
     CompileCommand cc;
     bool success = false;
     bool aborted = false;
+    // Whether the output file was copied from the compilation cache.
+    bool cached = false;
 
     void clean() { QFile::remove(outFile); }
   };
@@ -69,8 +92,35 @@ public:
   CCRes compileRaw(const QString &rawsource, QString outname = QString(),
                    bool showProgressdiag = true);
 
+  /**
+   * @brief compileAsync
+   * Compiles @p rawsource in the background, without blocking the caller or
+   * showing a progress dialog. If @p syntaxOnly is set, the source is only
+   * checked for errors, and no output file is produced. Cancelling the
+   * returned future kills the compiler. The future is resolved in the GUI
+   * thread, and should be observed through a QFutureWatcher.
+   */
+  QFuture<CCRes> compileAsync(const QString &rawsource,
+                              bool syntaxOnly = false);
+
+  /// Returns the errors which the compiler reported in @p stderrOutput for
+  /// the source @p file, located by their (zero-indexed) line.
+  static Errors parseErrors(const QString &stderrOutput, const QString &file);
+
   CompileCommand createCompileCommand(const QStringList &files,
                                       const QString &outname) const;
+  CompileCommand createSyntaxCommand(const QStringList &files) const;
+  CompileCommand createObjectCommand(const QString &file,
+                                     const QString &object) const;
+  CompileCommand createLinkCommand(const QStringList &objects,
+                                   const QString &outname) const;
+
+  /// Sets the directory of the compilation cache. An empty path disables the
+  /// cache. Defaults to a directory in the cache location of the user.
+  void setCacheDirectory(const QString &path);
+  const QString &cacheDirectory() const { return m_cacheDirectory; }
+  /// Sets the total size, in bytes, of the executables kept in the cache.
+  void setCacheSizeLimit(qint64 bytes) { m_cacheSizeLimit = bytes; }
 
 signals:
   /**
@@ -103,13 +153,58 @@ private:
    */
   CCRes verifyCC(const QString &CC);
 
+  /// Returns the compiler and the target and user compiler arguments shared
+  /// by all commands.
+  CompileCommand baseCommand() const;
+
+#ifdef RIPES_WITH_QPROCESS
+  /// Runs the compile command @p cc in m_process.
+  void runCompiler(const CompileCommand &cc, bool showProgressdiag);
+  /// Runs @p commands, in parallel, and returns whether each succeeded.
+  /// Remaining commands are not run once a command fails.
+  std::vector<bool> runCompilers(const std::vector<CompileCommand> &commands,
+                                 bool showProgressdiag);
+  /// Compiles each of @p files to an object, unless cached, and links the
+  /// objects into @p outname.
+  void compileSeparately(const QStringList &files, const QString &outname,
+                         bool showProgressdiag);
+#endif
+
+  /// Returns the version reported by the compiler @p CC.
+  QString compilerVersion(const QString &CC);
+
+  /// Returns the cache key of compiling @p sources to an executable, or to an
+  /// object if @p object is set.
+  QString cacheKey(const QByteArrayList &sources, bool object) const;
+  /// Returns the path of the cached executable of @p files, or an empty path
+  /// if the cache is disabled.
+  QString cachePath(const QStringList &files) const;
+  /// Copies the executable @p outname into the cache as @p path, and removes
+  /// the least recently used executables beyond the size limit.
+  void insertCached(const QString &outname, const QString &path) const;
+  /// Removes the least recently used entries matching @p pattern from
+  /// @p directory beyond the size limit.
+  void trimCache(const QString &directory, const QString &pattern) const;
+
   CCManager();
   QString m_currentCC;
+  QString m_currentCCVersion;
+  QString m_cacheDirectory;
+  qint64 m_cacheSizeLimit = 256 * 1024 * 1024;
 #ifdef RIPES_WITH_QPROCESS
   QProcess m_process;
 #endif
   bool m_errored = false;
   bool m_aborted = false;
+  // Set while verifying a compiler, which compiles rather than uses objects.
+  bool m_verifying = false;
+  // Error output of separately compiled sources (see getError).
+  QString m_stderr;
+  // Objects of separately compiled sources, if the cache is disabled.
+  QTemporaryDir m_objectDir;
+  // Sources and executables of asynchronous compilations.
+  QTemporaryDir m_asyncDir;
+  unsigned m_asyncCompilations = 0;
   std::unique_ptr<QFile> m_tmpSrcFile;
 };
 
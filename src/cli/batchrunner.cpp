@@ -0,0 +1,356 @@
+#include "batchrunner.h"
+#include "clirunner.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QProcess>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+#include <iostream>
+
+namespace Ripes {
+
+/// Splits a line of a CSV file into its fields. Fields may be quoted, in which
+/// case they may contain commas and escaped ("") quotes.
+static QStringList splitCSVLine(const QString &line) {
+  QStringList fields;
+  QString field;
+  bool quoted = false;
+  for (int i = 0; i < line.size(); ++i) {
+    const QChar ch = line.at(i);
+    if (quoted) {
+      if (ch == '"' && i + 1 < line.size() && line.at(i + 1) == '"') {
+        field += '"';
+        ++i;
+      } else if (ch == '"') {
+        quoted = false;
+      } else {
+        field += ch;
+      }
+    } else if (ch == '"') {
+      quoted = true;
+    } else if (ch == ',') {
+      fields << field.trimmed();
+      field.clear();
+    } else {
+      field += ch;
+    }
+  }
+  fields << field.trimmed();
+  return fields;
+}
+
+/// Returns the list of values of a manifest field, given either as an array or
+/// as a string of values separated by @p separator.
+static QStringList fieldValues(const QJsonValue &value, QChar separator) {
+  QStringList values;
+  if (value.isArray()) {
+    for (const auto &v : value.toArray())
+      values << v.toString();
+  } else {
+    values = value.toString().split(separator, Qt::SkipEmptyParts);
+  }
+  for (auto &v : values)
+    v = v.trimmed();
+  return values;
+}
+
+BatchRunner::BatchRunner(const CLIModeOptions &options) : m_options(options) {}
+
+int BatchRunner::run() {
+  QString errorMessage;
+  if (!parseManifest(errorMessage)) {
+    std::cerr << "ERROR: " << errorMessage.toStdString() << std::endl;
+    return 1;
+  }
+
+  QJsonArray results;
+  if (m_options.batch.workers > 1 && m_options.batch.shards == 1 &&
+      m_jobs.size() > 1) {
+    if (!runWorkers(results, errorMessage)) {
+      std::cerr << "ERROR: " << errorMessage.toStdString() << std::endl;
+      return 1;
+    }
+  } else {
+    results = runJobs();
+  }
+  return writeReport(results);
+}
+
+bool BatchRunner::parseManifest(QString &errorMessage) {
+  QFile file(m_options.batch.manifest);
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    errorMessage =
+        "Failed to open batch manifest '" + m_options.batch.manifest + "'";
+    return false;
+  }
+  const QString baseDir = QFileInfo(file).absolutePath();
+
+  std::vector<QJsonObject> entries;
+  if (m_options.batch.manifest.endsWith(".csv", Qt::CaseInsensitive)) {
+    QTextStream stream(&file);
+    QStringList header;
+    while (!stream.atEnd()) {
+      const QString line = stream.readLine();
+      if (line.trimmed().isEmpty())
+        continue;
+      const QStringList fields = splitCSVLine(line);
+      if (header.isEmpty()) {
+        header = fields;
+        continue;
+      }
+      QJsonObject entry;
+      for (int i = 0; i < fields.size() && i < header.size(); ++i)
+        if (!fields.at(i).isEmpty())
+          entry[header.at(i)] = fields.at(i);
+      entries.push_back(entry);
+    }
+  } else {
+    QJsonParseError parseError;
+    const auto doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (parseError.error != QJsonParseError::NoError || !doc.isArray()) {
+      errorMessage = "Invalid batch manifest '" + m_options.batch.manifest +
+                     "': expected a JSON array of jobs";
+      if (parseError.error != QJsonParseError::NoError)
+        errorMessage += " (" + parseError.errorString() + ")";
+      return false;
+    }
+    for (const auto &value : doc.array())
+      entries.push_back(value.toObject());
+  }
+
+  for (const auto &entry : entries)
+    m_jobs.push_back(parseJob(entry, baseDir, m_options));
+  return true;
+}
+
+BatchRunner::Job BatchRunner::parseJob(const QJsonObject &entry,
+                                       const QString &baseDir,
+                                       const CLIModeOptions &baseOptions) {
+  Job job{entry, baseOptions, QString()};
+  auto &options = job.options;
+  options.batch = BatchOptions();
+  options.captureOutput = true;
+  options.reuseProcessor = true;
+  options.outputFile.clear();
+
+  const QString source = entry.value("source").toString();
+  if (source.isEmpty()) {
+    job.error = "No source file specified";
+    return job;
+  }
+  options.src = QDir(baseDir).filePath(source);
+
+  if (entry.contains("type") &&
+      !parseSourceType(entry.value("type").toString(), options.srcType)) {
+    job.error = "Invalid source type '" + entry.value("type").toString() + "'";
+    return job;
+  }
+
+  if (!entry.contains("processor")) {
+    job.error = "No processor specified";
+    return job;
+  }
+  if (!parseProcessorID(entry.value("processor").toString(), options.proc,
+                        job.error))
+    return job;
+
+  options.isaExtensions = fieldValues(entry.value("extensions"), ',');
+  if (!validateISAExtensions(options.proc, options.isaExtensions, job.error))
+    return job;
+
+  // Register files are separated by ';', given that the initializations of a
+  // register file are separated by ','.
+  options.regInit.clear();
+  if (!parseRegisterInitialization(fieldValues(entry.value("regInit"), ';'),
+                                   options.proc, options.isaExtensions,
+                                   options.regInit, job.error))
+    return job;
+
+  // Console input is read from a file relative to the manifest. Jobs without
+  // console input read the end of the input, rather than waiting for console
+  // input which nothing provides.
+  if (const QString input = entry.value("stdin").toString(); !input.isEmpty())
+    options.stdinFile = QDir(baseDir).filePath(input);
+  else if (options.stdinFile.isEmpty() && !options.stdinData)
+    options.stdinData = QByteArray();
+  // As is the peripheral configuration.
+  if (const QString io = entry.value("io").toString(); !io.isEmpty())
+    options.ioConfig = QDir(baseDir).filePath(io);
+
+  if (entry.contains("timeout")) {
+    const QJsonValue timeout = entry.value("timeout");
+    bool ok = timeout.isDouble() && timeout.toDouble() >= 0;
+    options.timeout = ok ? timeout.toInt() : timeout.toString().toUInt(&ok);
+    if (!ok)
+      job.error = "Invalid timeout value";
+  }
+  for (const auto &[field, bound] :
+       {std::make_pair("maxCycles", &options.maxCycles),
+        std::make_pair("maxInstructions", &options.maxInstructions)}) {
+    if (!entry.contains(field))
+      continue;
+    const QJsonValue value = entry.value(field);
+    bool ok = value.isDouble() && value.toDouble() >= 0;
+    *bound = ok ? value.toInteger() : value.toString().toLongLong(&ok);
+    if (!ok || *bound < 0)
+      job.error = "Invalid " + QString(field) + " value";
+  }
+  return job;
+}
+
+QJsonArray BatchRunner::runJobs() const {
+  QJsonArray results;
+  for (unsigned i = m_options.batch.shard; i < m_jobs.size();
+       i += m_options.batch.shards) {
+    const auto &job = m_jobs.at(i);
+    QJsonObject result = job.entry;
+    result["index"] = static_cast<int>(i);
+    const QJsonObject jobResult = runJob(job);
+    for (auto it = jobResult.begin(); it != jobResult.end(); ++it)
+      result[it.key()] = it.value();
+    results.append(result);
+  }
+  return results;
+}
+
+QJsonObject BatchRunner::runJob(const Job &job) {
+  QJsonObject result;
+  if (!job.error.isEmpty()) {
+    result["status"] = "invalid";
+    result["errors"] = QJsonArray{job.error};
+    return result;
+  }
+
+  // Re-enabling the telemetry resets any state recorded during previous jobs.
+  for (auto &telemetry : job.options.telemetry)
+    if (telemetry->isEnabled())
+      telemetry->enable();
+
+  QElapsedTimer timer;
+  timer.start();
+  CLIRunner runner(job.options);
+  const int exitCode = runner.simulate();
+  switch (exitCode) {
+  case ExitSuccess:
+    result["status"] = "ok";
+    break;
+  case ExitCycleLimit:
+    result["status"] = "cycle limit";
+    break;
+  case ExitInstructionLimit:
+    result["status"] = "instruction limit";
+    break;
+  case ExitWatchpoint:
+    result["status"] = "watchpoint";
+    break;
+  default:
+    result["status"] = "failed";
+    break;
+  }
+  result["seconds"] = timer.elapsed() / 1000.0;
+  if (exitCode != ExitFailure)
+    result["report"] = runner.jsonReport();
+  if (!runner.errors().isEmpty())
+    result["errors"] = QJsonArray::fromStringList(runner.errors());
+  if (!runner.output().isEmpty())
+    result["output"] = runner.output();
+  return result;
+}
+
+bool BatchRunner::runWorkers(QJsonArray &results,
+                             QString &errorMessage) const {
+  QTemporaryDir reportDir;
+  if (!reportDir.isValid()) {
+    errorMessage = "Failed to create a directory for the worker reports";
+    return false;
+  }
+
+  // Workers are relaunched with the arguments of this process. Later
+  // occurrences of --output take precedence over earlier ones.
+  QStringList arguments = QCoreApplication::arguments();
+  arguments.removeFirst();
+  const unsigned workers =
+      std::min<unsigned>(m_options.batch.workers, m_jobs.size());
+  std::vector<std::unique_ptr<QProcess>> processes;
+  for (unsigned i = 0; i < workers; ++i) {
+    auto process = std::make_unique<QProcess>();
+    process->setProcessChannelMode(QProcess::ForwardedChannels);
+    process->start(QCoreApplication::applicationFilePath(),
+                   QStringList(arguments)
+                       << "--batchshard"
+                       << QString::number(i) + "," + QString::number(workers)
+                       << "--output"
+                       << reportDir.filePath(QString::number(i) + ".json"));
+    processes.push_back(std::move(process));
+  }
+
+  std::vector<QJsonValue> jobResults(m_jobs.size());
+  for (unsigned i = 0; i < workers; ++i) {
+    auto &process = processes.at(i);
+    process->waitForFinished(-1);
+    QFile file(reportDir.filePath(QString::number(i) + ".json"));
+    if (!file.open(QIODevice::ReadOnly))
+      continue;
+    const auto report = QJsonDocument::fromJson(file.readAll()).object();
+    for (const auto &value : report.value("jobs").toArray()) {
+      const int index = value.toObject().value("index").toInt(-1);
+      if (index >= 0 && index < static_cast<int>(jobResults.size()))
+        jobResults.at(index) = value;
+    }
+  }
+
+  // Jobs of workers which exited before reporting are reported as failed.
+  for (unsigned i = 0; i < m_jobs.size(); ++i) {
+    if (jobResults.at(i).isUndefined()) {
+      QJsonObject result = m_jobs.at(i).entry;
+      result["index"] = static_cast<int>(i);
+      result["status"] = "failed";
+      result["errors"] = QJsonArray{"Worker process exited unexpectedly"};
+      jobResults.at(i) = result;
+    }
+    results.append(jobResults.at(i));
+  }
+  return true;
+}
+
+int BatchRunner::writeReport(const QJsonArray &results) const {
+  int succeeded = 0, limited = 0;
+  for (const auto &result : results) {
+    const QString status = result.toObject().value("status").toString();
+    succeeded += status == "ok";
+    limited += status == "cycle limit" || status == "instruction limit" ||
+               status == "watchpoint";
+  }
+  QJsonObject summary;
+  summary["jobs"] = results.size();
+  summary["succeeded"] = succeeded;
+  summary["limited"] = limited;
+  summary["failed"] = results.size() - succeeded - limited;
+
+  QJsonObject report;
+  report["summary"] = summary;
+  report["jobs"] = results;
+  const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+
+  if (m_options.outputFile.isEmpty()) {
+    std::cout << json.toStdString() << std::flush;
+    return 0;
+  }
+  QFile outputFile(m_options.outputFile);
+  if (!outputFile.open(QIODevice::Truncate | QIODevice::Text |
+                       QIODevice::WriteOnly)) {
+    std::cerr << "ERROR: Failed to open output file" << std::endl;
+    return 1;
+  }
+  outputFile.write(json);
+  return 0;
+}
+
+} // namespace Ripes
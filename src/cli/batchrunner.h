@@ -0,0 +1,61 @@
+#pragma once
+
+#include "clioptions.h"
+#include <QJsonArray>
+#include <QJsonObject>
+
+namespace Ripes {
+
+/// The BatchRunner class runs the jobs of a manifest (--batch) in a single
+/// invocation of Ripes, such that the startup of Ripes is paid once rather
+/// than once per job. Each job specifies a source file and a processor, and
+/// optionally a source type, ISA extensions, register initializations and a
+/// timeout; all other options are shared by all jobs.
+///
+/// The processor models are driven through the global ProcessorHandler, and
+/// jobs within a process thus run one after another. With more than one
+/// worker (--batchjobs), Ripes is relaunched as a pool of worker processes,
+/// each of which runs an interleaved share of the jobs. The reports of the
+/// workers are merged into a single JSON report, ordered as the manifest.
+class BatchRunner {
+public:
+  BatchRunner(const CLIModeOptions &options);
+
+  /// Runs the jobs of the batch and writes the report. Returns non-zero if the
+  /// manifest or report could not be processed; the failure of individual jobs
+  /// is reported within the report.
+  int run();
+
+  struct Job {
+    // Fields of the job as given in the manifest, for reporting.
+    QJsonObject entry;
+    CLIModeOptions options;
+    // Set if the manifest entry of the job is invalid.
+    QString error;
+  };
+
+  /// Parses a job from its manifest @p entry. The job inherits all options
+  /// of @p options which are not given per job. Relative source paths are
+  /// resolved relative to @p baseDir.
+  static Job parseJob(const QJsonObject &entry, const QString &baseDir,
+                      const CLIModeOptions &options);
+
+  /// Runs @p job, returning its status, errors, console output and telemetry.
+  static QJsonObject runJob(const Job &job);
+
+private:
+  bool parseManifest(QString &errorMessage);
+
+  /// Runs the jobs of the share of this process.
+  QJsonArray runJobs() const;
+
+  /// Runs the jobs through a pool of worker processes.
+  bool runWorkers(QJsonArray &results, QString &errorMessage) const;
+
+  int writeReport(const QJsonArray &results) const;
+
+  CLIModeOptions m_options;
+  std::vector<Job> m_jobs;
+};
+
+} // namespace Ripes
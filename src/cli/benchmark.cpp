@@ -0,0 +1,151 @@
+#include "benchmark.h"
+#include "clirunner.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QTemporaryFile>
+#include <QTextStream>
+
+#include <iostream>
+
+namespace Ripes {
+
+// Sums, multiplies and swaps the elements of an array over a number of passes,
+// followed by an exit system call.
+const QString Benchmark::s_workload = QStringList{".data",
+                                                  "array: .zero 1024",
+                                                  ".text",
+                                                  "  li s0, 64",
+                                                  "pass:",
+                                                  "  la a0, array",
+                                                  "  li a1, 255",
+                                                  "  li a2, 0",
+                                                  "loop:",
+                                                  "  lw t0, 0(a0)",
+                                                  "  lw t1, 4(a0)",
+                                                  "  add t2, t0, a1",
+                                                  "  mul t3, t1, a1",
+                                                  "  xor t4, t2, t3",
+                                                  "  srli t4, t4, 3",
+                                                  "  add a2, a2, t4",
+                                                  "  sw t1, 0(a0)",
+                                                  "  sw t2, 4(a0)",
+                                                  "  blt t0, t1, skip",
+                                                  "  addi a2, a2, 1",
+                                                  "skip:",
+                                                  "  addi a0, a0, 4",
+                                                  "  addi a1, a1, -1",
+                                                  "  bnez a1, loop",
+                                                  "  addi s0, s0, -1",
+                                                  "  bnez s0, pass",
+                                                  "  li a7, 10",
+                                                  "  ecall"}
+                                          .join("\n");
+
+Benchmark::Benchmark(const CLIModeOptions &options) : m_options(options) {}
+
+int Benchmark::run() {
+  QTemporaryFile workload;
+  if (!workload.open() || workload.write(s_workload.toUtf8()) < 0 ||
+      !workload.flush()) {
+    std::cerr << "ERROR: Failed to write the benchmark workload" << std::endl;
+    return 1;
+  }
+
+  std::vector<QJsonObject> results;
+  // The workload is RISC-V assembly.
+  for (const auto &desc : ProcessorRegistry::getAvailableProcessors())
+    if (ProcessorRegistry::isaFamily(desc.first) == "RISC-V")
+      results.push_back(runProcessor(desc.first, workload.fileName()));
+  return writeReport(results);
+}
+
+QJsonObject Benchmark::runProcessor(ProcessorID id,
+                                    const QString &workload) const {
+  CLIModeOptions options = m_options;
+  options.benchmark = false;
+  options.src = workload;
+  options.srcType = SourceType::Assembly;
+  options.proc = id;
+  options.isaExtensions =
+      ProcessorRegistry::getDescription(id).isaInfo().defaultExtensions;
+  options.regInit.clear();
+  options.captureOutput = true;
+  options.outputFile.clear();
+
+  std::shared_ptr<SimSpeedTelemetry> simSpeed;
+  for (auto &telemetry : options.telemetry) {
+    if (auto t = std::dynamic_pointer_cast<SimSpeedTelemetry>(telemetry)) {
+      simSpeed = t;
+      simSpeed->enable();
+    }
+  }
+
+  CLIRunner runner(options);
+  const bool success = runner.simulate() == 0;
+  const auto *proc = ProcessorHandler::getProcessor();
+  QJsonObject result;
+  result["processor"] = enumToString<ProcessorID>(id);
+  result["status"] = success ? "ok" : "failed";
+  result["cycles"] = proc->getCycleCount();
+  result["instructions"] = proc->getInstructionsRetired();
+  result["simulation speed"] =
+      QJsonValue::fromVariant(simSpeed->report(/*json=*/true));
+  if (!runner.errors().isEmpty())
+    result["errors"] = QJsonArray::fromStringList(runner.errors());
+  return result;
+}
+
+int Benchmark::writeReport(const std::vector<QJsonObject> &results) const {
+  QString out;
+  QTextStream stream(&out);
+  bool success = true;
+  if (m_options.jsonOutput) {
+    QJsonArray array;
+    for (const auto &result : results)
+      array.append(result);
+    stream << QJsonDocument(array).toJson(QJsonDocument::Indented);
+  } else {
+    stream << qSetFieldWidth(20) << Qt::left << "processor"
+           << qSetFieldWidth(14) << Qt::right;
+    for (const char *column : {"cycles", "instructions", "construct s",
+                               "load s", "run s", "cycles/s", "instrs/s"})
+      stream << column;
+    stream << qSetFieldWidth(0) << "\n";
+    for (const auto &result : results) {
+      const auto speed = result.value("simulation speed").toObject();
+      stream << qSetFieldWidth(20) << Qt::left
+             << result.value("processor").toString() << qSetFieldWidth(14)
+             << Qt::right << result.value("cycles").toInteger()
+             << result.value("instructions").toInteger();
+      for (const char *key :
+           {"construction seconds", "loading seconds", "run seconds"})
+        stream << QString::number(speed.value(key).toDouble(), 'f', 4);
+      for (const char *key : {"cycles per second", "instructions per second"})
+        stream << QString::number(speed.value(key).toDouble(), 'f', 0);
+      stream << qSetFieldWidth(0);
+      if (result.value("status").toString() != "ok")
+        stream << "  (failed)";
+      stream << "\n";
+    }
+  }
+  for (const auto &result : results)
+    success &= result.value("status").toString() == "ok";
+  stream.flush();
+
+  if (m_options.outputFile.isEmpty()) {
+    std::cout << out.toStdString() << std::flush;
+  } else {
+    QFile outputFile(m_options.outputFile);
+    if (!outputFile.open(QIODevice::Truncate | QIODevice::Text |
+                         QIODevice::WriteOnly)) {
+      std::cerr << "ERROR: Failed to open output file" << std::endl;
+      return 1;
+    }
+    outputFile.write(out.toUtf8());
+  }
+  return success ? 0 : 1;
+}
+
+} // namespace Ripes
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "clioptions.h"
+#include <QJsonObject>
+
+namespace Ripes {
+
+/// The Benchmark class measures the speed of the simulator (--benchmark). A
+/// bundled workload is run on every registered processor model, and the
+/// wall-clock time of the run and the simulated cycles and instructions per
+/// second of each model are reported as a table, for catching performance
+/// regressions in the processor models.
+class Benchmark {
+public:
+  Benchmark(const CLIModeOptions &options);
+
+  /// Runs the workload on every processor model and writes the report.
+  /// Returns non-zero if the workload failed on any processor model.
+  int run();
+
+  /// Returns the measurements of running the workload on @p id.
+  QJsonObject runProcessor(ProcessorID id, const QString &workload) const;
+
+  /// The bundled workload, an assembly program exercising arithmetic, memory
+  /// accesses and branches which runs on all processor models.
+  static const QString s_workload;
+
+private:
+  int writeReport(const std::vector<QJsonObject> &results) const;
+
+  CLIModeOptions m_options;
+};
+
+} // namespace Ripes
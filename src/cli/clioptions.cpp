@@ -1,6 +1,8 @@
 #include "clioptions.h"
 #include "processorregistry.h"
+#include "processors/RISC-V/rv_vector.h"
 #include "radix.h"
+#include "ripessettings.h"
 #include "telemetry.h"
 #include <QFile>
 #include <QMetaEnum>
@@ -12,10 +14,410 @@
 
 namespace Ripes {
 
+bool parseCacheConfig(const QString &spec, CachePreset &preset) {
+  static const std::map<QString, ReplPolicy> policies{
+      {"random", ReplPolicy::Random}, {"lru", ReplPolicy::LRU},
+      {"plru", ReplPolicy::PLRU},     {"fifo", ReplPolicy::FIFO},
+      {"srrip", ReplPolicy::SRRIP},   {"brrip", ReplPolicy::BRRIP}};
+
+  const auto presets = RipesSettings::value(RIPES_SETTING_CACHE_PRESETS)
+                           .value<QList<CachePreset>>();
+  for (const auto &p : presets) {
+    if (p.name == spec) {
+      preset = p;
+      return true;
+    }
+  }
+
+  QStringList values = spec.split(":");
+  ReplPolicy policy = ReplPolicy::LRU;
+  if (values.size() == 4) {
+    auto it = policies.find(values.takeLast());
+    if (it == policies.end())
+      return false;
+    policy = it->second;
+  }
+  if (values.size() != 3)
+    return false;
+  std::vector<int> bits;
+  for (const auto &value : values) {
+    bool ok;
+    bits.push_back(value.toInt(&ok));
+    if (!ok || bits.back() < 0 || bits.back() > 16)
+      return false;
+  }
+  preset = CachePreset{spec,
+                       bits.at(0),
+                       bits.at(1),
+                       bits.at(2),
+                       WritePolicy::WriteBack,
+                       WriteAllocPolicy::WriteAllocate,
+                       policy};
+  return true;
+}
+
+/// Parses a prefetcher configuration <cache>=<type>[:<degree>] of a cache
+/// hierarchy.
+/// Parses a budget given as [<component>=]<MiB>, where a budget without a
+/// component applies to all components.
+static bool parseMemoryBudget(
+    const QString &spec,
+    std::array<size_t, MemoryFootprint::NComponents> &budgets) {
+  const QStringList parts = spec.split("=");
+  if (parts.size() > 2)
+    return false;
+  bool ok;
+  const qulonglong mib = parts.back().toULongLong(&ok);
+  if (!ok)
+    return false;
+  const size_t bytes = size_t(mib) << 20;
+  if (parts.size() == 1) {
+    budgets.fill(bytes);
+    return true;
+  }
+  for (unsigned i = 0; i < MemoryFootprint::NComponents; ++i) {
+    if (parts.at(0) == MemoryFootprint::key(MemoryFootprint::Component(i))) {
+      budgets[i] = bytes;
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool parsePrefetchConfig(const QString &spec,
+                                CacheHierarchyConfig &config) {
+  static const std::map<QString, PrefetcherType> types{
+      {"nextline", PrefetcherType::NextLine},
+      {"stride", PrefetcherType::Stride},
+      {"stream", PrefetcherType::Stream}};
+
+  const QStringList parts = spec.split("=");
+  if (parts.size() != 2)
+    return false;
+  PrefetchConfig *target = nullptr;
+  if (parts.at(0) == "l1i")
+    target = &config.l1iPrefetch;
+  else if (parts.at(0) == "l1d")
+    target = &config.l1dPrefetch;
+  else if (parts.at(0) == "l2" && config.l2)
+    target = &config.l2Prefetch;
+  else
+    return false;
+
+  const QStringList values = parts.at(1).split(":");
+  auto it = types.find(values.at(0));
+  if (values.size() > 2 || it == types.end())
+    return false;
+  target->type = it->second;
+  target->degree = 1;
+  if (values.size() == 2) {
+    bool ok;
+    target->degree = values.at(1).toUInt(&ok);
+    if (!ok || target->degree == 0 || target->degree > 64)
+      return false;
+  }
+  return true;
+}
+
+static bool parseVictimCache(const QString &spec,
+                             CacheHierarchyConfig &config) {
+  const QStringList parts = spec.split("=");
+  if (parts.size() != 2)
+    return false;
+  unsigned *target = nullptr;
+  if (parts.at(0) == "l1i")
+    target = &config.l1iVictim;
+  else if (parts.at(0) == "l1d")
+    target = &config.l1dVictim;
+  else
+    return false;
+  bool ok;
+  *target = parts.at(1).toUInt(&ok);
+  return ok && *target != 0 && *target <= 64;
+}
+
+static bool parseFunctionalUnitTiming(const QString &spec,
+                                      FunctionalUnitTiming &timing) {
+  for (const auto &unitSpec : spec.split(",")) {
+    const QStringList parts = unitSpec.split("=");
+    if (parts.size() != 2)
+      return false;
+    FunctionalUnitTiming::Unit *unit = nullptr;
+    if (parts.at(0) == "mul")
+      unit = &timing.mul;
+    else if (parts.at(0) == "div")
+      unit = &timing.div;
+    else
+      return false;
+
+    const QStringList values = parts.at(1).split("/");
+    if (values.size() > 2)
+      return false;
+    bool ok;
+    unit->latency = values.at(0).toUInt(&ok);
+    if (!ok || unit->latency == 0)
+      return false;
+    unit->interval = 1;
+    if (values.size() == 2) {
+      unit->interval = values.at(1).toUInt(&ok);
+      if (!ok || unit->interval == 0)
+        return false;
+    }
+  }
+  return true;
+}
+
+static bool parseEnergyModel(const QString &spec, EnergyModel &model) {
+  for (const auto &costSpec : spec.split(",")) {
+    const QStringList parts = costSpec.split("=");
+    if (parts.size() != 2)
+      return false;
+    bool ok;
+    const double picojoules = parts.at(1).toDouble(&ok);
+    if (!ok || picojoules < 0 || !model.set(parts.at(0), picojoules))
+      return false;
+  }
+  return true;
+}
+
+static bool parseStoreBuffer(const QString &spec, StoreBufferConfig &config) {
+  const QStringList parts = spec.split(",");
+  if (parts.size() > 2)
+    return false;
+  bool ok;
+  config.entries = parts.at(0).toUInt(&ok);
+  if (!ok || config.entries == 0)
+    return false;
+  if (parts.size() == 2) {
+    if (parts.at(1) != "combine")
+      return false;
+    config.writeCombining = true;
+  }
+  return true;
+}
+
+/// Parses a TLB configuration, given as <sets>:<ways>[:<policy>] in log2
+/// values.
+static bool parseTLBConfig(const QString &spec, TLBConfig &config) {
+  static const std::map<QString, ReplPolicy> policies{
+      {"lru", ReplPolicy::LRU},
+      {"fifo", ReplPolicy::FIFO},
+      {"random", ReplPolicy::Random}};
+  QStringList values = spec.split(":");
+  if (values.size() == 3) {
+    auto it = policies.find(values.takeLast());
+    if (it == policies.end())
+      return false;
+    config.policy = it->second;
+  }
+  if (values.size() != 2)
+    return false;
+  bool setsOk, waysOk;
+  config.sets = values.at(0).toUInt(&setsOk);
+  config.ways = values.at(1).toUInt(&waysOk);
+  return setsOk && waysOk && config.sets + config.ways <= 12;
+}
+
+/// Parses a DRAM organization, given as <banks>:<rowbytes>[:<policy>].
+static bool parseDRAMConfig(const QString &spec, DRAMConfig &config) {
+  QStringList values = spec.split(":");
+  if (values.size() == 3) {
+    const QString policy = values.takeLast();
+    if (policy == "open")
+      config.policy = RowPolicy::Open;
+    else if (policy == "closed")
+      config.policy = RowPolicy::Closed;
+    else
+      return false;
+  }
+  if (values.size() != 2)
+    return false;
+  bool banksOk, rowBytesOk;
+  config.banks = values.at(0).toUInt(&banksOk);
+  config.rowBytes = values.at(1).toUInt(&rowBytesOk);
+  const auto isPowerOfTwo = [](unsigned value) {
+    return value != 0 && (value & (value - 1)) == 0;
+  };
+  return banksOk && rowBytesOk && isPowerOfTwo(config.banks) &&
+         isPowerOfTwo(config.rowBytes);
+}
+
+static bool parsePairingPolicy(const QString &spec, WayPairingPolicy &policy) {
+  for (const auto &restriction : spec.split(",")) {
+    if (restriction == "memonly")
+      policy.dataWayArithmetic = false;
+    else if (restriction == "branchalone")
+      policy.pairControlflow = false;
+    else if (restriction != "full")
+      return false;
+  }
+  return true;
+}
+
+static bool parseTargetPrediction(const QString &spec,
+                                  TargetPredictionConfig &config) {
+  for (const auto &predictorSpec : spec.split(",")) {
+    const QStringList parts = predictorSpec.split("=");
+    if (parts.size() != 2)
+      return false;
+    bool ok;
+    const unsigned entries = parts.at(1).toUInt(&ok);
+    if (!ok)
+      return false;
+    if (parts.at(0) == "ras")
+      config.rasEntries = entries;
+    else if (parts.at(0) == "indirect")
+      config.indirectEntries = entries;
+    else
+      return false;
+  }
+  return true;
+}
+
+static bool parseFetchQueue(const QString &spec, FetchQueueConfig &config) {
+  for (const auto &part : spec.split(",")) {
+    const QStringList parts = part.split("=");
+    if (parts.size() != 2)
+      return false;
+    bool ok;
+    const unsigned value = parts.at(1).toUInt(&ok);
+    if (!ok)
+      return false;
+    if (parts.at(0) == "entries")
+      config.entries = value;
+    else if (parts.at(0) == "line")
+      config.lineBytes = value;
+    else
+      return false;
+  }
+  return true;
+}
+
+bool parseSourceType(const QString &type, SourceType &srcType) {
+  static const std::map<QString, SourceType> types{
+      {"c", SourceType::C},
+      {"asm", SourceType::Assembly},
+      {"bin", SourceType::FlatBinary},
+      {"elf", SourceType::ExternalELF}};
+  auto it = types.find(type);
+  if (it == types.end())
+    return false;
+  srcType = it->second;
+  return true;
+}
+
+bool parseProcessorID(const QString &name, ProcessorID &proc,
+                      QString &errorMessage) {
+  bool ok;
+  int procID = QMetaEnum::fromType<ProcessorID>().keyToValue(
+      name.toStdString().c_str(), &ok);
+  if (!ok) {
+    errorMessage = "Invalid processor model specified '" + name + "' (--proc).";
+    return false;
+  }
+  proc = static_cast<ProcessorID>(procID);
+  return true;
+}
+
+bool validateISAExtensions(ProcessorID proc, const QStringList &isaExtensions,
+                           QString &errorMessage) {
+  // Validate the ISA extensions with respect to the selected processor.
+  auto exts =
+      ProcessorRegistry::getDescription(proc).isaInfo().supportedExtensions;
+
+  for (auto &ext : isaExtensions) {
+    if (!exts.contains(ext)) {
+      errorMessage =
+          "Invalid ISA extension '" + ext + "' specified (--isaexts).";
+      errorMessage += " Processor '" + enumToString<ProcessorID>(proc) + "'";
+      errorMessage += " supports extensions: " + exts.join(", ");
+      return false;
+    }
+  }
+  return true;
+}
+
+bool parseRegisterInitialization(const QStringList &specs, ProcessorID proc,
+                                 const QStringList &isaExtensions,
+                                 RegisterInitialization &regInit,
+                                 QString &errorMessage) {
+  const auto &procisa =
+      ProcessorRegistry::getAvailableProcessors().at(proc)->isaInfo();
+  const auto *isa = procisa.isa.get();
+  for (const auto &regFileInit : specs) {
+    if (!regFileInit.contains(':')) {
+      errorMessage = "Cannot find register file type (--reginit).";
+      return false;
+    }
+    auto regFileSplit = regFileInit.indexOf(':');
+    QString regFile = regFileInit.mid(0, regFileSplit);
+
+    QStringList regInitList = regFileInit.mid(regFileSplit + 1).split(",");
+    for (auto &init : regInitList) {
+      QStringList regInitParts = init.split("=");
+      if (regInitParts.size() != 2) {
+        errorMessage = "Invalid register initialization '" + init +
+                       "' specified (--reginit).";
+        return false;
+      }
+      bool ok;
+      int regIdx = regInitParts[0].toInt(&ok);
+      if (!ok) {
+        errorMessage = "Invalid register index '" + regInitParts[0] +
+                       "' specified (--reginit).";
+        return false;
+      }
+
+      auto &vstr = regInitParts[1];
+      VInt regVal = decodeRadixValue(vstr, &ok);
+
+      if (!ok) {
+        errorMessage =
+            "Invalid register value '" + vstr + "' specified (--reginit).";
+        return false;
+      }
+
+      std::string_view rfid = "";
+      auto fileNames = isa->regFileNames();
+      for (const auto &regFileName : fileNames) {
+        if (regFile == QString(regFileName.data())) {
+          rfid = regFileName;
+          break;
+        }
+      }
+      if (rfid.empty()) {
+        errorMessage = "Invalid register file type '" + regFile +
+                       "' specified (--reginit). Valid types for '" +
+                       enumToString<ProcessorID>(proc) + "' with extensions [";
+        std::stringstream extInfo;
+        extInfo << isaExtensions.join(", ").toStdString();
+        extInfo << "]: [";
+        llvm::interleaveComma(fileNames, extInfo);
+        extInfo << "]";
+        errorMessage += extInfo.str().c_str();
+        return false;
+      }
+
+      if (regInit.count(rfid) == 0) {
+        regInit[rfid] = {{regIdx, regVal}};
+      } else {
+        if (regInit.at(rfid).count(regIdx) > 0) {
+          errorMessage = "Duplicate register initialization for register " +
+                         QString::number(regIdx) + " specified (--reginit).";
+          return false;
+        }
+
+        regInit[rfid][regIdx] = regVal;
+      }
+    }
+  }
+  return true;
+}
+
 void addCLIOptions(QCommandLineParser &parser, Ripes::CLIModeOptions &options) {
   parser.addOption(QCommandLineOption("src", "Path to source file.", "path"));
   parser.addOption(QCommandLineOption(
-      "t", "Source file type. Options: [c, asm, bin]", "type", "asm"));
+      "t", "Source file type. Options: [c, asm, bin, elf]", "type", "asm"));
 
   // Processor models. Generate information from processor registry.
   QStringList processorOptions;
@@ -41,11 +443,420 @@ void addCLIOptions(QCommandLineParser &parser, Ripes::CLIModeOptions &options) {
       "Simulation timeout in milliseconds. If simulation does not finish "
       "within the specified time, it will be aborted.",
       "ms", "0"));
+  parser.addOption(QCommandLineOption(
+      "maxcycles",
+      "Stops the simulation after <n> cycles. Unlike --timeout, the bound is "
+      "independent of the speed of the host. Exits with code 2 if reached.",
+      "n", "0"));
+  parser.addOption(QCommandLineOption(
+      "maxinstrs",
+      "Stops the simulation after <n> retired instructions. Exits with code 3 "
+      "if reached.",
+      "n", "0"));
+  parser.addOption(QCommandLineOption(
+      "watch",
+      "Stops the simulation once the bytes <first> to <last> (or the byte at "
+      "<first>) are read (r), written (w) or either (rw, the default). Exits "
+      "with code 4 if hit. Can be used multiple times.",
+      "first[-last][:r|w|rw]"));
+  parser.addOption(QCommandLineOption(
+      "watchreg",
+      "Stops the simulation once register <reg> is written, eg. a0 or x10. "
+      "Exits with code 4 if hit. Can be used multiple times.",
+      "reg"));
+  parser.addOption(QCommandLineOption(
+      "sample",
+      "Sampled simulation. Repeatedly fast-forwards <ff> instructions and "
+      "warms up the caches for <warmup> instructions using the functional "
+      "simulator, and then simulates <window> instructions with the selected "
+      "processor model. Reports CPI and cache hit rates with confidence "
+      "intervals.",
+      "ff,warmup,window"));
+  parser.addOption(QCommandLineOption(
+      "cosim",
+      "Co-simulate the processor model in lockstep with the single-cycle "
+      "reference model, stopping at the first divergence in register "
+      "writes."));
+  parser.addOption(QCommandLineOption(
+      "native",
+      "Clocks processors with native clocking, such as Verilator-backed "
+      "processors and the ISS, in tight loops, synchronizing their state with "
+      "the simulator in between slices of cycles. Cannot be used together "
+      "with options observing individual cycles."));
+  parser.addOption(QCommandLineOption(
+      "cachesweep",
+      "Computes the hit rates of a grid of instruction and data cache "
+      "configurations in a single run, assuming LRU replacement. Each range is "
+      "given as log2 values <min>-<max> (or a single value) for the number of "
+      "blocks, lines and ways.",
+      "blocks,lines,ways"));
+  parser.addOption(QCommandLineOption(
+      "caches",
+      "Simulates split L1 instruction and data caches, and optionally a "
+      "unified L2 cache, during the run. Each cache is given as the name of a "
+      "cache preset or as <blocks>:<lines>:<ways>[:<policy>] in log2 values, "
+      "where <policy> is one of [lru, random, plru, fifo, srrip, brrip].",
+      "l1i,l1d[,l2]"));
+  parser.addOption(QCommandLineOption(
+      "cachelatency",
+      "Access latencies in cycles of the L1 caches, the L2 cache and main "
+      "memory, used for reporting the average memory access time of --caches.",
+      "l1,l2,mem", "1,10,100"));
+  parser.addOption(QCommandLineOption(
+      "cachestall",
+      "Stalls the processor on misses of the L1 caches of --caches for the "
+      "latencies of --cachelatency, such that the cycle count includes the "
+      "memory stalls. The caches of processors without memory stalls, such as "
+      "the ISS, are observed instead."));
+  parser.addOption(QCommandLineOption(
+      "storebuffer",
+      "Buffers the stores of --cachestall in a store buffer of <entries> "
+      "entries in front of the L1 data cache, which forwards buffered data to "
+      "loads. With combine, sequential stores to a cache block are merged "
+      "into a single entry.",
+      "entries[,combine]"));
+  parser.addOption(QCommandLineOption(
+      "dram",
+      "Replaces the memory latency of --caches by a DRAM of <banks> banks "
+      "with row buffers of <rowbytes> bytes behind the last cache level. "
+      "<policy> is one of [open, closed] (default: open).",
+      "banks:rowbytes[:policy]"));
+  parser.addOption(QCommandLineOption(
+      "dramtiming",
+      "Row activation (tRCD), column access (tCAS) and precharge (tRP) "
+      "latencies in cycles of the DRAM of --dram (default: 30,30,30).",
+      "trcd,tcas,trp", "30,30,30"));
+  parser.addOption(QCommandLineOption(
+      "fulatency",
+      "Latencies and issue intervals in cycles of the multiplier and divider "
+      "of the processor, which execute the M extension. The interval defaults "
+      "to 1 (a pipelined unit). Ignored by processors without multi-cycle "
+      "functional units.",
+      "mul=latency[/interval],div=latency[/interval]"));
+  parser.addOption(QCommandLineOption(
+      "energymodel",
+      "Energy costs in picojoules of the estimate of --energy, overriding the "
+      "defaults. Costs are per retired instruction of a class (alu, muldiv, "
+      "fp, vector, load, store, control, system), per register file access "
+      "(reg), per cache access and miss of each level (l1, l1miss, l2, "
+      "l2miss), per main memory access (dram) and per cycle (static). Enables "
+      "--energy.",
+      "name=pJ,..."));
+  parser.addOption(QCommandLineOption(
+      "pairing",
+      "Restricts the instruction pairs issued together by the dual-issue "
+      "processors. Comma-separated restrictions, of: memonly (the data way "
+      "only executes loads and stores), branchalone (control flow issues "
+      "alone). Default: full (no restrictions).",
+      "policy"));
+  parser.addOption(QCommandLineOption(
+      "targetpred",
+      "Entries of the return-address stack and of the indirect-target "
+      "predictor of the processors with branch prediction. 0 disables a "
+      "predictor (default), such that the targets are predicted by the branch "
+      "target buffer.",
+      "ras=entries,indirect=entries"));
+  parser.addOption(QCommandLineOption(
+      "fetchqueue",
+      "Entries of the fetch queue of the generated pipelines, and the bytes of "
+      "the lines fetched into it (default 16). 0 entries disables the queue "
+      "(default), such that a single instruction is fetched per cycle.",
+      "entries=n,line=bytes"));
+  parser.addOption(QCommandLineOption(
+      "vlen",
+      "Length in bits of the vector registers of the processors implementing "
+      "the V extension. A power of two from 64 to 65536 (default 128).",
+      "bits"));
+  parser.addOption(QCommandLineOption(
+      "prefetch",
+      "Attaches a prefetcher to a cache of --caches. Can be used multiple "
+      "times. <cache> is one of [l1i, l1d, l2] and <type> one of [nextline, "
+      "stride, stream]. <degree> is the number of blocks prefetched ahead of "
+      "the access stream (default 1).",
+      "cache=type[:degree]"));
+  parser.addOption(QCommandLineOption(
+      "victimcache",
+      "Places a fully associative victim cache of <entries> blocks (at most "
+      "64) behind an L1 cache of --caches, holding the blocks evicted from "
+      "it. Can be used multiple times. <cache> is one of [l1i, l1d]. A lookup "
+      "takes 1 cycle.",
+      "cache=entries"));
+  parser.addOption(QCommandLineOption(
+      "inclusion",
+      "Inclusion policy of the L2 cache of --caches with respect to the L1 "
+      "caches. One of [noninclusive, inclusive, exclusive] (default: "
+      "noninclusive).",
+      "policy"));
+  parser.addOption(QCommandLineOption(
+      "mmu",
+      "Translates the instruction and data memory accesses of the run through "
+      "split TLBs and Sv32 (RV32) or Sv39 (RV64) page tables, and reports the "
+      "TLB hit rates, page walks and estimated stall cycles. <mode> is one of "
+      "[sv32, sv39].",
+      "mode"));
+  parser.addOption(QCommandLineOption(
+      "pagetable",
+      "Address or symbol of the root page table of --mmu in the memory of the "
+      "program. Without a page table, an identity mapping in pages of "
+      "--pagesize is walked instead.",
+      "address|symbol"));
+  parser.addOption(QCommandLineOption(
+      "pagesize",
+      "Page size of the identity mapping of --mmu; one of [4k, 4m] for Sv32 "
+      "and [4k, 2m, 1g] for Sv39 (default: 4k).",
+      "size", "4k"));
+  parser.addOption(QCommandLineOption(
+      "tlbs",
+      "Instruction and data TLBs of --mmu, each given as "
+      "<sets>:<ways>[:<policy>] in log2 values, where <policy> is one of "
+      "[lru, fifo, random] (default: 0:5,0:5).",
+      "itlb,dtlb", "0:5,0:5"));
+  parser.addOption(QCommandLineOption(
+      "walklatency",
+      "Latency in cycles of reading a page table entry during a page walk of "
+      "--mmu (default: 100).",
+      "cycles", "100"));
+  parser.addOption(QCommandLineOption(
+      "recordtrace",
+      "Records the instruction and data memory accesses of every cycle to a "
+      "binary access trace file.",
+      "path"));
+  parser.addOption(QCommandLineOption(
+      "replaytrace",
+      "Replays a binary access trace file (see --recordtrace) through the "
+      "instruction and data cache simulators, configured by the first cache "
+      "preset, instead of simulating a program. --src is not required.",
+      "path"));
+  parser.addOption(QCommandLineOption(
+      "recordinputs",
+      "Records the nondeterministic inputs of the run (system call times, "
+      "console input and peripheral inputs) to a binary input log.",
+      "path"));
+  parser.addOption(QCommandLineOption(
+      "replayinputs",
+      "Replays the inputs of a binary input log (see --recordinputs) in place "
+      "of the live inputs of the run.",
+      "path"));
+  parser.addOption(QCommandLineOption(
+      "savesnapshot",
+      "Saves the state of the processor, memory, caches and peripherals to a "
+      "binary snapshot once the run stops.",
+      "path"));
+  parser.addOption(QCommandLineOption(
+      "loadsnapshot",
+      "Restores the state of a binary snapshot (see --savesnapshot) over the "
+      "loaded program before the run, which resumes from the snapshot.",
+      "path"));
+  parser.addOption(QCommandLineOption(
+      "memorybudget",
+      "Warns after the run if a component of Ripes holds more than <MiB> MiB "
+      "of memory (see --footprint). Can be used multiple times. <component> is "
+      "one of [rewind, cachetraces, pipeline, disassembly, console, memory]; "
+      "without a component, the budget applies to all components.",
+      "[component=]MiB"));
+  parser.addOption(QCommandLineOption(
+      "pipelinetrace",
+      "Streams the pipeline state of every recorded cycle to <path>, one row "
+      "per cycle, instead of holding it in memory for --pipeline.",
+      "path"));
+  parser.addOption(QCommandLineOption(
+      "pipelineformat",
+      "Format of --pipelinetrace [tsv, chrome]. 'chrome' writes the Chrome "
+      "Trace Event format, for viewing in chrome://tracing or the Perfetto "
+      "UI. Default: 'chrome' if <path> ends with .json, otherwise 'tsv'.",
+      "format"));
+  parser.addOption(QCommandLineOption(
+      "pipelinewindow",
+      "Only records the cycles <first> to <last> in --pipelinetrace. <last> "
+      "may be omitted to record until the end of the run.",
+      "first-last"));
+  parser.addOption(QCommandLineOption(
+      "pipelinebreak",
+      "Only records the cycles around the cycles in which the instruction at "
+      "<address> is in a breakpoint-triggering stage in --pipelinetrace. Can "
+      "be used multiple times.",
+      "address"));
+  parser.addOption(QCommandLineOption(
+      "pipelinecontext",
+      "Number of cycles recorded before and after each --pipelinebreak "
+      "breakpoint (default: 8).",
+      "n", "8"));
+  parser.addOption(QCommandLineOption(
+      "commitlog",
+      "Logs a record per retired instruction to <path>, holding its address, "
+      "its instruction word, the register it wrote and its data memory "
+      "access, for comparison against external reference models.",
+      "path"));
+  parser.addOption(QCommandLineOption(
+      "commitlogformat",
+      "Format of --commitlog [bin, spike]. 'spike' writes the text format of "
+      "the commit log of Spike (--log-commits). Default: 'spike' if <path> "
+      "ends with .log, otherwise 'bin'.",
+      "format"));
+  parser.addOption(QCommandLineOption(
+      "stream",
+      "Writes a JSON record of the progress of the run per interval (see "
+      "--streaminterval) to <path>, one record per line, or to stdout if "
+      "<path> is '-'.",
+      "path"));
+  parser.addOption(QCommandLineOption(
+      "streaminterval",
+      "Interval between the records of --stream, in cycles (<n>c) or in "
+      "milliseconds (<n>ms).",
+      "interval", "1000ms"));
+  parser.addOption(QCommandLineOption(
+      "profilefolded",
+      "Writes the profile of --profile to <path> in the folded stack format "
+      "of flame graph tools. Enables --profile.",
+      "path"));
+  parser.addOption(QCommandLineOption(
+      "profileblocks",
+      "Writes the basic block profile of --profile to <path>, as a Graphviz "
+      "graph if <path> ends in .dot and otherwise as JSON. Enables --profile.",
+      "path"));
+  parser.addOption(QCommandLineOption(
+      "profiletop",
+      "Number of source lines and instructions reported by --profile, and of "
+      "instructions and symbols reported by --cachemisses (default: 20).",
+      "n", "20"));
+  parser.addOption(QCommandLineOption(
+      "reuseblocks",
+      "Block size of the reuse-distance analysis of --reuse, as a log2 number "
+      "of words (default: 2).",
+      "n", "2"));
+  parser.addOption(QCommandLineOption(
+      "reusewindow",
+      "Number of cycles of the windows over which --reuse reports the "
+      "working-set size (default: 1000).",
+      "cycles", "1000"));
+  parser.addOption(QCommandLineOption(
+      "dump",
+      "Dumps the <bytes> bytes of memory at <start>, an address or a symbol of "
+      "the program, once the simulation finished, eg. result:4096. Can be "
+      "used multiple times.",
+      "start:bytes"));
+  parser.addOption(QCommandLineOption(
+      "dumpformat",
+      "Format of --dump: lines of hexadecimal bytes (hex), a JSON array of "
+      "the bytes of each region (json), or the raw bytes of the regions "
+      "(bin), which requires --dumpfile.",
+      "hex|json|bin", "hex"));
+  parser.addOption(QCommandLineOption(
+      "dumpfile",
+      "Writes --dump to <path>, instead of after the report.", "path"));
+  parser.addOption(QCommandLineOption(
+      "asmcache",
+      "Directory in which assembled programs are cached. Assembling a source "
+      "which was previously assembled with the same processor, ISA extensions "
+      "and segment settings loads the cached program instead.",
+      "path"));
+  parser.addOption(QCommandLineOption(
+      "preload",
+      "Loads the file at <path> into memory at <start>, an address or a symbol "
+      "of the program, ahead of the run, eg. data.bin@buffer:a0,a1. The file "
+      "is mapped rather than copied. The optional registers are initialized "
+      "with the address and the size in bytes of the file. Can be used "
+      "multiple times.",
+      "path@start[:reg[,reg]]"));
+  parser.addOption(QCommandLineOption(
+      "stdin",
+      "Reads the console input of the program from <path>, or from the "
+      "standard input of Ripes if '-', instead of waiting for console input. "
+      "Reads past the end of the input return EOF.",
+      "path"));
+  parser.addOption(QCommandLineOption(
+      "io",
+      "Instantiates the peripherals described by the JSON configuration at "
+      "<path>, without a display. The inputs of the peripherals are set by the "
+      "timeline of the configuration.",
+      "path"));
+  parser.addOption(QCommandLineOption(
+      "cc",
+      "Path to the compiler used for C sources (-t c). Defaults to the "
+      "compiler set in the Ripes settings, or a compiler found in PATH.",
+      "path"));
+  parser.addOption(QCommandLineOption(
+      "cccache",
+      "Directory in which compiled C sources are cached. Compiling a source "
+      "which was previously compiled with the same compiler, compiler "
+      "arguments and processor ISA loads the cached executable instead.",
+      "path"));
+  parser.addOption(QCommandLineOption(
+      "cccachesize",
+      "Size limit of the executables in --cccache, in MiB (default: 256). The "
+      "least recently used executables are removed beyond the limit.",
+      "MiB", "256"));
+  parser.addOption(QCommandLineOption(
+      "batch",
+      "Runs each job of a manifest file, and writes a single JSON report of "
+      "all jobs. The manifest is a JSON array of objects, or a CSV file with "
+      "a header row, with the fields source, processor and optionally type, "
+      "extensions, regInit, timeout and stdin. --src, --proc, --isaexts and "
+      "--reginit are given per job.",
+      "path"));
+  parser.addOption(QCommandLineOption(
+      "batchjobs",
+      "Number of worker processes running the jobs of --batch (default 1).",
+      "n", "1"));
+  // Used by the workers of --batchjobs, to run a share of the jobs.
+  QCommandLineOption batchShardOption(
+      "batchshard", "Runs every <n>th job starting from job <i> of --batch.",
+      "i,n");
+  batchShardOption.setFlags(QCommandLineOption::HiddenFromHelp);
+  parser.addOption(batchShardOption);
+  parser.addOption(QCommandLineOption(
+      "server",
+      "Keeps Ripes running, and runs a job for each JSON request read from "
+      "stdin, one request per line, writing a JSON response line to stdout "
+      "per job. Requests specify the fields of a --batch job, or the program "
+      "and its console input inline, and optionally the reported telemetry."));
+  parser.addOption(QCommandLineOption(
+      "benchmark",
+      "Runs a bundled workload on every processor model, and reports the "
+      "simulation speed of each model as a table (or as JSON with --json)."));
+  parser.addOption(QCommandLineOption(
+      "regrade",
+      "Regrades the assembly submissions within a directory against the task "
+      "catalogue, and writes a gradebook (CSV if --output ends with .csv, "
+      "JSON otherwise). Submissions are named <section>.<number>.s, within a "
+      "subdirectory per student. Tasks without a processor are graded on "
+      "--proc.",
+      "path"));
+  parser.addOption(QCommandLineOption(
+      "dse",
+      "Runs the workloads of a design space specification on every "
+      "combination of its processor models, ISA extensions, branch "
+      "predictors, L1 cache geometries and memory latencies, and reports the "
+      "cycles and hardware cost of each design as a table (or as JSON with "
+      "--json), marking the Pareto front of cycles versus cost.",
+      "path"));
+  parser.addOption(QCommandLineOption(
+      "compare",
+      "Runs the assembly program of --src and this assembly program side by "
+      "side on the same console input, and reports the differences of their "
+      "performance counters, cycles per symbol and L1 cache misses as JSON.",
+      "path"));
+  parser.addOption(QCommandLineOption(
+      "compareproc",
+      "Processor of the compared variant (see --compare), if differing from "
+      "--proc. Without --compare, the program of --src is compared on both "
+      "processors.",
+      "proc"));
+  parser.addOption(QCommandLineOption(
+      "compareexts",
+      "ISA extensions of the compared variant (see --compare), if differing "
+      "from --isaexts (comma separated).",
+      "extensions"));
   parser.addOption(QCommandLineOption("v", "Verbose output"));
   parser.addOption(QCommandLineOption(
       "output", "Report output file. If not set, report is printed to stdout.",
       "path"));
   parser.addOption(QCommandLineOption("json", "JSON-formatted report."));
+  parser.addOption(QCommandLineOption(
+      "jsonformat",
+      "Format of the JSON report: indented JSON (indented), JSON without "
+      "whitespace (compact) or CBOR (cbor). Implies --json.",
+      "indented|compact|cbor", "indented"));
 
   parser.addOption(QCommandLineOption("all", "Enable all report options."));
 
@@ -54,8 +865,33 @@ void addCLIOptions(QCommandLineParser &parser, Ripes::CLIModeOptions &options) {
   options.telemetry.push_back(std::make_shared<InstrsRetiredTelemetry>());
   options.telemetry.push_back(std::make_shared<CPITelemetry>());
   options.telemetry.push_back(std::make_shared<IPCTelemetry>());
+  options.telemetry.push_back(std::make_shared<EnergyTelemetry>());
+  options.telemetry.push_back(std::make_shared<DecodeCacheTelemetry>());
+  options.telemetry.push_back(std::make_shared<SimSpeedTelemetry>());
+  options.telemetry.push_back(std::make_shared<SimProfileTelemetry>());
+  options.telemetry.push_back(std::make_shared<MemoryFootprintTelemetry>());
+  options.telemetry.push_back(std::make_shared<SamplingTelemetry>());
+  options.telemetry.push_back(std::make_shared<CacheSweepTelemetry>());
+  options.telemetry.push_back(std::make_shared<ReuseTelemetry>());
+  options.telemetry.push_back(std::make_shared<TraceReplayTelemetry>());
+  options.telemetry.push_back(std::make_shared<CacheHierarchyTelemetry>());
+  options.telemetry.push_back(std::make_shared<CacheMissTelemetry>());
+  options.telemetry.push_back(std::make_shared<RooflineTelemetry>());
+  options.telemetry.push_back(std::make_shared<TLBTelemetry>());
+  options.telemetry.push_back(std::make_shared<StallTelemetry>());
+  options.telemetry.push_back(std::make_shared<FlushTelemetry>());
+  options.telemetry.push_back(std::make_shared<HazardTelemetry>());
+  options.telemetry.push_back(std::make_shared<ForwardingTelemetry>());
+  options.telemetry.push_back(std::make_shared<BranchTelemetry>());
+  options.telemetry.push_back(std::make_shared<FrontEndTelemetry>());
+  options.telemetry.push_back(std::make_shared<DualIssueTelemetry>());
+  options.telemetry.push_back(std::make_shared<CustomInstructionTelemetry>());
+  options.telemetry.push_back(std::make_shared<CoherenceTelemetry>());
   options.telemetry.push_back(std::make_shared<PipelineTelemetry>());
+  options.telemetry.push_back(std::make_shared<ProfileTelemetry>());
   options.telemetry.push_back(std::make_shared<RegisterTelemetry>());
+  options.telemetry.push_back(std::make_shared<SyscallTelemetry>());
+  options.telemetry.push_back(std::make_shared<TerminationTelemetry>());
   options.telemetry.push_back(std::make_shared<RunInfoTelemetry>(&parser));
 
   for (auto &telemetry : options.telemetry) {
@@ -68,65 +904,191 @@ void addCLIOptions(QCommandLineParser &parser, Ripes::CLIModeOptions &options) {
 bool parseCLIOptions(QCommandLineParser &parser, QString &errorMessage,
                      CLIModeOptions &options) {
   options.verbose = parser.isSet("v");
+  options.recordTrace = parser.value("recordtrace");
+  options.replayTrace = parser.value("replaytrace");
+  options.recordInputs = parser.value("recordinputs");
+  options.replayInputs = parser.value("replayinputs");
+  options.saveSnapshot = parser.value("savesnapshot");
+  options.loadSnapshot = parser.value("loadsnapshot");
+  for (const auto &spec : parser.values("memorybudget")) {
+    if (!parseMemoryBudget(spec, options.memoryBudgets)) {
+      errorMessage = "Invalid memory budget '" + spec +
+                     "' specified (--memorybudget). Format: "
+                     "[<component>=]<MiB>.";
+      return false;
+    }
+  }
+  options.assemblerCache = parser.value("asmcache");
+  options.compiler = parser.value("cc");
+  options.compileCache = parser.value("cccache");
+  bool compileCacheSizeOk;
+  const unsigned compileCacheSize =
+      parser.value("cccachesize").toUInt(&compileCacheSizeOk);
+  if (!compileCacheSizeOk || compileCacheSize == 0) {
+    errorMessage = "Invalid compilation cache size '" +
+                   parser.value("cccachesize") + "' specified (--cccachesize).";
+    return false;
+  }
+  options.compileCacheSize = qint64(compileCacheSize) * 1024 * 1024;
+  options.stdinFile = parser.value("stdin");
+  options.ioConfig = parser.value("io");
+
+  if (parser.isSet("batch")) {
+    options.batch.manifest = parser.value("batch");
+    bool ok;
+    options.batch.workers = parser.value("batchjobs").toUInt(&ok);
+    if (!ok || options.batch.workers == 0) {
+      errorMessage = "Invalid number of batch workers '" +
+                     parser.value("batchjobs") + "' specified (--batchjobs).";
+      return false;
+    }
+    if (parser.isSet("batchshard")) {
+      const QStringList values = parser.value("batchshard").split(",");
+      bool shardOk = false, shardsOk = false;
+      if (values.size() == 2) {
+        options.batch.shard = values.at(0).toUInt(&shardOk);
+        options.batch.shards = values.at(1).toUInt(&shardsOk);
+      }
+      if (!shardOk || !shardsOk ||
+          options.batch.shard >= options.batch.shards) {
+        errorMessage = "Invalid batch shard '" + parser.value("batchshard") +
+                       "' specified (--batchshard).";
+        return false;
+      }
+    }
+  }
+
+  options.server = parser.isSet("server");
+  if (options.server && options.batch.enabled()) {
+    errorMessage = "--server cannot be used together with --batch.";
+    return false;
+  }
+
+  options.benchmark = parser.isSet("benchmark");
+  if (options.benchmark && (options.server || options.batch.enabled())) {
+    errorMessage = "--benchmark cannot be used together with --batch or "
+                   "--server.";
+    return false;
+  }
+
+  options.regrade = parser.value("regrade");
+  if (!options.regrade.isEmpty() &&
+      (options.server || options.batch.enabled() || options.benchmark ||
+       parser.isSet("src") || !options.replayTrace.isEmpty())) {
+    errorMessage = "--regrade cannot be used together with --batch, --server, "
+                   "--benchmark, --src or --replaytrace.";
+    return false;
+  }
+
+  options.dse = parser.value("dse");
+  if (!options.dse.isEmpty() &&
+      (options.server || options.batch.enabled() || options.benchmark ||
+       !options.regrade.isEmpty())) {
+    errorMessage = "--dse cannot be used together with --batch, --server, "
+                   "--benchmark or --regrade.";
+    return false;
+  }
 
-  if (!parser.isSet("src")) {
+  // A batch manifest or the requests of the server specify the source program
+  // and processor of each job, the benchmark runs its own workload, and a
+  // design space specification lists its workloads and processors.
+  const bool perJob = options.batch.enabled() || options.server ||
+                      options.benchmark || !options.dse.isEmpty();
+  if (perJob) {
+    if (parser.isSet("src") || parser.isSet("proc") ||
+        parser.isSet("isaexts") || parser.isSet("reginit") ||
+        !options.replayTrace.isEmpty()) {
+      errorMessage = "--src, --proc, --isaexts, --reginit and --replaytrace "
+                     "cannot be used together with --batch, --server, "
+                     "--benchmark or --dse.";
+      return false;
+    }
+    if (options.stdinFile == "-") {
+      // The standard input would be consumed by the first job, or is reserved
+      // for the requests of the server.
+      errorMessage = "--stdin - cannot be used together with --batch, "
+                     "--server, --benchmark or --dse.";
+      return false;
+    }
+    options.jsonOutput = !options.benchmark && options.dse.isEmpty();
+  }
+
+  // A replayed trace replaces the source program.
+  // The submissions of a regrade are the source programs.
+  const bool sourceless = perJob || !options.regrade.isEmpty();
+  if (!parser.isSet("src") && options.replayTrace.isEmpty() && !sourceless) {
     errorMessage = "No source file specified (--src)";
     return false;
   }
   options.src = parser.value("src");
 
-  if (!parser.isSet("t")) {
+  if (!parser.isSet("t") && options.replayTrace.isEmpty() && !sourceless) {
     errorMessage = "No source type specified (--t)";
     return false;
   }
 
-  if (parser.value("t") == "c") {
-    options.srcType = SourceType::C;
-  } else if (parser.value("t") == "asm") {
-    options.srcType = SourceType::Assembly;
-  } else if (parser.value("t") == "bin") {
-    options.srcType = SourceType::FlatBinary;
-  } else if (parser.value("t") == "elf") {
-    options.srcType = SourceType::ExternalELF;
-  } else {
+  if (!parseSourceType(parser.value("t"), options.srcType)) {
     errorMessage = "Invalid source type (--t)";
     return false;
   }
 
-  if (!parser.isSet("proc")) {
+  if (!parser.isSet("proc") && !perJob) {
     errorMessage = "No processor specified (-proc).";
     return false;
   }
-  bool ok;
-  int procID = QMetaEnum::fromType<ProcessorID>().keyToValue(
-      parser.value("proc").toStdString().c_str(), &ok);
-  if (!ok) {
-    errorMessage = "Invalid processor model specified '" +
-                   parser.value("proc") + "' (--proc).";
+  if (parser.isSet("proc") &&
+      !parseProcessorID(parser.value("proc"), options.proc, errorMessage))
     return false;
-  }
-  options.proc = static_cast<ProcessorID>(procID);
 
-  options.jsonOutput = parser.isSet("json");
+  options.jsonOutput |= parser.isSet("json") || parser.isSet("jsonformat");
+  const auto jsonFormat =
+      ReportWriter::parseFormat(parser.value("jsonformat"));
+  if (!jsonFormat) {
+    errorMessage = "Invalid JSON format '" + parser.value("jsonformat") +
+                   "' specified (--jsonformat). Format: indented, compact or "
+                   "cbor.";
+    return false;
+  }
+  options.jsonFormat = *jsonFormat;
 
   if (parser.isSet("isaexts")) {
     options.isaExtensions = parser.value("isaexts").split(",");
+    if (!validateISAExtensions(options.proc, options.isaExtensions,
+                               errorMessage))
+      return false;
+  }
 
-    // Validate the ISA extensions with respect to the selected processor.
-    auto exts = ProcessorRegistry::getDescription(options.proc)
-                    .isaInfo()
-                    .supportedExtensions;
-
-    for (auto &ext : std::as_const(options.isaExtensions)) {
-      if (!exts.contains(ext)) {
-        errorMessage =
-            "Invalid ISA extension '" + ext + "' specified (--isaexts).";
-        errorMessage +=
-            " Processor '" + enumToString<ProcessorID>(options.proc) + "'";
-        errorMessage += " supports extensions: " + exts.join(", ");
+  if (parser.isSet("compare") || parser.isSet("compareproc") ||
+      parser.isSet("compareexts")) {
+    if (perJob || !options.regrade.isEmpty() ||
+        !options.replayTrace.isEmpty()) {
+      errorMessage = "--compare cannot be used together with --batch, "
+                     "--server, --benchmark, --regrade, --dse or "
+                     "--replaytrace.";
+      return false;
+    }
+    if (options.srcType != SourceType::Assembly) {
+      errorMessage = "--compare requires an assembly source (-t asm).";
+      return false;
+    }
+    auto &compare = options.compare;
+    compare.src = parser.value("compare");
+    if (parser.isSet("compareproc")) {
+      ProcessorID proc;
+      if (!parseProcessorID(parser.value("compareproc"), proc, errorMessage))
         return false;
-      }
+      compare.proc = proc;
+    }
+    if (parser.isSet("compareexts")) {
+      const QString exts = parser.value("compareexts");
+      compare.isaExtensions =
+          exts.isEmpty() ? QStringList() : exts.split(",");
     }
+    if (!validateISAExtensions(
+            compare.proc.value_or(options.proc),
+            compare.isaExtensions.value_or(options.isaExtensions),
+            errorMessage))
+      return false;
   }
 
   if (parser.isSet("timeout")) {
@@ -138,88 +1100,666 @@ bool parseCLIOptions(QCommandLineParser &parser, QString &errorMessage,
     }
   }
 
+  for (const auto &[name, bound] :
+       {std::make_pair("maxcycles", &options.maxCycles),
+        std::make_pair("maxinstrs", &options.maxInstructions)}) {
+    bool ok;
+    *bound = parser.value(name).toLongLong(&ok);
+    if (!ok || *bound < 0) {
+      errorMessage = "Invalid bound '" + parser.value(name) +
+                     "' specified (--" + name + ").";
+      return false;
+    }
+  }
+
+  for (const auto &watch : parser.values("watch")) {
+    QStringList parts = watch.split(":");
+    const QStringList range = parts.at(0).split("-");
+    Watchpoints::MemoryWatchpoint watchpoint;
+    bool firstOk, lastOk = true;
+    watchpoint.first = range.at(0).toULongLong(&firstOk, 0);
+    watchpoint.last = range.size() == 2 ? range.at(1).toULongLong(&lastOk, 0)
+                                        : watchpoint.first;
+    const QString access = parts.size() == 2 ? parts.at(1) : "rw";
+    watchpoint.access = access == "r"    ? Watchpoints::Read
+                        : access == "w"  ? Watchpoints::Write
+                        : access == "rw" ? Watchpoints::ReadWrite
+                                         : 0;
+    if (parts.size() > 2 || range.size() > 2 || !firstOk || !lastOk ||
+        watchpoint.last < watchpoint.first || watchpoint.access == 0) {
+      errorMessage = "Invalid watchpoint '" + watch +
+                     "' specified (--watch). Format: first[-last][:r|w|rw].";
+      return false;
+    }
+    options.memoryWatchpoints.push_back(watchpoint);
+  }
+  options.registerWatchpoints = parser.values("watchreg");
+
   options.outputFile = parser.value("output");
+  options.cosimulate = parser.isSet("cosim");
+  options.nativeClocking = parser.isSet("native");
 
-  // Validate register initializations
-  if (parser.isSet("reginit")) {
-    const auto &procisa =
-        ProcessorRegistry::getAvailableProcessors().at(options.proc)->isaInfo();
-    const auto *isa = procisa.isa.get();
-    for (const auto &regFileInit : parser.values("reginit")) {
-      if (!regFileInit.contains(':')) {
-        errorMessage = "Cannot find register file type (--reginit).";
-        return false;
-      }
-      auto regFileSplit = regFileInit.indexOf(':');
-      QString regFile = regFileInit.mid(0, regFileSplit);
-
-      QStringList regInitList = regFileInit.mid(regFileSplit + 1).split(",");
-      for (auto &regInit : regInitList) {
-        QStringList regInitParts = regInit.split("=");
-        if (regInitParts.size() != 2) {
-          errorMessage = "Invalid register initialization '" + regInit +
-                         "' specified (--reginit).";
-          return false;
-        }
-        bool ok;
-        int regIdx = regInitParts[0].toInt(&ok);
-        if (!ok) {
-          errorMessage = "Invalid register index '" + regInitParts[0] +
-                         "' specified (--reginit).";
-          return false;
-        }
+  const bool pipelineTraceOption =
+      parser.isSet("pipelinewindow") || parser.isSet("pipelinebreak") ||
+      parser.isSet("pipelinecontext") || parser.isSet("pipelineformat");
+  if (pipelineTraceOption && !parser.isSet("pipelinetrace")) {
+    errorMessage = "--pipelinewindow, --pipelinebreak, --pipelinecontext and "
+                   "--pipelineformat require --pipelinetrace.";
+    return false;
+  }
+  if (parser.isSet("pipelinetrace")) {
+    auto &trace = options.pipelineTrace;
+    trace.path = parser.value("pipelinetrace");
+    const QString format =
+        parser.isSet("pipelineformat")
+            ? parser.value("pipelineformat")
+            : (trace.path.endsWith(".json", Qt::CaseInsensitive) ? "chrome"
+                                                                 : "tsv");
+    if (format == "chrome") {
+      trace.format = PipelineTraceOptions::Format::ChromeTrace;
+    } else if (format != "tsv") {
+      errorMessage = "Invalid pipeline trace format '" + format +
+                     "' specified (--pipelineformat). Options: tsv, chrome.";
+      return false;
+    }
+    if (parser.isSet("pipelinewindow")) {
+      const QStringList bounds = parser.value("pipelinewindow").split("-");
+      bool firstOk, lastOk = true;
+      trace.first = bounds.at(0).toLongLong(&firstOk);
+      if (bounds.size() == 2 && !bounds.at(1).isEmpty())
+        trace.last = bounds.at(1).toLongLong(&lastOk);
+      if (bounds.size() > 2 || !firstOk || !lastOk || trace.first < 0 ||
+          trace.last < trace.first) {
+        errorMessage = "Invalid pipeline window '" +
+                       parser.value("pipelinewindow") +
+                       "' specified (--pipelinewindow). Format: first-last.";
+        return false;
+      }
+    }
+    for (const auto &address : parser.values("pipelinebreak")) {
+      bool ok;
+      trace.breakpoints.insert(address.toULongLong(&ok, 0));
+      if (!ok) {
+        errorMessage = "Invalid breakpoint address '" + address +
+                       "' specified (--pipelinebreak).";
+        return false;
+      }
+    }
+    bool ok;
+    trace.context = parser.value("pipelinecontext").toUInt(&ok);
+    if (!ok) {
+      errorMessage = "Invalid number of context cycles '" +
+                     parser.value("pipelinecontext") +
+                     "' specified (--pipelinecontext).";
+      return false;
+    }
+  }
 
-        auto &vstr = regInitParts[1];
-        VInt regVal = decodeRadixValue(vstr, &ok);
+  if (parser.isSet("commitlogformat") && !parser.isSet("commitlog")) {
+    errorMessage = "--commitlogformat requires --commitlog.";
+    return false;
+  }
+  if (parser.isSet("commitlog")) {
+    options.commitLog = parser.value("commitlog");
+    const QString format =
+        parser.isSet("commitlogformat")
+            ? parser.value("commitlogformat")
+            : (options.commitLog.endsWith(".log", Qt::CaseInsensitive)
+                   ? "spike"
+                   : "bin");
+    if (format == "spike") {
+      options.commitLogFormat = CommitLog::Format::Spike;
+    } else if (format != "bin") {
+      errorMessage = "Invalid commit log format '" + format +
+                     "' specified (--commitlogformat). Options: bin, spike.";
+      return false;
+    }
+  }
 
-        if (!ok) {
-          errorMessage =
-              "Invalid register value '" + vstr + "' specified (--reginit).";
-          return false;
-        }
+  if (parser.isSet("stream")) {
+    options.stream.path = parser.value("stream");
+    QString interval = parser.value("streaminterval");
+    options.stream.cycles = interval.endsWith("c");
+    if (options.stream.cycles)
+      interval.chop(1);
+    else if (interval.endsWith("ms"))
+      interval.chop(2);
+    bool ok;
+    options.stream.interval = interval.toUInt(&ok);
+    if (!ok || options.stream.interval == 0) {
+      errorMessage = "Invalid stream interval '" +
+                     parser.value("streaminterval") +
+                     "' specified (--streaminterval). Format: <n>c or <n>ms.";
+      return false;
+    }
+  }
 
-        std::string_view rfid = "";
-        auto fileNames = isa->regFileNames();
-        for (const auto &regFileName : fileNames) {
-          if (regFile == QString(regFileName.data())) {
-            rfid = regFileName;
-            break;
-          }
-        }
-        if (rfid.empty()) {
-          errorMessage = "Invalid register file type '" + regFile +
-                         "' specified (--reginit). Valid types for '" +
-                         parser.value("proc") + "' with extensions [";
-          std::stringstream extInfo;
-          std::string isaExtensions =
-              options.isaExtensions.join("").toStdString();
-          llvm::interleaveComma(isaExtensions, extInfo);
-          extInfo << "]: [";
-          llvm::interleaveComma(fileNames, extInfo);
-          extInfo << "]";
-          errorMessage += extInfo.str().c_str();
-          return false;
-        }
+  options.profile.folded = parser.value("profilefolded");
+  options.profile.blocks = parser.value("profileblocks");
+  bool profileTopOk;
+  options.profile.top = parser.value("profiletop").toUInt(&profileTopOk);
+  if (!profileTopOk) {
+    errorMessage = "Invalid number of reported hotspots '" +
+                   parser.value("profiletop") + "' specified (--profiletop).";
+    return false;
+  }
 
-        if (options.regInit.count(rfid) == 0) {
-          options.regInit[rfid] = {{regIdx, regVal}};
-        } else {
-          if (options.regInit.at(rfid).count(regIdx) > 0) {
-            errorMessage = "Duplicate register initialization for register " +
-                           QString::number(regIdx) + " specified (--reginit).";
-            return false;
-          }
+  bool reuseBlocksOk, reuseWindowOk;
+  options.reuse.blocks = parser.value("reuseblocks").toUInt(&reuseBlocksOk);
+  options.reuse.window = parser.value("reusewindow").toUInt(&reuseWindowOk);
+  if (!reuseBlocksOk || options.reuse.blocks > 16) {
+    errorMessage = "Invalid block size '" + parser.value("reuseblocks") +
+                   "' specified (--reuseblocks). Must be in [0, 16].";
+    return false;
+  }
+  if (!reuseWindowOk || options.reuse.window == 0) {
+    errorMessage = "Invalid working-set window '" +
+                   parser.value("reusewindow") +
+                   "' specified (--reusewindow).";
+    return false;
+  }
 
-          options.regInit[rfid][regIdx] = regVal;
-        }
+  for (const auto &spec : parser.values("dump")) {
+    const auto region = MemoryDump::parseRegion(spec);
+    if (!region) {
+      errorMessage = "Invalid memory region '" + spec +
+                     "' specified (--dump). Format: <address|symbol>:<bytes>.";
+      return false;
+    }
+    options.dump.regions.push_back(*region);
+  }
+  for (const auto &spec : parser.values("preload")) {
+    // Paths may contain '@', whereas addresses and symbols do not.
+    const qsizetype at = spec.lastIndexOf('@');
+    const QStringList parts = spec.mid(at + 1).split(":");
+    const QStringList registers =
+        parts.size() == 2 ? parts.at(1).split(",") : QStringList();
+    PreloadOptions preload;
+    preload.path = spec.left(at);
+    preload.start = parts.at(0);
+    preload.pointerRegister = registers.value(0);
+    preload.lengthRegister = registers.value(1);
+    if (at <= 0 || parts.size() > 2 || registers.size() > 2 ||
+        preload.start.isEmpty() ||
+        (parts.size() == 2 && preload.pointerRegister.isEmpty())) {
+      errorMessage = "Invalid preload '" + spec +
+                     "' specified (--preload). Format: "
+                     "<path>@<address|symbol>[:<reg>[,<reg>]].";
+      return false;
+    }
+    options.preloads.push_back(preload);
+  }
+
+  const auto dumpFormat = MemoryDump::parseFormat(parser.value("dumpformat"));
+  if (!dumpFormat) {
+    errorMessage = "Invalid dump format '" + parser.value("dumpformat") +
+                   "' specified (--dumpformat). Format: hex, json or bin.";
+    return false;
+  }
+  options.dump.format = *dumpFormat;
+  options.dump.path = parser.value("dumpfile");
+  if (options.dump.format == MemoryDump::Format::Binary &&
+      options.dump.path.isEmpty() && options.dump.enabled()) {
+    errorMessage = "--dumpformat bin requires --dumpfile.";
+    return false;
+  }
+
+  if (parser.isSet("sample")) {
+    const QStringList values = parser.value("sample").split(",");
+    bool ok = values.size() == 3;
+    std::vector<unsigned> counts;
+    for (const auto &value : values) {
+      bool valueOk;
+      counts.push_back(value.toUInt(&valueOk));
+      ok &= valueOk;
+    }
+    if (!ok || counts.at(2) == 0) {
+      errorMessage = "Invalid sampling parameters '" + parser.value("sample") +
+                     "' specified (--sample). Format: ff,warmup,window with "
+                     "window > 0.";
+      return false;
+    }
+    options.sampling = {counts.at(0), counts.at(1), counts.at(2)};
+  }
+
+  if (options.cosimulate && options.sampling.enabled()) {
+    errorMessage = "--cosim and --sample cannot be used together.";
+    return false;
+  }
+
+  if (parser.isSet("cachesweep")) {
+    // Maximum log2 values of each range, bounding the memory used by the
+    // stack distance analysis.
+    const std::vector<int> limits = {8, 16, 5};
+    const QStringList values = parser.value("cachesweep").split(",");
+    bool ok = values.size() == 3;
+    std::vector<CacheSweep::Range> ranges;
+    for (int i = 0; ok && i < values.size(); ++i) {
+      const QStringList bounds = values.at(i).split("-");
+      bool minOk, maxOk = true;
+      CacheSweep::Range range;
+      range.min = bounds.at(0).toInt(&minOk);
+      range.max = bounds.size() == 2 ? bounds.at(1).toInt(&maxOk) : range.min;
+      ok &= minOk && maxOk && bounds.size() <= 2 && range.min >= 0 &&
+            range.min <= range.max && range.max <= limits.at(i);
+      ranges.push_back(range);
+    }
+    if (!ok) {
+      errorMessage = "Invalid cache sweep ranges '" +
+                     parser.value("cachesweep") +
+                     "' specified (--cachesweep). Format: blocks,lines,ways "
+                     "where each range is <min>-<max> in log2, with at most " +
+                     QString::number(limits.at(0)) + ", " +
+                     QString::number(limits.at(1)) + " and " +
+                     QString::number(limits.at(2)) + " respectively.";
+      return false;
+    }
+    options.cacheSweep = {ranges.at(0), ranges.at(1), ranges.at(2), true};
+    if (options.cosimulate || options.sampling.enabled()) {
+      errorMessage =
+          "--cachesweep cannot be used together with --cosim or --sample.";
+      return false;
+    }
+  }
+
+  if (parser.isSet("caches")) {
+    const QStringList specs = parser.value("caches").split(",");
+    if (specs.size() < 2 || specs.size() > 3) {
+      errorMessage = "Invalid cache hierarchy '" + parser.value("caches") +
+                     "' specified (--caches). Format: l1i,l1d[,l2].";
+      return false;
+    }
+    std::vector<CachePreset> levels;
+    for (const auto &spec : specs) {
+      CachePreset preset;
+      if (!parseCacheConfig(spec, preset)) {
+        errorMessage = "Invalid cache configuration '" + spec +
+                       "' specified (--caches). Expected a cache preset name "
+                       "or <blocks>:<lines>:<ways>[:<policy>].";
+        return false;
+      }
+      levels.push_back(preset);
+    }
+    CacheHierarchyConfig config;
+    config.l1i = levels.at(0);
+    config.l1d = levels.at(1);
+    if (levels.size() == 3)
+      config.l2 = levels.at(2);
+
+    const QStringList latencies = parser.value("cachelatency").split(",");
+    bool ok = latencies.size() == 3;
+    std::vector<unsigned> values;
+    for (const auto &latency : latencies) {
+      bool valueOk;
+      values.push_back(latency.toUInt(&valueOk));
+      ok &= valueOk;
+    }
+    if (!ok) {
+      errorMessage = "Invalid cache latencies '" +
+                     parser.value("cachelatency") +
+                     "' specified (--cachelatency). Format: l1,l2,mem.";
+      return false;
+    }
+    config.l1Latency = values.at(0);
+    config.l2Latency = values.at(1);
+    config.memoryLatency = values.at(2);
+    config.stall = parser.isSet("cachestall");
+    if (parser.isSet("storebuffer") &&
+        !parseStoreBuffer(parser.value("storebuffer"), config.storeBuffer)) {
+      errorMessage = "Invalid store buffer '" + parser.value("storebuffer") +
+                     "' specified (--storebuffer). Format: "
+                     "<entries>[,combine].";
+      return false;
+    }
+
+    if (parser.isSet("dram")) {
+      DRAMConfig dram;
+      if (!parseDRAMConfig(parser.value("dram"), dram)) {
+        errorMessage = "Invalid DRAM '" + parser.value("dram") +
+                       "' specified (--dram). Format: "
+                       "<banks>:<rowbytes>[:<open|closed>], in powers of two.";
+        return false;
+      }
+      const QStringList timings = parser.value("dramtiming").split(",");
+      bool timingsOk = timings.size() == 3;
+      std::vector<unsigned> cycles;
+      for (const auto &timing : timings) {
+        bool valueOk;
+        cycles.push_back(timing.toUInt(&valueOk));
+        timingsOk &= valueOk;
+      }
+      if (!timingsOk) {
+        errorMessage = "Invalid DRAM timing '" + parser.value("dramtiming") +
+                       "' specified (--dramtiming). Format: trcd,tcas,trp.";
+        return false;
       }
+      dram.tRCD = cycles.at(0);
+      dram.tCAS = cycles.at(1);
+      dram.tRP = cycles.at(2);
+      config.dram = dram;
+    }
+
+    for (const auto &spec : parser.values("prefetch")) {
+      if (!parsePrefetchConfig(spec, config)) {
+        errorMessage = "Invalid prefetcher '" + spec +
+                       "' specified (--prefetch). Format: "
+                       "<l1i|l1d|l2>=<nextline|stride|stream>[:<degree>].";
+        return false;
+      }
+    }
+    for (const auto &spec : parser.values("victimcache")) {
+      if (!parseVictimCache(spec, config)) {
+        errorMessage = "Invalid victim cache '" + spec +
+                       "' specified (--victimcache). Format: "
+                       "<l1i|l1d>=<entries>, of 1 to 64 entries.";
+        return false;
+      }
+    }
+
+    if (parser.isSet("inclusion")) {
+      static const std::map<QString, InclusionPolicy> policies{
+          {"noninclusive", InclusionPolicy::NonInclusive},
+          {"inclusive", InclusionPolicy::Inclusive},
+          {"exclusive", InclusionPolicy::Exclusive}};
+      auto it = policies.find(parser.value("inclusion"));
+      if (it == policies.end() || !config.l2) {
+        errorMessage = "Invalid inclusion policy '" +
+                       parser.value("inclusion") +
+                       "' specified (--inclusion). Expected one of "
+                       "[noninclusive, inclusive, exclusive], with an L2 "
+                       "cache in --caches.";
+        return false;
+      }
+      config.l2Inclusion = it->second;
+      if (config.l2Inclusion == InclusionPolicy::Exclusive &&
+          config.l2Prefetch.type != PrefetcherType::None) {
+        errorMessage = "An exclusive L2 cache (--inclusion) cannot have a "
+                       "prefetcher (--prefetch).";
+        return false;
+      }
+    }
+    options.caches = config;
+    if (options.cosimulate || options.sampling.enabled()) {
+      errorMessage =
+          "--caches cannot be used together with --cosim or --sample.";
+      return false;
+    }
+  }
+
+  if (parser.isSet("mmu")) {
+    MMUOptions mmu;
+    const QString mode = parser.value("mmu");
+    const unsigned xlen =
+        ProcessorRegistry::getDescription(options.proc).isaInfo().isa->bits();
+    if (mode == "sv32" && xlen == 32) {
+      mmu.config.mode = PagingMode::Sv32;
+    } else if (mode == "sv39" && xlen == 64) {
+      mmu.config.mode = PagingMode::Sv39;
+    } else {
+      errorMessage = "Invalid paging mode '" + mode +
+                     "' specified (--mmu). Expected sv32 for RV32 processors "
+                     "and sv39 for RV64 processors.";
+      return false;
+    }
+
+    const std::map<QString, unsigned> pageLevels =
+        mmu.config.mode == PagingMode::Sv32
+            ? std::map<QString, unsigned>{{"4k", 0}, {"4m", 1}}
+            : std::map<QString, unsigned>{{"4k", 0}, {"2m", 1}, {"1g", 2}};
+    auto pageLevel = pageLevels.find(parser.value("pagesize").toLower());
+    if (pageLevel == pageLevels.end()) {
+      errorMessage = "Invalid page size '" + parser.value("pagesize") +
+                     "' specified (--pagesize) for " + mode + ".";
+      return false;
+    }
+    mmu.config.pageLevel = pageLevel->second;
+    mmu.pageTable = parser.value("pagetable");
+
+    const QStringList tlbs = parser.value("tlbs").split(",");
+    if (tlbs.size() != 2 || !parseTLBConfig(tlbs.at(0), mmu.config.itlb) ||
+        !parseTLBConfig(tlbs.at(1), mmu.config.dtlb)) {
+      errorMessage = "Invalid TLBs '" + parser.value("tlbs") +
+                     "' specified (--tlbs). Format: "
+                     "<sets>:<ways>[:<policy>],<sets>:<ways>[:<policy>], of at "
+                     "most 2^12 entries each.";
+      return false;
+    }
+    bool latencyOk;
+    mmu.config.walkLatency = parser.value("walklatency").toUInt(&latencyOk);
+    if (!latencyOk) {
+      errorMessage = "Invalid page walk latency '" +
+                     parser.value("walklatency") +
+                     "' specified (--walklatency).";
+      return false;
+    }
+    options.mmu = mmu;
+    if (options.cosimulate || options.sampling.enabled()) {
+      errorMessage = "--mmu cannot be used together with --cosim or --sample.";
+      return false;
+    }
+  }
+
+  if (parser.isSet("fulatency")) {
+    FunctionalUnitTiming timing;
+    if (!parseFunctionalUnitTiming(parser.value("fulatency"), timing)) {
+      errorMessage = "Invalid functional unit timing '" +
+                     parser.value("fulatency") +
+                     "' specified (--fulatency). Format: "
+                     "mul=<latency>[/<interval>],div=<latency>[/<interval>].";
+      return false;
+    }
+    options.functionalUnits = timing;
+  }
+
+  if (parser.isSet("energymodel") &&
+      !parseEnergyModel(parser.value("energymodel"), options.energyModel)) {
+    errorMessage = "Invalid energy model '" + parser.value("energymodel") +
+                   "' specified (--energymodel). Format: <name>=<pJ>,... "
+                   "with names of [alu, muldiv, fp, vector, load, store, "
+                   "control, system, reg, l1, l1miss, l2, l2miss, dram, "
+                   "static].";
+    return false;
+  }
+
+  if (parser.isSet("pairing")) {
+    WayPairingPolicy policy;
+    if (!parsePairingPolicy(parser.value("pairing"), policy)) {
+      errorMessage = "Invalid pairing policy '" + parser.value("pairing") +
+                     "' specified (--pairing). Expected full, or any of "
+                     "[memonly, branchalone].";
+      return false;
+    }
+    options.pairingPolicy = policy;
+  }
+
+  if (parser.isSet("targetpred")) {
+    TargetPredictionConfig config;
+    if (!parseTargetPrediction(parser.value("targetpred"), config)) {
+      errorMessage = "Invalid target predictors '" +
+                     parser.value("targetpred") +
+                     "' specified (--targetpred). Format: "
+                     "ras=<entries>,indirect=<entries>.";
+      return false;
     }
+    options.targetPrediction = config;
+  }
+
+  if (parser.isSet("fetchqueue")) {
+    FetchQueueConfig config;
+    if (!parseFetchQueue(parser.value("fetchqueue"), config)) {
+      errorMessage = "Invalid fetch queue '" + parser.value("fetchqueue") +
+                     "' specified (--fetchqueue). Format: "
+                     "entries=<entries>,line=<bytes>.";
+      return false;
+    }
+    options.fetchQueue = config;
+  }
+
+  if (parser.isSet("vlen")) {
+    bool ok;
+    const unsigned vlen = parser.value("vlen").toUInt(&ok);
+    if (!ok || !RVVectorUnit::validVLEN(vlen)) {
+      errorMessage = "Invalid vector length '" + parser.value("vlen") +
+                     "' specified (--vlen). Expected a power of two from 64 "
+                     "to 65536.";
+      return false;
+    }
+    options.vlen = vlen;
+  }
+
+  if ((parser.isSet("dram") || parser.isSet("dramtiming")) &&
+      !options.caches) {
+    errorMessage = "--dram and --dramtiming require --caches.";
+    return false;
+  }
+
+  if (parser.isSet("prefetch") && !options.caches) {
+    errorMessage = "--prefetch requires --caches.";
+    return false;
+  }
+
+  if ((parser.isSet("victimcache") || parser.isSet("inclusion")) &&
+      !options.caches) {
+    errorMessage = "--victimcache and --inclusion require --caches.";
+    return false;
   }
 
+  if (parser.isSet("cachestall") &&
+      (!options.caches || !options.replayTrace.isEmpty())) {
+    errorMessage = "--cachestall requires --caches, and cannot be used "
+                   "together with --replaytrace.";
+    return false;
+  }
+
+  if (parser.isSet("storebuffer") && !parser.isSet("cachestall")) {
+    errorMessage = "--storebuffer requires --cachestall.";
+    return false;
+  }
+
+  if (!options.replayTrace.isEmpty() &&
+      (options.cosimulate || options.sampling.enabled() ||
+       !options.recordTrace.isEmpty())) {
+    errorMessage = "--replaytrace cannot be used together with --cosim, "
+                   "--sample or --recordtrace.";
+    return false;
+  }
+  if (!options.recordTrace.isEmpty() &&
+      (options.cosimulate || options.sampling.enabled())) {
+    errorMessage =
+        "--recordtrace cannot be used together with --cosim or --sample.";
+    return false;
+  }
+  if (!options.commitLog.isEmpty() &&
+      (options.cosimulate || options.sampling.enabled() ||
+       !options.replayTrace.isEmpty())) {
+    errorMessage = "--commitlog cannot be used together with --cosim, "
+                   "--sample or --replaytrace.";
+    return false;
+  }
+  if (!options.recordInputs.isEmpty() || !options.replayInputs.isEmpty()) {
+    if (!options.recordInputs.isEmpty() && !options.replayInputs.isEmpty()) {
+      errorMessage =
+          "--recordinputs cannot be used together with --replayinputs.";
+      return false;
+    }
+    if (options.cosimulate || options.sampling.enabled() ||
+        options.cacheSweep.enabled || !options.replayTrace.isEmpty()) {
+      errorMessage = "--recordinputs and --replayinputs cannot be used "
+                     "together with --cosim, --sample, --cachesweep or "
+                     "--replaytrace.";
+      return false;
+    }
+  }
+  if ((!options.saveSnapshot.isEmpty() || !options.loadSnapshot.isEmpty()) &&
+      (options.cosimulate || options.sampling.enabled() ||
+       options.cacheSweep.enabled || !options.replayTrace.isEmpty())) {
+    errorMessage = "--savesnapshot and --loadsnapshot cannot be used together "
+                   "with --cosim, --sample, --cachesweep or --replaytrace.";
+    return false;
+  }
+
+  // Validate register initializations
+  if (parser.isSet("reginit") &&
+      !parseRegisterInitialization(parser.values("reginit"), options.proc,
+                                   options.isaExtensions, options.regInit,
+                                   errorMessage))
+    return false;
+
   // Enable selected telemetry options.
   for (auto &telemetry : options.telemetry)
     if (parser.isSet("all") || parser.isSet(telemetry->key()))
       telemetry->enable();
+  if (options.sampling.enabled()) {
+    for (auto &telemetry : options.telemetry)
+      if (telemetry->key() == SamplingTelemetry::s_key)
+        telemetry->enable();
+  }
+  if (options.cacheSweep.enabled) {
+    for (auto &telemetry : options.telemetry)
+      if (telemetry->key() == CacheSweepTelemetry::s_key)
+        telemetry->enable();
+  }
+  if (!options.replayTrace.isEmpty()) {
+    for (auto &telemetry : options.telemetry)
+      if (telemetry->key() == TraceReplayTelemetry::s_key)
+        telemetry->enable();
+  }
+  if (options.caches) {
+    for (auto &telemetry : options.telemetry)
+      if (telemetry->key() == CacheHierarchyTelemetry::s_key)
+        telemetry->enable();
+  }
+  if (options.mmu) {
+    for (auto &telemetry : options.telemetry)
+      if (telemetry->key() == TLBTelemetry::s_key)
+        telemetry->enable();
+  }
+  if (options.pipelineTrace.enabled()) {
+    for (auto &telemetry : options.telemetry)
+      if (telemetry->key() == PipelineTelemetry::s_key)
+        telemetry->enable();
+  }
+  if (options.maxCycles != 0 || options.maxInstructions != 0 ||
+      !options.memoryWatchpoints.empty() ||
+      !options.registerWatchpoints.isEmpty()) {
+    for (auto &telemetry : options.telemetry)
+      if (telemetry->key() == TerminationTelemetry::s_key)
+        telemetry->enable();
+  }
+  if (parser.isSet("energymodel")) {
+    for (auto &telemetry : options.telemetry)
+      if (telemetry->key() == EnergyTelemetry::s_key)
+        telemetry->enable();
+  }
+  if (!options.profile.folded.isEmpty() || !options.profile.blocks.isEmpty()) {
+    for (auto &telemetry : options.telemetry)
+      if (telemetry->key() == ProfileTelemetry::s_key)
+        telemetry->enable();
+  }
+
+  // Natively clocked processors do not record the state of individual cycles.
+  if (options.nativeClocking) {
+    bool perCycle = options.caches || options.mmu ||
+                    !options.recordTrace.isEmpty() ||
+                    !options.commitLog.isEmpty() ||
+                    options.cacheSweep.enabled || options.cosimulate ||
+                    options.sampling.enabled() || options.stream.enabled() ||
+                    options.maxInstructions != 0 ||
+                    !options.memoryWatchpoints.empty() ||
+                    !options.registerWatchpoints.isEmpty();
+    for (const auto &telemetry : options.telemetry)
+      perCycle |= telemetry->isEnabled() &&
+                  (telemetry->key() == PipelineTelemetry::s_key ||
+                   telemetry->key() == ProfileTelemetry::s_key ||
+                   telemetry->key() == ReuseTelemetry::s_key);
+    if (perCycle) {
+      errorMessage = "--native cannot be used together with --caches, "
+                     "--mmu, --recordtrace, --commitlog, --cachesweep, "
+                     "--cosim, --sample, --stream, --maxinstrs, --watch, "
+                     "--watchreg, --pipeline, --profile or --reuse.";
+      return false;
+    }
+  }
 
   return true;
 }
@@ -1,13 +1,127 @@
 #pragma once
 
 #include "assembler/program.h"
+#include "cachesim/cachehierarchy.h"
+#include "cachesim/cachesweep.h"
+#include "cachesim/mmu.h"
+#include "commitlog.h"
+#include "memorydump.h"
+#include "memoryfootprint.h"
 #include "processorregistry.h"
+#include "reportwriter.h"
 #include "telemetry.h"
+#include "watchpoints.h"
 #include <QCommandLineParser>
+#include <optional>
 #include <set>
 
 namespace Ripes {
 
+/// Options for sampled simulation (--sample). Sampling is disabled if window is
+/// 0. See Sampler for details.
+struct SamplingOptions {
+  unsigned fastForward = 0;
+  unsigned warmup = 0;
+  unsigned window = 0;
+  bool enabled() const { return window != 0; }
+};
+
+/// Options for sweeping cache configurations (--cachesweep). Ranges are log2
+/// values, as in CachePreset. See CacheSweep for details.
+struct CacheSweepOptions {
+  CacheSweep::Range blocks;
+  CacheSweep::Range lines;
+  CacheSweep::Range ways;
+  bool enabled = false;
+};
+
+/// Options for streaming periodic records of the progress of a run (--stream).
+/// See TelemetryStream for details.
+struct StreamOptions {
+  // Path of the record file, or "-" for stdout.
+  QString path;
+  // Interval between records, in cycles if 'cycles' is set, otherwise in
+  // milliseconds.
+  unsigned interval = 1000;
+  bool cycles = false;
+  bool enabled() const { return !path.isEmpty(); }
+};
+
+/// Options for profiling the run (--profile). See Profiler for details.
+struct ProfileOptions {
+  // Write the profile in the folded stack format to this file.
+  QString folded;
+  // Write the basic block profile to this file.
+  QString blocks;
+  // Number of source lines and instructions reported.
+  unsigned top = 20;
+};
+
+/// Options for the reuse-distance analysis of the run (--reuse). See
+/// ReuseAnalysis for details.
+struct ReuseOptions {
+  // Log2 number of words of a block.
+  unsigned blocks = 2;
+  // Cycles of a working-set window.
+  unsigned window = 1000;
+};
+
+/// Options for the virtual memory model of the run (--mmu). See MMU for
+/// details.
+struct MMUOptions {
+  MMUConfig config;
+  // Address or symbol of the root page table (--pagetable). If empty, an
+  // identity mapping is walked instead.
+  QString pageTable;
+};
+
+/// Options for running the jobs of a manifest in a single invocation (--batch).
+/// See BatchRunner for details.
+struct BatchOptions {
+  QString manifest;
+  // Number of worker processes running the jobs.
+  unsigned workers = 1;
+  // The share of the jobs run by this process: every 'shards'th job, starting
+  // from job 'shard'.
+  unsigned shard = 0;
+  unsigned shards = 1;
+  bool enabled() const { return !manifest.isEmpty(); }
+};
+
+/// Options for dumping regions of memory once the run finished (--dump). See
+/// MemoryDump for details.
+struct DumpOptions {
+  std::vector<MemoryDump::Region> regions;
+  MemoryDump::Format format = MemoryDump::Format::Hex;
+  // Path of the dump, or empty to write the dump after the report.
+  QString path;
+  bool enabled() const { return !regions.empty(); }
+};
+
+/// A file copied into memory ahead of the run (--preload).
+struct PreloadOptions {
+  QString path;
+  // Address or symbol of the program at which the file is loaded.
+  QString start;
+  // Registers initialized with the address and the size in bytes of the file,
+  // by name, if set.
+  QString pointerRegister;
+  QString lengthRegister;
+};
+
+/// Options for comparing the run against a variant of it (--compare,
+/// --compareproc, --compareexts). See Comparison for details.
+struct CompareOptions {
+  // Source program of the variant, or empty for the program of --src.
+  QString src;
+  // Processor and ISA extensions of the variant, if differing.
+  std::optional<ProcessorID> proc;
+  std::optional<QStringList> isaExtensions;
+  bool enabled() const {
+    return !src.isEmpty() || proc.has_value() || isaExtensions.has_value();
+  }
+};
+
 struct CLIModeOptions {
   QString src;
   SourceType srcType;
@@ -16,8 +130,118 @@ struct CLIModeOptions {
   bool verbose = false;
   QString outputFile = "";
   bool jsonOutput = false;
+  ReportWriter::Format jsonFormat = ReportWriter::Format::Indented;
   int timeout = 0;
+  // Bounds on the cycles and retired instructions of the run (--maxcycles,
+  // --maxinstrs). 0 is unbounded.
+  long long maxCycles = 0;
+  long long maxInstructions = 0;
+  // Stop the run once the watched memory is accessed (--watch) or the watched
+  // registers are written (--watchreg), by register name.
+  std::vector<Watchpoints::MemoryWatchpoint> memoryWatchpoints;
+  QStringList registerWatchpoints;
   RegisterInitialization regInit;
+  // Files loaded into memory after the program (--preload), in order, later
+  // files overwriting earlier ones and the program where overlapping.
+  std::vector<PreloadOptions> preloads;
+  SamplingOptions sampling;
+  CacheSweepOptions cacheSweep;
+  // Simulate a cache hierarchy during the run (--caches, --cachelatency).
+  std::optional<CacheHierarchyConfig> caches;
+  // Translate the memory accesses of the run through TLBs and page tables
+  // (--mmu, --pagetable, --pagesize, --tlbs, --walklatency).
+  std::optional<MMUOptions> mmu;
+  // Override the timing of the multiplier and divider of the processor
+  // (--fulatency).
+  std::optional<FunctionalUnitTiming> functionalUnits;
+  // Energy costs of the energy estimate (--energy, --energymodel).
+  EnergyModel energyModel;
+  // Restrict the instruction pairs of the dual-issue processors (--pairing).
+  std::optional<WayPairingPolicy> pairingPolicy;
+  // Size the target predictors of the processors with branch prediction
+  // (--targetpred).
+  std::optional<TargetPredictionConfig> targetPrediction;
+  // Size the fetch queue of the generated pipelines (--fetchqueue).
+  std::optional<FetchQueueConfig> fetchQueue;
+  // Length in bits of the vector registers of the processors implementing the
+  // V extension (--vlen).
+  std::optional<unsigned> vlen;
+  // Record the memory accesses of the run to this file (--recordtrace).
+  QString recordTrace;
+  // Replay the memory accesses of this file through the cache simulator
+  // instead of simulating a program (--replaytrace).
+  QString replayTrace;
+  // Record the nondeterministic inputs of the run to this file
+  // (--recordinputs).
+  QString recordInputs;
+  // Replay the nondeterministic inputs of this file (--replayinputs).
+  QString replayInputs;
+  // Save the state of the simulation to this file once the run stops
+  // (--savesnapshot).
+  QString saveSnapshot;
+  // Restore the state of the simulation from this file before the run
+  // (--loadsnapshot).
+  QString loadSnapshot;
+  // Budget in bytes of each component of MemoryFootprint, or 0 if unlimited
+  // (--memorybudget).
+  std::array<size_t, MemoryFootprint::NComponents> memoryBudgets{};
+  // Stream the pipeline state of the run to a file (--pipelinetrace).
+  PipelineTraceOptions pipelineTrace;
+  // Log the instructions retired by the run to this file (--commitlog,
+  // --commitlogformat).
+  QString commitLog;
+  CommitLog::Format commitLogFormat = CommitLog::Format::Binary;
+  // Stream periodic records of the progress of the run (--stream).
+  StreamOptions stream;
+  // Profile the cycles of the run per instruction (--profile).
+  ProfileOptions profile;
+  // Analyse the reuse distances of the memory accesses of the run (--reuse).
+  ReuseOptions reuse;
+  // Dump regions of memory once the run finished (--dump).
+  DumpOptions dump;
+  // Co-simulate the processor model against the reference model (--cosim).
+  bool cosimulate = false;
+  // Clock processors with native clocking in tight loops (--native).
+  bool nativeClocking = false;
+  // Serve the console input of the program from this file, or from the stdin
+  // of the process if "-" (--stdin).
+  QString stdinFile;
+  // Serve the console input of the program from this data instead (set for
+  // the jobs of --server with inline input).
+  std::optional<QByteArray> stdinData;
+  // Instantiate the peripherals of this JSON configuration for the run (--io,
+  // see IOConfig).
+  QString ioConfig;
+  // Persist assembled programs to this directory (--asmcache).
+  QString assemblerCache;
+  // Compiler used for C sources (--cc). Empty for the compiler of the Ripes
+  // settings.
+  QString compiler;
+  // Persist compiled C sources to this directory (--cccache).
+  QString compileCache;
+  // Size limit of the executables in the compileCache, in bytes
+  // (--cccachesize).
+  qint64 compileCacheSize = 256 * 1024 * 1024;
+  // Run the jobs of a manifest instead of a single program (--batch).
+  BatchOptions batch;
+  // Run jobs received on stdin instead of a single program (--server).
+  bool server = false;
+  // Run a bundled workload on every processor model (--benchmark).
+  bool benchmark = false;
+  // Regrade the submissions of this directory against the task catalogue
+  // (--regrade).
+  QString regrade;
+  // Explore the design space of this JSON specification (--dse).
+  QString dse;
+  // Compare the run against a variant of another program or processor
+  // (--compare, --compareproc, --compareexts).
+  CompareOptions compare;
+  // Collect the console output and errors of the program into the report
+  // instead of printing them (set for the jobs of --batch).
+  bool captureOutput = false;
+  // Reset the current processor instead of reconstructing it, if it is the
+  // requested processor (set for the jobs of --batch and --server).
+  bool reuseProcessor = false;
 
   // A list of enabled telemetry options.
   std::vector<std::shared_ptr<Telemetry>> telemetry;
@@ -31,4 +255,27 @@ void addCLIOptions(QCommandLineParser &parser, Ripes::CLIModeOptions &options);
 bool parseCLIOptions(QCommandLineParser &parser, QString &errorMessage,
                      CLIModeOptions &options);
 
+/// Parses a source type [c, asm, bin, elf]. Returns true if @p type is valid.
+bool parseSourceType(const QString &type, SourceType &srcType);
+
+/// Parses the name of a processor model.
+bool parseProcessorID(const QString &name, ProcessorID &proc,
+                      QString &errorMessage);
+
+/// Parses a cache configuration, given either as the name of a cache preset,
+/// or as <blocks>:<lines>:<ways>[:<policy>] in log2 values (a write-back,
+/// write-allocate cache, with LRU replacement unless specified).
+bool parseCacheConfig(const QString &spec, CachePreset &preset);
+
+/// Returns true if all of @p isaExtensions are supported by @p proc.
+bool validateISAExtensions(ProcessorID proc, const QStringList &isaExtensions,
+                           QString &errorMessage);
+
+/// Parses register initializations of the format
+/// <register file>:<register idx>=<value>,... into @p regInit.
+bool parseRegisterInitialization(const QStringList &specs, ProcessorID proc,
+                                 const QStringList &isaExtensions,
+                                 RegisterInitialization &regInit,
+                                 QString &errorMessage);
+
 } // namespace Ripes
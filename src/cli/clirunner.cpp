@@ -1,11 +1,33 @@
 #include "clirunner.h"
+#include "assembler/programcache.h"
+#include "binutils.h"
+#include "cachesim/accesstrace.h"
+#include "cachesim/l1cacheshim.h"
+#include "ccmanager.h"
+#include "commitlog.h"
+#include "inputlog.h"
+#include "cosimulator.h"
 #include "io/iomanager.h"
+#include "memoryblock.h"
+#include "memorydump.h"
 #include "processorhandler.h"
+#include "processors/RISC-V/rv_vector.h"
 #include "programutilities.h"
+#include "reportwriter.h"
+#include "ripessettings.h"
+#include "sampler.h"
+#include "snapshot.h"
 #include "syscall/systemio.h"
+#include "telemetrystream.h"
 
-#include <QJsonDocument>
+#include <QBuffer>
+#include <QDir>
+#include <QFileInfo>
 #include <QJsonObject>
+#include <QScopeGuard>
+
+#include <cstdio>
+#include <map>
 
 namespace Ripes {
 
@@ -35,37 +57,189 @@ static QString qVariantToString(QVariant &v) {
 CLIRunner::CLIRunner(const CLIModeOptions &options)
     : QObject(), m_options(options) {
   info("Ripes CLI mode", false, true);
-  ProcessorHandler::selectProcessor(m_options.proc, m_options.isaExtensions,
-                                    m_options.regInit);
+  for (auto &telemetry : m_options.telemetry) {
+    if (auto simSpeed = std::dynamic_pointer_cast<SimSpeedTelemetry>(telemetry))
+      m_simSpeed = simSpeed;
+    if (auto termination =
+            std::dynamic_pointer_cast<TerminationTelemetry>(telemetry))
+      m_termination = termination;
+    if (auto energy = std::dynamic_pointer_cast<EnergyTelemetry>(telemetry))
+      energy->setModel(m_options.energyModel);
+  }
 
-  // Connect systemIO output to stdout.
-  connect(&SystemIO::get(), &SystemIO::doPrint, this, [&](auto text) {
-    std::cout << text.toStdString();
-    std::flush(std::cout);
-  });
+  QElapsedTimer constructionTimer;
+  constructionTimer.start();
+  if (m_options.reuseProcessor)
+    ProcessorHandler::reselectProcessor(
+        m_options.proc, m_options.isaExtensions, m_options.regInit);
+  else
+    ProcessorHandler::selectProcessor(m_options.proc, m_options.isaExtensions,
+                                      m_options.regInit);
+  if (m_simSpeed)
+    m_simSpeed->timings().construction = constructionTimer.nsecsElapsed() / 1e9;
+  ProcessorHandler::getProcessorNonConst()->setNativeClocking(
+      m_options.nativeClocking);
+  // Reused processors may hold the timing of a previous job.
+  ProcessorHandler::getProcessorNonConst()->functionalUnitTiming =
+      m_options.functionalUnits.value_or(FunctionalUnitTiming());
+  if (auto *dualIssue = dynamic_cast<DualIssueProcessor *>(
+          ProcessorHandler::getProcessorNonConst()))
+    dualIssue->setPairingPolicy(
+        m_options.pairingPolicy.value_or(WayPairingPolicy()));
+  if (auto *targets = dynamic_cast<TargetPredictionProcessor *>(
+          ProcessorHandler::getProcessorNonConst()))
+    targets->setTargetPrediction(
+        m_options.targetPrediction.value_or(TargetPredictionConfig()));
+  if (auto *fetchQueue = dynamic_cast<FetchQueueProcessor *>(
+          ProcessorHandler::getProcessorNonConst()))
+    fetchQueue->setFetchQueue(
+        m_options.fetchQueue.value_or(FetchQueueConfig()));
+  if (auto *vector = dynamic_cast<VectorProcessor *>(
+          ProcessorHandler::getProcessorNonConst()))
+    vector->setVLEN(m_options.vlen.value_or(RVVectorUnit::c_defaultVLEN));
 
-  // TODO: how to handle system input?
+  // Connect systemIO output to stdout. All output is retained, and so may be
+  // flushed by the simulating thread, which calls the receiver directly.
+  SystemIO::setRetainOutput(true);
+  connect(
+      &SystemIO::get(), &SystemIO::doPrint, this,
+      [&](auto text) {
+        if (m_options.captureOutput) {
+          m_output += text;
+          return;
+        }
+        // Output arrives in chunks, and std::cout is flushed once the
+        // simulation finishes.
+        std::cout << text.toStdString();
+      },
+      Qt::DirectConnection);
+
+  if (m_options.caches) {
+    m_caches = std::make_shared<CacheHierarchy>(*m_options.caches);
+    // Trace replays drive the hierarchy directly.
+    if (m_options.replayTrace.isEmpty())
+      m_caches->attachToProcessor();
+    for (auto &telemetry : m_options.telemetry)
+      if (auto caches =
+              std::dynamic_pointer_cast<CacheHierarchyTelemetry>(telemetry))
+        caches->setHierarchy(m_caches);
+      else if (auto misses =
+                   std::dynamic_pointer_cast<CacheMissTelemetry>(telemetry))
+        misses->setHierarchy(m_caches, m_options.profile.top);
+      else if (auto roofline =
+                   std::dynamic_pointer_cast<RooflineTelemetry>(telemetry))
+        roofline->setHierarchy(m_caches);
+      else if (auto energy =
+                   std::dynamic_pointer_cast<EnergyTelemetry>(telemetry))
+        energy->setHierarchy(m_caches);
+  }
 }
 
 int CLIRunner::run() {
-  if (processInput())
-    return 1;
+  for (unsigned i = 0; i < MemoryFootprint::NComponents; ++i)
+    MemoryFootprint::setBudget(MemoryFootprint::Component(i),
+                               m_options.memoryBudgets[i]);
+  const int result = simulate();
+  if (result == ExitFailure)
+    return ExitFailure;
 
-  if (runModel())
-    return 1;
+  const auto footprint = MemoryFootprint::measure();
+  for (const auto component : MemoryFootprint::overBudget(footprint))
+    info(QString("%1: %2 MiB, exceeding the memory budget of %3 MiB")
+             .arg(MemoryFootprint::name(component))
+             .arg(footprint[component] / double(1 << 20), 0, 'f', 1)
+             .arg(MemoryFootprint::budget(component) / double(1 << 20), 0,
+                  'f', 1),
+         true);
 
   if (postRun())
+    return ExitFailure;
+
+  return result;
+}
+
+int CLIRunner::simulate() {
+  // Output pending once the simulation finishes is written before returning.
+  const auto flushOutput = qScopeGuard([] {
+    SystemIO::flushOutput();
+    std::cout.flush();
+  });
+  if (!m_options.replayTrace.isEmpty())
+    return runTraceReplay();
+
+  const auto resetStdIn =
+      qScopeGuard([] { SystemIO::setStdInSource(nullptr); });
+  if (openStdIn())
+    return ExitFailure;
+
+  // Peripherals are instantiated ahead of processing the input, which may
+  // refer to the symbols of the peripherals.
+  if (!m_options.ioConfig.isEmpty()) {
+    m_io = std::make_unique<IOConfig>();
+    if (const QString err = m_io->loadFile(m_options.ioConfig);
+        !err.isEmpty()) {
+      error(err);
+      return ExitFailure;
+    }
+  }
+
+  QElapsedTimer loadingTimer;
+  loadingTimer.start();
+  if (processInput() || preloadFiles())
     return 1;
+  if (m_simSpeed)
+    m_simSpeed->timings().loading = loadingTimer.nsecsElapsed() / 1e9;
 
+  if (m_options.cosimulate)
+    return runCosimulation();
+  else if (m_options.sampling.enabled())
+    return runSampled();
+  else if (m_options.cacheSweep.enabled)
+    return runCacheSweep();
+  return runModel();
+}
+
+int CLIRunner::openStdIn() {
+  if (m_options.stdinData) {
+    auto buffer = std::make_unique<QBuffer>();
+    buffer->setData(*m_options.stdinData);
+    buffer->open(QIODevice::ReadOnly);
+    m_stdin = std::move(buffer);
+  } else if (!m_options.stdinFile.isEmpty()) {
+    auto file = std::make_unique<QFile>(m_options.stdinFile);
+    const bool opened = m_options.stdinFile == "-"
+                            ? file->open(stdin, QIODevice::ReadOnly)
+                            : file->open(QIODevice::ReadOnly);
+    if (!opened) {
+      error("Failed to open stdin file '" + m_options.stdinFile + "'");
+      return 1;
+    }
+    m_stdin = std::move(file);
+  } else {
+    return 0;
+  }
+  SystemIO::setStdInSource(m_stdin.get());
   return 0;
 }
 
+QJsonObject CLIRunner::jsonReport() const {
+  QJsonObject jsonOutput;
+  for (auto &telemetry : m_options.telemetry)
+    if (telemetry->isEnabled())
+      jsonOutput.insert(
+          telemetry->prettyKey(),
+          QJsonValue::fromVariant(telemetry->report(/*json=*/true)));
+  return jsonOutput;
+}
+
 int CLIRunner::processInput() {
   info("Processing input file", false, true);
 
   switch (m_options.srcType) {
   case SourceType::Assembly: {
     info("Assembling input file '" + m_options.src + "'");
+    if (!m_options.assemblerCache.isEmpty())
+      Assembler::ProgramCache::get().setDirectory(m_options.assemblerCache);
     QFile inputFile(m_options.src);
     if (!inputFile.open(QIODevice::ReadOnly)) {
       error("Failed to open input file");
@@ -73,12 +247,17 @@ int CLIRunner::processInput() {
     }
     auto res = ProcessorHandler::getAssembler()->assembleRaw(
         inputFile.readAll(), &IOManager::get().assemblerSymbols());
-    if (res.errors.size() == 0)
-      ProcessorHandler::loadProgram(std::make_shared<Program>(res.program));
-    else {
+    if (res.errors.size() == 0) {
+      m_program = std::make_shared<Program>(res.program);
+      ProcessorHandler::loadProgram(m_program);
+    } else {
       error("Error during assembly:");
-      for (auto &err : res.errors)
-        info(err.errorMessage(), true);
+      for (auto &err : res.errors) {
+        if (m_options.captureOutput)
+          m_errors << err.errorMessage();
+        else
+          info(err.errorMessage(), true);
+      }
       return 1;
     }
     break;
@@ -91,9 +270,25 @@ int CLIRunner::processInput() {
       error(err);
       return 1;
     }
-    ProcessorHandler::loadProgram(std::make_shared<Program>(p));
+    m_program = std::make_shared<Program>(p);
+    ProcessorHandler::loadProgram(m_program);
     break;
   }
+  case SourceType::ExternalELF: {
+    info("Loading executable '" + m_options.src + "'");
+    return loadExecutable(m_options.src);
+  }
+  case SourceType::C: {
+    info("Compiling input file '" + m_options.src + "'");
+    QString errorMessage;
+    QTemporaryDir outputDir;
+    const QString executable = compileInput(outputDir, errorMessage);
+    if (executable.isEmpty()) {
+      error(errorMessage);
+      return 1;
+    }
+    return loadExecutable(executable);
+  }
   default:
     assert(false &&
            "Command-line support for this source type is not yet implemented");
@@ -102,6 +297,124 @@ int CLIRunner::processInput() {
   return 0;
 }
 
+int CLIRunner::loadExecutable(const QString &path) {
+  Program p;
+  const QString err = loadElfFile(p, path);
+  if (!err.isEmpty()) {
+    error(err);
+    return 1;
+  }
+  m_program = std::make_shared<Program>(p);
+  ProcessorHandler::loadProgram(m_program);
+  return 0;
+}
+
+int CLIRunner::preloadFiles() {
+  if (m_options.preloads.empty())
+    return 0;
+  RegisterInitialization regInit = m_options.regInit;
+  const auto setRegister = [&](const QString &name, VInt value) {
+    for (const auto &[rfid, regInfo] :
+         ProcessorHandler::currentISA()->regInfoMap()) {
+      bool found;
+      const unsigned index = regInfo->regNumber(name, found);
+      if (found) {
+        regInit[rfid][index] = value;
+        return true;
+      }
+    }
+    error("Invalid register '" + name + "' specified (--preload).");
+    return false;
+  };
+
+  for (const auto &preload : m_options.preloads) {
+    bool isAddress;
+    const AInt address = preload.start.toULongLong(&isAddress, 0);
+    std::optional<AInt> symbol;
+    if (!isAddress && m_program)
+      symbol = m_program->symbolIndex().address(preload.start);
+    if (!isAddress && !symbol) {
+      error("Unknown symbol '" + preload.start + "' (--preload)");
+      return 1;
+    }
+    const AInt start = isAddress ? address : *symbol;
+
+    auto file = std::make_shared<QFile>(preload.path);
+    if (!file->open(QIODevice::ReadOnly)) {
+      error("Failed to open preload file '" + preload.path + "'");
+      return 1;
+    }
+    // The memory references the mapping of the file, owned by the file, until
+    // the referencing pages are written. Files which cannot be mapped, such as
+    // empty files, are read instead.
+    std::shared_ptr<const void> owner = file;
+    size_t size = file->size();
+    const char *data = reinterpret_cast<const char *>(file->map(0, size));
+    if (!data) {
+      auto contents = std::make_shared<QByteArray>(file->readAll());
+      data = contents->constData();
+      size = contents->size();
+      owner = std::move(contents);
+    }
+    MemoryBlock::addInitializationMemory(ProcessorHandler::getMemory(), start,
+                                         data, size, std::move(owner));
+    info("Preloaded " + QString::number(size) + " bytes of '" + preload.path +
+         "' at 0x" + QString::number(start, 16));
+
+    if (!preload.pointerRegister.isEmpty() &&
+        !setRegister(preload.pointerRegister, start))
+      return 1;
+    if (!preload.lengthRegister.isEmpty() &&
+        !setRegister(preload.lengthRegister, size))
+      return 1;
+  }
+
+  // Resetting the processor rebuilds its memory image, including the files.
+  ProcessorHandler::reselectProcessor(m_options.proc, m_options.isaExtensions,
+                                      regInit);
+  return 0;
+}
+
+QString CLIRunner::compileInput(const QTemporaryDir &outputDir,
+                                QString &errorMessage) {
+  auto &cc = CCManager::get();
+  if (!m_options.compiler.isEmpty() && cc.currentCC() != m_options.compiler &&
+      !cc.trySetCC(m_options.compiler)) {
+    errorMessage = "Invalid compiler '" + m_options.compiler + "'";
+    return QString();
+  }
+  if (!cc.hasValidCC()) {
+    errorMessage = "No valid compiler found (--cc)";
+    return QString();
+  }
+
+  QFile inputFile(m_options.src);
+  if (!inputFile.open(QIODevice::ReadOnly)) {
+    errorMessage = "Failed to open input file";
+    return QString();
+  }
+  QStringList files = {QFileInfo(inputFile).absoluteFilePath()};
+  // Include peripheral header file, if available
+  const QString peripheralSymbolsHeader = IOManager::get().cSymbolsHeaderpath();
+  if (!peripheralSymbolsHeader.isEmpty())
+    files << peripheralSymbolsHeader;
+
+  // Executables are only cached if requested, such that runs are independent
+  // of the cache of the Ripes GUI.
+  cc.setCacheDirectory(m_options.compileCache);
+  cc.setCacheSizeLimit(m_options.compileCacheSize);
+  const QString outputPath = outputDir.filePath("a.out");
+  auto res = cc.compile(files, outputPath, /*showProgressdiag=*/false);
+  if (!res.success) {
+    errorMessage = "Error during compilation:\n" +
+                   res.errorOutput.errMsg + "\n" + CCManager::getError();
+    return QString();
+  }
+  if (res.cached)
+    info("Loaded cached executable from '" + m_options.compileCache + "'");
+  return outputPath;
+}
+
 int CLIRunner::runModel() {
   info("Running model", false, true);
 
@@ -136,67 +449,564 @@ int CLIRunner::runModel() {
   if (m_options.verbose)
     infoTimer.start(1000);
 
+  std::shared_ptr<AccessTraceWriter> traceWriter;
+  std::unique_ptr<L1CacheShim> traceShim;
+  if (!m_options.recordTrace.isEmpty()) {
+    QString errorMessage;
+    traceWriter = std::make_shared<AccessTraceWriter>();
+    if (!traceWriter->open(m_options.recordTrace, errorMessage)) {
+      error(errorMessage);
+      return 1;
+    }
+    traceShim = std::make_unique<L1CacheShim>(
+        L1CacheShim::CacheType::InstrCache, nullptr);
+    traceShim->setTraceWriter(traceWriter);
+  }
+
+  std::shared_ptr<PipelineTraceWriter> pipelineTrace;
+  if (m_options.pipelineTrace.enabled()) {
+    QString errorMessage;
+    pipelineTrace =
+        std::make_shared<PipelineTraceWriter>(m_options.pipelineTrace);
+    if (!pipelineTrace->open(errorMessage)) {
+      error(errorMessage);
+      return 1;
+    }
+    for (auto &telemetry : m_options.telemetry)
+      if (auto pipeline =
+              std::dynamic_pointer_cast<PipelineTelemetry>(telemetry))
+        pipeline->setTraceWriter(pipelineTrace);
+  }
+
+  // The profile, the roofline and the energy estimate share the profiler of
+  // the run.
+  std::shared_ptr<Profiler> profiler;
+  const auto getProfiler = [&] {
+    if (!profiler) {
+      profiler = std::make_shared<Profiler>(m_program, m_options.profile.top);
+      profiler->attach(ProcessorHandler::getProcessorNonConst());
+    }
+    return profiler;
+  };
+  for (auto &telemetry : m_options.telemetry) {
+    if (!telemetry->isEnabled())
+      continue;
+    if (auto profile = std::dynamic_pointer_cast<ProfileTelemetry>(telemetry))
+      profile->setProfiler(getProfiler());
+    else if (auto roofline =
+                 std::dynamic_pointer_cast<RooflineTelemetry>(telemetry);
+             roofline && m_caches)
+      roofline->setProfiler(getProfiler());
+    else if (auto energy =
+                 std::dynamic_pointer_cast<EnergyTelemetry>(telemetry))
+      energy->setProfiler(getProfiler());
+  }
+
+  // Connections of the analyses recording the memory accesses of the run.
+  std::vector<QMetaObject::Connection> accessConnections;
+  const auto stopRecording = qScopeGuard([&] {
+    for (const auto &connection : accessConnections)
+      disconnect(connection);
+  });
+  for (auto &telemetry : m_options.telemetry) {
+    auto reuse = std::dynamic_pointer_cast<ReuseTelemetry>(telemetry);
+    if (reuse && reuse->isEnabled()) {
+      const unsigned byteOffset =
+          log2Ceil(ProcessorHandler::currentISA()->bytes());
+      const auto &options = m_options.reuse;
+      auto icache = std::make_shared<ReuseAnalysis>(byteOffset, options.blocks,
+                                                    options.window);
+      auto dcache = std::make_shared<ReuseAnalysis>(byteOffset, options.blocks,
+                                                    options.window);
+      reuse->setAnalyses(icache, dcache);
+      accessConnections =
+          recordAccesses([=](const MemoryAccess &instrAccess,
+                             const MemoryAccess &dataAccess, long long cycle) {
+            if (instrAccess.type == MemoryAccess::Read)
+              icache->access(instrAccess.address, cycle);
+            if (dataAccess.type != MemoryAccess::None)
+              dcache->access(dataAccess.address, cycle);
+          });
+    }
+  }
+  if (m_options.mmu) {
+    auto mmu = createMMU();
+    if (!mmu)
+      return 1;
+    const auto connections = recordAccesses(
+        [=](const MemoryAccess &instrAccess, const MemoryAccess &dataAccess,
+            long long) { mmu->access(instrAccess, dataAccess); });
+    accessConnections.insert(accessConnections.end(), connections.begin(),
+                             connections.end());
+  }
+
+  if (!m_options.replayInputs.isEmpty()) {
+    if (const QString err = InputLog::startReplay(m_options.replayInputs);
+        !err.isEmpty()) {
+      error(err);
+      return 1;
+    }
+  } else if (!m_options.recordInputs.isEmpty()) {
+    InputLog::startRecording();
+  }
+  const auto stopInputLog = qScopeGuard([] { InputLog::stop(); });
+
+  std::unique_ptr<TelemetryStream> stream;
+  if (m_options.stream.enabled()) {
+    QString errorMessage;
+    stream = std::make_unique<TelemetryStream>(m_options.stream, m_caches);
+    if (!stream->open(errorMessage)) {
+      error(errorMessage);
+      return 1;
+    }
+    stream->start();
+  }
+
+  auto &watchpoints = ProcessorHandler::watchpoints();
+  watchpoints.clear();
+  const auto clearWatchpoints = qScopeGuard([&] { watchpoints.clear(); });
+  for (const auto &watchpoint : m_options.memoryWatchpoints)
+    watchpoints.addMemory(watchpoint);
+  for (const auto &name : m_options.registerWatchpoints) {
+    bool found = false;
+    for (const auto &[rfid, regInfo] :
+         ProcessorHandler::currentISA()->regInfoMap()) {
+      const unsigned index = regInfo->regNumber(name, found);
+      if (found) {
+        found = watchpoints.addRegister({rfid, index});
+        break;
+      }
+    }
+    if (!found) {
+      error("Invalid register '" + name + "' specified (--watchreg).");
+      return 1;
+    }
+  }
+
+  std::shared_ptr<CommitLog> commitLog;
+  if (!m_options.commitLog.isEmpty()) {
+    QString errorMessage;
+    commitLog =
+        CommitLog::open(m_options.commitLog, m_options.commitLogFormat,
+                        *ProcessorHandler::currentISA(), errorMessage);
+    if (!commitLog) {
+      error(errorMessage);
+      return 1;
+    }
+    ProcessorHandler::setCommitLog(commitLog);
+  }
+
+  // The caches of the hierarchy are saved to and restored from snapshots.
+  std::vector<CacheSim *> snapshotCaches;
+  if (m_caches) {
+    snapshotCaches = {&m_caches->l1i(), &m_caches->l1d()};
+    if (m_caches->l2())
+      snapshotCaches.push_back(m_caches->l2());
+  }
+  if (!m_options.loadSnapshot.isEmpty()) {
+    QString errorMessage;
+    if (!Snapshot::load(m_options.loadSnapshot, errorMessage,
+                        snapshotCaches)) {
+      error(errorMessage);
+      return 1;
+    }
+    info("Restored snapshot '" + m_options.loadSnapshot + "' at cycle " +
+         QString::number(ProcessorHandler::getProcessor()->getCycleCount()));
+  } else if (!m_options.saveSnapshot.isEmpty()) {
+    // Pages written by the run are only recorded once tracking is enabled,
+    // which Snapshot::load does by itself.
+    Snapshot::enableTracking();
+  }
+
   // Start simulation
+  ProcessorHandler::setRunLimits({m_options.maxCycles,
+                                  m_options.maxInstructions});
+  QElapsedTimer runTimer;
+  runTimer.start();
   ProcessorHandler::run();
   if (m_options.timeout != 0)
     timeoutTimer.start(m_options.timeout);
   loop.exec();
+  if (m_simSpeed)
+    m_simSpeed->timings().run = runTimer.nsecsElapsed() / 1e9;
 
   // Event loop finished either by processor finishing or timeout. Determine the
   // cause and act.
 
   timeoutTimer.stop();
   infoTimer.stop();
-  if (hadTimeout) {
+  // The run is stopped before the final record is written, such that it is
+  // not written concurrently with the simulation thread.
+  if (hadTimeout)
     ProcessorHandler::stopRun();
+  if (stream)
+    stream->stop();
+  if (pipelineTrace)
+    pipelineTrace->close();
+  if (commitLog) {
+    ProcessorHandler::setCommitLog(nullptr);
+    if (const QString err = commitLog->close(); !err.isEmpty()) {
+      error(err);
+      return 1;
+    }
+    info("Logged " + QString::number(commitLog->commits()) +
+         " retired instructions to '" + m_options.commitLog + "'");
+  }
+  if (profiler) {
+    profiler->detach();
+    QString errorMessage;
+    if (!m_options.profile.folded.isEmpty() &&
+        !profiler->writeFolded(m_options.profile.folded, errorMessage)) {
+      error(errorMessage);
+      return 1;
+    }
+    if (!m_options.profile.blocks.isEmpty() &&
+        !profiler->writeBlocks(m_options.profile.blocks, errorMessage)) {
+      error(errorMessage);
+      return 1;
+    }
+  }
+  if (traceWriter) {
+    traceWriter->close();
+    info("Recorded " + QString::number(traceWriter->cycles()) +
+         " cycles of memory accesses to '" + m_options.recordTrace + "'");
+  }
+  if (!m_options.recordInputs.isEmpty()) {
+    if (const QString err = InputLog::save(m_options.recordInputs);
+        !err.isEmpty()) {
+      error(err);
+      return 1;
+    }
+    info("Recorded " + QString::number(InputLog::inputs()) + " inputs to '" +
+         m_options.recordInputs + "'");
+  } else if (!m_options.replayInputs.isEmpty()) {
+    info("Replayed " + QString::number(InputLog::inputs()) + " inputs from '" +
+         m_options.replayInputs + "'");
+    if (InputLog::diverged())
+      info("The run diverged from the recorded inputs of '" +
+               m_options.replayInputs + "'",
+           true);
+  }
+  if (!m_options.saveSnapshot.isEmpty()) {
+    QString errorMessage;
+    if (!Snapshot::save(m_options.saveSnapshot, errorMessage,
+                        snapshotCaches)) {
+      error(errorMessage);
+      return 1;
+    }
+    info("Saved snapshot to '" + m_options.saveSnapshot + "' at cycle " +
+         QString::number(ProcessorHandler::getProcessor()->getCycleCount()));
+  }
+  if (hadTimeout) {
+    if (m_termination)
+      m_termination->setReason("timeout");
     error("Simulation did not finish within the specified timeout (" +
           QString::number(m_options.timeout) + " ms)");
+    return ExitFailure;
+  }
+
+  if (const auto &hit = ProcessorHandler::watchpointHit()) {
+    if (m_termination) {
+      m_termination->setReason("watchpoint");
+      m_termination->setWatchpointHit(*hit, ProcessorHandler::currentISA());
+    }
+    info(hit->describe(ProcessorHandler::currentISA()));
+    return ExitWatchpoint;
+  }
+
+  switch (ProcessorHandler::runLimitReached()) {
+  case ProcessorHandler::RunLimit::Cycles:
+    if (m_termination)
+      m_termination->setReason("cycle limit");
+    info("Simulation stopped after reaching the cycle limit (" +
+         QString::number(m_options.maxCycles) + " cycles)");
+    return ExitCycleLimit;
+  case ProcessorHandler::RunLimit::Instructions:
+    if (m_termination)
+      m_termination->setReason("instruction limit");
+    info("Simulation stopped after reaching the instruction limit (" +
+         QString::number(m_options.maxInstructions) + " instructions)");
+    return ExitInstructionLimit;
+  case ProcessorHandler::RunLimit::None:
+    break;
+  }
+  if (m_termination)
+    m_termination->setReason("finished");
+  return ExitSuccess;
+}
+
+int CLIRunner::runSampled() {
+  info("Running sampled simulation", false, true);
+
+  // The console input is read in full ahead of the run, by the functional
+  // simulator.
+  const QByteArray input = m_stdin ? m_stdin->readAll() : QByteArray();
+  Sampler sampler(m_options, m_program, input);
+  QString errorMessage;
+  const bool success = sampler.run(errorMessage);
+  for (auto &telemetry : m_options.telemetry)
+    if (auto sampling = std::dynamic_pointer_cast<SamplingTelemetry>(telemetry))
+      sampling->setReport(sampler.report());
+  if (!success) {
+    error(errorMessage);
     return 1;
   }
+  return 0;
+}
+
+int CLIRunner::runCacheSweep() {
+  const auto &sweep = m_options.cacheSweep;
+  const unsigned byteOffset = log2Ceil(ProcessorHandler::currentISA()->bytes());
+  auto icache = std::make_shared<CacheSweep>(byteOffset, sweep.blocks,
+                                             sweep.lines, sweep.ways);
+  auto dcache = std::make_shared<CacheSweep>(byteOffset, sweep.blocks,
+                                             sweep.lines, sweep.ways);
+  // Record the accesses of the initial (cycle 0) state, and of every cycle
+  // thereafter.
+  const auto connections =
+      recordAccesses([=](const MemoryAccess &instrAccess,
+                         const MemoryAccess &dataAccess, long long) {
+        if (instrAccess.type == MemoryAccess::Read)
+          icache->access(instrAccess.address);
+        if (dataAccess.type != MemoryAccess::None)
+          dcache->access(dataAccess.address);
+      });
+
+  const int result = runModel();
+  for (const auto &connection : connections)
+    disconnect(connection);
 
+  for (auto &telemetry : m_options.telemetry)
+    if (auto cacheSweep =
+            std::dynamic_pointer_cast<CacheSweepTelemetry>(telemetry))
+      cacheSweep->setSweeps(icache, dcache);
+  return result;
+}
+
+std::vector<QMetaObject::Connection>
+CLIRunner::recordAccesses(const AccessRecorder &record) {
+  const auto *proc = ProcessorHandler::getProcessor();
+  record(proc->instrMemAccess(), proc->dataMemAccess(), proc->getCycleCount());
+  auto clocked = connect(
+      ProcessorHandler::get(), &ProcessorHandler::processorClocked, this,
+      [=] {
+        record(proc->instrMemAccess(), proc->dataMemAccess(),
+               proc->getCycleCount());
+      },
+      Qt::DirectConnection);
+  auto clockedBatch = connect(
+      ProcessorHandler::get(), &ProcessorHandler::processorClockedBatch, this,
+      [=] {
+        for (const auto &cycle : proc->clockBatch())
+          record(cycle.instrAccess, cycle.dataAccess, cycle.cycle);
+      },
+      Qt::DirectConnection);
+  return {clocked, clockedBatch};
+}
+
+std::shared_ptr<MMU> CLIRunner::createMMU() {
+  MMUConfig config = m_options.mmu->config;
+  const QString &pageTable = m_options.mmu->pageTable;
+  if (!pageTable.isEmpty()) {
+    bool isAddress;
+    const AInt address = pageTable.toULongLong(&isAddress, 0);
+    std::optional<AInt> symbol;
+    if (!isAddress && m_program)
+      symbol = m_program->symbolIndex().address(pageTable);
+    if (!isAddress && !symbol) {
+      error("Unknown symbol '" + pageTable + "' (--pagetable)");
+      return nullptr;
+    }
+    config.root = isAddress ? address : *symbol;
+  }
+  // Page tables are read as they are at the time of the walk, such that the
+  // program may build them.
+  auto mmu = std::make_shared<MMU>(config, [](AInt address, unsigned bytes) {
+    return ProcessorHandler::getMemory().readMemConst(address, bytes);
+  });
+  for (auto &telemetry : m_options.telemetry)
+    if (auto tlb = std::dynamic_pointer_cast<TLBTelemetry>(telemetry))
+      tlb->setMMU(mmu);
+  return mmu;
+}
+
+int CLIRunner::runTraceReplay() {
+  info("Replaying memory access trace", false, true);
+
+  AccessTraceReader reader;
+  QString errorMessage;
+  if (!reader.open(m_options.replayTrace, errorMessage)) {
+    error(errorMessage);
+    return 1;
+  }
+
+  const auto presets = RipesSettings::value(RIPES_SETTING_CACHE_PRESETS)
+                           .value<QList<CachePreset>>();
+  if (presets.empty()) {
+    error("Trace replay requires a cache preset, of which none are "
+          "configured in the settings");
+    return 1;
+  }
+  CacheSim icache(nullptr);
+  CacheSim dcache(nullptr);
+  for (auto *cache : {&icache, &dcache}) {
+    cache->setPreset(presets.front());
+    cache->setRecordHistory(false);
+  }
+
+  std::shared_ptr<CacheSweep> icacheSweep, dcacheSweep;
+  if (m_options.cacheSweep.enabled) {
+    const auto &sweep = m_options.cacheSweep;
+    const unsigned byteOffset =
+        log2Ceil(ProcessorHandler::currentISA()->bytes());
+    icacheSweep = std::make_shared<CacheSweep>(byteOffset, sweep.blocks,
+                                               sweep.lines, sweep.ways);
+    dcacheSweep = std::make_shared<CacheSweep>(byteOffset, sweep.blocks,
+                                               sweep.lines, sweep.ways);
+  }
+
+  std::shared_ptr<MMU> mmu;
+  if (m_options.mmu) {
+    mmu = createMMU();
+    if (!mmu)
+      return 1;
+  }
+
+  MemoryAccess instrAccess, dataAccess;
+  while (reader.next(instrAccess, dataAccess)) {
+    if (m_caches)
+      m_caches->access(instrAccess, dataAccess);
+    if (mmu)
+      mmu->access(instrAccess, dataAccess);
+    if (instrAccess.type == MemoryAccess::Read) {
+      icache.access(instrAccess.address, MemoryAccess::Read);
+      if (icacheSweep)
+        icacheSweep->access(instrAccess.address);
+    }
+    if (dataAccess.type != MemoryAccess::None) {
+      dcache.access(dataAccess.address, dataAccess.type);
+      if (dcacheSweep)
+        dcacheSweep->access(dataAccess.address);
+    }
+  }
+  if (reader.error()) {
+    error("Malformed memory access trace '" + m_options.replayTrace +
+          "' after " + QString::number(reader.cycles()) + " cycles");
+    return 1;
+  }
+
+  const auto cacheReport = [](const CacheSim &cache) {
+    QVariantMap m;
+    m["hits"] = cache.getHits();
+    m["misses"] = cache.getMisses();
+    m["writebacks"] = cache.getWritebacks();
+    m["hit rate"] = cache.getHitRate();
+    return m;
+  };
+  QVariantMap report;
+  report["cycles"] = reader.cycles();
+  report["cache preset"] = presets.front().name;
+  report["icache"] = cacheReport(icache);
+  report["dcache"] = cacheReport(dcache);
+  for (auto &telemetry : m_options.telemetry) {
+    if (auto replay =
+            std::dynamic_pointer_cast<TraceReplayTelemetry>(telemetry))
+      replay->setReport(report);
+    if (auto cacheSweep =
+            std::dynamic_pointer_cast<CacheSweepTelemetry>(telemetry))
+      cacheSweep->setSweeps(icacheSweep, dcacheSweep);
+  }
+  return 0;
+}
+
+int CLIRunner::runCosimulation() {
+  info("Running co-simulation", false, true);
+
+  // Both models read the console input, which is thus read in full ahead of
+  // the run.
+  const QByteArray input = m_stdin ? m_stdin->readAll() : QByteArray();
+  Cosimulator cosimulator(m_options, m_program, input);
+  QString errorMessage;
+  if (!cosimulator.run(errorMessage)) {
+    error(errorMessage);
+    return 1;
+  }
+  info("Co-simulation finished after " +
+           QString::number(cosimulator.cycles()) + " cycles; " +
+           QString::number(cosimulator.comparedWrites()) +
+           " register writes matched the reference model",
+       true);
   return 0;
 }
 
 int CLIRunner::postRun() {
   info("Post-run", false, true);
 
-  // Open output stream
-  std::unique_ptr<QTextStream> stream;
-  std::unique_ptr<QFile> outputFile;
+  // Open output device
+  QFile output;
   if (m_options.outputFile.isEmpty()) {
-    stream = std::make_unique<QTextStream>(stdout, QIODevice::WriteOnly);
+    output.open(stdout, QIODevice::WriteOnly);
   } else {
-    outputFile = std::make_unique<QFile>(m_options.outputFile);
-    if (!outputFile->open(QIODevice::Truncate | QIODevice::Text |
-                          QIODevice::WriteOnly)) {
+    output.setFileName(m_options.outputFile);
+    QIODevice::OpenMode mode = QIODevice::Truncate | QIODevice::WriteOnly;
+    if (!m_options.jsonOutput ||
+        m_options.jsonFormat != ReportWriter::Format::CBOR)
+      mode |= QIODevice::Text;
+    if (!output.open(mode)) {
       error("Failed to open output file");
       return 1;
     }
-    stream = std::make_unique<QTextStream>(outputFile.get());
   }
 
   if (m_options.jsonOutput) {
-    // Telemetry output
-    QJsonObject jsonOutput;
+    // Telemetry output. Each report is written as it is produced, rather than
+    // into a document of every report. As in jsonReport(), reports are keyed
+    // in sorted order.
+    std::map<QString, Telemetry *> reports;
     for (auto &telemetry : m_options.telemetry)
       if (telemetry->isEnabled())
-        jsonOutput.insert(
-            telemetry->prettyKey(),
-            QJsonValue::fromVariant(telemetry->report(/*json=*/true)));
-    *stream << QJsonDocument(jsonOutput).toJson(QJsonDocument::Indented);
+        reports[telemetry->prettyKey()] = telemetry.get();
+    auto writer = ReportWriter::create(m_options.jsonFormat, output);
+    writer->beginObject();
+    for (const auto &[key, telemetry] : reports) {
+      writer->key(key);
+      telemetry->write(*writer);
+    }
+    writer->endObject();
   } else {
     // Telemetry output
+    QTextStream stream(&output);
     for (auto &telemetry : m_options.telemetry)
       if (telemetry->isEnabled()) {
-        *stream << "===== " << telemetry->description() << "\n";
+        stream << "===== " << telemetry->description() << "\n";
         QVariant reportedValue = telemetry->report(/*json=*/false);
-        *stream << qVariantToString(reportedValue) << "\n";
+        stream << qVariantToString(reportedValue) << "\n";
       }
   }
 
-  // Close output file if necessary
-  if (!m_options.outputFile.isEmpty())
-    outputFile->close();
+  if (m_options.dump.enabled()) {
+    // Dumps are written to their own file, or to the report output.
+    QFile dumpFile;
+    QIODevice *device = &output;
+    if (!m_options.dump.path.isEmpty()) {
+      dumpFile.setFileName(m_options.dump.path);
+      if (!dumpFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        error("Failed to open memory dump file '" + m_options.dump.path + "'");
+        return 1;
+      }
+      device = &dumpFile;
+    }
+    const MemoryDump dump(m_options.dump.format,
+                          ProcessorHandler::currentISA()->bytes());
+    QString errorMessage;
+    if (!dump.write(*device, ProcessorHandler::getMemory(),
+                    m_options.dump.regions, m_program.get(), errorMessage)) {
+      error(errorMessage);
+      return 1;
+    }
+  }
+
+  output.close();
 
   return 0;
 }
@@ -221,6 +1031,10 @@ void CLIRunner::info(QString msg, bool alwaysPrint, bool header,
   }
 }
 
-void CLIRunner::error(const QString &msg) { info(msg, true, false, "ERROR"); }
+void CLIRunner::error(const QString &msg) {
+  m_errors << msg;
+  if (!m_options.captureOutput)
+    info(msg, true, false, "ERROR");
+}
 
 } // namespace Ripes
@@ -1,10 +1,27 @@
 #pragma once
 
 #include "clioptions.h"
+#include "io/ioconfig.h"
+#include <QIODevice>
+#include <QJsonObject>
 #include <QObject>
+#include <QTemporaryDir>
+
+#include <memory>
 
 namespace Ripes {
 
+/// Exit codes of the CLI mode. Runs stopped by a bound on the cycles or retired
+/// instructions, or by a watchpoint, are reported as usual, but exit with a
+/// distinct code.
+enum CLIExitCode {
+  ExitSuccess = 0,
+  ExitFailure = 1,
+  ExitCycleLimit = 2,
+  ExitInstructionLimit = 3,
+  ExitWatchpoint = 4
+};
+
 /// The CLIRunner class is used to run Ripes in CLI mode.
 /// Based on a CLIModeOptions struct, it will run the appropriate combination
 /// of source processing (assembler/compiler/...), processor model execution
@@ -17,13 +34,69 @@ public:
   /// Runs the CLI mode.
   int run();
 
+  /// Processes the input and runs the processor model, without reporting.
+  /// Returns a CLIExitCode.
+  int simulate();
+
+  /// Returns the JSON report of the enabled telemetry.
+  QJsonObject jsonReport() const;
+
+  /// Errors and console output of the program, if captured (see
+  /// CLIModeOptions::captureOutput).
+  const QStringList &errors() const { return m_errors; }
+  const QString &output() const { return m_output; }
+
 private:
   /// Process the provided source file (assembling, compiling, loading, ...)
   int processInput();
 
+  /// Opens the stdin source of the run, if given (see
+  /// CLIModeOptions::stdinFile), through which reads of stdin are served.
+  int openStdIn();
+
+  /// Loads the ELF executable at @p path as the program.
+  int loadExecutable(const QString &path);
+
+  /// Loads the files of CLIModeOptions::preloads into memory, and initializes
+  /// their registers, such that they are part of the memory image to which the
+  /// processor resets.
+  int preloadFiles();
+
+  /// Compiles the C source file, returning the path of the executable, which
+  /// is placed in @p outputDir. The executable is copied from the compilation
+  /// cache if enabled (see CLIModeOptions::compileCache). Returns an empty
+  /// path and sets @p errorMessage on failure.
+  QString compileInput(const QTemporaryDir &outputDir, QString &errorMessage);
+
   /// Runs the processor model until the program is finished.
   int runModel();
 
+  /// Runs a sampled simulation of the program (see Sampler).
+  int runSampled();
+
+  /// Runs the processor model while recording the instruction and data memory
+  /// accesses into a sweep of cache configurations (see CacheSweep).
+  int runCacheSweep();
+
+  using AccessRecorder =
+      std::function<void(const MemoryAccess &instrAccess,
+                         const MemoryAccess &dataAccess, long long cycle)>;
+  /// Calls @p record with the memory accesses of the current state of the
+  /// processor, and of every cycle clocked thereafter until the returned
+  /// connections are disconnected; see L1CacheShim.
+  std::vector<QMetaObject::Connection>
+  recordAccesses(const AccessRecorder &record);
+  /// Creates the MMU of --mmu, resolving its page table in the program, and
+  /// assigns it to the TLB telemetry. Returns nullptr on an unknown symbol.
+  std::shared_ptr<MMU> createMMU();
+  /// Replays a memory access trace through the cache simulator, instead of
+  /// simulating a program.
+  int runTraceReplay();
+
+  /// Co-simulates the processor model against the reference model (see
+  /// Cosimulator).
+  int runCosimulation();
+
   /// Prints requested telemetry to the console/output file.
   int postRun();
   void info(QString msg, bool alwaysPrint = false, bool header = false,
@@ -31,6 +104,16 @@ private:
   void error(const QString &msg);
 
   CLIModeOptions m_options;
+  QStringList m_errors;
+  QString m_output;
+  std::shared_ptr<Program> m_program;
+  std::unique_ptr<QIODevice> m_stdin;
+  // Peripherals of the run, if configured (see CLIModeOptions::ioConfig).
+  std::unique_ptr<IOConfig> m_io;
+  std::shared_ptr<CacheHierarchy> m_caches;
+  // Records the timings of the phases of the run, if present.
+  std::shared_ptr<SimSpeedTelemetry> m_simSpeed;
+  std::shared_ptr<TerminationTelemetry> m_termination;
 };
 
 } // namespace Ripes
@@ -0,0 +1,294 @@
+#include "comparison.h"
+#include "assembler/assembler.h"
+#include "binutils.h"
+#include "cachesim/cachesweep.h"
+#include "processorpool.h"
+#include "simulationcontext.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <map>
+
+namespace Ripes {
+
+static CachePreset defaultCache() {
+  return CachePreset{"2:5:1",
+                     2,
+                     5,
+                     1,
+                     WritePolicy::WriteBack,
+                     WriteAllocPolicy::WriteAllocate,
+                     ReplPolicy::LRU};
+}
+
+/// Returns the named performance counters of @p counters.
+static std::vector<std::pair<QString, long long>>
+counterValues(const PerformanceCounters &counters) {
+  long long stalled = 0, flushed = 0;
+  for (const auto &stage : counters.stages) {
+    stalled += stage.second.stalled;
+    flushed += stage.second.flushed;
+  }
+  return {{"stall cycles", stalled},
+          {"flush cycles", flushed},
+          {"data hazards", counters.dataHazards},
+          {"load-use hazards", counters.loadUseHazards},
+          {"forwards", counters.forwards},
+          {"branches", counters.branches},
+          {"branches taken", counters.branchesTaken},
+          {"mispredicts", counters.mispredicts},
+          {"memory stalls", counters.memoryStalls},
+          {"functional unit stalls", counters.functionalUnitStalls},
+          {"fetch stalls", counters.fetchStalls},
+          {"backend stalls", counters.backendStalls}};
+}
+
+static double rate(long long count, long long total) {
+  return total != 0 ? static_cast<double>(count) / total : 0.0;
+}
+
+Comparison::Comparison(const Variant &a, const Variant &b)
+    : m_variants{a, b}, m_l1i(defaultCache()), m_l1d(defaultCache()) {}
+
+void Comparison::setCaches(const CachePreset &l1i, const CachePreset &l1d) {
+  m_l1i = l1i;
+  m_l1d = l1d;
+}
+
+std::shared_ptr<const Program>
+Comparison::assemble(ProcessorID id, const QStringList &extensions,
+                     const QString &source, QStringList &errors) {
+  auto processor = ProcessorPool::get().acquire(id, extensions);
+  const auto isa = processor->fullISA();
+  ProcessorPool::get().release(id, extensions, std::move(processor));
+  auto res = Assembler::constructAssemblerDynamic(isa)->assembleRaw(source);
+  if (!res.errors.empty()) {
+    for (const auto &err : res.errors)
+      errors << err.errorMessage();
+    return nullptr;
+  }
+  return std::make_shared<Program>(res.program);
+}
+
+void Comparison::run() {
+  std::array<std::unique_ptr<SimulationContext>, 2> contexts;
+  std::array<std::unique_ptr<Profiler>, 2> profilers;
+  for (size_t i = 0; i < contexts.size(); ++i) {
+    const auto &variant = m_variants.at(i);
+    auto &context = contexts.at(i);
+    context =
+        std::make_unique<SimulationContext>(variant.id, variant.extensions);
+    context->loadProgram(std::make_shared<Program>(*variant.program));
+    context->putStdInData(m_input);
+    context->processor()->setPerformanceCounting(true);
+    profilers.at(i) = std::make_unique<Profiler>(context->program(), 0);
+    profilers.at(i)->attach(context->processor());
+  }
+
+  QThreadPool pool;
+  for (size_t i = 0; i < contexts.size(); ++i)
+    pool.start([&, i] { simulate(*contexts.at(i), m_results.at(i)); });
+  pool.waitForDone();
+
+  for (size_t i = 0; i < contexts.size(); ++i) {
+    m_results.at(i).symbols = profilers.at(i)->symbols();
+    profilers.at(i)->detach();
+  }
+}
+
+void Comparison::simulate(SimulationContext &context, Result &result) const {
+  auto *processor = context.processor();
+  const unsigned byteOffset = log2Ceil(processor->implementsISA()->bytes());
+  const auto cache = [&](const CachePreset &preset) {
+    return CacheSweep(byteOffset, {preset.blocks, preset.blocks},
+                      {preset.lines, preset.lines},
+                      {preset.ways, preset.ways});
+  };
+  CacheSweep instrCache = cache(m_l1i);
+  CacheSweep dataCache = cache(m_l1d);
+
+  const bool finished = context.runUntil(
+      [&] {
+        return m_maxCycles != 0 && processor->getCycleCount() >= m_maxCycles;
+      },
+      [&] {
+        for (const auto &record : processor->clockBatch()) {
+          if (record.instrAccess.type == MemoryAccess::Read)
+            instrCache.access(record.instrAccess.address);
+          if (record.dataAccess.type != MemoryAccess::None)
+            dataCache.access(record.dataAccess.address);
+        }
+      });
+
+  result.cycles = processor->getCycleCount();
+  result.instructions = processor->getInstructionsRetired();
+  result.status = finished ? "ok"
+                  : m_maxCycles != 0 && result.cycles >= m_maxCycles
+                      ? "cycle limit"
+                      : "failed";
+  result.output = context.output();
+  result.hasCounters =
+      processor->features() & RipesProcessor::hasPerformanceCounters;
+  result.counters = processor->performanceCounters();
+  result.instrAccesses = instrCache.accesses();
+  result.instrMisses = instrCache.results().front().misses;
+  result.dataAccesses = dataCache.accesses();
+  result.dataMisses = dataCache.results().front().misses;
+}
+
+std::vector<Comparison::Row> Comparison::counters() const {
+  const auto &a = m_results.at(0);
+  const auto &b = m_results.at(1);
+  std::vector<Row> rows = {
+      {"cycles", double(a.cycles), double(b.cycles)},
+      {"instructions", double(a.instructions), double(b.instructions)},
+      {"CPI", rate(a.cycles, a.instructions), rate(b.cycles, b.instructions)}};
+  // A processor without performance counters counts no events.
+  if (a.hasCounters || b.hasCounters) {
+    const auto valuesA = counterValues(a.counters);
+    const auto valuesB = counterValues(b.counters);
+    for (size_t i = 0; i < valuesA.size(); ++i)
+      rows.push_back({valuesA.at(i).first,
+                      a.hasCounters ? double(valuesA.at(i).second) : 0,
+                      b.hasCounters ? double(valuesB.at(i).second) : 0});
+  }
+  return rows;
+}
+
+std::vector<Comparison::Row> Comparison::symbols() const {
+  std::map<QString, Row> bySymbol;
+  for (const auto &entry : m_results.at(0).symbols)
+    bySymbol[entry.name].a = entry.cycles;
+  for (const auto &entry : m_results.at(1).symbols)
+    bySymbol[entry.name].b = entry.cycles;
+  std::vector<Row> rows;
+  for (auto &[name, row] : bySymbol) {
+    row.name = name;
+    rows.push_back(row);
+  }
+  std::stable_sort(rows.begin(), rows.end(),
+                   [](const Row &lhs, const Row &rhs) {
+                     return std::abs(lhs.delta()) > std::abs(rhs.delta());
+                   });
+  return rows;
+}
+
+std::vector<Comparison::Row> Comparison::caches() const {
+  const auto &a = m_results.at(0);
+  const auto &b = m_results.at(1);
+  return {
+      {"l1i accesses", double(a.instrAccesses), double(b.instrAccesses)},
+      {"l1i misses", double(a.instrMisses), double(b.instrMisses)},
+      {"l1i miss rate", rate(a.instrMisses, a.instrAccesses),
+       rate(b.instrMisses, b.instrAccesses)},
+      {"l1d accesses", double(a.dataAccesses), double(b.dataAccesses)},
+      {"l1d misses", double(a.dataMisses), double(b.dataMisses)},
+      {"l1d miss rate", rate(a.dataMisses, a.dataAccesses),
+       rate(b.dataMisses, b.dataAccesses)}};
+}
+
+QJsonObject Comparison::report() const {
+  const auto rows = [](const std::vector<Row> &values) {
+    QJsonArray array;
+    for (const auto &row : values)
+      array.append(QJsonObject{{"name", row.name},
+                               {"a", row.a},
+                               {"b", row.b},
+                               {"delta", row.delta()}});
+    return array;
+  };
+  QJsonObject report;
+  for (size_t i = 0; i < m_variants.size(); ++i) {
+    const auto &variant = m_variants.at(i);
+    report[i == 0 ? "a" : "b"] = QJsonObject{
+        {"name", variant.name},
+        {"processor", enumToString<ProcessorID>(variant.id)},
+        {"extensions", variant.extensions.join(",")},
+        {"status", m_results.at(i).status}};
+  }
+  report["counters"] = rows(counters());
+  report["symbols"] = rows(symbols());
+  report["caches"] = QJsonObject{
+      {"l1i", m_l1i.name}, {"l1d", m_l1d.name}, {"rows", rows(caches())}};
+  // Differing output hints that the variants do not compute the same.
+  report["output equal"] = output(false) == output(true);
+  return report;
+}
+
+ComparisonRunner::ComparisonRunner(const CLIModeOptions &options)
+    : m_options(options) {}
+
+int ComparisonRunner::run() {
+  const auto &compare = m_options.compare;
+  Comparison::Variant variants[2] = {
+      {QFileInfo(m_options.src).fileName(), m_options.proc,
+       m_options.isaExtensions, nullptr},
+      {QFileInfo(compare.src.isEmpty() ? m_options.src : compare.src)
+           .fileName(),
+       compare.proc.value_or(m_options.proc),
+       compare.isaExtensions.value_or(m_options.isaExtensions), nullptr}};
+  const QString sources[2] = {
+      m_options.src, compare.src.isEmpty() ? m_options.src : compare.src};
+  for (int i = 0; i < 2; ++i) {
+    QFile file(sources[i]);
+    if (!file.open(QIODevice::ReadOnly)) {
+      std::cerr << "ERROR: Failed to open input file '"
+                << sources[i].toStdString() << "'" << std::endl;
+      return 1;
+    }
+    QStringList errors;
+    variants[i].program = Comparison::assemble(
+        variants[i].id, variants[i].extensions, file.readAll(), errors);
+    if (!variants[i].program) {
+      std::cerr << "ERROR: Error during assembly of '"
+                << sources[i].toStdString() << "':" << std::endl;
+      for (const auto &error : errors)
+        std::cerr << error.toStdString() << std::endl;
+      return 1;
+    }
+  }
+
+  Comparison comparison(variants[0], variants[1]);
+  if (m_options.caches)
+    comparison.setCaches(m_options.caches->l1i, m_options.caches->l1d);
+  comparison.setMaxCycles(m_options.maxCycles);
+  if (!m_options.stdinFile.isEmpty()) {
+    QFile input(m_options.stdinFile);
+    const bool opened = m_options.stdinFile == "-"
+                            ? input.open(stdin, QIODevice::ReadOnly)
+                            : input.open(QIODevice::ReadOnly);
+    if (!opened) {
+      std::cerr << "ERROR: Failed to open stdin file '"
+                << m_options.stdinFile.toStdString() << "'" << std::endl;
+      return 1;
+    }
+    comparison.setInput(input.readAll());
+  }
+  comparison.run();
+
+  const QByteArray out =
+      QJsonDocument(comparison.report()).toJson(QJsonDocument::Indented);
+  if (m_options.outputFile.isEmpty()) {
+    std::cout << out.toStdString() << std::flush;
+  } else {
+    QFile outputFile(m_options.outputFile);
+    if (!outputFile.open(QIODevice::Truncate | QIODevice::Text |
+                         QIODevice::WriteOnly)) {
+      std::cerr << "ERROR: Failed to open output file" << std::endl;
+      return 1;
+    }
+    outputFile.write(out);
+  }
+  return comparison.status(false) == "ok" && comparison.status(true) == "ok"
+             ? 0
+             : 1;
+}
+
+} // namespace Ripes
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "clioptions.h"
+#include "profiler.h"
+#include <QJsonObject>
+
+#include <array>
+#include <memory>
+
+namespace Ripes {
+
+class SimulationContext;
+
+/// The Comparison class runs two variants of a workload side by side; two
+/// programs, or a program on two processor configurations. Each variant is
+/// simulated in an independent SimulationContext on a thread of its own, and
+/// both variants are given the same console input.
+///
+/// The variants are compared by their performance counters, their cycles per
+/// symbol (see Profiler), and the hits and misses of a pair of L1 caches
+/// observing their memory accesses (see CacheSweep). Differences are given as
+/// variant B relative to variant A, such that saved cycles are negative.
+class Comparison {
+public:
+  struct Variant {
+    QString name;
+    ProcessorID id;
+    QStringList extensions;
+    std::shared_ptr<const Program> program;
+  };
+
+  /// A compared quantity, and its value in each variant.
+  struct Row {
+    QString name;
+    double a = 0;
+    double b = 0;
+    double delta() const { return b - a; }
+  };
+
+  Comparison(const Variant &a, const Variant &b);
+
+  /// Geometry of the L1 caches observing the memory accesses of the
+  /// variants; 4-word blocks, 32 lines and 2 ways by default.
+  void setCaches(const CachePreset &l1i, const CachePreset &l1d);
+  void setInput(const QByteArray &input) { m_input = input; }
+  /// Bounds the cycles of each variant; 0 is unbounded.
+  void setMaxCycles(long long maxCycles) { m_maxCycles = maxCycles; }
+
+  /// Runs both variants concurrently, until both have finished or reached
+  /// the cycle bound.
+  void run();
+
+  /// Returns the status of variant @p b (A otherwise); "ok", "cycle limit" or
+  /// "failed".
+  const QString &status(bool b) const { return m_results.at(b).status; }
+  /// Returns the console output of variant @p b (A otherwise).
+  const QString &output(bool b) const { return m_results.at(b).output; }
+
+  /// Returns the cycles, retired instructions and CPI of the variants, and
+  /// their performance counters if either processor maintains them.
+  std::vector<Row> counters() const;
+  /// Returns the cycles of each symbol of either variant, sorted by the
+  /// magnitude of their difference.
+  std::vector<Row> symbols() const;
+  /// Returns the accesses, misses and miss rate of the L1 caches.
+  std::vector<Row> caches() const;
+
+  /// Returns the comparison as a JSON report.
+  QJsonObject report() const;
+
+  /// Assembles @p source for the ISA of processor @p id with @p extensions.
+  /// Returns nullptr and sets @p errors on failure.
+  static std::shared_ptr<const Program>
+  assemble(ProcessorID id, const QStringList &extensions,
+           const QString &source, QStringList &errors);
+
+private:
+  struct Result {
+    QString status;
+    QString output;
+    long long cycles = 0;
+    long long instructions = 0;
+    bool hasCounters = false;
+    PerformanceCounters counters;
+    std::vector<Profiler::Entry> symbols;
+    long long instrAccesses = 0;
+    long long instrMisses = 0;
+    long long dataAccesses = 0;
+    long long dataMisses = 0;
+  };
+
+  void simulate(SimulationContext &context, Result &result) const;
+
+  std::array<Variant, 2> m_variants;
+  std::array<Result, 2> m_results;
+  CachePreset m_l1i;
+  CachePreset m_l1d;
+  QByteArray m_input;
+  long long m_maxCycles = 0;
+};
+
+/// The ComparisonRunner class compares the program of --src on the processor
+/// of --proc against the variant given by --compare, --compareproc and
+/// --compareexts (see Comparison), and writes the comparison as JSON.
+class ComparisonRunner {
+public:
+  ComparisonRunner(const CLIModeOptions &options);
+
+  /// Runs the comparison and writes the report. Returns non-zero if either
+  /// program failed to load, or either variant failed.
+  int run();
+
+private:
+  CLIModeOptions m_options;
+};
+
+} // namespace Ripes
@@ -0,0 +1,202 @@
+#include "cosimulator.h"
+
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <iostream>
+
+#include "simulationcontext.h"
+
+namespace Ripes {
+
+// Maximum number of cycles the reference model may execute without writing a
+// register, before it is considered to have diverged (e.g. stuck in a loop).
+static constexpr unsigned s_maxReferenceCyclesPerWrite = 100000;
+
+Cosimulator::Cosimulator(const CLIModeOptions &options,
+                         const std::shared_ptr<Program> &program,
+                         const QByteArray &input)
+    : m_options(options), m_program(program), m_input(input) {}
+
+Cosimulator::~Cosimulator() {}
+
+long long Cosimulator::cycles() const {
+  return m_target ? m_target->processor()->getCycleCount() : 0;
+}
+
+std::vector<Cosimulator::RegisterWrite>
+Cosimulator::readWrites(SimulationContext &context, std::vector<VInt> &state,
+                        AInt pc) {
+  std::vector<RegisterWrite> writes;
+  const auto *proc = context.processor();
+  // The registers of each register file are consecutive.
+  const RegisterFileHandle *file = nullptr;
+  for (unsigned i = 0; i < m_registers.size(); i++) {
+    const auto &reg = m_registers[i];
+    if (!file || file->rfid != reg.file)
+      file = &context.registerFile(reg.file);
+    const VInt value = file->valid() ? proc->readRegister(*file, reg.index)
+                                     : proc->getRegister(reg.file, reg.index);
+    if (value != state[i]) {
+      state[i] = value;
+      writes.push_back({i, value, pc});
+    }
+  }
+  return writes;
+}
+
+bool Cosimulator::nextReferenceWrite(RegisterWrite &write) {
+  unsigned cycles = 0;
+  auto *ref = m_reference->processor();
+  while (m_pendingReferenceWrites.empty()) {
+    if (ref->finished() || cycles++ == s_maxReferenceCyclesPerWrite)
+      return false;
+    const AInt pc = ref->getPcForStage({0, 0});
+    m_reference->clock();
+    for (const auto &w : readWrites(*m_reference, m_referenceState, pc))
+      m_pendingReferenceWrites.push_back(w);
+  }
+  write = m_pendingReferenceWrites.front();
+  m_pendingReferenceWrites.pop_front();
+  return true;
+}
+
+QString Cosimulator::registerName(unsigned reg) const {
+  const auto &r = m_registers.at(reg);
+  if (auto regInfo =
+          m_target->processor()->implementsISA()->regInfo(r.file);
+      regInfo.has_value()) {
+    const QString name = (*regInfo)->regName(r.index);
+    const QString alias = (*regInfo)->regAlias(r.index);
+    return alias == name ? name : name + " (" + alias + ")";
+  }
+  return QString(r.file.data()) + "[" + QString::number(r.index) + "]";
+}
+
+QString Cosimulator::divergenceReport(
+    const std::vector<RegisterWrite> &expected,
+    const std::vector<RegisterWrite> &actual) const {
+  const auto describe = [&](const RegisterWrite &w) {
+    return registerName(w.reg) + " = 0x" + QString::number(w.value, 16) +
+           " (PC 0x" + QString::number(w.pc, 16) + ")";
+  };
+
+  QString report = "Divergence from the reference model at cycle " +
+                   QString::number(cycles()) + ", after " +
+                   QString::number(m_comparedWrites) +
+                   " matching register writes.";
+  report += "\n  Processor model wrote:";
+  if (actual.empty())
+    report += "\n    nothing (processor model finished)";
+  for (const auto &w : actual)
+    report += "\n    " + describe(w);
+  report += "\n  Reference model wrote:";
+  if (expected.empty())
+    report += "\n    nothing (reference model finished or stalled)";
+  for (const auto &w : expected)
+    report += "\n    " + describe(w);
+  return report;
+}
+
+bool Cosimulator::openedFiles(QString &errorMessage) const {
+  if (m_target->openFiles().empty() && m_reference->openFiles().empty())
+    return false;
+  errorMessage = "Co-simulation does not support programs which open files, "
+                 "as both models would access them (at cycle " +
+                 QString::number(cycles()) + ")";
+  return true;
+}
+
+bool Cosimulator::run(QString &errorMessage) {
+  const auto &isa = ProcessorRegistry::getDescription(m_options.proc).isaInfo();
+  const ProcessorID referenceID =
+      isa.isa->bits() == 64 ? ProcessorID::RV64_SS : ProcessorID::RV32_SS;
+  if (isa.isa->isaID() !=
+      ProcessorRegistry::getDescription(referenceID).isaInfo().isa->isaID()) {
+    errorMessage = "Co-simulation is not supported for processor '" +
+                   enumToString<ProcessorID>(m_options.proc) + "'";
+    return false;
+  }
+
+  m_reference = std::make_unique<SimulationContext>(
+      referenceID, m_options.isaExtensions, m_options.regInit);
+  m_reference->loadProgram(m_program);
+  m_reference->putStdInData(m_input);
+  m_target = std::make_unique<SimulationContext>(
+      m_options.proc, m_options.isaExtensions, m_options.regInit);
+  m_target->loadProgram(m_program);
+  m_target->putStdInData(m_input);
+
+  auto *target = m_target->processor();
+  m_registers.clear();
+  for (const auto &regFile : target->implementsISA()->regInfos()) {
+    for (unsigned i = 0; i < regFile->regCnt(); i++)
+      m_registers.push_back({regFile->regFileName(), i});
+  }
+  m_targetState.resize(m_registers.size());
+  m_referenceState.resize(m_registers.size());
+  readWrites(*m_target, m_targetState, 0);
+  readWrites(*m_reference, m_referenceState, 0);
+
+  // Instructions commit their register writes in the last stage of the
+  // pipeline.
+  const StageIndex commitStage = {0, target->structure().at(0) - 1};
+
+  QElapsedTimer timer;
+  timer.start();
+  while (!target->finished()) {
+    if (m_options.timeout != 0 && timer.elapsed() > m_options.timeout) {
+      errorMessage = "Co-simulation did not finish within the specified "
+                     "timeout (" +
+                     QString::number(m_options.timeout) + " ms)";
+      return false;
+    }
+
+    const AInt pc = target->getPcForStage(commitStage);
+    m_target->clock();
+    // The processor model executes a system call before the reference, which
+    // only reaches it when matching the writes of the processor model. A file
+    // is thus opened by the processor model alone before being rejected.
+    if (openedFiles(errorMessage))
+      return false;
+    if (!m_target->output().isEmpty()) {
+      std::cout << m_target->output().toStdString();
+      std::flush(std::cout);
+      m_target->clearOutput();
+    }
+
+    // Each write of the reference must match a write of the processor model
+    // in this cycle, by register and value. The first write which does not is
+    // the divergence.
+    auto writes = readWrites(*m_target, m_targetState, pc);
+    std::vector<RegisterWrite> referenceWrites;
+    while (!writes.empty()) {
+      RegisterWrite refWrite;
+      if (!nextReferenceWrite(refWrite)) {
+        errorMessage = divergenceReport(referenceWrites, writes);
+        return false;
+      }
+      referenceWrites.push_back(refWrite);
+      auto it = std::find_if(writes.begin(), writes.end(), [&](const auto &w) {
+        return w.reg == refWrite.reg;
+      });
+      if (it == writes.end() || it->value != refWrite.value) {
+        errorMessage = divergenceReport(referenceWrites, writes);
+        return false;
+      }
+      writes.erase(it);
+      m_comparedWrites++;
+    }
+  }
+
+  // The reference must not write registers which the processor model never
+  // wrote before finishing.
+  RegisterWrite refWrite;
+  if (nextReferenceWrite(refWrite)) {
+    errorMessage = divergenceReport({refWrite}, {});
+    return false;
+  }
+  return true;
+}
+
+} // namespace Ripes
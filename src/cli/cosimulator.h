@@ -0,0 +1,88 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+
+#include <deque>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "assembler/program.h"
+#include "clioptions.h"
+
+namespace Ripes {
+
+class SimulationContext;
+
+/// The Cosimulator class executes a processor model in lockstep with the
+/// single-cycle reference model (RVSS). After each cycle of the processor
+/// model, the register writes which it committed are compared against the
+/// next register writes of the reference model, which is advanced as needed.
+/// Simulation stops at the first divergence: a reference write of a register
+/// which the processor model did not write, or wrote a different value to, or
+/// a reference write left once the processor model finished. Only the current
+/// register state of the two models is retained, such that memory use is
+/// independent of the length of the program.
+///
+/// Register writes which do not change the value of a register are not
+/// observable, and are thus not compared. Likewise, only the last of several
+/// writes of a register committed within a cycle is observable, such that
+/// processor models must not commit more than one write per register and
+/// cycle. Both models execute system calls, and read their console input from
+/// a copy of the same input; only the console output of the processor model is
+/// forwarded. Programs which open files are rejected, since the file system
+/// calls of both models would access the same files.
+class Cosimulator {
+public:
+  Cosimulator(const CLIModeOptions &options,
+              const std::shared_ptr<Program> &program,
+              const QByteArray &input = QByteArray());
+  ~Cosimulator();
+
+  /// Runs the processor model until it finishes, or until a divergence from
+  /// the reference model is detected. Returns false and sets @p errorMessage to
+  /// a report of the divergence on failure.
+  bool run(QString &errorMessage);
+
+  long long cycles() const;
+  long long comparedWrites() const { return m_comparedWrites; }
+
+private:
+  struct Register {
+    std::string_view file;
+    unsigned index;
+  };
+  struct RegisterWrite {
+    unsigned reg; // Index into m_registers
+    VInt value;
+    AInt pc;
+  };
+
+  /// Returns the register writes performed by @p context since @p state was
+  /// last updated, and updates @p state.
+  std::vector<RegisterWrite> readWrites(SimulationContext &context,
+                                        std::vector<VInt> &state, AInt pc);
+  /// Returns the next register write of the reference model, or false if the
+  /// reference model finished or stopped writing registers.
+  bool nextReferenceWrite(RegisterWrite &write);
+  QString divergenceReport(const std::vector<RegisterWrite> &expected,
+                           const std::vector<RegisterWrite> &actual) const;
+  QString registerName(unsigned reg) const;
+  /// Returns true and sets @p errorMessage if either model opened a file.
+  bool openedFiles(QString &errorMessage) const;
+
+  CLIModeOptions m_options;
+  std::shared_ptr<Program> m_program;
+  QByteArray m_input;
+  std::unique_ptr<SimulationContext> m_reference;
+  std::unique_ptr<SimulationContext> m_target;
+
+  std::vector<Register> m_registers;
+  std::vector<VInt> m_referenceState;
+  std::vector<VInt> m_targetState;
+  std::deque<RegisterWrite> m_pendingReferenceWrites;
+  long long m_comparedWrites = 0;
+};
+
+} // namespace Ripes
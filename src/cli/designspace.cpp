@@ -0,0 +1,545 @@
+#include "designspace.h"
+#include "assembler/assembler.h"
+#include "binutils.h"
+#include "cachesim/cachesweep.h"
+#include "processorpool.h"
+#include "simulationcontext.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QTextStream>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <limits>
+
+namespace Ripes {
+
+// Default cost of the processor models, by microarchitecture, for a 32-bit
+// datapath. A 64-bit datapath costs s_rv64Cost times as much.
+static const std::map<QString, double> s_processorCosts{
+    {"SS", 1.0},         {"5S_NO_FW_HZ", 1.3}, {"5S_NO_HZ", 1.4},
+    {"5S_NO_FW", 1.4},   {"5S", 1.5},          {"5S_BP_BTFN", 1.6},
+    {"5S_BP_1BIT", 1.7}, {"5S_BP_2BIT", 1.8},  {"5S_BP_GSHARE", 2.0},
+    {"6S_DUAL", 2.8},    {"3S_GEN", 1.2},      {"5S_GEN", 1.5},
+    {"7S_GEN", 1.7},     {"9S_GEN", 1.9},      {"OOO_2W", 5.0},
+    {"OOO_4W", 9.0},     {"ISS", 1.0},         {"MH_2", 2.0},
+    {"MH_4", 4.0}};
+static constexpr double s_rv64Cost = 1.5;
+// Default cost of the ISA extensions; other extensions cost
+// s_defaultExtensionCost.
+static const std::map<QString, double> s_extensionCosts{
+    {"M", 0.4}, {"A", 0.1}, {"C", 0.2}, {"F", 1.0}, {"D", 1.5}, {"V", 3.0}};
+static constexpr double s_defaultExtensionCost = 0.1;
+
+static const QStringList s_predictors{"none", "btfn", "1bit", "2bit",
+                                      "gshare"};
+
+/// Returns the data capacity of a cache of @p preset in KiB.
+static double capacityKiB(const CachePreset &preset) {
+  return static_cast<double>(4ull << (preset.blocks + preset.lines +
+                                      preset.ways)) /
+         1024;
+}
+
+/// Returns the misses of the geometry of @p preset within @p results.
+static long long misses(const std::vector<CacheSweep::Result> &results,
+                        const CachePreset &preset) {
+  for (const auto &result : results) {
+    if (result.blocks == preset.blocks && result.lines == preset.lines &&
+        result.ways == preset.ways)
+      return result.misses;
+  }
+  return 0;
+}
+
+struct DesignSpaceExplorer::Run {
+  ProcessorID id;
+  QStringList extensions;
+  size_t workload = 0;
+  std::shared_ptr<Program> program;
+  std::unique_ptr<SimulationContext> context;
+  QString status;
+  QStringList errors;
+  long long cycles = 0;
+  long long instructions = 0;
+  // Misses of the swept L1 geometries, as given by CacheSweep::results.
+  std::vector<CacheSweep::Result> instrMisses;
+  std::vector<CacheSweep::Result> dataMisses;
+};
+
+DesignSpaceExplorer::DesignSpaceExplorer(const CLIModeOptions &options)
+    : m_options(options) {}
+
+std::vector<bool>
+DesignSpaceExplorer::paretoFront(const std::vector<double> &cost,
+                                 const std::vector<long long> &cycles) {
+  std::vector<bool> front(cost.size(), true);
+  for (size_t i = 0; i < cost.size(); ++i) {
+    for (size_t j = 0; j < cost.size() && front.at(i); ++j) {
+      front.at(i) = !(cost.at(j) <= cost.at(i) &&
+                      cycles.at(j) <= cycles.at(i) &&
+                      (cost.at(j) < cost.at(i) || cycles.at(j) < cycles.at(i)));
+    }
+  }
+  return front;
+}
+
+bool DesignSpaceExplorer::parseSpecification(QString &errorMessage) {
+  QFile file(m_options.dse);
+  if (!file.open(QIODevice::ReadOnly)) {
+    errorMessage = "Failed to open design space specification '" +
+                   m_options.dse + "'";
+    return false;
+  }
+  QJsonParseError parseError;
+  const auto doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+  if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+    errorMessage = "Invalid design space specification: expected a JSON "
+                   "object";
+    return false;
+  }
+  const QJsonObject spec = doc.object();
+  const auto strings = [&](const QString &key) {
+    QStringList values;
+    for (const auto &value : spec.value(key).toArray())
+      values << value.toString();
+    return values;
+  };
+
+  // Workloads are given relative to the specification.
+  const QDir dir = QFileInfo(m_options.dse).dir();
+  for (const auto &name : strings("workloads")) {
+    QFile source(dir.filePath(name));
+    if (!source.open(QIODevice::ReadOnly)) {
+      errorMessage = "Failed to open workload '" + name + "'";
+      return false;
+    }
+    m_workloads.push_back({name, QString::fromUtf8(source.readAll())});
+  }
+  if (m_workloads.empty()) {
+    errorMessage = "No workloads specified in the design space specification";
+    return false;
+  }
+
+  const QStringList predictors =
+      spec.contains("predictors") ? strings("predictors") : QStringList();
+  for (const auto &predictor : predictors) {
+    if (!s_predictors.contains(predictor)) {
+      errorMessage = "Invalid branch predictor '" + predictor +
+                     "'. Expected any of [" + s_predictors.join(", ") + "].";
+      return false;
+    }
+  }
+  // A processor model is explored with each of the predictors of its
+  // variants with branch prediction (as in RV32_5S_BP_GSHARE), if any.
+  std::vector<ProcessorID> processors;
+  for (const auto &name : strings("processors")) {
+    ProcessorID id;
+    if (!parseProcessorID(name, id, errorMessage)) {
+      errorMessage =
+          "Invalid processor model '" + name + "' in the design space "
+          "specification";
+      return false;
+    }
+    std::vector<ProcessorID> variants;
+    for (const auto &predictor : predictors) {
+      ProcessorID variant;
+      QString ignored;
+      if (predictor == "none")
+        variants.push_back(id);
+      else if (parseProcessorID(name + "_BP_" + predictor.toUpper(), variant,
+                                ignored))
+        variants.push_back(variant);
+    }
+    if (variants.empty())
+      variants.push_back(id);
+    for (auto variant : variants) {
+      if (std::find(processors.begin(), processors.end(), variant) ==
+          processors.end())
+        processors.push_back(variant);
+    }
+  }
+  if (processors.empty()) {
+    errorMessage =
+        "No processors specified in the design space specification";
+    return false;
+  }
+
+  // Sets of extensions, or the default extensions of each processor.
+  std::vector<std::optional<QStringList>> extensionSets;
+  for (const auto &set : strings("extensions"))
+    extensionSets.push_back(set.isEmpty() ? QStringList() : set.split(","));
+  if (extensionSets.empty())
+    extensionSets.push_back(std::nullopt);
+
+  std::vector<std::optional<CacheGeometry>> caches;
+  for (const auto &geometry : strings("caches")) {
+    if (geometry == "none") {
+      caches.push_back(std::nullopt);
+      continue;
+    }
+    const QStringList specs = geometry.split(",");
+    CacheGeometry levels;
+    if (specs.size() != 2 || !parseCacheConfig(specs.at(0), levels.l1i) ||
+        !parseCacheConfig(specs.at(1), levels.l1d)) {
+      errorMessage = "Invalid cache geometry '" + geometry +
+                     "'. Expected none or l1i,l1d, as in --caches.";
+      return false;
+    }
+    if (levels.l1i.replPolicy != ReplPolicy::LRU ||
+        levels.l1d.replPolicy != ReplPolicy::LRU) {
+      errorMessage = "Invalid cache geometry '" + geometry +
+                     "': caches are explored with LRU replacement";
+      return false;
+    }
+    caches.push_back(levels);
+  }
+  if (caches.empty())
+    caches.push_back(std::nullopt);
+
+  std::vector<unsigned> latencies;
+  for (const auto &value : spec.value("memoryLatency").toArray()) {
+    if (value.toInt(-1) < 0) {
+      errorMessage = "Invalid memory latency in the design space "
+                     "specification";
+      return false;
+    }
+    latencies.push_back(value.toInt());
+  }
+  if (latencies.empty())
+    latencies.push_back(CacheHierarchyConfig().memoryLatency);
+
+  if (spec.contains("maxCycles")) {
+    m_maxCycles = spec.value("maxCycles").toInteger(-1);
+    if (m_maxCycles <= 0) {
+      errorMessage = "Invalid maxCycles in the design space specification";
+      return false;
+    }
+  }
+
+  const QJsonObject costs = spec.value("cost").toObject();
+  const QJsonObject processorCosts = costs.value("processors").toObject();
+  for (auto it = processorCosts.begin(); it != processorCosts.end(); ++it)
+    m_processorCosts[it.key()] = it.value().toDouble();
+  const QJsonObject extensionCosts = costs.value("extensions").toObject();
+  for (auto it = extensionCosts.begin(); it != extensionCosts.end(); ++it)
+    m_extensionCosts[it.key()] = it.value().toDouble();
+  m_cacheKiBCost = costs.value("cacheKiB").toDouble(m_cacheKiBCost);
+
+  // Sets of extensions which a processor does not support are skipped, and
+  // memory latencies only apply to designs with caches.
+  for (auto id : processors) {
+    for (const auto &set : extensionSets) {
+      const QStringList extensions =
+          set.value_or(ProcessorRegistry::getDescription(id)
+                           .isaInfo()
+                           .defaultExtensions);
+      QString ignored;
+      if (!validateISAExtensions(id, extensions, ignored))
+        continue;
+      for (const auto &geometry : caches) {
+        for (unsigned latency : latencies) {
+          Design design{id, extensions, geometry, geometry ? latency : 0};
+          design.cost = cost(design);
+          m_designs.push_back(design);
+          if (!geometry)
+            break;
+        }
+      }
+    }
+  }
+  if (m_designs.empty()) {
+    errorMessage = "The design space specification has no designs with "
+                   "supported extensions";
+    return false;
+  }
+  return true;
+}
+
+double DesignSpaceExplorer::cost(const Design &design) const {
+  const QString name = enumToString<ProcessorID>(design.id);
+  // Strip the "RV32_" or "RV64_" prefix.
+  const QString microarchitecture = name.mid(5);
+  double cost = 0;
+  if (auto it = m_processorCosts.find(name); it != m_processorCosts.end()) {
+    cost = it->second;
+  } else {
+    if (auto it = m_processorCosts.find(microarchitecture);
+        it != m_processorCosts.end())
+      cost = it->second;
+    else if (auto it = s_processorCosts.find(microarchitecture);
+             it != s_processorCosts.end())
+      cost = it->second;
+    if (name.startsWith("RV64"))
+      cost *= s_rv64Cost;
+  }
+
+  for (const auto &ext : design.extensions) {
+    if (auto it = m_extensionCosts.find(ext); it != m_extensionCosts.end())
+      cost += it->second;
+    else if (auto it = s_extensionCosts.find(ext);
+             it != s_extensionCosts.end())
+      cost += it->second;
+    else
+      cost += s_defaultExtensionCost;
+  }
+  if (design.caches)
+    cost += m_cacheKiBCost * (capacityKiB(design.caches->l1i) +
+                              capacityKiB(design.caches->l1d));
+  return cost;
+}
+
+std::vector<DesignSpaceExplorer::Run>
+DesignSpaceExplorer::prepareRuns() const {
+  // Workloads are assembled once per ISA, on the calling thread.
+  std::map<QString, std::shared_ptr<Assembler::AssemblerBase>> assemblers;
+  std::vector<Run> runs;
+  for (const auto &design : m_designs) {
+    const bool simulated =
+        std::any_of(runs.begin(), runs.end(), [&](const Run &run) {
+          return run.id == design.id && run.extensions == design.extensions;
+        });
+    if (simulated)
+      continue;
+
+    auto processor = ProcessorPool::get().acquire(design.id, design.extensions);
+    const auto isa = processor->fullISA();
+    ProcessorPool::get().release(design.id, design.extensions,
+                                 std::move(processor));
+    QStringList extensions = design.extensions;
+    extensions.sort();
+    const QString isaKey =
+        QString::number(static_cast<int>(isa->isaID())) + extensions.join("");
+    auto &assembler = assemblers[isaKey];
+    if (!assembler)
+      assembler = Assembler::constructAssemblerDynamic(isa);
+
+    for (size_t i = 0; i < m_workloads.size(); ++i) {
+      Run run;
+      run.id = design.id;
+      run.extensions = design.extensions;
+      run.workload = i;
+      auto res = assembler->assembleRaw(m_workloads.at(i).source);
+      if (res.errors.empty()) {
+        run.program = std::make_shared<Program>(res.program);
+      } else {
+        run.status = "failed";
+        for (const auto &err : res.errors)
+          run.errors << err.errorMessage();
+      }
+      runs.push_back(std::move(run));
+    }
+  }
+  return runs;
+}
+
+void DesignSpaceExplorer::simulate(Run &run) const {
+  auto *processor = run.context->processor();
+  // Sweep the L1 geometries of all designs with caches.
+  std::array<CacheSweep::Range, 3> instrRanges, dataRanges;
+  bool sweep = false;
+  for (const auto &design : m_designs) {
+    if (!design.caches)
+      continue;
+    for (auto [ranges, preset] :
+         {std::pair{&instrRanges, &design.caches->l1i},
+          std::pair{&dataRanges, &design.caches->l1d}}) {
+      const std::array<int, 3> values = {preset->blocks, preset->lines,
+                                         preset->ways};
+      for (size_t i = 0; i < values.size(); ++i) {
+        auto &range = ranges->at(i);
+        range.min = sweep ? std::min(range.min, values.at(i)) : values.at(i);
+        range.max = sweep ? std::max(range.max, values.at(i)) : values.at(i);
+      }
+    }
+    sweep = true;
+  }
+  std::optional<CacheSweep> instrCache, dataCache;
+  if (sweep) {
+    const unsigned byteOffset =
+        log2Ceil(processor->implementsISA()->bytes());
+    instrCache.emplace(byteOffset, instrRanges.at(0), instrRanges.at(1),
+                       instrRanges.at(2));
+    dataCache.emplace(byteOffset, dataRanges.at(0), dataRanges.at(1),
+                      dataRanges.at(2));
+  }
+
+  const auto observer = [&] {
+    if (!sweep)
+      return;
+    for (const auto &record : processor->clockBatch()) {
+      if (record.instrAccess.type == MemoryAccess::Read)
+        instrCache->access(record.instrAccess.address);
+      if (record.dataAccess.type != MemoryAccess::None)
+        dataCache->access(record.dataAccess.address);
+    }
+  };
+  const bool finished = run.context->runUntil(
+      [&] { return processor->getCycleCount() >= m_maxCycles; }, observer);
+
+  run.cycles = processor->getCycleCount();
+  run.instructions = processor->getInstructionsRetired();
+  run.status = finished                     ? "ok"
+               : run.cycles >= m_maxCycles ? "cycle limit"
+                                           : "failed";
+  if (sweep) {
+    run.instrMisses = instrCache->results();
+    run.dataMisses = dataCache->results();
+  }
+}
+
+int DesignSpaceExplorer::run() {
+  QString errorMessage;
+  if (!parseSpecification(errorMessage)) {
+    std::cerr << "ERROR: " << errorMessage.toStdString() << std::endl;
+    return 1;
+  }
+
+  std::vector<Run> runs = prepareRuns();
+  // Runs are simulated in waves, such that the processors of a large design
+  // space are not all held at once.
+  QThreadPool pool;
+  const size_t wave = std::max(1, pool.maxThreadCount()) * 2;
+  for (size_t first = 0; first < runs.size(); first += wave) {
+    const size_t last = std::min(runs.size(), first + wave);
+    for (size_t i = first; i < last; ++i) {
+      auto &run = runs.at(i);
+      if (!run.program)
+        continue;
+      run.context =
+          std::make_unique<SimulationContext>(run.id, run.extensions);
+      run.context->loadProgram(std::make_shared<Program>(*run.program));
+      pool.start([this, &run] { simulate(run); });
+    }
+    pool.waitForDone();
+    for (size_t i = first; i < last; ++i)
+      runs.at(i).context.reset();
+  }
+
+  std::vector<QJsonObject> designs;
+  std::vector<double> costs;
+  std::vector<long long> cycles;
+  for (const auto &design : m_designs) {
+    QJsonObject result;
+    result["processor"] = enumToString<ProcessorID>(design.id);
+    result["extensions"] = design.extensions.join(",");
+    result["caches"] = design.caches ? design.caches->l1i.name + "," +
+                                           design.caches->l1d.name
+                                     : "none";
+    if (design.caches)
+      result["memoryLatency"] = static_cast<int>(design.memoryLatency);
+    result["cost"] = design.cost;
+
+    QJsonArray workloads;
+    long long totalCycles = 0, totalInstructions = 0;
+    bool success = true;
+    for (const auto &run : runs) {
+      if (run.id != design.id || run.extensions != design.extensions)
+        continue;
+      QJsonObject workload;
+      workload["name"] = m_workloads.at(run.workload).name;
+      workload["status"] = run.status;
+      long long runCycles = run.cycles;
+      if (design.caches) {
+        const long long instrMisses =
+            misses(run.instrMisses, design.caches->l1i);
+        const long long dataMisses =
+            misses(run.dataMisses, design.caches->l1d);
+        workload["l1i misses"] = instrMisses;
+        workload["l1d misses"] = dataMisses;
+        runCycles += (instrMisses + dataMisses) * design.memoryLatency;
+      }
+      workload["cycles"] = runCycles;
+      workload["instructions"] = run.instructions;
+      if (!run.errors.isEmpty())
+        workload["errors"] = QJsonArray::fromStringList(run.errors);
+      workloads.append(workload);
+      totalCycles += runCycles;
+      totalInstructions += run.instructions;
+      success &= run.status == "ok";
+    }
+    result["workloads"] = workloads;
+    result["cycles"] = totalCycles;
+    result["instructions"] = totalInstructions;
+    result["status"] = success ? "ok" : "failed";
+    designs.push_back(result);
+    // Failed designs are kept off the Pareto front.
+    costs.push_back(design.cost);
+    cycles.push_back(success ? totalCycles
+                             : std::numeric_limits<long long>::max());
+  }
+
+  const auto front = paretoFront(costs, cycles);
+  for (size_t i = 0; i < designs.size(); ++i)
+    designs.at(i)["pareto"] =
+        front.at(i) && designs.at(i).value("status").toString() == "ok";
+  return writeReport(designs);
+}
+
+int DesignSpaceExplorer::writeReport(
+    const std::vector<QJsonObject> &designs) const {
+  QString out;
+  QTextStream stream(&out);
+  if (m_options.jsonOutput) {
+    QJsonArray workloads, array;
+    for (const auto &workload : m_workloads)
+      workloads.append(workload.name);
+    for (const auto &design : designs)
+      array.append(design);
+    stream << QJsonDocument(QJsonObject{{"workloads", workloads},
+                                        {"designs", array}})
+                  .toJson(QJsonDocument::Indented);
+  } else {
+    stream << qSetFieldWidth(20) << Qt::left << "processor"
+           << qSetFieldWidth(12) << "extensions" << qSetFieldWidth(20)
+           << "caches" << qSetFieldWidth(10) << Qt::right << "latency"
+           << "cost" << qSetFieldWidth(14) << "cycles" << "instructions"
+           << qSetFieldWidth(0) << "  pareto\n";
+    unsigned paretoDesigns = 0;
+    for (const auto &design : designs) {
+      const bool pareto = design.value("pareto").toBool();
+      paretoDesigns += pareto;
+      stream << qSetFieldWidth(20) << Qt::left
+             << design.value("processor").toString() << qSetFieldWidth(12)
+             << design.value("extensions").toString() << qSetFieldWidth(20)
+             << design.value("caches").toString() << qSetFieldWidth(10)
+             << Qt::right
+             << (design.contains("memoryLatency")
+                     ? QString::number(design.value("memoryLatency").toInt())
+                     : QString("-"))
+             << QString::number(design.value("cost").toDouble(), 'f', 2)
+             << qSetFieldWidth(14) << design.value("cycles").toInteger()
+             << design.value("instructions").toInteger() << qSetFieldWidth(0);
+      if (pareto)
+        stream << "  *";
+      else if (design.value("status").toString() != "ok")
+        stream << "  (failed)";
+      stream << "\n";
+    }
+    stream << "\n"
+           << paretoDesigns << " of " << designs.size()
+           << " designs on the Pareto front of cycles versus cost\n";
+  }
+  stream.flush();
+
+  if (m_options.outputFile.isEmpty()) {
+    std::cout << out.toStdString() << std::flush;
+  } else {
+    QFile outputFile(m_options.outputFile);
+    if (!outputFile.open(QIODevice::Truncate | QIODevice::Text |
+                         QIODevice::WriteOnly)) {
+      std::cerr << "ERROR: Failed to open output file" << std::endl;
+      return 1;
+    }
+    outputFile.write(out.toUtf8());
+  }
+  return 0;
+}
+
+} // namespace Ripes
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "clioptions.h"
+#include <QJsonObject>
+
+#include <map>
+#include <optional>
+
+namespace Ripes {
+
+/// The DesignSpaceExplorer class runs a set of workloads on every design of a
+/// grid of processor models, ISA extensions, branch predictors, L1 cache
+/// geometries and memory latencies (--dse), and reports the cycles and the
+/// modelled hardware cost of each design, marking the designs on the Pareto
+/// front of cycles versus cost.
+///
+/// Each workload is simulated once per processor model and set of extensions,
+/// on a pool of threads, one per core, each simulating an independent
+/// SimulationContext. The L1 caches of all geometries are evaluated from a
+/// single pass over the memory accesses of a run through CacheSweep, such that
+/// cache geometries and memory latencies add no runs. Cache misses stall the
+/// processor for the memory latency, estimated as for CacheHierarchy, with L1
+/// hits pipelined.
+///
+/// The hardware cost of a design is the sum of the cost of its processor model
+/// and ISA extensions, and of the capacity of its caches, in arbitrary units;
+/// the default costs may be overridden by the specification.
+class DesignSpaceExplorer {
+public:
+  DesignSpaceExplorer(const CLIModeOptions &options);
+
+  /// Runs the workloads of the specification on every design and writes the
+  /// report. Returns non-zero if the specification is invalid or the report
+  /// could not be written.
+  int run();
+
+  /// The split L1 caches of a design.
+  struct CacheGeometry {
+    CachePreset l1i;
+    CachePreset l1d;
+  };
+
+  struct Design {
+    ProcessorID id;
+    QStringList extensions;
+    std::optional<CacheGeometry> caches;
+    unsigned memoryLatency = 0;
+    double cost = 0;
+  };
+
+  /// Returns, for each of the designs of @p cost and @p cycles, whether no
+  /// other design has a lower or equal cost and cycles, one of which strictly
+  /// lower.
+  static std::vector<bool> paretoFront(const std::vector<double> &cost,
+                                       const std::vector<long long> &cycles);
+
+private:
+  struct Workload {
+    QString name;
+    QString source;
+  };
+  /// A workload simulated on a processor model with a set of extensions.
+  struct Run;
+
+  /// Parses the specification, and expands its grid into m_designs.
+  bool parseSpecification(QString &errorMessage);
+  double cost(const Design &design) const;
+  std::vector<Run> prepareRuns() const;
+  void simulate(Run &run) const;
+  int writeReport(const std::vector<QJsonObject> &designs) const;
+
+  CLIModeOptions m_options;
+  std::vector<Workload> m_workloads;
+  std::vector<Design> m_designs;
+  long long m_maxCycles = 100000000;
+  // Cost overrides of the specification, by processor model (or its
+  // microarchitecture, as in "5S_BP_GSHARE") and by extension.
+  std::map<QString, double> m_processorCosts;
+  std::map<QString, double> m_extensionCosts;
+  double m_cacheKiBCost = 0.25;
+};
+
+} // namespace Ripes
@@ -0,0 +1,211 @@
+#include "energy.h"
+#include "processorhandler.h"
+#include "roofline.h"
+
+#include <QRegularExpression>
+#include <QTextStream>
+
+#include <map>
+
+namespace Ripes {
+
+static QString mnemonicOf(const QString &instr) {
+  const QString mnemonic =
+      instr.section(' ', 0, 0, QString::SectionSkipEmpty).toLower();
+  return mnemonic.startsWith("c.") ? mnemonic.mid(2) : mnemonic;
+}
+
+bool EnergyModel::set(const QString &name, double picojoules) {
+  static const std::map<QString, double EnergyModel::*> s_costs{
+      {"alu", &EnergyModel::alu},         {"muldiv", &EnergyModel::muldiv},
+      {"fp", &EnergyModel::fp},           {"vector", &EnergyModel::vector},
+      {"load", &EnergyModel::load},       {"store", &EnergyModel::store},
+      {"control", &EnergyModel::control}, {"system", &EnergyModel::system},
+      {"reg", &EnergyModel::reg},         {"l1", &EnergyModel::l1},
+      {"l1miss", &EnergyModel::l1Miss},   {"l2", &EnergyModel::l2},
+      {"l2miss", &EnergyModel::l2Miss},   {"dram", &EnergyModel::dram},
+      {"static", &EnergyModel::staticPower}};
+  auto it = s_costs.find(name);
+  if (it == s_costs.end())
+    return false;
+  this->*(it->second) = picojoules;
+  return true;
+}
+
+QString EnergyEstimate::className(InstrClass c) {
+  static const std::array<QString, NClasses> s_names{
+      "alu", "muldiv", "fp", "vector", "load", "store", "control", "system"};
+  return s_names.at(c);
+}
+
+EnergyEstimate::InstrClass EnergyEstimate::classify(const QString &instr) {
+  const QString mnemonic = mnemonicOf(instr);
+  switch (Roofline::classify(instr)) {
+  case Roofline::InstrClass::Memory:
+    // Store-conditionals write a register, as loads do.
+    return (mnemonic.startsWith("s") && !mnemonic.startsWith("sc.")) ||
+                   mnemonic.startsWith("fs") || mnemonic.startsWith("vs")
+               ? Store
+               : Load;
+  case Roofline::InstrClass::Control:
+    return Control;
+  case Roofline::InstrClass::System:
+    return System;
+  case Roofline::InstrClass::Operation:
+    break;
+  }
+  if (mnemonic.startsWith("mul") || mnemonic.startsWith("div") ||
+      mnemonic.startsWith("rem"))
+    return MulDiv;
+  if (mnemonic.startsWith("f"))
+    return FP;
+  if (mnemonic.startsWith("v"))
+    return Vector;
+  return ALU;
+}
+
+std::pair<unsigned, unsigned>
+EnergyEstimate::registerAccesses(const QString &instr,
+                                 const ISAInfoBase &isa) {
+  static const QRegularExpression s_separators("[\\s,()]+");
+  const QStringList operands =
+      instr.split(s_separators, Qt::SkipEmptyParts).mid(1);
+  std::vector<bool> writable;
+  for (const auto &operand : operands) {
+    for (const auto &regInfo : isa.regInfos()) {
+      bool isRegister = false;
+      const unsigned index = regInfo->regNumber(operand, isRegister);
+      if (isRegister) {
+        writable.push_back(!regInfo->regIsReadOnly(index));
+        break;
+      }
+    }
+  }
+  if (writable.empty())
+    return {0, 0};
+
+  const InstrClass c = classify(instr);
+  const bool branch = c == Control && mnemonicOf(instr).startsWith("b");
+  if (c == Store || branch)
+    return {writable.size(), 0};
+  return {writable.size() - 1, writable.front() ? 1 : 0};
+}
+
+EnergyEstimate::EnergyEstimate(const EnergyModel &model,
+                               const Profiler &profiler,
+                               CacheHierarchy *caches)
+    : m_cycles(profiler.totalCycles()), m_caches(caches != nullptr) {
+  std::array<long long, NClasses> retired{};
+  long long regAccesses = 0;
+  if (const auto *profile = profiler.profile()) {
+    const auto &disassembled = profiler.program()->getDisassembled();
+    const auto &isa = *ProcessorHandler::currentISA();
+    for (size_t i = 0; i < profile->retired.size(); ++i) {
+      const long long count = profile->retired.at(i);
+      if (count == 0)
+        continue;
+      const QString instr =
+          disassembled.getFromAddr(profile->address(i)).value_or(QString());
+      retired[classify(instr)] += count;
+      const auto [reads, writes] = registerAccesses(instr, isa);
+      regAccesses += count * (reads + writes);
+      m_instructions += count;
+    }
+  }
+
+  const std::array<double, NClasses> costs{
+      model.alu,   model.muldiv, model.fp,      model.vector,
+      model.load,  model.store,  model.control, model.system};
+  for (int c = 0; c < NClasses; ++c)
+    m_components.push_back(
+        {className(InstrClass(c)), retired[c], retired[c] * costs[c]});
+  m_components.push_back(
+      {"register file", regAccesses, regAccesses * model.reg});
+
+  if (caches) {
+    const auto cacheComponent = [](const QString &name, const CacheSim &cache,
+                                   double access, double miss) {
+      const long long accesses = cache.getHits() + cache.getMisses();
+      return Component{name, accesses,
+                       accesses * access + cache.getMisses() * miss};
+    };
+    m_components.push_back(
+        cacheComponent("L1I", caches->l1i(), model.l1, model.l1Miss));
+    m_components.push_back(
+        cacheComponent("L1D", caches->l1d(), model.l1, model.l1Miss));
+    if (const auto *l2 = caches->l2())
+      m_components.push_back(cacheComponent("L2", *l2, model.l2, model.l2Miss));
+
+    long long memoryAccesses = 0;
+    if (const auto *dram = caches->dram()) {
+      memoryAccesses = dram->reads() + dram->writes();
+    } else {
+      std::vector<const CacheSim *> lastLevels = {&caches->l1i(),
+                                                  &caches->l1d()};
+      if (const auto *l2 = caches->l2())
+        lastLevels = {l2};
+      for (const auto *cache : lastLevels)
+        memoryAccesses += cache->getMisses() + cache->getWritebacks();
+    }
+    m_components.push_back(
+        {"DRAM", memoryAccesses, memoryAccesses * model.dram});
+  }
+
+  m_components.push_back({"static", m_cycles, m_cycles * model.staticPower});
+}
+
+double EnergyEstimate::energy() const {
+  double energy = 0;
+  for (const auto &component : m_components)
+    energy += component.energy;
+  return energy;
+}
+
+double EnergyEstimate::energyPerInstruction() const {
+  return m_instructions == 0 ? 0.0 : energy() / m_instructions;
+}
+
+QVariant EnergyEstimate::report(bool json) const {
+  const double total = energy();
+  const auto share = [&](double energy) {
+    return total == 0 ? 0.0 : energy / total;
+  };
+
+  if (json) {
+    QVariantMap components;
+    for (const auto &component : m_components) {
+      QVariantMap m;
+      m["events"] = component.events;
+      m["energy (pJ)"] = component.energy;
+      m["share"] = share(component.energy);
+      components[component.name] = m;
+    }
+    QVariantMap m;
+    m["components"] = components;
+    m["energy (pJ)"] = total;
+    m["energy per instruction (pJ)"] = energyPerInstruction();
+    m["energy-delay product (pJ*cycles)"] = energyDelayProduct();
+    return m;
+  }
+
+  QString out;
+  QTextStream stream(&out);
+  stream << "Estimated " << QString::number(total, 'f', 1) << " pJ, "
+         << QString::number(energyPerInstruction(), 'f', 2)
+         << " pJ/instruction, energy-delay product "
+         << QString::number(energyDelayProduct(), 'g', 6) << " pJ*cycles\n";
+  if (!m_caches)
+    stream << "(the caches and main memory are not estimated without "
+              "--caches)\n";
+  stream << "\n"
+         << qSetFieldWidth(14) << Qt::left << "component" << Qt::right
+         << "events" << "energy (pJ)" << "%" << qSetFieldWidth(0) << "\n";
+  for (const auto &component : m_components)
+    stream << qSetFieldWidth(14) << Qt::left << component.name << Qt::right
+           << component.events << QString::number(component.energy, 'f', 1)
+           << QString::number(share(component.energy) * 100, 'f', 2)
+           << qSetFieldWidth(0) << "\n";
+  return out;
+}
+
+} // namespace Ripes
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <QString>
+#include <QVariant>
+
+#include <array>
+#include <utility>
+#include <vector>
+
+#include "cachesim/cachehierarchy.h"
+#include "isa/isainfo.h"
+#include "profiler.h"
+
+namespace Ripes {
+
+/// Energy costs of the events of a run, in picojoules. The defaults are of the
+/// order of magnitude of a small in-order core with SRAM caches and an
+/// off-chip DRAM, where a DRAM access costs far more than any instruction.
+struct EnergyModel {
+  // Per retired instruction of each class (see EnergyEstimate::classify).
+  double alu = 1;
+  double muldiv = 3;
+  double fp = 4;
+  double vector = 8;
+  double load = 1;
+  double store = 1;
+  double control = 1;
+  double system = 1;
+  // Per register file read or write.
+  double reg = 0.5;
+  // Per access of a cache of each level, and additionally per miss.
+  double l1 = 10;
+  double l1Miss = 5;
+  double l2 = 40;
+  double l2Miss = 10;
+  // Per read or write of main memory.
+  double dram = 640;
+  // Per cycle.
+  double staticPower = 5;
+
+  /// Sets the cost named @p name; one of alu, muldiv, fp, vector, load,
+  /// store, control, system, reg, l1, l1miss, l2, l2miss, dram and static.
+  /// Returns false for an unknown name.
+  bool set(const QString &name, double picojoules);
+};
+
+/// The EnergyEstimate class estimates the energy of a run from the events
+/// counted by a Profiler and a CacheHierarchy, and an EnergyModel:
+/// - the retired instructions of each class, classified by their mnemonic,
+/// - the register file reads and writes of the retired instructions, as the
+///   register operands of each instruction,
+/// - the accesses and misses of each cache of the hierarchy,
+/// - the reads and writes of main memory; the accesses of the DRAM model, or
+///   otherwise the misses and writebacks of the last cache level,
+/// - and static power in every cycle.
+/// Without a cache hierarchy, the energy of the caches and main memory is not
+/// estimated. The energy-delay product is the energy times the cycles of the
+/// run.
+class EnergyEstimate {
+public:
+  enum InstrClass {
+    ALU,
+    MulDiv,
+    FP,
+    Vector,
+    Load,
+    Store,
+    Control,
+    System,
+    NClasses
+  };
+  static QString className(InstrClass c);
+
+  /// Classifies the disassembled instruction @p instr by its mnemonic.
+  static InstrClass classify(const QString &instr);
+  /// Returns the register file reads and writes of the disassembled
+  /// instruction @p instr; each register operand is read, except for the
+  /// first operand of instructions other than stores and branches, which is
+  /// written. Writes to read-only registers are not counted.
+  static std::pair<unsigned, unsigned> registerAccesses(const QString &instr,
+                                                        const ISAInfoBase &isa);
+
+  EnergyEstimate(const EnergyModel &model, const Profiler &profiler,
+                 CacheHierarchy *caches);
+
+  struct Component {
+    QString name;
+    long long events = 0;
+    double energy = 0;
+  };
+  /// The energy of each instruction class, the register file, each cache
+  /// level, main memory and static power, in picojoules.
+  const std::vector<Component> &components() const { return m_components; }
+
+  double energy() const;
+  long long cycles() const { return m_cycles; }
+  long long instructions() const { return m_instructions; }
+  double energyPerInstruction() const;
+  double energyDelayProduct() const { return energy() * m_cycles; }
+
+  /// Returns the energy of each component, the total energy, the energy per
+  /// instruction and the energy-delay product as a table, or a map thereof if
+  /// @p json is set.
+  QVariant report(bool json) const;
+
+private:
+  std::vector<Component> m_components;
+  long long m_cycles = 0;
+  long long m_instructions = 0;
+  bool m_caches = false;
+};
+
+} // namespace Ripes
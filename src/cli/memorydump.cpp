@@ -0,0 +1,127 @@
+#include "memorydump.h"
+
+#include <QByteArray>
+
+#include <algorithm>
+
+#include "memoryblock.h"
+
+namespace Ripes {
+
+std::optional<MemoryDump::Region>
+MemoryDump::parseRegion(const QString &spec) {
+  const int separator = spec.lastIndexOf(':');
+  if (separator <= 0)
+    return {};
+  bool ok;
+  Region region;
+  region.start = spec.left(separator).trimmed();
+  region.bytes = spec.mid(separator + 1).toULongLong(&ok, 0);
+  if (!ok || region.bytes == 0)
+    return {};
+  return region;
+}
+
+std::optional<MemoryDump::Format>
+MemoryDump::parseFormat(const QString &format) {
+  if (format == "bin")
+    return Format::Binary;
+  if (format == "hex")
+    return Format::Hex;
+  if (format == "json")
+    return Format::JSON;
+  return {};
+}
+
+bool MemoryDump::write(QIODevice &device,
+                       const vsrtl::core::AddressSpace &memory,
+                       const std::vector<Region> &regions,
+                       const Program *program, QString &errorMessage) const {
+  // Regions are resolved before writing, such that an invalid region does not
+  // leave a partial dump.
+  std::vector<AInt> addresses;
+  for (const auto &region : regions) {
+    bool isAddress;
+    const AInt address = region.start.toULongLong(&isAddress, 0);
+    std::optional<AInt> symbol;
+    if (!isAddress && program)
+      symbol = program->symbolIndex().address(region.start);
+    if (!isAddress && !symbol) {
+      errorMessage = "Unknown symbol '" + region.start + "' (--dump)";
+      return false;
+    }
+    addresses.push_back(isAddress ? address : *symbol);
+  }
+
+  bool ok = m_format != Format::JSON || device.write("[") == 1;
+  for (size_t i = 0; i < regions.size() && ok; i++)
+    ok = writeRegion(device, memory, regions.at(i), addresses.at(i), i == 0);
+  if (ok && m_format == Format::JSON)
+    ok = device.write("]\n") == 2;
+  if (!ok)
+    errorMessage = "Failed to write memory dump: " + device.errorString();
+  return ok;
+}
+
+bool MemoryDump::writeRegion(QIODevice &device,
+                             const vsrtl::core::AddressSpace &memory,
+                             const Region &region, AInt address,
+                             bool first) const {
+  const auto hex = [&](AInt value) {
+    return QByteArray::number(static_cast<qulonglong>(value), 16)
+        .rightJustified(m_addressBytes * 2, '0');
+  };
+  QByteArray text;
+  if (m_format == Format::Hex) {
+    text = "# " + region.start.toUtf8() + ": " +
+           QByteArray::number(static_cast<qulonglong>(region.bytes)) +
+           " bytes at 0x" + hex(address) + "\n";
+  } else if (m_format == Format::JSON) {
+    text = QByteArray(first ? "" : ",") + "\n{\"region\": \"" +
+           region.start.toUtf8().replace('\\', "\\\\").replace('"', "\\\"") +
+           "\", \"address\": " +
+           QByteArray::number(static_cast<qulonglong>(address)) +
+           ", \"bytes\": [";
+  }
+
+  std::vector<char> chunk(std::min<AInt>(region.bytes, s_chunkBytes));
+  // Hexadecimal bytes take 3 characters, and 16 bytes a line of addresses.
+  text.reserve(text.size() + chunk.size() * 4);
+  for (AInt offset = 0; offset < region.bytes; offset += chunk.size()) {
+    const size_t bytes = std::min<AInt>(chunk.size(), region.bytes - offset);
+    MemoryBlock::readBlock(memory, address + offset, chunk.data(), bytes);
+    if (m_format == Format::Binary) {
+      if (device.write(chunk.data(), bytes) != qint64(bytes))
+        return false;
+      continue;
+    }
+
+    for (size_t i = 0; i < bytes; i++) {
+      const uint8_t byte = static_cast<uint8_t>(chunk[i]);
+      const AInt index = offset + i;
+      if (m_format == Format::Hex) {
+        if (index % s_hexLineBytes == 0)
+          text += hex(address + index) + ":";
+        text += ' ';
+        text += "0123456789abcdef"[byte >> 4];
+        text += "0123456789abcdef"[byte & 0xF];
+        if (index % s_hexLineBytes == s_hexLineBytes - 1 ||
+            index == region.bytes - 1)
+          text += '\n';
+      } else {
+        if (index != 0)
+          text += ',';
+        text += QByteArray::number(byte);
+      }
+    }
+    if (device.write(text) != text.size())
+      return false;
+    text.clear();
+  }
+
+  if (m_format == Format::JSON)
+    text += "]}";
+  return device.write(text) == text.size();
+}
+
+} // namespace Ripes
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <QIODevice>
+#include <QString>
+
+#include <optional>
+#include <vector>
+
+#include "VSRTL/core/vsrtl_addressspace.h"
+#include "assembler/program.h"
+
+namespace Ripes {
+
+/**
+ * @brief The MemoryDump class
+ * Writes regions of memory once a run finished (--dump), as the raw bytes of
+ * the regions, as lines of 16 hexadecimal bytes, or as a JSON array holding an
+ * object with the bytes of each region. Regions start at an address or at a
+ * symbol of the program.
+ *
+ * Regions are read from memory in chunks, which are formatted and written as
+ * read, such that dumping a region costs time linear in its size and memory
+ * independent of it.
+ */
+class MemoryDump {
+public:
+  enum class Format { Binary, Hex, JSON };
+
+  struct Region {
+    // Address or symbol at which the region starts.
+    QString start;
+    AInt bytes = 0;
+  };
+
+  /// Parses @p spec as <address|symbol>:<bytes>.
+  static std::optional<Region> parseRegion(const QString &spec);
+  static std::optional<Format> parseFormat(const QString &format);
+
+  MemoryDump(Format format, unsigned addressBytes)
+      : m_format(format), m_addressBytes(addressBytes) {}
+
+  /// Writes @p regions of @p memory to @p device, resolving symbols in
+  /// @p program. Returns false and sets @p errorMessage if a region starts at
+  /// an unknown symbol or the device fails, in which case nothing or a part
+  /// of the dump is written.
+  bool write(QIODevice &device, const vsrtl::core::AddressSpace &memory,
+             const std::vector<Region> &regions, const Program *program,
+             QString &errorMessage) const;
+
+private:
+  bool writeRegion(QIODevice &device, const vsrtl::core::AddressSpace &memory,
+                   const Region &region, AInt address, bool first) const;
+
+  static constexpr size_t s_chunkBytes = 64 * 1024;
+  static constexpr unsigned s_hexLineBytes = 16;
+
+  Format m_format;
+  unsigned m_addressBytes;
+};
+
+} // namespace Ripes
@@ -0,0 +1,467 @@
+#include "profiler.h"
+#include "processorhandler.h"
+
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+
+#include <algorithm>
+#include <limits>
+
+namespace Ripes {
+
+static void sortByCycles(std::vector<Profiler::Entry> &entries) {
+  std::stable_sort(entries.begin(), entries.end(),
+                   [](const auto &lhs, const auto &rhs) {
+                     return lhs.cycles > rhs.cycles;
+                   });
+}
+
+static QString hex(AInt address) {
+  return "0x" + QString::number(address, 16).rightJustified(8, '0');
+}
+
+static double cyclesPerInstruction(const Profiler::Entry &entry) {
+  return entry.retired == 0 ? 0.0
+                            : static_cast<double>(entry.cycles) /
+                                  static_cast<double>(entry.retired);
+}
+
+// Returns @p entry as reported in JSON, of a profile of @p total cycles.
+static QVariantMap entryMap(const Profiler::Entry &entry,
+                            const QString &nameKey, long long total) {
+  QVariantMap m;
+  m[nameKey] = entry.name;
+  m["address"] = hex(entry.address);
+  m["cycles"] = entry.cycles;
+  m["retired"] = entry.retired;
+  m["cycle share"] =
+      total == 0 ? 0.0 : static_cast<double>(entry.cycles) / total;
+  m["CPI"] = cyclesPerInstruction(entry);
+  return m;
+}
+
+Profiler::Profiler(const std::shared_ptr<const Program> &program,
+                   unsigned top)
+    : m_program(program), m_top(top) {}
+
+void Profiler::attach(RipesProcessor *processor) {
+  const auto *text =
+      m_program ? m_program->getSection(TEXT_SECTION_NAME) : nullptr;
+  if (!text)
+    return;
+  m_profile = std::make_shared<PCProfile>(
+      text->address, text->data.size(),
+      processor->implementsISA()->instrByteAlignment());
+  // The following instruction of each instruction distinguishes taken
+  // branches and jumps from falling through.
+  auto &next = m_profile->next;
+  next.resize(m_profile->cycles.size());
+  for (size_t i = 0; i < next.size(); ++i)
+    next[i] = i + 1;
+  const auto &disassembled = m_program->getDisassembled();
+  for (unsigned i = 0; i + 1 < disassembled.numInstructions(); ++i) {
+    const AInt address = *disassembled.indexToAddress(i);
+    const AInt following = *disassembled.indexToAddress(i + 1);
+    if (m_profile->contains(address) && m_profile->contains(following))
+      next[m_profile->index(address)] = m_profile->index(following);
+  }
+  m_processor = processor;
+  m_processor->setPCProfile(m_profile);
+}
+
+void Profiler::detach() {
+  if (m_processor)
+    m_processor->setPCProfile(nullptr);
+  m_processor = nullptr;
+}
+
+QString Profiler::symbolOf(AInt address) const {
+  auto it = m_program->symbols.upper_bound(address);
+  if (it == m_program->symbols.begin() ||
+      !m_profile->contains((--it)->first))
+    return TEXT_SECTION_NAME;
+  return it->second.v;
+}
+
+long long Profiler::totalCycles() const {
+  if (!m_profile)
+    return 0;
+  long long cycles = m_profile->unattributedCycles;
+  for (const long long c : m_profile->cycles)
+    cycles += c;
+  return cycles;
+}
+
+std::vector<Profiler::Entry> Profiler::symbols() const {
+  std::map<QString, Entry> bySymbol;
+  if (!m_profile)
+    return {};
+  for (size_t i = 0; i < m_profile->cycles.size(); ++i) {
+    if (m_profile->cycles.at(i) == 0 && m_profile->retired.at(i) == 0)
+      continue;
+    const AInt address = m_profile->address(i);
+    const QString name = symbolOf(address);
+    // Entries are addressed by the first profiled instruction of the symbol.
+    auto it = bySymbol.try_emplace(name, Entry{name, address});
+    it.first->second.cycles += m_profile->cycles.at(i);
+    it.first->second.retired += m_profile->retired.at(i);
+  }
+  std::vector<Entry> entries;
+  for (const auto &it : bySymbol)
+    entries.push_back(it.second);
+  sortByCycles(entries);
+  return entries;
+}
+
+std::vector<Profiler::Entry> Profiler::lines() const {
+  std::map<unsigned, Entry> byLine;
+  if (!m_profile)
+    return {};
+  const auto &sourceMapping = m_program->getSourceMapping();
+  for (size_t i = 0; i < m_profile->cycles.size(); ++i) {
+    const AInt address = m_profile->address(i);
+    auto mapping = sourceMapping.find(address);
+    if (mapping == sourceMapping.end() || mapping->second.empty())
+      continue;
+    // Instructions of a pseudo-instruction share its source line.
+    const unsigned line = *mapping->second.begin();
+    auto it =
+        byLine.try_emplace(line, Entry{QString::number(line + 1), address});
+    it.first->second.cycles += m_profile->cycles.at(i);
+    it.first->second.retired += m_profile->retired.at(i);
+  }
+  std::vector<Entry> entries;
+  for (const auto &it : byLine)
+    if (it.second.cycles != 0 || it.second.retired != 0)
+      entries.push_back(it.second);
+  sortByCycles(entries);
+  return entries;
+}
+
+std::vector<Profiler::Entry> Profiler::instructions() const {
+  std::vector<Entry> entries;
+  if (!m_profile)
+    return entries;
+  for (size_t i = 0; i < m_profile->cycles.size(); ++i) {
+    if (m_profile->cycles.at(i) == 0 && m_profile->retired.at(i) == 0)
+      continue;
+    entries.push_back({QString(), m_profile->address(i),
+                       m_profile->cycles.at(i), m_profile->retired.at(i)});
+  }
+  sortByCycles(entries);
+  // Only the reported instructions are disassembled.
+  if (entries.size() > m_top)
+    entries.resize(m_top);
+  for (auto &entry : entries)
+    entry.name = ProcessorHandler::disassembleInstr(entry.address);
+  return entries;
+}
+
+std::pair<std::vector<Profiler::Block>, std::vector<Profiler::Edge>>
+Profiler::blocks() const {
+  if (!m_profile || m_profile->cycles.empty())
+    return {};
+  const auto &profile = *m_profile;
+  const size_t size = profile.cycles.size();
+
+  std::vector<bool> leader(size);
+  std::vector<long long> taken(size);
+  leader[0] = true;
+  for (auto it = m_program->symbols.lower_bound(profile.base);
+       it != m_program->symbols.end() && profile.contains(it->first); ++it)
+    leader[profile.index(it->first)] = true;
+  for (const auto &[jump, count] : profile.jumps) {
+    leader[jump.second] = true;
+    taken[jump.first] += count;
+    if (profile.next[jump.first] < size)
+      leader[profile.next[jump.first]] = true;
+  }
+
+  // Instructions are visited in memory order, starting a block at each leader.
+  constexpr size_t noBlock = std::numeric_limits<size_t>::max();
+  std::vector<Block> blocks;
+  std::vector<size_t> blockOf(size, noBlock);
+  std::vector<size_t> lastOf;
+  for (size_t i = 0; i < size; i = profile.next[i]) {
+    if (leader[i]) {
+      blocks.push_back({symbolOf(profile.address(i)), profile.address(i)});
+      blocks.back().entries = profile.retired[i];
+      lastOf.push_back(i);
+    }
+    auto &block = blocks.back();
+    block.end = profile.address(profile.next[i]);
+    block.instructions++;
+    block.cycles += profile.cycles[i];
+    block.retired += profile.retired[i];
+    blockOf[i] = blocks.size() - 1;
+    lastOf.back() = i;
+  }
+
+  std::vector<Edge> edges;
+  for (const auto &[jump, count] : profile.jumps) {
+    const size_t from = blockOf[jump.first];
+    const size_t to = blockOf[jump.second];
+    if (from != noBlock && to != noBlock)
+      edges.push_back(
+          {blocks.at(from).address, blocks.at(to).address, true, count});
+  }
+  // Each retirement of the last instruction of a block which is not followed
+  // by a taken transition, nor is the final retirement, falls through.
+  for (size_t b = 0; b + 1 < blocks.size(); ++b) {
+    const size_t last = lastOf.at(b);
+    const long long fallThrough = profile.retired[last] - taken[last] -
+                                  (profile.lastRetired == last ? 1 : 0);
+    if (fallThrough > 0)
+      edges.push_back({blocks.at(b).address, blocks.at(b + 1).address, false,
+                       fallThrough});
+  }
+  std::stable_sort(edges.begin(), edges.end(),
+                   [](const auto &lhs, const auto &rhs) {
+                     return lhs.from < rhs.from;
+                   });
+
+  blocks.erase(std::remove_if(blocks.begin(), blocks.end(),
+                              [](const Block &block) {
+                                return block.cycles == 0 && block.retired == 0;
+                              }),
+               blocks.end());
+  return {blocks, edges};
+}
+
+QVariant Profiler::report(bool json) const {
+  if (!m_profile)
+    return QVariant();
+
+  const long long total = totalCycles();
+  const auto share = [&](long long cycles) {
+    return total == 0 ? 0.0 : static_cast<double>(cycles) / total;
+  };
+  auto lineEntries = lines();
+  if (lineEntries.size() > m_top)
+    lineEntries.resize(m_top);
+  const auto instrEntries = instructions();
+
+  if (json) {
+    const auto toList = [&](const std::vector<Entry> &entries,
+                            const QString &nameKey) {
+      QVariantList list;
+      for (const auto &entry : entries)
+        list << entryMap(entry, nameKey, total);
+      return list;
+    };
+    QVariantMap m;
+    m["cycles"] = total;
+    m["unattributed cycles"] = m_profile->unattributedCycles;
+    m["symbols"] = toList(symbols(), "symbol");
+    m["lines"] = toList(lineEntries, "line");
+    m["instructions"] = toList(instrEntries, "instruction");
+    return m;
+  }
+
+  QString out;
+  QTextStream stream(&out);
+  const auto writeTable = [&](const QString &title,
+                              const std::vector<Entry> &entries) {
+    stream << title << "\n";
+    stream << qSetFieldWidth(12) << Qt::right << "cycles" << "%" << "retired"
+           << "CPI" << qSetFieldWidth(0) << "  " << Qt::left << "address"
+           << "    " << title.split(" ").last() << "\n";
+    for (const auto &entry : entries) {
+      stream << qSetFieldWidth(12) << Qt::right << entry.cycles
+             << QString::number(share(entry.cycles) * 100, 'f', 2)
+             << entry.retired
+             << QString::number(cyclesPerInstruction(entry), 'f', 2)
+             << qSetFieldWidth(0) << "  " << Qt::left << hex(entry.address)
+             << "  " << entry.name << "\n";
+    }
+    stream << "\n";
+  };
+  stream << "Profiled " << total << " cycles ("
+         << m_profile->unattributedCycles << " unattributed)\n\n";
+  writeTable("Hot symbols", symbols());
+  if (!lineEntries.empty())
+    writeTable("Hot source lines", lineEntries);
+  writeTable("Hot instructions", instrEntries);
+  return out;
+}
+
+void Profiler::write(ReportWriter &writer) const {
+  if (!m_profile) {
+    writer.value(QVariant());
+    return;
+  }
+
+  // Members are written in the order of the keys of report(), and each entry
+  // as it is formatted.
+  const long long total = totalCycles();
+  const auto writeList = [&](const std::vector<Entry> &entries,
+                             const QString &nameKey) {
+    writer.beginArray();
+    for (const auto &entry : entries)
+      writer.value(entryMap(entry, nameKey, total));
+    writer.endArray();
+  };
+  auto lineEntries = lines();
+  if (lineEntries.size() > m_top)
+    lineEntries.resize(m_top);
+
+  writer.beginObject();
+  writer.member("cycles", total);
+  writer.key("instructions");
+  writeList(instructions(), "instruction");
+  writer.key("lines");
+  writeList(lineEntries, "line");
+  writer.key("symbols");
+  writeList(symbols(), "symbol");
+  writer.member("unattributed cycles", m_profile->unattributedCycles);
+  writer.endObject();
+}
+
+bool Profiler::writeFolded(const QString &path, QString &errorMessage) const {
+  QFile file(path);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate |
+                 QIODevice::Text)) {
+    errorMessage = "Failed to open profile output file '" + path + "'";
+    return false;
+  }
+  if (!m_profile)
+    return true;
+
+  QTextStream stream(&file);
+  const auto &sourceMapping = m_program->getSourceMapping();
+  for (size_t i = 0; i < m_profile->cycles.size(); ++i) {
+    if (m_profile->cycles.at(i) == 0)
+      continue;
+    const AInt address = m_profile->address(i);
+    QString frame = hex(address);
+    auto mapping = sourceMapping.find(address);
+    if (mapping != sourceMapping.end() && !mapping->second.empty())
+      frame = "line " + QString::number(*mapping->second.begin() + 1);
+    stream << symbolOf(address) << ";" << frame << " "
+           << m_profile->cycles.at(i) << "\n";
+  }
+  if (m_profile->unattributedCycles != 0)
+    stream << "[unattributed] " << m_profile->unattributedCycles << "\n";
+  return true;
+}
+
+bool Profiler::writeBlocks(const QString &path, QString &errorMessage) const {
+  QFile file(path);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate |
+                 QIODevice::Text)) {
+    errorMessage = "Failed to open block profile output file '" + path + "'";
+    return false;
+  }
+  if (!m_profile)
+    return true;
+
+  const auto [blocks, edges] = this->blocks();
+  const long long total = totalCycles();
+  long long hottest = 0;
+  for (const auto &block : blocks)
+    hottest = std::max(hottest, block.cycles);
+  const auto share = [&](long long cycles) {
+    return total == 0 ? 0.0 : static_cast<double>(cycles) / total;
+  };
+  const auto cyclesPerEntry = [](const Block &block) {
+    return block.entries == 0 ? 0.0
+                              : static_cast<double>(block.cycles) /
+                                    static_cast<double>(block.entries);
+  };
+
+  QTextStream stream(&file);
+  if (path.endsWith(".dot", Qt::CaseInsensitive)) {
+    // Blocks are shaded from white to red by their cycles relative to the
+    // hottest block, and back edges are drawn in bold red.
+    stream << "digraph cfg {\n"
+           << "  node [shape=box, style=filled, fontname=monospace];\n";
+    for (const auto &block : blocks) {
+      const double heat =
+          hottest == 0 ? 0.0 : static_cast<double>(block.cycles) / hottest;
+      stream << "  \"" << hex(block.address) << "\" [label=\""
+             << block.symbol << " " << hex(block.address) << "\\n"
+             << block.instructions << " instructions, " << block.entries
+             << " entries\\n"
+             << block.cycles << " cycles ("
+             << QString::number(share(block.cycles) * 100, 'f', 2) << "%), "
+             << QString::number(cyclesPerEntry(block), 'f', 2)
+             << " cycles/entry\", fillcolor=\"0.000 "
+             << QString::number(heat, 'f', 3) << " 1.000\"];\n";
+    }
+    for (const auto &edge : edges) {
+      stream << "  \"" << hex(edge.from) << "\" -> \"" << hex(edge.to)
+             << "\" [label=\"" << edge.count << "\"";
+      if (!edge.taken)
+        stream << ", style=dashed";
+      if (edge.backEdge())
+        stream << ", color=red, penwidth=2";
+      stream << "];\n";
+    }
+    stream << "}\n";
+    return true;
+  }
+
+  QVariantList blockList;
+  std::map<AInt, const Block *> byAddress;
+  for (const auto &block : blocks) {
+    QVariantMap m;
+    m["symbol"] = block.symbol;
+    m["address"] = hex(block.address);
+    m["end"] = hex(block.end);
+    m["instructions"] = block.instructions;
+    m["entries"] = block.entries;
+    m["cycles"] = block.cycles;
+    m["retired"] = block.retired;
+    m["cycle share"] = share(block.cycles);
+    m["cycles per entry"] = cyclesPerEntry(block);
+    blockList << m;
+    byAddress[block.address] = &block;
+  }
+  QVariantList edgeList;
+  // The loop of a back edge spans the blocks from its target up to and
+  // including its source.
+  std::vector<std::pair<long long, QVariantMap>> loops;
+  for (const auto &edge : edges) {
+    QVariantMap m;
+    m["from"] = hex(edge.from);
+    m["to"] = hex(edge.to);
+    m["kind"] = edge.taken ? "taken" : "fall-through";
+    m["count"] = edge.count;
+    m["back edge"] = edge.backEdge();
+    edgeList << m;
+    if (!edge.backEdge())
+      continue;
+    long long cycles = 0;
+    for (auto it = byAddress.lower_bound(edge.to);
+         it != byAddress.end() && it->first <= edge.from; ++it)
+      cycles += it->second->cycles;
+    QVariantMap loop;
+    loop["symbol"] = symbolOf(edge.to);
+    loop["header"] = hex(edge.to);
+    loop["latch"] = hex(edge.from);
+    loop["iterations"] = edge.count;
+    loop["cycles"] = cycles;
+    loop["cycle share"] = share(cycles);
+    loops.push_back({cycles, loop});
+  }
+  std::stable_sort(loops.begin(), loops.end(),
+                   [](const auto &lhs, const auto &rhs) {
+                     return lhs.first > rhs.first;
+                   });
+  QVariantList loopList;
+  for (const auto &loop : loops)
+    loopList << loop.second;
+
+  QVariantMap m;
+  m["cycles"] = total;
+  m["blocks"] = blockList;
+  m["edges"] = edgeList;
+  m["loops"] = loopList;
+  stream << QJsonDocument(QJsonObject::fromVariantMap(m))
+                .toJson(QJsonDocument::Indented);
+  return true;
+}
+
+} // namespace Ripes
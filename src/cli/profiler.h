@@ -0,0 +1,107 @@
+#pragma once
+
+#include <QString>
+#include <QVariant>
+
+#include <memory>
+
+#include "assembler/program.h"
+#include "processors/interface/ripesprocessor.h"
+#include "reportwriter.h"
+
+namespace Ripes {
+
+/// The Profiler class profiles the cycles and retired instructions of a run
+/// per instruction of the .text section of a program (see PCProfile), and
+/// aggregates the profile per symbol and per source line. The symbol of an
+/// instruction is the closest preceding symbol within the .text section.
+/// The profile is furthermore aggregated per basic block of the executed
+/// control flow graph, whose edges count the taken and fall-through
+/// transitions between blocks.
+class Profiler {
+public:
+  /// @p top limits the number of source lines and instructions reported.
+  Profiler(const std::shared_ptr<const Program> &program, unsigned top);
+
+  /// Starts profiling the cycles clocked by @p processor. Nothing is profiled
+  /// if the program has no .text section.
+  void attach(RipesProcessor *processor);
+  void detach();
+
+  /// Returns the hotspots of the profile, as a table of symbols, source lines
+  /// and instructions sorted by cycles, or a map thereof if @p json is set.
+  QVariant report(bool json) const;
+  /// Writes the report of report(true) to @p writer, one entry at a time.
+  void write(ReportWriter &writer) const;
+
+  /// Writes the profile to @p path in the folded stack format of flame graph
+  /// tools, with one line of "<symbol>;<source line or address> <cycles>" per
+  /// profiled instruction. Returns false and sets @p errorMessage on failure.
+  bool writeFolded(const QString &path, QString &errorMessage) const;
+
+  /// Writes the basic block profile to @p path, as a Graphviz graph of the
+  /// blocks colored by their share of the cycles if @p path ends in ".dot",
+  /// and otherwise as JSON. Returns false and sets @p errorMessage on failure.
+  bool writeBlocks(const QString &path, QString &errorMessage) const;
+
+  struct Entry {
+    QString name;
+    AInt address = 0;
+    long long cycles = 0;
+    long long retired = 0;
+  };
+
+  /// Returns the profile aggregated per symbol, sorted by cycles.
+  std::vector<Entry> symbols() const;
+  /// Returns the profile aggregated per source line, sorted by cycles. Entries
+  /// are named by their (1-based) line number.
+  std::vector<Entry> lines() const;
+  /// Returns the profile per instruction, sorted by cycles. Entries are named
+  /// by their disassembled instruction.
+  std::vector<Entry> instructions() const;
+
+  /// A basic block of [address : end[. A block starts at the start of the
+  /// .text section, at a symbol, at the target of a taken branch or jump and
+  /// following a taken branch or jump. Each retirement of its first
+  /// instruction is an entry of the block.
+  struct Block {
+    QString symbol;
+    AInt address = 0;
+    AInt end = 0;
+    unsigned instructions = 0;
+    long long entries = 0;
+    long long cycles = 0;
+    long long retired = 0;
+  };
+  /// A transition between the blocks starting at @p from and @p to, either by
+  /// a taken branch or jump (@p taken) or by falling through to the
+  /// following block. Edges to a block at or before @p from are back edges,
+  /// i.e. iterations of a loop.
+  struct Edge {
+    AInt from = 0;
+    AInt to = 0;
+    bool taken = false;
+    long long count = 0;
+    bool backEdge() const { return to <= from; }
+  };
+  /// Returns the executed basic blocks, sorted by address, and the edges
+  /// between them.
+  std::pair<std::vector<Block>, std::vector<Edge>> blocks() const;
+
+  long long totalCycles() const;
+
+  /// Returns the name of the symbol of the instruction at @p address.
+  QString symbolOf(AInt address) const;
+  /// Returns the profile of the run, if attached to a program with a .text
+  /// section.
+  const PCProfile *profile() const { return m_profile.get(); }
+  const std::shared_ptr<const Program> &program() const { return m_program; }
+
+private:
+  std::shared_ptr<const Program> m_program;
+  unsigned m_top;
+  std::shared_ptr<PCProfile> m_profile;
+  RipesProcessor *m_processor = nullptr;
+};
+
+} // namespace Ripes
@@ -1,7 +1,133 @@
 #include "programutilities.h"
+#include "elfio/elfio.hpp"
+#include "libelfin/dwarf/dwarf++.hh"
+#include "loaddialog.h"
+#include "tracespans.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QRegularExpression>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <vector>
 
 namespace Ripes {
 
+using namespace ELFIO;
+
+namespace {
+
+class ELFIODwarfLoader : public ::dwarf::loader {
+public:
+  ELFIODwarfLoader(elfio &reader) : reader(reader) {}
+
+  const void *load(::dwarf::section_type section, size_t *size_out) override {
+    auto sec = reader.sections[::dwarf::elf::section_type_to_name(section)];
+    if (sec == nullptr)
+      return nullptr;
+    *size_out = sec->get_size();
+    return sec->get_data();
+  }
+
+private:
+  elfio &reader;
+};
+
+bool isInternalSourceFile(const QString &filename) {
+  // Returns true if we have reason to believe that this file originated from
+  // within the Ripes editor. These will be temporary files like
+  // /.../Ripes.abc123.c
+  static QRegularExpression re("Ripes.[a-zA-Z0-9]+.c");
+  return re.match(filename).hasMatch();
+}
+
+/// The source lines of an executable, as (address, line) pairs sorted by
+/// address.
+struct SourceLines {
+  QString sourceFile;
+  // Error of parsing the debug information, if any.
+  QString error;
+  std::vector<std::pair<quint64, quint32>> lines;
+};
+
+constexpr quint32 c_sourceMapMagic = 0x52534d43; // "RSMC"
+constexpr quint32 c_sourceMapVersion = 1;
+
+QString sourceMapPath(const QString &filepath) {
+  return filepath + ".srcmap";
+}
+
+bool readSourceMap(const QString &path, const QByteArray &elfHash,
+                   SourceLines &result) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly))
+    return false;
+  QDataStream in(&file);
+  quint32 magic, version;
+  QByteArray hash;
+  in >> magic >> version;
+  if (magic != c_sourceMapMagic || version != c_sourceMapVersion)
+    return false;
+  in >> hash;
+  if (hash != elfHash)
+    return false;
+  quint32 count;
+  in >> result.sourceFile >> result.error >> count;
+  result.lines.resize(count);
+  for (auto &line : result.lines) {
+    if (in.status() != QDataStream::Ok)
+      break;
+    in >> line.first >> line.second;
+  }
+  return in.status() == QDataStream::Ok;
+}
+
+void writeSourceMap(const QString &path, const QByteArray &elfHash,
+                    const SourceLines &lines) {
+  // The cache is best effort; the directory of the executable may not be
+  // writable.
+  QSaveFile file(path);
+  if (!file.open(QIODevice::WriteOnly))
+    return;
+  QDataStream out(&file);
+  out << c_sourceMapMagic << c_sourceMapVersion << elfHash << lines.sourceFile
+      << lines.error << quint32(lines.lines.size());
+  for (const auto &line : lines.lines)
+    out << line.first << line.second;
+  file.commit();
+}
+
+/// Parses the line tables of the DWARF information of @p reader.
+SourceLines parseSourceLines(elfio &reader) {
+  TraceSpan span("Parse DWARF line tables");
+  // We'll only load information from compilation units which originated from
+  // a source file that plausibly arrived from within the Ripes editor.
+  SourceLines result;
+  ::dwarf::dwarf dw(std::make_shared<ELFIODwarfLoader>(reader));
+  for (auto &cu : dw.compilation_units()) {
+    for (auto &line : cu.get_line_table()) {
+      if (!line.file)
+        continue;
+      QString filePath = QString::fromStdString(line.file->path);
+      if (result.sourceFile.isEmpty()) {
+        // Try to see if this compilation unit is from the Ripes editor:
+        if (isInternalSourceFile(filePath))
+          result.sourceFile = filePath;
+      }
+      if (result.sourceFile != filePath)
+        continue;
+      result.lines.emplace_back(line.address, line.line - 1);
+    }
+  }
+  std::stable_sort(
+      result.lines.begin(), result.lines.end(),
+      [](const auto &a, const auto &b) { return a.first < b.first; });
+  return result;
+}
+
+} // namespace
+
 QString loadFlatBinaryFile(Program &program, const QString &filepath,
                            unsigned long entryPoint, unsigned long loadAt) {
   QFile file(filepath);
@@ -18,4 +144,136 @@ QString loadFlatBinaryFile(Program &program, const QString &filepath,
   return QString();
 }
 
+const char *mapFile(Program &program, const QString &filepath) {
+  auto file = std::make_shared<QFile>(filepath);
+  if (!file->open(QIODevice::ReadOnly) || file->size() == 0)
+    return nullptr;
+  // The mapping remains valid until the QFile is destroyed.
+  const uchar *image = file->map(0, file->size());
+  if (!image)
+    return nullptr;
+  program.backing = file;
+  return reinterpret_cast<const char *>(image);
+}
+
+void loadElfSections(Program &program, ELFIO::elfio &reader,
+                     const char *image) {
+  TraceSpan span("Load ELF sections");
+  for (const auto &elfSection : reader.sections) {
+    // Do not load .debug sections
+    if (!QString::fromStdString(elfSection->get_name()).startsWith(".debug")) {
+      ProgramSection section;
+      section.name = QString::fromStdString(elfSection->get_name());
+      section.address = elfSection->get_address();
+      // Sections of a mapped file reference the mapping, and are only copied
+      // by QByteArray if modified. Otherwise, QByteArray performs a deep copy
+      // of the data when the data array is initialized at construction.
+      // Sections without file contents (.bss) are zero-initialized.
+      const int size = static_cast<int>(elfSection->get_size());
+      if (elfSection->get_type() == SHT_NOBITS)
+        section.data = QByteArray(size, 0);
+      else if (image)
+        section.data =
+            QByteArray::fromRawData(image + elfSection->get_offset(), size);
+      else
+        section.data = QByteArray(elfSection->get_data(), size);
+      program.sections[section.name] = section;
+    }
+
+    if (elfSection->get_type() == SHT_SYMTAB) {
+      // Collect function symbols
+      const ELFIO::symbol_section_accessor symbols(reader, elfSection);
+      for (unsigned int j = 0; j < symbols.get_symbols_num(); ++j) {
+        std::string name;
+        ELFIO::Elf64_Addr value = 0;
+        ELFIO::Elf_Xword size;
+        unsigned char bind;
+        unsigned char type = STT_NOTYPE;
+        ELFIO::Elf_Half section_index;
+        unsigned char other;
+        symbols.get_symbol(j, name, value, size, bind, type, section_index,
+                           other);
+
+        if (type != STT_FUNC)
+          continue;
+        program.symbols[value] = QString::fromStdString(name);
+      }
+    }
+  }
+  program.entryPoint = reader.get_entry();
+}
+
+void loadElfSourceMapping(
+    Program &program, const std::shared_ptr<ELFIO::elfio> &reader,
+    const QString &filepath,
+    const std::function<void(const QString &)> &onError) {
+  // The executable is hashed upon loading, since it may be removed before the
+  // mapping is loaded.
+  QByteArray elfHash;
+  QFile file(filepath);
+  if (file.open(QIODevice::ReadOnly)) {
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(&file);
+    elfHash = hash.result();
+  }
+
+  const QString cachePath = sourceMapPath(filepath);
+  program.setSourceLoader([=](Program::SourceMapping &mapping,
+                              QString &sourceHash) {
+    const auto error = [&](const QString &what) {
+      if (onError)
+        onError("Could not load debug information: " + what);
+    };
+    SourceLines lines;
+    if (elfHash.isEmpty() || !readSourceMap(cachePath, elfHash, lines)) {
+      try {
+        lines = parseSourceLines(*reader);
+      } catch (::dwarf::format_error &e) {
+        // Executables without valid debug information are cached as such.
+        lines = SourceLines();
+        lines.error = QString::fromStdString(e.what());
+      } catch (...) {
+        // Something else went wrong.
+        return;
+      }
+      if (!elfHash.isEmpty())
+        writeSourceMap(cachePath, elfHash, lines);
+    }
+    if (!lines.error.isEmpty()) {
+      error(lines.error);
+      return;
+    }
+
+    for (const auto &line : lines.lines)
+      mapping[line.first].insert(line.second);
+    if (!lines.sourceFile.isEmpty()) {
+      // Finally, we need to generate a hash of the source file that we've
+      // loaded source mappings from, so the editor knows what editor contents
+      // applies to this program.
+      QFile srcFile(lines.sourceFile);
+      if (srcFile.open(QFile::ReadOnly))
+        sourceHash = Program::calculateHash(srcFile.readAll());
+      else
+        error("Could not find source file " + lines.sourceFile);
+    }
+  });
+}
+
+QString loadElfFile(Program &program, const QString &filepath) {
+  if (!QFile::exists(filepath))
+    return "Error: Could not open file " + filepath;
+  const auto elfInfo = LoadDialog::validateELFFile(QFile(filepath));
+  if (!elfInfo.valid) {
+    // The validation messages are formatted for display in the GUI.
+    QString message = elfInfo.errorMessage;
+    return "Error: " + message.replace(QRegularExpression("(<br/>)+"), " ");
+  }
+
+  ELFIO::elfio reader;
+  if (!reader.load(filepath.toStdString()))
+    return "Error: Could not load ELF file " + filepath;
+  loadElfSections(program, reader, mapFile(program, filepath));
+  return QString();
+}
+
 } // namespace Ripes
@@ -3,9 +3,42 @@
 #include "assembler/program.h"
 #include <QFile>
 
+#include <functional>
+#include <memory>
+
+namespace ELFIO {
+class elfio;
+}
+
 namespace Ripes {
 
 QString loadFlatBinaryFile(Program &program, const QString &filepath,
                            unsigned long entryPoint, unsigned long loadAt);
 
+/// Memory-maps the file at @p filepath, and makes @p program own the mapping.
+/// Returns the contents of the file, or nullptr if it could not be mapped.
+const char *mapFile(Program &program, const QString &filepath);
+
+/// Loads the sections, function symbols and entry point of the ELF executable
+/// of @p reader into @p program. Debug sections are not loaded. If @p image is
+/// the memory-mapped ELF file, the sections reference its contents rather than
+/// copying them.
+void loadElfSections(Program &program, ELFIO::elfio &reader,
+                     const char *image = nullptr);
+
+/// Defers loading the source mapping of the ELF executable of @p reader, loaded
+/// from @p filepath, until its first use. Only the lines of a source file which
+/// originated from the Ripes editor are mapped. The DWARF line tables are
+/// parsed once per executable; the mapping is then cached in a file next to
+/// the executable, keyed by a hash of the executable. @p onError is called
+/// with a message if the debug information cannot be loaded.
+void loadElfSourceMapping(
+    Program &program, const std::shared_ptr<ELFIO::elfio> &reader,
+    const QString &filepath,
+    const std::function<void(const QString &)> &onError = {});
+
+/// Loads the ELF executable at @p filepath into @p program. Returns an error
+/// message if the file is not an executable for the current processor.
+QString loadElfFile(Program &program, const QString &filepath);
+
 } // namespace Ripes
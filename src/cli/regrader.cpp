@@ -0,0 +1,244 @@
+#include "regrader.h"
+#include "assembler/programcache.h"
+#include "processorhandler.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QRegularExpression>
+#include <QSemaphore>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <deque>
+#include <iostream>
+
+namespace Ripes {
+
+/// Quotes a field of a CSV file if it contains separators or quotes.
+static QString csvField(const QString &field) {
+  if (!field.contains(QRegularExpression("[,\"\r\n]")))
+    return field;
+  return "\"" + QString(field).replace("\"", "\"\"") + "\"";
+}
+
+Regrader::Regrader(const CLIModeOptions &options) : m_options(options) {}
+
+std::vector<Regrader::Submission>
+Regrader::findSubmissions(const QString &directory) {
+  static const QRegularExpression taskName("^(\\d+)\\.(\\d+)$");
+  const QDir root(directory);
+  std::vector<Submission> submissions;
+  QDirIterator it(directory, {"*.s", "*.asm"}, QDir::Files,
+                  QDirIterator::Subdirectories);
+  while (it.hasNext()) {
+    const QFileInfo info(it.next());
+    const auto match = taskName.match(info.completeBaseName());
+    if (!match.hasMatch())
+      continue;
+    Submission submission;
+    submission.file = root.relativeFilePath(info.filePath());
+    submission.student = root.relativeFilePath(info.path());
+    if (submission.student == ".")
+      submission.student.clear();
+    submission.section = match.captured(1).toUInt();
+    submission.number = match.captured(2).toUInt();
+    submissions.push_back(submission);
+  }
+  std::sort(submissions.begin(), submissions.end(),
+            [](const auto &lhs, const auto &rhs) {
+              return lhs.file < rhs.file;
+            });
+  return submissions;
+}
+
+int Regrader::run() {
+  if (!QDir(m_options.regrade).exists()) {
+    std::cerr << "ERROR: Submission directory '"
+              << m_options.regrade.toStdString() << "' does not exist"
+              << std::endl;
+    return 1;
+  }
+  ProcessorHandler::selectProcessor(m_options.proc, m_options.isaExtensions);
+  // Identical submissions are assembled once, also across regrades if the
+  // assembled programs are persisted.
+  if (!m_options.assemblerCache.isEmpty())
+    Assembler::ProgramCache::get().setDirectory(m_options.assemblerCache);
+
+  const auto submissions = findSubmissions(m_options.regrade);
+  const auto journaled = readJournal();
+  QFile journal(journalPath());
+  if (!m_options.outputFile.isEmpty() &&
+      !journal.open(QIODevice::WriteOnly | QIODevice::Append)) {
+    std::cerr << "ERROR: Failed to open regrade journal '"
+              << journal.fileName().toStdString() << "'" << std::endl;
+    return 1;
+  }
+  std::vector<QJsonObject> entries(submissions.size());
+  const auto record = [&](size_t index, const QJsonObject &entry) {
+    entries.at(index) = entry;
+    if (!journal.isOpen())
+      return;
+    QJsonObject line;
+    line["catalogueVersion"] =
+        QString::fromStdString(m_checker.getCatalogueVersion());
+    line["entry"] = entry;
+    journal.write(QJsonDocument(line).toJson(QJsonDocument::Compact) + "\n");
+    journal.flush();
+  };
+
+  // The tests of all checks in flight share the threads of the pool. Checks
+  // are prepared, and their processors constructed and destroyed, on this
+  // thread, and the number of checks in flight is bounded such that the
+  // memory of the regrade does not grow with the number of submissions.
+  struct Pending {
+    size_t index = 0;
+    std::unique_ptr<TaskChecker::Check> check;
+    QSemaphore done;
+  };
+  QThreadPool pool;
+  const size_t maxPending = 4 * std::max(1, pool.maxThreadCount());
+  std::deque<std::unique_ptr<Pending>> pending;
+  const auto finish = [&] {
+    auto &front = *pending.front();
+    front.done.acquire(static_cast<int>(front.check->contexts.size()));
+    record(front.index, entry(submissions.at(front.index),
+                              m_checker.checkReport(*front.check)));
+    pending.pop_front();
+  };
+
+  for (size_t i = 0; i < submissions.size(); ++i) {
+    const auto &submission = submissions.at(i);
+    if (auto it = journaled.find(submission.file); it != journaled.end()) {
+      entries.at(i) = it->second;
+      continue;
+    }
+    const Task *task =
+        m_checker.findTask(submission.section, submission.number);
+    QFile file(QDir(m_options.regrade).filePath(submission.file));
+    if (!task || !file.open(QIODevice::ReadOnly)) {
+      QJsonObject invalid = entry(submission, std::string());
+      invalid.remove("report");
+      invalid["status"] = "invalid";
+      invalid["errors"] =
+          QJsonArray{task ? "Failed to open submission" : "Unknown task"};
+      record(i, invalid);
+      continue;
+    }
+
+    auto &current = *pending.emplace_back(std::make_unique<Pending>());
+    current.index = i;
+    current.check =
+        m_checker.prepareCheck(QString::fromUtf8(file.readAll()), *task);
+    for (size_t test = 0; test < current.check->contexts.size(); ++test) {
+      pool.start([&, test] {
+        m_checker.runCheckTest(*current.check, test);
+        current.done.release();
+      });
+    }
+    while (pending.size() > maxPending)
+      finish();
+  }
+  while (!pending.empty())
+    finish();
+
+  const int result = writeGradebook(entries);
+  if (result == 0 && journal.isOpen())
+    journal.remove();
+  return result;
+}
+
+QJsonObject Regrader::entry(const Submission &submission,
+                            const std::string &report) const {
+  QJsonObject entry;
+  entry["file"] = submission.file;
+  entry["student"] = submission.student;
+  entry["task"] = QString::number(submission.section) + "." +
+                  QString::number(submission.number);
+  const auto grade = TaskChecker::parseGrade(report);
+  entry["status"] = "ok";
+  entry["passed"] = static_cast<int>(grade.passed);
+  entry["tests"] = static_cast<int>(grade.tests);
+  if (grade.score)
+    entry["score"] = *grade.score;
+  entry["report"] = QString::fromStdString(report);
+  return entry;
+}
+
+QString Regrader::journalPath() const {
+  return m_options.outputFile + ".journal";
+}
+
+std::map<QString, QJsonObject> Regrader::readJournal() const {
+  std::map<QString, QJsonObject> entries;
+  QFile file(journalPath());
+  if (m_options.outputFile.isEmpty() || !file.open(QIODevice::ReadOnly))
+    return entries;
+  // Grades against another version of the catalogue are regraded, and a line
+  // cut short by the interruption is ignored.
+  const QString version =
+      QString::fromStdString(m_checker.getCatalogueVersion());
+  while (!file.atEnd()) {
+    const auto line = QJsonDocument::fromJson(file.readLine()).object();
+    if (line.value("catalogueVersion").toString() != version)
+      continue;
+    const QJsonObject entry = line.value("entry").toObject();
+    entries[entry.value("file").toString()] = entry;
+  }
+  return entries;
+}
+
+int Regrader::writeGradebook(const std::vector<QJsonObject> &entries) const {
+  QByteArray gradebook;
+  if (m_options.outputFile.endsWith(".csv", Qt::CaseInsensitive)) {
+    gradebook = "student,task,file,status,passed,tests,score\n";
+    for (const auto &entry : entries) {
+      QStringList fields;
+      for (const char *key : {"student", "task", "file", "status"})
+        fields << csvField(entry.value(key).toString());
+      fields << QString::number(entry.value("passed").toInt())
+             << QString::number(entry.value("tests").toInt())
+             << (entry.contains("score")
+                     ? QString::number(entry.value("score").toDouble())
+                     : QString());
+      gradebook += fields.join(",").toUtf8() + "\n";
+    }
+  } else {
+    int invalid = 0, passed = 0;
+    for (const auto &entry : entries) {
+      invalid += entry.value("status").toString() == "invalid";
+      passed += entry.value("tests").toInt() != 0 &&
+                entry.value("passed") == entry.value("tests");
+    }
+    QJsonObject summary;
+    summary["submissions"] = static_cast<int>(entries.size());
+    summary["passed"] = passed;
+    summary["invalid"] = invalid;
+    QJsonObject report;
+    report["catalogueVersion"] =
+        QString::fromStdString(m_checker.getCatalogueVersion());
+    report["summary"] = summary;
+    QJsonArray submissions;
+    for (const auto &entry : entries)
+      submissions.append(entry);
+    report["submissions"] = submissions;
+    gradebook = QJsonDocument(report).toJson(QJsonDocument::Indented);
+  }
+
+  if (m_options.outputFile.isEmpty()) {
+    std::cout << gradebook.toStdString() << std::flush;
+    return 0;
+  }
+  QFile outputFile(m_options.outputFile);
+  if (!outputFile.open(QIODevice::Truncate | QIODevice::WriteOnly)) {
+    std::cerr << "ERROR: Failed to open output file" << std::endl;
+    return 1;
+  }
+  outputFile.write(gradebook);
+  return 0;
+}
+
+} // namespace Ripes
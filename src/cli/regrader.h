@@ -0,0 +1,55 @@
+#pragma once
+
+#include "clioptions.h"
+#include "taskcheck/taskchecker.h"
+#include <QJsonObject>
+
+namespace Ripes {
+
+/// The Regrader class regrades a whole directory of stored submissions
+/// against the task catalogue (--regrade), such as after a test case of a task
+/// was fixed, and writes a gradebook of the grades.
+///
+/// Submissions are the assembly files (*.s, *.asm) within the directory and
+/// its subdirectories. A submission is named by its task, as in "1.2.s" for
+/// task 2 of section 1, and the path of its directory relative to the
+/// regraded directory names the student. The tests of all submissions are run
+/// on a shared pool of threads, one per core, such that small tasks still keep
+/// every core busy.
+///
+/// The grades of regraded submissions are journaled next to the gradebook,
+/// and an interrupted regrade resumes from the journal when rerun with the
+/// same gradebook and catalogue version.
+class Regrader {
+public:
+  Regrader(const CLIModeOptions &options);
+
+  /// Regrades all submissions and writes the gradebook. Returns non-zero if
+  /// the submissions or the gradebook could not be accessed.
+  int run();
+
+  struct Submission {
+    // Path relative to the regraded directory.
+    QString file;
+    QString student;
+    unsigned section = 0;
+    unsigned number = 0;
+  };
+
+  /// Returns the submissions within @p directory, ordered by path.
+  static std::vector<Submission> findSubmissions(const QString &directory);
+
+private:
+  /// Returns the gradebook entry of @p submission, graded by @p report.
+  QJsonObject entry(const Submission &submission,
+                    const std::string &report) const;
+  /// Reads the entries of the journal of an interrupted regrade.
+  std::map<QString, QJsonObject> readJournal() const;
+  QString journalPath() const;
+  int writeGradebook(const std::vector<QJsonObject> &entries) const;
+
+  CLIModeOptions m_options;
+  TaskChecker m_checker;
+};
+
+} // namespace Ripes
@@ -0,0 +1,249 @@
+#include "reportwriter.h"
+
+#include <QCborStreamWriter>
+#include <QCborValue>
+#include <QJsonValue>
+#include <QLocale>
+
+#include <cmath>
+#include <vector>
+
+namespace Ripes {
+
+namespace {
+
+// Writes JSON as QJsonDocument::toJson would; members separated by ": " and
+// nested levels indented by 4 spaces, or without whitespace if compact.
+class JSONReportWriter : public ReportWriter {
+public:
+  JSONReportWriter(QIODevice &device, bool indented)
+      : m_device(device), m_indented(indented) {}
+
+  void beginObject() override { open('{'); }
+  void endObject() override { close('}'); }
+  void beginArray() override { open('['); }
+  void endArray() override { close(']'); }
+  void key(const QString &key) override {
+    separate();
+    m_device.write(quoted(key));
+    m_device.write(m_indented ? ": " : ":");
+    m_afterKey = true;
+  }
+
+protected:
+  void scalar(const QVariant &value) override {
+    separate();
+    m_device.write(encode(value));
+  }
+
+private:
+  static QByteArray quoted(const QString &string) {
+    const QByteArray utf8 = string.toUtf8();
+    QByteArray out;
+    out.reserve(utf8.size() + 2);
+    out += '"';
+    for (const char c : utf8) {
+      switch (c) {
+      case '"':
+        out += "\\\"";
+        break;
+      case '\\':
+        out += "\\\\";
+        break;
+      case '\b':
+        out += "\\b";
+        break;
+      case '\f':
+        out += "\\f";
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      case '\r':
+        out += "\\r";
+        break;
+      case '\t':
+        out += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20)
+          out += "\\u" + QByteArray::number(static_cast<int>(c), 16)
+                             .rightJustified(4, '0');
+        else
+          out += c;
+      }
+    }
+    out += '"';
+    return out;
+  }
+
+  static QByteArray number(double value) {
+    // JSON has no infinity or NaN, which QJsonDocument writes as null.
+    return std::isfinite(value)
+               ? QByteArray::number(value, 'g', QLocale::FloatingPointShortest)
+               : QByteArray("null");
+  }
+
+  static QByteArray encode(const QVariant &value) {
+    switch (value.typeId()) {
+    case QMetaType::Bool:
+      return value.toBool() ? "true" : "false";
+    case QMetaType::Short:
+    case QMetaType::Int:
+    case QMetaType::Long:
+    case QMetaType::LongLong:
+      return QByteArray::number(value.toLongLong());
+    case QMetaType::UShort:
+    case QMetaType::UInt:
+    case QMetaType::ULong:
+    case QMetaType::ULongLong:
+      return QByteArray::number(value.toULongLong());
+    case QMetaType::Float:
+    case QMetaType::Double:
+      return number(value.toDouble());
+    default:
+      break;
+    }
+    // Other values are converted as by QJsonValue.
+    const QJsonValue json = QJsonValue::fromVariant(value);
+    if (json.isString())
+      return quoted(json.toString());
+    if (json.isBool())
+      return json.toBool() ? "true" : "false";
+    if (json.isDouble())
+      return number(json.toDouble());
+    return "null";
+  }
+
+  void open(char bracket) {
+    separate();
+    m_device.write(&bracket, 1);
+    m_empty.push_back(true);
+  }
+
+  void close(char bracket) {
+    m_empty.pop_back();
+    newline();
+    m_device.write(&bracket, 1);
+    // Indented documents end in a newline.
+    if (m_empty.empty() && m_indented)
+      m_device.write("\n");
+  }
+
+  // Starts a member or an element, separating it from the preceding one. The
+  // value of a member follows its key.
+  void separate() {
+    if (m_afterKey) {
+      m_afterKey = false;
+      return;
+    }
+    if (m_empty.empty())
+      return;
+    if (!m_empty.back())
+      m_device.write(",");
+    m_empty.back() = false;
+    newline();
+  }
+
+  void newline() {
+    if (!m_indented)
+      return;
+    m_device.write("\n");
+    m_device.write(QByteArray(4 * m_empty.size(), ' '));
+  }
+
+  QIODevice &m_device;
+  bool m_indented;
+  // Whether each open object and array is empty so far, innermost last.
+  std::vector<bool> m_empty;
+  bool m_afterKey = false;
+};
+
+// Writes CBOR maps and arrays of indefinite length.
+class CBORReportWriter : public ReportWriter {
+public:
+  explicit CBORReportWriter(QIODevice &device) : m_writer(&device) {}
+
+  void beginObject() override { m_writer.startMap(); }
+  void endObject() override { m_writer.endMap(); }
+  void beginArray() override { m_writer.startArray(); }
+  void endArray() override { m_writer.endArray(); }
+  void key(const QString &key) override { m_writer.append(key); }
+
+protected:
+  void scalar(const QVariant &value) override {
+    // Invalid values are written as null, as in JSON.
+    const QCborValue cbor =
+        value.isValid() ? QCborValue::fromVariant(value) : QCborValue(nullptr);
+    cbor.toCbor(m_writer);
+  }
+
+private:
+  QCborStreamWriter m_writer;
+};
+
+} // namespace
+
+std::optional<ReportWriter::Format>
+ReportWriter::parseFormat(const QString &format) {
+  if (format == "indented")
+    return Format::Indented;
+  if (format == "compact")
+    return Format::Compact;
+  if (format == "cbor")
+    return Format::CBOR;
+  return {};
+}
+
+std::unique_ptr<ReportWriter> ReportWriter::create(Format format,
+                                                   QIODevice &device) {
+  if (format == Format::CBOR)
+    return std::make_unique<CBORReportWriter>(device);
+  return std::make_unique<JSONReportWriter>(device,
+                                            format == Format::Indented);
+}
+
+void ReportWriter::value(const QVariant &value) {
+  switch (value.typeId()) {
+  case QMetaType::QVariantMap: {
+    const QVariantMap map = value.toMap();
+    beginObject();
+    for (auto it = map.cbegin(); it != map.cend(); ++it)
+      member(it.key(), it.value());
+    endObject();
+    return;
+  }
+  case QMetaType::QVariantHash: {
+    const QVariantHash hash = value.toHash();
+    QStringList keys = hash.keys();
+    keys.sort();
+    beginObject();
+    for (const auto &key : keys)
+      member(key, hash.value(key));
+    endObject();
+    return;
+  }
+  case QMetaType::QVariantList:
+  case QMetaType::QStringList: {
+    beginArray();
+    for (const auto &element : value.toList())
+      this->value(element);
+    endArray();
+    return;
+  }
+  case QMetaType::QJsonValue:
+  case QMetaType::QJsonObject:
+  case QMetaType::QJsonArray: {
+    const QJsonValue json = QJsonValue::fromVariant(value);
+    if (json.isObject() || json.isArray())
+      this->value(json.toVariant());
+    else
+      scalar(json.toVariant());
+    return;
+  }
+  default:
+    scalar(value);
+  }
+}
+
+} // namespace Ripes
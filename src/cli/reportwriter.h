@@ -0,0 +1,54 @@
+#pragma once
+
+#include <QIODevice>
+#include <QString>
+#include <QVariant>
+
+#include <memory>
+#include <optional>
+
+namespace Ripes {
+
+/**
+ * @brief The ReportWriter class
+ * Writes a report as a stream of objects, arrays, keys and values to a device,
+ * as they are written, such that the report is never held in memory as a
+ * whole. Writing a report costs memory proportional to the nesting depth of
+ * the report and the largest value written at once.
+ *
+ * Reports are written as indented JSON, as compact JSON or as CBOR. Within an
+ * object, each value must be preceded by its key.
+ */
+class ReportWriter {
+public:
+  enum class Format { Indented, Compact, CBOR };
+
+  static std::optional<Format> parseFormat(const QString &format);
+  /// Returns a writer of @p format to @p device, which must stay open while
+  /// the writer is used.
+  static std::unique_ptr<ReportWriter> create(Format format,
+                                              QIODevice &device);
+
+  virtual ~ReportWriter() {}
+
+  virtual void beginObject() = 0;
+  virtual void endObject() = 0;
+  virtual void beginArray() = 0;
+  virtual void endArray() = 0;
+  virtual void key(const QString &key) = 0;
+
+  /// Writes @p value. Maps are written as objects, with their keys sorted,
+  /// and lists as arrays.
+  void value(const QVariant &value);
+  /// Writes the key and value of a member of the current object.
+  void member(const QString &key, const QVariant &value) {
+    this->key(key);
+    this->value(value);
+  }
+
+protected:
+  /// Writes a value which is neither a map nor a list.
+  virtual void scalar(const QVariant &value) = 0;
+};
+
+} // namespace Ripes
@@ -0,0 +1,267 @@
+#include "roofline.h"
+#include "processorhandler.h"
+
+#include <QRegularExpression>
+#include <QSet>
+#include <QTextStream>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+
+namespace Ripes {
+
+// Operations per cycle of the processor models by microarchitecture, for
+// those retiring more than one instruction per cycle.
+static const std::map<QString, double> s_peakOpsPerCycle{
+    {"6S_DUAL", 2}, {"OOO_2W", 2}, {"OOO_4W", 4}, {"MH_2", 2}, {"MH_4", 4}};
+
+static QString hex(AInt address) {
+  return "0x" + QString::number(address, 16).rightJustified(8, '0');
+}
+
+static QString number(double value) {
+  return std::isinf(value) ? QString("inf") : QString::number(value, 'f', 3);
+}
+
+Roofline::InstrClass Roofline::classify(const QString &instr) {
+  QString mnemonic =
+      instr.section(' ', 0, 0, QString::SectionSkipEmpty).toLower();
+  // Compressed instructions are classified as their expansions.
+  if (mnemonic.startsWith("c."))
+    mnemonic = mnemonic.mid(2);
+
+  static const QSet<QString> s_memory{
+      "lb",   "lh",    "lw",    "lbu",   "lhu",   "lwu",   "ld",
+      "sb",   "sh",    "sw",    "sd",    "flw",   "fld",   "fsw",
+      "fsd",  "lwsp",  "ldsp",  "swsp",  "sdsp",  "flwsp", "fldsp",
+      "fswsp", "fsdsp"};
+  static const QSet<QString> s_control{"j",   "jal",  "jr",  "jalr",
+                                       "ret", "call", "tail"};
+  static const QSet<QString> s_system{"ecall", "ebreak", "fence", "fence.i",
+                                      "mret",  "sret",   "wfi",   "nop",
+                                      "syscall", "break", "unknown"};
+  // Unit-stride, strided and indexed vector loads and stores.
+  static const QRegularExpression s_vectorMemory("^v[ls](e|se|[uo]xei)\\d+");
+  // Conditional branches, excluding the single-bit instructions of Zbs.
+  static const QRegularExpression s_branch("^b(eq|ne|lt|le|gt|ge)");
+
+  if (s_memory.contains(mnemonic) || mnemonic.startsWith("amo") ||
+      mnemonic.startsWith("lr.") || mnemonic.startsWith("sc.") ||
+      s_vectorMemory.match(mnemonic).hasMatch())
+    return InstrClass::Memory;
+  if (s_control.contains(mnemonic) || s_branch.match(mnemonic).hasMatch())
+    return InstrClass::Control;
+  if (mnemonic.isEmpty() || s_system.contains(mnemonic) ||
+      mnemonic.startsWith("csr") || mnemonic.startsWith("vset"))
+    return InstrClass::System;
+  return InstrClass::Operation;
+}
+
+double Roofline::peakOpsPerCycle(ProcessorID id) {
+  const QString microarchitecture = enumToString<ProcessorID>(id).mid(5);
+  auto it = s_peakOpsPerCycle.find(microarchitecture);
+  return it != s_peakOpsPerCycle.end() ? it->second : 1;
+}
+
+double Roofline::Point::intensity() const {
+  return bytes == 0 ? std::numeric_limits<double>::infinity()
+                    : static_cast<double>(ops) / bytes;
+}
+
+double Roofline::Point::performance() const {
+  return cycles == 0 ? 0.0 : static_cast<double>(ops) / cycles;
+}
+
+Roofline::Roofline(const Profiler &profiler, CacheHierarchy &caches,
+                   ProcessorID id)
+    : m_peak(peakOpsPerCycle(id)) {
+  const unsigned wordBytes = ProcessorHandler::currentISA()->bytes();
+  const auto blockBytes = [&](const CacheSim &cache) {
+    return static_cast<long long>(cache.getBlocks()) * wordBytes;
+  };
+  std::vector<const CacheSim *> lastLevels = {&caches.l1i(), &caches.l1d()};
+  if (const auto *l2 = caches.l2())
+    lastLevels = {l2};
+  m_bandwidth = blockBytes(*lastLevels.back()) /
+                std::max(1.0, caches.memoryLatency());
+
+  std::map<QString, Point> bySymbol;
+  const auto *profile = profiler.profile();
+  if (profile) {
+    const auto &disassembled = profiler.program()->getDisassembled();
+    for (size_t i = 0; i < profile->cycles.size(); ++i) {
+      if (profile->cycles.at(i) == 0 && profile->retired.at(i) == 0)
+        continue;
+      const AInt address = profile->address(i);
+      const QString name = profiler.symbolOf(address);
+      // Points are addressed by the first profiled instruction of the symbol.
+      auto &point = bySymbol.try_emplace(name, Point{name, address})
+                        .first->second;
+      point.cycles += profile->cycles.at(i);
+      const auto instr = disassembled.getFromAddr(address);
+      if (instr && classify(*instr) == InstrClass::Operation)
+        point.ops += profile->retired.at(i);
+    }
+  }
+
+  m_total.name = "[total]";
+  m_total.cycles = profiler.totalCycles();
+  for (const auto *cache : lastLevels) {
+    for (const auto &[pc, counts] : cache->getPCAccesses()) {
+      const long long bytes = counts.misses * blockBytes(*cache);
+      m_total.bytes += bytes;
+      if (!profile || !profile->contains(pc))
+        continue;
+      if (auto it = bySymbol.find(profiler.symbolOf(pc)); it != bySymbol.end())
+        it->second.bytes += bytes;
+    }
+    m_total.bytes += cache->getWritebacks() * blockBytes(*cache);
+  }
+
+  for (const auto &it : bySymbol) {
+    m_total.ops += it.second.ops;
+    m_symbols.push_back(it.second);
+  }
+  std::stable_sort(m_symbols.begin(), m_symbols.end(),
+                   [](const Point &lhs, const Point &rhs) {
+                     return lhs.cycles > rhs.cycles;
+                   });
+}
+
+double Roofline::attainable(const Point &point) const {
+  return std::min(m_peak, point.intensity() * m_bandwidth);
+}
+
+bool Roofline::memoryBound(const Point &point) const {
+  return point.intensity() < ridge();
+}
+
+QString Roofline::plot() const {
+  constexpr int width = 64;
+  constexpr int height = 16;
+
+  std::vector<std::pair<QChar, const Point *>> marks = {{QChar('*'), &m_total}};
+  for (size_t i = 0; i < m_symbols.size() && i < 9; ++i)
+    marks.push_back({QChar('1' + int(i)), &m_symbols.at(i)});
+
+  // The axes are in log2 units, spanning the ridge point, the peak and every
+  // marked point. Points without memory traffic are drawn at the right edge.
+  double xLo = std::log2(ridge()), xHi = xLo;
+  const double yHi = std::log2(m_peak);
+  double yLo = yHi - 4;
+  for (const auto &mark : marks) {
+    const Point &point = *mark.second;
+    if (point.ops == 0)
+      continue;
+    if (point.bytes != 0) {
+      xLo = std::min(xLo, std::log2(point.intensity()));
+      xHi = std::max(xHi, std::log2(point.intensity()));
+    }
+    yLo = std::min(yLo, std::log2(point.performance()));
+  }
+  xLo = std::floor(xLo) - 1;
+  xHi = std::ceil(xHi) + 1;
+  yLo = std::floor(yLo);
+
+  const auto column = [&](double x) {
+    return std::clamp(int(std::lround((x - xLo) / (xHi - xLo) * (width - 1))),
+                      0, width - 1);
+  };
+  const auto row = [&](double y) {
+    return std::clamp(
+        int(std::lround((yHi - y) / (yHi - yLo) * (height - 1))), 0,
+        height - 1);
+  };
+
+  std::vector<QString> grid(height, QString(width, ' '));
+  const double bandwidth = std::log2(m_bandwidth);
+  for (int c = 0; c < width; ++c) {
+    const double x = xLo + c * (xHi - xLo) / (width - 1);
+    const double y = std::min(yHi, x + bandwidth);
+    grid[row(y)][c] = y < yHi ? '/' : '-';
+  }
+  for (const auto &[symbol, point] : marks) {
+    if (point->ops == 0)
+      continue;
+    const double x =
+        point->bytes == 0 ? xHi : std::log2(point->intensity());
+    grid[row(std::log2(point->performance()))][column(x)] = symbol;
+  }
+
+  const auto label = [](double exponent) {
+    return QString::number(std::exp2(exponent), 'g', 3);
+  };
+  const QString top = label(yHi), bottom = label(yLo);
+  const int margin = std::max(top.size(), bottom.size()) + 1;
+  QString out;
+  QTextStream stream(&out);
+  stream << "ops/cycle\n";
+  for (int r = 0; r < height; ++r) {
+    const QString axis = r == 0 ? top : r == height - 1 ? bottom : QString();
+    stream << axis.rightJustified(margin) << " |" << grid.at(r) << "\n";
+  }
+  stream << QString(margin + 1, ' ') << "+" << QString(width, '-') << "\n";
+  const QString left = label(xLo), right = label(xHi), title = "ops/byte";
+  const int gap = width - left.size() - right.size() - title.size();
+  stream << QString(margin + 2, ' ') << left << QString(gap / 2, ' ')
+         << title << QString(gap - gap / 2, ' ') << right << "\n";
+  return out;
+}
+
+QVariant Roofline::report(bool json) const {
+  if (json) {
+    const auto toMap = [&](const Point &point) {
+      QVariantMap m;
+      m["address"] = hex(point.address);
+      m["cycles"] = point.cycles;
+      m["ops"] = point.ops;
+      m["bytes"] = point.bytes;
+      // JSON has no infinity; the intensity is omitted without traffic.
+      if (point.bytes != 0)
+        m["ops/byte"] = point.intensity();
+      m["ops/cycle"] = point.performance();
+      m["attainable ops/cycle"] = attainable(point);
+      m["bound"] = memoryBound(point) ? "memory" : "compute";
+      return m;
+    };
+    QVariantMap m;
+    m["peak ops/cycle"] = m_peak;
+    m["bytes/cycle"] = m_bandwidth;
+    m["ridge ops/byte"] = ridge();
+    m["total"] = toMap(m_total);
+    QVariantList symbols;
+    for (const auto &point : m_symbols) {
+      auto symbol = toMap(point);
+      symbol["symbol"] = point.name;
+      symbols << symbol;
+    }
+    m["symbols"] = symbols;
+    return m;
+  }
+
+  QString out;
+  QTextStream stream(&out);
+  stream << "Peak " << number(m_peak) << " ops/cycle, memory bandwidth "
+         << number(m_bandwidth) << " bytes/cycle, ridge point "
+         << number(ridge()) << " ops/byte\n\n";
+  stream << qSetFieldWidth(12) << Qt::right << "ops" << "bytes" << "ops/byte"
+         << "ops/cycle" << "attainable" << qSetFieldWidth(0) << "  "
+         << Qt::left << "bound    symbol\n";
+  const auto writeRow = [&](const Point &point, const QString &name) {
+    stream << qSetFieldWidth(12) << Qt::right << point.ops << point.bytes
+           << number(point.intensity()) << number(point.performance())
+           << number(attainable(point)) << qSetFieldWidth(0) << "  "
+           << Qt::left << (memoryBound(point) ? "memory " : "compute") << "  "
+           << name << "\n";
+  };
+  writeRow(m_total, "* " + m_total.name);
+  for (size_t i = 0; i < m_symbols.size(); ++i)
+    writeRow(m_symbols.at(i), (i < 9 ? QString::number(i + 1) : " ") + " " +
+                                  m_symbols.at(i).name);
+  stream << "\n" << plot();
+  return out;
+}
+
+} // namespace Ripes
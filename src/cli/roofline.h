@@ -0,0 +1,87 @@
+#pragma once
+
+#include <QString>
+#include <QVariant>
+
+#include <vector>
+
+#include "cachesim/cachehierarchy.h"
+#include "processorregistry.h"
+#include "profiler.h"
+
+namespace Ripes {
+
+/// The Roofline class places a run, and each symbol of its program, on the
+/// roofline model of the processor and its cache hierarchy. The operational
+/// intensity of code is the number of operations it retires per byte of
+/// memory traffic, and its performance the number of operations it retires
+/// per cycle. Performance is bounded by the roofline
+///   attainable = min(peak, intensity * bandwidth),
+/// where the peak is the issue width of the processor (see peakOpsPerCycle),
+/// and the bandwidth is a block of the last cache level per memory latency,
+/// i.e. one outstanding miss at a time. Code of an intensity below the ridge
+/// point, peak / bandwidth, is memory-bound, and compute-bound otherwise.
+///
+/// Operations are the retired instructions profiled by a Profiler which are
+/// neither memory, control flow nor system instructions (see classify).
+/// Memory traffic is the blocks filled from memory by the demand misses of
+/// the last cache level; the L2 cache, or otherwise the L1 caches. Misses are
+/// attributed to the symbols of the instructions causing them (see
+/// CacheSim::getPCAccesses), whereas writebacks only count towards the
+/// traffic of the whole run. Blocks served by a victim cache are counted as
+/// memory traffic.
+class Roofline {
+public:
+  enum class InstrClass { Operation, Memory, Control, System };
+
+  /// Classifies the disassembled instruction @p instr by its mnemonic.
+  static InstrClass classify(const QString &instr);
+  /// Returns the operations per cycle which processor @p id can retire; its
+  /// issue width, times its harts.
+  static double peakOpsPerCycle(ProcessorID id);
+
+  struct Point {
+    QString name;
+    AInt address = 0;
+    long long cycles = 0;
+    long long ops = 0;
+    long long bytes = 0;
+
+    /// Operations per byte; infinite without memory traffic.
+    double intensity() const;
+    /// Operations per cycle.
+    double performance() const;
+  };
+
+  /// Evaluates the profile of @p profiler and the misses of @p caches, for a
+  /// run on processor @p id.
+  Roofline(const Profiler &profiler, CacheHierarchy &caches, ProcessorID id);
+
+  double peak() const { return m_peak; }
+  /// Memory bandwidth in bytes per cycle.
+  double bandwidth() const { return m_bandwidth; }
+  /// The intensity at which the roofline reaches the peak.
+  double ridge() const { return m_peak / m_bandwidth; }
+  double attainable(const Point &point) const;
+  bool memoryBound(const Point &point) const;
+
+  /// The whole run.
+  const Point &total() const { return m_total; }
+  /// The executed symbols, sorted by cycles.
+  const std::vector<Point> &symbols() const { return m_symbols; }
+
+  /// Returns the roofline and the points of the run and its symbols as a
+  /// table and a plot, or a map thereof if @p json is set.
+  QVariant report(bool json) const;
+  /// Returns a text plot of the roofline on logarithmic axes, marking the run
+  /// by '*' and its nine hottest symbols by their rank.
+  QString plot() const;
+
+private:
+  double m_peak = 1;
+  double m_bandwidth = 1;
+  Point m_total;
+  std::vector<Point> m_symbols;
+};
+
+} // namespace Ripes
@@ -0,0 +1,248 @@
+#include "sampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <map>
+
+#include "binutils.h"
+#include "cachesim/cachesim.h"
+#include "ripessettings.h"
+#include "simulationcontext.h"
+
+namespace Ripes {
+
+namespace {
+
+/// Minimal LRU, write-allocate cache model used for counting the hits and
+/// misses of the sampling windows. The CacheSim class records a per-cycle
+/// access trace for the GUI, which does not apply to the discontinuous cycle
+/// counts of sampled simulation.
+class SampledCache {
+public:
+  SampledCache(const CachePreset &preset, unsigned byteOffset)
+      : m_offsetBits(byteOffset + preset.blocks), m_lineBits(preset.lines),
+        m_ways(1u << preset.ways) {}
+
+  void access(AInt address) {
+    const AInt block = address >> m_offsetBits;
+    // Ways of a line are kept in most-recently-used order.
+    auto &ways = m_lines[block & vsrtl::generateBitmask(m_lineBits)];
+    auto it = std::find(ways.begin(), ways.end(), block);
+    if (it != ways.end()) {
+      hits++;
+      std::rotate(ways.begin(), it, it + 1);
+    } else {
+      misses++;
+      ways.insert(ways.begin(), block);
+      if (ways.size() > m_ways)
+        ways.pop_back();
+    }
+  }
+
+  long long hits = 0;
+  long long misses = 0;
+
+private:
+  unsigned m_offsetBits;
+  unsigned m_lineBits;
+  unsigned m_ways;
+  std::map<AInt, std::vector<AInt>> m_lines;
+};
+
+/// Returns the mean and 95% confidence interval (under a normal
+/// approximation) of @p samples.
+QVariantMap statistic(const std::vector<double> &samples) {
+  double mean = 0;
+  for (const double s : samples)
+    mean += s;
+  mean /= samples.empty() ? 1 : samples.size();
+
+  double ci = 0;
+  if (samples.size() > 1) {
+    double var = 0;
+    for (const double s : samples)
+      var += (s - mean) * (s - mean);
+    var /= samples.size() - 1;
+    ci = 1.96 * std::sqrt(var / samples.size());
+  }
+
+  QVariantMap m;
+  m["mean"] = mean;
+  m["ci95"] = ci;
+  return m;
+}
+
+void flushOutput(SimulationContext &context) {
+  if (!context.output().isEmpty()) {
+    std::cout << context.output().toStdString();
+    std::flush(std::cout);
+    context.clearOutput();
+  }
+}
+
+} // namespace
+
+Sampler::Sampler(const CLIModeOptions &options,
+                 const std::shared_ptr<Program> &program,
+                 const QByteArray &input)
+    : m_options(options), m_program(program), m_input(input) {}
+
+Sampler::~Sampler() {}
+
+void Sampler::transferState() {
+  auto *src = m_functional->processor();
+  auto *dst = m_detailed->processor();
+
+  // Restart the detailed model at the current PC of the functional model. This
+  // resets its memory to the initial program state.
+  dst->setPCInitialValue(src->getPcForStage({0, 0}));
+  m_detailed->reset();
+
+  std::vector<VInt> values;
+  for (const auto &regFile : src->implementsISA()->regInfos()) {
+    const auto &file = m_functional->registerFile(regFile->regFileName());
+    if (!file.valid())
+      continue;
+    values.resize(file.count);
+    src->readRegisters(file, values.data());
+    for (unsigned i = 0; i < file.count; i++)
+      dst->setRegister(file.rfid, i, values[i]);
+  }
+
+  auto &srcMem = src->getMemory();
+  auto &dstMem = dst->getMemory();
+  for (const AInt page : m_functional->writtenPages()) {
+    for (AInt addr = page; addr < page + SimulationContext::s_trackedPageSize;
+         addr += 4)
+      dstMem.writeMem(addr, srcMem.readMemConst(addr, 4), 4);
+  }
+}
+
+bool Sampler::run(QString &errorMessage) {
+  const auto &sampling = m_options.sampling;
+  const auto &isa = ProcessorRegistry::getDescription(m_options.proc).isaInfo();
+  const ProcessorID functionalID =
+      isa.isa->bits() == 64 ? ProcessorID::RV64_ISS : ProcessorID::RV32_ISS;
+  const auto &functionalISA =
+      ProcessorRegistry::getDescription(functionalID).isaInfo();
+  if (isa.isa->isaID() != functionalISA.isa->isaID()) {
+    errorMessage = "Sampled simulation is not supported for processor '" +
+                   enumToString<ProcessorID>(m_options.proc) + "'";
+    return false;
+  }
+  for (const auto &ext : m_options.isaExtensions) {
+    if (!functionalISA.supportedExtensions.contains(ext)) {
+      errorMessage = "ISA extension '" + ext +
+                     "' is not supported by the functional simulator";
+      return false;
+    }
+  }
+
+  const auto presets = RipesSettings::value(RIPES_SETTING_CACHE_PRESETS)
+                           .value<QList<CachePreset>>();
+  if (presets.empty()) {
+    errorMessage = "Sampled simulation requires a cache preset, of which none "
+                   "are configured in the settings";
+    return false;
+  }
+
+  m_functional = std::make_unique<SimulationContext>(
+      functionalID, m_options.isaExtensions, m_options.regInit);
+  m_functional->setTrackWrittenPages(true);
+  m_functional->loadProgram(m_program);
+  m_functional->putStdInData(m_input);
+  m_detailed = std::make_unique<SimulationContext>(
+      m_options.proc, m_options.isaExtensions, m_options.regInit);
+  m_detailed->setExecuteSyscalls(false);
+  m_detailed->loadProgram(m_program);
+
+  const CachePreset preset = presets.front();
+  const unsigned byteOffset = log2Ceil(isa.isa->bytes());
+  SampledCache icache(preset, byteOffset);
+  SampledCache dcache(preset, byteOffset);
+  const auto accessCaches = [&](const RipesProcessor *proc) {
+    for (const auto &record : proc->clockBatch()) {
+      if (record.instrAccess.type != MemoryAccess::None)
+        icache.access(record.instrAccess.address);
+      if (record.dataAccess.type != MemoryAccess::None)
+        dcache.access(record.dataAccess.address);
+    }
+  };
+
+  auto *functional = m_functional->processor();
+  const auto runFunctional = [&](long long instructions, bool warm) {
+    const long long target =
+        functional->getInstructionsRetired() + instructions;
+    m_functional->runUntil(
+        [&] { return functional->getInstructionsRetired() >= target; },
+        [&] {
+          if (warm)
+            accessCaches(functional);
+        });
+    flushOutput(*m_functional);
+    return functional->finished() ||
+           functional->getInstructionsRetired() >= target;
+  };
+
+  // Number of instructions executed by the last detailed window, which the
+  // functional model must re-execute.
+  long long catchUp = 0;
+  while (!functional->finished()) {
+    if (!runFunctional(catchUp + sampling.fastForward, false) ||
+        !runFunctional(sampling.warmup, true)) {
+      errorMessage = "Functional simulation stopped before finishing";
+      return false;
+    }
+    if (functional->finished())
+      break;
+
+    // Detailed window
+    transferState();
+    auto *detailed = m_detailed->processor();
+    const long long icacheHits = icache.hits, icacheMisses = icache.misses;
+    const long long dcacheHits = dcache.hits, dcacheMisses = dcache.misses;
+    // Bound the window in cycles, in case the detailed model stalls.
+    const long long maxCycles = 100ll * sampling.window + 1000;
+    m_detailed->runUntil(
+        [&] {
+          return detailed->getInstructionsRetired() >= sampling.window ||
+                 detailed->getCycleCount() >= maxCycles;
+        },
+        [&] { accessCaches(detailed); });
+
+    const long long retired = detailed->getInstructionsRetired();
+    // Always progress, even if the window was cut short by a system call.
+    catchUp = std::max(retired, 1ll);
+    if (retired == 0)
+      continue;
+    m_detailedInstructions += retired;
+    m_cpi.push_back(static_cast<double>(detailed->getCycleCount()) / retired);
+    const auto hitRate = [](long long hits, long long misses) {
+      return static_cast<double>(hits) / (hits + misses);
+    };
+    if (icache.hits + icache.misses != icacheHits + icacheMisses)
+      m_icacheHitRate.push_back(
+          hitRate(icache.hits - icacheHits, icache.misses - icacheMisses));
+    if (dcache.hits + dcache.misses != dcacheHits + dcacheMisses)
+      m_dcacheHitRate.push_back(
+          hitRate(dcache.hits - dcacheHits, dcache.misses - dcacheMisses));
+  }
+  return true;
+}
+
+QVariantMap Sampler::report() const {
+  QVariantMap m;
+  m["samples"] = static_cast<qulonglong>(m_cpi.size());
+  m["instructions"] = m_functional ? static_cast<qlonglong>(
+                                         m_functional->processor()
+                                             ->getInstructionsRetired())
+                                   : 0;
+  m["detailed instructions"] = static_cast<qlonglong>(m_detailedInstructions);
+  m["CPI"] = statistic(m_cpi);
+  m["icache hit rate"] = statistic(m_icacheHitRate);
+  m["dcache hit rate"] = statistic(m_dcacheHitRate);
+  return m;
+}
+
+} // namespace Ripes
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QVariantMap>
+
+#include <memory>
+
+#include "assembler/program.h"
+#include "clioptions.h"
+
+namespace Ripes {
+
+class SimulationContext;
+
+/// The Sampler class implements sampled simulation of a program. The program
+/// is executed in full by the functional instruction-set simulator. At regular
+/// intervals, the architectural and memory state of the functional simulator
+/// is transferred to the detailed processor model, which then simulates a
+/// window of instructions to measure CPI and cache behaviour. Each sampling
+/// period consists of:
+/// - fast-forward: functional execution of the instructions of the previous
+///   detailed window, followed by SamplingOptions::fastForward instructions.
+/// - warm-up: functional execution of SamplingOptions::warmup instructions,
+///   during which the instruction and data caches are warmed.
+/// - detailed window: detailed simulation of SamplingOptions::window
+///   instructions, starting from the state at the end of the warm-up. The
+///   detailed window runs on a copy of the state, and system calls end a
+///   detailed window early, such that they are only executed by the
+///   functional simulator.
+/// Cache statistics are gathered for the first cache preset of the settings.
+/// The console input of the program is read by the functional simulator.
+class Sampler {
+public:
+  Sampler(const CLIModeOptions &options,
+          const std::shared_ptr<Program> &program,
+          const QByteArray &input = QByteArray());
+  ~Sampler();
+
+  /// Runs the sampled simulation to completion. Returns false and sets
+  /// @p errorMessage on failure.
+  bool run(QString &errorMessage);
+
+  /// Returns the sampled statistics (number of samples, and the mean and 95%
+  /// confidence interval of CPI and cache hit rates).
+  QVariantMap report() const;
+
+private:
+  void transferState();
+
+  CLIModeOptions m_options;
+  std::shared_ptr<Program> m_program;
+  QByteArray m_input;
+  std::unique_ptr<SimulationContext> m_functional;
+  std::unique_ptr<SimulationContext> m_detailed;
+
+  std::vector<double> m_cpi;
+  std::vector<double> m_icacheHitRate;
+  std::vector<double> m_dcacheHitRate;
+  long long m_detailedInstructions = 0;
+};
+
+} // namespace Ripes
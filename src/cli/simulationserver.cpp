@@ -0,0 +1,210 @@
+#include "simulationserver.h"
+#include "batchrunner.h"
+#include "processorhandler.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QScopeGuard>
+#include <QTemporaryFile>
+
+#include <algorithm>
+#include <iostream>
+#include <mutex>
+#include <string>
+
+namespace Ripes {
+
+SimulationServer::SimulationServer(const CLIModeOptions &options)
+    : m_options(options) {
+  m_options.server = false;
+  // The console is reserved for requests and responses.
+  m_options.verbose = false;
+  for (const auto &telemetry : m_options.telemetry)
+    m_defaultTelemetry.push_back(telemetry->isEnabled());
+}
+
+int SimulationServer::run() {
+  std::string line;
+  while (std::getline(std::cin, line)) {
+    if (QString::fromStdString(line).trimmed().isEmpty())
+      continue;
+
+    QJsonParseError parseError;
+    const auto doc =
+        QJsonDocument::fromJson(QByteArray::fromStdString(line), &parseError);
+    QJsonObject response;
+    if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+      response["status"] = "invalid";
+      response["errors"] = QJsonArray{
+          "Invalid request: expected a JSON object on a single line"};
+    } else {
+      response = handle(doc.object());
+    }
+    std::cout << QJsonDocument(response).toJson(QJsonDocument::Compact).data()
+              << std::endl;
+  }
+  return 0;
+}
+
+QJsonObject SimulationServer::handle(const QJsonObject &request) {
+  QJsonObject response;
+  if (request.contains("id"))
+    response["id"] = request.value("id");
+  const auto invalid = [&](const QString &errorMessage) {
+    response["status"] = "invalid";
+    response["errors"] = QJsonArray{errorMessage};
+    return response;
+  };
+
+  if (request.contains("task")) {
+    const QJsonObject result = grade(request);
+    for (auto it = result.begin(); it != result.end(); ++it)
+      response[it.key()] = it.value();
+    return response;
+  }
+
+  // Inline programs are run from a temporary file, which lives until the job
+  // has finished.
+  QJsonObject entry = request;
+  QTemporaryFile programFile;
+  if (request.contains("program") || request.contains("binary")) {
+    const QByteArray program =
+        request.contains("program")
+            ? request.value("program").toString().toUtf8()
+            : QByteArray::fromBase64(
+                  request.value("binary").toString().toLatin1());
+    if (!programFile.open() || programFile.write(program) != program.size() ||
+        !programFile.flush())
+      return invalid("Failed to write the program to a temporary file");
+    entry["source"] = programFile.fileName();
+    if (request.contains("binary") && !request.contains("type"))
+      entry["type"] = "bin";
+  }
+
+  QString errorMessage;
+  if (!selectTelemetry(request.value("telemetry"), errorMessage))
+    return invalid(errorMessage);
+
+  auto job = BatchRunner::parseJob(entry, QDir::currentPath(), m_options);
+  // Inline console input is served from memory.
+  if (request.value("input").isString())
+    job.options.stdinData = request.value("input").toString().toUtf8();
+  const QJsonObject result = BatchRunner::runJob(job);
+  for (auto it = result.begin(); it != result.end(); ++it)
+    response[it.key()] = it.value();
+  return response;
+}
+
+QJsonObject SimulationServer::grade(const QJsonObject &request) {
+  QJsonObject response;
+  const auto invalid = [&](const QString &errorMessage) {
+    response["status"] = "invalid";
+    response["errors"] = QJsonArray{errorMessage};
+    return response;
+  };
+
+  if (!request.value("program").isString())
+    return invalid("No program specified");
+  if (request.contains("processor")) {
+    ProcessorID id;
+    QString errorMessage;
+    if (!parseProcessorID(request.value("processor").toString(), id,
+                          errorMessage))
+      return invalid(errorMessage);
+    QStringList extensions;
+    for (const auto &ext : request.value("extensions").toArray())
+      extensions << ext.toString();
+    if (!validateISAExtensions(id, extensions, errorMessage))
+      return invalid(errorMessage);
+    ProcessorHandler::reselectProcessor(id, extensions);
+  }
+
+  if (!m_taskChecker)
+    m_taskChecker = std::make_unique<TaskChecker>();
+  const QJsonObject task = request.value("task").toObject();
+  const Task *current =
+      m_taskChecker->findTask(task.value("section").toInt(-1),
+                              task.value("number").toInt(-1));
+  if (!current)
+    return invalid("Unknown task");
+
+  // With 'progress' set, a progress line is written per test as it completes,
+  // from the thread running the test, ahead of the response.
+  std::mutex progressMutex;
+  if (request.value("progress").toBool()) {
+    const QJsonValue id = request.value("id");
+    m_taskChecker->setTestObserver(
+        [&, id](size_t test, size_t tests, const std::string &answer) {
+          QJsonObject progress;
+          if (!id.isUndefined())
+            progress["id"] = id;
+          progress["status"] = "progress";
+          progress["test"] = static_cast<int>(test + 1);
+          progress["tests"] = static_cast<int>(tests);
+          progress["answer"] = QString::fromStdString(answer);
+          const QByteArray line =
+              QJsonDocument(progress).toJson(QJsonDocument::Compact);
+          std::lock_guard<std::mutex> lock(progressMutex);
+          std::cout << line.data() << std::endl;
+        });
+  }
+  const auto resetObserver =
+      qScopeGuard([&] { m_taskChecker->setTestObserver(nullptr); });
+
+  QElapsedTimer timer;
+  timer.start();
+  const std::string report =
+      m_taskChecker->checkTask(request.value("program").toString(), *current);
+  const auto grade = TaskChecker::parseGrade(report);
+  response["status"] = "ok";
+  response["seconds"] = timer.elapsed() / 1000.0;
+  response["report"] = QString::fromStdString(report);
+  response["passed"] = static_cast<int>(grade.passed);
+  response["tests"] = static_cast<int>(grade.tests);
+  if (grade.score)
+    response["score"] = *grade.score;
+  return response;
+}
+
+bool SimulationServer::selectTelemetry(const QJsonValue &selection,
+                                       QString &errorMessage) {
+  auto &telemetry = m_options.telemetry;
+  if (selection.isUndefined()) {
+    for (unsigned i = 0; i < telemetry.size(); ++i) {
+      if (m_defaultTelemetry.at(i))
+        telemetry.at(i)->enable();
+      else
+        telemetry.at(i)->disable();
+    }
+    return true;
+  }
+
+  QStringList keys;
+  if (selection.isArray()) {
+    for (const auto &key : selection.toArray())
+      keys << key.toString();
+  } else {
+    keys << selection.toString();
+  }
+  const bool all = keys.contains("all");
+  for (const auto &key : keys) {
+    if (key == "all")
+      continue;
+    if (std::none_of(telemetry.begin(), telemetry.end(),
+                     [&](const auto &t) { return t->key() == key; })) {
+      errorMessage = "Unknown telemetry '" + key + "'";
+      return false;
+    }
+  }
+  for (auto &t : telemetry) {
+    if (all || keys.contains(t->key()))
+      t->enable();
+    else
+      t->disable();
+  }
+  return true;
+}
+
+} // namespace Ripes
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "clioptions.h"
+#include "taskcheck/taskchecker.h"
+#include <QJsonObject>
+
+#include <memory>
+
+namespace Ripes {
+
+/// The SimulationServer class keeps Ripes running and runs jobs as they are
+/// requested (--server), such that clients running many short simulations do
+/// not pay the startup of Ripes for each of them.
+///
+/// Requests are read from stdin as JSON objects, one per line, and a response
+/// is written to stdout as a single line of JSON per request, in the order of
+/// the requests. A request specifies a job as an entry of a --batch manifest,
+/// with the program given either as a 'source' path, as assembly text in
+/// 'program', or as a base64-encoded flat binary in 'binary', and its console
+/// input optionally given as text in 'input'. 'telemetry' optionally lists the
+/// keys of the telemetry to report (or "all"), and an 'id' is echoed in the
+/// response. Consecutive jobs on the same processor reset the
+/// processor instead of reconstructing it.
+///
+/// A request with a 'task' field instead grades the inline 'program' against
+/// the tests of a task of the task catalogue (see TaskChecker), on the
+/// optionally given 'processor' and 'extensions'. If its 'progress' field is
+/// set, a line with the 'status' "progress" and the index ('test', 1-based),
+/// count ('tests') and 'answer' of each test is written as the test completes,
+/// ahead of the response.
+class SimulationServer {
+public:
+  SimulationServer(const CLIModeOptions &options);
+
+  /// Serves requests until stdin is closed.
+  int run();
+
+private:
+  QJsonObject handle(const QJsonObject &request);
+  QJsonObject grade(const QJsonObject &request);
+
+  /// Enables the telemetry listed by @p selection, or the telemetry selected
+  /// on the command line if @p selection is undefined.
+  bool selectTelemetry(const QJsonValue &selection, QString &errorMessage);
+
+  CLIModeOptions m_options;
+  // Telemetry enabled on the command line.
+  std::vector<bool> m_defaultTelemetry;
+  // Created upon the first grading request.
+  std::unique_ptr<TaskChecker> m_taskChecker;
+};
+
+} // namespace Ripes
@@ -2,9 +2,27 @@
 
 #include <QTextStream>
 
+#include "cachesim/cachehierarchy.h"
+#include "cachesim/cachesweep.h"
+#include "cachesim/missattribution.h"
+#include "cachesim/mmu.h"
+#include "cachesim/reuseanalysis.h"
+#include "isa/rv_custom_ext.h"
+#include "memoryfootprint.h"
 #include "pipelinediagrammodel.h"
+#include "pipelinetrace.h"
 #include "processorhandler.h"
+#include "energy.h"
+#include "profiler.h"
+#include "roofline.h"
+#include "processors/RISC-V/rv6s_dual/rv6s_dual_waycontrol.h"
+#include "processors/RISC-V/rv_decode.h"
+#include "processors/RISC-V/rv_fetchqueue.h"
+#include "processors/RISC-V/rv_targetpredictor.h"
+#include "processors/RISC-V/rvmh/coherence.h"
+#include "processors/interface/simprofiler.h"
 #include "radix.h"
+#include "reportwriter.h"
 
 #include <memory>
 
@@ -20,6 +38,12 @@ public:
   // set, indicates that the output is intended for JSON export.
   virtual QVariant report(bool /*json*/) = 0;
 
+  // Writes the report intended for JSON export to 'writer'. Telemetries with
+  // large reports override this to write them without building a QVariant.
+  virtual void write(ReportWriter &writer) {
+    writer.value(report(/*json=*/true));
+  }
+
   // Returns the name of this telemetry.
   virtual QString key() const = 0;
 
@@ -71,6 +95,43 @@ class IPCTelemetry : public Telemetry {
   }
 };
 
+/// The estimated energy of the run (see EnergyEstimate).
+class EnergyTelemetry : public Telemetry {
+public:
+  static constexpr const char *s_key = "energy";
+  void enable() override {
+    m_profiler.reset();
+    m_hierarchy.reset();
+    Telemetry::enable();
+  }
+
+  QString key() const override { return s_key; }
+  QString description() const override {
+    return "estimated energy per instruction class, register file access, "
+           "cache level, DRAM access and static power, and the energy-delay "
+           "product (see --energymodel)";
+  }
+  QVariant report(bool json) override {
+    if (!m_profiler)
+      return QVariant();
+    return EnergyEstimate(m_model, *m_profiler, m_hierarchy.get())
+        .report(json);
+  }
+
+  void setModel(const EnergyModel &model) { m_model = model; }
+  void setHierarchy(const std::shared_ptr<CacheHierarchy> &hierarchy) {
+    m_hierarchy = hierarchy;
+  }
+  void setProfiler(const std::shared_ptr<Profiler> &profiler) {
+    m_profiler = profiler;
+  }
+
+private:
+  EnergyModel m_model;
+  std::shared_ptr<CacheHierarchy> m_hierarchy;
+  std::shared_ptr<Profiler> m_profiler;
+};
+
 class CyclesTelemetry : public Telemetry {
   QString key() const override { return "cycles"; }
   QString description() const override { return "cycles"; }
@@ -88,25 +149,438 @@ class InstrsRetiredTelemetry : public Telemetry {
   }
 };
 
+/// Wall-clock timings of the phases of a run, and the speed of the simulator
+/// during the run phase. The timings are set by the CLIRunner.
+class SimSpeedTelemetry : public Telemetry {
+public:
+  static constexpr const char *s_key = "simspeed";
+  struct Timings {
+    double construction = 0;
+    double loading = 0;
+    double run = 0;
+  };
+
+  void enable() override {
+    m_timings = Timings();
+    Telemetry::enable();
+  }
+
+  QString key() const override { return s_key; }
+  QString prettyKey() const override { return "simulation speed"; }
+  QString description() const override {
+    return "simulation speed (wall-clock time of model construction, loading "
+           "and the run, and simulated cycles and instructions per second)";
+  }
+  QVariant report(bool /*json*/) override {
+    const auto *proc = ProcessorHandler::getProcessor();
+    const double run = m_timings.run;
+    QVariantMap m;
+    m["construction seconds"] = m_timings.construction;
+    m["loading seconds"] = m_timings.loading;
+    m["run seconds"] = run;
+    m["cycles per second"] = run == 0 ? 0.0 : proc->getCycleCount() / run;
+    m["instructions per second"] =
+        run == 0 ? 0.0 : proc->getInstructionsRetired() / run;
+    return m;
+  }
+
+  Timings &timings() { return m_timings; }
+
+private:
+  Timings m_timings;
+};
+
+/// The wall time and calls of the hot paths of the simulator during the run
+/// (see SimProfiler).
+class SimProfileTelemetry : public Telemetry {
+public:
+  void enable() override {
+    SimProfiler::enable();
+    Telemetry::enable();
+  }
+  void disable() override {
+    SimProfiler::disable();
+    Telemetry::disable();
+  }
+
+  QString key() const override { return "simprofile"; }
+  QString prettyKey() const override { return "simulator profile"; }
+  QString description() const override {
+    return "wall-clock time and calls of the simulator hot paths (VSRTL "
+           "propagation, signal dispatch, cache shims and system calls)";
+  }
+  QVariant report(bool /*json*/) override {
+    const auto results = SimProfiler::results();
+    double total = 0;
+    for (const auto &entry : results)
+      total += entry.seconds;
+    QVariantMap m;
+    for (unsigned i = 0; i < SimProfiler::NCategories; ++i) {
+      const auto &entry = results.at(i);
+      QVariantMap category;
+      category["seconds"] = entry.seconds;
+      category["calls"] = static_cast<qint64>(entry.calls);
+      category["share"] = total == 0 ? 0.0 : entry.seconds / total;
+      m[SimProfiler::name(SimProfiler::Category(i))] = category;
+    }
+    return m;
+  }
+};
+
+/// The bytes held by the components of Ripes which grow over a run, and their
+/// budgets (see MemoryFootprint).
+class MemoryFootprintTelemetry : public Telemetry {
+public:
+  QString key() const override { return "footprint"; }
+  QString prettyKey() const override { return "memory footprint"; }
+  QString description() const override {
+    return "bytes held by the rewind stacks, cache traces, disassembly and "
+           "guest memory, and their budgets";
+  }
+  QVariant report(bool /*json*/) override {
+    const auto measurement = MemoryFootprint::measure();
+    QVariantMap m;
+    qint64 total = 0;
+    for (unsigned i = 0; i < MemoryFootprint::NComponents; ++i) {
+      const auto component = MemoryFootprint::Component(i);
+      QVariantMap entry;
+      entry["bytes"] = static_cast<qint64>(measurement[i]);
+      if (const size_t budget = MemoryFootprint::budget(component)) {
+        entry["budget"] = static_cast<qint64>(budget);
+        entry["over budget"] = measurement[i] > budget;
+      }
+      m[MemoryFootprint::name(component)] = entry;
+      total += measurement[i];
+    }
+    m["total bytes"] = total;
+    return m;
+  }
+};
+
+class DecodeCacheTelemetry : public Telemetry {
+public:
+  void enable() override {
+    // Processors reused by the next run keep the counts of previous runs.
+    if (auto *design = dynamic_cast<vsrtl::SimComponent *>(
+            ProcessorHandler::getProcessorNonConst()))
+      vsrtl::core::resetDecodeCacheStats(*design);
+    Telemetry::enable();
+  }
+
+  QString key() const override { return "decodecache"; }
+  QString prettyKey() const override { return "decode cache"; }
+  QString description() const override {
+    return "decoded-instruction cache statistics";
+  }
+  QVariant report(bool /*json*/) override {
+    const auto *design = dynamic_cast<const vsrtl::SimComponent *>(
+        ProcessorHandler::getProcessor());
+    const auto stats = design ? vsrtl::core::decodeCacheStats(*design)
+                              : vsrtl::core::DecodeCacheStats();
+    QVariantMap m;
+    m["hits"] = stats.hits;
+    m["misses"] = stats.misses;
+    m["hit rate"] = stats.hitRate();
+    return m;
+  }
+};
+
+/// Base class of the telemetry reporting the performance counters of the
+/// processor model (see RipesProcessor::performanceCounters). Reports nothing
+/// for processors which do not maintain performance counters.
+class PerformanceCounterTelemetry : public Telemetry {
+public:
+  void enable() override {
+    ProcessorHandler::setPerformanceCounting(true);
+    Telemetry::enable();
+  }
+
+  QVariant report(bool json) override {
+    const auto *proc = ProcessorHandler::getProcessor();
+    if (!(proc->features() & RipesProcessor::hasPerformanceCounters))
+      return QVariant();
+    return reportCounters(proc->performanceCounters(), json);
+  }
+
+protected:
+  virtual QVariant reportCounters(const PerformanceCounters &counters,
+                                  bool json) = 0;
+
+  /// Returns the per-stage values of @p value, keyed by stage name.
+  template <typename F>
+  static QVariantMap perStage(const PerformanceCounters &counters,
+                              const F &value) {
+    const auto *proc = ProcessorHandler::getProcessor();
+    const bool multiLane = proc->structure().size() > 1;
+    QVariantMap m;
+    for (auto idx : proc->structure().stageIt()) {
+      QString name = proc->stageName(idx);
+      if (multiLane)
+        name += " (lane " + QString::number(idx.lane()) + ")";
+      auto it = counters.stages.find(idx);
+      m[name] = it != counters.stages.end() ? value(it->second) : 0;
+    }
+    return m;
+  }
+
+  static double rate(long long count, long long total) {
+    return total != 0 ? static_cast<double>(count) / total : 0.0;
+  }
+};
+
+class StallTelemetry : public PerformanceCounterTelemetry {
+  QString key() const override { return "stalls"; }
+  QString prettyKey() const override { return "stall cycles"; }
+  QString description() const override { return "stall cycles per stage"; }
+  QVariant reportCounters(const PerformanceCounters &counters, bool) override {
+    return perStage(counters, [](const auto &stage) { return stage.stalled; });
+  }
+};
+
+class FlushTelemetry : public PerformanceCounterTelemetry {
+  QString key() const override { return "flushes"; }
+  QString prettyKey() const override { return "flush cycles"; }
+  QString description() const override { return "flush cycles per stage"; }
+  QVariant reportCounters(const PerformanceCounters &counters, bool) override {
+    return perStage(counters, [](const auto &stage) { return stage.flushed; });
+  }
+};
+
+class HazardTelemetry : public PerformanceCounterTelemetry {
+  QString key() const override { return "hazards"; }
+  QString description() const override {
+    return "data hazard, load-use hazard, way hazard, memory stall and "
+           "functional unit stall cycles";
+  }
+  QVariant reportCounters(const PerformanceCounters &counters, bool) override {
+    long long wayHazards = 0;
+    for (const auto &stage : counters.stages)
+      wayHazards += stage.second.wayHazard;
+    QVariantMap m;
+    m["data hazards"] = counters.dataHazards;
+    m["load-use hazards"] = counters.loadUseHazards;
+    m["way hazards"] = wayHazards;
+    m["memory stalls"] = counters.memoryStalls;
+    m["functional unit stalls"] = counters.functionalUnitStalls;
+    return m;
+  }
+};
+
+class ForwardingTelemetry : public PerformanceCounterTelemetry {
+  QString key() const override { return "forwards"; }
+  QString prettyKey() const override { return "forwarded operands"; }
+  QString description() const override {
+    return "operands forwarded to the execute stage";
+  }
+  QVariant reportCounters(const PerformanceCounters &counters, bool) override {
+    return counters.forwards;
+  }
+};
+
+class BranchTelemetry : public PerformanceCounterTelemetry {
+  QString key() const override { return "branches"; }
+  QString description() const override {
+    return "branches taken, mispredicted control flow and, for processors "
+           "with target predictors, hits and misses of the targets of returns "
+           "and indirect jumps";
+  }
+  QVariant reportCounters(const PerformanceCounters &counters, bool) override {
+    QVariantMap m;
+    m["branches"] = counters.branches;
+    m["taken"] = counters.branchesTaken;
+    m["taken rate"] = rate(counters.branchesTaken, counters.branches);
+    m["mispredicts"] = counters.mispredicts;
+    if (dynamic_cast<const TargetPredictionProcessor *>(
+            ProcessorHandler::getProcessor())) {
+      const auto targets = [](const PerformanceCounters::TargetPredictions &t) {
+        QVariantMap m;
+        m["hits"] = t.hits;
+        m["misses"] = t.misses;
+        m["hit rate"] = rate(t.hits, t.hits + t.misses);
+        return m;
+      };
+      m["returns"] = targets(counters.returns);
+      m["indirect jumps"] = targets(counters.indirectJumps);
+    }
+    return m;
+  }
+};
+
+class FrontEndTelemetry : public PerformanceCounterTelemetry {
+  QString key() const override { return "frontend"; }
+  QString prettyKey() const override { return "front end"; }
+  QString description() const override {
+    return "cycles stalled on the fetch queue running empty (fetch stalls) "
+           "and on the pipeline behind it (backend stalls), for processors "
+           "with a fetch queue";
+  }
+  QVariant reportCounters(const PerformanceCounters &counters, bool) override {
+    const auto *proc = dynamic_cast<const FetchQueueProcessor *>(
+        ProcessorHandler::getProcessor());
+    if (!proc || proc->fetchQueue().entries == 0)
+      return QVariant();
+    QVariantMap m;
+    m["fetch stalls"] = counters.fetchStalls;
+    m["backend stalls"] = counters.backendStalls;
+    m["fetch-bound rate"] = rate(counters.fetchStalls,
+                                 counters.fetchStalls + counters.backendStalls);
+    return m;
+  }
+};
+
+class DualIssueTelemetry : public PerformanceCounterTelemetry {
+  QString key() const override { return "dualissue"; }
+  QString prettyKey() const override { return "dual issue"; }
+  QString description() const override {
+    return "dual-issue pairing rate and pairing failures by reason (dual-issue "
+           "processors)";
+  }
+  QVariant reportCounters(const PerformanceCounters &counters, bool) override {
+    const auto *proc = ProcessorHandler::getProcessor();
+    if (proc->structure().size() < 2)
+      return QVariant();
+    QVariantMap m;
+    m["issue cycles"] = counters.issueCycles;
+    m["dual-issue cycles"] = counters.dualIssueCycles;
+    m["pairing rate"] = rate(counters.dualIssueCycles, counters.issueCycles);
+    if (dynamic_cast<const DualIssueProcessor *>(proc)) {
+      const auto &failures = counters.pairingFailures;
+      QVariantMap f;
+      f["control flow"] = failures.controlflow;
+      f["structural"] = failures.structural;
+      f["ecall"] = failures.ecall;
+      f["dependence"] = failures.dependence;
+      f["policy"] = failures.policy;
+      m["pairing failures"] = f;
+    }
+    return m;
+  }
+};
+
+class CustomInstructionTelemetry : public PerformanceCounterTelemetry {
+  QString key() const override { return "custom"; }
+  QString prettyKey() const override { return "custom instructions"; }
+  QString description() const override {
+    return "retired custom instructions, by name (when custom instructions "
+           "are registered)";
+  }
+  QVariant reportCounters(const PerformanceCounters &counters, bool) override {
+    const auto &instructions = RVISA::ExtCustom::instructions();
+    if (instructions.empty())
+      return QVariant();
+    QVariantMap m;
+    for (const auto &instruction : instructions) {
+      const auto it = counters.customInstructions.find(instruction.name);
+      m[instruction.name] =
+          it != counters.customInstructions.end() ? it->second : 0;
+    }
+    return m;
+  }
+};
+
+class CoherenceTelemetry : public Telemetry {
+public:
+  QString key() const override { return "coherence"; }
+  QString prettyKey() const override { return "cache coherence"; }
+  QString description() const override {
+    return "L1 data cache coherence traffic per hart (multi-hart processors)";
+  }
+  QVariant report(bool) override {
+    const auto *proc = dynamic_cast<const MultiHartProcessor *>(
+        ProcessorHandler::getProcessor());
+    if (!proc)
+      return QVariant();
+    const auto &coherence = proc->coherence();
+    QVariantMap m;
+    for (unsigned hart = 0; hart < proc->numHarts(); ++hart)
+      m["hart " + QString::number(hart)] = stats(coherence.stats(hart));
+    m["total"] = stats(coherence.totals());
+    return m;
+  }
+
+private:
+  static QVariantMap stats(const CoherenceSim::Stats &stats) {
+    QVariantMap m;
+    m["reads"] = stats.reads;
+    m["writes"] = stats.writes;
+    m["misses"] = stats.misses;
+    m["upgrades"] = stats.upgrades;
+    m["invalidations"] = stats.invalidations;
+    m["false sharing"] = stats.falseSharing;
+    m["interventions"] = stats.interventions;
+    m["writebacks"] = stats.writebacks;
+    return m;
+  }
+};
+
 class PipelineTelemetry : public Telemetry {
 public:
+  static constexpr const char *s_key = "pipeline";
   PipelineTelemetry() {}
   void enable() override {
     // The PipelineDiagramModel will automatically, upon construction, connect
     // to the ProcessorHandler and record information during execution.
+    m_traceWriter.reset();
     m_pipelineDiagramModel = std::make_shared<PipelineDiagramModel>();
     Telemetry::enable();
   }
 
-  QString key() const override { return "pipeline"; }
-  QString description() const override { return "pipeline state"; }
+  QString key() const override { return s_key; }
+  QString description() const override {
+    return "pipeline state (see --pipelinetrace for long runs)";
+  }
   QVariant report(bool /*json*/) override {
+    if (m_traceWriter) {
+      QVariantMap m;
+      m["trace file"] = m_traceWriter->path();
+      m["cycles"] = m_traceWriter->cycles();
+      return m;
+    }
     // Simply grab the current state of the pipeline diagram model and print it.
     return m_pipelineDiagramModel->toString();
   }
 
+  /// Streams the pipeline state to @p writer instead of the pipeline diagram,
+  /// which holds the state of every cycle in memory.
+  void setTraceWriter(const std::shared_ptr<PipelineTraceWriter> &writer) {
+    m_pipelineDiagramModel.reset();
+    m_traceWriter = writer;
+  }
+
 private:
   std::shared_ptr<PipelineDiagramModel> m_pipelineDiagramModel;
+  std::shared_ptr<PipelineTraceWriter> m_traceWriter;
+};
+
+class ProfileTelemetry : public Telemetry {
+public:
+  static constexpr const char *s_key = "profile";
+  void enable() override {
+    m_profiler.reset();
+    Telemetry::enable();
+  }
+
+  QString key() const override { return s_key; }
+  QString description() const override {
+    return "per-symbol, per-source line and per-instruction cycle hotspots "
+           "(see --profilefolded)";
+  }
+  QVariant report(bool json) override {
+    return m_profiler ? m_profiler->report(json) : QVariant();
+  }
+  void write(ReportWriter &writer) override {
+    if (m_profiler)
+      m_profiler->write(writer);
+    else
+      writer.value(QVariant());
+  }
+
+  void setProfiler(const std::shared_ptr<Profiler> &profiler) {
+    m_profiler = profiler;
+  }
+
+private:
+  std::shared_ptr<Profiler> m_profiler;
 };
 
 class RegisterTelemetry : public Telemetry {
@@ -143,6 +617,305 @@ public:
   }
 };
 
+class SamplingTelemetry : public Telemetry {
+public:
+  static constexpr const char *s_key = "sampling";
+  QString key() const override { return s_key; }
+  QString description() const override {
+    return "sampled simulation statistics (enabled by --sample)";
+  }
+  QVariant report(bool /*json*/) override { return m_report; }
+
+  void setReport(const QVariantMap &report) { m_report = report; }
+
+private:
+  QVariantMap m_report;
+};
+
+/// The reuse-distance histograms and working-set sizes of the instruction and
+/// data accesses of the run (see ReuseAnalysis).
+class ReuseTelemetry : public Telemetry {
+public:
+  static constexpr const char *s_key = "reuse";
+  QString key() const override { return s_key; }
+  QString prettyKey() const override { return "reuse distance"; }
+  QString description() const override {
+    return "reuse-distance histograms and working-set sizes of the instruction "
+           "and data accesses (see --reuseblocks, --reusewindow)";
+  }
+  QVariant report(bool json) override {
+    if (!m_icache || !m_dcache)
+      return QVariant();
+    if (json) {
+      QVariantMap m;
+      m["icache"] = m_icache->toVariantMap();
+      m["dcache"] = m_dcache->toVariantMap();
+      return m;
+    }
+    return "Instruction accesses:\n" + m_icache->toTable() +
+           "\nData accesses:\n" + m_dcache->toTable();
+  }
+
+  void setAnalyses(const std::shared_ptr<ReuseAnalysis> &icache,
+                   const std::shared_ptr<ReuseAnalysis> &dcache) {
+    m_icache = icache;
+    m_dcache = dcache;
+  }
+
+private:
+  std::shared_ptr<ReuseAnalysis> m_icache;
+  std::shared_ptr<ReuseAnalysis> m_dcache;
+};
+
+class CacheSweepTelemetry : public Telemetry {
+public:
+  static constexpr const char *s_key = "sweep";
+  QString key() const override { return s_key; }
+  QString prettyKey() const override { return "cache sweep"; }
+  QString description() const override {
+    return "cache configuration sweep results (enabled by --cachesweep)";
+  }
+  QVariant report(bool json) override {
+    if (!m_icache || !m_dcache)
+      return QVariant();
+    if (json) {
+      QVariantMap m;
+      m["icache"] = m_icache->toVariantList();
+      m["dcache"] = m_dcache->toVariantList();
+      return m;
+    }
+    return "Instruction cache:\n" + m_icache->toTable() +
+           "\nData cache:\n" + m_dcache->toTable();
+  }
+
+  void setSweeps(const std::shared_ptr<CacheSweep> &icache,
+                 const std::shared_ptr<CacheSweep> &dcache) {
+    m_icache = icache;
+    m_dcache = dcache;
+  }
+
+private:
+  std::shared_ptr<CacheSweep> m_icache;
+  std::shared_ptr<CacheSweep> m_dcache;
+};
+
+class TraceReplayTelemetry : public Telemetry {
+public:
+  static constexpr const char *s_key = "replay";
+  QString key() const override { return s_key; }
+  QString prettyKey() const override { return "trace replay"; }
+  QString description() const override {
+    return "access trace replay cache statistics (enabled by --replaytrace)";
+  }
+  QVariant report(bool /*json*/) override { return m_report; }
+
+  void setReport(const QVariantMap &report) { m_report = report; }
+
+private:
+  QVariantMap m_report;
+};
+
+class CacheHierarchyTelemetry : public Telemetry {
+public:
+  static constexpr const char *s_key = "cachestats";
+  QString key() const override { return s_key; }
+  QString prettyKey() const override { return "cache hierarchy"; }
+  QString description() const override {
+    return "cache hierarchy statistics, average memory access time and "
+           "estimated stall cycles (enabled by --caches)";
+  }
+  QVariant report(bool json) override {
+    return m_hierarchy ? m_hierarchy->report(json) : QVariant();
+  }
+
+  void setHierarchy(const std::shared_ptr<CacheHierarchy> &hierarchy) {
+    m_hierarchy = hierarchy;
+  }
+
+private:
+  std::shared_ptr<CacheHierarchy> m_hierarchy;
+};
+
+/// The misses of each cache of the cache hierarchy per instruction and per
+/// symbol (see MissAttribution).
+class CacheMissTelemetry : public Telemetry {
+public:
+  QString key() const override { return "cachemisses"; }
+  QString prettyKey() const override { return "cache misses"; }
+  QString description() const override {
+    return "the instructions and data symbols causing the misses of each "
+           "cache of --caches (see --profiletop)";
+  }
+  QVariant report(bool json) override {
+    if (!m_hierarchy)
+      return QVariant();
+    const auto program = ProcessorHandler::getProgram();
+    std::vector<std::pair<QString, const CacheSim *>> levels = {
+        {"L1I", &m_hierarchy->l1i()}, {"L1D", &m_hierarchy->l1d()}};
+    if (const auto *l2 = m_hierarchy->l2())
+      levels.push_back({"L2", l2});
+    QVariantMap m;
+    QString out;
+    for (const auto &[name, cache] : levels) {
+      const auto report = MissAttribution(*cache, program).report(m_top, json);
+      m[name] = report;
+      out += name + "\n" + report.toString() + "\n";
+    }
+    return json ? QVariant(m) : QVariant(out);
+  }
+
+  void setHierarchy(const std::shared_ptr<CacheHierarchy> &hierarchy,
+                    unsigned top) {
+    m_hierarchy = hierarchy;
+    m_top = top;
+  }
+
+private:
+  std::shared_ptr<CacheHierarchy> m_hierarchy;
+  unsigned m_top = 0;
+};
+
+/// The operational intensity and performance of the run and of each symbol,
+/// against the roofline of the processor and the cache hierarchy (see
+/// Roofline).
+class RooflineTelemetry : public Telemetry {
+public:
+  static constexpr const char *s_key = "roofline";
+  void enable() override {
+    m_profiler.reset();
+    Telemetry::enable();
+  }
+
+  QString key() const override { return s_key; }
+  QString description() const override {
+    return "operations per byte of memory traffic and per cycle of the run "
+           "and of each symbol, plotted against the roofline of the processor "
+           "and its caches (enabled by --caches)";
+  }
+  QVariant report(bool json) override {
+    if (!m_hierarchy || !m_profiler)
+      return QVariant();
+    return Roofline(*m_profiler, *m_hierarchy, ProcessorHandler::getID())
+        .report(json);
+  }
+
+  void setHierarchy(const std::shared_ptr<CacheHierarchy> &hierarchy) {
+    m_hierarchy = hierarchy;
+  }
+  void setProfiler(const std::shared_ptr<Profiler> &profiler) {
+    m_profiler = profiler;
+  }
+
+private:
+  std::shared_ptr<CacheHierarchy> m_hierarchy;
+  std::shared_ptr<Profiler> m_profiler;
+};
+
+/// The TLB hit rates, page walks and walk stall cycles of the virtual memory
+/// model of the run (see MMU).
+class TLBTelemetry : public Telemetry {
+public:
+  static constexpr const char *s_key = "tlb";
+  QString key() const override { return s_key; }
+  QString prettyKey() const override { return "TLB"; }
+  QString description() const override {
+    return "TLB hit rates and reach, page walks, page faults and estimated "
+           "walk stall cycles (enabled by --mmu)";
+  }
+  QVariant report(bool) override {
+    return m_mmu ? m_mmu->report() : QVariant();
+  }
+
+  void setMMU(const std::shared_ptr<MMU> &mmu) { m_mmu = mmu; }
+
+private:
+  std::shared_ptr<MMU> m_mmu;
+};
+
+/// The executions and wall-clock latencies of the system calls of the run,
+/// with a histogram of the latencies of each system call (see SyscallStats).
+class SyscallTelemetry : public Telemetry {
+public:
+  QString key() const override { return "syscalls"; }
+  QString prettyKey() const override { return "system calls"; }
+  QString description() const override {
+    return "executed system calls and their wall-clock latencies, including "
+           "latency histograms";
+  }
+  QVariant report(bool json) override {
+    const auto &manager = ProcessorHandler::getSyscallManager();
+    QVariantMap m;
+    for (const auto &[id, stats] : manager.stats()) {
+      QVariantMap syscall;
+      syscall["id"] = id;
+      syscall["count"] = static_cast<qint64>(stats.count);
+      syscall["async count"] = static_cast<qint64>(stats.asyncCount);
+      syscall["total seconds"] = stats.totalNs / 1e9;
+      syscall["mean us"] = stats.meanNs() / 1e3;
+      syscall["max us"] = stats.maxNs / 1e3;
+      // Buckets are reported from the shortest latencies, skipping empty
+      // buckets.
+      QVariantList histogram;
+      QStringList lines;
+      for (unsigned i = 0; i < SyscallStats::c_buckets; ++i) {
+        const auto count = stats.histogram.at(i);
+        if (count == 0)
+          continue;
+        const auto start =
+            static_cast<qint64>(SyscallStats::bucketStart(i));
+        histogram << QVariantMap{{"min ns", start},
+                                 {"count", static_cast<qint64>(count)}};
+        lines << QString(">=%1 ns: %2").arg(start).arg(count);
+      }
+      if (json)
+        syscall["histogram"] = histogram;
+      else
+        syscall["histogram"] = lines;
+      m[manager.getSyscalls().at(id)->name()] = syscall;
+    }
+    return m;
+  }
+};
+
+/// The reason for which the run stopped, set by the CLIRunner. Runs stopped by
+/// a bound (--maxcycles, --maxinstrs) are distinguished from runs which
+/// finished.
+class TerminationTelemetry : public Telemetry {
+public:
+  static constexpr const char *s_key = "termination";
+  void enable() override {
+    m_reason.clear();
+    m_watchpoint.clear();
+    Telemetry::enable();
+  }
+
+  QString key() const override { return s_key; }
+  QString description() const override {
+    return "reason for the end of the run (finished, cycle limit, instruction "
+           "limit, watchpoint or timeout)";
+  }
+  QVariant report(bool /*json*/) override {
+    QVariantMap m;
+    m["reason"] = m_reason;
+    m["cycle limit reached"] = m_reason == "cycle limit";
+    m["instruction limit reached"] = m_reason == "instruction limit";
+    if (!m_watchpoint.isEmpty())
+      m["watchpoint"] = m_watchpoint;
+    return m;
+  }
+
+  void setReason(const QString &reason) { m_reason = reason; }
+  void setWatchpointHit(const Watchpoints::Hit &hit, const ISAInfoBase *isa) {
+    m_watchpoint["cycle"] = hit.cycle;
+    m_watchpoint["pc"] = "0x" + QString::number(hit.pc, 16);
+    m_watchpoint["description"] = hit.describe(isa);
+  }
+
+private:
+  QString m_reason;
+  QVariantMap m_watchpoint;
+};
+
 class RunInfoTelemetry : public Telemetry {
 public:
   RunInfoTelemetry(QCommandLineParser *parser) {
@@ -0,0 +1,108 @@
+#include "telemetrystream.h"
+#include "processorhandler.h"
+
+#include <QJsonDocument>
+
+namespace Ripes {
+
+TelemetryStream::TelemetryStream(const StreamOptions &options,
+                                 const std::shared_ptr<CacheHierarchy> &caches)
+    : m_options(options), m_caches(caches) {}
+
+TelemetryStream::~TelemetryStream() { stop(); }
+
+bool TelemetryStream::open(QString &errorMessage) {
+  if (m_options.path != "-")
+    m_file.setFileName(m_options.path);
+  const bool success =
+      m_options.path == "-"
+          ? m_file.open(stdout, QIODevice::WriteOnly | QIODevice::Text)
+          : m_file.open(QIODevice::Truncate | QIODevice::Text |
+                        QIODevice::WriteOnly);
+  if (!success)
+    errorMessage = "Failed to open stream output file '" + m_options.path + "'";
+  return success;
+}
+
+void TelemetryStream::start() {
+  const auto *proc = ProcessorHandler::getProcessor();
+  m_lastCycles = proc->getCycleCount();
+  m_lastRetired = proc->getInstructionsRetired();
+  m_lastNsecs = 0;
+  m_elapsed.start();
+
+  m_clocked =
+      connect(ProcessorHandler::get(), &ProcessorHandler::processorClocked,
+              this, [=] { sample(); }, Qt::DirectConnection);
+  m_clockedBatch =
+      connect(ProcessorHandler::get(), &ProcessorHandler::processorClockedBatch,
+              this, [=] { sample(); }, Qt::DirectConnection);
+}
+
+void TelemetryStream::stop() {
+  if (!m_clocked && !m_clockedBatch)
+    return;
+  disconnect(m_clocked);
+  disconnect(m_clockedBatch);
+  m_clocked = m_clockedBatch = QMetaObject::Connection();
+  write(/*final=*/true);
+  m_file.flush();
+}
+
+void TelemetryStream::sample() {
+  const bool due =
+      m_options.cycles
+          ? ProcessorHandler::getProcessor()->getCycleCount() - m_lastCycles >=
+                m_options.interval
+          : m_elapsed.nsecsElapsed() - m_lastNsecs >=
+                qint64(m_options.interval) * 1000000;
+  if (due)
+    write(/*final=*/false);
+}
+
+void TelemetryStream::write(bool final) {
+  const auto *proc = ProcessorHandler::getProcessor();
+  const long long cycles = proc->getCycleCount();
+  const long long retired = proc->getInstructionsRetired();
+  const qint64 nsecs = m_elapsed.nsecsElapsed();
+
+  // Rates are computed over the interval since the previous record.
+  const double seconds = (nsecs - m_lastNsecs) / 1e9;
+  const long long intervalCycles = cycles - m_lastCycles;
+  const long long intervalRetired = retired - m_lastRetired;
+
+  QJsonObject record;
+  record["cycles"] = cycles;
+  record["retired"] = retired;
+  record["seconds"] = nsecs / 1e9;
+  record["mips"] = seconds > 0 ? intervalRetired / seconds / 1e6 : 0.0;
+  if (intervalRetired != 0)
+    record["cpi"] = static_cast<double>(intervalCycles) / intervalRetired;
+
+  if (m_caches) {
+    QJsonObject caches;
+    caches["l1i"] = m_caches->l1i().getHitRate();
+    caches["l1d"] = m_caches->l1d().getHitRate();
+    if (auto *l2 = m_caches->l2())
+      caches["l2"] = l2->getHitRate();
+    record["hit rates"] = caches;
+  }
+
+  const auto &syscallManager = ProcessorHandler::getSyscallManager();
+  QJsonObject syscalls;
+  for (const auto &[id, stats] : syscallManager.stats())
+    syscalls[syscallManager.getSyscalls().at(id)->name()] =
+        static_cast<qint64>(stats.count);
+  record["syscalls"] = syscalls;
+  if (final)
+    record["final"] = true;
+
+  m_file.write(QJsonDocument(record).toJson(QJsonDocument::Compact) + "\n");
+  m_file.flush();
+
+  m_lastCycles = cycles;
+  m_lastRetired = retired;
+  m_lastNsecs = nsecs;
+}
+
+} // namespace Ripes
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonObject>
+#include <QObject>
+
+#include <memory>
+
+#include "cachesim/cachehierarchy.h"
+#include "clioptions.h"
+
+namespace Ripes {
+
+/**
+ * @brief The TelemetryStream class
+ * Writes a record of the progress of a run of the processor model per interval
+ * of cycles or wall-clock time (--stream), as one line of JSON per record.
+ * Each record holds the cycles and instructions retired so far, the simulation
+ * speed and CPI over the interval, the hit rates of the simulated caches and
+ * the number of executed system calls.
+ *
+ * Records are written from the simulation thread, once a batch of cycles has
+ * been clocked, such that the statistics of each record are consistent. A
+ * final record is written once the run stops.
+ */
+class TelemetryStream : public QObject {
+  Q_OBJECT
+public:
+  TelemetryStream(const StreamOptions &options,
+                  const std::shared_ptr<CacheHierarchy> &caches);
+  ~TelemetryStream();
+
+  bool open(QString &errorMessage);
+
+  /// Starts recording the run of the processor of the ProcessorHandler.
+  void start();
+  /// Stops recording, writing the final record.
+  void stop();
+
+private:
+  void sample();
+  void write(bool final);
+
+  StreamOptions m_options;
+  std::shared_ptr<CacheHierarchy> m_caches;
+  QFile m_file;
+  QElapsedTimer m_elapsed;
+  QMetaObject::Connection m_clocked, m_clockedBatch;
+
+  // State at the last record.
+  long long m_lastCycles = 0;
+  long long m_lastRetired = 0;
+  qint64 m_lastNsecs = 0;
+};
+
+} // namespace Ripes
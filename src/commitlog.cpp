@@ -0,0 +1,295 @@
+#include "commitlog.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+#include "isa/rvisainfo_common.h"
+
+namespace Ripes {
+
+namespace {
+
+void appendLE(std::string &out, uint64_t value, unsigned bytes) {
+  for (unsigned i = 0; i < bytes; i++)
+    out += static_cast<char>((value >> (8 * i)) & 0xFF);
+}
+
+/// Appends @p value as a hexadecimal number of @p bytes bytes, as Spike does.
+void appendHex(std::string &out, uint64_t value, unsigned bytes) {
+  char hex[24];
+  if (bytes < 8)
+    value &= (uint64_t(1) << (8 * bytes)) - 1;
+  std::snprintf(hex, sizeof(hex), "0x%0*llx", int(bytes * 2),
+                static_cast<unsigned long long>(value));
+  out += hex;
+}
+
+} // namespace
+
+CommitLog::CommitLog(Format format, const ISAInfoBase &isa)
+    : m_format(format), m_xlenBytes(isa.bytes()),
+      m_flenBytes(isa.enabledExtensions().contains("D") ? 8 : 4),
+      m_queue(1 << 16) {}
+
+CommitLog::~CommitLog() { close(); }
+
+std::unique_ptr<CommitLog> CommitLog::open(const QString &filename,
+                                           Format format,
+                                           const ISAInfoBase &isa,
+                                           QString &error) {
+  std::unique_ptr<CommitLog> log(new CommitLog(format, isa));
+  log->m_file.setFileName(filename);
+  if (!log->m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    error = "Failed to open commit log '" + filename +
+            "': " + log->m_file.errorString();
+    return nullptr;
+  }
+  log->writeHeader();
+  log->m_thread = std::thread([log = log.get()] { log->run(); });
+  return log;
+}
+
+void CommitLog::sync(RipesProcessor &proc) {
+  m_registerFiles.clear();
+  for (const auto rfid : {RVISA::GPR, RVISA::FPR}) {
+    const auto handle = proc.registerFile(rfid);
+    if (!handle.valid())
+      continue;
+    RegisterFile file;
+    file.handle = handle;
+    file.isFloat = rfid == RVISA::FPR;
+    file.count = std::min(handle.count, 64u);
+    writtenRegisters(proc, file);
+    m_registerFiles.push_back(std::move(file));
+  }
+  m_pendingAccesses.clear();
+  m_lastCycle = proc.getCycleCount();
+  captureRetiring(proc);
+}
+
+void CommitLog::captureRetiring(const RipesProcessor &proc) {
+  m_retiring.clear();
+  const auto &structure = proc.structure();
+  for (unsigned lane = 0; lane < structure.size(); ++lane) {
+    const auto info = proc.stageInfo({lane, structure.at(lane) - 1});
+    if (info.stage_valid)
+      m_retiring.push_back(info.pc);
+  }
+}
+
+uint64_t CommitLog::writtenRegisters(const RipesProcessor &proc,
+                                     RegisterFile &file) {
+  if (proc.tracksRegisterWrites(file.handle.rfid))
+    return proc.writtenRegisters(file.handle.rfid, file.cursor);
+  uint64_t written = 0;
+  file.values.resize(file.count);
+  for (unsigned i = 0; i < file.count; i++) {
+    const VInt value = proc.readRegister(file.handle, i);
+    if (value != file.values[i])
+      written |= uint64_t(1) << i;
+    file.values[i] = value;
+  }
+  return written;
+}
+
+void CommitLog::observe(RipesProcessor &proc) {
+  const long long cycle = proc.getCycleCount();
+  if (cycle == m_lastCycle)
+    return;
+  m_lastCycle = cycle;
+
+  // Nothing retires nor accesses memory in cycles stalled on memory.
+  if (!proc.memoryStalled()) {
+    auto &memory = proc.getMemory();
+    // A write is performed by the cycle in which it is reported or by the
+    // following one, as pipelines report the access of the instruction which
+    // is about to write. Its bytes are read once it retires or once the
+    // following cycle has been clocked, whichever comes first.
+    const auto readWritten = [&](PendingAccess &pending) {
+      if (pending.access.type == MemoryAccess::Write && !pending.read)
+        pending.value =
+            memory.readMemConst(pending.access.address, pending.access.bytes);
+      pending.read = true;
+    };
+    for (auto &pending : m_pendingAccesses)
+      readWritten(pending);
+    const MemoryAccess access = proc.dataMemAccess();
+    if (access.type != MemoryAccess::None) {
+      if (m_pendingAccesses.size() == s_maxPendingAccesses)
+        m_pendingAccesses.erase(m_pendingAccesses.begin());
+      m_pendingAccesses.push_back({access});
+    }
+
+    m_retired.clear();
+    for (const AInt pc : m_retiring) {
+      Commit &commit = m_retired.emplace_back();
+      commit.pc = pc;
+      commit.instr = memory.readMemConst(pc, 4);
+      if ((commit.instr & 0b11) != 0b11) {
+        commit.flags |= Compressed;
+        commit.instr &= 0xFFFF;
+      }
+      auto it = std::find_if(m_pendingAccesses.begin(),
+                             m_pendingAccesses.end(),
+                             [=](const PendingAccess &pending) {
+                               return pending.access.pc == pc;
+                             });
+      if (it != m_pendingAccesses.end()) {
+        readWritten(*it);
+        commit.flags |= it->access.type == MemoryAccess::Write ? MemoryWrite
+                                                                : MemoryRead;
+        commit.accessAddress = it->access.address;
+        commit.accessBytes = it->access.bytes;
+        commit.accessValue = it->value;
+        m_pendingAccesses.erase(it);
+      }
+    }
+
+    for (auto &file : m_registerFiles) {
+      uint64_t written = writtenRegisters(proc, file);
+      if (!file.isFloat)
+        written &= ~uint64_t(1);
+      for (unsigned i = 0; written != 0 && i < file.count; i++) {
+        if (((written >> i) & 1) == 0)
+          continue;
+        written &= ~(uint64_t(1) << i);
+        // Of multiple retiring instructions, the write is attributed to the
+        // one whose destination field holds the register, or otherwise to the
+        // first one without a write.
+        Commit *target = nullptr;
+        for (auto &commit : m_retired) {
+          if (commit.flags & RegisterWrite)
+            continue;
+          if (!target)
+            target = &commit;
+          if (m_retired.size() > 1 && !(commit.flags & Compressed) &&
+              ((commit.instr >> 7) & 0b11111) == i) {
+            target = &commit;
+            break;
+          }
+        }
+        if (!target)
+          break;
+        target->flags |= RegisterWrite | (file.isFloat ? FloatRegister : 0);
+        target->reg = i;
+        target->regValue = proc.readRegister(file.handle, i);
+      }
+    }
+    for (const auto &commit : m_retired)
+      push(commit);
+  }
+  captureRetiring(proc);
+}
+
+void CommitLog::push(const Commit &commit) {
+  while (!m_queue.push(commit)) {
+    m_wake.notify_one();
+    std::this_thread::yield();
+  }
+  m_commits++;
+  if (++m_unnotified == s_notifyInterval) {
+    m_unnotified = 0;
+    m_wake.notify_one();
+  }
+}
+
+QString CommitLog::close() {
+  if (m_thread.joinable()) {
+    {
+      std::lock_guard lock(m_mutex);
+      m_stop = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+    flush();
+    m_file.close();
+  }
+  return m_writeFailed
+             ? "Failed to write commit log '" + m_file.fileName() + "'"
+             : QString();
+}
+
+void CommitLog::run() {
+  Commit commit;
+  while (true) {
+    while (m_queue.pop(commit))
+      writeCommit(commit);
+    if (m_buffer.size() >= s_blockSize)
+      flush();
+
+    // The producer only notifies the writer periodically, so the writer
+    // wakes up by itself as well.
+    std::unique_lock lock(m_mutex);
+    if (m_stop && m_queue.empty())
+      return;
+    m_wake.wait_for(lock, std::chrono::milliseconds(10),
+                    [this] { return m_stop || !m_queue.empty(); });
+  }
+}
+
+void CommitLog::writeHeader() {
+  if (m_format != Format::Binary)
+    return;
+  m_buffer += "RPCL";
+  m_buffer += static_cast<char>(1);
+  m_buffer += static_cast<char>(m_xlenBytes);
+  m_buffer += static_cast<char>(m_flenBytes);
+}
+
+void CommitLog::writeCommit(const Commit &commit) {
+  const unsigned instrBytes = (commit.flags & Compressed) ? 2 : 4;
+  const unsigned regBytes =
+      (commit.flags & FloatRegister) ? m_flenBytes : m_xlenBytes;
+  if (m_format == Format::Binary) {
+    m_buffer += static_cast<char>(commit.flags);
+    appendLE(m_buffer, commit.pc, m_xlenBytes);
+    appendLE(m_buffer, commit.instr, instrBytes);
+    if (commit.flags & RegisterWrite) {
+      m_buffer += static_cast<char>(commit.reg);
+      appendLE(m_buffer, commit.regValue, regBytes);
+    }
+    if (commit.flags & (MemoryRead | MemoryWrite)) {
+      appendLE(m_buffer, commit.accessAddress, m_xlenBytes);
+      m_buffer += static_cast<char>(commit.accessBytes);
+    }
+    if (commit.flags & MemoryWrite)
+      appendLE(m_buffer, commit.accessValue, commit.accessBytes);
+    return;
+  }
+
+  // Instructions retire in machine mode (privilege level 3).
+  m_buffer += "core   0: 3 ";
+  appendHex(m_buffer, commit.pc, m_xlenBytes);
+  m_buffer += " (";
+  appendHex(m_buffer, commit.instr, instrBytes);
+  m_buffer += ")";
+  if (commit.flags & RegisterWrite) {
+    char reg[8];
+    std::snprintf(reg, sizeof(reg), " %c%-2u ",
+                  (commit.flags & FloatRegister) ? 'f' : 'x',
+                  unsigned(commit.reg));
+    m_buffer += reg;
+    appendHex(m_buffer, commit.regValue, regBytes);
+  }
+  if (commit.flags & (MemoryRead | MemoryWrite)) {
+    m_buffer += " mem ";
+    appendHex(m_buffer, commit.accessAddress, m_xlenBytes);
+  }
+  if (commit.flags & MemoryWrite) {
+    m_buffer += " ";
+    appendHex(m_buffer, commit.accessValue, commit.accessBytes);
+  }
+  m_buffer += "\n";
+}
+
+void CommitLog::flush() {
+  if (m_buffer.empty())
+    return;
+  if (m_file.write(m_buffer.data(), m_buffer.size()) !=
+      static_cast<qint64>(m_buffer.size()))
+    m_writeFailed = true;
+  m_buffer.clear();
+}
+
+} // namespace Ripes
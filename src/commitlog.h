@@ -0,0 +1,155 @@
+#pragma once
+
+#include <QFile>
+#include <QString>
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "cachesim/spscqueue.h"
+#include "processors/interface/ripesprocessor.h"
+
+namespace Ripes {
+
+/**
+ * @brief The CommitLog class
+ * Logs a record per retired instruction of a run, holding its address, its
+ * instruction word, the register it wrote and its data memory access, for
+ * comparing runs against external reference models. Records are written
+ * either in a compact binary format or in the format of the commit log of
+ * Spike (--log-commits), such that Spike logs may be diffed against the log.
+ *
+ * The processor is observed after each cycle. An instruction retires in a
+ * cycle if it is valid in the last stage of its lane (as in PCProfile), and
+ * is attributed the registers written in the cycle and the latest data access
+ * performed by its address. Writes of x0 are not observable, and are thus not
+ * logged. Records are passed to a writer thread through a lock-free queue,
+ * such that the simulation thread only copies the state of each retirement.
+ *
+ * The binary log starts with the magic "RPCL", a version byte, and the widths
+ * in bytes of the integer and floating-point registers. Each record is a
+ * flags byte (see Flags), the address of the instruction (XLEN bytes) and the
+ * instruction word (2 bytes if compressed, otherwise 4), followed by the index
+ * and value of the written register if any, and the address and width (one
+ * byte) of the data access if any, followed by the written bytes of a write.
+ * All values are little-endian.
+ */
+class CommitLog {
+public:
+  enum class Format { Binary, Spike };
+  enum Flags : uint8_t {
+    Compressed = 1 << 0,
+    RegisterWrite = 1 << 1,
+    // The written register is a floating-point register.
+    FloatRegister = 1 << 2,
+    MemoryRead = 1 << 3,
+    MemoryWrite = 1 << 4,
+  };
+
+  struct Commit {
+    uint8_t flags = 0;
+    uint8_t reg = 0;
+    uint8_t accessBytes = 0;
+    uint32_t instr = 0;
+    AInt pc = 0;
+    VInt regValue = 0;
+    AInt accessAddress = 0;
+    VInt accessValue = 0;
+  };
+
+  ~CommitLog();
+
+  /// Opens @p filename for logging the instructions of processors
+  /// implementing @p isa. Returns nullptr and sets @p error if the file could
+  /// not be opened.
+  static std::unique_ptr<CommitLog> open(const QString &filename,
+                                         Format format,
+                                         const ISAInfoBase &isa,
+                                         QString &error);
+
+  /// Starts observing @p proc from its current state.
+  void sync(RipesProcessor &proc);
+  /// Logs the instructions retired by the latest cycle of @p proc. Must be
+  /// called for every cycle after sync; repeated calls for a cycle are
+  /// ignored.
+  void observe(RipesProcessor &proc);
+
+  /// Writes the outstanding records and closes the log. Returns an error
+  /// message if writing failed.
+  QString close();
+
+  /// Number of records logged.
+  long long commits() const { return m_commits; }
+
+private:
+  CommitLog(Format format, const ISAInfoBase &isa);
+
+  struct RegisterFile {
+    RegisterFileHandle handle;
+    bool isFloat = false;
+    unsigned count = 0;
+    uint64_t cursor = 0;
+    // Values of the registers, for files not tracked by the processor.
+    std::vector<VInt> values;
+  };
+  struct PendingAccess {
+    MemoryAccess access;
+    VInt value = 0;
+    // Whether the written bytes have been read.
+    bool read = false;
+  };
+
+  /// Returns a mask of the registers of @p file written since the latest
+  /// call.
+  static uint64_t writtenRegisters(const RipesProcessor &proc,
+                                   RegisterFile &file);
+  /// Records the instructions which retire in the upcoming cycle of @p proc.
+  void captureRetiring(const RipesProcessor &proc);
+  void push(const Commit &commit);
+
+  void run();
+  void writeHeader();
+  void writeCommit(const Commit &commit);
+  void flush();
+
+  // Records between notifications of the writer.
+  static constexpr unsigned s_notifyInterval = 256;
+  // Bytes of formatted records written to the file at a time.
+  static constexpr size_t s_blockSize = 1 << 20;
+  // Data accesses awaiting the retirement of their instruction.
+  static constexpr size_t s_maxPendingAccesses = 8;
+
+  const Format m_format;
+  const unsigned m_xlenBytes;
+  const unsigned m_flenBytes;
+  QFile m_file;
+
+  // Simulation state.
+  std::vector<RegisterFile> m_registerFiles;
+  std::vector<PendingAccess> m_pendingAccesses;
+  // Addresses of the instructions retiring in the upcoming cycle.
+  std::vector<AInt> m_retiring;
+  std::vector<Commit> m_retired;
+  long long m_lastCycle = -1;
+  long long m_commits = 0;
+  unsigned m_unnotified = 0;
+
+  SPSCQueue<Commit> m_queue;
+
+  // Writer state.
+  std::string m_buffer;
+  bool m_writeFailed = false;
+
+  std::mutex m_mutex;
+  std::condition_variable m_wake;
+  bool m_stop = false;
+  std::thread m_thread;
+};
+
+} // namespace Ripes
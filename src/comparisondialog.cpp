@@ -0,0 +1,191 @@
+#include "comparisondialog.h"
+
+#include "processorhandler.h"
+
+#include <QApplication>
+#include <QComboBox>
+#include <QFile>
+#include <QFileDialog>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QTabWidget>
+#include <QTableWidget>
+#include <QVBoxLayout>
+
+#include <cmath>
+
+namespace Ripes {
+
+// Bound on the cycles of each variant, such that a variant which does not
+// terminate does not hang the GUI.
+static constexpr long long s_maxCycles = 10000000;
+
+static QTableWidget *createTable(QWidget *parent) {
+  auto *table = new QTableWidget(0, 4, parent);
+  table->setHorizontalHeaderLabels({"", "A", "B", "B - A"});
+  table->verticalHeader()->hide();
+  table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  table->horizontalHeader()->setSectionResizeMode(
+      0, QHeaderView::ResizeToContents);
+  table->horizontalHeader()->setStretchLastSection(true);
+  return table;
+}
+
+static QString format(double value) {
+  return value == std::floor(value) ? QString::number(value, 'f', 0)
+                                    : QString::number(value, 'f', 3);
+}
+
+ComparisonDialog::ComparisonDialog(QWidget *parent) : QDialog(parent) {
+  setWindowTitle("Compare runs");
+
+  auto *description = new QLabel(
+      "Runs the current program on the current processor (A) side by side "
+      "with another assembly program and/or processor (B), and shows where "
+      "their cycles differ. Both runs are bounded to " +
+          QString::number(s_maxCycles) + " cycles.",
+      this);
+  description->setWordWrap(true);
+
+  m_variantA = new QLabel(this);
+  m_program = new QLineEdit(this);
+  m_program->setPlaceholderText("Current program");
+  auto *browseButton = new QPushButton("Browse...", this);
+  connect(browseButton, &QPushButton::clicked, this, [=] {
+    const QString path = QFileDialog::getOpenFileName(
+        this, "Program of variant B", QString(),
+        "Assembly files (*.s *.asm);;All files (*)");
+    if (!path.isEmpty())
+      m_program->setText(path);
+  });
+  auto *programLayout = new QHBoxLayout();
+  programLayout->addWidget(m_program);
+  programLayout->addWidget(browseButton);
+
+  m_processor = new QComboBox(this);
+  for (const auto &desc : ProcessorRegistry::getAvailableProcessors())
+    m_processor->addItem(enumToString<ProcessorID>(desc.first),
+                         QVariant::fromValue(desc.first));
+  m_extensions = new QLineEdit(this);
+  m_extensions->setPlaceholderText("Comma separated, as M,C");
+
+  auto *form = new QFormLayout();
+  form->addRow("A:", m_variantA);
+  form->addRow("B program:", programLayout);
+  form->addRow("B processor:", m_processor);
+  form->addRow("B extensions:", m_extensions);
+
+  auto *compareButton = new QPushButton("Compare", this);
+  connect(compareButton, &QPushButton::clicked, this,
+          &ComparisonDialog::compare);
+  m_status = new QLabel(this);
+  m_status->setWordWrap(true);
+  auto *controls = new QHBoxLayout();
+  controls->addWidget(m_status, 1);
+  controls->addWidget(compareButton);
+
+  m_counters = createTable(this);
+  m_symbols = createTable(this);
+  m_caches = createTable(this);
+  auto *tabs = new QTabWidget(this);
+  tabs->addTab(m_counters, "Counters");
+  tabs->addTab(m_symbols, "Symbols");
+  tabs->addTab(m_caches, "Caches");
+
+  auto *layout = new QVBoxLayout(this);
+  layout->addWidget(description);
+  layout->addLayout(form);
+  layout->addLayout(controls);
+  layout->addWidget(tabs);
+}
+
+void ComparisonDialog::showEvent(QShowEvent *event) {
+  // Variant B starts out as the current processor configuration.
+  const QStringList extensions =
+      ProcessorHandler::currentISA()->enabledExtensions();
+  m_variantA->setText("Current program on " +
+                      enumToString<ProcessorID>(ProcessorHandler::getID()) +
+                      " [" + extensions.join(",") + "]");
+  m_processor->setCurrentIndex(
+      m_processor->findData(QVariant::fromValue(ProcessorHandler::getID())));
+  m_extensions->setText(extensions.join(","));
+  QDialog::showEvent(event);
+}
+
+void ComparisonDialog::compare() {
+  const auto program = ProcessorHandler::getProgram();
+  if (!program) {
+    m_status->setText("No program is loaded.");
+    return;
+  }
+  Comparison::Variant a{"A", ProcessorHandler::getID(),
+                        ProcessorHandler::currentISA()->enabledExtensions(),
+                        program};
+  Comparison::Variant b{
+      "B", m_processor->currentData().value<ProcessorID>(),
+      m_extensions->text().isEmpty() ? QStringList()
+                                     : m_extensions->text().split(","),
+      program};
+  const auto exts =
+      ProcessorRegistry::getDescription(b.id).isaInfo().supportedExtensions;
+  for (const auto &ext : b.extensions) {
+    if (!exts.contains(ext)) {
+      m_status->setText("Processor " + enumToString<ProcessorID>(b.id) +
+                        " does not support extension '" + ext + "'.");
+      return;
+    }
+  }
+  if (!m_program->text().isEmpty()) {
+    QFile file(m_program->text());
+    if (!file.open(QIODevice::ReadOnly)) {
+      m_status->setText("Failed to open '" + m_program->text() + "'.");
+      return;
+    }
+    QStringList errors;
+    b.program =
+        Comparison::assemble(b.id, b.extensions, file.readAll(), errors);
+    if (!b.program) {
+      m_status->setText("Error during assembly of B: " + errors.join("; "));
+      return;
+    }
+  }
+
+  QApplication::setOverrideCursor(Qt::WaitCursor);
+  Comparison comparison(a, b);
+  comparison.setMaxCycles(s_maxCycles);
+  comparison.run();
+  QApplication::restoreOverrideCursor();
+
+  QString status = "A: " + comparison.status(false) +
+                   ", B: " + comparison.status(true) + ".";
+  if (comparison.output(false) != comparison.output(true))
+    status += " The console output of the variants differs.";
+  m_status->setText(status);
+  showRows(m_counters, comparison.counters());
+  showRows(m_symbols, comparison.symbols());
+  showRows(m_caches, comparison.caches());
+}
+
+void ComparisonDialog::showRows(QTableWidget *table,
+                                const std::vector<Comparison::Row> &rows) {
+  table->setRowCount(rows.size());
+  for (size_t i = 0; i < rows.size(); ++i) {
+    const auto &row = rows.at(i);
+    const double delta = row.delta();
+    const QStringList values = {
+        row.name, format(row.a), format(row.b),
+        (delta > 0 ? "+" : "") + format(delta)};
+    for (int column = 0; column < values.size(); ++column) {
+      auto *item = new QTableWidgetItem(values.at(column));
+      if (column != 0)
+        item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+      table->setItem(i, column, item);
+    }
+  }
+}
+
+} // namespace Ripes
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <QDialog>
+
+#include "cli/comparison.h"
+
+class QComboBox;
+class QLabel;
+class QLineEdit;
+class QTableWidget;
+
+namespace Ripes {
+
+/**
+ * @brief The ComparisonDialog class
+ * The "Compare runs" panel. Runs the current program on the current processor
+ * (variant A) side by side with a variant B, being another assembly program
+ * and/or another processor configuration (see Comparison), and shows the
+ * differences of their performance counters, cycles per symbol and L1 cache
+ * behaviour.
+ */
+class ComparisonDialog : public QDialog {
+  Q_OBJECT
+
+public:
+  explicit ComparisonDialog(QWidget *parent = nullptr);
+
+protected:
+  void showEvent(QShowEvent *event) override;
+
+private:
+  void compare();
+  void showRows(QTableWidget *table, const std::vector<Comparison::Row> &rows);
+
+  QLabel *m_variantA = nullptr;
+  QLineEdit *m_program = nullptr;
+  QComboBox *m_processor = nullptr;
+  QLineEdit *m_extensions = nullptr;
+  QLabel *m_status = nullptr;
+  QTableWidget *m_counters = nullptr;
+  QTableWidget *m_symbols = nullptr;
+  QTableWidget *m_caches = nullptr;
+};
+
+} // namespace Ripes
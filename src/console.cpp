@@ -3,6 +3,7 @@
 #include "fonts.h"
 #include "ripessettings.h"
 
+#include <QMimeData>
 #include <QScrollBar>
 
 namespace Ripes {
@@ -15,7 +16,7 @@ Console::Console(QWidget *parent) : QPlainTextEdit(parent) {
   }
   setFont(m_font);
 
-  document()->setMaximumBlockCount(100);
+  document()->setMaximumBlockCount(s_scrollbackLines);
 
   auto paletteChangeFunctor = [=] {
     QPalette p = palette();
@@ -46,11 +47,22 @@ Console::Console(QWidget *parent) : QPlainTextEdit(parent) {
 }
 
 void Console::putData(const QByteArray &bytes) {
+  // Only the lines which are retained in the scrollback are inserted.
+  qsizetype start = 0;
+  int lines = 0;
+  for (qsizetype i = bytes.size() - 1; i >= 0; --i) {
+    if (bytes.at(i) == '\n' && ++lines == s_scrollbackLines) {
+      start = i + 1;
+      break;
+    }
+  }
+
   // Text can always only be inserted at the end of the console
   auto cursorAtEnd = QTextCursor(document());
   cursorAtEnd.movePosition(QTextCursor::End);
   setTextCursor(cursorAtEnd);
-  insertPlainText(bytes);
+  insertPlainText(QString::fromUtf8(bytes.constData() + start,
+                                    bytes.size() - start));
 
   QScrollBar *bar = verticalScrollBar();
   bar->setValue(bar->maximum());
@@ -61,6 +73,29 @@ void Console::clearConsole() {
   m_buffer.clear();
 }
 
+void Console::sendInput(const QByteArray &data) {
+  emit sendData(m_buffer.toLocal8Bit() + data);
+  m_buffer.clear();
+  if (m_localEchoEnabled)
+    putData(data);
+}
+
+void Console::insertFromMimeData(const QMimeData *source) {
+  // Pasted text is sent in bulk, up to its last newline, rather than a line
+  // at a time. Text following the last newline remains editable.
+  const QString text = source->text();
+  if (text.isEmpty())
+    return;
+  m_buffer += text;
+  const qsizetype newline = m_buffer.lastIndexOf('\n');
+  if (newline >= 0) {
+    emit sendData(m_buffer.left(newline + 1).toLocal8Bit());
+    m_buffer.remove(0, newline + 1);
+  }
+  if (m_localEchoEnabled)
+    putData(text.toUtf8());
+}
+
 void Console::backspace() {
   // Deletes the last character in the console
   auto cursorAtEnd = QTextCursor(document());
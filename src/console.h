@@ -5,6 +5,8 @@
 #include <QFont>
 #include <QPlainTextEdit>
 
+#include "memoryfootprint.h"
+
 namespace Ripes {
 
 class Console : public QPlainTextEdit {
@@ -17,16 +19,28 @@ public:
   Console(QWidget *parent = nullptr);
   void putData(const QByteArray &data);
   void clearConsole();
+  /// Sends @p data as input in a single operation, following any input typed
+  /// on the current line.
+  void sendInput(const QByteArray &data);
 
 protected:
   void keyPressEvent(QKeyEvent *e) override;
+  void insertFromMimeData(const QMimeData *source) override;
 
 private:
   void backspace();
 
+  // Number of lines retained in the console.
+  static constexpr int s_scrollbackLines = 100;
+
   bool m_localEchoEnabled = false;
   QFont m_font;
   QString m_buffer;
+
+  MemoryFootprint::Source m_footprint{MemoryFootprint::Console, [this] {
+    return (document()->characterCount() + m_buffer.capacity()) *
+           sizeof(QChar);
+  }};
 };
 
 } // namespace Ripes
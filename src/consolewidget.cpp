@@ -6,6 +6,9 @@
 #include "ripessettings.h"
 #include "syscall/systemio.h"
 
+#include <QFile>
+#include <QFileDialog>
+#include <QMessageBox>
 #include <QPushButton>
 #include <QScrollBar>
 
@@ -20,6 +23,11 @@ ConsoleWidget::ConsoleWidget(QWidget *parent)
   m_ui->clearConsoleButton->setIcon(QIcon(":/icons/clear.svg"));
   m_ui->clearConsoleButton->setToolTip("Clear console");
 
+  connect(m_ui->loadInputButton, &QToolButton::clicked, this,
+          &ConsoleWidget::loadInput);
+  m_ui->loadInputButton->setIcon(QIcon(":/icons/loadfile.svg"));
+  m_ui->loadInputButton->setToolTip("Load file as input");
+
   // Send input data from the console to the SystemIO stdin stream.
   connect(m_ui->console, &Console::sendData, &SystemIO::get(),
           &SystemIO::putStdInData);
@@ -35,4 +43,19 @@ void ConsoleWidget::putData(const QByteArray &d) { m_ui->console->putData(d); }
 
 void ConsoleWidget::clearConsole() { m_ui->console->clearConsole(); }
 
+void ConsoleWidget::loadInput() {
+  const QString path =
+      QFileDialog::getOpenFileName(this, "Load file as input", QString());
+  if (path.isEmpty())
+    return;
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    QMessageBox::warning(this, "Error",
+                         "Could not open file " + path + ": " +
+                             file.errorString());
+    return;
+  }
+  m_ui->console->sendInput(file.readAll());
+}
+
 } // namespace Ripes
@@ -19,6 +19,8 @@ public:
   void clearConsole();
 
 private:
+  void loadInput();
+
   Ui::ConsoleWidget *m_ui;
 };
 
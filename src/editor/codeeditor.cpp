@@ -37,6 +37,11 @@ CodeEditor::CodeEditor(QWidget *parent) : HighlightableTextEdit(parent) {
 
   connect(ProcessorHandler::get(), &ProcessorHandler::procStateChangedNonRun,
           this, &CodeEditor::updateHighlighting);
+  connect(document(), &QTextDocument::contentsChange, this,
+          [&](int /*pos*/, int charsRemoved, int charsAdded) {
+            if (charsRemoved != 0 || charsAdded != 0)
+              ++m_contentVersion;
+          });
 
   // Set font for the entire widget. calls to fontMetrics() will get the
   // dimensions of the currently set font
@@ -309,10 +314,19 @@ bool CodeEditor::eventFilter(QObject * /*observed*/, QEvent *event) {
 
 void CodeEditor::rehighlight() {
   if (m_highlighter) {
+    updatePriorityBlocks();
     m_highlighter->rehighlight();
   }
 }
 
+void CodeEditor::updatePriorityBlocks() {
+  if (!m_highlighter)
+    return;
+  const int last =
+      cursorForPosition(QPoint(0, viewport()->height())).blockNumber();
+  m_highlighter->setPriorityBlocks(firstVisibleBlock().blockNumber(), last);
+}
+
 bool CodeEditor::event(QEvent *event) {
   // Override event handler for receiving tool tips
   if (event->type() == QEvent::ToolTip) {
@@ -343,6 +357,7 @@ void CodeEditor::updateSidebar(const QRect &rect, int dy) {
 
   if (rect.contains(viewport()->rect()))
     updateSidebarWidth(0);
+  updatePriorityBlocks();
 }
 
 void CodeEditor::resizeEvent(QResizeEvent *e) {
@@ -375,7 +390,7 @@ void CodeEditor::setSourceType(SourceType type,
     break;
   }
 
-  m_highlighter->rehighlight();
+  rehighlight();
 }
 
 void CodeEditor::highlightCurrentLine() {
@@ -421,54 +436,68 @@ void CodeEditor::lineNumberAreaPaintEvent(QPaintEvent *event) {
   }
 }
 
-void CodeEditor::updateHighlighting() {
-  clearBlockHighlights();
-
-  if (!RipesSettings::value(RIPES_SETTING_EDITORSTAGEHIGHLIGHTING).toBool())
-    return;
-
-  auto *proc = ProcessorHandler::getProcessor();
-  auto program = ProcessorHandler::getProgram().get();
-
-  // Is the current source in sync with the in-memory source?
-  if (!program || !program->isSameSource(document()->toPlainText().toUtf8()))
-    return;
-
-  auto sourceMapping = program->sourceMapping;
-
-  // Do nothing if no soruce mappings are available.
-  if (sourceMapping.empty())
-    return;
-
-  // Iterate over the processor stages and use the source mappings to determine
-  // the source line which originated the instruction.
-  const unsigned stages = proc->structure().numStages();
-  auto colorGenerator = Colors::incrementalRedGenerator(stages);
+bool CodeEditor::sourceInSync() {
+  // The source is hashed only once per change of the document or program.
+  auto program = ProcessorHandler::getProgram();
+  if (program != m_syncedProgram || m_contentVersion != m_syncedVersion) {
+    m_syncedProgram = program;
+    m_syncedVersion = m_contentVersion;
+    m_sourceInSync =
+        program && program->isSameSource(document()->toPlainText().toUtf8());
+  }
+  return m_sourceInSync;
+}
 
-  for (auto sid : proc->structure().stageIt()) {
-    const auto stageInfo = proc->stageInfo(sid);
-    QColor stageColor = colorGenerator();
-    if (stageInfo.stage_valid) {
+void CodeEditor::updateHighlighting() {
+  std::vector<StageHighlight> highlights;
+  const auto *program = ProcessorHandler::getProgram().get();
+
+  // Highlight only if enabled and if the current source is in sync with the
+  // in-memory source. Do nothing if no source mappings are available.
+  if (RipesSettings::value(RIPES_SETTING_EDITORSTAGEHIGHLIGHTING).toBool() &&
+      sourceInSync() && !program->getSourceMapping().empty()) {
+    const auto &sourceMapping = program->getSourceMapping();
+    auto *proc = ProcessorHandler::getProcessor();
+
+    // Iterate over the processor stages and use the source mappings to
+    // determine the source line which originated the instruction.
+    const unsigned stages = proc->structure().numStages();
+    auto colorGenerator = Colors::incrementalRedGenerator(stages);
+
+    for (auto sid : proc->structure().stageIt()) {
+      const auto stageInfo = proc->stageInfo(sid);
+      QColor stageColor = colorGenerator();
+      if (!stageInfo.stage_valid)
+        continue;
       auto mappingIt = sourceMapping.find(stageInfo.pc);
       if (mappingIt == sourceMapping.end()) {
         // No source line registerred for this PC.
         continue;
       }
 
+      // Record the stage name for the highlighted block for later painting
+      QString stageString = proc->stageName(sid);
+      if (!stageInfo.namedState.isEmpty())
+        stageString += " (" + stageInfo.namedState + ")";
       for (auto sourceLine : mappingIt->second) {
-        // Find block
         QTextBlock block = document()->findBlockByLineNumber(sourceLine);
-        if (!block.isValid())
-          continue;
-
-        // Record the stage name for the highlighted block for later painting
-        QString stageString = ProcessorHandler::getProcessor()->stageName(sid);
-        if (!stageInfo.namedState.isEmpty())
-          stageString += " (" + stageInfo.namedState + ")";
-        highlightBlock(block, stageColor, stageString);
+        if (block.isValid())
+          highlights.push_back({block.blockNumber(), stageColor, stageString});
       }
     }
   }
+
+  // Blocks are only rehighlighted, and repainted, if their highlighting
+  // changed.
+  if (highlights == m_stageHighlights &&
+      m_contentVersion == m_stageHighlightsVersion)
+    return;
+  clearBlockHighlights();
+  for (const auto &highlight : highlights)
+    highlightBlock(document()->findBlockByNumber(highlight.blockNumber),
+                   highlight.color, highlight.stage);
+  m_stageHighlights = std::move(highlights);
+  m_stageHighlightsVersion = m_contentVersion;
 }
 
 } // namespace Ripes
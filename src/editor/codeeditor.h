@@ -57,8 +57,35 @@ private slots:
   void updateSidebar(const QRect &, int);
 
 private:
+  /// Prioritizes the highlighting of the blocks visible in the editor.
+  void updatePriorityBlocks();
+  /// Returns true if the document is the source of the loaded program.
+  bool sourceInSync();
+
   std::unique_ptr<SyntaxHighlighter> m_highlighter;
 
+  // Incremented upon changes to the text of the document, but not upon
+  // formatting changes.
+  unsigned m_contentVersion = 0;
+  // Program and content version for which m_sourceInSync was determined.
+  std::shared_ptr<const Program> m_syncedProgram;
+  unsigned m_syncedVersion = 0;
+  bool m_sourceInSync = false;
+
+  struct StageHighlight {
+    int blockNumber;
+    QColor color;
+    QString stage;
+    bool operator==(const StageHighlight &other) const {
+      return blockNumber == other.blockNumber && color == other.color &&
+             stage == other.stage;
+    }
+  };
+  // The stage highlights currently applied, and the content version which they
+  // were applied to.
+  std::vector<StageHighlight> m_stageHighlights;
+  unsigned m_stageHighlightsVersion = 0;
+
   LineNumberArea *m_lineNumberArea;
   int m_sidebarWidth;
 
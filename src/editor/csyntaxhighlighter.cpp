@@ -7,83 +7,49 @@ namespace Ripes {
 CSyntaxHighlighter::CSyntaxHighlighter(QTextDocument *parent,
                                        std::shared_ptr<Errors> errors)
     : SyntaxHighlighter(parent, errors) {
-  HighlightingRule rule;
-
   errorFormat.setUnderlineStyle(QTextCharFormat::WaveUnderline);
   errorFormat.setUnderlineColor(Qt::red);
 
-  keywordFormat.setForeground(Qt::darkBlue);
-  keywordFormat.setFontWeight(QFont::Bold);
-  const QString keywordPatterns[] = {
-      QStringLiteral("\\bconst\\b"),    QStringLiteral("\\benum\\b"),
-      QStringLiteral("\\binline\\b"),   QStringLiteral("\\bshort\\b"),
-      QStringLiteral("\\bstatic\\b"),   QStringLiteral("\\bstruct\\b"),
-      QStringLiteral("\\btypedef\\b"),  QStringLiteral("\\btypename\\b"),
-      QStringLiteral("\\bunion\\b"),    QStringLiteral("\\bvolatile\\b"),
-      QStringLiteral("\\bbreak\\b"),    QStringLiteral("\\bcase\\b"),
-      QStringLiteral("\\bif\\b"),       QStringLiteral("\\belse\\b"),
-      QStringLiteral("\\bdo\\b"),       QStringLiteral("\\bwhile\\b"),
-      QStringLiteral("\\bcontinue\\b"), QStringLiteral("\\bfor\\b"),
-      QStringLiteral("\\bextern\\b"),   QStringLiteral("\\bgoto\\b"),
-      QStringLiteral("\\bswitch\\b"),   QStringLiteral("\\bregister\\b"),
-      QStringLiteral("\\breturn\\b"),   QStringLiteral("\\bsizeof\\b"),
-      QStringLiteral("\\b__asm__\\b"),  QStringLiteral("\\basm\\b")};
-
-  for (const QString &pattern : keywordPatterns) {
-    rule.pattern = QRegularExpression(pattern);
-    rule.format = keywordFormat;
-    highlightingRules.append(rule);
-  }
-
-  typeFormat.setForeground(Qt::darkBlue);
-  typeFormat.setFontWeight(QFont::Bold);
-  const QString typePatterns[] = {
-      QStringLiteral("\\bchar\\b"),   QStringLiteral("\\bfloat\\b"),
-      QStringLiteral("\\bdouble\\b"), QStringLiteral("\\bint\\b"),
-      QStringLiteral("\\blong\\b"),   QStringLiteral("\\bshort\\b"),
-      QStringLiteral("\\bsigned\\b"), QStringLiteral("\\bunsigned\\b"),
-      QStringLiteral("\\bvoid\\b"),   QStringLiteral("\\bbool\\b")};
-  for (const QString &pattern : typePatterns) {
-    rule.pattern = QRegularExpression(pattern);
-    rule.format = typeFormat;
-    highlightingRules.append(rule);
-  }
+  // Rules are listed in order of precedence.
+  std::vector<HighlightingRule> rules;
 
   singleLineCommentFormat.setForeground(Colors::Medalist);
-  rule.pattern = QRegularExpression(QStringLiteral("//[^\n]*"));
-  rule.format = singleLineCommentFormat;
-  highlightingRules.append(rule);
+  rules.push_back({QStringLiteral("//[^\n]*"), singleLineCommentFormat});
 
-  multiLineCommentFormat.setForeground(Colors::Medalist);
+  quotationFormat.setForeground(QColor{0x80, 0x00, 0x00});
+  rules.push_back({QStringLiteral("\".*\""), quotationFormat});
 
   preprocessorFormat.setForeground(QColorConstants::DarkMagenta);
-  rule.pattern = QRegularExpression(QStringLiteral("^\\ *#[^ ]*"));
-  rule.format = preprocessorFormat;
-  highlightingRules.append(rule);
+  rules.push_back({QStringLiteral("^\\ *#[^ ]*"), preprocessorFormat});
 
-  quotationFormat.setForeground(QColor{0x80, 0x00, 0x00});
-  rule.pattern = QRegularExpression(QStringLiteral("\".*\""));
-  rule.format = quotationFormat;
-  highlightingRules.append(rule);
+  keywordFormat.setForeground(Qt::darkBlue);
+  keywordFormat.setFontWeight(QFont::Bold);
+  const QStringList keywords = {
+      "const", "enum", "inline", "short", "static", "struct", "typedef",
+      "typename", "union", "volatile", "break", "case", "if", "else", "do",
+      "while", "continue", "for", "extern", "goto", "switch", "register",
+      "return", "sizeof", "__asm__", "asm"};
+  rules.push_back({"\\b(?:" + keywords.join('|') + ")\\b", keywordFormat});
+
+  typeFormat.setForeground(Qt::darkBlue);
+  typeFormat.setFontWeight(QFont::Bold);
+  const QStringList types = {
+      "char", "float", "double", "int", "long", "short", "signed", "unsigned",
+      "void", "bool"};
+  rules.push_back({"\\b(?:" + types.join('|') + ")\\b", typeFormat});
 
   functionFormat.setForeground(Colors::BerkeleyBlue);
-  rule.pattern = QRegularExpression(QStringLiteral("\\b[A-Za-z0-9_]+(?=\\()"));
-  rule.format = functionFormat;
-  highlightingRules.append(rule);
+  rules.push_back({QStringLiteral("\\b[A-Za-z0-9_]+(?=\\()"), functionFormat});
+
+  setRules(rules);
 
+  multiLineCommentFormat.setForeground(Colors::Medalist);
   commentStartExpression = QRegularExpression(QStringLiteral("/\\*"));
   commentEndExpression = QRegularExpression(QStringLiteral("\\*/"));
 } // namespace Ripes
 
 void CSyntaxHighlighter::syntaxHighlightBlock(const QString &text) {
-  for (const HighlightingRule &rule : std::as_const(highlightingRules)) {
-    QRegularExpressionMatchIterator matchIterator =
-        rule.pattern.globalMatch(text);
-    while (matchIterator.hasNext()) {
-      QRegularExpressionMatch match = matchIterator.next();
-      setFormat(match.capturedStart(), match.capturedLength(), rule.format);
-    }
-  }
+  applyRules(text);
 
   setCurrentBlockState(0);
 
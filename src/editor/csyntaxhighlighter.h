@@ -17,12 +17,6 @@ public:
   void syntaxHighlightBlock(const QString &text) override;
 
 private:
-  struct HighlightingRule {
-    QRegularExpression pattern;
-    QTextCharFormat format;
-  };
-  QVector<HighlightingRule> highlightingRules;
-
   QRegularExpression commentStartExpression;
   QRegularExpression commentEndExpression;
 
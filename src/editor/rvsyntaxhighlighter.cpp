@@ -2,82 +2,63 @@
 
 #include "colors.h"
 
+#include <algorithm>
+
 namespace Ripes {
 
 RVSyntaxHighlighter::RVSyntaxHighlighter(
     QTextDocument *parent, std::shared_ptr<Errors> errors,
     const std::set<QString> &supportedOpcodes)
     : SyntaxHighlighter(parent, errors) {
-  HighlightingRule rule;
-
-  // General registers
-  registerFormat.setForeground(QColor{0x80, 0x00, 0x00});
-  rule.pattern = QRegularExpression("\\b[(a|s|t|x)][0-9]{1,2}");
-  rule.format = registerFormat;
-  m_highlightingRules.append(rule);
+  // Rules are listed in order of precedence.
+  std::vector<HighlightingRule> rules;
 
-  // Name-specific registers
-  QStringList registerPatterns;
-  registerPatterns << "\\bzero\\b"
-                   << "\\bra\\b"
-                   << "\\bsp\\b"
-                   << "\\bgp\\b"
-                   << "\\btp\\b"
-                   << "\\bfp\\b";
-  for (const auto &pattern : std::as_const(registerPatterns)) {
-    rule.pattern = QRegularExpression(pattern);
-    rule.format = registerFormat;
-    m_highlightingRules.append(rule);
-  }
+  // Comments
+  commentFormat.setForeground(Colors::Medalist);
+  rules.push_back({"[#]+.*", commentFormat});
 
-  // Instructions
-  instructionFormat.setForeground(Colors::BerkeleyBlue);
-  for (const auto &pattern : supportedOpcodes) {
-    const QString regexPattern = "\\b" + pattern + "\\b";
-    rule.pattern = QRegularExpression(regexPattern);
-    rule.format = instructionFormat;
-    m_highlightingRules.append(rule);
-  }
+  // Strings
+  stringFormat.setForeground(QColor{0x80, 0x00, 0x00});
+  rules.push_back({R"("(?:[^"]|\.)*")", stringFormat});
 
   // Labels
   labelFormat.setForeground(Colors::Medalist);
-  rule.pattern = QRegularExpression(R"([\S]+:)");
-  rule.format = labelFormat;
-  m_highlightingRules.append(rule);
+  rules.push_back({R"([\S]+:)", labelFormat});
 
-  // Immediates
+  // Prefixed immediates (0x, 0b)
   immediateFormat.setForeground(QColorConstants::DarkGreen);
-  rule.pattern = QRegularExpression("\\b(?<![A-Za-z])[-+]?\\d+");
-  rule.format = immediateFormat;
-  m_highlightingRules.append(rule);
+  rules.push_back(
+      {"([-+]?0[xX][0-9a-fA-F]+|[-+]?0[bB][0-1]+)", immediateFormat});
 
-  // Prefixed immediates (0x, 0b)
-  rule.pattern =
-      QRegularExpression("([-+]?0[xX][0-9a-fA-F]+|[-+]?0[bB][0-1]+)");
-  m_highlightingRules.append(rule);
+  // Immediates
+  rules.push_back({"\\b(?<![A-Za-z])[-+]?\\d+", immediateFormat});
 
-  // Strings
-  stringFormat.setForeground(QColor{0x80, 0x00, 0x00});
-  rule.pattern = QRegularExpression(R"("(?:[^"]|\.)*")");
-  rule.format = stringFormat;
-  m_highlightingRules.append(rule);
+  // General and name-specific registers
+  registerFormat.setForeground(QColor{0x80, 0x00, 0x00});
+  rules.push_back({"\\b[(a|s|t|x)][0-9]{1,2}", registerFormat});
+  rules.push_back({"\\b(?:zero|ra|sp|gp|tp|fp)\\b", registerFormat});
 
-  // Comments
-  commentFormat.setForeground(Colors::Medalist);
-  rule.pattern = QRegularExpression("[#]+.*");
-  rule.format = commentFormat;
-  m_highlightingRules.append(rule);
+  // Instructions. Longer opcodes are matched first, such that an opcode is not
+  // matched as the prefix of another (i.e., "fadd" in "fadd.s").
+  instructionFormat.setForeground(Colors::BerkeleyBlue);
+  std::vector<QString> opcodes(supportedOpcodes.begin(),
+                               supportedOpcodes.end());
+  std::stable_sort(opcodes.begin(), opcodes.end(),
+                   [](const QString &lhs, const QString &rhs) {
+                     return lhs.size() > rhs.size();
+                   });
+  QStringList opcodePatterns;
+  for (const auto &opcode : opcodes)
+    opcodePatterns << QRegularExpression::escape(opcode);
+  if (!opcodePatterns.isEmpty())
+    rules.push_back({"\\b(?:" + opcodePatterns.join('|') + ")\\b",
+                     instructionFormat});
+
+  setRules(rules);
 }
 
 void RVSyntaxHighlighter::syntaxHighlightBlock(const QString &text) {
-  for (const HighlightingRule &rule : std::as_const(m_highlightingRules)) {
-    QRegularExpressionMatchIterator matchIterator =
-        rule.pattern.globalMatch(text);
-    while (matchIterator.hasNext()) {
-      QRegularExpressionMatch match = matchIterator.next();
-      setFormat(match.capturedStart(), match.capturedLength(), rule.format);
-    }
-  }
+  applyRules(text);
 }
 
 } // namespace Ripes
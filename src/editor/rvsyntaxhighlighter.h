@@ -14,12 +14,6 @@ public:
   void syntaxHighlightBlock(const QString &text) override;
 
 private:
-  struct HighlightingRule {
-    QRegularExpression pattern;
-    QTextCharFormat format;
-  };
-  QVector<HighlightingRule> m_highlightingRules;
-
   QTextCharFormat registerFormat;
   QTextCharFormat labelFormat;
   QTextCharFormat directiveFormat;
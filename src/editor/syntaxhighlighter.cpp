@@ -8,9 +8,33 @@ SyntaxHighlighter::SyntaxHighlighter(QTextDocument *parent,
     : QSyntaxHighlighter(parent), m_errors(errors) {
   errorFormat.setUnderlineStyle(QTextCharFormat::WaveUnderline);
   errorFormat.setUnderlineColor(Qt::red);
+
+  m_pendingTimer.setSingleShot(true);
+  m_pendingTimer.setInterval(0);
+  connect(&m_pendingTimer, &QTimer::timeout, this,
+          &SyntaxHighlighter::highlightPendingBlocks);
 }
 
 void SyntaxHighlighter::highlightBlock(const QString &text) {
+  // A pass of highlighting blocks ends once control returns to the event
+  // loop. Pending blocks are highlighted in passes of their own.
+  if (!m_highlightingPending && !m_inPass) {
+    m_inPass = true;
+    m_passTimer.start();
+    QTimer::singleShot(0, this, [this] { m_inPass = false; });
+  }
+  // Blocks beyond the budget of the pass are left pending. Leaving the state
+  // of a pending block unchanged also ends the rehighlighting of subsequent
+  // blocks, which QSyntaxHighlighter continues whilst block states change.
+  const int blockNumber = currentBlock().blockNumber();
+  if (m_passTimer.elapsed() > s_sliceBudget && !isPriority(blockNumber)) {
+    setCurrentBlockState(s_pendingState);
+    m_nextPending = std::min(m_nextPending, blockNumber);
+    m_pendingTimer.start();
+    return;
+  }
+
+  setCurrentBlockState(-1);
   int row = currentBlock().firstLineNumber();
   if (m_errors && m_errors->toMap().count(row) != 0) {
     setFormat(0, text.length(), errorFormat);
@@ -19,4 +43,70 @@ void SyntaxHighlighter::highlightBlock(const QString &text) {
   }
 }
 
+void SyntaxHighlighter::setPriorityBlocks(int first, int last) {
+  m_firstPriority = first;
+  m_lastPriority = last;
+  if (!m_pendingTimer.isActive() || !document())
+    return;
+
+  m_highlightingPending = true;
+  m_passTimer.start();
+  for (auto block = document()->findBlockByNumber(first);
+       block.isValid() && block.blockNumber() <= last; block = block.next()) {
+    if (block.userState() == s_pendingState)
+      rehighlightBlock(block);
+  }
+  m_highlightingPending = false;
+}
+
+void SyntaxHighlighter::highlightPendingBlocks() {
+  if (!document())
+    return;
+
+  m_highlightingPending = true;
+  m_passTimer.start();
+  auto block = document()->findBlockByNumber(m_nextPending);
+  for (; block.isValid() && m_passTimer.elapsed() < s_sliceBudget;
+       block = block.next()) {
+    if (block.userState() == s_pendingState)
+      rehighlightBlock(block);
+  }
+  m_highlightingPending = false;
+
+  if (block.isValid()) {
+    m_nextPending = block.blockNumber();
+    m_pendingTimer.start();
+  } else {
+    m_nextPending = document()->blockCount();
+  }
+}
+
+void SyntaxHighlighter::setRules(const std::vector<HighlightingRule> &rules) {
+  QStringList alternatives;
+  for (size_t i = 0; i < rules.size(); ++i)
+    alternatives << "(?<r" + QString::number(i) + ">" + rules.at(i).pattern +
+                        ")";
+  m_lexer = QRegularExpression(alternatives.join('|'));
+  m_lexer.optimize();
+
+  m_ruleFormats.clear();
+  const QStringList groups = m_lexer.namedCaptureGroups();
+  for (size_t i = 0; i < rules.size(); ++i)
+    m_ruleFormats.emplace_back(groups.indexOf("r" + QString::number(i)),
+                               rules.at(i).format);
+}
+
+void SyntaxHighlighter::applyRules(const QString &text) {
+  QRegularExpressionMatchIterator matchIterator = m_lexer.globalMatch(text);
+  while (matchIterator.hasNext()) {
+    const QRegularExpressionMatch match = matchIterator.next();
+    for (const auto &[group, format] : m_ruleFormats) {
+      if (match.capturedStart(group) != -1) {
+        setFormat(match.capturedStart(), match.capturedLength(), format);
+        break;
+      }
+    }
+  }
+}
+
 } // namespace Ripes
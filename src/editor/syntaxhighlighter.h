@@ -1,6 +1,9 @@
 #pragma once
 
+#include <QElapsedTimer>
+#include <QRegularExpression>
 #include <QSyntaxHighlighter>
+#include <QTimer>
 #include <memory>
 
 #include "isa/isa_defines.h"
@@ -18,6 +21,10 @@ public:
    * @brief highlightBlock
    * Performs language-independent highlighting, such as line-underlining upon
    * an error during assembly/compilation.
+   *
+   * Blocks are highlighted for at most s_sliceBudget ms at a time. Blocks
+   * beyond that budget, which are not within the priority range, are left
+   * pending and highlighted in time slices from the event loop.
    */
   void highlightBlock(const QString &text) override final;
   /**
@@ -26,7 +33,30 @@ public:
    */
   virtual void syntaxHighlightBlock(const QString &text) = 0;
 
+  /**
+   * @brief setPriorityBlocks
+   * Sets the range of blocks, typically those visible in the editor, which are
+   * always highlighted immediately. Pending blocks within the range are
+   * highlighted upon being set.
+   */
+  void setPriorityBlocks(int first, int last);
+
 protected:
+  struct HighlightingRule {
+    QString pattern;
+    QTextCharFormat format;
+  };
+
+  /**
+   * @brief setRules
+   * Compiles @p rules into a single lexer, which matches all rules in a single
+   * pass over a block. Where several rules match at a position, the rule
+   * earliest in @p rules takes precedence.
+   */
+  void setRules(const std::vector<HighlightingRule> &rules);
+  /// Formats the matches of the rules within @p text.
+  void applyRules(const QString &text);
+
   /**
    * @brief m_errors
    * The syntax highlighter may provide a tooltip error for each line in the
@@ -35,5 +65,31 @@ protected:
    */
   std::shared_ptr<Errors> m_errors;
   QTextCharFormat errorFormat;
+
+private:
+  /// Highlights pending blocks for up to s_sliceBudget ms.
+  void highlightPendingBlocks();
+  bool isPriority(int blockNumber) const {
+    return m_firstPriority <= blockNumber && blockNumber <= m_lastPriority;
+  }
+
+  // Block state of blocks which are yet to be highlighted.
+  static constexpr int s_pendingState = -2;
+  static constexpr int s_sliceBudget = 8; // ms
+
+  QRegularExpression m_lexer;
+  // Capture group index and format of each rule of the lexer.
+  std::vector<std::pair<int, QTextCharFormat>> m_ruleFormats;
+
+  int m_firstPriority = 0;
+  int m_lastPriority = -1;
+  // Set whilst the blocks of a single (re)highlighting pass are highlighted.
+  bool m_inPass = false;
+  // Set whilst pending blocks are highlighted, which are never deferred.
+  bool m_highlightingPending = false;
+  QElapsedTimer m_passTimer;
+  QTimer m_pendingTimer;
+  // Block from which to continue searching for pending blocks.
+  int m_nextPending = 0;
 };
 } // namespace Ripes
@@ -2,7 +2,6 @@
 #include "ui_edittab.h"
 
 #include "elfio/elfio.hpp"
-#include "libelfin/dwarf/dwarf++.hh"
 
 #include <QCheckBox>
 #include <QLabel>
@@ -79,8 +78,26 @@ EditTab::EditTab(QToolBar *toolbar, QWidget *parent)
           &EditTab::enableAssemblyInput);
   connect(m_ui->codeEditor, &CodeEditor::timedTextChanged, this,
           &EditTab::sourceCodeChanged);
-
-  m_ui->programViewer->setReadOnly(true);
+  connect(&m_checkWatcher, &QFutureWatcher<CCManager::CCRes>::finished, this,
+          [=] {
+            if (m_checkWatcher.isCanceled() ||
+                m_currentSourceType != SourceType::C)
+              return;
+            const auto res = m_checkWatcher.result();
+            *m_sourceErrors = CCManager::parseErrors(
+                res.errorOutput._stderr, res.inFiles.value(0));
+            m_ui->codeEditor->rehighlight();
+            if (res.success)
+              prebuild();
+          });
+  connect(&m_compileWatcher, &QFutureWatcher<CCManager::CCRes>::finished,
+          this, &EditTab::compileFinished);
+  connect(&m_prebuildWatcher, &QFutureWatcher<CCManager::CCRes>::finished,
+          this, [=] {
+            // The executable is kept in the compilation cache.
+            if (!m_prebuildWatcher.isCanceled())
+              m_prebuildWatcher.result().clean();
+          });
 
   connect(m_ui->setAssemblyInput, &QRadioButton::toggled, this,
           &EditTab::sourceTypeChanged);
@@ -143,7 +160,7 @@ EditTab::EditTab(QToolBar *toolbar, QWidget *parent)
 
 void EditTab::showSymbolNavigator() {
   if (auto program = ProcessorHandler::getProgram()) {
-    SymbolNavigator nav(program->symbols, this);
+    SymbolNavigator nav(program->symbolIndex(), this);
     if (nav.exec()) {
       m_ui->programViewer->setCenterAddress(nav.getSelectedSymbolAddress());
     }
@@ -296,16 +313,24 @@ void EditTab::sourceCodeChanged() {
   case SourceType::Assembly:
     assemble(source);
     break;
+  case SourceType::C:
+    // The user shall manually select to build, but errors are reported while
+    // editing.
+    check(source);
+    break;
   default:
-    // Do nothing, either some external program is loaded or, if compiling from
-    // C, the user shall manually select to build
+    // Do nothing, some external program is loaded
     break;
   }
 }
 
 void EditTab::assemble(const QString &source) {
-  auto res = ProcessorHandler::getAssembler()->assembleRaw(
-      source, &IOManager::get().assemblerSymbols());
+  // The source is reassembled whenever the user pauses typing; reuse the
+  // tokenization and machine code of the lines which were not edited.
+  auto assembler = ProcessorHandler::getAssembler();
+  assembler->setIncremental(true);
+  auto res =
+      assembler->assembleRaw(source, &IOManager::get().assemblerSymbols());
   *m_sourceErrors = res.errors;
   if (m_sourceErrors->size() == 0) {
     ProcessorHandler::loadProgram(std::make_shared<Program>(res.program));
@@ -321,10 +346,43 @@ void EditTab::assemble(const QString &source) {
   m_ui->codeEditor->rehighlight();
 }
 
+void EditTab::check(const QString &source) {
+  // The source is checked whenever the user pauses typing; a check of a
+  // previous edit which is still running is cancelled.
+  m_checkWatcher.future().cancel();
+  m_prebuildWatcher.future().cancel();
+  m_checkedSource = source;
+  m_checkWatcher.setFuture(CCManager::get().compileAsync(source, true));
+}
+
+void EditTab::prebuild() {
+  // Starting the compiler dominates the time of compiling small programs. A
+  // checked source is therefore compiled into the compilation cache while the
+  // user is idle, such that building it is immediate.
+  if (CCManager::get().cacheDirectory().isEmpty())
+    return;
+  m_prebuildSource = m_checkedSource;
+  m_prebuildWatcher.setFuture(CCManager::get().compileAsync(m_prebuildSource));
+}
+
 void EditTab::compile() {
-  // We don't care about asking our editor for syntax accepted, since there is
-  // no C-syntax checking in Ripes.
-  auto res = CCManager::get().compile(m_ui->codeEditor->document());
+  // Compilation runs in the background, such that the editor remains usable.
+  // Building again restarts the compilation.
+  m_compileWatcher.future().cancel();
+  const QString source = m_ui->codeEditor->toPlainText();
+  if (m_prebuildWatcher.isRunning() && source == m_prebuildSource) {
+    // Adopt the ongoing compilation of the source.
+    m_compileWatcher.setFuture(m_prebuildWatcher.future());
+    m_prebuildWatcher.setFuture(QFuture<CCManager::CCRes>());
+    return;
+  }
+  m_compileWatcher.setFuture(CCManager::get().compileAsync(source));
+}
+
+void EditTab::compileFinished() {
+  if (m_compileWatcher.isCanceled())
+    return;
+  auto res = m_compileWatcher.result();
   if (res.success) {
     // Compilation successful; load file through standard file loading functions
     LoadFileParams params;
@@ -335,7 +393,9 @@ void EditTab::compile() {
   } else if (!res.aborted) {
     CompilerErrorDialog errDiag(this);
     errDiag.setText("Compilation failed. Error output was:");
-    errDiag.setErrorText(CCManager::getError());
+    errDiag.setErrorText(res.errorOutput._stderr.isEmpty()
+                             ? res.errorOutput.errMsg
+                             : res.errorOutput._stderr);
     errDiag.exec();
   }
   res.clean();
@@ -390,119 +450,23 @@ bool EditTab::loadSourceFile(Program &, QFile &file) {
   return true;
 }
 
-using namespace ELFIO;
-class ELFIODwarfLoader : public ::dwarf::loader {
-public:
-  ELFIODwarfLoader(elfio &reader) : reader(reader) {}
-
-  const void *load(::dwarf::section_type section, size_t *size_out) override {
-    auto sec = reader.sections[::dwarf::elf::section_type_to_name(section)];
-    if (sec == nullptr)
-      return nullptr;
-    *size_out = sec->get_size();
-    return sec->get_data();
-  }
-
-private:
-  elfio &reader;
-};
-
-std::shared_ptr<ELFIODwarfLoader> createDwarfLoader(elfio &reader) {
-  return std::make_shared<ELFIODwarfLoader>(reader);
-}
-
-static bool isInternalSourceFile(const QString &filename) {
-  // Returns true if we have reason to believe that this file originated from
-  // within the Ripes editor. These will be temporary files like
-  // /.../Ripes.abc123.c
-  static QRegularExpression re("Ripes.[a-zA-Z0-9]+.c");
-  return re.match(filename).hasMatch();
-}
-
 bool EditTab::loadElfFile(Program &program, QFile &file) {
-  ELFIO::elfio reader;
+  auto reader = std::make_shared<ELFIO::elfio>();
 
   // No file validity checking is performed - it is expected that Loaddialog has
   // done all validity checking.
-  if (!reader.load(file.fileName().toStdString())) {
+  if (!reader->load(file.fileName().toStdString())) {
     assert(false);
   }
 
-  for (const auto &elfSection : reader.sections) {
-    // Do not load .debug sections
-    if (!QString::fromStdString(elfSection->get_name()).startsWith(".debug")) {
-      ProgramSection section;
-      section.name = QString::fromStdString(elfSection->get_name());
-      section.address = elfSection->get_address();
-      // QByteArray performs a deep copy of the data when the data array is
-      // initialized at construction
-      section.data = QByteArray(elfSection->get_data(),
-                                static_cast<int>(elfSection->get_size()));
-      program.sections[section.name] = section;
-    }
-
-    if (elfSection->get_type() == SHT_SYMTAB) {
-      // Collect function symbols
-      const ELFIO::symbol_section_accessor symbols(reader, elfSection);
-      for (unsigned int j = 0; j < symbols.get_symbols_num(); ++j) {
-        std::string name;
-        ELFIO::Elf64_Addr value = 0;
-        ELFIO::Elf_Xword size;
-        unsigned char bind;
-        unsigned char type = STT_NOTYPE;
-        ELFIO::Elf_Half section_index;
-        unsigned char other;
-        symbols.get_symbol(j, name, value, size, bind, type, section_index,
-                           other);
-
-        if (type != STT_FUNC)
-          continue;
-        program.symbols[value] = QString::fromStdString(name);
-      }
-    }
-  }
-
-  // Load DWARF information into the source mapping of the program.
-  // We'll only load information from compilation units which originated from a
-  // source file that plausibly arrived from within the Ripes editor.
-  QString editorSrcFile;
-  try {
-    ::dwarf::dwarf dw(createDwarfLoader(reader));
-    for (auto &cu : dw.compilation_units()) {
-      for (auto &line : cu.get_line_table()) {
-        if (!line.file)
-          continue;
-        QString filePath = QString::fromStdString(line.file->path);
-        if (editorSrcFile.isEmpty()) {
-          // Try to see if this compilation unit is from the Ripes editor:
-          if (isInternalSourceFile(filePath))
-            editorSrcFile = filePath;
-        }
-        if (editorSrcFile != filePath)
-          continue;
-        program.sourceMapping[line.address].insert(line.line - 1);
-      }
-    }
-    if (!editorSrcFile.isEmpty()) {
-      // Finally, we need to generate a hash of the source file that we've
-      // loaded source mappings from, so the editor knows what editor contents
-      // applies to this program.
-      QFile srcFile(editorSrcFile);
-      if (srcFile.open(QFile::ReadOnly))
-        program.sourceHash = Program::calculateHash(srcFile.readAll());
-      else
-        throw ::dwarf::format_error("Could not find source file " +
-                                    editorSrcFile.toStdString());
-    }
-  } catch (::dwarf::format_error &e) {
-    std::string msg = "Could not load debug information: ";
-    msg += e.what();
-    GeneralStatusManager::setStatusTimed(QString::fromStdString(msg), 2500);
-  } catch (...) {
-    // Something else went wrong.
-  }
+  loadElfSections(program, *reader, mapFile(program, file.fileName()));
 
-  program.entryPoint = reader.get_entry();
+  // The source mapping is loaded from the DWARF information once used, after
+  // the program is runnable.
+  loadElfSourceMapping(program, reader, file.fileName(),
+                       [](const QString &message) {
+                         GeneralStatusManager::setStatusTimed(message, 2500);
+                       });
 
   m_ui->curInputSrcLabel->setText("Executable (ELF)");
   m_ui->inputSrcPath->setText(file.fileName());
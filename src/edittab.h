@@ -2,12 +2,14 @@
 
 #include <QByteArray>
 #include <QFile>
+#include <QFutureWatcher>
 #include <QWidget>
 #include <map>
 #include <memory>
 
 #include "assembler/assembler.h"
 #include "assembler/program.h"
+#include "ccmanager.h"
 #include "ripestab.h"
 
 namespace Ripes {
@@ -75,7 +77,12 @@ private:
   // Assembles the provided text and updates the ProcessorHandler with the
   // assembled program.
   void assemble(const QString &sourceText);
+  // Checks the provided C source for errors in the background.
+  void check(const QString &sourceText);
+  // Compiles the most recently checked C source in the background.
+  void prebuild();
   void compile();
+  void compileFinished();
 
   void updateProgramViewer();
   bool loadSourceFile(Program &program, QFile &file);
@@ -92,6 +99,14 @@ private:
   Ui::EditTab *m_ui = nullptr;
   std::shared_ptr<Errors> m_sourceErrors;
 
+  // Background checks and compilations of C sources. Watching a new future
+  // cancels the previous one, whose results are then never applied.
+  QFutureWatcher<CCManager::CCRes> m_checkWatcher;
+  QFutureWatcher<CCManager::CCRes> m_compileWatcher;
+  QFutureWatcher<CCManager::CCRes> m_prebuildWatcher;
+  QString m_checkedSource;
+  QString m_prebuildSource;
+
   SourceType m_currentSourceType = SourceType::Assembly;
 
   bool m_editorEnabled = true;
@@ -8,6 +8,7 @@
 #include <QVariant>
 
 #include "processorhandler.h"
+#include "symbolnavigator.h"
 
 namespace Ripes {
 
@@ -48,6 +49,14 @@ void GoToComboBox::signalFilter(int index) {
     }
     break;
   }
+  case GoToFunction::Symbol: {
+    if (auto program = ProcessorHandler::getProgram()) {
+      SymbolNavigator navigator(program->symbolIndex(), this);
+      if (navigator.exec() == QDialog::Accepted)
+        emit jumpToAddress(navigator.getSelectedSymbolAddress());
+    }
+    break;
+  }
   case GoToFunction::Custom: {
     emit jumpToAddress(addrForIndex(index));
     break;
@@ -60,6 +69,10 @@ void GoToSectionComboBox::addTargets() {
   addItem("Address...",
           QVariant::fromValue<GoToUserData>({GoToFunction::Address, 0}));
   if (auto prog_spt = ProcessorHandler::getProgram()) {
+    // Symbols are searched in the symbol navigator, rather than listed.
+    if (!prog_spt->symbols.empty())
+      addItem("Symbol...",
+              QVariant::fromValue<GoToUserData>({GoToFunction::Symbol, 0}));
     for (const auto &section : prog_spt->sections) {
       addItem(section.first,
               QVariant::fromValue<GoToUserData>({GoToFunction::Custom, 0}));
@@ -0,0 +1,318 @@
+#include "inputlog.h"
+
+#include "io/iobase.h"
+#include "processorhandler.h"
+
+#include <QFile>
+
+#include <climits>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace Ripes {
+
+std::atomic<InputLog::Mode> InputLog::s_mode = InputLog::Mode::Off;
+
+namespace {
+constexpr char s_magic[] = "RIPESINL";
+constexpr qint64 s_magicSize = sizeof(s_magic) - 1;
+constexpr char s_version = 1;
+
+enum RecordType : char {
+  TimeRecord = 1,
+  StdInRecord = 2,
+  PeripheralRecord = 3
+};
+
+struct PeripheralInputs {
+  long long instret;
+  std::vector<bool> inputs;
+};
+
+std::mutex s_mutex;
+long long s_inputs = 0;
+bool s_diverged = false;
+
+// Recording
+QByteArray s_log;
+qint64 s_prevTime = 0;
+long long s_prevInstret = 0;
+std::map<std::string, std::vector<bool>> s_recordedInputs;
+
+// Replay
+std::deque<qint64> s_times;
+std::deque<QByteArray> s_stdin;
+std::map<std::string, std::deque<PeripheralInputs>> s_peripheralInputs;
+
+void writeLEB(QByteArray &out, quint64 value) {
+  do {
+    uchar byte = value & 0x7F;
+    value >>= 7;
+    if (value != 0)
+      byte |= 0x80;
+    out.append(static_cast<char>(byte));
+  } while (value != 0);
+}
+
+void writeZigZag(QByteArray &out, qint64 value) {
+  writeLEB(out, (static_cast<quint64>(value) << 1) ^
+                    static_cast<quint64>(value >> (sizeof(value) * CHAR_BIT -
+                                                   1)));
+}
+
+class Reader {
+public:
+  explicit Reader(const QByteArray &data) : m_data(data) {}
+  bool atEnd() const { return m_pos >= m_data.size(); }
+  bool readByte(char &byte) {
+    if (atEnd())
+      return false;
+    byte = m_data.at(m_pos++);
+    return true;
+  }
+  bool readLEB(quint64 &value) {
+    value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+      char byte;
+      if (!readByte(byte))
+        return false;
+      value |= static_cast<quint64>(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0)
+        return true;
+    }
+    return false;
+  }
+  bool readZigZag(qint64 &value) {
+    quint64 encoded;
+    if (!readLEB(encoded))
+      return false;
+    value =
+        static_cast<qint64>(encoded >> 1) ^ -static_cast<qint64>(encoded & 1);
+    return true;
+  }
+  bool readBytes(quint64 size, QByteArray &bytes) {
+    if (size > static_cast<quint64>(m_data.size() - m_pos))
+      return false;
+    bytes = m_data.mid(m_pos, size);
+    m_pos += size;
+    return true;
+  }
+
+private:
+  const QByteArray &m_data;
+  qsizetype m_pos = 0;
+};
+
+std::vector<bool> currentInputs(const IOBase *peripheral) {
+  std::vector<bool> inputs(peripheral->inputs().size());
+  for (unsigned i = 0; i < inputs.size(); ++i)
+    inputs[i] = peripheral->input(i);
+  return inputs;
+}
+
+bool parseLog(const QByteArray &data) {
+  Reader reader(data);
+  QByteArray header;
+  if (!reader.readBytes(s_magicSize + 1, header) ||
+      !header.startsWith(QByteArray(s_magic, s_magicSize)) ||
+      header.at(s_magicSize) != s_version)
+    return false;
+
+  qint64 time = 0;
+  long long instret = 0;
+  while (!reader.atEnd()) {
+    char type;
+    reader.readByte(type);
+    switch (type) {
+    case TimeRecord: {
+      qint64 delta;
+      if (!reader.readZigZag(delta))
+        return false;
+      time += delta;
+      s_times.push_back(time);
+      break;
+    }
+    case StdInRecord: {
+      quint64 size;
+      QByteArray bytes;
+      if (!reader.readLEB(size) || !reader.readBytes(size, bytes))
+        return false;
+      s_stdin.push_back(bytes);
+      break;
+    }
+    case PeripheralRecord: {
+      quint64 delta, idSize, count;
+      QByteArray id, mask;
+      if (!reader.readLEB(delta) || !reader.readLEB(idSize) ||
+          !reader.readBytes(idSize, id) || !reader.readLEB(count) ||
+          !reader.readBytes((count + 7) / 8, mask))
+        return false;
+      instret += delta;
+      PeripheralInputs record{instret, std::vector<bool>(count)};
+      for (unsigned i = 0; i < count; ++i)
+        record.inputs[i] = (mask.at(i / 8) >> (i % 8)) & 1;
+      s_peripheralInputs[id.toStdString()].push_back(std::move(record));
+      break;
+    }
+    default:
+      return false;
+    }
+  }
+  return true;
+}
+
+void clear() {
+  s_inputs = 0;
+  s_diverged = false;
+  s_log.clear();
+  s_prevTime = 0;
+  s_prevInstret = 0;
+  s_recordedInputs.clear();
+  s_times.clear();
+  s_stdin.clear();
+  s_peripheralInputs.clear();
+}
+} // namespace
+
+void InputLog::startRecording() {
+  std::lock_guard lock(s_mutex);
+  clear();
+  s_log.append(s_magic, s_magicSize);
+  s_log.append(s_version);
+  s_mode = Mode::Record;
+}
+
+QString InputLog::startReplay(const QString &path) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly))
+    return "Failed to open input log '" + path + "'";
+  std::lock_guard lock(s_mutex);
+  clear();
+  if (!parseLog(file.readAll())) {
+    clear();
+    return "Invalid input log '" + path + "'";
+  }
+  s_mode = Mode::Replay;
+  return QString();
+}
+
+void InputLog::stop() { s_mode = Mode::Off; }
+
+QString InputLog::save(const QString &path) {
+  QFile file(path);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    return "Failed to open input log '" + path + "'";
+  std::lock_guard lock(s_mutex);
+  if (file.write(s_log) != s_log.size())
+    return "Failed to write input log '" + path + "'";
+  return QString();
+}
+
+qint64 InputLog::time(qint64 live) {
+  const Mode current = mode();
+  if (current == Mode::Off)
+    return live;
+  std::lock_guard lock(s_mutex);
+  if (current == Mode::Record) {
+    s_log.append(TimeRecord);
+    writeZigZag(s_log, live - s_prevTime);
+    s_prevTime = live;
+    ++s_inputs;
+    return live;
+  }
+  if (s_times.empty()) {
+    s_diverged = true;
+    return live;
+  }
+  const qint64 time = s_times.front();
+  s_times.pop_front();
+  ++s_inputs;
+  return time;
+}
+
+std::optional<QByteArray> InputLog::replayStdIn() {
+  if (mode() != Mode::Replay)
+    return {};
+  std::lock_guard lock(s_mutex);
+  if (s_stdin.empty()) {
+    s_diverged = true;
+    return {};
+  }
+  QByteArray bytes = s_stdin.front();
+  s_stdin.pop_front();
+  ++s_inputs;
+  return bytes;
+}
+
+void InputLog::recordStdIn(const QByteArray &bytes) {
+  if (mode() != Mode::Record)
+    return;
+  std::lock_guard lock(s_mutex);
+  s_log.append(StdInRecord);
+  writeLEB(s_log, bytes.size());
+  s_log.append(bytes);
+  ++s_inputs;
+}
+
+void InputLog::peripheralRead(IOBase *peripheral) {
+  const Mode current = mode();
+  if (current == Mode::Off || peripheral->inputs().isEmpty())
+    return;
+  const long long instret =
+      ProcessorHandler::getProcessor()->getInstructionsRetired();
+  const std::string id = peripheral->serializedUniqueID();
+  std::lock_guard lock(s_mutex);
+  if (current == Mode::Record) {
+    std::vector<bool> inputs = currentInputs(peripheral);
+    auto it = s_recordedInputs.find(id);
+    if (it != s_recordedInputs.end() && it->second == inputs)
+      return;
+    s_log.append(PeripheralRecord);
+    writeLEB(s_log, instret - s_prevInstret);
+    s_prevInstret = instret;
+    writeLEB(s_log, id.size());
+    s_log.append(id.data(), id.size());
+    writeLEB(s_log, inputs.size());
+    QByteArray mask((inputs.size() + 7) / 8, '\0');
+    for (unsigned i = 0; i < inputs.size(); ++i)
+      if (inputs[i])
+        mask[i / 8] = mask.at(i / 8) | (1 << (i % 8));
+    s_log.append(mask);
+    s_recordedInputs[id] = std::move(inputs);
+    ++s_inputs;
+    return;
+  }
+
+  // The latest inputs due at this read are applied, overriding any live
+  // inputs.
+  auto &records = s_peripheralInputs[id];
+  std::optional<std::vector<bool>> due;
+  while (!records.empty() && records.front().instret <= instret) {
+    due = std::move(records.front().inputs);
+    records.pop_front();
+    ++s_inputs;
+  }
+  if (due)
+    s_recordedInputs[id] = std::move(*due);
+  auto it = s_recordedInputs.find(id);
+  if (it == s_recordedInputs.end())
+    return;
+  for (unsigned i = 0; i < it->second.size(); ++i)
+    if (peripheral->input(i) != it->second[i])
+      peripheral->setInput(i, it->second[i]);
+}
+
+long long InputLog::inputs() {
+  std::lock_guard lock(s_mutex);
+  return s_inputs;
+}
+
+bool InputLog::diverged() {
+  std::lock_guard lock(s_mutex);
+  return s_diverged ||
+         (mode() == Mode::Replay && (!s_times.empty() || !s_stdin.empty()));
+}
+
+} // namespace Ripes
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+
+#include <atomic>
+#include <optional>
+
+namespace Ripes {
+
+class IOBase;
+
+/**
+ * @brief The InputLog class
+ * Records the nondeterministic inputs of a run, and feeds them back to later
+ * runs, such that two processor models, or two builds of Ripes, may be compared
+ * on the same execution. The inputs are:
+ *  - the times returned by the Time_msec system call,
+ *  - the bytes read from the console input of the program (stdin),
+ *  - the inputs of peripherals (see IOBase::inputs), such as switches and
+ *    buttons set through their views, whenever the peripheral is read.
+ *
+ * The times and console input are replayed in the order in which the program
+ * requested them. Peripheral inputs are logged when they changed since the
+ * previous read of the peripheral, stamped with the number of instructions
+ * retired at the read, and are applied to reads at or after the same number
+ * of retired instructions. If the program requests more inputs than were
+ * recorded, the live inputs are used, and the replay is considered diverged.
+ *
+ * The log is a binary file, starting with the 8-byte magic "RIPESINL" followed
+ * by a version byte. Each record consists of a type byte, followed by:
+ *  - time: the zig-zag encoded LEB128 delta to the previous time, in ms.
+ *  - stdin: the LEB128 length of the bytes read, followed by the bytes.
+ *  - peripheral: the LEB128 delta of instructions retired to the previous
+ *    peripheral record, the LEB128 length of IOBase::serializedUniqueID and
+ *    the ID, and the LEB128 number of inputs followed by the inputs as a
+ *    bitmask, least significant bit first.
+ */
+class InputLog {
+public:
+  enum class Mode { Off, Record, Replay };
+  static Mode mode() { return s_mode.load(std::memory_order_relaxed); }
+
+  /// Starts recording inputs, discarding any previous log.
+  static void startRecording();
+  /// Starts replaying the log at @p path. @returns an error message on
+  /// failure.
+  static QString startReplay(const QString &path);
+  /// Stops recording or replaying.
+  static void stop();
+  /// Writes the recorded log to @p path. @returns an error message on failure.
+  static QString save(const QString &path);
+
+  /// Returns the time to use in place of @p live.
+  static qint64 time(qint64 live);
+  /// Returns the next recorded console input, if replaying and available.
+  static std::optional<QByteArray> replayStdIn();
+  /// Records console input which was read by the program.
+  static void recordStdIn(const QByteArray &bytes);
+  /// Called before each read of @p peripheral by the processor. Records its
+  /// inputs, or sets its inputs to the replayed inputs.
+  static void peripheralRead(IOBase *peripheral);
+
+  /// Returns the number of recorded or replayed inputs.
+  static long long inputs();
+  /// Returns true if the program requested inputs which were not recorded, or
+  /// if recorded inputs were left unused.
+  static bool diverged();
+
+private:
+  static std::atomic<Mode> s_mode;
+};
+
+} // namespace Ripes
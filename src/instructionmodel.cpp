@@ -1,6 +1,9 @@
 #include "instructionmodel.h"
 #include <QHeaderView>
 
+#include <algorithm>
+
+#include "cachesim/cachesim.h"
 #include "processorhandler.h"
 
 namespace Ripes {
@@ -27,12 +30,8 @@ int InstructionModel::addressToRow(AInt addr) const {
 
 InstructionModel::InstructionModel(QObject *parent)
     : QAbstractTableModel(parent) {
-  for (auto idx : ProcessorHandler::getProcessor()->structure().stageIt()) {
-    m_stageNames[idx] = ProcessorHandler::getProcessor()->stageName(idx);
-    m_stageInfos[idx] = ProcessorHandler::getProcessor()->stageInfo(idx);
-  }
-  connect(ProcessorHandler::get(), &ProcessorHandler::procStateChangedNonRun,
-          this, &InstructionModel::updateStageInfo);
+  for (auto idx : ProcessorHandler::getProcessor()->structure().stageIt())
+    m_stageNames.push_back(ProcessorHandler::getProcessor()->stageName(idx));
   connect(ProcessorHandler::get(), &ProcessorHandler::processorReset, this,
           &InstructionModel::onProcessorReset);
   onProcessorReset();
@@ -44,8 +43,11 @@ void InstructionModel::onProcessorReset() {
 
   updateRowCount();
   beginResetModel();
+  m_stageInfos.clear();
   endResetModel();
   updateStageInfo();
+  m_icacheAccesses = m_dcacheAccesses = s_stale;
+  updateMisses();
 }
 
 int InstructionModel::columnCount(const QModelIndex &) const {
@@ -63,34 +65,76 @@ void InstructionModel::updateRowCount() {
 int InstructionModel::rowCount(const QModelIndex &) const { return m_rowCount; }
 
 void InstructionModel::updateStageInfo() {
-  bool firstStageChanged = false;
-  for (auto idx : ProcessorHandler::getProcessor()->structure().stageIt()) {
-    auto stageInfoIt = m_stageInfos.find(idx);
-    if (stageInfoIt != m_stageInfos.end()) {
-      auto &oldStageInfo = m_stageInfos.at(idx);
-      if (idx == StageIndex(0, 0)) {
-        if (oldStageInfo.pc !=
-            ProcessorHandler::getProcessor()->stageInfo(idx).pc) {
-          firstStageChanged = true;
-        }
-      }
-      const auto stageInfo = ProcessorHandler::getProcessor()->stageInfo(idx);
-      const AInt oldAddress = oldStageInfo.pc;
-      if (oldStageInfo != stageInfo) {
-        oldStageInfo = stageInfo;
-        const int oldRow = addressToRow(oldAddress);
-        const int newRow = addressToRow(stageInfo.pc);
-        const QModelIndex oldIdx = index(oldRow, Stage);
-        const QModelIndex newIdx = index(newRow, Stage);
-        emit dataChanged(oldIdx, oldIdx, {Qt::DisplayRole});
-        emit dataChanged(newIdx, newIdx, {Qt::DisplayRole});
-      }
-      if (firstStageChanged) {
-        emit firstStageInstrChanged(addressToRow(m_stageInfos.at({0, 0}).pc));
-        firstStageChanged = false;
-      }
-    }
+  const auto changes =
+      ProcessorHandler::getProcessor()->stageChanges(m_stageInfos);
+  if (changes.empty() || !m_program)
+    return;
+
+  // Only the rows of the instructions which entered or left a stage change.
+  auto &disassembleRes = m_program->getDisassembled();
+  std::vector<int> rows;
+  rows.reserve(changes.size() * 2);
+  std::optional<AInt> firstStagePC;
+  for (const auto &change : changes) {
+    for (const AInt pc : {change.oldPC, change.newPC})
+      if (auto row = disassembleRes.addressToIndex(pc); row.has_value())
+        rows.push_back(*row);
+    if (change.stage == StageIndex(0, 0) && change.oldPC != change.newPC)
+      firstStagePC = change.newPC;
+  }
+  std::sort(rows.begin(), rows.end());
+  rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+  for (size_t i = 0; i < rows.size();) {
+    size_t last = i;
+    while (last + 1 < rows.size() && rows[last + 1] == rows[last] + 1)
+      ++last;
+    emit dataChanged(index(rows[i], Stage), index(rows[last], Stage),
+                     {Qt::DisplayRole});
+    i = last + 1;
   }
+  if (firstStagePC.has_value())
+    emit firstStageInstrChanged(addressToRow(*firstStagePC));
+}
+
+void InstructionModel::setCaches(
+    const std::shared_ptr<const CacheSim> &icache,
+    const std::shared_ptr<const CacheSim> &dcache) {
+  m_icache = icache;
+  m_dcache = dcache;
+  m_icacheAccesses = m_dcacheAccesses = s_stale;
+  updateMisses();
+}
+
+void InstructionModel::updateMisses() {
+  // Caches may be simulated on worker threads whilst running.
+  if (ProcessorHandler::isRunning())
+    return;
+  const auto accesses = [](const std::shared_ptr<const CacheSim> &cache) {
+    return cache ? cache->getHits() + cache->getMisses() : 0;
+  };
+  const unsigned icacheAccesses = accesses(m_icache);
+  const unsigned dcacheAccesses = accesses(m_dcache);
+  if (icacheAccesses == m_icacheAccesses && dcacheAccesses == m_dcacheAccesses)
+    return;
+  m_icacheAccesses = icacheAccesses;
+  m_dcacheAccesses = dcacheAccesses;
+
+  m_misses.clear();
+  if (m_icache)
+    for (const auto &[pc, counts] : m_icache->getPCAccesses()) {
+      auto &misses = m_misses[pc];
+      misses.fetches = counts.accesses;
+      misses.fetchMisses = counts.misses;
+    }
+  if (m_dcache)
+    for (const auto &[pc, counts] : m_dcache->getPCAccesses()) {
+      auto &misses = m_misses[pc];
+      misses.accesses = counts.accesses;
+      misses.accessMisses = counts.misses;
+    }
+  if (m_rowCount != 0)
+    emit dataChanged(index(0, Misses), index(m_rowCount - 1, Misses),
+                     {Qt::DisplayRole, Qt::ToolTipRole});
 }
 
 bool InstructionModel::setData(const QModelIndex &index, const QVariant &value,
@@ -118,6 +162,10 @@ QVariant InstructionModel::headerData(int section, Qt::Orientation orientation,
     case Column::Stage:
       return role == Qt::DisplayRole ? "Stage"
                                      : "Stages currently executing instructon";
+    case Column::Misses:
+      return role == Qt::DisplayRole
+                 ? "Misses"
+                 : "Instruction and data cache misses of instructions";
     case Column::Instruction:
       return "Instruction";
     default:
@@ -135,9 +183,10 @@ QVariant InstructionModel::PCData(AInt addr) const {
 }
 QVariant InstructionModel::stageData(AInt addr) const {
   QStringList stagesForAddr;
-  for (const auto &si : m_stageInfos) {
-    if ((si.second.pc == addr) && si.second.stage_valid) {
-      stagesForAddr << m_stageNames.at(si.first);
+  for (unsigned i = 0; i < m_stageInfos.size(); ++i) {
+    const auto &si = m_stageInfos.at(i);
+    if ((si.pc == addr) && si.stage_valid) {
+      stagesForAddr << m_stageNames.at(i);
     }
   }
   if (stagesForAddr.isEmpty()) {
@@ -147,6 +196,33 @@ QVariant InstructionModel::stageData(AInt addr) const {
   }
 }
 
+QVariant InstructionModel::missesData(AInt addr, int role) const {
+  auto it = m_misses.find(addr);
+  if (it == m_misses.end())
+    return QVariant();
+  const auto &misses = it->second;
+  if (role == Qt::ToolTipRole) {
+    QStringList lines;
+    if (misses.fetches != 0)
+      lines << QString("Instruction cache: %1 misses of %2 fetches")
+                   .arg(misses.fetchMisses)
+                   .arg(misses.fetches);
+    if (misses.accesses != 0)
+      lines << QString("Data cache: %1 misses of %2 accesses")
+                   .arg(misses.accessMisses)
+                   .arg(misses.accesses);
+    return lines.join("\n");
+  }
+  if (misses.fetchMisses == 0 && misses.accessMisses == 0)
+    return QVariant();
+  QStringList counts;
+  if (misses.fetchMisses != 0)
+    counts << "I:" + QString::number(misses.fetchMisses);
+  if (misses.accessMisses != 0)
+    counts << "D:" + QString::number(misses.accessMisses);
+  return counts.join(" ");
+}
+
 QVariant InstructionModel::instructionData(AInt addr) const {
   if (m_program) {
     auto &disres = m_program->getDisassembled();
@@ -182,6 +258,12 @@ QVariant InstructionModel::data(const QModelIndex &index, int role) const {
     }
     break;
   }
+  case Column::Misses: {
+    if (role == Qt::DisplayRole || role == Qt::ToolTipRole) {
+      return missesData(addr, role);
+    }
+    break;
+  }
   case Column::Instruction: {
     if (role == Qt::DisplayRole) {
       return instructionData(addr);
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <memory>
 #include <set>
+#include <unordered_map>
 
 #include <QAbstractTableModel>
 #include <QColor>
@@ -10,13 +12,21 @@
 
 namespace Ripes {
 
+class CacheSim;
 class Parser;
 class Pipeline;
 
 class InstructionModel : public QAbstractTableModel {
   Q_OBJECT
 public:
-  enum Column { Breakpoint = 0, PC = 1, Stage = 2, Instruction = 3, NColumns };
+  enum Column {
+    Breakpoint = 0,
+    PC = 1,
+    Stage = 2,
+    Misses = 3,
+    Instruction = 4,
+    NColumns
+  };
   InstructionModel(QObject *parent = nullptr);
 
   int rowCount(const QModelIndex &parent = QModelIndex()) const override;
@@ -32,6 +42,16 @@ public:
   Qt::ItemFlags flags(const QModelIndex &index) const override;
   AInt indexToAddress(const QModelIndex &index) const;
   int addressToRow(AInt addr) const;
+  /// Updates the stage information of the model from the processor. Invoked
+  /// by the view whenever the processor state changed whilst it is shown.
+  void updateStageInfo();
+  /// Sets the caches whose misses are shown per instruction (see
+  /// CacheSim::getPCAccesses).
+  void setCaches(const std::shared_ptr<const CacheSim> &icache,
+                 const std::shared_ptr<const CacheSim> &dcache);
+  /// Updates the misses of the model from the caches. The caches are only read
+  /// whilst the processor is not running.
+  void updateMisses();
 
 signals:
   /**
@@ -42,19 +62,34 @@ signals:
   void firstStageInstrChanged(int row);
 
 private:
-  void updateStageInfo();
-
   QVariant BPData(AInt addr) const;
   QVariant PCData(AInt addr) const;
   QVariant stageData(AInt addr) const;
+  QVariant missesData(AInt addr, int role) const;
   QVariant instructionData(AInt addr) const;
   void updateRowCount();
   void onProcessorReset();
 
   std::shared_ptr<const Program> m_program;
-  std::map<StageIndex, QString> m_stageNames;
-  using StageID = unsigned;
-  std::map<StageIndex, StageInfo> m_stageInfos;
+  // Names and information of the stages of the processor, in the order of
+  // ProcessorStructure::stageIt().
+  std::vector<QString> m_stageNames;
+  std::vector<StageInfo> m_stageInfos;
   int m_rowCount = 0;
+
+  struct InstrMisses {
+    unsigned fetches = 0;
+    unsigned fetchMisses = 0;
+    unsigned accesses = 0;
+    unsigned accessMisses = 0;
+  };
+  std::shared_ptr<const CacheSim> m_icache;
+  std::shared_ptr<const CacheSim> m_dcache;
+  // Misses of the caches per instruction, as of the last update. The number
+  // of accesses of each cache at the last update detects changes.
+  static constexpr unsigned s_stale = static_cast<unsigned>(-1);
+  std::unordered_map<AInt, InstrMisses> m_misses;
+  unsigned m_icacheAccesses = s_stale;
+  unsigned m_dcacheAccesses = s_stale;
 };
 } // namespace Ripes
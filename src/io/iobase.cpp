@@ -6,11 +6,9 @@ namespace Ripes {
 
 std::map<unsigned, std::set<unsigned>> IOBase::s_peripheralIDs;
 
-IOBase::IOBase(unsigned IOType, QWidget *parent)
-    : QWidget(parent), m_type(IOType) {
+IOBase::IOBase(unsigned IOType, QObject *parent)
+    : QObject(parent), m_type(IOType) {
   m_id = claimPeripheralId(m_type);
-  connect(this, &IOBase::scheduleUpdate, this,
-          QOverload<>::of(&QWidget::update));
 }
 
 QString cName(const QString &name) {
@@ -1,7 +1,8 @@
 ﻿#pragma once
 
+#include <QObject>
+#include <QStringList>
 #include <QVariant>
-#include <QWidget>
 #include <set>
 
 #include "../assembler/program.h"
@@ -10,6 +11,8 @@
 
 #include "VSRTL/external/cereal/include/cereal/cereal.hpp"
 
+QT_FORWARD_DECLARE_CLASS(QWidget);
+
 namespace Ripes {
 
 /**
@@ -59,11 +62,20 @@ struct RegDesc {
   bool exported = false;
 };
 
-class IOBase : public QWidget {
+class IOView;
+
+/**
+ * @brief The IOBase class
+ * The state and memory-mapped behaviour of a peripheral. Peripherals are
+ * independent of their presentation, such that they may be instantiated
+ * without a display, such as in the CLI. Peripherals are presented in the GUI
+ * through the view created by createView.
+ */
+class IOBase : public QObject {
   Q_OBJECT
 
 public:
-  IOBase(unsigned IOType /*ioregistry.h::IOType*/, QWidget *parent);
+  IOBase(unsigned IOType /*ioregistry.h::IOType*/, QObject *parent);
   virtual ~IOBase() {
     assert(m_didUnregister &&
            "IO peripherals must call unregister() in their destructor!");
@@ -118,6 +130,50 @@ public:
    */
   virtual void reset() {}
 
+  /**
+   * @brief createView
+   * @returns a new widget presenting this peripheral, through which the
+   * inputs of the peripheral may be set by the user.
+   */
+  virtual IOView *createView(QWidget *parent) = 0;
+
+  /**
+   * @brief inputs
+   * @returns the names of the inputs of this peripheral, such as its buttons,
+   * indexed as by setInput. Inputs are set by the view of the peripheral, or
+   * scripted when running without a view (see IOConfig).
+   */
+  virtual QStringList inputs() const { return {}; }
+  virtual bool input(unsigned index) const {
+    Q_UNUSED(index);
+    return false;
+  }
+  virtual void setInput(unsigned index, bool value) {
+    Q_UNUSED(index);
+    Q_UNUSED(value);
+  }
+
+  /**
+   * @brief saveState
+   * Appends the state of this peripheral which is not held by its parameters
+   * and inputs to @p state, for snapshots (see Snapshot). Returns false if the
+   * state cannot currently be saved, such as whilst a transfer is in progress.
+   * Peripherals without such state keep the default.
+   */
+  virtual bool saveState(std::vector<uint64_t> &state) const {
+    Q_UNUSED(state);
+    return true;
+  }
+  /**
+   * @brief restoreState
+   * Restores the state saved by saveState over the reset peripheral, once the
+   * processor and the inputs of the peripheral have been restored. Returns
+   * false if @p state was not saved by a peripheral of the same parameters.
+   */
+  virtual bool restoreState(const std::vector<uint64_t> &state) {
+    return state.empty();
+  }
+
   /**
    * Read/write functions from processor
    */
@@ -129,6 +185,14 @@ public:
    */
   std::function<void(AInt, AInt, VInt)> memWrite;
   std::function<VInt(AInt, AInt)> memRead;
+  /// Reads a block of bytes from simulator memory, as multiple memRead's.
+  std::function<void(AInt, char *, size_t)> memReadBlock;
+  /// Raises or lowers the interrupt line of interrupt source @p source of the
+  /// interrupt controllers.
+  std::function<void(unsigned source, bool level)> setInterruptLine;
+  /// Number of interrupt sources of an interrupt controller. Source 0 is
+  /// reserved as "no interrupt".
+  static constexpr unsigned s_interruptSources = 32;
 
   unsigned iotype() const { return m_type; }
   unsigned id() const { return m_id; }
@@ -181,6 +245,13 @@ signals:
    */
   void scheduleUpdate();
 
+  /**
+   * @brief inputsChanged
+   * Emitted when the inputs of this peripheral are set, such that views may
+   * reflect inputs which were not set through the view.
+   */
+  void inputsChanged();
+
   /**
    * @brief aboutToDelete
    * Signal emitted when this IO peripheral is about to be destroyed. @param ok
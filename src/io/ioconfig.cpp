@@ -0,0 +1,128 @@
+#include "ioconfig.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+
+#include <algorithm>
+
+#include "iomanager.h"
+#include "ioregistry.h"
+#include "processorhandler.h"
+
+namespace Ripes {
+
+IOConfig::~IOConfig() {
+  if (auto *processor = ProcessorHandler::getProcessorNonConst())
+    processor->events().cancel(this);
+  for (auto *peripheral : m_peripherals)
+    delete peripheral;
+}
+
+QString IOConfig::loadFile(const QString &path) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly))
+    return "Failed to open peripheral configuration '" + path + "'";
+  QJsonParseError parseError;
+  const QJsonDocument doc =
+      QJsonDocument::fromJson(file.readAll(), &parseError);
+  if (parseError.error != QJsonParseError::NoError)
+    return "Invalid peripheral configuration: " + parseError.errorString();
+  if (!doc.isObject())
+    return "Invalid peripheral configuration: expected a JSON object";
+  return load(doc.object());
+}
+
+QString IOConfig::load(const QJsonObject &config) {
+  for (const auto &entry : config.value("peripherals").toArray())
+    if (QString error = loadPeripheral(entry.toObject()); !error.isEmpty())
+      return error;
+  for (const auto &entry : config.value("timeline").toArray())
+    if (QString error = loadInput(entry.toObject()); !error.isEmpty())
+      return error;
+  std::stable_sort(
+      m_timeline.begin(), m_timeline.end(),
+      [](const Input &a, const Input &b) { return a.cycle < b.cycle; });
+
+  // Processor resets clear the events of the processor, after which the
+  // timeline is replayed.
+  connect(&IOManager::get(), &IOManager::peripheralsReset, this,
+          &IOConfig::restart, Qt::UniqueConnection);
+  restart();
+  return QString();
+}
+
+QString IOConfig::loadPeripheral(const QJsonObject &entry) {
+  const QString type = entry.value("type").toString();
+  auto it =
+      std::find_if(IOTypeTitles.begin(), IOTypeTitles.end(),
+                   [&](const auto &title) { return title.second == type; });
+  if (it == IOTypeTitles.end())
+    return "Unknown peripheral type '" + type + "'";
+  auto *peripheral = IOManager::get().createPeripheral(it->first);
+  m_peripherals.push_back(peripheral);
+
+  const QJsonObject parameters = entry.value("parameters").toObject();
+  for (auto param = parameters.begin(); param != parameters.end(); ++param) {
+    const auto &params = peripheral->parameters();
+    auto match = std::find_if(params.begin(), params.end(), [&](const auto &p) {
+      return p.second.name == param.key();
+    });
+    if (match == params.end())
+      return "Unknown parameter '" + param.key() + "' of " + peripheral->name();
+    const IOParam &p = match->second;
+    const QVariant value = param.value().toVariant();
+    if (p.hasRange && (value.toInt() < p.min.toInt() ||
+                       value.toInt() > p.max.toInt()))
+      return "Parameter '" + param.key() + "' of " + peripheral->name() +
+             " is out of range";
+    peripheral->setParameter(p.id, value);
+  }
+  return QString();
+}
+
+QString IOConfig::loadInput(const QJsonObject &entry) {
+  const QString name = entry.value("peripheral").toString();
+  auto it = std::find_if(m_peripherals.begin(), m_peripherals.end(),
+                         [&](IOBase *p) { return p->name() == name; });
+  if (it == m_peripherals.end())
+    return "Unknown peripheral '" + name + "' in timeline";
+  const QString input = entry.value("input").toVariant().toString();
+  const int index = (*it)->inputs().indexOf(input);
+  if (index < 0)
+    return "Unknown input '" + input + "' of " + name;
+  const QJsonValue cycle = entry.value("cycle");
+  if (!cycle.isDouble() || cycle.toDouble() < 0)
+    return "Invalid cycle in timeline";
+  m_timeline.push_back(Input{cycle.toInteger(), *it, unsigned(index),
+                             entry.value("value").toVariant().toBool()});
+  return QString();
+}
+
+void IOConfig::restart() {
+  // Inputs are released until set by the timeline.
+  for (auto *peripheral : m_peripherals)
+    for (int i = 0; i < peripheral->inputs().size(); ++i)
+      peripheral->setInput(i, false);
+  m_next = 0;
+  scheduleNext();
+}
+
+void IOConfig::scheduleNext() {
+  auto *processor = ProcessorHandler::getProcessorNonConst();
+  if (!processor || m_next >= m_timeline.size())
+    return;
+  processor->events().schedule(this, m_timeline.at(m_next).cycle, [this] {
+    // Inputs which are due are set together.
+    const long long cycle =
+        ProcessorHandler::getProcessor()->getCycleCount();
+    for (; m_next < m_timeline.size() && m_timeline.at(m_next).cycle <= cycle;
+         ++m_next) {
+      const Input &input = m_timeline.at(m_next);
+      input.peripheral->setInput(input.index, input.value);
+    }
+    scheduleNext();
+  });
+}
+
+} // namespace Ripes
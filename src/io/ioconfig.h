@@ -0,0 +1,71 @@
+#pragma once
+
+#include <QJsonObject>
+#include <QObject>
+
+#include "iobase.h"
+
+namespace Ripes {
+
+/**
+ * @brief The IOConfig class
+ * Peripherals instantiated without views, as described by a JSON
+ * configuration, such that programs using peripherals may be run without a
+ * display. The inputs of the peripherals, such as switches and buttons, are
+ * set by a timeline of the configuration, which is replayed upon each reset of
+ * the processor, such that runs are deterministic:
+ *
+ *   {
+ *     "peripherals": [
+ *       {"type": "Switches", "parameters": {"# Switches": 4}},
+ *       {"type": "D-Pad"}
+ *     ],
+ *     "timeline": [
+ *       {"cycle": 0, "peripheral": "Switches 0", "input": "2", "value": true},
+ *       {"cycle": 5000, "peripheral": "D-Pad 0", "input": "UP", "value": 1}
+ *     ]
+ *   }
+ *
+ * Peripherals are referred to by their names (see IOBase::name), and inputs by
+ * the names of IOBase::inputs. Inputs are released upon reset, and an input is
+ * set before the cycle of its entry is executed. The peripherals are removed
+ * once the configuration is destroyed.
+ */
+class IOConfig : public QObject {
+  Q_OBJECT
+
+public:
+  IOConfig() = default;
+  ~IOConfig() override;
+
+  /// Instantiates the peripherals of @p config, and schedules its timeline.
+  /// Returns an error message on failure.
+  QString load(const QJsonObject &config);
+  /// As load, for the configuration of the JSON file at @p path.
+  QString loadFile(const QString &path);
+
+  const std::vector<IOBase *> &peripherals() const { return m_peripherals; }
+
+private:
+  struct Input {
+    long long cycle;
+    IOBase *peripheral;
+    unsigned index;
+    bool value;
+  };
+
+  QString loadPeripheral(const QJsonObject &entry);
+  QString loadInput(const QJsonObject &entry);
+
+  /// Replays the timeline from its start.
+  void restart();
+  /// Schedules the next input of the timeline with the processor.
+  void scheduleNext();
+
+  std::vector<IOBase *> m_peripherals;
+  // Inputs of the timeline, sorted by cycle.
+  std::vector<Input> m_timeline;
+  size_t m_next = 0;
+};
+
+} // namespace Ripes
@@ -0,0 +1,254 @@
+#include "iodma.h"
+
+#include <QPainter>
+
+#include <algorithm>
+
+#include "ioregistry.h"
+#include "processorhandler.h"
+
+namespace Ripes {
+
+namespace {
+enum Register {
+  SRC = 0x00,
+  DST = 0x04,
+  LEN = 0x08,
+  CTRL = 0x0C,
+  STATUS = 0x10,
+  CYCLES = 0x14,
+  YIELDED = 0x18
+};
+enum Control { START = 0b1, INTERRUPT_ENABLE = 0b10 };
+enum Status { BUSY = 0b1, DONE = 0b10 };
+} // namespace
+
+IODMA::IODMA(QObject *parent) : IOBase(IOType::DMA, parent) {
+  m_parameters[BANDWIDTH] =
+      IOParam(BANDWIDTH, "Bandwidth (bytes/cycle)", 4, true, 1, 64);
+  m_parameters[PRIORITY] =
+      IOParam(PRIORITY, "Core priority (0: off, 1: on)", 1, true, 0, 1);
+  m_parameters[SOURCE] =
+      IOParam(SOURCE, "Interrupt source", 2, true, 1, s_interruptSources - 1);
+
+  m_regDescs.push_back(RegDesc{"SRC", RegDesc::RW::RW, 32, SRC, true});
+  m_regDescs.push_back(RegDesc{"DST", RegDesc::RW::RW, 32, DST, true});
+  m_regDescs.push_back(RegDesc{"LEN", RegDesc::RW::RW, 32, LEN, true});
+  m_regDescs.push_back(RegDesc{"CTRL", RegDesc::RW::RW, 32, CTRL, true});
+  m_regDescs.push_back(RegDesc{"STATUS", RegDesc::RW::RW, 32, STATUS, true});
+  m_regDescs.push_back(RegDesc{"CYCLES", RegDesc::RW::R, 32, CYCLES, true});
+  m_regDescs.push_back(RegDesc{"YIELDED", RegDesc::RW::R, 32, YIELDED, true});
+  m_extraSymbols.push_back(IOSymbol{"SOURCE", source()});
+
+  // Transfers are scheduled with the processor, and are abandoned along with
+  // it.
+  connect(ProcessorHandler::get(), &ProcessorHandler::processorChanged, this,
+          &IODMA::reset);
+}
+
+IODMA::~IODMA() {
+  if (auto *processor = ProcessorHandler::getProcessorNonConst())
+    processor->events().cancel(this);
+  unregister();
+}
+
+unsigned IODMA::bandwidth() const {
+  return m_parameters.at(BANDWIDTH).value.toUInt();
+}
+
+bool IODMA::corePriority() const {
+  return m_parameters.at(PRIORITY).value.toUInt() != 0;
+}
+
+unsigned IODMA::source() const {
+  return m_parameters.at(SOURCE).value.toUInt();
+}
+
+QString IODMA::description() const {
+  QStringList desc;
+  desc << "Copies LEN bytes from SRC to DST in the background of the "
+          "processor, in ascending order of addresses.";
+  desc << "Writing bit 0 of CTRL starts a transfer, unless one is in "
+          "progress. Bit 1 of CTRL enables raising the interrupt source "
+          "SOURCE once the transfer completes.";
+  desc << "Bit 0 of STATUS is set whilst a transfer is in progress, and bit 1 "
+          "once it has completed. Writing STATUS clears bit 1 and lowers the "
+          "interrupt source.";
+  desc << "Up to 'Bandwidth' bytes are copied per cycle. With core priority, "
+          "the transfer yields the cycle following each data memory access "
+          "of the processor.";
+  desc << "CYCLES holds the cycles taken by the latest transfer, and YIELDED "
+          "the cycles of the transfer which were yielded to the processor.";
+  return desc.join('\n');
+}
+
+VInt IODMA::ioRead(AInt offset, unsigned) {
+  switch (offset) {
+  case SRC:
+    return m_regs.src;
+  case DST:
+    return m_regs.dst;
+  case LEN:
+    return m_regs.length;
+  case CTRL:
+    return m_interruptEnable ? INTERRUPT_ENABLE : 0;
+  case STATUS:
+    return (m_busy ? BUSY : 0) | (m_done ? DONE : 0);
+  case CYCLES:
+    return m_cycles;
+  case YIELDED:
+    return m_yielded;
+  default:
+    return 0;
+  }
+}
+
+void IODMA::ioWrite(AInt offset, VInt value, unsigned) {
+  value &= 0xFFFFFFFF;
+  switch (offset) {
+  case SRC:
+    m_regs.src = value;
+    break;
+  case DST:
+    m_regs.dst = value;
+    break;
+  case LEN:
+    m_regs.length = value;
+    break;
+  case CTRL:
+    m_interruptEnable = value & INTERRUPT_ENABLE;
+    if ((value & START) && !m_busy)
+      start();
+    break;
+  case STATUS:
+    m_done = false;
+    setLine(false);
+    break;
+  default:
+    return;
+  }
+  emit scheduleUpdate();
+}
+
+void IODMA::start() {
+  auto *processor = ProcessorHandler::getProcessorNonConst();
+  if (!processor)
+    return;
+  m_transfer = m_regs;
+  m_copied = 0;
+  m_cycles = 0;
+  m_yielded = 0;
+  m_done = false;
+  setLine(false);
+  m_busy = true;
+  // The transfer starts in the cycle following the write.
+  m_startCycle = processor->getCycleCount();
+  processor->events().schedule(this, m_startCycle + 1, [this] { step(); });
+}
+
+void IODMA::step() {
+  auto *processor = ProcessorHandler::getProcessorNonConst();
+  const long long cycle = processor->getCycleCount();
+  if (corePriority() &&
+      processor->dataMemAccess().type != MemoryAccess::None) {
+    m_yielded++;
+  } else {
+    const uint32_t bytes =
+        std::min<uint32_t>(bandwidth(), m_transfer.length - m_copied);
+    for (uint32_t i = 0; i < bytes; ++i, ++m_copied) {
+      const VInt byte = memRead(m_transfer.src + m_copied, 1);
+      memWrite(m_transfer.dst + m_copied, byte, 1);
+    }
+  }
+
+  if (m_copied < m_transfer.length) {
+    processor->events().schedule(this, cycle + 1, [this] { step(); });
+    return;
+  }
+  m_busy = false;
+  m_done = true;
+  m_cycles = cycle - m_startCycle;
+  if (m_interruptEnable)
+    setLine(true);
+  emit scheduleUpdate();
+}
+
+void IODMA::reset() {
+  if (auto *processor = ProcessorHandler::getProcessorNonConst())
+    processor->events().cancel(this);
+  m_regs = Transfer();
+  m_transfer = Transfer();
+  m_copied = 0;
+  m_busy = false;
+  m_done = false;
+  m_interruptEnable = false;
+  m_cycles = 0;
+  m_yielded = 0;
+  setLine(false);
+  emit scheduleUpdate();
+}
+
+bool IODMA::saveState(std::vector<uint64_t> &state) const {
+  if (m_busy)
+    return false;
+  state.insert(state.end(),
+               {m_regs.src, m_regs.dst, m_regs.length, m_transfer.src,
+                m_transfer.dst, m_transfer.length, m_copied, m_done,
+                m_interruptEnable, m_line, m_cycles, m_yielded});
+  return true;
+}
+
+bool IODMA::restoreState(const std::vector<uint64_t> &state) {
+  if (state.size() != 12)
+    return false;
+  m_regs = {state[0], state[1], uint32_t(state[2])};
+  m_transfer = {state[3], state[4], uint32_t(state[5])};
+  m_copied = state[6];
+  m_done = state[7];
+  m_interruptEnable = state[8];
+  m_cycles = state[10];
+  m_yielded = state[11];
+  setLine(state[9]);
+  emit scheduleUpdate();
+  return true;
+}
+
+void IODMA::parameterChanged(unsigned) {
+  // Lower the line of the previous source.
+  const bool line = m_line;
+  setLine(false);
+  m_extraSymbols.clear();
+  m_extraSymbols.push_back(IOSymbol{"SOURCE", source()});
+  setLine(line);
+  emit regMapChanged();
+}
+
+void IODMA::setLine(bool level) {
+  m_line = level;
+  if (setInterruptLine)
+    setInterruptLine(source(), level);
+}
+
+IOView *IODMA::createView(QWidget *parent) {
+  return new IODMAView(this, parent);
+}
+
+QSize IODMAView::minimumSizeHint() const {
+  return QSize(
+      fontMetrics().horizontalAdvance("Copied: 0000000000 / 0000000000"),
+      fontMetrics().height() * 2);
+}
+
+void IODMAView::paintEvent(QPaintEvent *) {
+  QPainter painter(this);
+  const QString status = m_dma->busy()   ? "busy"
+                         : m_dma->done() ? "done"
+                                         : "-";
+  painter.drawText(rect(), Qt::AlignLeft | Qt::AlignTop,
+                   "Copied: " + QString::number(m_dma->copied()) + " / " +
+                       QString::number(m_dma->length()) +
+                       "\nStatus: " + status);
+  painter.end();
+}
+
+} // namespace Ripes
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <QVariant>
+#include <QWidget>
+
+#include "iobase.h"
+#include "ioview.h"
+
+namespace Ripes {
+
+/**
+ * @brief The IODMA class
+ * A DMA controller, copying a block of memory in the background of the
+ * processor. A transfer is started by writing CTRL, and copies up to
+ * BANDWIDTH bytes per cycle through memRead and memWrite, such that memory
+ * reflects the progress of the transfer.
+ *
+ * The transfer shares the memory port with the data accesses of the
+ * processor. With core priority, the controller yields the cycle following
+ * each data access of the processor, as observed through
+ * RipesProcessor::dataMemAccess.
+ *
+ * The progress of a transfer is scheduled as an event of the processor (see
+ * RipesProcessor::events) for each cycle of the transfer. Completion is
+ * signalled through STATUS, and through an interrupt source if enabled.
+ */
+class IODMA : public IOBase {
+  Q_OBJECT
+
+  enum Parameters { BANDWIDTH, PRIORITY, SOURCE };
+
+public:
+  IODMA(QObject *parent);
+  ~IODMA();
+
+  virtual unsigned byteSize() const override { return 7 * 4; }
+  virtual QString description() const override;
+  virtual QString baseName() const override { return "DMA"; }
+
+  virtual const std::vector<RegDesc> &registers() const override {
+    return m_regDescs;
+  };
+  virtual const std::vector<IOSymbol> *extraSymbols() const override {
+    return &m_extraSymbols;
+  }
+
+  /**
+   * Hardware read/write functions
+   */
+  virtual VInt ioRead(AInt offset, unsigned size) override;
+  virtual void ioWrite(AInt offset, VInt value, unsigned size) override;
+
+  virtual void reset() override;
+
+  /// A transfer in progress, which is scheduled with the processor, cannot be
+  /// saved.
+  bool saveState(std::vector<uint64_t> &state) const override;
+  bool restoreState(const std::vector<uint64_t> &state) override;
+
+  virtual IOView *createView(QWidget *parent) override;
+
+  bool busy() const { return m_busy; }
+  bool done() const { return m_done; }
+  /// Bytes copied by the current, or latest, transfer, and its length.
+  uint32_t copied() const { return m_copied; }
+  uint32_t length() const { return m_transfer.length; }
+
+protected:
+  virtual void parameterChanged(unsigned) override;
+
+private:
+  struct Transfer {
+    AInt src = 0;
+    AInt dst = 0;
+    uint32_t length = 0;
+  };
+
+  void start();
+  /// Performs the transfer of the current cycle, and schedules the next.
+  void step();
+  void setLine(bool level);
+  unsigned bandwidth() const;
+  bool corePriority() const;
+  unsigned source() const;
+
+  // The registers, as last written.
+  Transfer m_regs;
+  // The current, or latest, transfer.
+  Transfer m_transfer;
+  uint32_t m_copied = 0;
+  bool m_busy = false;
+  bool m_done = false;
+  bool m_interruptEnable = false;
+  bool m_line = false;
+  long long m_startCycle = 0;
+  // Cycles taken by, and cycles yielded to the processor during, the latest
+  // transfer.
+  uint32_t m_cycles = 0;
+  uint32_t m_yielded = 0;
+  std::vector<RegDesc> m_regDescs;
+  std::vector<IOSymbol> m_extraSymbols;
+};
+
+class IODMAView : public IOView {
+  Q_OBJECT
+
+public:
+  IODMAView(IODMA *dma, QWidget *parent) : IOView(dma, parent), m_dma(dma) {}
+
+protected:
+  void paintEvent(QPaintEvent *event) override;
+  QSize minimumSizeHint() const override;
+
+private:
+  IODMA *m_dma;
+};
+} // namespace Ripes
@@ -9,112 +9,134 @@
 
 namespace Ripes {
 
-IODPad::IODPad(QWidget *parent) : IOBase(IOType::DPAD, parent) {
-  for (unsigned i = 0; i < DIRECTIONS; ++i) {
-    QString name;
+static const QStringList s_dirNames = {"UP", "DOWN", "LEFT", "RIGHT"};
+
+IODPad::IODPad(QObject *parent) : IOBase(IOType::DPAD, parent) {
+  for (unsigned i = 0; i < DIRECTIONS; ++i)
+    m_regDescs.push_back(
+        RegDesc{s_dirNames.at(i), RegDesc::RW::R, 1, i * 4, true});
+}
+
+unsigned IODPad::byteSize() const { return 4 * 4; }
+
+QStringList IODPad::inputs() const { return s_dirNames; }
+
+bool IODPad::input(unsigned index) const { return (m_pressed >> index) & 1; }
+
+void IODPad::setInput(unsigned index, bool value) {
+  if (index >= DIRECTIONS)
+    return;
+  if (value)
+    m_pressed |= 1u << index;
+  else
+    m_pressed &= ~(1u << index);
+  emit inputsChanged();
+}
+
+QString IODPad::description() const {
+  QStringList desc;
+  desc << "Each button maps to a 32-bit register, with the least-significant "
+          "bit indicating the state of the "
+          "button.\n";
+  desc << "If the D-pad window is in focus, the buttons may be pressed using "
+          "the \"WASD\" keys of the keyboard.";
+
+  return desc.join('\n');
+}
+
+VInt IODPad::ioRead(AInt offset, unsigned) {
+  if (offset % 4 != 0 || offset / 4 >= DIRECTIONS)
+    return 0;
+  return input(offset / 4);
+}
+
+void IODPad::ioWrite(AInt, VInt, unsigned) {
+  // Write-only
+}
+
+IOView *IODPad::createView(QWidget *parent) {
+  return new IODPadView(this, parent);
+}
+
+/**
+ * IO D-Pad view
+ */
+
+IODPadView::IODPadView(IODPad *dpad, QWidget *parent)
+    : IOView(dpad, parent), m_dpad(dpad) {
+  for (unsigned i = 0; i < IODPad::DIRECTIONS; ++i) {
     Qt::ArrowType arrow;
     switch (i) {
-    case UP:
-      name = "UP";
+    case IODPad::UP:
       arrow = Qt::UpArrow;
       break;
-    case DOWN:
-      name = "DOWN";
+    case IODPad::DOWN:
       arrow = Qt::DownArrow;
       break;
-    case LEFT:
-      name = "LEFT";
+    case IODPad::LEFT:
       arrow = Qt::LeftArrow;
       break;
-    case RIGHT:
-      name = "RIGHT";
+    case IODPad::RIGHT:
       arrow = Qt::RightArrow;
       break;
     }
     auto *button = new QToolButton();
-    m_buttons[static_cast<IdxToDir>(i)] = button;
+    m_buttons[static_cast<IODPad::IdxToDir>(i)] = button;
     button->setArrowType(arrow);
-
-    m_regDescs.push_back(RegDesc{name, RegDesc::RW::R, 1, i * 4, true});
+    connect(button, &QAbstractButton::pressed, this,
+            [this, i] { m_dpad->setInput(i, true); });
+    connect(button, &QAbstractButton::released, this,
+            [this, i] { m_dpad->setInput(i, false); });
   }
 
   auto *gridLayout = new QGridLayout();
-  gridLayout->addWidget(m_buttons[UP], 0, 1);
-  gridLayout->addWidget(m_buttons[DOWN], 2, 1);
-  gridLayout->addWidget(m_buttons[LEFT], 1, 0);
-  gridLayout->addWidget(m_buttons[RIGHT], 1, 2);
+  gridLayout->addWidget(m_buttons[IODPad::UP], 0, 1);
+  gridLayout->addWidget(m_buttons[IODPad::DOWN], 2, 1);
+  gridLayout->addWidget(m_buttons[IODPad::LEFT], 1, 0);
+  gridLayout->addWidget(m_buttons[IODPad::RIGHT], 1, 2);
 
   setLayout(gridLayout);
-}
 
-unsigned IODPad::byteSize() const { return 4 * 4; }
+  connect(dpad, &IOBase::inputsChanged, this, &IODPadView::updateButtons);
+}
 
-void IODPad::keyPressEvent(QKeyEvent *e) {
-  switch (e->key()) {
-  case Qt::Key_A:
-    m_buttons.at(LEFT)->setDown(true);
-    return;
-  case Qt::Key_D:
-    m_buttons.at(RIGHT)->setDown(true);
-    return;
-  case Qt::Key_W:
-    m_buttons.at(UP)->setDown(true);
-    return;
-  case Qt::Key_S:
-    m_buttons.at(DOWN)->setDown(true);
-    return;
-  }
-  IOBase::keyPressEvent(e);
+void IODPadView::updateButtons() {
+  for (const auto &[dir, button] : m_buttons)
+    if (button->isDown() != m_dpad->input(dir))
+      button->setDown(m_dpad->input(dir));
 }
-void IODPad::keyReleaseEvent(QKeyEvent *e) {
-  switch (e->key()) {
+
+bool IODPadView::setKey(int key, bool pressed) {
+  IODPad::IdxToDir dir;
+  switch (key) {
   case Qt::Key_A:
-    m_buttons.at(LEFT)->setDown(false);
-    return;
+    dir = IODPad::LEFT;
+    break;
   case Qt::Key_D:
-    m_buttons.at(RIGHT)->setDown(false);
-    return;
+    dir = IODPad::RIGHT;
+    break;
   case Qt::Key_W:
-    m_buttons.at(UP)->setDown(false);
-    return;
+    dir = IODPad::UP;
+    break;
   case Qt::Key_S:
-    m_buttons.at(DOWN)->setDown(false);
-    return;
+    dir = IODPad::DOWN;
+    break;
+  default:
+    return false;
   }
-  IOBase::keyReleaseEvent(e);
-}
-
-QString IODPad::description() const {
-  QStringList desc;
-  desc << "Each button maps to a 32-bit register, with the least-significant "
-          "bit indicating the state of the "
-          "button.\n";
-  desc << "If the D-pad window is in focus, the buttons may be pressed using "
-          "the \"WASD\" keys of the keyboard.";
-
-  return desc.join('\n');
+  m_buttons.at(dir)->setDown(pressed);
+  m_dpad->setInput(dir, pressed);
+  return true;
 }
 
-VInt IODPad::ioRead(AInt offset, unsigned) {
-  switch (offset) {
-  case LEFT * 4: {
-    return m_buttons.at(LEFT)->isDown();
-  }
-  case RIGHT * 4: {
-    return m_buttons.at(RIGHT)->isDown();
-  }
-  case UP * 4: {
-    return m_buttons.at(UP)->isDown();
-  }
-  case DOWN * 4: {
-    return m_buttons.at(DOWN)->isDown();
-  }
-  }
-  return 0;
+void IODPadView::keyPressEvent(QKeyEvent *e) {
+  if (!setKey(e->key(), true))
+    IOView::keyPressEvent(e);
 }
 
-void IODPad::ioWrite(AInt, VInt, unsigned) {
-  // Write-only
+void IODPadView::keyReleaseEvent(QKeyEvent *e) {
+  if (!setKey(e->key(), false))
+    IOView::keyReleaseEvent(e);
 }
 
 } // namespace Ripes
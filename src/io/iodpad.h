@@ -4,19 +4,27 @@
 #include <QVariant>
 #include <QWidget>
 
+#include <atomic>
+
 QT_FORWARD_DECLARE_CLASS(QAbstractButton);
 
 #include "iobase.h"
+#include "ioview.h"
 
 namespace Ripes {
 
+/**
+ * @brief The IODPad class
+ * A directional pad of four buttons, each mapped to a register of the
+ * peripheral. The buttons are the inputs of the peripheral.
+ */
 class IODPad : public IOBase {
   Q_OBJECT
 
+public:
   enum IdxToDir { UP, DOWN, LEFT, RIGHT, DIRECTIONS };
 
-public:
-  IODPad(QWidget *parent);
+  IODPad(QObject *parent);
   ~IODPad() { unregister(); };
 
   virtual unsigned byteSize() const override;
@@ -33,14 +41,44 @@ public:
   virtual VInt ioRead(AInt offset, unsigned size) override;
   virtual void ioWrite(AInt offset, VInt value, unsigned size) override;
 
+  virtual IOView *createView(QWidget *parent) override;
+
+  virtual QStringList inputs() const override;
+  virtual bool input(unsigned index) const override;
+  virtual void setInput(unsigned index, bool value) override;
+
 protected:
   virtual void parameterChanged(unsigned) override{/* no parameters */};
+
+private:
+  std::vector<RegDesc> m_regDescs;
+  // Bit n holds the state of the button of direction n. Set from the GUI
+  // thread, and read by the simulator thread.
+  std::atomic<uint32_t> m_pressed{0};
+};
+
+/**
+ * @brief The IODPadView class
+ * A button per direction, which is pressed by the mouse or by the "WASD" keys
+ * of the keyboard.
+ */
+class IODPadView : public IOView {
+  Q_OBJECT
+
+public:
+  IODPadView(IODPad *dpad, QWidget *parent);
+
+protected:
   void keyPressEvent(QKeyEvent *e) override;
   void keyReleaseEvent(QKeyEvent *e) override;
 
 private:
-  constexpr static unsigned m_maxSideWidth = 256;
-  std::vector<RegDesc> m_regDescs;
-  std::map<IdxToDir, QAbstractButton *> m_buttons;
+  /// Sets the button of the direction of @p key as @p pressed. Returns false
+  /// if the key does not map to a direction.
+  bool setKey(int key, bool pressed);
+  void updateButtons();
+
+  IODPad *m_dpad;
+  std::map<IODPad::IdxToDir, QAbstractButton *> m_buttons;
 };
 } // namespace Ripes
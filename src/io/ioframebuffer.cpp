@@ -0,0 +1,227 @@
+#include "ioframebuffer.h"
+
+#include <QPaintEvent>
+#include <QPainter>
+
+#include <utility>
+
+#include "ioregistry.h"
+
+namespace Ripes {
+
+IOFramebuffer::IOFramebuffer(QObject *parent)
+    : IOBase(IOType::FRAMEBUFFER, parent) {
+  // Parameters
+  m_parameters[WIDTH] = IOParam(WIDTH, "Width", 320, true, 1, s_maxSide);
+  m_parameters[HEIGHT] = IOParam(HEIGHT, "Height", 240, true, 1, s_maxSide);
+  m_parameters[FORMAT] =
+      IOParam(FORMAT, "Format (0: RGB565, 1: RGB888)", RGB565, true, 0, 1);
+  m_parameters[SCALE] = IOParam(SCALE, "Pixel scale", 1, true, 1, 8);
+
+  m_frameTimer.setSingleShot(true);
+  m_frameTimer.setInterval(s_frameInterval);
+  connect(&m_frameTimer, &QTimer::timeout, this, &IOFramebuffer::flush);
+
+  updateImage();
+}
+
+unsigned IOFramebuffer::bytesPerPixel() const {
+  return m_parameters.at(FORMAT).value.toInt() == RGB888 ? 4 : 2;
+}
+
+bool IOFramebuffer::isAlphaByte(AInt offset) const {
+  return bytesPerPixel() == 4 && offset % 4 == 3;
+}
+
+unsigned IOFramebuffer::rowBytes() const {
+  return m_parameters.at(WIDTH).value.toUInt() * bytesPerPixel();
+}
+
+AInt IOFramebuffer::pixelBytes() const {
+  return rowBytes() * m_parameters.at(HEIGHT).value.toUInt();
+}
+
+unsigned IOFramebuffer::byteSize() const {
+  // The pixel memory is followed by the BLIT register.
+  return ((pixelBytes() + 3) & ~AInt(3)) + 4;
+}
+
+QString IOFramebuffer::description() const {
+  QStringList desc;
+  desc << "The pixel memory holds the rows of pixels from the top of the "
+          "display. In the RGB565 format, each pixel is a halfword with R in "
+          "the 5 most significant bits. In the RGB888 format, each pixel is a "
+          "word storing an RGB color value, with B stored in the least "
+          "significant byte.";
+  desc << "The byte offset of the pixel at coordinates (x, y) is:";
+  desc << "    offset = (x + y*WIDTH) * BYTES_PER_PIXEL";
+  desc << "Writing the address of a frame, laid out as the pixel memory, to "
+          "the BLIT register copies the frame into the pixel memory.";
+
+  return desc.join('\n');
+}
+
+void IOFramebuffer::updateImage() {
+  const unsigned width = m_parameters.at(WIDTH).value.toUInt();
+  const unsigned height = m_parameters.at(HEIGHT).value.toUInt();
+  m_image = QImage(width, height,
+                   bytesPerPixel() == 4 ? QImage::Format_RGB32
+                                        : QImage::Format_RGB16);
+  reset();
+
+  m_extraSymbols.clear();
+  m_extraSymbols.push_back(IOSymbol{"WIDTH", width});
+  m_extraSymbols.push_back(IOSymbol{"HEIGHT", height});
+  m_extraSymbols.push_back(IOSymbol{"BYTES_PER_PIXEL", bytesPerPixel()});
+
+  const AInt blitOffset = byteSize() - 4;
+  m_regDescs.clear();
+  m_regDescs.push_back(
+      RegDesc{"PIXELS", RegDesc::RW::RW, bytesPerPixel() * 8, 0, false});
+  m_regDescs.push_back(RegDesc{"BLIT", RegDesc::RW::W, 32, blitOffset, true});
+
+  emit regMapChanged();
+}
+
+void IOFramebuffer::reset() {
+  // Pixels of the RGB32 format must have an opaque alpha channel.
+  m_image.fill(m_image.format() == QImage::Format_RGB32 ? 0xFF000000 : 0);
+  markDirty(m_image.rect());
+}
+
+uchar *IOFramebuffer::pixelByte(AInt offset) {
+  // Rows of the image may be padded.
+  const unsigned row = rowBytes();
+  return m_image.scanLine(offset / row) + offset % row;
+}
+
+bool IOFramebuffer::saveState(std::vector<uint64_t> &state) const {
+  const unsigned row = rowBytes();
+  const size_t first = state.size();
+  state.resize(first + (pixelBytes() + 7) / 8);
+  for (AInt offset = 0; offset < pixelBytes(); ++offset) {
+    const uchar byte = m_image.constScanLine(offset / row)[offset % row];
+    state[first + offset / 8] |= uint64_t(byte) << (offset % 8 * 8);
+  }
+  return true;
+}
+
+bool IOFramebuffer::restoreState(const std::vector<uint64_t> &state) {
+  if (state.size() != (pixelBytes() + 7) / 8)
+    return false;
+  for (AInt offset = 0; offset < pixelBytes(); ++offset)
+    *pixelByte(offset) = state[offset / 8] >> (offset % 8 * 8);
+  markDirty(m_image.rect());
+  return true;
+}
+
+VInt IOFramebuffer::ioRead(AInt offset, unsigned size) {
+  if (offset + size > pixelBytes())
+    return 0;
+  VInt value = 0;
+  for (unsigned i = 0; i < size; ++i)
+    if (!isAlphaByte(offset + i))
+      value |= VInt(*pixelByte(offset + i)) << (i * 8);
+  return value;
+}
+
+void IOFramebuffer::ioWrite(AInt offset, VInt value, unsigned size) {
+  if (offset == byteSize() - 4) {
+    blit(value);
+    return;
+  }
+  if (offset + size > pixelBytes())
+    return;
+  for (unsigned i = 0; i < size; ++i)
+    *pixelByte(offset + i) = isAlphaByte(offset + i)
+                                 ? 0xFF
+                                 : static_cast<uchar>(value >> (i * 8));
+  markDirty(offset, size);
+}
+
+void IOFramebuffer::blit(AInt address) {
+  if (!memReadBlock)
+    return;
+  const unsigned row = rowBytes();
+  for (int y = 0; y < m_image.height(); ++y) {
+    uchar *line = m_image.scanLine(y);
+    memReadBlock(address + AInt(y) * row, reinterpret_cast<char *>(line), row);
+    if (bytesPerPixel() == 4)
+      for (unsigned x = 3; x < row; x += 4)
+        line[x] = 0xFF;
+  }
+  markDirty(m_image.rect());
+}
+
+void IOFramebuffer::markDirty(AInt offset, unsigned size) {
+  const unsigned bpp = bytesPerPixel();
+  const unsigned width = m_image.width();
+  const AInt first = offset / bpp;
+  const AInt last = (offset + size - 1) / bpp;
+  const int y = first / width;
+  if (last / width == AInt(y))
+    markDirty(QRect(first % width, y, last - first + 1, 1));
+  else
+    markDirty(QRect(0, y, width, last / width - y + 1));
+}
+
+void IOFramebuffer::markDirty(const QRect &rect) {
+  QMutexLocker lock(&m_dirtyMutex);
+  m_dirty |= rect;
+  if (m_flushScheduled)
+    return;
+  // Views are notified of writes once the frame interval has passed, through
+  // the event loop of the GUI thread.
+  m_flushScheduled = true;
+  QMetaObject::invokeMethod(
+      this, [this] { m_frameTimer.start(); }, Qt::QueuedConnection);
+}
+
+void IOFramebuffer::flush() {
+  QRect dirty;
+  {
+    QMutexLocker lock(&m_dirtyMutex);
+    dirty = std::exchange(m_dirty, QRect());
+    m_flushScheduled = false;
+  }
+  emit pixelsChanged(dirty);
+}
+
+IOView *IOFramebuffer::createView(QWidget *parent) {
+  return new IOFramebufferView(this, parent);
+}
+
+/**
+ * IO framebuffer view
+ */
+
+IOFramebufferView::IOFramebufferView(IOFramebuffer *framebuffer,
+                                     QWidget *parent)
+    : IOView(framebuffer, parent), m_framebuffer(framebuffer) {
+  connect(framebuffer, &IOFramebuffer::pixelsChanged, this,
+          [this](const QRect &dirty) {
+            const int scale = m_framebuffer->scale();
+            update(QRect(dirty.topLeft() * scale, dirty.size() * scale));
+          });
+}
+
+QSize IOFramebufferView::minimumSizeHint() const {
+  return m_framebuffer->image().size() * m_framebuffer->scale();
+}
+
+void IOFramebufferView::paintEvent(QPaintEvent *event) {
+  QPainter painter(this);
+  const QImage &image = m_framebuffer->image();
+  const int scale = m_framebuffer->scale();
+  // Only the pixels of the exposed area are drawn.
+  const QRect exposed = event->rect();
+  const QRect source =
+      QRect(QPoint(exposed.left() / scale, exposed.top() / scale),
+            QPoint(exposed.right() / scale, exposed.bottom() / scale)) &
+      image.rect();
+  painter.drawImage(QRect(source.topLeft() * scale, source.size() * scale),
+                    image, source);
+  painter.end();
+}
+
+} // namespace Ripes
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <QImage>
+#include <QMutex>
+#include <QTimer>
+#include <QVariant>
+#include <QWidget>
+
+#include "iobase.h"
+#include "ioview.h"
+
+namespace Ripes {
+
+/**
+ * @brief The IOFramebuffer class
+ * A framebuffer of pixels. The pixel memory of the framebuffer is the buffer of
+ * the displayed image, such that writes to the pixel memory are stored
+ * directly in the image. Whole frames rendered in ordinary memory may instead
+ * be presented through the BLIT register, which copies a frame in bulk rather
+ * than through a peripheral access per pixel.
+ *
+ * Written pixels are accumulated into a dirty rectangle, of which views are
+ * notified at most once per frame.
+ */
+class IOFramebuffer : public IOBase {
+  Q_OBJECT
+
+  enum Parameters { WIDTH, HEIGHT, FORMAT, SCALE };
+  enum Format { RGB565, RGB888 };
+
+public:
+  IOFramebuffer(QObject *parent);
+  ~IOFramebuffer() { unregister(); };
+
+  virtual unsigned byteSize() const override;
+  virtual QString description() const override;
+  virtual QString baseName() const override { return "Framebuffer"; }
+
+  virtual const std::vector<RegDesc> &registers() const override {
+    return m_regDescs;
+  };
+  virtual const std::vector<IOSymbol> *extraSymbols() const override {
+    return &m_extraSymbols;
+  }
+
+  /**
+   * Hardware read/write functions
+   */
+  virtual VInt ioRead(AInt offset, unsigned size) override;
+  virtual void ioWrite(AInt offset, VInt value, unsigned size) override;
+
+  virtual void reset() override;
+
+  /// The pixel memory is saved as 8 bytes per state word.
+  bool saveState(std::vector<uint64_t> &state) const override;
+  bool restoreState(const std::vector<uint64_t> &state) override;
+
+  virtual IOView *createView(QWidget *parent) override;
+
+  /// The displayed image, which is the pixel memory of the framebuffer.
+  const QImage &image() const { return m_image; }
+  int scale() const { return m_parameters.at(SCALE).value.toInt(); }
+
+signals:
+  /// Emitted at most once per frame, with the area of the pixels written.
+  void pixelsChanged(const QRect &dirty);
+
+protected:
+  virtual void parameterChanged(unsigned) override { updateImage(); };
+
+private:
+  void updateImage();
+
+  /// Copies a frame from memory at @p address into the image.
+  void blit(AInt address);
+
+  /// Returns the byte of the image at @p offset into the pixel memory.
+  uchar *pixelByte(AInt offset);
+
+  /// Adds the pixels of @p size bytes at @p offset to the dirty rectangle.
+  void markDirty(AInt offset, unsigned size);
+  void markDirty(const QRect &rect);
+  /// Notifies views of the dirty rectangle.
+  void flush();
+
+  /// Returns true if the byte at @p offset into the pixel memory is the unused
+  /// alpha byte of an RGB888 pixel, which must be opaque in the image.
+  bool isAlphaByte(AInt offset) const;
+
+  unsigned bytesPerPixel() const;
+  unsigned rowBytes() const;
+  AInt pixelBytes() const;
+
+  static constexpr unsigned s_maxSide = 1024;
+  static constexpr int s_frameInterval = 16; // ms
+
+  QImage m_image;
+  std::vector<RegDesc> m_regDescs;
+  std::vector<IOSymbol> m_extraSymbols;
+
+  // Pixels written since the last repaint. Guarded by m_dirtyMutex, given that
+  // pixels are written from the simulator thread.
+  QMutex m_dirtyMutex;
+  QRect m_dirty;
+  bool m_flushScheduled = false;
+  QTimer m_frameTimer{this};
+};
+
+/**
+ * @brief The IOFramebufferView class
+ * Paints the image of a framebuffer, scaled by its pixel scale.
+ */
+class IOFramebufferView : public IOView {
+  Q_OBJECT
+
+public:
+  IOFramebufferView(IOFramebuffer *framebuffer, QWidget *parent);
+
+protected:
+  void paintEvent(QPaintEvent *event) override;
+  QSize minimumSizeHint() const override;
+
+private:
+  IOFramebuffer *m_framebuffer;
+};
+} // namespace Ripes
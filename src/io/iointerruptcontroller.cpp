@@ -0,0 +1,228 @@
+#include "iointerruptcontroller.h"
+
+#include <QPainter>
+
+#include "ioregistry.h"
+#include "processorhandler.h"
+
+namespace Ripes {
+
+namespace {
+enum Register {
+  PENDING = 0x00,
+  ENABLE = 0x04,
+  CLAIM = 0x08,
+  VECTOR = 0x0C,
+  EPC = 0x10,
+  STATUS = 0x14,
+  MRET = 0x18,
+  WFI = 0x1C
+};
+} // namespace
+
+IOInterruptController::IOInterruptController(QObject *parent)
+    : IOBase(IOType::INTERRUPT_CONTROLLER, parent) {
+  m_regDescs.push_back(RegDesc{"PENDING", RegDesc::RW::R, 32, PENDING, true});
+  m_regDescs.push_back(RegDesc{"ENABLE", RegDesc::RW::RW, 32, ENABLE, true});
+  m_regDescs.push_back(RegDesc{"CLAIM", RegDesc::RW::R, 32, CLAIM, true});
+  m_regDescs.push_back(RegDesc{"VECTOR", RegDesc::RW::RW, 32, VECTOR, true});
+  m_regDescs.push_back(RegDesc{"EPC", RegDesc::RW::R, 32, EPC, true});
+  m_regDescs.push_back(RegDesc{"STATUS", RegDesc::RW::RW, 32, STATUS, true});
+  m_regDescs.push_back(RegDesc{"MRET", RegDesc::RW::W, 32, MRET, true});
+  m_regDescs.push_back(RegDesc{"WFI", RegDesc::RW::W, 32, WFI, true});
+
+  connect(ProcessorHandler::get(), &ProcessorHandler::processorChanged, this,
+          &IOInterruptController::reset);
+}
+
+IOInterruptController::~IOInterruptController() {
+  if (auto *processor = ProcessorHandler::getProcessorNonConst()) {
+    processor->events().cancel(this);
+    processor->events().cancel(&m_epc);
+  }
+  unregister();
+}
+
+QString IOInterruptController::description() const {
+  QStringList desc;
+  desc << "Bit n of PENDING is set once interrupt source n is raised, and "
+          "stays set until the interrupt is claimed.";
+  desc << "Reading CLAIM returns the lowest pending interrupt source which is "
+          "enabled in ENABLE, and clears it from PENDING. 0 is returned if no "
+          "interrupt is pending.";
+  desc << "Bit 0 of STATUS enables interrupts. An interrupt is delivered by "
+          "saving the address of the interrupted instruction to EPC, "
+          "clearing bit 0 of STATUS and jumping to VECTOR.";
+  desc << "Writing MRET returns from the interrupt handler to EPC and enables "
+          "interrupts, as the instruction after the write.";
+  desc << "Writing WFI idles the processor until the next interrupt.";
+  desc << "Interrupts are only delivered by processors which support them "
+          "(the single-cycle ISS).";
+  return desc.join('\n');
+}
+
+VInt IOInterruptController::ioRead(AInt offset, unsigned) {
+  switch (offset) {
+  case PENDING:
+    return m_pending;
+  case ENABLE:
+    return m_enable;
+  case CLAIM: {
+    const uint32_t claimable = m_pending & m_enable;
+    if (claimable == 0)
+      return 0;
+    unsigned source = 1;
+    while (!(claimable & (1u << source)))
+      ++source;
+    // A level-triggered source which is still raised becomes pending again.
+    m_pending &= ~(1u << source) | m_lines;
+    emit scheduleUpdate();
+    return source;
+  }
+  case VECTOR:
+    return m_vector;
+  case EPC:
+    return m_epc;
+  case STATUS:
+    return m_ie ? 1 : 0;
+  default:
+    return 0;
+  }
+}
+
+void IOInterruptController::ioWrite(AInt offset, VInt value, unsigned) {
+  auto *processor = ProcessorHandler::getProcessorNonConst();
+  switch (offset) {
+  case ENABLE:
+    // Source 0 is never enabled.
+    m_enable = value & ~uint32_t(1);
+    update();
+    break;
+  case VECTOR:
+    m_vector = value;
+    break;
+  case STATUS:
+    m_ie = value & 1;
+    update();
+    break;
+  case MRET:
+    if (!(processor->features() & RipesProcessor::hasInterrupts))
+      break;
+    // The write is performed within the cycle of the instruction; the return
+    // is performed once the cycle has completed.
+    processor->events().schedule(&m_epc, processor->getCycleCount() + 1,
+                                 [this, processor] {
+                                   processor->setProgramCounter(m_epc);
+                                   m_ie = true;
+                                   update();
+                                   emit scheduleUpdate();
+                                 });
+    break;
+  case WFI: {
+    const long long next = processor->events().nextCycle();
+    if (!(m_pending & m_enable) && next != LLONG_MAX)
+      processor->idleUntil(next);
+    break;
+  }
+  default:
+    break;
+  }
+  emit scheduleUpdate();
+}
+
+void IOInterruptController::reset() {
+  m_lines = 0;
+  m_pending = 0;
+  m_enable = 0;
+  m_vector = 0;
+  m_epc = 0;
+  m_ie = false;
+  if (auto *processor = ProcessorHandler::getProcessorNonConst()) {
+    processor->events().cancel(this);
+    processor->events().cancel(&m_epc);
+  }
+  emit scheduleUpdate();
+}
+
+bool IOInterruptController::saveState(std::vector<uint64_t> &state) const {
+  const auto *processor = ProcessorHandler::getProcessor();
+  if (processor && processor->events().scheduled(&m_epc))
+    return false;
+  state.insert(state.end(),
+               {m_lines, m_pending, m_enable, m_vector, m_epc, m_ie});
+  return true;
+}
+
+bool IOInterruptController::restoreState(const std::vector<uint64_t> &state) {
+  if (state.size() != 6)
+    return false;
+  m_lines = state[0];
+  m_pending = state[1];
+  m_enable = state[2];
+  m_vector = state[3];
+  m_epc = state[4];
+  m_ie = state[5];
+  update();
+  emit scheduleUpdate();
+  return true;
+}
+
+void IOInterruptController::setLine(unsigned source, bool level) {
+  if (source == 0 || source >= s_interruptSources)
+    return;
+  const uint32_t mask = 1u << source;
+  if (level) {
+    m_lines |= mask;
+    m_pending |= mask;
+  } else {
+    m_lines &= ~mask;
+  }
+  update();
+  emit scheduleUpdate();
+}
+
+void IOInterruptController::update() {
+  auto *processor = ProcessorHandler::getProcessorNonConst();
+  if (!processor || !deliverable())
+    return;
+  // Interrupts are taken between cycles. If an interrupt becomes deliverable
+  // by an instruction, it is taken after the instruction.
+  processor->events().schedule(this, processor->getCycleCount(),
+                               [this] { deliver(); });
+}
+
+void IOInterruptController::deliver() {
+  auto *processor = ProcessorHandler::getProcessorNonConst();
+  if (!deliverable() ||
+      !(processor->features() & RipesProcessor::hasInterrupts))
+    return;
+  m_epc = processor->nextFetchedAddress();
+  m_ie = false;
+  processor->setProgramCounter(m_vector);
+  emit scheduleUpdate();
+}
+
+IOView *IOInterruptController::createView(QWidget *parent) {
+  return new IOInterruptControllerView(this, parent);
+}
+
+QSize IOInterruptControllerView::minimumSizeHint() const {
+  return QSize(fontMetrics().horizontalAdvance("PENDING: 0x00000000"),
+               fontMetrics().height() * 3);
+}
+
+void IOInterruptControllerView::paintEvent(QPaintEvent *) {
+  QPainter painter(this);
+  const auto hex = [](uint32_t value) {
+    return "0x" + QString::number(value, 16).rightJustified(8, '0');
+  };
+  painter.drawText(rect(), Qt::AlignLeft | Qt::AlignTop,
+                   "PENDING: " + hex(m_controller->pending()) +
+                       "\nENABLE: " + hex(m_controller->enabled()) +
+                       "\nInterrupts: " +
+                       (m_controller->interruptsEnabled() ? "enabled"
+                                                          : "disabled"));
+  painter.end();
+}
+
+} // namespace Ripes
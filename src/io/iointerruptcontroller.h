@@ -0,0 +1,97 @@
+#pragma once
+
+#include <QVariant>
+#include <QWidget>
+
+#include "iobase.h"
+#include "ioview.h"
+
+namespace Ripes {
+
+/**
+ * @brief The IOInterruptController class
+ * An interrupt controller, in the style of the RISC-V PLIC, which also holds
+ * the trap state of the processor. The RISC-V models do not implement the
+ * machine-mode CSRs, so the trap vector, the exception program counter and
+ * the return from a trap are accessed as registers of the controller.
+ *
+ * An interrupt is delivered between cycles, as an event of the processor (see
+ * RipesProcessor::events), to processors with interrupts. Delivering an
+ * interrupt saves the next fetched address to EPC, disables interrupts and
+ * redirects execution to VECTOR.
+ */
+class IOInterruptController : public IOBase {
+  Q_OBJECT
+
+public:
+  IOInterruptController(QObject *parent);
+  ~IOInterruptController();
+
+  virtual unsigned byteSize() const override { return 8 * 4; }
+  virtual QString description() const override;
+  virtual QString baseName() const override { return "Interrupt controller"; }
+
+  virtual const std::vector<RegDesc> &registers() const override {
+    return m_regDescs;
+  };
+  virtual const std::vector<IOSymbol> *extraSymbols() const override {
+    return nullptr;
+  }
+
+  /**
+   * Hardware read/write functions
+   */
+  virtual VInt ioRead(AInt offset, unsigned size) override;
+  virtual void ioWrite(AInt offset, VInt value, unsigned size) override;
+
+  virtual void reset() override;
+
+  /// A return from an interrupt in progress, which is scheduled with the
+  /// processor, cannot be saved.
+  bool saveState(std::vector<uint64_t> &state) const override;
+  bool restoreState(const std::vector<uint64_t> &state) override;
+
+  virtual IOView *createView(QWidget *parent) override;
+
+  uint32_t pending() const { return m_pending; }
+  uint32_t enabled() const { return m_enable; }
+  bool interruptsEnabled() const { return m_ie; }
+
+  /// Raises or lowers the line of interrupt source @p source. An interrupt
+  /// stays pending once raised, until claimed.
+  void setLine(unsigned source, bool level);
+
+protected:
+  virtual void parameterChanged(unsigned) override{};
+
+private:
+  /// Schedules the delivery of an interrupt, if any is deliverable.
+  void update();
+  void deliver();
+  bool deliverable() const { return m_ie && (m_pending & m_enable); }
+
+  uint32_t m_lines = 0;
+  uint32_t m_pending = 0;
+  uint32_t m_enable = 0;
+  AInt m_vector = 0;
+  AInt m_epc = 0;
+  bool m_ie = false;
+  std::vector<RegDesc> m_regDescs;
+};
+
+class IOInterruptControllerView : public IOView {
+  Q_OBJECT
+
+public:
+  IOInterruptControllerView(IOInterruptController *controller,
+                            QWidget *parent)
+      : IOView(controller, parent), m_controller(controller) {}
+
+protected:
+  void paintEvent(QPaintEvent *event) override;
+  QSize minimumSizeHint() const override;
+
+private:
+  IOInterruptController *m_controller;
+};
+} // namespace Ripes
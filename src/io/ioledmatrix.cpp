@@ -1,14 +1,18 @@
 #include "ioledmatrix.h"
 
+#include <QPaintEvent>
 #include <QPainter>
 #include <QPen>
 
+#include <algorithm>
+#include <numeric>
+
 #include "STLExtras.h"
 #include "ioregistry.h"
 
 namespace Ripes {
 
-IOLedMatrix::IOLedMatrix(QWidget *parent) : IOBase(IOType::LED_MATRIX, parent) {
+IOLedMatrix::IOLedMatrix(QObject *parent) : IOBase(IOType::LED_MATRIX, parent) {
   constexpr unsigned defaultWidth = 25;
 
   // Parameters
@@ -18,8 +22,9 @@ IOLedMatrix::IOLedMatrix(QWidget *parent) : IOBase(IOType::LED_MATRIX, parent) {
       IOParam(WIDTH, "Width", defaultWidth + 10, true, 1, m_maxSideWidth);
   m_parameters[SIZE] = IOParam(SIZE, "LED size", 8, true, 1, 100);
 
-  m_pen.setWidth(1);
-  m_pen.setColor(Qt::black);
+  m_frameTimer.setSingleShot(true);
+  m_frameTimer.setInterval(s_frameInterval);
+  connect(&m_frameTimer, &QTimer::timeout, this, &IOLedMatrix::flush);
 
   updateLEDRegs();
 }
@@ -53,8 +58,43 @@ void IOLedMatrix::ioWrite(AInt offset, VInt value, unsigned) {
   if (offset >= m_ledRegs.size()) {
     Q_ASSERT(false);
   }
+  if (m_ledRegs.at(offset) == value)
+    return;
   m_ledRegs.at(offset) = value;
-  emit scheduleUpdate();
+  markDirty(offset);
+}
+
+void IOLedMatrix::markDirty(unsigned index) {
+  QMutexLocker lock(&m_dirtyMutex);
+  if (index >= m_dirty.size() || m_dirty[index])
+    return;
+  m_dirty[index] = true;
+  m_dirtyLEDs.push_back(index);
+  if (m_flushScheduled)
+    return;
+  // Changed LEDs are rendered once the frame interval has passed, through the
+  // event loop of the GUI thread.
+  m_flushScheduled = true;
+  QMetaObject::invokeMethod(
+      this, [this] { m_frameTimer.start(); }, Qt::QueuedConnection);
+}
+
+bool IOLedMatrix::saveState(std::vector<uint64_t> &state) const {
+  state.insert(state.end(), m_ledRegs.begin(), m_ledRegs.end());
+  return true;
+}
+
+bool IOLedMatrix::restoreState(const std::vector<uint64_t> &state) {
+  if (state.size() != m_ledRegs.size())
+    return false;
+  std::copy(state.begin(), state.end(), m_ledRegs.begin());
+  markAllDirty();
+  return true;
+}
+
+void IOLedMatrix::markAllDirty() {
+  for (unsigned i = 0; i < m_ledRegs.size(); ++i)
+    markDirty(i);
 }
 
 static QColor regToColor(uint32_t regVal) {
@@ -66,6 +106,12 @@ void IOLedMatrix::updateLEDRegs() {
   const unsigned height = m_parameters[HEIGHT].value.toInt();
   const int nLEDs = width * height;
   m_ledRegs.resize(nLEDs);
+  {
+    QMutexLocker lock(&m_dirtyMutex);
+    m_dirty.assign(nLEDs, false);
+    m_dirtyLEDs.clear();
+  }
+  markAllDirty();
 
   m_extraSymbols.clear();
   m_extraSymbols.push_back(IOSymbol{"WIDTH", width});
@@ -83,40 +129,114 @@ void IOLedMatrix::updateLEDRegs() {
     mRegDesc.value() = regdesc;
   }
 
-  updateGeometry();
   emit regMapChanged();
 }
 
-QSize IOLedMatrix::minimumSizeHint() const {
-  const int width = m_parameters.at(WIDTH).value.toInt();
-  const int height = m_parameters.at(HEIGHT).value.toInt();
-  const int size = m_parameters.at(SIZE).value.toInt();
-  const int pixelWidth = width * (size + m_pen.width());
-  const int pixelHeight = height * (size + m_pen.width());
-  return QSize(pixelWidth, pixelHeight);
+std::vector<unsigned> IOLedMatrix::takeDirty() {
+  std::vector<unsigned> dirty;
+  QMutexLocker lock(&m_dirtyMutex);
+  dirty.swap(m_dirtyLEDs);
+  for (unsigned index : dirty)
+    m_dirty[index] = false;
+  return dirty;
 }
 
-void IOLedMatrix::paintEvent(QPaintEvent *) {
-  QPainter painter(this);
-  painter.setRenderHint(QPainter::Antialiasing);
+void IOLedMatrix::flush() {
+  {
+    QMutexLocker lock(&m_dirtyMutex);
+    m_flushScheduled = false;
+  }
+  emit ledsChanged();
+}
 
-  painter.setPen(m_pen);
+IOView *IOLedMatrix::createView(QWidget *parent) {
+  return new IOLedMatrixView(this, parent);
+}
+
+/**
+ * IO LED matrix view
+ */
+
+IOLedMatrixView::IOLedMatrixView(IOLedMatrix *matrix, QWidget *parent)
+    : IOView(matrix, parent), m_matrix(matrix) {
+  m_pen.setWidth(1);
+  m_pen.setColor(Qt::black);
+  connect(matrix, &IOLedMatrix::ledsChanged, this,
+          [this] { update(render()); });
+}
+
+QSize IOLedMatrixView::minimumSizeHint() const {
+  const int pitch = m_matrix->ledSize() + m_pen.width();
+  return QSize(m_matrix->columns() * pitch, m_matrix->rows() * pitch);
+}
+
+QRect IOLedMatrixView::ledRect(unsigned index) const {
+  const int width = m_matrix->columns();
+  const int pitch = m_matrix->ledSize() + m_pen.width();
+  return QRect((index % width) * pitch, (index / width) * pitch, pitch, pitch);
+}
 
-  const int width = m_parameters[WIDTH].value.toInt();
-  const int height = m_parameters[HEIGHT].value.toInt();
-  const int size = m_parameters[SIZE].value.toInt();
-  for (int y = 0; y < height; y++) {
-    for (int x = 0; x < width; x++) {
-      QBrush brush(regToColor(m_ledRegs.at(y * width + x)));
-      painter.setBrush(brush);
+const QPixmap &IOLedMatrixView::sprite(uint32_t color) {
+  // Pixels of the LEDs are the same as of the colour, regardless of the bits
+  // beyond the 24-bit colour.
+  color &= 0xFFFFFF;
+  auto it = m_sprites.find(color);
+  if (it != m_sprites.end())
+    return it->second;
+  if (m_sprites.size() >= s_maxSprites)
+    m_sprites.clear();
+
+  const int size = m_matrix->ledSize();
+  const int pitch = size + m_pen.width();
+  const qreal dpr = devicePixelRatioF();
+  QPixmap pixmap(QSize(pitch, pitch) * dpr);
+  pixmap.setDevicePixelRatio(dpr);
+  pixmap.fill(Qt::transparent);
+  QPainter painter(&pixmap);
+  painter.setRenderHint(QPainter::Antialiasing);
+  painter.setPen(m_pen);
+  painter.setBrush(regToColor(color));
+  const qreal inset = m_pen.widthF() / 2;
+  painter.drawEllipse(QRectF(inset, inset, size, size));
+  painter.end();
+  return m_sprites.emplace(color, std::move(pixmap)).first->second;
+}
 
-      const unsigned xpos = x * (size + m_pen.width());
-      const unsigned ypos = y * (size + m_pen.width());
+QRect IOLedMatrixView::render() {
+  std::vector<unsigned> dirty = m_matrix->takeDirty();
+
+  const qreal dpr = devicePixelRatioF();
+  const QSize canvasSize = minimumSizeHint() * dpr;
+  if (m_canvas.size() != canvasSize || m_canvas.devicePixelRatio() != dpr) {
+    m_canvas = QPixmap(canvasSize);
+    m_canvas.setDevicePixelRatio(dpr);
+    m_canvas.fill(Qt::transparent);
+    m_sprites.clear();
+    dirty.resize(m_matrix->numLEDs());
+    std::iota(dirty.begin(), dirty.end(), 0);
+  }
 
-      painter.drawEllipse(xpos, ypos, size, size);
-    }
+  QPainter painter(&m_canvas);
+  painter.setCompositionMode(QPainter::CompositionMode_Source);
+  QRect rendered;
+  for (unsigned index : dirty) {
+    if (index >= m_matrix->numLEDs())
+      continue;
+    const QRect rect = ledRect(index);
+    painter.drawPixmap(rect.topLeft(), sprite(m_matrix->led(index)));
+    rendered |= rect;
   }
+  painter.end();
+  return rendered;
+}
 
+void IOLedMatrixView::paintEvent(QPaintEvent *event) {
+  // The canvas is rendered up front if the dimensions of the matrix changed.
+  if (m_canvas.size() != minimumSizeHint() * devicePixelRatioF())
+    render();
+  QPainter painter(this);
+  painter.setClipRect(event->rect());
+  painter.drawPixmap(0, 0, m_canvas);
   painter.end();
 }
 
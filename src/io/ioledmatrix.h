@@ -1,20 +1,32 @@
 #pragma once
 
+#include <QMutex>
 #include <QPen>
+#include <QPixmap>
+#include <QTimer>
 #include <QVariant>
 #include <QWidget>
 
+#include <unordered_map>
+
 #include "iobase.h"
+#include "ioview.h"
 
 namespace Ripes {
 
+/**
+ * @brief The IOLedMatrix class
+ * A matrix of LEDs. Writes which change an LED mark it in a dirty bitmap, and
+ * views are notified of the marked LEDs at most once per frame (see
+ * IOLedMatrixView).
+ */
 class IOLedMatrix : public IOBase {
   Q_OBJECT
 
   enum Parameters { HEIGHT, WIDTH, SIZE };
 
 public:
-  IOLedMatrix(QWidget *parent);
+  IOLedMatrix(QObject *parent);
   ~IOLedMatrix() { unregister(); };
 
   virtual unsigned byteSize() const override;
@@ -36,26 +48,85 @@ public:
 
   virtual void reset() override {
     std::fill(m_ledRegs.begin(), m_ledRegs.end(), 0);
+    markAllDirty();
   }
 
+  bool saveState(std::vector<uint64_t> &state) const override;
+  bool restoreState(const std::vector<uint64_t> &state) override;
+
+  virtual IOView *createView(QWidget *parent) override;
+
+  unsigned columns() const { return m_parameters.at(WIDTH).value.toUInt(); }
+  unsigned rows() const { return m_parameters.at(HEIGHT).value.toUInt(); }
+  int ledSize() const { return m_parameters.at(SIZE).value.toInt(); }
+  uint32_t led(unsigned index) const { return m_ledRegs.at(index); }
+  unsigned numLEDs() const { return m_ledRegs.size(); }
+
+  /// Returns the LEDs changed since this was last called, and unmarks them.
+  std::vector<unsigned> takeDirty();
+
+signals:
+  /// Emitted at most once per frame, when LEDs have changed.
+  void ledsChanged();
+
 protected:
   virtual void parameterChanged(unsigned) override { updateLEDRegs(); };
 
-  /**
-   * QWidget drawing
-   */
-  void paintEvent(QPaintEvent *event) override;
-  QSize minimumSizeHint() const override;
-
 private:
   VInt regRead(AInt offset) const;
   void updateLEDRegs();
 
+  /// Marks the LED at @p index to be rendered with the next frame.
+  void markDirty(unsigned index);
+  void markAllDirty();
+  /// Notifies views of the marked LEDs.
+  void flush();
+
+  static constexpr int s_frameInterval = 16; // ms
+
   unsigned m_maxSideWidth = 256;
   std::vector<uint32_t> m_ledRegs;
   std::vector<RegDesc> m_regDescs;
   std::vector<IOSymbol> m_extraSymbols;
 
+  // LEDs changed since they were last rendered. Guarded by m_dirtyMutex, given
+  // that LEDs are written from the simulator thread.
+  QMutex m_dirtyMutex;
+  std::vector<bool> m_dirty;
+  std::vector<unsigned> m_dirtyLEDs;
+  bool m_flushScheduled = false;
+  QTimer m_frameTimer{this};
+};
+
+/**
+ * @brief The IOLedMatrixView class
+ * The LEDs of a matrix are rendered into a canvas, from which the view is
+ * painted. The changed LEDs are rendered into the canvas once per frame, from
+ * pre-rendered sprites of each colour.
+ */
+class IOLedMatrixView : public IOView {
+  Q_OBJECT
+
+public:
+  IOLedMatrixView(IOLedMatrix *matrix, QWidget *parent);
+
+protected:
+  void paintEvent(QPaintEvent *event) override;
+  QSize minimumSizeHint() const override;
+
+private:
+  /// Renders the changed LEDs into the canvas (recreating the canvas if the
+  /// dimensions of the matrix changed), and returns the area rendered.
+  QRect render();
+
+  QRect ledRect(unsigned index) const;
+  const QPixmap &sprite(uint32_t color);
+
+  IOLedMatrix *m_matrix;
   QPen m_pen;
+  QPixmap m_canvas;
+  // Rendered LEDs, by colour.
+  std::unordered_map<uint32_t, QPixmap> m_sprites;
+  static constexpr size_t s_maxSprites = 4096;
 };
 } // namespace Ripes
@@ -1,5 +1,7 @@
 #include "iomanager.h"
+#include "iointerruptcontroller.h"
 
+#include "inputlog.h"
 #include "processorhandler.h"
 #include "ripessettings.h"
 
@@ -15,6 +17,15 @@ IOManager::IOManager() : QObject(nullptr) {
   // changes
   connect(ProcessorHandler::get(), &ProcessorHandler::processorChanged, this,
           &IOManager::refreshAllPeriphsToProcessor);
+  // Deselected processors may be cached and selected again, and so must not
+  // retain the regions of peripherals.
+  connect(ProcessorHandler::get(), &ProcessorHandler::processorAboutToChange,
+          this, [this] {
+            auto &memory = ProcessorHandler::getMemory();
+            for (const auto &[start, size] : m_ioRegions)
+              memory.removeIORegion(start, size);
+            m_ioRegions.clear();
+          });
   connect(ProcessorHandler::get(), &ProcessorHandler::processorReset, this,
           &IOManager::refreshMemoryMap);
 
@@ -32,8 +43,9 @@ QString IOManager::cSymbolsHeaderpath() const {
 void IOManager::reset() {
   for (auto &device : m_peripherals) {
     device->reset();
-    device->update();
+    emit device->scheduleUpdate();
   }
+  emit peripheralsReset();
 }
 
 AInt IOManager::nextPeripheralAddress() const {
@@ -52,7 +64,7 @@ AInt IOManager::nextPeripheralAddress() const {
 }
 
 AInt IOManager::assignBaseAddress(IOBase *peripheral) {
-  unregisterPeripheralWithProcessor(peripheral);
+  m_periphMMappings.erase(peripheral);
   const AInt base = nextPeripheralAddress();
   m_periphMMappings[peripheral] = {base, peripheral->byteSize(),
                                    peripheral->name()};
@@ -62,12 +74,11 @@ AInt IOManager::assignBaseAddress(IOBase *peripheral) {
 
 void IOManager::assignBaseAddresses() {
   // First unassign all base addresses to start with a clean address map
-  for (const auto &periph : m_peripherals) {
-    unregisterPeripheralWithProcessor(periph);
-  }
+  m_periphMMappings.clear();
   for (const auto &periph : m_peripherals) {
     assignBaseAddress(periph);
   }
+  updateIORegions();
   refreshMemoryMap();
 }
 
@@ -77,30 +88,53 @@ void IOManager::peripheralSizeChanged(IOBase *) {
 }
 
 void IOManager::registerPeripheralWithProcessor(IOBase *peripheral) {
-  ProcessorHandler::getMemory().addIORegion(
-      m_periphMMappings.at(peripheral).startAddr, peripheral->byteSize(),
-      vsrtl::core::IOFunctors{
-          [peripheral](AInt offset, VInt value, unsigned size) {
-            peripheral->ioWrite(offset, value, size);
-          },
-          [peripheral](AInt offset, unsigned size) {
-            return peripheral->ioRead(offset, size);
-          }});
-
   peripheral->memWrite = [](AInt address, VInt value, unsigned size) {
     ProcessorHandler::getMemory().writeMem(address, value, size);
   };
   peripheral->memRead = [](AInt address, unsigned size) {
     return ProcessorHandler::getMemory().readMem(address, size);
   };
+  peripheral->memReadBlock = [](AInt address, char *data, size_t size) {
+    ProcessorHandler::readMemBlock(address, data, size);
+  };
+  peripheral->setInterruptLine = [this](unsigned source, bool level) {
+    for (auto *periph : m_peripherals)
+      if (auto *controller = dynamic_cast<IOInterruptController *>(periph))
+        controller->setLine(source, level);
+  };
 }
 
-void IOManager::unregisterPeripheralWithProcessor(IOBase *peripheral) {
-  const auto &mmEntry = m_periphMMappings.find(peripheral);
-  if (mmEntry != m_periphMMappings.end()) {
-    ProcessorHandler::getMemory().removeIORegion(mmEntry->second.startAddr,
-                                                 mmEntry->second.size);
-    m_periphMMappings.erase(mmEntry);
+void IOManager::updateIORegions() {
+  auto &memory = ProcessorHandler::getMemory();
+  for (const auto &[start, size] : m_ioRegions)
+    memory.removeIORegion(start, size);
+  m_ioRegions.clear();
+
+  std::vector<MMIODecoder::Region> regions;
+  for (const auto &[peripheral, entry] : m_periphMMappings)
+    regions.push_back({entry.startAddr, entry.end(), peripheral});
+  m_decoder.assign(std::move(regions));
+
+  for (const auto &run : m_decoder.runs()) {
+    memory.addIORegion(
+        run.first, run.second,
+        vsrtl::core::IOFunctors{
+            [this, start = run.first](AInt offset, VInt value, unsigned size) {
+              const AInt address = start + offset;
+              if (const auto *region = m_decoder.decode(address))
+                region->peripheral->ioWrite(address - region->start, value,
+                                            size);
+            },
+            [this, start = run.first](AInt offset, unsigned size) -> VInt {
+              const AInt address = start + offset;
+              const auto *region = m_decoder.decode(address);
+              if (region && InputLog::mode() != InputLog::Mode::Off)
+                InputLog::peripheralRead(region->peripheral);
+              return region ? region->peripheral->ioRead(
+                                  address - region->start, size)
+                            : 0;
+            }});
+    m_ioRegions.push_back(run);
   }
 }
 
@@ -118,6 +152,7 @@ IOBase *IOManager::createPeripheral(IOType type, unsigned forcedId) {
   }
   m_peripherals.insert(peripheral);
   assignBaseAddress(peripheral);
+  updateIORegions();
   refreshMemoryMap();
 
   return peripheral;
@@ -126,8 +161,9 @@ IOBase *IOManager::createPeripheral(IOType type, unsigned forcedId) {
 void IOManager::removePeripheral(IOBase *peripheral, std::atomic<bool> &ok) {
   auto periphit = m_peripherals.find(peripheral);
   Q_ASSERT(periphit != m_peripherals.end());
-  unregisterPeripheralWithProcessor(peripheral);
+  m_periphMMappings.erase(peripheral);
   m_peripherals.erase(periphit);
+  updateIORegions();
 
   emit peripheralRemoved(peripheral);
   refreshMemoryMap();
@@ -136,9 +172,12 @@ void IOManager::removePeripheral(IOBase *peripheral, std::atomic<bool> &ok) {
 }
 
 void IOManager::refreshAllPeriphsToProcessor() {
+  // The regions were registered with the memory of the previous processor.
+  m_ioRegions.clear();
   for (const auto &periph : m_periphMMappings) {
     registerPeripheralWithProcessor(periph.first);
   }
+  updateIORegions();
 }
 
 void IOManager::refreshMemoryMap() {
@@ -153,7 +192,7 @@ void IOManager::refreshMemoryMap() {
     for (const auto &section : program.get()->sections) {
       m_memoryMap[section.second.address] =
           MemoryMapEntry{section.second.address,
-                         static_cast<unsigned>(section.second.data.size()),
+                         static_cast<unsigned>(section.second.size()),
                          section.second.name};
     }
   }
@@ -208,7 +247,8 @@ void IOManager::updateSymbols() {
                   "*****************";
 
     auto symbols = assemblerSymbolsForPeriph(p.first);
-    m_assemblerSymbols.abs.insert(symbols.begin(), symbols.end());
+    for (const auto &symbol : symbols)
+      m_assemblerSymbols.setAbsSymbol(symbol.first, symbol.second);
 
     for (const auto &symbol : assemblerSymbolsForPeriph(p.first)) {
       headerfile << "#define " + symbol.first.v + "\t" + "(0x" +
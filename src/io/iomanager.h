@@ -4,6 +4,7 @@
 #include "iobase.h"
 #include "ioregistry.h"
 #include "isa/symbolmap.h"
+#include "mmiodecoder.h"
 
 #include <QFile>
 
@@ -41,6 +42,9 @@ public:
   IOBase *createPeripheral(IOType type, unsigned forcedId = UINT_MAX);
   void removePeripheral(IOBase *peripheral, std::atomic<bool> &ok);
   const MemoryMap &memoryMap() const { return m_memoryMap; }
+  const std::set<IOBase *> &peripherals() const { return m_peripherals; }
+  /// Decoder of the addresses of the peripherals.
+  const MMIODecoder &decoder() const { return m_decoder; }
 
   /**
    * @brief cSymbolsHeaderpath
@@ -67,6 +71,9 @@ public:
 signals:
   void memoryMapChanged();
   void peripheralRemoved(QObject *peripheral);
+  /// Emitted once all IO devices have been reset, after the events of the
+  /// processor were cleared by the reset (see RipesProcessor::events).
+  void peripheralsReset();
 
 private:
   IOManager();
@@ -83,13 +90,20 @@ private:
 
   /**
    * @brief registerPeripheralWithProcessor
-   * Registers @param peripheral with the processor. Specifically, the
-   * peripheral hooks into the memory of the processor, and creates the link
-   * between the peripheral memory read/write functionality, and the processor
-   * memory.
+   * Creates the link between the peripheral memory read/write functionality of
+   * @param peripheral, and the processor memory.
    */
   void registerPeripheralWithProcessor(IOBase *peripheral);
-  void unregisterPeripheralWithProcessor(IOBase *peripheral);
+
+  /**
+   * @brief updateIORegions
+   * Rebuilds the decoder from the current peripheral mappings, and hooks the
+   * peripherals into the memory of the processor. Contiguous peripherals are
+   * registered as a single IO region of the memory, whose accesses are
+   * dispatched to the peripherals through the decoder, such that the memory
+   * searches a single region for the peripherals of the window.
+   */
+  void updateIORegions();
 
   /**
    * @brief refreshAllPeriphsToProcessor
@@ -109,6 +123,10 @@ private:
 
   MemoryMap m_memoryMap;
   std::map<IOBase *, MemoryMapEntry> m_periphMMappings;
+  MMIODecoder m_decoder;
+  // IO regions registered with the memory of the processor, as pairs of start
+  // address and size.
+  std::vector<std::pair<AInt, AInt>> m_ioRegions;
   std::set<IOBase *> m_peripherals;
   SymbolMap m_assemblerSymbols;
   std::unique_ptr<QFile> m_symbolsHeaderFile;
@@ -1,11 +1,14 @@
 #pragma once
 
 #include "iobase.h"
-#include <QWidget>
 
+#include "iodma.h"
 #include "iodpad.h"
+#include "ioframebuffer.h"
+#include "iointerruptcontroller.h"
 #include "ioledmatrix.h"
 #include "ioswitches.h"
+#include "iotimer.h"
 
 /** @brief IORegistry
  *
@@ -18,24 +21,41 @@
 
 namespace Ripes {
 
-enum IOType { LED_MATRIX, SWITCHES, DPAD, NPERIPHERALS };
+enum IOType {
+  LED_MATRIX,
+  SWITCHES,
+  DPAD,
+  FRAMEBUFFER,
+  TIMER,
+  INTERRUPT_CONTROLLER,
+  DMA,
+  NPERIPHERALS
+};
 
 template <typename T>
-IOBase *createIO(QWidget *parent) {
+IOBase *createIO(QObject *parent) {
   static_assert(std::is_base_of<IOBase, T>::value);
   return new T(parent);
 }
 
-using IOFactory = std::function<IOBase *(QWidget *parent)>;
+using IOFactory = std::function<IOBase *(QObject *parent)>;
 
 const static std::map<IOType, QString> IOTypeTitles = {
     {IOType::LED_MATRIX, "LED Matrix"},
     {IOType::SWITCHES, "Switches"},
-    {IOType::DPAD, "D-Pad"}};
+    {IOType::DPAD, "D-Pad"},
+    {IOType::FRAMEBUFFER, "Framebuffer"},
+    {IOType::TIMER, "Timer"},
+    {IOType::INTERRUPT_CONTROLLER, "Interrupt controller"},
+    {IOType::DMA, "DMA"}};
 const static std::map<IOType, IOFactory> IOFactories = {
     {IOType::LED_MATRIX, createIO<IOLedMatrix>},
     {IOType::SWITCHES, createIO<IOSwitches>},
-    {IOType::DPAD, createIO<IODPad>}};
+    {IOType::DPAD, createIO<IODPad>},
+    {IOType::FRAMEBUFFER, createIO<IOFramebuffer>},
+    {IOType::TIMER, createIO<IOTimer>},
+    {IOType::INTERRUPT_CONTROLLER, createIO<IOInterruptController>},
+    {IOType::DMA, createIO<IODMA>}};
 
 } // namespace Ripes
 
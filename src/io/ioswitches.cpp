@@ -136,13 +136,10 @@ void ToggleButton::enterEvent(QEnterEvent *event) {
  * IO Switches
  */
 
-IOSwitches::IOSwitches(QWidget *parent) : IOBase(IOType::SWITCHES, parent) {
+IOSwitches::IOSwitches(QObject *parent) : IOBase(IOType::SWITCHES, parent) {
   // Parameters
   m_parameters[SWITCHES] = IOParam(SWITCHES, "# Switches", 8, true, 1, 32);
 
-  m_switchLayout = new QGridLayout(this);
-  setLayout(m_switchLayout);
-
   updateSwitches();
 }
 
@@ -155,8 +152,75 @@ QString IOSwitches::description() const {
   return desc.join('\n');
 }
 
+unsigned IOSwitches::numSwitches() const {
+  return m_parameters.at(SWITCHES).value.toUInt();
+}
+
 void IOSwitches::updateSwitches() {
-  const unsigned nSwitches = m_parameters.at(SWITCHES).value.toInt();
+  const unsigned nSwitches = numSwitches();
+  // Remove the state of extra switches if # of switches was reduced
+  m_state &= vsrtl::generateBitmask(nSwitches);
+
+  m_extraSymbols.clear();
+  m_extraSymbols.push_back(IOSymbol{"N", nSwitches});
+
+  // No reason to export the register, since the base pointer already points to
+  // it, and it is the only register of this component.
+  m_regDescs = {RegDesc{"Switches", RegDesc::RW::R, nSwitches, 0, false}};
+
+  emit regMapChanged();
+}
+
+QStringList IOSwitches::inputs() const {
+  QStringList names;
+  for (unsigned i = 0; i < numSwitches(); ++i)
+    names << QString::number(i);
+  return names;
+}
+
+bool IOSwitches::input(unsigned index) const {
+  return (m_state >> index) & 1;
+}
+
+void IOSwitches::setInput(unsigned index, bool value) {
+  if (index >= numSwitches())
+    return;
+  if (value)
+    m_state |= 1u << index;
+  else
+    m_state &= ~(1u << index);
+  emit inputsChanged();
+}
+
+VInt IOSwitches::ioRead(AInt, unsigned) { return m_state; }
+
+void IOSwitches::ioWrite(AInt, VInt, unsigned) {
+  // Read-only
+  return;
+}
+
+IOView *IOSwitches::createView(QWidget *parent) {
+  return new IOSwitchesView(this, parent);
+}
+
+/**
+ * IO Switches view
+ */
+
+IOSwitchesView::IOSwitchesView(IOSwitches *switches, QWidget *parent)
+    : IOView(switches, parent), m_switchesPeriph(switches) {
+  m_switchLayout = new QGridLayout(this);
+  setLayout(m_switchLayout);
+
+  connect(switches, &IOBase::paramsChanged, this,
+          &IOSwitchesView::updateSwitches);
+  connect(switches, &IOBase::inputsChanged, this,
+          &IOSwitchesView::updateSwitches);
+  updateSwitches();
+}
+
+void IOSwitchesView::updateSwitches() {
+  const unsigned nSwitches = m_switchesPeriph->inputs().size();
   for (unsigned i = 0; i < nSwitches; ++i) {
     if (m_switches.count(i) == 0) {
       auto *sw = new ToggleButton(10, 8, true, this);
@@ -164,12 +228,15 @@ void IOSwitches::updateSwitches() {
       m_switches[i] = {label, sw};
       m_switchLayout->addWidget(label, 0, i, Qt::AlignCenter);
       m_switchLayout->addWidget(sw, 1, i, Qt::AlignCenter);
+      connect(sw, &QAbstractButton::clicked, this, [this, i](bool checked) {
+        m_switchesPeriph->setInput(i, checked);
+      });
     }
+    auto *sw = m_switches.at(i).second;
+    if (sw->isChecked() != m_switchesPeriph->input(i))
+      sw->setChecked(m_switchesPeriph->input(i));
   }
 
-  m_extraSymbols.clear();
-  m_extraSymbols.push_back(IOSymbol{"N", nSwitches});
-
   // Remove extra switches if # of switches was reduced
   std::vector<unsigned> idxToDelete;
   for (const auto &it : m_switches) {
@@ -185,26 +252,7 @@ void IOSwitches::updateSwitches() {
     it->second.second->deleteLater();
     m_switches.erase(idx);
   }
-
-  // No reason to export the register, since the base pointer already points to
-  // it, and it is the only register of this component.
-  m_regDescs = {RegDesc{"Switches", RegDesc::RW::R, nSwitches, 0, false}};
   updateGeometry();
-
-  emit regMapChanged();
-}
-
-VInt IOSwitches::ioRead(AInt, unsigned) {
-  return std::accumulate(m_switches.begin(), m_switches.end(), 0,
-                         [=](uint32_t acc, const auto &sw) {
-                           return acc | (sw.second.second->isChecked())
-                                            << sw.first;
-                         });
-}
-
-void IOSwitches::ioWrite(AInt, VInt, unsigned) {
-  // Read-only
-  return;
 }
 
 } // namespace Ripes
@@ -8,7 +8,10 @@
 #include <QtCore/QPropertyAnimation>
 #include <QtWidgets/QAbstractButton>
 
+#include <atomic>
+
 #include "iobase.h"
+#include "ioview.h"
 
 namespace Ripes {
 
@@ -27,6 +30,7 @@ public:
   ~ToggleButton();
 
   QSize sizeHint() const override;
+  void setChecked(bool checked);
 
 signals:
   void mOffsetChanged(int);
@@ -36,7 +40,6 @@ protected:
   void resizeEvent(QResizeEvent *) override;
   void mouseReleaseEvent(QMouseEvent *) override;
   void enterEvent(QEnterEvent *event) override;
-  void setChecked(bool checked);
 
   int offset();
   void setOffset(int value);
@@ -58,13 +61,18 @@ private:
   QHash<bool, QString> mThumbText;
 };
 
+/**
+ * @brief The IOSwitches class
+ * A bank of switches, each mapped to a bit of the register of the peripheral.
+ * The switches are the inputs of the peripheral.
+ */
 class IOSwitches : public IOBase {
   Q_OBJECT
 
   enum Parameters { SWITCHES };
 
 public:
-  IOSwitches(QWidget *parent);
+  IOSwitches(QObject *parent);
   ~IOSwitches() { unregister(); };
 
   virtual unsigned byteSize() const override { return 4; }
@@ -84,16 +92,43 @@ public:
   virtual VInt ioRead(AInt offset, unsigned size) override;
   virtual void ioWrite(AInt offset, VInt value, unsigned size) override;
 
+  virtual IOView *createView(QWidget *parent) override;
+
+  virtual QStringList inputs() const override;
+  virtual bool input(unsigned index) const override;
+  virtual void setInput(unsigned index, bool value) override;
+
 protected:
   virtual void parameterChanged(unsigned) override { updateSwitches(); };
 
 private:
   void updateSwitches();
+  unsigned numSwitches() const;
 
-  uint32_t regRead(AInt offset) const;
-  std::map<unsigned, std::pair<QLabel *, ToggleButton *>> m_switches;
-  QGridLayout *m_switchLayout;
+  // Bit n holds the state of switch n. Set from the GUI thread, and read by
+  // the simulator thread.
+  std::atomic<uint32_t> m_state{0};
   std::vector<RegDesc> m_regDescs;
   std::vector<IOSymbol> m_extraSymbols;
 };
+
+/**
+ * @brief The IOSwitchesView class
+ * A toggle button per switch, which sets the switch when clicked.
+ */
+class IOSwitchesView : public IOView {
+  Q_OBJECT
+
+public:
+  IOSwitchesView(IOSwitches *switches, QWidget *parent);
+
+private:
+  /// Creates a toggle button per switch, and checks the buttons of the
+  /// switches which are set.
+  void updateSwitches();
+
+  IOSwitches *m_switchesPeriph;
+  std::map<unsigned, std::pair<QLabel *, ToggleButton *>> m_switches;
+  QGridLayout *m_switchLayout;
+};
 } // namespace Ripes
@@ -0,0 +1,148 @@
+#include "iotimer.h"
+
+#include <QPainter>
+
+#include "ioregistry.h"
+#include "processorhandler.h"
+
+namespace Ripes {
+
+IOTimer::IOTimer(QObject *parent) : IOBase(IOType::TIMER, parent) {
+  m_parameters[SOURCE] =
+      IOParam(SOURCE, "Interrupt source", 1, true, 1, s_interruptSources - 1);
+
+  m_regDescs.push_back(RegDesc{"MTIME", RegDesc::RW::R, 32, 0x0, true});
+  m_regDescs.push_back(RegDesc{"MTIMEH", RegDesc::RW::R, 32, 0x4, true});
+  m_regDescs.push_back(RegDesc{"MTIMECMP", RegDesc::RW::RW, 32, 0x8, true});
+  m_regDescs.push_back(RegDesc{"MTIMECMPH", RegDesc::RW::RW, 32, 0xC, true});
+  m_extraSymbols.push_back(IOSymbol{"SOURCE", source()});
+
+  // The expiry is scheduled with the processor, and so must be rescheduled
+  // with a new processor.
+  connect(ProcessorHandler::get(), &ProcessorHandler::processorChanged, this,
+          &IOTimer::schedule);
+}
+
+unsigned IOTimer::source() const {
+  return m_parameters.at(SOURCE).value.toUInt();
+}
+
+QString IOTimer::description() const {
+  QStringList desc;
+  desc << "MTIME holds the 64-bit time of the timer, which is the cycle count "
+          "of the processor.";
+  desc << "Once MTIME is greater than or equal to the 64-bit MTIMECMP, the "
+          "interrupt source SOURCE of the interrupt controller is raised "
+          "until MTIMECMP is written with a value beyond MTIME.";
+  desc << "To avoid spurious interrupts, write MTIMECMPH as -1 before writing "
+          "MTIMECMP, and MTIMECMPH thereafter.";
+  return desc.join('\n');
+}
+
+VInt IOTimer::ioRead(AInt offset, unsigned) {
+  const uint64_t time = ProcessorHandler::getProcessor()->getCycleCount();
+  switch (offset) {
+  case 0x0:
+    return time & 0xFFFFFFFF;
+  case 0x4:
+    return time >> 32;
+  case 0x8:
+    return m_compare & 0xFFFFFFFF;
+  case 0xC:
+    return m_compare >> 32;
+  default:
+    return 0;
+  }
+}
+
+void IOTimer::ioWrite(AInt offset, VInt value, unsigned) {
+  value &= 0xFFFFFFFF;
+  if (offset == 0x8)
+    m_compare = (m_compare & ~uint64_t(0xFFFFFFFF)) | value;
+  else if (offset == 0xC)
+    m_compare = (m_compare & 0xFFFFFFFF) | (uint64_t(value) << 32);
+  else
+    return;
+  schedule();
+  emit scheduleUpdate();
+}
+
+void IOTimer::reset() {
+  m_compare = UINT64_MAX;
+  schedule();
+  emit scheduleUpdate();
+}
+
+bool IOTimer::saveState(std::vector<uint64_t> &state) const {
+  state.push_back(m_compare);
+  return true;
+}
+
+bool IOTimer::restoreState(const std::vector<uint64_t> &state) {
+  if (state.size() != 1)
+    return false;
+  // The expiry is rescheduled for the restored cycle count.
+  m_compare = state[0];
+  schedule();
+  emit scheduleUpdate();
+  return true;
+}
+
+void IOTimer::parameterChanged(unsigned) {
+  // Lower the line of the previous source.
+  const bool line = m_line;
+  setLine(false);
+  m_extraSymbols.clear();
+  m_extraSymbols.push_back(IOSymbol{"SOURCE", source()});
+  setLine(line);
+  emit regMapChanged();
+}
+
+void IOTimer::schedule() {
+  auto *processor = ProcessorHandler::getProcessorNonConst();
+  if (!processor)
+    return;
+  auto &events = processor->events();
+  const long long time = processor->getCycleCount();
+  if (m_compare > uint64_t(time)) {
+    setLine(false);
+    if (m_compare < uint64_t(LLONG_MAX))
+      events.schedule(this, m_compare, [this] {
+        setLine(true);
+        emit scheduleUpdate();
+      });
+    else
+      events.cancel(this);
+  } else {
+    events.cancel(this);
+    setLine(true);
+  }
+}
+
+void IOTimer::setLine(bool level) {
+  m_line = level;
+  if (setInterruptLine)
+    setInterruptLine(source(), level);
+}
+
+IOView *IOTimer::createView(QWidget *parent) {
+  return new IOTimerView(this, parent);
+}
+
+QSize IOTimerView::minimumSizeHint() const {
+  return QSize(fontMetrics().horizontalAdvance("MTIMECMP: 0x0000000000000000"),
+               fontMetrics().height() * 2);
+}
+
+void IOTimerView::paintEvent(QPaintEvent *) {
+  QPainter painter(this);
+  const uint64_t cmp = m_timer->compare();
+  const QString compare =
+      cmp == UINT64_MAX ? QString("-") : "0x" + QString::number(cmp, 16);
+  painter.drawText(rect(), Qt::AlignLeft | Qt::AlignTop,
+                   "MTIMECMP: " + compare + "\nInterrupt: " +
+                       (m_timer->line() ? "raised" : "-"));
+  painter.end();
+}
+
+} // namespace Ripes
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <QVariant>
+#include <QWidget>
+
+#include "iobase.h"
+#include "ioview.h"
+
+namespace Ripes {
+
+/**
+ * @brief The IOTimer class
+ * A machine timer, in the style of the RISC-V CLINT. The time of the timer is
+ * the cycle count of the processor. Once the time reaches the compare value,
+ * the interrupt line of the timer is raised until a compare value beyond the
+ * time is written.
+ *
+ * The expiry of the timer is scheduled as an event of the processor (see
+ * RipesProcessor::events), such that the timer is not polled every cycle.
+ */
+class IOTimer : public IOBase {
+  Q_OBJECT
+
+  enum Parameters { SOURCE };
+
+public:
+  IOTimer(QObject *parent);
+  ~IOTimer() { unregister(); };
+
+  virtual unsigned byteSize() const override { return 4 * 4; }
+  virtual QString description() const override;
+  virtual QString baseName() const override { return "Timer"; }
+
+  virtual const std::vector<RegDesc> &registers() const override {
+    return m_regDescs;
+  };
+  virtual const std::vector<IOSymbol> *extraSymbols() const override {
+    return &m_extraSymbols;
+  }
+
+  /**
+   * Hardware read/write functions
+   */
+  virtual VInt ioRead(AInt offset, unsigned size) override;
+  virtual void ioWrite(AInt offset, VInt value, unsigned size) override;
+
+  virtual void reset() override;
+
+  bool saveState(std::vector<uint64_t> &state) const override;
+  bool restoreState(const std::vector<uint64_t> &state) override;
+
+  virtual IOView *createView(QWidget *parent) override;
+
+  uint64_t compare() const { return m_compare; }
+  bool line() const { return m_line; }
+
+protected:
+  virtual void parameterChanged(unsigned) override;
+
+private:
+  /// Schedules the expiry of the timer with the processor, and updates the
+  /// interrupt line.
+  void schedule();
+  void setLine(bool level);
+  unsigned source() const;
+
+  uint64_t m_compare = UINT64_MAX;
+  bool m_line = false;
+  std::vector<RegDesc> m_regDescs;
+  std::vector<IOSymbol> m_extraSymbols;
+};
+
+class IOTimerView : public IOView {
+  Q_OBJECT
+
+public:
+  IOTimerView(IOTimer *timer, QWidget *parent)
+      : IOView(timer, parent), m_timer(timer) {}
+
+protected:
+  void paintEvent(QPaintEvent *event) override;
+  QSize minimumSizeHint() const override;
+
+private:
+  IOTimer *m_timer;
+};
+} // namespace Ripes
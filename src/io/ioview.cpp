@@ -0,0 +1,19 @@
+#include "ioview.h"
+
+namespace Ripes {
+
+IOView::IOView(IOBase *peripheral, QWidget *parent)
+    : QWidget(parent), m_peripheral(peripheral) {
+  // Updates are scheduled from the simulator thread, and are thereby queued to
+  // the GUI thread.
+  connect(peripheral, &IOBase::scheduleUpdate, this,
+          QOverload<>::of(&QWidget::update));
+  connect(peripheral, &IOBase::paramsChanged, this, [this] {
+    updateGeometry();
+    update();
+  });
+}
+
+IOView::~IOView() { delete m_peripheral; }
+
+} // namespace Ripes
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <QWidget>
+
+#include "iobase.h"
+
+namespace Ripes {
+
+/**
+ * @brief The IOView class
+ * A widget presenting a peripheral in the GUI. The view is repainted when the
+ * peripheral schedules an update, and owns the peripheral, such that closing
+ * the view removes the peripheral.
+ */
+class IOView : public QWidget {
+  Q_OBJECT
+
+public:
+  IOView(IOBase *peripheral, QWidget *parent);
+  ~IOView() override;
+
+  IOBase *peripheral() const { return m_peripheral; }
+
+private:
+  IOBase *m_peripheral;
+};
+
+} // namespace Ripes
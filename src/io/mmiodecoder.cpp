@@ -0,0 +1,44 @@
+#include "mmiodecoder.h"
+
+#include <algorithm>
+
+namespace Ripes {
+
+void MMIODecoder::assign(std::vector<Region> regions) {
+  const auto empty = [](const Region &r) { return r.start >= r.end; };
+  regions.erase(std::remove_if(regions.begin(), regions.end(), empty),
+                regions.end());
+  std::sort(regions.begin(), regions.end(),
+            [](const Region &a, const Region &b) { return a.start < b.start; });
+  m_regions = std::move(regions);
+  m_pages.clear();
+  if (m_regions.empty()) {
+    m_base = 0;
+    m_size = 0;
+    return;
+  }
+
+  m_base = m_regions.front().start;
+  m_size = m_regions.back().end - m_base;
+  m_pages.resize(((m_size - 1) >> s_pageBits) + 1);
+  unsigned region = 0;
+  for (AInt page = 0; page < m_pages.size(); ++page) {
+    const AInt pageStart = m_base + (page << s_pageBits);
+    while (m_regions[region].end <= pageStart)
+      ++region;
+    m_pages[page] = region;
+  }
+}
+
+std::vector<std::pair<AInt, AInt>> MMIODecoder::runs() const {
+  std::vector<std::pair<AInt, AInt>> runs;
+  for (const auto &region : m_regions) {
+    if (!runs.empty() && runs.back().first + runs.back().second == region.start)
+      runs.back().second += region.end - region.start;
+    else
+      runs.push_back({region.start, region.end - region.start});
+  }
+  return runs;
+}
+
+} // namespace Ripes
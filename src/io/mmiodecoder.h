@@ -0,0 +1,66 @@
+#pragma once
+
+#include "isa/isa_types.h"
+
+#include <utility>
+#include <vector>
+
+namespace Ripes {
+
+class IOBase;
+
+/**
+ * @brief The MMIODecoder class
+ * Decodes the addresses of the memory-mapped I/O window into the peripherals
+ * mapped at them. The window is divided into pages, each holding the index of
+ * the first peripheral which overlaps or follows the page, such that an
+ * address is decoded in constant time regardless of the number of
+ * peripherals. Addresses outside of the window are rejected by a single range
+ * check.
+ */
+class MMIODecoder {
+public:
+  /// A peripheral mapped at [start; end[.
+  struct Region {
+    AInt start;
+    AInt end;
+    IOBase *peripheral;
+  };
+
+  /// Replaces the mapped regions with @p regions, which must not overlap.
+  void assign(std::vector<Region> regions);
+
+  /// Returns the region containing @p address, or nullptr if @p address is
+  /// not mapped to a peripheral.
+  const Region *decode(AInt address) const {
+    // Addresses below the window wrap around to beyond its size.
+    const AInt offset = address - m_base;
+    if (offset >= m_size)
+      return nullptr;
+    for (unsigned i = m_pages[offset >> s_pageBits];
+         i < m_regions.size() && m_regions[i].start <= address; ++i)
+      if (address < m_regions[i].end)
+        return &m_regions[i];
+    return nullptr;
+  }
+
+  const std::vector<Region> &regions() const { return m_regions; }
+
+  /// Returns the maximal ranges of contiguously mapped regions, as pairs of
+  /// start address and size.
+  std::vector<std::pair<AInt, AInt>> runs() const;
+
+  static constexpr unsigned s_pageBits = 8;
+
+private:
+  // Bounds of the window, from the start of the first region to the end of
+  // the last.
+  AInt m_base = 0;
+  AInt m_size = 0;
+  // Regions sorted by their start address.
+  std::vector<Region> m_regions;
+  // Index of the first region which ends beyond the start of each page.
+  std::vector<unsigned> m_pages;
+};
+
+} // namespace Ripes
@@ -8,6 +8,7 @@
 #include <QToolBar>
 
 #include "fonts.h"
+#include "io/ioview.h"
 #include "io/memorymapmodel.h"
 #include "ioperipheraltab.h"
 #include "processorhandler.h"
@@ -55,14 +56,14 @@ IOTab::IOTab(QToolBar *toolbar, QWidget *parent)
             if (w == nullptr) {
               setPeripheralTabActive(nullptr);
             } else {
-              // MDI window -> QMainwindow -> QDockWidget -> IOBase widget...
+              // MDI window -> QMainwindow -> QDockWidget -> IOView widget...
               // Whew!
               auto *w1 = w->widget();
               auto *w2 = w1->findChildren<QDockWidget *>().at(0);
               auto *w3 = w2->widget();
-              auto *peripheral = dynamic_cast<IOBase *>(w3);
-              Q_ASSERT(peripheral != nullptr);
-              this->setPeripheralTabActive(peripheral);
+              auto *view = dynamic_cast<IOView *>(w3);
+              Q_ASSERT(view != nullptr);
+              this->setPeripheralTabActive(view->peripheral());
             }
           });
 
@@ -122,14 +123,17 @@ IOBase *IOTab::createPeripheral(IOType type, int forcedID) {
   auto *mw = new QMainWindow(this);
   m_ui->dockArea->addWidget(
       mw); // Shouldn't be needed, but MDI windows aren't created without this?
+  // The view owns the peripheral, such that closing the MDI window removes the
+  // peripheral.
+  auto *view = peripheral->createView(nullptr);
   auto *dw = new QDockWidget();
   dw->setFeatures(dw->features() & ~QDockWidget::DockWidgetClosable);
-  dw->setWidget(peripheral);
+  dw->setWidget(view);
   dw->setAllowedAreas(Qt::AllDockWidgetAreas);
   mw->addDockWidget(Qt::TopDockWidgetArea, dw);
   auto *mdiw = m_ui->mdiArea->addSubWindow(mw);
   mdiw->setWindowTitle(peripheral->name());
-  peripheral->setFocus();
+  view->setFocus();
 
   /* The following ensures that the MDI window which a peripheral is contained
    * within is resized when the widget itself is resized. It seems a bit
@@ -259,8 +263,9 @@ IOTab::~IOTab() {
    * been removed, we need to delete all IOBase objects before deleting the
    * IOTab itself. The default deletion mechanism is incorrect for this, given
    * that IOTab is first deleted, and then the underlying QObject is deleted
-   * (which deletes its children, being the IOBase objects). We delete from the
-   * subwindows because they are the top-level parent of the IOBase objects.
+   * (which deletes its children, being the views of the IOBase objects). We
+   * delete from the subwindows because they are the top-level parent of the
+   * views, which own the IOBase objects.
    */
 
   // Copy subwindows collection, so we can safely iterate through it
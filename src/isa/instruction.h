@@ -84,6 +84,8 @@ struct BitRangeBase {
   constexpr unsigned width() const { return stop - start + 1; }
   // TODO(raccog): Decouple from vsrtl library
   constexpr Instr_T getMask() const { return vsrtl::generateBitmask(width()); }
+  /// Returns the mask of the bits of this range within an instruction.
+  constexpr Instr_T getInstrMask() const { return getMask() << start; }
   constexpr Instr_T apply(Instr_T value) const {
     return (value & getMask()) << start;
   }
@@ -135,6 +137,10 @@ struct BitRangeSet {
 
   /// Returns the combined width of all BitRanges
   constexpr static unsigned width() { return (BitRanges().width() + ... + 0); }
+  /// Returns the combined mask of all BitRanges within an instruction
+  constexpr static Instr_T mask() {
+    return (BitRanges().getInstrMask() | ... | Instr_T(0));
+  }
 
 private:
   /// Compile-time verification using recursive templates and static_assert
@@ -263,6 +269,14 @@ struct OpcodeSet {
   }
   /// Returns the number of OpParts in this opcode.
   constexpr static unsigned numParts() { return sizeof...(OpParts); }
+  /// Returns the mask of the bits identified by the OpParts.
+  constexpr static Instr_T mask() { return BitRanges::mask(); }
+  /// Returns the value of the bits identified by the OpParts.
+  constexpr static Instr_T value() {
+    Instr_T instruction = 0;
+    (OpParts().apply(instruction), ...);
+    return instruction;
+  }
   /// Returns a pointer to a dynamically accessible OpPart. (needed for the
   /// assembly matcher)
   constexpr static OpPartBase getOpPart(unsigned partIndex) {
@@ -382,6 +396,8 @@ public:
 
   /// Returns the number of Fields in this set.
   constexpr static unsigned numFields() { return sizeof...(Fields); }
+  /// Returns the mask of the bits encoding the fields.
+  constexpr static Instr_T mask() { return BitRanges::mask(); }
 
 private:
   /// This calls all BitRanges' static assertions
@@ -699,7 +715,10 @@ using Imm = ImmBase<tokenIndex, width, repr, ImmParts, SymbolType::None,
 /** @brief A no-template, abstract class that defines an instruction. */
 class InstructionBase {
 public:
-  InstructionBase(unsigned byteSize) : m_byteSize(byteSize) {}
+  InstructionBase(unsigned byteSize, Instr_T opcodeMask = 0,
+                  Instr_T opcodeValue = 0)
+      : m_byteSize(byteSize), m_opcodeMask(opcodeMask),
+        m_opcodeValue(opcodeValue) {}
   virtual ~InstructionBase() = default;
   /// Assembles a line of tokens into an encoded program.
   virtual AssembleRes assemble(const TokenizedSrcLine &tokens) = 0;
@@ -721,6 +740,15 @@ public:
    */
   unsigned size() const { return m_byteSize; }
 
+  /// Returns the mask of the bits identified by the OpParts of this
+  /// instruction, and the value of these bits.
+  Instr_T opcodeMask() const { return m_opcodeMask; }
+  Instr_T opcodeValue() const { return m_opcodeValue; }
+  /// Returns true if all OpParts of this instruction are contained in @p instr.
+  bool matchesOpcode(Instr_T instr) const {
+    return (instr & m_opcodeMask) == m_opcodeValue;
+  }
+
   void addExtraMatchCond(const std::function<bool(Instr_T)> &f) {
     m_extraMatchConditions.push_back(f);
   }
@@ -735,6 +763,8 @@ protected:
   /// opcode-based matching is insufficient.
   std::vector<std::function<bool(Instr_T)>> m_extraMatchConditions;
   unsigned m_byteSize;
+  Instr_T m_opcodeMask;
+  Instr_T m_opcodeValue;
 };
 
 /** @brief Asserts that this instruction has no overlapping fields, has all
@@ -770,15 +800,23 @@ struct InstrByteSize {
  */
 template <typename InstrImpl>
 struct Instruction : public InstructionBase {
+  /// The encoding of the opcode and the layout of the fields, derived from the
+  /// OpParts and Fields at compile time.
+  constexpr static Instr_T opcodeMaskImpl = InstrImpl::Opcode::mask();
+  constexpr static Instr_T opcodeValueImpl = InstrImpl::Opcode::value();
+  constexpr static Instr_T fieldsMaskImpl = InstrImpl::Fields::mask();
+  static_assert((opcodeMaskImpl & fieldsMaskImpl) == 0,
+                "Opcode and fields of instruction overlap");
+
   Instruction()
-      : InstructionBase(InstrByteSize<InstrImpl>::byteSize),
+      : InstructionBase(InstrByteSize<InstrImpl>::byteSize, opcodeMaskImpl,
+                        opcodeValueImpl),
         m_name(InstrImpl::NAME.data()) {}
 
   AssembleRes assemble(const TokenizedSrcLine &tokens) override {
-    Instr_T instruction = 0;
+    Instr_T instruction = opcodeValueImpl;
     FieldLinkRequest linksWithSymbol;
 
-    InstrImpl::Opcode::apply(instruction, linksWithSymbol);
     if (auto fieldRes =
             InstrImpl::Fields::apply(tokens, instruction, linksWithSymbol);
         fieldRes.isError()) {
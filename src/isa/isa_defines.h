@@ -245,6 +245,7 @@ struct Result : public std::variant<Error, T> {
   using V_T = std::variant<Error, T>;
 
   Result(const T &v) : V_T(v) {}
+  Result(T &&v) : V_T(std::move(v)) {}
 
   Result(const Error &err) : V_T(err) {}
 
@@ -4,7 +4,9 @@
 #include <QMap>
 #include <QSet>
 #include <QString>
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <vector>
 
@@ -147,21 +149,49 @@ public:
   /// Returns the set of relocations for this ISA
   virtual const RelocationsVec &relocations() const = 0;
 
+  /// A set of extensions, as a mask of the indices of the extensions within
+  /// the supported extensions of an ISA.
+  using ExtensionMask = uint32_t;
+  /// Returns the mask of @p extensions within @p supported. Unsupported
+  /// extensions are ignored.
+  static ExtensionMask extensionMask(const QStringList &supported,
+                                     const QStringList &extensions) {
+    ExtensionMask mask = 0;
+    for (const auto &ext : extensions) {
+      const auto index = supported.indexOf(ext);
+      if (index >= 0)
+        mask |= ExtensionMask(1) << index;
+    }
+    return mask;
+  }
+  /// Returns the mask of the enabled extensions, computed upon first use.
+  ExtensionMask enabledExtensionMask() const {
+    auto mask = m_enabledExtensionMask.load(std::memory_order_relaxed);
+    if (mask < 0) {
+      mask = extensionMask(supportedExtensions(), enabledExtensions());
+      m_enabledExtensionMask.store(mask, std::memory_order_relaxed);
+    }
+    return static_cast<ExtensionMask>(mask);
+  }
+
   /**
    * ISA equality is defined as a separate function rather than the == operator,
    * given that we might need to check for ISA equivalence, without having
-   * instantiated the other ISA. As such, it being uninstantiated does not allow
-   * comparison of extensions.
+   * instantiated the other ISA with the extensions @p otherExts. ISAs are equal
+   * if they are the same ISA with the same set of enabled extensions.
    */
   bool eq(const ISAInfoBase *other, const QStringList &otherExts) const {
-    const auto ext1 = QSet(this->enabledExtensions().begin(),
-                           this->enabledExtensions().end());
-    const auto ext2 = QSet(otherExts.begin(), otherExts.end());
-    return this->name() == other->name() && ext1 == ext2;
+    return this->isaID() == other->isaID() &&
+           enabledExtensionMask() ==
+               extensionMask(other->supportedExtensions(), otherExts);
   }
 
 protected:
   ISAInfoBase() {}
+
+private:
+  // Mask of the enabled extensions, or -1 until computed.
+  mutable std::atomic<int64_t> m_enabledExtensionMask = -1;
 };
 
 struct ProcessorISAInfo {
@@ -173,8 +203,10 @@ struct ProcessorISAInfo {
 template <ISA isa>
 class ISAInfo : public ISAInfoBase {};
 
-using ISAInfoMap =
-    std::map<std::pair<ISA, QStringList>, std::shared_ptr<ISAInfoBase>>;
+// ISAs are interned by their enabled extensions, such that lookups compare
+// integers rather than lists of extensions.
+using ISAInfoMap = std::map<std::pair<ISA, ISAInfoBase::ExtensionMask>,
+                            std::shared_ptr<ISAInfoBase>>;
 
 struct ISAInfoRegistry {
   template <ISA isa>
@@ -197,13 +229,18 @@ private:
   template <ISA isa>
   const std::shared_ptr<ISAInfoBase> &supportedISA(
       const QStringList &extensions = ISAInfo<isa>::getSupportedExtensions()) {
-    auto key = std::pair(isa, extensions);
-    if (supportedISAMap.count(key) == 0) {
-      supportedISAMap[key] = std::make_shared<ISAInfo<isa>>(extensions);
-    }
-    return supportedISAMap.at(key);
+    const auto key = std::pair(
+        isa, ISAInfoBase::extensionMask(ISAInfo<isa>::getSupportedExtensions(),
+                                        extensions));
+    // ISAs are looked up by processors constructed on worker threads.
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto &info = supportedISAMap[key];
+    if (!info)
+      info = std::make_shared<ISAInfo<isa>>(extensions);
+    return info;
   }
 
+  std::mutex m_mutex;
   ISAInfoMap supportedISAMap;
 };
 
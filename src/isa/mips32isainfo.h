@@ -15,6 +15,7 @@ public:
         m_enabledExtensions << ext;
       }
     }
+    initialize();
   }
 
   ISA isaID() const override { return ISA::MIPS32I; }
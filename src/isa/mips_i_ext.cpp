@@ -0,0 +1,37 @@
+#include "mips_i_ext.h"
+
+namespace Ripes {
+namespace MIPSISA {
+namespace ExtI {
+
+void enableExt(const ISAInfoBase *, InstrVec &instructions,
+               PseudoInstrVec &pseudoInstructions) {
+  using namespace TypeR;
+  using namespace TypeRShift;
+  using namespace TypeRShiftV;
+  using namespace TypeRMulDiv;
+  using namespace TypeRMoveFrom;
+  using namespace TypeRSource;
+  using namespace TypeRTrap;
+  using namespace TypeI;
+  using namespace TypeIU;
+  using namespace TypeL;
+  using namespace TypeB;
+  using namespace TypeBZ;
+  using namespace TypeJ;
+
+  enableInstructions<Add, Addu, Sub, Subu, And, Or, Xor, Nor, Slt, Sltu, Sll,
+                     Srl, Sra, Sllv, Srlv, Srav, Mult, Multu, Div, Divu, Mfhi,
+                     Mflo, Mthi, Mtlo, Jr, Jalr, Syscall, Break, Addi, Addiu,
+                     Slti, Sltiu, Andi, Ori, Xori, Lui, Lb, Lbu, Lh, Lhu, Lw,
+                     Sb, Sh, Sw, Beq, Bne, Blez, Bgtz, Bltz, Bgez, J, Jal>(
+      instructions);
+
+  using namespace TypePseudo;
+  enablePseudoInstructions<Nop, Move, Li, La, B, Beqz, Bnez, Blt, Bgt, Ble,
+                           Bge>(pseudoInstructions);
+}
+
+} // namespace ExtI
+} // namespace MIPSISA
+} // namespace Ripes
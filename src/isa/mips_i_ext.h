@@ -0,0 +1,612 @@
+#pragma once
+
+#include "mipsisainfo_common.h"
+#include "pseudoinstruction.h"
+
+namespace Ripes {
+namespace MIPSISA {
+
+namespace ExtI {
+
+/// A MIPS signed immediate field with a width of 16 bits, in bits 0-15.
+/// Used in arithmetic I-type instructions, loads and stores.
+template <unsigned tokenIndex>
+struct ImmSigned16
+    : public Imm<tokenIndex, 16, Repr::Signed, ImmPart<0, 0, 15>> {};
+
+/// A MIPS unsigned immediate field with a width of 16 bits, in bits 0-15.
+/// Used in logical I-type instructions and lui, which zero-extend it.
+template <unsigned tokenIndex>
+struct ImmUnsigned16
+    : public Imm<tokenIndex, 16, Repr::Hex, ImmPart<0, 0, 15>> {};
+
+/// Branch offsets are encoded relative to the instruction following the
+/// branch.
+inline Reg_T branchOffset(Reg_T offset) { return offset - 4; }
+
+/// A MIPS branch offset, in bytes. It is defined as:
+///  - Imm[31:18] = Inst[15]
+///  - Imm[17:2]  = Inst[15:0]
+///  - Imm[1:0]   = 0
+template <unsigned tokenIndex>
+struct ImmBranch : public ImmBase<tokenIndex, 18, Repr::Signed,
+                                  ImmPart<2, 0, 15>, SymbolType::Relative,
+                                  branchOffset> {};
+
+/// Jump targets are encoded as their address within the 256 MiB region of the
+/// jump.
+inline Reg_T jumpRegion(Reg_T target) { return target & 0x0FFFFFFF; }
+
+/// A MIPS jump target. It is defined as:
+///  - Imm[27:2] = Inst[25:0]
+///  - Imm[1:0]  = 0
+template <unsigned tokenIndex>
+struct ImmJump : public ImmBase<tokenIndex, 28, Repr::Hex, ImmPart<2, 0, 25>,
+                                SymbolType::Absolute, jumpRegion> {};
+
+namespace TypeR {
+
+/// An R-type MIPS instruction, computing rd from rs and rt
+template <typename InstrImpl, Function funct>
+struct Instr : public MIPS_Instruction<InstrImpl> {
+  struct Opcode
+      : public OpcodeSet<OpPartOpcode<MIPSISA::RTYPE>, OpPartFunct<funct>,
+                         OpPartZeroes<6, 10>> {};
+  struct Fields : public FieldSet<RegRd, RegRs, RegRt> {};
+};
+
+struct Add : public Instr<Add, MIPSISA::ADD> {
+  constexpr static std::string_view NAME = "add";
+};
+
+struct Addu : public Instr<Addu, MIPSISA::ADDU> {
+  constexpr static std::string_view NAME = "addu";
+};
+
+struct Sub : public Instr<Sub, MIPSISA::SUB> {
+  constexpr static std::string_view NAME = "sub";
+};
+
+struct Subu : public Instr<Subu, MIPSISA::SUBU> {
+  constexpr static std::string_view NAME = "subu";
+};
+
+struct And : public Instr<And, MIPSISA::AND> {
+  constexpr static std::string_view NAME = "and";
+};
+
+struct Or : public Instr<Or, MIPSISA::OR> {
+  constexpr static std::string_view NAME = "or";
+};
+
+struct Xor : public Instr<Xor, MIPSISA::XOR> {
+  constexpr static std::string_view NAME = "xor";
+};
+
+struct Nor : public Instr<Nor, MIPSISA::NOR> {
+  constexpr static std::string_view NAME = "nor";
+};
+
+struct Slt : public Instr<Slt, MIPSISA::SLT> {
+  constexpr static std::string_view NAME = "slt";
+};
+
+struct Sltu : public Instr<Sltu, MIPSISA::SLTU> {
+  constexpr static std::string_view NAME = "sltu";
+};
+
+} // namespace TypeR
+
+namespace TypeRShift {
+
+/// A MIPS unsigned shift amount with a width of 5 bits, in bits 6-10.
+template <unsigned tokenIndex>
+struct ImmShamt : public Imm<tokenIndex, 5, Repr::Unsigned, ImmPart<0, 6, 10>> {
+};
+
+/// A MIPS shift of rt by a constant amount
+template <typename InstrImpl, Function funct>
+struct Instr : public MIPS_Instruction<InstrImpl> {
+  struct Opcode
+      : public OpcodeSet<OpPartOpcode<MIPSISA::RTYPE>, OpPartFunct<funct>,
+                         OpPartZeroes<21, 25>> {};
+  struct Fields : public FieldSet<RegRd, RegRt, ImmShamt> {};
+};
+
+struct Sll : public Instr<Sll, MIPSISA::SLL> {
+  constexpr static std::string_view NAME = "sll";
+};
+
+struct Srl : public Instr<Srl, MIPSISA::SRL> {
+  constexpr static std::string_view NAME = "srl";
+};
+
+struct Sra : public Instr<Sra, MIPSISA::SRA> {
+  constexpr static std::string_view NAME = "sra";
+};
+
+} // namespace TypeRShift
+
+namespace TypeRShiftV {
+
+/// A MIPS shift of rt by the amount in rs
+template <typename InstrImpl, Function funct>
+struct Instr : public MIPS_Instruction<InstrImpl> {
+  struct Opcode
+      : public OpcodeSet<OpPartOpcode<MIPSISA::RTYPE>, OpPartFunct<funct>,
+                         OpPartZeroes<6, 10>> {};
+  struct Fields : public FieldSet<RegRd, RegRt, RegRs> {};
+};
+
+struct Sllv : public Instr<Sllv, MIPSISA::SLLV> {
+  constexpr static std::string_view NAME = "sllv";
+};
+
+struct Srlv : public Instr<Srlv, MIPSISA::SRLV> {
+  constexpr static std::string_view NAME = "srlv";
+};
+
+struct Srav : public Instr<Srav, MIPSISA::SRAV> {
+  constexpr static std::string_view NAME = "srav";
+};
+
+} // namespace TypeRShiftV
+
+namespace TypeRMulDiv {
+
+/// A MIPS multiplication or division of rs and rt into hi and lo
+template <typename InstrImpl, Function funct>
+struct Instr : public MIPS_Instruction<InstrImpl> {
+  struct Opcode
+      : public OpcodeSet<OpPartOpcode<MIPSISA::RTYPE>, OpPartFunct<funct>,
+                         OpPartZeroes<6, 15>> {};
+  struct Fields : public FieldSet<RegRs, RegRt> {};
+};
+
+struct Mult : public Instr<Mult, MIPSISA::MULT> {
+  constexpr static std::string_view NAME = "mult";
+};
+
+struct Multu : public Instr<Multu, MIPSISA::MULTU> {
+  constexpr static std::string_view NAME = "multu";
+};
+
+struct Div : public Instr<Div, MIPSISA::DIV> {
+  constexpr static std::string_view NAME = "div";
+};
+
+struct Divu : public Instr<Divu, MIPSISA::DIVU> {
+  constexpr static std::string_view NAME = "divu";
+};
+
+} // namespace TypeRMulDiv
+
+namespace TypeRMoveFrom {
+
+/// A MIPS move from hi or lo into rd
+template <typename InstrImpl, Function funct>
+struct Instr : public MIPS_Instruction<InstrImpl> {
+  struct Opcode
+      : public OpcodeSet<OpPartOpcode<MIPSISA::RTYPE>, OpPartFunct<funct>,
+                         OpPartZeroes<16, 25>, OpPartZeroes<6, 10>> {};
+  struct Fields : public FieldSet<RegRd> {};
+};
+
+struct Mfhi : public Instr<Mfhi, MIPSISA::MFHI> {
+  constexpr static std::string_view NAME = "mfhi";
+};
+
+struct Mflo : public Instr<Mflo, MIPSISA::MFLO> {
+  constexpr static std::string_view NAME = "mflo";
+};
+
+} // namespace TypeRMoveFrom
+
+namespace TypeRSource {
+
+/// A MIPS R-type instruction with rs as its only operand
+template <typename InstrImpl, Function funct>
+struct Instr : public MIPS_Instruction<InstrImpl> {
+  struct Opcode
+      : public OpcodeSet<OpPartOpcode<MIPSISA::RTYPE>, OpPartFunct<funct>,
+                         OpPartZeroes<6, 20>> {};
+  struct Fields : public FieldSet<RegRs> {};
+};
+
+struct Mthi : public Instr<Mthi, MIPSISA::MTHI> {
+  constexpr static std::string_view NAME = "mthi";
+};
+
+struct Mtlo : public Instr<Mtlo, MIPSISA::MTLO> {
+  constexpr static std::string_view NAME = "mtlo";
+};
+
+struct Jr : public Instr<Jr, MIPSISA::JR> {
+  constexpr static std::string_view NAME = "jr";
+};
+
+} // namespace TypeRSource
+
+struct Jalr : public MIPS_Instruction<Jalr> {
+  struct Opcode
+      : public OpcodeSet<OpPartOpcode<MIPSISA::RTYPE>,
+                         OpPartFunct<MIPSISA::JALR>, OpPartZeroes<16, 20>,
+                         OpPartZeroes<6, 10>> {};
+  struct Fields : public FieldSet<RegRd, RegRs> {};
+
+  constexpr static std::string_view NAME = "jalr";
+};
+
+namespace TypeRTrap {
+
+/// A MIPS trap. The code field is unused, and must be 0.
+template <typename InstrImpl, Function funct>
+struct Instr : public MIPS_Instruction<InstrImpl> {
+  struct Opcode
+      : public OpcodeSet<OpPartOpcode<MIPSISA::RTYPE>, OpPartFunct<funct>,
+                         OpPartZeroes<6, 25>> {};
+  struct Fields : public FieldSet<> {};
+};
+
+struct Syscall : public Instr<Syscall, MIPSISA::SYSCALL> {
+  constexpr static std::string_view NAME = "syscall";
+};
+
+struct Break : public Instr<Break, MIPSISA::BREAK> {
+  constexpr static std::string_view NAME = "break";
+};
+
+} // namespace TypeRTrap
+
+namespace TypeI {
+
+/// An arithmetic I-type MIPS instruction, computing rt from rs and a
+/// sign-extended immediate
+template <typename InstrImpl, Opcode opcode>
+struct Instr : public MIPS_Instruction<InstrImpl> {
+  struct Opcode : public OpcodeSet<OpPartOpcode<opcode>> {};
+  struct Fields : public FieldSet<RegRt, RegRs, ImmSigned16> {};
+};
+
+struct Addi : public Instr<Addi, MIPSISA::ADDI> {
+  constexpr static std::string_view NAME = "addi";
+};
+
+struct Addiu : public Instr<Addiu, MIPSISA::ADDIU> {
+  constexpr static std::string_view NAME = "addiu";
+};
+
+struct Slti : public Instr<Slti, MIPSISA::SLTI> {
+  constexpr static std::string_view NAME = "slti";
+};
+
+struct Sltiu : public Instr<Sltiu, MIPSISA::SLTIU> {
+  constexpr static std::string_view NAME = "sltiu";
+};
+
+} // namespace TypeI
+
+namespace TypeIU {
+
+/// A logical I-type MIPS instruction, computing rt from rs and a zero-extended
+/// immediate
+template <typename InstrImpl, Opcode opcode>
+struct Instr : public MIPS_Instruction<InstrImpl> {
+  struct Opcode : public OpcodeSet<OpPartOpcode<opcode>> {};
+  struct Fields : public FieldSet<RegRt, RegRs, ImmUnsigned16> {};
+};
+
+struct Andi : public Instr<Andi, MIPSISA::ANDI> {
+  constexpr static std::string_view NAME = "andi";
+};
+
+struct Ori : public Instr<Ori, MIPSISA::ORI> {
+  constexpr static std::string_view NAME = "ori";
+};
+
+struct Xori : public Instr<Xori, MIPSISA::XORI> {
+  constexpr static std::string_view NAME = "xori";
+};
+
+} // namespace TypeIU
+
+struct Lui : public MIPS_Instruction<Lui> {
+  struct Opcode
+      : public OpcodeSet<OpPartOpcode<MIPSISA::LUI>, OpPartZeroes<21, 25>> {};
+  struct Fields : public FieldSet<RegRt, ImmUnsigned16> {};
+
+  constexpr static std::string_view NAME = "lui";
+};
+
+namespace TypeL {
+
+/// A MIPS load or store of rt, at the address rs + a sign-extended immediate
+template <typename InstrImpl, Opcode opcode>
+struct Instr : public MIPS_Instruction<InstrImpl> {
+  struct Opcode : public OpcodeSet<OpPartOpcode<opcode>> {};
+  struct Fields : public FieldSet<RegRt, ImmSigned16, RegRs> {};
+};
+
+struct Lb : public Instr<Lb, MIPSISA::LB> {
+  constexpr static std::string_view NAME = "lb";
+};
+
+struct Lbu : public Instr<Lbu, MIPSISA::LBU> {
+  constexpr static std::string_view NAME = "lbu";
+};
+
+struct Lh : public Instr<Lh, MIPSISA::LH> {
+  constexpr static std::string_view NAME = "lh";
+};
+
+struct Lhu : public Instr<Lhu, MIPSISA::LHU> {
+  constexpr static std::string_view NAME = "lhu";
+};
+
+struct Lw : public Instr<Lw, MIPSISA::LW> {
+  constexpr static std::string_view NAME = "lw";
+};
+
+struct Sb : public Instr<Sb, MIPSISA::SB> {
+  constexpr static std::string_view NAME = "sb";
+};
+
+struct Sh : public Instr<Sh, MIPSISA::SH> {
+  constexpr static std::string_view NAME = "sh";
+};
+
+struct Sw : public Instr<Sw, MIPSISA::SW> {
+  constexpr static std::string_view NAME = "sw";
+};
+
+} // namespace TypeL
+
+namespace TypeB {
+
+/// A MIPS branch comparing rs and rt
+template <typename InstrImpl, Opcode opcode>
+struct Instr : public MIPS_Instruction<InstrImpl> {
+  struct Opcode : public OpcodeSet<OpPartOpcode<opcode>> {};
+  struct Fields : public FieldSet<RegRs, RegRt, ImmBranch> {};
+};
+
+struct Beq : public Instr<Beq, MIPSISA::BEQ> {
+  constexpr static std::string_view NAME = "beq";
+};
+
+struct Bne : public Instr<Bne, MIPSISA::BNE> {
+  constexpr static std::string_view NAME = "bne";
+};
+
+} // namespace TypeB
+
+namespace TypeBZ {
+
+/// A MIPS branch comparing rs against zero
+template <typename InstrImpl, Opcode opcode>
+struct Instr : public MIPS_Instruction<InstrImpl> {
+  struct Opcode
+      : public OpcodeSet<OpPartOpcode<opcode>, OpPartZeroes<16, 20>> {};
+  struct Fields : public FieldSet<RegRs, ImmBranch> {};
+};
+
+struct Blez : public Instr<Blez, MIPSISA::BLEZ> {
+  constexpr static std::string_view NAME = "blez";
+};
+
+struct Bgtz : public Instr<Bgtz, MIPSISA::BGTZ> {
+  constexpr static std::string_view NAME = "bgtz";
+};
+
+/// A REGIMM branch comparing rs against zero, selected by the rt field
+template <typename InstrImpl, RegImm rt>
+struct RegImmInstr : public MIPS_Instruction<InstrImpl> {
+  struct Opcode : public OpcodeSet<OpPartOpcode<MIPSISA::BLTZ>,
+                                   OpPartRegImm<rt>> {};
+  struct Fields : public FieldSet<RegRs, ImmBranch> {};
+};
+
+struct Bltz : public RegImmInstr<Bltz, MIPSISA::RT_BLTZ> {
+  constexpr static std::string_view NAME = "bltz";
+};
+
+struct Bgez : public RegImmInstr<Bgez, MIPSISA::RT_BGEZ> {
+  constexpr static std::string_view NAME = "bgez";
+};
+
+} // namespace TypeBZ
+
+namespace TypeJ {
+
+/// A MIPS jump to a target within the region of the jump
+template <typename InstrImpl, Opcode opcode>
+struct Instr : public MIPS_Instruction<InstrImpl> {
+  struct Opcode : public OpcodeSet<OpPartOpcode<opcode>> {};
+  struct Fields : public FieldSet<ImmJump> {};
+};
+
+struct J : public Instr<J, MIPSISA::J> {
+  constexpr static std::string_view NAME = "j";
+};
+
+struct Jal : public Instr<Jal, MIPSISA::JAL> {
+  constexpr static std::string_view NAME = "jal";
+};
+
+} // namespace TypeJ
+
+namespace TypePseudo {
+
+template <unsigned tokenIndex>
+struct PseudoReg : public Ripes::PseudoReg<tokenIndex, MIPS_GPRInfo> {};
+
+struct Nop : public PseudoInstruction<Nop> {
+  struct Fields : public FieldSet<> {};
+
+  static Result<std::vector<LineTokens>>
+  expander(const PseudoInstruction<Nop> &, const TokenizedSrcLine &,
+           const SymbolMap &) {
+    LineTokensVec v;
+    v.push_back(LineTokens{Token("sll"), Token("$zero"), Token("$zero"),
+                           Token("0")});
+    return v;
+  }
+  constexpr static std::string_view NAME = "nop";
+};
+
+struct Move : public PseudoInstruction<Move> {
+  struct Fields : public FieldSet<PseudoReg, PseudoReg> {};
+
+  static Result<std::vector<LineTokens>>
+  expander(const PseudoInstruction<Move> &, const TokenizedSrcLine &line,
+           const SymbolMap &) {
+    LineTokensVec v;
+    v.push_back(LineTokens{Token("addu"), line.tokens.at(1), Token("$zero"),
+                           line.tokens.at(2)});
+    return v;
+  }
+  constexpr static std::string_view NAME = "move";
+};
+
+/// Loads a 32-bit constant in one instruction if it fits in the immediate of
+/// addiu or ori, else through lui and ori.
+struct Li : public PseudoInstruction<Li> {
+  struct Fields : public FieldSet<PseudoReg, PseudoImm> {};
+
+  static Result<std::vector<LineTokens>>
+  expander(const PseudoInstruction<Li> &, const TokenizedSrcLine &line,
+           const SymbolMap &) {
+    bool canConvert;
+    const int64_t immediate =
+        getImmediateSext32(line.tokens.at(2), canConvert);
+    if (!canConvert) {
+      return Result<std::vector<LineTokens>>{Error(
+          line, QString("Invalid immediate '%1'").arg(line.tokens.at(2)))};
+    }
+
+    const Token &rt = line.tokens.at(1);
+    LineTokensVec v;
+    if (isInt(16, immediate)) {
+      v.push_back(LineTokens{Token("addiu"), rt, Token("$zero"),
+                             Token(QString::number(immediate))});
+    } else if (isUInt(16, immediate)) {
+      v.push_back(LineTokens{Token("ori"), rt, Token("$zero"),
+                             Token(QString::number(immediate))});
+    } else {
+      const uint32_t value = static_cast<uint32_t>(immediate);
+      v.push_back(
+          LineTokens{Token("lui"), rt, Token(QString::number(value >> 16))});
+      v.push_back(LineTokens{Token("ori"), rt, rt,
+                             Token(QString::number(value & 0xFFFF))});
+    }
+    return v;
+  }
+  constexpr static std::string_view NAME = "li";
+};
+
+struct La : public PseudoInstruction<La> {
+  struct Fields : public FieldSet<PseudoReg, PseudoImm> {};
+
+  static Result<std::vector<LineTokens>>
+  expander(const PseudoInstruction<La> &, const TokenizedSrcLine &line,
+           const SymbolMap &) {
+    LineTokensVec v;
+    v.push_back(LineTokens{Token("lui"), line.tokens.at(1),
+                           Token(line.tokens.at(2), "%hi")});
+    v.push_back(LineTokens{Token("ori"), line.tokens.at(1), line.tokens.at(1),
+                           Token(line.tokens.at(2), "%lo")});
+    return v;
+  }
+  constexpr static std::string_view NAME = "la";
+};
+
+struct B : public PseudoInstruction<B> {
+  struct Fields : public FieldSet<PseudoImm> {};
+
+  static Result<std::vector<LineTokens>>
+  expander(const PseudoInstruction<B> &, const TokenizedSrcLine &line,
+           const SymbolMap &) {
+    LineTokensVec v;
+    v.push_back(LineTokens{Token("beq"), Token("$zero"), Token("$zero"),
+                           line.tokens.at(1)});
+    return v;
+  }
+  constexpr static std::string_view NAME = "b";
+};
+
+/// A branch comparing rs against zero, through beq or bne
+template <typename PseudoInstrImpl>
+struct PseudoInstrBZ : public PseudoInstruction<PseudoInstrImpl> {
+  struct Fields : public FieldSet<PseudoReg, PseudoImm> {};
+
+  static Result<std::vector<LineTokens>>
+  expander(const PseudoInstruction<PseudoInstrImpl> &,
+           const TokenizedSrcLine &line, const SymbolMap &) {
+    LineTokensVec v;
+    v.push_back(LineTokens{Token(PseudoInstrImpl::BRANCH.data()),
+                           line.tokens.at(1), Token("$zero"),
+                           line.tokens.at(2)});
+    return v;
+  }
+};
+
+struct Beqz : public PseudoInstrBZ<Beqz> {
+  constexpr static std::string_view NAME = "beqz";
+  constexpr static std::string_view BRANCH = "beq";
+};
+
+struct Bnez : public PseudoInstrBZ<Bnez> {
+  constexpr static std::string_view NAME = "bnez";
+  constexpr static std::string_view BRANCH = "bne";
+};
+
+/// A branch comparing rs and rt, through slt into the assembler temporary
+/// register $at. If SWAP, rt is compared as less than rs; the branch is taken
+/// if the comparison equals TAKEN.
+template <typename PseudoInstrImpl>
+struct PseudoInstrBCmp : public PseudoInstruction<PseudoInstrImpl> {
+  struct Fields : public FieldSet<PseudoReg, PseudoReg, PseudoImm> {};
+
+  static Result<std::vector<LineTokens>>
+  expander(const PseudoInstruction<PseudoInstrImpl> &,
+           const TokenizedSrcLine &line, const SymbolMap &) {
+    const Token &rs = line.tokens.at(PseudoInstrImpl::SWAP ? 2 : 1);
+    const Token &rt = line.tokens.at(PseudoInstrImpl::SWAP ? 1 : 2);
+    LineTokensVec v;
+    v.push_back(LineTokens{Token("slt"), Token("$at"), rs, rt});
+    v.push_back(LineTokens{Token(PseudoInstrImpl::TAKEN ? "bne" : "beq"),
+                           Token("$at"), Token("$zero"), line.tokens.at(3)});
+    return v;
+  }
+};
+
+struct Blt : public PseudoInstrBCmp<Blt> {
+  constexpr static std::string_view NAME = "blt";
+  constexpr static bool SWAP = false;
+  constexpr static bool TAKEN = true;
+};
+
+struct Bgt : public PseudoInstrBCmp<Bgt> {
+  constexpr static std::string_view NAME = "bgt";
+  constexpr static bool SWAP = true;
+  constexpr static bool TAKEN = true;
+};
+
+struct Ble : public PseudoInstrBCmp<Ble> {
+  constexpr static std::string_view NAME = "ble";
+  constexpr static bool SWAP = true;
+  constexpr static bool TAKEN = false;
+};
+
+struct Bge : public PseudoInstrBCmp<Bge> {
+  constexpr static std::string_view NAME = "bge";
+  constexpr static bool SWAP = false;
+  constexpr static bool TAKEN = false;
+};
+
+} // namespace TypePseudo
+
+} // namespace ExtI
+
+} // namespace MIPSISA
+} // namespace Ripes
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "elfio/elf_types.hpp"
+#include "instruction.h"
 #include "isainfo.h"
+#include "mipsrelocations.h"
 
 #include <QDebug>
 
@@ -134,6 +136,16 @@ enum Function {
   SYSCALL = 0b001100
 };
 
+/// Values of the rt field which select the REGIMM branches (opcode BLTZ/BGEZ).
+enum RegImm { RT_BLTZ = 0b00000, RT_BGEZ = 0b00001 };
+
+constexpr unsigned INSTR_BITS = 32;
+
+template <typename InstrImpl>
+struct MIPS_Instruction : public Instruction<InstrImpl> {
+  constexpr static unsigned instrBits() { return INSTR_BITS; }
+};
+
 constexpr std::string_view GPR = "gpr";
 constexpr std::string_view GPR_DESC = "General purpose registers";
 
@@ -178,6 +190,60 @@ struct MIPS_GPRInfo : public RegFileInfoInterface {
   }
 };
 
+/// The fields of the MIPS instruction formats. The functional model decodes
+/// the operands of an instruction through the same ranges (see MIPSISS).
+using RangeOpcode = BitRange<26, 31>;
+using RangeRs = BitRange<21, 25>;
+using RangeRt = BitRange<16, 20>;
+using RangeRd = BitRange<11, 15>;
+using RangeShamt = BitRange<6, 10>;
+using RangeFunct = BitRange<0, 5>;
+using RangeImm = BitRange<0, 15>;
+using RangeTarget = BitRange<0, 25>;
+
+/// All MIPS opcodes are defined as a 6-bit field in bits 26-31 of the
+/// instruction
+template <Opcode opcode>
+struct OpPartOpcode
+    : public OpPart<static_cast<unsigned>(opcode), RangeOpcode> {};
+
+/// The function of R-type instructions is defined as a 6-bit field in bits 0-5
+/// of the instruction
+template <Function funct>
+struct OpPartFunct : public OpPart<static_cast<unsigned>(funct), RangeFunct> {};
+
+/// The REGIMM branches are selected by the rt field
+template <RegImm rt>
+struct OpPartRegImm : public OpPart<static_cast<unsigned>(rt), RangeRt> {};
+
+template <typename RegImpl, unsigned tokenIndex, typename Range>
+struct GPR_Reg : public Reg<RegImpl, tokenIndex, Range, MIPS_GPRInfo> {};
+
+/// The MIPS rs field contains a source register index.
+template <unsigned tokenIndex>
+struct RegRs : public GPR_Reg<RegRs<tokenIndex>, tokenIndex, RangeRs> {
+  constexpr static std::string_view NAME = "rs";
+};
+
+/// The MIPS rt field contains a source register index, or the destination
+/// register index of I-type instructions.
+template <unsigned tokenIndex>
+struct RegRt : public GPR_Reg<RegRt<tokenIndex>, tokenIndex, RangeRt> {
+  constexpr static std::string_view NAME = "rt";
+};
+
+/// The MIPS rd field contains the destination register index of R-type
+/// instructions.
+template <unsigned tokenIndex>
+struct RegRd : public GPR_Reg<RegRd<tokenIndex>, tokenIndex, RangeRd> {
+  constexpr static std::string_view NAME = "rd";
+};
+
+namespace ExtI {
+void enableExt(const ISAInfoBase *isa, InstrVec &instructions,
+               PseudoInstrVec &pseudoInstructions);
+}
+
 } // namespace MIPSISA
 
 class MIPS_ISAInfoBase : public ISAInfoBase {
@@ -194,7 +260,8 @@ public:
   MIPS_ISAInfoBase() {
     m_regInfos[MIPSISA::GPR] = std::make_unique<MIPSISA::MIPS_GPRInfo>();
 
-    // TODO: Setup MIPS instructions here
+    // Setup relocations
+    m_relocations = mipsRelocations();
   }
 
   const RegInfoMap &regInfoMap() const override { return m_regInfos; }
@@ -244,6 +311,11 @@ public:
   const RelocationsVec &relocations() const override { return m_relocations; }
 
 protected:
+  /// Make sure to call this in any child class's constructor
+  void initialize() {
+    MIPSISA::ExtI::enableExt(this, m_instructions, m_pseudoInstructions);
+  }
+
   QStringList m_enabledExtensions;
   QStringList m_supportedExtensions = getSupportedExtensions();
   RegInfoMap m_regInfos;
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "isa/isa_defines.h"
+
+namespace Ripes {
+
+inline Relocation mips_hi() {
+  return Relocation(
+      "%hi",
+      [](const Reg_T val, const Reg_T /*reloc_addr*/) -> HandleRelocationRes {
+        return {val >> 16 & 0xFFFF};
+      });
+}
+
+inline Relocation mips_lo() {
+  return Relocation(
+      "%lo",
+      [](const Reg_T val, const Reg_T /*reloc_addr*/) -> HandleRelocationRes {
+        return {val & 0xFFFF};
+      });
+}
+
+/** @brief
+ * A collection of MIPS assembler relocations. The lower half of an address is
+ * combined with its upper half through ori, which zero-extends its immediate,
+ * such that %hi needs no adjustment for the sign of %lo.
+ */
+
+inline RelocationsVec mipsRelocations() {
+  RelocationsVec relocations;
+
+  relocations.push_back(std::make_shared<Relocation>(mips_hi()));
+  relocations.push_back(std::make_shared<Relocation>(mips_lo()));
+
+  return relocations;
+}
+} // namespace Ripes
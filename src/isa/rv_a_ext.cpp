@@ -0,0 +1,21 @@
+#include "rv_a_ext.h"
+namespace Ripes {
+namespace RVISA {
+namespace ExtA {
+
+void enableExt(const ISAInfoBase *isa, InstrVec &instructions,
+               PseudoInstrVec &) {
+  using namespace TypeAMO;
+
+  enableInstructions<LrW, ScW, AmoswapW, AmoaddW, AmoxorW, AmoandW, AmoorW,
+                     AmominW, AmomaxW, AmominuW, AmomaxuW>(instructions);
+
+  if (isa->bits() == 64) {
+    enableInstructions<LrD, ScD, AmoswapD, AmoaddD, AmoxorD, AmoandD, AmoorD,
+                       AmominD, AmomaxD, AmominuD, AmomaxuD>(instructions);
+  }
+}
+
+} // namespace ExtA
+} // namespace RVISA
+} // namespace Ripes
@@ -0,0 +1,158 @@
+#pragma once
+
+#include "pseudoinstruction.h"
+#include "rv_i_ext.h"
+#include "rvisainfo_common.h"
+
+namespace Ripes {
+namespace RVISA {
+
+namespace ExtA {
+
+namespace TypeAMO {
+
+enum class Funct3 { W = 0b010, D = 0b011 };
+
+enum class Funct5 {
+  LR = 0b00010,
+  SC = 0b00011,
+  AMOSWAP = 0b00001,
+  AMOADD = 0b00000,
+  AMOXOR = 0b00100,
+  AMOAND = 0b01100,
+  AMOOR = 0b01000,
+  AMOMIN = 0b10000,
+  AMOMAX = 0b10100,
+  AMOMINU = 0b11000,
+  AMOMAXU = 0b11100
+};
+
+/// All RISC-V Funct5 opcode parts of atomic instructions are defined as a
+/// 5-bit field in bits 27-31 of the instruction
+template <unsigned funct5>
+struct OpPartFunct5 : public OpPart<funct5, BitRange<27, 31>> {};
+
+/// An atomic RISC-V instruction. The acquire and release ordering bits (aq/rl)
+/// are not supported by the assembler, and are always zero.
+template <typename InstrImpl, Funct3 funct3, Funct5 funct5>
+struct Instr : public RV_Instruction<InstrImpl> {
+  struct Opcode
+      : public OpcodeSet<OpPartOpcode<RVISA::OpcodeID::AMO>,
+                         OpPartFunct3<static_cast<unsigned>(funct3)>,
+                         OpPartZeroes<25, 26>,
+                         OpPartFunct5<static_cast<unsigned>(funct5)>> {};
+  // amo{op} rd, rs2, (rs1)
+  struct Fields : public FieldSet<RegRd, RegRs2, RegRs1> {};
+};
+
+/// Load-reserved instructions have no rs2 operand.
+template <typename InstrImpl, Funct3 funct3>
+struct InstrLR : public RV_Instruction<InstrImpl> {
+  struct Opcode
+      : public OpcodeSet<OpPartOpcode<RVISA::OpcodeID::AMO>,
+                         OpPartFunct3<static_cast<unsigned>(funct3)>,
+                         OpPartZeroes<20, 26>,
+                         OpPartFunct5<static_cast<unsigned>(Funct5::LR)>> {};
+  // lr rd, (rs1)
+  struct Fields : public FieldSet<RegRd, RegRs1> {};
+};
+
+template <typename InstrImpl, Funct5 funct5>
+using Instr32 = Instr<InstrImpl, Funct3::W, funct5>;
+template <typename InstrImpl, Funct5 funct5>
+using Instr64 = Instr<InstrImpl, Funct3::D, funct5>;
+
+struct LrW : public InstrLR<LrW, Funct3::W> {
+  constexpr static std::string_view NAME = "lr.w";
+};
+
+struct ScW : public Instr32<ScW, Funct5::SC> {
+  constexpr static std::string_view NAME = "sc.w";
+};
+
+struct AmoswapW : public Instr32<AmoswapW, Funct5::AMOSWAP> {
+  constexpr static std::string_view NAME = "amoswap.w";
+};
+
+struct AmoaddW : public Instr32<AmoaddW, Funct5::AMOADD> {
+  constexpr static std::string_view NAME = "amoadd.w";
+};
+
+struct AmoxorW : public Instr32<AmoxorW, Funct5::AMOXOR> {
+  constexpr static std::string_view NAME = "amoxor.w";
+};
+
+struct AmoandW : public Instr32<AmoandW, Funct5::AMOAND> {
+  constexpr static std::string_view NAME = "amoand.w";
+};
+
+struct AmoorW : public Instr32<AmoorW, Funct5::AMOOR> {
+  constexpr static std::string_view NAME = "amoor.w";
+};
+
+struct AmominW : public Instr32<AmominW, Funct5::AMOMIN> {
+  constexpr static std::string_view NAME = "amomin.w";
+};
+
+struct AmomaxW : public Instr32<AmomaxW, Funct5::AMOMAX> {
+  constexpr static std::string_view NAME = "amomax.w";
+};
+
+struct AmominuW : public Instr32<AmominuW, Funct5::AMOMINU> {
+  constexpr static std::string_view NAME = "amominu.w";
+};
+
+struct AmomaxuW : public Instr32<AmomaxuW, Funct5::AMOMAXU> {
+  constexpr static std::string_view NAME = "amomaxu.w";
+};
+
+struct LrD : public InstrLR<LrD, Funct3::D> {
+  constexpr static std::string_view NAME = "lr.d";
+};
+
+struct ScD : public Instr64<ScD, Funct5::SC> {
+  constexpr static std::string_view NAME = "sc.d";
+};
+
+struct AmoswapD : public Instr64<AmoswapD, Funct5::AMOSWAP> {
+  constexpr static std::string_view NAME = "amoswap.d";
+};
+
+struct AmoaddD : public Instr64<AmoaddD, Funct5::AMOADD> {
+  constexpr static std::string_view NAME = "amoadd.d";
+};
+
+struct AmoxorD : public Instr64<AmoxorD, Funct5::AMOXOR> {
+  constexpr static std::string_view NAME = "amoxor.d";
+};
+
+struct AmoandD : public Instr64<AmoandD, Funct5::AMOAND> {
+  constexpr static std::string_view NAME = "amoand.d";
+};
+
+struct AmoorD : public Instr64<AmoorD, Funct5::AMOOR> {
+  constexpr static std::string_view NAME = "amoor.d";
+};
+
+struct AmominD : public Instr64<AmominD, Funct5::AMOMIN> {
+  constexpr static std::string_view NAME = "amomin.d";
+};
+
+struct AmomaxD : public Instr64<AmomaxD, Funct5::AMOMAX> {
+  constexpr static std::string_view NAME = "amomax.d";
+};
+
+struct AmominuD : public Instr64<AmominuD, Funct5::AMOMINU> {
+  constexpr static std::string_view NAME = "amominu.d";
+};
+
+struct AmomaxuD : public Instr64<AmomaxuD, Funct5::AMOMAXU> {
+  constexpr static std::string_view NAME = "amomaxu.d";
+};
+
+} // namespace TypeAMO
+
+} // namespace ExtA
+
+} // namespace RVISA
+} // namespace Ripes
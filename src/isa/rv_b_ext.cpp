@@ -0,0 +1,52 @@
+#include "rv_b_ext.h"
+namespace Ripes {
+namespace RVISA {
+
+namespace ExtZba {
+
+void enableExt(const ISAInfoBase *isa, InstrVec &instructions,
+               PseudoInstrVec &) {
+  enableInstructions<Sh1add, Sh2add, Sh3add>(instructions);
+
+  if (isa->bits() == 64) {
+    enableInstructions<AddUw, Sh1addUw, Sh2addUw, Sh3addUw, SlliUw>(
+        instructions);
+  }
+}
+
+} // namespace ExtZba
+
+namespace ExtZbb {
+
+void enableExt(const ISAInfoBase *isa, InstrVec &instructions,
+               PseudoInstrVec &) {
+  enableInstructions<Andn, Orn, Xnor, Min, Minu, Max, Maxu, Rol, Ror, Clz,
+                     Ctz, Cpop, SextB, SextH, OrcB>(instructions);
+
+  if (isa->bits() == 32) {
+    enableInstructions<Rori32, Rev8_32, ZextH32>(instructions);
+  } else {
+    enableInstructions<Rori64, Rev8_64, ZextH64, Clzw, Ctzw, Cpopw, Rolw, Rorw,
+                       Roriw>(instructions);
+  }
+}
+
+} // namespace ExtZbb
+
+namespace ExtZbs {
+
+void enableExt(const ISAInfoBase *isa, InstrVec &instructions,
+               PseudoInstrVec &) {
+  enableInstructions<Bclr, Bext, Binv, Bset>(instructions);
+
+  if (isa->bits() == 32) {
+    enableInstructions<Bclri32, Bexti32, Binvi32, Bseti32>(instructions);
+  } else {
+    enableInstructions<Bclri64, Bexti64, Binvi64, Bseti64>(instructions);
+  }
+}
+
+} // namespace ExtZbs
+
+} // namespace RVISA
+} // namespace Ripes
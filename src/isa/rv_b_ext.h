@@ -0,0 +1,307 @@
+#pragma once
+
+#include "pseudoinstruction.h"
+#include "rv_i_ext.h"
+#include "rvisainfo_common.h"
+
+namespace Ripes {
+namespace RVISA {
+
+/// Encodings shared by the bit-manipulation extensions Zba, Zbb and Zbs.
+namespace ExtB {
+
+/// An R-Type bit-manipulation instruction.
+template <typename InstrImpl, OpcodeID opcodeID, unsigned funct3,
+          unsigned funct7>
+struct TypeR : public RV_Instruction<InstrImpl> {
+  struct Opcode : public OpcodeSet<OpPartOpcode<opcodeID>,
+                                   OpPartFunct3<funct3>, OpPartFunct7<funct7>> {
+  };
+  struct Fields : public FieldSet<RegRd, RegRs1, RegRs2> {};
+};
+
+/// A unary bit-manipulation instruction, for which the rs2 field (bits 20-24)
+/// selects the operation.
+template <typename InstrImpl, OpcodeID opcodeID, unsigned funct3,
+          unsigned funct7, unsigned funct5>
+struct TypeUnary : public RV_Instruction<InstrImpl> {
+  struct Opcode
+      : public OpcodeSet<OpPartOpcode<opcodeID>, OpPartFunct3<funct3>,
+                         OpPartFunct7<funct7>,
+                         OpPart<funct5, BitRange<20, 24>>> {};
+  struct Fields : public FieldSet<RegRd, RegRs1> {};
+};
+
+/// A unary bit-manipulation instruction, for which the immediate field (bits
+/// 20-31) selects the operation.
+template <typename InstrImpl, unsigned funct3, unsigned funct12>
+struct TypeUnary12 : public RV_Instruction<InstrImpl> {
+  struct Opcode : public OpcodeSet<OpPartOpcode<OpcodeID::OPIMM>,
+                                   OpPartFunct3<funct3>,
+                                   OpPart<funct12, BitRange<20, 31>>> {};
+  struct Fields : public FieldSet<RegRd, RegRs1> {};
+};
+
+/// A bit-manipulation instruction with a 5-bit shift amount, as used by RV32
+/// and by the 32-bit word variants of RV64.
+template <typename InstrImpl, OpcodeID opcodeID, unsigned funct3,
+          unsigned funct7>
+struct TypeIShift32 : public RV_Instruction<InstrImpl> {
+  struct Opcode : public OpcodeSet<OpPartOpcode<opcodeID>,
+                                   OpPartFunct3<funct3>, OpPartFunct7<funct7>> {
+  };
+  struct Fields
+      : public FieldSet<RegRd, RegRs1, ExtI::TypeIShift::ImmIShift32> {};
+};
+
+/// A bit-manipulation instruction with a 6-bit shift amount, as used by RV64.
+template <typename InstrImpl, OpcodeID opcodeID, unsigned funct3,
+          unsigned funct6>
+struct TypeIShift64 : public RV_Instruction<InstrImpl> {
+  struct Opcode : public OpcodeSet<OpPartOpcode<opcodeID>,
+                                   OpPartFunct3<funct3>, OpPartFunct6<funct6>> {
+  };
+  struct Fields
+      : public FieldSet<RegRd, RegRs1, ExtI::TypeIShift64::ImmIShift64> {};
+};
+
+} // namespace ExtB
+
+/// Address generation instructions.
+namespace ExtZba {
+
+constexpr unsigned SHADD = 0b0010000;
+constexpr unsigned ADDUW = 0b0000100;
+constexpr unsigned SLLIUW = 0b000010;
+
+struct Sh1add : public ExtB::TypeR<Sh1add, OpcodeID::OP, 0b010, SHADD> {
+  constexpr static std::string_view NAME = "sh1add";
+};
+
+struct Sh2add : public ExtB::TypeR<Sh2add, OpcodeID::OP, 0b100, SHADD> {
+  constexpr static std::string_view NAME = "sh2add";
+};
+
+struct Sh3add : public ExtB::TypeR<Sh3add, OpcodeID::OP, 0b110, SHADD> {
+  constexpr static std::string_view NAME = "sh3add";
+};
+
+struct AddUw : public ExtB::TypeR<AddUw, OpcodeID::OP32, 0b000, ADDUW> {
+  constexpr static std::string_view NAME = "add.uw";
+};
+
+struct Sh1addUw : public ExtB::TypeR<Sh1addUw, OpcodeID::OP32, 0b010, SHADD> {
+  constexpr static std::string_view NAME = "sh1add.uw";
+};
+
+struct Sh2addUw : public ExtB::TypeR<Sh2addUw, OpcodeID::OP32, 0b100, SHADD> {
+  constexpr static std::string_view NAME = "sh2add.uw";
+};
+
+struct Sh3addUw : public ExtB::TypeR<Sh3addUw, OpcodeID::OP32, 0b110, SHADD> {
+  constexpr static std::string_view NAME = "sh3add.uw";
+};
+
+struct SlliUw
+    : public ExtB::TypeIShift64<SlliUw, OpcodeID::OPIMM32, 0b001, SLLIUW> {
+  constexpr static std::string_view NAME = "slli.uw";
+};
+
+} // namespace ExtZba
+
+/// Basic bit-manipulation instructions.
+namespace ExtZbb {
+
+constexpr unsigned NEGATE = 0b0100000;
+constexpr unsigned MINMAX = 0b0000101;
+constexpr unsigned ROTATE = 0b0110000;
+constexpr unsigned ZEXT = 0b0000100;
+
+struct Andn : public ExtB::TypeR<Andn, OpcodeID::OP, 0b111, NEGATE> {
+  constexpr static std::string_view NAME = "andn";
+};
+
+struct Orn : public ExtB::TypeR<Orn, OpcodeID::OP, 0b110, NEGATE> {
+  constexpr static std::string_view NAME = "orn";
+};
+
+struct Xnor : public ExtB::TypeR<Xnor, OpcodeID::OP, 0b100, NEGATE> {
+  constexpr static std::string_view NAME = "xnor";
+};
+
+struct Min : public ExtB::TypeR<Min, OpcodeID::OP, 0b100, MINMAX> {
+  constexpr static std::string_view NAME = "min";
+};
+
+struct Minu : public ExtB::TypeR<Minu, OpcodeID::OP, 0b101, MINMAX> {
+  constexpr static std::string_view NAME = "minu";
+};
+
+struct Max : public ExtB::TypeR<Max, OpcodeID::OP, 0b110, MINMAX> {
+  constexpr static std::string_view NAME = "max";
+};
+
+struct Maxu : public ExtB::TypeR<Maxu, OpcodeID::OP, 0b111, MINMAX> {
+  constexpr static std::string_view NAME = "maxu";
+};
+
+struct Rol : public ExtB::TypeR<Rol, OpcodeID::OP, 0b001, ROTATE> {
+  constexpr static std::string_view NAME = "rol";
+};
+
+struct Ror : public ExtB::TypeR<Ror, OpcodeID::OP, 0b101, ROTATE> {
+  constexpr static std::string_view NAME = "ror";
+};
+
+struct Clz : public ExtB::TypeUnary<Clz, OpcodeID::OPIMM, 0b001, ROTATE, 0> {
+  constexpr static std::string_view NAME = "clz";
+};
+
+struct Ctz : public ExtB::TypeUnary<Ctz, OpcodeID::OPIMM, 0b001, ROTATE, 1> {
+  constexpr static std::string_view NAME = "ctz";
+};
+
+struct Cpop : public ExtB::TypeUnary<Cpop, OpcodeID::OPIMM, 0b001, ROTATE, 2> {
+  constexpr static std::string_view NAME = "cpop";
+};
+
+struct SextB
+    : public ExtB::TypeUnary<SextB, OpcodeID::OPIMM, 0b001, ROTATE, 4> {
+  constexpr static std::string_view NAME = "sext.b";
+};
+
+struct SextH
+    : public ExtB::TypeUnary<SextH, OpcodeID::OPIMM, 0b001, ROTATE, 5> {
+  constexpr static std::string_view NAME = "sext.h";
+};
+
+struct OrcB : public ExtB::TypeUnary12<OrcB, 0b101, 0b001010000111> {
+  constexpr static std::string_view NAME = "orc.b";
+};
+
+struct Rori32
+    : public ExtB::TypeIShift32<Rori32, OpcodeID::OPIMM, 0b101, ROTATE> {
+  constexpr static std::string_view NAME = "rori";
+};
+
+struct Rev8_32 : public ExtB::TypeUnary12<Rev8_32, 0b101, 0b011010011000> {
+  constexpr static std::string_view NAME = "rev8";
+};
+
+/// zext.h is encoded on OP in RV32, and on OP32 in RV64.
+template <typename InstrImpl, OpcodeID opcodeID>
+using ZextHInstr = ExtB::TypeUnary<InstrImpl, opcodeID, 0b100, ZEXT, 0>;
+
+struct ZextH32 : public ZextHInstr<ZextH32, OpcodeID::OP> {
+  constexpr static std::string_view NAME = "zext.h";
+};
+
+struct ZextH64 : public ZextHInstr<ZextH64, OpcodeID::OP32> {
+  constexpr static std::string_view NAME = "zext.h";
+};
+
+struct Rori64
+    : public ExtB::TypeIShift64<Rori64, OpcodeID::OPIMM, 0b101, (ROTATE >> 1)> {
+  constexpr static std::string_view NAME = "rori";
+};
+
+struct Rev8_64 : public ExtB::TypeUnary12<Rev8_64, 0b101, 0b011010111000> {
+  constexpr static std::string_view NAME = "rev8";
+};
+
+struct Clzw
+    : public ExtB::TypeUnary<Clzw, OpcodeID::OPIMM32, 0b001, ROTATE, 0> {
+  constexpr static std::string_view NAME = "clzw";
+};
+
+struct Ctzw
+    : public ExtB::TypeUnary<Ctzw, OpcodeID::OPIMM32, 0b001, ROTATE, 1> {
+  constexpr static std::string_view NAME = "ctzw";
+};
+
+struct Cpopw
+    : public ExtB::TypeUnary<Cpopw, OpcodeID::OPIMM32, 0b001, ROTATE, 2> {
+  constexpr static std::string_view NAME = "cpopw";
+};
+
+struct Rolw : public ExtB::TypeR<Rolw, OpcodeID::OP32, 0b001, ROTATE> {
+  constexpr static std::string_view NAME = "rolw";
+};
+
+struct Rorw : public ExtB::TypeR<Rorw, OpcodeID::OP32, 0b101, ROTATE> {
+  constexpr static std::string_view NAME = "rorw";
+};
+
+struct Roriw
+    : public ExtB::TypeIShift32<Roriw, OpcodeID::OPIMM32, 0b101, ROTATE> {
+  constexpr static std::string_view NAME = "roriw";
+};
+
+} // namespace ExtZbb
+
+/// Single-bit instructions.
+namespace ExtZbs {
+
+constexpr unsigned BCLR = 0b0100100;
+constexpr unsigned BINV = 0b0110100;
+constexpr unsigned BSET = 0b0010100;
+
+struct Bclr : public ExtB::TypeR<Bclr, OpcodeID::OP, 0b001, BCLR> {
+  constexpr static std::string_view NAME = "bclr";
+};
+
+struct Bext : public ExtB::TypeR<Bext, OpcodeID::OP, 0b101, BCLR> {
+  constexpr static std::string_view NAME = "bext";
+};
+
+struct Binv : public ExtB::TypeR<Binv, OpcodeID::OP, 0b001, BINV> {
+  constexpr static std::string_view NAME = "binv";
+};
+
+struct Bset : public ExtB::TypeR<Bset, OpcodeID::OP, 0b001, BSET> {
+  constexpr static std::string_view NAME = "bset";
+};
+
+/// The immediate forms, with a 5-bit (RV32) or 6-bit (RV64) bit index.
+template <typename InstrImpl, unsigned funct3, unsigned funct7>
+using Imm32 = ExtB::TypeIShift32<InstrImpl, OpcodeID::OPIMM, funct3, funct7>;
+template <typename InstrImpl, unsigned funct3, unsigned funct7>
+using Imm64 =
+    ExtB::TypeIShift64<InstrImpl, OpcodeID::OPIMM, funct3, (funct7 >> 1)>;
+
+struct Bclri32 : public Imm32<Bclri32, 0b001, BCLR> {
+  constexpr static std::string_view NAME = "bclri";
+};
+
+struct Bexti32 : public Imm32<Bexti32, 0b101, BCLR> {
+  constexpr static std::string_view NAME = "bexti";
+};
+
+struct Binvi32 : public Imm32<Binvi32, 0b001, BINV> {
+  constexpr static std::string_view NAME = "binvi";
+};
+
+struct Bseti32 : public Imm32<Bseti32, 0b001, BSET> {
+  constexpr static std::string_view NAME = "bseti";
+};
+
+struct Bclri64 : public Imm64<Bclri64, 0b001, BCLR> {
+  constexpr static std::string_view NAME = "bclri";
+};
+
+struct Bexti64 : public Imm64<Bexti64, 0b101, BCLR> {
+  constexpr static std::string_view NAME = "bexti";
+};
+
+struct Binvi64 : public Imm64<Binvi64, 0b001, BINV> {
+  constexpr static std::string_view NAME = "binvi";
+};
+
+struct Bseti64 : public Imm64<Bseti64, 0b001, BSET> {
+  constexpr static std::string_view NAME = "bseti";
+};
+
+} // namespace ExtZbs
+
+} // namespace RVISA
+} // namespace Ripes
@@ -0,0 +1,47 @@
+#include "rv_custom_ext.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace Ripes {
+namespace RVISA {
+namespace ExtCustom {
+
+static std::vector<CustomInstruction> &registry() {
+  static std::vector<CustomInstruction> instructions;
+  return instructions;
+}
+
+const std::vector<CustomInstruction> &instructions() { return registry(); }
+
+int find(Instr_T instr) {
+  const auto &instructions = registry();
+  for (unsigned i = 0; i < instructions.size(); ++i)
+    if (instructions[i].matches(instr))
+      return i;
+  return -1;
+}
+
+unsigned registerInstruction(CustomInstruction instruction) {
+  auto &instructions = registry();
+  [[maybe_unused]] const bool overlaps = std::any_of(
+      instructions.begin(), instructions.end(), [&](const auto &other) {
+        // Two encodings overlap if they agree in the bits fixed by both.
+        return ((instruction.opcodeValue ^ other.opcodeValue) &
+                instruction.opcodeMask & other.opcodeMask) == 0;
+      });
+  assert(!overlaps && "Custom instruction encodings overlap");
+  assert(isCustomOpcode(instruction.opcodeValue & 0x7F) &&
+         "Custom instructions are encoded in the custom opcodes");
+  instructions.push_back(std::move(instruction));
+  return instructions.size() - 1;
+}
+
+void enableExt(const ISAInfoBase *, InstrVec &instructions, PseudoInstrVec &) {
+  for (const auto &instruction : registry())
+    instructions.emplace_back(instruction.create());
+}
+
+} // namespace ExtCustom
+} // namespace RVISA
+} // namespace Ripes
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <functional>
+
+#include "pseudoinstruction.h"
+#include "rv_i_ext.h"
+#include "rvisainfo_common.h"
+
+namespace Ripes {
+namespace RVISA {
+
+/**
+ * Custom instructions, modelling accelerators attached to the core. Custom
+ * instructions are encoded in the custom-0..3 opcodes reserved by the RISC-V
+ * specification, and are defined like the instructions of the standard
+ * extensions, through the encodings of TypeR and TypeI:
+ *
+ *   struct Mac : public ExtCustom::TypeR::Instr<Mac, OpcodeID::CUSTOM0, 0, 0> {
+ *     constexpr static std::string_view NAME = "mac";
+ *   };
+ *   ExtCustom::registerInstruction<Mac>(
+ *       [](const ExtCustom::Operands &ops) { return ops.rs1 * ops.rs2; },
+ *       {4, 1});
+ *
+ * Registered instructions are enabled in every RISC-V ISA constructed after
+ * their registration, and are thereby assembled and disassembled as any other
+ * instruction. They must therefore be registered before the first ISA is
+ * constructed; ISAs are constructed once per set of extensions, and are
+ * shared (see ISAInfoRegistry).
+ *
+ * The functional and timing processor models execute a custom instruction
+ * through its semantics, writing the returned value to rd, and time it in a
+ * functional unit of its own (see Timing).
+ */
+namespace ExtCustom {
+
+/// Returns whether @p opcode is one of the opcodes reserved for custom
+/// extensions.
+constexpr bool isCustomOpcode(unsigned opcode) {
+  return opcode == OpcodeID::CUSTOM0 || opcode == OpcodeID::CUSTOM1 ||
+         opcode == OpcodeID::CUSTOM2 || opcode == OpcodeID::CUSTOM3;
+}
+
+namespace TypeR {
+
+/// A custom instruction with the operands rd, rs1 and rs2.
+template <typename InstrImpl, OpcodeID opcodeID, unsigned funct3,
+          unsigned funct7>
+struct Instr : public RV_Instruction<InstrImpl> {
+  static_assert(isCustomOpcode(opcodeID),
+                "Custom instructions are encoded in the custom opcodes");
+  constexpr static bool readsRs2 = true;
+  struct Opcode
+      : public OpcodeSet<OpPartOpcode<opcodeID>, OpPartFunct3<funct3>,
+                         OpPartFunct7<funct7>> {};
+  struct Fields : public FieldSet<RegRd, RegRs1, RegRs2> {};
+};
+
+} // namespace TypeR
+
+namespace TypeI {
+
+/// A custom instruction with the operands rd, rs1 and a 12-bit signed
+/// immediate.
+template <typename InstrImpl, OpcodeID opcodeID, unsigned funct3>
+struct Instr : public RV_Instruction<InstrImpl> {
+  static_assert(isCustomOpcode(opcodeID),
+                "Custom instructions are encoded in the custom opcodes");
+  constexpr static bool readsRs2 = false;
+  struct Opcode
+      : public OpcodeSet<OpPartOpcode<opcodeID>, OpPartFunct3<funct3>> {};
+  struct Fields : public FieldSet<RegRd, RegRs1, ExtI::ImmCommon12> {};
+};
+
+} // namespace TypeI
+
+/// The operands of an executed custom instruction. Register values are
+/// zero-extended from XLEN bits, and the immediate of a TypeI instruction is
+/// sign-extended. Operands not encoded by the instruction are 0.
+struct Operands {
+  VInt rs1 = 0;
+  VInt rs2 = 0;
+  VIntS imm = 0;
+  // The address of the instruction.
+  VInt pc = 0;
+  unsigned xlen = 32;
+};
+
+/// Computes the value written to rd, truncated to XLEN bits.
+using Semantics = std::function<VInt(const Operands &)>;
+
+/// Timing of the functional unit of a custom instruction, with the meaning of
+/// FunctionalUnitTiming: the latency is the number of cycles until the result
+/// is available, and the interval the number of cycles before the unit
+/// accepts the next instruction.
+struct Timing {
+  unsigned latency = 1;
+  unsigned interval = 1;
+};
+
+struct CustomInstruction {
+  QString name;
+  Instr_T opcodeMask = 0;
+  Instr_T opcodeValue = 0;
+  bool readsRs2 = false;
+  Semantics semantics;
+  Timing timing;
+  std::function<std::shared_ptr<InstructionBase>()> create;
+
+  bool matches(Instr_T instr) const {
+    return (instr & opcodeMask) == opcodeValue;
+  }
+};
+
+/// Returns the registered custom instructions, in order of registration.
+const std::vector<CustomInstruction> &instructions();
+
+/// Returns the index of the registered custom instruction encoded by
+/// @p instr, or -1 if none matches.
+int find(Instr_T instr);
+
+/// Registers @p instruction and returns its index. The encoding of a custom
+/// instruction may not overlap the encoding of a registered instruction.
+unsigned registerInstruction(CustomInstruction instruction);
+
+/// Registers the custom instruction InstrImpl, executing with @p semantics in
+/// a functional unit timed by @p timing, and returns its index.
+template <typename InstrImpl>
+unsigned registerInstruction(Semantics semantics, Timing timing = {}) {
+  CustomInstruction instruction;
+  instruction.name = QString(InstrImpl::NAME.data());
+  instruction.opcodeMask = InstrImpl::opcodeMaskImpl;
+  instruction.opcodeValue = InstrImpl::opcodeValueImpl;
+  instruction.readsRs2 = InstrImpl::readsRs2;
+  instruction.semantics = std::move(semantics);
+  instruction.timing = timing;
+  instruction.create = [] { return std::make_shared<InstrImpl>(); };
+  return registerInstruction(std::move(instruction));
+}
+
+} // namespace ExtCustom
+} // namespace RVISA
+} // namespace Ripes
@@ -0,0 +1,55 @@
+#include "rv_f_ext.h"
+namespace Ripes {
+namespace RVISA {
+
+namespace ExtF {
+
+void enableExt(const ISAInfoBase *isa, InstrVec &instructions,
+               PseudoInstrVec &pseudoInstructions) {
+  enableInstructions<Flw, Fsw, FmaddS, FmsubS, FnmsubS, FnmaddS, FaddS, FsubS,
+                     FmulS, FdivS, FsqrtS, FsgnjS, FsgnjnS, FsgnjxS, FminS,
+                     FmaxS, FeqS, FltS, FleS, FcvtWS, FcvtWuS, FcvtSW, FcvtSWu,
+                     FmvXW, FclassS, FmvWX>(instructions);
+  // The floating-point CSRs are accessed through the Zicsr instructions,
+  // which are implied by F.
+  enableInstructions<ExtZicsr::Csrrw, ExtZicsr::Csrrs, ExtZicsr::Csrrc,
+                     ExtZicsr::Csrrwi, ExtZicsr::Csrrsi, ExtZicsr::Csrrci>(
+      instructions);
+
+  if (isa->bits() == 64) {
+    enableInstructions<FcvtLS, FcvtLuS, FcvtSL, FcvtSLu>(instructions);
+  }
+
+  using namespace ExtFD::TypePseudo;
+  enablePseudoInstructions<
+      ExtFD::TypePseudo::Flw, ExtFD::TypePseudo::Fsw, FmvS, FnegS, FabsS,
+      FmvXS, FmvSX, Csrr, Csrw, Csrs, Csrc, Csrwi, Csrsi, Csrci, Frcsr, Frsr,
+      Frrm, Frflags, Fscsr, Fssr, Fsrm, Fsflags, Fsrmi, Fsflagsi>(
+      pseudoInstructions);
+}
+
+} // namespace ExtF
+
+namespace ExtD {
+
+void enableExt(const ISAInfoBase *isa, InstrVec &instructions,
+               PseudoInstrVec &pseudoInstructions) {
+  enableInstructions<Fld, Fsd, FmaddD, FmsubD, FnmsubD, FnmaddD, FaddD, FsubD,
+                     FmulD, FdivD, FsqrtD, FsgnjD, FsgnjnD, FsgnjxD, FminD,
+                     FmaxD, FeqD, FltD, FleD, FcvtSD, FcvtDS, FcvtWD, FcvtWuD,
+                     FcvtDW, FcvtDWu, FclassD>(instructions);
+
+  if (isa->bits() == 64) {
+    enableInstructions<FcvtLD, FcvtLuD, FcvtDL, FcvtDLu, FmvXD, FmvDX>(
+        instructions);
+  }
+
+  using namespace ExtFD::TypePseudo;
+  enablePseudoInstructions<ExtFD::TypePseudo::Fld, ExtFD::TypePseudo::Fsd,
+                           FmvD, FnegD, FabsD>(pseudoInstructions);
+}
+
+} // namespace ExtD
+
+} // namespace RVISA
+} // namespace Ripes
@@ -0,0 +1,800 @@
+#pragma once
+
+#include "pseudoinstruction.h"
+#include "rv_i_ext.h"
+#include "rvisainfo_common.h"
+
+namespace Ripes {
+namespace RVISA {
+
+/// Encodings shared by the single- (F) and double-precision (D)
+/// floating-point extensions, and the subset of the Zicsr extension through
+/// which the floating-point control and status registers are accessed.
+namespace ExtFD {
+
+template <typename RegImpl, unsigned tokenIndex, typename Range>
+struct FPR_Reg : public Reg<RegImpl, tokenIndex, Range, RV_FPRInfo> {};
+
+/// The floating-point destination register, in bits 7-11 of the instruction.
+template <unsigned tokenIndex>
+struct RegFd : public FPR_Reg<RegFd<tokenIndex>, tokenIndex, BitRange<7, 11>> {
+  constexpr static std::string_view NAME = "fd";
+};
+
+/// The first floating-point source register, in bits 15-19 of the
+/// instruction.
+template <unsigned tokenIndex>
+struct RegFs1
+    : public FPR_Reg<RegFs1<tokenIndex>, tokenIndex, BitRange<15, 19>> {
+  constexpr static std::string_view NAME = "fs1";
+};
+
+/// The second floating-point source register, in bits 20-24 of the
+/// instruction.
+template <unsigned tokenIndex>
+struct RegFs2
+    : public FPR_Reg<RegFs2<tokenIndex>, tokenIndex, BitRange<20, 24>> {
+  constexpr static std::string_view NAME = "fs2";
+};
+
+/// The third floating-point source register of fused multiply-adds, in bits
+/// 27-31 of the instruction.
+template <unsigned tokenIndex>
+struct RegFs3
+    : public FPR_Reg<RegFs3<tokenIndex>, tokenIndex, BitRange<27, 31>> {
+  constexpr static std::string_view NAME = "fs3";
+};
+
+/// The rounding modes of the rm field. Dynamic rounding uses the rounding mode
+/// of the frm register.
+enum class RoundingMode : unsigned {
+  RNE = 0b000,
+  RTZ = 0b001,
+  RDN = 0b010,
+  RUP = 0b011,
+  RMM = 0b100,
+  DYN = 0b111
+};
+
+/**
+ * @brief RoundingModeField
+ * The rounding mode (rm) field, in bits 12-14 of the instruction. It is
+ * written as an optional last token (rne, rtz, rdn, rup, rmm or dyn), and
+ * defaults to dynamic rounding, which is not shown when disassembling.
+ */
+template <unsigned tokenIndex>
+struct RoundingModeField
+    : public Field<tokenIndex, BitRangeSet<BitRange<12, 14>>> {
+  using Range = BitRange<12, 14>;
+
+  static const QStringList &names() {
+    static const QStringList c_names = {"rne", "rtz", "rdn", "rup",
+                                        "rmm", "",    "",    "dyn"};
+    return c_names;
+  }
+
+  static Result<> apply(const TokenizedSrcLine &line, Instr_T &instruction,
+                        FieldLinkRequest &) {
+    unsigned rm = static_cast<unsigned>(RoundingMode::DYN);
+    if (tokenIndex + 1 < line.tokens.size()) {
+      const QString token = line.tokens.at(tokenIndex + 1).toLower();
+      const int index = names().indexOf(token);
+      if (token.isEmpty() || index < 0)
+        return Error(line, "Invalid rounding mode '" + token + "'");
+      rm = index;
+    }
+    instruction |= Range().apply(rm);
+    return Result<>::def();
+  }
+
+  static bool decode(const Instr_T instruction, const Reg_T,
+                     const ReverseSymbolMap &, LineTokens &line) {
+    const unsigned rm = Range().decode(instruction);
+    if (rm == static_cast<unsigned>(RoundingMode::DYN))
+      return true;
+    // Reserved rounding modes are shown as their value.
+    line.push_back(names().at(rm).isEmpty() ? QString::number(rm)
+                                            : names().at(rm));
+    return true;
+  }
+};
+
+/// The floating-point formats of the fmt field.
+enum class Fmt : unsigned { S = 0b00, D = 0b01 };
+
+enum class Funct5 : unsigned {
+  FADD = 0b00000,
+  FSUB = 0b00001,
+  FMUL = 0b00010,
+  FDIV = 0b00011,
+  FSGNJ = 0b00100,
+  FMINMAX = 0b00101,
+  FCVT_FMT = 0b01000,
+  FSQRT = 0b01011,
+  FCMP = 0b10100,
+  FCVT_INT = 0b11000,
+  FCVT_FROM_INT = 0b11010,
+  FMV_CLASS = 0b11100,
+  FMV_FROM_INT = 0b11110
+};
+
+/// OP-FP instructions are selected by funct5 (bits 27-31) and the format of
+/// their operands (bits 25-26), which together make up funct7.
+template <Funct5 funct5, Fmt fmt>
+struct OpPartFunct5Fmt
+    : public OpPartFunct7<(static_cast<unsigned>(funct5) << 2) |
+                          static_cast<unsigned>(fmt)> {};
+
+/// The format of the operands of fused multiply-adds, in bits 25-26.
+template <Fmt fmt>
+struct OpPartFmt
+    : public OpPart<static_cast<unsigned>(fmt), BitRange<25, 26>> {};
+
+/// Selects the operation of unary OP-FP instructions through the rs2 field
+/// (bits 20-24).
+template <unsigned rs2>
+struct OpPartRs2 : public OpPart<rs2, BitRange<20, 24>> {};
+
+/// The width field of floating-point loads and stores.
+enum class Width : unsigned { W = 0b010, D = 0b011 };
+
+/// A floating-point load.
+/// fl{w,d} fd, imm(rs1)
+template <typename InstrImpl, Width width>
+struct TypeLoad : public RV_Instruction<InstrImpl> {
+  struct Opcode
+      : public OpcodeSet<OpPartOpcode<RVISA::OpcodeID::LOADFP>,
+                         OpPartFunct3<static_cast<unsigned>(width)>> {};
+  struct Fields : public FieldSet<RegFd, ExtI::ImmCommon12, RegRs1> {};
+};
+
+/// A floating-point store.
+/// fs{w,d} fs2, imm(rs1)
+template <typename InstrImpl, Width width>
+struct TypeStore : public RV_Instruction<InstrImpl> {
+  struct Opcode
+      : public OpcodeSet<OpPartOpcode<RVISA::OpcodeID::STOREFP>,
+                         OpPartFunct3<static_cast<unsigned>(width)>> {};
+  struct Fields : public FieldSet<RegFs2, ExtI::TypeS::ImmS, RegRs1> {};
+};
+
+/// A fused multiply-add (R4-Type), selected by its opcode.
+/// f{n}m{add,sub}.fmt fd, fs1, fs2, fs3[, rm]
+template <typename InstrImpl, OpcodeID opcode, Fmt fmt>
+struct TypeR4 : public RV_Instruction<InstrImpl> {
+  struct Opcode : public OpcodeSet<OpPartOpcode<opcode>, OpPartFmt<fmt>> {};
+  struct Fields
+      : public FieldSet<RegFd, RegFs1, RegFs2, RegFs3, RoundingModeField> {};
+};
+
+/// A binary operation which is rounded.
+/// op.fmt fd, fs1, fs2[, rm]
+template <typename InstrImpl, Funct5 funct5, Fmt fmt>
+struct TypeR : public RV_Instruction<InstrImpl> {
+  struct Opcode : public OpcodeSet<OpPartOpcode<RVISA::OpcodeID::OPFP>,
+                                   OpPartFunct5Fmt<funct5, fmt>> {};
+  struct Fields : public FieldSet<RegFd, RegFs1, RegFs2, RoundingModeField> {};
+};
+
+/// A binary operation selected by funct3, writing the register @p Rd (a
+/// floating-point register, or an integer register for comparisons).
+/// op.fmt rd, fs1, fs2
+template <typename InstrImpl, Funct5 funct5, Fmt fmt, unsigned funct3,
+          template <unsigned> typename Rd = RegFd>
+struct TypeRFunct3 : public RV_Instruction<InstrImpl> {
+  struct Opcode : public OpcodeSet<OpPartOpcode<RVISA::OpcodeID::OPFP>,
+                                   OpPartFunct5Fmt<funct5, fmt>,
+                                   OpPartFunct3<funct3>> {};
+  struct Fields : public FieldSet<Rd, RegFs1, RegFs2> {};
+};
+
+/// A unary operation which is rounded, selected by rs2, such as square roots
+/// and conversions.
+/// op.fmt rd, rs1[, rm]
+template <typename InstrImpl, Funct5 funct5, Fmt fmt, unsigned rs2,
+          template <unsigned> typename Rd = RegFd,
+          template <unsigned> typename Rs1 = RegFs1>
+struct TypeUnary : public RV_Instruction<InstrImpl> {
+  struct Opcode : public OpcodeSet<OpPartOpcode<RVISA::OpcodeID::OPFP>,
+                                   OpPartFunct5Fmt<funct5, fmt>,
+                                   OpPartRs2<rs2>> {};
+  struct Fields : public FieldSet<Rd, Rs1, RoundingModeField> {};
+};
+
+/// A unary operation selected by rs2 and funct3, such as moves between the
+/// register files and classification.
+/// op.fmt rd, rs1
+template <typename InstrImpl, Funct5 funct5, Fmt fmt, unsigned funct3,
+          template <unsigned> typename Rd, template <unsigned> typename Rs1>
+struct TypeUnaryFunct3 : public RV_Instruction<InstrImpl> {
+  struct Opcode : public OpcodeSet<OpPartOpcode<RVISA::OpcodeID::OPFP>,
+                                   OpPartFunct5Fmt<funct5, fmt>, OpPartRs2<0>,
+                                   OpPartFunct3<funct3>> {};
+  struct Fields : public FieldSet<Rd, Rs1> {};
+};
+
+} // namespace ExtFD
+
+namespace ExtF {
+
+using namespace ExtFD;
+
+struct Flw : public TypeLoad<Flw, Width::W> {
+  constexpr static std::string_view NAME = "flw";
+};
+struct Fsw : public TypeStore<Fsw, Width::W> {
+  constexpr static std::string_view NAME = "fsw";
+};
+
+struct FmaddS : public TypeR4<FmaddS, OpcodeID::MADD, Fmt::S> {
+  constexpr static std::string_view NAME = "fmadd.s";
+};
+struct FmsubS : public TypeR4<FmsubS, OpcodeID::MSUB, Fmt::S> {
+  constexpr static std::string_view NAME = "fmsub.s";
+};
+struct FnmsubS : public TypeR4<FnmsubS, OpcodeID::NMSUB, Fmt::S> {
+  constexpr static std::string_view NAME = "fnmsub.s";
+};
+struct FnmaddS : public TypeR4<FnmaddS, OpcodeID::NMADD, Fmt::S> {
+  constexpr static std::string_view NAME = "fnmadd.s";
+};
+
+struct FaddS : public TypeR<FaddS, Funct5::FADD, Fmt::S> {
+  constexpr static std::string_view NAME = "fadd.s";
+};
+struct FsubS : public TypeR<FsubS, Funct5::FSUB, Fmt::S> {
+  constexpr static std::string_view NAME = "fsub.s";
+};
+struct FmulS : public TypeR<FmulS, Funct5::FMUL, Fmt::S> {
+  constexpr static std::string_view NAME = "fmul.s";
+};
+struct FdivS : public TypeR<FdivS, Funct5::FDIV, Fmt::S> {
+  constexpr static std::string_view NAME = "fdiv.s";
+};
+struct FsqrtS : public TypeUnary<FsqrtS, Funct5::FSQRT, Fmt::S, 0> {
+  constexpr static std::string_view NAME = "fsqrt.s";
+};
+
+struct FsgnjS : public TypeRFunct3<FsgnjS, Funct5::FSGNJ, Fmt::S, 0b000> {
+  constexpr static std::string_view NAME = "fsgnj.s";
+};
+struct FsgnjnS : public TypeRFunct3<FsgnjnS, Funct5::FSGNJ, Fmt::S, 0b001> {
+  constexpr static std::string_view NAME = "fsgnjn.s";
+};
+struct FsgnjxS : public TypeRFunct3<FsgnjxS, Funct5::FSGNJ, Fmt::S, 0b010> {
+  constexpr static std::string_view NAME = "fsgnjx.s";
+};
+struct FminS : public TypeRFunct3<FminS, Funct5::FMINMAX, Fmt::S, 0b000> {
+  constexpr static std::string_view NAME = "fmin.s";
+};
+struct FmaxS : public TypeRFunct3<FmaxS, Funct5::FMINMAX, Fmt::S, 0b001> {
+  constexpr static std::string_view NAME = "fmax.s";
+};
+
+struct FeqS : public TypeRFunct3<FeqS, Funct5::FCMP, Fmt::S, 0b010, RegRd> {
+  constexpr static std::string_view NAME = "feq.s";
+};
+struct FltS : public TypeRFunct3<FltS, Funct5::FCMP, Fmt::S, 0b001, RegRd> {
+  constexpr static std::string_view NAME = "flt.s";
+};
+struct FleS : public TypeRFunct3<FleS, Funct5::FCMP, Fmt::S, 0b000, RegRd> {
+  constexpr static std::string_view NAME = "fle.s";
+};
+
+struct FcvtWS : public TypeUnary<FcvtWS, Funct5::FCVT_INT, Fmt::S, 0, RegRd> {
+  constexpr static std::string_view NAME = "fcvt.w.s";
+};
+struct FcvtWuS
+    : public TypeUnary<FcvtWuS, Funct5::FCVT_INT, Fmt::S, 1, RegRd> {
+  constexpr static std::string_view NAME = "fcvt.wu.s";
+};
+struct FcvtLS : public TypeUnary<FcvtLS, Funct5::FCVT_INT, Fmt::S, 2, RegRd> {
+  constexpr static std::string_view NAME = "fcvt.l.s";
+};
+struct FcvtLuS
+    : public TypeUnary<FcvtLuS, Funct5::FCVT_INT, Fmt::S, 3, RegRd> {
+  constexpr static std::string_view NAME = "fcvt.lu.s";
+};
+struct FcvtSW : public TypeUnary<FcvtSW, Funct5::FCVT_FROM_INT, Fmt::S, 0,
+                                 RegFd, RegRs1> {
+  constexpr static std::string_view NAME = "fcvt.s.w";
+};
+struct FcvtSWu : public TypeUnary<FcvtSWu, Funct5::FCVT_FROM_INT, Fmt::S, 1,
+                                  RegFd, RegRs1> {
+  constexpr static std::string_view NAME = "fcvt.s.wu";
+};
+struct FcvtSL : public TypeUnary<FcvtSL, Funct5::FCVT_FROM_INT, Fmt::S, 2,
+                                 RegFd, RegRs1> {
+  constexpr static std::string_view NAME = "fcvt.s.l";
+};
+struct FcvtSLu : public TypeUnary<FcvtSLu, Funct5::FCVT_FROM_INT, Fmt::S, 3,
+                                  RegFd, RegRs1> {
+  constexpr static std::string_view NAME = "fcvt.s.lu";
+};
+
+struct FmvXW : public TypeUnaryFunct3<FmvXW, Funct5::FMV_CLASS, Fmt::S, 0b000,
+                                      RegRd, RegFs1> {
+  constexpr static std::string_view NAME = "fmv.x.w";
+};
+struct FclassS : public TypeUnaryFunct3<FclassS, Funct5::FMV_CLASS, Fmt::S,
+                                        0b001, RegRd, RegFs1> {
+  constexpr static std::string_view NAME = "fclass.s";
+};
+struct FmvWX : public TypeUnaryFunct3<FmvWX, Funct5::FMV_FROM_INT, Fmt::S,
+                                      0b000, RegFd, RegRs1> {
+  constexpr static std::string_view NAME = "fmv.w.x";
+};
+
+} // namespace ExtF
+
+namespace ExtD {
+
+using namespace ExtFD;
+
+struct Fld : public TypeLoad<Fld, Width::D> {
+  constexpr static std::string_view NAME = "fld";
+};
+struct Fsd : public TypeStore<Fsd, Width::D> {
+  constexpr static std::string_view NAME = "fsd";
+};
+
+struct FmaddD : public TypeR4<FmaddD, OpcodeID::MADD, Fmt::D> {
+  constexpr static std::string_view NAME = "fmadd.d";
+};
+struct FmsubD : public TypeR4<FmsubD, OpcodeID::MSUB, Fmt::D> {
+  constexpr static std::string_view NAME = "fmsub.d";
+};
+struct FnmsubD : public TypeR4<FnmsubD, OpcodeID::NMSUB, Fmt::D> {
+  constexpr static std::string_view NAME = "fnmsub.d";
+};
+struct FnmaddD : public TypeR4<FnmaddD, OpcodeID::NMADD, Fmt::D> {
+  constexpr static std::string_view NAME = "fnmadd.d";
+};
+
+struct FaddD : public TypeR<FaddD, Funct5::FADD, Fmt::D> {
+  constexpr static std::string_view NAME = "fadd.d";
+};
+struct FsubD : public TypeR<FsubD, Funct5::FSUB, Fmt::D> {
+  constexpr static std::string_view NAME = "fsub.d";
+};
+struct FmulD : public TypeR<FmulD, Funct5::FMUL, Fmt::D> {
+  constexpr static std::string_view NAME = "fmul.d";
+};
+struct FdivD : public TypeR<FdivD, Funct5::FDIV, Fmt::D> {
+  constexpr static std::string_view NAME = "fdiv.d";
+};
+struct FsqrtD : public TypeUnary<FsqrtD, Funct5::FSQRT, Fmt::D, 0> {
+  constexpr static std::string_view NAME = "fsqrt.d";
+};
+
+struct FsgnjD : public TypeRFunct3<FsgnjD, Funct5::FSGNJ, Fmt::D, 0b000> {
+  constexpr static std::string_view NAME = "fsgnj.d";
+};
+struct FsgnjnD : public TypeRFunct3<FsgnjnD, Funct5::FSGNJ, Fmt::D, 0b001> {
+  constexpr static std::string_view NAME = "fsgnjn.d";
+};
+struct FsgnjxD : public TypeRFunct3<FsgnjxD, Funct5::FSGNJ, Fmt::D, 0b010> {
+  constexpr static std::string_view NAME = "fsgnjx.d";
+};
+struct FminD : public TypeRFunct3<FminD, Funct5::FMINMAX, Fmt::D, 0b000> {
+  constexpr static std::string_view NAME = "fmin.d";
+};
+struct FmaxD : public TypeRFunct3<FmaxD, Funct5::FMINMAX, Fmt::D, 0b001> {
+  constexpr static std::string_view NAME = "fmax.d";
+};
+
+struct FeqD : public TypeRFunct3<FeqD, Funct5::FCMP, Fmt::D, 0b010, RegRd> {
+  constexpr static std::string_view NAME = "feq.d";
+};
+struct FltD : public TypeRFunct3<FltD, Funct5::FCMP, Fmt::D, 0b001, RegRd> {
+  constexpr static std::string_view NAME = "flt.d";
+};
+struct FleD : public TypeRFunct3<FleD, Funct5::FCMP, Fmt::D, 0b000, RegRd> {
+  constexpr static std::string_view NAME = "fle.d";
+};
+
+/// fcvt.s.d narrows a double (rs2 = D) to the single format.
+struct FcvtSD : public TypeUnary<FcvtSD, Funct5::FCVT_FMT, Fmt::S, 1> {
+  constexpr static std::string_view NAME = "fcvt.s.d";
+};
+/// fcvt.d.s widens a single (rs2 = S) to the double format.
+struct FcvtDS : public TypeUnary<FcvtDS, Funct5::FCVT_FMT, Fmt::D, 0> {
+  constexpr static std::string_view NAME = "fcvt.d.s";
+};
+
+struct FcvtWD : public TypeUnary<FcvtWD, Funct5::FCVT_INT, Fmt::D, 0, RegRd> {
+  constexpr static std::string_view NAME = "fcvt.w.d";
+};
+struct FcvtWuD
+    : public TypeUnary<FcvtWuD, Funct5::FCVT_INT, Fmt::D, 1, RegRd> {
+  constexpr static std::string_view NAME = "fcvt.wu.d";
+};
+struct FcvtLD : public TypeUnary<FcvtLD, Funct5::FCVT_INT, Fmt::D, 2, RegRd> {
+  constexpr static std::string_view NAME = "fcvt.l.d";
+};
+struct FcvtLuD
+    : public TypeUnary<FcvtLuD, Funct5::FCVT_INT, Fmt::D, 3, RegRd> {
+  constexpr static std::string_view NAME = "fcvt.lu.d";
+};
+struct FcvtDW : public TypeUnary<FcvtDW, Funct5::FCVT_FROM_INT, Fmt::D, 0,
+                                 RegFd, RegRs1> {
+  constexpr static std::string_view NAME = "fcvt.d.w";
+};
+struct FcvtDWu : public TypeUnary<FcvtDWu, Funct5::FCVT_FROM_INT, Fmt::D, 1,
+                                  RegFd, RegRs1> {
+  constexpr static std::string_view NAME = "fcvt.d.wu";
+};
+struct FcvtDL : public TypeUnary<FcvtDL, Funct5::FCVT_FROM_INT, Fmt::D, 2,
+                                 RegFd, RegRs1> {
+  constexpr static std::string_view NAME = "fcvt.d.l";
+};
+struct FcvtDLu : public TypeUnary<FcvtDLu, Funct5::FCVT_FROM_INT, Fmt::D, 3,
+                                  RegFd, RegRs1> {
+  constexpr static std::string_view NAME = "fcvt.d.lu";
+};
+
+struct FclassD : public TypeUnaryFunct3<FclassD, Funct5::FMV_CLASS, Fmt::D,
+                                        0b001, RegRd, RegFs1> {
+  constexpr static std::string_view NAME = "fclass.d";
+};
+struct FmvXD : public TypeUnaryFunct3<FmvXD, Funct5::FMV_CLASS, Fmt::D, 0b000,
+                                      RegRd, RegFs1> {
+  constexpr static std::string_view NAME = "fmv.x.d";
+};
+struct FmvDX : public TypeUnaryFunct3<FmvDX, Funct5::FMV_FROM_INT, Fmt::D,
+                                      0b000, RegFd, RegRs1> {
+  constexpr static std::string_view NAME = "fmv.d.x";
+};
+
+} // namespace ExtD
+
+/// The instructions of the Zicsr extension, which are enabled with the
+/// floating-point extensions to access their control and status registers.
+namespace ExtZicsr {
+
+/// The floating-point control and status registers.
+enum class CSR : unsigned { FFLAGS = 0x001, FRM = 0x002, FCSR = 0x003 };
+
+/**
+ * @brief CSRField
+ * The address of a control and status register, in bits 20-31 of the
+ * instruction, written either as the name of a floating-point CSR (fflags, frm
+ * or fcsr) or as a 12-bit number.
+ */
+template <unsigned tokenIndex>
+struct CSRField : public Field<tokenIndex, BitRangeSet<BitRange<20, 31>>> {
+  using Range = BitRange<20, 31>;
+
+  static const QStringList &names() {
+    static const QStringList c_names = {"", "fflags", "frm", "fcsr"};
+    return c_names;
+  }
+
+  static Result<> apply(const TokenizedSrcLine &line, Instr_T &instruction,
+                        FieldLinkRequest &) {
+    if (tokenIndex + 1 >= line.tokens.size()) {
+      return Error(line, "Required field 'csr' (index " +
+                             QString::number(tokenIndex) + ") not provided");
+    }
+    const QString &token = line.tokens.at(tokenIndex + 1);
+    unsigned csr = 0;
+    if (const int index = names().indexOf(token.toLower()); index > 0) {
+      csr = index;
+    } else {
+      bool isNumber = false;
+      csr = token.toUInt(&isNumber, 0);
+      if (!isNumber || !isUInt(12, csr))
+        return Error(line, "Invalid CSR '" + token + "'");
+    }
+    instruction |= Range().apply(csr);
+    return Result<>::def();
+  }
+
+  static bool decode(const Instr_T instruction, const Reg_T,
+                     const ReverseSymbolMap &, LineTokens &line) {
+    const unsigned csr = Range().decode(instruction);
+    line.push_back(csr != 0 && csr < static_cast<unsigned>(names().size())
+                       ? names().at(csr)
+                       : "0x" + QString::number(csr, 16));
+    return true;
+  }
+};
+
+/// The unsigned 5-bit immediate of the immediate CSR instructions, in bits
+/// 15-19.
+template <unsigned tokenIndex>
+struct UImmCSR
+    : public Imm<tokenIndex, 5, Repr::Unsigned, ImmPart<0, 15, 19>> {};
+
+/// csr{rw,rs,rc} rd, csr, rs1
+template <typename InstrImpl, unsigned funct3>
+struct TypeCSR : public RV_Instruction<InstrImpl> {
+  struct Opcode : public OpcodeSet<OpPartOpcode<RVISA::OpcodeID::SYSTEM>,
+                                   OpPartFunct3<funct3>> {};
+  struct Fields : public FieldSet<RegRd, CSRField, RegRs1> {};
+};
+
+/// csr{rw,rs,rc}i rd, csr, uimm
+template <typename InstrImpl, unsigned funct3>
+struct TypeCSRImm : public RV_Instruction<InstrImpl> {
+  struct Opcode : public OpcodeSet<OpPartOpcode<RVISA::OpcodeID::SYSTEM>,
+                                   OpPartFunct3<funct3>> {};
+  struct Fields : public FieldSet<RegRd, CSRField, UImmCSR> {};
+};
+
+struct Csrrw : public TypeCSR<Csrrw, 0b001> {
+  constexpr static std::string_view NAME = "csrrw";
+};
+struct Csrrs : public TypeCSR<Csrrs, 0b010> {
+  constexpr static std::string_view NAME = "csrrs";
+};
+struct Csrrc : public TypeCSR<Csrrc, 0b011> {
+  constexpr static std::string_view NAME = "csrrc";
+};
+struct Csrrwi : public TypeCSRImm<Csrrwi, 0b101> {
+  constexpr static std::string_view NAME = "csrrwi";
+};
+struct Csrrsi : public TypeCSRImm<Csrrsi, 0b110> {
+  constexpr static std::string_view NAME = "csrrsi";
+};
+struct Csrrci : public TypeCSRImm<Csrrci, 0b111> {
+  constexpr static std::string_view NAME = "csrrci";
+};
+
+} // namespace ExtZicsr
+
+namespace ExtFD {
+namespace TypePseudo {
+
+template <unsigned tokenIndex>
+struct PseudoFReg : public Ripes::PseudoReg<tokenIndex, RV_FPRInfo> {};
+template <unsigned tokenIndex>
+using PseudoReg = ExtI::TypePseudo::PseudoReg<tokenIndex>;
+
+/// Loads and stores of symbols, through an integer register holding the upper
+/// bits of the address of the symbol (fl{w,d} fd, symbol, rt).
+template <typename PseudoInstrImpl>
+using PseudoInstrMemory = ExtI::TypePseudo::PseudoInstrStore<PseudoInstrImpl>;
+
+struct Flw : public PseudoInstrMemory<Flw> {
+  constexpr static std::string_view NAME = "flw";
+};
+struct Fsw : public PseudoInstrMemory<Fsw> {
+  constexpr static std::string_view NAME = "fsw";
+};
+struct Fld : public PseudoInstrMemory<Fld> {
+  constexpr static std::string_view NAME = "fld";
+};
+struct Fsd : public PseudoInstrMemory<Fsd> {
+  constexpr static std::string_view NAME = "fsd";
+};
+
+/// A sign-injection of a register with itself, as by moves (fsgnj), negations
+/// (fsgnjn) and absolute values (fsgnjx).
+/// op fd, fs
+template <typename PseudoInstrImpl>
+struct PseudoInstrSgnj : public PseudoInstruction<PseudoInstrImpl> {
+  struct Fields : public FieldSet<PseudoFReg, PseudoFReg> {};
+
+  static Result<std::vector<LineTokens>>
+  expander(const PseudoInstruction<PseudoInstrImpl> &,
+           const TokenizedSrcLine &line, const SymbolMap &) {
+    LineTokensVec v;
+    v.push_back(LineTokens()
+                << Token(PseudoInstrImpl::INSTR.data()) << line.tokens.at(1)
+                << line.tokens.at(2) << line.tokens.at(2));
+    return v;
+  }
+};
+
+struct FmvS : public PseudoInstrSgnj<FmvS> {
+  constexpr static std::string_view NAME = "fmv.s";
+  constexpr static std::string_view INSTR = "fsgnj.s";
+};
+struct FnegS : public PseudoInstrSgnj<FnegS> {
+  constexpr static std::string_view NAME = "fneg.s";
+  constexpr static std::string_view INSTR = "fsgnjn.s";
+};
+struct FabsS : public PseudoInstrSgnj<FabsS> {
+  constexpr static std::string_view NAME = "fabs.s";
+  constexpr static std::string_view INSTR = "fsgnjx.s";
+};
+struct FmvD : public PseudoInstrSgnj<FmvD> {
+  constexpr static std::string_view NAME = "fmv.d";
+  constexpr static std::string_view INSTR = "fsgnj.d";
+};
+struct FnegD : public PseudoInstrSgnj<FnegD> {
+  constexpr static std::string_view NAME = "fneg.d";
+  constexpr static std::string_view INSTR = "fsgnjn.d";
+};
+struct FabsD : public PseudoInstrSgnj<FabsD> {
+  constexpr static std::string_view NAME = "fabs.d";
+  constexpr static std::string_view INSTR = "fsgnjx.d";
+};
+
+/// The former names of fmv.x.w and fmv.w.x.
+/// op rd, rs
+template <typename PseudoInstrImpl>
+struct PseudoInstrAlias : public PseudoInstruction<PseudoInstrImpl> {
+  struct Fields : public FieldSet<PseudoReg, PseudoReg> {};
+
+  static Result<std::vector<LineTokens>>
+  expander(const PseudoInstruction<PseudoInstrImpl> &,
+           const TokenizedSrcLine &line, const SymbolMap &) {
+    LineTokensVec v;
+    v.push_back(LineTokens() << Token(PseudoInstrImpl::INSTR.data())
+                             << line.tokens.at(1) << line.tokens.at(2));
+    return v;
+  }
+};
+
+struct FmvXS : public PseudoInstrAlias<FmvXS> {
+  constexpr static std::string_view NAME = "fmv.x.s";
+  constexpr static std::string_view INSTR = "fmv.x.w";
+};
+struct FmvSX : public PseudoInstrAlias<FmvSX> {
+  constexpr static std::string_view NAME = "fmv.s.x";
+  constexpr static std::string_view INSTR = "fmv.w.x";
+};
+
+/// Reads a CSR.
+/// op rd
+template <typename PseudoInstrImpl>
+struct PseudoInstrCSRRead : public PseudoInstruction<PseudoInstrImpl> {
+  struct Fields : public FieldSet<PseudoReg> {};
+
+  static Result<std::vector<LineTokens>>
+  expander(const PseudoInstruction<PseudoInstrImpl> &,
+           const TokenizedSrcLine &line, const SymbolMap &) {
+    LineTokensVec v;
+    v.push_back(LineTokens()
+                << Token("csrrs") << line.tokens.at(1)
+                << Token(PseudoInstrImpl::CSR.data()) << Token("x0"));
+    return v;
+  }
+};
+
+/**
+ * @brief PseudoInstrCSRSwap
+ * Writes a CSR through the instruction PseudoInstrImpl::INSTR (csrrw or
+ * csrrwi), optionally reading its former value into a register.
+ * op [rd,] src
+ */
+template <typename PseudoInstrImpl>
+struct PseudoInstrCSRSwap : public PseudoInstruction<PseudoInstrImpl> {
+  struct Fields : public FieldSet<PseudoReg, PseudoReg> {};
+
+  Result<std::vector<LineTokens>> expand(const TokenizedSrcLine &line,
+                                         SymbolMap &symbols) const override {
+    if (line.tokens.length() != 2 && line.tokens.length() != 3) {
+      return Error(line, "Instruction '" + this->name() +
+                             "' expects 1 or 2 arguments, but got " +
+                             QString::number(line.tokens.length() - 1));
+    }
+    return expander(*this, line, symbols);
+  }
+
+  static Result<std::vector<LineTokens>>
+  expander(const PseudoInstruction<PseudoInstrImpl> &,
+           const TokenizedSrcLine &line, const SymbolMap &) {
+    const bool readsCSR = line.tokens.length() == 3;
+    LineTokensVec v;
+    v.push_back(LineTokens()
+                << Token(PseudoInstrImpl::INSTR.data())
+                << (readsCSR ? line.tokens.at(1) : Token("x0"))
+                << Token(PseudoInstrImpl::CSR.data())
+                << line.tokens.at(readsCSR ? 2 : 1));
+    return v;
+  }
+};
+
+/// Sets, clears or writes a CSR without reading it.
+/// op csr, src
+template <typename PseudoInstrImpl>
+struct PseudoInstrCSRWrite : public PseudoInstruction<PseudoInstrImpl> {
+  struct Fields : public FieldSet<PseudoReg, PseudoReg> {};
+
+  static Result<std::vector<LineTokens>>
+  expander(const PseudoInstruction<PseudoInstrImpl> &,
+           const TokenizedSrcLine &line, const SymbolMap &) {
+    LineTokensVec v;
+    v.push_back(LineTokens() << Token(PseudoInstrImpl::INSTR.data())
+                             << Token("x0") << line.tokens.at(1)
+                             << line.tokens.at(2));
+    return v;
+  }
+};
+
+/// csrr rd, csr
+struct Csrr : public PseudoInstruction<Csrr> {
+  struct Fields : public FieldSet<PseudoReg, PseudoReg> {};
+
+  static Result<std::vector<LineTokens>>
+  expander(const PseudoInstruction<Csrr> &, const TokenizedSrcLine &line,
+           const SymbolMap &) {
+    LineTokensVec v;
+    v.push_back(LineTokens() << Token("csrrs") << line.tokens.at(1)
+                             << line.tokens.at(2) << Token("x0"));
+    return v;
+  }
+  constexpr static std::string_view NAME = "csrr";
+};
+
+struct Csrw : public PseudoInstrCSRWrite<Csrw> {
+  constexpr static std::string_view NAME = "csrw";
+  constexpr static std::string_view INSTR = "csrrw";
+};
+struct Csrs : public PseudoInstrCSRWrite<Csrs> {
+  constexpr static std::string_view NAME = "csrs";
+  constexpr static std::string_view INSTR = "csrrs";
+};
+struct Csrc : public PseudoInstrCSRWrite<Csrc> {
+  constexpr static std::string_view NAME = "csrc";
+  constexpr static std::string_view INSTR = "csrrc";
+};
+struct Csrwi : public PseudoInstrCSRWrite<Csrwi> {
+  constexpr static std::string_view NAME = "csrwi";
+  constexpr static std::string_view INSTR = "csrrwi";
+};
+struct Csrsi : public PseudoInstrCSRWrite<Csrsi> {
+  constexpr static std::string_view NAME = "csrsi";
+  constexpr static std::string_view INSTR = "csrrsi";
+};
+struct Csrci : public PseudoInstrCSRWrite<Csrci> {
+  constexpr static std::string_view NAME = "csrci";
+  constexpr static std::string_view INSTR = "csrrci";
+};
+
+struct Frcsr : public PseudoInstrCSRRead<Frcsr> {
+  constexpr static std::string_view NAME = "frcsr";
+  constexpr static std::string_view CSR = "fcsr";
+};
+struct Frsr : public PseudoInstrCSRRead<Frsr> {
+  constexpr static std::string_view NAME = "frsr";
+  constexpr static std::string_view CSR = "fcsr";
+};
+struct Frrm : public PseudoInstrCSRRead<Frrm> {
+  constexpr static std::string_view NAME = "frrm";
+  constexpr static std::string_view CSR = "frm";
+};
+struct Frflags : public PseudoInstrCSRRead<Frflags> {
+  constexpr static std::string_view NAME = "frflags";
+  constexpr static std::string_view CSR = "fflags";
+};
+
+struct Fscsr : public PseudoInstrCSRSwap<Fscsr> {
+  constexpr static std::string_view NAME = "fscsr";
+  constexpr static std::string_view INSTR = "csrrw";
+  constexpr static std::string_view CSR = "fcsr";
+};
+struct Fssr : public PseudoInstrCSRSwap<Fssr> {
+  constexpr static std::string_view NAME = "fssr";
+  constexpr static std::string_view INSTR = "csrrw";
+  constexpr static std::string_view CSR = "fcsr";
+};
+struct Fsrm : public PseudoInstrCSRSwap<Fsrm> {
+  constexpr static std::string_view NAME = "fsrm";
+  constexpr static std::string_view INSTR = "csrrw";
+  constexpr static std::string_view CSR = "frm";
+};
+struct Fsflags : public PseudoInstrCSRSwap<Fsflags> {
+  constexpr static std::string_view NAME = "fsflags";
+  constexpr static std::string_view INSTR = "csrrw";
+  constexpr static std::string_view CSR = "fflags";
+};
+struct Fsrmi : public PseudoInstrCSRSwap<Fsrmi> {
+  constexpr static std::string_view NAME = "fsrmi";
+  constexpr static std::string_view INSTR = "csrrwi";
+  constexpr static std::string_view CSR = "frm";
+};
+struct Fsflagsi : public PseudoInstrCSRSwap<Fsflagsi> {
+  constexpr static std::string_view NAME = "fsflagsi";
+  constexpr static std::string_view INSTR = "csrrwi";
+  constexpr static std::string_view CSR = "fflags";
+};
+
+} // namespace TypePseudo
+} // namespace ExtFD
+
+} // namespace RVISA
+} // namespace Ripes
@@ -1022,12 +1022,11 @@ struct Li : public PseudoInstruction<Li<isRV64>> {
     int64_t immediate = getImmediateSext32(line.tokens.at(2), canConvert);
 
     if (!canConvert) {
-      auto absSymbols = symbols.copyRelativeTo(line.sourceLine());
       // Check if the immediate has been made available in the symbol set
       // at this point...
-      auto it = absSymbols.find(line.tokens.at(2));
-      if (it != absSymbols.end()) {
-        immediate = it->second;
+      auto symbolValue = symbols.value(line.tokens.at(2), line.sourceLine());
+      if (symbolValue) {
+        immediate = *symbolValue;
       } else {
         if (unsignedFitErr) {
           return Result<std::vector<LineTokens>>{
@@ -0,0 +1,35 @@
+#include "rv_v_ext.h"
+namespace Ripes {
+namespace RVISA {
+namespace ExtV {
+
+void enableExt(const ISAInfoBase *, InstrVec &instructions, PseudoInstrVec &) {
+  using namespace TypeVCfg;
+  using namespace TypeVMem;
+  using namespace TypeVArith;
+
+  enableInstructions<Vsetvli, Vsetivli, Vsetvl>(instructions);
+
+  enableInstructions<Vle8, Vle16, Vle32, Vle64, Vse8, Vse16, Vse32, Vse64,
+                     Vlse8, Vlse16, Vlse32, Vlse64, Vsse8, Vsse16, Vsse32,
+                     Vsse64>(instructions);
+
+  enableInstructions<VaddVV, VaddVX, VaddVI, VsubVV, VsubVX, VrsubVX, VrsubVI,
+                     VminuVV, VminuVX, VminVV, VminVX, VmaxuVV, VmaxuVX,
+                     VmaxVV, VmaxVX, VandVV, VandVX, VandVI, VorVV, VorVX,
+                     VorVI, VxorVV, VxorVX, VxorVI, VsllVV, VsllVX, VsllVI,
+                     VsrlVV, VsrlVX, VsrlVI, VsraVV, VsraVX, VsraVI, VmvVV,
+                     VmvVX, VmvVI>(instructions);
+
+  enableInstructions<VmulVV, VmulVX, VmulhVV, VmulhVX, VmulhuVV, VmulhuVX,
+                     VdivuVV, VdivuVX, VdivVV, VdivVX, VremuVV, VremuVX,
+                     VremVV, VremVX, VmaccVV, VmaccVX>(instructions);
+
+  enableInstructions<VredsumVS, VredandVS, VredorVS, VredxorVS, VredminuVS,
+                     VredminVS, VredmaxuVS, VredmaxVS, VmvXS, VmvSX>(
+      instructions);
+}
+
+} // namespace ExtV
+} // namespace RVISA
+} // namespace Ripes
@@ -0,0 +1,584 @@
+#pragma once
+
+#include "pseudoinstruction.h"
+#include "rv_i_ext.h"
+#include "rvisainfo_common.h"
+
+namespace Ripes {
+namespace RVISA {
+
+namespace ExtV {
+
+/// Defines information about the vector register file. Vector registers are
+/// only referenced by the assembler; their contents (of VLEN bits each) are
+/// not representable as register values, and as such the register file is not
+/// part of the register info map of the ISA.
+struct RV_VPRInfo : public RegFileInfoInterface {
+  std::string_view regFileName() const override { return "vpr"; }
+  std::string_view regFileDesc() const override { return "Vector registers"; }
+  unsigned int regCnt() const override { return 32; }
+  QString regName(unsigned i) const override {
+    return i < regCnt() ? "v" + QString::number(i) : QString();
+  }
+  QString regAlias(unsigned i) const override { return regName(i); }
+  QString regInfo(unsigned) const override { return QString(); }
+  bool regIsReadOnly(unsigned) const override { return false; }
+  unsigned int regNumber(const QString &reg, bool &success) const override {
+    success = false;
+    if (!reg.startsWith('v'))
+      return 0;
+    const unsigned index = reg.mid(1).toUInt(&success, 10);
+    success &= index < regCnt();
+    return success ? index : 0;
+  }
+};
+
+template <typename RegImpl, unsigned tokenIndex, typename Range>
+struct VPR_Reg : public Reg<RegImpl, tokenIndex, Range, RV_VPRInfo> {};
+
+/// The vector destination register, in bits 7-11 of the instruction.
+template <unsigned tokenIndex>
+struct RegVd : public VPR_Reg<RegVd<tokenIndex>, tokenIndex, BitRange<7, 11>> {
+  constexpr static std::string_view NAME = "vd";
+};
+
+/// The vector register stored by a vector store, in bits 7-11 of the
+/// instruction.
+template <unsigned tokenIndex>
+struct RegVs3
+    : public VPR_Reg<RegVs3<tokenIndex>, tokenIndex, BitRange<7, 11>> {
+  constexpr static std::string_view NAME = "vs3";
+};
+
+/// The first vector source register, in bits 15-19 of the instruction.
+template <unsigned tokenIndex>
+struct RegVs1
+    : public VPR_Reg<RegVs1<tokenIndex>, tokenIndex, BitRange<15, 19>> {
+  constexpr static std::string_view NAME = "vs1";
+};
+
+/// The second vector source register, in bits 20-24 of the instruction.
+template <unsigned tokenIndex>
+struct RegVs2
+    : public VPR_Reg<RegVs2<tokenIndex>, tokenIndex, BitRange<20, 24>> {
+  constexpr static std::string_view NAME = "vs2";
+};
+
+/// The signed 5-bit immediate of OPIVI instructions, in bits 15-19.
+template <unsigned tokenIndex>
+struct ImmV5 : public Imm<tokenIndex, 5, Repr::Signed, ImmPart<0, 15, 19>> {};
+
+/// The unsigned 5-bit immediate of OPIVI shifts and of vsetivli, in bits
+/// 15-19.
+template <unsigned tokenIndex>
+struct UImmV5
+    : public Imm<tokenIndex, 5, Repr::Unsigned, ImmPart<0, 15, 19>> {};
+
+/// Vector instructions are unmasked (vm = 1); masking by v0 is not supported.
+struct OpPartUnmasked : public OpPart<1, BitRange<25, 25>> {};
+
+/**
+ * @brief VTypeImm
+ * The vtype immediate of vsetvli and vsetivli, of @p bits bits starting at bit
+ * 20 of the instruction. It is written as the tokens following @p tokenIndex:
+ * the element width (e8, e16, e32, e64), and optionally the register group
+ * multiplier (mf8, mf4, mf2, m1, m2, m4, m8, default m1), the tail policy (tu,
+ * ta, default tu) and the mask policy (mu, ma, default mu), or as a single
+ * integer.
+ */
+template <unsigned tokenIndex, unsigned bits>
+struct VTypeImm
+    : public Field<tokenIndex, BitRangeSet<BitRange<20, 20 + bits - 1>>> {
+  using Range = BitRange<20, 20 + bits - 1>;
+
+  static Result<> apply(const TokenizedSrcLine &line, Instr_T &instruction,
+                        FieldLinkRequest &) {
+    if (tokenIndex + 1 >= line.tokens.size()) {
+      return Error(line, "Required field 'vtypei' (index " +
+                             QString::number(tokenIndex) + ") not provided");
+    }
+    bool isNumber = false;
+    const unsigned value = line.tokens.at(tokenIndex + 1).toUInt(&isNumber, 0);
+    if (isNumber) {
+      if (!isUInt(bits, value)) {
+        return Error(line, "vtype value '" + line.tokens.at(tokenIndex + 1) +
+                               "' does not fit in " + QString::number(bits) +
+                               " bits");
+      }
+      instruction |= Range().apply(value);
+      return Result<>::def();
+    }
+
+    static const QStringList c_sews = {"e8", "e16", "e32", "e64"};
+    static const QStringList c_lmuls = {"m1", "m2",  "m4",  "m8",
+                                        "",   "mf8", "mf4", "mf2"};
+    int sew = -1;
+    unsigned lmul = 0, ta = 0, ma = 0;
+    for (int i = tokenIndex + 1; i < line.tokens.size(); ++i) {
+      const QString token = line.tokens.at(i).toLower();
+      if (i == static_cast<int>(tokenIndex) + 1) {
+        sew = c_sews.indexOf(token);
+        if (sew < 0)
+          return Error(line, "Invalid element width '" + token + "'");
+      } else if (c_lmuls.contains(token) && !token.isEmpty()) {
+        lmul = c_lmuls.indexOf(token);
+      } else if (token == "ta" || token == "tu") {
+        ta = token == "ta";
+      } else if (token == "ma" || token == "mu") {
+        ma = token == "ma";
+      } else {
+        return Error(line, "Invalid vtype setting '" + token + "'");
+      }
+    }
+    instruction |= Range().apply(ma << 7 | ta << 6 | sew << 3 | lmul);
+    return Result<>::def();
+  }
+
+  static bool decode(const Instr_T instruction, const Reg_T,
+                     const ReverseSymbolMap &, LineTokens &line) {
+    const unsigned vtype = Range().decode(instruction);
+    const unsigned lmul = vtype & 0b111;
+    const unsigned sew = (vtype >> 3) & 0b111;
+    if ((vtype >> 8) != 0 || sew > 3 || lmul == 4) {
+      // Reserved settings are shown as their value.
+      line.push_back(QString::number(vtype));
+      return true;
+    }
+    line.push_back("e" + QString::number(8 << sew));
+    line.push_back(lmul < 4 ? "m" + QString::number(1 << lmul)
+                            : "mf" + QString::number(1 << (8 - lmul)));
+    line.push_back((vtype >> 6) & 1 ? "ta" : "tu");
+    line.push_back((vtype >> 7) & 1 ? "ma" : "mu");
+    return true;
+  }
+};
+
+template <unsigned tokenIndex>
+using VTypeImm11 = VTypeImm<tokenIndex, 11>;
+template <unsigned tokenIndex>
+using VTypeImm10 = VTypeImm<tokenIndex, 10>;
+
+namespace TypeVCfg {
+
+/// vsetvli rd, rs1, vtypei
+struct Vsetvli : public RV_Instruction<Vsetvli> {
+  struct Opcode : public OpcodeSet<OpPartOpcode<RVISA::OpcodeID::OPV>,
+                                   OpPartFunct3<0b111>,
+                                   OpPart<0b0, BitRange<31, 31>>> {};
+  struct Fields : public FieldSet<RegRd, RegRs1, VTypeImm11> {};
+  constexpr static std::string_view NAME = "vsetvli";
+};
+
+/// vsetivli rd, uimm, vtypei
+struct Vsetivli : public RV_Instruction<Vsetivli> {
+  struct Opcode : public OpcodeSet<OpPartOpcode<RVISA::OpcodeID::OPV>,
+                                   OpPartFunct3<0b111>,
+                                   OpPart<0b11, BitRange<30, 31>>> {};
+  struct Fields : public FieldSet<RegRd, UImmV5, VTypeImm10> {};
+  constexpr static std::string_view NAME = "vsetivli";
+};
+
+/// vsetvl rd, rs1, rs2
+struct Vsetvl : public RV_Instruction<Vsetvl> {
+  struct Opcode : public OpcodeSet<OpPartOpcode<RVISA::OpcodeID::OPV>,
+                                   OpPartFunct3<0b111>,
+                                   OpPart<0b1, BitRange<31, 31>>,
+                                   OpPartZeroes<25, 30>> {};
+  struct Fields : public FieldSet<RegRd, RegRs1, RegRs2> {};
+  constexpr static std::string_view NAME = "vsetvl";
+};
+
+} // namespace TypeVCfg
+
+namespace TypeVMem {
+
+/// The width field of vector loads and stores, giving the element width.
+enum class Width { E8 = 0b000, E16 = 0b101, E32 = 0b110, E64 = 0b111 };
+/// The addressing mode of vector loads and stores.
+enum class Mop { UNIT = 0b00, STRIDED = 0b10 };
+
+template <Mop mop>
+struct OpPartMop
+    : public OpPart<static_cast<unsigned>(mop), BitRange<26, 27>> {};
+
+/// A unit-stride vector load or store (of a single field, nf = 0).
+/// v{l,s}e{width}.v vd, (rs1)
+template <typename InstrImpl, OpcodeID opcode, Width width,
+          template <unsigned> typename RegV>
+struct InstrUnit : public RV_Instruction<InstrImpl> {
+  struct Opcode
+      : public OpcodeSet<OpPartOpcode<opcode>,
+                         OpPartFunct3<static_cast<unsigned>(width)>,
+                         OpPartMop<Mop::UNIT>, OpPartUnmasked,
+                         OpPartZeroes<28, 31>, OpPartZeroes<20, 24>> {};
+  struct Fields : public FieldSet<RegV, RegRs1> {};
+};
+
+/// A strided vector load or store, with a stride of rs2 bytes.
+/// v{l,s}se{width}.v vd, (rs1), rs2
+template <typename InstrImpl, OpcodeID opcode, Width width,
+          template <unsigned> typename RegV>
+struct InstrStrided : public RV_Instruction<InstrImpl> {
+  struct Opcode
+      : public OpcodeSet<OpPartOpcode<opcode>,
+                         OpPartFunct3<static_cast<unsigned>(width)>,
+                         OpPartMop<Mop::STRIDED>, OpPartUnmasked,
+                         OpPartZeroes<28, 31>> {};
+  struct Fields : public FieldSet<RegV, RegRs1, RegRs2> {};
+};
+
+template <typename InstrImpl, Width width>
+using Load = InstrUnit<InstrImpl, OpcodeID::LOADFP, width, RegVd>;
+template <typename InstrImpl, Width width>
+using Store = InstrUnit<InstrImpl, OpcodeID::STOREFP, width, RegVs3>;
+template <typename InstrImpl, Width width>
+using LoadStrided = InstrStrided<InstrImpl, OpcodeID::LOADFP, width, RegVd>;
+template <typename InstrImpl, Width width>
+using StoreStrided =
+    InstrStrided<InstrImpl, OpcodeID::STOREFP, width, RegVs3>;
+
+struct Vle8 : public Load<Vle8, Width::E8> {
+  constexpr static std::string_view NAME = "vle8.v";
+};
+struct Vle16 : public Load<Vle16, Width::E16> {
+  constexpr static std::string_view NAME = "vle16.v";
+};
+struct Vle32 : public Load<Vle32, Width::E32> {
+  constexpr static std::string_view NAME = "vle32.v";
+};
+struct Vle64 : public Load<Vle64, Width::E64> {
+  constexpr static std::string_view NAME = "vle64.v";
+};
+
+struct Vse8 : public Store<Vse8, Width::E8> {
+  constexpr static std::string_view NAME = "vse8.v";
+};
+struct Vse16 : public Store<Vse16, Width::E16> {
+  constexpr static std::string_view NAME = "vse16.v";
+};
+struct Vse32 : public Store<Vse32, Width::E32> {
+  constexpr static std::string_view NAME = "vse32.v";
+};
+struct Vse64 : public Store<Vse64, Width::E64> {
+  constexpr static std::string_view NAME = "vse64.v";
+};
+
+struct Vlse8 : public LoadStrided<Vlse8, Width::E8> {
+  constexpr static std::string_view NAME = "vlse8.v";
+};
+struct Vlse16 : public LoadStrided<Vlse16, Width::E16> {
+  constexpr static std::string_view NAME = "vlse16.v";
+};
+struct Vlse32 : public LoadStrided<Vlse32, Width::E32> {
+  constexpr static std::string_view NAME = "vlse32.v";
+};
+struct Vlse64 : public LoadStrided<Vlse64, Width::E64> {
+  constexpr static std::string_view NAME = "vlse64.v";
+};
+
+struct Vsse8 : public StoreStrided<Vsse8, Width::E8> {
+  constexpr static std::string_view NAME = "vsse8.v";
+};
+struct Vsse16 : public StoreStrided<Vsse16, Width::E16> {
+  constexpr static std::string_view NAME = "vsse16.v";
+};
+struct Vsse32 : public StoreStrided<Vsse32, Width::E32> {
+  constexpr static std::string_view NAME = "vsse32.v";
+};
+struct Vsse64 : public StoreStrided<Vsse64, Width::E64> {
+  constexpr static std::string_view NAME = "vsse64.v";
+};
+
+} // namespace TypeVMem
+
+namespace TypeVArith {
+
+/// The operand category of a vector arithmetic instruction: integer (OPI) or
+/// multiply/reduction (OPM) operations on vector (VV), scalar (VX) or
+/// immediate (VI) operands.
+enum class Funct3 {
+  OPIVV = 0b000,
+  OPMVV = 0b010,
+  OPIVI = 0b011,
+  OPIVX = 0b100,
+  OPMVX = 0b110
+};
+
+enum class Funct6 {
+  VADD = 0b000000,
+  VSUB = 0b000010,
+  VRSUB = 0b000011,
+  VMINU = 0b000100,
+  VMIN = 0b000101,
+  VMAXU = 0b000110,
+  VMAX = 0b000111,
+  VAND = 0b001001,
+  VOR = 0b001010,
+  VXOR = 0b001011,
+  VMV = 0b010111,
+  VSLL = 0b100101,
+  VSRL = 0b101000,
+  VSRA = 0b101001,
+  // OPM
+  VREDSUM = 0b000000,
+  VREDAND = 0b000001,
+  VREDOR = 0b000010,
+  VREDXOR = 0b000011,
+  VREDMINU = 0b000100,
+  VREDMIN = 0b000101,
+  VREDMAXU = 0b000110,
+  VREDMAX = 0b000111,
+  VWXUNARY0 = 0b010000, // vmv.x.s, vmv.s.x
+  VDIVU = 0b100000,
+  VDIV = 0b100001,
+  VREMU = 0b100010,
+  VREM = 0b100011,
+  VMULHU = 0b100100,
+  VMUL = 0b100101,
+  VMULH = 0b100111,
+  VMACC = 0b101101
+};
+
+/// An unmasked vector arithmetic instruction of the fields @p FieldsT.
+template <typename InstrImpl, Funct3 funct3, Funct6 funct6, typename FieldsT,
+          typename... ExtraParts>
+struct Instr : public RV_Instruction<InstrImpl> {
+  struct Opcode
+      : public OpcodeSet<OpPartOpcode<RVISA::OpcodeID::OPV>,
+                         OpPartFunct3<static_cast<unsigned>(funct3)>,
+                         OpPartUnmasked,
+                         OpPartFunct6<static_cast<unsigned>(funct6)>,
+                         ExtraParts...> {};
+  struct Fields : public FieldsT {};
+};
+
+// op.vv vd, vs2, vs1
+template <typename InstrImpl, Funct6 funct6, Funct3 funct3 = Funct3::OPIVV>
+using InstrVV =
+    Instr<InstrImpl, funct3, funct6, FieldSet<RegVd, RegVs2, RegVs1>>;
+// op.vx vd, vs2, rs1
+template <typename InstrImpl, Funct6 funct6, Funct3 funct3 = Funct3::OPIVX>
+using InstrVX =
+    Instr<InstrImpl, funct3, funct6, FieldSet<RegVd, RegVs2, RegRs1>>;
+// op.vi vd, vs2, imm
+template <typename InstrImpl, Funct6 funct6>
+using InstrVI =
+    Instr<InstrImpl, Funct3::OPIVI, funct6, FieldSet<RegVd, RegVs2, ImmV5>>;
+// op.vi vd, vs2, uimm
+template <typename InstrImpl, Funct6 funct6>
+using InstrVIU =
+    Instr<InstrImpl, Funct3::OPIVI, funct6, FieldSet<RegVd, RegVs2, UImmV5>>;
+template <typename InstrImpl, Funct6 funct6>
+using InstrMVV = InstrVV<InstrImpl, funct6, Funct3::OPMVV>;
+template <typename InstrImpl, Funct6 funct6>
+using InstrMVX = InstrVX<InstrImpl, funct6, Funct3::OPMVX>;
+
+struct VaddVV : public InstrVV<VaddVV, Funct6::VADD> {
+  constexpr static std::string_view NAME = "vadd.vv";
+};
+struct VaddVX : public InstrVX<VaddVX, Funct6::VADD> {
+  constexpr static std::string_view NAME = "vadd.vx";
+};
+struct VaddVI : public InstrVI<VaddVI, Funct6::VADD> {
+  constexpr static std::string_view NAME = "vadd.vi";
+};
+struct VsubVV : public InstrVV<VsubVV, Funct6::VSUB> {
+  constexpr static std::string_view NAME = "vsub.vv";
+};
+struct VsubVX : public InstrVX<VsubVX, Funct6::VSUB> {
+  constexpr static std::string_view NAME = "vsub.vx";
+};
+struct VrsubVX : public InstrVX<VrsubVX, Funct6::VRSUB> {
+  constexpr static std::string_view NAME = "vrsub.vx";
+};
+struct VrsubVI : public InstrVI<VrsubVI, Funct6::VRSUB> {
+  constexpr static std::string_view NAME = "vrsub.vi";
+};
+struct VminuVV : public InstrVV<VminuVV, Funct6::VMINU> {
+  constexpr static std::string_view NAME = "vminu.vv";
+};
+struct VminuVX : public InstrVX<VminuVX, Funct6::VMINU> {
+  constexpr static std::string_view NAME = "vminu.vx";
+};
+struct VminVV : public InstrVV<VminVV, Funct6::VMIN> {
+  constexpr static std::string_view NAME = "vmin.vv";
+};
+struct VminVX : public InstrVX<VminVX, Funct6::VMIN> {
+  constexpr static std::string_view NAME = "vmin.vx";
+};
+struct VmaxuVV : public InstrVV<VmaxuVV, Funct6::VMAXU> {
+  constexpr static std::string_view NAME = "vmaxu.vv";
+};
+struct VmaxuVX : public InstrVX<VmaxuVX, Funct6::VMAXU> {
+  constexpr static std::string_view NAME = "vmaxu.vx";
+};
+struct VmaxVV : public InstrVV<VmaxVV, Funct6::VMAX> {
+  constexpr static std::string_view NAME = "vmax.vv";
+};
+struct VmaxVX : public InstrVX<VmaxVX, Funct6::VMAX> {
+  constexpr static std::string_view NAME = "vmax.vx";
+};
+struct VandVV : public InstrVV<VandVV, Funct6::VAND> {
+  constexpr static std::string_view NAME = "vand.vv";
+};
+struct VandVX : public InstrVX<VandVX, Funct6::VAND> {
+  constexpr static std::string_view NAME = "vand.vx";
+};
+struct VandVI : public InstrVI<VandVI, Funct6::VAND> {
+  constexpr static std::string_view NAME = "vand.vi";
+};
+struct VorVV : public InstrVV<VorVV, Funct6::VOR> {
+  constexpr static std::string_view NAME = "vor.vv";
+};
+struct VorVX : public InstrVX<VorVX, Funct6::VOR> {
+  constexpr static std::string_view NAME = "vor.vx";
+};
+struct VorVI : public InstrVI<VorVI, Funct6::VOR> {
+  constexpr static std::string_view NAME = "vor.vi";
+};
+struct VxorVV : public InstrVV<VxorVV, Funct6::VXOR> {
+  constexpr static std::string_view NAME = "vxor.vv";
+};
+struct VxorVX : public InstrVX<VxorVX, Funct6::VXOR> {
+  constexpr static std::string_view NAME = "vxor.vx";
+};
+struct VxorVI : public InstrVI<VxorVI, Funct6::VXOR> {
+  constexpr static std::string_view NAME = "vxor.vi";
+};
+struct VsllVV : public InstrVV<VsllVV, Funct6::VSLL> {
+  constexpr static std::string_view NAME = "vsll.vv";
+};
+struct VsllVX : public InstrVX<VsllVX, Funct6::VSLL> {
+  constexpr static std::string_view NAME = "vsll.vx";
+};
+struct VsllVI : public InstrVIU<VsllVI, Funct6::VSLL> {
+  constexpr static std::string_view NAME = "vsll.vi";
+};
+struct VsrlVV : public InstrVV<VsrlVV, Funct6::VSRL> {
+  constexpr static std::string_view NAME = "vsrl.vv";
+};
+struct VsrlVX : public InstrVX<VsrlVX, Funct6::VSRL> {
+  constexpr static std::string_view NAME = "vsrl.vx";
+};
+struct VsrlVI : public InstrVIU<VsrlVI, Funct6::VSRL> {
+  constexpr static std::string_view NAME = "vsrl.vi";
+};
+struct VsraVV : public InstrVV<VsraVV, Funct6::VSRA> {
+  constexpr static std::string_view NAME = "vsra.vv";
+};
+struct VsraVX : public InstrVX<VsraVX, Funct6::VSRA> {
+  constexpr static std::string_view NAME = "vsra.vx";
+};
+struct VsraVI : public InstrVIU<VsraVI, Funct6::VSRA> {
+  constexpr static std::string_view NAME = "vsra.vi";
+};
+
+// vmv.v.{v,x,i} vd, src; the vs2 field is zero.
+struct VmvVV : public Instr<VmvVV, Funct3::OPIVV, Funct6::VMV,
+                            FieldSet<RegVd, RegVs1>, OpPartZeroes<20, 24>> {
+  constexpr static std::string_view NAME = "vmv.v.v";
+};
+struct VmvVX : public Instr<VmvVX, Funct3::OPIVX, Funct6::VMV,
+                            FieldSet<RegVd, RegRs1>, OpPartZeroes<20, 24>> {
+  constexpr static std::string_view NAME = "vmv.v.x";
+};
+struct VmvVI : public Instr<VmvVI, Funct3::OPIVI, Funct6::VMV,
+                            FieldSet<RegVd, ImmV5>, OpPartZeroes<20, 24>> {
+  constexpr static std::string_view NAME = "vmv.v.i";
+};
+
+struct VmulVV : public InstrMVV<VmulVV, Funct6::VMUL> {
+  constexpr static std::string_view NAME = "vmul.vv";
+};
+struct VmulVX : public InstrMVX<VmulVX, Funct6::VMUL> {
+  constexpr static std::string_view NAME = "vmul.vx";
+};
+struct VmulhVV : public InstrMVV<VmulhVV, Funct6::VMULH> {
+  constexpr static std::string_view NAME = "vmulh.vv";
+};
+struct VmulhVX : public InstrMVX<VmulhVX, Funct6::VMULH> {
+  constexpr static std::string_view NAME = "vmulh.vx";
+};
+struct VmulhuVV : public InstrMVV<VmulhuVV, Funct6::VMULHU> {
+  constexpr static std::string_view NAME = "vmulhu.vv";
+};
+struct VmulhuVX : public InstrMVX<VmulhuVX, Funct6::VMULHU> {
+  constexpr static std::string_view NAME = "vmulhu.vx";
+};
+struct VdivuVV : public InstrMVV<VdivuVV, Funct6::VDIVU> {
+  constexpr static std::string_view NAME = "vdivu.vv";
+};
+struct VdivuVX : public InstrMVX<VdivuVX, Funct6::VDIVU> {
+  constexpr static std::string_view NAME = "vdivu.vx";
+};
+struct VdivVV : public InstrMVV<VdivVV, Funct6::VDIV> {
+  constexpr static std::string_view NAME = "vdiv.vv";
+};
+struct VdivVX : public InstrMVX<VdivVX, Funct6::VDIV> {
+  constexpr static std::string_view NAME = "vdiv.vx";
+};
+struct VremuVV : public InstrMVV<VremuVV, Funct6::VREMU> {
+  constexpr static std::string_view NAME = "vremu.vv";
+};
+struct VremuVX : public InstrMVX<VremuVX, Funct6::VREMU> {
+  constexpr static std::string_view NAME = "vremu.vx";
+};
+struct VremVV : public InstrMVV<VremVV, Funct6::VREM> {
+  constexpr static std::string_view NAME = "vrem.vv";
+};
+struct VremVX : public InstrMVX<VremVX, Funct6::VREM> {
+  constexpr static std::string_view NAME = "vrem.vx";
+};
+
+// vmacc.vv vd, vs1, vs2 and vmacc.vx vd, rs1, vs2 (vd += vs1 * vs2)
+struct VmaccVV : public Instr<VmaccVV, Funct3::OPMVV, Funct6::VMACC,
+                              FieldSet<RegVd, RegVs1, RegVs2>> {
+  constexpr static std::string_view NAME = "vmacc.vv";
+};
+struct VmaccVX : public Instr<VmaccVX, Funct3::OPMVX, Funct6::VMACC,
+                              FieldSet<RegVd, RegRs1, RegVs2>> {
+  constexpr static std::string_view NAME = "vmacc.vx";
+};
+
+// vred{op}.vs vd, vs2, vs1 (vd[0] = vs1[0] op vs2[*])
+struct VredsumVS : public InstrMVV<VredsumVS, Funct6::VREDSUM> {
+  constexpr static std::string_view NAME = "vredsum.vs";
+};
+struct VredandVS : public InstrMVV<VredandVS, Funct6::VREDAND> {
+  constexpr static std::string_view NAME = "vredand.vs";
+};
+struct VredorVS : public InstrMVV<VredorVS, Funct6::VREDOR> {
+  constexpr static std::string_view NAME = "vredor.vs";
+};
+struct VredxorVS : public InstrMVV<VredxorVS, Funct6::VREDXOR> {
+  constexpr static std::string_view NAME = "vredxor.vs";
+};
+struct VredminuVS : public InstrMVV<VredminuVS, Funct6::VREDMINU> {
+  constexpr static std::string_view NAME = "vredminu.vs";
+};
+struct VredminVS : public InstrMVV<VredminVS, Funct6::VREDMIN> {
+  constexpr static std::string_view NAME = "vredmin.vs";
+};
+struct VredmaxuVS : public InstrMVV<VredmaxuVS, Funct6::VREDMAXU> {
+  constexpr static std::string_view NAME = "vredmaxu.vs";
+};
+struct VredmaxVS : public InstrMVV<VredmaxVS, Funct6::VREDMAX> {
+  constexpr static std::string_view NAME = "vredmax.vs";
+};
+
+// vmv.x.s rd, vs2 and vmv.s.x vd, rs1
+struct VmvXS : public Instr<VmvXS, Funct3::OPMVV, Funct6::VWXUNARY0,
+                            FieldSet<RegRd, RegVs2>, OpPartZeroes<15, 19>> {
+  constexpr static std::string_view NAME = "vmv.x.s";
+};
+struct VmvSX : public Instr<VmvSX, Funct3::OPMVX, Funct6::VWXUNARY0,
+                            FieldSet<RegVd, RegRs1>, OpPartZeroes<20, 24>> {
+  constexpr static std::string_view NAME = "vmv.s.x";
+};
+
+} // namespace TypeVArith
+
+} // namespace ExtV
+
+} // namespace RVISA
+} // namespace Ripes
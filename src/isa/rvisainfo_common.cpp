@@ -48,6 +48,52 @@ const QStringList GPRRegDescs = QStringList() << "Hard-Wired zero"
                                            << "Temporary register\nSaver: Caller"
                                            << "Temporary register\nSaver: Caller"
                                            << "Temporary register\nSaver: Caller";
+
+const QStringList FPRRegAliases = QStringList()
+                                           << "ft0" << "ft1" << "ft2" << "ft3" << "ft4" << "ft5" << "ft6" << "ft7" << "fs0" << "fs1"
+                                           << "fa0" << "fa1" << "fa2" << "fa3" << "fa4" << "fa5" << "fa6" << "fa7" << "fs2" << "fs3"
+                                           << "fs4" << "fs5" << "fs6" << "fs7" << "fs8" << "fs9" << "fs10" << "fs11" << "ft8" << "ft9"
+                                           << "ft10" << "ft11";
+
+const QStringList FPRRegNames = QStringList()
+                                           << "f0" << "f1" << "f2" << "f3" << "f4" << "f5" << "f6" << "f7" << "f8" << "f9"
+                                           << "f10" << "f11" << "f12" << "f13" << "f14" << "f15" << "f16" << "f17" << "f18" << "f19"
+                                           << "f20" << "f21" << "f22" << "f23" << "f24" << "f25" << "f26" << "f27" << "f28" << "f29"
+                                           << "f30" << "f31";
+
+const QStringList FPRRegDescs = QStringList()
+                                           << "Temporary\nSaver: Caller"
+                                           << "Temporary\nSaver: Caller"
+                                           << "Temporary\nSaver: Caller"
+                                           << "Temporary\nSaver: Caller"
+                                           << "Temporary\nSaver: Caller"
+                                           << "Temporary\nSaver: Caller"
+                                           << "Temporary\nSaver: Caller"
+                                           << "Temporary\nSaver: Caller"
+                                           << "Saved register\nSaver: Callee"
+                                           << "Saved register\nSaver: Callee"
+                                           << "Function argument/return value\nSaver: Caller"
+                                           << "Function argument/return value\nSaver: Caller"
+                                           << "Function argument\nSaver: Caller"
+                                           << "Function argument\nSaver: Caller"
+                                           << "Function argument\nSaver: Caller"
+                                           << "Function argument\nSaver: Caller"
+                                           << "Function argument\nSaver: Caller"
+                                           << "Function argument\nSaver: Caller"
+                                           << "Saved register\nSaver: Callee"
+                                           << "Saved register\nSaver: Callee"
+                                           << "Saved register\nSaver: Callee"
+                                           << "Saved register\nSaver: Callee"
+                                           << "Saved register\nSaver: Callee"
+                                           << "Saved register\nSaver: Callee"
+                                           << "Saved register\nSaver: Callee"
+                                           << "Saved register\nSaver: Callee"
+                                           << "Saved register\nSaver: Callee"
+                                           << "Saved register\nSaver: Callee"
+                                           << "Temporary\nSaver: Caller"
+                                           << "Temporary\nSaver: Caller"
+                                           << "Temporary\nSaver: Caller"
+                                           << "Temporary\nSaver: Caller";
 // clang-format on
 
 } // namespace RVISA
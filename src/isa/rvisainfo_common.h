@@ -44,6 +44,8 @@ enum SysCall {
   FStat = 80,
   Exit2 = 93,
   brk = 214,
+  munmap = 215,
+  mmap = 222,
   Open = 1024
 };
 
@@ -53,6 +55,9 @@ namespace RVISA {
 extern const QStringList GPRRegAliases;
 extern const QStringList GPRRegNames;
 extern const QStringList GPRRegDescs;
+extern const QStringList FPRRegAliases;
+extern const QStringList FPRRegNames;
+extern const QStringList FPRRegDescs;
 
 constexpr unsigned INSTR_BITS = 32;
 
@@ -108,13 +113,29 @@ struct RV_GPRInfo : public RegFileInfoInterface {
 struct RV_FPRInfo : public RegFileInfoInterface {
   std::string_view regFileName() const override { return FPR; }
   std::string_view regFileDesc() const override { return FPR_DESC; }
-  // TODO: Fill out RISC-V floating point register info
-  unsigned int regCnt() const override { return 0; }
-  QString regName(unsigned) const override { return QString(); }
-  QString regAlias(unsigned) const override { return QString(); }
-  QString regInfo(unsigned) const override { return QString(); }
+  unsigned int regCnt() const override { return 32; }
+  QString regName(unsigned i) const override {
+    return RVISA::FPRRegNames.size() > static_cast<int>(i)
+               ? RVISA::FPRRegNames.at(static_cast<int>(i))
+               : QString();
+  }
+  QString regAlias(unsigned i) const override {
+    return RVISA::FPRRegAliases.size() > static_cast<int>(i)
+               ? RVISA::FPRRegAliases.at(static_cast<int>(i))
+               : QString();
+  }
+  QString regInfo(unsigned i) const override {
+    return RVISA::FPRRegDescs.size() > static_cast<int>(i)
+               ? RVISA::FPRRegDescs.at(static_cast<int>(i))
+               : QString();
+  }
   bool regIsReadOnly(unsigned) const override { return false; }
-  unsigned int regNumber(const QString &, bool &success) const override {
+  unsigned int regNumber(const QString &reg, bool &success) const override {
+    success = true;
+    if (const int index = RVISA::FPRRegNames.indexOf(reg); index >= 0)
+      return index;
+    if (const int index = RVISA::FPRRegAliases.indexOf(reg); index >= 0)
+      return index;
     success = false;
     return 0;
   }
@@ -137,15 +158,56 @@ void enableExt(const ISAInfoBase *isa, InstrVec &instructions,
                PseudoInstrVec &pseudoInstructions);
 }
 
+namespace ExtA {
+void enableExt(const ISAInfoBase *isa, InstrVec &instructions,
+               PseudoInstrVec &pseudoInstructions);
+}
+
+namespace ExtF {
+void enableExt(const ISAInfoBase *isa, InstrVec &instructions,
+               PseudoInstrVec &pseudoInstructions);
+}
+
+namespace ExtD {
+void enableExt(const ISAInfoBase *isa, InstrVec &instructions,
+               PseudoInstrVec &pseudoInstructions);
+}
+
 namespace ExtC {
 void enableExt(const ISAInfoBase *isa, InstrVec &instructions,
                PseudoInstrVec &pseudoInstructions);
 }
 
+namespace ExtV {
+void enableExt(const ISAInfoBase *isa, InstrVec &instructions,
+               PseudoInstrVec &pseudoInstructions);
+}
+
+namespace ExtZba {
+void enableExt(const ISAInfoBase *isa, InstrVec &instructions,
+               PseudoInstrVec &pseudoInstructions);
+}
+
+namespace ExtZbb {
+void enableExt(const ISAInfoBase *isa, InstrVec &instructions,
+               PseudoInstrVec &pseudoInstructions);
+}
+
+namespace ExtZbs {
+void enableExt(const ISAInfoBase *isa, InstrVec &instructions,
+               PseudoInstrVec &pseudoInstructions);
+}
+
+namespace ExtCustom {
+void enableExt(const ISAInfoBase *isa, InstrVec &instructions,
+               PseudoInstrVec &pseudoInstructions);
+}
+
 class RV_ISAInfoBase : public ISAInfoBase {
 public:
   static const QStringList &getSupportedExtensions() {
-    static const QStringList ext = {"M", "C"};
+    static const QStringList ext = {"M", "A",   "F",   "D",  "C",
+                                    "V", "Zba", "Zbb", "Zbs"};
     return ext;
   }
   static const QStringList &getDefaultExtensions() {
@@ -164,7 +226,12 @@ public:
     }
 
     m_regInfos[GPR] = std::make_unique<RV_GPRInfo>();
-    if (supportsExtension("F")) {
+    // The D extension depends upon, and thereby implies, the F extension.
+    if (m_enabledExtensions.contains("D") &&
+        !m_enabledExtensions.contains("F")) {
+      m_enabledExtensions << "F";
+    }
+    if (m_enabledExtensions.contains("F")) {
       m_regInfos[FPR] = std::make_unique<RV_FPRInfo>();
     }
 
@@ -216,8 +283,22 @@ public:
   QString extensionDescription(const QString &ext) const override {
     if (ext == "M")
       return "Integer multiplication and division";
+    if (ext == "A")
+      return "Atomic instructions";
+    if (ext == "F")
+      return "Single-precision floating-point instructions";
+    if (ext == "D")
+      return "Double-precision floating-point instructions";
     if (ext == "C")
       return "Compressed instructions";
+    if (ext == "V")
+      return "Vector instructions";
+    if (ext == "Zba")
+      return "Address generation instructions";
+    if (ext == "Zbb")
+      return "Basic bit-manipulation instructions";
+    if (ext == "Zbs")
+      return "Single-bit instructions";
     Q_UNREACHABLE();
   }
 
@@ -232,25 +313,45 @@ protected:
   void initialize(const std::set<Option> &options = {}) {
     RVISA::ExtI::enableExt(this, m_instructions, m_pseudoInstructions, options);
     for (const auto &extension : m_enabledExtensions) {
-      switch (extension.unicode()->toLatin1()) {
-      case 'M':
+      if (extension == "M")
         RVISA::ExtM::enableExt(this, m_instructions, m_pseudoInstructions);
-        break;
-      case 'C':
+      else if (extension == "A")
+        RVISA::ExtA::enableExt(this, m_instructions, m_pseudoInstructions);
+      else if (extension == "F")
+        RVISA::ExtF::enableExt(this, m_instructions, m_pseudoInstructions);
+      else if (extension == "D")
+        RVISA::ExtD::enableExt(this, m_instructions, m_pseudoInstructions);
+      else if (extension == "C")
         RVISA::ExtC::enableExt(this, m_instructions, m_pseudoInstructions);
-        break;
-      }
+      else if (extension == "V")
+        RVISA::ExtV::enableExt(this, m_instructions, m_pseudoInstructions);
+      else if (extension == "Zba")
+        RVISA::ExtZba::enableExt(this, m_instructions, m_pseudoInstructions);
+      else if (extension == "Zbb")
+        RVISA::ExtZbb::enableExt(this, m_instructions, m_pseudoInstructions);
+      else if (extension == "Zbs")
+        RVISA::ExtZbs::enableExt(this, m_instructions, m_pseudoInstructions);
     }
+    // Custom instructions are not an extension of their own, and are enabled
+    // in every ISA constructed after their registration.
+    RVISA::ExtCustom::enableExt(this, m_instructions, m_pseudoInstructions);
   }
 
   QString _CCmarch(QString march) const {
     // Proceed in canonical order. Canonical ordering is defined in the RISC-V
     // spec.
-    for (const auto &ext : {"M", "A", "F", "D", "C"}) {
+    for (const auto &ext : {"M", "A", "F", "D", "C", "V"}) {
       if (m_enabledExtensions.contains(ext)) {
         march += QString(ext).toLower();
       }
     }
+    // Multi-letter extensions follow the single-letter extensions, separated
+    // by underscores.
+    for (const auto &ext : {"Zba", "Zbb", "Zbs"}) {
+      if (m_enabledExtensions.contains(ext)) {
+        march += "_" + QString(ext).toLower();
+      }
+    }
 
     return march;
   }
@@ -277,6 +378,20 @@ enum OpcodeID {
   OP32 = 0b0111011,
   SYSTEM = 0b1110011,
   AUIPC = 0b0010111,
+  AMO = 0b0101111,
+  OPV = 0b1010111,
+  LOADFP = 0b0000111,
+  STOREFP = 0b0100111,
+  OPFP = 0b1010011,
+  MADD = 0b1000011,
+  MSUB = 0b1000111,
+  NMSUB = 0b1001011,
+  NMADD = 0b1001111,
+  // Reserved for custom extensions (see ExtCustom).
+  CUSTOM0 = 0b0001011,
+  CUSTOM1 = 0b0101011,
+  CUSTOM2 = 0b1011011,
+  CUSTOM3 = 0b1111011,
   INVALID = 0b0
 };
 enum QuadrantID {
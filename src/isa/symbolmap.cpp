@@ -1,48 +1,84 @@
 #include "symbolmap.h"
 
+#include <algorithm>
+
 namespace Ripes {
 
 /// Adds a symbol to the current symbol mapping of this assembler.
 std::optional<Error> SymbolMap::addAbsSymbol(const unsigned &line,
                                              const Symbol &s, VInt v) {
-  if (abs.count(s)) {
+  if (ids.contains(s.v)) {
     return {Error(line, "Multiple definitions of symbol '" + s.v + "'")};
   }
-  abs[s] = v;
+  ids.insert(s.v, abs.size());
+  abs.push_back({s, static_cast<VIntS>(v)});
   return {};
 }
 
+void SymbolMap::setAbsSymbol(const Symbol &s, VInt v) {
+  auto it = ids.constFind(s.v);
+  if (it != ids.constEnd()) {
+    abs[it.value()] = {s, static_cast<VIntS>(v)};
+    return;
+  }
+  ids.insert(s.v, abs.size());
+  abs.push_back({s, static_cast<VIntS>(v)});
+}
+
 std::optional<Error> SymbolMap::addRelSymbol(const unsigned &line,
                                              const Symbol &s, VInt v) {
   assert(s.isLocal());
-  auto &it = rel[s.v.toInt()];
-  if (it.count(line))
+  auto &defs = rel[s.v.toInt()];
+  // Labels are mostly defined in line order, in which case the definition is
+  // appended.
+  auto it = std::lower_bound(
+      defs.begin(), defs.end(), line,
+      [](const RelSymbol &def, unsigned line) { return def.line < line; });
+  if (it != defs.end() && it->line == line)
     return {Error(line, QString::fromStdString(
                             "Multiple definitions of relative symbol '" +
                             std::to_string(v) + "' on line '" +
                             std::to_string(line)))};
-  it[line] = v;
+  defs.insert(it, {line, static_cast<VIntS>(v)});
   return {};
 }
 
-AbsoluteSymbolMap SymbolMap::copyRelativeTo(unsigned line,
-                                            const QString &beforeSuffix,
-                                            const QString &afterSuffix) const {
-  AbsoluteSymbolMap res = abs;
-
-  for (auto &relSymbols : rel) {
-    auto ub = relSymbols.second.upper_bound(line);
-    if (ub != relSymbols.second.end())
-      res[QString::number(relSymbols.first) + afterSuffix] = ub->second;
+std::optional<VIntS> SymbolMap::relValue(const std::vector<RelSymbol> &defs,
+                                         unsigned line, bool after) const {
+  auto ub = std::upper_bound(
+      defs.begin(), defs.end(), line,
+      [](unsigned line, const RelSymbol &def) { return line < def.line; });
+  if (after) {
+    if (ub == defs.end())
+      return {};
+    return ub->value;
+  }
+  if (ub == defs.begin())
+    return {};
+  return std::prev(ub)->value;
+}
 
-    if (ub != relSymbols.second.begin()) {
-      auto lb = ub;
-      std::advance(lb, -1);
-      res[QString::number(relSymbols.first) + beforeSuffix] = lb->second;
+std::optional<VIntS> SymbolMap::value(const QString &name,
+                                      unsigned line) const {
+  if (!rel.empty() && name.size() > 1) {
+    const QChar suffix = name.back();
+    if (suffix == beforeSuffix || suffix == afterSuffix) {
+      bool ok;
+      const RelativeSymbol relSymbol = name.chopped(1).toInt(&ok);
+      if (ok) {
+        auto it = rel.find(relSymbol);
+        if (it != rel.end()) {
+          if (auto v = relValue(it->second, line, suffix == afterSuffix))
+            return v;
+        }
+      }
     }
   }
 
-  return res;
+  auto it = ids.constFind(name);
+  if (it != ids.constEnd())
+    return abs[it.value()].value;
+  return {};
 }
 
 } // namespace Ripes
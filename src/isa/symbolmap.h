@@ -1,26 +1,58 @@
 #pragma once
 
 #include "isa_defines.h"
+#include <QHash>
+#include <map>
 #include <optional>
+#include <vector>
 
 namespace Ripes {
 
 using AbsoluteSymbolMap = std::map<Symbol, VIntS>;
+
+/**
+ * @brief The SymbolMap struct
+ * Absolute symbols are interned upon their definition; each symbol is assigned
+ * an integer ID indexing its definition in 'abs', and is found through a hash
+ * map from its name. The definitions of each relative symbol are kept sorted
+ * by source line, such that the nearest definition before or after any line is
+ * found through binary search.
+ */
 struct SymbolMap {
-  AbsoluteSymbolMap abs;
+  using SymbolID = unsigned;
   using RelativeSymbol = int;
   using SourceLine = unsigned;
-  std::map<RelativeSymbol, std::map<SourceLine, VIntS>> rel;
+
+  struct AbsSymbol {
+    Symbol symbol;
+    VIntS value;
+  };
+  struct RelSymbol {
+    SourceLine line;
+    VIntS value;
+  };
+
+  /// Absolute symbols, indexed by their ID, in order of definition.
+  std::vector<AbsSymbol> abs;
+  QHash<QString, SymbolID> ids;
+  /// Definitions of each relative symbol, sorted by source line.
+  std::map<RelativeSymbol, std::vector<RelSymbol>> rel;
 
   void clear() {
     abs.clear();
+    ids.clear();
     rel.clear();
   }
 
   std::optional<Error> addSymbol(const TokenizedSrcLine &line, const Symbol &s,
                                  VInt v) {
-    return s.isLocal() ? addRelSymbol(line.sourceLine(), s, v)
-                       : addAbsSymbol(line.sourceLine(), s, v);
+    return addSymbol(line.sourceLine(), s, v);
+  }
+
+  /// Adds the relative or absolute symbol @p s defined at source line @p line.
+  std::optional<Error> addSymbol(const unsigned &line, const Symbol &s,
+                                 VInt v) {
+    return s.isLocal() ? addRelSymbol(line, s, v) : addAbsSymbol(line, s, v);
   }
 
   /// Adds a symbol to the current symbol mapping of this assembler defined at
@@ -34,6 +66,10 @@ struct SymbolMap {
   std::optional<Error> addAbsSymbol(const unsigned &line, const Symbol &s,
                                     VInt v);
 
+  /// Defines the absolute symbol @p s as @p v, replacing any previous
+  /// definition of the symbol.
+  void setAbsSymbol(const Symbol &s, VInt v);
+
   /// Adds a relative symbol to this symbol map. A relative symbol is unqiued
   /// based on the tuple <symbol ID, source line>.
   std::optional<Error> addRelSymbol(const TokenizedSrcLine &line,
@@ -44,12 +80,26 @@ struct SymbolMap {
   std::optional<Error> addRelSymbol(const unsigned &line, const Symbol &s,
                                     VInt v);
 
-  /// Returns a copy of this symbol map with relative symbols copied relative to
-  /// 'line'. Relative symbols may be suffixed with additional strings in cases
-  /// of being before/after the provided source line.
-  AbsoluteSymbolMap copyRelativeTo(unsigned line,
-                                   const QString &beforeSuffix = "b",
-                                   const QString &afterSuffix = "f") const;
+  /// Returns the ID of the absolute symbol @p name, if defined.
+  std::optional<SymbolID> id(const QString &name) const {
+    auto it = ids.constFind(name);
+    if (it == ids.constEnd())
+      return {};
+    return it.value();
+  }
+
+  /// Returns the value of the symbol @p name as seen from source line @p line.
+  /// Relative symbols are referenced through being suffixed with
+  /// 'beforeSuffix' or 'afterSuffix', referring to the nearest definition
+  /// before or after @p line.
+  std::optional<VIntS> value(const QString &name, unsigned line) const;
+
+  static constexpr char beforeSuffix = 'b';
+  static constexpr char afterSuffix = 'f';
+
+private:
+  std::optional<VIntS> relValue(const std::vector<RelSymbol> &defs,
+                                unsigned line, bool after) const;
 };
 
 } // namespace Ripes
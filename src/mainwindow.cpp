@@ -2,9 +2,11 @@
 #include "ui_mainwindow.h"
 
 #include "cachetab.h"
+#include "comparisondialog.h"
 #include "edittab.h"
 #include "iotab.h"
 #include "loaddialog.h"
+#include "memoryfootprintdialog.h"
 #include "memorytab.h"
 #include "processorhandler.h"
 #include "processortab.h"
@@ -13,6 +15,7 @@
 #include "ripessettings.h"
 #include "savedialog.h"
 #include "settingsdialog.h"
+#include "simprofilerdialog.h"
 #include "syscall/syscallviewer.h"
 #include "syscall/systemio.h"
 #include "version/version.h"
@@ -134,6 +137,7 @@ MainWindow::MainWindow(QWidget *parent)
 
   connect(cacheTab, &CacheTab::focusAddressChanged, memoryTab,
           &MemoryTab::setCentralAddress);
+  processorTab->setCaches(cacheTab->instructionCache(), cacheTab->dataCache());
 
   connect(this, &MainWindow::prepareSave, editTab, &EditTab::onSave);
 
@@ -253,6 +257,22 @@ void MainWindow::setupMenus() {
   m_ui->menuView->addAction(
       static_cast<ProcessorTab *>(m_tabWidgets.at(ProcessorTabID).tab)
           ->m_displayValuesAction);
+  m_ui->menuView->addSeparator();
+  auto *simProfilerDialog = new SimProfilerDialog(this);
+  m_ui->menuView->addAction("Simulator performance...", this, [=] {
+    simProfilerDialog->show();
+    simProfilerDialog->raise();
+  });
+  auto *comparisonDialog = new ComparisonDialog(this);
+  m_ui->menuView->addAction("Compare runs...", this, [=] {
+    comparisonDialog->show();
+    comparisonDialog->raise();
+  });
+  auto *memoryFootprintDialog = new MemoryFootprintDialog(this);
+  m_ui->menuView->addAction("Memory footprint...", this, [=] {
+    memoryFootprintDialog->show();
+    memoryFootprintDialog->raise();
+  });
 
   // File I/O is not yet supported on WASM due to sandboxing.
   disableIfWasm(QList{loadAction, saveAction, saveAsAction, exitAction});
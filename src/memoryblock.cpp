@@ -0,0 +1,85 @@
+#include "memoryblock.h"
+#include "pagedmemory.h"
+
+#include <algorithm>
+
+namespace Ripes {
+namespace MemoryBlock {
+
+static constexpr unsigned s_wordBytes = sizeof(VInt);
+
+/// Returns the number of bytes from @p address up to the end of its word, or
+/// up to @p size. Returns 0 if the bytes are not all outside of IO regions, in
+/// which case they must be accessed byte by byte.
+static size_t wordBytes(const vsrtl::core::AddressSpace &memory, AInt address,
+                        size_t size) {
+  const size_t bytes =
+      std::min<size_t>(size, s_wordBytes - address % s_wordBytes);
+  using RegionType = vsrtl::core::AddressSpace::RegionType;
+  if (bytes == 1 || memory.regionType(address) == RegionType::IO ||
+      memory.regionType(address + bytes - 1) == RegionType::IO)
+    return 1;
+  return bytes;
+}
+
+void readBlock(const vsrtl::core::AddressSpace &memory, AInt address,
+               char *data, size_t size) {
+  while (size > 0) {
+    const size_t bytes = wordBytes(memory, address, size);
+    const VInt word = memory.readMemConst(address, bytes);
+    for (size_t i = 0; i < bytes; ++i)
+      data[i] = static_cast<char>(word >> (i * CHAR_BIT));
+    address += bytes;
+    data += bytes;
+    size -= bytes;
+  }
+}
+
+void writeBlock(vsrtl::core::AddressSpace &memory, AInt address,
+                const char *data, size_t size) {
+  while (size > 0) {
+    const size_t bytes = wordBytes(memory, address, size);
+    VInt word = 0;
+    for (size_t i = 0; i < bytes; ++i)
+      word |= VInt(static_cast<uint8_t>(data[i])) << (i * CHAR_BIT);
+    memory.writeMem(address, word, bytes);
+    address += bytes;
+    data += bytes;
+    size -= bytes;
+  }
+}
+
+size_t strnlen(const vsrtl::core::AddressSpace &memory, AInt address,
+               size_t maxLength) {
+  size_t length = 0;
+  while (length < maxLength) {
+    const size_t bytes = wordBytes(memory, address, maxLength - length);
+    const VInt word = memory.readMemConst(address, bytes);
+    for (size_t i = 0; i < bytes; ++i) {
+      if (((word >> (i * CHAR_BIT)) & 0xFF) == 0)
+        return length + i;
+    }
+    address += bytes;
+    length += bytes;
+  }
+  return maxLength;
+}
+
+void addInitializationMemory(vsrtl::core::AddressSpaceMM &memory,
+                             AInt address, const char *data, size_t size,
+                             std::shared_ptr<const void> owner) {
+  if (auto *paged = dynamic_cast<PagedMemory *>(&memory))
+    paged->addInitializationMemory(address, data, size, std::move(owner));
+  else
+    memory.addInitializationMemory(address, data, size);
+}
+
+void clearInitializationMemories(vsrtl::core::AddressSpaceMM &memory) {
+  if (auto *paged = dynamic_cast<PagedMemory *>(&memory))
+    paged->clearInitializationMemories();
+  else
+    memory.clearInitializationMemories();
+}
+
+} // namespace MemoryBlock
+} // namespace Ripes
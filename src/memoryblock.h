@@ -0,0 +1,44 @@
+#pragma once
+
+#include <climits>
+#include <cstddef>
+#include <memory>
+
+#include "VSRTL/core/vsrtl_addressspace.h"
+#include "isa/isa_types.h"
+
+namespace Ripes {
+
+/**
+ * Bulk accesses of the memory of a processor, for accesses which span more
+ * than a word, such as the buffers and strings of system calls. Memory outside
+ * of IO regions is accessed a word at a time, whereas IO regions are accessed
+ * a byte at a time, such that the side effects of IO accesses are preserved.
+ * IO regions are assumed to be word aligned.
+ */
+namespace MemoryBlock {
+
+/// Reads @p size bytes starting at @p address into @p data.
+void readBlock(const vsrtl::core::AddressSpace &memory, AInt address,
+               char *data, size_t size);
+
+/// Writes @p size bytes of @p data starting at @p address.
+void writeBlock(vsrtl::core::AddressSpace &memory, AInt address,
+                const char *data, size_t size);
+
+/// Returns the length of the null-terminated string at @p address, or
+/// @p maxLength if no null terminator is present within @p maxLength bytes.
+size_t strnlen(const vsrtl::core::AddressSpace &memory, AInt address,
+               size_t maxLength);
+
+/// Adds @p size bytes of @p data at @p address to the initialization memories
+/// of @p memory, which are loaded in bulk if @p memory is a PagedMemory. If
+/// @p owner is set, it owns @p data, which a PagedMemory references rather than
+/// copies.
+void addInitializationMemory(vsrtl::core::AddressSpaceMM &memory,
+                             AInt address, const char *data, size_t size,
+                             std::shared_ptr<const void> owner = {});
+void clearInitializationMemories(vsrtl::core::AddressSpaceMM &memory);
+
+} // namespace MemoryBlock
+} // namespace Ripes
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <vector>
+
+namespace Ripes {
+
+/**
+ * @brief The MemoryFootprint class
+ * Accounts the memory held by the components of Ripes which grow over the
+ * course of a session, for finding which component is responsible for a large
+ * process. Each instance of a component registers a MemoryFootprint::Source,
+ * which reports the bytes held by the instance, and the bytes of all sources
+ * of a component are summed when measured.
+ *
+ * The reported bytes are estimated from the sizes of the containers of each
+ * component, and exclude the overhead of the allocator. Sources are measured
+ * without synchronizing with the simulation thread, and should be measured
+ * while the processor is not running.
+ *
+ * A budget may be configured for each component, which measurements are
+ * checked against by overBudget().
+ */
+class MemoryFootprint {
+public:
+  enum Component {
+    RewindStacks,    // State saved for reversing the processor
+    CacheTraces,     // Access histories and undo traces of the caches
+    PipelineDiagram, // Recorded cycles of the pipeline diagram
+    Disassembly,     // Disassembled instructions of loaded programs
+    Console,         // Scrollback of the console
+    GuestMemory,     // Allocated pages of the memory of the processors
+    NComponents
+  };
+  using Measurement = std::array<size_t, NComponents>;
+
+  static const char *name(Component component) {
+    static const char *names[NComponents] = {
+        "Rewind stacks", "Cache traces", "Pipeline diagram",
+        "Disassembly",   "Console",      "Guest memory"};
+    return names[component];
+  }
+  /// Returns the name of @p component as given on the command line.
+  static const char *key(Component component) {
+    static const char *keys[NComponents] = {
+        "rewind", "cachetraces", "pipeline", "disassembly", "console",
+        "memory"};
+    return keys[component];
+  }
+
+  /// Registers the bytes of an instance of a component for as long as the
+  /// source lives.
+  class Source {
+  public:
+    Source(Component component, std::function<size_t()> bytes)
+        : m_component(component), m_bytes(std::move(bytes)) {
+      std::lock_guard lock(s_mutex);
+      s_sources.insert(this);
+    }
+    ~Source() {
+      std::lock_guard lock(s_mutex);
+      s_sources.erase(this);
+    }
+    Source(const Source &) = delete;
+    Source &operator=(const Source &) = delete;
+
+  private:
+    friend class MemoryFootprint;
+    Component m_component;
+    std::function<size_t()> m_bytes;
+  };
+
+  /// Returns the bytes held by each component.
+  static Measurement measure() {
+    Measurement measurement{};
+    std::lock_guard lock(s_mutex);
+    for (const auto *source : s_sources)
+      measurement[source->m_component] += source->m_bytes();
+    return measurement;
+  }
+
+  /// Sets the budget of @p component to @p bytes; 0 disables the budget.
+  static void setBudget(Component component, size_t bytes) {
+    s_budgets[component].store(bytes, std::memory_order_relaxed);
+  }
+  static size_t budget(Component component) {
+    return s_budgets[component].load(std::memory_order_relaxed);
+  }
+
+  /// Returns the components of @p measurement which exceed their budget.
+  static std::vector<Component> overBudget(const Measurement &measurement) {
+    std::vector<Component> components;
+    for (unsigned i = 0; i < NComponents; ++i) {
+      const size_t limit = budget(Component(i));
+      if (limit != 0 && measurement[i] > limit)
+        components.push_back(Component(i));
+    }
+    return components;
+  }
+
+private:
+  static inline std::mutex s_mutex;
+  static inline std::set<Source *> s_sources;
+  static inline std::array<std::atomic<size_t>, NComponents> s_budgets{};
+};
+
+} // namespace Ripes
@@ -0,0 +1,136 @@
+#include "memoryfootprintdialog.h"
+
+#include "processorhandler.h"
+#include "ripessettings.h"
+#include "statusmanager.h"
+
+#include <QHeaderView>
+#include <QLabel>
+#include <QTableWidget>
+#include <QVBoxLayout>
+
+#include <algorithm>
+
+namespace Ripes {
+
+// Interval between refreshes of the panel, in milliseconds.
+static constexpr int s_refreshInterval = 1000;
+// Interval between checks of the budgets, in milliseconds.
+static constexpr int s_checkInterval = 10000;
+
+static QString toMiB(size_t bytes) {
+  return QString::number(bytes / double(1 << 20), 'f', 2);
+}
+
+MemoryFootprintDialog::MemoryFootprintDialog(QWidget *parent)
+    : QDialog(parent) {
+  setWindowTitle("Memory footprint");
+
+  auto *description = new QLabel(
+      "Memory held by the components of Ripes which grow over the course of a "
+      "session. Sizes are estimated from the containers of each component, "
+      "and are measured while the processor is not running.",
+      this);
+  description->setWordWrap(true);
+
+  m_warning = new QLabel(this);
+  m_warning->setWordWrap(true);
+  m_warning->setStyleSheet("QLabel { color: red; }");
+  m_warning->hide();
+
+  m_table = new QTableWidget(MemoryFootprint::NComponents, 3, this);
+  m_table->setHorizontalHeaderLabels(
+      {"Component", "Size (MiB)", "Budget (MiB)"});
+  m_table->verticalHeader()->hide();
+  m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  m_table->setSelectionMode(QAbstractItemView::NoSelection);
+  m_table->horizontalHeader()->setSectionResizeMode(
+      0, QHeaderView::ResizeToContents);
+  m_table->horizontalHeader()->setStretchLastSection(true);
+  for (int i = 0; i < MemoryFootprint::NComponents; ++i) {
+    m_table->setItem(i, 0,
+                     new QTableWidgetItem(MemoryFootprint::name(
+                         MemoryFootprint::Component(i))));
+    for (int column = 1; column < 3; ++column) {
+      auto *item = new QTableWidgetItem();
+      item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+      m_table->setItem(i, column, item);
+    }
+  }
+
+  auto *layout = new QVBoxLayout(this);
+  layout->addWidget(description);
+  layout->addWidget(m_warning);
+  layout->addWidget(m_table);
+
+  connect(RipesSettings::getObserver(RIPES_SETTING_MEMORY_BUDGET),
+          &SettingObserver::modified, this,
+          &MemoryFootprintDialog::applyBudget);
+  applyBudget(RipesSettings::value(RIPES_SETTING_MEMORY_BUDGET));
+
+  m_refreshTimer.setInterval(s_refreshInterval);
+  connect(&m_refreshTimer, &QTimer::timeout, this,
+          &MemoryFootprintDialog::refresh);
+  m_checkTimer.setInterval(s_checkInterval);
+  connect(&m_checkTimer, &QTimer::timeout, this,
+          &MemoryFootprintDialog::checkBudgets);
+  m_checkTimer.start();
+}
+
+void MemoryFootprintDialog::showEvent(QShowEvent *event) {
+  refresh();
+  m_refreshTimer.start();
+  QDialog::showEvent(event);
+}
+
+void MemoryFootprintDialog::hideEvent(QHideEvent *event) {
+  m_refreshTimer.stop();
+  QDialog::hideEvent(event);
+}
+
+void MemoryFootprintDialog::applyBudget(const QVariant &mib) {
+  const size_t bytes = size_t(std::max(0, mib.toInt())) << 20;
+  for (int i = 0; i < MemoryFootprint::NComponents; ++i)
+    MemoryFootprint::setBudget(MemoryFootprint::Component(i), bytes);
+}
+
+void MemoryFootprintDialog::refresh() {
+  // The components are modified by the simulation thread while running.
+  if (ProcessorHandler::isRunning())
+    return;
+  const auto measurement = MemoryFootprint::measure();
+  QStringList exceeding;
+  for (int i = 0; i < MemoryFootprint::NComponents; ++i) {
+    const auto component = MemoryFootprint::Component(i);
+    const size_t budget = MemoryFootprint::budget(component);
+    const bool over = budget != 0 && measurement[i] > budget;
+    m_table->item(i, 1)->setText(toMiB(measurement[i]));
+    m_table->item(i, 2)->setText(budget == 0 ? "-" : toMiB(budget));
+    m_table->item(i, 1)->setForeground(over ? QBrush(Qt::red) : QBrush());
+    if (over)
+      exceeding << MemoryFootprint::name(component);
+  }
+  m_warning->setText("Exceeding the memory budget: " + exceeding.join(", "));
+  m_warning->setVisible(!exceeding.empty());
+}
+
+void MemoryFootprintDialog::checkBudgets() {
+  if (ProcessorHandler::isRunning())
+    return;
+  const auto measurement = MemoryFootprint::measure();
+  std::array<bool, MemoryFootprint::NComponents> overBudget{};
+  for (const auto component : MemoryFootprint::overBudget(measurement)) {
+    overBudget[component] = true;
+    // Each component is reported once when it exceeds its budget.
+    if (!m_overBudget[component])
+      GeneralStatusManager::setStatusTimed(
+          QString(MemoryFootprint::name(component)) + ": " +
+              toMiB(measurement[component]) +
+              " MiB, exceeding the memory budget (see View > Memory "
+              "footprint...)",
+          5000);
+  }
+  m_overBudget = overBudget;
+}
+
+} // namespace Ripes
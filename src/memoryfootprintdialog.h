@@ -0,0 +1,46 @@
+#pragma once
+
+#include <QDialog>
+#include <QTimer>
+
+#include <array>
+
+#include "memoryfootprint.h"
+
+class QLabel;
+class QTableWidget;
+
+namespace Ripes {
+
+/**
+ * @brief The MemoryFootprintDialog class
+ * The "Memory footprint" panel. Shows the bytes held by each component of
+ * Ripes (see MemoryFootprint), refreshed while the panel is visible. The budget
+ * of each component is RIPES_SETTING_MEMORY_BUDGET; the footprint is checked
+ * periodically while the processor is not running, and a component exceeding
+ * its budget is reported in the status bar.
+ */
+class MemoryFootprintDialog : public QDialog {
+  Q_OBJECT
+
+public:
+  explicit MemoryFootprintDialog(QWidget *parent = nullptr);
+
+protected:
+  void showEvent(QShowEvent *event) override;
+  void hideEvent(QHideEvent *event) override;
+
+private:
+  void refresh();
+  void checkBudgets();
+  void applyBudget(const QVariant &mib);
+
+  QTableWidget *m_table = nullptr;
+  QLabel *m_warning = nullptr;
+  QTimer m_refreshTimer;
+  QTimer m_checkTimer;
+  // Components which exceeded their budget when last checked.
+  std::array<bool, MemoryFootprint::NComponents> m_overBudget{};
+};
+
+} // namespace Ripes
@@ -4,11 +4,42 @@
 #include <QFont>
 
 #include "fonts.h"
+#include "io/iomanager.h"
 #include "processorhandler.h"
 
 namespace Ripes {
 
-MemoryModel::MemoryModel(QObject *parent) : QAbstractTableModel(parent) {}
+MemoryModel::MemoryModel(QObject *parent) : QAbstractTableModel(parent) {
+  // Writes by the processor are recorded whilst clocking, which may happen on
+  // the thread of a run. Any other change to the memory of the processor is
+  // a change to its state, and invalidates the snapshot.
+  connect(
+      ProcessorHandler::get(), &ProcessorHandler::processorClocked, this,
+      [=] {
+        const auto access = ProcessorHandler::getProcessor()->dataMemAccess();
+        if (access.type == MemoryAccess::Write)
+          memoryWritten(access.address, access.bytes);
+      },
+      Qt::DirectConnection);
+  connect(
+      ProcessorHandler::get(), &ProcessorHandler::processorClockedBatch, this,
+      [=] {
+        for (const auto &record :
+             ProcessorHandler::getProcessor()->clockBatch())
+          if (record.dataAccess.type == MemoryAccess::Write)
+            memoryWritten(record.dataAccess.address, record.dataAccess.bytes);
+      },
+      Qt::DirectConnection);
+  connect(
+      ProcessorHandler::get(), &ProcessorHandler::syscallExecuted, this,
+      [=] { memoryChanged(); }, Qt::DirectConnection);
+  for (auto signal : {&ProcessorHandler::processorReset,
+                      &ProcessorHandler::processorReversed,
+                      &ProcessorHandler::processorChanged})
+    connect(
+        ProcessorHandler::get(), signal, this, [=] { memoryChanged(); },
+        Qt::DirectConnection);
+}
 
 int MemoryModel::columnCount(const QModelIndex &) const {
   return FIXED_COLUMNS_CNT +
@@ -17,9 +48,54 @@ int MemoryModel::columnCount(const QModelIndex &) const {
 
 int MemoryModel::rowCount(const QModelIndex &) const { return m_rowsVisible; }
 
+void MemoryModel::memoryWritten(AInt address, unsigned bytes) {
+  if (address + bytes > m_viewFirst.load() && address <= m_viewLast.load())
+    memoryChanged();
+}
+
+bool MemoryModel::viewsIOMemory() const {
+  for (const auto &it : IOManager::get().memoryMap()) {
+    const auto &entry = it.second;
+    if (entry.startAddr <= m_viewLast.load() &&
+        entry.startAddr + entry.size > m_viewFirst.load())
+      return true;
+  }
+  return false;
+}
+
 void MemoryModel::processorWasClocked() {
-  // Reload model
+  const unsigned long version = m_memoryVersion.load();
+  if (version == m_snapshotVersion && !viewsIOMemory())
+    return;
+
+  auto rows = snapshot();
+  m_snapshotVersion = version;
+  if (rows.size() != m_rows.size()) {
+    beginResetModel();
+    m_rows = std::move(rows);
+    endResetModel();
+    return;
+  }
+
+  // Redraw the rows which changed since the previous snapshot, merging
+  // adjacent rows into a single range.
+  const int lastColumn = columnCount() - 1;
+  std::swap(m_rows, rows);
+  for (unsigned first = 0; first < m_rows.size(); ++first) {
+    if (m_rows.at(first) == rows.at(first))
+      continue;
+    unsigned last = first;
+    while (last + 1 < m_rows.size() && m_rows.at(last + 1) != rows.at(last + 1))
+      ++last;
+    emit dataChanged(index(first, 0), index(last, lastColumn));
+    first = last;
+  }
+}
+
+void MemoryModel::resetView() {
   beginResetModel();
+  m_snapshotVersion = m_memoryVersion.load();
+  m_rows = snapshot();
   endResetModel();
 }
 
@@ -30,7 +106,7 @@ AInt maxAddress() {
 void MemoryModel::setCentralAddress(AInt address) {
   address = address - (address % ProcessorHandler::currentISA()->bytes());
   m_centralAddress = address;
-  processorWasClocked();
+  resetView();
 }
 
 // Checks whether an overflow or underflow error occurred when calculating the
@@ -56,7 +132,7 @@ void MemoryModel::offsetCentralAddress(int rowOffset) {
   m_centralAddress = validAddressChange(m_centralAddress, newCenterAddress)
                          ? newCenterAddress
                          : m_centralAddress;
-  processorWasClocked();
+  resetView();
 }
 
 QVariant MemoryModel::headerData(int section, Qt::Orientation orientation,
@@ -76,7 +152,56 @@ QVariant MemoryModel::headerData(int section, Qt::Orientation orientation,
 
 void MemoryModel::setRowsVisible(int rows) {
   m_rowsVisible = rows;
-  processorWasClocked();
+  resetView();
+}
+
+AInt MemoryModel::rowAddress(int row, bool &validAddress) const {
+  // Calculate the word-aligned address corresponding to the row. If the
+  // central address is at one of its two extrema, based on the address space
+  // of the processor, the aligned address is invalid.
+  const auto bytes = ProcessorHandler::currentISA()->bytes();
+  const AInt alignedAddress =
+      static_cast<AInt>(m_centralAddress) +
+      ((((m_rowsVisible * bytes) / 2) / bytes) * bytes) - (row * bytes);
+  validAddress = validAddressChange(m_centralAddress, alignedAddress);
+  return alignedAddress;
+}
+
+std::vector<MemoryModel::Row> MemoryModel::snapshot() {
+  const unsigned bytes = ProcessorHandler::currentISA()->bytes();
+  auto &memory = ProcessorHandler::getMemory();
+  std::vector<Row> rows(m_rowsVisible);
+  AInt first = 0, last = 0;
+  for (int i = 0; i < m_rowsVisible; ++i) {
+    Row &row = rows.at(i);
+    row.address = rowAddress(i, row.valid);
+    if (!row.valid)
+      continue;
+    // Rows are in order of descending addresses.
+    last = i == 0 ? row.address + bytes - 1 : last;
+    first = row.address;
+
+    // Memory which is not present is not read, given that reading it would
+    // create an entry in the memory.
+    for (unsigned j = 0; j < bytes; ++j)
+      if (memory.contains(row.address + j))
+        row.present |= 1 << j;
+    if (row.present == 0)
+      continue;
+    if (row.present & 1)
+      row.word = memory.readMemConst(row.address, bytes);
+    for (unsigned j = 0; j < bytes; ++j) {
+      if (!(row.present & (1 << j)))
+        continue;
+      // The bytes of a word are served from a single read of the word.
+      row.bytes[j] = row.present == (1 << bytes) - 1
+                         ? (row.word >> (j * CHAR_BIT)) & 0xFF
+                         : memory.readMemConst(row.address + j, 1) & 0xFF;
+    }
+  }
+  m_viewFirst = first;
+  m_viewLast = last;
+  return rows;
 }
 
 QVariant MemoryModel::data(const QModelIndex &index, int role) const {
@@ -91,42 +216,20 @@ QVariant MemoryModel::data(const QModelIndex &index, int role) const {
     return QFont(Fonts::monospace, 11);
   }
 
-  const auto bytes = ProcessorHandler::currentISA()->bytes();
-  // Calculate the word-aligned address corresponding to the row of the current
-  // index. If the central address is at one of its two extrema, based on the
-  // address space of the processor, the aligned address is invalid.
-  /*
-  AInt alignedAddress;
-  bool validAddress = true;
-  if (m_centralAddress == 0x0) {
-      validAddress &= index.row() < m_rowsVisible / 2;
-  }
-  if (m_centralAddress >= maxAddress()) {
-      validAddress &= index.row() > m_rowsVisible / 2;
-  }
-  if (validAddress) {
-      alignedAddress = static_cast<AInt>(m_centralAddress) + ((((m_rowsVisible *
-  bytes) / 2) / bytes) * bytes) - (index.row() * bytes);
-  }
-*/
-
-  const AInt alignedAddress =
-      static_cast<AInt>(m_centralAddress) +
-      ((((m_rowsVisible * bytes) / 2) / bytes) * bytes) - (index.row() * bytes);
-  const bool validAddress =
-      validAddressChange(m_centralAddress, alignedAddress);
-
+  if (index.row() >= static_cast<int>(m_rows.size()))
+    return QVariant();
+  const Row &row = m_rows.at(index.row());
   const unsigned byteOffset = index.column() - FIXED_COLUMNS_CNT;
 
   if (index.column() == Column::Address) {
     if (role == Qt::DisplayRole) {
-      return addrData(alignedAddress, validAddress);
+      return addrData(row);
     } else if (role == Qt::ForegroundRole) {
       // Assign a brush if one of the byte-indexed address covered by the
       // aligned address has been written to
       QVariant unusedAddressBrush;
       for (unsigned i = 0; i < ProcessorHandler::currentISA()->bytes(); ++i) {
-        QVariant addressBrush = fgColorData(alignedAddress, i, validAddress);
+        QVariant addressBrush = fgColorData(row, i);
         if (addressBrush.isNull()) {
           return addressBrush;
         } else {
@@ -138,14 +241,13 @@ QVariant MemoryModel::data(const QModelIndex &index, int role) const {
   } else {
     switch (role) {
     case Qt::ForegroundRole:
-      return fgColorData(alignedAddress,
-                         index.column() == Column::WordValue ? 0 : byteOffset,
-                         validAddress);
+      return fgColorData(
+          row, index.column() == Column::WordValue ? 0 : byteOffset);
     case Qt::DisplayRole:
       if (index.column() == Column::WordValue) {
-        return wordData(alignedAddress, validAddress);
+        return wordData(row);
       } else {
-        return byteData(alignedAddress, byteOffset, validAddress);
+        return byteData(row, byteOffset);
       }
     default:
       break;
@@ -157,54 +259,47 @@ QVariant MemoryModel::data(const QModelIndex &index, int role) const {
 
 void MemoryModel::setRadix(Radix r) {
   m_radix = r;
-  processorWasClocked();
+  resetView();
 }
 
-QVariant MemoryModel::addrData(AInt address, bool validAddress) const {
-  if (!validAddress) {
+QVariant MemoryModel::addrData(const Row &row) const {
+  if (!row.valid) {
     return "-";
   }
-  return encodeRadixValue(address, Radix::Hex,
+  return encodeRadixValue(row.address, Radix::Hex,
                           ProcessorHandler::currentISA()->bytes());
 }
 
-QVariant MemoryModel::fgColorData(AInt address, AInt byteOffset,
-                                  bool validAddress) const {
-  if (!validAddress ||
-      !ProcessorHandler::getMemory().contains(address + byteOffset)) {
+QVariant MemoryModel::fgColorData(const Row &row, AInt byteOffset) const {
+  if (!row.valid || !(row.present & (1 << byteOffset))) {
     return QBrush(Qt::lightGray);
   } else {
     return QVariant(); // default
   }
 }
 
-QVariant MemoryModel::byteData(AInt address, AInt byteOffset,
-                               bool validAddress) const {
-  if (!validAddress) {
+QVariant MemoryModel::byteData(const Row &row, AInt byteOffset) const {
+  if (!row.valid) {
     return "-";
-  } else if (!ProcessorHandler::getMemory().contains(address + byteOffset)) {
-    // Dont read the memory (this will create an entry in the memory if done
-    // so). Instead, create a "fake" entry in the memory model, containing X's.
+  } else if (!(row.present & (1 << byteOffset))) {
+    // The memory is not read (this would create an entry in the memory).
+    // Instead, show a "fake" entry in the memory model, containing X's.
     return "X";
   } else {
-    VInt value =
-        ProcessorHandler::getMemory().readMemConst(address + byteOffset, 1);
-    return encodeRadixValue(value & 0xFF, m_radix, 1);
+    return encodeRadixValue(row.bytes.at(byteOffset), m_radix, 1);
   }
 }
 
-QVariant MemoryModel::wordData(AInt address, bool validAddress) const {
-  if (!validAddress) {
+QVariant MemoryModel::wordData(const Row &row) const {
+  if (!row.valid) {
     return "-";
-  } else if (!ProcessorHandler::getMemory().contains(address)) {
-    // Dont read the memory (this will create an entry in the memory if done
-    // so). Instead, create a "fake" entry in the memory model, containing X's.
+  } else if (!(row.present & 1)) {
+    // The memory is not read (this would create an entry in the memory).
+    // Instead, show a "fake" entry in the memory model, containing X's.
     return "X";
   } else {
-    unsigned bytes = ProcessorHandler::currentISA()->bytes();
-    return encodeRadixValue(
-        ProcessorHandler::getMemory().readMemConst(address, bytes), m_radix,
-        bytes);
+    return encodeRadixValue(row.word, m_radix,
+                            ProcessorHandler::currentISA()->bytes());
   }
 }
 
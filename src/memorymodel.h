@@ -2,6 +2,10 @@
 
 #include <QAbstractTableModel>
 
+#include <array>
+#include <atomic>
+#include <vector>
+
 #include "radix.h"
 
 namespace Ripes {
@@ -25,6 +29,10 @@ public:
   void setRadix(Radix r);
   Radix getRadix() const { return m_radix; }
 
+  /// Returns the word-aligned address of @p row, and whether the address is
+  /// valid within the address space of the processor.
+  AInt rowAddress(int row, bool &validAddress) const;
+
 public slots:
   void processorWasClocked();
   void setRowsVisible(int rows);
@@ -32,15 +40,60 @@ public slots:
   void setCentralAddress(Ripes::AInt address);
 
 private:
-  QVariant addrData(AInt address, bool validAddress) const;
-  QVariant byteData(AInt address, AInt byteOffset, bool validAddress) const;
-  QVariant wordData(AInt address, bool validAddress) const;
-  QVariant fgColorData(AInt address, AInt byteOffset, bool validAddress) const;
+  /// The contents of a row of the model, as of the latest snapshot.
+  struct Row {
+    AInt address = 0;
+    bool valid = false;
+    /// Bit i is set if byte i of the row is present in memory.
+    uint8_t present = 0;
+    std::array<uint8_t, sizeof(VInt)> bytes{};
+    VInt word = 0;
+    bool operator==(const Row &other) const {
+      return address == other.address && valid == other.valid &&
+             present == other.present && bytes == other.bytes &&
+             word == other.word;
+    }
+    bool operator!=(const Row &other) const { return !(*this == other); }
+  };
+
+  /// Reads the rows in view from memory, and records the address range of
+  /// the view.
+  std::vector<Row> snapshot();
+  /// Takes a snapshot of the rows in view and resets the model, for changes to
+  /// the viewport or presentation of the model.
+  void resetView();
+  /// Records that memory may have changed since the latest snapshot.
+  void memoryChanged() { m_memoryVersion.fetch_add(1); }
+  /// Records a write of @p bytes at @p address, if within the view.
+  void memoryWritten(AInt address, unsigned bytes);
+  /// Returns true if the view covers the memory of an I/O device, the memory
+  /// of which may change without being written to by the processor.
+  bool viewsIOMemory() const;
+
+  QVariant addrData(const Row &row) const;
+  QVariant byteData(const Row &row, AInt byteOffset) const;
+  QVariant wordData(const Row &row) const;
+  QVariant fgColorData(const Row &row, AInt byteOffset) const;
 
   Radix m_radix = Radix::Hex;
 
   AInt m_centralAddress = 0; // Memory address at the center of the model
   int m_rowsVisible = 0;     // Number of rows currently visible in the view
                              // associated with the model
+
+  /**
+   * @brief m_rows
+   * Snapshot of the rows in view, from which data() is served. A refresh
+   * only takes a new snapshot if memory may have changed since the snapshot
+   * was taken, as recorded by the version stamps, and only redraws the rows
+   * which differ from the previous snapshot.
+   */
+  std::vector<Row> m_rows;
+  unsigned long m_snapshotVersion = 0;
+  std::atomic<unsigned long> m_memoryVersion{1};
+  // Address range [first, last] of the snapshot, for filtering writes made
+  // by the processor whilst running on another thread.
+  std::atomic<AInt> m_viewFirst{0};
+  std::atomic<AInt> m_viewLast{0};
 };
 } // namespace Ripes
@@ -0,0 +1,210 @@
+#include "memorysearch.h"
+
+#include <QRegularExpression>
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+#include "isa/isa_defines.h"
+#include "memoryblock.h"
+#include "pagedmemory.h"
+
+namespace Ripes {
+
+static_assert(MemorySearch::s_pageBits == PagedMemory::s_pageBits,
+              "Searched pages must be the pages of PagedMemory");
+
+namespace {
+
+std::optional<uint64_t> parseInteger(const QString &text, unsigned width,
+                                     QString &error) {
+  bool ok;
+  const QString trimmed = text.trimmed();
+  const int64_t value = getImmediate(trimmed, ok);
+  if (!ok) {
+    error = "Invalid integer '" + trimmed + "'";
+    return {};
+  }
+  // Values must be representable as signed or unsigned integers of the width.
+  if (width < sizeof(uint64_t)) {
+    const int64_t upper = value >> (width * CHAR_BIT);
+    if (upper != 0 && upper != -1) {
+      error = "'" + trimmed + "' does not fit in " + QString::number(width) +
+              " bytes";
+      return {};
+    }
+  }
+  return static_cast<uint64_t>(value);
+}
+
+std::vector<uint8_t> littleEndian(uint64_t value, unsigned width) {
+  std::vector<uint8_t> bytes(width);
+  for (auto &byte : bytes) {
+    byte = static_cast<uint8_t>(value);
+    value >>= CHAR_BIT;
+  }
+  return bytes;
+}
+
+} // namespace
+
+std::optional<MemorySearch::Pattern>
+MemorySearch::parse(Kind kind, const QString &text, unsigned width,
+                    const QString &mask, QString &error) {
+  Pattern pattern;
+  switch (kind) {
+  case Kind::Bytes: {
+    const QString digits = QString(text).remove(QRegularExpression("\\s"));
+    if (digits.isEmpty() || digits.size() % 2 != 0) {
+      error = "Bytes must be given as pairs of hexadecimal digits";
+      return {};
+    }
+    bool masked = false;
+    for (int i = 0; i < digits.size(); i += 2) {
+      uint8_t byte = 0, byteMask = 0;
+      for (int j = 0; j < 2; j++) {
+        const QChar ch = digits.at(i + j);
+        const unsigned shift = j == 0 ? 4 : 0;
+        bool ok;
+        const unsigned nibble = QString(ch).toUInt(&ok, 16);
+        if (ch == '?') {
+          masked = true;
+        } else if (ok) {
+          byte |= nibble << shift;
+          byteMask |= 0xF << shift;
+        } else {
+          error = "Invalid byte '" + digits.mid(i, 2) + "'";
+          return {};
+        }
+      }
+      pattern.bytes.push_back(byte);
+      pattern.mask.push_back(byteMask);
+    }
+    if (!masked)
+      pattern.mask.clear();
+    break;
+  }
+  case Kind::String: {
+    const QByteArray utf8 = text.toUtf8();
+    if (utf8.isEmpty()) {
+      error = "Empty string";
+      return {};
+    }
+    pattern.bytes.assign(utf8.begin(), utf8.end());
+    break;
+  }
+  case Kind::Value: {
+    const auto value = parseInteger(text, width, error);
+    if (!value)
+      return {};
+    pattern.bytes = littleEndian(*value, width);
+    if (!mask.trimmed().isEmpty()) {
+      const auto maskValue = parseInteger(mask, width, error);
+      if (!maskValue)
+        return {};
+      pattern.mask = littleEndian(*maskValue, width);
+    }
+    break;
+  }
+  }
+  return pattern;
+}
+
+MemorySearch::MemorySearch(const vsrtl::core::AddressSpace &memory,
+                           std::vector<AInt> pages)
+    : m_memory(memory), m_paged(dynamic_cast<const PagedMemory *>(&memory)),
+      m_pages(std::move(pages)) {
+  for (auto &page : m_pages)
+    page &= ~(s_pageSize - 1);
+  std::sort(m_pages.begin(), m_pages.end());
+  m_pages.erase(std::unique(m_pages.begin(), m_pages.end()), m_pages.end());
+}
+
+std::vector<AInt> MemorySearch::pages(AInt from) const {
+  if (m_paged)
+    return m_paged->allocatedPageAddresses(from);
+  return {std::lower_bound(m_pages.begin(), m_pages.end(),
+                           from & ~(s_pageSize - 1)),
+          m_pages.end()};
+}
+
+const uint8_t *MemorySearch::pageBytes(AInt base) const {
+  if (m_paged)
+    return m_paged->pageBytes(base);
+  MemoryBlock::readBlock(m_memory, base, reinterpret_cast<char *>(&m_buffer[0]),
+                         s_pageSize);
+  return m_buffer.data();
+}
+
+bool MemorySearch::byteAt(AInt address, uint8_t &byte) const {
+  if (m_paged) {
+    const uint8_t *bytes = m_paged->pageBytes(address);
+    if (bytes)
+      byte = bytes[address & (s_pageSize - 1)];
+    return bytes;
+  }
+  if (!std::binary_search(m_pages.begin(), m_pages.end(),
+                          address & ~(s_pageSize - 1)))
+    return false;
+  byte = static_cast<uint8_t>(m_memory.readMemConst(address, 1));
+  return true;
+}
+
+std::optional<AInt> MemorySearch::findNext(const Pattern &pattern,
+                                           AInt from) const {
+  const size_t size = pattern.bytes.size();
+  if (size == 0)
+    return {};
+  const auto maskAt = [&](size_t i) -> uint8_t {
+    return pattern.mask.empty() ? 0xFF : pattern.mask[i];
+  };
+  // Candidates are located by the first byte which is compared in full.
+  size_t anchor = 0;
+  while (anchor < size && maskAt(anchor) != 0xFF)
+    anchor++;
+
+  const auto matches = [&](AInt base, const uint8_t *bytes, AInt offset) {
+    for (size_t i = 0; i < size; i++) {
+      uint8_t byte;
+      if (offset + i < s_pageSize)
+        byte = bytes[offset + i];
+      else if (!byteAt(base + offset + i, byte))
+        return false;
+      if ((byte ^ pattern.bytes[i]) & maskAt(i))
+        return false;
+    }
+    return true;
+  };
+
+  for (const AInt base : pages(from)) {
+    const uint8_t *bytes = pageBytes(base);
+    if (!bytes)
+      continue;
+    AInt offset = from > base ? from - base : 0;
+    while (offset < s_pageSize) {
+      const AInt start = offset + anchor;
+      // Patterns without a byte compared in full, and positions whose anchor
+      // lies in the next page, are compared at every position.
+      if (anchor == size || start >= s_pageSize) {
+        if (matches(base, bytes, offset))
+          return base + offset;
+        offset++;
+        continue;
+      }
+      const void *found = std::memchr(bytes + start, pattern.bytes[anchor],
+                                      s_pageSize - start);
+      if (!found) {
+        offset = s_pageSize - anchor;
+        continue;
+      }
+      offset = static_cast<const uint8_t *>(found) - bytes - anchor;
+      if (matches(base, bytes, offset))
+        return base + offset;
+      offset++;
+    }
+  }
+  return {};
+}
+
+} // namespace Ripes
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <QString>
+
+#include <array>
+#include <optional>
+#include <vector>
+
+#include "VSRTL/core/vsrtl_addressspace.h"
+#include "isa/isa_types.h"
+
+namespace Ripes {
+
+class PagedMemory;
+
+/**
+ * @brief The MemorySearch class
+ * Searches the memory of a processor for patterns of bytes. All allocated
+ * pages of a PagedMemory are searched in place; other memories are searched
+ * within a given set of pages, which are read a page at a time.
+ *
+ * Candidate matches are located by memchr on a byte of the pattern which is
+ * compared in full, which the C library vectorizes, and are then compared in
+ * full. Matches may span consecutive pages, but not unallocated pages.
+ */
+class MemorySearch {
+public:
+  static constexpr unsigned s_pageBits = 12;
+  static constexpr AInt s_pageSize = AInt(1) << s_pageBits;
+
+  struct Pattern {
+    std::vector<uint8_t> bytes;
+    /// The bits of each byte which are compared; all bits if empty.
+    std::vector<uint8_t> mask;
+  };
+
+  enum class Kind { Bytes, String, Value };
+
+  /**
+   * @brief parse
+   * Parses @p text as a pattern of @p kind:
+   * - Bytes: hexadecimal bytes, where '?' matches any nibble, eg. "de b? ef".
+   * - String: the characters of @p text, encoded as UTF-8.
+   * - Value: an integer of @p width bytes, stored as little endian. If @p mask
+   *   is not empty, only the bits set in the integer @p mask are compared.
+   * Returns nothing and sets @p error if @p text or @p mask is invalid.
+   */
+  static std::optional<Pattern> parse(Kind kind, const QString &text,
+                                      unsigned width, const QString &mask,
+                                      QString &error);
+
+  /// Searches the allocated pages of @p memory if a PagedMemory, and
+  /// otherwise the pages at the base addresses @p pages.
+  explicit MemorySearch(const vsrtl::core::AddressSpace &memory,
+                        std::vector<AInt> pages = {});
+
+  /// Returns the address of the first match of @p pattern at or after
+  /// @p from, if any.
+  std::optional<AInt> findNext(const Pattern &pattern, AInt from) const;
+
+private:
+  std::vector<AInt> pages(AInt from) const;
+  /// Returns the bytes of the page at @p base.
+  const uint8_t *pageBytes(AInt base) const;
+  /// Reads the byte at @p address, returning false if it is not searched.
+  bool byteAt(AInt address, uint8_t &byte) const;
+
+  const vsrtl::core::AddressSpace &m_memory;
+  const PagedMemory *m_paged = nullptr;
+  std::vector<AInt> m_pages;
+  mutable std::array<uint8_t, s_pageSize> m_buffer;
+};
+
+} // namespace Ripes
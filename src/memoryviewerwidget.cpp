@@ -1,15 +1,21 @@
 #include "memoryviewerwidget.h"
 #include "ui_memoryviewerwidget.h"
 
+#include <QComboBox>
 #include <QHBoxLayout>
 #include <QLabel>
+#include <QLineEdit>
+#include <QMenu>
+#include <QPushButton>
 #include <QTableView>
 
 #include "flowlayout.h"
 #include "gotocombobox.h"
 #include "memorymodel.h"
+#include "memorysearch.h"
 #include "processorhandler.h"
 #include "radixselectorwidget.h"
+#include "statusmanager.h"
 
 namespace Ripes {
 
@@ -32,6 +38,41 @@ MemoryViewerWidget::MemoryViewerWidget(QWidget *parent)
           this, [=] { this->updateView(); });
   connect(ProcessorHandler::get(), &ProcessorHandler::memoryFocusAddressChanged,
           this, &MemoryViewerWidget::setCentralAddress);
+
+  m_ui->memoryView->setContextMenuPolicy(Qt::CustomContextMenu);
+  connect(m_ui->memoryView, &QTableView::customContextMenuRequested, this,
+          &MemoryViewerWidget::showContextMenu);
+}
+
+void MemoryViewerWidget::showContextMenu(const QPoint &pos) {
+  const auto index = m_ui->memoryView->indexAt(pos);
+  if (!index.isValid())
+    return;
+  bool validAddress;
+  const AInt address = m_memoryModel->rowAddress(index.row(), validAddress);
+  if (!validAddress)
+    return;
+
+  // Watchpoints cover the word of the row.
+  auto &watchpoints = ProcessorHandler::watchpoints();
+  const unsigned wordBytes = ProcessorHandler::currentISA()->bytes();
+  const auto watched = watchpoints.memoryAccess(address);
+  QMenu menu;
+  for (const auto &[text, access] :
+       {std::make_pair("Watch reads", Watchpoints::Read),
+        std::make_pair("Watch writes", Watchpoints::Write)}) {
+    auto *action = menu.addAction(text);
+    action->setCheckable(true);
+    action->setChecked(watched & access);
+    connect(action, &QAction::toggled, [&, access = access](bool enabled) {
+      const unsigned remaining =
+          enabled ? watched | access : watched & ~access;
+      watchpoints.removeMemory(address);
+      if (remaining != 0)
+        watchpoints.addMemory({address, address + wordBytes - 1, remaining});
+    });
+  }
+  menu.exec(m_ui->memoryView->viewport()->mapToGlobal(pos));
 }
 
 MemoryViewerWidget::~MemoryViewerWidget() { delete m_ui; }
@@ -57,13 +98,107 @@ void MemoryViewerWidget::setupNavigationWidgets() {
   layout->addWidget(new QLabel("Go to section: ", m_ui->flowParentLayout));
   layout->addWidget(m_goToSection);
   flowLayout->addItem(layout);
+
+  // Patterns are searched as bytes, strings or values of a given width, the
+  // latter being stored in the item data of the kinds.
+  m_findPattern = new QLineEdit(m_ui->flowParentLayout);
+  m_findPattern->setPlaceholderText("de ad b? ef");
+  m_findKind = new QComboBox(m_ui->flowParentLayout);
+  m_findKind->addItem("Bytes", 0);
+  m_findKind->addItem("String", 0);
+  for (const auto &[name, width] :
+       {std::make_pair("Byte", 1), std::make_pair("Half", 2),
+        std::make_pair("Word", 4), std::make_pair("Double", 8)})
+    m_findKind->addItem(name, width);
+  m_findMask = new QLineEdit(m_ui->flowParentLayout);
+  m_findMask->setPlaceholderText("Mask");
+  m_findMask->setToolTip("Bits of the value which are compared");
+  m_findMask->setEnabled(false);
+  auto *findButton = new QPushButton("Find next", m_ui->flowParentLayout);
+
+  connect(m_findKind, QOverload<int>::of(&QComboBox::currentIndexChanged), this,
+          [=](int index) {
+            m_findMask->setEnabled(m_findKind->itemData(index).toInt() != 0);
+            m_findPattern->setPlaceholderText(index == 0 ? "de ad b? ef" : "");
+            m_lastMatch.reset();
+          });
+  for (auto *edit : {m_findPattern, m_findMask}) {
+    connect(edit, &QLineEdit::textEdited, this, [=] { m_lastMatch.reset(); });
+    connect(edit, &QLineEdit::returnPressed, this,
+            &MemoryViewerWidget::findNext);
+  }
+  connect(findButton, &QPushButton::clicked, this,
+          &MemoryViewerWidget::findNext);
+  // Matches are searched anew once the memory may have changed.
+  connect(ProcessorHandler::get(), &ProcessorHandler::procStateChangedNonRun,
+          this, [=] { m_lastMatch.reset(); });
+
+  layout = new QHBoxLayout();
+  layout->addWidget(new QLabel("Find: ", m_ui->flowParentLayout));
+  layout->addWidget(m_findPattern);
+  layout->addWidget(m_findKind);
+  layout->addWidget(m_findMask);
+  layout->addWidget(findButton);
+  flowLayout->addItem(layout);
+}
+
+void MemoryViewerWidget::findNext() {
+  const int index = m_findKind->currentIndex();
+  const unsigned width = m_findKind->itemData(index).toUInt();
+  const auto kind = index == 0   ? MemorySearch::Kind::Bytes
+                    : width == 0 ? MemorySearch::Kind::String
+                                 : MemorySearch::Kind::Value;
+  QString error;
+  const auto pattern = MemorySearch::parse(kind, m_findPattern->text(), width,
+                                           m_findMask->text(), error);
+  if (!pattern) {
+    GeneralStatusManager::setStatusTimed(error, 5000);
+    return;
+  }
+
+  // Memories other than paged memories are searched within the sections of
+  // the program and the pages written since the last reset.
+  std::vector<AInt> pages(ProcessorHandler::writtenPages().begin(),
+                          ProcessorHandler::writtenPages().end());
+  if (auto program = ProcessorHandler::getProgram()) {
+    for (const auto &[name, section] : program->sections) {
+      const AInt end = section.address + section.data.size();
+      for (AInt page = section.address & ~(MemorySearch::s_pageSize - 1);
+           page < end; page += MemorySearch::s_pageSize)
+        pages.push_back(page);
+    }
+  }
+  const MemorySearch search(ProcessorHandler::getMemory(), std::move(pages));
+  auto match = search.findNext(*pattern, m_lastMatch ? *m_lastMatch + 1 : 0);
+  if (!match && m_lastMatch)
+    match = search.findNext(*pattern, 0);
+  if (!match) {
+    m_lastMatch.reset();
+    GeneralStatusManager::setStatusTimed("Pattern not found in memory", 5000);
+    return;
+  }
+  m_lastMatch = match;
+  m_memoryModel->setCentralAddress(*match);
+  GeneralStatusManager::setStatusTimed(
+      "Pattern found at 0x" + QString::number(*match, 16), 5000);
 }
 
 void MemoryViewerWidget::setCentralAddress(AInt address) {
   m_memoryModel->setCentralAddress(address);
 }
 
-void MemoryViewerWidget::updateView() { m_memoryModel->processorWasClocked(); }
+void MemoryViewerWidget::showEvent(QShowEvent *event) {
+  QWidget::showEvent(event);
+  if (m_stale)
+    updateView();
+}
+
+void MemoryViewerWidget::updateView() {
+  // Hidden views are updated once shown.
+  m_stale = !isVisible();
+  if (!m_stale)
+    m_memoryModel->processorWasClocked();
+}
 
 void MemoryViewerWidget::updateModel() {
   auto *oldModel = m_memoryModel;
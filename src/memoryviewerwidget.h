@@ -2,8 +2,13 @@
 
 #include <QWidget>
 
+#include <optional>
+
 #include "isa/isa_types.h"
 
+class QComboBox;
+class QLineEdit;
+
 namespace Ripes {
 
 class RadixSelectorWidget;
@@ -29,13 +34,26 @@ public slots:
   void updateView();
   void setCentralAddress(Ripes::AInt address);
 
+protected:
+  void showEvent(QShowEvent *event) override;
+
 private:
   void setupNavigationWidgets();
+  void showContextMenu(const QPoint &pos);
+  /// Centers the view on the next match of the search pattern, continuing
+  /// from the previous match of the same pattern, and wrapping around.
+  void findNext();
 
   Ui::MemoryViewerWidget *m_ui = nullptr;
 
   RadixSelectorWidget *m_radixSelector = nullptr;
   GoToComboBox *m_goToSection = nullptr;
   GoToComboBox *m_goToRegister = nullptr;
+  QLineEdit *m_findPattern = nullptr;
+  QComboBox *m_findKind = nullptr;
+  QLineEdit *m_findMask = nullptr;
+  std::optional<AInt> m_lastMatch;
+  // Set if the view was hidden whilst the processor state changed.
+  bool m_stale = false;
 };
 } // namespace Ripes
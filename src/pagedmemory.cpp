@@ -0,0 +1,310 @@
+#include "pagedmemory.h"
+
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <cstring>
+
+namespace Ripes {
+
+PagedMemory::Page *PagedMemory::findPage(AInt address) const {
+  const AInt number = address >> s_pageBits;
+  TLBEntry &entry = m_tlb[number % s_tlbEntries];
+  if (entry.number == number)
+    return entry.page;
+
+  Page *page = nullptr;
+  if (number >> (2 * s_levelBits) == 0) {
+    const auto &directory = m_root[number >> s_levelBits];
+    if (directory)
+      page = (*directory)[number & (s_levelEntries - 1)].get();
+  } else {
+    auto it = m_highPages.find(number);
+    if (it != m_highPages.end())
+      page = it->second.get();
+  }
+  // Unallocated pages are not cached, such that their allocation needs no
+  // invalidation.
+  if (page)
+    entry = {number, page};
+  return page;
+}
+
+std::unique_ptr<PagedMemory::Page> &PagedMemory::slot(AInt number) {
+  if (number >> (2 * s_levelBits) == 0) {
+    auto &directory = m_root[number >> s_levelBits];
+    if (!directory)
+      directory = std::make_unique<Directory>();
+    return (*directory)[number & (s_levelEntries - 1)];
+  }
+  return m_highPages[number];
+}
+
+PagedMemory::Page &PagedMemory::page(AInt address) {
+  if (Page *page = findPage(address))
+    return *page;
+
+  const AInt number = address >> s_pageBits;
+  auto &allocated = slot(number);
+  allocated = std::make_unique<Page>();
+  allocated->storage = std::make_unique<std::array<uint8_t, s_pageSize>>();
+  allocated->bytes = allocated->storage->data();
+  m_allocatedPages++;
+  m_tlb[number % s_tlbEntries] = {number, allocated.get()};
+  return *allocated;
+}
+
+uint8_t *PagedMemory::writable(Page &page, AInt address) {
+  if (!page.dirty) {
+    page.dirty = true;
+    m_dirtyPages.push_back(address >> s_pageBits);
+  }
+  if (!page.storage) {
+    page.storage = std::make_unique<std::array<uint8_t, s_pageSize>>();
+    std::memcpy(page.storage->data(), page.bytes, s_pageSize);
+    page.bytes = page.storage->data();
+    m_sharedPages--;
+  }
+  return page.storage->data();
+}
+
+void PagedMemory::flushTLB() const { m_tlb.fill(TLBEntry()); }
+
+size_t PagedMemory::bytes() const {
+  const size_t directories =
+      std::count_if(m_root.begin(), m_root.end(),
+                    [](const auto &directory) { return directory != nullptr; });
+  const size_t copies =
+      std::count_if(m_image.begin(), m_image.end(),
+                    [](const auto &image) { return image.second.copy; });
+  // Shared pages reference the bytes of an initialization memory.
+  return directories * sizeof(Directory) + m_allocatedPages * sizeof(Page) +
+         (m_allocatedPages - m_sharedPages + copies) * s_pageSize +
+         m_image.size() * sizeof(ImagePage);
+}
+
+const uint8_t *PagedMemory::pageBytes(AInt address) const {
+  if (isIO(address))
+    return nullptr;
+  const Page *page = findPage(address);
+  return page ? page->bytes : nullptr;
+}
+
+std::vector<AInt> PagedMemory::allocatedPageAddresses(AInt from) const {
+  std::vector<AInt> addresses;
+  const AInt first = from >> s_pageBits;
+  if (first >> (2 * s_levelBits) == 0) {
+    for (AInt d = first >> s_levelBits; d < s_levelEntries; ++d) {
+      if (!m_root[d])
+        continue;
+      const AInt begin =
+          d == first >> s_levelBits ? first & (s_levelEntries - 1) : 0;
+      for (AInt e = begin; e < s_levelEntries; ++e) {
+        if ((*m_root[d])[e])
+          addresses.push_back(((d << s_levelBits) | e) << s_pageBits);
+      }
+    }
+  }
+  const size_t low = addresses.size();
+  for (const auto &[number, page] : m_highPages) {
+    if (page && number >= first)
+      addresses.push_back(number << s_pageBits);
+  }
+  std::sort(addresses.begin() + low, addresses.end());
+  return addresses;
+}
+
+std::vector<AInt> PagedMemory::dirtyPageAddresses() const {
+  std::vector<AInt> addresses;
+  addresses.reserve(m_dirtyPages.size());
+  for (const AInt number : m_dirtyPages)
+    addresses.push_back(number << s_pageBits);
+  std::sort(addresses.begin(), addresses.end());
+  return addresses;
+}
+
+void PagedMemory::writePage(AInt address, const uint8_t *bytes) {
+  assert((address & (s_pageSize - 1)) == 0 && !isIO(address));
+  Page &target = page(address);
+  std::memcpy(writable(target, address), bytes, s_pageSize);
+  target.written.set();
+  if (target.code) {
+    target.code.reset();
+    m_codeWrites++;
+  }
+}
+
+bool PagedMemory::contains(AInt address) const {
+  if (isIO(address))
+    return AddressSpaceMM::contains(address);
+  const Page *page = findPage(address);
+  return page && page->written.test(address & (s_pageSize - 1));
+}
+
+void PagedMemory::writeMem(AInt address, VInt value, int size) {
+  if (isIO(address)) {
+    AddressSpaceMM::writeMem(address, value, size);
+    return;
+  }
+  Page *target = &page(address);
+  uint8_t *bytes = writable(*target, address);
+  for (int i = 0; i < size; ++i, ++address) {
+    const unsigned offset = address & (s_pageSize - 1);
+    if (offset == 0 && i != 0) {
+      target = &page(address);
+      bytes = writable(*target, address);
+    }
+    if (target->code && target->code->test(offset)) {
+      target->code.reset();
+      m_codeWrites++;
+    }
+    bytes[offset] = static_cast<uint8_t>(value);
+    target->written.set(offset);
+    value >>= CHAR_BIT;
+  }
+}
+
+VInt PagedMemory::readMem(AInt address, unsigned width) {
+  if (isIO(address))
+    return AddressSpaceMM::readMem(address, width);
+  return readMemConst(address, width);
+}
+
+VInt PagedMemory::readMemConst(AInt address, unsigned width) const {
+  if (isIO(address))
+    return AddressSpaceMM::readMemConst(address, width);
+  const Page *source = findPage(address);
+  VInt value = 0;
+  for (unsigned i = 0; i < width; ++i, ++address) {
+    const unsigned offset = address & (s_pageSize - 1);
+    if (offset == 0 && i != 0)
+      source = findPage(address);
+    if (source)
+      value |= VInt(source->bytes[offset]) << (i * CHAR_BIT);
+  }
+  return value;
+}
+
+void PagedMemory::addInitializationMemory(AInt address, const char *data,
+                                          size_t size,
+                                          std::shared_ptr<const void> owner) {
+  if (!owner) {
+    auto copy = std::make_shared<std::vector<char>>(data, data + size);
+    data = copy->data();
+    owner = std::move(copy);
+  }
+  m_sections.push_back({address, data, size, std::move(owner)});
+}
+
+void PagedMemory::clearInitializationMemories() {
+  m_sections.clear();
+  AddressSpaceMM::clearInitializationMemories();
+}
+
+bool PagedMemory::markCode(AInt address, unsigned bytes) {
+  for (unsigned i = 0; i < bytes; ++i, ++address) {
+    Page *target = isIO(address) ? nullptr : findPage(address);
+    if (!target)
+      return false;
+    if (!target->code)
+      target->code = std::make_unique<std::bitset<s_pageSize>>();
+    target->code->set(address & (s_pageSize - 1));
+  }
+  return true;
+}
+
+void PagedMemory::buildImage() {
+  m_image.clear();
+  for (const auto &section : m_sections) {
+    AInt address = section.address;
+    const char *data = section.data;
+    size_t size = section.size;
+    while (size > 0) {
+      const unsigned offset = address & (s_pageSize - 1);
+      const size_t bytes = std::min<size_t>(size, s_pageSize - offset);
+      auto [it, inserted] = m_image.try_emplace(address >> s_pageBits);
+      ImagePage &image = it->second;
+      if (bytes == s_pageSize && inserted) {
+        // Reference the bytes of the section.
+        image.shared = reinterpret_cast<const uint8_t *>(data);
+      } else {
+        if (!image.copy) {
+          image.copy = std::make_unique<std::array<uint8_t, s_pageSize>>();
+          if (image.shared)
+            std::memcpy(image.copy->data(), image.shared, s_pageSize);
+          image.shared = nullptr;
+        }
+        std::memcpy(image.copy->data() + offset, data, bytes);
+      }
+      for (size_t i = 0; i < bytes; ++i)
+        image.written.set(offset + i);
+      address += bytes;
+      data += bytes;
+      size -= bytes;
+    }
+  }
+  m_imageSections = m_sections;
+  m_imageBuilt = true;
+}
+
+void PagedMemory::restore(Page &page, const ImagePage &image) {
+  const bool wasShared = page.bytes && !page.storage;
+  if (image.shared) {
+    // The page references the bytes of the image until written.
+    page.storage.reset();
+    page.bytes = image.shared;
+    if (!wasShared)
+      m_sharedPages++;
+  } else {
+    if (!page.storage) {
+      page.storage = std::make_unique<std::array<uint8_t, s_pageSize>>();
+      if (wasShared)
+        m_sharedPages--;
+    }
+    std::memcpy(page.storage->data(), image.copy->data(), s_pageSize);
+    page.bytes = page.storage->data();
+  }
+  page.written = image.written;
+  page.code.reset();
+  page.dirty = false;
+}
+
+void PagedMemory::reset() {
+  AddressSpaceMM::reset();
+  m_codeWrites++;
+  flushTLB();
+
+  if (m_imageBuilt && m_imageSections == m_sections) {
+    // Only the pages written since the last reset differ from the image.
+    for (const AInt number : m_dirtyPages) {
+      auto &written = slot(number);
+      auto it = m_image.find(number);
+      if (it != m_image.end()) {
+        restore(*written, it->second);
+        continue;
+      }
+      written.reset();
+      if (number >> (2 * s_levelBits) != 0)
+        m_highPages.erase(number);
+      m_allocatedPages--;
+    }
+    m_dirtyPages.clear();
+    return;
+  }
+
+  buildImage();
+  for (auto &directory : m_root)
+    directory.reset();
+  m_highPages.clear();
+  m_allocatedPages = 0;
+  m_sharedPages = 0;
+  m_dirtyPages.clear();
+  for (const auto &[number, image] : m_image) {
+    auto &allocated = slot(number);
+    allocated = std::make_unique<Page>();
+    m_allocatedPages++;
+    restore(*allocated, image);
+  }
+}
+
+} // namespace Ripes
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "VSRTL/core/vsrtl_addressspace.h"
+#include "isa/isa_types.h"
+#include "memoryfootprint.h"
+
+namespace Ripes {
+
+/**
+ * @brief The PagedMemory class
+ * Memory of a processor backed by 4 KiB pages, which are allocated upon their
+ * first write. Pages below 4 GiB are found through a two-level page table,
+ * and pages above through a hash map. A small software TLB holds the last
+ * pages accessed, such that accesses to these are a shift and a pointer
+ * dereference.
+ *
+ * IO regions are accessed as by AddressSpaceMM. Initialization memories are
+ * held by PagedMemory rather than by AddressSpace, and are loaded upon reset.
+ * Pages fully covered by an initialization memory reference its bytes rather
+ * than copying them, and are copied upon their first write. Partially covered
+ * pages are copied a page at a time. Use MemoryBlock::addInitializationMemory
+ * and clearInitializationMemories to initialize any AddressSpaceMM.
+ *
+ * The pages of the memory upon reset form its image, which is built by the
+ * first reset after the initialization memories changed. Subsequent resets
+ * restore only the pages written since the previous reset, such that
+ * resetting is proportional to the memory touched rather than to the size of
+ * the program. Initialization memories which are removed and added again
+ * with the same bytes (such as when reloading a program) keep the image.
+ *
+ * Bytes may be marked as code which a processor has translated (see
+ * markCode). Writing a marked byte unmarks the bytes of its page and
+ * increments codeWrites(), as does a reset, such that the processor discards
+ * its translations. Data sharing a page with code is written as usual.
+ */
+class PagedMemory : public vsrtl::core::AddressSpaceMM {
+public:
+  static constexpr unsigned s_pageBits = 12;
+  static constexpr AInt s_pageSize = AInt(1) << s_pageBits;
+
+  bool contains(AInt address) const override;
+  void writeMem(AInt address, VInt value, int size = sizeof(VInt)) override;
+  VInt readMem(AInt address, unsigned width = sizeof(VInt)) override;
+  VInt readMemConst(AInt address, unsigned width = sizeof(VInt)) const override;
+
+  /// Adds @p size bytes of @p data at @p address to the memory written upon
+  /// reset. If @p owner is set, it owns @p data, which is referenced rather
+  /// than copied, and must not be modified.
+  void addInitializationMemory(AInt address, const char *data, size_t size,
+                               std::shared_ptr<const void> owner = {});
+  void clearInitializationMemories();
+  /// Restores the image of the initialization memories, freeing all other
+  /// pages.
+  void reset();
+
+  /// Number of pages currently allocated.
+  size_t allocatedPages() const { return m_allocatedPages; }
+  /// Number of allocated pages referencing the bytes of an initialization
+  /// memory, which have not been written since the last reset.
+  size_t sharedPages() const { return m_sharedPages; }
+  /// Bytes held by the page table and the allocated pages.
+  size_t bytes() const;
+
+  /// Returns the bytes of the page holding @p address, or nullptr if the page
+  /// is not allocated.
+  const uint8_t *pageBytes(AInt address) const;
+  /// Returns the base addresses of the allocated pages at or after the page
+  /// holding @p from, in ascending order.
+  std::vector<AInt> allocatedPageAddresses(AInt from = 0) const;
+  /// Returns the base addresses of the pages written since the last reset,
+  /// being the pages which differ from the image, in ascending order.
+  std::vector<AInt> dirtyPageAddresses() const;
+  /// Writes the s_pageSize bytes of @p bytes to the page at the page-aligned
+  /// @p address, as writing each byte of the page.
+  void writePage(AInt address, const uint8_t *bytes);
+
+  /// Marks the @p bytes bytes at @p address as translated code. Returns false
+  /// if a byte is in an unallocated page or an IO region, in which case the
+  /// bytes cannot be translated.
+  bool markCode(AInt address, unsigned bytes);
+  /// Number of writes to marked bytes and resets.
+  unsigned long long codeWrites() const { return m_codeWrites; }
+
+private:
+  static constexpr unsigned s_levelBits = 10;
+  static constexpr unsigned s_levelEntries = 1 << s_levelBits;
+  static constexpr unsigned s_tlbEntries = 4;
+
+  struct Page {
+    // Bytes of the page; those of an initialization memory until the page is
+    // written, and otherwise its own storage.
+    const uint8_t *bytes = nullptr;
+    std::unique_ptr<std::array<uint8_t, s_pageSize>> storage;
+    // Bytes which have been written, as reported by contains().
+    std::bitset<s_pageSize> written;
+    // Bytes marked by markCode, allocated upon the first mark.
+    std::unique_ptr<std::bitset<s_pageSize>> code;
+    // Whether the page was written since the last reset (see m_dirtyPages).
+    bool dirty = false;
+  };
+  using Directory = std::array<std::unique_ptr<Page>, s_levelEntries>;
+
+  struct TLBEntry {
+    AInt number = ~AInt(0);
+    Page *page = nullptr;
+  };
+
+  struct Section {
+    AInt address;
+    const char *data;
+    size_t size;
+    std::shared_ptr<const void> owner;
+
+    bool operator==(const Section &other) const {
+      return address == other.address && data == other.data &&
+             size == other.size;
+    }
+  };
+
+  /// A page of the image: the bytes of a fully covered page of an
+  /// initialization memory, or otherwise a copy of the bytes of the page.
+  struct ImagePage {
+    const uint8_t *shared = nullptr;
+    std::unique_ptr<std::array<uint8_t, s_pageSize>> copy;
+    std::bitset<s_pageSize> written;
+  };
+  /// Builds the image from the initialization memories.
+  void buildImage();
+  /// Sets the bytes of @p page to those of @p image.
+  void restore(Page &page, const ImagePage &image);
+
+  bool isIO(AInt address) const {
+    return regionType(address) == RegionType::IO;
+  }
+  /// Returns the page of @p address, or nullptr if it is not allocated.
+  Page *findPage(AInt address) const;
+  /// Returns the page of @p address, allocating it if necessary.
+  Page &page(AInt address);
+  /// Returns the slot of the page table holding page number @p number.
+  std::unique_ptr<Page> &slot(AInt number);
+  /// Returns the storage of @p page at @p address, copying its shared bytes
+  /// into it, and records the page as dirty.
+  uint8_t *writable(Page &page, AInt address);
+  void flushTLB() const;
+
+  std::array<std::unique_ptr<Directory>, s_levelEntries> m_root;
+  // Pages above 4 GiB, by page number.
+  std::unordered_map<AInt, std::unique_ptr<Page>> m_highPages;
+  size_t m_allocatedPages = 0;
+  size_t m_sharedPages = 0;
+  mutable std::array<TLBEntry, s_tlbEntries> m_tlb;
+  std::vector<Section> m_sections;
+  // The image, by page number, and the initialization memories it was built
+  // from, which own the bytes of its shared pages.
+  std::unordered_map<AInt, ImagePage> m_image;
+  std::vector<Section> m_imageSections;
+  bool m_imageBuilt = false;
+  // The numbers of the pages written since the last reset.
+  std::vector<AInt> m_dirtyPages;
+  unsigned long long m_codeWrites = 0;
+  MemoryFootprint::Source m_footprint{MemoryFootprint::GuestMemory,
+                                      [this] { return bytes(); }};
+};
+
+} // namespace Ripes
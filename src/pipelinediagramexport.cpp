@@ -0,0 +1,229 @@
+#include "pipelinediagramexport.h"
+
+#include "fonts.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QFontMetrics>
+#include <QImage>
+#include <QPainter>
+#include <QPdfWriter>
+#include <QSvgGenerator>
+#include <QtConcurrent/QtConcurrent>
+
+#include <algorithm>
+
+namespace Ripes {
+
+std::optional<PipelineDiagramExportOptions::Format>
+PipelineDiagramExportOptions::formatForPath(const QString &path) {
+  const QString suffix = QFileInfo(path).suffix().toLower();
+  if (suffix == "png")
+    return Format::PNG;
+  if (suffix == "svg")
+    return Format::SVG;
+  if (suffix == "pdf")
+    return Format::PDF;
+  return {};
+}
+
+PipelineDiagramExporter::PipelineDiagramExporter(
+    const PipelineDiagramModel &model,
+    const PipelineDiagramExportOptions &options, QObject *parent)
+    : QObject(parent), m_snapshot(model.snapshot()), m_options(options),
+      m_font(Fonts::monospace, 10) {
+  m_options.tileRows = std::max(m_options.tileRows, 1);
+  m_options.tileColumns = std::max(m_options.tileColumns, 1);
+  m_tileRowCount =
+      (m_snapshot.rows() + m_options.tileRows - 1) / m_options.tileRows;
+  m_tileColumnCount = (m_snapshot.columns() + m_options.tileColumns - 1) /
+                      m_options.tileColumns;
+
+  connect(&m_watcher, &QFutureWatcher<QString>::progressValueChanged, this,
+          &PipelineDiagramExporter::progress);
+  connect(&m_watcher, &QFutureWatcher<QString>::finished, this, [=] {
+    if (m_watcher.isCanceled() || m_watcher.future().resultCount() == 0)
+      emit finished("Export cancelled");
+    else
+      emit finished(m_watcher.result());
+  });
+}
+
+PipelineDiagramExporter::~PipelineDiagramExporter() {
+  m_watcher.cancel();
+  m_watcher.waitForFinished();
+}
+
+int PipelineDiagramExporter::tiles() const {
+  return m_tileRowCount * m_tileColumnCount;
+}
+
+QString PipelineDiagramExporter::tilePath(int row, int column) const {
+  if (m_options.format == PipelineDiagramExportOptions::Format::PDF ||
+      tiles() == 1)
+    return m_options.path;
+  const QFileInfo info(m_options.path);
+  return info.dir().filePath(info.completeBaseName() + "_" +
+                             QString::number(row) + "_" +
+                             QString::number(column) + "." + info.suffix());
+}
+
+void PipelineDiagramExporter::start() {
+  m_watcher.setFuture(QtConcurrent::run([this](QPromise<QString> &promise) {
+    promise.setProgressRange(0, tiles());
+    promise.addResult(render(promise));
+  }));
+}
+
+void PipelineDiagramExporter::cancel() { m_watcher.cancel(); }
+
+PipelineDiagramExporter::Tile
+PipelineDiagramExporter::layoutTile(int row, int column) const {
+  Tile tile;
+  tile.firstRow = row * m_options.tileRows;
+  tile.rows = std::min(m_options.tileRows, m_snapshot.rows() - tile.firstRow);
+  tile.firstColumn = column * m_options.tileColumns;
+  tile.columns = std::min(m_options.tileColumns,
+                          m_snapshot.columns() - tile.firstColumn);
+
+  // Columns are sized to their contents, as the table of the dialog.
+  const QFontMetrics metrics(m_font);
+  const int padding = 2 * metrics.horizontalAdvance(' ');
+  tile.headerWidth = 0;
+  for (int i = 0; i < tile.rows; ++i)
+    tile.headerWidth =
+        std::max(tile.headerWidth,
+                 metrics.horizontalAdvance(
+                     m_snapshot.rowHeader(tile.firstRow + i)));
+  tile.headerWidth += padding;
+
+  tile.texts.reserve(tile.rows * tile.columns);
+  for (int i = 0; i < tile.rows; ++i)
+    for (int j = 0; j < tile.columns; ++j)
+      tile.texts.push_back(
+          m_snapshot.text(tile.firstRow + i, tile.firstColumn + j));
+  int width = tile.headerWidth;
+  for (int j = 0; j < tile.columns; ++j) {
+    int columnWidth = metrics.horizontalAdvance(
+        m_snapshot.columnHeader(tile.firstColumn + j));
+    for (int i = 0; i < tile.rows; ++i)
+      columnWidth = std::max(
+          columnWidth,
+          metrics.horizontalAdvance(tile.texts[i * tile.columns + j]));
+    tile.columnWidths.push_back(columnWidth + padding);
+    width += tile.columnWidths.back();
+  }
+  tile.rowHeight = metrics.height() + metrics.height() / 2;
+  tile.size = QSize(width, (tile.rows + 1) * tile.rowHeight);
+  return tile;
+}
+
+void PipelineDiagramExporter::paintTile(QPainter &painter,
+                                        const Tile &tile) const {
+  painter.fillRect(QRect(QPoint(), tile.size), Qt::white);
+  painter.setFont(m_font);
+
+  // Cycles are laid out horizontally following the instructions, as in the
+  // table of the dialog.
+  std::vector<int> columnX = {tile.headerWidth};
+  for (const int width : tile.columnWidths)
+    columnX.push_back(columnX.back() + width);
+  const int height = tile.size.height();
+
+  painter.setPen(Qt::lightGray);
+  for (int i = 1; i <= tile.rows; ++i)
+    painter.drawLine(0, i * tile.rowHeight, tile.size.width(),
+                     i * tile.rowHeight);
+  for (const int x : columnX)
+    painter.drawLine(x, 0, x, height);
+
+  painter.setPen(Qt::black);
+  const int margin = QFontMetrics(m_font).horizontalAdvance(' ');
+  for (int j = 0; j < tile.columns; ++j)
+    painter.drawText(QRect(columnX[j], 0, tile.columnWidths[j], tile.rowHeight),
+                     Qt::AlignCenter,
+                     m_snapshot.columnHeader(tile.firstColumn + j));
+  for (int i = 0; i < tile.rows; ++i) {
+    const int y = (i + 1) * tile.rowHeight;
+    painter.drawText(QRect(margin, y, tile.headerWidth - 2 * margin,
+                           tile.rowHeight),
+                     Qt::AlignLeft | Qt::AlignVCenter,
+                     m_snapshot.rowHeader(tile.firstRow + i));
+    for (int j = 0; j < tile.columns; ++j)
+      painter.drawText(
+          QRect(columnX[j], y, tile.columnWidths[j], tile.rowHeight),
+          Qt::AlignCenter, tile.texts[i * tile.columns + j]);
+  }
+}
+
+QString PipelineDiagramExporter::render(QPromise<QString> &promise) const {
+  using Format = PipelineDiagramExportOptions::Format;
+  if (tiles() == 0)
+    return "The pipeline diagram is empty";
+
+  // PDF exports are a single document, to which a page is added per tile.
+  std::unique_ptr<QPdfWriter> pdf;
+  QPainter pdfPainter;
+  if (m_options.format == Format::PDF) {
+    pdf = std::make_unique<QPdfWriter>(m_options.path);
+    // A pixel of a tile is a point of its page.
+    pdf->setResolution(72);
+    pdf->setPageMargins(QMarginsF());
+    pdf->setTitle("Pipeline diagram");
+    pdf->setCreator("Ripes");
+  }
+
+  int rendered = 0;
+  for (int row = 0; row < m_tileRowCount; ++row) {
+    for (int column = 0; column < m_tileColumnCount; ++column) {
+      if (promise.isCanceled())
+        return "Export cancelled";
+      const Tile tile = layoutTile(row, column);
+      const QString path = tilePath(row, column);
+      const QString error = "Failed to write '" + path + "'";
+      switch (m_options.format) {
+      case Format::PNG: {
+        QImage image(tile.size, QImage::Format_RGB32);
+        QPainter painter(&image);
+        paintTile(painter, tile);
+        painter.end();
+        if (!image.save(path, "PNG"))
+          return error;
+        break;
+      }
+      case Format::SVG: {
+        QSvgGenerator generator;
+        generator.setFileName(path);
+        generator.setSize(tile.size);
+        generator.setViewBox(QRect(QPoint(), tile.size));
+        generator.setTitle("Pipeline diagram");
+        QPainter painter;
+        if (!painter.begin(&generator))
+          return error;
+        paintTile(painter, tile);
+        painter.end();
+        break;
+      }
+      case Format::PDF: {
+        // The page size applies to the page following the current page.
+        pdf->setPageSize(QPageSize(QSizeF(tile.size), QPageSize::Point,
+                                   QString(), QPageSize::ExactMatch));
+        if (!pdfPainter.isActive()) {
+          if (!pdfPainter.begin(pdf.get()))
+            return error;
+        } else if (!pdf->newPage()) {
+          return error;
+        }
+        paintTile(pdfPainter, tile);
+        break;
+      }
+      }
+      promise.setProgressValue(++rendered);
+    }
+  }
+  if (pdfPainter.isActive() && !pdfPainter.end())
+    return "Failed to write '" + m_options.path + "'";
+  return QString();
+}
+
+} // namespace Ripes
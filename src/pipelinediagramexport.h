@@ -0,0 +1,92 @@
+#pragma once
+
+#include <QFont>
+#include <QFutureWatcher>
+#include <QObject>
+#include <QPromise>
+
+#include <optional>
+
+#include "pipelinediagrammodel.h"
+
+QT_FORWARD_DECLARE_CLASS(QPainter)
+
+namespace Ripes {
+
+/// Options of a pipeline diagram export. See PipelineDiagramExporter for
+/// details.
+struct PipelineDiagramExportOptions {
+  enum class Format { PNG, SVG, PDF };
+  QString path;
+  Format format = Format::PDF;
+  // Dimensions of a tile, in instructions and cycles.
+  int tileRows = 64;
+  int tileColumns = 64;
+
+  /// Returns the format implied by the suffix of @p path, if any.
+  static std::optional<Format> formatForPath(const QString &path);
+};
+
+/**
+ * @brief The PipelineDiagramExporter class
+ * Renders a pipeline diagram offscreen, in tiles of a fixed number of
+ * instructions and cycles. Each tile repeats the instructions and cycles of
+ * its rows and columns, such that it can be read on its own. PDF exports hold
+ * a page per tile, whereas PNG and SVG exports write a file per tile, named by
+ * the row and column of the tile (diagram_<row>_<column>.png), unless the
+ * diagram fits a single tile.
+ *
+ * Tiles are rendered on a background thread, reading the cells of each tile
+ * from the recorded cycles of the model as it is rendered. The memory used is
+ * thereby bounded by a tile, regardless of the number of cycles recorded. The
+ * model must not record cycles whilst exporting, which the modal pipeline
+ * diagram dialog ensures.
+ */
+class PipelineDiagramExporter : public QObject {
+  Q_OBJECT
+public:
+  PipelineDiagramExporter(const PipelineDiagramModel &model,
+                          const PipelineDiagramExportOptions &options,
+                          QObject *parent = nullptr);
+  ~PipelineDiagramExporter();
+
+  /// Starts rendering the tiles on a background thread.
+  void start();
+  void cancel();
+  bool isRunning() const { return m_watcher.isRunning(); }
+
+  int tiles() const;
+  /// Returns the path of the file of the tile at @p row, @p column.
+  QString tilePath(int row, int column) const;
+
+signals:
+  void progress(int tiles);
+  /// Emitted once all tiles have been rendered, or rendering failed or was
+  /// cancelled. @p error is empty on success.
+  void finished(const QString &error);
+
+private:
+  /// The layout and cells of a tile, of which the cells are stored by row.
+  struct Tile {
+    int firstRow, rows;
+    int firstColumn, columns;
+    // Width of the instruction header and of each cycle.
+    int headerWidth;
+    std::vector<int> columnWidths;
+    int rowHeight;
+    QSize size;
+    std::vector<QString> texts;
+  };
+  Tile layoutTile(int row, int column) const;
+  void paintTile(QPainter &painter, const Tile &tile) const;
+  QString render(QPromise<QString> &promise) const;
+
+  PipelineDiagramModel::Snapshot m_snapshot;
+  PipelineDiagramExportOptions m_options;
+  QFont m_font;
+  int m_tileRowCount = 0;
+  int m_tileColumnCount = 0;
+  QFutureWatcher<QString> m_watcher;
+};
+
+} // namespace Ripes
@@ -3,6 +3,7 @@
 #include "processorhandler.h"
 #include "ripessettings.h"
 
+#include <algorithm>
 #include <vector>
 
 namespace Ripes {
@@ -19,8 +20,12 @@ PipelineDiagramModel::PipelineDiagramModel(QObject *parent)
     : QAbstractTableModel(parent) {
   connect(ProcessorHandler::get(), &ProcessorHandler::processorClocked, this,
           &PipelineDiagramModel::processorWasClocked, Qt::DirectConnection);
+  connect(ProcessorHandler::get(), &ProcessorHandler::processorClockedBatch,
+          this, &PipelineDiagramModel::processorWasClockedBatch,
+          Qt::DirectConnection);
   connect(ProcessorHandler::get(), &ProcessorHandler::processorReset, this,
           &PipelineDiagramModel::reset);
+  reset();
 }
 
 QVariant PipelineDiagramModel::headerData(int section,
@@ -30,20 +35,46 @@ QVariant PipelineDiagramModel::headerData(int section,
     return QVariant();
   if (orientation == Qt::Horizontal) {
     // Cycle number
-    return QString::number(section);
+    return QString::number(m_firstCycle + section);
   } else {
     const auto addr = indexToAddress(section);
     return ProcessorHandler::disassembleInstr(addr);
   }
 }
 
-int PipelineDiagramModel::rowCount(const QModelIndex &) const {
+int PipelineDiagramModel::programRows() const {
   return ProcessorHandler::getCurrentProgramSize() /
          ProcessorHandler::currentISA()->instrBytes();
 }
 
+int PipelineDiagramModel::recordedCycles() const {
+  return m_cells.empty() ? 0 : static_cast<int>(m_cells.front().size());
+}
+
+size_t PipelineDiagramModel::bytes() const {
+  size_t bytes = m_cells.capacity() * sizeof(m_cells[0]) +
+                 m_namedStates.capacity() * sizeof(QString);
+  for (const auto &cells : m_cells)
+    bytes += cells.capacity() * sizeof(Cell);
+  for (const auto &namedState : m_namedStates)
+    bytes += namedState.capacity() * sizeof(QChar);
+  return bytes;
+}
+
+int PipelineDiagramModel::rowCount(const QModelIndex &) const {
+  return m_viewRows;
+}
+
 int PipelineDiagramModel::columnCount(const QModelIndex &) const {
-  return m_cycleStageInfos.size();
+  return m_viewColumns;
+}
+
+void PipelineDiagramModel::updateMaxCycles() {
+  const auto cycleCount = ProcessorHandler::getProcessor()->getCycleCount();
+  if (cycleCount >=
+      RipesSettings::value(RIPES_SETTING_PIPEDIAGRAM_MAXCYCLES).toInt()) {
+    m_atMaxCycles = true;
+  }
 }
 
 void PipelineDiagramModel::processorWasClocked() {
@@ -51,36 +82,100 @@ void PipelineDiagramModel::processorWasClocked() {
     return;
   }
   gatherStageInfo();
+  updateMaxCycles();
+}
 
-  const auto cycleCount = ProcessorHandler::getProcessor()->getCycleCount();
-  if (cycleCount >=
-      RipesSettings::value(RIPES_SETTING_PIPEDIAGRAM_MAXCYCLES).toInt()) {
-    m_atMaxCycles = true;
+void PipelineDiagramModel::processorWasClockedBatch() {
+  if (m_atMaxCycles) {
+    return;
   }
+
+  for (const auto &record : ProcessorHandler::getProcessor()->clockBatch()) {
+    if (record.stageInfos.empty()) {
+      // Stage info is not recorded beyond the pipeline diagram cycle limit.
+      break;
+    }
+    this->record(record.cycle, record.stageInfos);
+  }
+  updateMaxCycles();
 }
 
 void PipelineDiagramModel::reset() {
+  beginResetModel();
   m_atMaxCycles = false;
-  m_cycleStageInfos.clear();
+  m_cells.clear();
+  m_stages.clear();
+  m_stageNames.clear();
+  m_namedStates = {QString()};
+  m_firstCycle = ProcessorHandler::getProcessor()->getCycleCount();
+  for (auto idx : ProcessorHandler::getProcessor()->structure().stageIt()) {
+    m_stages.push_back(idx);
+    m_stageNames.push_back(ProcessorHandler::getProcessor()->stageName(idx));
+  }
+  m_cells.resize(m_stages.size());
+  m_viewRows = 0;
+  m_viewColumns = 0;
+  endResetModel();
   gatherStageInfo();
 }
 
 void PipelineDiagramModel::prepareForView() {
-  beginResetModel();
-  endResetModel();
+  // Only the cycles recorded since the view was last prepared are published,
+  // such that opening a view of a long run does not rebuild the model. A
+  // changed program changes the rows of every column, and resets the model.
+  const int rows = programRows();
+  const int columns = recordedCycles();
+  if (rows != m_viewRows || columns < m_viewColumns) {
+    beginResetModel();
+    m_viewRows = rows;
+    m_viewColumns = columns;
+    endResetModel();
+  } else if (columns > m_viewColumns) {
+    beginInsertColumns(QModelIndex(), m_viewColumns, columns - 1);
+    m_viewColumns = columns;
+    endInsertColumns();
+  }
 }
 
-void PipelineDiagramModel::gatherStageInfo() {
-  long long cycleCount = ProcessorHandler::getProcessor()->getCycleCount();
-  auto stageInfoForCycle = m_cycleStageInfos.find(cycleCount);
-  if (stageInfoForCycle != m_cycleStageInfos.end()) {
-    // Already gathered stage info for this cycle.
+uint16_t PipelineDiagramModel::internNamedState(const QString &namedState) {
+  if (namedState.isEmpty())
+    return 0;
+  auto it = std::find(m_namedStates.begin(), m_namedStates.end(), namedState);
+  if (it != m_namedStates.end())
+    return static_cast<uint16_t>(it - m_namedStates.begin());
+  m_namedStates.push_back(namedState);
+  return static_cast<uint16_t>(m_namedStates.size() - 1);
+}
+
+void PipelineDiagramModel::record(
+    long long cycle, const std::map<StageIndex, StageInfo> &infos) {
+  if (cycle != m_firstCycle + recordedCycles()) {
+    // Already gathered stage info for this cycle, or the cycle does not
+    // follow the recorded cycles.
     return;
   }
-  m_cycleStageInfos[cycleCount];
-  for (auto idx : ProcessorHandler::getProcessor()->structure().stageIt())
-    m_cycleStageInfos[cycleCount][idx] =
-        ProcessorHandler::getProcessor()->stageInfo(idx);
+  for (size_t i = 0; i < m_stages.size(); ++i) {
+    Cell cell;
+    auto it = infos.find(m_stages.at(i));
+    if (it != infos.end()) {
+      cell.pc = it->second.pc;
+      cell.stageValid = it->second.stage_valid;
+      cell.state = it->second.state;
+      cell.namedState = internNamedState(it->second.namedState);
+    }
+    m_cells.at(i).push_back(cell);
+  }
+}
+
+void PipelineDiagramModel::gatherStageInfo() {
+  auto *processor = ProcessorHandler::getProcessor();
+  const long long cycleCount = processor->getCycleCount();
+  if (cycleCount != m_firstCycle + recordedCycles())
+    return;
+  std::map<StageIndex, StageInfo> infos;
+  for (auto idx : m_stages)
+    infos[idx] = processor->stageInfo(idx);
+  record(cycleCount, infos);
 }
 
 QVariant PipelineDiagramModel::data(const QModelIndex &index, int role) const {
@@ -94,61 +189,74 @@ QVariant PipelineDiagramModel::data(const QModelIndex &index, int role) const {
   if (role != Qt::DisplayRole)
     return QVariant();
 
-  if (!m_cycleStageInfos.count(index.column()))
+  const QString text = cellText(indexToAddress(index.row()), index.column());
+  if (text.isEmpty())
     return QVariant();
+  return text;
+}
 
-  const AInt addr = indexToAddress(index.row());
-  const auto &stageInfo = m_cycleStageInfos.at(index.column());
+QString PipelineDiagramModel::cellText(AInt addr, int column) const {
+  if (column < 0 || column >= recordedCycles())
+    return QString();
 
   QStringList stagesForAddr;
   QString stageStr;
-  for (const auto &si : stageInfo) {
-    if (si.second.pc == addr && si.second.stage_valid &&
-        si.second.state == StageInfo::State::None) {
-      if (m_cycleStageInfos.count(index.column() - 1)) {
-        const auto &prevCycleStageInfo =
-            m_cycleStageInfos.at(index.column() - 1);
-        if (prevCycleStageInfo.at(si.first).stage_valid &&
-            prevCycleStageInfo.at(si.first).pc == si.second.pc) {
-          stageStr = "-";
-          if (!si.second.namedState.isEmpty()) {
-            stageStr += " (" + si.second.namedState + ")";
-          }
-          stagesForAddr << stageStr;
-          continue;
-        }
-      }
-      stageStr = ProcessorHandler::getProcessor()->stageName(si.first);
-      if (!si.second.namedState.isEmpty()) {
-        stageStr += " (" + si.second.namedState + ")";
-      }
-      stagesForAddr << stageStr;
+  for (size_t i = 0; i < m_stages.size(); ++i) {
+    const auto &cells = m_cells.at(i);
+    const Cell &cell = cells.at(column);
+    if (cell.pc != addr || !cell.stageValid ||
+        cell.state != StageInfo::State::None)
+      continue;
+    if (column > 0 && cells.at(column - 1).stageValid &&
+        cells.at(column - 1).pc == cell.pc) {
+      stageStr = "-";
+    } else {
+      stageStr = m_stageNames.at(i);
     }
-  }
-
-  if (stagesForAddr.size() == 0) {
-    return QVariant();
+    if (cell.namedState != 0) {
+      stageStr += " (" + m_namedStates.at(cell.namedState) + ")";
+    }
+    stagesForAddr << stageStr;
   }
 
   return stagesForAddr.join('/');
 }
 
+PipelineDiagramModel::Snapshot PipelineDiagramModel::snapshot() const {
+  Snapshot snapshot;
+  snapshot.m_model = this;
+  snapshot.m_columns = recordedCycles();
+  snapshot.m_firstCycle = m_firstCycle;
+  snapshot.m_textAddress = indexToAddress(0);
+  snapshot.m_instrBytes = ProcessorHandler::currentISA()->instrBytes();
+  // Instructions are disassembled up front, as disassembly is not thread-safe.
+  const int rows = programRows();
+  snapshot.m_rowHeaders.reserve(rows);
+  for (int i = 0; i < rows; ++i)
+    snapshot.m_rowHeaders.push_back(headerData(i, Qt::Vertical).toString());
+  return snapshot;
+}
+
 QString PipelineDiagramModel::toString() const {
   QString textualRepr;
 
   // Copy headers
   textualRepr.append('\t');
-  for (int j = 0; j < columnCount(); j++) {
+  // The recorded cycles are stringified regardless of whether they have been
+  // published to a view.
+  const int rows = programRows();
+  const int columns = recordedCycles();
+  for (int j = 0; j < columns; j++) {
     textualRepr.append(headerData(j, Qt::Horizontal).toString());
     textualRepr.append('\t');
   }
   textualRepr.append('\n');
   // Copy data
-  for (int i = 0; i < rowCount(); ++i) {
+  for (int i = 0; i < rows; ++i) {
     textualRepr.append(headerData(i, Qt::Vertical).toString());
     textualRepr.append('\t');
-    for (int j = 0; j < columnCount(); j++) {
-      textualRepr.append(data(index(i, j)).toString());
+    for (int j = 0; j < columns; j++) {
+      textualRepr.append(data(createIndex(i, j)).toString());
       textualRepr.append('\t');
     }
     textualRepr.append('\n');
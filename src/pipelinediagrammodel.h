@@ -1,5 +1,6 @@
 #pragma once
 
+#include "memoryfootprint.h"
 #include "processors/interface/ripesprocessor.h"
 #include <QAbstractTableModel>
 
@@ -23,18 +24,85 @@ public:
   /// Returns a tab-separated stringified version of this pipeline diagram.
   QString toString() const;
 
+  /**
+   * @brief The Snapshot class
+   * The recorded cycles of a model, regardless of whether they have been
+   * published to a view. Cells are read from the recorded cycles of the model
+   * rather than copied, such that a snapshot may be read from any thread
+   * whilst the model records no cycles and is not reset.
+   */
+  class Snapshot {
+  public:
+    int rows() const { return static_cast<int>(m_rowHeaders.size()); }
+    int columns() const { return m_columns; }
+    QString rowHeader(int row) const { return m_rowHeaders.at(row); }
+    QString columnHeader(int column) const {
+      return QString::number(m_firstCycle + column);
+    }
+    QString text(int row, int column) const {
+      return m_model->cellText(m_textAddress + row * m_instrBytes, column);
+    }
+
+  private:
+    friend class PipelineDiagramModel;
+    const PipelineDiagramModel *m_model = nullptr;
+    std::vector<QString> m_rowHeaders;
+    int m_columns = 0;
+    long long m_firstCycle = 0;
+    AInt m_textAddress = 0;
+    unsigned m_instrBytes = 0;
+  };
+  Snapshot snapshot() const;
+
 public slots:
   void processorWasClocked();
+  void processorWasClockedBatch();
   void reset();
 
 private:
+  /// The state of a stage in a cycle, as recorded by the model. Named states
+  /// are interned in m_namedStates, such that a cell is a handful of bytes.
+  struct Cell {
+    AInt pc = 0;
+    uint16_t namedState = 0;
+    bool stageValid = false;
+    StageInfo::State state = StageInfo::State::None;
+  };
+
   void gatherStageInfo();
+  /// Returns the stages of the instruction at @p addr in @p column.
+  QString cellText(AInt addr, int column) const;
+  /// Appends the stage infos of @p cycle, unless already recorded.
+  void record(long long cycle, const std::map<StageIndex, StageInfo> &infos);
+  uint16_t internNamedState(const QString &namedState);
+  /// Number of cycles recorded, of which the view is notified upon
+  /// prepareForView().
+  int recordedCycles() const;
+  int programRows() const;
+  void updateMaxCycles();
+  /// Returns the bytes held by the recorded cycles.
+  size_t bytes() const;
 
   /**
-   * @brief m_cycleStageInfos
-   * map<cycle, map<stageId, stageInfo>>
+   * @brief m_cells
+   * The recorded cycles, stored per stage (in the order of m_stages) as a
+   * dense array indexed by the cycle relative to m_firstCycle. Recording a
+   * cycle only appends to these arrays, and data() only reads the cells of
+   * the cycles in view.
    */
-  std::map<long long, std::map<StageIndex, StageInfo>> m_cycleStageInfos;
+  std::vector<std::vector<Cell>> m_cells;
+  std::vector<StageIndex> m_stages;
+  std::vector<QString> m_stageNames;
+  std::vector<QString> m_namedStates;
+  long long m_firstCycle = 0;
+
+  /**
+   * @brief m_viewRows, m_viewColumns
+   * The dimensions of the model as last published to views. Cycles recorded
+   * since are published as inserted columns by prepareForView().
+   */
+  int m_viewRows = 0;
+  int m_viewColumns = 0;
 
   /**
    * @brief m_atMaxCycles
@@ -44,5 +112,8 @@ private:
    * the value has been reached.
    */
   bool m_atMaxCycles = false;
+
+  MemoryFootprint::Source m_footprint{MemoryFootprint::PipelineDiagram,
+                                      [this] { return bytes(); }};
 };
 } // namespace Ripes
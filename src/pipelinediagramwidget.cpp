@@ -2,8 +2,12 @@
 #include "ui_pipelinediagramwidget.h"
 
 #include <QClipboard>
+#include <QFileDialog>
 #include <QHeaderView>
+#include <QMessageBox>
+#include <QProgressDialog>
 
+#include "pipelinediagramexport.h"
 #include "pipelinediagrammodel.h"
 #include "ripessettings.h"
 
@@ -19,6 +23,7 @@ PipelineDiagramWidget::PipelineDiagramWidget(PipelineDiagramModel *model,
 
   m_ui->pipelineDiagramView->resizeColumnsToContents();
   m_ui->copy->setIcon(QIcon(":/icons/documents.svg"));
+  m_ui->exportDiagram->setIcon(QIcon(":/icons/saveas.svg"));
 
   m_stageModel->prepareForView();
 }
@@ -50,4 +55,44 @@ void PipelineDiagramWidget::on_copy_clicked() {
   }
   QApplication::clipboard()->setText(textualRepr);
 }
+
+void PipelineDiagramWidget::on_exportDiagram_clicked() {
+  const QString path = QFileDialog::getSaveFileName(
+      this, "Export pipeline diagram", QString(),
+      "PDF document (*.pdf);;PNG images (*.png);;SVG images (*.svg)");
+  if (path.isEmpty())
+    return;
+  const auto format = PipelineDiagramExportOptions::formatForPath(path);
+  if (!format) {
+    QMessageBox::warning(this, "Error",
+                         "Pipeline diagrams are exported as .pdf, .png or "
+                         ".svg files.");
+    return;
+  }
+
+  // The diagram is rendered in the background whilst the dialog remains
+  // responsive, and the export is cancelled if the dialog is closed.
+  PipelineDiagramExportOptions options;
+  options.path = path;
+  options.format = *format;
+  auto *exporter = new PipelineDiagramExporter(*m_stageModel, options, this);
+  auto *progress =
+      new QProgressDialog("Exporting pipeline diagram...", "Cancel", 0,
+                          exporter->tiles(), this);
+  progress->setWindowModality(Qt::WindowModal);
+  progress->setMinimumDuration(500);
+  connect(exporter, &PipelineDiagramExporter::progress, progress,
+          &QProgressDialog::setValue);
+  connect(progress, &QProgressDialog::canceled, exporter,
+          &PipelineDiagramExporter::cancel);
+  connect(exporter, &PipelineDiagramExporter::finished, this,
+          [=](const QString &error) {
+            const bool cancelled = progress->wasCanceled();
+            progress->deleteLater();
+            exporter->deleteLater();
+            if (!error.isEmpty() && !cancelled)
+              QMessageBox::warning(this, "Error", error);
+          });
+  exporter->start();
+}
 } // namespace Ripes
@@ -19,6 +19,7 @@ public:
 
 private slots:
   void on_copy_clicked();
+  void on_exportDiagram_clicked();
 
 private:
   Ui::PipelineDiagramWidget *m_ui = nullptr;
@@ -0,0 +1,242 @@
+#include "pipelinetrace.h"
+
+#include "processorhandler.h"
+
+#include <QJsonDocument>
+
+namespace Ripes {
+
+static QString stageStateName(StageInfo::State state) {
+  switch (state) {
+  case StageInfo::State::Stalled:
+    return "stall";
+  case StageInfo::State::Flushed:
+    return "flush";
+  case StageInfo::State::WayHazard:
+    return "hazard";
+  default:
+    return QString();
+  }
+}
+
+PipelineTraceWriter::PipelineTraceWriter(const PipelineTraceOptions &options)
+    : m_options(options) {}
+
+PipelineTraceWriter::~PipelineTraceWriter() { close(); }
+
+bool PipelineTraceWriter::open(QString &errorMessage) {
+  m_file.setFileName(m_options.path);
+  if (!m_file.open(QIODevice::Truncate | QIODevice::Text |
+                   QIODevice::WriteOnly)) {
+    errorMessage =
+        "Failed to open pipeline trace file '" + m_options.path + "'";
+    return false;
+  }
+
+  const auto *proc = ProcessorHandler::getProcessor();
+  m_breakpointStages = proc->breakpointTriggeringStages();
+  if (m_options.format == PipelineTraceOptions::Format::ChromeTrace) {
+    m_file.write("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    m_firstEvent = true;
+    m_slices.clear();
+    // Names the threads of the stages, ordered as the stages.
+    unsigned tid = 0;
+    for (auto idx : proc->structure().stageIt()) {
+      QString name = proc->stageName(idx);
+      if (proc->structure().size() > 1)
+        name += " (lane " + QString::number(idx.lane()) + ")";
+      writeChromeTraceEvent({{"ph", "M"},
+                             {"name", "thread_name"},
+                             {"pid", 0},
+                             {"tid", static_cast<int>(tid++)},
+                             {"args", QJsonObject{{"name", name}}}});
+    }
+    writeChromeTraceEvent({{"ph", "M"},
+                           {"name", "thread_name"},
+                           {"pid", 0},
+                           {"tid", static_cast<int>(tid)},
+                           {"args", QJsonObject{{"name", "syscalls"}}}});
+    connect(ProcessorHandler::get(), &ProcessorHandler::syscallExecuted, this,
+            &PipelineTraceWriter::syscallExecuted, Qt::DirectConnection);
+  } else {
+    QByteArray header = "cycle";
+    for (auto idx : proc->structure().stageIt())
+      header += '\t' + proc->stageName(idx).toUtf8();
+    m_file.write(header + '\n');
+  }
+
+  // Stage information is only gathered for the cycles which may be recorded.
+  ProcessorHandler::setRunStageInfoRange(m_options.first, m_options.last);
+  connect(ProcessorHandler::get(), &ProcessorHandler::processorClocked, this,
+          &PipelineTraceWriter::processorWasClocked, Qt::DirectConnection);
+  connect(ProcessorHandler::get(), &ProcessorHandler::processorClockedBatch,
+          this, &PipelineTraceWriter::processorWasClockedBatch,
+          Qt::DirectConnection);
+  return true;
+}
+
+void PipelineTraceWriter::close() {
+  if (!m_file.isOpen())
+    return;
+  disconnect(ProcessorHandler::get(), nullptr, this, nullptr);
+  ProcessorHandler::clearRunStageInfoRange();
+  if (m_options.format == PipelineTraceOptions::Format::ChromeTrace) {
+    unsigned tid = 0;
+    for (const auto &slice : m_slices)
+      writeSlice(tid++, slice.second);
+    m_file.write("\n]}\n");
+  }
+  m_file.close();
+}
+
+void PipelineTraceWriter::processorWasClocked() {
+  const auto *proc = ProcessorHandler::getProcessor();
+  const long long cycle = proc->getCycleCount();
+  if (cycle < m_options.first || cycle > m_options.last)
+    return;
+  std::map<StageIndex, StageInfo> stages;
+  for (auto idx : proc->structure().stageIt())
+    stages[idx] = proc->stageInfo(idx);
+  record(cycle, stages);
+}
+
+void PipelineTraceWriter::processorWasClockedBatch() {
+  for (const auto &record : ProcessorHandler::getProcessor()->clockBatch()) {
+    // Stage information is only recorded within the range of the trace.
+    if (!record.stageInfos.empty())
+      this->record(record.cycle, record.stageInfos);
+  }
+}
+
+void PipelineTraceWriter::record(
+    long long cycle, const std::map<StageIndex, StageInfo> &stages) {
+  if (m_options.breakpoints.empty()) {
+    writeRow(cycle, stages);
+    return;
+  }
+
+  if (atBreakpoint(stages)) {
+    for (const auto &prev : m_history)
+      writeRow(prev.first, prev.second);
+    m_history.clear();
+    m_recordUntil = cycle + m_options.context;
+  }
+  if (cycle <= m_recordUntil) {
+    writeRow(cycle, stages);
+  } else if (m_options.context != 0) {
+    m_history.emplace_back(cycle, stages);
+    if (m_history.size() > m_options.context)
+      m_history.pop_front();
+  }
+}
+
+bool PipelineTraceWriter::atBreakpoint(
+    const std::map<StageIndex, StageInfo> &stages) const {
+  for (const auto &idx : m_breakpointStages) {
+    auto it = stages.find(idx);
+    if (it != stages.end() && it->second.stage_valid &&
+        it->second.state == StageInfo::State::None &&
+        m_options.breakpoints.count(it->second.pc))
+      return true;
+  }
+  return false;
+}
+
+void PipelineTraceWriter::writeRow(
+    long long cycle, const std::map<StageIndex, StageInfo> &stages) {
+  if (m_options.format == PipelineTraceOptions::Format::ChromeTrace) {
+    writeChromeTraceCycle(cycle, stages);
+    return;
+  }
+
+  QByteArray row = QByteArray::number(cycle);
+  for (const auto &stage : stages) {
+    row += '\t';
+    const auto &info = stage.second;
+    if (!info.stage_valid || info.state == StageInfo::State::Unused)
+      continue;
+    if (info.state != StageInfo::State::None) {
+      row += '(' + stageStateName(info.state).toUtf8() + ')';
+      continue;
+    }
+    row += ProcessorHandler::disassembleInstr(info.pc).toUtf8();
+    if (!info.namedState.isEmpty())
+      row += " (" + info.namedState.toUtf8() + ')';
+  }
+  m_file.write(row + '\n');
+  m_cycles++;
+}
+
+void PipelineTraceWriter::writeChromeTraceCycle(
+    long long cycle, const std::map<StageIndex, StageInfo> &stages) {
+  unsigned tid = 0;
+  for (const auto &stage : stages) {
+    auto &slice = m_slices[stage.first];
+    if (slice.first != -1 && slice.last + 1 == cycle &&
+        slice.info == stage.second &&
+        slice.info.namedState == stage.second.namedState) {
+      slice.last = cycle;
+    } else {
+      writeSlice(tid, slice);
+      slice = {stage.second, cycle, cycle};
+    }
+    tid++;
+  }
+  m_cycles++;
+}
+
+void PipelineTraceWriter::writeSlice(unsigned tid, const Slice &slice) {
+  const auto &info = slice.info;
+  if (slice.first == -1 || !info.stage_valid ||
+      info.state == StageInfo::State::Unused)
+    return;
+
+  QJsonObject event{{"ph", "X"},
+                    {"pid", 0},
+                    {"tid", static_cast<int>(tid)},
+                    {"ts", slice.first},
+                    {"dur", slice.last - slice.first + 1}};
+  if (info.state != StageInfo::State::None) {
+    event["name"] = '(' + stageStateName(info.state) + ')';
+    event["cat"] = stageStateName(info.state);
+  } else {
+    event["name"] = ProcessorHandler::disassembleInstr(info.pc);
+    event["cat"] = "instruction";
+    QJsonObject args{
+        {"pc", "0x" + QString::number(info.pc, 16).rightJustified(8, '0')}};
+    if (!info.namedState.isEmpty())
+      args["state"] = info.namedState;
+    event["args"] = args;
+  }
+  writeChromeTraceEvent(event);
+}
+
+void PipelineTraceWriter::writeChromeTraceEvent(const QJsonObject &event) {
+  if (!m_firstEvent)
+    m_file.write(",\n");
+  m_firstEvent = false;
+  m_file.write(QJsonDocument(event).toJson(QJsonDocument::Compact));
+}
+
+void PipelineTraceWriter::syscallExecuted(int function) {
+  const auto *proc = ProcessorHandler::getProcessor();
+  const long long cycle = proc->getCycleCount();
+  if (cycle < m_options.first || cycle > m_options.last)
+    return;
+  const auto &syscalls = ProcessorHandler::getSyscallManager().getSyscalls();
+  auto it = syscalls.find(function);
+  QString name = "syscall " + QString::number(function);
+  if (it != syscalls.end())
+    name = it->second->name();
+  // System calls are events of the thread following the threads of the stages.
+  const int tid = proc->structure().numStages();
+  writeChromeTraceEvent({{"ph", "i"},
+                         {"s", "g"},
+                         {"pid", 0},
+                         {"tid", tid},
+                         {"ts", cycle},
+                         {"name", name},
+                         {"cat", "syscall"}});
+}
+
+} // namespace Ripes
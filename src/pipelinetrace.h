@@ -0,0 +1,97 @@
+#pragma once
+
+#include <QFile>
+#include <QJsonObject>
+#include <QObject>
+
+#include <deque>
+#include <limits>
+#include <set>
+
+#include "processors/interface/ripesprocessor.h"
+
+namespace Ripes {
+
+/// Options of a pipeline trace. See PipelineTraceWriter for details.
+struct PipelineTraceOptions {
+  enum class Format { TSV, ChromeTrace };
+  QString path;
+  Format format = Format::TSV;
+  // Range of cycles which are recorded.
+  long long first = 0;
+  long long last = std::numeric_limits<long long>::max();
+  // If non-empty, only the cycles around the cycles in which an instruction at
+  // any of these addresses is in a breakpoint-triggering stage are recorded.
+  std::set<AInt> breakpoints;
+  // Number of cycles recorded before and after each breakpoint.
+  unsigned context = 8;
+  bool enabled() const { return !path.isEmpty(); }
+};
+
+/**
+ * @brief The PipelineTraceWriter class
+ * Writes the state of the pipeline of the current processor to a file whilst
+ * it is being clocked, as a tab-separated table with one row per cycle and one
+ * column per stage. A stage holding an instruction is denoted by the
+ * disassembled instruction, followed by the state of the stage if it is not
+ * executing the instruction normally.
+ *
+ * Alternatively, the trace is written in the Chrome Trace Event format, which
+ * is read by chrome://tracing and the Perfetto UI. Each stage is a thread of
+ * the trace, in which each instruction is a slice spanning the consecutive
+ * cycles it occupied the stage; stalls and flushes are slices of their own.
+ * System calls are instant events. One cycle is one microsecond of the trace.
+ *
+ * Contrary to the PipelineDiagramModel, rows are written as cycles are
+ * clocked, such that the memory used is independent of the number of cycles
+ * recorded. The recorded cycles may be limited to a window of cycles, and to
+ * the cycles around breakpoints.
+ */
+class PipelineTraceWriter : public QObject {
+  Q_OBJECT
+public:
+  PipelineTraceWriter(const PipelineTraceOptions &options);
+  ~PipelineTraceWriter();
+
+  /// Creates the trace file and starts recording the processor of the
+  /// ProcessorHandler. Returns false and sets @p errorMessage on failure.
+  bool open(QString &errorMessage);
+  void close();
+
+  const QString &path() const { return m_options.path; }
+  long long cycles() const { return m_cycles; }
+
+private:
+  void processorWasClocked();
+  void processorWasClockedBatch();
+  void record(long long cycle, const std::map<StageIndex, StageInfo> &stages);
+  bool atBreakpoint(const std::map<StageIndex, StageInfo> &stages) const;
+  void writeRow(long long cycle, const std::map<StageIndex, StageInfo> &stages);
+  void writeChromeTraceCycle(long long cycle,
+                             const std::map<StageIndex, StageInfo> &stages);
+  void writeChromeTraceEvent(const QJsonObject &event);
+  void syscallExecuted(int function);
+
+  /// A slice of the Chrome trace of a stage; the latest cycles in which the
+  /// stage was in the same state.
+  struct Slice {
+    StageInfo info;
+    long long first = -1;
+    long long last = -1;
+  };
+  void writeSlice(unsigned tid, const Slice &slice);
+
+  PipelineTraceOptions m_options;
+  QFile m_file;
+  std::vector<StageIndex> m_breakpointStages;
+  // The latest cycles preceding the current cycle which were not written, for
+  // recording the context before a breakpoint.
+  std::deque<std::pair<long long, std::map<StageIndex, StageInfo>>> m_history;
+  // Cycles up to and including this cycle are written.
+  long long m_recordUntil = -1;
+  long long m_cycles = 0;
+  std::map<StageIndex, Slice> m_slices;
+  bool m_firstEvent = true;
+};
+
+} // namespace Ripes
@@ -1,21 +1,49 @@
 #include "processorhandler.h"
 
 #include "processorregistry.h"
+#include "processors/interface/simprofiler.h"
 #include "processors/ripesvsrtlprocessor.h"
 #include "ripessettings.h"
 #include "statusmanager.h"
+#include "tracespans.h"
 
 #include "assembler/assembler.h"
 #include "assembler/program.h"
+#include "binutils.h"
 #include "io/iomanager.h"
 
-#include "syscall/riscv_syscall.h"
+#include "syscall/syscallmanagers.h"
 
+#include <QElapsedTimer>
+#include <QGuiApplication>
 #include <QMessageBox>
+#include <QScreen>
+#include <QSignalBlocker>
 #include <QtConcurrent/QtConcurrent>
 
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <utility>
+
 namespace Ripes {
 
+// Number of cycles executed between each notification of per-cycle observers
+// while running.
+static constexpr unsigned s_runBatchCycles = 1024;
+// Maximum number of frames skipped after a refresh exceeding its budget.
+static constexpr qint64 s_maxRefreshBackoff = 30;
+// Paced runs fall behind by at most this many milliseconds of cycles; cycles
+// beyond are dropped rather than caught up on.
+static constexpr long long s_maxPaceLagMs = 50;
+// Paced runs sleep for at most this many milliseconds at a time, such that
+// they respond to stop requests.
+static constexpr qint64 s_maxPaceSleepMs = 10;
+#ifdef RIPES_COOPERATIVE_RUN
+// Milliseconds of clocking in each slice of a run on the GUI thread.
+static constexpr qint64 s_runSliceMs = 12;
+#endif
+
 ProcessorHandler::ProcessorHandler() {
   m_constructing = true;
 
@@ -43,36 +71,40 @@ ProcessorHandler::ProcessorHandler() {
     extensions = RipesSettings::value(RIPES_SETTING_PROCESSOR_EXTENSIONS)
                      .value<QStringList>();
 
-  _selectProcessor(
-      m_currentID, extensions,
-      ProcessorRegistry::getDescription(m_currentID).defaultRegisterVals);
-
-  // The m_procStateChangeTimer limits maximum frequency of which the
-  // procStateChangedNonRun is emitted.
-  m_procStateChangeTimer.setSingleShot(true);
-  m_procStateChangeTimer.setInterval(
-      1000.0 / RipesSettings::value(RIPES_SETTING_UIUPDATEPS).toInt());
-  connect(RipesSettings::getObserver(RIPES_SETTING_UIUPDATEPS),
-          &SettingObserver::modified, this, [=] {
-            m_procStateChangeTimer.setInterval(
-                1000.0 /
-                RipesSettings::value(RIPES_SETTING_UIUPDATEPS).toInt());
-          });
-
-  connect(&m_procStateChangeTimer, &QTimer::timeout, this, [=] {
-    emit procStateChangedNonRun();
-    m_enqueueStateChangeLock.lock();
-    if (m_enqueueStateChangeSignal) {
-      m_enqueueStateChangeSignal = false;
-      m_procStateChangeTimer.start();
-    }
-    m_enqueueStateChangeLock.unlock();
-  });
+  // The processor is constructed once first used, such that no processor is
+  // constructed if another processor is selected first (ie. by the CLI).
+  m_pendingProcessor = PendingProcessor{
+      extensions,
+      ProcessorRegistry::getDescription(m_currentID).defaultRegisterVals};
+
+  // Refresh the GUI at most once per frame of the screen.
+  double refreshRate = 60;
+  auto *app = qobject_cast<QGuiApplication *>(QCoreApplication::instance());
+  if (auto *screen = app ? app->primaryScreen() : nullptr;
+      screen && screen->refreshRate() > 0)
+    refreshRate = screen->refreshRate();
+  m_refreshTimer.setInterval(std::max(1, qRound(1000.0 / refreshRate)));
+  m_refreshTimer.setTimerType(Qt::PreciseTimer);
+  connect(&m_refreshTimer, &QTimer::timeout, this, &ProcessorHandler::_refresh);
+
+#ifdef RIPES_COOPERATIVE_RUN
+  m_runSliceTimer.setInterval(0);
+  connect(&m_runSliceTimer, &QTimer::timeout, this,
+          &ProcessorHandler::runSlice);
+#endif
+
+  // The first clock concludes the startup phases.
+  const auto markFirstClock = [] { TraceSpans::markOnce("First clock"); };
+  connect(this, &ProcessorHandler::processorClocked, this, markFirstClock,
+          Qt::DirectConnection);
+  connect(this, &ProcessorHandler::processorClockedBatch, this,
+          markFirstClock, Qt::DirectConnection);
 
   // Connect the runwatcher finished signals
   connect(&m_runWatcher, &QFutureWatcher<void>::finished, this, [=] {
+    emit aboutToPresentState();
     emit runFinished();
-    _triggerProcStateChangeTimer();
+    _notifyStateChanged();
   });
   connect(&m_runWatcher, &QFutureWatcher<void>::finished, this,
           [=] { ProcessorStatusManager::clearStatus(); });
@@ -80,26 +112,16 @@ ProcessorHandler::ProcessorHandler() {
   // Connect relevant settings changes to VSRTL
   connect(RipesSettings::getObserver(RIPES_SETTING_REWINDSTACKSIZE),
           &SettingObserver::modified, this, [=](const auto &size) {
-            m_currentProcessor->setMaxReverseCycles(size.toUInt());
+            if (m_currentProcessor)
+              m_currentProcessor->setMaxReverseCycles(size.toUInt());
           });
 
-  // Update VSRTL reverse stack size to reflect current settings
-  m_currentProcessor->setMaxReverseCycles(
-      RipesSettings::value(RIPES_SETTING_REWINDSTACKSIZE).toInt());
-
-  connect(RipesSettings::getObserver(RIPES_SETTING_VCD_TRACE),
-          &SettingObserver::modified, this, [=](const auto &enabled) {
-            m_currentProcessor->vcdTrace(
-                enabled.toBool(),
-                RipesSettings::value(RIPES_SETTING_VCD_TRACE_FILE).toString());
-          });
-
-  connect(RipesSettings::getObserver(RIPES_SETTING_VCD_TRACE_FILE),
-          &SettingObserver::modified, this, [=](const auto &file) {
-            m_currentProcessor->vcdTrace(
-                RipesSettings::value(RIPES_SETTING_VCD_TRACE).toBool(),
-                file.toString());
-          });
+  for (const auto *setting :
+       {RIPES_SETTING_VCD_TRACE, RIPES_SETTING_VCD_TRACE_FILE,
+        RIPES_SETTING_VCD_TRACE_COMPONENTS}) {
+    connect(RipesSettings::getObserver(setting), &SettingObserver::modified,
+            this, [=] { updateVCDTrace(); });
+  }
 
   // Reset VCD trace status.
   RipesSettings::getObserver(RIPES_SETTING_VCD_TRACE_FILE)->trigger();
@@ -108,7 +130,8 @@ ProcessorHandler::ProcessorHandler() {
   connect(RipesSettings::getObserver(RIPES_GLOBALSIGNAL_REQRESET),
           &SettingObserver::modified, this, &ProcessorHandler::_reset);
 
-  m_syscallManager = std::make_unique<RISCVSyscallManager>();
+  m_syscallManager = createSyscallManager(
+      ProcessorRegistry::getDescription(m_currentID).isaInfo().isa->isaID());
   m_constructing = false;
 }
 
@@ -118,6 +141,7 @@ bool ProcessorHandler::isVSRTLProcessor() {
 }
 
 void ProcessorHandler::_loadProgram(const std::shared_ptr<Program> &p) {
+  TraceSpan span("Load program");
   // Stop any currently executing simulation
   stopRun();
 
@@ -125,17 +149,20 @@ void ProcessorHandler::_loadProgram(const std::shared_ptr<Program> &p) {
   if (!textSection)
     return;
 
-  auto &mem = m_currentProcessor->getMemory();
+  auto &mem = _getProcessor()->getMemory();
 
   m_program = p;
+  m_disassemblyMemo.clear();
   // Memory initializations
-  mem.clearInitializationMemories();
+  MemoryBlock::clearInitializationMemories(mem);
   for (const auto &seg : p->sections) {
-    mem.addInitializationMemory(seg.second.address, seg.second.data.data(),
-                                seg.second.data.length());
+    // The sections are referenced by the memory, and owned by the program.
+    MemoryBlock::addInitializationMemory(mem, seg.second.address,
+                                         seg.second.data.constData(),
+                                         seg.second.data.length(), p);
   }
 
-  m_currentProcessor->setPCInitialValue(p->entryPoint);
+  _getProcessor()->setPCInitialValue(p->entryPoint);
 
   const auto textStart = textSection->address;
   const auto textEnd = textSection->address + textSection->data.length();
@@ -150,28 +177,121 @@ void ProcessorHandler::_loadProgram(const std::shared_ptr<Program> &p) {
   for (const auto &bp : bpsToRemove) {
     m_breakpoints.erase(bp);
   }
+  rebuildBreakpointMap();
 
   RipesSettings::getObserver(RIPES_GLOBALSIGNAL_REQRESET)->trigger();
   emit programChanged();
 }
 
 void ProcessorHandler::_writeMem(AInt address, VInt value, int size) {
-  m_currentProcessor->getMemory().writeMem(address, value, size);
+  _getProcessor()->getMemory().writeMem(address, value, size);
+  if (m_trackWrittenPages)
+    trackWrite(address, size);
 }
 
-vsrtl::core::AddressSpaceMM &ProcessorHandler::_getMemory() {
-  return m_currentProcessor->getMemory();
+void ProcessorHandler::_writeMemBlock(AInt address, const char *data,
+                                      size_t size) {
+  MemoryBlock::writeBlock(_getProcessor()->getMemory(), address, data, size);
+  if (m_trackWrittenPages && size != 0)
+    trackWrite(address, size);
 }
 
-void ProcessorHandler::_triggerProcStateChangeTimer() {
-  m_enqueueStateChangeLock.lock();
-  if (!m_procStateChangeTimer.isActive()) {
-    m_enqueueStateChangeSignal = false;
-    m_procStateChangeTimer.start();
+const RegisterFileHandle &
+ProcessorHandler::registerFile(const std::string_view &rfid) {
+  if (auto *context = SimulationContext::active())
+    return context->registerFile(rfid);
+  return get()->m_registerFiles[rfid];
+}
+
+void ProcessorHandler::updateObservers() {
+  if (!m_currentProcessor)
+    return;
+  // Pages written by the processor are recorded from its data accesses.
+  auto &observers = m_currentProcessor->observers();
+  if (m_trackWrittenPages) {
+    observers.subscribe<ProcessorEvent::DataAccess>(
+        this, [=](const ProcessorEvent::DataAccess &event) {
+          if (event.access.type == MemoryAccess::Write)
+            trackWrite(event.access.address, event.access.bytes);
+        });
   } else {
-    m_enqueueStateChangeSignal = true;
+    observers.unsubscribe<ProcessorEvent::DataAccess>(this);
   }
-  m_enqueueStateChangeLock.unlock();
+}
+
+void ProcessorHandler::trackWrite(AInt address, size_t bytes) {
+  const AInt first = address & ~(s_trackedPageSize - 1);
+  const AInt last = (address + bytes - 1) & ~(s_trackedPageSize - 1);
+  for (AInt page = first; page != last; page += s_trackedPageSize)
+    m_writtenPages.insert(page);
+  m_writtenPages.insert(last);
+}
+
+void ProcessorHandler::_notifyStateChanged() {
+  m_stateVersion.fetch_add(1);
+  // The refresh timer is started from the GUI thread, and only if stopped.
+  if (!m_refreshScheduled.exchange(true))
+    QMetaObject::invokeMethod(
+        this, [=] { m_refreshTimer.start(); }, Qt::QueuedConnection);
+}
+
+void ProcessorHandler::_notifyStateRestored() {
+  // As when resetting the processor.
+  _publishStateSnapshot();
+  emit aboutToPresentState();
+  emit procStateChangedNonRun();
+}
+
+void ProcessorHandler::_publishStateSnapshot() {
+  m_stateSnapshot.store({_getProcessor()->getCycleCount(),
+                         _getProcessor()->getInstructionsRetired()});
+}
+
+void ProcessorHandler::_refresh() {
+  if (m_refreshBackoff != 0) {
+    m_refreshBackoff--;
+    return;
+  }
+
+  QElapsedTimer timer;
+  timer.start();
+  SimProfiler::Scope profile(SimProfiler::Views);
+  if (_isRunning() && m_paced) {
+    // Paced runs are presented as when stepping the processor, in the frames
+    // in which the run clocked the processor.
+    std::lock_guard lock(m_clockLock);
+    const long long cycle = _getProcessor()->getCycleCount();
+    if (cycle == m_pacedRefreshCycle)
+      return;
+    m_pacedRefreshCycle = cycle;
+    emit aboutToPresentState();
+    emit procStateChangedNonRun();
+    emit runStateRefreshed();
+  } else if (_isRunning()) {
+    emit runStateRefreshed();
+  } else {
+    const unsigned long version = m_stateVersion.load();
+    if (version == m_refreshedVersion) {
+      // Nothing changed since the previous refresh. Stop refreshing, unless
+      // the state changed whilst stopping.
+      m_refreshTimer.stop();
+      m_refreshScheduled = false;
+      if (m_stateVersion.load() != m_refreshedVersion &&
+          !m_refreshScheduled.exchange(true))
+        m_refreshTimer.start();
+      return;
+    }
+    m_refreshedVersion = version;
+    _publishStateSnapshot();
+    emit aboutToPresentState();
+    emit procStateChangedNonRun();
+  }
+
+  // Refreshing may occupy at most a quarter of the frames of the GUI thread.
+  const qint64 budget = m_refreshTimer.interval() / 4;
+  const qint64 elapsed = timer.elapsed();
+  m_refreshBackoff =
+      budget == 0 ? 0 : std::min<qint64>(elapsed / budget, s_maxRefreshBackoff);
 }
 
 class ProcessorClocker : public QRunnable {
@@ -181,7 +301,8 @@ public:
     std::unique_lock l(clockLock);
     ProcessorHandler::getProcessorNonConst()->clock();
     ProcessorHandler::checkProcessorFinished();
-    if (ProcessorHandler::checkBreakpoint()) {
+    const bool watchpointHit = ProcessorHandler::checkWatchpoints();
+    if (watchpointHit || ProcessorHandler::checkBreakpoint()) {
       ProcessorHandler::stopRun();
     }
   }
@@ -195,35 +316,178 @@ void ProcessorHandler::_clock() {
   // that there already is an ongoing clock event. This _clock event will
   // therefore be ignored.
   if (m_clockLock.try_lock()) {
+    m_watchpointHit.reset();
+    m_watchpoints.sync(*_getProcessor());
     QThreadPool::globalInstance()->start(new ProcessorClocker(m_clockLock));
     m_clockLock.unlock();
   }
 }
 
-void ProcessorHandler::_run() {
+void ProcessorHandler::_run(bool paced) {
+  m_paced = paced;
+  m_pacedRate = 0;
+  m_pacedRefreshCycle = -1;
   ProcessorStatusManager::setStatusTimed("Running...");
   emit runStarted();
+  _notifyStateChanged();
 
+  // Stage information is by default only required by the pipeline diagram,
+  // which stops recording after a set number of cycles.
+  if (m_runStageInfoRange)
+    _getProcessor()->setBatchStageInfoRange(m_runStageInfoRange->first,
+                                            m_runStageInfoRange->second);
+  else
+    _getProcessor()->setBatchStageInfoRange(
+        0, RipesSettings::value(RIPES_SETTING_PIPEDIAGRAM_MAXCYCLES).toInt());
+
+#ifdef RIPES_COOPERATIVE_RUN
+  // Without native threads, the processor is clocked on the GUI thread in
+  // slices, between which the browser is free to render and handle events.
+  m_runPromise = std::make_unique<QPromise<void>>();
+  m_runPromise->start();
+  m_runWatcher.setFuture(m_runPromise->future());
+  beginRunLoop();
+  m_runSliceTimer.start();
+#else
   // Start running through the VSRTL Widget interface
   m_runWatcher.setFuture(QtConcurrent::run([=] {
-    auto *vsrtl_proc =
-        dynamic_cast<vsrtl::SimDesign *>(m_currentProcessor.get());
+    beginRunLoop();
+    while (clockRunBatch())
+      ;
+    endRunLoop();
+  }));
+#endif
+}
 
-    if (vsrtl_proc) {
-      vsrtl_proc->setEnableSignals(false);
-    }
+void ProcessorHandler::beginRunLoop() {
+  if (auto *vsrtl_proc =
+          dynamic_cast<vsrtl::SimDesign *>(m_currentProcessor.get()))
+    vsrtl_proc->setEnableSignals(false);
+  m_runLimitReached = RunLimit::None;
+  m_activeRunLimits = m_runLimits;
+  m_watchpointHit.reset();
+  m_watchpoints.sync(*m_currentProcessor);
+  if (m_commitLog)
+    m_commitLog->sync(*m_currentProcessor);
+  m_runStartCycle = m_currentProcessor->getCycleCount();
+}
+
+unsigned ProcessorHandler::pacedCyclesDue(unsigned rate, qint64 &waitNs) {
+  if (rate != m_pacedRate) {
+    // The pace is restarted whenever the rate changes.
+    m_pacedRate = rate;
+    m_pacedCycles = 0;
+    m_paceTimer.start();
+  }
+  // Cycle i of the pace is due i / rate seconds after its start.
+  const long long elapsedUs = m_paceTimer.nsecsElapsed() / 1000;
+  long long due = elapsedUs * rate / 1000000 + 1 - m_pacedCycles;
+  const long long maxLag = std::max<long long>(1, rate * s_maxPaceLagMs / 1000);
+  if (due > maxLag) {
+    m_pacedCycles += due - maxLag;
+    due = maxLag;
+  }
+  if (due > 0) {
+    waitNs = 0;
+    return std::min<long long>(due, s_runBatchCycles);
+  }
+  waitNs = (m_pacedCycles * 1000000 / rate - elapsedUs) * 1000;
+  return 0;
+}
 
-    while (!(_checkBreakpoint() || m_currentProcessor->finished() ||
-             m_stopRunningFlag)) {
-      m_currentProcessor->clock();
+bool ProcessorHandler::clockRunBatch() {
+  // Clock the processor in batches; per-cycle observers are notified once
+  // per batch. A batch cut short indicates that the processor finished, or
+  // that a breakpoint, watchpoint, stop request or instruction limit was
+  // encountered.
+  // The cycle limit bounds the size of the batches, and thus costs nothing
+  // per cycle.
+  const RunLimits &limits = m_activeRunLimits;
+  const auto stop = [=] {
+    if (limits.instructions != 0 &&
+        m_currentProcessor->getInstructionsRetired() >= limits.instructions) {
+      m_runLimitReached = RunLimit::Instructions;
+      return true;
     }
+    // The commit log and watchpoints observe every cycle, to keep up with
+    // register writes.
+    if (m_commitLog)
+      m_commitLog->observe(*m_currentProcessor);
+    const bool watchpointHit = _checkWatchpoints();
+    // Paced runs step off of the breakpoint which they start at, as stepping
+    // does.
+    const bool atStart =
+        m_paced && m_currentProcessor->getCycleCount() == m_runStartCycle;
+    return watchpointHit || (!atStart && _checkBreakpoint()) ||
+           m_stopRunningFlag;
+  };
+  unsigned batch = s_runBatchCycles;
+  if (limits.cycles != 0) {
+    const long long remaining =
+        limits.cycles - m_currentProcessor->getCycleCount();
+    if (remaining <= 0) {
+      if (!m_currentProcessor->finished())
+        m_runLimitReached = RunLimit::Cycles;
+      return false;
+    }
+    batch = std::min<long long>(batch, remaining);
+  }
+  if (m_paced) {
+    qint64 waitNs = 0;
+    const unsigned due = pacedCyclesDue(m_runRate, waitNs);
+    if (due == 0) {
+#ifndef RIPES_COOPERATIVE_RUN
+      std::this_thread::sleep_for(std::chrono::nanoseconds(
+          std::min(waitNs, s_maxPaceSleepMs * 1000000)));
+#endif
+      return !m_stopRunningFlag;
+    }
+    batch = std::min(batch, due);
+  }
+  unsigned cycles = 0;
+  if (m_paced) {
+    // The GUI refreshes from the processor between the batches of paced runs.
+    std::lock_guard lock(m_clockLock);
+    cycles = m_currentProcessor->clockN(batch, stop);
+    m_pacedCycles += cycles;
+  } else {
+    cycles = m_currentProcessor->clockN(batch, stop);
+  }
+  _publishStateSnapshot();
+  return cycles == batch;
+}
+
+void ProcessorHandler::endRunLoop() {
+  // The final cycle of a run is not followed by a check of the run loop.
+  if (m_commitLog)
+    m_commitLog->observe(*m_currentProcessor);
+  if (auto *vsrtl_proc =
+          dynamic_cast<vsrtl::SimDesign *>(m_currentProcessor.get()))
+    vsrtl_proc->setEnableSignals(m_drawingEnabled);
+  emit aboutToPresentState();
+  emit runFinished();
+}
 
-    if (vsrtl_proc) {
-      vsrtl_proc->setEnableSignals(true);
+#ifdef RIPES_COOPERATIVE_RUN
+void ProcessorHandler::runSlice() {
+  if (!m_runPromise)
+    return;
+  QElapsedTimer timer;
+  timer.start();
+  while (timer.elapsed() < s_runSliceMs) {
+    if (!clockRunBatch()) {
+      m_runSliceTimer.stop();
+      endRunLoop();
+      m_runPromise->finish();
+      m_runPromise.reset();
+      return;
     }
-    emit runFinished();
-  }));
+    // The batches of paced runs are due across slices.
+    if (m_paced)
+      return;
+  }
 }
+#endif
 
 void ProcessorHandler::_setBreakpoint(const AInt address, bool enabled) {
   if (enabled && _isExecutableAddress(address)) {
@@ -231,6 +495,34 @@ void ProcessorHandler::_setBreakpoint(const AInt address, bool enabled) {
   } else {
     m_breakpoints.erase(address);
   }
+  rebuildBreakpointMap();
+}
+
+void ProcessorHandler::rebuildBreakpointMap() {
+  for (auto it = m_breakpointConditions.begin();
+       it != m_breakpointConditions.end();) {
+    if (!m_breakpoints.count(it->first)) {
+      it = m_breakpointConditions.erase(it);
+      continue;
+    }
+    compileBreakpointCondition(it->second);
+    ++it;
+  }
+
+  m_breakpointMap.clear();
+  m_breakpointMapBase = 0;
+  if (m_breakpoints.empty() || !m_program)
+    return;
+
+  if (auto *textSection = m_program->getSection(TEXT_SECTION_NAME)) {
+    m_breakpointMapBase = textSection->address;
+    m_breakpointMap.resize((textSection->data.length() + 1) / 2);
+    for (const auto &bp : m_breakpoints) {
+      const AInt idx = (bp - m_breakpointMapBase) / 2;
+      if (idx < m_breakpointMap.size())
+        m_breakpointMap[idx] = true;
+    }
+  }
 }
 
 void ProcessorHandler::_loadProcessorToWidget(vsrtl::VSRTLWidget *widget,
@@ -239,36 +531,202 @@ void ProcessorHandler::_loadProcessorToWidget(vsrtl::VSRTLWidget *widget,
 
   // Currently, only VSRTL processors can be visualized
   if (auto *vsrtlProcessor =
-          dynamic_cast<RipesVSRTLProcessor *>(m_currentProcessor.get())) {
+          dynamic_cast<RipesVSRTLProcessor *>(_getProcessor())) {
+    TraceSpan span("Load processor to view");
     widget->setDesign(vsrtlProcessor, doPlaceAndRoute);
+    vsrtlProcessor->setEnableSignals(m_drawingEnabled);
   }
 }
 
+void ProcessorHandler::_setProcessorDrawingEnabled(bool enabled) {
+  m_drawingEnabled = enabled;
+  // A run restores the signals of the processor once finished.
+  if (_isRunning())
+    return;
+  if (auto *vsrtlProcessor =
+          dynamic_cast<vsrtl::SimDesign *>(m_currentProcessor.get()))
+    vsrtlProcessor->setEnableSignals(enabled);
+}
+
 bool ProcessorHandler::_hasBreakpoint(const AInt address) const {
   return m_breakpoints.count(address);
 }
 
 bool ProcessorHandler::_checkBreakpoint() {
-  for (const auto &stage : m_currentProcessor->breakpointTriggeringStages()) {
-    const auto it =
-        m_breakpoints.find(m_currentProcessor->getPcForStage(stage));
-    if (it != m_breakpoints.end()) {
-      return true;
+  if (m_breakpointMap.empty())
+    return false;
+
+  for (const auto &stage : m_breakpointStages) {
+    const AInt pc = _getProcessor()->getPcForStage(stage);
+    // Addresses below the map base wrap around and fall outside the map.
+    const AInt idx = (pc - m_breakpointMapBase) / 2;
+    if (idx < m_breakpointMap.size() && m_breakpointMap[idx]) {
+      if (m_breakpointConditions.empty())
+        return true;
+      auto it = m_breakpointConditions.find(pc);
+      if (it == m_breakpointConditions.end() ||
+          breakpointConditionTriggered(it->second, stage))
+        return true;
     }
   }
   return false;
 }
 
+bool ProcessorHandler::breakpointConditionTriggered(
+    CompiledBreakpointCondition &condition, StageIndex stage) {
+  auto *proc = m_currentProcessor.get();
+  const long long cycle = proc->getCycleCount();
+  // The breakpoint may be checked more than once per cycle.
+  if (cycle == condition.lastCycle)
+    return condition.lastTriggered;
+  const bool stalled =
+      cycle == condition.lastCycle + 1 && condition.lastStalled;
+  condition.lastCycle = cycle;
+  condition.lastStalled =
+      proc->stageInfo(stage).state == StageInfo::State::Stalled;
+  if (stalled)
+    return condition.lastTriggered;
+
+  bool holds = true;
+  if (condition.expr) {
+    const unsigned bits = proc->implementsISA()->bits();
+    holds = condition.expr->evaluate([&](unsigned i) -> Assembler::ExprEvalVT {
+      const auto &operand = condition.operands[i];
+      VInt value = 0;
+      switch (operand.kind) {
+      case ConditionOperand::PC:
+        value = proc->getPcForStage(stage);
+        break;
+      case ConditionOperand::Register:
+        value = proc->getRegister(operand.rfid, operand.index);
+        break;
+      case ConditionOperand::Memory:
+        value = proc->getMemory().readMemConst(operand.address, bits / 8);
+        break;
+      }
+      // Values are signed, as immediates of the condition.
+      return vsrtl::signextend(value, bits);
+    }) != 0;
+  }
+  if (holds)
+    condition.condition.hits++;
+  condition.lastTriggered =
+      holds && condition.condition.hits >= condition.condition.hitCount;
+  return condition.lastTriggered;
+}
+
+void ProcessorHandler::compileBreakpointCondition(
+    CompiledBreakpointCondition &condition, QString *error) const {
+  using Binding = Assembler::CompiledExpr::Binding;
+  condition.expr.reset();
+  condition.operands.clear();
+  if (condition.condition.condition.trimmed().isEmpty())
+    return;
+
+  auto &operands = condition.operands;
+  const auto operand = [&](const ConditionOperand &op) {
+    operands.push_back(op);
+    return Binding{Binding::Operand,
+                   static_cast<Assembler::ExprEvalVT>(operands.size() - 1)};
+  };
+  const auto symbol = [&](const QString &name) -> std::optional<AInt> {
+    bool isImmediate;
+    const AInt value = getImmediate(name, isImmediate);
+    if (isImmediate)
+      return value;
+    if (m_program)
+      return m_program->symbolIndex().address(name);
+    return {};
+  };
+  const auto binder = [&](const QString &name) -> std::optional<Binding> {
+    if (name == "pc")
+      return operand({ConditionOperand::PC});
+    if (name.startsWith('[') && name.endsWith(']')) {
+      if (auto address = symbol(name.mid(1, name.size() - 2)))
+        return operand({ConditionOperand::Memory, {}, 0, *address});
+      return {};
+    }
+    for (const auto &[rfid, regInfo] : _currentISA()->regInfoMap()) {
+      bool found;
+      const unsigned index = regInfo->regNumber(name, found);
+      if (found)
+        return operand({ConditionOperand::Register, rfid, index});
+    }
+    if (auto address = symbol(name))
+      return Binding{Binding::Constant,
+                     static_cast<Assembler::ExprEvalVT>(*address)};
+    return {};
+  };
+  auto res = Assembler::CompiledExpr::compile(
+      Location::unknown(), condition.condition.condition, binder);
+  if (res.isError()) {
+    if (error)
+      *error = res.error().errorMessage();
+    return;
+  }
+  condition.expr = res.value();
+}
+
+QString ProcessorHandler::_setBreakpointCondition(const AInt address,
+                                                  const QString &condition,
+                                                  unsigned hitCount) {
+  if (!_isExecutableAddress(address))
+    return "Address 0x" + QString::number(address, 16) +
+           " is not an instruction of the program";
+  CompiledBreakpointCondition compiled;
+  compiled.condition.condition = condition.trimmed();
+  compiled.condition.hitCount = std::max(hitCount, 1u);
+  QString error;
+  compileBreakpointCondition(compiled, &error);
+  if (!error.isEmpty())
+    return error;
+
+  m_breakpoints.insert(address);
+  if (compiled.condition.condition.isEmpty() &&
+      compiled.condition.hitCount == 1)
+    m_breakpointConditions.erase(address);
+  else
+    m_breakpointConditions[address] = std::move(compiled);
+  rebuildBreakpointMap();
+  return QString();
+}
+
+std::optional<ProcessorHandler::BreakpointCondition>
+ProcessorHandler::_breakpointCondition(const AInt address) const {
+  auto it = m_breakpointConditions.find(address);
+  if (it == m_breakpointConditions.end())
+    return {};
+  return it->second.condition;
+}
+
+bool ProcessorHandler::_checkWatchpoints() {
+  if (m_watchpoints.empty())
+    return false;
+  auto hit = m_watchpoints.check(*m_currentProcessor);
+  if (!hit)
+    return false;
+  m_watchpointHit = hit;
+  emit watchpointTriggered(*hit);
+  return true;
+}
+
 void ProcessorHandler::_toggleBreakpoint(const AInt address) {
   _setBreakpoint(address, !hasBreakpoint(address));
 }
 
-void ProcessorHandler::_clearBreakpoints() { m_breakpoints.clear(); }
+void ProcessorHandler::_clearBreakpoints() {
+  m_breakpoints.clear();
+  rebuildBreakpointMap();
+}
 
 void ProcessorHandler::createAssemblerForCurrentISA() {
-  const auto &isa = m_currentProcessor->fullISA();
+  TraceSpan span("Assembler construction");
+  const auto &isa = _getProcessor()->fullISA();
   if (!m_currentAssembler || m_currentAssembler->getISA() != isa->isaID()) {
     m_currentAssembler = Assembler::constructAssemblerDynamic(isa);
+    // Programs are reassembled after every processor switch; reuse the
+    // programs assembled for identical sources and settings.
+    m_currentAssembler->setProgramCaching(true);
   }
 }
 
@@ -279,6 +737,16 @@ void ProcessorHandler::_reset() {
 
   SystemIO::abortSyscall();
   getProcessorNonConst()->resetProcessor();
+  // Peripherals reschedule their events upon being reset.
+  getProcessorNonConst()->events().clear();
+  m_syscallManager->resetStats();
+  m_syscallManager->anonymousMemory().reset();
+  m_writtenPages.clear();
+  m_watchpointHit.reset();
+  for (auto &[address, condition] : m_breakpointConditions) {
+    condition.condition.hits = 0;
+    condition.lastCycle = -1;
+  }
 
   // Rewrite register initializations
   for (const auto &regFileInit : m_currentRegInits) {
@@ -293,12 +761,41 @@ void ProcessorHandler::_reset() {
   // Forcing memory values doesn't necessarily mean that the processor will
   // notify that its state changed. Manually trigger a state change signal, to
   // ensure this.
+  _publishStateSnapshot();
+  emit aboutToPresentState();
   emit procStateChangedNonRun();
 }
 
+void ProcessorHandler::updateVCDTrace() {
+  if (!m_currentProcessor)
+    return;
+  const QString error = m_currentProcessor->vcdTrace(
+      RipesSettings::value(RIPES_SETTING_VCD_TRACE).toBool(),
+      RipesSettings::value(RIPES_SETTING_VCD_TRACE_FILE).toString(),
+      RipesSettings::value(RIPES_SETTING_VCD_TRACE_COMPONENTS)
+          .toString()
+          .split(',', Qt::SkipEmptyParts));
+  if (!error.isEmpty())
+    GeneralStatusManager::setStatusTimed(error, 5000);
+}
+
+void ProcessorHandler::constructPendingProcessor() {
+  const auto pending = std::move(*m_pendingProcessor);
+  // The processor is constructed as if it had been constructed along with the
+  // handler, ie. without notifying of a processor change.
+  const QSignalBlocker blocker(this);
+  const bool constructing = std::exchange(m_constructing, true);
+  _selectProcessor(m_currentID, pending.extensions, pending.setup);
+  m_constructing = constructing;
+  RipesSettings::getObserver(RIPES_SETTING_VCD_TRACE_FILE)->trigger();
+}
+
 void ProcessorHandler::_selectProcessor(const ProcessorID &id,
                                         const QStringList &extensions,
                                         const RegisterInitialization &setup) {
+  TraceSpan span("Select processor");
+  m_pendingProcessor.reset();
+  const ProcessorID previousID = m_currentID;
   m_currentID = id;
   m_currentRegInits = setup;
   RipesSettings::setValue(RIPES_SETTING_PROCESSOR_ID, id);
@@ -311,26 +808,82 @@ void ProcessorHandler::_selectProcessor(const ProcessorID &id,
           ProcessorRegistry::getDescription(id).isaInfo().isa.get(),
           extensions));
 
-  // Processor initializations
-  m_currentProcessor =
-      ProcessorRegistry::constructProcessor(m_currentID, extensions);
+  if (m_currentProcessor) {
+    emit processorAboutToChange();
+    if (m_cacheProcessors) {
+      m_processorCache.push_front({previousID, std::move(m_currentProcessor),
+                                   std::move(m_signalWrappers)});
+      m_signalWrappers.clear();
+    }
+  }
+
+  // Reuse a cached processor for the same ISA, if any. Its design has been
+  // verified, and its signals are still connected.
+  auto cached = std::find_if(
+      m_processorCache.begin(), m_processorCache.end(), [&](const auto &entry) {
+        return entry.id == id &&
+               entry.processor->implementsISA()->eq(
+                   ProcessorRegistry::getDescription(id).isaInfo().isa.get(),
+                   extensions);
+      });
+  const bool reused = cached != m_processorCache.end();
+  if (reused) {
+    m_currentProcessor = std::move(cached->processor);
+    m_signalWrappers = std::move(cached->signalWrappers);
+    m_processorCache.erase(cached);
+    // The program of the previous selection is not retained.
+    MemoryBlock::clearInitializationMemories(m_currentProcessor->getMemory());
+  } else {
+    // Processor initializations
+    m_currentProcessor =
+        ProcessorRegistry::constructProcessor(m_currentID, extensions);
+  }
+  trimProcessorCache();
+
   m_currentProcessor->isExecutableAddress = [=](AInt address) {
     return _isExecutableAddress(address);
   };
 
-  // Syscall handling initialization
+  // Syscall handling initialization. System calls follow the ABI of the ISA
+  // family of the processor.
   m_currentProcessor->trapHandler = [=] { syscallTrap(); };
-
-  m_currentProcessor->postConstruct();
+  const ISA isa = m_currentProcessor->implementsISA()->isaID();
+  if (m_syscallManager &&
+      ISAFamilyNames.at(isa) !=
+          ISAFamilyNames.at(ProcessorRegistry::getDescription(previousID)
+                                .isaInfo()
+                                .isa->isaID()))
+    m_syscallManager = createSyscallManager(isa);
+  updateObservers();
+
+  if (!reused)
+    m_currentProcessor->postConstruct();
+  m_currentProcessor->setMaxReverseCycles(
+      RipesSettings::value(RIPES_SETTING_REWINDSTACKSIZE).toInt());
+  m_currentProcessor->setPerformanceCounting(m_countPerformance);
+  m_breakpointStages = m_currentProcessor->breakpointTriggeringStages();
+  m_registerFiles = RegisterFileHandles(*m_currentProcessor);
   createAssemblerForCurrentISA();
+  m_disassemblyMemo.clear();
 
   if (keepProgram && m_program) {
     loadProgram(m_program);
   } else {
     m_program = nullptr;
+    rebuildBreakpointMap();
     emit programChanged();
   }
 
+  if (!reused)
+    connectProcessorSignals();
+
+  emit processorChanged();
+
+  // Finally, reset the processor
+  RipesSettings::getObserver(RIPES_GLOBALSIGNAL_REQRESET)->trigger();
+}
+
+void ProcessorHandler::connectProcessorSignals() {
   // Connect wrappers for making processor signal emissions thread safe.
   m_signalWrappers.clear();
   m_signalWrappers.push_back(std::unique_ptr<vsrtl::GallantSignalWrapperBase>(
@@ -338,8 +891,9 @@ void ProcessorHandler::_selectProcessor(const ProcessorID &id,
           this,
           [=] {
             if (!_isRunning()) {
+              SimProfiler::Scope profile(SimProfiler::Views);
               emit processorClockedNonRun();
-              _triggerProcStateChangeTimer();
+              _notifyStateChanged();
             }
           },
           m_currentProcessor->processorWasClocked)));
@@ -348,14 +902,16 @@ void ProcessorHandler::_selectProcessor(const ProcessorID &id,
   // not be possible through processorClockedNonRun, which might be cross-thread
   // and out of order.
   m_currentProcessor->processorWasClocked.Connect(
-      this, &ProcessorHandler::processorClocked);
+      this, &ProcessorHandler::dispatchProcessorClocked);
+  m_currentProcessor->processorWasBatchClocked.Connect(
+      this, &ProcessorHandler::dispatchProcessorClockedBatch);
 
   m_signalWrappers.push_back(std::unique_ptr<vsrtl::GallantSignalWrapperBase>(
       new vsrtl::GallantSignalWrapper(
           this,
           [=] {
             emit processorReset();
-            _triggerProcStateChangeTimer();
+            _notifyStateChanged();
           },
           m_currentProcessor->processorWasReset)));
 
@@ -364,13 +920,47 @@ void ProcessorHandler::_selectProcessor(const ProcessorID &id,
           this,
           [=] {
             emit processorReversed();
-            _triggerProcStateChangeTimer();
+            _notifyStateChanged();
           },
           m_currentProcessor->processorWasReversed)));
+}
 
-  emit processorChanged();
+void ProcessorHandler::dispatchProcessorClocked() {
+  SimProfiler::Scope profile(SimProfiler::Signals);
+  emit processorClocked();
+}
 
-  // Finally, reset the processor
+void ProcessorHandler::dispatchProcessorClockedBatch() {
+  SimProfiler::Scope profile(SimProfiler::Signals);
+  emit processorClockedBatch();
+}
+
+void ProcessorHandler::trimProcessorCache() {
+  const size_t size = m_cacheProcessors ? s_processorCacheSize : 0;
+  while (m_processorCache.size() > size) {
+    emit processorEvicted(m_processorCache.back().processor.get());
+    m_processorCache.pop_back();
+  }
+}
+
+void ProcessorHandler::_setProcessorCaching(bool enabled) {
+  m_cacheProcessors = enabled;
+  trimProcessorCache();
+}
+
+void ProcessorHandler::_reselectProcessor(const ProcessorID &id,
+                                          const QStringList &extensions,
+                                          const RegisterInitialization &setup) {
+  if (!m_currentProcessor || m_currentID != id ||
+      !m_currentProcessor->implementsISA()->eq(
+          ProcessorRegistry::getDescription(id).isaInfo().isa.get(),
+          extensions)) {
+    _selectProcessor(id, extensions, setup);
+    return;
+  }
+
+  stopRun();
+  m_currentRegInits = setup;
   RipesSettings::getObserver(RIPES_GLOBALSIGNAL_REQRESET)->trigger();
 }
 
@@ -397,9 +987,16 @@ AInt ProcessorHandler::_getTextStart() const {
 QString ProcessorHandler::_disassembleInstr(const AInt addr) const {
   if (m_program) {
     const unsigned instrBytes = _currentISA()->instrBytes();
+    const VInt word = _getProcessor()->getMemory().readMem(addr, instrBytes);
+    auto it = m_disassemblyMemo.constFind(addr);
+    if (it != m_disassemblyMemo.constEnd() && it->word == word)
+      return it->repr;
+
     auto disRes = m_currentAssembler->disassemble(
-        m_currentProcessor->getMemory().readMem(addr, instrBytes),
-        m_program.get()->symbols, addr);
+        word, m_program.get()->symbols, addr);
+    if (m_disassemblyMemo.size() >= s_disassemblyMemoSize)
+      m_disassemblyMemo.clear();
+    m_disassemblyMemo.insert(addr, {word, disRes.repr});
     return disRes.repr;
   } else {
     return QString();
@@ -407,19 +1004,31 @@ QString ProcessorHandler::_disassembleInstr(const AInt addr) const {
 }
 
 void ProcessorHandler::syscallTrap() {
-  auto futureWatcher = QFutureWatcher<bool>();
-  futureWatcher.setFuture(QtConcurrent::run([=] {
-    if (auto reg = _currentISA()->syscallReg(); reg.has_value()) {
-      const unsigned int function =
-          m_currentProcessor->getRegister(reg->file->regFileName(), reg->index);
-      return m_syscallManager->execute(function);
+  bool success = false;
+  if (auto reg = _currentISA()->syscallReg(); reg.has_value()) {
+    const unsigned int function = _getProcessor()->readRegister(
+        m_registerFiles[reg->file->regFileName()], reg->index);
+    _getProcessor()->publishSyscall(function);
+    emit syscallExecuted(function);
+    SimProfiler::Scope profile(SimProfiler::Syscalls);
+    QElapsedTimer latency;
+    latency.start();
+    const bool async = m_syscallManager->isBlocking(function);
+    if (async) {
+      // System calls waiting for console input are run asynchronously, such
+      // that they may be aborted through SystemIO::abortSyscall.
+      auto futureWatcher = QFutureWatcher<bool>();
+      futureWatcher.setFuture(QtConcurrent::run(
+          [=] { return m_syscallManager->execute(function); }));
+      futureWatcher.waitForFinished();
+      success = futureWatcher.result();
     } else {
-      return false;
+      success = m_syscallManager->execute(function);
     }
-  }));
+    m_syscallManager->recordLatency(function, latency.nsecsElapsed(), async);
+  }
 
-  futureWatcher.waitForFinished();
-  if (!futureWatcher.result()) {
+  if (!success) {
     // Syscall handling failed, stop running processor
     setStopRunFlag();
   }
@@ -428,7 +1037,7 @@ void ProcessorHandler::syscallTrap() {
 bool ProcessorHandler::_isRunning() { return !m_runWatcher.isFinished(); }
 
 void ProcessorHandler::_checkProcessorFinished() {
-  if (m_currentProcessor->finished())
+  if (_getProcessor()->finished())
     emit exit();
 }
 
@@ -444,7 +1053,14 @@ void ProcessorHandler::setStopRunFlag() {
 
 void ProcessorHandler::_stopRun() {
   setStopRunFlag();
+#ifdef RIPES_COOPERATIVE_RUN
+  // The run is clocked on this thread, and cannot be waited upon. With the
+  // stop flag set, the next slice concludes it.
+  while (m_runPromise)
+    runSlice();
+#else
   m_runWatcher.waitForFinished();
+#endif
   m_stopRunningFlag = false;
 }
 
@@ -461,11 +1077,6 @@ bool ProcessorHandler::_isExecutableAddress(AInt address) const {
 
 void ProcessorHandler::_setRegisterValue(const std::string_view &rfid,
                                          const unsigned idx, VInt value) {
-  m_currentProcessor->setRegister(rfid, idx, value);
-}
-
-VInt ProcessorHandler::_getRegisterValue(const std::string_view &rfid,
-                                         const unsigned idx) const {
-  return m_currentProcessor->getRegister(rfid, idx);
+  _getProcessor()->setRegister(rfid, idx, value);
 }
 } // namespace Ripes
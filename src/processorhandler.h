@@ -1,16 +1,33 @@
 #pragma once
 
+#include <QElapsedTimer>
 #include <QFuture>
 #include <QFutureWatcher>
+#include <QHash>
 #include <QObject>
+#include <QPromise>
+#include <QTimer>
+#include <algorithm>
+#include <atomic>
+#include <list>
+#include <map>
 #include <memory>
+#include <optional>
 
 #include "VSRTL/graphics/gallantsignalwrapper.h"
 #include "assembler/assembler.h"
+#include "assembler/expreval.h"
 #include "assembler/program.h"
+#include "commitlog.h"
+#include "memoryblock.h"
+#include "memoryfootprint.h"
 #include "processorregistry.h"
 #include "processors/interface/ripesprocessor.h"
+#include "seqlock.h"
+#include "simulationcontext.h"
 #include "syscall/ripes_syscall.h"
+#include "wasmSupport.h"
+#include "watchpoints.h"
 
 #include "VSRTL/graphics/vsrtl_widget.h"
 
@@ -21,6 +38,12 @@ namespace Ripes {
  * Manages construction and destruction of a VSRTL processor design, when
  * selecting between processors. Manages all interaction and control of the
  * current processor.
+ *
+ * The static accessors used by system calls and telemetry (processor, ISA,
+ * program, memory and register access) refer to the active SimulationContext
+ * of the calling thread, if any, and otherwise to the ProcessorHandler
+ * singleton. This allows the system call implementations to be shared between
+ * the GUI simulation and any number of headless simulation contexts.
  */
 class ProcessorHandler : public QObject {
   Q_OBJECT
@@ -34,11 +57,17 @@ public:
 
   /// Returns a non-const pointer to the currently instantiated processor.
   static RipesProcessor *getProcessorNonConst() {
+    if (auto *context = SimulationContext::active())
+      return context->processor();
     return get()->_getProcessor();
   }
 
   /// Returns a pointer to the currently instantiated processor.
-  static const RipesProcessor *getProcessor() { return get()->_getProcessor(); }
+  static const RipesProcessor *getProcessor() {
+    if (auto *context = SimulationContext::active())
+      return context->processor();
+    return get()->_getProcessor();
+  }
 
   /// Return a pointer to the currently instantiated assembler.
   static const std::shared_ptr<Assembler::AssemblerBase> getAssembler() {
@@ -46,29 +75,39 @@ public:
   }
 
   /// Returns the ID of the currently instantiated processor.
-  static const ProcessorID &getID() { return get()->_getID(); }
+  static const ProcessorID &getID() {
+    if (auto *context = SimulationContext::active())
+      return context->id();
+    return get()->_getID();
+  }
 
   /// Returns a pointer to the currently instantiated program.
   static std::shared_ptr<const Program> getProgram() {
+    if (auto *context = SimulationContext::active())
+      return context->program();
     return get()->_getProgram();
   }
 
   /// Returns a pointer to the currently instantiated ISA.
-  static const ISAInfoBase *currentISA() { return get()->_currentISA(); }
+  static const ISAInfoBase *currentISA() {
+    return getProcessor()->implementsISA();
+  }
 
   /// Returns a pointer to the current ISA with all its supported extensions
   /// enabled.
   static std::shared_ptr<const ISAInfoBase> fullISA() {
-    return get()->_fullISA();
+    return getProcessor()->fullISA();
   }
 
   /// Returns a const reference to the system call manager.
   static const SyscallManager &getSyscallManager() {
-    return get()->_getSyscallManager();
+    return getSyscallManagerNonConst();
   }
 
   /// Returns a non-const reference to the system call manager.
   static SyscallManager &getSyscallManagerNonConst() {
+    if (auto *context = SimulationContext::active())
+      return context->syscallManager();
     return get()->_getSyscallManagerNonConst();
   }
 
@@ -91,6 +130,17 @@ public:
     get()->_loadProcessorToWidget(widget, doPlaceAndRoute);
   }
 
+  /**
+   * @brief setProcessorDrawingEnabled
+   * Enables or disables the signals through which a VSRTL processor updates
+   * its drawing whilst being clocked. Drawing is disabled whilst the processor
+   * view is hidden, in which case the view must be synchronized with the
+   * processor once shown again. Signals are always disabled whilst running.
+   */
+  static void setProcessorDrawingEnabled(bool enabled) {
+    get()->_setProcessorDrawingEnabled(enabled);
+  }
+
   /**
    * @brief selectProcessor
    * Constructs the processor identified by @param id, and performs all
@@ -102,12 +152,26 @@ public:
     get()->_selectProcessor(id, extensions, setup);
   }
 
+  /**
+   * @brief reselectProcessor
+   * As selectProcessor, but if the current processor is already @param id
+   * with the same @param extensions, the current processor is reset with the
+   * register initializations of @param setup instead of being reconstructed.
+   */
+  static void reselectProcessor(
+      const ProcessorID &id, const QStringList &extensions = {},
+      const RegisterInitialization &setup = RegisterInitialization()) {
+    get()->_reselectProcessor(id, extensions, setup);
+  }
+
   /**
    * @brief isExecutableAddress
    * @returns whether @param address is within the executable section of the
    * currently loaded program.
    */
   static bool isExecutableAddress(AInt address) {
+    if (auto *context = SimulationContext::active())
+      return context->isExecutableAddress(address);
     return get()->_isExecutableAddress(address);
   }
 
@@ -137,7 +201,7 @@ public:
    * returns const-wrapped references to the current process memory
    */
   static vsrtl::core::AddressSpaceMM &getMemory() {
-    return get()->_getMemory();
+    return getProcessorNonConst()->getMemory();
   }
 
   /**
@@ -146,7 +210,7 @@ public:
    */
   static void setRegisterValue(const std::string_view &rfid, const unsigned idx,
                                VInt value) {
-    get()->_setRegisterValue(rfid, idx, value);
+    getProcessorNonConst()->setRegister(rfid, idx, value);
   }
   /**
    * @brief writeMem
@@ -154,18 +218,120 @@ public:
    * @p value into the memory of the simulator
    */
   static void writeMem(AInt address, VInt value, int size = sizeof(VInt)) {
+    if (auto *context = SimulationContext::active()) {
+      context->writeMem(address, value, size);
+      return;
+    }
     get()->_writeMem(address, value, size);
   }
 
+  /**
+   * @brief readMemBlock
+   * reads @p size bytes from the memory of the simulator, starting from
+   * @p address, into @p data.
+   */
+  static void readMemBlock(AInt address, char *data, size_t size) {
+    MemoryBlock::readBlock(getMemory(), address, data, size);
+  }
+
+  /**
+   * @brief readMemString
+   * returns the null-terminated string at @p address in the memory of the
+   * simulator, excluding the null terminator, and of at most @p maxLength
+   * bytes.
+   */
+  static QByteArray readMemString(AInt address, size_t maxLength = SIZE_MAX) {
+    QByteArray string(MemoryBlock::strnlen(getMemory(), address, maxLength),
+                      '\0');
+    readMemBlock(address, string.data(), string.size());
+    return string;
+  }
+
+  /**
+   * @brief writeMemBlock
+   * writes @p size bytes of @p data into the memory of the simulator, starting
+   * from @p address.
+   */
+  static void writeMemBlock(AInt address, const char *data, size_t size) {
+    if (auto *context = SimulationContext::active()) {
+      context->writeMemBlock(address, data, size);
+      return;
+    }
+    get()->_writeMemBlock(address, data, size);
+  }
+
+  /**
+   * @brief setTrackWrittenPages
+   * Enables recording of the memory pages (of size s_trackedPageSize) which
+   * have been written since the last reset, either by the processor or through
+   * ProcessorHandler::writeMem. Disabled by default.
+   */
+  static void setTrackWrittenPages(bool enabled) {
+    get()->m_trackWrittenPages = enabled;
+    get()->updateObservers();
+  }
+
+  /**
+   * @brief setPerformanceCounting
+   * Enables maintaining the performance counters of the current and any
+   * subsequently selected processor (see RipesProcessor::performanceCounters).
+   */
+  static void setPerformanceCounting(bool enabled) {
+    get()->m_countPerformance = enabled;
+    if (get()->m_currentProcessor)
+      get()->m_currentProcessor->setPerformanceCounting(enabled);
+  }
+
+  /**
+   * @brief setRunStageInfoRange
+   * Sets the range of cycles [@p first, @p last] for which stage information
+   * is recorded whilst running, in place of the cycles shown in the pipeline
+   * diagram. Used by observers of processorClockedBatch which require stage
+   * information beyond the pipeline diagram.
+   */
+  static void setRunStageInfoRange(long long first, long long last) {
+    get()->m_runStageInfoRange = {first, last};
+  }
+  static void clearRunStageInfoRange() { get()->m_runStageInfoRange.reset(); }
+
+  /**
+   * @brief writtenPages
+   * @returns the base addresses of the pages written since the last reset.
+   * Only valid if page tracking has been enabled before the last reset.
+   */
+  static const std::set<AInt> &writtenPages() { return get()->m_writtenPages; }
+  static constexpr AInt s_trackedPageSize = 0x1000;
+
+  /**
+   * @brief notifyStateRestored
+   * Publishes the state of the processor once it has been restored outside of
+   * a run, such as from a snapshot (see Snapshot::load).
+   */
+  static void notifyStateRestored() { get()->_notifyStateRestored(); }
+
   /**
    * @brief getRegisterValue
    * @returns value of register @param idx
    */
   static VInt getRegisterValue(const std::string_view &rfid,
                                const unsigned idx) {
-    return get()->_getRegisterValue(rfid, idx);
+    const auto &file = registerFile(rfid);
+    return file.valid() ? getProcessor()->readRegister(file, idx)
+                        : getProcessor()->getRegister(rfid, idx);
+  }
+  static VInt getRegisterValue(const RegisterFileHandle &file,
+                               const unsigned idx) {
+    return getProcessor()->readRegister(file, idx);
   }
 
+  /**
+   * @brief registerFile
+   * @returns the handle to register file @p rfid of the current processor,
+   * which is resolved once per processor (see RipesProcessor::registerFile).
+   * The handle is valid until another processor is selected.
+   */
+  static const RegisterFileHandle &registerFile(const std::string_view &rfid);
+
   /// Returns true if the processor is currently at a breakpoint. This is done
   /// through comparing the breakpoint-triggering stages of the current
   /// processor, fetching the PC of those stages, and comparing them against the
@@ -190,6 +356,74 @@ public:
   /// Removes all currently set breakpoints.
   static void clearBreakpoints() { get()->_clearBreakpoints(); }
 
+  /**
+   * @brief The BreakpointCondition struct
+   * Conditions on stopping at a breakpoint. The breakpoint is hit whenever the
+   * instruction at its address enters a breakpoint-triggering stage and
+   * @p condition evaluates to nonzero, and stops the processor once it has
+   * been hit @p hitCount times. The condition is an expression of the
+   * assembler (see Assembler::CompiledExpr), of register names, 'pc', symbols
+   * of the program, and words of memory at an address or symbol in brackets,
+   * eg. "a0 == 1000" or "[counter] >= 10". Conditions are evaluated on the
+   * state of the processor in the cycle in which the instruction enters the
+   * stage. An empty condition always holds.
+   */
+  struct BreakpointCondition {
+    QString condition;
+    unsigned hitCount = 1;
+    /// Times the breakpoint was hit since the processor was reset.
+    unsigned hits = 0;
+  };
+
+  /**
+   * @brief setBreakpointCondition
+   * Sets the condition of the breakpoint at @p address, setting the
+   * breakpoint if not set, and resets its hit count. Returns an error message
+   * if the condition is invalid, in which case the breakpoint is unchanged.
+   */
+  static QString setBreakpointCondition(const AInt address,
+                                        const QString &condition,
+                                        unsigned hitCount = 1) {
+    return get()->_setBreakpointCondition(address, condition, hitCount);
+  }
+
+  /// Returns the condition of the breakpoint at @p address, if conditional.
+  static std::optional<BreakpointCondition>
+  breakpointCondition(const AInt address) {
+    return get()->_breakpointCondition(address);
+  }
+
+  /**
+   * @brief watchpoints
+   * The memory and register watchpoints of the current processor, which stop
+   * runs once hit. Watchpoints are kept across processor changes, and may
+   * only be modified whilst the processor is not being clocked.
+   */
+  static Watchpoints &watchpoints() { return get()->m_watchpoints; }
+
+  /// Returns true if a watchpoint was hit in the latest cycle, and records
+  /// the hit.
+  static bool checkWatchpoints() { return get()->_checkWatchpoints(); }
+
+  /**
+   * @brief watchpointHit
+   * @returns the watchpoint hit which stopped the latest run or clock, if
+   * any. Cleared once the processor is clocked, run or reset.
+   */
+  static const std::optional<Watchpoints::Hit> &watchpointHit() {
+    return get()->m_watchpointHit;
+  }
+
+  /**
+   * @brief setCommitLog
+   * Logs the instructions retired by subsequent runs to @p log, or stops
+   * logging if null. May only be set whilst the processor is not being
+   * clocked.
+   */
+  static void setCommitLog(const std::shared_ptr<CommitLog> &log) {
+    get()->m_commitLog = log;
+  }
+
   /// Trigger a processor finished check. This inspect the current processor run
   /// state, and if finished, emit a finish signal.
   static void checkProcessorFinished() { get()->_checkProcessorFinished(); }
@@ -197,6 +431,21 @@ public:
   /// Returns true if the simulator is currently in "run" mode.
   static bool isRunning() { return get()->_isRunning(); }
 
+  /// The state of the processor displayed whilst it is running.
+  struct StateSnapshot {
+    long long cycleCount = 0;
+    long long instructionsRetired = 0;
+  };
+
+  /**
+   * @brief stateSnapshot
+   * Returns the latest published state of the processor. The state is
+   * published by the simulating thread after each batch of a run, and by the
+   * GUI thread when refreshing whilst not running, and may be read from any
+   * thread without synchronizing with the simulation.
+   */
+  static StateSnapshot stateSnapshot() { return get()->m_stateSnapshot.load(); }
+
   static void setMemoryFocusAddress(AInt address) {
     emit get()->memoryFocusAddressChanged(address);
   }
@@ -210,6 +459,45 @@ public:
    */
   static void run() { get()->_run(); }
 
+  /**
+   * @brief runPaced
+   * Runs the current processor as run() does, but at @p cyclesPerSecond
+   * cycles per second, sleeping between batches of cycles. Whilst the run is
+   * paced, the GUI is refreshed as when stepping the processor, such that
+   * slow-motion runs are presented cycle by cycle.
+   */
+  static void runPaced(unsigned cyclesPerSecond) {
+    setRunRate(cyclesPerSecond);
+    get()->_run(true);
+  }
+  /// Sets the rate of paced runs, which takes effect on an ongoing run.
+  static void setRunRate(unsigned cyclesPerSecond) {
+    get()->m_runRate = std::max(cyclesPerSecond, 1u);
+  }
+
+  /**
+   * @brief The RunLimits struct
+   * Bounds on the cycle count and the number of retired instructions of the
+   * processor whilst running. A bound of 0 is unbounded. The bounds are checked
+   * within the run loop, such that runs stop deterministically regardless of
+   * the load of the host.
+   */
+  struct RunLimits {
+    long long cycles = 0;
+    long long instructions = 0;
+  };
+  enum class RunLimit { None, Cycles, Instructions };
+
+  static void setRunLimits(const RunLimits &limits) {
+    get()->m_runLimits = limits;
+  }
+
+  /**
+   * @brief runLimitReached
+   * @returns the bound which stopped the latest run, if any.
+   */
+  static RunLimit runLimitReached() { return get()->m_runLimitReached; }
+
   static void clock() { get()->_clock(); }
 
   /**
@@ -219,6 +507,17 @@ public:
    */
   static void stopRun() { get()->_stopRun(); }
 
+  /**
+   * @brief setProcessorCaching
+   * If enabled, the most recently deselected processors are kept, and are
+   * reset rather than reconstructed once selected again with the same ISA
+   * extensions. Cached processors are verified designs, such that views may
+   * keep their graphical representation as well (see processorEvicted).
+   */
+  static void setProcessorCaching(bool enabled) {
+    get()->_setProcessorCaching(enabled);
+  }
+
 signals:
 
   /**
@@ -227,6 +526,20 @@ signals:
    */
   void processorChanged();
 
+  /**
+   * @brief processorAboutToChange
+   * Emitted before the current processor is deselected, when another
+   * processor is chosen.
+   */
+  void processorAboutToChange();
+
+  /**
+   * @brief processorEvicted
+   * Emitted before the cached @p processor is destroyed (see
+   * setProcessorCaching).
+   */
+  void processorEvicted(const Ripes::RipesProcessor *processor);
+
   /**
    * @brief exit
    * end the current simulation, disallowing further clocking of the processor
@@ -248,6 +561,12 @@ signals:
   void runStarted();
   void runFinished();
 
+  /**
+   * @brief watchpointTriggered
+   * Emitted when a watchpoint is hit, from the thread clocking the processor.
+   */
+  void watchpointTriggered(const Ripes::Watchpoints::Hit &hit);
+
   /**
    * @brief Various signals wrapping around the direct VSRTL model emission
    * signals. This is done to avoid relying component to having to reconnect to
@@ -260,10 +579,28 @@ signals:
   // cycle. Remember to use Qt::DirectConnection for the slot to be executed
   // directly, instead of concurrently in the event loop.
   void processorClocked();
+  // Emitted after a batch of cycles has been executed while running. The
+  // per-cycle state of the batch is available through
+  // RipesProcessor::clockBatch(). Components connecting to processorClocked
+  // must also connect to this signal (using Qt::DirectConnection) to observe
+  // every cycle.
+  void processorClockedBatch();
+  // Emitted from the simulating thread before executing the system call
+  // @p function. Connect using Qt::DirectConnection, as for processorClocked.
+  void syscallExecuted(int function);
   void processorClockedNonRun(); // Only emitted when _not_ running; i.e., for
                                  // GUI updating
   void procStateChangedNonRun(); // processorReset | processorReversed |
                                  // processorClockedNonRun
+  // Emitted for each refresh of the GUI whilst running. Only the state
+  // snapshot (see stateSnapshot()) may be read when refreshing during a run.
+  void runStateRefreshed();
+  // Emitted before runFinished and procStateChangedNonRun, whilst the
+  // processor is not clocked. Components which perform the work of the
+  // processor on other threads (e.g. CacheWorker) must complete it before
+  // returning, such that the state presented is complete. Connect using
+  // Qt::DirectConnection.
+  void aboutToPresentState();
 
   // Emitted whenever the global memory focus address for the application should
   // change.
@@ -272,9 +609,11 @@ signals:
 private slots:
   /**
    * @brief syscallTrap
-   * Connects to the processors system call request interface. Will concurrently
-   * run the systemcall manager to handle the requested functionality, and
-   * return once the system call was handled.
+   * Connects to the processors system call request interface. Runs the system
+   * call manager to handle the requested functionality, and returns once the
+   * system call was handled. Non-blocking system calls are handled directly on
+   * the calling thread; blocking system calls (console input) are handled
+   * concurrently.
    */
   void syscallTrap();
 
@@ -283,56 +622,93 @@ private:
   /// documentation, refer to their static counterparts above.
 
   void _loadProgram(const std::shared_ptr<Program> &p);
-  RipesProcessor *_getProcessor() { return m_currentProcessor.get(); }
-  const RipesProcessor *_getProcessor() const {
+  RipesProcessor *_getProcessor() {
+    if (m_pendingProcessor)
+      constructPendingProcessor();
     return m_currentProcessor.get();
   }
+  const RipesProcessor *_getProcessor() const {
+    return const_cast<ProcessorHandler *>(this)->_getProcessor();
+  }
   const std::shared_ptr<Assembler::AssemblerBase> _getAssembler() {
+    _getProcessor();
     return m_currentAssembler;
   }
   const ProcessorID &_getID() const { return m_currentID; }
   std::shared_ptr<const Program> _getProgram() const { return m_program; }
   const ISAInfoBase *_currentISA() const {
-    return m_currentProcessor->implementsISA();
+    return _getProcessor()->implementsISA();
   }
-  std::shared_ptr<const ISAInfoBase> _fullISA() const {
-    return m_currentProcessor->fullISA();
-  }
-  const SyscallManager &_getSyscallManager() const { return *m_syscallManager; }
   SyscallManager &_getSyscallManagerNonConst() const {
     return *m_syscallManager;
   }
   void _loadProcessorToWidget(vsrtl::VSRTLWidget *widget,
                               bool doPlaceAndRoute = false);
+  void _setProcessorDrawingEnabled(bool enabled);
   void _selectProcessor(
       const ProcessorID &id, const QStringList &extensions = {},
       const RegisterInitialization &setup = RegisterInitialization());
+  void _reselectProcessor(const ProcessorID &id, const QStringList &extensions,
+                          const RegisterInitialization &setup);
   bool _isExecutableAddress(AInt address) const;
   int _getCurrentProgramSize() const;
   AInt _getTextStart() const;
   QString _disassembleInstr(const AInt address) const;
-  vsrtl::core::AddressSpaceMM &_getMemory();
   const vsrtl::core::AddressSpace &_getRegisters() const;
   void _setRegisterValue(const std::string_view &rfid, const unsigned idx,
                          VInt value);
   void _writeMem(AInt address, VInt value, int size = sizeof(VInt));
-  VInt _getRegisterValue(const std::string_view &rfid,
-                         const unsigned idx) const;
+  void _writeMemBlock(AInt address, const char *data, size_t size);
   bool _checkBreakpoint();
+  QString _setBreakpointCondition(const AInt address, const QString &condition,
+                                  unsigned hitCount);
+  std::optional<BreakpointCondition>
+  _breakpointCondition(const AInt address) const;
+  bool _checkWatchpoints();
   void _setBreakpoint(const AInt address, bool enabled);
   void _toggleBreakpoint(const AInt address);
   bool _hasBreakpoint(const AInt address) const;
   void _clearBreakpoints();
   void _checkProcessorFinished();
   bool _isRunning();
-  void _run();
+  void _run(bool paced = false);
   void _clock();
   void _reset();
   void _stopRun();
-  void _triggerProcStateChangeTimer();
+  void _notifyStateChanged();
+  void _notifyStateRestored();
+  void _publishStateSnapshot();
+  void _refresh();
+  /// Applies the VCD trace settings to the current processor.
+  void updateVCDTrace();
 
   void createAssemblerForCurrentISA();
+  /// Constructs the processor selected upon construction of the handler.
+  void constructPendingProcessor();
+  /// Connects the signals of the current processor to the handler.
+  void connectProcessorSignals();
+  /// Emit processorClocked and processorClockedBatch on behalf of the
+  /// processor, profiled as signal dispatch (see SimProfiler).
+  void dispatchProcessorClocked();
+  void dispatchProcessorClockedBatch();
+  /// Destroys the least recently used cached processors beyond the size of
+  /// the cache.
+  void trimProcessorCache();
+  void _setProcessorCaching(bool enabled);
   void setStopRunFlag();
+  /// The run loop; clockRunBatch returns false once the run should stop.
+  void beginRunLoop();
+  bool clockRunBatch();
+  void endRunLoop();
+  /// Returns the number of cycles of a paced run which are due at @p rate,
+  /// and the nanoseconds until the next cycle is due through @p waitNs.
+  unsigned pacedCyclesDue(unsigned rate, qint64 &waitNs);
+#ifdef RIPES_COOPERATIVE_RUN
+  /// Clocks the processor for a slice of a run on the GUI thread.
+  void runSlice();
+  QTimer m_runSliceTimer;
+  std::unique_ptr<QPromise<void>> m_runPromise;
+#endif
   ProcessorHandler();
 
   // Flag used during construction to avoid calling ProcessorHandler::get() to
@@ -341,6 +717,18 @@ private:
   ProcessorID m_currentID;
   RegisterInitialization m_currentRegInits;
   std::unique_ptr<RipesProcessor> m_currentProcessor;
+  MemoryFootprint::Source m_rewindFootprint{
+      MemoryFootprint::RewindStacks, [this] {
+        return m_currentProcessor ? m_currentProcessor->reverseStateBytes()
+                                  : 0;
+      }};
+  // The processor selected upon construction of the handler, until it is
+  // first used.
+  struct PendingProcessor {
+    QStringList extensions;
+    RegisterInitialization setup;
+  };
+  std::optional<PendingProcessor> m_pendingProcessor;
   std::unique_ptr<SyscallManager> m_syscallManager;
   std::shared_ptr<Assembler::AssemblerBase> m_currentAssembler;
 
@@ -349,23 +737,125 @@ private:
    * The VSRTL Widget associated which the processor models will be loaded to
    */
   vsrtl::VSRTLWidget *m_vsrtlWidget = nullptr;
+  std::atomic<bool> m_drawingEnabled{true};
 
   std::set<AInt> m_breakpoints;
   std::shared_ptr<Program> m_program;
 
+  /**
+   * @brief m_disassemblyMemo
+   * Disassembled instructions of _disassembleInstr, keyed by address. Each
+   * entry records the instruction word which was disassembled, such that
+   * writes to the instruction memory invalidate the entry. Cleared on program
+   * load and processor change, given that the symbols and the assembler may
+   * have changed.
+   */
+  struct DisassemblyMemo {
+    VInt word;
+    QString repr;
+  };
+  mutable QHash<AInt, DisassemblyMemo> m_disassemblyMemo;
+  static constexpr int s_disassemblyMemoSize = 1 << 12;
+
+  /**
+   * @brief m_breakpointMap
+   * Dense bitmap mirroring m_breakpoints over the .text section of the current
+   * program, indexed by half-words (the minimum instruction alignment) relative
+   * to m_breakpointMapBase. Used for constant-time breakpoint checks while
+   * running.
+   */
+  std::vector<bool> m_breakpointMap;
+  AInt m_breakpointMapBase = 0;
+  void rebuildBreakpointMap();
+
+  /**
+   * @brief m_breakpointConditions
+   * Conditional breakpoints, by address. Conditions are compiled once set, and
+   * recompiled whenever the breakpoint map is rebuilt, given that the symbols
+   * of the program and the registers of the ISA may have changed. Conditions
+   * are only evaluated once the breakpoint map matches, on the thread clocking
+   * the processor. A condition which fails to compile always holds.
+   */
+  struct ConditionOperand {
+    enum Kind { PC, Register, Memory };
+    Kind kind = PC;
+    std::string_view rfid;
+    unsigned index = 0;
+    AInt address = 0;
+  };
+  struct CompiledBreakpointCondition {
+    BreakpointCondition condition;
+    std::optional<Assembler::CompiledExpr> expr;
+    std::vector<ConditionOperand> operands;
+    // The latest cycle in which the breakpoint was checked, its outcome, and
+    // whether the instruction stalled in the stage, such that the stalled
+    // cycles of an instruction count as a single hit.
+    long long lastCycle = -1;
+    bool lastTriggered = false;
+    bool lastStalled = false;
+  };
+  std::map<AInt, CompiledBreakpointCondition> m_breakpointConditions;
+  void compileBreakpointCondition(CompiledBreakpointCondition &condition,
+                                  QString *error = nullptr) const;
+  bool breakpointConditionTriggered(CompiledBreakpointCondition &condition,
+                                    StageIndex stage);
+
+  /**
+   * @brief m_breakpointStages
+   * Cached copy of the breakpoint triggering stages of the current processor.
+   */
+  std::vector<StageIndex> m_breakpointStages;
+  RegisterFileHandles m_registerFiles;
+
+  Watchpoints m_watchpoints;
+  std::optional<Watchpoints::Hit> m_watchpointHit;
+  std::shared_ptr<CommitLog> m_commitLog;
+
+  void updateObservers();
+  void trackWrite(AInt address, size_t bytes);
+  bool m_trackWrittenPages = false;
+  std::set<AInt> m_writtenPages;
+
+  std::optional<std::pair<long long, long long>> m_runStageInfoRange;
+  bool m_countPerformance = false;
+
   QFutureWatcher<void> m_runWatcher;
   bool m_stopRunningFlag = false;
+  RunLimits m_runLimits;
+  // The limits of the ongoing run.
+  RunLimits m_activeRunLimits;
+  RunLimit m_runLimitReached = RunLimit::None;
+  // Held by the clocking thread whilst clocking the processor outside of
+  // unpaced runs, and by the GUI thread whilst refreshing from a paced run.
   std::mutex m_clockLock;
+  // The rate of paced runs, in cycles per second (see runPaced). Whilst a run
+  // is paced, m_pacedRate is the rate which m_paceTimer and m_pacedCycles
+  // account for.
+  std::atomic<unsigned> m_runRate{1};
+  bool m_paced = false;
+  unsigned m_pacedRate = 0;
+  QElapsedTimer m_paceTimer;
+  long long m_pacedCycles = 0;
+  long long m_pacedRefreshCycle = -1;
+  // The cycle at which the ongoing run started.
+  long long m_runStartCycle = 0;
 
   /**
-   * @brief To avoid excessive UI updates due to things relying on
-   * procStateChangedNonRun, the m_procStateChangeTimer ensures that the signal
-   * is only emitted with some max. frequency. New state change signals can be
-   * enqueued by atomically setting the m_enqueueStateChangeSignal.
+   * @brief The GUI is refreshed, through procStateChangedNonRun and
+   * runStateRefreshed, by m_refreshTimer at the refresh rate of the screen,
+   * and only for frames in which the state of the processor changed.
+   * State changes are recorded by incrementing m_stateVersion, which requires
+   * no synchronization with the GUI thread. If a refresh exceeds its budget
+   * (a share of a frame), the subsequent m_refreshBackoff frames are skipped,
+   * such that refreshing never occupies more than its share of the GUI
+   * thread. The timer is stopped whilst the state does not change.
    */
-  QTimer m_procStateChangeTimer;
-  bool m_enqueueStateChangeSignal;
-  std::mutex m_enqueueStateChangeLock;
+  QTimer m_refreshTimer;
+  std::atomic<unsigned long> m_stateVersion{0};
+  std::atomic<bool> m_refreshScheduled{false};
+  unsigned long m_refreshedVersion = 0;
+  unsigned m_refreshBackoff = 0;
+  SeqLock<StateSnapshot> m_stateSnapshot;
 
   /**
    * @brief m_sem
@@ -375,5 +865,17 @@ private:
   QSemaphore m_sem;
   std::vector<std::unique_ptr<vsrtl::GallantSignalWrapperBase>>
       m_signalWrappers;
+
+  // Recently deselected processors, along with the wrappers connected to their
+  // signals, by how recently they were deselected (see setProcessorCaching).
+  struct CachedProcessor {
+    ProcessorID id;
+    std::unique_ptr<RipesProcessor> processor;
+    std::vector<std::unique_ptr<vsrtl::GallantSignalWrapperBase>>
+        signalWrappers;
+  };
+  std::list<CachedProcessor> m_processorCache;
+  bool m_cacheProcessors = false;
+  static constexpr size_t s_processorCacheSize = 4;
 };
 } // namespace Ripes
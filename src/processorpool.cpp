@@ -0,0 +1,80 @@
+#include "processorpool.h"
+#include "memoryblock.h"
+
+namespace Ripes {
+
+ProcessorPool::Key ProcessorPool::key(ProcessorID id,
+                                      const QStringList &extensions) {
+  // The order of the extensions does not affect the constructed processor.
+  QStringList sorted = extensions;
+  sorted.sort();
+  return {id, sorted.join(",")};
+}
+
+std::unique_ptr<RipesProcessor>
+ProcessorPool::construct(ProcessorID id, const QStringList &extensions) {
+  auto processor = ProcessorRegistry::constructProcessor(id, extensions);
+  processor->postConstruct();
+  return processor;
+}
+
+std::unique_ptr<RipesProcessor>
+ProcessorPool::acquire(ProcessorID id, const QStringList &extensions) {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_processors.find(key(id, extensions));
+    if (it != m_processors.end() && !it->second.empty()) {
+      auto processor = std::move(it->second.back());
+      it->second.pop_back();
+      return processor;
+    }
+  }
+  return construct(id, extensions);
+}
+
+void ProcessorPool::release(ProcessorID id, const QStringList &extensions,
+                            std::unique_ptr<RipesProcessor> processor) {
+  if (!processor)
+    return;
+  processor->isExecutableAddress = {};
+  processor->trapHandler = {};
+  processor->observers().clear();
+  processor->setPCProfile(nullptr);
+  processor->setPerformanceCounting(false);
+  processor->setBatchStageInfoRange(0, 0);
+  MemoryBlock::clearInitializationMemories(processor->getMemory());
+  processor->resetProcessor();
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto &processors = m_processors[key(id, extensions)];
+  if (processors.size() < m_capacity)
+    processors.push_back(std::move(processor));
+}
+
+void ProcessorPool::prewarm(ProcessorID id, const QStringList &extensions,
+                            unsigned count) {
+  for (unsigned n = size(id, extensions); n < count; ++n)
+    release(id, extensions, construct(id, extensions));
+}
+
+unsigned ProcessorPool::size(ProcessorID id,
+                             const QStringList &extensions) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_processors.find(key(id, extensions));
+  return it == m_processors.end() ? 0 : it->second.size();
+}
+
+void ProcessorPool::setCapacity(unsigned capacity) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_capacity = capacity;
+  for (auto &it : m_processors)
+    if (it.second.size() > m_capacity)
+      it.second.resize(m_capacity);
+}
+
+void ProcessorPool::clear() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_processors.clear();
+}
+
+} // namespace Ripes
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <QStringList>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "processorregistry.h"
+
+namespace Ripes {
+
+/**
+ * @brief The ProcessorPool class
+ * A process-wide pool of constructed processors, per processor ID and set of
+ * ISA extensions. Constructing (and verifying) a processor design is
+ * expensive compared to a short simulation, and SimulationContexts thus check
+ * their processors out of the pool, and return them once destroyed.
+ *
+ * Returned processors are reset to a clean state: the initialization memories
+ * and the hooks and profiles set by the previous user are cleared, and the
+ * processor is reset. The pool is thread-safe.
+ */
+class ProcessorPool {
+public:
+  static ProcessorPool &get() {
+    static ProcessorPool pool;
+    return pool;
+  }
+
+  /// Returns a pooled processor of @p id with @p extensions, or constructs a
+  /// new one if none is pooled.
+  std::unique_ptr<RipesProcessor> acquire(ProcessorID id,
+                                          const QStringList &extensions);
+
+  /// Resets @p processor and returns it to the pool of @p id and
+  /// @p extensions. The processor is destroyed if the pool is full.
+  void release(ProcessorID id, const QStringList &extensions,
+               std::unique_ptr<RipesProcessor> processor);
+
+  /// Constructs processors until @p count processors of @p id with
+  /// @p extensions are pooled, such that subsequent acquisitions are cheap.
+  void prewarm(ProcessorID id, const QStringList &extensions, unsigned count);
+
+  /// Returns the number of pooled processors of @p id with @p extensions.
+  unsigned size(ProcessorID id, const QStringList &extensions) const;
+
+  /// Sets the maximum number of pooled processors per processor ID and set of
+  /// extensions (default: s_defaultCapacity).
+  void setCapacity(unsigned capacity);
+  static constexpr unsigned s_defaultCapacity = 16;
+
+  /// Destroys all pooled processors.
+  void clear();
+
+private:
+  ProcessorPool() {}
+  using Key = std::pair<ProcessorID, QString>;
+  static Key key(ProcessorID id, const QStringList &extensions);
+  static std::unique_ptr<RipesProcessor>
+  construct(ProcessorID id, const QStringList &extensions);
+
+  mutable std::mutex m_mutex;
+  unsigned m_capacity = s_defaultCapacity;
+  std::map<Key, std::vector<std::unique_ptr<RipesProcessor>>> m_processors;
+};
+
+} // namespace Ripes
@@ -2,11 +2,19 @@
 
 #include <QPolygonF>
 
+#include "tracespans.h"
+
+#include "processors/MIPS/mipsiss/mipsiss.h"
 #include "processors/RISC-V/rv5s/rv5s.h"
+#include "processors/RISC-V/rv5s_bp/rv5s_bp.h"
 #include "processors/RISC-V/rv5s_no_fw/rv5s_no_fw.h"
 #include "processors/RISC-V/rv5s_no_fw_hz/rv5s_no_fw_hz.h"
 #include "processors/RISC-V/rv5s_no_hz/rv5s_no_hz.h"
 #include "processors/RISC-V/rv6s_dual/rv6s_dual.h"
+#include "processors/RISC-V/rviss/rviss.h"
+#include "processors/RISC-V/rvmh/rvmh.h"
+#include "processors/RISC-V/rvooo/rvooo.h"
+#include "processors/RISC-V/rvpipeline/rvpipeline.h"
 #include "processors/RISC-V/rvss/rvss.h"
 
 namespace Ripes {
@@ -35,13 +43,82 @@ constexpr const char rv5s_no_fw_desc[] =
     "A 5-stage in-order processor with hazard detection/elimination but no "
     "forwarding unit.";
 
+#define rv5s_bp_desc(scheme)                                                   \
+  "A 5-stage in-order processor with hazard detection/elimination, "           \
+  "forwarding and " scheme " branch prediction. Targets are predicted by a "   \
+  "branch target buffer in the IF stage, and mispredicted control flow is "    \
+  "flushed once resolved in the EX stage."
+
+constexpr const char rv5s_bp_btfn_desc[] = rv5s_bp_desc(
+    "static backward-taken/forward-not-taken");
+constexpr const char rv5s_bp_1bit_desc[] = rv5s_bp_desc("1-bit dynamic");
+constexpr const char rv5s_bp_2bit_desc[] = rv5s_bp_desc("2-bit dynamic");
+constexpr const char rv5s_bp_gshare_desc[] = rv5s_bp_desc("gshare");
+
 constexpr const char rv6s_desc[] =
     "A 6-stage dual-issue in-order processor. Each way may execute "
     "arithmetic instructions, whereas way 1 "
     "is reserved for controlflow and ecall instructions, and way 2 for "
     "memory accessing instructions.";
 
+#define rvpipeline_desc(depth, stages, branch, forwarding)                     \
+  "A " depth "-stage in-order processor generated from a pipeline "            \
+  "description, with the stages " stages ". Branches are predicted as not "    \
+  "taken and resolve in the " branch " stage. " forwarding " The model is a "  \
+  "timing model of the functional instruction-set simulator."                  \
+  "<br><b>NOTE: this processor cannot be visualized or reversed.</b>"
+
+constexpr const char rvpipeline_3s_desc[] = rvpipeline_desc(
+    "3", "IF, ID and EX/MEM/WB", "EX/MEM/WB",
+    "Results are written back before dependent instructions execute.");
+constexpr const char rvpipeline_5s_desc[] = rvpipeline_desc(
+    "5", "IF, ID, EX, MEM and WB", "EX",
+    "Results are forwarded from the MEM and WB stages. The timing is not that "
+    "of the 5-stage VSRTL processor, around ecalls and multi-cycle "
+    "instructions in particular.");
+constexpr const char rvpipeline_7s_desc[] = rvpipeline_desc(
+    "7", "IF1, IF2, ID, EX, MEM1, MEM2 and WB", "EX",
+    "Results are forwarded from the MEM1, MEM2 and WB stages.");
+constexpr const char rvpipeline_9s_desc[] = rvpipeline_desc(
+    "9", "IF1 to IF3, ID, EX1, EX2, MEM1, MEM2 and WB", "EX2",
+    "Results are forwarded from the MEM1, MEM2 and WB stages.");
+
+#define rvooo_desc(width)                                                      \
+  "A " width "-wide out-of-order superscalar processor with register "         \
+  "renaming, a reorder buffer, an issue queue and a load/store queue. The "    \
+  "model is a timing model of the functional instruction-set simulator, "      \
+  "showing the instructions in each stage in the pipeline diagram."            \
+  "<br><b>NOTE: this processor cannot be visualized or reversed.</b>"
+
+constexpr const char rvooo_2w_desc[] = rvooo_desc("2");
+constexpr const char rvooo_4w_desc[] = rvooo_desc("4");
+
+#define rvmh_desc(harts)                                                       \
+  "A multi-hart processor of " harts " functional harts sharing memory "       \
+  "through private L1 data caches, kept coherent by the MESI protocol. Each "  \
+  "hart starts at the entry point of the program with its hart ID in the tp "  \
+  "register. The A extension provides atomic instructions."                    \
+  "<br><b>NOTE: this processor cannot be visualized or reversed. The "         \
+  "registers shown are those of hart 0.</b>"
+
+constexpr const char rvmh_2_desc[] = rvmh_desc("2");
+constexpr const char rvmh_4_desc[] = rvmh_desc("4");
+
+constexpr const char rviss_desc[] =
+    "A functional instruction-set simulator. Instructions are executed "
+    "directly on the architectural state without modelling a datapath, "
+    "enabling fast execution of long-running programs. Implements a subset "
+    "of the vector (V) extension."
+    "<br><b>NOTE: this processor cannot be visualized.</b>";
+
+constexpr const char mipsiss_desc[] =
+    "A functional instruction-set simulator of the MIPS32 integer "
+    "instructions. As in MARS, branches and jumps have no delay slot, and "
+    "system calls follow the numbering of MARS."
+    "<br><b>NOTE: this processor cannot be visualized.</b>";
+
 ProcessorRegistry::ProcessorRegistry() {
+  TraceSpan span("ProcessorRegistry construction");
   // Initialize processors
   std::vector<Layout> layouts;
   RegisterInitialization defRegVals;
@@ -156,6 +233,34 @@ ProcessorRegistry::ProcessorRegistry() {
       ProcessorID::RV64_5S, "5-stage processor", rv5s_desc, layouts,
       defRegVals));
 
+  // RISC-V 5-stage with branch prediction. The layouts of the 5-stage
+  // processor are shared; the branch predictor is placed by VSRTL.
+  using BP = BranchPredictorScheme;
+  addProcessor(ProcInfo<vsrtl::core::RV5S_BP<uint32_t, BP::BTFN>>(
+      ProcessorID::RV32_5S_BP_BTFN, "5-stage processor w/ static prediction",
+      rv5s_bp_btfn_desc, layouts, defRegVals));
+  addProcessor(ProcInfo<vsrtl::core::RV5S_BP<uint32_t, BP::OneBit>>(
+      ProcessorID::RV32_5S_BP_1BIT, "5-stage processor w/ 1-bit prediction",
+      rv5s_bp_1bit_desc, layouts, defRegVals));
+  addProcessor(ProcInfo<vsrtl::core::RV5S_BP<uint32_t, BP::TwoBit>>(
+      ProcessorID::RV32_5S_BP_2BIT, "5-stage processor w/ 2-bit prediction",
+      rv5s_bp_2bit_desc, layouts, defRegVals));
+  addProcessor(ProcInfo<vsrtl::core::RV5S_BP<uint32_t, BP::GShare>>(
+      ProcessorID::RV32_5S_BP_GSHARE, "5-stage processor w/ gshare prediction",
+      rv5s_bp_gshare_desc, layouts, defRegVals));
+  addProcessor(ProcInfo<vsrtl::core::RV5S_BP<uint64_t, BP::BTFN>>(
+      ProcessorID::RV64_5S_BP_BTFN, "5-stage processor w/ static prediction",
+      rv5s_bp_btfn_desc, layouts, defRegVals));
+  addProcessor(ProcInfo<vsrtl::core::RV5S_BP<uint64_t, BP::OneBit>>(
+      ProcessorID::RV64_5S_BP_1BIT, "5-stage processor w/ 1-bit prediction",
+      rv5s_bp_1bit_desc, layouts, defRegVals));
+  addProcessor(ProcInfo<vsrtl::core::RV5S_BP<uint64_t, BP::TwoBit>>(
+      ProcessorID::RV64_5S_BP_2BIT, "5-stage processor w/ 2-bit prediction",
+      rv5s_bp_2bit_desc, layouts, defRegVals));
+  addProcessor(ProcInfo<vsrtl::core::RV5S_BP<uint64_t, BP::GShare>>(
+      ProcessorID::RV64_5S_BP_GSHARE, "5-stage processor w/ gshare prediction",
+      rv5s_bp_gshare_desc, layouts, defRegVals));
+
   // RISC-V 6-stage dual issue
   layouts = {{"Extended",
               ":/layouts/RISC-V/rv6s_dual/rv6s_dual_extended_layout.json",
@@ -178,5 +283,82 @@ ProcessorRegistry::ProcessorRegistry() {
   addProcessor(ProcInfo<vsrtl::core::RV6S_DUAL<uint64_t>>(
       ProcessorID::RV64_6S_DUAL, "6-stage dual-issue processor", rv6s_desc,
       layouts, defRegVals));
+
+  // RISC-V in-order pipelines generated from pipeline descriptions
+  layouts = {};
+  defRegVals = {{RVISA::GPR, {{2, 0x7ffffff0}, {3, 0x10000000}}}};
+  addProcessor(ProcInfo<RVPipeline<uint32_t, Pipeline3S>>(
+      ProcessorID::RV32_3S_GEN, "3-stage processor (generated)",
+      rvpipeline_3s_desc, layouts, defRegVals));
+  addProcessor(ProcInfo<RVPipeline<uint32_t, Pipeline5S>>(
+      ProcessorID::RV32_5S_GEN, "5-stage processor (generated)",
+      rvpipeline_5s_desc, layouts, defRegVals));
+  addProcessor(ProcInfo<RVPipeline<uint32_t, Pipeline7S>>(
+      ProcessorID::RV32_7S_GEN, "7-stage processor (generated)",
+      rvpipeline_7s_desc, layouts, defRegVals));
+  addProcessor(ProcInfo<RVPipeline<uint32_t, Pipeline9S>>(
+      ProcessorID::RV32_9S_GEN, "9-stage processor (generated)",
+      rvpipeline_9s_desc, layouts, defRegVals));
+  addProcessor(ProcInfo<RVPipeline<uint64_t, Pipeline3S>>(
+      ProcessorID::RV64_3S_GEN, "3-stage processor (generated)",
+      rvpipeline_3s_desc, layouts, defRegVals));
+  addProcessor(ProcInfo<RVPipeline<uint64_t, Pipeline5S>>(
+      ProcessorID::RV64_5S_GEN, "5-stage processor (generated)",
+      rvpipeline_5s_desc, layouts, defRegVals));
+  addProcessor(ProcInfo<RVPipeline<uint64_t, Pipeline7S>>(
+      ProcessorID::RV64_7S_GEN, "7-stage processor (generated)",
+      rvpipeline_7s_desc, layouts, defRegVals));
+  addProcessor(ProcInfo<RVPipeline<uint64_t, Pipeline9S>>(
+      ProcessorID::RV64_9S_GEN, "9-stage processor (generated)",
+      rvpipeline_9s_desc, layouts, defRegVals));
+
+  // RISC-V out-of-order superscalar
+  layouts = {};
+  defRegVals = {{RVISA::GPR, {{2, 0x7ffffff0}, {3, 0x10000000}}}};
+  addProcessor(ProcInfo<RVOOO<uint32_t, 2>>(
+      ProcessorID::RV32_OOO_2W, "2-wide out-of-order processor", rvooo_2w_desc,
+      layouts, defRegVals));
+  addProcessor(ProcInfo<RVOOO<uint32_t, 4>>(
+      ProcessorID::RV32_OOO_4W, "4-wide out-of-order processor", rvooo_4w_desc,
+      layouts, defRegVals));
+  addProcessor(ProcInfo<RVOOO<uint64_t, 2>>(
+      ProcessorID::RV64_OOO_2W, "2-wide out-of-order processor", rvooo_2w_desc,
+      layouts, defRegVals));
+  addProcessor(ProcInfo<RVOOO<uint64_t, 4>>(
+      ProcessorID::RV64_OOO_4W, "4-wide out-of-order processor", rvooo_4w_desc,
+      layouts, defRegVals));
+
+  // RISC-V functional instruction-set simulator
+  layouts = {};
+  defRegVals = {{RVISA::GPR, {{2, 0x7ffffff0}, {3, 0x10000000}}}};
+  addProcessor(ProcInfo<RVISS<uint32_t>>(ProcessorID::RV32_ISS,
+                                         "Instruction-set simulator",
+                                         rviss_desc, layouts, defRegVals));
+  addProcessor(ProcInfo<RVISS<uint64_t>>(ProcessorID::RV64_ISS,
+                                         "Instruction-set simulator",
+                                         rviss_desc, layouts, defRegVals));
+
+  // RISC-V multi-hart
+  layouts = {};
+  defRegVals = {{RVISA::GPR, {{2, 0x7ffffff0}, {3, 0x10000000}}}};
+  addProcessor(ProcInfo<RVMH<uint32_t, 2>>(ProcessorID::RV32_MH_2,
+                                           "2-hart processor", rvmh_2_desc,
+                                           layouts, defRegVals));
+  addProcessor(ProcInfo<RVMH<uint32_t, 4>>(ProcessorID::RV32_MH_4,
+                                           "4-hart processor", rvmh_4_desc,
+                                           layouts, defRegVals));
+  addProcessor(ProcInfo<RVMH<uint64_t, 2>>(ProcessorID::RV64_MH_2,
+                                           "2-hart processor", rvmh_2_desc,
+                                           layouts, defRegVals));
+  addProcessor(ProcInfo<RVMH<uint64_t, 4>>(ProcessorID::RV64_MH_4,
+                                           "4-hart processor", rvmh_4_desc,
+                                           layouts, defRegVals));
+
+  // MIPS functional instruction-set simulator
+  layouts = {};
+  defRegVals = {{MIPSISA::GPR, {{29, 0x7fffeffc}, {28, 0x10008000}}}};
+  addProcessor(ProcInfo<MIPSISS>(ProcessorID::MIPS32_ISS,
+                                 "Instruction-set simulator", mipsiss_desc,
+                                 layouts, defRegVals));
 }
 } // namespace Ripes
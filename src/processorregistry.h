@@ -28,13 +28,40 @@ enum ProcessorID {
   RV32_5S_NO_HZ,
   RV32_5S_NO_FW,
   RV32_5S,
+  RV32_5S_BP_BTFN,
+  RV32_5S_BP_1BIT,
+  RV32_5S_BP_2BIT,
+  RV32_5S_BP_GSHARE,
   RV32_6S_DUAL,
+  RV32_3S_GEN,
+  RV32_5S_GEN,
+  RV32_7S_GEN,
+  RV32_9S_GEN,
+  RV32_OOO_2W,
+  RV32_OOO_4W,
+  RV32_ISS,
+  RV32_MH_2,
+  RV32_MH_4,
   RV64_SS,
   RV64_5S_NO_FW_HZ,
   RV64_5S_NO_HZ,
   RV64_5S_NO_FW,
   RV64_5S,
+  RV64_5S_BP_BTFN,
+  RV64_5S_BP_1BIT,
+  RV64_5S_BP_2BIT,
+  RV64_5S_BP_GSHARE,
   RV64_6S_DUAL,
+  RV64_3S_GEN,
+  RV64_5S_GEN,
+  RV64_7S_GEN,
+  RV64_9S_GEN,
+  RV64_OOO_2W,
+  RV64_OOO_4W,
+  RV64_ISS,
+  RV64_MH_2,
+  RV64_MH_4,
+  MIPS32_ISS,
   NUM_PROCESSORS
 };
 Q_ENUM_NS(ProcessorID); // Register with the metaobject system
@@ -110,6 +137,10 @@ public:
     Q_ASSERT(it != _this.m_descriptions.end());
     return it->second->construct(extensions);
   }
+  /// Returns the name of the ISA family of processor @p id, e.g. "RISC-V".
+  static const QString &isaFamily(ProcessorID id) {
+    return ISAFamilyNames.at(getDescription(id).isaInfo().isa->isaID());
+  }
 
 private:
   template <typename T>
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "../../isa/mips32isainfo.h"
+#include "../interface/ripesprocessor.h"
+
+namespace Ripes {
+
+namespace MIPSISA {
+
+/// Returns the ISA supported by a MIPS processor model.
+inline ProcessorISAInfo supportsISA() {
+  using MIPSISAInfo = ISAInfo<ISA::MIPS32I>;
+  return ProcessorISAInfo{ISAInfoRegistry::getISA<ISA::MIPS32I>(QStringList()),
+                          MIPSISAInfo::getSupportedExtensions(),
+                          MIPSISAInfo::getDefaultExtensions()};
+}
+
+} // namespace MIPSISA
+
+} // namespace Ripes
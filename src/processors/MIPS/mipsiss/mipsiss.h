@@ -0,0 +1,189 @@
+#pragma once
+
+#include "../../interface/functionalengine.h"
+#include "../mips.h"
+
+namespace Ripes {
+
+/**
+ * @brief The MIPSISS class
+ * Functional MIPS32 processor model, executing the MIPS32 integer instructions
+ * through the ISA-generic FunctionalEngine. As in the default configuration of
+ * MARS, branches and jumps have no delay slot. Arithmetic overflow and
+ * unaligned accesses do not trap, and division by zero leaves hi and lo
+ * unchanged. hi and lo are registers 32 and 33 of the general-purpose register
+ * file.
+ */
+class MIPSISS : public FunctionalEngine<uint32_t> {
+  using Engine = FunctionalEngine<uint32_t>;
+  static constexpr unsigned c_hi = 32;
+  static constexpr unsigned c_lo = 33;
+  static constexpr unsigned c_ra = 31;
+
+public:
+  MIPSISS(const QStringList &extensions)
+      : Engine(ISAInfoRegistry::getISA<ISA::MIPS32I>(extensions),
+               semantics()) {}
+
+  static ProcessorISAInfo supportsISA() { return MIPSISA::supportsISA(); }
+
+private:
+  static unsigned rs(Instr_T instr) { return MIPSISA::RangeRs().decode(instr); }
+  static unsigned rt(Instr_T instr) { return MIPSISA::RangeRt().decode(instr); }
+  static unsigned rd(Instr_T instr) { return MIPSISA::RangeRd().decode(instr); }
+  static unsigned shamt(Instr_T instr) {
+    return MIPSISA::RangeShamt().decode(instr);
+  }
+  static uint32_t uimm(Instr_T instr) {
+    return MIPSISA::RangeImm().decode(instr);
+  }
+  static uint32_t simm(Instr_T instr) {
+    return static_cast<uint32_t>(static_cast<int16_t>(uimm(instr)));
+  }
+  static int32_t sreg(Engine &e, unsigned i) {
+    return static_cast<int32_t>(e.reg(i));
+  }
+
+  static void branch(Engine &e, Instr_T instr, bool taken) {
+    if (taken)
+      e.jump(e.nextPc() + (simm(instr) << 2));
+  }
+  static void mult(Engine &e, uint64_t product) {
+    e.setReg(c_hi, static_cast<uint32_t>(product >> 32));
+    e.setReg(c_lo, static_cast<uint32_t>(product));
+  }
+
+  static const SemanticsMap &semantics() {
+    // clang-format off
+    static const SemanticsMap s_semantics = {
+      // Arithmetic and logic
+      {"add", [](Engine &e, Instr_T i) {
+        e.setReg(rd(i), e.reg(rs(i)) + e.reg(rt(i))); }},
+      {"addu", [](Engine &e, Instr_T i) {
+        e.setReg(rd(i), e.reg(rs(i)) + e.reg(rt(i))); }},
+      {"sub", [](Engine &e, Instr_T i) {
+        e.setReg(rd(i), e.reg(rs(i)) - e.reg(rt(i))); }},
+      {"subu", [](Engine &e, Instr_T i) {
+        e.setReg(rd(i), e.reg(rs(i)) - e.reg(rt(i))); }},
+      {"and", [](Engine &e, Instr_T i) {
+        e.setReg(rd(i), e.reg(rs(i)) & e.reg(rt(i))); }},
+      {"or", [](Engine &e, Instr_T i) {
+        e.setReg(rd(i), e.reg(rs(i)) | e.reg(rt(i))); }},
+      {"xor", [](Engine &e, Instr_T i) {
+        e.setReg(rd(i), e.reg(rs(i)) ^ e.reg(rt(i))); }},
+      {"nor", [](Engine &e, Instr_T i) {
+        e.setReg(rd(i), ~(e.reg(rs(i)) | e.reg(rt(i)))); }},
+      {"slt", [](Engine &e, Instr_T i) {
+        e.setReg(rd(i), sreg(e, rs(i)) < sreg(e, rt(i))); }},
+      {"sltu", [](Engine &e, Instr_T i) {
+        e.setReg(rd(i), e.reg(rs(i)) < e.reg(rt(i))); }},
+      {"addi", [](Engine &e, Instr_T i) {
+        e.setReg(rt(i), e.reg(rs(i)) + simm(i)); }},
+      {"addiu", [](Engine &e, Instr_T i) {
+        e.setReg(rt(i), e.reg(rs(i)) + simm(i)); }},
+      {"slti", [](Engine &e, Instr_T i) {
+        e.setReg(rt(i), sreg(e, rs(i)) < static_cast<int32_t>(simm(i))); }},
+      {"sltiu", [](Engine &e, Instr_T i) {
+        e.setReg(rt(i), e.reg(rs(i)) < simm(i)); }},
+      {"andi", [](Engine &e, Instr_T i) {
+        e.setReg(rt(i), e.reg(rs(i)) & uimm(i)); }},
+      {"ori", [](Engine &e, Instr_T i) {
+        e.setReg(rt(i), e.reg(rs(i)) | uimm(i)); }},
+      {"xori", [](Engine &e, Instr_T i) {
+        e.setReg(rt(i), e.reg(rs(i)) ^ uimm(i)); }},
+      {"lui", [](Engine &e, Instr_T i) { e.setReg(rt(i), uimm(i) << 16); }},
+
+      // Shifts
+      {"sll", [](Engine &e, Instr_T i) {
+        e.setReg(rd(i), e.reg(rt(i)) << shamt(i)); }},
+      {"srl", [](Engine &e, Instr_T i) {
+        e.setReg(rd(i), e.reg(rt(i)) >> shamt(i)); }},
+      {"sra", [](Engine &e, Instr_T i) {
+        e.setReg(rd(i), sreg(e, rt(i)) >> shamt(i)); }},
+      {"sllv", [](Engine &e, Instr_T i) {
+        e.setReg(rd(i), e.reg(rt(i)) << (e.reg(rs(i)) & 0x1F)); }},
+      {"srlv", [](Engine &e, Instr_T i) {
+        e.setReg(rd(i), e.reg(rt(i)) >> (e.reg(rs(i)) & 0x1F)); }},
+      {"srav", [](Engine &e, Instr_T i) {
+        e.setReg(rd(i), sreg(e, rt(i)) >> (e.reg(rs(i)) & 0x1F)); }},
+
+      // Multiplication and division, through hi and lo
+      {"mult", [](Engine &e, Instr_T i) {
+        mult(e, static_cast<uint64_t>(int64_t(sreg(e, rs(i))) *
+                                      int64_t(sreg(e, rt(i))))); }},
+      {"multu", [](Engine &e, Instr_T i) {
+        mult(e, uint64_t(e.reg(rs(i))) * uint64_t(e.reg(rt(i)))); }},
+      {"div", [](Engine &e, Instr_T i) {
+        const int32_t a = sreg(e, rs(i));
+        const int32_t b = sreg(e, rt(i));
+        if (b == 0)
+          return;
+        // The quotient of INT32_MIN / -1 overflows to INT32_MIN.
+        const bool overflow = a == INT32_MIN && b == -1;
+        e.setReg(c_lo, overflow ? a : a / b);
+        e.setReg(c_hi, overflow ? 0 : a % b); }},
+      {"divu", [](Engine &e, Instr_T i) {
+        const uint32_t a = e.reg(rs(i));
+        const uint32_t b = e.reg(rt(i));
+        if (b == 0)
+          return;
+        e.setReg(c_lo, a / b);
+        e.setReg(c_hi, a % b); }},
+      {"mfhi", [](Engine &e, Instr_T i) { e.setReg(rd(i), e.reg(c_hi)); }},
+      {"mflo", [](Engine &e, Instr_T i) { e.setReg(rd(i), e.reg(c_lo)); }},
+      {"mthi", [](Engine &e, Instr_T i) { e.setReg(c_hi, e.reg(rs(i))); }},
+      {"mtlo", [](Engine &e, Instr_T i) { e.setReg(c_lo, e.reg(rs(i))); }},
+
+      // Loads and stores
+      {"lb", [](Engine &e, Instr_T i) {
+        e.setReg(rt(i), static_cast<int8_t>(
+                            e.load(e.reg(rs(i)) + simm(i), 1))); }},
+      {"lbu", [](Engine &e, Instr_T i) {
+        e.setReg(rt(i), e.load(e.reg(rs(i)) + simm(i), 1) & 0xFF); }},
+      {"lh", [](Engine &e, Instr_T i) {
+        e.setReg(rt(i), static_cast<int16_t>(
+                            e.load(e.reg(rs(i)) + simm(i), 2))); }},
+      {"lhu", [](Engine &e, Instr_T i) {
+        e.setReg(rt(i), e.load(e.reg(rs(i)) + simm(i), 2) & 0xFFFF); }},
+      {"lw", [](Engine &e, Instr_T i) {
+        e.setReg(rt(i), e.load(e.reg(rs(i)) + simm(i), 4)); }},
+      {"sb", [](Engine &e, Instr_T i) {
+        e.store(e.reg(rs(i)) + simm(i), e.reg(rt(i)), 1); }},
+      {"sh", [](Engine &e, Instr_T i) {
+        e.store(e.reg(rs(i)) + simm(i), e.reg(rt(i)), 2); }},
+      {"sw", [](Engine &e, Instr_T i) {
+        e.store(e.reg(rs(i)) + simm(i), e.reg(rt(i)), 4); }},
+
+      // Control transfers. Branch offsets are relative to the following
+      // instruction, and jump targets lie in its 256MB region.
+      {"beq", [](Engine &e, Instr_T i) {
+        branch(e, i, e.reg(rs(i)) == e.reg(rt(i))); }},
+      {"bne", [](Engine &e, Instr_T i) {
+        branch(e, i, e.reg(rs(i)) != e.reg(rt(i))); }},
+      {"blez", [](Engine &e, Instr_T i) { branch(e, i, sreg(e, rs(i)) <= 0); }},
+      {"bgtz", [](Engine &e, Instr_T i) { branch(e, i, sreg(e, rs(i)) > 0); }},
+      {"bltz", [](Engine &e, Instr_T i) { branch(e, i, sreg(e, rs(i)) < 0); }},
+      {"bgez", [](Engine &e, Instr_T i) { branch(e, i, sreg(e, rs(i)) >= 0); }},
+      {"j", [](Engine &e, Instr_T i) {
+        e.jump((e.nextPc() & 0xF0000000) |
+               MIPSISA::RangeTarget().decode(i) << 2); }},
+      {"jal", [](Engine &e, Instr_T i) {
+        e.setReg(c_ra, e.nextPc());
+        e.jump((e.nextPc() & 0xF0000000) |
+               MIPSISA::RangeTarget().decode(i) << 2); }},
+      {"jr", [](Engine &e, Instr_T i) { e.jump(e.reg(rs(i))); }},
+      {"jalr", [](Engine &e, Instr_T i) {
+        const uint32_t target = e.reg(rs(i));
+        e.setReg(rd(i), e.nextPc());
+        e.jump(target); }},
+
+      // System calls are executed through the trap handler, whereas break
+      // executes as a nop.
+      {"syscall", [](Engine &e, Instr_T) { e.trap(); }},
+    };
+    // clang-format on
+    return s_semantics;
+  }
+};
+
+} // namespace Ripes
@@ -12,12 +12,31 @@ namespace Ripes {
 
 namespace RVISA {
 
+/// Returns the ISA supported by a RISC-V processor model. The atomic (A) and
+/// vector (V) extensions are only supported by models which set @p atomics
+/// and @p vector, the bit-manipulation extensions (Zba/Zbb/Zbs) by models
+/// which do not clear @p bitManip, and the floating-point extensions (F/D) by
+/// models which set @p floats.
 template <unsigned XLEN>
-ProcessorISAInfo supportsISA() {
+ProcessorISAInfo supportsISA(bool atomics = false, bool vector = false,
+                             bool bitManip = true, bool floats = false) {
   using RVISAInfo = ISAInfo<XLenToRVISA<XLEN>()>;
-  return ProcessorISAInfo{std::make_shared<RVISAInfo>(QStringList()),
-                          RVISAInfo::getSupportedExtensions(),
-                          RVISAInfo::getDefaultExtensions()};
+  QStringList extensions = RVISAInfo::getSupportedExtensions();
+  if (!atomics)
+    extensions.removeAll("A");
+  if (!vector)
+    extensions.removeAll("V");
+  if (!floats) {
+    extensions.removeAll("F");
+    extensions.removeAll("D");
+  }
+  if (!bitManip) {
+    for (const auto &ext : {"Zba", "Zbb", "Zbs"})
+      extensions.removeAll(ext);
+  }
+  return ProcessorISAInfo{
+      ISAInfoRegistry::getISA<XLenToRVISA<XLEN>()>(QStringList()), extensions,
+      RVISAInfo::getDefaultExtensions()};
 }
 
 template <unsigned XLEN>
@@ -52,8 +71,13 @@ Enum(RVInstr, NOP,
 
 /** Datapath enumerations */
 Enum(ALUOp, NOP, ADD, SUB, MUL, DIV, AND, OR, XOR, SL, SRA, SRL, LUI, LT, LTU,
-     EQ, MULH, MULHU, MULHSU, DIVU, REM, REMU, SLW, SRLW, SRAW, ADDW, SUBW,
-     MULW, DIVW, DIVUW, REMW, REMUW);
+     MULH, MULHU, MULHSU, DIVU, REM, REMU, SLW, SRLW, SRAW, ADDW, SUBW, MULW,
+     DIVW, DIVUW, REMW, REMUW,
+
+     /* Bit-manipulation (Zba/Zbb/Zbs) operations, from SH1ADD through BSET */
+     SH1ADD, SH2ADD, SH3ADD, ADDUW, SH1ADDUW, SH2ADDUW, SH3ADDUW, SLLIUW, ANDN,
+     ORN, XNOR, CLZ, CTZ, CPOP, CLZW, CTZW, CPOPW, MIN, MINU, MAX, MAXU, SEXTB,
+     SEXTH, ZEXTH, ROL, ROR, ROLW, RORW, ORCB, REV8, BCLR, BEXT, BINV, BSET);
 Enum(RegWrSrc, MEMREAD, ALURES, PC4);
 Enum(AluSrc1, REG1, PC);
 Enum(AluSrc2, REG2, IMM);
@@ -63,7 +87,10 @@ Enum(ECALL, none, print_int = 1, print_char = 2, print_string = 4, exit = 10);
 Enum(PcSrc, PC4 = 0, ALU = 1);
 Enum(PcInc, INC2 = 0, INC4 = 1);
 
-/** Instruction field parser */
+/** Instruction field parser
+ * The fields of each instruction format, from MSB to LSB. The field widths are
+ * given from LSB to MSB.
+ */
 class RVInstrParser {
 public:
   static RVInstrParser *getParser() {
@@ -71,100 +98,70 @@ public:
     return &parser;
   }
 
-  std::vector<uint32_t> decodeU32Instr(const uint32_t &instr) const {
-    return m_decodeU32Instr(instr);
+  using U32Fields = InstrFields<uint32_t, 7, 5, 20>;
+  using J32Fields = InstrFields<uint32_t, 7, 5, 8, 1, 10, 1>;
+  using I32Fields = InstrFields<uint32_t, 7, 5, 3, 5, 12>;
+  using S32Fields = InstrFields<uint32_t, 7, 5, 3, 5, 5, 7>;
+  using R32Fields = InstrFields<uint32_t, 7, 5, 3, 5, 5, 7>;
+  using B32Fields = InstrFields<uint32_t, 7, 1, 4, 3, 5, 5, 6, 1>;
+
+  // RVC
+  using CA16Fields = InstrFields<uint32_t, 2, 3, 2, 3, 2, 1, 3, 16>;
+  using CI16Fields = InstrFields<uint32_t, 2, 5, 5, 1, 3, 16>;
+  using CS16Fields = InstrFields<uint32_t, 2, 3, 2, 3, 3, 3, 16>;
+  using CIW16Fields = InstrFields<uint32_t, 2, 3, 8, 3, 16>;
+  using CSS16Fields = InstrFields<uint32_t, 2, 5, 6, 3, 16>;
+  using CJ16Fields = InstrFields<uint32_t, 2, 11, 3, 16>;
+  using CB16Fields = InstrFields<uint32_t, 2, 5, 3, 3, 3, 16>;
+  using CB216Fields = InstrFields<uint32_t, 2, 5, 3, 2, 1, 3, 16>;
+
+  static constexpr auto decodeU32Instr(uint32_t instr) {
+    return U32Fields::parse(instr);
   }
-  std::vector<uint32_t> decodeJ32Instr(const uint32_t &instr) const {
-    return m_decodeJ32Instr(instr);
+  static constexpr auto decodeJ32Instr(uint32_t instr) {
+    return J32Fields::parse(instr);
   }
-  std::vector<uint32_t> decodeI32Instr(const uint32_t &instr) const {
-    return m_decodeI32Instr(instr);
+  static constexpr auto decodeI32Instr(uint32_t instr) {
+    return I32Fields::parse(instr);
   }
-  std::vector<uint32_t> decodeS32Instr(const uint32_t &instr) const {
-    return m_decodeS32Instr(instr);
+  static constexpr auto decodeS32Instr(uint32_t instr) {
+    return S32Fields::parse(instr);
   }
-  std::vector<uint32_t> decodeR32Instr(const uint32_t &instr) const {
-    return m_decodeR32Instr(instr);
+  static constexpr auto decodeR32Instr(uint32_t instr) {
+    return R32Fields::parse(instr);
   }
-  std::vector<uint32_t> decodeB32Instr(const uint32_t &instr) const {
-    return m_decodeB32Instr(instr);
+  static constexpr auto decodeB32Instr(uint32_t instr) {
+    return B32Fields::parse(instr);
   }
 
   // RVC
-  std::vector<uint32_t> decodeCA16Instr(const uint32_t &instr) const {
-    return m_decodeCA16Instr(instr);
+  static constexpr auto decodeCA16Instr(uint32_t instr) {
+    return CA16Fields::parse(instr);
   }
-  std::vector<uint32_t> decodeCI16Instr(const uint32_t &instr) const {
-    return m_decodeCI16Instr(instr);
+  static constexpr auto decodeCI16Instr(uint32_t instr) {
+    return CI16Fields::parse(instr);
   }
-  std::vector<uint32_t> decodeCS16Instr(const uint32_t &instr) const {
-    return m_decodeCS16Instr(instr);
+  static constexpr auto decodeCS16Instr(uint32_t instr) {
+    return CS16Fields::parse(instr);
   }
-  std::vector<uint32_t> decodeCIW16Instr(const uint32_t &instr) const {
-    return m_decodeCIW16Instr(instr);
+  static constexpr auto decodeCIW16Instr(uint32_t instr) {
+    return CIW16Fields::parse(instr);
   }
-  std::vector<uint32_t> decodeCSS16Instr(const uint32_t &instr) const {
-    return m_decodeCSS16Instr(instr);
+  static constexpr auto decodeCSS16Instr(uint32_t instr) {
+    return CSS16Fields::parse(instr);
   }
-  std::vector<uint32_t> decodeCJ16Instr(const uint32_t &instr) const {
-    return m_decodeCJ16Instr(instr);
+  static constexpr auto decodeCJ16Instr(uint32_t instr) {
+    return CJ16Fields::parse(instr);
   }
-  std::vector<uint32_t> decodeCB16Instr(const uint32_t &instr) const {
-    return m_decodeCB16Instr(instr);
+  static constexpr auto decodeCB16Instr(uint32_t instr) {
+    return CB16Fields::parse(instr);
   }
-  std::vector<uint32_t> decodeCB216Instr(const uint32_t &instr) const {
-    return m_decodeCB216Instr(instr);
+  static constexpr auto decodeCB216Instr(uint32_t instr) {
+    return CB216Fields::parse(instr);
   }
 
 private:
-  RVInstrParser() {
-    m_decodeR32Instr = generateInstrParser<uint32_t>(
-        std::vector<int>{7, 5, 3, 5, 5, 7}); // from LSB to MSB
-    m_decodeI32Instr =
-        generateInstrParser<uint32_t>(std::vector<int>{7, 5, 3, 5, 12});
-    m_decodeS32Instr =
-        generateInstrParser<uint32_t>(std::vector<int>{7, 5, 3, 5, 5, 7});
-    m_decodeB32Instr =
-        generateInstrParser<uint32_t>(std::vector<int>{7, 1, 4, 3, 5, 5, 6, 1});
-    m_decodeU32Instr =
-        generateInstrParser<uint32_t>(std::vector<int>{7, 5, 20});
-    m_decodeJ32Instr =
-        generateInstrParser<uint32_t>(std::vector<int>{7, 5, 8, 1, 10, 1});
-
-    // RVC
-    m_decodeCA16Instr = generateInstrParser<uint32_t>(
-        std::vector<int>{2, 3, 2, 3, 2, 1, 3, 16});
-    m_decodeCI16Instr =
-        generateInstrParser<uint32_t>(std::vector<int>{2, 5, 5, 1, 3, 16});
-    m_decodeCS16Instr =
-        generateInstrParser<uint32_t>(std::vector<int>{2, 3, 2, 3, 3, 3, 16});
-    m_decodeCIW16Instr =
-        generateInstrParser<uint32_t>(std::vector<int>{2, 3, 8, 3, 16});
-    m_decodeCSS16Instr =
-        generateInstrParser<uint32_t>(std::vector<int>{2, 5, 6, 3, 16});
-    m_decodeCJ16Instr =
-        generateInstrParser<uint32_t>(std::vector<int>{2, 11, 3, 16});
-    m_decodeCB16Instr =
-        generateInstrParser<uint32_t>(std::vector<int>{2, 5, 3, 3, 3, 16});
-    m_decodeCB216Instr =
-        generateInstrParser<uint32_t>(std::vector<int>{2, 5, 3, 2, 1, 3, 16});
-  }
-  decode_functor<uint32_t> m_decodeU32Instr;
-  decode_functor<uint32_t> m_decodeJ32Instr;
-  decode_functor<uint32_t> m_decodeI32Instr;
-  decode_functor<uint32_t> m_decodeS32Instr;
-  decode_functor<uint32_t> m_decodeR32Instr;
-  decode_functor<uint32_t> m_decodeB32Instr;
-
-  // RVC
-  decode_functor<uint32_t> m_decodeCA16Instr;
-  decode_functor<uint32_t> m_decodeCI16Instr;
-  decode_functor<uint32_t> m_decodeCS16Instr;
-  decode_functor<uint32_t> m_decodeCIW16Instr;
-  decode_functor<uint32_t> m_decodeCSS16Instr;
-  decode_functor<uint32_t> m_decodeCJ16Instr;
-  decode_functor<uint32_t> m_decodeCB16Instr;
-  decode_functor<uint32_t> m_decodeCB216Instr;
+  RVInstrParser() {}
 };
 
 } // namespace Ripes
@@ -48,6 +48,7 @@ public:
     m_enabledISA = ISAInfoRegistry::getISA<XLenToRVISA<XLEN>()>(extensions);
     decode->setISA(m_enabledISA);
     uncompress->setISA(m_enabledISA);
+    m_features |= Features::hasPerformanceCounters;
 
     // -----------------------------------------------------------------------
     // Program counter
@@ -84,6 +85,7 @@ public:
     // -----------------------------------------------------------------------
     // Control signals
     decode->opcode >> control->opcode;
+    decode->bitmanip_op >> control->bitmanip_op;
 
     // -----------------------------------------------------------------------
     // Immediate
@@ -104,6 +106,7 @@ public:
     memwb_reg->reg_wr_src_ctrl_out >> reg_wr_src->select;
 
     registerFile->setMemory(m_regMem);
+    trackRegisterWrites(RVISA::GPR);
 
     // -----------------------------------------------------------------------
     // Branch
@@ -456,7 +459,9 @@ public:
   }
 
   MemoryAccess dataMemAccess() const override {
-    return memToAccessInfo(data_mem);
+    auto dataAccess = memToAccessInfo(data_mem);
+    dataAccess.pc = getPcForStage({0, MEM});
+    return dataAccess;
   }
   MemoryAccess instrMemAccess() const override {
     auto instrAccess = memToAccessInfo(instr_mem);
@@ -478,6 +483,7 @@ public:
 
   void setRegister(const std::string_view &, unsigned i, VInt v) override {
     setSynchronousValue(registerFile->_wr_mem, i, v);
+    markRegistersWritten(RVISA::GPR, uint64_t(1) << i);
   }
 
   void clockProcessor() override {
@@ -487,7 +493,10 @@ public:
         isExecutableAddress(memwb_reg->pc_out.uValue())) {
       m_instructionsRetired++;
     }
+    if (m_countPerformance)
+      countEvents(1);
 
+    markRegistersWritten(RVISA::GPR, registerFile->pendingWriteMask());
     Design::clock();
   }
 
@@ -503,6 +512,35 @@ public:
         isExecutableAddress(memwb_reg->pc_out.uValue())) {
       m_instructionsRetired--;
     }
+    if (m_countPerformance)
+      countEvents(-1);
+  }
+
+  /**
+   * @brief countEvents
+   * Adds @p delta to the performance counters of the events of the current
+   * cycle.
+   */
+  void countEvents(int delta) {
+    countStageStates(delta);
+    auto &counters = m_performanceCounters;
+    if (hzunit->hazardIDEXClear.uValue()) {
+      counters.dataHazards += delta;
+      counters.loadUseHazards += delta;
+    }
+    if (idex_reg->valid_out.uValue()) {
+      const auto fw1 = funit->alu_reg1_forwarding_ctrl.uValue();
+      const auto fw2 = funit->alu_reg2_forwarding_ctrl.uValue();
+      counters.forwards += delta * ((fw1 != ForwardingSrc::IdStage) +
+                                    (fw2 != ForwardingSrc::IdStage));
+      if (idex_reg->do_br_out.uValue()) {
+        counters.branches += delta;
+        counters.branchesTaken += delta * br_and->out.uValue();
+      }
+      // Branches are predicted not taken; each change of control flow flushes
+      // the instructions fetched after it.
+      counters.mispredicts += delta * controlflow_or->out.uValue();
+    }
   }
 
   void reset() override {
@@ -54,15 +54,7 @@ public:
   // register file before handling the ecall.
   OUTPUTPORT(stallEcallHandling, 1);
 
-private:
-  bool hasHazard() { return hasDataOrLoadUseHazard() || hasEcallHazard(); }
-
-  bool hasDataOrLoadUseHazard() {
-    return hasDataHazardExMem() || hasLoadUseHazard();
-  }
-
-  bool hasDataHazardExMem() { return hasDataHazardEx() || hasDataHazardMem(); }
-
+  // True if the instruction in ID depends on a load in EX.
   bool hasLoadUseHazard() const {
     const unsigned exidx = ex_reg_wr_idx.uValue();
     const unsigned idx1 = id_reg1_idx.uValue();
@@ -72,6 +64,15 @@ private:
     return (exidx == idx1 || exidx == idx2) && mrd;
   }
 
+private:
+  bool hasHazard() { return hasDataOrLoadUseHazard() || hasEcallHazard(); }
+
+  bool hasDataOrLoadUseHazard() {
+    return hasDataHazardExMem() || hasLoadUseHazard();
+  }
+
+  bool hasDataHazardExMem() { return hasDataHazardEx() || hasDataHazardMem(); }
+
   bool hasEcallHazard() const {
     // Check for ECALL hazard. We are implictly dependent on all registers when
     // performing an ECALL operation. As such, all outstanding writes to the
@@ -40,7 +40,7 @@ namespace core {
 using namespace Ripes;
 
 template <typename XLEN_T>
-class RV6S_DUAL : public RipesVSRTLProcessor {
+class RV6S_DUAL : public RipesVSRTLProcessor, public DualIssueProcessor {
   static_assert(std::is_same<uint32_t, XLEN_T>::value ||
                     std::is_same<uint64_t, XLEN_T>::value,
                 "Only supports 32- and 64-bit variants");
@@ -55,6 +55,7 @@ public:
     decode_way2->setISA(m_enabledISA);
     decode_way1->setISA(m_enabledISA);
     uncompress_dual->setISA(m_enabledISA);
+    m_features |= Features::hasPerformanceCounters;
 
     // -----------------------------------------------------------------------
     // Program counter
@@ -219,6 +220,7 @@ public:
     memwb_reg->reg_do_write_data_out >> registerFile->wr_2_en;
 
     registerFile->setMemory(m_regMem);
+    trackRegisterWrites(RVISA::GPR);
 
     // -----------------------------------------------------------------------
     // Branch
@@ -784,6 +786,14 @@ public:
     return StageInfo({getPcForStage(stage), stageValid, state});
   }
 
+  void setPairingPolicy(const WayPairingPolicy &policy) override {
+    waycontrol->setPolicy(policy);
+    propagateDesign();
+  }
+  const WayPairingPolicy &pairingPolicy() const override {
+    return waycontrol->policy();
+  }
+
   void setProgramCounter(AInt address) override {
     pc_reg->forceValue(0, address);
     propagateDesign();
@@ -810,7 +820,9 @@ public:
   }
 
   MemoryAccess dataMemAccess() const override {
-    return memToAccessInfo(data_mem);
+    auto dataAccess = memToAccessInfo(data_mem);
+    dataAccess.pc = getPcForStage({DATA, MEM});
+    return dataAccess;
   }
   MemoryAccess instrMemAccess() const override {
     auto instrAccess = memToAccessInfo(instr_mem);
@@ -835,6 +847,7 @@ public:
 
   void setRegister(const std::string_view &, unsigned i, VInt v) override {
     setSynchronousValue(registerFile->rf_1->_wr_mem, i, v);
+    markRegistersWritten(RVISA::GPR, uint64_t(1) << i);
   }
 
   int instructionsRetired() const {
@@ -858,7 +871,10 @@ public:
     // An instruction has been retired if the instruction in the WB stage is
     // valid and the PC is within the executable range of the program
     m_instructionsRetired += instructionsRetired();
+    if (m_countPerformance)
+      countEvents(1);
 
+    markRegistersWritten(RVISA::GPR, registerFile->pendingWriteMask());
     Design::clock();
   }
 
@@ -871,6 +887,76 @@ public:
     }
     Design::reverse();
     m_instructionsRetired -= instructionsRetired();
+    if (m_countPerformance)
+      countEvents(-1);
+  }
+
+  /**
+   * @brief countEvents
+   * Adds @p delta to the performance counters of the events of the current
+   * cycle.
+   */
+  void countEvents(int delta) {
+    countStageStates(delta);
+    auto &counters = m_performanceCounters;
+    if (hzunit->hazardIDEXClear.uValue()) {
+      counters.dataHazards += delta;
+      counters.loadUseHazards += delta;
+    }
+    // Pairing failures take effect unless the fetched instructions are held
+    // by a hazard or flushed.
+    if (waycontrol->stall_out.uValue() && hzunit->hazardFEEnable.uValue() &&
+        !branch->did_controlflow.uValue() &&
+        isExecutableAddress(ifid_reg->pc4_out.uValue())) {
+      auto &failures = counters.pairingFailures;
+      switch (waycontrol->pairingFailure()) {
+      case PairingFailure::Controlflow:
+        failures.controlflow += delta;
+        break;
+      case PairingFailure::Structural:
+        failures.structural += delta;
+        break;
+      case PairingFailure::Ecall:
+        failures.ecall += delta;
+        break;
+      case PairingFailure::Dependence:
+        failures.dependence += delta;
+        break;
+      case PairingFailure::Policy:
+        failures.policy += delta;
+        break;
+      case PairingFailure::None:
+        break;
+      }
+    }
+    if (!iiex_reg->valid_out.uValue())
+      return;
+
+    const bool exec = iiex_reg->exec_valid_out.uValue();
+    const bool data = iiex_reg->data_valid_out.uValue();
+    const auto forwards = [](const auto &ctrl1, const auto &ctrl2) {
+      return (ctrl1.uValue() != ForwardingSrcDual::IdStage) +
+             (ctrl2.uValue() != ForwardingSrcDual::IdStage);
+    };
+    if (exec) {
+      counters.forwards +=
+          delta *
+          forwards(funit->alu_reg1_fw_ctrl_exec, funit->alu_reg2_fw_ctrl_exec);
+      // Branches are resolved in the execution way, and predicted not taken.
+      if (iiex_reg->do_br_out.uValue()) {
+        counters.branches += delta;
+        counters.branchesTaken += delta * branch->did_controlflow.uValue();
+      }
+      counters.mispredicts += delta * branch->did_controlflow.uValue();
+    }
+    if (data)
+      counters.forwards +=
+          delta *
+          forwards(funit->alu_reg1_fw_ctrl_data, funit->alu_reg2_fw_ctrl_data);
+    if (exec || data)
+      counters.issueCycles += delta;
+    if (exec && data)
+      counters.dualIssueCycles += delta;
   }
 
   void reset() override {
@@ -879,7 +965,11 @@ public:
     m_syscallExitCycle = -1;
   }
 
-  static ProcessorISAInfo supportsISA() { return RVISA::supportsISA<XLEN>(); }
+  static ProcessorISAInfo supportsISA() {
+    // The way control does not forward the bit-manipulation operations of the
+    // decoders.
+    return RVISA::supportsISA<XLEN>(false, false, false);
+  }
   const ISAInfoBase *implementsISA() const override {
     return m_enabledISA.get();
   }
@@ -64,6 +64,12 @@ public:
   INPUTPORT(data_2_in, XLEN);
   INPUTPORT(wr_2_en, 1);
 
+  /// Returns a mask of the registers written by the pending (current-cycle)
+  /// writes of both ways.
+  uint64_t pendingWriteMask() const {
+    return rf_1->pendingWriteMask() | rf_2->pendingWriteMask();
+  }
+
   VSRTL_VT_U getRegister(unsigned i) {
     return m_memory->readMem(i << ceillog2(XLEN / CHAR_BIT), XLEN / CHAR_BIT);
   }
@@ -4,6 +4,52 @@
 #include "VSRTL/core/vsrtl_component.h"
 #include "rv6s_dual_common.h"
 
+namespace Ripes {
+
+/**
+ * @brief The WayPairingPolicy struct
+ * Restricts the pairs of instructions which the dual-issue processor issues
+ * together. The datapath fixes the units of the ways: the execution way
+ * executes arithmetic, control-flow and ecall instructions, and the data way
+ * loads, stores and arithmetic instructions.
+ */
+struct WayPairingPolicy {
+  // Whether the data way executes arithmetic instructions; otherwise, it only
+  // executes loads and stores.
+  bool dataWayArithmetic = true;
+  // Whether a control-flow instruction may issue together with the older
+  // instruction fetched with it; otherwise, it issues alone.
+  bool pairControlflow = true;
+};
+
+/// Reasons for which two fetched instructions did not issue together.
+enum class PairingFailure {
+  None,
+  // The older instruction is a control-flow instruction.
+  Controlflow,
+  // Both instructions require the memory unit, or the branch unit.
+  Structural,
+  // One of the instructions is an ecall.
+  Ecall,
+  // The younger instruction reads the register written by the older.
+  Dependence,
+  // The pair is disallowed by the WayPairingPolicy.
+  Policy
+};
+
+/**
+ * @brief The DualIssueProcessor class
+ * Interface of processor models pairing instructions through a WayControl.
+ */
+class DualIssueProcessor {
+public:
+  virtual ~DualIssueProcessor() {}
+  virtual void setPairingPolicy(const WayPairingPolicy &policy) = 0;
+  virtual const WayPairingPolicy &pairingPolicy() const = 0;
+};
+
+} // namespace Ripes
+
 namespace vsrtl {
 namespace core {
 using namespace Ripes;
@@ -99,6 +145,16 @@ private:
     }
   }
 
+  bool policyAllows(const WayClass &way1Type,
+                    const WayClass &way2Type) const {
+    // Unless either instruction is a load or store, the data way executes an
+    // arithmetic instruction.
+    if (!m_policy.dataWayArithmetic && way1Type != WayClass::Data &&
+        way2Type != WayClass::Data)
+      return false;
+    return m_policy.pairControlflow || way2Type != WayClass::Controlflow;
+  }
+
   WaySrc otherWay(const WaySrc way) const {
     return way == +WaySrc::WAY1 ? WaySrc::WAY2 : WaySrc::WAY1;
   }
@@ -124,21 +180,30 @@ private:
       m_execWayValid = way2Type != WayClass::Data;
       m_execWaySrc = WaySrc::WAY2;
       m_stall = false;
+      m_failure = PairingFailure::None;
     } else if (way1Type == WayClass::Controlflow) {
       // Control flow hazard; only issue 1st fetched instruction
       m_dataWayValid = false;
       m_execWayValid = true;
       m_execWaySrc = WaySrc::WAY1;
       m_stall = true && ifid_valid.uValue();
+      m_failure = PairingFailure::Controlflow;
     } else if (structuralHazard(way1Type, way2Type) ||
-               way2Type == WayClass::Ecall || way1Type == WayClass::Ecall) {
-      // Structural hazard or ecall; always issue way 1 instruction (execute
-      // in-order)
+               way2Type == WayClass::Ecall || way1Type == WayClass::Ecall ||
+               !policyAllows(way1Type, way2Type)) {
+      // Structural hazard, ecall or a pair disallowed by the policy; always
+      // issue way 1 instruction (execute in-order)
       m_dataWayValid = way1Type == WayClass::Data;
       m_dataWaySrc = WaySrc::WAY1;
       m_execWayValid = way1Type != WayClass::Data;
       m_execWaySrc = WaySrc::WAY1;
       m_stall = true && ifid_valid.uValue();
+      if (structuralHazard(way1Type, way2Type))
+        m_failure = PairingFailure::Structural;
+      else if (way1Type == WayClass::Ecall || way2Type == WayClass::Ecall)
+        m_failure = PairingFailure::Ecall;
+      else
+        m_failure = PairingFailure::Policy;
     } else if (rawHazard()) {
       // WAR hazard; only issue 1st fetched instruction
       m_dataWayValid = way1Type == WayClass::Data;
@@ -146,6 +211,7 @@ private:
       m_dataWaySrc = WaySrc::WAY1;
       m_execWaySrc = WaySrc::WAY1;
       m_stall = true && ifid_valid.uValue();
+      m_failure = PairingFailure::Dependence;
     } else {
       // Can issue both
       m_dataWayValid = true;
@@ -170,6 +236,7 @@ private:
       }
 
       m_stall = false;
+      m_failure = PairingFailure::None;
       Q_ASSERT(m_dataWaySrc != m_execWaySrc);
     }
 
@@ -205,6 +272,22 @@ public:
     Q_ASSERT(m_design != nullptr);
   }
 
+  void setPolicy(const WayPairingPolicy &policy) {
+    m_policy = policy;
+    cachedCycle = -1;
+  }
+  const WayPairingPolicy &policy() const { return m_policy; }
+
+  /**
+   * @brief pairingFailure
+   * Returns the reason for which the fetched instructions of the current cycle
+   * do not issue together, if stall_out is asserted.
+   */
+  PairingFailure pairingFailure() {
+    computeCycle();
+    return m_failure;
+  }
+
   INPUTPORT(ifid_valid, 1);
 
   INPUTPORT_ENUM(opcode_way1, RVInstr);
@@ -239,6 +322,8 @@ private:
   WaySrc m_execWaySrc = WaySrc::WAY1;
   WaySrc m_dataWaySrc = WaySrc::WAY1;
   bool m_stall = false;
+  PairingFailure m_failure = PairingFailure::None;
+  WayPairingPolicy m_policy;
 };
 
 } // namespace core
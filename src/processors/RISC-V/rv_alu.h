@@ -4,6 +4,7 @@
 #include <math.h>
 
 #include "riscv.h"
+#include "rv_bitmanip.h"
 
 #include "VSRTL/core/vsrtl_component.h"
 
@@ -16,6 +17,8 @@ constexpr int64_t div_overflow64 = (LLONG_MIN);   //-2^(64-1)
 
 template <unsigned XLEN>
 class ALU : public Component {
+  using XLEN_T = std::conditional_t<XLEN == 32, uint32_t, uint64_t>;
+
 public:
   SetGraphicsType(ALU);
   ALU(const std::string &name, SimComponent *parent) : Component(name, parent) {
@@ -161,6 +164,10 @@ public:
                                    (op2.uValue() & generateBitmask(5))));
 
       default:
+        if (RVBitManip::isOp(ctrl.uValue()))
+          return VT_U(RVBitManip::execute(
+              ctrl.uValue(), static_cast<XLEN_T>(op1.uValue()),
+              static_cast<XLEN_T>(op2.uValue())));
         throw std::runtime_error("Invalid ALU opcode");
       }
     };
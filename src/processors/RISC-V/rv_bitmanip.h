@@ -0,0 +1,344 @@
+#pragma once
+
+#include <climits>
+#include <cstdint>
+#include <type_traits>
+
+#include "riscv.h"
+
+namespace Ripes {
+
+/// Decoding and operations of the bit-manipulation extensions (Zba/Zbb/Zbs),
+/// shared by the VSRTL models and the instruction set simulator. Instructions
+/// are decoded to the ALUOp operations from ALUOp::SH1ADD through ALUOp::BSET.
+/// All operations are defined on unsigned operands of the width of the
+/// operation.
+namespace RVBitManip {
+
+template <typename T>
+constexpr unsigned bits() {
+  static_assert(std::is_unsigned_v<T>, "Operands must be unsigned");
+  return sizeof(T) * CHAR_BIT;
+}
+
+/// Returns the number of leading zero bits of @p v, or the width of T if @p v
+/// is zero.
+template <typename T>
+constexpr T clz(T v) {
+  if (v == 0)
+    return bits<T>();
+  T count = 0;
+  for (unsigned shift = bits<T>() / 2; shift > 0; shift /= 2) {
+    if ((v >> (bits<T>() - shift)) == 0) {
+      count += shift;
+      v <<= shift;
+    }
+  }
+  return count;
+}
+
+/// Returns the number of trailing zero bits of @p v, or the width of T if @p v
+/// is zero.
+template <typename T>
+constexpr T ctz(T v) {
+  if (v == 0)
+    return bits<T>();
+  // Isolate the lowest set bit; all bits below it are the trailing zeros.
+  return bits<T>() - 1 - clz<T>(v & (~v + 1));
+}
+
+/// Returns the number of set bits of @p v.
+template <typename T>
+constexpr T cpop(T v) {
+  constexpr T m1 = T(~T(0)) / 3;
+  constexpr T m2 = T(~T(0)) / 15 * 3;
+  constexpr T m4 = T(~T(0)) / 255 * 15;
+  constexpr T h01 = T(~T(0)) / 255;
+  v -= (v >> 1) & m1;
+  v = (v & m2) + ((v >> 2) & m2);
+  v = (v + (v >> 4)) & m4;
+  return T(v * h01) >> (bits<T>() - CHAR_BIT);
+}
+
+template <typename T>
+constexpr T rol(T v, unsigned shamt) {
+  shamt &= bits<T>() - 1;
+  return shamt == 0 ? v : T(v << shamt) | T(v >> (bits<T>() - shamt));
+}
+
+template <typename T>
+constexpr T ror(T v, unsigned shamt) {
+  shamt &= bits<T>() - 1;
+  return shamt == 0 ? v : T(v >> shamt) | T(v << (bits<T>() - shamt));
+}
+
+/// Sets each byte of the result to all ones if the byte of @p v is nonzero.
+template <typename T>
+constexpr T orcb(T v) {
+  T res = 0;
+  for (unsigned i = 0; i < bits<T>(); i += CHAR_BIT) {
+    if ((v >> i) & 0xFF)
+      res |= T(0xFF) << i;
+  }
+  return res;
+}
+
+/// Reverses the order of the bytes of @p v.
+template <typename T>
+constexpr T rev8(T v) {
+  T res = 0;
+  for (unsigned i = 0; i < sizeof(T); ++i) {
+    res = T(res << CHAR_BIT) | (v & 0xFF);
+    v >>= CHAR_BIT;
+  }
+  return res;
+}
+
+/// Sign-extends the lowest @p width bits of @p v.
+template <typename T>
+constexpr T sext(T v, unsigned width) {
+  const T sign = T(1) << (width - 1);
+  v &= (T(1) << width) - 1;
+  return T((v ^ sign) - sign);
+}
+
+/// The enabled bit-manipulation extensions of an ISA.
+struct Extensions {
+  Extensions() = default;
+  explicit Extensions(const ISAInfoBase &isa)
+      : zba(isa.extensionEnabled("Zba")), zbb(isa.extensionEnabled("Zbb")),
+        zbs(isa.extensionEnabled("Zbs")) {}
+  bool any() const { return zba || zbb || zbs; }
+
+  bool zba = false;
+  bool zbb = false;
+  bool zbs = false;
+};
+
+/// Returns whether @p op is a bit-manipulation operation.
+inline bool isOp(unsigned op) {
+  return op >= ALUOp::SH1ADD && op <= ALUOp::BSET;
+}
+
+/// Returns the operation of the bit-manipulation instruction @p instr, or
+/// ALUOp::NOP if @p instr is not an instruction of the extensions @p ext. The
+/// second operand of the operation is rs2 for OP and OP-32 instructions, and
+/// the I-type immediate for OP-IMM and OP-IMM-32 instructions.
+template <unsigned XLEN>
+unsigned decode(uint32_t instr, const Extensions &ext) {
+  const unsigned opcode = instr & 0x7F;
+  const unsigned funct3 = (instr >> 12) & 0x7;
+  const unsigned funct5 = (instr >> 20) & 0x1F;
+  const unsigned funct7 = instr >> 25;
+  const unsigned imm12 = instr >> 20;
+  // The shift amount of RV64 immediate shifts extends into funct7.
+  const unsigned shiftFunct7 = XLEN == 64 ? funct7 & ~0x1u : funct7;
+
+  switch (opcode) {
+  case RVISA::OpcodeID::OP:
+    switch (funct7 << 3 | funct3) {
+    case 0b0010000'010:
+      return ext.zba ? ALUOp::SH1ADD : ALUOp::NOP;
+    case 0b0010000'100:
+      return ext.zba ? ALUOp::SH2ADD : ALUOp::NOP;
+    case 0b0010000'110:
+      return ext.zba ? ALUOp::SH3ADD : ALUOp::NOP;
+    case 0b0100000'111:
+      return ext.zbb ? ALUOp::ANDN : ALUOp::NOP;
+    case 0b0100000'110:
+      return ext.zbb ? ALUOp::ORN : ALUOp::NOP;
+    case 0b0100000'100:
+      return ext.zbb ? ALUOp::XNOR : ALUOp::NOP;
+    case 0b0000101'100:
+      return ext.zbb ? ALUOp::MIN : ALUOp::NOP;
+    case 0b0000101'101:
+      return ext.zbb ? ALUOp::MINU : ALUOp::NOP;
+    case 0b0000101'110:
+      return ext.zbb ? ALUOp::MAX : ALUOp::NOP;
+    case 0b0000101'111:
+      return ext.zbb ? ALUOp::MAXU : ALUOp::NOP;
+    case 0b0000100'100:
+      return ext.zbb && XLEN == 32 && funct5 == 0 ? ALUOp::ZEXTH : ALUOp::NOP;
+    case 0b0110000'001:
+      return ext.zbb ? ALUOp::ROL : ALUOp::NOP;
+    case 0b0110000'101:
+      return ext.zbb ? ALUOp::ROR : ALUOp::NOP;
+    case 0b0100100'001:
+      return ext.zbs ? ALUOp::BCLR : ALUOp::NOP;
+    case 0b0100100'101:
+      return ext.zbs ? ALUOp::BEXT : ALUOp::NOP;
+    case 0b0110100'001:
+      return ext.zbs ? ALUOp::BINV : ALUOp::NOP;
+    case 0b0010100'001:
+      return ext.zbs ? ALUOp::BSET : ALUOp::NOP;
+    }
+    return ALUOp::NOP;
+
+  case RVISA::OpcodeID::OPIMM:
+    if (ext.zbb && funct3 == 0b001 && funct7 == 0b0110000) {
+      switch (funct5) {
+      case 0b00000:
+        return ALUOp::CLZ;
+      case 0b00001:
+        return ALUOp::CTZ;
+      case 0b00010:
+        return ALUOp::CPOP;
+      case 0b00100:
+        return ALUOp::SEXTB;
+      case 0b00101:
+        return ALUOp::SEXTH;
+      }
+      return ALUOp::NOP;
+    }
+    if (ext.zbb && funct3 == 0b101) {
+      if (imm12 == 0b001010000111)
+        return ALUOp::ORCB;
+      if (imm12 == (XLEN == 32 ? 0b011010011000 : 0b011010111000))
+        return ALUOp::REV8;
+    }
+    switch (shiftFunct7 << 3 | funct3) {
+    case 0b0110000'101:
+      return ext.zbb ? ALUOp::ROR : ALUOp::NOP;
+    case 0b0100100'001:
+      return ext.zbs ? ALUOp::BCLR : ALUOp::NOP;
+    case 0b0100100'101:
+      return ext.zbs ? ALUOp::BEXT : ALUOp::NOP;
+    case 0b0110100'001:
+      return ext.zbs ? ALUOp::BINV : ALUOp::NOP;
+    case 0b0010100'001:
+      return ext.zbs ? ALUOp::BSET : ALUOp::NOP;
+    }
+    return ALUOp::NOP;
+
+  case RVISA::OpcodeID::OP32:
+    if (XLEN != 64)
+      return ALUOp::NOP;
+    switch (funct7 << 3 | funct3) {
+    case 0b0000100'000:
+      return ext.zba ? ALUOp::ADDUW : ALUOp::NOP;
+    case 0b0010000'010:
+      return ext.zba ? ALUOp::SH1ADDUW : ALUOp::NOP;
+    case 0b0010000'100:
+      return ext.zba ? ALUOp::SH2ADDUW : ALUOp::NOP;
+    case 0b0010000'110:
+      return ext.zba ? ALUOp::SH3ADDUW : ALUOp::NOP;
+    case 0b0000100'100:
+      return ext.zbb && funct5 == 0 ? ALUOp::ZEXTH : ALUOp::NOP;
+    case 0b0110000'001:
+      return ext.zbb ? ALUOp::ROLW : ALUOp::NOP;
+    case 0b0110000'101:
+      return ext.zbb ? ALUOp::RORW : ALUOp::NOP;
+    }
+    return ALUOp::NOP;
+
+  case RVISA::OpcodeID::OPIMM32:
+    if (XLEN != 64)
+      return ALUOp::NOP;
+    if (ext.zba && funct3 == 0b001 && (funct7 >> 1) == 0b000010)
+      return ALUOp::SLLIUW;
+    if (!ext.zbb || funct7 != 0b0110000)
+      return ALUOp::NOP;
+    if (funct3 == 0b101)
+      return ALUOp::RORW;
+    if (funct3 != 0b001)
+      return ALUOp::NOP;
+    switch (funct5) {
+    case 0b00000:
+      return ALUOp::CLZW;
+    case 0b00001:
+      return ALUOp::CTZW;
+    case 0b00010:
+      return ALUOp::CPOPW;
+    }
+    return ALUOp::NOP;
+  }
+  return ALUOp::NOP;
+}
+
+/// Executes the bit-manipulation operation @p op on the operands @p a and
+/// @p b.
+template <typename XLEN_T>
+XLEN_T execute(unsigned op, XLEN_T a, XLEN_T b) {
+  using XLENS_T = std::make_signed_t<XLEN_T>;
+  const unsigned shamt = b & (bits<XLEN_T>() - 1);
+  const XLEN_T bit = XLEN_T(1) << shamt;
+  const uint32_t a32 = static_cast<uint32_t>(a);
+  const auto sext32 = [](uint32_t v) {
+    return static_cast<XLEN_T>(sext<uint64_t>(v, 32));
+  };
+
+  switch (op) {
+  case ALUOp::SH1ADD:
+    return (a << 1) + b;
+  case ALUOp::SH2ADD:
+    return (a << 2) + b;
+  case ALUOp::SH3ADD:
+    return (a << 3) + b;
+  case ALUOp::ADDUW:
+    return XLEN_T(a32) + b;
+  case ALUOp::SH1ADDUW:
+    return (XLEN_T(a32) << 1) + b;
+  case ALUOp::SH2ADDUW:
+    return (XLEN_T(a32) << 2) + b;
+  case ALUOp::SH3ADDUW:
+    return (XLEN_T(a32) << 3) + b;
+  case ALUOp::SLLIUW:
+    return XLEN_T(a32) << shamt;
+  case ALUOp::ANDN:
+    return a & ~b;
+  case ALUOp::ORN:
+    return a | ~b;
+  case ALUOp::XNOR:
+    return ~(a ^ b);
+  case ALUOp::CLZ:
+    return clz(a);
+  case ALUOp::CTZ:
+    return ctz(a);
+  case ALUOp::CPOP:
+    return cpop(a);
+  case ALUOp::CLZW:
+    return clz(a32);
+  case ALUOp::CTZW:
+    return ctz(a32);
+  case ALUOp::CPOPW:
+    return cpop(a32);
+  case ALUOp::MIN:
+    return XLENS_T(a) < XLENS_T(b) ? a : b;
+  case ALUOp::MINU:
+    return a < b ? a : b;
+  case ALUOp::MAX:
+    return XLENS_T(a) < XLENS_T(b) ? b : a;
+  case ALUOp::MAXU:
+    return a < b ? b : a;
+  case ALUOp::SEXTB:
+    return sext(a, 8);
+  case ALUOp::SEXTH:
+    return sext(a, 16);
+  case ALUOp::ZEXTH:
+    return a & 0xFFFF;
+  case ALUOp::ROL:
+    return rol(a, shamt);
+  case ALUOp::ROR:
+    return ror(a, shamt);
+  case ALUOp::ROLW:
+    return sext32(rol(a32, shamt));
+  case ALUOp::RORW:
+    return sext32(ror(a32, shamt));
+  case ALUOp::ORCB:
+    return orcb(a);
+  case ALUOp::REV8:
+    return rev8(a);
+  case ALUOp::BCLR:
+    return a & ~bit;
+  case ALUOp::BEXT:
+    return (a >> shamt) & 1;
+  case ALUOp::BINV:
+    return a ^ bit;
+  case ALUOp::BSET:
+    return a | bit;
+  }
+  return 0;
+}
+
+} // namespace RVBitManip
+} // namespace Ripes
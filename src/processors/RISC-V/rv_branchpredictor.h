@@ -0,0 +1,335 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+
+#include "VSRTL/core/vsrtl_component.h"
+
+#include "riscv.h"
+#include "rv_targetpredictor.h"
+
+namespace Ripes {
+Enum(PredSrc, PC4 = 0, BTB = 1);
+Enum(NextPcSrc, PREDICTED = 0, EX_PC4 = 1, ALU = 2);
+
+enum class BranchPredictorScheme {
+  // Backward branches are predicted taken, forward branches not taken.
+  BTFN,
+  // A branch history table of the last outcome of each branch.
+  OneBit,
+  // A branch history table of 2-bit saturating counters.
+  TwoBit,
+  // 2-bit saturating counters indexed by the branch address XOR'ed with the
+  // global history of branch outcomes.
+  GShare
+};
+} // namespace Ripes
+
+namespace vsrtl {
+namespace core {
+using namespace Ripes;
+
+/**
+ * @brief The BranchPredictor class
+ * Predicts the address fetched after the instruction in the IF stage, and
+ * detects mispredicted control flow once the instruction is resolved in the EX
+ * stage.
+ *
+ * Targets are predicted through a direct-mapped branch target buffer (BTB).
+ * An instruction in IF is predicted taken if it hits the BTB and either is a
+ * jump, or its direction is predicted taken by the scheme of the predictor.
+ * The EX stage is mispredicted if the instruction fetched after it, which is
+ * the instruction in the ID stage, is not located at the resolved address.
+ * Given that the BTB is only filled by taken control flow, the BTFN scheme
+ * predicts a branch once it has been taken.
+ *
+ * Optionally, returns are predicted by a return-address stack, and other
+ * indirect jumps by an indirect-target predictor (see TargetPredictionConfig),
+ * whose predictions take precedence over the target in the BTB. Both are
+ * trained as jumps are resolved in the EX stage; predictions account for the
+ * jumps in the ID and EX stages, which are yet to train them.
+ *
+ * The predictor tables are updated when the processor is clocked, and are
+ * restored when the processor is reversed.
+ */
+template <unsigned XLEN, BranchPredictorScheme scheme>
+class BranchPredictor : public Component {
+public:
+  static constexpr unsigned c_bhtBits = 10;
+  static constexpr unsigned c_btbBits = 6;
+
+  BranchPredictor(const std::string &name, SimComponent *parent)
+      : Component(name, parent) {
+    setDescription("Branch predictor and branch target buffer");
+    pred_taken << [=] { return predictTaken(if_pc.uValue()); };
+    pred_target << [=] { return predictTarget(if_pc.uValue()); };
+    mispredict << [=] { return isMispredicted(); };
+    next_pc_src << [=] {
+      if (!isMispredicted())
+        return NextPcSrc::PREDICTED;
+      return ex_taken.uValue() ? NextPcSrc::ALU : NextPcSrc::EX_PC4;
+    };
+    resetTables();
+  }
+
+  // Address of the instruction in the IF stage
+  INPUTPORT(if_pc, XLEN);
+  // Address and decoded jump of the instruction in the ID stage
+  INPUTPORT(id_pc, XLEN);
+  INPUTPORT(id_pc4, XLEN);
+  INPUTPORT(id_valid, 1);
+  INPUTPORT_ENUM(id_opcode, RVInstr);
+  INPUTPORT(id_wr_reg_idx, c_RVRegsBits);
+  INPUTPORT(id_r1_reg_idx, c_RVRegsBits);
+
+  // Resolution of the instruction in the EX stage
+  INPUTPORT(ex_valid, 1);
+  INPUTPORT(ex_pc, XLEN);
+  INPUTPORT(ex_pc4, XLEN);
+  INPUTPORT(ex_do_br, 1);
+  INPUTPORT(ex_do_jmp, 1);
+  INPUTPORT(ex_taken, 1);
+  INPUTPORT(ex_target, XLEN);
+  INPUTPORT_ENUM(ex_opcode, RVInstr);
+  INPUTPORT(ex_wr_reg_idx, c_RVRegsBits);
+  INPUTPORT(ex_r1_reg_idx, c_RVRegsBits);
+
+  OUTPUTPORT(pred_taken, 1);
+  OUTPUTPORT(pred_target, XLEN);
+  OUTPUTPORT(mispredict, 1);
+  OUTPUTPORT_ENUM(next_pc_src, NextPcSrc);
+
+  /**
+   * @brief update
+   * Trains the predictor on the instruction which is resolved in the EX stage.
+   * Must be called before clocking the design.
+   */
+  void update() {
+    Update record;
+    record.history = m_history;
+    const AInt pc = ex_pc.uValue();
+    const bool isControlFlow = ex_do_br.uValue() || ex_do_jmp.uValue();
+    if (ex_valid.uValue() && isControlFlow) {
+      record.valid = true;
+      const bool taken = ex_taken.uValue();
+      record.bhtIndex = bhtIndex(pc);
+      record.bht = m_bht.at(record.bhtIndex);
+      record.btbIndex = btbIndex(pc);
+      record.btb = m_btb.at(record.btbIndex);
+
+      if (ex_do_br.uValue()) {
+        uint8_t &counter = m_bht[record.bhtIndex];
+        if constexpr (scheme == BranchPredictorScheme::OneBit) {
+          counter = taken;
+        } else {
+          if (taken && counter < 3)
+            ++counter;
+          else if (!taken && counter > 0)
+            --counter;
+        }
+        m_history = ((m_history << 1) | taken) & ((1u << c_bhtBits) - 1);
+      }
+      const AInt target = ex_target.uValue();
+      record.hints = exHints();
+      record.ras = m_ras.update(record.hints.pop, record.hints.push,
+                                ex_pc4.uValue());
+      if (record.hints.indirect)
+        record.itp = m_itp.update(pc, target);
+      if (taken)
+        m_btb[record.btbIndex] = {true, pc, target, bool(ex_do_jmp.uValue()),
+                                  record.hints};
+    }
+    m_updates.push_back(record);
+    if (m_updates.size() > m_maxUpdates)
+      m_updates.pop_front();
+  }
+
+  /**
+   * @brief revert
+   * Reverts the last update of the predictor. Must be called before reversing
+   * the design.
+   */
+  void revert() {
+    if (m_updates.empty())
+      return;
+    const Update &record = m_updates.back();
+    if (record.valid) {
+      m_bht[record.bhtIndex] = record.bht;
+      m_btb[record.btbIndex] = record.btb;
+      m_ras.revert(record.ras);
+      if (record.hints.indirect)
+        m_itp.revert(record.itp);
+    }
+    m_history = record.history;
+    m_updates.pop_back();
+  }
+
+  void resetTables() {
+    // 2-bit counters are initialized as weakly not taken.
+    const uint8_t initial = scheme == BranchPredictorScheme::OneBit ? 0 : 1;
+    m_bht.assign(1u << c_bhtBits, initial);
+    m_btb.assign(1u << c_btbBits, BTBEntry());
+    m_history = 0;
+    m_ras.clear();
+    m_itp.clear();
+    m_updates.clear();
+  }
+
+  /// Sizes the target predictors, and clears them.
+  void setTargetPrediction(const TargetPredictionConfig &config) {
+    m_targetPrediction = config;
+    m_ras.resize(config.rasEntries);
+    m_itp.resize(config.indirectEntries);
+    m_updates.clear();
+  }
+  const TargetPredictionConfig &targetPrediction() const {
+    return m_targetPrediction;
+  }
+
+  /// Returns the hints of the jump in the EX stage, if any.
+  JumpHints exHints() const {
+    if (!ex_valid.uValue())
+      return {};
+    return hints(ex_opcode.uValue(), ex_wr_reg_idx.uValue(),
+                 ex_r1_reg_idx.uValue());
+  }
+
+  /// Sets the number of updates which may be reverted.
+  void setMaxUpdates(unsigned updates) {
+    m_maxUpdates = updates;
+    while (m_updates.size() > m_maxUpdates)
+      m_updates.pop_front();
+  }
+
+private:
+  struct BTBEntry {
+    bool valid = false;
+    AInt tag = 0;
+    AInt target = 0;
+    bool jump = false;
+    JumpHints hints;
+  };
+
+  struct Update {
+    bool valid = false;
+    unsigned bhtIndex = 0;
+    uint8_t bht = 0;
+    unsigned btbIndex = 0;
+    BTBEntry btb;
+    unsigned history = 0;
+    JumpHints hints;
+    ReturnAddressStack::Undo ras;
+    IndirectTargetPredictor::Undo itp;
+  };
+
+  static JumpHints hints(VSRTL_VT_U opcode, unsigned rd, unsigned rs1) {
+    if (opcode != RVInstr::JAL && opcode != RVInstr::JALR)
+      return {};
+    return JumpHints::of(opcode == RVInstr::JALR, rd, rs1);
+  }
+  JumpHints idHints() const {
+    if (!id_valid.uValue())
+      return {};
+    return hints(id_opcode.uValue(), id_wr_reg_idx.uValue(),
+                 id_r1_reg_idx.uValue());
+  }
+
+  // Instructions are aligned to 2 bytes, given the C extension.
+  static unsigned btbIndex(AInt pc) {
+    return (pc >> 1) & ((1u << c_btbBits) - 1);
+  }
+  unsigned bhtIndex(AInt pc) const {
+    unsigned index = pc >> 1;
+    if constexpr (scheme == BranchPredictorScheme::GShare)
+      index ^= m_history;
+    return index & ((1u << c_bhtBits) - 1);
+  }
+
+  BTBEntry btbEntry(AInt pc) const {
+    const BTBEntry &entry = m_btb.at(btbIndex(pc));
+    return entry.valid && entry.tag == pc ? entry : BTBEntry();
+  }
+
+  AInt predictTarget(AInt pc) const {
+    const BTBEntry entry = btbEntry(pc);
+    std::optional<AInt> target;
+    if (entry.hints.pop)
+      target = pendingReturn();
+    else if (entry.hints.indirect)
+      target = m_itp.predict(pc, pendingHistory());
+    return target.value_or(entry.target);
+  }
+
+  /// Returns the top of the return-address stack once the jumps in the EX
+  /// and ID stages have been resolved.
+  std::optional<AInt> pendingReturn() const {
+    if (!m_ras.enabled())
+      return {};
+    std::optional<AInt> pushed;
+    unsigned depth = 0;
+    const auto resolve = [&](const JumpHints &hints, AInt pc4) {
+      if (hints.pop) {
+        if (pushed)
+          pushed.reset();
+        else
+          depth++;
+      }
+      if (hints.push)
+        pushed = pc4;
+    };
+    resolve(exHints(), ex_pc4.uValue());
+    resolve(idHints(), id_pc4.uValue());
+    return pushed ? pushed : m_ras.peek(depth);
+  }
+
+  /// Returns the target history of the indirect-target predictor once the
+  /// jumps in the EX and ID stages have been resolved. The jump in ID jumps
+  /// to the instruction in IF, unless it is mispredicted, in which case the
+  /// instruction in IF is flushed.
+  unsigned pendingHistory() const {
+    unsigned history = m_itp.history();
+    if (exHints().indirect)
+      history = IndirectTargetPredictor::nextHistory(history,
+                                                     ex_target.uValue());
+    if (idHints().indirect)
+      history = IndirectTargetPredictor::nextHistory(history, if_pc.uValue());
+    return history;
+  }
+
+  bool predictTaken(AInt pc) const {
+    const BTBEntry entry = btbEntry(pc);
+    if (!entry.valid)
+      return false;
+    if (entry.jump)
+      return true;
+    if constexpr (scheme == BranchPredictorScheme::BTFN)
+      return entry.target <= pc;
+    else if constexpr (scheme == BranchPredictorScheme::OneBit)
+      return m_bht.at(bhtIndex(pc)) != 0;
+    else
+      return m_bht.at(bhtIndex(pc)) >= 2;
+  }
+
+  bool isMispredicted() const {
+    // The ID stage is only cleared whilst the pipeline is being flushed.
+    if (!ex_valid.uValue() || !id_valid.uValue())
+      return false;
+    const AInt resolved =
+        ex_taken.uValue() ? ex_target.uValue() : ex_pc4.uValue();
+    return resolved != id_pc.uValue();
+  }
+
+  std::vector<uint8_t> m_bht;
+  std::vector<BTBEntry> m_btb;
+  ReturnAddressStack m_ras;
+  IndirectTargetPredictor m_itp;
+  TargetPredictionConfig m_targetPrediction;
+  // Outcomes of the most recent conditional branches, the latest in the LSB.
+  unsigned m_history = 0;
+  // Updates of the predictor which may be reverted, the latest at the back.
+  std::deque<Update> m_updates;
+  unsigned m_maxUpdates = 100;
+};
+
+} // namespace core
+} // namespace vsrtl
@@ -249,12 +249,19 @@ public:
     reg_wr_src_ctrl << [=] { return do_reg_wr_src_ctrl(opcode.uValue()); };
     alu_op1_ctrl << [=] { return do_alu_op1_ctrl(opcode.uValue()); };
     alu_op2_ctrl << [=] { return do_alu_op2_ctrl(opcode.uValue()); };
-    alu_ctrl << [=] { return do_alu_ctrl(opcode.uValue()); };
+    alu_ctrl << [=] {
+      if (bitmanip_op.uValue() != ALUOp::NOP)
+        return bitmanip_op.uValue();
+      return VSRTL_VT_U(do_alu_ctrl(opcode.uValue()));
+    };
     mem_do_write_ctrl << [=] { return do_do_mem_write_ctrl(opcode.uValue()); };
     mem_do_read_ctrl << [=] { return do_do_read_ctrl(opcode.uValue()); };
   }
 
   INPUTPORT_ENUM(opcode, RVInstr);
+  // The ALU operation of bit-manipulation instructions (see Decode), which
+  // takes precedence over the ALU operation of the opcode.
+  INPUTPORT_ENUM(bitmanip_op, ALUOp);
 
   OUTPUTPORT(reg_do_write_ctrl, 1);
   OUTPUTPORT(mem_do_write_ctrl, 1);
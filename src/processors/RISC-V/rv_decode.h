@@ -1,25 +1,149 @@
 ﻿#pragma once
 
+#include <array>
+
 #include "VSRTL/core/vsrtl_component.h"
 #include "riscv.h"
+#include "rv_bitmanip.h"
 
 namespace vsrtl {
 namespace core {
 using namespace Ripes;
 
+/**
+ * @brief The DecodeCacheStats struct
+ * Hit/miss statistics of a decoded-instruction cache.
+ */
+struct DecodeCacheStats {
+  long long hits = 0;
+  long long misses = 0;
+  double hitRate() const {
+    const long long accesses = hits + misses;
+    return accesses == 0 ? 0.0 : static_cast<double>(hits) / accesses;
+  }
+};
+
+/**
+ * @brief The DecodeCacheCounter class
+ * Counts the accesses to the decoded-instruction cache of a Decode component.
+ * The counters belong to the component, such that they are only modified by
+ * the thread clocking its processor.
+ */
+class DecodeCacheCounter {
+public:
+  virtual ~DecodeCacheCounter() {}
+  const DecodeCacheStats &decodeCacheStats() const { return m_stats; }
+  void resetDecodeCacheStats() { m_stats = DecodeCacheStats(); }
+
+protected:
+  void countDecodeCacheAccess(bool hit) {
+    ++(hit ? m_stats.hits : m_stats.misses);
+  }
+
+private:
+  DecodeCacheStats m_stats;
+};
+
+/// Returns the sum of the decode cache statistics of the Decode components of
+/// @p component and its subcomponents.
+inline DecodeCacheStats decodeCacheStats(const SimComponent &component) {
+  DecodeCacheStats stats;
+  if (auto *counter = dynamic_cast<const DecodeCacheCounter *>(&component)) {
+    stats.hits += counter->decodeCacheStats().hits;
+    stats.misses += counter->decodeCacheStats().misses;
+  }
+  for (const auto &subcomponent : component.getSubComponents()) {
+    const auto sub = decodeCacheStats(*subcomponent);
+    stats.hits += sub.hits;
+    stats.misses += sub.misses;
+  }
+  return stats;
+}
+
+/// Resets the decode cache statistics of the Decode components of
+/// @p component and its subcomponents.
+inline void resetDecodeCacheStats(SimComponent &component) {
+  if (auto *counter = dynamic_cast<DecodeCacheCounter *>(&component))
+    counter->resetDecodeCacheStats();
+  for (const auto &subcomponent : component.getSubComponents())
+    resetDecodeCacheStats(*subcomponent);
+}
+
 template <unsigned XLEN>
-class Decode : public Component {
+class Decode : public Component, public DecodeCacheCounter {
 public:
-  void setISA(const std::shared_ptr<ISAInfoBase> &isa) { m_isa = isa; }
+  void setISA(const std::shared_ptr<ISAInfoBase> &isa) {
+    m_isa = isa;
+    m_extB = isa ? RVBitManip::Extensions(*isa) : RVBitManip::Extensions();
+    // Decoding is dependent on the enabled extensions.
+    m_decodeCache.fill({});
+  }
 
   Decode(const std::string &name, SimComponent *parent)
       : Component(name, parent) {
-    opcode << [=] {
-      const auto instrValue = instr.uValue();
+    opcode << [=] { return decoded(true).opcode; };
+
+    // Accesses are counted once per instruction, by the opcode.
+    bitmanip_op << [=] { return decoded(false).bitmanip; };
+
+    wr_reg_idx << [=] { return (instr.uValue() >> 7) & 0b11111; };
 
+    r1_reg_idx << [=] { return (instr.uValue() >> 15) & 0b11111; };
+
+    r2_reg_idx << [=] { return (instr.uValue() >> 20) & 0b11111; };
+  }
+
+  INPUTPORT(instr, c_RVInstrWidth);
+  OUTPUTPORT_ENUM(opcode, RVInstr);
+  // ALU operation of bit-manipulation instructions, which are decoded as ADD
+  // (register operands) or ADDI (immediate operand). ALUOp::NOP otherwise.
+  OUTPUTPORT_ENUM(bitmanip_op, ALUOp);
+  OUTPUTPORT(wr_reg_idx, c_RVRegsBits);
+  OUTPUTPORT(r1_reg_idx, c_RVRegsBits);
+  OUTPUTPORT(r2_reg_idx, c_RVRegsBits);
+
+private:
+  struct DecodeCacheEntry {
+    bool valid = false;
+    VSRTL_VT_U instr = 0;
+    VSRTL_VT_U opcode = RVInstr::NOP;
+    VSRTL_VT_U bitmanip = ALUOp::NOP;
+  };
+
+  const DecodeCacheEntry &decoded(bool countAccess) {
+    const auto instrValue = instr.uValue();
+    auto &entry = m_decodeCache[decodeCacheIndex(instrValue)];
+    const bool hit = entry.valid && entry.instr == instrValue;
+    if (countAccess)
+      countDecodeCacheAccess(hit);
+    if (hit)
+      return entry;
+    entry = {true, instrValue, RVInstr::NOP, ALUOp::NOP};
+    if (m_extB.any())
+      entry.bitmanip = RVBitManip::decode<XLEN>(instrValue, m_extB);
+    if (entry.bitmanip == ALUOp::NOP) {
+      entry.opcode = decodeInstr(instrValue);
+    } else {
       const unsigned l7 = instrValue & 0b1111111;
+      entry.opcode = l7 == RVISA::OpcodeID::OP || l7 == RVISA::OpcodeID::OP32
+                         ? RVInstr::ADD
+                         : RVInstr::ADDI;
+    }
+    return entry;
+  }
+
+  static constexpr unsigned c_decodeCacheEntries = 1024;
+  static unsigned decodeCacheIndex(VSRTL_VT_U instrValue) {
+    // The low opcode bits are (nearly) constant for uncompressed instructions;
+    // index by the register and immediate fields instead.
+    return ((instrValue >> 7) ^ (instrValue >> 17)) &
+           (c_decodeCacheEntries - 1);
+  }
 
-      // clang-format off
+  VSRTL_VT_U decodeInstr(VSRTL_VT_U instrValue) const {
+    const unsigned l7 = instrValue & 0b1111111;
+
+    // clang-format off
             switch(l7) {
             case RVISA::OpcodeID::LUI: return RVInstr::LUI;
             case RVISA::OpcodeID::AUIPC: return RVInstr::AUIPC;
@@ -203,32 +327,21 @@ public:
 
             // Fallthrough - unknown instruction.
             return RVInstr::NOP;
-        };
-
-        wr_reg_idx << [=] {
-          return (instr.uValue() >> 7) & 0b11111;
-        };
-
-        r1_reg_idx << [=] {
-          return (instr.uValue() >> 15) & 0b11111;
-        };
-
-        r2_reg_idx << [=] {
-          return (instr.uValue() >> 20) & 0b11111;
-        };
-
     // clang-format on
   }
 
-  INPUTPORT(instr, c_RVInstrWidth);
-  OUTPUTPORT_ENUM(opcode, RVInstr);
-  OUTPUTPORT(wr_reg_idx, c_RVRegsBits);
-  OUTPUTPORT(r1_reg_idx, c_RVRegsBits);
-  OUTPUTPORT(r2_reg_idx, c_RVRegsBits);
-
-private:
   void unknownInstruction() {}
   std::shared_ptr<ISAInfoBase> m_isa;
+  RVBitManip::Extensions m_extB;
+
+  /**
+   * @brief m_decodeCache
+   * Direct-mapped cache of decoded instructions, tagged by the instruction
+   * word. Decoding is a pure function of the instruction word (and the ISA),
+   * so entries never have to be invalidated on writes to instruction memory;
+   * a modified instruction simply results in a tag mismatch.
+   */
+  std::array<DecodeCacheEntry, c_decodeCacheEntries> m_decodeCache;
 };
 
 } // namespace core
@@ -0,0 +1,34 @@
+#pragma once
+
+namespace Ripes {
+
+/**
+ * @brief The FetchQueueConfig struct
+ * Configuration of a fetch queue decoupling the fetch of a pipeline from its
+ * decode. The fetch unit fetches whole lines of @p lineBytes bytes, queueing
+ * their instructions, and the pipeline takes its instructions from the queue.
+ * A miss of the instruction cache thereby delays the fetch unit, rather than
+ * stalling the pipeline, until the queue runs empty. 0 entries disables the
+ * queue, such that the pipeline fetches a single instruction per cycle.
+ */
+struct FetchQueueConfig {
+  unsigned entries = 0;
+  // Rounded down to a power of two, of at least 4 bytes.
+  unsigned lineBytes = 16;
+  bool operator==(const FetchQueueConfig &other) const {
+    return entries == other.entries && lineBytes == other.lineBytes;
+  }
+};
+
+/**
+ * @brief The FetchQueueProcessor class
+ * Interface of processor models with a configurable fetch queue.
+ */
+class FetchQueueProcessor {
+public:
+  virtual ~FetchQueueProcessor() {}
+  virtual void setFetchQueue(const FetchQueueConfig &config) = 0;
+  virtual const FetchQueueConfig &fetchQueue() const = 0;
+};
+
+} // namespace Ripes
@@ -0,0 +1,551 @@
+#pragma once
+
+#include <array>
+#include <cfenv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <type_traits>
+
+namespace Ripes {
+
+namespace RVFloat {
+
+/// Accrued exception flags of the fflags register.
+enum Flags : unsigned { NX = 1, UF = 2, OF = 4, DZ = 8, NV = 16 };
+/// Rounding modes of the rm field and of the frm register.
+enum RoundingMode : unsigned { RNE = 0, RTZ = 1, RDN = 2, RUP = 3, RMM = 4 };
+/// Addresses of the floating-point control and status registers.
+enum CSR : unsigned { FFLAGS = 0x001, FRM = 0x002, FCSR = 0x003 };
+
+template <typename T>
+using Bits = std::conditional_t<std::is_same_v<T, float>, uint32_t, uint64_t>;
+
+template <typename T>
+inline Bits<T> toBits(T v) {
+  Bits<T> bits;
+  std::memcpy(&bits, &v, sizeof(v));
+  return bits;
+}
+template <typename T>
+inline T fromBits(Bits<T> bits) {
+  T v;
+  std::memcpy(&v, &bits, sizeof(v));
+  return v;
+}
+
+template <typename T>
+constexpr Bits<T> signBit() {
+  return Bits<T>(1) << (sizeof(T) * 8 - 1);
+}
+/// The canonical NaN of RISC-V, which is written by all operations yielding a
+/// NaN.
+template <typename T>
+constexpr Bits<T> canonicalNaN() {
+  return std::is_same_v<T, float> ? Bits<T>(0x7fc00000)
+                                  : Bits<T>(0x7ff8000000000000);
+}
+template <typename T>
+constexpr Bits<T> quietBit() {
+  return std::is_same_v<T, float> ? Bits<T>(1) << 22 : Bits<T>(1) << 51;
+}
+
+template <typename T>
+inline bool isSignaling(T v) {
+  return std::isnan(v) && !(toBits(v) & quietBit<T>());
+}
+
+/**
+ * @brief classify
+ * Returns the class of @p v as by fclass: a mask with a single bit set, for
+ * (from bit 0) negative infinity, negative normal, negative subnormal,
+ * negative zero, positive zero, positive subnormal, positive normal, positive
+ * infinity, signaling NaN and quiet NaN.
+ */
+template <typename T>
+inline unsigned classify(T v) {
+  const bool negative = std::signbit(v);
+  switch (std::fpclassify(v)) {
+  case FP_INFINITE:
+    return negative ? 1u << 0 : 1u << 7;
+  case FP_NORMAL:
+    return negative ? 1u << 1 : 1u << 6;
+  case FP_SUBNORMAL:
+    return negative ? 1u << 2 : 1u << 5;
+  case FP_ZERO:
+    return negative ? 1u << 3 : 1u << 4;
+  default:
+    return isSignaling(v) ? 1u << 8 : 1u << 9;
+  }
+}
+
+/**
+ * @brief The RoundingScope class
+ * Sets the rounding mode of the host to the RISC-V rounding mode @p rm for the
+ * lifetime of the scope. Round to nearest, ties to max magnitude (RMM) has no
+ * host equivalent, and rounds to nearest, ties to even. The host is left in
+ * its default rounding mode (to nearest) outside of the scope.
+ *
+ * The tree is compiled with -frounding-math (/fp:strict on MSVC), such that
+ * floating-point operations are neither folded nor moved across the changes
+ * of the rounding mode and the reads of the exception flags.
+ */
+class RoundingScope {
+public:
+  explicit RoundingScope(unsigned rm) : m_changed(rm != RNE && rm != RMM) {
+    if (!m_changed)
+      return;
+    static constexpr int c_hostModes[] = {FE_TONEAREST, FE_TOWARDZERO,
+                                          FE_DOWNWARD, FE_UPWARD};
+    std::fesetround(c_hostModes[rm]);
+  }
+  ~RoundingScope() {
+    if (m_changed)
+      std::fesetround(FE_TONEAREST);
+  }
+  RoundingScope(const RoundingScope &) = delete;
+  RoundingScope &operator=(const RoundingScope &) = delete;
+
+private:
+  const bool m_changed;
+};
+
+/// Returns the fflags raised by the host since the flags were last cleared.
+inline unsigned hostFlags() {
+  const int raised = std::fetestexcept(FE_ALL_EXCEPT);
+  return ((raised & FE_INEXACT) ? unsigned(NX) : 0u) |
+         ((raised & FE_UNDERFLOW) ? unsigned(UF) : 0u) |
+         ((raised & FE_OVERFLOW) ? unsigned(OF) : 0u) |
+         ((raised & FE_DIVBYZERO) ? unsigned(DZ) : 0u) |
+         ((raised & FE_INVALID) ? unsigned(NV) : 0u);
+}
+
+} // namespace RVFloat
+
+/**
+ * @brief The RVFloatUnit class
+ * The floating-point registers and the fcsr register of the single- (F) and
+ * double-precision (D) extensions, and the execution of their arithmetic
+ * instructions through the IEEE 754 arithmetic of the host.
+ *
+ * Operations are performed in the rounding mode of the instruction, set on
+ * the host for the duration of the operation, and the exceptions raised on the
+ * host accrue in fflags. Results which are NaNs are written as the canonical
+ * NaN. Operations for which the host arithmetic differs from RISC-V (minimum
+ * and maximum, comparisons, classification, sign injection and conversions to
+ * integers) are implemented on the values or bits of the operands. Arithmetic
+ * rounded to nearest with ties to max magnitude (RMM) is rounded with ties to
+ * even, except for conversions to integers.
+ *
+ * The registers are FLEN bits wide, where FLEN is 64 if the D extension is
+ * enabled and 32 otherwise. With the D extension, single-precision values are
+ * NaN-boxed: their upper 32 bits are set, and single-precision operands which
+ * are not NaN-boxed are read as the canonical NaN.
+ */
+class RVFloatUnit {
+public:
+  static constexpr unsigned c_fregs = 32;
+
+  struct State {
+    std::array<uint64_t, c_fregs> regs{};
+    uint8_t frm = 0;
+    uint8_t fflags = 0;
+  };
+
+  /// Sets whether the D extension is enabled, and resets the unit.
+  void setDouble(bool enabled) {
+    m_double = enabled;
+    reset();
+  }
+  bool isDouble() const { return m_double; }
+
+  void reset() { m_state = State(); }
+  const State &state() const { return m_state; }
+  void restore(const State &state) { m_state = state; }
+
+  uint64_t reg(unsigned i) const { return m_state.regs.at(i); }
+  void setReg(unsigned i, uint64_t v) {
+    m_state.regs.at(i) = m_double ? v : v & 0xFFFFFFFF;
+  }
+
+  /// Returns the value of the floating-point CSR @p csr, or nothing if @p csr
+  /// is not a floating-point CSR.
+  std::optional<uint64_t> readCSR(unsigned csr) const {
+    switch (csr) {
+    case RVFloat::FFLAGS:
+      return m_state.fflags;
+    case RVFloat::FRM:
+      return m_state.frm;
+    case RVFloat::FCSR:
+      return (m_state.frm << 5) | m_state.fflags;
+    default:
+      return {};
+    }
+  }
+  /// Writes @p value to the floating-point CSR @p csr. Returns false if
+  /// @p csr is not a floating-point CSR.
+  bool writeCSR(unsigned csr, uint64_t value) {
+    switch (csr) {
+    case RVFloat::FFLAGS:
+      m_state.fflags = value & 0x1F;
+      return true;
+    case RVFloat::FRM:
+      m_state.frm = value & 0x7;
+      return true;
+    case RVFloat::FCSR:
+      m_state.fflags = value & 0x1F;
+      m_state.frm = (value >> 5) & 0x7;
+      return true;
+    default:
+      return false;
+    }
+  }
+
+  /// Returns the bits stored by fsw (@p isDouble = false) or fsd from register
+  /// @p i.
+  uint64_t storeValue(unsigned i, bool isDouble) const {
+    return isDouble ? m_state.regs.at(i) : m_state.regs.at(i) & 0xFFFFFFFF;
+  }
+  /// Writes the bits loaded by flw (@p isDouble = false) or fld to register
+  /// @p i.
+  void load(unsigned i, uint64_t bits, bool isDouble) {
+    if (isDouble)
+      m_state.regs.at(i) = bits;
+    else
+      writeBits<float>(i, static_cast<uint32_t>(bits));
+  }
+
+  /// Returns whether the unit executes instructions of format @p fmt:
+  /// single-precision (0), or double-precision (1) with the D extension.
+  bool executes(unsigned fmt) const {
+    return fmt == 0 || (fmt == 1 && m_double);
+  }
+
+  /**
+   * @brief execute
+   * Executes the OP-FP or fused multiply-add instruction @p instr, with @p x
+   * the value of integer register rs1 (for moves and conversions from
+   * integers), on a processor of @p xlen bits. Returns the value written to
+   * integer register rd, if any, sign-extended to 64 bits. Unknown
+   * instructions, and instructions with reserved rounding modes, are executed
+   * as nops.
+   */
+  std::optional<uint64_t> execute(uint32_t instr, uint64_t x, unsigned xlen) {
+    const unsigned fmt = (instr >> 25) & 0b11;
+    if (!executes(fmt))
+      return {};
+    return fmt == 0 ? executeFmt<float>(instr, x, xlen)
+                    : executeFmt<double>(instr, x, xlen);
+  }
+
+private:
+  template <typename T>
+  T readReg(unsigned i) const {
+    const uint64_t bits = m_state.regs[i];
+    if constexpr (std::is_same_v<T, float>) {
+      if (m_double && (bits >> 32) != 0xFFFFFFFF)
+        return RVFloat::fromBits<float>(RVFloat::canonicalNaN<float>());
+      return RVFloat::fromBits<float>(static_cast<uint32_t>(bits));
+    } else {
+      return RVFloat::fromBits<double>(bits);
+    }
+  }
+  template <typename T>
+  void writeBits(unsigned i, RVFloat::Bits<T> bits) {
+    if constexpr (std::is_same_v<T, float>)
+      m_state.regs[i] = m_double ? 0xFFFFFFFF00000000 | bits : bits;
+    else
+      m_state.regs[i] = bits;
+  }
+  /// Writes @p v to register @p i, canonicalizing NaNs.
+  template <typename T>
+  void writeReg(unsigned i, T v) {
+    writeBits<T>(i, std::isnan(v) ? RVFloat::canonicalNaN<T>()
+                                  : RVFloat::toBits(v));
+  }
+
+  /// Returns the rounding mode of @p instr, resolving dynamic rounding, or
+  /// nothing if the rounding mode is reserved.
+  std::optional<unsigned> roundingMode(uint32_t instr) const {
+    unsigned rm = (instr >> 12) & 0b111;
+    if (rm == 0b111)
+      rm = m_state.frm;
+    if (rm > RVFloat::RMM)
+      return {};
+    return rm;
+  }
+
+  /// Computes @p op in rounding mode @p rm, accruing the exceptions it
+  /// raises. The operands of @p op are to be read through volatile copies,
+  /// such that the operation is not moved out of the rounding scope.
+  template <typename R, typename Op>
+  R compute(unsigned rm, Op op) {
+    std::feclearexcept(FE_ALL_EXCEPT);
+    volatile R result;
+    {
+      RVFloat::RoundingScope scope(rm);
+      result = op();
+    }
+    m_state.fflags |= RVFloat::hostFlags();
+    return result;
+  }
+
+  /// Converts @p v to the integer type I as by fcvt.{w,wu,l,lu}: rounded in
+  /// @p rm, and saturated if out of range, in which case NV is raised; NaNs
+  /// convert to the maximum integer.
+  template <typename I, typename T>
+  I toInteger(T v, unsigned rm) {
+    constexpr int bits = std::numeric_limits<I>::digits +
+                         (std::numeric_limits<I>::is_signed ? 1 : 0);
+    if (std::isnan(v)) {
+      m_state.fflags |= RVFloat::NV;
+      return std::numeric_limits<I>::max();
+    }
+    T rounded;
+    if (rm == RVFloat::RMM) {
+      rounded = std::round(v);
+    } else {
+      RVFloat::RoundingScope scope(rm);
+      volatile T operand = v;
+      volatile T result = std::nearbyint(operand);
+      rounded = result;
+    }
+    const T upper = std::ldexp(T(1), std::numeric_limits<I>::is_signed
+                                         ? bits - 1
+                                         : bits);
+    const T lower = std::numeric_limits<I>::is_signed ? -upper : T(0);
+    if (rounded < lower || rounded >= upper) {
+      m_state.fflags |= RVFloat::NV;
+      return v < 0 ? std::numeric_limits<I>::min()
+                   : std::numeric_limits<I>::max();
+    }
+    if (rounded != v)
+      m_state.fflags |= RVFloat::NX;
+    return static_cast<I>(rounded);
+  }
+
+  /// Returns the minimum (@p max = false) or maximum of @p a and @p b as by
+  /// fmin and fmax: -0 is less than +0, and NaN operands are ignored, unless
+  /// both are NaN. Signaling NaNs raise NV.
+  template <typename T>
+  T minMax(T a, T b, bool max) {
+    if (RVFloat::isSignaling(a) || RVFloat::isSignaling(b))
+      m_state.fflags |= RVFloat::NV;
+    if (std::isnan(a) && std::isnan(b))
+      return RVFloat::fromBits<T>(RVFloat::canonicalNaN<T>());
+    if (std::isnan(a))
+      return b;
+    if (std::isnan(b))
+      return a;
+    if (a == b)
+      return (std::signbit(a) != max) ? a : b;
+    return (a < b) != max ? a : b;
+  }
+
+  /// Compares @p a and @p b as by feq (@p funct3 = 0b010), flt (0b001) or fle
+  /// (0b000). All NaN operands raise NV for flt and fle, and signaling NaN
+  /// operands for feq.
+  template <typename T>
+  uint64_t compare(T a, T b, unsigned funct3) {
+    if (std::isnan(a) || std::isnan(b)) {
+      if (funct3 != 0b010 || RVFloat::isSignaling(a) ||
+          RVFloat::isSignaling(b))
+        m_state.fflags |= RVFloat::NV;
+      return 0;
+    }
+    switch (funct3) {
+    case 0b010:
+      return a == b;
+    case 0b001:
+      return a < b;
+    default:
+      return a <= b;
+    }
+  }
+
+  template <typename T>
+  std::optional<uint64_t> executeFmt(uint32_t instr, uint64_t x,
+                                     unsigned xlen) {
+    using U = RVFloat::Bits<T>;
+    const unsigned opcode = instr & 0x7F;
+    const unsigned rd = (instr >> 7) & 0x1F;
+    const unsigned funct3 = (instr >> 12) & 0b111;
+    const unsigned rs1 = (instr >> 15) & 0x1F;
+    const unsigned rs2 = (instr >> 20) & 0x1F;
+    const unsigned funct5 = instr >> 27;
+    const T a = readReg<T>(rs1);
+    const T b = readReg<T>(rs2);
+    const auto rm = roundingMode(instr);
+
+    if (opcode != 0b1010011) {
+      // Fused multiply-adds: fmadd, fmsub, fnmsub and fnmadd.
+      if (!rm)
+        return {};
+      const T c = readReg<T>(instr >> 27);
+      const bool negateProduct = opcode == 0b1001011 || opcode == 0b1001111;
+      const bool negateAddend = opcode == 0b1000111 || opcode == 0b1001111;
+      writeReg(rd, compute<T>(*rm, [&] {
+                 volatile T va = negateProduct ? -a : a, vb = b;
+                 volatile T vc = negateAddend ? -c : c;
+                 return std::fma(va, vb, vc);
+               }));
+      return {};
+    }
+
+    const auto rounded = [&](auto op) {
+      if (rm)
+        writeReg(rd, compute<T>(*rm, op));
+    };
+    switch (funct5) {
+    case 0b00000: // fadd
+      rounded([&] {
+        volatile T va = a, vb = b;
+        return va + vb;
+      });
+      return {};
+    case 0b00001: // fsub
+      rounded([&] {
+        volatile T va = a, vb = b;
+        return va - vb;
+      });
+      return {};
+    case 0b00010: // fmul
+      rounded([&] {
+        volatile T va = a, vb = b;
+        return va * vb;
+      });
+      return {};
+    case 0b00011: // fdiv
+      rounded([&] {
+        volatile T va = a, vb = b;
+        return va / vb;
+      });
+      return {};
+    case 0b01011: // fsqrt
+      rounded([&] {
+        volatile T va = a;
+        return std::sqrt(va);
+      });
+      return {};
+    case 0b00100: { // fsgnj, fsgnjn, fsgnjx
+      const U bitsA = RVFloat::toBits(a);
+      const U bitsB = RVFloat::toBits(b);
+      const U sign = RVFloat::signBit<T>();
+      U bits = bitsA & ~sign;
+      if (funct3 == 0b000)
+        bits |= bitsB & sign;
+      else if (funct3 == 0b001)
+        bits |= ~bitsB & sign;
+      else if (funct3 == 0b010)
+        bits |= (bitsA ^ bitsB) & sign;
+      else
+        return {};
+      writeBits<T>(rd, bits);
+      return {};
+    }
+    case 0b00101: // fmin, fmax
+      if (funct3 > 0b001)
+        return {};
+      writeBits<T>(rd, RVFloat::toBits(minMax(a, b, funct3 == 0b001)));
+      return {};
+    case 0b01000: { // fcvt.s.d, fcvt.d.s
+      if (!rm)
+        return {};
+      if constexpr (std::is_same_v<T, float>) {
+        if (rs2 != 1 || !m_double)
+          return {};
+        const double d = readReg<double>(rs1);
+        writeReg(rd, compute<float>(*rm, [&] {
+                   volatile double vd = d;
+                   return static_cast<float>(vd);
+                 }));
+      } else {
+        if (rs2 != 0)
+          return {};
+        const float f = readReg<float>(rs1);
+        writeReg(rd, compute<double>(*rm, [&] {
+                   volatile float vf = f;
+                   return static_cast<double>(vf);
+                 }));
+      }
+      return {};
+    }
+    case 0b10100: // feq, flt, fle
+      if (funct3 > 0b010)
+        return {};
+      return compare(a, b, funct3);
+    case 0b11000: // fcvt.{w,wu,l,lu}.fmt
+      if (!rm || (rs2 > 1 && xlen == 32))
+        return {};
+      switch (rs2) {
+      case 0:
+        return static_cast<uint64_t>(
+            static_cast<int64_t>(toInteger<int32_t>(a, *rm)));
+      case 1:
+        // 32-bit results are sign-extended.
+        return static_cast<uint64_t>(static_cast<int64_t>(
+            static_cast<int32_t>(toInteger<uint32_t>(a, *rm))));
+      case 2:
+        return static_cast<uint64_t>(toInteger<int64_t>(a, *rm));
+      case 3:
+        return toInteger<uint64_t>(a, *rm);
+      default:
+        return {};
+      }
+    case 0b11010: { // fcvt.fmt.{w,wu,l,lu}
+      if (!rm || rs2 > 3 || (rs2 > 1 && xlen == 32))
+        return {};
+      writeReg(rd, compute<T>(*rm, [&]() -> T {
+                 switch (rs2) {
+                 case 0: {
+                   volatile int32_t v = static_cast<int32_t>(x);
+                   return static_cast<T>(v);
+                 }
+                 case 1: {
+                   volatile uint32_t v = static_cast<uint32_t>(x);
+                   return static_cast<T>(v);
+                 }
+                 case 2: {
+                   volatile int64_t v = static_cast<int64_t>(x);
+                   return static_cast<T>(v);
+                 }
+                 default: {
+                   volatile uint64_t v = x;
+                   return static_cast<T>(v);
+                 }
+                 }
+               }));
+      return {};
+    }
+    case 0b11100: // fmv.x.{w,d}, fclass
+      if (rs2 != 0)
+        return {};
+      if (funct3 == 0b001)
+        return RVFloat::classify(a);
+      if (funct3 != 0b000 || (!std::is_same_v<T, float> && xlen == 32))
+        return {};
+      if constexpr (std::is_same_v<T, float>) {
+        // The raw bits are moved, regardless of NaN-boxing.
+        return static_cast<uint64_t>(static_cast<int64_t>(
+            static_cast<int32_t>(m_state.regs[rs1])));
+      } else {
+        return m_state.regs[rs1];
+      }
+    case 0b11110: // fmv.{w,d}.x
+      if (rs2 != 0 || funct3 != 0b000 ||
+          (!std::is_same_v<T, float> && xlen == 32))
+        return {};
+      writeBits<T>(rd, static_cast<U>(x));
+      return {};
+    default:
+      return {};
+    }
+  }
+
+  bool m_double = false;
+  State m_state;
+};
+
+} // namespace Ripes
@@ -1,15 +1,47 @@
 #pragma once
 
 #include "../../binutils.h"
+#include <array>
 #include <assert.h>
 #include <functional>
 #include <numeric>
 
 namespace Ripes {
 
+/**
+ * @brief The InstrFields struct
+ * Compile-time instruction field parser of a word of type T, split into fields
+ * of @p Widths bits from LSB to MSB. parse() returns the fields from MSB to
+ * LSB, matching the order of the fields returned by generateInstrParser,
+ * without allocating.
+ */
+template <typename T, unsigned... Widths>
+struct InstrFields {
+  static constexpr unsigned size_bits = sizeof(T) * CHAR_BIT;
+  static constexpr unsigned count = sizeof...(Widths);
+  static_assert(isPowerOf2(size_bits) && size_bits >= 32,
+                "Invalid word size parameter");
+  static_assert((Widths + ...) == size_bits,
+                "Requested word parsing format is not T-bits in length");
+
+  static constexpr std::array<T, count> parse(T word) {
+    constexpr std::array<unsigned, count> widths = {Widths...};
+    std::array<T, count> fields{};
+    for (unsigned i = 0; i < count; ++i) {
+      const unsigned width = widths[i];
+      const T mask = width >= size_bits ? ~T(0) : (T(1) << width) - 1;
+      fields[count - 1 - i] = word & mask;
+      word = width >= size_bits ? T(0) : T(word >> width);
+    }
+    return fields;
+  }
+};
+
 template <typename T>
 using decode_functor = std::function<std::vector<T>(T)>;
 
+/// Generates a parser of a word format given at run time. Fixed formats should
+/// use InstrFields instead.
 template <typename T>
 decode_functor<T> generateInstrParser(const std::vector<int> &bitFields) {
   constexpr int size_bits = sizeof(T) * CHAR_BIT;
@@ -91,6 +91,12 @@ public:
                                   XLEN / CHAR_BIT);
   }
 
+  /// Returns a mask of the register written by the pending (current-cycle)
+  /// write of the register file, if any.
+  uint64_t pendingWriteMask() const {
+    return wr_en_0.uValue() ? uint64_t(1) << wr_addr.uValue() : 0;
+  }
+
   std::vector<VSRTL_VT_U> getRegisters() {
     std::vector<VSRTL_VT_U> regs;
     for (int i = 0; i < c_RVRegs; ++i)
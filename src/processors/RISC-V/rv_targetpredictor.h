@@ -0,0 +1,223 @@
+#pragma once
+
+#include <algorithm>
+#include <optional>
+#include <vector>
+
+#include "../../isa/isa_types.h"
+
+namespace Ripes {
+
+/**
+ * @brief The TargetPredictionConfig struct
+ * Sizes of the optional target predictors of a branch predictor: a
+ * return-address stack predicting the targets of returns, and an
+ * indirect-target predictor predicting the targets of the other indirect
+ * jumps. A size of 0 disables the predictor, such that the targets of these
+ * jumps are predicted by the branch target buffer as their last target.
+ */
+struct TargetPredictionConfig {
+  unsigned rasEntries = 0;
+  // Rounded down to a power of two.
+  unsigned indirectEntries = 0;
+  bool operator==(const TargetPredictionConfig &other) const {
+    return rasEntries == other.rasEntries &&
+           indirectEntries == other.indirectEntries;
+  }
+};
+
+/**
+ * @brief The TargetPredictionProcessor class
+ * Interface of processor models with configurable target predictors.
+ */
+class TargetPredictionProcessor {
+public:
+  virtual ~TargetPredictionProcessor() {}
+  virtual void setTargetPrediction(const TargetPredictionConfig &config) = 0;
+  virtual const TargetPredictionConfig &targetPrediction() const = 0;
+};
+
+/**
+ * @brief The JumpHints struct
+ * The use of the return-address stack hinted by a jump, given by its link
+ * registers (x1 and x5) as specified by the ISA: a jump writing a link
+ * register is a call, pushing its return address, and a jalr reading a link
+ * register other than the one it writes is a return, popping the address it
+ * returns to. A jalr which does both swaps coroutines.
+ */
+struct JumpHints {
+  bool push = false;
+  bool pop = false;
+  // Indirect jumps which are not returns.
+  bool indirect = false;
+
+  static JumpHints of(bool jalr, unsigned rd, unsigned rs1) {
+    const auto isLink = [](unsigned reg) { return reg == 1 || reg == 5; };
+    JumpHints hints;
+    hints.push = isLink(rd);
+    if (jalr) {
+      hints.pop = isLink(rs1) && (!isLink(rd) || rd != rs1);
+      hints.indirect = !hints.pop;
+    }
+    return hints;
+  }
+};
+
+/**
+ * @brief The ReturnAddressStack class
+ * Circular stack of return addresses. Pushing onto a full stack overwrites its
+ * oldest entry, and popping an empty stack has no effect.
+ */
+class ReturnAddressStack {
+public:
+  /// State overwritten by an update, with which the update is reverted.
+  struct Undo {
+    unsigned top = 0;
+    unsigned size = 0;
+    unsigned slot = 0;
+    AInt value = 0;
+  };
+
+  /// Sets the number of entries of the stack, and clears it.
+  void resize(unsigned entries) {
+    m_entries.assign(entries, 0);
+    clear();
+  }
+  void clear() {
+    m_top = 0;
+    m_size = 0;
+  }
+  bool enabled() const { return !m_entries.empty(); }
+
+  /// Returns the entry @p depth entries below the top of the stack.
+  std::optional<AInt> peek(unsigned depth = 0) const {
+    if (depth >= m_size)
+      return {};
+    const unsigned n = m_entries.size();
+    return m_entries.at((m_top + n - depth) % n);
+  }
+
+  /// Pops the stack if @p pop, and then pushes @p address if @p push.
+  Undo update(bool pop, bool push, AInt address) {
+    Undo undo{m_top, m_size, m_top, AInt(0)};
+    if (!enabled())
+      return undo;
+    undo.value = m_entries[m_top];
+    const unsigned n = m_entries.size();
+    if (pop && m_size > 0) {
+      m_top = (m_top + n - 1) % n;
+      m_size--;
+    }
+    if (push) {
+      m_top = (m_top + 1) % n;
+      m_size = std::min<unsigned>(m_size + 1, n);
+      undo.slot = m_top;
+      undo.value = m_entries[m_top];
+      m_entries[m_top] = address;
+    }
+    return undo;
+  }
+
+  void revert(const Undo &undo) {
+    if (!enabled())
+      return;
+    m_entries[undo.slot] = undo.value;
+    m_top = undo.top;
+    m_size = undo.size;
+  }
+
+private:
+  std::vector<AInt> m_entries;
+  unsigned m_top = 0;
+  unsigned m_size = 0;
+};
+
+/**
+ * @brief The IndirectTargetPredictor class
+ * Tagged table of the targets of indirect jumps, indexed by the address of the
+ * jump XOR'ed with the history of the targets of the preceding indirect jumps.
+ * Unlike the branch target buffer, which predicts the last target of a jump,
+ * the table predicts the targets of jumps whose target follows from the path
+ * taken to them, such as the dispatch of an interpreter or a switch statement.
+ */
+class IndirectTargetPredictor {
+public:
+  struct Undo {
+    bool valid = false;
+    unsigned index = 0;
+    AInt tag = 0;
+    AInt target = 0;
+    bool entryValid = false;
+    unsigned history = 0;
+  };
+
+  /// Sets the number of entries of the table, rounded down to a power of two,
+  /// and clears it.
+  void resize(unsigned entries) {
+    unsigned size = 0;
+    while (entries >> (size + 1))
+      size++;
+    m_entries.assign(entries != 0 ? 1u << size : 0, Entry());
+    m_history = 0;
+  }
+  void clear() { resize(m_entries.size()); }
+  bool enabled() const { return !m_entries.empty(); }
+
+  unsigned history() const { return m_history; }
+  /// Returns the history following an indirect jump to @p target.
+  static unsigned nextHistory(unsigned history, AInt target) {
+    return ((history << 2) ^ (target >> 1)) & c_historyMask;
+  }
+
+  /// Predicts the target of the jump at @p pc, given the target history
+  /// @p history.
+  std::optional<AInt> predict(AInt pc, unsigned history) const {
+    if (!enabled())
+      return {};
+    const Entry &entry = m_entries.at(index(pc, history));
+    if (!entry.valid || entry.tag != pc)
+      return {};
+    return entry.target;
+  }
+
+  /// Trains the table on the jump at @p pc to @p target.
+  Undo update(AInt pc, AInt target) {
+    Undo undo;
+    undo.history = m_history;
+    if (!enabled())
+      return undo;
+    undo.valid = true;
+    undo.index = index(pc, m_history);
+    Entry &entry = m_entries[undo.index];
+    undo.entryValid = entry.valid;
+    undo.tag = entry.tag;
+    undo.target = entry.target;
+    entry = {true, pc, target};
+    m_history = nextHistory(m_history, target);
+    return undo;
+  }
+
+  void revert(const Undo &undo) {
+    m_history = undo.history;
+    if (undo.valid)
+      m_entries[undo.index] = {undo.entryValid, undo.tag, undo.target};
+  }
+
+private:
+  static constexpr unsigned c_historyMask = 0xFFFF;
+
+  struct Entry {
+    bool valid = false;
+    AInt tag = 0;
+    AInt target = 0;
+  };
+
+  unsigned index(AInt pc, unsigned history) const {
+    return ((pc >> 1) ^ history) & (m_entries.size() - 1);
+  }
+
+  std::vector<Entry> m_entries;
+  unsigned m_history = 0;
+};
+
+} // namespace Ripes
@@ -0,0 +1,1106 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#if defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace Ripes {
+
+/**
+ * @brief The VectorProcessor class
+ * Interface of processor models implementing the vector (V) extension, whose
+ * vector register length is configurable.
+ */
+class VectorProcessor {
+public:
+  virtual ~VectorProcessor() {}
+  /// Sets the length in bits of the vector registers (VLEN), clearing them.
+  virtual void setVLEN(unsigned bits) = 0;
+  virtual unsigned vlen() const = 0;
+};
+
+namespace RVVector {
+
+/**
+ * Element loops operate on 16-byte blocks of the vector registers through the
+ * SIMD instructions of the host (SSE2, SSE4.1 or NEON) where the host has an
+ * instruction for the operation at the element width, and on single elements
+ * otherwise, including the elements following the last full block.
+ *
+ * Elements are accessed in host byte order, such that unit-stride loads and
+ * stores are plain copies of bytes on little-endian hosts.
+ */
+constexpr unsigned c_blockBytes = 16;
+
+#if defined(__SSE2__) || defined(_M_X64)
+using Block = __m128i;
+constexpr bool c_simd = true;
+
+inline Block loadBlock(const uint8_t *p) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+}
+inline void storeBlock(uint8_t *p, Block b) {
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(p), b);
+}
+template <typename T>
+inline Block splat(T v) {
+  if constexpr (sizeof(T) == 1)
+    return _mm_set1_epi8(static_cast<char>(v));
+  else if constexpr (sizeof(T) == 2)
+    return _mm_set1_epi16(static_cast<short>(v));
+  else if constexpr (sizeof(T) == 4)
+    return _mm_set1_epi32(static_cast<int>(v));
+  else
+    return _mm_set1_epi64x(static_cast<long long>(v));
+}
+template <typename T>
+inline Block add(Block a, Block b) {
+  if constexpr (sizeof(T) == 1)
+    return _mm_add_epi8(a, b);
+  else if constexpr (sizeof(T) == 2)
+    return _mm_add_epi16(a, b);
+  else if constexpr (sizeof(T) == 4)
+    return _mm_add_epi32(a, b);
+  else
+    return _mm_add_epi64(a, b);
+}
+template <typename T>
+inline Block sub(Block a, Block b) {
+  if constexpr (sizeof(T) == 1)
+    return _mm_sub_epi8(a, b);
+  else if constexpr (sizeof(T) == 2)
+    return _mm_sub_epi16(a, b);
+  else if constexpr (sizeof(T) == 4)
+    return _mm_sub_epi32(a, b);
+  else
+    return _mm_sub_epi64(a, b);
+}
+inline Block bitAnd(Block a, Block b) { return _mm_and_si128(a, b); }
+inline Block bitOr(Block a, Block b) { return _mm_or_si128(a, b); }
+inline Block bitXor(Block a, Block b) { return _mm_xor_si128(a, b); }
+
+/// Whether the host multiplies elements of type T (the low half of the
+/// product).
+template <typename T>
+constexpr bool hasMul() {
+#if defined(__SSE4_1__)
+  return sizeof(T) == 2 || sizeof(T) == 4;
+#else
+  return sizeof(T) == 2;
+#endif
+}
+template <typename T>
+inline Block mul(Block a, Block b) {
+  static_assert(hasMul<T>(), "Unsupported element type");
+#if defined(__SSE4_1__)
+  if constexpr (sizeof(T) == 4)
+    return _mm_mullo_epi32(a, b);
+  else
+#endif
+    return _mm_mullo_epi16(a, b);
+}
+
+/// Whether the host computes the minimum and maximum of (signed) elements of
+/// type T.
+template <typename T, bool isSigned>
+constexpr bool hasMinMax() {
+#if defined(__SSE4_1__)
+  return sizeof(T) <= 4;
+#else
+  return (sizeof(T) == 1 && !isSigned) || (sizeof(T) == 2 && isSigned);
+#endif
+}
+template <typename T, bool isSigned>
+inline Block min(Block a, Block b) {
+  static_assert(hasMinMax<T, isSigned>(), "Unsupported element type");
+  if constexpr (sizeof(T) == 1 && !isSigned)
+    return _mm_min_epu8(a, b);
+  else if constexpr (sizeof(T) == 2 && isSigned)
+    return _mm_min_epi16(a, b);
+#if defined(__SSE4_1__)
+  else if constexpr (sizeof(T) == 1)
+    return _mm_min_epi8(a, b);
+  else if constexpr (sizeof(T) == 2)
+    return _mm_min_epu16(a, b);
+  else if constexpr (isSigned)
+    return _mm_min_epi32(a, b);
+  else
+    return _mm_min_epu32(a, b);
+#endif
+}
+template <typename T, bool isSigned>
+inline Block max(Block a, Block b) {
+  static_assert(hasMinMax<T, isSigned>(), "Unsupported element type");
+  if constexpr (sizeof(T) == 1 && !isSigned)
+    return _mm_max_epu8(a, b);
+  else if constexpr (sizeof(T) == 2 && isSigned)
+    return _mm_max_epi16(a, b);
+#if defined(__SSE4_1__)
+  else if constexpr (sizeof(T) == 1)
+    return _mm_max_epi8(a, b);
+  else if constexpr (sizeof(T) == 2)
+    return _mm_max_epu16(a, b);
+  else if constexpr (isSigned)
+    return _mm_max_epi32(a, b);
+  else
+    return _mm_max_epu32(a, b);
+#endif
+}
+
+#elif defined(__ARM_NEON)
+using Block = uint8x16_t;
+constexpr bool c_simd = true;
+
+// Applies the NEON operation op to the lanes of a and b, of the lane type
+// given by suffix (e.g. u16).
+#define RIPES_NEON_LANES(op, suffix, a, b)                                     \
+  vreinterpretq_u8_##suffix(op##_##suffix(vreinterpretq_##suffix##_u8(a),     \
+                                          vreinterpretq_##suffix##_u8(b)))
+
+inline Block loadBlock(const uint8_t *p) { return vld1q_u8(p); }
+inline void storeBlock(uint8_t *p, Block b) { vst1q_u8(p, b); }
+template <typename T>
+inline Block splat(T v) {
+  if constexpr (sizeof(T) == 1)
+    return vdupq_n_u8(v);
+  else if constexpr (sizeof(T) == 2)
+    return vreinterpretq_u8_u16(vdupq_n_u16(v));
+  else if constexpr (sizeof(T) == 4)
+    return vreinterpretq_u8_u32(vdupq_n_u32(v));
+  else
+    return vreinterpretq_u8_u64(vdupq_n_u64(v));
+}
+template <typename T>
+inline Block add(Block a, Block b) {
+  if constexpr (sizeof(T) == 1)
+    return vaddq_u8(a, b);
+  else if constexpr (sizeof(T) == 2)
+    return RIPES_NEON_LANES(vaddq, u16, a, b);
+  else if constexpr (sizeof(T) == 4)
+    return RIPES_NEON_LANES(vaddq, u32, a, b);
+  else
+    return RIPES_NEON_LANES(vaddq, u64, a, b);
+}
+template <typename T>
+inline Block sub(Block a, Block b) {
+  if constexpr (sizeof(T) == 1)
+    return vsubq_u8(a, b);
+  else if constexpr (sizeof(T) == 2)
+    return RIPES_NEON_LANES(vsubq, u16, a, b);
+  else if constexpr (sizeof(T) == 4)
+    return RIPES_NEON_LANES(vsubq, u32, a, b);
+  else
+    return RIPES_NEON_LANES(vsubq, u64, a, b);
+}
+inline Block bitAnd(Block a, Block b) { return vandq_u8(a, b); }
+inline Block bitOr(Block a, Block b) { return vorrq_u8(a, b); }
+inline Block bitXor(Block a, Block b) { return veorq_u8(a, b); }
+
+template <typename T>
+constexpr bool hasMul() {
+  return sizeof(T) <= 4;
+}
+template <typename T>
+inline Block mul(Block a, Block b) {
+  static_assert(hasMul<T>(), "Unsupported element type");
+  if constexpr (sizeof(T) == 1)
+    return vmulq_u8(a, b);
+  else if constexpr (sizeof(T) == 2)
+    return RIPES_NEON_LANES(vmulq, u16, a, b);
+  else
+    return RIPES_NEON_LANES(vmulq, u32, a, b);
+}
+
+template <typename T, bool isSigned>
+constexpr bool hasMinMax() {
+  return sizeof(T) <= 4;
+}
+template <typename T, bool isSigned>
+inline Block min(Block a, Block b) {
+  static_assert(hasMinMax<T, isSigned>(), "Unsupported element type");
+  if constexpr (sizeof(T) == 1 && isSigned)
+    return RIPES_NEON_LANES(vminq, s8, a, b);
+  else if constexpr (sizeof(T) == 1)
+    return vminq_u8(a, b);
+  else if constexpr (sizeof(T) == 2 && isSigned)
+    return RIPES_NEON_LANES(vminq, s16, a, b);
+  else if constexpr (sizeof(T) == 2)
+    return RIPES_NEON_LANES(vminq, u16, a, b);
+  else if constexpr (isSigned)
+    return RIPES_NEON_LANES(vminq, s32, a, b);
+  else
+    return RIPES_NEON_LANES(vminq, u32, a, b);
+}
+template <typename T, bool isSigned>
+inline Block max(Block a, Block b) {
+  static_assert(hasMinMax<T, isSigned>(), "Unsupported element type");
+  if constexpr (sizeof(T) == 1 && isSigned)
+    return RIPES_NEON_LANES(vmaxq, s8, a, b);
+  else if constexpr (sizeof(T) == 1)
+    return vmaxq_u8(a, b);
+  else if constexpr (sizeof(T) == 2 && isSigned)
+    return RIPES_NEON_LANES(vmaxq, s16, a, b);
+  else if constexpr (sizeof(T) == 2)
+    return RIPES_NEON_LANES(vmaxq, u16, a, b);
+  else if constexpr (isSigned)
+    return RIPES_NEON_LANES(vmaxq, s32, a, b);
+  else
+    return RIPES_NEON_LANES(vmaxq, u32, a, b);
+}
+
+#undef RIPES_NEON_LANES
+
+#else
+// Hosts without SIMD support execute all element loops on single elements;
+// the block operations are never called.
+struct Block {};
+constexpr bool c_simd = false;
+
+inline Block loadBlock(const uint8_t *) { return {}; }
+inline void storeBlock(uint8_t *, Block) {}
+template <typename T>
+inline Block splat(T) {
+  return {};
+}
+template <typename T>
+inline Block add(Block a, Block) {
+  return a;
+}
+template <typename T>
+inline Block sub(Block a, Block) {
+  return a;
+}
+inline Block bitAnd(Block a, Block) { return a; }
+inline Block bitOr(Block a, Block) { return a; }
+inline Block bitXor(Block a, Block) { return a; }
+template <typename T>
+constexpr bool hasMul() {
+  return false;
+}
+template <typename T>
+inline Block mul(Block a, Block) {
+  return a;
+}
+template <typename T, bool isSigned>
+constexpr bool hasMinMax() {
+  return false;
+}
+template <typename T, bool isSigned>
+inline Block min(Block a, Block) {
+  return a;
+}
+template <typename T, bool isSigned>
+inline Block max(Block a, Block) {
+  return a;
+}
+#endif
+
+template <typename T>
+inline T element(const uint8_t *bytes, size_t i) {
+  T value;
+  std::memcpy(&value, bytes + i * sizeof(T), sizeof(T));
+  return value;
+}
+template <typename T>
+inline void setElement(uint8_t *bytes, size_t i, T value) {
+  std::memcpy(bytes + i * sizeof(T), &value, sizeof(T));
+}
+
+/// Returns the upper half of the unsigned product of a and b.
+template <typename T>
+inline T mulhu(T a, T b) {
+  constexpr unsigned bits = sizeof(T) * CHAR_BIT;
+  if constexpr (bits < 64) {
+    return static_cast<T>((uint64_t(a) * uint64_t(b)) >> bits);
+  } else {
+    const uint64_t aLo = a & 0xFFFFFFFF, aHi = a >> 32;
+    const uint64_t bLo = b & 0xFFFFFFFF, bHi = b >> 32;
+    const uint64_t lolo = aLo * bLo;
+    const uint64_t hilo = aHi * bLo;
+    const uint64_t lohi = aLo * bHi;
+    const uint64_t cross = (lolo >> 32) + (hilo & 0xFFFFFFFF) + lohi;
+    return aHi * bHi + (hilo >> 32) + (cross >> 32);
+  }
+}
+/// Returns the upper half of the signed product of a and b.
+template <typename T>
+inline T mulh(T a, T b) {
+  using S = std::make_signed_t<T>;
+  T res = mulhu(a, b);
+  if (static_cast<S>(a) < 0)
+    res -= b;
+  if (static_cast<S>(b) < 0)
+    res -= a;
+  return res;
+}
+
+/// Element operations, applied to an element a of vs2 and an element b of
+/// vs1 (or the scalar operand) of the unsigned element type T. Operations
+/// with simd<T>() are additionally applied to blocks of elements.
+struct Add {
+  template <typename T>
+  static T apply(T a, T b) {
+    return static_cast<T>(a + b);
+  }
+  template <typename T>
+  static constexpr bool simd() {
+    return c_simd;
+  }
+  template <typename T>
+  static Block block(Block a, Block b) {
+    return add<T>(a, b);
+  }
+};
+struct Sub {
+  template <typename T>
+  static T apply(T a, T b) {
+    return static_cast<T>(a - b);
+  }
+  template <typename T>
+  static constexpr bool simd() {
+    return c_simd;
+  }
+  template <typename T>
+  static Block block(Block a, Block b) {
+    return sub<T>(a, b);
+  }
+};
+struct RSub {
+  template <typename T>
+  static T apply(T a, T b) {
+    return static_cast<T>(b - a);
+  }
+  template <typename T>
+  static constexpr bool simd() {
+    return c_simd;
+  }
+  template <typename T>
+  static Block block(Block a, Block b) {
+    return sub<T>(b, a);
+  }
+};
+struct And {
+  template <typename T>
+  static T apply(T a, T b) {
+    return a & b;
+  }
+  template <typename T>
+  static constexpr bool simd() {
+    return c_simd;
+  }
+  template <typename T>
+  static Block block(Block a, Block b) {
+    return bitAnd(a, b);
+  }
+};
+struct Or {
+  template <typename T>
+  static T apply(T a, T b) {
+    return a | b;
+  }
+  template <typename T>
+  static constexpr bool simd() {
+    return c_simd;
+  }
+  template <typename T>
+  static Block block(Block a, Block b) {
+    return bitOr(a, b);
+  }
+};
+struct Xor {
+  template <typename T>
+  static T apply(T a, T b) {
+    return a ^ b;
+  }
+  template <typename T>
+  static constexpr bool simd() {
+    return c_simd;
+  }
+  template <typename T>
+  static Block block(Block a, Block b) {
+    return bitXor(a, b);
+  }
+};
+template <bool isSigned>
+struct Min {
+  template <typename T>
+  static T apply(T a, T b) {
+    using C = std::conditional_t<isSigned, std::make_signed_t<T>, T>;
+    return static_cast<C>(a) < static_cast<C>(b) ? a : b;
+  }
+  template <typename T>
+  static constexpr bool simd() {
+    return hasMinMax<T, isSigned>();
+  }
+  template <typename T>
+  static Block block(Block a, Block b) {
+    return min<T, isSigned>(a, b);
+  }
+};
+template <bool isSigned>
+struct Max {
+  template <typename T>
+  static T apply(T a, T b) {
+    using C = std::conditional_t<isSigned, std::make_signed_t<T>, T>;
+    return static_cast<C>(a) > static_cast<C>(b) ? a : b;
+  }
+  template <typename T>
+  static constexpr bool simd() {
+    return hasMinMax<T, isSigned>();
+  }
+  template <typename T>
+  static Block block(Block a, Block b) {
+    return max<T, isSigned>(a, b);
+  }
+};
+struct Mul {
+  template <typename T>
+  static T apply(T a, T b) {
+    // Promoted to unsigned, such that the product never overflows an int.
+    return static_cast<T>(static_cast<uint64_t>(a) * b);
+  }
+  template <typename T>
+  static constexpr bool simd() {
+    return hasMul<T>();
+  }
+  template <typename T>
+  static Block block(Block a, Block b) {
+    return mul<T>(a, b);
+  }
+};
+struct Move {
+  template <typename T>
+  static T apply(T, T b) {
+    return b;
+  }
+  template <typename T>
+  static constexpr bool simd() {
+    return c_simd;
+  }
+  template <typename T>
+  static Block block(Block, Block b) {
+    return b;
+  }
+};
+
+/// Element operations without block variants.
+struct Scalar {
+  template <typename T>
+  static constexpr bool simd() {
+    return false;
+  }
+  template <typename T>
+  static Block block(Block a, Block) {
+    return a;
+  }
+};
+template <typename T>
+constexpr T shiftMask() {
+  return sizeof(T) * CHAR_BIT - 1;
+}
+struct Sll : Scalar {
+  template <typename T>
+  static T apply(T a, T b) {
+    return static_cast<T>(a << (b & shiftMask<T>()));
+  }
+};
+struct Srl : Scalar {
+  template <typename T>
+  static T apply(T a, T b) {
+    return static_cast<T>(a >> (b & shiftMask<T>()));
+  }
+};
+struct Sra : Scalar {
+  template <typename T>
+  static T apply(T a, T b) {
+    return static_cast<T>(static_cast<std::make_signed_t<T>>(a) >>
+                          (b & shiftMask<T>()));
+  }
+};
+struct MulH : Scalar {
+  template <typename T>
+  static T apply(T a, T b) {
+    return mulh(a, b);
+  }
+};
+struct MulHU : Scalar {
+  template <typename T>
+  static T apply(T a, T b) {
+    return mulhu(a, b);
+  }
+};
+// Division and remainder by zero and of the signed overflow follow the scalar
+// M extension.
+struct DivU : Scalar {
+  template <typename T>
+  static T apply(T a, T b) {
+    return b == 0 ? std::numeric_limits<T>::max() : static_cast<T>(a / b);
+  }
+};
+struct RemU : Scalar {
+  template <typename T>
+  static T apply(T a, T b) {
+    return b == 0 ? a : static_cast<T>(a % b);
+  }
+};
+struct Div : Scalar {
+  template <typename T>
+  static T apply(T a, T b) {
+    using S = std::make_signed_t<T>;
+    if (b == 0)
+      return std::numeric_limits<T>::max();
+    if (static_cast<S>(a) == std::numeric_limits<S>::min() &&
+        static_cast<S>(b) == -1)
+      return a;
+    return static_cast<T>(static_cast<S>(a) / static_cast<S>(b));
+  }
+};
+struct Rem : Scalar {
+  template <typename T>
+  static T apply(T a, T b) {
+    using S = std::make_signed_t<T>;
+    if (b == 0)
+      return a;
+    if (static_cast<S>(a) == std::numeric_limits<S>::min() &&
+        static_cast<S>(b) == -1)
+      return 0;
+    return static_cast<T>(static_cast<S>(a) % static_cast<S>(b));
+  }
+};
+
+/// Applies Op to the first @p n elements of @p a and @p b, into @p d. If @p b
+/// is nullptr, the scalar @p s is used as every element of b.
+template <typename T, typename Op>
+void binary(uint8_t *d, const uint8_t *a, const uint8_t *b, T s, size_t n) {
+  size_t i = 0;
+  if constexpr (Op::template simd<T>()) {
+    constexpr size_t lanes = c_blockBytes / sizeof(T);
+    const Block splatted = splat<T>(s);
+    for (; i + lanes <= n; i += lanes) {
+      const size_t offset = i * sizeof(T);
+      const Block vb = b ? loadBlock(b + offset) : splatted;
+      storeBlock(d + offset,
+                 Op::template block<T>(loadBlock(a + offset), vb));
+    }
+  }
+  for (; i < n; ++i) {
+    const T vb = b ? element<T>(b, i) : s;
+    setElement<T>(d, i, Op::template apply<T>(element<T>(a, i), vb));
+  }
+}
+
+/// Computes d += a * b for the first @p n elements, with the scalar @p s as b
+/// if @p b is nullptr.
+template <typename T>
+void multiplyAdd(uint8_t *d, const uint8_t *a, const uint8_t *b, T s,
+                 size_t n) {
+  size_t i = 0;
+  if constexpr (Mul::simd<T>()) {
+    constexpr size_t lanes = c_blockBytes / sizeof(T);
+    const Block splatted = splat<T>(s);
+    for (; i + lanes <= n; i += lanes) {
+      const size_t offset = i * sizeof(T);
+      const Block vb = b ? loadBlock(b + offset) : splatted;
+      const Block product = mul<T>(loadBlock(a + offset), vb);
+      storeBlock(d + offset, add<T>(loadBlock(d + offset), product));
+    }
+  }
+  for (; i < n; ++i) {
+    const T vb = b ? element<T>(b, i) : s;
+    setElement<T>(d, i,
+                  Add::apply<T>(element<T>(d, i),
+                                Mul::apply<T>(element<T>(a, i), vb)));
+  }
+}
+
+/// Reduces @p init and the first @p n elements of @p a through Op.
+template <typename T, typename Op>
+T reduce(const uint8_t *a, size_t n, T init) {
+  T acc = init;
+  size_t i = 0;
+  if constexpr (Op::template simd<T>()) {
+    constexpr size_t lanes = c_blockBytes / sizeof(T);
+    if (n >= lanes) {
+      // Reduce the blocks lane-wise, and then the lanes.
+      Block partial = loadBlock(a);
+      for (i = lanes; i + lanes <= n; i += lanes)
+        partial = Op::template block<T>(partial, loadBlock(a + i * sizeof(T)));
+      uint8_t lanesBytes[c_blockBytes];
+      storeBlock(lanesBytes, partial);
+      for (size_t lane = 0; lane < lanes; ++lane)
+        acc = Op::template apply<T>(acc, element<T>(lanesBytes, lane));
+    }
+  }
+  for (; i < n; ++i)
+    acc = Op::template apply<T>(acc, element<T>(a, i));
+  return acc;
+}
+
+} // namespace RVVector
+
+/**
+ * @brief The RVVectorUnit class
+ * Architectural state and arithmetic of the vector (V) extension: 32 vector
+ * registers of VLEN bits, and the vl and vtype settings. Elements are up to
+ * 64 bits wide (ELEN), in register groups of 1/8 to 8 registers (LMUL).
+ * Instructions operate on the first vl elements of their operands and leave
+ * the remaining (tail) elements undisturbed, which satisfies both tail
+ * policies.
+ *
+ * Masked instructions are not supported. Instructions which are masked,
+ * reserved, or illegal for the current vtype (including while vill is set)
+ * are not executed.
+ */
+class RVVectorUnit {
+public:
+  static constexpr unsigned c_elen = 64;
+  static constexpr unsigned c_defaultVLEN = 128;
+  static constexpr unsigned c_maxVLEN = 65536;
+  static constexpr unsigned c_vregs = 32;
+
+  enum class Op {
+    Add,
+    Sub,
+    RSub,
+    MinU,
+    Min,
+    MaxU,
+    Max,
+    And,
+    Or,
+    Xor,
+    Sll,
+    Srl,
+    Sra,
+    Move,
+    Mul,
+    MulH,
+    MulHU,
+    DivU,
+    Div,
+    RemU,
+    Rem,
+    MultiplyAdd
+  };
+  enum class Reduction { Sum, And, Or, Xor, MinU, Min, MaxU, Max };
+
+  struct State {
+    std::vector<uint8_t> regs;
+    uint64_t vl = 0;
+    uint64_t vtype = 0;
+    bool vill = true;
+  };
+
+  RVVectorUnit() { setVLEN(c_defaultVLEN); }
+
+  /// VLEN must be a power of two of at least ELEN bits.
+  static bool validVLEN(unsigned bits) {
+    return bits >= c_elen && bits <= c_maxVLEN && (bits & (bits - 1)) == 0;
+  }
+  /// Sets the length of the vector registers to @p bits (see validVLEN), and
+  /// resets the unit.
+  void setVLEN(unsigned bits) {
+    m_vlen = bits;
+    reset();
+  }
+  unsigned vlen() const { return m_vlen; }
+  unsigned vlenb() const { return m_vlen / CHAR_BIT; }
+
+  /// Clears the vector registers and vl, and sets vill.
+  void reset() {
+    m_state.regs.assign(c_vregs * vlenb(), 0);
+    m_state.vl = 0;
+    m_state.vtype = 0;
+    m_state.vill = true;
+  }
+  const State &state() const { return m_state; }
+  void restore(const State &state) { m_state = state; }
+
+  uint64_t vl() const { return m_state.vl; }
+  uint64_t vtype() const { return m_state.vtype; }
+  bool vill() const { return m_state.vill; }
+  /// Element width in bits of the current vtype.
+  unsigned sew() const { return 8u << ((m_state.vtype >> 3) & 0b111); }
+
+  /// Returns the maximum vector length for elements of @p sew bits in groups
+  /// of 2^@p lmulLog2 registers, or 0 if the setting is unsupported. A
+  /// fractional group must hold at least one element of ELEN bits.
+  uint64_t vlmax(unsigned sew, int lmulLog2) const {
+    if (sew > c_elen || lmulLog2 < -3 || lmulLog2 > 3)
+      return 0;
+    if (lmulLog2 < 0 && sew > (c_elen >> -lmulLog2))
+      return 0;
+    const uint64_t elements = m_vlen / sew;
+    return lmulLog2 >= 0 ? elements << lmulLog2 : elements >> -lmulLog2;
+  }
+
+  /**
+   * @brief configure
+   * Executes vsetvl(i): sets vtype to @p vtype, and vl to the application
+   * vector length @p avl limited to VLMAX. An unsupported vtype sets vill and
+   * clears vl. Returns the new vl.
+   */
+  uint64_t configure(uint64_t avl, uint64_t vtype) {
+    const unsigned vsew = (vtype >> 3) & 0b111;
+    const unsigned vlmul = vtype & 0b111;
+    uint64_t max = 0;
+    if ((vtype >> 8) == 0 && vsew <= 3 && vlmul != 0b100)
+      max = vlmax(8u << vsew, lmulLog2(vlmul));
+    if (max == 0) {
+      m_state.vill = true;
+      m_state.vtype = 0;
+      m_state.vl = 0;
+    } else {
+      m_state.vill = false;
+      m_state.vtype = vtype;
+      m_state.vl = std::min(avl, max);
+    }
+    return m_state.vl;
+  }
+
+  /// Returns the bytes of the register group starting at @p reg, of elements
+  /// of @p eew bits under the current vtype, or nullptr if the group is
+  /// misaligned or its multiplier is unsupported.
+  uint8_t *group(unsigned reg, unsigned eew) {
+    if (m_state.vill || reg >= c_vregs)
+      return nullptr;
+    const int emulLog2 =
+        log2(eew) - log2(sew()) + lmulLog2(m_state.vtype & 0b111);
+    if (emulLog2 < -3 || emulLog2 > 3)
+      return nullptr;
+    if (emulLog2 > 0 && reg % (1u << emulLog2) != 0)
+      return nullptr;
+    return registerBytes(reg);
+  }
+  uint8_t *registerBytes(unsigned reg) {
+    return m_state.regs.data() + reg * vlenb();
+  }
+
+  /// Executes the elementwise operation @p op on the vd and vs2 register
+  /// groups, and the vs1 register group or, if @p vs1 is unset, the scalar
+  /// operand @p scalar truncated to SEW bits. Returns false if the register
+  /// groups are illegal.
+  bool arith(Op op, unsigned vd, unsigned vs2, std::optional<unsigned> vs1,
+             uint64_t scalar) {
+    const unsigned width = sew();
+    uint8_t *d = group(vd, width);
+    const uint8_t *a = group(vs2, width);
+    const uint8_t *b = vs1 ? group(*vs1, width) : nullptr;
+    if (!d || !a || (vs1 && !b))
+      return false;
+    forElementType([&](auto type) {
+      using T = decltype(type);
+      arith<T>(op, d, a, b, static_cast<T>(scalar), m_state.vl);
+    });
+    return true;
+  }
+
+  /// Executes the reduction @p reduction of element 0 of vs1 and the vs2
+  /// register group, into element 0 of vd. Nothing is written if vl is 0.
+  bool reduce(Reduction reduction, unsigned vd, unsigned vs2, unsigned vs1) {
+    const uint8_t *a = group(vs2, sew());
+    if (!a || vd >= c_vregs || vs1 >= c_vregs)
+      return false;
+    if (m_state.vl == 0)
+      return true;
+    uint8_t *d = registerBytes(vd);
+    const uint8_t *init = registerBytes(vs1);
+    forElementType([&](auto type) {
+      using T = decltype(type);
+      using namespace RVVector;
+      const size_t n = m_state.vl;
+      const T s = element<T>(init, 0);
+      T result = 0;
+      switch (reduction) {
+      case Reduction::Sum:
+        result = RVVector::reduce<T, Add>(a, n, s);
+        break;
+      case Reduction::And:
+        result = RVVector::reduce<T, And>(a, n, s);
+        break;
+      case Reduction::Or:
+        result = RVVector::reduce<T, Or>(a, n, s);
+        break;
+      case Reduction::Xor:
+        result = RVVector::reduce<T, Xor>(a, n, s);
+        break;
+      case Reduction::MinU:
+        result = RVVector::reduce<T, Min<false>>(a, n, s);
+        break;
+      case Reduction::Min:
+        result = RVVector::reduce<T, Min<true>>(a, n, s);
+        break;
+      case Reduction::MaxU:
+        result = RVVector::reduce<T, Max<false>>(a, n, s);
+        break;
+      case Reduction::Max:
+        result = RVVector::reduce<T, Max<true>>(a, n, s);
+        break;
+      }
+      setElement<T>(d, 0, result);
+    });
+    return true;
+  }
+
+  /// vmv.x.s: returns element 0 of @p vs2, sign-extended to 64 bits.
+  std::optional<uint64_t> moveToScalar(unsigned vs2) {
+    if (m_state.vill || vs2 >= c_vregs)
+      return {};
+    const uint8_t *bytes = registerBytes(vs2);
+    uint64_t value = 0;
+    forElementType([&](auto type) {
+      using T = decltype(type);
+      value = static_cast<uint64_t>(static_cast<int64_t>(
+          static_cast<std::make_signed_t<T>>(RVVector::element<T>(bytes, 0))));
+    });
+    return value;
+  }
+
+  /// vmv.s.x: writes @p value, truncated to SEW bits, to element 0 of @p vd
+  /// if vl is not 0.
+  bool moveFromScalar(unsigned vd, uint64_t value) {
+    if (m_state.vill || vd >= c_vregs)
+      return false;
+    if (m_state.vl == 0)
+      return true;
+    uint8_t *bytes = registerBytes(vd);
+    forElementType([&](auto type) {
+      using T = decltype(type);
+      RVVector::setElement<T>(bytes, 0, static_cast<T>(value));
+    });
+    return true;
+  }
+
+  /**
+   * @brief execute
+   * Executes the unmasked OP-V arithmetic instruction @p instr (other than
+   * the vsetvl instructions), given the value @p x of its scalar register
+   * rs1, sign-extended from XLEN bits. Returns the value written to the
+   * integer register rd, for vmv.x.s.
+   */
+  std::optional<uint64_t> execute(uint32_t instr, uint64_t x) {
+    const unsigned vd = (instr >> 7) & 0x1F;
+    const unsigned funct3 = (instr >> 12) & 0x7;
+    const unsigned rs1 = (instr >> 15) & 0x1F;
+    const unsigned vs2 = (instr >> 20) & 0x1F;
+    const unsigned funct6 = (instr >> 26) & 0x3F;
+    if (!((instr >> 25) & 1))
+      return {};
+
+    // Integer register moves
+    if (funct6 == 0b010000) {
+      if (funct3 == 0b010 && rs1 == 0) // vmv.x.s
+        return moveToScalar(vs2);
+      if (funct3 == 0b110 && vs2 == 0) // vmv.s.x
+        moveFromScalar(vd, x);
+      return {};
+    }
+    if (funct3 == 0b010 && funct6 <= 0b000111) {
+      reduce(static_cast<Reduction>(funct6), vd, vs2, rs1);
+      return {};
+    }
+
+    const auto op = decode(funct3, funct6);
+    if (!op || (*op == Op::Move && vs2 != 0))
+      return {};
+    switch (funct3) {
+    case 0b000: // OPIVV
+    case 0b010: // OPMVV
+      arith(*op, vd, vs2, rs1, 0);
+      break;
+    case 0b011: { // OPIVI; shift amounts are unsigned.
+      const bool shift = *op == Op::Sll || *op == Op::Srl || *op == Op::Sra;
+      const uint64_t imm = shift ? rs1 : uint64_t(int64_t(rs1 << 27) >> 27);
+      arith(*op, vd, vs2, std::nullopt, imm);
+      break;
+    }
+    default: // OPIVX, OPMVX
+      arith(*op, vd, vs2, std::nullopt, x);
+      break;
+    }
+    return {};
+  }
+
+  /// Returns the element width in bits of a vector load or store of the
+  /// width field @p funct3, or 0 if the width is not a vector width.
+  static unsigned memoryEEW(unsigned funct3) {
+    switch (funct3) {
+    case 0b000:
+      return 8;
+    case 0b101:
+      return 16;
+    case 0b110:
+      return 32;
+    case 0b111:
+      return 64;
+    default:
+      return 0;
+    }
+  }
+
+private:
+  static int log2(unsigned v) {
+    int log = 0;
+    while (v >>= 1)
+      log++;
+    return log;
+  }
+  /// Register group multiplier of the vlmul field @p vlmul, in log2.
+  static int lmulLog2(unsigned vlmul) {
+    return vlmul < 4 ? static_cast<int>(vlmul) : static_cast<int>(vlmul) - 8;
+  }
+
+  /// Decodes the operation of an OPIVV/OPIVX/OPIVI or OPMVV/OPMVX
+  /// instruction, of the operand forms which exist for the operation.
+  static std::optional<Op> decode(unsigned funct3, unsigned funct6) {
+    const bool vv = funct3 == 0b000, vx = funct3 == 0b100;
+    const bool vi = funct3 == 0b011;
+    if (funct3 == 0b010 || funct3 == 0b110) {
+      switch (funct6) {
+      case 0b100000:
+        return Op::DivU;
+      case 0b100001:
+        return Op::Div;
+      case 0b100010:
+        return Op::RemU;
+      case 0b100011:
+        return Op::Rem;
+      case 0b100100:
+        return Op::MulHU;
+      case 0b100101:
+        return Op::Mul;
+      case 0b100111:
+        return Op::MulH;
+      case 0b101101:
+        return Op::MultiplyAdd;
+      default:
+        return {};
+      }
+    }
+    if (!vv && !vx && !vi)
+      return {};
+    switch (funct6) {
+    case 0b000000:
+      return Op::Add;
+    case 0b000010:
+      return vi ? std::nullopt : std::optional(Op::Sub);
+    case 0b000011:
+      return vv ? std::nullopt : std::optional(Op::RSub);
+    case 0b000100:
+      return vi ? std::nullopt : std::optional(Op::MinU);
+    case 0b000101:
+      return vi ? std::nullopt : std::optional(Op::Min);
+    case 0b000110:
+      return vi ? std::nullopt : std::optional(Op::MaxU);
+    case 0b000111:
+      return vi ? std::nullopt : std::optional(Op::Max);
+    case 0b001001:
+      return Op::And;
+    case 0b001010:
+      return Op::Or;
+    case 0b001011:
+      return Op::Xor;
+    case 0b010111:
+      return Op::Move;
+    case 0b100101:
+      return Op::Sll;
+    case 0b101000:
+      return Op::Srl;
+    case 0b101001:
+      return Op::Sra;
+    default:
+      return {};
+    }
+  }
+
+  /// Calls @p f with a value of the unsigned element type of the current SEW.
+  template <typename F>
+  void forElementType(F &&f) const {
+    switch (sew()) {
+    case 8:
+      f(uint8_t());
+      break;
+    case 16:
+      f(uint16_t());
+      break;
+    case 32:
+      f(uint32_t());
+      break;
+    default:
+      f(uint64_t());
+      break;
+    }
+  }
+
+  template <typename T>
+  static void arith(Op op, uint8_t *d, const uint8_t *a, const uint8_t *b,
+                    T s, size_t n) {
+    using namespace RVVector;
+    switch (op) {
+    case Op::Add:
+      return binary<T, Add>(d, a, b, s, n);
+    case Op::Sub:
+      return binary<T, Sub>(d, a, b, s, n);
+    case Op::RSub:
+      return binary<T, RSub>(d, a, b, s, n);
+    case Op::MinU:
+      return binary<T, Min<false>>(d, a, b, s, n);
+    case Op::Min:
+      return binary<T, Min<true>>(d, a, b, s, n);
+    case Op::MaxU:
+      return binary<T, Max<false>>(d, a, b, s, n);
+    case Op::Max:
+      return binary<T, Max<true>>(d, a, b, s, n);
+    case Op::And:
+      return binary<T, And>(d, a, b, s, n);
+    case Op::Or:
+      return binary<T, Or>(d, a, b, s, n);
+    case Op::Xor:
+      return binary<T, Xor>(d, a, b, s, n);
+    case Op::Sll:
+      return binary<T, Sll>(d, a, b, s, n);
+    case Op::Srl:
+      return binary<T, Srl>(d, a, b, s, n);
+    case Op::Sra:
+      return binary<T, Sra>(d, a, b, s, n);
+    case Op::Move:
+      // vs2 is not an operand of vmv.v.
+      return binary<T, Move>(d, d, b, s, n);
+    case Op::Mul:
+      return binary<T, Mul>(d, a, b, s, n);
+    case Op::MulH:
+      return binary<T, MulH>(d, a, b, s, n);
+    case Op::MulHU:
+      return binary<T, MulHU>(d, a, b, s, n);
+    case Op::DivU:
+      return binary<T, DivU>(d, a, b, s, n);
+    case Op::Div:
+      return binary<T, Div>(d, a, b, s, n);
+    case Op::RemU:
+      return binary<T, RemU>(d, a, b, s, n);
+    case Op::Rem:
+      return binary<T, Rem>(d, a, b, s, n);
+    case Op::MultiplyAdd:
+      return multiplyAdd<T>(d, a, b, s, n);
+    }
+  }
+
+  unsigned m_vlen = c_defaultVLEN;
+  State m_state;
+};
+
+} // namespace Ripes
@@ -0,0 +1,1417 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <deque>
+#include <limits>
+#include <type_traits>
+#include <unordered_map>
+
+#include "VSRTL/core/vsrtl_addressspace.h"
+
+#include "../../../pagedmemory.h"
+#include "../../interface/ripesprocessor.h"
+
+#include "../../../isa/rv_custom_ext.h"
+#include "../riscv.h"
+#include "../rv_bitmanip.h"
+#include "../rv_float.h"
+#include "../rv_uncompress.h"
+#include "../rv_vector.h"
+
+namespace Ripes {
+
+/**
+ * @brief The RVMemoryPort class
+ * Interface through which a functional RISC-V model performs its memory
+ * accesses in place of accessing its own memory, such as the harts of a
+ * multi-hart system sharing a single memory (see RVMH).
+ */
+class RVMemoryPort {
+public:
+  virtual ~RVMemoryPort() {}
+  /// Reads the 4 bytes of the instruction at @p address.
+  virtual VInt fetch(AInt address) = 0;
+  virtual VInt read(AInt address, unsigned bytes) = 0;
+  virtual void write(AInt address, VInt value, unsigned bytes) = 0;
+};
+
+/**
+ * @brief The RVISS class
+ * Functional (instruction-set level) RISC-V processor model. Instructions are
+ * executed directly on the architectural state, one instruction per cycle,
+ * without modelling any of the underlying datapath. This makes the model
+ * significantly faster than the VSRTL models, at the cost of not being
+ * visualizable. Memory, syscalls and the cache interfaces are shared with the
+ * VSRTL models through the RipesProcessor interface.
+ *
+ * Reverse execution is checkpoint based: the architectural state is
+ * checkpointed every c_checkpointInterval cycles, and memory writes are
+ * recorded in an undo log. Reversing restores the nearest preceding checkpoint
+ * and deterministically re-executes forward to the requested cycle. A
+ * checkpoint is additionally taken after each ecall, such that re-execution
+ * never has to repeat a system call.
+ *
+ * Each checkpoint indexes the registers and the range of memory written until
+ * the following checkpoint, such that the latest write of a register or
+ * address is found by re-executing only the latest interval between
+ * checkpoints which wrote it (see reverseToLastWrite).
+ *
+ * Instructions are translated upon their first execution into blocks of
+ * micro-ops, decoded up to the next control transfer, which are cached by
+ * their start address and chained to the blocks executed after them. Writes to
+ * translated instructions discard all translations (see
+ * PagedMemory::markCode).
+ *
+ * Natively clocked slices skip idle loops, such as a loop polling an
+ * unchanged peripheral register or spinning until an interrupt, up to the
+ * next scheduled event (see probeIdleLoop).
+ *
+ * The model implements the unmasked unit-stride and strided loads and stores,
+ * integer arithmetic and reductions of the vector (V) extension, executed by
+ * an RVVectorUnit, and the single- (F) and double-precision (D) floating-point
+ * extensions, executed by an RVFloatUnit through the floating-point
+ * arithmetic of the host. Of the CSR instructions, only accesses of the
+ * floating-point CSRs are implemented.
+ */
+template <typename XLEN_T>
+class RVISS : public RipesProcessor, public VectorProcessor {
+  static_assert(std::is_same<uint32_t, XLEN_T>::value ||
+                    std::is_same<uint64_t, XLEN_T>::value,
+                "Only supports 32- and 64-bit variants");
+  static constexpr unsigned XLEN = sizeof(XLEN_T) * CHAR_BIT;
+  using XLENS_T = std::make_signed_t<XLEN_T>;
+
+public:
+  RVISS(const QStringList &extensions) {
+    m_enabledISA = ISAInfoRegistry::getISA<XLenToRVISA<XLEN>()>(extensions);
+    m_extC = m_enabledISA->extensionEnabled("C");
+    m_extM = m_enabledISA->extensionEnabled("M");
+    m_extA = m_enabledISA->extensionEnabled("A");
+    m_extV = m_enabledISA->extensionEnabled("V");
+    m_extF = m_enabledISA->extensionEnabled("F");
+    m_fpu.setDouble(m_enabledISA->extensionEnabled("D"));
+    m_extB = RVBitManip::Extensions(*m_enabledISA);
+    m_features = isReversible | hasICacheInterface | hasDCacheInterface |
+                 hasInterrupts | hasNativeClocking;
+    trackRegisterWrites(RVISA::GPR);
+  }
+
+  // Ripes interface compliance
+  const ProcessorStructure &structure() const override { return m_structure; }
+  unsigned int getPcForStage(StageIndex) const override { return m_pc; }
+  AInt nextFetchedAddress() const override { return m_pc; }
+  QString stageName(StageIndex) const override { return "•"; }
+  StageInfo stageInfo(StageIndex) const override {
+    return StageInfo({m_pc, isExecutableAddress(m_pc), StageInfo::State::None});
+  }
+  void setProgramCounter(AInt address) override {
+    m_pc = static_cast<XLEN_T>(address);
+  }
+  void setPCInitialValue(AInt address) override {
+    m_pcInit = static_cast<XLEN_T>(address);
+  }
+  vsrtl::core::AddressSpaceMM &getMemory() override { return m_memory; }
+  VInt getRegister(const std::string_view &rfid, unsigned i) const override {
+    if (rfid == RVISA::FPR)
+      return m_fpu.reg(i);
+    return m_regs.at(i);
+  }
+  void setRegister(const std::string_view &rfid, unsigned i,
+                   VInt v) override {
+    if (rfid == RVISA::FPR) {
+      m_fpu.setReg(i, v);
+    } else if (i != 0) {
+      m_regs.at(i) = static_cast<XLEN_T>(v);
+      markRegistersWritten(RVISA::GPR, uint64_t(1) << i);
+    }
+  }
+  unsigned registerFileId(const std::string_view &rfid) const override {
+    return rfid == RVISA::FPR ? c_fprFile : c_gprFile;
+  }
+  VInt readRegister(const RegisterFileHandle &file, unsigned i) const override {
+    if (file.id == c_fprFile)
+      return m_fpu.reg(i);
+    return m_regs[i];
+  }
+  void readRegisters(const RegisterFileHandle &file,
+                     VInt *values) const override {
+    if (file.id == c_fprFile) {
+      for (unsigned i = 0; i < file.count; i++)
+        values[i] = m_fpu.reg(i);
+    } else {
+      std::copy(m_regs.begin(), m_regs.end(), values);
+    }
+  }
+  void finalize(FinalizeReason fr) override {
+    if (fr == FinalizeReason::exitSyscall) {
+      // The exit syscall is executed as part of the ecall instruction, which
+      // itself retires in the current cycle.
+      m_finished = true;
+    }
+  }
+  bool finished() const override {
+    return m_finished || !stageInfo({0, 0}).stage_valid;
+  }
+  const std::vector<StageIndex> breakpointTriggeringStages() const override {
+    return {{0, 0}};
+  }
+  MemoryAccess dataMemAccess() const override { return m_dataAccess; }
+  MemoryAccess instrMemAccess() const override { return m_instrAccess; }
+
+  long long getInstructionsRetired() const override {
+    return m_instructionsRetired;
+  }
+  long long getCycleCount() const override { return m_cycleCount; }
+  void idleUntil(long long cycle) override { m_idleUntil = cycle; }
+
+  void resetProcessor() override {
+    m_memory.reset();
+    m_regs.fill(0);
+    markAllRegistersWritten();
+    m_pc = m_pcInit;
+    m_cycleCount = 0;
+    m_idleUntil = 0;
+    m_instructionsRetired = 0;
+    m_dataAccess = MemoryAccess();
+    m_instrAccess = MemoryAccess();
+    m_finished = false;
+    m_reserved = false;
+    m_vector.reset();
+    m_fpu.reset();
+    m_checkpoints.clear();
+    m_undoLog.clear();
+    m_undoLogBase = 0;
+    resetWriteIndex();
+    m_checkpointNextCycle = true;
+    m_sliceEffects = false;
+    m_idleCyclesSkipped = 0;
+    if (m_emitsSignals)
+      processorWasReset.Emit();
+  }
+
+  void setMaxReverseCycles(unsigned cycles) override {
+    m_maxReverseCycles = cycles;
+  }
+  size_t reverseStateBytes() const override {
+    return m_checkpoints.size() * sizeof(Checkpoint) +
+           m_undoLog.size() * sizeof(MemoryUndo);
+  }
+
+  bool saveState(std::vector<uint64_t> &state) const override {
+    state.insert(state.end(), {static_cast<uint64_t>(m_cycleCount),
+                               static_cast<uint64_t>(m_instructionsRetired),
+                               m_finished, m_reserved, m_reservation});
+    if (m_extF) {
+      const auto &fp = m_fpu.state();
+      state.insert(state.end(), fp.regs.begin(), fp.regs.end());
+      state.insert(state.end(), {fp.frm, fp.fflags});
+    }
+    if (m_extV) {
+      // Vector registers are packed 8 bytes to a word.
+      const auto &vector = m_vector.state();
+      state.insert(state.end(), {vector.vl, vector.vtype, vector.vill});
+      for (size_t i = 0; i < vector.regs.size(); i += 8) {
+        uint64_t word = 0;
+        for (size_t j = 0; j < 8 && i + j < vector.regs.size(); j++)
+          word |= static_cast<uint64_t>(vector.regs[i + j]) << (8 * j);
+        state.push_back(word);
+      }
+    }
+    return true;
+  }
+
+  bool restoreState(const std::vector<uint64_t> &state) override {
+    const size_t fpWords = m_extF ? RVFloatUnit::c_fregs + 2 : 0;
+    const size_t vectorBytes = m_extV ? m_vector.state().regs.size() : 0;
+    const size_t vectorWords = m_extV ? 3 + (vectorBytes + 7) / 8 : 0;
+    if (state.size() != 5 + fpWords + vectorWords)
+      return false;
+
+    auto it = state.begin();
+    m_cycleCount = static_cast<long long>(*it++);
+    m_instructionsRetired = static_cast<long long>(*it++);
+    m_finished = *it++;
+    m_reserved = *it++;
+    m_reservation = static_cast<XLEN_T>(*it++);
+    if (m_extF) {
+      RVFloatUnit::State fp;
+      std::copy(it, it + fp.regs.size(), fp.regs.begin());
+      it += fp.regs.size();
+      fp.frm = static_cast<uint8_t>(*it++);
+      fp.fflags = static_cast<uint8_t>(*it++);
+      m_fpu.restore(fp);
+    }
+    if (m_extV) {
+      RVVectorUnit::State vector;
+      vector.vl = *it++;
+      vector.vtype = *it++;
+      vector.vill = *it++;
+      vector.regs.resize(vectorBytes);
+      for (size_t i = 0; i < vectorBytes; i++)
+        vector.regs[i] = static_cast<uint8_t>(it[i / 8] >> (8 * (i % 8)));
+      m_vector.restore(vector);
+    }
+
+    // Reverse execution restarts from the restored state.
+    m_idleUntil = 0;
+    m_dataAccess = MemoryAccess();
+    m_instrAccess = MemoryAccess();
+    m_checkpoints.clear();
+    m_undoLog.clear();
+    m_undoLogBase = 0;
+    resetWriteIndex();
+    m_checkpointNextCycle = true;
+    markAllRegistersWritten();
+    return true;
+  }
+
+  void reverseProcessor() override {
+    if (m_cycleCount == 0)
+      return;
+    const long long target = m_cycleCount - 1;
+    if (m_checkpoints.empty() || m_checkpoints.front().cycle > target) {
+      // Beyond the reverse horizon.
+      return;
+    }
+    size_t index = m_checkpoints.size() - 1;
+    while (m_checkpoints[index].cycle > target)
+      index--;
+    restoreCheckpoint(index);
+
+    // Re-execute up until the target cycle. By construction, no ecalls are
+    // executed between a checkpoint and the following checkpoint.
+    while (m_cycleCount < target)
+      step();
+    m_checkpointNextCycle = false;
+
+    if (m_emitsSignals)
+      processorWasReversed.Emit();
+  }
+
+  std::optional<long long>
+  reverseToLastWrite(const WriteQuery &query) override {
+    const bool isRegister = query.kind == WriteQuery::Kind::Register;
+    if (isRegister &&
+        (query.rfid != RVISA::GPR || query.index == 0 || query.index >= 64))
+      return {};
+    const AInt first = query.address;
+    const AInt last = query.address + std::max(query.bytes, 1u) - 1;
+    const auto overlaps = [&](const MemoryUndo &undo) {
+      return undo.address <= last && first <= undo.address + undo.bytes - 1;
+    };
+
+    // Finds the latest interval between checkpoints which wrote the register
+    // or memory, through the index of each checkpoint and the undo log.
+    size_t undoEnd = m_undoLogBase + m_undoLog.size();
+    for (size_t i = m_checkpoints.size(); i-- > 0;) {
+      const auto &cp = m_checkpoints[i];
+      const bool latest = i + 1 == m_checkpoints.size();
+      const WriteIndex &index = latest ? m_writeIndex : cp.written;
+      bool written = false;
+      if (isRegister) {
+        written = (index.registers >> query.index) & 1;
+      } else if (index.first <= last && first <= index.last) {
+        for (size_t pos = cp.undoLogPos; pos < undoEnd && !written; pos++)
+          written = overlaps(m_undoLog[pos - m_undoLogBase]);
+      }
+      undoEnd = cp.undoLogPos;
+      if (!written)
+        continue;
+
+      // Re-executes the interval from its checkpoint to find the cycle of its
+      // latest write.
+      const long long end = latest ? m_cycleCount : m_checkpoints[i + 1].cycle;
+      const auto endRegs = latest ? m_regs : m_checkpoints[i + 1].regs;
+      restoreCheckpoint(i);
+      std::optional<long long> cycle;
+      while (m_cycleCount < end) {
+        // System calls end their interval and are not re-executed; their
+        // register writes are found from the state following them.
+        if (m_memory.readMemConst(m_pc, 4) == 0x00000073) {
+          if (isRegister && m_regs[query.index] != endRegs[query.index])
+            cycle = m_cycleCount;
+          break;
+        }
+        const long long current = m_cycleCount;
+        const size_t undoPos = m_undoLogBase + m_undoLog.size();
+        m_writtenRegs = 0;
+        step();
+        if (isRegister) {
+          if ((m_writtenRegs >> query.index) & 1)
+            cycle = current;
+        } else {
+          for (size_t pos = undoPos - m_undoLogBase; pos < m_undoLog.size();
+               pos++)
+            if (overlaps(m_undoLog[pos]))
+              cycle = current;
+        }
+      }
+      // The index is exact, so the interval holds the write.
+      if (cycle) {
+        restoreCheckpoint(i);
+        while (m_cycleCount < *cycle)
+          step();
+      }
+      m_checkpointNextCycle = false;
+      if (m_emitsSignals)
+        processorWasReversed.Emit();
+      return cycle;
+    }
+    return {};
+  }
+
+  static ProcessorISAInfo supportsISA() {
+    return RVISA::supportsISA<XLEN>(true, true, true, true);
+  }
+  const ISAInfoBase *implementsISA() const override {
+    return m_enabledISA.get();
+  }
+  std::shared_ptr<const ISAInfoBase> fullISA() const override {
+    return RVISA::fullISA<XLEN>();
+  }
+
+  const std::set<std::string_view> registerFiles() const override {
+    if (m_extF)
+      return {RVISA::GPR, RVISA::FPR};
+    return {RVISA::GPR};
+  }
+
+  void setVLEN(unsigned bits) override {
+    m_vector.setVLEN(bits);
+    // Checkpoints hold vector registers of the previous length.
+    m_checkpoints.clear();
+    m_checkpointNextCycle = true;
+  }
+  unsigned vlen() const override { return m_vector.vlen(); }
+
+  /// Cycles of idle loops skipped by natively clocked slices since the reset.
+  long long idleCyclesSkipped() const { return m_idleCyclesSkipped; }
+
+protected:
+  void clockProcessor() override {
+    if (m_maxReverseCycles != 0 &&
+        (m_checkpointNextCycle || m_cycleCount % c_checkpointInterval == 0))
+      checkpoint();
+    step();
+    markRegistersWritten(RVISA::GPR, m_writtenRegs);
+    m_writtenRegs = 0;
+    if (m_emitsSignals)
+      processorWasClocked.Emit();
+  }
+
+  unsigned clockNative(unsigned n) override {
+    // Slices following a slice without side effects are probed for an idle
+    // loop. Memory accessed through a port may be written by others.
+    bool probing = !m_sliceEffects && !m_port;
+    m_sliceEffects = false;
+    m_idleProbe.cycle = -1;
+    unsigned cycles = 0;
+    do {
+      if (m_maxReverseCycles != 0 &&
+          (m_checkpointNextCycle || m_cycleCount % c_checkpointInterval == 0))
+        checkpoint();
+      const XLEN_T pc = m_pc;
+      step();
+      cycles++;
+      if (probing && m_pc <= pc)
+        probing = probeIdleLoop(n, cycles);
+    } while (cycles < n && !finished() && m_cycleCount < nextEventCycle());
+    // Register writes are published once per slice.
+    markRegistersWritten(RVISA::GPR, m_writtenRegs);
+    m_writtenRegs = 0;
+    return cycles;
+  }
+
+  // Members are accessible to timing models built upon the functional model
+  // (see RVOOO).
+  static constexpr long long c_checkpointInterval = 4096;
+  /// Identifiers of the register files in their handles (see registerFile).
+  static constexpr unsigned c_gprFile = 0;
+  static constexpr unsigned c_fprFile = 1;
+
+  /// The registers written, and the range [first : last] of memory holding the
+  /// writes recorded in the undo log, over an interval of cycles.
+  struct WriteIndex {
+    uint64_t registers = 0;
+    AInt first = ~AInt(0);
+    AInt last = 0;
+  };
+
+  struct Checkpoint {
+    long long cycle;
+    long long instructionsRetired;
+    std::array<XLEN_T, c_RVRegs> regs;
+    XLEN_T pc;
+    MemoryAccess dataAccess;
+    MemoryAccess instrAccess;
+    bool finished;
+    bool reserved;
+    XLEN_T reservation;
+    // Position in the undo log at the time of the checkpoint.
+    size_t undoLogPos;
+    // Vector state, if the V extension is enabled.
+    RVVectorUnit::State vector;
+    // Floating-point state, if the F extension is enabled.
+    RVFloatUnit::State fp;
+    // Writes performed from this checkpoint until the following checkpoint.
+    WriteIndex written = {};
+  };
+
+  struct MemoryUndo {
+    AInt address;
+    VInt value;
+    unsigned bytes;
+  };
+
+  void step() {
+    execute();
+    m_cycleCount++;
+    m_instructionsRetired++;
+    if (m_idleUntil > m_cycleCount) {
+      // Cycles spent idling are skipped rather than executed.
+      m_cycleCount = m_idleUntil;
+      m_checkpointNextCycle = true;
+    }
+  }
+
+  /// The state in which the head of a loop, the target of the first backward
+  /// control transfer of a slice, was reached.
+  struct IdleLoopProbe {
+    XLEN_T head = 0;
+    long long cycle = -1;
+    long long instructionsRetired = 0;
+    std::array<XLEN_T, c_RVRegs> regs;
+    bool reserved;
+    XLEN_T reservation;
+    RVVectorUnit::State vector;
+    RVFloatUnit::State fp;
+  };
+
+  /**
+   * @brief probeIdleLoop
+   * Called after a backward control transfer of a natively clocked slice of
+   * @p n cycles, of which @p cycles have been clocked. An iteration of a loop
+   * which writes no memory, makes no system call and leaves the architectural
+   * state as it found it is an idle loop, whose every following iteration is
+   * identical until a scheduled event changes the state of the system, such as
+   * polling an unchanged peripheral register. The iterations which complete
+   * before the next event or the end of the slice are skipped in one step,
+   * with the cycle and instruction counts advanced as if they were executed.
+   * Peripheral registers are assumed to be read without side effects.
+   * @returns whether to keep probing the slice.
+   */
+  bool probeIdleLoop(unsigned n, unsigned &cycles) {
+    if (m_sliceEffects)
+      return false;
+    auto &probe = m_idleProbe;
+    if (probe.cycle < 0) {
+      probe = {m_pc,
+               m_cycleCount,
+               m_instructionsRetired,
+               m_regs,
+               m_reserved,
+               m_reservation,
+               m_extV ? m_vector.state() : RVVectorUnit::State(),
+               m_extF ? m_fpu.state() : RVFloatUnit::State()};
+      return true;
+    }
+    // Transfers to other targets are those of inner loops.
+    if (m_pc != probe.head)
+      return true;
+    const long long period = m_cycleCount - probe.cycle;
+    // Iterations which idled (see idleUntil) do not repeat.
+    if (period != m_instructionsRetired - probe.instructionsRetired ||
+        m_regs != probe.regs || m_reserved != probe.reserved ||
+        (m_reserved && m_reservation != probe.reservation))
+      return false;
+    if (m_extF) {
+      const auto fp = m_fpu.state();
+      if (fp.regs != probe.fp.regs || fp.frm != probe.fp.frm ||
+          fp.fflags != probe.fp.fflags)
+        return false;
+    }
+    if (m_extV) {
+      const auto vector = m_vector.state();
+      if (vector.regs != probe.vector.regs || vector.vl != probe.vector.vl ||
+          vector.vtype != probe.vector.vtype ||
+          vector.vill != probe.vector.vill)
+        return false;
+    }
+
+    const long long remaining = std::min<long long>(
+        n - cycles, nextEventCycle() - m_cycleCount);
+    const long long skipped = remaining / period * period;
+    if (skipped > 0) {
+      m_cycleCount += skipped;
+      m_instructionsRetired += skipped;
+      m_idleCyclesSkipped += skipped;
+      cycles += skipped;
+      m_checkpointNextCycle = true;
+    }
+    // Fewer cycles than an iteration remain.
+    return false;
+  }
+
+  void checkpoint() {
+    m_checkpointNextCycle = false;
+    if (!m_checkpoints.empty() && m_checkpoints.back().cycle == m_cycleCount)
+      return;
+    if (!m_checkpoints.empty())
+      m_checkpoints.back().written = m_writeIndex;
+    resetWriteIndex();
+    m_checkpoints.push_back({m_cycleCount, m_instructionsRetired, m_regs, m_pc,
+                             m_dataAccess, m_instrAccess, m_finished,
+                             m_reserved, m_reservation,
+                             m_undoLogBase + m_undoLog.size(),
+                             m_extV ? m_vector.state() : RVVectorUnit::State(),
+                             m_extF ? m_fpu.state() : RVFloatUnit::State()});
+
+    // Discard checkpoints (and their undo log entries) which are no longer
+    // needed to reverse m_maxReverseCycles cycles.
+    const long long horizon = m_cycleCount - m_maxReverseCycles;
+    while (m_checkpoints.size() > 1 && m_checkpoints[1].cycle <= horizon)
+      m_checkpoints.pop_front();
+    while (m_undoLogBase < m_checkpoints.front().undoLogPos) {
+      m_undoLog.pop_front();
+      m_undoLogBase++;
+    }
+  }
+
+  /// Restores the state of checkpoint @p index, discarding the checkpoints
+  /// following it and undoing the memory writes performed after it.
+  void restoreCheckpoint(size_t index) {
+    m_checkpoints.resize(index + 1);
+    const auto &cp = m_checkpoints.back();
+    while (m_undoLogBase + m_undoLog.size() > cp.undoLogPos) {
+      const auto &undo = m_undoLog.back();
+      m_memory.writeMem(undo.address, undo.value, undo.bytes);
+      m_undoLog.pop_back();
+    }
+    m_regs = cp.regs;
+    markAllRegistersWritten();
+    m_pc = cp.pc;
+    m_cycleCount = cp.cycle;
+    m_idleUntil = 0;
+    m_instructionsRetired = cp.instructionsRetired;
+    m_dataAccess = cp.dataAccess;
+    m_instrAccess = cp.instrAccess;
+    m_finished = cp.finished;
+    m_reserved = cp.reserved;
+    m_reservation = cp.reservation;
+    if (m_extV)
+      m_vector.restore(cp.vector);
+    if (m_extF)
+      m_fpu.restore(cp.fp);
+    // The writes of the interval are indexed anew as it is re-executed.
+    resetWriteIndex();
+  }
+
+  void resetWriteIndex() { m_writeIndex = WriteIndex(); }
+
+  static XLENS_T toSigned(XLEN_T v) { return static_cast<XLENS_T>(v); }
+  static XLEN_T sext32(uint64_t v) {
+    return static_cast<XLEN_T>(static_cast<int64_t>(static_cast<int32_t>(v)));
+  }
+
+  /// Returns the upper XLEN bits of the unsigned 2*XLEN-bit product of a and
+  /// b.
+  static XLEN_T mulhu(XLEN_T a, XLEN_T b) {
+    if constexpr (XLEN == 32) {
+      return static_cast<XLEN_T>((uint64_t(a) * uint64_t(b)) >> 32);
+    } else {
+      const uint64_t aLo = a & 0xFFFFFFFF, aHi = a >> 32;
+      const uint64_t bLo = b & 0xFFFFFFFF, bHi = b >> 32;
+      const uint64_t lolo = aLo * bLo;
+      const uint64_t hilo = aHi * bLo;
+      const uint64_t lohi = aLo * bHi;
+      const uint64_t hihi = aHi * bHi;
+      const uint64_t cross = (lolo >> 32) + (hilo & 0xFFFFFFFF) + lohi;
+      return hihi + (hilo >> 32) + (cross >> 32);
+    }
+  }
+  static XLEN_T mulh(XLEN_T a, XLEN_T b) {
+    XLEN_T res = mulhu(a, b);
+    if (toSigned(a) < 0)
+      res -= b;
+    if (toSigned(b) < 0)
+      res -= a;
+    return res;
+  }
+  static XLEN_T mulhsu(XLEN_T a, XLEN_T b) {
+    XLEN_T res = mulhu(a, b);
+    if (toSigned(a) < 0)
+      res -= b;
+    return res;
+  }
+
+  template <typename U, typename S>
+  static U div(U a, U b) {
+    if (b == 0)
+      return static_cast<U>(-1);
+    if (static_cast<S>(a) == std::numeric_limits<S>::min() &&
+        static_cast<S>(b) == -1)
+      return a;
+    return static_cast<U>(static_cast<S>(a) / static_cast<S>(b));
+  }
+  template <typename U, typename S>
+  static U rem(U a, U b) {
+    if (b == 0)
+      return a;
+    if (static_cast<S>(a) == std::numeric_limits<S>::min() &&
+        static_cast<S>(b) == -1)
+      return 0;
+    return static_cast<U>(static_cast<S>(a) % static_cast<S>(b));
+  }
+  template <typename U>
+  static U divu(U a, U b) {
+    return b == 0 ? static_cast<U>(-1) : a / b;
+  }
+  template <typename U>
+  static U remu(U a, U b) {
+    return b == 0 ? a : a % b;
+  }
+
+  void writeReg(unsigned rd, XLEN_T v) {
+    if (rd != 0) {
+      m_regs[rd] = v;
+      m_writtenRegs |= uint64_t(1) << rd;
+      m_writeIndex.registers |= uint64_t(1) << rd;
+    }
+  }
+
+  VInt loadBytes(XLEN_T addr, unsigned bytes) {
+    m_dataAccess = {MemoryAccess::Read, addr, bytes, m_pc};
+    return m_port ? m_port->read(addr, bytes) : m_memory.readMem(addr, bytes);
+  }
+
+  XLEN_T load(XLEN_T addr, unsigned funct3) {
+    static constexpr unsigned c_sizes[] = {1, 2, 4, 8, 1, 2, 4, 0};
+    const VInt v = loadBytes(addr, c_sizes[funct3]);
+    switch (funct3) {
+    case 0b000: // lb
+      return static_cast<XLEN_T>(static_cast<int64_t>(static_cast<int8_t>(v)));
+    case 0b001: // lh
+      return static_cast<XLEN_T>(static_cast<int64_t>(static_cast<int16_t>(v)));
+    case 0b010: // lw
+      return sext32(v);
+    default: // ld, lbu, lhu, lwu
+      return static_cast<XLEN_T>(v);
+    }
+  }
+
+  void store(XLEN_T addr, XLEN_T value, unsigned funct3) {
+    storeBytes(addr, value, 1 << (funct3 & 0b11));
+  }
+
+  void storeBytes(XLEN_T addr, VInt value, unsigned bytes) {
+    m_dataAccess = {MemoryAccess::Write, addr, bytes, m_pc};
+    m_sliceEffects = true;
+    if (m_port) {
+      m_port->write(addr, value, bytes);
+      return;
+    }
+    if (m_maxReverseCycles != 0 &&
+        m_memory.regionType(addr) !=
+            vsrtl::core::AddressSpace::RegionType::IO) {
+      m_undoLog.push_back({addr, m_memory.readMemConst(addr, bytes), bytes});
+      m_writeIndex.first = std::min<AInt>(m_writeIndex.first, addr);
+      m_writeIndex.last = std::max<AInt>(m_writeIndex.last, addr + bytes - 1);
+    }
+    m_memory.writeMem(addr, value, bytes);
+  }
+
+  XLEN_T aluOp(unsigned funct3, unsigned funct7, XLEN_T a, XLEN_T b,
+               bool isImm) {
+    constexpr unsigned shamtMask = XLEN - 1;
+    if (!isImm && funct7 == 0b0000001) {
+      if (!m_extM)
+        return 0;
+      switch (funct3) {
+      case 0b000:
+        return a * b;
+      case 0b001:
+        return mulh(a, b);
+      case 0b010:
+        return mulhsu(a, b);
+      case 0b011:
+        return mulhu(a, b);
+      case 0b100:
+        return div<XLEN_T, XLENS_T>(a, b);
+      case 0b101:
+        return divu(a, b);
+      case 0b110:
+        return rem<XLEN_T, XLENS_T>(a, b);
+      case 0b111:
+        return remu(a, b);
+      }
+    }
+    const bool alt = funct7 & 0b0100000;
+    switch (funct3) {
+    case 0b000:
+      return (!isImm && alt) ? a - b : a + b;
+    case 0b001:
+      return a << (b & shamtMask);
+    case 0b010:
+      return toSigned(a) < toSigned(b) ? 1 : 0;
+    case 0b011:
+      return a < b ? 1 : 0;
+    case 0b100:
+      return a ^ b;
+    case 0b101:
+      return alt ? static_cast<XLEN_T>(toSigned(a) >> (b & shamtMask))
+                 : a >> (b & shamtMask);
+    case 0b110:
+      return a | b;
+    default:
+      return a & b;
+    }
+  }
+
+  /// RV64-only 32-bit operations (OP-32/OP-IMM-32), results are sign-extended.
+  XLEN_T aluOp32(unsigned funct3, unsigned funct7, XLEN_T a, XLEN_T b,
+                 bool isImm) {
+    const uint32_t a32 = static_cast<uint32_t>(a);
+    const uint32_t b32 = static_cast<uint32_t>(b);
+    if (!isImm && funct7 == 0b0000001) {
+      if (!m_extM)
+        return 0;
+      switch (funct3) {
+      case 0b000:
+        return sext32(a32 * b32);
+      case 0b100:
+        return sext32(div<uint32_t, int32_t>(a32, b32));
+      case 0b101:
+        return sext32(divu(a32, b32));
+      case 0b110:
+        return sext32(rem<uint32_t, int32_t>(a32, b32));
+      case 0b111:
+        return sext32(remu(a32, b32));
+      default:
+        return 0;
+      }
+    }
+    const bool alt = funct7 & 0b0100000;
+    switch (funct3) {
+    case 0b000:
+      return sext32((!isImm && alt) ? a32 - b32 : a32 + b32);
+    case 0b001:
+      return sext32(a32 << (b32 & 0x1F));
+    case 0b101:
+      return alt ? sext32(static_cast<uint32_t>(static_cast<int32_t>(a32) >>
+                                                (b32 & 0x1F)))
+                 : sext32(a32 >> (b32 & 0x1F));
+    default:
+      return 0;
+    }
+  }
+
+  /// Returns the operation of the bit-manipulation (Zba/Zbb/Zbs) instruction
+  /// @p instr, or ALUOp::NOP if @p instr is executed by aluOp or aluOp32.
+  unsigned bitManipOp(XLEN_T instr) const {
+    return m_extB.any() ? RVBitManip::decode<XLEN>(instr, m_extB)
+                        : unsigned(ALUOp::NOP);
+  }
+
+  /// Executes the atomic (A extension) instruction @p instr on the word or
+  /// doubleword (@p funct3) at @p addr. Unknown atomics are executed as nops.
+  void atomic(XLEN_T instr, unsigned rd, XLEN_T addr, XLEN_T src,
+              unsigned funct3) {
+    const bool word = funct3 == 0b010;
+    if (!word && (XLEN == 32 || funct3 != 0b011))
+      return;
+    const unsigned funct5 = (instr >> 27) & 0x1F;
+    if (funct5 == 0b00010) { // lr
+      writeReg(rd, load(addr, funct3));
+      m_reserved = true;
+      m_reservation = addr;
+      return;
+    }
+    if (funct5 == 0b00011) { // sc
+      const bool success = m_reserved && m_reservation == addr;
+      m_reserved = false;
+      if (success)
+        store(addr, src, funct3);
+      writeReg(rd, success ? 0 : 1);
+      return;
+    }
+
+    // Word operands are compared as sign- or zero-extended 32-bit values; the
+    // loaded word is sign-extended by load().
+    const XLEN_T s = word ? sext32(src) : src;
+    const XLEN_T u = word ? static_cast<XLEN_T>(uint32_t(src)) : src;
+    const XLEN_T mem = load(addr, funct3);
+    const XLEN_T memU = word ? static_cast<XLEN_T>(uint32_t(mem)) : mem;
+    XLEN_T result;
+    switch (funct5) {
+    case 0b00001: // amoswap
+      result = src;
+      break;
+    case 0b00000: // amoadd
+      result = mem + src;
+      break;
+    case 0b00100: // amoxor
+      result = mem ^ src;
+      break;
+    case 0b01100: // amoand
+      result = mem & src;
+      break;
+    case 0b01000: // amoor
+      result = mem | src;
+      break;
+    case 0b10000: // amomin
+      result = toSigned(mem) < toSigned(s) ? mem : s;
+      break;
+    case 0b10100: // amomax
+      result = toSigned(mem) > toSigned(s) ? mem : s;
+      break;
+    case 0b11000: // amominu
+      result = memU < u ? mem : src;
+      break;
+    case 0b11100: // amomaxu
+      result = memU > u ? mem : src;
+      break;
+    default:
+      m_dataAccess = MemoryAccess();
+      return;
+    }
+    store(addr, result, funct3);
+    writeReg(rd, mem);
+  }
+
+  /// Executes the vector configuration instruction (vsetvli, vsetivli or
+  /// vsetvl) @p instr.
+  void vectorConfigure(XLEN_T instr, unsigned rd, unsigned rs1, XLEN_T op1,
+                       XLEN_T op2) {
+    uint64_t vtype;
+    uint64_t avl;
+    if (!((instr >> 31) & 1)) { // vsetvli
+      vtype = (instr >> 20) & 0x7FF;
+    } else if ((instr >> 30) & 1) { // vsetivli
+      vtype = (instr >> 20) & 0x3FF;
+    } else { // vsetvl
+      vtype = op2;
+    }
+    if (((instr >> 30) & 0b11) == 0b11)
+      avl = rs1;
+    else if (rs1 != 0)
+      avl = op1;
+    else if (rd != 0) // Sets vl to VLMAX.
+      avl = std::numeric_limits<uint64_t>::max();
+    else // Keeps vl, changing vtype.
+      avl = m_vector.vl();
+    writeReg(rd, static_cast<XLEN_T>(m_vector.configure(avl, vtype)));
+  }
+
+  /// Executes the unmasked unit-stride or strided vector load or store
+  /// @p instr, from @p base with the byte stride @p stride. Other vector
+  /// memory instructions are executed as nops.
+  void vectorMemory(XLEN_T instr, bool isStore, XLEN_T base, XLEN_T stride) {
+    const unsigned eew = RVVectorUnit::memoryEEW((instr >> 12) & 0x7);
+    const unsigned vd = (instr >> 7) & 0x1F;
+    const unsigned mop = (instr >> 26) & 0b11;
+    const unsigned lumop = (instr >> 20) & 0x1F;
+    if (eew == 0 || !((instr >> 25) & 1) || (instr >> 28) != 0)
+      return;
+    if (mop != 0b10 && !(mop == 0b00 && lumop == 0))
+      return;
+    uint8_t *regs = m_vector.group(vd, eew);
+    if (!regs)
+      return;
+
+    // Transfers bytes between the registers and memory, in the little-endian
+    // byte order of both.
+    const auto transfer = [&](XLEN_T addr, uint8_t *data, unsigned bytes) {
+      if (isStore) {
+        VInt value = 0;
+        for (unsigned i = 0; i < bytes; ++i)
+          value |= VInt(data[i]) << (i * CHAR_BIT);
+        storeBytes(addr, value, bytes);
+      } else {
+        const VInt value = loadBytes(addr, bytes);
+        for (unsigned i = 0; i < bytes; ++i)
+          data[i] = static_cast<uint8_t>(value >> (i * CHAR_BIT));
+      }
+    };
+    const unsigned elementBytes = eew / CHAR_BIT;
+    const uint64_t vl = m_vector.vl();
+    if (mop == 0b00) {
+      // Unit-stride accesses are performed in chunks of up to 8 bytes, and
+      // reported as a single access of all the bytes.
+      const uint64_t total = vl * elementBytes;
+      for (uint64_t offset = 0; offset < total;) {
+        unsigned chunk = sizeof(VInt);
+        while (chunk > total - offset)
+          chunk >>= 1;
+        transfer(base + offset, regs + offset, chunk);
+        offset += chunk;
+      }
+      if (total != 0) {
+        m_dataAccess = {isStore ? MemoryAccess::Write : MemoryAccess::Read,
+                        base, static_cast<unsigned>(total), m_pc};
+      }
+    } else {
+      // Strided accesses are reported as the access of the last element.
+      for (uint64_t i = 0; i < vl; ++i)
+        transfer(base + static_cast<XLEN_T>(i) * stride,
+                 regs + i * elementBytes, elementBytes);
+    }
+  }
+
+  /// Executes the CSR instruction @p instr of function @p funct3, with @p x
+  /// the value of integer register rs1. Accesses of CSRs other than the
+  /// floating-point CSRs are executed as nops.
+  void csrAccess(XLEN_T instr, unsigned rd, unsigned rs1, XLEN_T x,
+                 unsigned funct3) {
+    const unsigned csr = instr >> 20;
+    const auto old = m_fpu.readCSR(csr);
+    if (!old)
+      return;
+    // The immediate variants take rs1 as a zero-extended immediate.
+    const uint64_t src = (funct3 & 0b100) ? rs1 : x;
+    switch (funct3 & 0b11) {
+    case 0b01: // csrrw
+      m_fpu.writeCSR(csr, src);
+      break;
+    case 0b10: // csrrs
+      if (rs1 != 0)
+        m_fpu.writeCSR(csr, *old | src);
+      break;
+    case 0b11: // csrrc
+      if (rs1 != 0)
+        m_fpu.writeCSR(csr, *old & ~src);
+      break;
+    }
+    writeReg(rd, static_cast<XLEN_T>(*old));
+  }
+
+  /// Uncompresses the instruction in the low bits of @p word. @p instrBytes
+  /// is set to the size of the instruction in memory.
+  XLEN_T expandInstruction(VInt word, unsigned &instrBytes) const {
+    XLEN_T instr = static_cast<XLEN_T>(word & 0xFFFFFFFF);
+    instrBytes = 4;
+    if (m_extC && (instr & 0b11) != 0b11) {
+      instr = static_cast<XLEN_T>(
+          vsrtl::core::RVCTable<XLEN>::get().expand(instr & 0xFFFF));
+      instrBytes = 2;
+    }
+    return instr;
+  }
+
+  /// Reads the instruction at m_pc, uncompressing compressed instructions.
+  /// @p instrBytes is set to the size of the instruction in memory.
+  XLEN_T fetchInstruction(unsigned &instrBytes) {
+    const VInt word =
+        m_port ? m_port->fetch(m_pc) : m_memory.readMem(m_pc, 4);
+    return expandInstruction(word, instrBytes);
+  }
+
+  /// A decoded instruction, with the fields and the immediate of the format of
+  /// its opcode extracted, such that executing it does not decode it again.
+  struct MicroOp {
+    XLEN_T instr;
+    XLEN_T imm;
+    uint8_t opcode;
+    uint8_t rd;
+    uint8_t rs1;
+    uint8_t rs2;
+    uint8_t funct3;
+    uint8_t funct7;
+    uint8_t bytes;
+    // Bit-manipulation operation (see bitManipOp).
+    uint8_t bitManip;
+    // Index of the custom instruction (see RVISA::ExtCustom), or -1.
+    int16_t custom;
+  };
+
+  MicroOp decodeOp(XLEN_T instr, unsigned instrBytes) const {
+    MicroOp op;
+    op.instr = instr;
+    op.opcode = instr & 0x7F;
+    op.rd = (instr >> 7) & 0x1F;
+    op.funct3 = (instr >> 12) & 0x7;
+    op.rs1 = (instr >> 15) & 0x1F;
+    op.rs2 = (instr >> 20) & 0x1F;
+    op.funct7 = (instr >> 25) & 0x7F;
+    op.bytes = instrBytes;
+    op.bitManip = unsigned(ALUOp::NOP);
+    op.custom = -1;
+    switch (op.opcode) {
+    case RVISA::OpcodeID::LUI:
+    case RVISA::OpcodeID::AUIPC:
+      op.imm = sext32(instr & 0xFFFFF000);
+      break;
+    case RVISA::OpcodeID::JAL:
+      op.imm = sext32(((static_cast<int32_t>(instr) >> 11) & ~0xFFFFF) |
+                      (instr & 0xFF000) | ((instr >> 9) & 0x800) |
+                      ((instr >> 20) & 0x7FE));
+      break;
+    case RVISA::OpcodeID::BRANCH:
+      op.imm = sext32(((static_cast<int32_t>(instr) >> 19) & ~0xFFF) |
+                      ((instr << 4) & 0x800) | ((instr >> 20) & 0x7E0) |
+                      ((instr >> 7) & 0x1E));
+      break;
+    case RVISA::OpcodeID::STORE:
+    case RVISA::OpcodeID::STOREFP:
+      op.imm = sext32((static_cast<int32_t>(instr) >> 20 & ~0x1F) | op.rd);
+      break;
+    case RVISA::OpcodeID::OP:
+    case RVISA::OpcodeID::OP32:
+      op.imm = 0;
+      op.bitManip = bitManipOp(instr);
+      break;
+    case RVISA::OpcodeID::CUSTOM0:
+    case RVISA::OpcodeID::CUSTOM1:
+    case RVISA::OpcodeID::CUSTOM2:
+    case RVISA::OpcodeID::CUSTOM3:
+      op.custom = RVISA::ExtCustom::find(instr);
+      op.imm = sext32(static_cast<int32_t>(instr) >> 20);
+      break;
+    case RVISA::OpcodeID::OPIMM:
+    case RVISA::OpcodeID::OPIMM32:
+      op.bitManip = bitManipOp(instr);
+      [[fallthrough]];
+    default:
+      op.imm = sext32(static_cast<int32_t>(instr) >> 20);
+      break;
+    }
+    return op;
+  }
+
+  /// A block of instructions translated into micro-ops, ending at the first
+  /// control transfer or system instruction.
+  struct TranslatedBlock {
+    std::vector<MicroOp> ops;
+    // The blocks most recently executed after this block, by start address,
+    // through which consecutive blocks are found without a lookup.
+    std::array<std::pair<XLEN_T, TranslatedBlock *>, 2> successors{};
+  };
+  static constexpr unsigned c_maxBlockOps = 64;
+  static constexpr size_t c_maxTranslatedBlocks = 1 << 16;
+
+  void flushTranslations() {
+    m_blocks.clear();
+    m_block = nullptr;
+    m_codeWrites = m_memory.codeWrites();
+  }
+
+  /// Returns the block starting at @p pc, translating it if necessary, or
+  /// nullptr if the instruction at @p pc cannot be translated. Translated
+  /// instructions are marked as code, such that writing them discards all
+  /// translations.
+  TranslatedBlock *translate(XLEN_T pc) {
+    if (auto it = m_blocks.find(pc); it != m_blocks.end())
+      return &it->second;
+    if (m_blocks.size() >= c_maxTranslatedBlocks)
+      flushTranslations();
+    TranslatedBlock block;
+    for (XLEN_T addr = pc; block.ops.size() < c_maxBlockOps;) {
+      unsigned instrBytes;
+      const XLEN_T instr =
+          expandInstruction(m_memory.readMemConst(addr, 4), instrBytes);
+      if (!m_memory.markCode(addr, instrBytes))
+        break;
+      block.ops.push_back(decodeOp(instr, instrBytes));
+      addr += instrBytes;
+      const unsigned opcode = instr & 0x7F;
+      if (opcode == RVISA::OpcodeID::JAL || opcode == RVISA::OpcodeID::JALR ||
+          opcode == RVISA::OpcodeID::BRANCH ||
+          opcode == RVISA::OpcodeID::SYSTEM)
+        break;
+    }
+    if (block.ops.empty())
+      return nullptr;
+    return &m_blocks.emplace(pc, std::move(block)).first->second;
+  }
+
+  /// Returns the micro-op of the instruction at m_pc, or nullptr if it is not
+  /// translated. Memory accessed through a port may be written by others, and
+  /// is therefore not translated.
+  const MicroOp *translatedOp() {
+    if (m_port)
+      return nullptr;
+    if (m_memory.codeWrites() != m_codeWrites)
+      flushTranslations();
+    if (m_block && m_blockPc == m_pc && m_blockIdx < m_block->ops.size()) {
+      const MicroOp &op = m_block->ops[m_blockIdx++];
+      m_blockPc += op.bytes;
+      return &op;
+    }
+
+    // Blocks are chained to the blocks following them.
+    TranslatedBlock *next = nullptr;
+    if (m_block) {
+      for (const auto &[address, successor] : m_block->successors)
+        if (successor && address == m_pc)
+          next = successor;
+    }
+    if (!next) {
+      next = translate(m_pc);
+      if (next && m_block) {
+        auto &successors = m_block->successors;
+        successors[1] = successors[0];
+        successors[0] = {m_pc, next};
+      }
+    }
+    m_block = next;
+    if (!m_block)
+      return nullptr;
+    const MicroOp &op = m_block->ops.front();
+    m_blockIdx = 1;
+    m_blockPc = m_pc + op.bytes;
+    return &op;
+  }
+
+  void execute() {
+    m_dataAccess = MemoryAccess();
+
+    // Instructions are executed from their translated block, or are otherwise
+    // fetched and decoded.
+    MicroOp fetched;
+    const MicroOp *decoded = translatedOp();
+    if (!decoded) {
+      unsigned instrBytes;
+      const XLEN_T instr = fetchInstruction(instrBytes);
+      fetched = decodeOp(instr, instrBytes);
+      decoded = &fetched;
+    }
+    // The micro-op is copied, since its block may be discarded during its
+    // execution.
+    const MicroOp op = *decoded;
+    m_instrAccess = {MemoryAccess::Read, m_pc, op.bytes};
+
+    const unsigned opcode = op.opcode;
+    const unsigned rd = op.rd;
+    const unsigned funct3 = op.funct3;
+    const unsigned rs1 = op.rs1;
+    const unsigned funct7 = op.funct7;
+    const unsigned bitManip = op.bitManip;
+    const XLEN_T instr = op.instr;
+    const XLEN_T imm = op.imm;
+    const XLEN_T op1 = m_regs[rs1];
+    const XLEN_T op2 = m_regs[op.rs2];
+
+    XLEN_T nextPc = m_pc + op.bytes;
+
+    switch (opcode) {
+    case RVISA::OpcodeID::LUI:
+      writeReg(rd, imm);
+      break;
+    case RVISA::OpcodeID::AUIPC:
+      writeReg(rd, m_pc + imm);
+      break;
+    case RVISA::OpcodeID::JAL:
+      writeReg(rd, nextPc);
+      nextPc = m_pc + imm;
+      break;
+    case RVISA::OpcodeID::JALR: {
+      const XLEN_T target = (op1 + imm) & ~XLEN_T(1);
+      writeReg(rd, nextPc);
+      nextPc = target;
+      break;
+    }
+    case RVISA::OpcodeID::BRANCH: {
+      bool taken = false;
+      switch (funct3) {
+      case 0b000:
+        taken = op1 == op2;
+        break;
+      case 0b001:
+        taken = op1 != op2;
+        break;
+      case 0b100:
+        taken = toSigned(op1) < toSigned(op2);
+        break;
+      case 0b101:
+        taken = toSigned(op1) >= toSigned(op2);
+        break;
+      case 0b110:
+        taken = op1 < op2;
+        break;
+      case 0b111:
+        taken = op1 >= op2;
+        break;
+      }
+      if (taken)
+        nextPc = m_pc + imm;
+      break;
+    }
+    case RVISA::OpcodeID::LOAD:
+      writeReg(rd, load(op1 + imm, funct3));
+      break;
+    case RVISA::OpcodeID::STORE:
+      store(op1 + imm, op2, funct3);
+      break;
+    case RVISA::OpcodeID::OPIMM:
+      if (bitManip != ALUOp::NOP)
+        writeReg(rd, RVBitManip::execute(bitManip, op1, imm));
+      else
+        writeReg(rd, aluOp(funct3, funct7 & ~0x1, op1, imm, true));
+      break;
+    case RVISA::OpcodeID::OP:
+      if (bitManip != ALUOp::NOP)
+        writeReg(rd, RVBitManip::execute(bitManip, op1, op2));
+      else
+        writeReg(rd, aluOp(funct3, funct7, op1, op2, false));
+      break;
+    case RVISA::OpcodeID::OPIMM32:
+      if constexpr (XLEN == 64) {
+        if (bitManip != ALUOp::NOP)
+          writeReg(rd, RVBitManip::execute(bitManip, op1, imm));
+        else
+          writeReg(rd, aluOp32(funct3, funct7, op1, imm, true));
+      }
+      break;
+    case RVISA::OpcodeID::OP32:
+      if constexpr (XLEN == 64) {
+        if (bitManip != ALUOp::NOP)
+          writeReg(rd, RVBitManip::execute(bitManip, op1, op2));
+        else
+          writeReg(rd, aluOp32(funct3, funct7, op1, op2, false));
+      }
+      break;
+    case RVISA::OpcodeID::AMO:
+      if (m_extA)
+        atomic(instr, rd, op1, op2, funct3);
+      break;
+    case RVISA::OpcodeID::OPV:
+      if (!m_extV)
+        break;
+      if (funct3 == 0b111) {
+        vectorConfigure(instr, rd, rs1, op1, op2);
+      } else {
+        // Scalar operands are sign-extended to SEW bits.
+        const uint64_t x = static_cast<int64_t>(toSigned(op1));
+        if (const auto res = m_vector.execute(instr, x))
+          writeReg(rd, static_cast<XLEN_T>(*res));
+      }
+      break;
+    case RVISA::OpcodeID::LOADFP:
+      if (m_extF && (funct3 == 0b010 || funct3 == 0b011)) {
+        const bool isDouble = funct3 == 0b011;
+        if (isDouble && !m_fpu.isDouble())
+          break;
+        m_fpu.load(rd, loadBytes(op1 + imm, isDouble ? 8 : 4), isDouble);
+      } else if (m_extV) {
+        vectorMemory(instr, false, op1, op2);
+      }
+      break;
+    case RVISA::OpcodeID::STOREFP:
+      if (m_extF && (funct3 == 0b010 || funct3 == 0b011)) {
+        const bool isDouble = funct3 == 0b011;
+        if (isDouble && !m_fpu.isDouble())
+          break;
+        storeBytes(op1 + imm, m_fpu.storeValue(op.rs2, isDouble),
+                   isDouble ? 8 : 4);
+      } else if (m_extV) {
+        vectorMemory(instr, true, op1, op2);
+      }
+      break;
+    case RVISA::OpcodeID::OPFP:
+    case RVISA::OpcodeID::MADD:
+    case RVISA::OpcodeID::MSUB:
+    case RVISA::OpcodeID::NMSUB:
+    case RVISA::OpcodeID::NMADD:
+      if (!m_extF)
+        break;
+      if (const auto res = m_fpu.execute(instr, op1, XLEN))
+        writeReg(rd, static_cast<XLEN_T>(*res));
+      break;
+    case RVISA::OpcodeID::CUSTOM0:
+    case RVISA::OpcodeID::CUSTOM1:
+    case RVISA::OpcodeID::CUSTOM2:
+    case RVISA::OpcodeID::CUSTOM3:
+      if (op.custom >= 0) {
+        const auto &custom = RVISA::ExtCustom::instructions()[op.custom];
+        RVISA::ExtCustom::Operands operands;
+        operands.rs1 = op1;
+        if (custom.readsRs2)
+          operands.rs2 = op2;
+        else
+          operands.imm = toSigned(imm);
+        operands.pc = m_pc;
+        operands.xlen = XLEN;
+        writeReg(rd, static_cast<XLEN_T>(custom.semantics(operands)));
+      }
+      break;
+    case RVISA::OpcodeID::SYSTEM:
+      if (funct3 != 0) {
+        if (m_extF)
+          csrAccess(instr, rd, rs1, op1, funct3);
+      } else if (instr == 0x00000073 && trapHandler) { // ecall
+        // Registers changed by the system call are indexed as written.
+        const auto regs = m_regs;
+        m_sliceEffects = true;
+        trapHandler();
+        for (unsigned i = 1; i < c_RVRegs; i++)
+          if (m_regs[i] != regs[i])
+            m_writeIndex.registers |= uint64_t(1) << i;
+        m_checkpointNextCycle = true;
+      }
+      break;
+    default:
+      // Unknown instructions are executed as nops, similar to the VSRTL models.
+      break;
+    }
+
+    m_pc = nextPc;
+  }
+
+  PagedMemory m_memory;
+  std::array<XLEN_T, c_RVRegs> m_regs{};
+  // Registers written in the current cycle (see markRegistersWritten).
+  uint64_t m_writtenRegs = 0;
+  XLEN_T m_pc = 0;
+  XLEN_T m_pcInit = 0;
+  long long m_cycleCount = 0;
+  // Cycle until which the processor idles (see idleUntil).
+  long long m_idleUntil = 0;
+  long long m_instructionsRetired = 0;
+  MemoryAccess m_dataAccess;
+  MemoryAccess m_instrAccess;
+  bool m_finished = false;
+  bool m_extC = false;
+  bool m_extM = false;
+  bool m_extA = false;
+  bool m_extV = false;
+  bool m_extF = false;
+  RVBitManip::Extensions m_extB;
+  RVVectorUnit m_vector;
+  RVFloatUnit m_fpu;
+  // Reservation of the latest load-reserved instruction (see atomic).
+  bool m_reserved = false;
+  XLEN_T m_reservation = 0;
+  // If set, memory is accessed through the port rather than m_memory.
+  RVMemoryPort *m_port = nullptr;
+
+  // Translated blocks by start address, valid as of m_codeWrites writes to
+  // translated code (see PagedMemory::codeWrites).
+  std::unordered_map<XLEN_T, TranslatedBlock> m_blocks;
+  unsigned long long m_codeWrites = 0;
+  // The block of the most recently executed micro-op, and the index and
+  // address of the micro-op following it.
+  TranslatedBlock *m_block = nullptr;
+  size_t m_blockIdx = 0;
+  XLEN_T m_blockPc = 0;
+  std::shared_ptr<ISAInfoBase> m_enabledISA;
+  ProcessorStructure m_structure = {{0, 1}};
+
+  // Reverse execution state
+  long long m_maxReverseCycles = 0;
+  bool m_checkpointNextCycle = true;
+  std::deque<Checkpoint> m_checkpoints;
+  std::deque<MemoryUndo> m_undoLog;
+  // Number of entries which have been discarded from the front of the undo log.
+  size_t m_undoLogBase = 0;
+  // Writes performed since the latest checkpoint.
+  WriteIndex m_writeIndex;
+
+  // Idle loop state (see probeIdleLoop). Whether memory was written or a
+  // system call was made in the current slice.
+  bool m_sliceEffects = false;
+  IdleLoopProbe m_idleProbe;
+  long long m_idleCyclesSkipped = 0;
+};
+
+} // namespace Ripes
@@ -0,0 +1,249 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "../../interface/ripesprocessor.h"
+
+namespace Ripes {
+
+enum class CoherenceProtocol { MSI, MESI };
+
+/**
+ * @brief The CoherenceSim class
+ * Simulates the private L1 data caches of the harts of a multi-hart processor,
+ * kept coherent by an MSI or MESI protocol snooping a shared bus. The caches
+ * are set-associative with LRU replacement, and allocate on both reads and
+ * writes. Lines are held in one of the states:
+ *  - Modified: the only, dirty, copy of the line.
+ *  - Exclusive (MESI only): the only, clean, copy of the line. Written
+ *    silently, without a bus transaction.
+ *  - Shared: one of possibly several clean copies. Writes must first upgrade
+ *    the line, invalidating the copies of the other caches.
+ *  - Invalid.
+ * Misses to a line which another cache holds Modified are served by that
+ * cache (an intervention), which writes back and downgrades or invalidates
+ * its copy.
+ *
+ * An invalidation is reported as false sharing if the invalidated cache never
+ * accessed any of the written bytes, that is, if the harts only share the line
+ * and not the data. Accesses are attributed to the line of their first byte.
+ */
+class CoherenceSim {
+public:
+  enum class State : uint8_t { Invalid, Shared, Exclusive, Modified };
+
+  struct Config {
+    CoherenceProtocol protocol = CoherenceProtocol::MESI;
+    // Cache geometry, in log2: bytes per line (at most 64), lines and ways.
+    unsigned lineBits = 5;
+    unsigned setBits = 6;
+    unsigned wayBits = 1;
+  };
+
+  struct Stats {
+    long long reads = 0;
+    long long writes = 0;
+    long long misses = 0;
+    // Writes to Shared lines.
+    long long upgrades = 0;
+    // Copies in other caches invalidated by writes of this cache.
+    long long invalidations = 0;
+    // The subset of invalidations which were due to false sharing.
+    long long falseSharing = 0;
+    // Misses served by another cache holding the line Modified.
+    long long interventions = 0;
+    // Modified lines written back, on eviction or intervention.
+    long long writebacks = 0;
+
+    Stats &operator+=(const Stats &other) {
+      reads += other.reads;
+      writes += other.writes;
+      misses += other.misses;
+      upgrades += other.upgrades;
+      invalidations += other.invalidations;
+      falseSharing += other.falseSharing;
+      interventions += other.interventions;
+      writebacks += other.writebacks;
+      return *this;
+    }
+  };
+
+  CoherenceSim(unsigned caches = 1, const Config &config = Config()) {
+    configure(caches, config);
+  }
+
+  void configure(unsigned caches, const Config &config) {
+    assert(config.lineBits <= 6 && "Lines may span at most 64 bytes");
+    m_config = config;
+    const size_t lines = size_t(1) << (config.setBits + config.wayBits);
+    m_lines.assign(caches, std::vector<Line>(lines));
+    m_stats.assign(caches, Stats());
+    m_time = 0;
+  }
+
+  void reset() { configure(m_stats.size(), m_config); }
+
+  const Config &config() const { return m_config; }
+  unsigned caches() const { return m_stats.size(); }
+
+  void access(unsigned cache, AInt address, unsigned bytes,
+              MemoryAccess::Type type) {
+    const AInt lineAddress = address >> m_config.lineBits;
+    const unsigned offset = address & ((AInt(1) << m_config.lineBits) - 1);
+    const uint64_t mask =
+        (bytes >= 64 ? ~uint64_t(0) : (uint64_t(1) << bytes) - 1) << offset;
+    const bool write = type == MemoryAccess::Write;
+    Stats &stats = m_stats.at(cache);
+    (write ? stats.writes : stats.reads)++;
+
+    if (Line *line = find(cache, lineAddress)) {
+      if (write) {
+        if (line->state == State::Shared) {
+          stats.upgrades++;
+          invalidateCopies(cache, lineAddress, mask);
+        }
+        line->state = State::Modified;
+      }
+      line->lastUse = ++m_time;
+      line->accessed |= mask;
+      return;
+    }
+
+    stats.misses++;
+    bool shared = false;
+    for (unsigned other = 0; other < m_lines.size(); ++other) {
+      if (other == cache)
+        continue;
+      Line *copy = find(other, lineAddress);
+      if (!copy)
+        continue;
+      shared = true;
+      if (copy->state == State::Modified) {
+        stats.interventions++;
+        m_stats.at(other).writebacks++;
+      }
+      if (!write)
+        copy->state = State::Shared;
+    }
+    if (write)
+      invalidateCopies(cache, lineAddress, mask);
+
+    Line &line = allocate(cache, lineAddress);
+    if (write)
+      line.state = State::Modified;
+    else if (shared || m_config.protocol == CoherenceProtocol::MSI)
+      line.state = State::Shared;
+    else
+      line.state = State::Exclusive;
+    line.accessed = mask;
+  }
+
+  /// Returns the state of the line containing @p address in @p cache.
+  State state(unsigned cache, AInt address) const {
+    const size_t idx = findIndex(cache, address >> m_config.lineBits);
+    return idx == s_notFound ? State::Invalid : m_lines.at(cache)[idx].state;
+  }
+
+  const Stats &stats(unsigned cache) const { return m_stats.at(cache); }
+  Stats totals() const {
+    Stats totals;
+    for (const auto &stats : m_stats)
+      totals += stats;
+    return totals;
+  }
+
+private:
+  struct Line {
+    AInt lineAddress = 0;
+    State state = State::Invalid;
+    unsigned long long lastUse = 0;
+    // Bytes of the line accessed since it was filled.
+    uint64_t accessed = 0;
+  };
+
+  static constexpr size_t s_notFound = static_cast<size_t>(-1);
+
+  /// Returns the index of the first way of the set of @p lineAddress.
+  size_t setIndex(AInt lineAddress) const {
+    const AInt set = lineAddress & ((AInt(1) << m_config.setBits) - 1);
+    return static_cast<size_t>(set) << m_config.wayBits;
+  }
+
+  size_t findIndex(unsigned cache, AInt lineAddress) const {
+    const auto &lines = m_lines.at(cache);
+    const size_t first = setIndex(lineAddress);
+    for (size_t idx = first; idx < first + (1u << m_config.wayBits); ++idx) {
+      if (lines[idx].state != State::Invalid &&
+          lines[idx].lineAddress == lineAddress)
+        return idx;
+    }
+    return s_notFound;
+  }
+
+  Line *find(unsigned cache, AInt lineAddress) {
+    const size_t idx = findIndex(cache, lineAddress);
+    return idx == s_notFound ? nullptr : &m_lines.at(cache)[idx];
+  }
+
+  Line &allocate(unsigned cache, AInt lineAddress) {
+    Line *ways = &m_lines.at(cache)[setIndex(lineAddress)];
+    Line *victim = &ways[0];
+    for (unsigned way = 0; way < (1u << m_config.wayBits); ++way) {
+      if (ways[way].state == State::Invalid) {
+        victim = &ways[way];
+        break;
+      }
+      if (ways[way].lastUse < victim->lastUse)
+        victim = &ways[way];
+    }
+    if (victim->state == State::Modified)
+      m_stats.at(cache).writebacks++;
+    victim->lineAddress = lineAddress;
+    victim->lastUse = ++m_time;
+    return *victim;
+  }
+
+  void invalidateCopies(unsigned cache, AInt lineAddress, uint64_t mask) {
+    Stats &stats = m_stats.at(cache);
+    for (unsigned other = 0; other < m_lines.size(); ++other) {
+      if (other == cache)
+        continue;
+      if (Line *copy = find(other, lineAddress)) {
+        stats.invalidations++;
+        stats.falseSharing += (copy->accessed & mask) == 0;
+        copy->state = State::Invalid;
+      }
+    }
+  }
+
+  Config m_config;
+  // Lines of each cache, the ways of each set being adjacent.
+  std::vector<std::vector<Line>> m_lines;
+  std::vector<Stats> m_stats;
+  unsigned long long m_time = 0;
+};
+
+/**
+ * @brief The MultiHartProcessor class
+ * Interface of processor models with multiple harts sharing a coherent memory
+ * (see RVMH).
+ */
+class MultiHartProcessor {
+public:
+  virtual ~MultiHartProcessor() {}
+  virtual unsigned numHarts() const = 0;
+  virtual const CoherenceSim &coherence() const = 0;
+  /// Reconfigures, and resets, the caches of the harts.
+  virtual void setCoherenceConfig(const CoherenceSim::Config &config) = 0;
+  /**
+   * @brief setQuantum
+   * Sets the number of cycles which the harts may execute on parallel threads
+   * in between synchronizing, or 0 to execute the harts on a single thread.
+   * The quantum does not affect the simulated execution.
+   */
+  virtual void setQuantum(unsigned cycles) = 0;
+};
+
+} // namespace Ripes
@@ -0,0 +1,620 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "../../../assembler/parallelfor.h"
+#include "../rviss/rviss.h"
+#include "coherence.h"
+
+namespace Ripes {
+
+/**
+ * @brief The RVMH class
+ * Multi-hart RISC-V processor model, being N functional harts (see RVISS)
+ * sharing a single memory. Each cycle, every hart which has not finished
+ * executes one instruction, in order of hart ID. The data accesses of each
+ * hart are simulated in its private L1 cache, kept coherent with the caches of
+ * the other harts (see CoherenceSim). The A extension provides the atomic
+ * instructions for synchronizing the harts; a store by any hart clears the
+ * load reservations of the other harts which overlap the stored bytes.
+ *
+ * All harts start executing at the entry point of the program. Hart IDs are
+ * passed in the tp register, and the stacks of the harts are disjoint: the
+ * initial stack pointer of each hart is offset by c_stackSize bytes per hart
+ * ID. The processor finishes once all harts have finished, and an exit system
+ * call finishes all harts. The registers of the processor are those of hart 0,
+ * except for whilst a hart executes a system call.
+ *
+ * Harts are executed in parallel, on one thread per hart, for quanta of
+ * cycles. During a quantum, each hart buffers its stores, and records the
+ * memory it accessed. A quantum is only committed if no hart accessed memory
+ * which another hart stored to, such that the harts could not have observed
+ * each other; the buffered stores are then written, and the cache accesses are
+ * replayed in the order of the cycles. Otherwise, or if a hart executed a
+ * system call or accessed an I/O region, the quantum is discarded and the
+ * harts are executed cycle by cycle on a single thread. As such, execution is
+ * deterministic and independent of the quantum. Quanta are only executed when
+ * the processor is clocked in batches (see RipesProcessor::clockN). Since the
+ * harts run ahead of the cycle count of the processor, the state of the harts
+ * is re-executed up to the current cycle if it is accessed within a quantum.
+ *
+ * The model cannot be visualized or reversed. Instructions are assumed not to
+ * be modified during execution.
+ */
+template <typename XLEN_T, unsigned N>
+class RVMH : public RipesProcessor, public MultiHartProcessor {
+  static_assert(N >= 1, "At least one hart is required");
+  static constexpr unsigned XLEN = sizeof(XLEN_T) * CHAR_BIT;
+
+public:
+  // Distance between the initial stack pointers of consecutive harts.
+  static constexpr AInt c_stackSize = 0x10000;
+  static constexpr unsigned c_defaultQuantum = 4096;
+  // Maximum number of quanta executed on a single thread after a quantum
+  // which could not be committed.
+  static constexpr unsigned c_maxBackoff = 16;
+
+  RVMH(const QStringList &extensions) {
+    for (unsigned id = 0; id < N; ++id)
+      m_harts[id] = std::make_unique<Hart>(extensions, this, id);
+    m_coherence.configure(N, CoherenceSim::Config());
+    m_features = 0;
+    for (unsigned id = 0; id < N; ++id)
+      m_structure[id] = 1;
+    trackRegisterWrites(RVISA::GPR);
+  }
+
+  // MultiHartProcessor interface
+  unsigned numHarts() const override { return N; }
+  const CoherenceSim &coherence() const override {
+    sync();
+    return m_coherence;
+  }
+  void setCoherenceConfig(const CoherenceSim::Config &config) override {
+    sync();
+    m_coherence.configure(N, config);
+  }
+  void setQuantum(unsigned cycles) override {
+    sync();
+    m_quantum = cycles;
+  }
+
+  // Ripes interface compliance
+  const ProcessorStructure &structure() const override { return m_structure; }
+  unsigned int getPcForStage(StageIndex idx) const override {
+    return hartPc(idx.lane());
+  }
+  AInt nextFetchedAddress() const override { return hartPc(0); }
+  QString stageName(StageIndex idx) const override {
+    return "H" + QString::number(idx.lane());
+  }
+  StageInfo stageInfo(StageIndex idx) const override {
+    return StageInfo({hartPc(idx.lane()), !hartFinished(idx.lane()),
+                      StageInfo::State::None});
+  }
+  void setProgramCounter(AInt address) override {
+    sync();
+    for (auto &hart : m_harts)
+      hart->setProgramCounter(address);
+  }
+  void setPCInitialValue(AInt address) override {
+    for (auto &hart : m_harts)
+      hart->setPCInitialValue(address);
+  }
+  vsrtl::core::AddressSpaceMM &getMemory() override {
+    sync();
+    return m_memory;
+  }
+  VInt getRegister(const std::string_view &rfid, unsigned i) const override {
+    sync();
+    return m_harts[m_current]->getRegister(rfid, i);
+  }
+  VInt readRegister(const RegisterFileHandle &file, unsigned i) const override {
+    sync();
+    return m_harts[m_current]->readRegister(file, i);
+  }
+  void readRegisters(const RegisterFileHandle &file,
+                     VInt *values) const override {
+    sync();
+    m_harts[m_current]->readRegisters(file, values);
+  }
+  /// Sets the register of the hart executing a system call, or otherwise of
+  /// all harts (such as when initializing the registers).
+  void setRegister(const std::string_view &rfid, unsigned i, VInt v) override {
+    sync();
+    if (m_inTrap) {
+      m_harts[m_current]->setRegister(rfid, i, v);
+    } else {
+      for (unsigned id = 0; id < N; ++id) {
+        const VInt offset = i == 2 ? id * c_stackSize : 0;
+        m_harts[id]->setRegister(rfid, i, v - offset);
+      }
+    }
+    if (m_current == 0 && i != 0)
+      markRegistersWritten(RVISA::GPR, uint64_t(1) << i);
+  }
+  void finalize(FinalizeReason fr) override {
+    for (auto &hart : m_harts)
+      hart->finalize(fr);
+  }
+  bool finished() const override {
+    for (unsigned id = 0; id < N; ++id)
+      if (!hartFinished(id))
+        return false;
+    return true;
+  }
+  const std::vector<StageIndex> breakpointTriggeringStages() const override {
+    std::vector<StageIndex> stages;
+    for (unsigned id = 0; id < N; ++id)
+      stages.push_back({id, 0});
+    return stages;
+  }
+  MemoryAccess dataMemAccess() const override {
+    if (m_ahead) {
+      const size_t i = m_cycleCount - m_aheadStart - 1;
+      return i < m_harts[0]->quantumCycles() ? m_harts[0]->quantumAccess(i)
+                                             : MemoryAccess();
+    }
+    return m_harts[0]->dataMemAccess();
+  }
+  MemoryAccess instrMemAccess() const override {
+    if (m_ahead) {
+      const size_t i = m_cycleCount - m_aheadStart - 1;
+      return i < m_harts[0]->quantumCycles() ? m_harts[0]->quantumFetch(i)
+                                             : MemoryAccess();
+    }
+    return m_harts[0]->instrMemAccess();
+  }
+
+  long long getInstructionsRetired() const override {
+    long long retired = 0;
+    for (unsigned id = 0; id < N; ++id) {
+      const Hart &hart = *m_harts[id];
+      if (m_ahead) {
+        retired += hart.quantumStart().instructionsRetired +
+                   std::min<long long>(m_cycleCount - m_aheadStart,
+                                       hart.quantumCycles());
+      } else {
+        retired += hart.getInstructionsRetired();
+      }
+    }
+    return retired;
+  }
+  long long getCycleCount() const override { return m_cycleCount; }
+
+  void resetProcessor() override {
+    m_memory.reset();
+    m_coherence.reset();
+    m_ahead = false;
+    m_undoLog.clear();
+    m_cycleCount = 0;
+    m_serialUntil = 0;
+    m_backoff = 1;
+    m_current = 0;
+    m_inTrap = false;
+    for (unsigned id = 0; id < N; ++id) {
+      m_harts[id]->resetProcessor();
+      m_harts[id]->setRegister(RVISA::GPR, 4, id);
+    }
+    markAllRegistersWritten();
+    if (m_emitsSignals)
+      processorWasReset.Emit();
+  }
+
+  static ProcessorISAInfo supportsISA() {
+    return RVISA::supportsISA<XLEN>(true);
+  }
+  const ISAInfoBase *implementsISA() const override {
+    return m_harts[0]->implementsISA();
+  }
+  std::shared_ptr<const ISAInfoBase> fullISA() const override {
+    return RVISA::fullISA<XLEN>();
+  }
+
+  const std::set<std::string_view> registerFiles() const override {
+    return {RVISA::GPR};
+  }
+
+protected:
+  void clockProcessor() override {
+    if (m_ahead && m_emitsSignals)
+      sync();
+    if (!m_ahead && !(canRunAhead() && runAhead()))
+      cycle();
+    m_cycleCount++;
+    if (m_ahead && m_cycleCount >= m_aheadEnd) {
+      // The harts have been caught up with.
+      m_ahead = false;
+      m_undoLog.clear();
+    }
+    if (m_emitsSignals)
+      processorWasClocked.Emit();
+  }
+
+private:
+  /**
+   * @brief The Hart class
+   * A functional model of a single hart, accessing the memory of the
+   * processor through its memory port. Whilst speculating, stores are
+   * buffered rather than written to memory.
+   */
+  class Hart : public RVISS<XLEN_T>, public RVMemoryPort {
+    using Base = RVISS<XLEN_T>;
+
+  public:
+    using Checkpoint = typename Base::Checkpoint;
+
+    Hart(const QStringList &extensions, RVMH *processor, unsigned id)
+        : Base(extensions), m_processor(processor), m_id(id) {
+      this->m_port = this;
+      this->m_emitsSignals = false;
+      this->isExecutableAddress = [processor](AInt address) {
+        return processor->isExecutableAddress(address);
+      };
+      this->trapHandler = [this] {
+        if (m_speculating)
+          m_aborted = true;
+        else
+          m_processor->trap(m_id);
+      };
+    }
+
+    XLEN_T pc() const { return this->m_pc; }
+    /// Executes a single cycle.
+    void cycle() { this->step(); }
+    /// Returns the registers written since the previous call.
+    uint64_t takeWrittenRegisters() {
+      const uint64_t written = this->m_writtenRegs;
+      this->m_writtenRegs = 0;
+      return written;
+    }
+    /// Clears the load reservation of the hart if it overlaps @p access.
+    void clearReservation(const MemoryAccess &access) {
+      const AInt reserved = granule(this->m_reservation);
+      if (this->m_reserved && granule(access.address) <= reserved &&
+          reserved <= granule(access.address + access.bytes - 1))
+        this->m_reserved = false;
+    }
+
+    // Speculative execution
+    /**
+     * @brief speculate
+     * Executes up to @p cycles cycles, buffering stores. Stops early if the
+     * hart finishes, or if the execution must be discarded (see aborted()).
+     */
+    void speculate(unsigned cycles) {
+      m_quantumStart = {this->m_cycleCount,
+                        this->m_instructionsRetired,
+                        this->m_regs,
+                        this->m_pc,
+                        this->m_dataAccess,
+                        this->m_instrAccess,
+                        this->m_finished,
+                        this->m_reserved,
+                        this->m_reservation,
+                        0,
+                        {}};
+      m_quantumPcs.clear();
+      m_quantumAccesses.clear();
+      m_quantumFetches.clear();
+      m_buffer.clear();
+      m_bufferedStores.clear();
+      m_readGranules.clear();
+      m_writtenGranules.clear();
+      m_speculating = true;
+      m_aborted = false;
+      for (unsigned i = 0; i < cycles && !m_aborted && !this->finished();
+           ++i) {
+        m_quantumPcs.push_back(this->m_pc);
+        this->step();
+        m_quantumAccesses.push_back(this->m_dataAccess);
+        m_quantumFetches.push_back(this->m_instrAccess);
+      }
+      m_speculating = false;
+    }
+    /// Whether the hart executed a system call or accessed an I/O region
+    /// whilst speculating.
+    bool aborted() const { return m_aborted; }
+    /// Restores the state of the hart prior to speculate().
+    void discard() {
+      this->m_cycleCount = m_quantumStart.cycle;
+      this->m_instructionsRetired = m_quantumStart.instructionsRetired;
+      this->m_regs = m_quantumStart.regs;
+      this->m_pc = m_quantumStart.pc;
+      this->m_dataAccess = m_quantumStart.dataAccess;
+      this->m_instrAccess = m_quantumStart.instrAccess;
+      this->m_finished = m_quantumStart.finished;
+      this->m_reserved = m_quantumStart.reserved;
+      this->m_reservation = m_quantumStart.reservation;
+      this->m_writtenRegs = 0;
+    }
+    const Checkpoint &quantumStart() const { return m_quantumStart; }
+    /// Number of cycles executed by speculate().
+    size_t quantumCycles() const { return m_quantumPcs.size(); }
+    AInt quantumPc(size_t cycle) const { return m_quantumPcs.at(cycle); }
+    const MemoryAccess &quantumAccess(size_t cycle) const {
+      return m_quantumAccesses.at(cycle);
+    }
+    const MemoryAccess &quantumFetch(size_t cycle) const {
+      return m_quantumFetches.at(cycle);
+    }
+    const std::unordered_set<AInt> &readGranules() const {
+      return m_readGranules;
+    }
+    const std::unordered_set<AInt> &writtenGranules() const {
+      return m_writtenGranules;
+    }
+    struct BufferedStore {
+      AInt address;
+      VInt value;
+      unsigned bytes;
+    };
+    const std::vector<BufferedStore> &bufferedStores() const {
+      return m_bufferedStores;
+    }
+
+    // RVMemoryPort interface
+    VInt fetch(AInt address) override {
+      // Fetches are treated as reads, for programs modifying their code.
+      return m_speculating ? read(address, 4)
+                           : m_processor->m_memory.readMem(address, 4);
+    }
+    VInt read(AInt address, unsigned bytes) override {
+      auto &memory = m_processor->m_memory;
+      if (!m_speculating)
+        return memory.readMem(address, bytes);
+      if (isIO(address))
+        return 0;
+      m_readGranules.insert(granule(address));
+      m_readGranules.insert(granule(address + bytes - 1));
+      if (m_buffer.empty())
+        return memory.readMemConst(address, bytes);
+      VInt value = 0;
+      for (unsigned i = 0; i < bytes; ++i) {
+        const auto it = m_buffer.find(address + i);
+        const VInt byte = it != m_buffer.end()
+                              ? it->second
+                              : memory.readMemConst(address + i, 1);
+        value |= (byte & 0xFF) << (i * CHAR_BIT);
+      }
+      return value;
+    }
+    void write(AInt address, VInt value, unsigned bytes) override {
+      if (!m_speculating) {
+        m_processor->m_memory.writeMem(address, value, bytes);
+        return;
+      }
+      if (isIO(address))
+        return;
+      m_writtenGranules.insert(granule(address));
+      m_writtenGranules.insert(granule(address + bytes - 1));
+      m_bufferedStores.push_back({address, value, bytes});
+      for (unsigned i = 0; i < bytes; ++i)
+        m_buffer[address + i] = (value >> (i * CHAR_BIT)) & 0xFF;
+    }
+
+    /// Memory is shared between harts at a granularity of 8 bytes.
+    static AInt granule(AInt address) { return address >> 3; }
+
+  private:
+    bool isIO(AInt address) {
+      if (m_processor->m_memory.regionType(address) !=
+          vsrtl::core::AddressSpace::RegionType::IO)
+        return false;
+      m_aborted = true;
+      return true;
+    }
+
+    RVMH *m_processor;
+    const unsigned m_id;
+
+    bool m_speculating = false;
+    bool m_aborted = false;
+    Checkpoint m_quantumStart{};
+    // Program counter, data and instruction access of each cycle of the
+    // quantum.
+    std::vector<AInt> m_quantumPcs;
+    std::vector<MemoryAccess> m_quantumAccesses;
+    std::vector<MemoryAccess> m_quantumFetches;
+    // Buffered stores, in program order, and the resulting bytes.
+    std::vector<BufferedStore> m_bufferedStores;
+    std::unordered_map<AInt, uint8_t> m_buffer;
+    std::unordered_set<AInt> m_readGranules;
+    std::unordered_set<AInt> m_writtenGranules;
+  };
+
+  struct MemoryUndo {
+    AInt address;
+    VInt value;
+  };
+
+  /// Executes a system call for hart @p id.
+  void trap(unsigned id) {
+    m_current = id;
+    m_inTrap = true;
+    if (trapHandler)
+      trapHandler();
+    m_inTrap = false;
+  }
+
+  /// Accesses the cache of hart @p id, and clears the reservations of the
+  /// other harts overlapping stores.
+  void performAccess(unsigned id, const MemoryAccess &access, bool reserve) {
+    if (access.type == MemoryAccess::None)
+      return;
+    m_coherence.access(id, access.address, access.bytes, access.type);
+    if (reserve && access.type == MemoryAccess::Write) {
+      for (unsigned other = 0; other < N; ++other)
+        if (other != id)
+          m_harts[other]->clearReservation(access);
+    }
+  }
+
+  /// Executes a single cycle of all harts, in order of hart ID.
+  void cycle() {
+    for (unsigned id = 0; id < N; ++id) {
+      Hart &hart = *m_harts[id];
+      if (hart.finished())
+        continue;
+      m_current = id;
+      hart.cycle();
+      performAccess(id, hart.dataMemAccess(), true);
+    }
+    m_current = 0;
+    publishWrittenRegisters();
+  }
+
+  void publishWrittenRegisters() {
+    markRegistersWritten(RVISA::GPR, m_harts[0]->takeWrittenRegisters());
+    for (unsigned id = 1; id < N; ++id)
+      m_harts[id]->takeWrittenRegisters();
+  }
+
+  bool canRunAhead() {
+    // Events may interact with the harts at any cycle.
+    return N > 1 && m_quantum != 0 && !m_emitsSignals &&
+           m_cycleCount >= m_serialUntil &&
+           events().nextCycle() > m_cycleCount + m_quantum;
+  }
+
+  /**
+   * @brief runAhead
+   * Executes a quantum of the harts in parallel. @returns whether the quantum
+   * was committed, in which case the harts have run ahead of the cycle count.
+   */
+  bool runAhead() {
+    parallelFor(N, 1, [&](size_t begin, size_t end) {
+      for (size_t id = begin; id < end; ++id)
+        m_harts[id]->speculate(m_quantum);
+    });
+
+    if (!canCommit()) {
+      for (auto &hart : m_harts)
+        hart->discard();
+      m_serialUntil = m_cycleCount + static_cast<long long>(m_backoff) *
+                                         m_quantum;
+      m_backoff = std::min(m_backoff * 2, c_maxBackoff);
+      return false;
+    }
+    m_backoff = 1;
+
+    m_coherenceAtQuantumStart = m_coherence;
+    m_undoLog.clear();
+    size_t cycles = 0;
+    for (auto &hart : m_harts) {
+      for (const auto &store : hart->bufferedStores()) {
+        for (unsigned i = 0; i < store.bytes; ++i)
+          m_undoLog.push_back(
+              {store.address + i, m_memory.readMemConst(store.address + i, 1)});
+        m_memory.writeMem(store.address, store.value, store.bytes);
+      }
+      cycles = std::max(cycles, hart->quantumCycles());
+    }
+    for (size_t i = 0; i < cycles; ++i) {
+      for (unsigned id = 0; id < N; ++id) {
+        if (i < m_harts[id]->quantumCycles())
+          performAccess(id, m_harts[id]->quantumAccess(i), false);
+      }
+    }
+    publishWrittenRegisters();
+
+    m_ahead = true;
+    m_aheadStart = m_cycleCount;
+    m_aheadEnd = m_cycleCount + cycles;
+    return true;
+  }
+
+  /// Returns whether the speculatively executed harts did not observe each
+  /// other.
+  bool canCommit() const {
+    std::unordered_map<AInt, unsigned> writers;
+    for (unsigned id = 0; id < N; ++id) {
+      if (m_harts[id]->aborted())
+        return false;
+      for (const AInt granule : m_harts[id]->writtenGranules()) {
+        if (!writers.emplace(granule, id).second)
+          return false;
+      }
+    }
+    for (unsigned id = 0; id < N; ++id) {
+      for (const AInt granule : m_harts[id]->readGranules()) {
+        const auto it = writers.find(granule);
+        if (it != writers.end() && it->second != id)
+          return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @brief sync
+   * Brings the harts back to the current cycle, if they have run ahead, by
+   * restoring the state at the start of the quantum and executing the
+   * intervening cycles on a single thread. Does not modify the observable
+   * state of the processor.
+   */
+  void sync() const {
+    if (m_ahead)
+      const_cast<RVMH *>(this)->catchUp();
+  }
+  void catchUp() {
+    for (auto it = m_undoLog.rbegin(); it != m_undoLog.rend(); ++it)
+      m_memory.writeMem(it->address, it->value, 1);
+    m_undoLog.clear();
+    for (auto &hart : m_harts)
+      hart->discard();
+    m_coherence = m_coherenceAtQuantumStart;
+    m_ahead = false;
+
+    for (long long i = m_aheadStart; i < m_cycleCount; ++i)
+      cycle();
+    markAllRegistersWritten();
+  }
+
+  AInt hartPc(unsigned id) const {
+    const Hart &hart = *m_harts.at(id);
+    if (m_ahead) {
+      const size_t i = m_cycleCount - m_aheadStart;
+      if (i < hart.quantumCycles())
+        return hart.quantumPc(i);
+    }
+    return hart.pc();
+  }
+  bool hartFinished(unsigned id) const {
+    const Hart &hart = *m_harts.at(id);
+    if (m_ahead &&
+        static_cast<size_t>(m_cycleCount - m_aheadStart) < hart.quantumCycles())
+      return false;
+    return hart.finished();
+  }
+
+  PagedMemory m_memory;
+  std::array<std::unique_ptr<Hart>, N> m_harts;
+  CoherenceSim m_coherence;
+  ProcessorStructure m_structure;
+  long long m_cycleCount = 0;
+  // The hart whose registers are accessed through the processor.
+  unsigned m_current = 0;
+  bool m_inTrap = false;
+
+  // Parallel execution state
+  unsigned m_quantum = c_defaultQuantum;
+  // Cycle until which quanta are not executed in parallel, and the number of
+  // quanta to wait after the next quantum which cannot be committed.
+  long long m_serialUntil = 0;
+  unsigned m_backoff = 1;
+  // Whether the harts have run ahead of the cycle count, and the cycles at
+  // which the quantum started and the harts have since been executed until.
+  bool m_ahead = false;
+  long long m_aheadStart = 0;
+  long long m_aheadEnd = 0;
+  // Memory written by the committed quantum, in order of writing.
+  std::vector<MemoryUndo> m_undoLog;
+  CoherenceSim m_coherenceAtQuantumStart;
+};
+
+} // namespace Ripes
@@ -0,0 +1,685 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <optional>
+#include <vector>
+
+#include "../rv_targetpredictor.h"
+#include "../rviss/rviss.h"
+
+namespace Ripes {
+
+/**
+ * @brief The RVOOO class
+ * Out-of-order superscalar RISC-V processor model, fetching, dispatching,
+ * issuing and committing up to W instructions per cycle. Rather than modelling
+ * a datapath, the model is a timing model built upon the functional model of
+ * RVISS: instructions are executed functionally once fetched, in program
+ * order, and the model tracks when each instruction would pass through the
+ * stages of an out-of-order pipeline:
+ *  - IF: fetched, ending a fetch group on taken control flow. Branches are
+ *    predicted by 2-bit counters and a branch target buffer; fetching stops
+ *    after a mispredicted instruction until the instruction is resolved.
+ *    Optionally, the targets of returns and other indirect jumps are
+ *    predicted by a return-address stack and an indirect-target predictor
+ *    (see setTargetPrediction).
+ *  - ID: decoded and renamed. Source registers are renamed to the reorder
+ *    buffer (ROB) entries producing them.
+ *  - IQ: dispatched to the ROB, the issue queue and, for memory instructions,
+ *    the load/store queue. Instructions wait in the issue queue until their
+ *    operands are available.
+ *  - EX: issued, oldest first, to W ALUs, a multiplier, a divider and a
+ *    single memory port. The multiplier and divider are timed by
+ *    functionalUnitTiming; by default, the multiplier is pipelined and the
+ *    divider iterative. Each custom instruction (see RVISA::ExtCustom)
+ *    issues to a unit of its own, timed by its registration. Loads issue once
+ *    the addresses of all older stores are known, and are forwarded the data
+ *    of an older overlapping store instead of accessing memory.
+ *  - WB: completed, waiting in the ROB to commit in order.
+ *  - CM: committing in the following cycle. Stores access memory as they
+ *    commit, occupying the memory port.
+ *
+ * Each of the W lanes of a stage shows one of the instructions in the stage,
+ * oldest first. Ecalls are serializing: fetching stops after an ecall, which
+ * is executed once it commits. Since the speculative state is only ever on the
+ * correct path, the register file of the processor reflects the committed
+ * state, whereas memory reflects the state of the fetched instructions.
+ *
+ * The model is not reversible, and does not take interrupts.
+ */
+template <typename XLEN_T, unsigned W>
+class RVOOO : public RVISS<XLEN_T>, public TargetPredictionProcessor {
+  using Base = RVISS<XLEN_T>;
+  using Base::execute;
+  using Base::fetchInstruction;
+  using Base::m_cycleCount;
+  using Base::m_dataAccess;
+  using Base::m_finished;
+  using Base::m_instructionsRetired;
+  using Base::m_pc;
+  using Base::m_regs;
+  using Base::m_writtenRegs;
+  using RipesProcessor::isExecutableAddress;
+  using RipesProcessor::m_countPerformance;
+  using RipesProcessor::m_emitsSignals;
+  using RipesProcessor::m_performanceCounters;
+  using RipesProcessor::markRegistersWritten;
+
+public:
+  // Capacities of the instruction window.
+  static constexpr unsigned c_robSize = 16 * W;
+  static constexpr unsigned c_iqSize = 8 * W;
+  static constexpr unsigned c_lsqSize = 4 * W;
+  // Execution latencies in cycles. Those of the multiplier and divider are
+  // given by functionalUnitTiming.
+  static constexpr unsigned c_aluLatency = 1;
+  static constexpr unsigned c_loadLatency = 2;
+  // Sizes of the branch history table and branch target buffer, in log2.
+  static constexpr unsigned c_bhtBits = 10;
+  static constexpr unsigned c_btbBits = 6;
+
+  enum Stage { IF, ID, IQ, EX, WB, CM, NUM_STAGES };
+
+  RVOOO(const QStringList &extensions) : Base(extensions) {
+    this->m_features = RipesProcessor::hasICacheInterface |
+                       RipesProcessor::hasDCacheInterface |
+                       RipesProcessor::hasPerformanceCounters |
+                       RipesProcessor::hasFunctionalUnitTiming;
+    for (unsigned lane = 0; lane < W; ++lane)
+      m_oooStructure[lane] = NUM_STAGES;
+    m_customBusyUntil.assign(RVISA::ExtCustom::instructions().size(), 0);
+    resetPredictor();
+  }
+
+  // The vector and floating-point extensions of the functional model are not
+  // timed.
+  static ProcessorISAInfo supportsISA() {
+    return RVISA::supportsISA<sizeof(XLEN_T) * CHAR_BIT>(true);
+  }
+
+  const ProcessorStructure &structure() const override {
+    return m_oooStructure;
+  }
+  unsigned int getPcForStage(StageIndex idx) const override {
+    return stageInfo(idx).pc;
+  }
+  QString stageName(StageIndex idx) const override {
+    switch (idx.index()) {
+    case IF:
+      return "IF";
+    case ID:
+      return "ID";
+    case IQ:
+      return "IQ";
+    case EX:
+      return "EX";
+    case WB:
+      return "WB";
+    case CM:
+      return "CM";
+    default:
+      return "?";
+    }
+  }
+  StageInfo stageInfo(StageIndex idx) const override {
+    unsigned lane = 0;
+    for (const auto &entry : m_window) {
+      if (entry.stage != idx.index() || lane++ != idx.lane())
+        continue;
+      const bool stalled = entry.stage == IQ && entry.waiting;
+      return StageInfo({entry.pc, true,
+                        stalled ? StageInfo::State::Stalled
+                                : StageInfo::State::None});
+    }
+    return StageInfo({0, false, StageInfo::State::None});
+  }
+  bool finished() const override {
+    return m_finished || (m_window.empty() && !isExecutableAddress(m_pc));
+  }
+
+  VInt getRegister(const std::string_view &, unsigned i) const override {
+    return m_archRegs.at(i);
+  }
+  VInt readRegister(const RegisterFileHandle &, unsigned i) const override {
+    return m_archRegs[i];
+  }
+  void readRegisters(const RegisterFileHandle &, VInt *values) const override {
+    std::copy(m_archRegs.begin(), m_archRegs.end(), values);
+  }
+  void setRegister(const std::string_view &rfid, unsigned i, VInt v) override {
+    if (i != 0)
+      m_archRegs.at(i) = static_cast<XLEN_T>(v);
+    Base::setRegister(rfid, i, v);
+  }
+
+  MemoryAccess dataMemAccess() const override { return m_cycleDataAccess; }
+  MemoryAccess instrMemAccess() const override { return m_cycleInstrAccess; }
+
+  void resetProcessor() override {
+    m_window.clear();
+    m_rat.fill(std::nullopt);
+    m_archRegs.fill(0);
+    m_nextSeq = 0;
+    m_fetchBlocker.reset();
+    m_mulBusyUntil = 0;
+    m_divBusyUntil = 0;
+    m_customBusyUntil.assign(RVISA::ExtCustom::instructions().size(), 0);
+    m_cycleDataAccess = MemoryAccess();
+    m_cycleInstrAccess = MemoryAccess();
+    m_performanceCounters = PerformanceCounters();
+    resetPredictor();
+    Base::resetProcessor();
+  }
+
+  void setTargetPrediction(const TargetPredictionConfig &config) override {
+    m_targetPrediction = config;
+    m_ras.resize(config.rasEntries);
+    m_itp.resize(config.indirectEntries);
+  }
+  const TargetPredictionConfig &targetPrediction() const override {
+    return m_targetPrediction;
+  }
+
+  void setMaxReverseCycles(unsigned) override {}
+  void reverseProcessor() override {}
+  void idleUntil(long long) override {}
+  // The instructions in flight through the reorder buffer are not saved.
+  bool saveState(std::vector<uint64_t> &) const override { return false; }
+  bool restoreState(const std::vector<uint64_t> &) override { return false; }
+
+protected:
+  void clockProcessor() override {
+    if (m_countPerformance)
+      this->countStageStates(1);
+    m_cycleDataAccess = MemoryAccess();
+    m_cycleInstrAccess = MemoryAccess();
+    const long long now = ++m_cycleCount;
+
+    // Stages are processed from the back of the pipeline, such that each
+    // instruction advances at most one stage per cycle.
+    commit();
+    complete(now);
+    issue(now);
+    dispatch();
+    decode();
+    fetch();
+    markCommits();
+
+    markRegistersWritten(RVISA::GPR, m_committedRegs);
+    m_committedRegs = 0;
+    m_writtenRegs = 0;
+    if (m_emitsSignals)
+      this->processorWasClocked.Emit();
+  }
+
+private:
+  enum class Unit { ALU, MUL, DIV, CUSTOM, LOAD, STORE, ECALL };
+
+  struct Entry {
+    uint64_t seq = 0;
+    AInt pc = 0;
+    Stage stage = IF;
+    Unit unit = Unit::ALU;
+    // Index of the custom instruction executed in Unit::CUSTOM.
+    int custom = -1;
+    // Destination register, or 0 if the instruction writes no register.
+    unsigned rd = 0;
+    XLEN_T result = 0;
+    std::array<unsigned, 2> srcs{};
+    unsigned numSrcs = 0;
+    // ROB entries producing the sources, assigned when renamed.
+    std::array<std::optional<uint64_t>, 2> producers;
+    // Cycle in which the result of an issued instruction is available.
+    long long readyCycle = 0;
+    MemoryAccess access;
+    bool isBranch = false;
+    JumpHints hints;
+    bool taken = false;
+    bool mispredicted = false;
+    // Whether the instruction waited on an operand in the latest cycle.
+    bool waiting = false;
+  };
+
+  struct BTBEntry {
+    bool valid = false;
+    AInt tag = 0;
+    AInt target = 0;
+  };
+
+  static bool isMemory(Unit unit) {
+    return unit == Unit::LOAD || unit == Unit::STORE;
+  }
+
+  Entry *entry(uint64_t seq) {
+    if (m_window.empty() || seq < m_window.front().seq)
+      return nullptr;
+    return &m_window.at(seq - m_window.front().seq);
+  }
+
+  void commit() {
+    while (!m_window.empty() && m_window.front().stage == CM) {
+      Entry &e = m_window.front();
+      if (e.unit == Unit::STORE)
+        m_cycleDataAccess = e.access;
+      if (e.unit == Unit::ECALL) {
+        // All older instructions have committed and no younger instructions
+        // have been fetched, such that the ecall observes the committed state.
+        execute();
+        m_fetchBlocker.reset();
+      }
+      if (e.rd != 0) {
+        m_archRegs[e.rd] = e.result;
+        m_committedRegs |= uint64_t(1) << e.rd;
+        if (m_rat[e.rd] == e.seq)
+          m_rat[e.rd].reset();
+      }
+      if (m_countPerformance && e.isBranch) {
+        m_performanceCounters.branches++;
+        m_performanceCounters.branchesTaken += e.taken;
+      }
+      if (m_countPerformance && e.mispredicted)
+        m_performanceCounters.mispredicts++;
+      if (m_countPerformance && e.unit == Unit::CUSTOM) {
+        const auto &custom = RVISA::ExtCustom::instructions()[e.custom];
+        m_performanceCounters.customInstructions[custom.name]++;
+      }
+      if (m_countPerformance && (e.hints.pop || e.hints.indirect)) {
+        auto &targets = e.hints.pop ? m_performanceCounters.returns
+                                    : m_performanceCounters.indirectJumps;
+        targets.hits += !e.mispredicted;
+        targets.misses += e.mispredicted;
+      }
+      m_instructionsRetired++;
+      m_window.pop_front();
+    }
+  }
+
+  void complete(long long now) {
+    for (auto &e : m_window) {
+      if (e.stage != EX || e.readyCycle > now)
+        continue;
+      e.stage = WB;
+      // Fetching resumes on the resolved path.
+      if (m_fetchBlocker == e.seq && e.unit != Unit::ECALL)
+        m_fetchBlocker.reset();
+    }
+  }
+
+  /// Returns whether the operand produced by @p producer is available in cycle
+  /// @p now.
+  bool operandReady(const std::optional<uint64_t> &producer, long long now) {
+    const Entry *p = producer ? entry(*producer) : nullptr;
+    return !p || (p->stage >= EX && p->readyCycle <= now);
+  }
+
+  void issue(long long now) {
+    unsigned issued = 0;
+    // Committing stores occupy the memory port.
+    bool portUsed = m_cycleDataAccess.type != MemoryAccess::None;
+    bool olderStoreUnissued = false;
+    bool oldest = true;
+    bool unitBusy = false;
+    const auto &timing = this->functionalUnitTiming;
+    for (auto &e : m_window) {
+      if (e.stage == IF || e.stage == ID)
+        break;
+      if (e.stage != IQ)
+        continue;
+
+      bool ready = true;
+      bool waitsOnLoad = false;
+      for (unsigned i = 0; i < e.numSrcs; ++i) {
+        if (!operandReady(e.producers[i], now)) {
+          ready = false;
+          waitsOnLoad |= entry(*e.producers[i])->unit == Unit::LOAD;
+        }
+      }
+      e.waiting = !ready;
+      if (m_countPerformance && oldest && !ready) {
+        m_performanceCounters.dataHazards++;
+        m_performanceCounters.loadUseHazards += waitsOnLoad;
+      }
+      oldest = false;
+
+      bool canIssue = ready && issued < W;
+      switch (e.unit) {
+      case Unit::MUL:
+        unitBusy |= ready && m_mulBusyUntil > now;
+        canIssue &= m_mulBusyUntil <= now;
+        break;
+      case Unit::DIV:
+        unitBusy |= ready && m_divBusyUntil > now;
+        canIssue &= m_divBusyUntil <= now;
+        break;
+      case Unit::CUSTOM:
+        unitBusy |= ready && m_customBusyUntil.at(e.custom) > now;
+        canIssue &= m_customBusyUntil.at(e.custom) <= now;
+        break;
+      case Unit::LOAD:
+        canIssue &= !portUsed && !olderStoreUnissued;
+        break;
+      default:
+        break;
+      }
+      if (!canIssue) {
+        olderStoreUnissued |= e.unit == Unit::STORE;
+        continue;
+      }
+
+      unsigned latency = c_aluLatency;
+      switch (e.unit) {
+      case Unit::MUL:
+        latency = std::max(timing.mul.latency, 1u);
+        m_mulBusyUntil = now + std::max(timing.mul.interval, 1u);
+        break;
+      case Unit::DIV:
+        latency = std::max(timing.div.latency, 1u);
+        m_divBusyUntil = now + std::max(timing.div.interval, 1u);
+        break;
+      case Unit::CUSTOM: {
+        const auto &custom = RVISA::ExtCustom::instructions()[e.custom].timing;
+        latency = std::max(custom.latency, 1u);
+        m_customBusyUntil.at(e.custom) = now + std::max(custom.interval, 1u);
+        break;
+      }
+      case Unit::LOAD:
+        latency = c_loadLatency;
+        if (!forwardsFromStore(e)) {
+          portUsed = true;
+          m_cycleDataAccess = e.access;
+        }
+        break;
+      default:
+        break;
+      }
+      if (m_countPerformance) {
+        // Operands of uncommitted producers are bypassed to the execute
+        // stage.
+        for (unsigned i = 0; i < e.numSrcs; ++i)
+          m_performanceCounters.forwards +=
+              e.producers[i] && entry(*e.producers[i]) != nullptr;
+      }
+      e.stage = EX;
+      e.readyCycle = now + latency;
+      issued++;
+    }
+    if (m_countPerformance) {
+      if (issued > 0) {
+        m_performanceCounters.issueCycles++;
+        m_performanceCounters.dualIssueCycles += issued >= 2;
+      }
+      m_performanceCounters.functionalUnitStalls += unitBusy;
+    }
+  }
+
+  /// Returns whether an uncommitted store older than the load @p load
+  /// overlaps the bytes accessed by the load.
+  bool forwardsFromStore(const Entry &load) const {
+    const AInt begin = load.access.address;
+    const AInt end = begin + load.access.bytes;
+    for (const auto &e : m_window) {
+      if (e.seq == load.seq)
+        break;
+      if (e.unit != Unit::STORE)
+        continue;
+      const AInt storeBegin = e.access.address;
+      const AInt storeEnd = storeBegin + e.access.bytes;
+      if (storeBegin < end && begin < storeEnd)
+        return true;
+    }
+    return false;
+  }
+
+  void dispatch() {
+    unsigned rob = 0, iq = 0, lsq = 0;
+    for (const auto &e : m_window) {
+      if (e.stage < IQ)
+        continue;
+      rob++;
+      iq += e.stage == IQ;
+      lsq += isMemory(e.unit);
+    }
+
+    unsigned dispatched = 0;
+    for (auto &e : m_window) {
+      if (e.stage != ID)
+        continue;
+      if (dispatched == W || rob == c_robSize || iq == c_iqSize ||
+          (isMemory(e.unit) && lsq == c_lsqSize))
+        break;
+      for (unsigned i = 0; i < e.numSrcs; ++i)
+        e.producers[i] = m_rat[e.srcs[i]];
+      if (e.rd != 0)
+        m_rat[e.rd] = e.seq;
+      e.stage = IQ;
+      dispatched++;
+      rob++;
+      iq++;
+      lsq += isMemory(e.unit);
+    }
+  }
+
+  void decode() {
+    unsigned decoding = 0;
+    for (const auto &e : m_window)
+      decoding += e.stage == ID;
+    for (auto &e : m_window) {
+      if (e.stage != IF)
+        continue;
+      if (decoding == W)
+        break;
+      e.stage = ID;
+      decoding++;
+    }
+  }
+
+  void fetch() {
+    if (m_fetchBlocker)
+      return;
+    unsigned fetching = 0;
+    for (const auto &e : m_window)
+      fetching += e.stage == IF;
+
+    for (; fetching < W; ++fetching) {
+      if (!isExecutableAddress(m_pc))
+        break;
+      Entry e;
+      e.seq = m_nextSeq++;
+      e.pc = m_pc;
+      unsigned bytes;
+      const XLEN_T instr = fetchInstruction(bytes);
+      if (m_cycleInstrAccess.type == MemoryAccess::None)
+        m_cycleInstrAccess = {MemoryAccess::Read, m_pc, bytes};
+      decodeInstruction(e, instr);
+
+      if (e.unit == Unit::ECALL) {
+        // Executed once committed.
+        m_fetchBlocker = e.seq;
+        m_window.push_back(e);
+        break;
+      }
+
+      execute();
+      e.result = e.rd != 0 ? m_regs[e.rd] : 0;
+      if (isMemory(e.unit))
+        e.access = m_dataAccess;
+      e.taken = m_pc != static_cast<XLEN_T>(e.pc + bytes);
+      const unsigned opcode = instr & 0x7F;
+      if (opcode == RVISA::OpcodeID::JAL || opcode == RVISA::OpcodeID::JALR)
+        e.hints = JumpHints::of(opcode == RVISA::OpcodeID::JALR,
+                                (instr >> 7) & 0x1F, (instr >> 15) & 0x1F);
+      if (e.isBranch || opcode == RVISA::OpcodeID::JALR)
+        e.mispredicted = predict(e, opcode == RVISA::OpcodeID::JALR);
+      m_ras.update(e.hints.pop, e.hints.push, e.pc + bytes);
+      m_window.push_back(e);
+
+      if (e.mispredicted) {
+        m_fetchBlocker = e.seq;
+        break;
+      }
+      // Fetch groups end at taken control flow.
+      if (e.taken)
+        break;
+    }
+  }
+
+  void markCommits() {
+    unsigned committing = 0;
+    bool store = false;
+    for (auto &e : m_window) {
+      if (e.stage != WB || committing == W)
+        break;
+      // A single store commits per cycle, through the memory port.
+      if (e.unit == Unit::STORE) {
+        if (store)
+          break;
+        store = true;
+      }
+      e.stage = CM;
+      committing++;
+    }
+  }
+
+  void decodeInstruction(Entry &e, XLEN_T instr) const {
+    const unsigned opcode = instr & 0x7F;
+    const unsigned rd = (instr >> 7) & 0x1F;
+    const unsigned rs1 = (instr >> 15) & 0x1F;
+    const unsigned rs2 = (instr >> 20) & 0x1F;
+    const unsigned funct3 = (instr >> 12) & 0x7;
+    const unsigned funct7 = (instr >> 25) & 0x7F;
+    const auto setSrcs = [&](std::initializer_list<unsigned> srcs) {
+      for (const unsigned src : srcs)
+        if (src != 0)
+          e.srcs[e.numSrcs++] = src;
+    };
+
+    switch (opcode) {
+    case RVISA::OpcodeID::LUI:
+    case RVISA::OpcodeID::AUIPC:
+    case RVISA::OpcodeID::JAL:
+      e.rd = rd;
+      break;
+    case RVISA::OpcodeID::JALR:
+    case RVISA::OpcodeID::OPIMM:
+    case RVISA::OpcodeID::OPIMM32:
+      e.rd = rd;
+      setSrcs({rs1});
+      break;
+    case RVISA::OpcodeID::LOAD:
+      e.unit = Unit::LOAD;
+      e.rd = rd;
+      setSrcs({rs1});
+      break;
+    case RVISA::OpcodeID::STORE:
+      e.unit = Unit::STORE;
+      setSrcs({rs1, rs2});
+      break;
+    case RVISA::OpcodeID::AMO:
+      // Atomics are timed as stores, accessing memory as they commit, except
+      // for LR which only reads memory.
+      e.unit = ((instr >> 27) & 0x1F) == 0b00010 ? Unit::LOAD : Unit::STORE;
+      e.rd = rd;
+      setSrcs({rs1, rs2});
+      break;
+    case RVISA::OpcodeID::BRANCH:
+      e.isBranch = true;
+      setSrcs({rs1, rs2});
+      break;
+    case RVISA::OpcodeID::OP:
+    case RVISA::OpcodeID::OP32:
+      e.rd = rd;
+      setSrcs({rs1, rs2});
+      if (funct7 == 0b0000001)
+        e.unit = funct3 < 0b100 ? Unit::MUL : Unit::DIV;
+      break;
+    case RVISA::OpcodeID::CUSTOM0:
+    case RVISA::OpcodeID::CUSTOM1:
+    case RVISA::OpcodeID::CUSTOM2:
+    case RVISA::OpcodeID::CUSTOM3:
+      e.custom = RVISA::ExtCustom::find(instr);
+      if (e.custom < 0)
+        break;
+      e.unit = Unit::CUSTOM;
+      e.rd = rd;
+      if (RVISA::ExtCustom::instructions()[e.custom].readsRs2)
+        setSrcs({rs1, rs2});
+      else
+        setSrcs({rs1});
+      break;
+    case RVISA::OpcodeID::SYSTEM:
+      if (instr == 0x00000073)
+        e.unit = Unit::ECALL;
+      break;
+    default:
+      break;
+    }
+  }
+
+  /// Predicts the control flow of @p e, trains the predictor on its outcome
+  /// and returns whether it was mispredicted.
+  bool predict(const Entry &e, bool indirect) {
+    const AInt target = m_pc;
+    uint8_t &counter = m_bht[(e.pc >> 1) & ((1u << c_bhtBits) - 1)];
+    BTBEntry &btb = m_btb[(e.pc >> 1) & ((1u << c_btbBits) - 1)];
+    const bool btbHit = btb.valid && btb.tag == e.pc;
+    const bool predictTaken = btbHit && (indirect || counter >= 2);
+    // The target predictors take precedence over the BTB.
+    std::optional<AInt> predictedTarget;
+    if (e.hints.pop)
+      predictedTarget = m_ras.peek();
+    else if (e.hints.indirect)
+      predictedTarget = m_itp.predict(e.pc, m_itp.history());
+    const bool mispredicted =
+        predictTaken != e.taken ||
+        (e.taken && predictedTarget.value_or(btb.target) != target);
+
+    if (e.isBranch) {
+      if (e.taken && counter < 3)
+        counter++;
+      else if (!e.taken && counter > 0)
+        counter--;
+    }
+    if (e.taken)
+      btb = {true, e.pc, target};
+    if (e.hints.indirect)
+      m_itp.update(e.pc, target);
+    return mispredicted;
+  }
+
+  void resetPredictor() {
+    // 2-bit counters are initialized as weakly not taken.
+    m_bht.assign(1u << c_bhtBits, 1);
+    m_btb.assign(1u << c_btbBits, BTBEntry());
+    m_ras.clear();
+    m_itp.clear();
+  }
+
+  ProcessorStructure m_oooStructure;
+  // Instructions in flight in program order, from the oldest instruction in
+  // the ROB to the youngest fetched instruction.
+  std::deque<Entry> m_window;
+  uint64_t m_nextSeq = 0;
+  // Register alias table; the youngest uncommitted producer of each register.
+  std::array<std::optional<uint64_t>, c_RVRegs> m_rat;
+  // Committed register state.
+  std::array<XLEN_T, c_RVRegs> m_archRegs{};
+  uint64_t m_committedRegs = 0;
+  // Instruction after which fetching is stopped until it resolves.
+  std::optional<uint64_t> m_fetchBlocker;
+  // Cycles from which the multiplier and divider accept operations.
+  long long m_mulBusyUntil = 0;
+  long long m_divBusyUntil = 0;
+  // Cycles from which the unit of each custom instruction accepts operations.
+  std::vector<long long> m_customBusyUntil;
+  std::vector<uint8_t> m_bht;
+  std::vector<BTBEntry> m_btb;
+  ReturnAddressStack m_ras;
+  IndirectTargetPredictor m_itp;
+  TargetPredictionConfig m_targetPrediction;
+  MemoryAccess m_cycleDataAccess;
+  MemoryAccess m_cycleInstrAccess;
+};
+
+} // namespace Ripes
@@ -0,0 +1,818 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <initializer_list>
+#include <optional>
+
+#include <QStringList>
+
+#include "../rv_fetchqueue.h"
+#include "../rviss/rviss.h"
+
+namespace Ripes {
+
+/// Functions of the stages of a generated pipeline (see RVPipeline). A stage
+/// may combine several functions, such as EX | MEM | WB.
+namespace PipelineStage {
+enum : unsigned { IF = 0b1, ID = 0b10, EX = 0b100, MEM = 0b1000, WB = 0b10000 };
+} // namespace PipelineStage
+
+/// Returns the bitmask of the stage indices @p stages.
+constexpr unsigned stageMask(std::initializer_list<unsigned> stages) {
+  unsigned mask = 0;
+  for (const unsigned stage : stages)
+    mask |= 1u << stage;
+  return mask;
+}
+
+/**
+ * @brief The RVPipeline class
+ * In-order, single-issue RISC-V pipeline generated from a pipeline
+ * description. A description is a type with the static constexpr members:
+ *  - stages: a std::array of the functions of each stage (see PipelineStage),
+ *    from fetch to write-back. One or more IF stages are followed by a single
+ *    ID stage and one or more EX stages. The MEM stages follow, or are part
+ *    of, the EX stages, and the last stage writes back.
+ *  - branchStage: the index of the stage in which control flow resolves, at
+ *    or after the first EX stage.
+ *  - forwardFrom: the stageMask of the stages from which results are forwarded
+ *    to the first EX stage.
+ * The structure, stage names and hazard detection of the pipeline are derived
+ * from the description. The number of EX stages is the latency of the ALU,
+ * whereas multiplications and divisions execute in the multiplier and divider
+ * timed by functionalUnitTiming.
+ *
+ * Like RVOOO, the model is a timing model built upon the functional model of
+ * RVISS: instructions are executed once fetched, and the model tracks their
+ * progress through the stages:
+ *  - Operands are read in the ID stage and consumed by the first EX stage.
+ *    The register file is written in the first half of a cycle and read in
+ *    the second half. An instruction stalls in the ID stage until each of its
+ *    operands has been computed (by the last EX stage, or the last MEM stage
+ *    for loads) and is either forwarded or written to the register file.
+ *    Stalls hold the IF and ID stages, and insert a bubble into the first EX
+ *    stage.
+ *  - Multiplications and divisions enter their unit as they enter the first
+ *    EX stage, stalling in the ID stage while the unit is busy, and continue
+ *    down the pipeline whilst the unit computes their result. Once in the last
+ *    stage, an instruction whose result has yet to be computed stalls the
+ *    pipeline as a whole. Floating-point multiplications and fused
+ *    multiply-adds execute in the multiplier, floating-point divisions and
+ *    square roots in the divider, and the remaining floating-point
+ *    instructions in the ALU. Each custom instruction (see RVISA::ExtCustom)
+ *    executes likewise in a unit of its own, timed by its registration.
+ *  - Branches are predicted as not taken. Taken control flow flushes the
+ *    stages preceding the branch stage once resolved, such that every taken
+ *    branch or jump costs branchStage cycles.
+ *  - Ecalls are serializing: fetching stops after an ecall, which is executed
+ *    as it leaves the pipeline.
+ *  - With a fetch queue (see FetchQueueConfig), a fetch unit fetches whole
+ *    lines into the queue, from which the first IF stage takes an instruction
+ *    per cycle. The queue adds a stage to the front end, and the latency of
+ *    the line accesses delays the fetch unit rather than stalling the pipeline
+ *    (see RipesProcessor::delayFetch). Fetch stalls and backend stalls are
+ *    counted at the queue.
+ * Register writes become visible as instructions leave the pipeline, whereas
+ * memory reflects the state of the fetched instructions.
+ *
+ * The model is not reversible, and does not take interrupts.
+ */
+template <typename XLEN_T, typename Desc>
+class RVPipeline : public RVISS<XLEN_T>, public FetchQueueProcessor {
+  using Base = RVISS<XLEN_T>;
+  using Base::execute;
+  using Base::fetchInstruction;
+  using Base::m_cycleCount;
+  using Base::m_dataAccess;
+  using Base::m_finished;
+  using Base::m_instructionsRetired;
+  using Base::m_pc;
+  using Base::m_regs;
+  using Base::m_writtenRegs;
+  using RipesProcessor::isExecutableAddress;
+  using RipesProcessor::m_countPerformance;
+  using RipesProcessor::m_emitsSignals;
+  using RipesProcessor::m_performanceCounters;
+  using RipesProcessor::markRegistersWritten;
+
+  static constexpr unsigned D = Desc::stages.size();
+
+  static constexpr unsigned firstStage(unsigned function) {
+    for (unsigned s = 0; s < D; ++s)
+      if (Desc::stages[s] & function)
+        return s;
+    return D;
+  }
+  static constexpr unsigned lastStage(unsigned function) {
+    for (unsigned s = D; s > 0; --s)
+      if (Desc::stages[s - 1] & function)
+        return s - 1;
+    return D;
+  }
+  static constexpr unsigned countStages(unsigned function) {
+    unsigned count = 0;
+    for (unsigned s = 0; s < D; ++s)
+      count += (Desc::stages[s] & function) != 0;
+    return count;
+  }
+  static constexpr bool contiguous(unsigned function) {
+    return countStages(function) != 0 &&
+           lastStage(function) - firstStage(function) + 1 ==
+               countStages(function);
+  }
+
+public:
+  static constexpr unsigned c_decodeStage = firstStage(PipelineStage::ID);
+  static constexpr unsigned c_exStage = firstStage(PipelineStage::EX);
+  static constexpr unsigned c_aluLatency = countStages(PipelineStage::EX);
+  static constexpr unsigned c_memStage = firstStage(PipelineStage::MEM);
+  // Stages at the end of which results are computed.
+  static constexpr unsigned c_aluResultStage = lastStage(PipelineStage::EX);
+  static constexpr unsigned c_loadResultStage = lastStage(PipelineStage::MEM);
+
+  static_assert(D >= 3 && D <= 16, "Pipelines span 3 to 16 stages");
+  static_assert(contiguous(PipelineStage::IF) &&
+                    firstStage(PipelineStage::IF) == 0 &&
+                    lastStage(PipelineStage::IF) + 1 == c_decodeStage,
+                "The pipeline starts with its IF stages");
+  static_assert(countStages(PipelineStage::ID) == 1 &&
+                    Desc::stages[c_decodeStage] == PipelineStage::ID,
+                "The pipeline has a single, dedicated, ID stage");
+  static_assert(contiguous(PipelineStage::EX) &&
+                    c_exStage == c_decodeStage + 1,
+                "The EX stages follow the ID stage");
+  static_assert(contiguous(PipelineStage::MEM) && c_memStage >= c_exStage,
+                "The MEM stages follow, or are part of, the EX stages");
+  static_assert(countStages(PipelineStage::WB) == 1 &&
+                    (Desc::stages[D - 1] & PipelineStage::WB),
+                "The last stage writes back");
+  static_assert(Desc::branchStage >= c_exStage && Desc::branchStage < D,
+                "Control flow resolves at or after the first EX stage");
+  static_assert((Desc::forwardFrom & ((2u << c_exStage) - 1)) == 0 &&
+                    (Desc::forwardFrom >> D) == 0,
+                "Results are forwarded from the stages following the first "
+                "EX stage");
+
+  RVPipeline(const QStringList &extensions) : Base(extensions) {
+    this->m_features = RipesProcessor::hasICacheInterface |
+                       RipesProcessor::hasDCacheInterface |
+                       RipesProcessor::hasPerformanceCounters |
+                       RipesProcessor::hasMemoryStalls |
+                       RipesProcessor::hasFunctionalUnitTiming;
+    m_pipelineStructure[0] = D;
+    m_customBusyUntil.assign(RVISA::ExtCustom::instructions().size(), 0);
+
+    // Stages are named by their functions, numbered if a function spans
+    // several stages.
+    static constexpr std::array<std::pair<unsigned, const char *>, 5>
+        functions = {{{PipelineStage::IF, "IF"},
+                      {PipelineStage::ID, "ID"},
+                      {PipelineStage::EX, "EX"},
+                      {PipelineStage::MEM, "MEM"},
+                      {PipelineStage::WB, "WB"}}};
+    for (unsigned s = 0; s < D; ++s) {
+      QStringList names;
+      for (const auto &[function, name] : functions) {
+        if (!(Desc::stages[s] & function))
+          continue;
+        names << name;
+        if (countStages(function) > 1)
+          names.last() += QString::number(s - firstStage(function) + 1);
+      }
+      m_stageNames << names.join("/");
+    }
+  }
+
+  const ProcessorStructure &structure() const override {
+    return m_pipelineStructure;
+  }
+  unsigned int getPcForStage(StageIndex idx) const override {
+    return stageInfo(idx).pc;
+  }
+  QString stageName(StageIndex idx) const override {
+    return m_stageNames.value(idx.index(), "?");
+  }
+  StageInfo stageInfo(StageIndex idx) const override {
+    const unsigned s = idx.index();
+    const auto &entry = m_stages.at(s);
+    const auto state = s < m_stalledStages   ? StageInfo::State::Stalled
+                       : s < m_flushedStages ? StageInfo::State::Flushed
+                                             : StageInfo::State::None;
+    return StageInfo({entry ? entry->pc : 0, entry.has_value(), state});
+  }
+  bool finished() const override {
+    if (m_finished)
+      return true;
+    for (const auto &entry : m_stages)
+      if (entry)
+        return false;
+    return m_fetchQueue.empty() && !isExecutableAddress(m_pc);
+  }
+
+  void setFetchQueue(const FetchQueueConfig &config) override {
+    m_fetchQueueConfig = config;
+    m_lineBytes = 4;
+    while (m_lineBytes * 2 <= config.lineBytes)
+      m_lineBytes *= 2;
+  }
+  const FetchQueueConfig &fetchQueue() const override {
+    return m_fetchQueueConfig;
+  }
+
+  VInt getRegister(const std::string_view &rfid, unsigned i) const override {
+    if (rfid == RVISA::FPR)
+      return m_archFRegs.at(i);
+    return m_archRegs.at(i);
+  }
+  VInt readRegister(const RegisterFileHandle &file, unsigned i) const override {
+    if (file.id == Base::c_fprFile)
+      return m_archFRegs[i];
+    return m_archRegs[i];
+  }
+  void readRegisters(const RegisterFileHandle &file,
+                     VInt *values) const override {
+    if (file.id == Base::c_fprFile)
+      std::copy(m_archFRegs.begin(), m_archFRegs.end(), values);
+    else
+      std::copy(m_archRegs.begin(), m_archRegs.end(), values);
+  }
+  void setRegister(const std::string_view &rfid, unsigned i, VInt v) override {
+    Base::setRegister(rfid, i, v);
+    if (rfid == RVISA::FPR)
+      m_archFRegs.at(i) = this->m_fpu.reg(i);
+    else if (i != 0)
+      m_archRegs.at(i) = static_cast<XLEN_T>(v);
+  }
+
+  MemoryAccess dataMemAccess() const override { return m_cycleDataAccess; }
+  MemoryAccess instrMemAccess() const override { return m_cycleInstrAccess; }
+
+  void resetProcessor() override {
+    m_stages.fill(std::nullopt);
+    m_archRegs.fill(0);
+    m_archFRegs.fill(0);
+    m_committedRegs = 0;
+    m_nextSeq = 0;
+    m_fetchBlocker.reset();
+    m_fetchQueue.clear();
+    m_fetchBusyUntil = 0;
+    m_lineEntries = 0;
+    m_unitBusyUntil.fill(0);
+    m_customBusyUntil.assign(RVISA::ExtCustom::instructions().size(), 0);
+    m_stalledStages = 0;
+    m_flushedStages = 0;
+    m_cycleDataAccess = MemoryAccess();
+    m_cycleInstrAccess = MemoryAccess();
+    m_performanceCounters = PerformanceCounters();
+    Base::resetProcessor();
+  }
+
+  void setMaxReverseCycles(unsigned) override {}
+  void reverseProcessor() override {}
+  void idleUntil(long long) override {}
+  // The instructions in flight through the stages and the fetch queue are not saved.
+  bool saveState(std::vector<uint64_t> &) const override { return false; }
+  bool restoreState(const std::vector<uint64_t> &) override { return false; }
+
+protected:
+  void clockProcessor() override {
+    if (m_countPerformance)
+      this->countStageStates(1);
+    m_cycleDataAccess = MemoryAccess();
+    m_cycleInstrAccess = MemoryAccess();
+    m_stalledStages = 0;
+    m_flushedStages = 0;
+    m_lineEntries = 0;
+    ++m_cycleCount;
+
+    const auto &last = m_stages[D - 1];
+    if (last && !computed(*last)) {
+      m_stalledStages = D;
+      if (m_countPerformance)
+        m_performanceCounters.functionalUnitStalls++;
+    } else {
+      advance();
+    }
+    if (m_countPerformance && m_stalledStages != 0 && queuedReady())
+      m_performanceCounters.backendStalls++;
+    // The fetch unit runs ahead of the pipeline, also whilst it stalls.
+    if (m_fetchQueueConfig.entries != 0)
+      fetchLine();
+
+    const auto &memory = m_stages[c_memStage];
+    if (memory && memory->memory && m_stalledStages != D)
+      m_cycleDataAccess = memory->access;
+
+    markRegistersWritten(RVISA::GPR, m_committedRegs);
+    m_committedRegs = 0;
+    m_writtenRegs = 0;
+    if (m_emitsSignals)
+      this->processorWasClocked.Emit();
+  }
+
+  void stallProcessor() override {
+    ++m_cycleCount;
+    if (m_emitsSignals)
+      this->processorWasClocked.Emit();
+  }
+
+  bool delayFetch(unsigned cycles) override {
+    if (m_fetchQueueConfig.entries == 0)
+      return false;
+    // The instructions of the line fetched in the current cycle are at the
+    // back of the queue.
+    for (size_t i = m_fetchQueue.size() - m_lineEntries;
+         i < m_fetchQueue.size(); ++i)
+      m_fetchQueue[i].readyCycle += cycles;
+    m_fetchBusyUntil += cycles;
+    return true;
+  }
+
+private:
+  enum class Unit { ALU, MUL, DIV, CUSTOM };
+
+  struct Entry {
+    uint64_t seq = 0;
+    AInt pc = 0;
+    // Destination register, or 0 if the instruction writes no register.
+    // Floating-point register f<i> is identified as c_RVRegs + i.
+    unsigned rd = 0;
+    uint64_t result = 0;
+    std::array<unsigned, 3> srcs{};
+    unsigned numSrcs = 0;
+    // Whether the result is loaded from memory, and whether memory is
+    // accessed.
+    bool load = false;
+    bool memory = false;
+    bool ecall = false;
+    bool isBranch = false;
+    bool taken = false;
+    MemoryAccess access;
+    Unit unit = Unit::ALU;
+    // Index of the custom instruction executed in Unit::CUSTOM.
+    int custom = -1;
+    // Cycle at the end of which the result is computed, for instructions
+    // which are not loads. Set as the instruction enters the first EX stage.
+    long long readyCycle = 0;
+  };
+
+  /// Advances the instructions by a stage, from the back of the pipeline.
+  /// Instructions past the ID stage only stall with the pipeline as a whole.
+  void advance() {
+    retire();
+    for (unsigned s = D - 1; s > c_exStage; --s)
+      m_stages[s] = m_stages[s - 1];
+
+    unsigned forwarded = 0;
+    bool waitsOnLoad = false;
+    const auto &decoded = m_stages[c_decodeStage];
+    const bool dataHazard =
+        decoded && !operandsReady(*decoded, forwarded, waitsOnLoad);
+    const bool unitBusy =
+        decoded && !dataHazard && unitBusyUntil(*decoded) > m_cycleCount;
+    if (dataHazard || unitBusy) {
+      m_stages[c_exStage].reset();
+      m_stalledStages = c_decodeStage + 1;
+      if (m_countPerformance) {
+        m_performanceCounters.dataHazards += dataHazard;
+        m_performanceCounters.loadUseHazards += waitsOnLoad;
+        m_performanceCounters.functionalUnitStalls += unitBusy;
+      }
+    } else {
+      if (m_countPerformance)
+        m_performanceCounters.forwards += forwarded;
+      for (unsigned s = c_exStage; s > 0; --s)
+        m_stages[s] = m_stages[s - 1];
+      if (auto &executed = m_stages[c_exStage])
+        enterUnit(*executed);
+      fetch();
+    }
+  }
+
+  long long unitBusyUntil(const Entry &e) const {
+    switch (e.unit) {
+    case Unit::ALU:
+      return 0;
+    case Unit::CUSTOM:
+      return m_customBusyUntil.at(e.custom);
+    default:
+      return m_unitBusyUntil.at(e.unit == Unit::DIV);
+    }
+  }
+
+  /// Times @p e, entering the first EX stage in the current cycle.
+  void enterUnit(Entry &e) {
+    unsigned latency = c_aluLatency;
+    if (e.unit == Unit::CUSTOM) {
+      const auto &timing = RVISA::ExtCustom::instructions()[e.custom].timing;
+      latency = std::max(timing.latency, 1u);
+      m_customBusyUntil.at(e.custom) =
+          m_cycleCount + std::max(timing.interval, 1u);
+    } else if (e.unit != Unit::ALU) {
+      const auto &timing = e.unit == Unit::MUL
+                               ? this->functionalUnitTiming.mul
+                               : this->functionalUnitTiming.div;
+      latency = std::max(timing.latency, 1u);
+      m_unitBusyUntil.at(e.unit == Unit::DIV) =
+          m_cycleCount + std::max(timing.interval, 1u);
+    }
+    e.readyCycle = m_cycleCount + latency - 1;
+  }
+
+  /// Returns whether the result of @p e, past the first EX stage, was
+  /// computed by the end of the previous cycle.
+  bool computed(const Entry &e, unsigned stage = D) const {
+    if (e.load)
+      return stage > c_loadResultStage;
+    return e.readyCycle < m_cycleCount;
+  }
+
+  void retire() {
+    auto &last = m_stages[D - 1];
+    if (!last)
+      return;
+    const Entry &e = *last;
+    if (e.ecall) {
+      // All older instructions have left the pipeline and no younger
+      // instructions have been fetched, such that the ecall observes the
+      // committed state.
+      execute();
+    }
+    if (e.rd >= c_RVRegs) {
+      m_archFRegs[e.rd - c_RVRegs] = e.result;
+    } else if (e.rd != 0) {
+      m_archRegs[e.rd] = static_cast<XLEN_T>(e.result);
+      m_committedRegs |= uint64_t(1) << e.rd;
+    }
+    if (m_countPerformance) {
+      if (e.isBranch) {
+        m_performanceCounters.branches++;
+        m_performanceCounters.branchesTaken += e.taken;
+      }
+      m_performanceCounters.mispredicts += e.taken;
+      if (e.custom >= 0) {
+        const auto &custom = RVISA::ExtCustom::instructions()[e.custom];
+        m_performanceCounters.customInstructions[custom.name]++;
+      }
+    }
+    m_instructionsRetired++;
+    last.reset();
+  }
+
+  /// Returns whether the operands of @p e, in the ID stage, are available to
+  /// the first EX stage in the current cycle. @p forwarded is set to the
+  /// number of forwarded operands, and @p waitsOnLoad to whether an
+  /// unavailable operand is loaded from memory.
+  bool operandsReady(const Entry &e, unsigned &forwarded,
+                     bool &waitsOnLoad) const {
+    bool ready = true;
+    for (unsigned i = 0; i < e.numSrcs; ++i) {
+      // Finds the youngest older instruction producing the operand. Producers
+      // which have left the pipeline were written to the register file no
+      // later than in the cycle in which the operand was read.
+      for (unsigned s = c_exStage + 1; s < D; ++s) {
+        const auto &p = m_stages[s];
+        if (!p || p->rd != e.srcs[i])
+          continue;
+        if (computed(*p, s) && (Desc::forwardFrom >> s & 1)) {
+          forwarded++;
+        } else {
+          ready = false;
+          waitsOnLoad |= p->load;
+        }
+        break;
+      }
+    }
+    return ready;
+  }
+
+  /// Returns the stage of instruction @p seq, if in the pipeline.
+  std::optional<unsigned> stageOf(uint64_t seq) const {
+    for (unsigned s = 0; s < D; ++s)
+      if (m_stages[s] && m_stages[s]->seq == seq)
+        return s;
+    return std::nullopt;
+  }
+
+  /// Returns whether fetching awaits unresolved control flow, or an ecall
+  /// leaving the pipeline.
+  bool fetchBlocked() {
+    if (!m_fetchBlocker)
+      return false;
+    for (const auto &queued : m_fetchQueue)
+      if (queued.entry.seq == *m_fetchBlocker)
+        return true;
+    if (const auto stage = stageOf(*m_fetchBlocker)) {
+      if (m_stages[*stage]->ecall)
+        return true;
+      if (*stage <= Desc::branchStage) {
+        // The stages behind resolving control flow hold the wrong path.
+        if (*stage == Desc::branchStage)
+          m_flushedStages = Desc::branchStage;
+        return true;
+      }
+    }
+    m_fetchBlocker.reset();
+    return false;
+  }
+
+  /// Fetches and executes the instruction at m_pc, of @p bytes bytes.
+  Entry fetchEntry(unsigned &bytes) {
+    Entry e;
+    e.seq = m_nextSeq++;
+    e.pc = m_pc;
+    const XLEN_T instr = fetchInstruction(bytes);
+    decodeInstruction(e, instr);
+    if (!e.ecall) {
+      execute();
+      e.result = e.rd >= c_RVRegs ? this->m_fpu.reg(e.rd - c_RVRegs)
+                 : e.rd != 0      ? m_regs[e.rd]
+                                  : 0;
+      if (e.memory)
+        e.access = m_dataAccess;
+      e.taken = m_pc != static_cast<XLEN_T>(e.pc + bytes);
+    }
+    if (e.ecall || e.taken)
+      m_fetchBlocker = e.seq;
+    return e;
+  }
+
+  void fetch() {
+    m_stages[0].reset();
+    if (m_fetchQueueConfig.entries != 0 || !m_fetchQueue.empty()) {
+      const bool blocked = fetchBlocked();
+      if (queuedReady()) {
+        m_stages[0] = m_fetchQueue.front().entry;
+        m_fetchQueue.pop_front();
+      } else if (m_countPerformance &&
+                 (!m_fetchQueue.empty() ||
+                  (!blocked && isExecutableAddress(m_pc)))) {
+        m_performanceCounters.fetchStalls++;
+      }
+      return;
+    }
+    if (fetchBlocked() || !isExecutableAddress(m_pc))
+      return;
+
+    unsigned bytes;
+    m_stages[0] = fetchEntry(bytes);
+    m_cycleInstrAccess = {MemoryAccess::Read, m_stages[0]->pc, bytes};
+  }
+
+  /// Returns whether the instruction at the head of the fetch queue may enter
+  /// the pipeline in the current cycle.
+  bool queuedReady() const {
+    return !m_fetchQueue.empty() &&
+           m_fetchQueue.front().readyCycle <= m_cycleCount;
+  }
+
+  /// Fetches the line holding m_pc into the fetch queue, unless the queue is
+  /// full or the access of the previous line is outstanding. Instructions are
+  /// queued until the queue fills, or control flow leaves the line.
+  void fetchLine() {
+    const unsigned entries = m_fetchQueueConfig.entries;
+    if (m_fetchQueue.size() >= entries || m_fetchBusyUntil > m_cycleCount ||
+        fetchBlocked() || !isExecutableAddress(m_pc))
+      return;
+    const AInt line = m_pc & ~AInt(m_lineBytes - 1);
+    m_cycleInstrAccess = {MemoryAccess::Read, line, m_lineBytes};
+    m_fetchBusyUntil = m_cycleCount + 1;
+    while (m_fetchQueue.size() < entries &&
+           (m_pc & ~AInt(m_lineBytes - 1)) == line &&
+           isExecutableAddress(m_pc)) {
+      unsigned bytes;
+      m_fetchQueue.push_back({fetchEntry(bytes), m_cycleCount + 1});
+      m_lineEntries++;
+      if (m_fetchBlocker)
+        break;
+    }
+  }
+
+  void decodeInstruction(Entry &e, XLEN_T instr) const {
+    const unsigned opcode = instr & 0x7F;
+    const unsigned rd = (instr >> 7) & 0x1F;
+    const unsigned rs1 = (instr >> 15) & 0x1F;
+    const unsigned rs2 = (instr >> 20) & 0x1F;
+    const unsigned funct3 = (instr >> 12) & 0b111;
+    // Identifiers of floating-point registers (see Entry::rd).
+    const unsigned fd = c_RVRegs + rd;
+    const unsigned fs1 = c_RVRegs + rs1;
+    const unsigned fs2 = c_RVRegs + rs2;
+    const unsigned fs3 = c_RVRegs + (instr >> 27);
+    const auto setSrcs = [&](std::initializer_list<unsigned> srcs) {
+      for (const unsigned src : srcs)
+        if (src != 0)
+          e.srcs[e.numSrcs++] = src;
+    };
+
+    switch (opcode) {
+    case RVISA::OpcodeID::LUI:
+    case RVISA::OpcodeID::AUIPC:
+    case RVISA::OpcodeID::JAL:
+      e.rd = rd;
+      break;
+    case RVISA::OpcodeID::JALR:
+    case RVISA::OpcodeID::OPIMM:
+    case RVISA::OpcodeID::OPIMM32:
+      e.rd = rd;
+      setSrcs({rs1});
+      break;
+    case RVISA::OpcodeID::LOAD:
+      e.rd = rd;
+      e.load = e.memory = true;
+      setSrcs({rs1});
+      break;
+    case RVISA::OpcodeID::STORE:
+      e.memory = true;
+      setSrcs({rs1, rs2});
+      break;
+    case RVISA::OpcodeID::AMO:
+      e.rd = rd;
+      e.load = e.memory = true;
+      setSrcs({rs1, rs2});
+      break;
+    case RVISA::OpcodeID::BRANCH:
+      e.isBranch = true;
+      setSrcs({rs1, rs2});
+      break;
+    case RVISA::OpcodeID::OP:
+    case RVISA::OpcodeID::OP32:
+      e.rd = rd;
+      setSrcs({rs1, rs2});
+      // The M extension.
+      if (((instr >> 25) & 0x7F) == 0b1)
+        e.unit = funct3 < 4 ? Unit::MUL : Unit::DIV;
+      break;
+    case RVISA::OpcodeID::LOADFP:
+      if (!this->m_extF || (funct3 != 0b010 && funct3 != 0b011))
+        break;
+      e.rd = fd;
+      e.load = e.memory = true;
+      setSrcs({rs1});
+      break;
+    case RVISA::OpcodeID::STOREFP:
+      if (!this->m_extF || (funct3 != 0b010 && funct3 != 0b011))
+        break;
+      e.memory = true;
+      setSrcs({rs1, fs2});
+      break;
+    case RVISA::OpcodeID::MADD:
+    case RVISA::OpcodeID::MSUB:
+    case RVISA::OpcodeID::NMSUB:
+    case RVISA::OpcodeID::NMADD:
+      if (!this->m_extF)
+        break;
+      e.rd = fd;
+      e.unit = Unit::MUL;
+      setSrcs({fs1, fs2, fs3});
+      break;
+    case RVISA::OpcodeID::OPFP:
+      if (!this->m_extF)
+        break;
+      switch (instr >> 27) {
+      case 0b10100: // feq, flt, fle
+        e.rd = rd;
+        setSrcs({fs1, fs2});
+        break;
+      case 0b11000: // fcvt.{w,wu,l,lu}.fmt
+      case 0b11100: // fmv.x.fmt, fclass
+        e.rd = rd;
+        setSrcs({fs1});
+        break;
+      case 0b11010: // fcvt.fmt.{w,wu,l,lu}
+      case 0b11110: // fmv.fmt.x
+        e.rd = fd;
+        setSrcs({rs1});
+        break;
+      case 0b01000: // fcvt.s.d, fcvt.d.s
+        e.rd = fd;
+        setSrcs({fs1});
+        break;
+      case 0b01011: // fsqrt
+        e.rd = fd;
+        e.unit = Unit::DIV;
+        setSrcs({fs1});
+        break;
+      default:
+        e.rd = fd;
+        setSrcs({fs1, fs2});
+        if ((instr >> 27) == 0b00010) // fmul
+          e.unit = Unit::MUL;
+        else if ((instr >> 27) == 0b00011) // fdiv
+          e.unit = Unit::DIV;
+        break;
+      }
+      break;
+    case RVISA::OpcodeID::CUSTOM0:
+    case RVISA::OpcodeID::CUSTOM1:
+    case RVISA::OpcodeID::CUSTOM2:
+    case RVISA::OpcodeID::CUSTOM3:
+      e.custom = RVISA::ExtCustom::find(instr);
+      if (e.custom < 0)
+        break;
+      e.rd = rd;
+      e.unit = Unit::CUSTOM;
+      if (RVISA::ExtCustom::instructions()[e.custom].readsRs2)
+        setSrcs({rs1, rs2});
+      else
+        setSrcs({rs1});
+      break;
+    case RVISA::OpcodeID::SYSTEM:
+      e.ecall = instr == 0x00000073;
+      // Accesses of the floating-point CSRs.
+      if (funct3 != 0 && this->m_extF) {
+        e.rd = rd;
+        if (!(funct3 & 0b100))
+          setSrcs({rs1});
+      }
+      break;
+    default:
+      break;
+    }
+  }
+
+  ProcessorStructure m_pipelineStructure;
+  QStringList m_stageNames;
+  // The instruction in each stage, if any.
+  std::array<std::optional<Entry>, D> m_stages;
+  uint64_t m_nextSeq = 0;
+  // Committed register state.
+  std::array<XLEN_T, c_RVRegs> m_archRegs{};
+  std::array<uint64_t, RVFloatUnit::c_fregs> m_archFRegs{};
+  uint64_t m_committedRegs = 0;
+  // Instruction after which fetching is stopped until it resolves.
+  std::optional<uint64_t> m_fetchBlocker;
+  // Fetched instructions, and the cycles from which they may enter the
+  // pipeline.
+  struct Queued {
+    Entry entry;
+    long long readyCycle;
+  };
+  FetchQueueConfig m_fetchQueueConfig;
+  unsigned m_lineBytes = 16;
+  std::deque<Queued> m_fetchQueue;
+  // Cycle from which the fetch unit issues its next access, and the number of
+  // instructions queued by the access of the current cycle.
+  long long m_fetchBusyUntil = 0;
+  unsigned m_lineEntries = 0;
+  // Cycles from which the multiplier and divider accept operations.
+  std::array<long long, 2> m_unitBusyUntil{};
+  // Cycles from which the unit of each custom instruction accepts operations.
+  std::vector<long long> m_customBusyUntil;
+  // The stages [0, m_stalledStages[ stalled, and [0, m_flushedStages[ were
+  // flushed, in the latest cycle.
+  unsigned m_stalledStages = 0;
+  unsigned m_flushedStages = 0;
+  MemoryAccess m_cycleDataAccess;
+  MemoryAccess m_cycleInstrAccess;
+};
+
+// ========================= Pipeline descriptions ============================
+
+/// IF, ID and a single stage executing, accessing memory and writing back.
+/// Results are written back before dependent instructions execute, such that
+/// no forwarding is required.
+struct Pipeline3S {
+  static constexpr std::array<unsigned, 3> stages = {
+      PipelineStage::IF, PipelineStage::ID,
+      PipelineStage::EX | PipelineStage::MEM | PipelineStage::WB};
+  static constexpr unsigned branchStage = 2;
+  static constexpr unsigned forwardFrom = 0;
+};
+
+/// A five-stage pipeline with the stages of the RV5S processors, and
+/// forwarding from the MEM and WB stages. It is not derived from the RV5S
+/// VSRTL design, and is not cycle-exact with it: ecalls and the multi-cycle
+/// units of the M extension are timed as by the other pipeline descriptions.
+struct Pipeline5S {
+  static constexpr std::array<unsigned, 5> stages = {
+      PipelineStage::IF, PipelineStage::ID, PipelineStage::EX,
+      PipelineStage::MEM, PipelineStage::WB};
+  static constexpr unsigned branchStage = 2;
+  static constexpr unsigned forwardFrom = stageMask({3, 4});
+};
+
+/// Two-stage fetch and memory access, with full forwarding.
+struct Pipeline7S {
+  static constexpr std::array<unsigned, 7> stages = {
+      PipelineStage::IF,  PipelineStage::IF,  PipelineStage::ID,
+      PipelineStage::EX,  PipelineStage::MEM, PipelineStage::MEM,
+      PipelineStage::WB};
+  static constexpr unsigned branchStage = 3;
+  static constexpr unsigned forwardFrom = stageMask({4, 5, 6});
+};
+
+/// Three-stage fetch, a two-cycle ALU and two-stage memory access, with full
+/// forwarding. Control flow resolves in the last EX stage.
+struct Pipeline9S {
+  static constexpr std::array<unsigned, 9> stages = {
+      PipelineStage::IF,  PipelineStage::IF,  PipelineStage::IF,
+      PipelineStage::ID,  PipelineStage::EX,  PipelineStage::EX,
+      PipelineStage::MEM, PipelineStage::MEM, PipelineStage::WB};
+  static constexpr unsigned branchStage = 5;
+  static constexpr unsigned forwardFrom = stageMask({6, 7, 8});
+};
+
+} // namespace Ripes
@@ -25,6 +25,7 @@ public:
     uncompress->exp_instr >> exp_instr;
 
     decode->opcode >> opcode;
+    decode->bitmanip_op >> bitmanip_op;
     decode->wr_reg_idx >> wr_reg_idx;
     decode->r1_reg_idx >> r1_reg_idx;
     decode->r2_reg_idx >> r2_reg_idx;
@@ -35,6 +36,7 @@ public:
 
   INPUTPORT(instr, c_RVInstrWidth);
   OUTPUTPORT_ENUM(opcode, RVInstr);
+  OUTPUTPORT_ENUM(bitmanip_op, ALUOp);
   OUTPUTPORT(wr_reg_idx, c_RVRegsBits);
   OUTPUTPORT(r1_reg_idx, c_RVRegsBits);
   OUTPUTPORT(r2_reg_idx, c_RVRegsBits);
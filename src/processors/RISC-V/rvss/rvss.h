@@ -62,6 +62,7 @@ public:
     // -----------------------------------------------------------------------
     // Control signals
     decode->opcode >> control->opcode;
+    decode->bitmanip_op >> control->bitmanip_op;
 
     // -----------------------------------------------------------------------
     // Immediate
@@ -82,6 +83,7 @@ public:
     control->reg_wr_src_ctrl >> reg_wr_src->select;
 
     registerFile->setMemory(m_regMem);
+    trackRegisterWrites(RVISA::GPR);
 
     // -----------------------------------------------------------------------
     // Branch
@@ -196,7 +198,9 @@ public:
   }
 
   MemoryAccess dataMemAccess() const override {
-    return memToAccessInfo(data_mem);
+    auto dataAccess = memToAccessInfo(data_mem);
+    dataAccess.pc = getPcForStage({0, 0});
+    return dataAccess;
   }
   MemoryAccess instrMemAccess() const override {
     auto instrAccess = memToAccessInfo(instr_mem);
@@ -206,6 +210,7 @@ public:
 
   void setRegister(const std::string_view &, unsigned i, VInt v) override {
     setSynchronousValue(registerFile->_wr_mem, i, v);
+    markRegistersWritten(RVISA::GPR, uint64_t(1) << i);
   }
 
   void clockProcessor() override {
@@ -216,6 +221,7 @@ public:
     // before clocking the processor, and emit finished if this was the final
     // clock cycle.
     const bool finishInThisCycle = m_finishInNextCycle;
+    markRegistersWritten(RVISA::GPR, registerFile->pendingWriteMask());
     Design::clock();
     if (finishInThisCycle) {
       m_finished = true;
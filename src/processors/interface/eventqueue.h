@@ -0,0 +1,76 @@
+#pragma once
+
+#include <climits>
+#include <functional>
+#include <map>
+
+namespace Ripes {
+
+/**
+ * @brief The EventQueue class
+ * Events scheduled to run at a given cycle of a processor. Events are keyed by
+ * their owner, such that rescheduling an event replaces the previously
+ * scheduled event of the owner. The processor checks a single cycle bound per
+ * cycle (see nextCycle), such that sources of events, like timers, are not
+ * polled every cycle.
+ */
+class EventQueue {
+public:
+  using Key = const void *;
+  using Event = std::function<void()>;
+
+  /// Schedules @p event to run once the cycle count reaches @p cycle,
+  /// replacing any event scheduled by @p key.
+  void schedule(Key key, long long cycle, Event event) {
+    cancel(key);
+    m_keys[key] = m_events.emplace(cycle, Entry{key, std::move(event)});
+    m_next = m_events.begin()->first;
+  }
+
+  /// Cancels the event scheduled by @p key, if any.
+  void cancel(Key key) {
+    auto it = m_keys.find(key);
+    if (it == m_keys.end())
+      return;
+    m_events.erase(it->second);
+    m_keys.erase(it);
+    m_next = m_events.empty() ? LLONG_MAX : m_events.begin()->first;
+  }
+
+  /// Returns true if an event is scheduled by @p key.
+  bool scheduled(Key key) const { return m_keys.count(key) != 0; }
+
+  void clear() {
+    m_events.clear();
+    m_keys.clear();
+    m_next = LLONG_MAX;
+  }
+
+  /// Returns the cycle of the earliest scheduled event, or LLONG_MAX if no
+  /// event is scheduled.
+  long long nextCycle() const { return m_next; }
+
+  /// Runs the events scheduled at or before @p cycle, in the order of their
+  /// cycles. Events may schedule further events.
+  void run(long long cycle) {
+    while (m_next <= cycle) {
+      auto it = m_events.begin();
+      Event event = std::move(it->second.event);
+      m_keys.erase(it->second.key);
+      m_events.erase(it);
+      m_next = m_events.empty() ? LLONG_MAX : m_events.begin()->first;
+      event();
+    }
+  }
+
+private:
+  struct Entry {
+    Key key;
+    Event event;
+  };
+  std::multimap<long long, Entry> m_events;
+  std::map<Key, std::multimap<long long, Entry>::iterator> m_keys;
+  long long m_next = LLONG_MAX;
+};
+
+} // namespace Ripes
@@ -0,0 +1,312 @@
+#pragma once
+
+#include <climits>
+#include <map>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "../../assembler/matcher.h"
+#include "../../pagedmemory.h"
+#include "ripesprocessor.h"
+
+namespace Ripes {
+
+/**
+ * @brief The FunctionalEngine class
+ * ISA-generic functional processor model. Instructions are decoded through
+ * the encodings of the ISA description (see InstructionBase and
+ * Assembler::Matcher), and executed by the semantics function attached to
+ * each instruction name, one instruction per cycle. A model of an ISA thereby
+ * consists of the semantics of its instructions (see MIPSISS), whereas
+ * register files, memory, decoding and the RipesProcessor interface are
+ * provided by the engine.
+ *
+ * Decoded instructions are cached by address. Cached instructions are marked
+ * as code in memory, such that writing them discards the cache (see
+ * PagedMemory::markCode). Instructions without semantics execute as nops.
+ */
+template <typename XLEN_T>
+class FunctionalEngine : public RipesProcessor {
+  static_assert(std::is_same<uint32_t, XLEN_T>::value ||
+                    std::is_same<uint64_t, XLEN_T>::value,
+                "Only supports 32- and 64-bit variants");
+
+public:
+  using Semantics = void (*)(FunctionalEngine &engine, Instr_T instr);
+  /// Semantics of each instruction, by instruction name.
+  using SemanticsMap = std::map<QString, Semantics>;
+
+  FunctionalEngine(const std::shared_ptr<ISAInfoBase> &isa,
+                   const SemanticsMap &semantics)
+      : m_isa(isa), m_matcher(isa->instructions()),
+        m_instrBytes(isa->instrBits() / CHAR_BIT) {
+    for (const auto &instr : isa->instructions()) {
+      if (auto it = semantics.find(instr->name()); it != semantics.end())
+        m_semantics[instr.get()] = it->second;
+    }
+
+    // The general-purpose register file holds the syscall register, and is
+    // the file accessed through reg and setReg.
+    const auto gpr = isa->syscallReg();
+    for (const auto &[name, info] : isa->regInfoMap()) {
+      RegFile file{name, std::vector<XLEN_T>(info->regCnt()), 0};
+      for (unsigned i = 0; i < info->regCnt() && i < 64; i++)
+        if (info->regIsReadOnly(i))
+          file.readOnly |= uint64_t(1) << i;
+      if (gpr && gpr->file.get() == info.get())
+        m_gpr = m_files.size();
+      m_files.push_back(std::move(file));
+      trackRegisterWrites(name);
+    }
+    m_features = hasICacheInterface | hasDCacheInterface | hasInterrupts |
+                 hasNativeClocking;
+  }
+
+  // Semantics interface
+  /// Returns register @p i of the general-purpose register file.
+  XLEN_T reg(unsigned i) const { return m_files[m_gpr].regs[i]; }
+  /// Writes register @p i of the general-purpose register file, unless it is
+  /// read-only.
+  void setReg(unsigned i, XLEN_T v) {
+    RegFile &file = m_files[m_gpr];
+    if (i < 64 && (file.readOnly >> i & 1))
+      return;
+    file.regs[i] = v;
+    m_writtenRegs |= i < 64 ? uint64_t(1) << i : 0;
+  }
+  /// Address of the executing instruction.
+  XLEN_T pc() const { return m_pc; }
+  /// Address of the instruction following the executing instruction.
+  XLEN_T nextPc() const { return m_pc + m_instrBytes; }
+  /// Transfers control to @p target after the executing instruction.
+  void jump(XLEN_T target) { m_nextPc = target; }
+  XLEN_T load(XLEN_T addr, unsigned bytes) {
+    m_dataAccess = {MemoryAccess::Read, addr, bytes, m_pc};
+    return static_cast<XLEN_T>(m_memory.readMem(addr, bytes));
+  }
+  void store(XLEN_T addr, XLEN_T value, unsigned bytes) {
+    m_dataAccess = {MemoryAccess::Write, addr, bytes, m_pc};
+    m_memory.writeMem(addr, value, bytes);
+  }
+  /// Executes a system call through the trap handler, if set.
+  void trap() {
+    if (trapHandler)
+      trapHandler();
+  }
+
+  // Ripes interface compliance
+  const ProcessorStructure &structure() const override { return m_structure; }
+  unsigned int getPcForStage(StageIndex) const override { return m_pc; }
+  AInt nextFetchedAddress() const override { return m_pc; }
+  QString stageName(StageIndex) const override { return "•"; }
+  StageInfo stageInfo(StageIndex) const override {
+    return StageInfo({m_pc, isExecutableAddress(m_pc), StageInfo::State::None});
+  }
+  void setProgramCounter(AInt address) override {
+    m_pc = static_cast<XLEN_T>(address);
+  }
+  void setPCInitialValue(AInt address) override {
+    m_pcInit = static_cast<XLEN_T>(address);
+  }
+  vsrtl::core::AddressSpaceMM &getMemory() override { return m_memory; }
+  VInt getRegister(const std::string_view &rfid, unsigned i) const override {
+    return m_files.at(registerFileId(rfid)).regs.at(i);
+  }
+  void setRegister(const std::string_view &rfid, unsigned i,
+                   VInt v) override {
+    RegFile &file = m_files.at(registerFileId(rfid));
+    if (i < 64 && (file.readOnly >> i & 1))
+      return;
+    file.regs.at(i) = static_cast<XLEN_T>(v);
+    markRegistersWritten(rfid, i < 64 ? uint64_t(1) << i : 0);
+  }
+  unsigned registerFileId(const std::string_view &rfid) const override {
+    for (unsigned id = 0; id < m_files.size(); id++)
+      if (m_files[id].name == rfid)
+        return id;
+    return m_gpr;
+  }
+  VInt readRegister(const RegisterFileHandle &file, unsigned i) const override {
+    return m_files[file.id].regs[i];
+  }
+  void readRegisters(const RegisterFileHandle &file,
+                     VInt *values) const override {
+    const auto &regs = m_files[file.id].regs;
+    std::copy(regs.begin(), regs.end(), values);
+  }
+  void finalize(FinalizeReason fr) override {
+    if (fr == FinalizeReason::exitSyscall) {
+      // The exit syscall is executed as part of its instruction, which itself
+      // retires in the current cycle.
+      m_finished = true;
+    }
+  }
+  bool finished() const override {
+    return m_finished || !stageInfo({0, 0}).stage_valid;
+  }
+  const std::vector<StageIndex> breakpointTriggeringStages() const override {
+    return {{0, 0}};
+  }
+  MemoryAccess dataMemAccess() const override { return m_dataAccess; }
+  MemoryAccess instrMemAccess() const override { return m_instrAccess; }
+
+  long long getInstructionsRetired() const override {
+    return m_instructionsRetired;
+  }
+  long long getCycleCount() const override { return m_cycleCount; }
+  void idleUntil(long long cycle) override { m_idleUntil = cycle; }
+
+  bool saveState(std::vector<uint64_t> &state) const override {
+    state.insert(state.end(), {static_cast<uint64_t>(m_cycleCount),
+                               static_cast<uint64_t>(m_instructionsRetired),
+                               m_finished});
+    return true;
+  }
+  bool restoreState(const std::vector<uint64_t> &state) override {
+    if (state.size() != 3)
+      return false;
+    m_cycleCount = static_cast<long long>(state[0]);
+    m_instructionsRetired = static_cast<long long>(state[1]);
+    m_finished = state[2];
+    m_idleUntil = 0;
+    m_dataAccess = MemoryAccess();
+    m_instrAccess = MemoryAccess();
+    markAllRegistersWritten();
+    return true;
+  }
+
+  void resetProcessor() override {
+    m_memory.reset();
+    for (auto &file : m_files)
+      std::fill(file.regs.begin(), file.regs.end(), 0);
+    markAllRegistersWritten();
+    m_pc = m_pcInit;
+    m_cycleCount = 0;
+    m_idleUntil = 0;
+    m_instructionsRetired = 0;
+    m_dataAccess = MemoryAccess();
+    m_instrAccess = MemoryAccess();
+    m_finished = false;
+    m_decoded.clear();
+    m_codeWrites = m_memory.codeWrites();
+    if (m_emitsSignals)
+      processorWasReset.Emit();
+  }
+
+  const ISAInfoBase *implementsISA() const override { return m_isa.get(); }
+  std::shared_ptr<const ISAInfoBase> fullISA() const override { return m_isa; }
+
+  const std::set<std::string_view> registerFiles() const override {
+    std::set<std::string_view> names;
+    for (const auto &file : m_files)
+      names.insert(file.name);
+    return names;
+  }
+
+protected:
+  void clockProcessor() override {
+    step();
+    markRegistersWritten(m_files[m_gpr].name, m_writtenRegs);
+    m_writtenRegs = 0;
+    if (m_emitsSignals)
+      processorWasClocked.Emit();
+  }
+
+  unsigned clockNative(unsigned n) override {
+    unsigned cycles = 0;
+    do {
+      step();
+      cycles++;
+    } while (cycles < n && !finished() && m_cycleCount < nextEventCycle());
+    // Register writes are published once per slice.
+    markRegistersWritten(m_files[m_gpr].name, m_writtenRegs);
+    m_writtenRegs = 0;
+    return cycles;
+  }
+
+  void step() {
+    execute();
+    m_cycleCount++;
+    m_instructionsRetired++;
+    if (m_idleUntil > m_cycleCount) {
+      // Cycles spent idling are skipped rather than executed.
+      m_cycleCount = m_idleUntil;
+    }
+  }
+
+  struct Decoded {
+    Instr_T instr;
+    Semantics fn;
+  };
+
+  Decoded decode(Instr_T instr) const {
+    auto match = m_matcher.matchInstruction(instr);
+    if (match.isError())
+      return {instr, nullptr};
+    auto it = m_semantics.find(match.value());
+    return {instr, it != m_semantics.end() ? it->second : nullptr};
+  }
+
+  /// Returns the decoded instruction at m_pc, from the cache if the
+  /// instruction can be marked as code.
+  Decoded fetch() {
+    if (m_memory.codeWrites() != m_codeWrites) {
+      m_decoded.clear();
+      m_codeWrites = m_memory.codeWrites();
+    }
+    if (auto it = m_decoded.find(m_pc); it != m_decoded.end())
+      return it->second;
+    const Decoded decoded =
+        decode(static_cast<Instr_T>(m_memory.readMem(m_pc, m_instrBytes)));
+    if (m_memory.markCode(m_pc, m_instrBytes))
+      m_decoded.emplace(m_pc, decoded);
+    return decoded;
+  }
+
+  void execute() {
+    m_dataAccess = MemoryAccess();
+    m_instrAccess = {MemoryAccess::Read, m_pc, m_instrBytes};
+    const Decoded decoded = fetch();
+    m_nextPc = m_pc + m_instrBytes;
+    if (decoded.fn)
+      decoded.fn(*this, decoded.instr);
+    m_pc = m_nextPc;
+  }
+
+  struct RegFile {
+    std::string_view name;
+    std::vector<XLEN_T> regs;
+    // Registers which ignore writes, such as a zero register.
+    uint64_t readOnly;
+  };
+
+  std::shared_ptr<ISAInfoBase> m_isa;
+  Assembler::Matcher m_matcher;
+  std::map<const InstructionBase *, Semantics> m_semantics;
+  const unsigned m_instrBytes;
+
+  PagedMemory m_memory;
+  std::vector<RegFile> m_files;
+  unsigned m_gpr = 0;
+  // Registers written in the current cycle (see markRegistersWritten).
+  uint64_t m_writtenRegs = 0;
+  XLEN_T m_pc = 0;
+  XLEN_T m_pcInit = 0;
+  XLEN_T m_nextPc = 0;
+  long long m_cycleCount = 0;
+  long long m_instructionsRetired = 0;
+  // Cycle until which the processor idles (see idleUntil).
+  long long m_idleUntil = 0;
+  MemoryAccess m_dataAccess;
+  MemoryAccess m_instrAccess;
+  bool m_finished = false;
+  ProcessorStructure m_structure = {{0, 1}};
+
+  // Decoded instructions by address, valid as of m_codeWrites writes to
+  // decoded code (see PagedMemory::codeWrites).
+  std::unordered_map<XLEN_T, Decoded> m_decoded;
+  unsigned long long m_codeWrites = 0;
+};
+
+} // namespace Ripes
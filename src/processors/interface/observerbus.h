@@ -0,0 +1,113 @@
+#pragma once
+
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace Ripes {
+
+/**
+ * @brief The ObserverBus class
+ * Typed events dispatched to the observers subscribed to their kind, where
+ * each of @p Events is a kind of event. Observers are keyed by their owner, as
+ * for EventQueue, such that subscribing again replaces the callback of the
+ * owner, and unsubscribing an owner removes all of its subscriptions.
+ *
+ * Publishers test whether a kind has subscribers (see subscribed) before
+ * deriving its events, such that events nobody observes cost a single test.
+ * Callbacks are invoked on the publishing thread, in the order of
+ * subscription, and must not change the subscriptions of the bus.
+ */
+template <typename... Events>
+class ObserverBus {
+  static_assert(sizeof...(Events) <= 32, "Kinds are tracked in a 32-bit mask");
+
+public:
+  using Key = const void *;
+  template <typename Event>
+  using Callback = std::function<void(const Event &)>;
+
+  /// Subscribes @p key to the events of kind @p Event, replacing any previous
+  /// subscription of @p key to the kind.
+  template <typename Event>
+  void subscribe(Key key, Callback<Event> callback) {
+    auto &subscribers = subscribersOf<Event>();
+    for (auto &subscriber : subscribers) {
+      if (subscriber.key == key) {
+        subscriber.callback = std::move(callback);
+        return;
+      }
+    }
+    subscribers.push_back({key, std::move(callback)});
+    m_kinds |= kind<Event>();
+  }
+
+  /// Removes the subscription of @p key to the events of kind @p Event.
+  template <typename Event>
+  void unsubscribe(Key key) {
+    auto &subscribers = subscribersOf<Event>();
+    for (auto it = subscribers.begin(); it != subscribers.end(); ++it) {
+      if (it->key == key) {
+        subscribers.erase(it);
+        break;
+      }
+    }
+    if (subscribers.empty())
+      m_kinds &= ~kind<Event>();
+  }
+
+  /// Removes all subscriptions of @p key.
+  void unsubscribe(Key key) { (unsubscribe<Events>(key), ...); }
+
+  void clear() {
+    std::apply([](auto &...subscribers) { (subscribers.clear(), ...); },
+               m_subscribers);
+    m_kinds = 0;
+  }
+
+  /// Returns the bit of kind @p Event in kinds().
+  template <typename Event>
+  static constexpr unsigned kind() {
+    static_assert((std::is_same_v<Event, Events> || ...),
+                  "Not an event of the bus");
+    unsigned index = 0;
+    unsigned i = 0;
+    ((std::is_same_v<Event, Events> ? (index = i++) : i++), ...);
+    return 1u << index;
+  }
+
+  /// Returns the mask of the kinds which have subscribers.
+  unsigned kinds() const { return m_kinds; }
+  template <typename Event>
+  bool subscribed() const {
+    return m_kinds & kind<Event>();
+  }
+
+  template <typename Event>
+  void publish(const Event &event) const {
+    for (const auto &subscriber : subscribersOf<Event>())
+      subscriber.callback(event);
+  }
+
+private:
+  template <typename Event>
+  struct Subscriber {
+    Key key;
+    Callback<Event> callback;
+  };
+
+  template <typename Event>
+  std::vector<Subscriber<Event>> &subscribersOf() {
+    return std::get<std::vector<Subscriber<Event>>>(m_subscribers);
+  }
+  template <typename Event>
+  const std::vector<Subscriber<Event>> &subscribersOf() const {
+    return std::get<std::vector<Subscriber<Event>>>(m_subscribers);
+  }
+
+  std::tuple<std::vector<Subscriber<Events>>...> m_subscribers;
+  unsigned m_kinds = 0;
+};
+
+} // namespace Ripes
@@ -4,10 +4,21 @@
 
 #include "Signals/Signal.h"
 #include "VSRTL/core/vsrtl_design.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <deque>
+#include <functional>
 #include <map>
+#include <memory>
+#include <optional>
+#include <vector>
 
 #include "../../isa/isa_types.h"
 #include "../../isa/isainfo.h"
+#include "eventqueue.h"
+#include "observerbus.h"
+#include "simprofiler.h"
 
 namespace Ripes {
 
@@ -21,7 +32,7 @@ struct StageInfo {
   enum class State { None, Stalled, Flushed, WayHazard, Unused };
   AInt pc = 0;
   bool stage_valid = false;
-  State state;
+  State state = State::None;
   QString namedState = "";
   bool operator==(const StageInfo &other) const {
     return this->pc == other.pc && this->stage_valid == other.stage_valid &&
@@ -37,6 +48,8 @@ struct MemoryAccess {
   Type type = None;
   AInt address;
   unsigned bytes;
+  /// Address of the instruction performing a data access.
+  AInt pc = 0;
 };
 
 /// A StageIndex denotes a unique stage within a processor.
@@ -109,6 +122,227 @@ struct ProcessorStructure : public std::map<unsigned, unsigned> {
   }
 };
 
+/**
+ * @brief The WriteQuery struct
+ * A register, or the bytes [address : address + bytes[ of memory, whose
+ * latest write is searched for by RipesProcessor::reverseToLastWrite.
+ */
+struct WriteQuery {
+  enum class Kind { Register, Memory };
+  Kind kind = Kind::Register;
+  std::string_view rfid;
+  unsigned index = 0;
+  AInt address = 0;
+  unsigned bytes = 1;
+};
+
+/**
+ * @brief The RegisterFileHandle struct
+ * A register file of a processor, resolved once per processor instance
+ * through RipesProcessor::registerFile, such that its registers are accessed
+ * by index without looking up the register file by name. Handles are only
+ * valid for the processor instance which resolved them.
+ */
+struct RegisterFileHandle {
+  std::string_view rfid;
+  /// Identifier of the register file within the processor (see
+  /// RipesProcessor::registerFileId).
+  unsigned id = 0;
+  /// Number of registers of the file; 0 if the processor does not expose the
+  /// register file.
+  unsigned count = 0;
+
+  bool valid() const { return count != 0; }
+};
+
+/// Events of the execution of a processor, published to the observers
+/// subscribed through RipesProcessor::observers().
+namespace ProcessorEvent {
+/// An instruction retired by a cycle: valid in the last stage of its lane as
+/// the cycle started.
+struct Retire {
+  long long cycle;
+  unsigned lane;
+  AInt pc;
+};
+/// A register written by a cycle, and its value after the cycle.
+struct RegisterWrite {
+  long long cycle;
+  std::string_view rfid;
+  unsigned index;
+  VInt value;
+};
+/// The data memory access of a cycle.
+struct DataAccess {
+  long long cycle;
+  MemoryAccess access;
+};
+/// A stage whose information changed by a cycle, and the PC of the stage
+/// before and after the cycle.
+struct StageChange {
+  long long cycle;
+  StageIndex stage;
+  AInt oldPC;
+  AInt newPC;
+};
+/// A system call, published by the trap handler of the environment before
+/// it is executed.
+struct Syscall {
+  long long cycle;
+  unsigned function;
+};
+} // namespace ProcessorEvent
+
+using ProcessorObservers =
+    ObserverBus<ProcessorEvent::Retire, ProcessorEvent::RegisterWrite,
+                ProcessorEvent::DataAccess, ProcessorEvent::StageChange,
+                ProcessorEvent::Syscall>;
+
+/**
+ * @brief The CycleRecord struct
+ * Per-cycle state recorded whilst the processor is being clocked in batches
+ * (see RipesProcessor::clockN). Observers which require per-cycle information
+ * may use these records in place of the per-cycle processorWasClocked signal.
+ */
+struct CycleRecord {
+  long long cycle;
+  MemoryAccess instrAccess;
+  MemoryAccess dataAccess;
+  /// Only recorded for cycles within the range set through
+  /// RipesProcessor::setBatchStageInfoRange.
+  std::map<StageIndex, StageInfo> stageInfos;
+};
+
+/**
+ * @brief The PerformanceCounters struct
+ * Hardware performance counters of a processor model, counting the
+ * microarchitectural events of the cycles executed since the last reset. Events
+ * which cannot occur in a processor model (e.g., forwarding in a processor
+ * without a forwarding unit) remain zero.
+ */
+struct PerformanceCounters {
+  /// Per-stage counts of cycles in which a stage was in a given state.
+  struct StageCounters {
+    long long stalled = 0;
+    long long flushed = 0;
+    long long wayHazard = 0;
+  };
+  std::map<StageIndex, StageCounters> stages;
+  /// Cycles in which the pipeline stalled to resolve a data hazard, and of
+  /// these, load-use hazards.
+  long long dataHazards = 0;
+  long long loadUseHazards = 0;
+  /// Operands forwarded to the execute stage.
+  long long forwards = 0;
+  /// Conditional branches executed, and of these, branches taken.
+  long long branches = 0;
+  long long branchesTaken = 0;
+  /// Control-flow changes which were mispredicted, and thus flushed the
+  /// instructions fetched after them.
+  long long mispredicts = 0;
+  /// Returns, and other indirect jumps, whose targets were predicted (hits)
+  /// and mispredicted (misses).
+  struct TargetPredictions {
+    long long hits = 0;
+    long long misses = 0;
+  };
+  TargetPredictions returns;
+  TargetPredictions indirectJumps;
+  /// Cycles in which instructions were issued to the execute stage of a
+  /// multiple-issue processor, and of these, cycles issuing two instructions.
+  long long issueCycles = 0;
+  long long dualIssueCycles = 0;
+  /// Cycles in which a dual-issue processor issued only the older of the two
+  /// instructions fetched together, by reason: the older instruction was
+  /// control flow, both required the memory or branch unit, either was an
+  /// ecall, the younger depended on the older, or the pairing policy of the
+  /// processor disallowed the pair.
+  struct PairingFailures {
+    long long controlflow = 0;
+    long long structural = 0;
+    long long ecall = 0;
+    long long dependence = 0;
+    long long policy = 0;
+  };
+  PairingFailures pairingFailures;
+  /// Cycles in which the processor stalled on the latency of its memory
+  /// accesses (see RipesProcessor::memoryLatency).
+  long long memoryStalls = 0;
+  /// Cycles in which the fetch queue of a processor with a decoupled front end
+  /// held no instruction for a pipeline ready to accept one (fetch stalls),
+  /// and cycles in which it held instructions which the stalled pipeline could
+  /// not accept (backend stalls). Cycles in which fetching awaits unresolved
+  /// control flow are counted as neither.
+  long long fetchStalls = 0;
+  long long backendStalls = 0;
+  /// Cycles in which the pipeline stalled on a busy multi-cycle functional
+  /// unit, or on a result which its unit had yet to compute by the time the
+  /// instruction was to leave the pipeline (see FunctionalUnitTiming).
+  long long functionalUnitStalls = 0;
+  /// Retired custom instructions, by name (see RVISA::ExtCustom).
+  std::map<QString, long long> customInstructions;
+};
+
+/**
+ * @brief The FunctionalUnitTiming struct
+ * Timing of the functional units executing the multiplications, and the
+ * divisions and remainders, of the M extension. The latency of a unit is the
+ * number of cycles from an operation entering the unit until its result is
+ * available, and its issue interval the number of cycles before the unit
+ * accepts the next operation. A pipelined unit has an interval of 1, whereas
+ * an iterative unit is occupied for its full latency.
+ */
+struct FunctionalUnitTiming {
+  struct Unit {
+    unsigned latency = 1;
+    unsigned interval = 1;
+    bool operator==(const Unit &other) const {
+      return latency == other.latency && interval == other.interval;
+    }
+  };
+  // A pipelined multiplier and an iterative divider.
+  Unit mul = {3, 1};
+  Unit div = {16, 16};
+};
+
+/**
+ * @brief The PCProfile struct
+ * Per-instruction profile of the instructions within [base : base + bytes[.
+ * Each cycle is attributed to the instruction retiring in the cycle. Cycles in
+ * which no instruction retires are attributed to the most recently retired
+ * instruction, such that the bubbles following a load or a taken branch are
+ * attributed to the load or branch. Cycles before the first instruction
+ * retires are counted as unattributed.
+ * If next is set, the transitions between consecutively retired
+ * instructions which do not retire the following instruction in memory, i.e.
+ * taken branches and jumps, are counted in jumps.
+ */
+struct PCProfile {
+  PCProfile(AInt base, AInt bytes, unsigned alignment)
+      : base(base), alignment(alignment),
+        cycles((bytes + alignment - 1) / alignment),
+        retired((bytes + alignment - 1) / alignment) {}
+
+  bool contains(AInt pc) const {
+    return pc >= base && (pc - base) / alignment < cycles.size();
+  }
+  size_t index(AInt pc) const { return (pc - base) / alignment; }
+  AInt address(size_t index) const { return base + index * alignment; }
+
+  AInt base;
+  unsigned alignment;
+  std::vector<long long> cycles;
+  std::vector<long long> retired;
+  long long unattributedCycles = 0;
+  // Index of the most recently retired instruction.
+  std::optional<size_t> lastRetired;
+  // Index of the instruction following each instruction in memory.
+  std::vector<size_t> next;
+  // Number of transitions from the first to the second index which are not to
+  // the following instruction.
+  std::map<std::pair<size_t, size_t>, long long> jumps;
+};
+
 /**
  * @brief The RipesProcessor class
  * Interface for all Ripes processors. This interface is intended to be
@@ -144,7 +378,12 @@ public:
   enum Features {
     isReversible = 0b1,
     hasICacheInterface = 0b10,
-    hasDCacheInterface = 0b100
+    hasDCacheInterface = 0b100,
+    hasPerformanceCounters = 0b1000,
+    hasInterrupts = 0b10000,
+    hasMemoryStalls = 0b100000,
+    hasFunctionalUnitTiming = 0b1000000,
+    hasNativeClocking = 0b10000000
   };
 
   unsigned features() const { return m_features; }
@@ -251,6 +490,52 @@ public:
   virtual void setRegister(const std::string_view &rfid, unsigned i,
                            VInt v) = 0;
 
+  /**
+   * @brief registerFile
+   * @returns a handle to register file @p rfid, through which its registers
+   * are read by readRegister and readRegisters. The handle is invalid if the
+   * processor does not expose the register file.
+   */
+  RegisterFileHandle registerFile(const std::string_view &rfid) const {
+    if (!registerFiles().count(rfid))
+      return {};
+    const auto regInfo = implementsISA()->regInfo(rfid);
+    if (!regInfo)
+      return {};
+    return {rfid, registerFileId(rfid), regInfo.value()->regCnt()};
+  }
+
+  /**
+   * @brief registerFileId
+   * @returns the identifier by which the processor distinguishes register
+   * file @p rfid in the handles to its register files. Processors exposing
+   * multiple register files override this alongside readRegister.
+   */
+  virtual unsigned registerFileId(const std::string_view &rfid) const {
+    Q_UNUSED(rfid);
+    return 0;
+  }
+
+  /**
+   * @brief readRegister
+   * @returns the value of register @p i of the register file of @p file.
+   * Equivalent to getRegister, but without looking up the register file.
+   */
+  virtual VInt readRegister(const RegisterFileHandle &file, unsigned i) const {
+    return getRegister(file.rfid, i);
+  }
+
+  /**
+   * @brief readRegisters
+   * Reads the values of all file.count registers of the register file of
+   * @p file into @p values.
+   */
+  virtual void readRegisters(const RegisterFileHandle &file,
+                             VInt *values) const {
+    for (unsigned i = 0; i < file.count; i++)
+      values[i] = readRegister(file, i);
+  }
+
   /**
    * @brief setProgramCounter
    * Sets the program counter of the processor to @param address
@@ -271,9 +556,19 @@ public:
 
   /**
    * @brief vcdTrace
-   * Enables VCD tracing of the processor model, if supported by the simulator.
+   * Enables VCD tracing of the processor model to @p filename, if supported
+   * by the simulator. The trace is compressed if @p filename ends with ".gz".
+   * @p components selects the components to trace by their paths, as wildcard
+   * patterns (see WaveformTrace::Filter); all are traced if empty.
+   * @returns an error message if the trace could not be opened.
    */
-  virtual void vcdTrace(bool, const QString &){};
+  virtual QString vcdTrace(bool enable, const QString &filename,
+                           const QStringList &components) {
+    Q_UNUSED(enable);
+    Q_UNUSED(filename);
+    Q_UNUSED(components);
+    return QString();
+  }
 
   /**
    * @brief clock
@@ -281,7 +576,74 @@ public:
    */
   void clock() {
     if (!finished())
-      clockProcessor();
+      clockCycle();
+  }
+
+  /**
+   * @brief clockN
+   * Clocks the processor for up to @p n cycles. Clocking is stopped early if
+   * the processor finishes, or if @p stop returns true. @p stop is evaluated
+   * before each cycle. processorWasClocked is not emitted for the individual
+   * cycles of the batch; instead, the state of each cycle is recorded in
+   * clockBatch(), and processorWasBatchClocked is emitted once the batch has
+   * been executed.
+   * If native clocking applies (see setNativeClocking), the batch is instead
+   * clocked through clockNative, and no per-cycle state is recorded.
+   * @returns the number of cycles executed.
+   */
+  unsigned clockN(unsigned n, const std::function<bool()> &stop = {}) {
+    const bool emitsSignals = m_emitsSignals;
+    m_emitsSignals = false;
+    m_clockBatch.clear();
+    if (nativeClockingApplies()) {
+      const unsigned cycles = clockNativeN(n, stop);
+      m_emitsSignals = emitsSignals;
+      if (cycles != 0 && m_emitsSignals)
+        processorWasBatchClocked.Emit();
+      return cycles;
+    }
+    m_clockBatch.reserve(n);
+
+    unsigned cycles = 0;
+    for (; cycles < n; ++cycles) {
+      if (finished() || (stop && stop()))
+        break;
+      clockCycle();
+
+      auto &record = m_clockBatch.emplace_back();
+      record.cycle = getCycleCount();
+      // Memory is not accessed anew in stalled cycles.
+      if (!m_memoryStalled) {
+        record.instrAccess = instrMemAccess();
+        record.dataAccess = dataMemAccess();
+      }
+      if (record.cycle >= m_batchStageInfoFirst &&
+          record.cycle <= m_batchStageInfoLast) {
+        for (auto idx : structure().stageIt())
+          record.stageInfos[idx] = stageInfo(idx);
+      }
+    }
+
+    m_emitsSignals = emitsSignals;
+    if (cycles != 0 && m_emitsSignals)
+      processorWasBatchClocked.Emit();
+    return cycles;
+  }
+
+  /**
+   * @brief clockBatch
+   * @returns the per-cycle records of the latest call to clockN.
+   */
+  const std::vector<CycleRecord> &clockBatch() const { return m_clockBatch; }
+
+  /**
+   * @brief setBatchStageInfoRange
+   * Stage information is only recorded in batched cycle records for cycles in
+   * the range [@p first, @p last].
+   */
+  void setBatchStageInfoRange(long long first, long long last) {
+    m_batchStageInfoFirst = first;
+    m_batchStageInfoLast = last;
   }
 
   /**
@@ -326,6 +688,33 @@ public:
   Gallant::Signal0<> processorWasClocked;
   Gallant::Signal0<> processorWasReversed;
   Gallant::Signal0<> processorWasReset;
+  /**
+   * @brief processorWasBatchClocked
+   * Emitted once after a batch of cycles has been executed through clockN.
+   */
+  Gallant::Signal0<> processorWasBatchClocked;
+
+  /**
+   * @brief observers
+   * Observers of the events of the execution of the processor. The events of
+   * each cycle are derived from the state of the processor after it has been
+   * clocked, for the kinds of events which have subscribers only, such that
+   * an unobserved processor is not queried for them. Cycles stalled on memory
+   * publish no events. Whilst events other than system calls are observed,
+   * batches are clocked per cycle rather than natively (see
+   * setNativeClocking). System calls are published by the trap handler
+   * through publishSyscall. Subscriptions must not change whilst the
+   * processor is being clocked.
+   */
+  ProcessorObservers &observers() { return m_observers; }
+  const ProcessorObservers &observers() const { return m_observers; }
+
+  /// Publishes a system call of function @p function to the observers, if
+  /// any. Called by trap handlers (see trapHandler).
+  void publishSyscall(unsigned function) const {
+    if (m_observers.subscribed<ProcessorEvent::Syscall>())
+      m_observers.publish(ProcessorEvent::Syscall{getCycleCount(), function});
+  }
 
   /**
    * @brief isExecutableAddress
@@ -357,19 +746,673 @@ public:
    * expected to be able to reverse.
    */
   virtual void setMaxReverseCycles(unsigned cycles) { Q_UNUSED(cycles); }
+  /**
+   * @brief reverseStateBytes
+   * Returns the number of bytes held by the processor for reversing cycles.
+   */
+  virtual size_t reverseStateBytes() const { return 0; }
+  /**
+   * @brief reverseToLastWrite
+   * Reverses the processor to the cycle of the latest write matching @p query,
+   * such that the writing instruction is the next to execute.
+   * @returns the cycle of the write, or nothing if no matching write was
+   * performed within the reverse horizon, in which case the processor is left
+   * as is. Processors which cannot search their reverse history return
+   * nothing.
+   */
+  virtual std::optional<long long> reverseToLastWrite(const WriteQuery &query) {
+    Q_UNUSED(query);
+    return {};
+  }
+
+  /** ========================= FEATURE: Snapshots ======================== */
+
+  /**
+   * @brief saveState
+   * Appends the state of the processor which is not held by its register
+   * files, program counter and memory to @p state, such as its cycle count and
+   * the contents of its pipeline. Returns false if the processor cannot save
+   * this state, in which case it cannot be snapshotted (see Snapshot).
+   */
+  virtual bool saveState(std::vector<uint64_t> &state) const {
+    Q_UNUSED(state);
+    return false;
+  }
+  /**
+   * @brief restoreState
+   * Restores the state saved by saveState, once the register files, program
+   * counter and memory of the processor have been restored. The processor
+   * cannot be reversed past the restored state. Returns false if @p state was
+   * not saved by a processor of the same model and configuration.
+   */
+  virtual bool restoreState(const std::vector<uint64_t> &state) {
+    Q_UNUSED(state);
+    return false;
+  }
+
+  /** ================== FEATURE: Performance counters =================== */
+  // Enabled by setting m_features.hasPerformanceCounters = true
+
+  /**
+   * @brief setPerformanceCounting
+   * Enables maintaining the performance counters whilst clocking the
+   * processor. Disabled by default, given that counting adds to the cost of
+   * every cycle.
+   */
+  void setPerformanceCounting(bool enabled) { m_countPerformance = enabled; }
+
+  /**
+   * @brief performanceCounters
+   * @returns the performance counters of the cycles executed since the last
+   * reset, whilst performance counting was enabled.
+   */
+  const PerformanceCounters &performanceCounters() const {
+    return m_performanceCounters;
+  }
+
+  /** ========================= FEATURE: Interrupts ======================== */
+  // Enabled by setting m_features.hasInterrupts = true. Events are run for
+  // all processors.
+
+  /**
+   * @brief events
+   * Events scheduled on the cycles of the processor, such as the expiry of a
+   * timer. Due events are run before the processor is clocked, such that
+   * events may redirect execution to an interrupt handler through
+   * setProgramCounter, if the processor has interrupts.
+   */
+  EventQueue &events() { return m_events; }
+  const EventQueue &events() const { return m_events; }
+
+  /**
+   * @brief idleUntil
+   * Idles the processor until its cycle count reaches @p cycle, as if it
+   * waited for an interrupt, without executing the intermediate cycles. Takes
+   * effect at the end of the current cycle.
+   */
+  virtual void idleUntil(long long cycle) { Q_UNUSED(cycle); }
+
+  /** ======================= FEATURE: Memory stalls ====================== */
+  // Enabled by setting m_features.hasMemoryStalls = true
+
+  /**
+   * @brief memoryLatency
+   * If set, returns the number of cycles, beyond the first, which the
+   * instruction and data memory accesses of the current cycle take to
+   * complete. It is called once for each cycle before the processor is clocked
+   * out of it, and the processor is stalled as a whole for the larger of the
+   * two latencies, such that the memory accesses are held across the stall.
+   * Processors which decouple their fetch from the rest of the pipeline
+   * instead delay their fetch by the latency of the instruction access (see
+   * delayFetch), and stall only for the latency of the data access.
+   * Stalled cycles are counted by the cycle count of the processor, but
+   * neither advance its state nor access memory.
+   */
+  struct MemoryLatency {
+    unsigned instr = 0;
+    unsigned data = 0;
+  };
+  std::function<MemoryLatency(const MemoryAccess &instrAccess,
+                              const MemoryAccess &dataAccess)>
+      memoryLatency;
+
+  /**
+   * @brief memoryStalled
+   * @returns whether the latest cycle was stalled on the latency of memory.
+   */
+  bool memoryStalled() const { return m_memoryStalled; }
+
+  /** ================== FEATURE: Native clocking ======================== */
+  // Enabled by setting m_features.hasNativeClocking = true
+
+  /**
+   * @brief setNativeClocking
+   * Enables clocking the batches of clockN through clockNative, for
+   * processors with native clocking. Native clocking is meant for runs which
+   * do not observe individual cycles: clockBatch() remains empty, and the stop
+   * predicate of clockN is evaluated in between native slices of up to
+   * c_nativeSliceCycles cycles. Batches are clocked per cycle regardless
+   * whilst the processor is profiled or stalls on memory.
+   */
+  void setNativeClocking(bool enabled) { m_nativeClocking = enabled; }
+  bool nativeClocking() const { return m_nativeClocking; }
+
+  static constexpr unsigned c_nativeSliceCycles = 1024;
+
+  /** ================= FEATURE: Functional unit timing ================== */
+  // Enabled by setting m_features.hasFunctionalUnitTiming = true
+
+  /**
+   * @brief functionalUnitTiming
+   * The timing of the multiplier and divider of the processor. Changes apply
+   * to operations issued after the change.
+   */
+  FunctionalUnitTiming functionalUnitTiming;
+
+  /** ========================== PC profiling ============================ */
+
+  /**
+   * @brief setPCProfile
+   * Sets the profile which the cycles and retired instructions of subsequently
+   * clocked cycles are counted in. A null profile disables profiling.
+   */
+  void setPCProfile(const std::shared_ptr<PCProfile> &profile) {
+    m_pcProfile = profile;
+  }
+
+  /** ====================== Stage change tracking ======================= */
+
+  struct StageChange {
+    StageIndex stage;
+    AInt oldPC;
+    AInt newPC;
+  };
+
+  /**
+   * @brief stageChanges
+   * @returns the stages whose information changed since the call which updated
+   * @p infos, in the order of structure().stageIt(), and updates @p infos to
+   * the current information of each stage. Each observer keeps its own
+   * @p infos, initially empty, for which all stages are reported as changed
+   * from a default-constructed StageInfo.
+   */
+  std::vector<StageChange> stageChanges(std::vector<StageInfo> &infos) const {
+    const unsigned stages = structure().numStages();
+    if (infos.size() != stages)
+      infos.assign(stages, StageInfo());
+    std::vector<StageChange> changes;
+    unsigned i = 0;
+    for (auto idx : structure().stageIt()) {
+      auto &old = infos[i++];
+      const StageInfo info = stageInfo(idx);
+      if (info != old) {
+        changes.push_back({idx, old.pc, info.pc});
+        old = info;
+      }
+    }
+    return changes;
+  }
+
+  /** ====================== Register write tracking ===================== */
+
+  /**
+   * @brief writtenRegisters
+   * @returns a mask of the registers of register file @p rfid which have been
+   * written since the call which returned @p cursor, and advances @p cursor.
+   * Bit i denotes register i. Each observer keeps its own cursor, initially 0,
+   * for which all registers are reported as written. All registers are
+   * reported as written for register files which are not tracked by the
+   * processor (see trackRegisterWrites), and registers beyond the 64th are
+   * not reported. May be called whilst the processor is being clocked on
+   * another thread.
+   */
+  uint64_t writtenRegisters(const std::string_view &rfid,
+                            uint64_t &cursor) const {
+    auto it = m_registerWrites.find(rfid);
+    if (it == m_registerWrites.end())
+      return ~uint64_t(0);
+    const auto &writes = it->second;
+    const uint64_t since = cursor;
+    cursor = writes.epoch.load(std::memory_order_acquire);
+    uint64_t mask = 0;
+    for (unsigned i = 0; i < writes.writtenAt.size(); ++i)
+      if (writes.writtenAt[i].load(std::memory_order_relaxed) > since)
+        mask |= uint64_t(1) << i;
+    return mask;
+  }
+
+  /**
+   * @brief tracksRegisterWrites
+   * @returns true if the processor reports the writes to register file
+   * @p rfid (see writtenRegisters).
+   */
+  bool tracksRegisterWrites(const std::string_view &rfid) const {
+    return m_registerWrites.count(rfid) != 0;
+  }
 
   /** ======================================================================*/
 
 protected:
+  /**
+   * @brief trackRegisterWrites
+   * Enables tracking the writes to register file @p rfid. Must be called during
+   * construction of the processor, for each register file which the processor
+   * reports its writes to through markRegistersWritten.
+   */
+  void trackRegisterWrites(const std::string_view &rfid) {
+    m_registerWrites[rfid];
+  }
+
+  /**
+   * @brief markRegistersWritten
+   * Records the registers of @p mask as written to in register file @p rfid.
+   * Processors accumulate the registers written in a cycle and call this once
+   * per cycle rather than per write, as well as through setRegister. Writes
+   * are recorded by the thread clocking the processor.
+   */
+  void markRegistersWritten(const std::string_view &rfid, uint64_t mask) {
+    if (mask == 0)
+      return;
+    auto it = m_registerWrites.find(rfid);
+    if (it == m_registerWrites.end())
+      return;
+    auto &writes = it->second;
+    // The registers are stamped with the next epoch before it is published,
+    // such that observers which read the epoch see the writes stamped with it.
+    const uint64_t epoch = writes.epoch.load(std::memory_order_relaxed) + 1;
+    for (unsigned i = 0; mask != 0 && i < writes.writtenAt.size();
+         ++i, mask >>= 1)
+      if (mask & 1)
+        writes.writtenAt[i].store(epoch, std::memory_order_relaxed);
+    writes.epoch.store(epoch, std::memory_order_release);
+  }
+
+  /**
+   * @brief markAllRegistersWritten
+   * Marks all registers as written, for operations such as resetting or
+   * reversing which may modify any register.
+   */
+  void markAllRegistersWritten() {
+    for (auto &it : m_registerWrites)
+      markRegistersWritten(it.first, ~uint64_t(0));
+  }
+
+  /**
+   * @brief countStageStates
+   * Adds @p delta to the per-stage counters of the state of each stage in the
+   * current cycle. Processors call this with a delta of 1 before clocking, and
+   * of -1 after reversing, a cycle.
+   */
+  void countStageStates(int delta) {
+    for (auto idx : structure().stageIt()) {
+      const auto info = stageInfo(idx);
+      auto &counters = m_performanceCounters.stages[idx];
+      switch (info.state) {
+      case StageInfo::State::Stalled:
+        counters.stalled += delta;
+        break;
+      case StageInfo::State::Flushed:
+        counters.flushed += delta;
+        break;
+      case StageInfo::State::WayHazard:
+        counters.wayHazard += delta;
+        break;
+      default:
+        break;
+      }
+    }
+  }
+
+  bool m_countPerformance = false;
+  PerformanceCounters m_performanceCounters;
+
+  /**
+   * @brief clockNative
+   * Clocks the processor for up to @p n cycles in a tight loop, in place of
+   * the per-cycle clockProcessor, for processors with
+   * Features::hasNativeClocking. At least one cycle is clocked, unless the
+   * processor has finished. Returns early once the processor finishes, or
+   * once its cycle count reaches nextEventCycle(), such that scheduled events
+   * run on time. Traps are handled through trapHandler as when
+   * clocked per cycle, with the register state synchronized beforehand;
+   * otherwise, register writes need only be published (markRegistersWritten)
+   * and memory synchronized once the slice has been clocked.
+   * @returns the number of cycles clocked.
+   */
+  virtual unsigned clockNative(unsigned n) {
+    Q_UNUSED(n);
+    return 0;
+  }
+
+  /// The cycle of the next scheduled event.
+  long long nextEventCycle() const { return m_events.nextCycle(); }
+
+  /// Runs the events which are due in the current cycle.
+  void runEvents() {
+    const long long cycle = getCycleCount();
+    if (cycle >= m_events.nextCycle())
+      m_events.run(cycle);
+  }
+
+  /**
+   * @brief profileCycle
+   * Counts the current cycle in m_pcProfile. An instruction retires in the
+   * current cycle if it is valid in the last stage of its lane. If multiple
+   * instructions retire, the cycle is attributed to the first of these.
+   * Nothing retires in a cycle which stalls on memory (@p stalled).
+   */
+  void profileCycle(bool stalled) {
+    auto &profile = *m_pcProfile;
+    if (stalled) {
+      if (profile.lastRetired)
+        profile.cycles[*profile.lastRetired]++;
+      else
+        profile.unattributedCycles++;
+      return;
+    }
+    const auto &procStructure = structure();
+    std::optional<size_t> firstRetired;
+    for (unsigned lane = 0; lane < procStructure.size(); ++lane) {
+      const auto info = stageInfo({lane, procStructure.at(lane) - 1});
+      if (!info.stage_valid || !profile.contains(info.pc))
+        continue;
+      const size_t index = profile.index(info.pc);
+      profile.retired[index]++;
+      if (!firstRetired)
+        firstRetired = index;
+      if (!profile.next.empty() && profile.lastRetired &&
+          profile.next[*profile.lastRetired] != index)
+        profile.jumps[{*profile.lastRetired, index}]++;
+      profile.lastRetired = index;
+    }
+    if (firstRetired)
+      profile.cycles[*firstRetired]++;
+    else if (profile.lastRetired)
+      profile.cycles[*profile.lastRetired]++;
+    else
+      profile.unattributedCycles++;
+  }
+
   /**
    * @brief clock
    * Implementation of processor clocking.
    */
   virtual void clockProcessor() = 0;
 
+  /**
+   * @brief stallProcessor
+   * Implementation of a cycle in which the processor stalls on memory. The
+   * cycle count of the processor includes m_memoryStallCycles.
+   */
+  virtual void stallProcessor() {}
+
+  /**
+   * @brief delayFetch
+   * Called with the latency of the instruction access of the current cycle
+   * (see memoryLatency). Processors with a fetch queue decoupling their fetch
+   * from the rest of the pipeline delay the instructions of the access by
+   * @p cycles and return true, such that the processor as a whole does not
+   * stall on the access.
+   */
+  virtual bool delayFetch(unsigned cycles) {
+    Q_UNUSED(cycles);
+    return false;
+  }
+
+  /**
+   * @brief undoMemoryStall
+   * Reverts the memory stall state of the latest cycle. Processors call this
+   * when reversing a cycle.
+   * @returns true if the reversed cycle was stalled on memory, in which case
+   * the state of the processor must be left as is.
+   */
+  bool undoMemoryStall() {
+    if (m_memoryStallHistory.empty())
+      return false;
+    const MemoryStallRecord record = m_memoryStallHistory.back();
+    m_memoryStallHistory.pop_back();
+    m_pendingMemoryStalls = record.pendingBefore;
+    m_memoryLatencyApplied = record.appliedBefore;
+    m_memoryStalled = !m_memoryStallHistory.empty() &&
+                      m_memoryStallHistory.back().stalled;
+    if (record.stalled) {
+      --m_memoryStallCycles;
+      if (record.counted)
+        --m_performanceCounters.memoryStalls;
+    }
+    return record.stalled;
+  }
+
+  /// Resets the memory stall state; called when resetting the processor.
+  void resetMemoryStalls() {
+    m_memoryStallHistory.clear();
+    m_pendingMemoryStalls = 0;
+    m_memoryLatencyApplied = false;
+    m_memoryStalled = false;
+    m_memoryStallCycles = 0;
+  }
+
+  /// Appends the memory stall state to @p state, for saveState. The history
+  /// of the stalls is not saved.
+  void saveMemoryStalls(std::vector<uint64_t> &state) const {
+    state.insert(state.end(), {static_cast<uint64_t>(m_memoryStallCycles),
+                               m_pendingMemoryStalls, m_memoryLatencyApplied,
+                               m_memoryStalled});
+  }
+  /// Restores the memory stall state saved by saveMemoryStalls from the
+  /// c_memoryStallWords words at @p state.
+  void restoreMemoryStalls(const uint64_t *state) {
+    m_memoryStallHistory.clear();
+    m_memoryStallCycles = static_cast<long long>(state[0]);
+    m_pendingMemoryStalls = static_cast<unsigned>(state[1]);
+    m_memoryLatencyApplied = state[2];
+    m_memoryStalled = state[3];
+  }
+  static constexpr size_t c_memoryStallWords = 4;
+
+  // Cycles stalled on memory since the processor was reset.
+  long long m_memoryStallCycles = 0;
+  // Number of cycles of memory stall history which may be reverted.
+  unsigned m_maxMemoryStallHistory = 100;
+
   // m_features should be adjusted accordingly during processor construction
   unsigned m_features;
   bool m_emitsSignals = true;
+
+private:
+  bool nativeClockingApplies() const {
+    return m_nativeClocking && (m_features & Features::hasNativeClocking) &&
+           !m_pcProfile && !observesCycles() &&
+           !(memoryLatency && (m_features & Features::hasMemoryStalls));
+  }
+
+  unsigned clockNativeN(unsigned n, const std::function<bool()> &stop) {
+    unsigned cycles = 0;
+    while (cycles < n && !finished() && !(stop && stop())) {
+      runEvents();
+      SimProfiler::Scope profile(SimProfiler::Propagation);
+      const unsigned clocked =
+          clockNative(std::min(n - cycles, c_nativeSliceCycles));
+      if (clocked == 0)
+        break;
+      cycles += clocked;
+    }
+    return cycles;
+  }
+
+  /// Runs the events and profiling of the current cycle, and clocks the
+  /// processor out of it, unless the cycle stalls on memory.
+  void clockCycle() {
+    runEvents();
+    const unsigned pendingBefore = m_pendingMemoryStalls;
+    const bool appliedBefore = m_memoryLatencyApplied;
+    const bool tracksStalls =
+        memoryLatency && (m_features & Features::hasMemoryStalls);
+    if (tracksStalls && !m_memoryLatencyApplied) {
+      const MemoryLatency latency =
+          memoryLatency(instrMemAccess(), dataMemAccess());
+      m_pendingMemoryStalls = delayFetch(latency.instr)
+                                  ? latency.data
+                                  : std::max(latency.instr, latency.data);
+      m_memoryLatencyApplied = true;
+    }
+    m_memoryStalled = tracksStalls && m_pendingMemoryStalls > 0;
+    if (m_pcProfile)
+      profileCycle(m_memoryStalled);
+    if (tracksStalls) {
+      m_memoryStallHistory.push_back({m_memoryStalled, m_countPerformance,
+                                      pendingBefore, appliedBefore});
+      if (m_memoryStallHistory.size() > m_maxMemoryStallHistory)
+        m_memoryStallHistory.pop_front();
+    }
+
+    SimProfiler::Scope profile(SimProfiler::Propagation);
+    if (m_memoryStalled) {
+      --m_pendingMemoryStalls;
+      ++m_memoryStallCycles;
+      if (m_countPerformance)
+        ++m_performanceCounters.memoryStalls;
+      stallProcessor();
+      return;
+    }
+    m_memoryLatencyApplied = false;
+    if (observesCycles()) {
+      beginObservedCycle();
+      clockProcessor();
+      publishCycleEvents();
+    } else {
+      clockProcessor();
+    }
+  }
+
+  /// Whether events derived from the individual cycles are observed.
+  bool observesCycles() const {
+    return (m_observers.kinds() &
+            ~ProcessorObservers::kind<ProcessorEvent::Syscall>()) != 0;
+  }
+
+  /// Records the state preceding the current cycle from which its events are
+  /// derived.
+  void beginObservedCycle() {
+    if (m_observers.subscribed<ProcessorEvent::Retire>()) {
+      m_observedRetiring.clear();
+      const auto &procStructure = structure();
+      for (unsigned lane = 0; lane < procStructure.size(); ++lane) {
+        const auto info = stageInfo({lane, procStructure.at(lane) - 1});
+        if (info.stage_valid)
+          m_observedRetiring.push_back({lane, info.pc});
+      }
+    }
+    if (m_observers.subscribed<ProcessorEvent::RegisterWrite>()) {
+      if (m_observedRegisterFiles.empty()) {
+        for (const auto &rfid : registerFiles()) {
+          const auto file = registerFile(rfid);
+          if (file.valid())
+            m_observedRegisterFiles.push_back(
+                {file, std::min(file.count, 64u)});
+        }
+      }
+      // Writes outside of the cycles, such as through setRegister, are not
+      // attributed to the cycle.
+      for (auto &file : m_observedRegisterFiles) {
+        if (tracksRegisterWrites(file.handle.rfid)) {
+          writtenRegisters(file.handle.rfid, file.cursor);
+        } else {
+          file.values.resize(file.handle.count);
+          readRegisters(file.handle, file.values.data());
+        }
+      }
+    }
+    if (m_observers.subscribed<ProcessorEvent::StageChange>())
+      stageChanges(m_observedStageInfos);
+  }
+
+  /// Publishes the events of the cycle which has been clocked.
+  void publishCycleEvents() {
+    const long long cycle = getCycleCount();
+    if (m_observers.subscribed<ProcessorEvent::Retire>()) {
+      for (const auto &[lane, pc] : m_observedRetiring)
+        m_observers.publish(ProcessorEvent::Retire{cycle, lane, pc});
+    }
+    if (m_observers.subscribed<ProcessorEvent::RegisterWrite>()) {
+      for (auto &file : m_observedRegisterFiles) {
+        const bool tracked = tracksRegisterWrites(file.handle.rfid);
+        const uint64_t written =
+            tracked ? writtenRegisters(file.handle.rfid, file.cursor) : 0;
+        for (unsigned i = 0; i < file.count; i++) {
+          if (tracked && ((written >> i) & 1) == 0)
+            continue;
+          const VInt value = readRegister(file.handle, i);
+          if (tracked || value != file.values[i])
+            m_observers.publish(ProcessorEvent::RegisterWrite{
+                cycle, file.handle.rfid, i, value});
+        }
+      }
+    }
+    if (m_observers.subscribed<ProcessorEvent::DataAccess>()) {
+      const MemoryAccess access = dataMemAccess();
+      if (access.type != MemoryAccess::None)
+        m_observers.publish(ProcessorEvent::DataAccess{cycle, access});
+    }
+    if (m_observers.subscribed<ProcessorEvent::StageChange>()) {
+      for (const auto &change : stageChanges(m_observedStageInfos))
+        m_observers.publish(ProcessorEvent::StageChange{
+            cycle, change.stage, change.oldPC, change.newPC});
+    }
+  }
+
+  struct MemoryStallRecord {
+    bool stalled;
+    // Whether the stall was counted in the performance counters.
+    bool counted;
+    unsigned pendingBefore;
+    bool appliedBefore;
+  };
+  // Memory stall state of the latest cycles, the latest at the back.
+  std::deque<MemoryStallRecord> m_memoryStallHistory;
+  unsigned m_pendingMemoryStalls = 0;
+  // Whether memoryLatency has been applied to the current cycle.
+  bool m_memoryLatencyApplied = false;
+  bool m_memoryStalled = false;
+  bool m_nativeClocking = false;
+
+  std::shared_ptr<PCProfile> m_pcProfile;
+  std::vector<CycleRecord> m_clockBatch;
+  ProcessorObservers m_observers;
+  // State of the observed cycle (see beginObservedCycle).
+  struct ObservedRegisterFile {
+    RegisterFileHandle handle;
+    // Observed registers; registers beyond the 64th are not observed.
+    unsigned count = 0;
+    uint64_t cursor = 0;
+    // Values of the registers, for files not tracked by the processor.
+    std::vector<VInt> values;
+  };
+  std::vector<std::pair<unsigned, AInt>> m_observedRetiring;
+  std::vector<ObservedRegisterFile> m_observedRegisterFiles;
+  std::vector<StageInfo> m_observedStageInfos;
+  EventQueue m_events;
+  /// The latest epoch in which each register of a register file was written.
+  /// 0 is the epoch of all observers' initial cursors.
+  struct RegisterWrites {
+    std::atomic<uint64_t> epoch{1};
+    std::array<std::atomic<uint64_t>, 64> writtenAt{};
+    RegisterWrites() {
+      for (auto &w : writtenAt)
+        w.store(1, std::memory_order_relaxed);
+    }
+  };
+  std::map<std::string_view, RegisterWrites> m_registerWrites;
+  long long m_batchStageInfoFirst = 0;
+  long long m_batchStageInfoLast = 0;
+};
+
+/**
+ * @brief The RegisterFileHandles class
+ * The handles to all register files of a processor instance, for owners of a
+ * processor to resolve once and share with the code accessing its registers.
+ */
+class RegisterFileHandles {
+public:
+  RegisterFileHandles() = default;
+  explicit RegisterFileHandles(const RipesProcessor &proc) {
+    for (const auto &rfid : proc.registerFiles())
+      if (auto file = proc.registerFile(rfid); file.valid())
+        m_files.push_back(file);
+  }
+
+  /// @returns the handle to register file @p rfid, which is invalid if the
+  /// processor does not expose the register file.
+  const RegisterFileHandle &operator[](const std::string_view &rfid) const {
+    static const RegisterFileHandle s_invalid;
+    for (const auto &file : m_files)
+      if (file.rfid == rfid)
+        return file;
+    return s_invalid;
+  }
+
+private:
+  std::vector<RegisterFileHandle> m_files;
 };
 
 } // namespace Ripes
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if (defined(__x86_64__) || defined(__i386__)) &&                             \
+    (defined(__GNUC__) || defined(__clang__))
+#include <x86intrin.h>
+#define RIPES_SIMPROFILER_TSC
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define RIPES_SIMPROFILER_TSC
+#endif
+
+namespace Ripes {
+
+/**
+ * @brief The SimProfiler class
+ * Attributes the wall time and the number of calls of the hot paths of the
+ * simulator to categories, for finding where the time of a slow simulation is
+ * spent. Each path is timed by a scoped SimProfiler::Scope. Time is attributed
+ * exclusively: the time of a scope nested within another scope on the same
+ * thread (such as the signals emitted while propagating a VSRTL design) is
+ * subtracted from the enclosing scope.
+ *
+ * Scopes are timed by the time-stamp counter of the CPU where available, which
+ * is converted to seconds against a steady clock, and otherwise by the steady
+ * clock itself. Profiling is disabled by default, in which case a scope costs
+ * a single relaxed atomic load.
+ */
+class SimProfiler {
+public:
+  enum Category {
+    Propagation, // Clocking the processor model
+    Signals,     // Per-cycle observers of the processor's clock signals
+    Views,       // Refreshing the models of the GUI
+    Caches,      // Forwarding memory accesses to the cache simulator
+    Syscalls,    // Executing system calls
+    NCategories
+  };
+
+  struct Entry {
+    double seconds = 0;
+    uint64_t calls = 0;
+  };
+  using Results = std::array<Entry, NCategories>;
+
+  static const char *name(Category category) {
+    static const char *names[NCategories] = {
+        "VSRTL propagation", "Signal dispatch", "GUI models", "Cache shims",
+        "Syscalls"};
+    return names[category];
+  }
+
+  /// Enables profiling, discarding any previous results.
+  static void enable() {
+    reset();
+    s_enabled.store(true, std::memory_order_relaxed);
+  }
+  static void disable() { s_enabled.store(false, std::memory_order_relaxed); }
+  static bool enabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+  static void reset() {
+    for (unsigned i = 0; i < NCategories; ++i) {
+      s_ticks[i].store(0, std::memory_order_relaxed);
+      s_calls[i].store(0, std::memory_order_relaxed);
+    }
+    s_resetTicks = ticks();
+    s_resetTime = std::chrono::steady_clock::now();
+  }
+
+  /// Returns the time and calls of each category since profiling was enabled
+  /// or reset.
+  static Results results() {
+    // Converts ticks to seconds by the rate of the tick counter since reset.
+    const double elapsed = std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - s_resetTime)
+                               .count();
+    const uint64_t elapsedTicks = ticks() - s_resetTicks;
+    const double secondsPerTick =
+        elapsedTicks == 0 ? 0 : elapsed / elapsedTicks;
+
+    Results results;
+    for (unsigned i = 0; i < NCategories; ++i) {
+      results[i].seconds =
+          s_ticks[i].load(std::memory_order_relaxed) * secondsPerTick;
+      results[i].calls = s_calls[i].load(std::memory_order_relaxed);
+    }
+    return results;
+  }
+
+  /// Attributes the lifetime of the scope to a category, if profiling is
+  /// enabled.
+  class Scope {
+  public:
+    explicit Scope(Category category)
+        : m_category(SimProfiler::enabled() ? category : NCategories) {
+      if (m_category == NCategories)
+        return;
+      m_parent = s_current;
+      s_current = this;
+      m_begin = ticks();
+    }
+    ~Scope() {
+      if (m_category == NCategories)
+        return;
+      const uint64_t elapsed = ticks() - m_begin;
+      s_ticks[m_category].fetch_add(elapsed - std::min(elapsed, m_children),
+                                    std::memory_order_relaxed);
+      s_calls[m_category].fetch_add(1, std::memory_order_relaxed);
+      if (m_parent)
+        m_parent->m_children += elapsed;
+      s_current = m_parent;
+    }
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+  private:
+    Category m_category;
+    Scope *m_parent = nullptr;
+    uint64_t m_begin = 0;
+    // Ticks spent in nested scopes.
+    uint64_t m_children = 0;
+  };
+
+private:
+  static uint64_t ticks() {
+#ifdef RIPES_SIMPROFILER_TSC
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+  }
+
+  static inline std::atomic<bool> s_enabled = false;
+  static inline std::array<std::atomic<uint64_t>, NCategories> s_ticks{};
+  static inline std::array<std::atomic<uint64_t>, NCategories> s_calls{};
+  static inline uint64_t s_resetTicks = 0;
+  static inline std::chrono::steady_clock::time_point s_resetTime;
+  // The innermost scope of the thread.
+  static inline thread_local Scope *s_current = nullptr;
+};
+
+} // namespace Ripes
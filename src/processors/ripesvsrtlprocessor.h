@@ -6,7 +6,9 @@
 
 #include "RISC-V/riscv.h"
 #include "VSRTL/core/vsrtl_design.h"
+#include "VSRTL/core/vsrtl_register.h"
 #include "interface/ripesprocessor.h"
+#include "waveformtrace.h"
 
 namespace Ripes {
 
@@ -15,41 +17,130 @@ public:
   RipesVSRTLProcessor(const std::string &name) : Design(name) {
     // VSRTL provides reversible simulation
     m_features = {Features::isReversible | Features::hasDCacheInterface |
-                  Features::hasICacheInterface};
+                  Features::hasICacheInterface | Features::hasMemoryStalls};
 
     // Shim signal emissions from VSRTL to RipesProcessor
-    designWasClocked.Connect(&processorWasClocked, &Gallant::Signal0<>::Emit);
+    designWasClocked.Connect(this, &RipesVSRTLProcessor::designClocked);
     designWasReversed.Connect(&processorWasReversed, &Gallant::Signal0<>::Emit);
     designWasReset.Connect(&processorWasReset, &Gallant::Signal0<>::Emit);
   }
 
   virtual void resetProcessor() override {
     m_instructionsRetired = 0;
+    m_performanceCounters = PerformanceCounters();
+    markAllRegistersWritten();
+    resetMemoryStalls();
     reset();
+    // The trace is restarted, given that the cycle count restarts.
+    if (m_waveform)
+      vcdTrace(true, m_waveformFile, m_waveformComponents);
   }
 
-  virtual void reverseProcessor() override { reverse(); }
+  virtual void reverseProcessor() override {
+    markAllRegistersWritten();
+    // Stalled cycles left the design untouched.
+    if (undoMemoryStall()) {
+      processorWasReversed.Emit();
+      return;
+    }
+    reverse();
+  }
+
+  virtual QString vcdTrace(bool enable, const QString &filename,
+                           const QStringList &components) override {
+    m_waveform.reset();
+    m_tracedPorts.clear();
+    if (!enable)
+      return QString();
 
-  virtual void vcdTrace(bool enable, const QString &filename) override {
-    vsrtl::core::Design::vcdTrace(enable, filename.toStdString());
+    std::vector<WaveformTrace::Signal> traced;
+    collectTracedPorts(*this, QString::fromStdString(getName()),
+                       WaveformTrace::Filter(components), false, traced);
+    QString error;
+    m_waveform = WaveformTrace::open(filename, std::move(traced), error);
+    if (!m_waveform) {
+      m_tracedPorts.clear();
+      return error;
+    }
+    m_waveformFile = filename;
+    m_waveformComponents = components;
+    m_waveformValues.resize(m_tracedPorts.size());
+    sampleWaveform();
+    return QString();
   }
 
   long long getInstructionsRetired() const override {
     return m_instructionsRetired;
   }
-  long long getCycleCount() const override { return m_cycleCount; }
+  long long getCycleCount() const override {
+    return m_cycleCount + m_memoryStallCycles;
+  }
   void setMaxReverseCycles(unsigned cycles) override {
+    m_maxMemoryStallHistory = cycles;
     setReverseStackSize(cycles);
   }
+  size_t reverseStateBytes() const override {
+    // Each clocked component saves its state in every cycle which may be
+    // reversed.
+    const long long cycles = std::min<long long>(
+        m_cycleCount, vsrtl::core::ClockedComponent::reverseStackSize());
+    return m_clockedComponents * cycles * sizeof(VSRTL_VT_U);
+  }
+
+  /**
+   * The state of a design is the value of each of its registers, which
+   * includes the pipeline registers and the program counter, alongside the
+   * cycle, memory stall and retired instruction counts. State held outside of
+   * registers, such as the tables of a branch predictor, is not saved.
+   */
+  bool saveState(std::vector<uint64_t> &state) const override {
+    state.insert(state.end(), {static_cast<uint64_t>(m_cycleCount),
+                               static_cast<uint64_t>(m_instructionsRetired)});
+    saveMemoryStalls(state);
+    for (const auto *reg : m_registers)
+      state.push_back(
+          reg->getPorts<vsrtl::SimPort::PortType::out>().front()->uValue());
+    return true;
+  }
+  bool restoreState(const std::vector<uint64_t> &state) override {
+    if (state.size() != 2 + c_memoryStallWords + m_registers.size())
+      return false;
+    m_cycleCount = static_cast<long long>(state[0]);
+    m_instructionsRetired = static_cast<long long>(state[1]);
+    restoreMemoryStalls(&state[2]);
+    for (size_t i = 0; i < m_registers.size(); i++)
+      m_registers[i]->forceValue(0, state[2 + c_memoryStallWords + i]);
+    propagateDesign();
+    markAllRegistersWritten();
+    return true;
+  }
 
   void postConstruct() override {
     /**
      * VSRTL designs must call verifyAndInitialize after being constructed.
      */
     verifyAndInitialize();
+    m_clockedComponents = countClockedComponents(*this);
+    // Registers are saved in the order of their names, which is independent
+    // of the order of construction.
+    std::map<std::string, vsrtl::core::RegisterBase *> registers;
+    collectRegisters(*this, getName(), registers);
+    for (const auto &it : registers)
+      m_registers.push_back(it.second);
   }
 
 protected:
+  void stallProcessor() override { designClocked(); }
+
+  void designClocked() {
+    if (m_waveform)
+      sampleWaveform();
+    // Clock signals are suppressed while clocking in batches (see
+    // RipesProcessor::clockN).
+    if (m_emitsSignals)
+      processorWasClocked.Emit();
+  }
+
   MemoryAccess
   memToAccessInfo(const vsrtl::core::BaseMemory<true> *memory) const {
     MemoryAccess access;
@@ -111,6 +202,71 @@ protected:
   // m_instructionsRetired should be modified by the processor when it retires
   // (or "un-retires", while reversing) an instruction
   long long m_instructionsRetired = 0;
+
+private:
+  static unsigned countClockedComponents(const vsrtl::SimComponent &component) {
+    unsigned count =
+        dynamic_cast<const vsrtl::core::ClockedComponent *>(&component) !=
+        nullptr;
+    for (const auto &subcomponent : component.getSubComponents())
+      count += countClockedComponents(*subcomponent);
+    return count;
+  }
+
+  /// Collects the registers of @p component and its subcomponents by their
+  /// hierarchical names, prefixed by @p path.
+  static void
+  collectRegisters(vsrtl::SimComponent &component, const std::string &path,
+                   std::map<std::string, vsrtl::core::RegisterBase *> &regs) {
+    if (auto *reg = dynamic_cast<vsrtl::core::RegisterBase *>(&component))
+      regs[path] = reg;
+    for (const auto &subcomponent : component.getSubComponents())
+      collectRegisters(*subcomponent, path + "." + subcomponent->getName(),
+                       regs);
+  }
+
+  /// Collects the output ports of @p component, if selected by @p filter, and
+  /// of its subcomponents. Subcomponents of selected components are selected
+  /// as well.
+  void collectTracedPorts(const vsrtl::SimComponent &component,
+                          const QString &path,
+                          const WaveformTrace::Filter &filter, bool selected,
+                          std::vector<WaveformTrace::Signal> &traced) {
+    selected = selected || filter.matches(path);
+    if (selected) {
+      for (auto *port : component.getPorts<vsrtl::SimPort::PortType::out>()) {
+        m_tracedPorts.push_back(port);
+        traced.push_back(
+            {(path + "." + QString::fromStdString(port->getName()))
+                 .toStdString(),
+             port->getWidth()});
+      }
+    }
+    for (const auto &subcomponent : component.getSubComponents()) {
+      collectTracedPorts(
+          *subcomponent,
+          path + "." + QString::fromStdString(subcomponent->getName()), filter,
+          selected, traced);
+    }
+  }
+
+  void sampleWaveform() {
+    for (size_t i = 0; i < m_tracedPorts.size(); i++)
+      m_waveformValues[i] = m_tracedPorts[i]->uValue();
+    m_waveform->sample(getCycleCount(), m_waveformValues.data());
+  }
+
+  // Number of components of the design saving state for reversing.
+  unsigned m_clockedComponents = 0;
+  // Registers of the design, in the order of their names (see saveState).
+  std::vector<vsrtl::core::RegisterBase *> m_registers;
+
+  // The waveform trace, if enabled, and the ports which it traces.
+  std::unique_ptr<WaveformTrace> m_waveform;
+  std::vector<const vsrtl::SimPort *> m_tracedPorts;
+  std::vector<WaveformTrace::Value> m_waveformValues;
+  QString m_waveformFile;
+  QStringList m_waveformComponents;
 };
 
 } // namespace Ripes
@@ -3,6 +3,7 @@
 
 #include <QDir>
 #include <QFontMetrics>
+#include <QInputDialog>
 #include <QMessageBox>
 #include <QPushButton>
 #include <QScrollBar>
@@ -19,7 +20,9 @@
 #include "registercontainerwidget.h"
 #include "registermodel.h"
 #include "ripessettings.h"
+#include "statusmanager.h"
 #include "syscall/systemio.h"
+#include "tracespans.h"
 
 #include "VSRTL/graphics/vsrtl_widget.h"
 
@@ -71,10 +74,23 @@ ProcessorTab::ProcessorTab(QToolBar *controlToolbar,
 
   m_vsrtlWidget = m_ui->vsrtlWidget;
 
+  // Deselected processors are kept along with their designs, such that
+  // switching between processors does not construct them again.
+  ProcessorHandler::setProcessorCaching(true);
+  connect(ProcessorHandler::get(), &ProcessorHandler::processorEvicted, this,
+          [=](const RipesProcessor *processor) {
+            if (processor == m_designProcessor) {
+              m_vsrtlWidget->clearDesign();
+              m_stageInstructionLabels.clear();
+              m_designProcessor = nullptr;
+            }
+            m_stashedDesigns.erase(processor);
+          });
+
   if (ProcessorHandler::isVSRTLProcessor()) {
-    // Load the default constructed processor to the VSRTL widget. Do a bit of
-    // sanity checking to ensure that the layout stored in the settings is valid
-    // for the given processor
+    // Load the default constructed processor to the VSRTL widget once shown.
+    // Do a bit of sanity checking to ensure that the layout stored in the
+    // settings is valid for the given processor
     unsigned layoutID =
         RipesSettings::value(RIPES_SETTING_PROCESSOR_LAYOUT_ID).toInt();
     const Layout *layout = nullptr;
@@ -87,10 +103,7 @@ ProcessorTab::ProcessorTab(QToolBar *controlToolbar,
     if (layouts.size() > layoutID) {
       layout = &layouts.at(layoutID);
     }
-    loadProcessorToWidget(layout);
-
-    // By default, lock the VSRTL widget
-    m_vsrtlWidget->setLocked(true);
+    m_pendingDesign = layout;
   }
 
   m_stageModel = new PipelineDiagramModel(this);
@@ -102,32 +115,29 @@ ProcessorTab::ProcessorTab(QToolBar *controlToolbar,
           this, &ProcessorTab::updateInstructionLabels);
   connect(ProcessorHandler::get(), &ProcessorHandler::procStateChangedNonRun,
           this, [=] {
-            m_reverseAction->setEnabled(m_vsrtlWidget->isReversible() &&
+            m_reverseAction->setEnabled(canReverse() &&
                                         !m_autoClockAction->isChecked());
           });
 
   setupSimulatorActions(controlToolbar);
 
-  // Setup statistics update timer - this timer is distinct from the
-  // ProcessorHandler's update timer, given that it needs to run during
-  // 'running' the processor.
-  m_statUpdateTimer = new QTimer(this);
-  m_statUpdateTimer->setInterval(
-      1000.0 / RipesSettings::value(RIPES_SETTING_UIUPDATEPS).toInt());
-  connect(m_statUpdateTimer, &QTimer::timeout, this,
+  // Statistics are also updated whilst running, from the state snapshot of the
+  // ProcessorHandler.
+  connect(ProcessorHandler::get(), &ProcessorHandler::runStateRefreshed, this,
           &ProcessorTab::updateStatistics);
-  connect(RipesSettings::getObserver(RIPES_SETTING_UIUPDATEPS),
-          &SettingObserver::modified, m_statUpdateTimer, [=] {
-            m_statUpdateTimer->setInterval(
-                1000.0 /
-                RipesSettings::value(RIPES_SETTING_UIUPDATEPS).toInt());
+  // The processor does not signal its view whilst auto-clocking, which is a
+  // paced run; the view is synchronized once per refresh instead.
+  connect(ProcessorHandler::get(), &ProcessorHandler::runStateRefreshed, this,
+          [=] {
+            if (m_autoClockAction->isChecked())
+              m_vsrtlWidget->sync();
           });
 
   // Connect changes in VSRTL reversible stack size to checking whether the
   // simulator is reversible
   connect(RipesSettings::getObserver(RIPES_SETTING_REWINDSTACKSIZE),
           &SettingObserver::modified, m_reverseAction, [=](const auto &) {
-            m_reverseAction->setEnabled(m_vsrtlWidget->isReversible());
+            m_reverseAction->setEnabled(canReverse());
           });
 
   // Connect the global reset request signal to reset()
@@ -139,6 +149,12 @@ ProcessorTab::ProcessorTab(QToolBar *controlToolbar,
           &ProcessorTab::runFinished);
   connect(ProcessorHandler::get(), &ProcessorHandler::stopping, this,
           &ProcessorTab::pause);
+  connect(ProcessorHandler::get(), &ProcessorHandler::watchpointTriggered,
+          this, [=](const Watchpoints::Hit &hit) {
+            pause();
+            GeneralStatusManager::setStatusTimed(
+                hit.describe(ProcessorHandler::currentISA()), 10000);
+          });
 
   // Make processor view stretch wrt. consoles
   m_ui->pipelinesplitter->setStretchFactor(0, 1);
@@ -159,6 +175,7 @@ ProcessorTab::ProcessorTab(QToolBar *controlToolbar,
 void ProcessorTab::loadLayout(const Layout &layout) {
   if (layout.name.isEmpty() || layout.file.isEmpty())
     return; // Not a valid layout
+  TraceSpan span("Load layout");
 
   if (layout.stageLabelPositions.size() !=
       ProcessorHandler::getProcessor()->structure().numStages()) {
@@ -220,6 +237,19 @@ void ProcessorTab::setupSimulatorActions(QToolBar *controlToolbar) {
   m_reverseAction->setToolTip("Undo a clock cycle (F4)");
   controlToolbar->addAction(m_reverseAction);
 
+  const QIcon reverseToWriteIcon = QIcon(":/icons/crosshair.svg");
+  m_reverseToWriteAction =
+      new QAction(reverseToWriteIcon, "Reverse to last write...", this);
+  connect(m_reverseToWriteAction, &QAction::triggered, this,
+          &ProcessorTab::reverseToLastWrite);
+  m_reverseToWriteAction->setToolTip(
+      "Reverse to the latest write of a register or memory address");
+  controlToolbar->addAction(m_reverseToWriteAction);
+  // Available whenever reversing is, for processors searching their history.
+  connect(m_reverseAction, &QAction::enabledChanged, m_reverseToWriteAction,
+          [=] { updateReverseToWriteAction(); });
+  updateReverseToWriteAction();
+
   const QIcon clockIcon = QIcon(":/icons/step.svg");
   m_clockAction = new QAction(clockIcon, "Clock (F5)", this);
   connect(m_clockAction, &QAction::triggered, this,
@@ -228,10 +258,6 @@ void ProcessorTab::setupSimulatorActions(QToolBar *controlToolbar) {
   m_clockAction->setToolTip("Clock the circuit (F5)");
   controlToolbar->addAction(m_clockAction);
 
-  m_autoClockTimer = new QTimer(this);
-  connect(m_autoClockTimer, &QTimer::timeout, this,
-          [=] { autoClockTimeout(); });
-
   const QIcon startAutoClockIcon = QIcon(":/icons/step-clock.svg");
   m_autoClockAction = new QAction(startAutoClockIcon, "Auto clock (F6)", this);
   m_autoClockAction->setShortcut(QKeySequence("F6"));
@@ -242,18 +268,18 @@ void ProcessorTab::setupSimulatorActions(QToolBar *controlToolbar) {
   connect(m_autoClockAction, &QAction::toggled, this, &ProcessorTab::autoClock);
   controlToolbar->addAction(m_autoClockAction);
 
-  m_autoClockInterval = new QSpinBox(this);
-  m_autoClockInterval->setRange(1, 10000);
-  m_autoClockInterval->setSuffix(" ms");
-  m_autoClockInterval->setToolTip("Auto clock interval");
-  connect(m_autoClockInterval, qOverload<int>(&QSpinBox::valueChanged), this,
-          [this](int msec) {
-            RipesSettings::setValue(RIPES_SETTING_AUTOCLOCK_INTERVAL, msec);
-            m_autoClockTimer->setInterval(msec);
+  m_autoClockRate = new QSpinBox(this);
+  m_autoClockRate->setRange(1, 10000);
+  m_autoClockRate->setSuffix(" Hz");
+  m_autoClockRate->setToolTip("Auto clock frequency");
+  connect(m_autoClockRate, qOverload<int>(&QSpinBox::valueChanged), this,
+          [this](int hz) {
+            RipesSettings::setValue(RIPES_SETTING_AUTOCLOCK_RATE, hz);
+            ProcessorHandler::setRunRate(hz);
           });
-  m_autoClockInterval->setValue(
-      RipesSettings::value(RIPES_SETTING_AUTOCLOCK_INTERVAL).toInt());
-  controlToolbar->addWidget(m_autoClockInterval);
+  m_autoClockRate->setValue(
+      RipesSettings::value(RIPES_SETTING_AUTOCLOCK_RATE).toInt());
+  controlToolbar->addWidget(m_autoClockRate);
 
   const QIcon runIcon = QIcon(":/icons/run.svg");
   m_runAction = new QAction(runIcon, "Run (F8)", this);
@@ -270,7 +296,7 @@ void ProcessorTab::setupSimulatorActions(QToolBar *controlToolbar) {
   // Setup processor-tab only actions
   m_displayValuesAction = new QAction("Show processor signal values", this);
   m_displayValuesAction->setCheckable(true);
-  connect(m_displayValuesAction, &QAction::toggled, m_vsrtlWidget,
+  connect(m_displayValuesAction, &QAction::toggled, this,
           [=](bool checked) {
             RipesSettings::setValue(RIPES_SETTING_SHOWSIGNALS,
                                     QVariant::fromValue(checked));
@@ -288,7 +314,7 @@ void ProcessorTab::setupSimulatorActions(QToolBar *controlToolbar) {
 
   m_darkmodeAction = new QAction("Processor darkmode", this);
   m_darkmodeAction->setCheckable(true);
-  connect(m_darkmodeAction, &QAction::toggled, m_vsrtlWidget,
+  connect(m_darkmodeAction, &QAction::toggled, this,
           [=](bool checked) {
             RipesSettings::setValue(RIPES_SETTING_DARKMODE,
                                     QVariant::fromValue(checked));
@@ -298,15 +324,45 @@ void ProcessorTab::setupSimulatorActions(QToolBar *controlToolbar) {
       RipesSettings::value(RIPES_SETTING_DARKMODE).toBool());
 }
 
+void ProcessorTab::tabVisibilityChanged(bool visible) {
+  // The processor is not drawn whilst the tab is hidden, and is synchronized
+  // with the view once shown.
+  ProcessorHandler::setProcessorDrawingEnabled(visible);
+}
+
+void ProcessorTab::showEvent(QShowEvent *event) {
+  RipesTab::showEvent(event);
+  loadPendingDesign();
+  if (m_stale) {
+    m_stale = false;
+    if (ProcessorHandler::isVSRTLProcessor())
+      m_vsrtlWidget->sync();
+    updateInstructionLabels();
+    m_instrModel->updateStageInfo();
+    m_instrModel->updateMisses();
+  }
+  updateStatistics();
+}
+
+void ProcessorTab::setCaches(const std::shared_ptr<const CacheSim> &icache,
+                             const std::shared_ptr<const CacheSim> &dcache) {
+  m_icache = icache;
+  m_dcache = dcache;
+  m_instrModel->setCaches(m_icache, m_dcache);
+}
+
 void ProcessorTab::updateStatistics() {
+  // Statistics of a hidden tab are updated once the tab is shown.
+  if (!isVisible())
+    return;
+
+  const auto state = ProcessorHandler::stateSnapshot();
   static auto lastUpdateTime = std::chrono::system_clock::now();
-  static long long lastCycleCount =
-      ProcessorHandler::getProcessor()->getCycleCount();
+  static long long lastCycleCount = state.cycleCount;
 
   const auto timeNow = std::chrono::system_clock::now();
-  const auto cycleCount = ProcessorHandler::getProcessor()->getCycleCount();
-  const auto instrsRetired =
-      ProcessorHandler::getProcessor()->getInstructionsRetired();
+  const auto cycleCount = state.cycleCount;
+  const auto instrsRetired = state.instructionsRetired;
   const auto timeDiff = std::chrono::duration_cast<std::chrono::milliseconds>(
                             timeNow - lastUpdateTime)
                             .count() /
@@ -341,7 +397,7 @@ void ProcessorTab::updateStatistics() {
 void ProcessorTab::pause() {
   m_autoClockAction->setChecked(false);
   m_runAction->setChecked(false);
-  m_reverseAction->setEnabled(m_vsrtlWidget->isReversible());
+  m_reverseAction->setEnabled(canReverse());
 }
 
 void ProcessorTab::fitToScreen() { m_vsrtlWidget->zoomToFit(); }
@@ -349,6 +405,8 @@ void ProcessorTab::fitToScreen() { m_vsrtlWidget->zoomToFit(); }
 void ProcessorTab::loadProcessorToWidget(const Layout *layout) {
   const bool doPlaceAndRoute = layout != nullptr;
   ProcessorHandler::loadProcessorToWidget(m_vsrtlWidget, doPlaceAndRoute);
+  m_designProcessor = ProcessorHandler::getProcessor();
+  m_designLayout = layout ? layout->name : QString();
 
   // Construct stage instruction labels
   auto *topLevelComponent = m_vsrtlWidget->getTopLevelComponent();
@@ -369,13 +427,85 @@ void ProcessorTab::loadProcessorToWidget(const Layout *layout) {
   fitToScreen();
 }
 
+void ProcessorTab::loadPendingDesign() {
+  if (!m_pendingDesign)
+    return;
+  const Layout *layout = *m_pendingDesign;
+  m_pendingDesign.reset();
+  loadProcessorToWidget(layout);
+
+  // By default, lock the VSRTL widget
+  m_vsrtlWidget->setLocked(true);
+
+  // Retrigger value display action if enabled
+  if (m_displayValuesAction->isChecked())
+    m_vsrtlWidget->setOutputPortValuesVisible(true);
+}
+
+void ProcessorTab::setVSRTLWidget(vsrtl::VSRTLWidget *widget) {
+  m_vsrtlWidget = widget;
+  m_vsrtlWidget->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+  m_vsrtlWidget->setDarkmode(m_darkmodeAction->isChecked());
+}
+
+void ProcessorTab::stashDesign() {
+  m_pendingDesign.reset();
+  if (!m_designProcessor) {
+    m_vsrtlWidget->clearDesign();
+    m_stageInstructionLabels.clear();
+    return;
+  }
+
+  // The widget keeps the placed and routed design; an empty widget takes its
+  // place in the view.
+  auto *splitter = m_ui->pipelinesplitter;
+  auto *widget = new vsrtl::VSRTLWidget();
+  splitter->replaceWidget(splitter->indexOf(m_vsrtlWidget), widget);
+  m_stashedDesigns[m_designProcessor] = {
+      std::unique_ptr<vsrtl::VSRTLWidget>(m_vsrtlWidget),
+      std::move(m_stageInstructionLabels), m_designLayout};
+  m_stageInstructionLabels.clear();
+  m_designProcessor = nullptr;
+  setVSRTLWidget(widget);
+}
+
+void ProcessorTab::restoreDesign(const Layout *layout) {
+  if (!ProcessorHandler::isVSRTLProcessor())
+    return;
+
+  auto it = m_stashedDesigns.find(ProcessorHandler::getProcessor());
+  if (it == m_stashedDesigns.end()) {
+    m_pendingDesign = layout;
+    if (isVisible())
+      loadPendingDesign();
+    return;
+  }
+
+  StashedDesign stashed = std::move(it->second);
+  m_stashedDesigns.erase(it);
+  auto *splitter = m_ui->pipelinesplitter;
+  delete splitter->replaceWidget(splitter->indexOf(m_vsrtlWidget),
+                                 stashed.widget.get());
+  setVSRTLWidget(stashed.widget.release());
+  m_designProcessor = ProcessorHandler::getProcessor();
+  m_designLayout = stashed.layout;
+  m_stageInstructionLabels = std::move(stashed.stageInstructionLabels);
+  if (layout && layout->name != m_designLayout) {
+    loadLayout(*layout);
+    m_designLayout = layout->name;
+  }
+  m_vsrtlWidget->setOutputPortValuesVisible(m_displayValuesAction->isChecked());
+  ProcessorHandler::setProcessorDrawingEnabled(isVisible());
+  updateInstructionLabels();
+  m_vsrtlWidget->sync();
+}
+
 void ProcessorTab::processorSelection() {
   m_autoClockAction->setChecked(false);
   ProcessorSelectionDialog diag;
   if (diag.exec()) {
     // New processor model was selected
-    m_vsrtlWidget->clearDesign();
-    m_stageInstructionLabels.clear();
+    stashDesign();
     ProcessorHandler::selectProcessor(diag.getSelectedId(),
                                       diag.getEnabledExtensions(),
                                       diag.getRegisterInitialization());
@@ -391,21 +521,15 @@ void ProcessorTab::processorSelection() {
                               static_cast<int>(layoutIndex));
     }
 
-    if (ProcessorHandler::isVSRTLProcessor()) {
-      loadProcessorToWidget(diag.getSelectedLayout());
-    }
+    restoreDesign(diag.getSelectedLayout());
     updateInstructionModel();
-
-    // Retrigger value display action if enabled
-    if (m_displayValuesAction->isChecked()) {
-      m_vsrtlWidget->setOutputPortValuesVisible(true);
-    }
   }
 }
 
 void ProcessorTab::updateInstructionModel() {
   auto *oldModel = m_instrModel;
   m_instrModel = new InstructionModel(this);
+  m_instrModel->setCaches(m_icache, m_dcache);
 
   // Update the instruction view according to the newly created model
   m_ui->instructionView->setEditTriggers(QAbstractItemView::NoEditTriggers);
@@ -430,12 +554,26 @@ void ProcessorTab::updateInstructionModel() {
                                               Qt::Horizontal, Qt::DisplayRole)
                                  .toString()) *
           1.25);
+  // As for the "stage" section, the "misses" section is not resized to
+  // contents.
+  m_ui->instructionView->horizontalHeader()->setSectionResizeMode(
+      InstructionModel::Misses, QHeaderView::Interactive);
+  m_ui->instructionView->horizontalHeader()->resizeSection(
+      InstructionModel::Misses, ivfm.horizontalAdvance("I:0000 D:0000"));
   m_ui->instructionView->horizontalHeader()->setSectionResizeMode(
       InstructionModel::Instruction, QHeaderView::Stretch);
   // Make the instruction view follow the instruction which is currently present
   // in the first stage of the
   connect(m_instrModel, &InstructionModel::firstStageInstrChanged, this,
           &ProcessorTab::setInstructionViewCenterRow);
+  connect(ProcessorHandler::get(), &ProcessorHandler::procStateChangedNonRun,
+          m_instrModel, [=] {
+            if (isVisible()) {
+              m_instrModel->updateStageInfo();
+              m_instrModel->updateMisses();
+            } else
+              m_stale = true;
+          });
 
   if (oldModel) {
     delete oldModel;
@@ -462,12 +600,24 @@ void ProcessorTab::enableSimulatorControls() {
   m_clockAction->setEnabled(true);
   m_autoClockAction->setEnabled(true);
   m_runAction->setEnabled(true);
-  m_reverseAction->setEnabled(m_vsrtlWidget->isReversible());
+  m_reverseAction->setEnabled(canReverse());
+  // The processor may have changed whilst reversing remained enabled.
+  updateReverseToWriteAction();
   m_resetAction->setEnabled(true);
   m_pipelineDiagramAction->setEnabled(true);
 }
 
+void ProcessorTab::updateReverseToWriteAction() {
+  m_reverseToWriteAction->setEnabled(m_reverseAction->isEnabled() &&
+                                     !ProcessorHandler::isVSRTLProcessor());
+}
+
 void ProcessorTab::updateInstructionLabels() {
+  // The labels of a hidden tab are updated once the tab is shown.
+  if (!isVisible()) {
+    m_stale = true;
+    return;
+  }
   const auto &proc = ProcessorHandler::getProcessor();
   for (auto sid : ProcessorHandler::getProcessor()->structure().stageIt()) {
     if (!m_stageInstructionLabels.count(sid))
@@ -520,28 +670,18 @@ void ProcessorTab::runFinished() {
   pause();
   ProcessorHandler::checkProcessorFinished();
   m_vsrtlWidget->sync();
-  m_statUpdateTimer->stop();
-}
-
-void ProcessorTab::autoClockTimeout() {
-  if (ProcessorHandler::checkBreakpoint())
-    return;
-  ProcessorHandler::clock();
 }
 
 void ProcessorTab::autoClock(bool state) {
   const QIcon startAutoClockIcon = QIcon(":/icons/step-clock.svg");
   const QIcon stopAutoTimerIcon = QIcon(":/icons/stop-clock.svg");
   if (!state) {
-    m_autoClockTimer->stop();
+    ProcessorHandler::stopRun();
     m_autoClockAction->setIcon(startAutoClockIcon);
   } else {
-    // Always clock the processor to start with. Afterwards, run
-    // autoClockTimeout() which will check if the processor is at a breakpoint.
-    // This is to circumvent some annoying cross-thread, eventloop,
-    // race-condition-y state setting wrt. when exactly a breakpoint is hit.
-    ProcessorHandler::clock();
-    m_autoClockTimer->start();
+    // The processor is clocked by a paced run on the simulation thread, which
+    // stops at breakpoints as runs do (see ProcessorHandler::runPaced).
+    ProcessorHandler::runPaced(m_autoClockRate->value());
     m_autoClockAction->setIcon(stopAutoTimerIcon);
   }
 
@@ -562,10 +702,8 @@ void ProcessorTab::run(bool state) {
   }
   if (state) {
     ProcessorHandler::run();
-    m_statUpdateTimer->start();
   } else {
     ProcessorHandler::stopRun();
-    m_statUpdateTimer->stop();
   }
 
   // Enable/Disable all actions based on whether the processor is running.
@@ -583,8 +721,77 @@ void ProcessorTab::run(bool state) {
   m_ui->instructionView->setEnabled(!state);
 }
 
+bool ProcessorTab::canReverse() const {
+  if (ProcessorHandler::isVSRTLProcessor()) {
+    // The design is reversed directly whilst not loaded to the widget.
+    if (m_pendingDesign)
+      return dynamic_cast<const vsrtl::SimDesign *>(
+                 ProcessorHandler::getProcessor())
+          ->canReverse();
+    return m_vsrtlWidget->isReversible();
+  }
+  // Non-VSRTL processors implement reverse execution themselves.
+  return ProcessorHandler::getProcessor()->features() &
+         RipesProcessor::isReversible;
+}
+
 void ProcessorTab::reverse() {
-  m_vsrtlWidget->reverse();
+  if (ProcessorHandler::isVSRTLProcessor() && !m_pendingDesign)
+    m_vsrtlWidget->reverse();
+  else
+    ProcessorHandler::getProcessorNonConst()->reverseProcessor();
+  enableSimulatorControls();
+}
+
+void ProcessorTab::reverseToLastWrite() {
+  bool ok;
+  const QString target =
+      QInputDialog::getText(this, "Reverse to last write",
+                            "Register, or address[:bytes] of memory:",
+                            QLineEdit::Normal, QString(), &ok)
+          .trimmed();
+  if (!ok || target.isEmpty())
+    return;
+
+  std::optional<WriteQuery> query;
+  for (const auto &[rfid, regInfo] :
+       ProcessorHandler::currentISA()->regInfoMap()) {
+    bool found;
+    const unsigned index = regInfo->regNumber(target, found);
+    if (found) {
+      query = WriteQuery{WriteQuery::Kind::Register, rfid, index};
+      break;
+    }
+  }
+  if (!query) {
+    // Addresses are given as numbers or program symbols.
+    const QStringList parts = target.split(':');
+    std::optional<AInt> address;
+    bool isImmediate;
+    const AInt value = getImmediate(parts.at(0).trimmed(), isImmediate);
+    if (isImmediate)
+      address = value;
+    else if (auto program = ProcessorHandler::getProgram())
+      address = program->symbolIndex().address(parts.at(0).trimmed());
+    unsigned bytes = 1;
+    bool validBytes = parts.size() <= 2;
+    if (validBytes && parts.size() == 2) {
+      bytes = parts.at(1).trimmed().toUInt(&validBytes, 0);
+      validBytes &= bytes > 0;
+    }
+    if (!address || !validBytes) {
+      QMessageBox::warning(this, "Reverse to last write",
+                           "'" + target +
+                               "' is neither a register nor an address.");
+      return;
+    }
+    query = WriteQuery{WriteQuery::Kind::Memory, {}, 0, *address, bytes};
+  }
+
+  if (!ProcessorHandler::getProcessorNonConst()->reverseToLastWrite(*query))
+    QMessageBox::information(
+        this, "Reverse to last write",
+        "No write of '" + target + "' was found within the reverse history.");
   enableSimulatorControls();
 }
 
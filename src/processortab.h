@@ -2,9 +2,10 @@
 
 #include <QAction>
 #include <QSpinBox>
-#include <QTimer>
 #include <QToolBar>
 #include <QWidget>
+#include <memory>
+#include <optional>
 
 #include "isa/isa_types.h"
 #include "processors/interface/ripesprocessor.h"
@@ -21,6 +22,7 @@ namespace Ui {
 class ProcessorTab;
 }
 
+class CacheSim;
 class InstructionModel;
 class RegisterModel;
 class PipelineDiagramModel;
@@ -37,12 +39,20 @@ public:
   ~ProcessorTab() override;
 
   void initRegWidget();
+  void tabVisibilityChanged(bool visible) override;
+  /// Sets the caches whose misses are shown in the instruction view.
+  void setCaches(const std::shared_ptr<const CacheSim> &icache,
+                 const std::shared_ptr<const CacheSim> &dcache);
+
+protected:
+  void showEvent(QShowEvent *event) override;
 
 public slots:
   void pause();
   void restart();
   void reset();
   void reverse();
+  void reverseToLastWrite();
   void processorFinished();
   void runFinished();
   void updateStatistics();
@@ -54,27 +64,55 @@ public slots:
 private slots:
   void run(bool state);
   void autoClock(bool state);
-  void autoClockTimeout();
   void setInstructionViewCenterRow(int row);
   void showPipelineDiagram();
 
 private:
   void setupSimulatorActions(QToolBar *controlToolbar);
   void enableSimulatorControls();
+  bool canReverse() const;
+  void updateReverseToWriteAction();
   void updateInstructionModel();
   void updateRegisterModel();
   void loadLayout(const Layout &);
   void loadProcessorToWidget(const Layout *);
+  // Loads the processor to the VSRTL widget, if deferred until shown.
+  void loadPendingDesign();
+  // Moves the design of the current processor out of the view, such that it
+  // may be restored if the processor is selected again.
+  void stashDesign();
+  // Restores the stashed design of the current processor, or otherwise loads
+  // its design with the given layout.
+  void restoreDesign(const Layout *layout);
+  void setVSRTLWidget(vsrtl::VSRTLWidget *widget);
 
   Ui::ProcessorTab *m_ui = nullptr;
   InstructionModel *m_instrModel = nullptr;
   PipelineDiagramModel *m_stageModel = nullptr;
+  std::shared_ptr<const CacheSim> m_icache;
+  std::shared_ptr<const CacheSim> m_dcache;
 
   vsrtl::VSRTLWidget *m_vsrtlWidget = nullptr;
+  // The layout of the processor to load to the VSRTL widget once the tab is
+  // shown. Placing the components of a processor dominates the startup time,
+  // and is not required until the processor is viewed.
+  std::optional<const Layout *> m_pendingDesign;
+  // The processor whose design is loaded to the VSRTL widget, and its layout.
+  const RipesProcessor *m_designProcessor = nullptr;
+  QString m_designLayout;
+
+  struct StashedDesign {
+    std::unique_ptr<vsrtl::VSRTLWidget> widget;
+    std::map<StageIndex, vsrtl::Label *> stageInstructionLabels;
+    QString layout;
+  };
+  // Placed and routed designs of the processors kept by the ProcessorHandler,
+  // such that switching back to a processor does not place it again.
+  std::map<const RipesProcessor *, StashedDesign> m_stashedDesigns;
 
   std::map<StageIndex, vsrtl::Label *> m_stageInstructionLabels;
-
-  QTimer *m_statUpdateTimer;
+  // Set if the processor view was hidden whilst the processor state changed.
+  bool m_stale = false;
 
   // Actions
   QAction *m_selectProcessorAction = nullptr;
@@ -84,10 +122,10 @@ private:
   QAction *m_displayValuesAction = nullptr;
   QAction *m_pipelineDiagramAction = nullptr;
   QAction *m_reverseAction = nullptr;
+  QAction *m_reverseToWriteAction = nullptr;
   QAction *m_resetAction = nullptr;
   QAction *m_darkmodeAction = nullptr;
-  QTimer *m_autoClockTimer = nullptr;
 
-  QSpinBox *m_autoClockInterval = nullptr;
+  QSpinBox *m_autoClockRate = nullptr;
 };
 } // namespace Ripes
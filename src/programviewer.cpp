@@ -3,9 +3,12 @@
 #include <QAction>
 #include <QApplication>
 #include <QEvent>
-#include <QFontMetricsF>
+#include <QInputDialog>
 #include <QMenu>
-#include <QTextBlock>
+#include <QMessageBox>
+#include <QPainter>
+
+#include <limits>
 
 #include "colors.h"
 #include "fonts.h"
@@ -13,78 +16,257 @@
 
 namespace Ripes {
 
-ProgramViewer::ProgramViewer(QWidget *parent) : HighlightableTextEdit(parent) {
-  m_breakpointArea = new BreakpointArea(this);
+// Indentation between the columns of an instruction row.
+static const QString s_indent = "    ";
+// Rows occupied by the label of a symbol; a blank row and the label itself.
+static constexpr int s_symbolRows = 2;
+// Horizontal padding of the text of a row.
+static constexpr int s_textPadding = 4;
 
-  connect(this, &QPlainTextEdit::blockCountChanged, this,
-          &ProgramViewer::updateSidebarWidth);
-  connect(this, &QPlainTextEdit::updateRequest, this,
-          &ProgramViewer::updateSidebar);
-  updateSidebarWidth(0);
+ProgramViewer::ProgramViewer(QWidget *parent) : QAbstractScrollArea(parent) {
+  m_breakpointArea = new BreakpointArea(this);
+  m_sidebarWidth = m_breakpointArea->width();
+  setViewportMargins(m_sidebarWidth, 0, 0, 0);
 
   // Set font for the entire widget. calls to fontMetrics() will get the
   // dimensions of the currently set font
   m_font = QFont(Fonts::monospace, 11);
   setFont(m_font);
-  m_fontTimer.setSingleShot(true);
-
-  setTabStopDistance(QFontMetricsF(m_font).horizontalAdvance(' ') * 4);
 
-  setLineWrapMode(QPlainTextEdit::NoWrap);
+  viewport()->setBackgroundRole(QPalette::Base);
+  viewport()->setAutoFillBackground(true);
+  setFocusPolicy(Qt::StrongFocus);
+  updateScrollBars();
 }
 
 void ProgramViewer::clearBreakpoints() { ProcessorHandler::clearBreakpoints(); }
 
 void ProgramViewer::resizeEvent(QResizeEvent *e) {
-  HighlightableTextEdit::resizeEvent(e);
+  QAbstractScrollArea::resizeEvent(e);
 
   const QRect cr = contentsRect();
   m_breakpointArea->setGeometry(cr.left(), cr.top(), m_breakpointArea->width(),
                                 cr.height());
+  updateScrollBars();
+}
 
-  // we need to update the highlighted lines whenever resizing the window to
-  // recalculate the highlighting gradient, reflecting the new widget size
-  updateHighlightedAddresses();
+void ProgramViewer::scrollContentsBy(int, int) {
+  viewport()->update();
+  m_breakpointArea->update();
+}
+
+int ProgramViewer::rowHeight() const { return fontMetrics().lineSpacing(); }
+
+int ProgramViewer::visibleRowCount() const {
+  return std::max(1, viewport()->height() / rowHeight());
+}
+
+int ProgramViewer::rowCount() const {
+  if (!m_program)
+    return 0;
+  return m_program->getDisassembled().numInstructions() +
+         s_symbolRows * m_symbols.size();
+}
+
+void ProgramViewer::updateScrollBars() {
+  const int visibleRows = visibleRowCount();
+  verticalScrollBar()->setRange(0, std::max(0, rowCount() - visibleRows));
+  verticalScrollBar()->setPageStep(visibleRows);
+  verticalScrollBar()->setSingleStep(1);
+
+  const int textWidth = m_textWidth + 2 * s_textPadding;
+  horizontalScrollBar()->setRange(
+      0, std::max(0, textWidth - viewport()->width()));
+  horizontalScrollBar()->setPageStep(viewport()->width());
+  horizontalScrollBar()->setSingleStep(fontMetrics().averageCharWidth());
 }
 
 void ProgramViewer::updateProgram(bool binary) {
-  m_labelAddrOffsetMap.clear();
-  const QString text =
-      binary ? Assembler::binobjdump(ProcessorHandler::getProgram(),
-                                     m_labelAddrOffsetMap)
-             : Assembler::objdump(ProcessorHandler::getProgram(),
-                                  m_labelAddrOffsetMap);
-
-  clearBlockHighlights();
-  setPlainText(text);
+  m_binary = binary;
+  m_program = ProcessorHandler::getProgram();
+  m_symbols.clear();
+  m_highlights.clear();
+  m_textWidth = 0;
+
+  // Only the symbols labelling instructions of the text section are shown.
+  // The symbols are located through the layout of the disassembled program,
+  // without disassembling it.
+  const auto *text =
+      m_program ? m_program->getSection(TEXT_SECTION_NAME) : nullptr;
+  if (text) {
+    const auto &disassembled = m_program->getDisassembled();
+    const AInt end = text->address + text->data.size();
+    for (auto it = m_program->symbols.lower_bound(text->address);
+         it != m_program->symbols.end() && it->first < end; ++it) {
+      if (auto index = disassembled.addressToIndex(it->first))
+        m_symbols.push_back({*index, it->second.v});
+    }
+  }
+
+  updateScrollBars();
+  verticalScrollBar()->setValue(0);
+  horizontalScrollBar()->setValue(0);
+  viewport()->update();
+  m_breakpointArea->update();
   updateHighlightedAddresses();
 }
 
-void ProgramViewer::updateSidebar(const QRect &rect, int /*dy*/) {
-  m_breakpointArea->update(0, rect.y(), m_breakpointArea->width(),
-                           rect.height());
+int ProgramViewer::symbolForRow(int row) const {
+  // The label of symbol k starts at row index_k + k * s_symbolRows.
+  int symbolIdx = 0;
+  int count = m_symbols.size();
+  while (count > 0) {
+    const int step = count / 2;
+    const int mid = symbolIdx + step;
+    if (static_cast<int>(m_symbols.at(mid).index) + mid * s_symbolRows <=
+        row) {
+      symbolIdx = mid + 1;
+      count -= step + 1;
+    } else {
+      count = step;
+    }
+  }
+  return symbolIdx - 1;
+}
+
+AInt ProgramViewer::addressForRow(int row, bool &ok) const {
+  ok = false;
+  if (!m_program || row < 0 || row >= rowCount())
+    return 0;
+  const int symbolIdx = symbolForRow(row);
+  int index = row;
+  if (symbolIdx >= 0) {
+    const int labelRow =
+        m_symbols.at(symbolIdx).index + symbolIdx * s_symbolRows;
+    if (row - labelRow < s_symbolRows)
+      return 0;
+    index = row - (symbolIdx + 1) * s_symbolRows;
+  }
+  const auto address = m_program->getDisassembled().indexToAddress(index);
+  ok = address.has_value();
+  return ok ? address.value() : 0;
+}
 
-  if (rect.contains(viewport()->rect()))
-    updateSidebarWidth(0);
+int ProgramViewer::rowForAddress(AInt address) const {
+  if (!m_program)
+    return -1;
+  const auto index = m_program->getDisassembled().addressToIndex(address);
+  if (!index.has_value())
+    return -1;
+  const auto labels = std::upper_bound(
+      m_symbols.begin(), m_symbols.end(), index.value(),
+      [](unsigned idx, const Symbol &symbol) { return idx < symbol.index; });
+  return index.value() + s_symbolRows * (labels - m_symbols.begin());
 }
 
-void ProgramViewer::updateSidebarWidth(int /* newBlockCount */) {
-  // Set margins of the text edit area
-  m_sidebarWidth = m_breakpointArea->width();
-  setViewportMargins(m_sidebarWidth, 0, 0, 0);
+QString ProgramViewer::rowText(int row) const {
+  const auto *text = m_program->getSection(TEXT_SECTION_NAME);
+  const int symbolIdx = symbolForRow(row);
+  if (symbolIdx >= 0) {
+    const auto &symbol = m_symbols.at(symbolIdx);
+    const int labelRow = symbol.index + symbolIdx * s_symbolRows;
+    if (row == labelRow)
+      return QString();
+    if (row == labelRow + 1) {
+      const unsigned regBytes = ProcessorHandler::currentISA()->bytes();
+      const AInt address =
+          *m_program->getDisassembled().indexToAddress(symbol.index);
+      return QString::number(address, 16).rightJustified(regBytes * 2, '0') +
+             " <" + symbol.name + ">:";
+    }
+  }
+
+  bool ok;
+  const AInt address = addressForRow(row, ok);
+  if (!ok)
+    return QString();
+  const auto &disassembled = m_program->getDisassembled();
+  const unsigned index = *disassembled.addressToIndex(address);
+  const AInt end = text->address + text->data.size();
+  const AInt next = disassembled.indexToAddress(index + 1).value_or(end);
+  const unsigned bytes = std::min(next, end) - address;
+
+  // Instruction word, most significant byte first
+  QString wordString, binaryString;
+  for (unsigned i = 0; i < bytes; ++i) {
+    const auto byte =
+        static_cast<uint8_t>(text->data.at(address - text->address + i));
+    wordString.prepend(QString::number(byte, 16).rightJustified(2, '0'));
+    binaryString.prepend(QString::number(byte, 2).rightJustified(8, '0'));
+  }
+
+  QString out = s_indent + QString::number(address, 16) + ":" + s_indent +
+                s_indent + wordString + s_indent + s_indent;
+  // Pad if < default instruction width to align disassembled instruction
+  // with default instruction width column
+  int dBytes = ProcessorHandler::currentISA()->instrBytes() - bytes;
+  while (dBytes > 0) {
+    out += s_indent;
+    dBytes -= s_indent.size() / 2;
+  }
+  return out + (m_binary ? binaryString
+                         : disassembled.getFromIdx(index).value_or(QString()));
 }
 
-void ProgramViewer::setCenterAddress(const AInt address) {
-  auto block = blockForAddress(address);
-  if (block.isValid()) {
-    auto newCursor = QTextCursor(block);
-    if (newCursor.blockNumber() != 0) {
-      setTextCursor(newCursor);
-      ensureCursorVisible();
+void ProgramViewer::paintEvent(QPaintEvent *event) {
+  if (!m_program)
+    return;
+  QPainter painter(viewport());
+  painter.setFont(font());
+  const int height = rowHeight();
+  const int width = viewport()->width();
+  const int xOffset = s_textPadding - horizontalScrollBar()->value();
+  const int top = firstVisibleRow();
+  const int first = top + event->rect().top() / height;
+  const int last =
+      std::min(rowCount() - 1, top + event->rect().bottom() / height);
+
+  int textWidth = m_textWidth;
+  for (int row = first; row <= last; ++row) {
+    const QRect rowRect(0, (row - top) * height, width, height);
+    auto highlight = m_highlights.find(row);
+    if (highlight != m_highlights.end()) {
+      QLinearGradient grad(rowRect.topLeft(), rowRect.bottomRight());
+      grad.setColorAt(0, palette().base().color());
+      grad.setColorAt(1, highlight->second.color);
+      painter.fillRect(rowRect, grad);
     }
+
+    const QString text = rowText(row);
+    textWidth =
+        std::max(textWidth, painter.fontMetrics().horizontalAdvance(text));
+    painter.setPen(palette().text().color());
+    painter.drawText(rowRect.translated(xOffset, 0),
+                     Qt::AlignLeft | Qt::AlignVCenter, text);
+
+    // Draw stage names for highlighted addresses
+    if (highlight != m_highlights.end()) {
+      painter.drawText(rowRect.adjusted(0, 0, /* right-hand side padding*/ -10,
+                                        0),
+                       Qt::AlignRight | Qt::AlignVCenter,
+                       highlight->second.stages.join('/'));
+    }
+  }
+
+  // The scrollable width grows as wider rows are painted.
+  if (textWidth != m_textWidth) {
+    m_textWidth = textWidth;
+    updateScrollBars();
   }
 }
 
+void ProgramViewer::setCenterAddress(const AInt address) {
+  const int row = rowForAddress(address);
+  if (row < 0)
+    return;
+  const int first = firstVisibleRow();
+  const int visibleRows = visibleRowCount();
+  if (row < first)
+    verticalScrollBar()->setValue(row);
+  else if (row >= first + visibleRows)
+    verticalScrollBar()->setValue(row - visibleRows + 1);
+}
+
 void ProgramViewer::updateCenterAddressFromProcessor() {
   const auto stageInfo = ProcessorHandler::getProcessor()->stageInfo({0, 0});
   setCenterAddress(stageInfo.pc);
@@ -100,26 +282,49 @@ void ProgramViewer::setFollowEnabled(bool enabled) {
 }
 
 void ProgramViewer::updateHighlightedAddresses() {
-  clearBlockHighlights();
   const unsigned stages =
       ProcessorHandler::getProcessor()->structure().numStages();
   auto colorGenerator = Colors::incrementalRedGenerator(stages);
 
+  std::map<int, Highlight> highlights;
   for (auto sid : ProcessorHandler::getProcessor()->structure().stageIt()) {
     const auto stageInfo = ProcessorHandler::getProcessor()->stageInfo(sid);
     if (stageInfo.stage_valid) {
-      auto block = blockForAddress(stageInfo.pc);
-      if (!block.isValid())
+      const int row = rowForAddress(stageInfo.pc);
+      if (row < 0)
         continue;
 
-      // Record the stage name for the highlighted block for later painting
+      // Record the stage name for the highlighted row for later painting. A
+      // row keeps the color of the first stage it is highlighted for.
       QString stageString = ProcessorHandler::getProcessor()->stageName(sid);
       if (!stageInfo.namedState.isEmpty())
         stageString += " (" + stageInfo.namedState + ")";
-      highlightBlock(block, colorGenerator(), stageString);
+      auto it = highlights.try_emplace(row, Highlight{colorGenerator(), {}});
+      it.first->second.stages << stageString;
     }
   }
 
+  // Only rows within the viewport are repainted, and only if their
+  // highlighting changed.
+  const int first = firstVisibleRow();
+  const int last = first + visibleRowCount();
+  const auto changedInView = [&](const auto &lhs, const auto &rhs) {
+    for (const auto &[row, highlight] : lhs) {
+      if (row < first || row > last)
+        continue;
+      auto it = rhs.find(row);
+      if (it == rhs.end() || it->second.stages != highlight.stages ||
+          it->second.color != highlight.color)
+        return true;
+    }
+    return false;
+  };
+  const bool repaint = changedInView(highlights, m_highlights) ||
+                       changedInView(m_highlights, highlights);
+  m_highlights = std::move(highlights);
+  if (repaint)
+    viewport()->update();
+
   if (m_following) {
     updateCenterAddressFromProcessor();
   }
@@ -128,9 +333,7 @@ void ProgramViewer::updateHighlightedAddresses() {
 void ProgramViewer::breakpointAreaPaintEvent(QPaintEvent *event) {
   QPainter painter(m_breakpointArea);
 
-  // When caret flashes in QPlainTextEdit a paint event is sent to this widget,
-  // with a height of a line in the edit. We override this paint event by always
-  // redrawing the visible breakpoint area
+  // The visible breakpoint area is always redrawn in full
   auto area = m_breakpointArea->rect();
   QLinearGradient gradient =
       QLinearGradient(area.topLeft(), area.bottomRight());
@@ -139,170 +342,26 @@ void ProgramViewer::breakpointAreaPaintEvent(QPaintEvent *event) {
 
   painter.fillRect(area, gradient);
 
-  QTextBlock block = firstVisibleBlock();
-  if (block.isValid()) {
-    int top, bottom;
-    top = static_cast<int>(
-        blockBoundingGeometry(block).translated(contentOffset()).top());
-    bottom = top + static_cast<int>(blockBoundingRect(block).height());
-
+  const int height = rowHeight();
+  const int top = firstVisibleRow();
+  const int first = top + event->rect().top() / height;
+  const int last =
+      std::min(rowCount() - 1, top + event->rect().bottom() / height);
+  for (int row = first; row <= last; ++row) {
     bool ok;
-    while (block.isValid() && top <= event->rect().bottom()) {
-      if (block.isVisible() && bottom >= event->rect().top()) {
-        const AInt address = addressForBlock(block, ok);
-        if (ok) {
-          if (ProcessorHandler::hasBreakpoint(address)) {
-            painter.drawPixmap(
-                m_breakpointArea->padding, top, m_breakpointArea->imageWidth,
-                m_breakpointArea->imageHeight, m_breakpointArea->m_breakpoint);
-          }
-        }
-      }
-
-      block = block.next();
-      top = bottom;
-      bottom = top + static_cast<int>(blockBoundingRect(block).height());
-    }
-  }
-}
-
-QTextBlock ProgramViewer::blockForAddress(AInt addr) const {
-  uint64_t adjustedLineNumber = 0;
-  auto m_program = ProcessorHandler::getProgram();
-  if (m_program) {
-    auto &disassembleRes = m_program->getDisassembled();
-    if (auto index = disassembleRes.addressToIndex(addr); index.has_value())
-      adjustedLineNumber = index.value();
-  }
-
-  if (m_labelAddrOffsetMap.empty()) {
-    return document()->findBlockByNumber(adjustedLineNumber);
-  }
-
-  uint64_t lineNumber = adjustedLineNumber;
-  auto low = m_labelAddrOffsetMap.lower_bound(lineNumber);
-  if (low == m_labelAddrOffsetMap.begin() && lineNumber < low->first) {
-    // The line number is less that the position of the first offset block;
-    // block is directly inferred from linenumber.
-    return document()->findBlockByNumber(adjustedLineNumber);
-  }
-
-  auto high = low;
-  if (low != m_labelAddrOffsetMap.begin()) {
-    low = std::prev(m_labelAddrOffsetMap.lower_bound(lineNumber));
-  }
-  high = std::next(low);
-
-  auto validBlockRange = [&] {
-    if (m_labelAddrOffsetMap.count(lineNumber))
-      return false;
-
-    bool valid = true;
-    valid &= (low->first - low->second.first) <= adjustedLineNumber;
-    if (high != m_labelAddrOffsetMap.end()) {
-      valid &= adjustedLineNumber < (high->first - high->second.first);
-    }
-    return valid;
-  };
-
-  // Adjust low and high iterators to locate the range bounds of the address
-  while (!validBlockRange()) {
-    low = m_labelAddrOffsetMap.lower_bound(lineNumber);
-    high = std::next(low);
-    lineNumber = low->first + 1;
-  }
-
-  const int offsetSum = high == m_labelAddrOffsetMap.end()
-                            ? low->second.first + 1
-                            : high->second.first;
-  lineNumber = offsetSum + adjustedLineNumber;
-
-  return document()->findBlockByNumber(lineNumber);
-}
-
-AInt ProgramViewer::addressForBlock(QTextBlock block, bool &ok) const {
-  ok = true;
-  const static auto calcAddressFunc =
-      [&](int lineNumber) -> std::optional<AInt> {
-    auto m_program = ProcessorHandler::getProgram();
-    if (m_program) {
-      auto &disassembleRes = m_program->getDisassembled();
-      if (disassembleRes.numInstructions() <
-          static_cast<unsigned>(lineNumber)) {
-        return std::nullopt;
-      }
-      if (auto addr = disassembleRes.indexToAddress(lineNumber);
-          addr.has_value())
-        return static_cast<AInt>(addr.value());
+    const AInt address = addressForRow(row, ok);
+    if (ok && ProcessorHandler::hasBreakpoint(address)) {
+      painter.drawPixmap(m_breakpointArea->padding,
+                         (row - top) * height,
+                         m_breakpointArea->imageWidth,
+                         m_breakpointArea->imageHeight,
+                         m_breakpointArea->m_breakpoint);
     }
-    return std::nullopt;
-  };
-
-  const int lineNumber = block.blockNumber();
-
-  // Clicking an invalid line? (non-instruction line)
-  if (m_labelAddrOffsetMap.count(lineNumber)) {
-    ok = false;
-    return 0;
-  }
-
-  // To identify the program address corresponding to the selected line, we find
-  // the lower bound of the selected block in the m_labelAddrOffsetMap and
-  // subtract the invalid line count up to the given point.
-  int adjustedLineNumber = lineNumber;
-
-  if (m_labelAddrOffsetMap.empty()) {
-    auto calcAddressRes = calcAddressFunc(adjustedLineNumber);
-    ok = calcAddressRes.has_value();
-    return ok ? calcAddressRes.value() : 0;
-  }
-
-  auto low = m_labelAddrOffsetMap.lower_bound(lineNumber);
-
-  if ((low == m_labelAddrOffsetMap.begin()) &&
-      static_cast<unsigned>(lineNumber) < low->first) {
-    // The line number is less that the position of the first offset block;
-    // address is directly inferred from linenumber.
-    auto calcAddressRes = calcAddressFunc(adjustedLineNumber);
-    ok = calcAddressRes.has_value();
-    return ok ? calcAddressRes.value() : 0;
-  }
-
-  if (low != m_labelAddrOffsetMap.begin()) {
-    low = std::prev(m_labelAddrOffsetMap.lower_bound(lineNumber));
   }
-
-  adjustedLineNumber -= (low->second.first + 1);
-  auto calcAddressRes = calcAddressFunc(adjustedLineNumber);
-  ok = calcAddressRes.has_value();
-  return ok ? calcAddressRes.value() : 0;
 }
 
 AInt ProgramViewer::addressForPos(const QPoint &pos, bool &ok) const {
-  ok = true;
-  // Get line height
-  QTextBlock block = firstVisibleBlock();
-
-  const auto height = blockBoundingRect(block).height();
-
-  // Find block index in the ProgramViewer
-  int index;
-  if (block == document()->findBlockByLineNumber(0)) {
-    index = static_cast<int>((pos.y() - contentOffset().y()) / height);
-  } else {
-    index = static_cast<int>((pos.y() + contentOffset().y()) / height);
-  }
-  // Get actual block index
-  while (index > 0) {
-    block = block.next();
-    index--;
-  }
-  if (!block.isValid()) {
-    ok = false;
-    return 0;
-  }
-
-  return addressForBlock(block, ok);
+  return addressForRow(firstVisibleRow() + pos.y() / rowHeight(), ok);
 }
 
 bool ProgramViewer::hasBreakpoint(const QPoint &pos) const {
@@ -320,10 +379,36 @@ void ProgramViewer::breakpointClick(const QPoint &pos) {
   const auto address = addressForPos(pos, ok);
   if (ok) {
     ProcessorHandler::toggleBreakpoint(static_cast<unsigned>(address));
-    repaint();
+    m_breakpointArea->update();
   }
 }
 
+void ProgramViewer::editBreakpointCondition(const QPoint &pos) {
+  bool ok;
+  const auto address = addressForPos(pos, ok);
+  if (!ok)
+    return;
+  const auto current = ProcessorHandler::breakpointCondition(address);
+  const QString condition = QInputDialog::getText(
+      this, "Breakpoint condition",
+      "Stop when the condition holds (eg. \"a0 == 10\" or \"[counter] > 2\"),"
+      "\nor always if empty:",
+      QLineEdit::Normal, current ? current->condition : QString(), &ok);
+  if (!ok)
+    return;
+  const int hitCount = QInputDialog::getInt(
+      this, "Breakpoint hit count", "Stop once the condition held this often:",
+      current ? int(current->hitCount) : 1, 1, std::numeric_limits<int>::max(),
+      1, &ok);
+  if (!ok)
+    return;
+  const QString error =
+      ProcessorHandler::setBreakpointCondition(address, condition, hitCount);
+  if (!error.isEmpty())
+    QMessageBox::warning(this, "Invalid breakpoint condition", error);
+  m_breakpointArea->update();
+}
+
 // -------------- breakpoint area ----------------------------------
 
 BreakpointArea::BreakpointArea(ProgramViewer *viewer) : QWidget(viewer) {
@@ -337,10 +422,14 @@ void BreakpointArea::contextMenuEvent(QContextMenuEvent *event) {
 
   // Create and connect actions for removing and setting breakpoints
   auto *toggleAction = contextMenu.addAction("Toggle breakpoint");
+  auto *conditionAction =
+      contextMenu.addAction("Edit breakpoint condition...");
   auto *removeAllAction = contextMenu.addAction("Remove all breakpoints");
 
   connect(toggleAction, &QAction::triggered, m_programViewer,
           [=] { m_programViewer->breakpointClick(event->pos()); });
+  connect(conditionAction, &QAction::triggered, m_programViewer,
+          [=] { m_programViewer->editBreakpointCondition(event->pos()); });
   connect(removeAllAction, &QAction::triggered, m_programViewer, [=] {
     m_programViewer->clearBreakpoints();
     repaint();
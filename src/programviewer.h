@@ -1,39 +1,50 @@
 #pragma once
 
+#include <QAbstractScrollArea>
 #include <QFont>
+#include <QMouseEvent>
 #include <QObject>
-#include <QPlainTextEdit>
 #include <QScrollBar>
-#include <QTimer>
 
-#include "assembler/objdump.h"
 #include "assembler/program.h"
-#include "highlightabletextedit.h"
 #include "processorhandler.h"
 
 namespace Ripes {
 
 class BreakpointArea;
 
-class ProgramViewer : public HighlightableTextEdit {
+/**
+ * @brief The ProgramViewer class
+ * A view of the disassembled program. Rows are formatted from the lazily
+ * disassembled program upon being painted, such that only the rows within the
+ * viewport are ever materialized, regardless of the size of the program.
+ *
+ * Rows are laid out as the output of objdump; an instruction is preceded by a
+ * blank row and a label row for each symbol at its address.
+ */
+class ProgramViewer : public QAbstractScrollArea {
   Q_OBJECT
 public:
   ProgramViewer(QWidget *parent = nullptr);
 
   void breakpointAreaPaintEvent(QPaintEvent *event);
   void breakpointClick(const QPoint &pos);
+  /// Prompts for the condition and hit count of the breakpoint at @p pos.
+  void editBreakpointCondition(const QPoint &pos);
   bool hasBreakpoint(const QPoint &pos) const;
   void clearBreakpoints();
   void setFollowEnabled(bool enabled);
 
   AInt addressForPos(const QPoint &pos, bool &ok) const;
-  AInt addressForBlock(QTextBlock block, bool &ok) const;
-  QTextBlock blockForAddress(AInt) const;
+  /// Returns the address of the instruction at @p row. @p ok is cleared if the
+  /// row does not contain an instruction.
+  AInt addressForRow(int row, bool &ok) const;
+  /// Returns the row of the instruction at @p address, or -1 if no
+  /// instruction is located at the address.
+  int rowForAddress(AInt address) const;
   void setCenterAddress(const AInt address);
 
-  const Assembler::AddrOffsetMap &addressOffsetMap() const {
-    return m_labelAddrOffsetMap;
-  }
+  int rowCount() const;
 
   ///
   /// \brief updateProgram
@@ -47,11 +58,9 @@ public slots:
   void updateHighlightedAddresses();
 
 protected:
+  void paintEvent(QPaintEvent *event) override;
   void resizeEvent(QResizeEvent *event) override;
-
-private slots:
-  void updateSidebar(const QRect &, int);
-  void updateSidebarWidth(int newBlockCount);
+  void scrollContentsBy(int dx, int dy) override;
 
 private:
   /**
@@ -62,28 +71,43 @@ private:
    */
   void updateCenterAddressFromProcessor();
 
-  // A timer is needed for only catching one of the multiple wheel events that
-  // occur on a regular mouse scroll
-  QTimer m_fontTimer;
-  QTimer m_changeTimer;
+  /// Formats the text of @p row.
+  QString rowText(int row) const;
+  /// Returns the index of the last symbol labelled at or before @p row, or -1
+  /// if the row precedes all symbols.
+  int symbolForRow(int row) const;
+  int rowHeight() const;
+  int firstVisibleRow() const { return verticalScrollBar()->value(); }
+  int visibleRowCount() const;
+  void updateScrollBars();
 
   bool m_following = true;
+  bool m_binary = false;
 
   QFont m_font;
   int m_sidebarWidth;
+  // Width of the widest row painted since the program was loaded.
+  int m_textWidth = 0;
 
   BreakpointArea *m_breakpointArea;
 
-  /**
-   * @brief m_labelAddrOffsetMap
-   * To correctly correlate a line index with program address location whilst
-   * accounting for additional output in the disassembled view of a program, we
-   * provide the AddrOffsetMap. Key in this map indicate line numbers (starting
-   * from 0) which does >not< correspond with an address. The value of the key
-   * corresponds to the total sum of non-address lines encountered up to and
-   * including the given label.
-   */
-  Assembler::AddrOffsetMap m_labelAddrOffsetMap;
+  std::shared_ptr<const Program> m_program;
+
+  struct Symbol {
+    // Index of the instruction labelled by the symbol.
+    unsigned index;
+    QString name;
+  };
+  // Symbols of the text section, sorted by index.
+  std::vector<Symbol> m_symbols;
+
+  struct Highlight {
+    QColor color;
+    // Names of the stages which the instruction of the row is present in.
+    QStringList stages;
+  };
+  // Rows of the instructions present in the stages of the processor.
+  std::map<int, Highlight> m_highlights;
 };
 
 class BreakpointArea : public QWidget {
@@ -34,7 +34,17 @@ void RegisterContainerWidget::initialize() {
   updateView();
 }
 
+void RegisterContainerWidget::showEvent(QShowEvent *event) {
+  QWidget::showEvent(event);
+  if (m_stale)
+    updateView();
+}
+
 void RegisterContainerWidget::updateView() {
+  // Hidden views are updated once shown.
+  m_stale = !isVisible();
+  if (m_stale)
+    return;
   for (int i = 0; i < m_ui->tabWidget->count(); ++i) {
     if (auto *regWidget =
             dynamic_cast<RegisterWidget *>(m_ui->tabWidget->widget(i))) {
@@ -15,10 +15,15 @@ public:
   explicit RegisterContainerWidget(QWidget *parent = nullptr);
   ~RegisterContainerWidget();
 
+protected:
+  void showEvent(QShowEvent *event) override;
+
 private:
   void initialize();
   void updateView();
   Ui::RegisterContainerWidget *m_ui;
+  // Set if the view was hidden whilst the processor state changed.
+  bool m_stale = false;
 };
 
 } // namespace Ripes
@@ -16,9 +16,14 @@ RegisterModel::RegisterModel(const std::string_view &rft, QObject *parent)
 }
 
 std::vector<VInt> RegisterModel::gatherRegisterValues() {
-  std::vector<VInt> vals;
-  for (int i = 0; i < rowCount(); ++i)
-    vals.push_back(ProcessorHandler::getRegisterValue(m_rft, i));
+  std::vector<VInt> vals(rowCount());
+  const auto &file = ProcessorHandler::registerFile(m_rft);
+  if (file.valid() && file.count == vals.size()) {
+    ProcessorHandler::getProcessor()->readRegisters(file, vals.data());
+  } else {
+    for (unsigned i = 0; i < vals.size(); ++i)
+      vals[i] = ProcessorHandler::getRegisterValue(m_rft, i);
+  }
   return vals;
 }
 
@@ -33,20 +38,44 @@ int RegisterModel::rowCount(const QModelIndex &) const {
 }
 
 void RegisterModel::processorWasClocked() {
-  // Reload model
-  beginResetModel();
-  endResetModel();
-  const auto newRegValues = gatherRegisterValues();
-  if (m_regValues.size() != 0) {
-    for (auto newRegVal : llvm::enumerate(newRegValues)) {
-      if (m_regValues[newRegVal.index()] != newRegVal.value()) {
-        m_mostRecentlyModifiedReg = newRegVal.index();
-        emit registerChanged(newRegVal.index());
-        break;
-      }
+  // Only the registers written since the previous update are read.
+  const uint64_t written =
+      ProcessorHandler::getProcessor()->writtenRegisters(m_rft, m_writeCursor);
+  if (m_regValues.size() != static_cast<unsigned>(rowCount())) {
+    beginResetModel();
+    m_regValues = gatherRegisterValues();
+    endResetModel();
+    return;
+  }
+
+  const int previouslyModifiedReg = m_mostRecentlyModifiedReg;
+  const auto &file = ProcessorHandler::registerFile(m_rft);
+  bool changed = false;
+  for (unsigned i = 0; i < m_regValues.size(); ++i) {
+    if (i < 64 && !((written >> i) & 1))
+      continue;
+    const VInt value = file.valid()
+                           ? ProcessorHandler::getRegisterValue(file, i)
+                           : ProcessorHandler::getRegisterValue(m_rft, i);
+    if (m_regValues[i] == value)
+      continue;
+    m_regValues[i] = value;
+    if (!changed) {
+      changed = true;
+      m_mostRecentlyModifiedReg = i;
+      emit registerChanged(i);
+    }
+    emit dataChanged(index(i, Column::Value), index(i, Column::Value));
+  }
+
+  // Update the highlighting of the most recently modified register.
+  if (m_mostRecentlyModifiedReg != previouslyModifiedReg) {
+    for (int row : {previouslyModifiedReg, m_mostRecentlyModifiedReg}) {
+      if (row >= 0)
+        emit dataChanged(index(row, 0), index(row, NColumns - 1),
+                         {Qt::BackgroundRole});
     }
   }
-  m_regValues = newRegValues;
 }
 
 bool RegisterModel::setData(const QModelIndex &index, const QVariant &value,
@@ -129,7 +158,8 @@ QVariant RegisterModel::data(const QModelIndex &index, int role) const {
 
 void RegisterModel::setRadix(Ripes::Radix r) {
   m_radix = r;
-  processorWasClocked();
+  emit dataChanged(index(0, Column::Value),
+                   index(rowCount() - 1, Column::Value));
 }
 
 QVariant RegisterModel::nameData(unsigned idx) const {
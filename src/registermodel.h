@@ -56,5 +56,8 @@ private:
 
   int m_mostRecentlyModifiedReg = -1;
   std::vector<VInt> m_regValues;
+  // Cursor of the register writes observed by the model (see
+  // RipesProcessor::writtenRegisters).
+  uint64_t m_writeCursor = 0;
 };
 } // namespace Ripes
@@ -92,6 +92,22 @@ void RegisterWidget::showContextMenu(const QPoint &pos) {
     ProcessorHandler::setMemoryFocusAddress(address);
   });
   menu.addAction(&goToAddressAction);
+
+  const Watchpoints::RegisterWatchpoint watchpoint{
+      m_regFileName, static_cast<unsigned>(index.row())};
+  auto *watchAction = menu.addAction("Watch register writes");
+  watchAction->setToolTip(
+      "Stop running or clocking the processor once the register is written");
+  watchAction->setCheckable(true);
+  watchAction->setChecked(
+      ProcessorHandler::watchpoints().hasRegister(watchpoint));
+  watchAction->setEnabled(!ProcessorHandler::isRunning());
+  connect(watchAction, &QAction::toggled, [&](bool watched) {
+    if (watched)
+      ProcessorHandler::watchpoints().addRegister(watchpoint);
+    else
+      ProcessorHandler::watchpoints().removeRegister(watchpoint);
+  });
   menu.setToolTipsVisible(true);
 
   menu.exec(m_ui->registerView->viewport()->mapToGlobal(pos));
@@ -11,6 +11,7 @@ namespace Ripes {
 const std::map<QString, QVariant> s_defaultSettings = {
     // User-modifyable settings
     {RIPES_SETTING_REWINDSTACKSIZE, 100},
+    {RIPES_SETTING_MEMORY_BUDGET, 512},
     {RIPES_SETTING_CCPATH, ""},
     {RIPES_SETTING_FORMATTER_PATH, "clang-format"},
     {RIPES_SETTING_FORMAT_ON_SAVE, false},
@@ -26,7 +27,6 @@ const std::map<QString, QVariant> s_defaultSettings = {
      QVariant() /* Let Console define its own default font */},
     {RIPES_SETTING_CONSOLEFONT, QColorConstants::Black},
     {RIPES_SETTING_INDENTAMT, 4},
-    {RIPES_SETTING_UIUPDATEPS, 25},
 
     {RIPES_SETTING_ASSEMBLER_TEXTSTART, 0x0},
     {RIPES_SETTING_ASSEMBLER_DATASTART, 0x10000000},
@@ -37,6 +37,7 @@ const std::map<QString, QVariant> s_defaultSettings = {
     {RIPES_SETTING_EDITORSTAGEHIGHLIGHTING, true},
     {RIPES_SETTING_VCD_TRACE_FILE, "ripes.vcd"},
     {RIPES_SETTING_VCD_TRACE, false},
+    {RIPES_SETTING_VCD_TRACE_COMPONENTS, ""},
 
     {RIPES_SETTING_PIPEDIAGRAM_MAXCYCLES, 100},
     {RIPES_SETTING_CACHE_MAXCYCLES, 10000},
@@ -70,7 +71,7 @@ const std::map<QString, QVariant> s_defaultSettings = {
     {RIPES_SETTING_DARKMODE, true},
     {RIPES_SETTING_SHOWSIGNALS, false},
     {RIPES_SETTING_INPUT_TYPE, static_cast<unsigned>(SourceType::Assembly)},
-    {RIPES_SETTING_AUTOCLOCK_INTERVAL, 100},
+    {RIPES_SETTING_AUTOCLOCK_RATE, 10},
 
     {RIPES_SETTING_HAS_SAVEFILE, false},
     {RIPES_SETTING_SAVEPATH, ""},
@@ -9,6 +9,7 @@ namespace Ripes {
 // =========== Definitions of the name of all settings within Ripes ============
 // User-modifyable settings
 #define RIPES_SETTING_REWINDSTACKSIZE ("simulator_rewindstacksize")
+#define RIPES_SETTING_MEMORY_BUDGET ("memory_budget")
 #define RIPES_SETTING_CCPATH ("compiler_path")
 #define RIPES_SETTING_CCARGS ("compiler_args")
 #define RIPES_SETTING_FORMATTER_PATH ("formatter_path")
@@ -20,7 +21,6 @@ namespace Ripes {
 #define RIPES_SETTING_CONSOLEFONTCOLOR ("console_font_color")
 #define RIPES_SETTING_CONSOLEFONT ("console_font")
 #define RIPES_SETTING_INDENTAMT ("editor_indent")
-#define RIPES_SETTING_UIUPDATEPS ("ui_update_ps")
 
 #define RIPES_SETTING_ASSEMBLER_TEXTSTART ("text_start")
 #define RIPES_SETTING_ASSEMBLER_DATASTART ("data_start")
@@ -34,6 +34,7 @@ namespace Ripes {
 #define RIPES_SETTING_PERIPHERAL_SETTINGS ("peripheral_settings")
 #define RIPES_SETTING_VCD_TRACE ("enable_vcd_trace")
 #define RIPES_SETTING_VCD_TRACE_FILE ("vcd_trace_file")
+#define RIPES_SETTING_VCD_TRACE_COMPONENTS ("vcd_trace_components")
 
 // This is not really a setting, but instead a method to leverage the static
 // observer objects that are generated for a setting. Used for other objects to
@@ -52,7 +53,7 @@ namespace Ripes {
 #define RIPES_SETTING_SOURCECODE ("sourcecode")
 #define RIPES_SETTING_DARKMODE ("darkmode")
 #define RIPES_SETTING_SHOWSIGNALS ("show_signals")
-#define RIPES_SETTING_AUTOCLOCK_INTERVAL ("autoclock_interval")
+#define RIPES_SETTING_AUTOCLOCK_RATE ("autoclock_rate")
 #define RIPES_SETTING_EDITORREGS ("editor_regs")
 #define RIPES_SETTING_EDITORCONSOLE ("editor_console")
 #define RIPES_SETTING_EDITORSTAGEHIGHLIGHTING ("editor_stage_highlighting")
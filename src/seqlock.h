@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace Ripes {
+
+/**
+ * @brief The SeqLock class
+ * Publishes a value of a trivially copyable type @p T from one thread to
+ * others, without readers ever blocking the writer. Readers retry if the value
+ * was written whilst being read. Writers are serialized amongst themselves.
+ *
+ * The value is stored as an array of atomic words, such that concurrent reads
+ * and writes of the value are well-defined.
+ */
+template <typename T>
+class SeqLock {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "SeqLock requires trivially copyable values");
+  static constexpr size_t c_words =
+      (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+public:
+  SeqLock() { store(T()); }
+
+  void store(const T &value) {
+    std::array<uint64_t, c_words> words{};
+    std::memcpy(words.data(), &value, sizeof(T));
+
+    // Acquire the writer side by moving the sequence to an odd number.
+    unsigned seq = m_seq.load(std::memory_order_relaxed);
+    do {
+      while (seq & 1)
+        seq = m_seq.load(std::memory_order_relaxed);
+    } while (!m_seq.compare_exchange_weak(seq, seq + 1,
+                                          std::memory_order_acquire));
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < c_words; ++i)
+      m_words[i].store(words[i], std::memory_order_relaxed);
+    m_seq.store(seq + 2, std::memory_order_release);
+  }
+
+  T load() const {
+    std::array<uint64_t, c_words> words;
+    unsigned seq;
+    do {
+      seq = m_seq.load(std::memory_order_acquire);
+      for (size_t i = 0; i < c_words; ++i)
+        words[i] = m_words[i].load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((seq & 1) || seq != m_seq.load(std::memory_order_relaxed));
+    T value;
+    std::memcpy(&value, words.data(), sizeof(T));
+    return value;
+  }
+
+  /// Returns the number of values stored, which readers may use to detect
+  /// whether the value changed since it was last read.
+  unsigned version() const {
+    return m_seq.load(std::memory_order_acquire) / 2;
+  }
+
+private:
+  std::atomic<unsigned> m_seq{0};
+  std::array<std::atomic<uint64_t>, c_words> m_words{};
+};
+
+} // namespace Ripes
@@ -311,6 +311,15 @@ QWidget *SettingsDialog::createSimulatorPage() {
   appendToLayout({rewindLabel, rewindSpinbox}, pageLayout,
                  "Maximum cycles that the simulator is able to undo.");
 
+  // Setting: RIPES_SETTING_MEMORY_BUDGET
+  auto [budgetLabel, budgetSpinbox] = createSettingsWidgets<QSpinBox>(
+      RIPES_SETTING_MEMORY_BUDGET, "Memory budget (MiB):");
+  budgetSpinbox->setRange(0, INT_MAX);
+  appendToLayout({budgetLabel, budgetSpinbox}, pageLayout,
+                 "Memory which each component of the simulator may hold before "
+                 "a warning is shown (see View > Memory footprint...). 0 "
+                 "disables the warnings.");
+
   // Setting: RIPES_SETTING_PERIPHERALS_START
   appendToLayout(createSettingsWidgets<HexSpinBox>(
                      RIPES_SETTING_PERIPHERALS_START, "I/O start address:"),
@@ -325,7 +334,18 @@ QWidget *SettingsDialog::createSimulatorPage() {
       RIPES_SETTING_VCD_TRACE_FILE, "VCD trace file:");
 
   appendToLayout({vcdEnableLabel, vcdEnable}, pageLayout);
-  appendToLayout({vcdTraceFileLabel, vcdTraceFile}, pageLayout);
+  appendToLayout({vcdTraceFileLabel, vcdTraceFile}, pageLayout,
+                 "The trace is gzip-compressed if the file name ends with "
+                 "'.gz'.");
+
+  // Setting: RIPES_SETTING_VCD_TRACE_COMPONENTS
+  appendToLayout(createSettingsWidgets<QLineEdit>(
+                     RIPES_SETTING_VCD_TRACE_COMPONENTS, "VCD components:"),
+                 pageLayout,
+                 "Comma-separated wildcard patterns of the paths of the "
+                 "components to trace, such as '*_reg' for the pipeline "
+                 "registers. Subcomponents of traced components are traced as "
+                 "well. All components are traced if empty.");
 
   return pageWidget;
 }
@@ -403,14 +423,6 @@ QWidget *SettingsDialog::createEditorPage() {
 QWidget *SettingsDialog::createEnvironmentPage() {
   auto [pageWidget, pageLayout] = constructPage();
 
-  auto [uiUpdateMsLabel, uiUpdateMsSb] = createSettingsWidgets<QSpinBox>(
-      RIPES_SETTING_UIUPDATEPS, "Max. UI updates per second");
-  uiUpdateMsSb->setMinimum(1);
-  uiUpdateMsSb->setMaximum(100);
-  appendToLayout({uiUpdateMsLabel, uiUpdateMsSb}, pageLayout,
-                 "Maximum updates of UI elements per second. Increasing this "
-                 "may reduce performance.");
-
   auto [maxcyclesLabel, maxcyclesSb] = createSettingsWidgets<QSpinBox>(
       RIPES_SETTING_CACHE_MAXCYCLES, "Max. cache plot cycles");
   maxcyclesSb->setMinimum(0);
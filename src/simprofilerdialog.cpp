@@ -0,0 +1,105 @@
+#include "simprofilerdialog.h"
+
+#include "processors/interface/simprofiler.h"
+
+#include <QCheckBox>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QVBoxLayout>
+
+namespace Ripes {
+
+// Interval between refreshes of the panel, in milliseconds.
+static constexpr int s_refreshInterval = 500;
+
+SimProfilerDialog::SimProfilerDialog(QWidget *parent) : QDialog(parent) {
+  setWindowTitle("Simulator performance");
+
+  auto *description = new QLabel(
+      "Wall-clock time spent in each part of the simulator since profiling was "
+      "enabled or reset. Time spent in a part nested within another part is "
+      "only attributed to the nested part.",
+      this);
+  description->setWordWrap(true);
+
+  m_enable = new QCheckBox("Profile", this);
+  m_enable->setChecked(SimProfiler::enabled());
+  connect(m_enable, &QCheckBox::toggled, this, [=](bool enabled) {
+    if (enabled)
+      SimProfiler::enable();
+    else
+      SimProfiler::disable();
+    refresh();
+  });
+  auto *resetButton = new QPushButton("Reset", this);
+  connect(resetButton, &QPushButton::clicked, this, [=] {
+    SimProfiler::reset();
+    refresh();
+  });
+
+  m_table = new QTableWidget(SimProfiler::NCategories, 4, this);
+  m_table->setHorizontalHeaderLabels({"Part", "Time (s)", "Share", "Calls"});
+  m_table->verticalHeader()->hide();
+  m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  m_table->setSelectionMode(QAbstractItemView::NoSelection);
+  m_table->horizontalHeader()->setSectionResizeMode(
+      0, QHeaderView::ResizeToContents);
+  m_table->horizontalHeader()->setStretchLastSection(true);
+  for (int i = 0; i < SimProfiler::NCategories; ++i) {
+    m_table->setItem(i, 0,
+                     new QTableWidgetItem(
+                         SimProfiler::name(SimProfiler::Category(i))));
+    for (int column = 1; column < 4; ++column) {
+      auto *item = new QTableWidgetItem();
+      item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+      m_table->setItem(i, column, item);
+    }
+  }
+
+  auto *controls = new QHBoxLayout();
+  controls->addWidget(m_enable);
+  controls->addStretch();
+  controls->addWidget(resetButton);
+  auto *layout = new QVBoxLayout(this);
+  layout->addWidget(description);
+  layout->addLayout(controls);
+  layout->addWidget(m_table);
+
+  m_refreshTimer.setInterval(s_refreshInterval);
+  connect(&m_refreshTimer, &QTimer::timeout, this,
+          &SimProfilerDialog::refresh);
+  refresh();
+}
+
+void SimProfilerDialog::showEvent(QShowEvent *event) {
+  m_enable->setChecked(SimProfiler::enabled());
+  refresh();
+  m_refreshTimer.start();
+  QDialog::showEvent(event);
+}
+
+void SimProfilerDialog::hideEvent(QHideEvent *event) {
+  m_refreshTimer.stop();
+  QDialog::hideEvent(event);
+}
+
+void SimProfilerDialog::refresh() {
+  const auto results = SimProfiler::results();
+  double total = 0;
+  for (const auto &entry : results)
+    total += entry.seconds;
+  for (int i = 0; i < SimProfiler::NCategories; ++i) {
+    const auto &entry = results.at(i);
+    m_table->item(i, 1)->setText(QString::number(entry.seconds, 'f', 3));
+    m_table->item(i, 2)->setText(
+        total == 0 ? "-"
+                   : QString::number(100 * entry.seconds / total, 'f', 1) +
+                         " %");
+    m_table->item(i, 3)->setText(QString::number(entry.calls));
+  }
+}
+
+} // namespace Ripes
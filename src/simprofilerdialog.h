@@ -0,0 +1,35 @@
+#pragma once
+
+#include <QDialog>
+#include <QTimer>
+
+class QCheckBox;
+class QTableWidget;
+
+namespace Ripes {
+
+/**
+ * @brief The SimProfilerDialog class
+ * The "Simulator performance" panel. Shows the wall time and calls of the hot
+ * paths of the simulator (see SimProfiler), refreshed while the panel is
+ * visible. Profiling is enabled through the panel.
+ */
+class SimProfilerDialog : public QDialog {
+  Q_OBJECT
+
+public:
+  explicit SimProfilerDialog(QWidget *parent = nullptr);
+
+protected:
+  void showEvent(QShowEvent *event) override;
+  void hideEvent(QHideEvent *event) override;
+
+private:
+  void refresh();
+
+  QCheckBox *m_enable = nullptr;
+  QTableWidget *m_table = nullptr;
+  QTimer m_refreshTimer;
+};
+
+} // namespace Ripes
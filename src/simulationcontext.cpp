@@ -0,0 +1,257 @@
+#include "simulationcontext.h"
+
+#include "memoryblock.h"
+#include "processorpool.h"
+#include "processors/interface/simprofiler.h"
+#include "syscall/syscallmanagers.h"
+#include "syscall/systemio.h"
+
+namespace Ripes {
+
+// Number of cycles executed between each check of the cycle limit.
+static constexpr unsigned s_runBatchCycles = 1024;
+
+static thread_local SimulationContext *s_activeContext = nullptr;
+
+/// Sets a context as the active context of the current thread for the lifetime
+/// of the scope, restoring any previously active context afterwards.
+class ActiveContextScope {
+public:
+  explicit ActiveContextScope(SimulationContext *context)
+      : m_previous(s_activeContext) {
+    s_activeContext = context;
+  }
+  ~ActiveContextScope() { s_activeContext = m_previous; }
+
+private:
+  SimulationContext *m_previous;
+};
+
+SimulationContext::SimulationContext(const ProcessorID &id,
+                                     const QStringList &extensions,
+                                     const RegisterInitialization &setup)
+    : m_id(id), m_extensions(extensions), m_regInits(setup) {
+  m_processor = ProcessorPool::get().acquire(m_id, m_extensions);
+  m_processor->isExecutableAddress = [=](AInt address) {
+    return isExecutableAddress(address);
+  };
+  m_processor->trapHandler = [=] { syscallTrap(); };
+  m_registerFiles = RegisterFileHandles(*m_processor);
+  // Contexts are not interactive; disable reverse execution bookkeeping.
+  m_processor->setMaxReverseCycles(0);
+  m_syscallManager =
+      createSyscallManager(m_processor->implementsISA()->isaID());
+  reset();
+}
+
+SimulationContext::~SimulationContext() {
+  closeFiles();
+  ProcessorPool::get().release(m_id, m_extensions, std::move(m_processor));
+}
+
+SimulationContext *SimulationContext::active() { return s_activeContext; }
+
+void SimulationContext::loadProgram(const std::shared_ptr<Program> &p) {
+  auto &mem = m_processor->getMemory();
+  m_program = p;
+  MemoryBlock::clearInitializationMemories(mem);
+  for (const auto &seg : p->sections) {
+    // The sections are referenced by the memory, and owned by the program.
+    MemoryBlock::addInitializationMemory(mem, seg.second.address,
+                                         seg.second.data.constData(),
+                                         seg.second.data.length(), p);
+  }
+  m_processor->setPCInitialValue(p->entryPoint);
+  reset();
+}
+
+void SimulationContext::reset() {
+  ActiveContextScope scope(this);
+  m_syscallFailed = false;
+  m_trapped = false;
+  m_limitExceeded = Limit::None;
+  m_outputBytes = 0;
+  m_writtenPages.clear();
+  closeFiles();
+  m_syscallManager->anonymousMemory().reset();
+  m_processor->resetProcessor();
+  for (const auto &regFileInit : m_regInits) {
+    for (const auto &kv : regFileInit.second)
+      m_processor->setRegister(regFileInit.first, kv.first, kv.second);
+  }
+}
+
+bool SimulationContext::run(long long maxCycles) {
+  return runUntil([=] {
+    return maxCycles >= 0 && m_processor->getCycleCount() >= maxCycles;
+  });
+}
+
+bool SimulationContext::runUntil(const std::function<bool()> &stop,
+                                 const std::function<void()> &observer) {
+  ActiveContextScope scope(this);
+  const auto stopPredicate = [&] {
+    if (m_limits.maxCycles != 0 &&
+        m_processor->getCycleCount() >= m_limits.maxCycles)
+      m_limitExceeded = Limit::Cycles;
+    return m_syscallFailed || m_trapped || m_limitExceeded != Limit::None ||
+           stop();
+  };
+  unsigned cycles;
+  do {
+    cycles = m_processor->clockN(s_runBatchCycles, stopPredicate);
+    if (observer)
+      observer();
+    if (m_limits.maxPages != 0 && m_writtenPages.size() > m_limits.maxPages) {
+      m_limitExceeded = Limit::Pages;
+      break;
+    }
+  } while (cycles == s_runBatchCycles);
+  return m_processor->finished();
+}
+
+void SimulationContext::clock() {
+  ActiveContextScope scope(this);
+  m_processor->clock();
+}
+
+void SimulationContext::setTrackWrittenPages(bool enabled) {
+  m_trackWrittenPages = enabled;
+  updateObservers();
+}
+
+void SimulationContext::setLimits(const Limits &limits) {
+  m_limits = limits;
+  updateObservers();
+}
+
+void SimulationContext::updateObservers() {
+  auto &observers = m_processor->observers();
+  if (m_trackWrittenPages || m_limits.maxPages != 0) {
+    observers.subscribe<ProcessorEvent::DataAccess>(
+        this, [=](const ProcessorEvent::DataAccess &event) {
+          if (event.access.type == MemoryAccess::Write)
+            trackWrite(event.access.address, event.access.bytes);
+        });
+  } else {
+    observers.unsubscribe<ProcessorEvent::DataAccess>(this);
+  }
+}
+
+void SimulationContext::writeMem(AInt address, VInt value, int size) {
+  m_processor->getMemory().writeMem(address, value, size);
+  if (m_trackWrittenPages || m_limits.maxPages != 0)
+    trackWrite(address, size);
+}
+
+void SimulationContext::writeMemBlock(AInt address, const char *data,
+                                      size_t size) {
+  MemoryBlock::writeBlock(m_processor->getMemory(), address, data, size);
+  if ((m_trackWrittenPages || m_limits.maxPages != 0) && size != 0)
+    trackWrite(address, size);
+}
+
+void SimulationContext::trackWrite(AInt address, size_t bytes) {
+  const AInt first = address & ~(s_trackedPageSize - 1);
+  const AInt last = (address + bytes - 1) & ~(s_trackedPageSize - 1);
+  for (AInt page = first; page != last; page += s_trackedPageSize)
+    m_writtenPages.insert(page);
+  m_writtenPages.insert(last);
+}
+
+bool SimulationContext::isExecutableAddress(AInt address) const {
+  if (m_program) {
+    if (auto *textSection = m_program->getSection(TEXT_SECTION_NAME)) {
+      const auto textStart = textSection->address;
+      const auto textEnd = textSection->address + textSection->data.length();
+      return textStart <= address && address < textEnd;
+    }
+  }
+  return false;
+}
+
+QString SimulationContext::describeLimit(Limit limit) const {
+  switch (limit) {
+  case Limit::None:
+    break;
+  case Limit::Cycles:
+    return "the limit of " + QString::number(m_limits.maxCycles) + " cycles";
+  case Limit::Pages:
+    return "the limit of " + QString::number(m_limits.maxPages) +
+           " written memory pages";
+  case Limit::OpenFiles:
+    return "the limit of " + QString::number(m_limits.maxOpenFiles) +
+           " open files";
+  case Limit::OutputBytes:
+    return "the limit of " + QString::number(m_limits.maxOutputBytes) +
+           " bytes of output";
+  }
+  return QString();
+}
+
+void SimulationContext::print(const QString &string) {
+  if (m_limits.maxOutputBytes == 0) {
+    m_output.append(string);
+    return;
+  }
+  if (m_limitExceeded == Limit::OutputBytes)
+    return;
+  const QByteArray bytes = string.toUtf8();
+  const long long remaining = m_limits.maxOutputBytes - m_outputBytes;
+  if (bytes.size() <= remaining) {
+    m_output.append(string);
+    m_outputBytes += bytes.size();
+    return;
+  }
+  // A multi-byte character truncated at the limit decodes as a replacement
+  // character.
+  m_output.append(QString::fromUtf8(bytes.left(remaining)));
+  m_outputBytes = m_limits.maxOutputBytes;
+  m_limitExceeded = Limit::OutputBytes;
+}
+
+bool SimulationContext::mayOpenFile() {
+  if (m_limits.maxOpenFiles == 0 || m_openFiles.size() < m_limits.maxOpenFiles)
+    return true;
+  m_limitExceeded = Limit::OpenFiles;
+  return false;
+}
+
+void SimulationContext::closeFiles() {
+  // Closing a file notifies the active context.
+  ActiveContextScope scope(nullptr);
+  for (const int fd : m_openFiles)
+    SystemIO::closeFile(fd);
+  m_openFiles.clear();
+}
+
+QByteArray SimulationContext::readStdIn(int length) {
+  // Mirror the console behaviour of reading up to and including a newline.
+  int n = std::min<int>(length, m_stdin.size());
+  const int newline = m_stdin.indexOf('\n');
+  if (newline >= 0 && newline < n)
+    n = newline + 1;
+  QByteArray data = m_stdin.left(n);
+  m_stdin.remove(0, n);
+  return data;
+}
+
+void SimulationContext::syscallTrap() {
+  if (!m_executeSyscalls) {
+    m_trapped = true;
+    return;
+  }
+
+  // System calls are executed synchronously on the simulating thread.
+  SimProfiler::Scope profile(SimProfiler::Syscalls);
+  if (auto reg = m_processor->implementsISA()->syscallReg(); reg.has_value()) {
+    const unsigned int function = m_processor->readRegister(
+        registerFile(reg->file->regFileName()), reg->index);
+    m_processor->publishSyscall(function);
+    m_syscallFailed = !m_syscallManager->execute(function);
+  } else {
+    m_syscallFailed = true;
+  }
+}
+
+} // namespace Ripes
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+#include <functional>
+#include <memory>
+#include <set>
+
+#include "assembler/program.h"
+#include "processorregistry.h"
+#include "processors/interface/ripesprocessor.h"
+#include "syscall/ripes_syscall.h"
+
+namespace Ripes {
+
+/**
+ * @brief The SimulationContext class
+ * A self-contained, headless simulation instance. A context owns a processor
+ * (and thereby its memory), the program loaded into it, and a system call
+ * manager. Processors are checked out of the ProcessorPool, and returned to it
+ * once the context is destroyed. Contexts are independent of the ProcessorHandler, and multiple
+ * contexts may be simulated concurrently, each from its own thread.
+ *
+ * Contexts simulated concurrently are constructed, and have their programs
+ * loaded, on the thread creating them; only their simulation (see run) is
+ * handed to other threads, such as those of a thread pool. A context is
+ * simulated by at most one thread at a time.
+ *
+ * While a context is executing (see SimulationContext::run), it is the active
+ * context of the executing thread. System calls, which access the simulator
+ * through the static ProcessorHandler and SystemIO interfaces, are redirected
+ * to the active context. Console output is collected in the context, and
+ * console input is read from the context's stdin buffer without blocking.
+ *
+ * File descriptors opened through system calls are still managed by the
+ * process-wide SystemIO file tables, and memory-mapped I/O devices are not
+ * available to contexts. Files opened by a context are closed when it is reset
+ * or destroyed.
+ *
+ * The resources used by a program may be capped through setLimits, such that
+ * untrusted programs cannot exhaust the process simulating them. A run
+ * exceeding a limit stops, and limitExceeded() reports the exceeded limit.
+ */
+class SimulationContext {
+public:
+  SimulationContext(
+      const ProcessorID &id, const QStringList &extensions = {},
+      const RegisterInitialization &setup = RegisterInitialization());
+  ~SimulationContext();
+  SimulationContext(const SimulationContext &) = delete;
+  SimulationContext &operator=(const SimulationContext &) = delete;
+
+  /// Returns the context currently executing on the calling thread, or nullptr
+  /// if the calling thread is not executing a context.
+  static SimulationContext *active();
+
+  /**
+   * @brief loadProgram
+   * Initializes the memory of the processor with @p p and resets the context.
+   */
+  void loadProgram(const std::shared_ptr<Program> &p);
+
+  /**
+   * @brief reset
+   * Resets the processor and the register initializations of the context.
+   * Output and stdin buffers are kept.
+   */
+  void reset();
+
+  /**
+   * @brief run
+   * Executes the processor on the calling thread until it finishes, a system
+   * call fails, or @p maxCycles cycles have been executed in total (if
+   * non-negative). Returns true if the processor finished.
+   */
+  bool run(long long maxCycles = -1);
+
+  /**
+   * @brief runUntil
+   * Executes the processor on the calling thread until it finishes, a system
+   * call fails or traps while system calls are disabled, or @p stop returns
+   * true. @p stop is evaluated before each cycle. If provided, @p observer is
+   * called after each batch of executed cycles, whose per-cycle state is
+   * available through RipesProcessor::clockBatch(). Returns true if the
+   * processor finished.
+   */
+  bool runUntil(const std::function<bool()> &stop,
+                const std::function<void()> &observer = {});
+
+  /// Clocks the processor a single cycle on the calling thread.
+  void clock();
+
+  /**
+   * @brief setExecuteSyscalls
+   * If disabled, a system call stops execution without being executed, and
+   * trapped() will return true until the context is reset. Enabled by default.
+   */
+  void setExecuteSyscalls(bool enabled) { m_executeSyscalls = enabled; }
+  bool trapped() const { return m_trapped; }
+
+  /**
+   * @brief writeMem
+   * Writes @p value to the memory of the processor, recording the written
+   * pages if page tracking is enabled.
+   */
+  void writeMem(AInt address, VInt value, int size = sizeof(VInt));
+  /// Writes @p size bytes of @p data to the memory of the processor, starting
+  /// from @p address, recording the written pages as writeMem.
+  void writeMemBlock(AInt address, const char *data, size_t size);
+
+  /**
+   * @brief setTrackWrittenPages
+   * Enables recording of the memory pages (of size s_trackedPageSize) written
+   * since the last reset, by either the processor or system calls.
+   */
+  void setTrackWrittenPages(bool enabled);
+  const std::set<AInt> &writtenPages() const { return m_writtenPages; }
+  static constexpr AInt s_trackedPageSize = 0x1000;
+
+  /// Resource limits of a program. Limits of 0 are not applied.
+  struct Limits {
+    // Executed cycles.
+    long long maxCycles = 0;
+    // Distinct memory pages (of size s_trackedPageSize) written since the last
+    // reset. Checked after each batch of executed cycles.
+    unsigned maxPages = 0;
+    // Files simultaneously open by the program.
+    unsigned maxOpenFiles = 0;
+    // UTF-8 encoded bytes of console output since the last reset. Output
+    // beyond the limit is discarded.
+    long long maxOutputBytes = 0;
+  };
+  enum class Limit { None, Cycles, Pages, OpenFiles, OutputBytes };
+
+  void setLimits(const Limits &limits);
+  const Limits &limits() const { return m_limits; }
+  /// Returns the limit exceeded since the last reset, if any.
+  Limit limitExceeded() const { return m_limitExceeded; }
+  /// Returns a description of @p limit, as in "the limit of 10 open files".
+  QString describeLimit(Limit limit) const;
+
+  /// Appends @p data to the data available to stdin reads of the program.
+  void putStdInData(const QByteArray &data) { m_stdin.append(data); }
+  /// Discards the data available to stdin reads of the program.
+  void clearStdIn() { m_stdin.clear(); }
+
+  /// Returns the console output produced by the program since the context was
+  /// created, or since the last call to clearOutput().
+  const QString &output() const { return m_output; }
+  void clearOutput() { m_output.clear(); }
+
+  RipesProcessor *processor() { return m_processor.get(); }
+  const RipesProcessor *processor() const { return m_processor.get(); }
+  /// Returns the handle to register file @p rfid of the processor.
+  const RegisterFileHandle &registerFile(const std::string_view &rfid) const {
+    return m_registerFiles[rfid];
+  }
+  const ProcessorID &id() const { return m_id; }
+  std::shared_ptr<const Program> program() const { return m_program; }
+  SyscallManager &syscallManager() { return *m_syscallManager; }
+  bool isExecutableAddress(AInt address) const;
+
+  // Console and file interface used by SystemIO while this context is active.
+  void print(const QString &string);
+  QByteArray readStdIn(int length);
+  /// Returns false, and stops the run, if the program may not open another
+  /// file.
+  bool mayOpenFile();
+  void fileOpened(int fd) { m_openFiles.insert(fd); }
+  void fileClosed(int fd) { m_openFiles.erase(fd); }
+  /// The file descriptors opened by the program and not yet closed.
+  const std::set<int> &openFiles() const { return m_openFiles; }
+
+private:
+  void syscallTrap();
+  void trackWrite(AInt address, size_t bytes);
+  /// Subscribes to the data accesses of the processor whilst written pages
+  /// are tracked.
+  void updateObservers();
+  void closeFiles();
+
+  ProcessorID m_id;
+  QStringList m_extensions;
+  RegisterInitialization m_regInits;
+  std::unique_ptr<RipesProcessor> m_processor;
+  RegisterFileHandles m_registerFiles;
+  std::unique_ptr<SyscallManager> m_syscallManager;
+  std::shared_ptr<Program> m_program;
+
+  QString m_output;
+  QByteArray m_stdin;
+  bool m_syscallFailed = false;
+  bool m_executeSyscalls = true;
+  bool m_trapped = false;
+  bool m_trackWrittenPages = false;
+  std::set<AInt> m_writtenPages;
+
+  Limits m_limits;
+  Limit m_limitExceeded = Limit::None;
+  long long m_outputBytes = 0;
+  std::set<int> m_openFiles;
+};
+
+} // namespace Ripes
@@ -0,0 +1,486 @@
+#include "snapshot.h"
+
+#include <QFile>
+
+#include <fstream>
+#include <map>
+#include <optional>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "cereal/archives/binary.hpp"
+#include "cereal/types/map.hpp"
+#include "cereal/types/string.hpp"
+#include "cereal/types/vector.hpp"
+
+#include "cachesim/cachesim.h"
+#include "io/iomanager.h"
+#include "memoryblock.h"
+#include "pagedmemory.h"
+#include "processorhandler.h"
+#include "processorregistry.h"
+#include "ripessettings.h"
+#include "simulationcontext.h"
+#include "syscall/systemio.h"
+
+namespace Ripes {
+
+template <class Archive>
+void serialize(Archive &archive, CacheSim::State &state) {
+  archive(state.tags, state.valid, state.dirty, state.lru, state.prefetched,
+          state.dirtyBlocks, state.replState, state.brripFills);
+}
+
+template <class Archive>
+void serialize(Archive &archive, AnonymousMemory::State &state) {
+  archive(state.mapped, state.highWater, state.mappedPages,
+          state.peakMappedPages);
+}
+
+namespace {
+
+constexpr uint32_t c_snapshotMagic = 0x52534e50; // "RSNP"
+constexpr uint32_t c_snapshotVersion = 2;
+
+constexpr AInt c_pageSize = PagedMemory::s_pageSize;
+static_assert(c_pageSize == ProcessorHandler::s_trackedPageSize &&
+              c_pageSize == SimulationContext::s_trackedPageSize);
+
+struct MemoryPage {
+  AInt address = 0;
+  std::vector<uint8_t> data;
+
+  template <class Archive>
+  void serialize(Archive &archive) {
+    archive(address, data);
+  }
+};
+
+struct FileDescriptor {
+  int fd = 0;
+  std::string name;
+  unsigned flags = 0;
+  int64_t pos = 0;
+
+  template <class Archive>
+  void serialize(Archive &archive) {
+    archive(fd, name, flags, pos);
+  }
+};
+
+struct PeripheralState {
+  // The serialized unique ID of the peripheral (see IOBase).
+  std::string id;
+  std::string name;
+  std::vector<uint8_t> inputs;
+  // See IOBase::saveState.
+  std::vector<uint64_t> state;
+
+  template <class Archive>
+  void serialize(Archive &archive) {
+    archive(id, name, inputs, state);
+  }
+};
+
+struct SnapshotData {
+  uint32_t magic = c_snapshotMagic;
+  uint32_t version = c_snapshotVersion;
+  std::string processor;
+  std::vector<std::string> extensions;
+  AInt pc = 0;
+  std::map<std::string, std::vector<VInt>> registers;
+  std::vector<uint64_t> processorState;
+  std::vector<MemoryPage> memory;
+  std::vector<FileDescriptor> files;
+  AnonymousMemory::State anonymousMemory;
+  std::vector<CacheSim::State> caches;
+  std::vector<PeripheralState> peripherals;
+
+  template <class Archive>
+  void serialize(Archive &archive) {
+    archive(magic, version, processor, extensions, pc, registers,
+            processorState, memory, files, anonymousMemory, caches,
+            peripherals);
+  }
+};
+
+/// Read-only stream buffer over a memory-mapped file, allowing cereal to
+/// deserialize directly from the mapping without an intermediate copy.
+class MappedStreamBuf : public std::streambuf {
+public:
+  MappedStreamBuf(uchar *data, qint64 size) {
+    char *begin = reinterpret_cast<char *>(data);
+    setg(begin, begin, begin + size);
+  }
+};
+
+/// The simulation of which the state is saved or restored; that of the
+/// ProcessorHandler if context is unset.
+struct Target {
+  SimulationContext *context = nullptr;
+  ProcessorID id;
+  RipesProcessor *processor;
+  std::shared_ptr<const Program> program;
+  const std::set<AInt> &writtenPages;
+  SyscallManager &syscalls;
+};
+
+Target handlerTarget() {
+  return {nullptr,
+          ProcessorHandler::getID(),
+          ProcessorHandler::getProcessorNonConst(),
+          ProcessorHandler::getProgram(),
+          ProcessorHandler::writtenPages(),
+          ProcessorHandler::getSyscallManagerNonConst()};
+}
+
+Target contextTarget(SimulationContext &context) {
+  return {&context,
+          context.id(),
+          context.processor(),
+          context.program(),
+          context.writtenPages(),
+          context.syscallManager()};
+}
+
+/// Returns the base addresses of the pages of the program and of the pages
+/// recorded as written by @p target, excluding IO regions.
+std::set<AInt> trackedPages(const Target &target) {
+  std::set<AInt> pages = target.writtenPages;
+  if (target.program) {
+    for (const auto &section : target.program->sections) {
+      const AInt start = section.second.address & ~(c_pageSize - 1);
+      const AInt end = section.second.address + section.second.data.length();
+      for (AInt page = start; page < end; page += c_pageSize)
+        pages.insert(page);
+    }
+  }
+  const auto &mem = target.processor->getMemory();
+  using RegionType = vsrtl::core::AddressSpace::RegionType;
+  for (auto it = pages.begin(); it != pages.end();) {
+    if (mem.regionType(*it) == RegionType::IO)
+      it = pages.erase(it);
+    else
+      ++it;
+  }
+  return pages;
+}
+
+/// Saves the memory pages of @p target which differ from its program.
+void saveMemory(const Target &target, SnapshotData &snapshot) {
+  auto &mem = target.processor->getMemory();
+  if (auto *paged = dynamic_cast<const PagedMemory *>(&mem)) {
+    // Only the pages written since the last reset differ from the image.
+    for (const AInt page : paged->dirtyPageAddresses()) {
+      if (const uint8_t *bytes = paged->pageBytes(page))
+        snapshot.memory.push_back(
+            {page, std::vector<uint8_t>(bytes, bytes + c_pageSize)});
+    }
+    return;
+  }
+  for (const AInt page : trackedPages(target)) {
+    MemoryPage saved{page, std::vector<uint8_t>(c_pageSize)};
+    MemoryBlock::readBlock(mem, page,
+                           reinterpret_cast<char *>(saved.data.data()),
+                           c_pageSize);
+    snapshot.memory.push_back(std::move(saved));
+  }
+}
+
+/// Restores the memory pages of @p snapshot over the reset memory of
+/// @p target.
+void loadMemory(const Target &target, const SnapshotData &snapshot) {
+  auto &mem = target.processor->getMemory();
+  auto *paged = dynamic_cast<PagedMemory *>(&mem);
+  for (const auto &page : snapshot.memory) {
+    if (page.data.size() != c_pageSize)
+      continue;
+    if (paged) {
+      paged->writePage(page.address, page.data.data());
+      continue;
+    }
+    // Written through the simulation, such that the restored pages are
+    // tracked for subsequent snapshots.
+    const char *data = reinterpret_cast<const char *>(page.data.data());
+    if (target.context)
+      target.context->writeMemBlock(page.address, data, c_pageSize);
+    else
+      ProcessorHandler::writeMemBlock(page.address, data, c_pageSize);
+  }
+}
+
+bool savePeripherals(SnapshotData &snapshot, QString &errorMessage) {
+  for (auto *peripheral : IOManager::get().peripherals()) {
+    PeripheralState state;
+    state.id = peripheral->serializedUniqueID();
+    state.name = peripheral->name().toStdString();
+    const auto inputs = peripheral->inputs().size();
+    for (int i = 0; i < inputs; i++)
+      state.inputs.push_back(peripheral->input(i));
+    if (!peripheral->saveState(state.state)) {
+      errorMessage = "The state of the peripheral '" + peripheral->name() +
+                     "' cannot be saved whilst it is busy";
+      return false;
+    }
+    snapshot.peripherals.push_back(std::move(state));
+  }
+  return true;
+}
+
+bool loadPeripherals(const SnapshotData &snapshot, QString &errorMessage) {
+  std::map<std::string, IOBase *> peripherals;
+  for (auto *peripheral : IOManager::get().peripherals())
+    peripherals[peripheral->serializedUniqueID()] = peripheral;
+  for (const auto &state : snapshot.peripherals) {
+    auto it = peripherals.find(state.id);
+    if (it == peripherals.end()) {
+      errorMessage = "The peripheral '" + QString::fromStdString(state.name) +
+                     "' of the snapshot is not instantiated";
+      return false;
+    }
+    IOBase *peripheral = it->second;
+    for (unsigned i = 0; i < state.inputs.size(); i++)
+      peripheral->setInput(i, state.inputs[i]);
+    if (!peripheral->restoreState(state.state)) {
+      errorMessage = "The parameters of the peripheral '" +
+                     peripheral->name() + "' do not match the snapshot";
+      return false;
+    }
+  }
+  return true;
+}
+
+bool saveTarget(const Target &target, const QString &path,
+                QString &errorMessage, const std::vector<CacheSim *> &caches) {
+  const auto *proc = target.processor;
+  SnapshotData snapshot;
+  if (!proc->saveState(snapshot.processorState)) {
+    errorMessage = "Snapshots are not supported by the " +
+                   ProcessorRegistry::getDescription(target.id).name +
+                   " processor";
+    return false;
+  }
+
+  snapshot.processor = enumToString<ProcessorID>(target.id).toStdString();
+  for (const auto &ext : proc->implementsISA()->enabledExtensions())
+    snapshot.extensions.push_back(ext.toStdString());
+  snapshot.pc = proc->getPcForStage({0, 0});
+  for (const auto &regFile : proc->implementsISA()->regInfos()) {
+    auto &values = snapshot.registers[std::string(regFile->regFileName())];
+    for (unsigned i = 0; i < regFile->regCnt(); i++)
+      values.push_back(proc->getRegister(regFile->regFileName(), i));
+  }
+  saveMemory(target, snapshot);
+
+  // Files opened by a context are the subset of the open files which it
+  // opened.
+  for (const auto &file : SystemIO::openFiles()) {
+    if (!target.context || target.context->openFiles().count(file.fd))
+      snapshot.files.push_back(
+          {file.fd, file.name.toStdString(), file.flags, file.pos});
+  }
+  snapshot.anonymousMemory = target.syscalls.anonymousMemory().state();
+  for (const auto *cache : caches)
+    snapshot.caches.push_back(cache->saveState());
+  // Peripherals are not available to contexts.
+  if (!target.context && !savePeripherals(snapshot, errorMessage))
+    return false;
+
+  std::ofstream out(path.toStdString(), std::ios::binary);
+  if (!out.is_open()) {
+    errorMessage = "Could not open '" + path + "' for writing";
+    return false;
+  }
+  try {
+    cereal::BinaryOutputArchive archive(out);
+    archive(snapshot);
+  } catch (const cereal::Exception &e) {
+    errorMessage = "Could not write snapshot: " + QString(e.what());
+    return false;
+  }
+  return true;
+}
+
+bool readSnapshot(const QString &path, SnapshotData &snapshot,
+                  QString &errorMessage) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    errorMessage = "Could not open '" + path + "'";
+    return false;
+  }
+  uchar *mapped = file.map(0, file.size());
+  if (!mapped) {
+    errorMessage = "Could not map '" + path + "'";
+    return false;
+  }
+  try {
+    MappedStreamBuf buf(mapped, file.size());
+    std::istream in(&buf);
+    cereal::BinaryInputArchive archive(in);
+    archive(snapshot);
+  } catch (const cereal::Exception &e) {
+    errorMessage = "Could not read snapshot: " + QString(e.what());
+    return false;
+  }
+  file.unmap(mapped);
+
+  if (snapshot.magic != c_snapshotMagic ||
+      snapshot.version != c_snapshotVersion) {
+    errorMessage = "'" + path + "' is not a valid snapshot file";
+    return false;
+  }
+  return true;
+}
+
+/// Returns the processor and ISA extensions of @p snapshot, or nothing if the
+/// processor is unknown.
+std::optional<std::pair<ProcessorID, QStringList>>
+snapshotProcessor(const SnapshotData &snapshot, QString &errorMessage) {
+  bool ok = false;
+  const int id = QMetaEnum::fromType<ProcessorID>().keyToValue(
+      snapshot.processor.c_str(), &ok);
+  if (!ok) {
+    errorMessage = "Unknown processor '" +
+                   QString::fromStdString(snapshot.processor) + "'";
+    return {};
+  }
+  QStringList extensions;
+  for (const auto &ext : snapshot.extensions)
+    extensions << QString::fromStdString(ext);
+  return {{static_cast<ProcessorID>(id), extensions}};
+}
+
+/// Restores the state of @p snapshot to the reset processor of @p target.
+bool loadTarget(const Target &target, const SnapshotData &snapshot,
+                QString &errorMessage, const std::vector<CacheSim *> &caches) {
+  auto *proc = target.processor;
+  loadMemory(target, snapshot);
+  for (const auto &regFile : snapshot.registers) {
+    for (unsigned i = 0; i < regFile.second.size(); i++) {
+      if (target.context)
+        proc->setRegister(regFile.first, i, regFile.second.at(i));
+      else
+        ProcessorHandler::setRegisterValue(regFile.first, i,
+                                           regFile.second.at(i));
+    }
+  }
+  proc->setProgramCounter(snapshot.pc);
+  if (!proc->restoreState(snapshot.processorState)) {
+    errorMessage = "The processor state of the snapshot does not match the "
+                   "configuration of the processor";
+    return false;
+  }
+  target.syscalls.anonymousMemory().restore(snapshot.anonymousMemory);
+
+  if (snapshot.caches.size() != caches.size()) {
+    errorMessage = "The snapshot holds " +
+                   QString::number(snapshot.caches.size()) +
+                   " caches, whereas " + QString::number(caches.size()) +
+                   " caches are simulated";
+    return false;
+  }
+  for (size_t i = 0; i < caches.size(); i++) {
+    if (!caches[i]->restoreState(snapshot.caches[i])) {
+      errorMessage = "The configuration of cache " + QString::number(i + 1) +
+                     " does not match the snapshot";
+      return false;
+    }
+  }
+  if (!target.context && !loadPeripherals(snapshot, errorMessage))
+    return false;
+
+  std::vector<SystemIO::FileState> files;
+  for (const auto &fd : snapshot.files)
+    files.push_back(
+        {fd.fd, QString::fromStdString(fd.name), fd.flags, fd.pos});
+  bool filesRestored = true;
+  if (target.context) {
+    // Other contexts keep their files open.
+    for (const auto &file : files) {
+      if (SystemIO::restoreFile(file))
+        target.context->fileOpened(file.fd);
+      else
+        filesRestored = false;
+    }
+  } else {
+    filesRestored = SystemIO::restoreFiles(files);
+  }
+  if (!filesRestored) {
+    errorMessage = "Some files of the snapshot could not be reopened";
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+void Snapshot::enableTracking() {
+  ProcessorHandler::setTrackWrittenPages(true);
+}
+
+bool Snapshot::save(const QString &path, QString &errorMessage,
+                    const std::vector<CacheSim *> &caches) {
+  return saveTarget(handlerTarget(), path, errorMessage, caches);
+}
+
+bool Snapshot::save(SimulationContext &context, const QString &path,
+                    QString &errorMessage) {
+  return saveTarget(contextTarget(context), path, errorMessage, {});
+}
+
+bool Snapshot::load(const QString &path, QString &errorMessage,
+                    const std::vector<CacheSim *> &caches) {
+  SnapshotData snapshot;
+  if (!readSnapshot(path, snapshot, errorMessage))
+    return false;
+  const auto processor = snapshotProcessor(snapshot, errorMessage);
+  if (!processor)
+    return false;
+
+  // Reselect the processor if needed.
+  const auto &[id, extensions] = *processor;
+  if (ProcessorHandler::getID() != id ||
+      !ProcessorHandler::currentISA()->eq(ProcessorHandler::currentISA(),
+                                          extensions)) {
+    ProcessorHandler::selectProcessor(
+        id, extensions,
+        ProcessorRegistry::getDescription(id).defaultRegisterVals);
+  }
+
+  // Restore from the program's reset state, which also resets the caches and
+  // the peripherals.
+  Snapshot::enableTracking();
+  RipesSettings::getObserver(RIPES_GLOBALSIGNAL_REQRESET)->trigger();
+  const bool loaded =
+      loadTarget(handlerTarget(), snapshot, errorMessage, caches);
+  ProcessorHandler::notifyStateRestored();
+  return loaded;
+}
+
+bool Snapshot::load(SimulationContext &context, const QString &path,
+                    QString &errorMessage) {
+  SnapshotData snapshot;
+  if (!readSnapshot(path, snapshot, errorMessage))
+    return false;
+  const auto processor = snapshotProcessor(snapshot, errorMessage);
+  if (!processor)
+    return false;
+
+  // Contexts cannot change their processor.
+  const auto &[id, extensions] = *processor;
+  if (context.id() != id ||
+      !context.processor()->implementsISA()->eq(
+          context.processor()->implementsISA(), extensions)) {
+    errorMessage = "The snapshot was taken with the " +
+                   ProcessorRegistry::getDescription(id).name +
+                   " processor, and ISA extensions [" + extensions.join(", ") +
+                   "]";
+    return false;
+  }
+
+  context.reset();
+  return loadTarget(contextTarget(context), snapshot, errorMessage, {});
+}
+
+} // namespace Ripes
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <QString>
+
+#include <vector>
+
+namespace Ripes {
+
+class CacheSim;
+class SimulationContext;
+
+/**
+ * @brief The Snapshot class
+ * Saves and restores the state of a simulation to/from a compact binary file,
+ * being either the simulation of the ProcessorHandler or a SimulationContext.
+ * A snapshot contains:
+ * - the processor model and its enabled ISA extensions,
+ * - the program counter and all register file values,
+ * - the state of the processor beyond its registers and memory, such as the
+ *   contents of its pipeline (see RipesProcessor::saveState),
+ * - all memory pages which differ from the loaded program,
+ * - the state of the file descriptors opened and the anonymous memory mapped
+ *   through system calls,
+ * - the contents of a given set of caches (see CacheSim::saveState),
+ * - for the ProcessorHandler, the state and the inputs of the IO peripherals
+ *   (see IOBase::saveState).
+ *
+ * Processors with paged memory (see PagedMemory) save the pages written since
+ * they were reset, which are restored a page at a time over the image of the
+ * program. The memory of other processors is saved as the pages of the
+ * program and the pages written since the processor was reset, which are only
+ * recorded once snapshot tracking has been enabled (see enableTracking).
+ *
+ * Snapshots are restored on top of the program which was loaded when the
+ * snapshot was taken. Processors which cannot save their state, such as the
+ * generated pipelines, cannot be snapshotted.
+ */
+class Snapshot {
+public:
+  /**
+   * @brief enableTracking
+   * Enables recording of the memory pages written during execution by the
+   * ProcessorHandler. Must be called before the processor is reset and a
+   * program is executed, for the resulting state of a processor without paged
+   * memory to be saveable. Contexts record their written pages once
+   * SimulationContext::setTrackWrittenPages is enabled.
+   */
+  static void enableTracking();
+
+  /**
+   * @brief save
+   * Saves the state of the current processor, and of @p caches, to @p path.
+   * Returns false and sets @p errorMessage on failure.
+   */
+  static bool save(const QString &path, QString &errorMessage,
+                   const std::vector<CacheSim *> &caches = {});
+
+  /**
+   * @brief load
+   * Restores the state stored in @p path, including the contents of
+   * @p caches, which must be the caches passed to save and be configured as
+   * they were then. The processor is reselected if the snapshot was taken with
+   * a different processor model or ISA extensions. Returns false and sets
+   * @p errorMessage on failure.
+   */
+  static bool load(const QString &path, QString &errorMessage,
+                   const std::vector<CacheSim *> &caches = {});
+
+  /// As save, for the processor of @p context.
+  static bool save(SimulationContext &context, const QString &path,
+                   QString &errorMessage);
+
+  /// As load, for the processor of @p context, which must be of the model and
+  /// ISA extensions of the snapshot.
+  static bool load(SimulationContext &context, const QString &path,
+                   QString &errorMessage);
+};
+
+} // namespace Ripes
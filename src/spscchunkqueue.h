@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+namespace Ripes {
+
+/**
+ * @brief The SPSCChunkQueue class
+ * Unbounded queue passing values of type @p T from a single producer thread to
+ * a single consumer thread, without either thread ever blocking the other.
+ * push may only be called by the producer, and pop and empty only by the
+ * consumer. Contrary to the bounded SPSCQueue of cachesim/spscqueue.h, a push
+ * never fails, such that chunks of any size and number may be queued, as
+ * console input pasted in bulk.
+ *
+ * The queue is a linked list of nodes, of which the head is a sentinel owned
+ * by the consumer. The producer publishes a node by linking it to the tail,
+ * and the consumer retires the sentinel once it has taken the value of its
+ * successor.
+ */
+template <typename T>
+class SPSCChunkQueue {
+  struct Node {
+    T value;
+    std::atomic<Node *> next{nullptr};
+  };
+
+public:
+  SPSCChunkQueue() : m_head(new Node()), m_tail(m_head) {}
+  ~SPSCChunkQueue() {
+    while (m_head)
+      delete std::exchange(m_head, m_head->next.load());
+  }
+  SPSCChunkQueue(const SPSCChunkQueue &) = delete;
+  SPSCChunkQueue &operator=(const SPSCChunkQueue &) = delete;
+
+  void push(T value) {
+    Node *node = new Node{std::move(value)};
+    m_tail->next.store(node, std::memory_order_release);
+    m_tail = node;
+  }
+
+  /// Moves the oldest value into @p value. Returns false if the queue is
+  /// empty.
+  bool pop(T &value) {
+    Node *next = m_head->next.load(std::memory_order_acquire);
+    if (!next)
+      return false;
+    value = std::move(next->value);
+    delete std::exchange(m_head, next);
+    return true;
+  }
+
+  bool empty() const {
+    return m_head->next.load(std::memory_order_acquire) == nullptr;
+  }
+
+private:
+  // Sentinel node, accessed by the consumer only.
+  Node *m_head;
+  // Last node, accessed by the producer only.
+  Node *m_tail;
+};
+
+} // namespace Ripes
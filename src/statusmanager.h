@@ -18,8 +18,8 @@ namespace Ripes {
 template <typename F>
 static void postToGUIThread(F &&fun,
                             Qt::ConnectionType type = Qt::QueuedConnection) {
-  if (qApp) {
-    auto *obj = QAbstractEventDispatcher::instance(qApp->thread());
+  if (auto *app = QCoreApplication::instance()) {
+    auto *obj = QAbstractEventDispatcher::instance(app->thread());
     Q_ASSERT(obj);
     QMetaObject::invokeMethod(obj, std::forward<F>(fun), type);
   }
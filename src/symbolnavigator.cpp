@@ -4,61 +4,90 @@
 #include "processorhandler.h"
 #include "radix.h"
 
+#include <QHeaderView>
 #include <QPushButton>
 
 namespace Ripes {
 
-SymbolNavigator::SymbolNavigator(const ReverseSymbolMap &symbolmap,
-                                 QWidget *parent)
+SymbolModel::SymbolModel(const SymbolIndex &index, unsigned addressBytes,
+                         QObject *parent)
+    : QAbstractTableModel(parent), m_index(index),
+      m_addressBytes(addressBytes), m_matches(index.search(QString())) {}
+
+void SymbolModel::setQuery(const QString &query) {
+  beginResetModel();
+  m_matches = m_index.search(query);
+  endResetModel();
+}
+
+AInt SymbolModel::addressAt(int row) const {
+  return m_index.entries().at(m_matches.at(row)).address;
+}
+
+int SymbolModel::rowCount(const QModelIndex &parent) const {
+  return parent.isValid() ? 0 : static_cast<int>(m_matches.size());
+}
+
+int SymbolModel::columnCount(const QModelIndex &parent) const {
+  return parent.isValid() ? 0 : NColumns;
+}
+
+QVariant SymbolModel::headerData(int section, Qt::Orientation orientation,
+                                 int role) const {
+  if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+    return QVariant();
+  return section == Address ? "Address" : "Symbol";
+}
+
+QVariant SymbolModel::data(const QModelIndex &index, int role) const {
+  if (!index.isValid() || role != Qt::DisplayRole)
+    return QVariant();
+  const auto &entry = m_index.entries().at(m_matches.at(index.row()));
+  if (index.column() == Address)
+    return encodeRadixValue(entry.address, Radix::Hex, m_addressBytes);
+  return entry.name;
+}
+
+SymbolNavigator::SymbolNavigator(const SymbolIndex &index, QWidget *parent)
     : QDialog(parent), m_ui(new Ui::SymbolNavigator) {
   m_ui->setupUi(this);
 
   setWindowTitle("Symbol navigator");
 
-  m_ui->symbolTable->setColumnCount(2);
+  m_model =
+      new SymbolModel(index, ProcessorHandler::currentISA()->bytes(), this);
+  m_ui->symbolTable->setModel(m_model);
   m_ui->symbolTable->setSelectionBehavior(QAbstractItemView::SelectRows);
   m_ui->symbolTable->setSelectionMode(QAbstractItemView::SingleSelection);
   m_ui->symbolTable->verticalHeader()->hide();
-  m_ui->symbolTable->setHorizontalHeaderLabels({"Address", "Symbol"});
+  // Rows are of a fixed height, such that the view need not measure them.
+  m_ui->symbolTable->verticalHeader()->setSectionResizeMode(
+      QHeaderView::Fixed);
   m_ui->symbolTable->horizontalHeader()->setStretchLastSection(true);
-  m_ui->symbolTable->horizontalHeader()->setSectionResizeMode(
-      QHeaderView::ResizeToContents);
+  m_ui->symbolTable->resizeColumnToContents(SymbolModel::Address);
   m_ui->buttonBox->button(QDialogButtonBox::Ok)->setText("Go to symbol");
 
-  for (const auto &iter : symbolmap) {
-    addSymbol(iter.first, iter.second);
-  }
+  m_ui->filter->setPlaceholderText("Search symbols");
+  connect(m_ui->filter, &QLineEdit::textChanged, this,
+          &SymbolNavigator::setQuery);
+  connect(m_ui->filter, &QLineEdit::returnPressed, this, &QDialog::accept);
+  connect(m_ui->symbolTable, &QAbstractItemView::doubleClicked, this,
+          &QDialog::accept);
+  m_ui->symbolTable->selectRow(0);
+}
+
+void SymbolNavigator::setQuery(const QString &query) {
+  m_model->setQuery(query.trimmed());
   m_ui->symbolTable->selectRow(0);
 }
 
 AInt SymbolNavigator::getSelectedSymbolAddress() const {
-  const auto selected = m_ui->symbolTable->selectedItems();
+  const auto selected = m_ui->symbolTable->selectionModel()->selectedRows();
   if (selected.size() > 0) {
-    return selected[0]->data(Qt::UserRole).toUInt();
+    return m_model->addressAt(selected[0].row());
   }
   return 0;
 }
 
-void SymbolNavigator::addSymbol(const AInt address, const QString &label) {
-  m_ui->symbolTable->setRowCount(m_ui->symbolTable->rowCount() + 1);
-  QTableWidgetItem *addrItem = new QTableWidgetItem();
-  QTableWidgetItem *labelItem = new QTableWidgetItem();
-
-  addrItem->setData(Qt::DisplayRole,
-                    encodeRadixValue(address, Radix::Hex,
-                                     ProcessorHandler::currentISA()->bytes()));
-  labelItem->setData(Qt::DisplayRole, label);
-
-  addrItem->setFlags(addrItem->flags() ^ Qt::ItemIsEditable);
-  labelItem->setFlags(labelItem->flags() ^ Qt::ItemIsEditable);
-
-  addrItem->setData(Qt::UserRole, QVariant::fromValue(address));
-  labelItem->setData(Qt::UserRole, QVariant::fromValue(address));
-
-  const int row = m_ui->symbolTable->rowCount() - 1;
-  m_ui->symbolTable->setItem(row, 0, addrItem);
-  m_ui->symbolTable->setItem(row, 1, labelItem);
-}
-
 SymbolNavigator::~SymbolNavigator() { delete m_ui; }
 } // namespace Ripes
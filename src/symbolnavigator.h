@@ -1,8 +1,9 @@
 #pragma once
 
+#include <QAbstractTableModel>
 #include <QDialog>
 
-#include "assembler/objdump.h"
+#include "assembler/symbolindex.h"
 
 namespace Ripes {
 
@@ -10,18 +11,49 @@ namespace Ui {
 class SymbolNavigator;
 }
 
+/**
+ * @brief The SymbolModel class
+ * A view of the matches of a query on a SymbolIndex. Rows are formatted upon
+ * being displayed, such that the cost of a query is that of searching the
+ * index, regardless of the number of symbols.
+ */
+class SymbolModel : public QAbstractTableModel {
+  Q_OBJECT
+public:
+  enum Column { Address, Symbol, NColumns };
+
+  SymbolModel(const SymbolIndex &index, unsigned addressBytes,
+              QObject *parent = nullptr);
+
+  void setQuery(const QString &query);
+  AInt addressAt(int row) const;
+
+  int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+  int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+  QVariant headerData(int section, Qt::Orientation orientation,
+                      int role = Qt::DisplayRole) const override;
+  QVariant data(const QModelIndex &index,
+                int role = Qt::DisplayRole) const override;
+
+private:
+  const SymbolIndex &m_index;
+  unsigned m_addressBytes;
+  std::vector<unsigned> m_matches;
+};
+
 class SymbolNavigator : public QDialog {
   Q_OBJECT
 
 public:
-  SymbolNavigator(const ReverseSymbolMap &symbolmap, QWidget *parent = nullptr);
+  SymbolNavigator(const SymbolIndex &index, QWidget *parent = nullptr);
   ~SymbolNavigator();
 
   AInt getSelectedSymbolAddress() const;
 
 private:
-  void addSymbol(const AInt address, const QString &label);
+  void setQuery(const QString &query);
 
   Ui::SymbolNavigator *m_ui;
+  SymbolModel *m_model = nullptr;
 };
 } // namespace Ripes
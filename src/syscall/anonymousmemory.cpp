@@ -0,0 +1,98 @@
+#include "anonymousmemory.h"
+
+#include <algorithm>
+
+namespace Ripes {
+
+AnonymousMemory::AnonymousMemory(AInt base, AInt limit)
+    : m_base(base), m_limit(limit), m_highWater(base) {}
+
+void AnonymousMemory::reset() {
+  m_mapped.clear();
+  m_highWater = m_base;
+  m_mappedPages = 0;
+  m_peakMappedPages = 0;
+}
+
+std::optional<AnonymousMemory::Mapping> AnonymousMemory::map(AInt length) {
+  if (length == 0 || length > m_limit - m_base)
+    return std::nullopt;
+  const AInt size = (length + s_pageSize - 1) & ~(s_pageSize - 1);
+
+  // Find the first gap which fits the mapping.
+  AInt address = m_base;
+  auto next = m_mapped.begin();
+  for (; next != m_mapped.end(); ++next) {
+    if (next->first - address >= size)
+      break;
+    address = next->second;
+  }
+  if (next == m_mapped.end() && m_limit - address < size)
+    return std::nullopt;
+
+  Mapping mapping;
+  mapping.address = address;
+  mapping.size = size;
+  if (address < m_highWater)
+    mapping.staleBytes = std::min(size, m_highWater - address);
+  m_highWater = std::max(m_highWater, address + size);
+
+  // Insert the range, merging it with its neighbours.
+  AInt start = address;
+  AInt end = address + size;
+  if (next != m_mapped.end() && next->first == end) {
+    end = next->second;
+    next = m_mapped.erase(next);
+  }
+  if (next != m_mapped.begin()) {
+    auto prev = std::prev(next);
+    if (prev->second == start) {
+      start = prev->first;
+      m_mapped.erase(prev);
+    }
+  }
+  m_mapped[start] = end;
+
+  m_mappedPages += size / s_pageSize;
+  m_peakMappedPages = std::max(m_peakMappedPages, m_mappedPages);
+  return mapping;
+}
+
+bool AnonymousMemory::unmap(AInt address, AInt length) {
+  if ((address & (s_pageSize - 1)) != 0 || length == 0 || address < m_base ||
+      address >= m_limit || length > m_limit - address)
+    return false;
+  const AInt end = std::min(
+      m_limit, (address + length + s_pageSize - 1) & ~(s_pageSize - 1));
+
+  // Trim each mapped range which overlaps [address, end).
+  auto it = m_mapped.upper_bound(address);
+  if (it != m_mapped.begin())
+    --it;
+  while (it != m_mapped.end() && it->first < end) {
+    const AInt rangeStart = it->first;
+    const AInt rangeEnd = it->second;
+    if (rangeEnd <= address) {
+      ++it;
+      continue;
+    }
+    it = m_mapped.erase(it);
+    if (rangeStart < address)
+      m_mapped[rangeStart] = address;
+    if (rangeEnd > end)
+      it = m_mapped.emplace(end, rangeEnd).first;
+    const AInt unmapped =
+        std::min(rangeEnd, end) - std::max(rangeStart, address);
+    m_mappedPages -= unmapped / s_pageSize;
+  }
+  return true;
+}
+
+bool AnonymousMemory::isMapped(AInt address) const {
+  auto it = m_mapped.upper_bound(address);
+  if (it == m_mapped.begin())
+    return false;
+  return std::prev(it)->second > address;
+}
+
+} // namespace Ripes
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <map>
+#include <optional>
+
+#include "isa/isa_types.h"
+
+namespace Ripes {
+
+/**
+ * @brief The AnonymousMemory class
+ * Allocates the anonymous memory mappings of a program, within a fixed region
+ * of the address space, at the granularity of pages. Mappings are placed at
+ * the first sufficiently large gap of the region.
+ *
+ * No memory is materialized upon mapping; the memory of the processor is
+ * sparse, such that untouched memory reads as zero. Only memory which was
+ * part of a mapping since the last reset may hold stale values, which must be
+ * zeroed once it is mapped again.
+ */
+class AnonymousMemory {
+public:
+  static constexpr AInt s_pageSize = 0x1000;
+  static constexpr AInt s_defaultBase = 0x40000000;
+  static constexpr AInt s_defaultLimit = 0x70000000;
+
+  explicit AnonymousMemory(AInt base = s_defaultBase,
+                           AInt limit = s_defaultLimit);
+
+  struct Mapping {
+    AInt address = 0;
+    // Size of the mapping, rounded up to a multiple of the page size.
+    AInt size = 0;
+    // Bytes at the start of the mapping which were mapped before, and may hold
+    // stale values.
+    AInt staleBytes = 0;
+  };
+
+  /// Maps @p length bytes, or returns std::nullopt if @p length is 0 or no
+  /// gap of the region is large enough.
+  std::optional<Mapping> map(AInt length);
+  /// Unmaps the pages spanned by [@p address, @p address + @p length). Pages
+  /// of the range which are not mapped are ignored. Returns false if
+  /// @p address is not page aligned, or the range is empty or exceeds the
+  /// region.
+  bool unmap(AInt address, AInt length);
+  void reset();
+
+  bool isMapped(AInt address) const;
+  /// Number of pages currently mapped.
+  AInt mappedPages() const { return m_mappedPages; }
+  /// Largest number of pages mapped at once since the last reset.
+  AInt peakMappedPages() const { return m_peakMappedPages; }
+  AInt base() const { return m_base; }
+  AInt limit() const { return m_limit; }
+
+  /// The mappings of the region, for saving and restoring them.
+  struct State {
+    std::map<AInt, AInt> mapped;
+    AInt highWater = 0;
+    AInt mappedPages = 0;
+    AInt peakMappedPages = 0;
+  };
+  State state() const {
+    return {m_mapped, m_highWater, m_mappedPages, m_peakMappedPages};
+  }
+  void restore(const State &state) {
+    m_mapped = state.mapped;
+    m_highWater = state.highWater;
+    m_mappedPages = state.mappedPages;
+    m_peakMappedPages = state.peakMappedPages;
+  }
+
+private:
+  AInt m_base;
+  AInt m_limit;
+  // Mapped ranges, as start address => end address. Adjacent ranges are
+  // merged.
+  std::map<AInt, AInt> m_mapped;
+  // End of the memory which has been mapped since the last reset.
+  AInt m_highWater;
+  AInt m_mappedPages = 0;
+  AInt m_peakMappedPages = 0;
+};
+
+} // namespace Ripes
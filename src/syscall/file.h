@@ -22,16 +22,7 @@ public:
   void execute() {
     const AInt arg0 = BaseSyscall::getArg(BaseSyscall::REG_FILE, 0);
     const AInt arg1 = BaseSyscall::getArg(BaseSyscall::REG_FILE, 1);
-    QByteArray string;
-    char byte;
-    unsigned int address = arg0;
-    do {
-      byte = static_cast<char>(
-          ProcessorHandler::getMemory().readMemConst(address++, 1) & 0xFF);
-      string.append(byte);
-    } while (byte != '\0');
-    if (string.endsWith('\0'))
-      string.remove(string.size() - 1, 1); // Remove null-byte
+    const QByteArray string = ProcessorHandler::readMemString(arg0);
 
     int ret = SystemIO::openFile(QString::fromUtf8(string), arg1);
 
@@ -85,26 +76,20 @@ public:
                      {1, "address of the buffer"},
                      {2, "maximum number of bytes to read"}},
                     {{0, "number of read bytes or -1 if an error occurred"}}) {}
+  bool blocking() const override {
+    // Reads from stdin (fd 0) wait for console input, unless served from a
+    // stdin source.
+    return BaseSyscall::getArg(BaseSyscall::REG_FILE, 0) == 0 &&
+           !SystemIO::hasStdInSource();
+  }
   void execute() {
     const int fd = BaseSyscall::getArg(BaseSyscall::REG_FILE, 0);
-    int byteAddress = BaseSyscall::getArg(
+    const AInt byteAddress = BaseSyscall::getArg(
         BaseSyscall::REG_FILE, 1); // destination of characters read from file
     const int length = BaseSyscall::getArg(BaseSyscall::REG_FILE, 2);
-    QByteArray buffer;
 
-    int retLength = SystemIO::readFromFile(fd, buffer, length);
+    const int retLength = SystemIO::readToMemory(fd, byteAddress, length);
     BaseSyscall::setRet(BaseSyscall::REG_FILE, 0, retLength);
-
-    if (retLength != -1) {
-      // copy bytes from returned buffer into memory
-      const char *dataptr =
-          buffer.constData(); // QString::data contains a possible null
-                              // termination '\0' character (present if reading
-                              // from stdin and not from a file)
-      while (retLength-- > 0) {
-        ProcessorHandler::writeMem(byteAddress++, *dataptr++, sizeof(char));
-      }
-    }
   }
 };
 
@@ -120,7 +105,7 @@ public:
                      {2, "number of bytes to write"}},
                     {{0, "the number of bytes written"}}) {}
   void execute() {
-    const int byteAddress = BaseSyscall::getArg(
+    const AInt byteAddress = BaseSyscall::getArg(
         BaseSyscall::REG_FILE, 1); // source of characters to write to file
     const int reqLength =
         BaseSyscall::getArg(BaseSyscall::REG_FILE, 2); // user-requested length
@@ -128,17 +113,8 @@ public:
       BaseSyscall::setRet(BaseSyscall::REG_FILE, 0, -1);
       return;
     }
-    int index = 0;
-    QString myBuffer;
-
-    do {
-      myBuffer.append(static_cast<char>(
-          ProcessorHandler::getMemory().readMemConst(byteAddress + index++, 1) &
-          0xFF));
-    } while (index < reqLength);
-
-    const int retValue = SystemIO::writeToFile(
-        BaseSyscall::getArg(BaseSyscall::REG_FILE, 0), myBuffer, reqLength);
+    const int retValue = SystemIO::writeFromMemory(
+        BaseSyscall::getArg(BaseSyscall::REG_FILE, 0), byteAddress, reqLength);
     BaseSyscall::setRet(BaseSyscall::REG_FILE, 0, retValue);
   }
 };
@@ -156,9 +132,8 @@ public:
              {1, "the length of the buffer"}},
             {{0, "-1 if the path is longer than the buffer"}}) {}
   void execute() {
-    const int byteAddress = BaseSyscall::getArg(
+    const AInt byteAddress = BaseSyscall::getArg(
         BaseSyscall::REG_FILE, 0); // destination of characters read from file
-    int index = 0;
     const int bufferSize = BaseSyscall::getArg(BaseSyscall::REG_FILE, 1);
 
     const QString pwd = QDir::currentPath();
@@ -171,10 +146,8 @@ public:
     }
 
     // copy bytes from returned buffer into memory
-    while (index < pwd.length()) {
-      ProcessorHandler::writeMem(byteAddress, pwd.at(index++).toLatin1(),
-                                 sizeof(char));
-    }
+    const QByteArray path = pwd.toLatin1();
+    ProcessorHandler::writeMemBlock(byteAddress, path.constData(), path.size());
   }
 };
 
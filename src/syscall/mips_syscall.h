@@ -0,0 +1,67 @@
+#pragma once
+
+#include "isa/mipsisainfo_common.h"
+#include "processorhandler.h"
+#include "ripes_syscall.h"
+
+// Syscall headers
+#include "control.h"
+#include "file.h"
+#include "print.h"
+
+namespace Ripes {
+
+class MIPSSyscall : public Syscall {
+public:
+  constexpr static std::string_view REG_FILE = MIPSISA::GPR;
+
+  MIPSSyscall(const QString &name, const QString &description = QString(),
+              const std::map<ArgIdx, QString> &argumentDescriptions =
+                  std::map<ArgIdx, QString>(),
+              const std::map<ArgIdx, QString> &returnDescriptions =
+                  std::map<ArgIdx, QString>())
+      : Syscall(name, description, argumentDescriptions, returnDescriptions) {}
+  ~MIPSSyscall() override {}
+
+  VInt getArg(const std::string_view &rfid, ArgIdx i) const override {
+    // MIPS arguments range from a0-a3
+    assert(i < 4);
+    const int regIdx = 4 + i; // a0 = $4
+    return ProcessorHandler::getRegisterValue(rfid, regIdx);
+  }
+
+  void setRet(const std::string_view &rfid, ArgIdx i,
+              VInt value) const override {
+    // MIPS return values range from v0-v1
+    assert(i < 2);
+    const int regIdx = 2 + i; // v0 = $2
+    ProcessorHandler::setRegisterValue(rfid, regIdx, value);
+  }
+};
+
+/// The system calls of MARS, of which the numbering is followed. Files are
+/// only accessed through the standard file descriptors, given that MARS
+/// interprets the flags of open differently.
+class MIPSSyscallManager : public SyscallManagerT<MIPSSyscall> {
+public:
+  MIPSSyscallManager() {
+    // Print syscalls
+    emplace<PrintIntSyscall<MIPSSyscall>>(MIPSABI::PrintInt);
+    emplace<PrintStrSyscall<MIPSSyscall>>(MIPSABI::PrintStr);
+    emplace<PrintCharSyscall<MIPSSyscall>>(MIPSABI::PrintChar);
+    emplace<PrintHexSyscall<MIPSSyscall>>(MIPSABI::PrintIntHex);
+    emplace<PrintBinarySyscall<MIPSSyscall>>(MIPSABI::PrintIntBinary);
+    emplace<PrintUnsignedSyscall<MIPSSyscall>>(MIPSABI::PrintIntUnsigned);
+
+    // Control syscalls
+    emplace<ExitSyscall<MIPSSyscall>>(MIPSABI::Exit);
+    emplace<Exit2Syscall<MIPSSyscall>>(MIPSABI::Exit2);
+
+    // File syscalls
+    emplace<ReadSyscall<MIPSSyscall>>(MIPSABI::Read);
+    emplace<WriteSyscall<MIPSSyscall>>(MIPSABI::Write);
+    emplace<CloseSyscall<MIPSSyscall>>(MIPSABI::Close);
+  }
+};
+
+} // namespace Ripes
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <type_traits>
+
+#include <QByteArray>
+
+#include "processorhandler.h"
+#include "ripes_syscall.h"
+
+namespace Ripes {
+
+// Flags of mmap, as defined by Linux.
+constexpr VInt MMAP_FLAG_PRIVATE = 0x02;
+constexpr VInt MMAP_FLAG_ANONYMOUS = 0x20;
+
+template <typename BaseSyscall>
+class MmapSyscall : public BaseSyscall {
+  static_assert(std::is_base_of<Syscall, BaseSyscall>::value);
+
+public:
+  MmapSyscall()
+      : BaseSyscall(
+            "mmap",
+            "Maps zero-filled anonymous memory. Only private, anonymous "
+            "mappings (flags MAP_PRIVATE | MAP_ANONYMOUS) are supported. Pages "
+            "of the mapping are materialized once they are accessed.",
+            {{0, "address hint (ignored)"},
+             {1, "length of the mapping in bytes"},
+             {2, "memory protection (ignored)"},
+             {3, "flags; MAP_PRIVATE (0x02) and MAP_ANONYMOUS (0x20)"},
+             {4, "file descriptor; must be -1"},
+             {5, "offset; must be 0"}},
+            {{0, "the address of the mapping, or -1 if an error occurred"}}) {}
+
+  void execute() {
+    const AInt length = BaseSyscall::getArg(BaseSyscall::REG_FILE, 1);
+    const VInt flags = BaseSyscall::getArg(BaseSyscall::REG_FILE, 3);
+    const int fd = BaseSyscall::getArg(BaseSyscall::REG_FILE, 4);
+    const VInt offset = BaseSyscall::getArg(BaseSyscall::REG_FILE, 5);
+
+    const VInt supported = MMAP_FLAG_PRIVATE | MMAP_FLAG_ANONYMOUS;
+    std::optional<AnonymousMemory::Mapping> mapping;
+    if ((flags & ~supported) == 0 && (flags & MMAP_FLAG_ANONYMOUS) &&
+        fd == -1 && offset == 0)
+      mapping = ProcessorHandler::getSyscallManagerNonConst()
+                    .anonymousMemory()
+                    .map(length);
+    if (!mapping) {
+      BaseSyscall::setRet(BaseSyscall::REG_FILE, 0, -1);
+      return;
+    }
+
+    // Memory which was mapped before may hold stale values. Only pages which
+    // hold any non-zero value are cleared, such that untouched pages are not
+    // materialized.
+    QByteArray page(AnonymousMemory::s_pageSize, '\0');
+    const QByteArray zeros(AnonymousMemory::s_pageSize, '\0');
+    for (AInt cleared = 0; cleared < mapping->staleBytes;
+         cleared += AnonymousMemory::s_pageSize) {
+      const AInt address = mapping->address + cleared;
+      ProcessorHandler::readMemBlock(address, page.data(), page.size());
+      if (page != zeros)
+        ProcessorHandler::writeMemBlock(address, zeros.constData(),
+                                        zeros.size());
+    }
+    BaseSyscall::setRet(BaseSyscall::REG_FILE, 0, mapping->address);
+  }
+};
+
+template <typename BaseSyscall>
+class MunmapSyscall : public BaseSyscall {
+  static_assert(std::is_base_of<Syscall, BaseSyscall>::value);
+
+public:
+  MunmapSyscall()
+      : BaseSyscall(
+            "munmap",
+            "Unmaps the pages of anonymous memory spanned by a range.",
+            {{0, "page aligned start address of the range"},
+             {1, "length of the range in bytes"}},
+            {{0, "0 on success, or -1 if an error occurred"}}) {}
+
+  void execute() {
+    const AInt address = BaseSyscall::getArg(BaseSyscall::REG_FILE, 0);
+    const AInt length = BaseSyscall::getArg(BaseSyscall::REG_FILE, 1);
+    const bool success = ProcessorHandler::getSyscallManagerNonConst()
+                             .anonymousMemory()
+                             .unmap(address, length);
+    BaseSyscall::setRet(BaseSyscall::REG_FILE, 0, success ? 0 : -1);
+  }
+};
+
+} // namespace Ripes
@@ -4,8 +4,35 @@
 
 namespace Ripes {
 
+unsigned SyscallStats::bucket(uint64_t ns) {
+  unsigned bucket = 0;
+  while (bucket + 1 < c_buckets && (ns >> (bucket + 1)) != 0)
+    ++bucket;
+  return bucket;
+}
+
+void SyscallStats::record(uint64_t ns, bool isAsync) {
+  ++timed;
+  if (isAsync)
+    ++asyncCount;
+  totalNs += ns;
+  maxNs = std::max(maxNs, ns);
+  ++histogram[bucket(ns)];
+}
+
+void SyscallManager::recordLatency(SyscallID id, uint64_t ns, bool async) {
+  std::lock_guard lock(m_statsMutex);
+  // Only known syscalls are profiled.
+  if (auto it = m_stats.find(id); it != m_stats.end())
+    it->second.record(ns, async);
+}
+
 bool SyscallManager::execute(SyscallID id) {
+  // Headless simulation contexts have no GUI to report status to.
+  const bool headless = SimulationContext::active() != nullptr;
   if (m_syscalls.count(id) == 0) {
+    if (headless)
+      return false;
     postToGUIThread([=] {
       if (auto reg = ProcessorHandler::currentISA()->syscallReg();
           reg.has_value()) {
@@ -21,6 +48,14 @@ bool SyscallManager::execute(SyscallID id) {
     return false;
   } else {
     const auto &syscall = m_syscalls.at(id);
+    {
+      std::lock_guard lock(m_statsMutex);
+      m_stats[id].count++;
+    }
+    if (headless) {
+      syscall->execute();
+      return true;
+    }
     const QString &syscallName = syscall->name();
     postToGUIThread([=] {
       // We don't have a good way of making non-permanent status timers
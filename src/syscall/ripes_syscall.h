@@ -6,11 +6,14 @@
 #include <QString>
 #include <QThread>
 
+#include <array>
 #include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 
 #include "../isa/isainfo.h"
+#include "anonymousmemory.h"
 #include "isa/isa_types.h"
 #include "statusmanager.h"
 
@@ -44,6 +47,16 @@ public:
 
   virtual void execute() = 0;
 
+  /**
+   * @brief blocking
+   * Returns true if executing the system call with its current arguments may
+   * block while waiting for user input from the console. Blocking system calls
+   * are executed asynchronously, such that the simulation can be aborted while
+   * waiting. All other system calls are executed directly on the simulating
+   * thread.
+   */
+  virtual bool blocking() const { return false; }
+
   /**
    * @brief getArg
    * ABI specific specialization of returning an argument register value.
@@ -67,6 +80,37 @@ protected:
   const std::map<ArgIdx, QString> m_returnDescriptions;
 };
 
+/**
+ * @brief The SyscallStats struct
+ * Profile of the executions of a system call. Latencies are the wall-clock
+ * time from the trap to the system call until it returned, including the
+ * dispatch of blocking system calls to another thread, and are recorded for
+ * system calls trapped by the processor.
+ */
+struct SyscallStats {
+  /// Latencies are binned by powers of two; bucket i holds latencies within
+  /// [2^i, 2^(i+1)) ns, and the last bucket holds all longer latencies.
+  static constexpr unsigned c_buckets = 32;
+  static unsigned bucket(uint64_t ns);
+  /// Returns the lower bound of the latencies of @p bucket, in ns.
+  static uint64_t bucketStart(unsigned bucket) {
+    return bucket ? 1ull << bucket : 0;
+  }
+
+  void record(uint64_t ns, bool isAsync);
+  double meanNs() const { return timed == 0 ? 0 : double(totalNs) / timed; }
+
+  uint64_t count = 0;
+  // Executions of which the latency was recorded.
+  uint64_t timed = 0;
+  // Executions which were dispatched to another thread, given that they might
+  // block.
+  uint64_t asyncCount = 0;
+  uint64_t totalNs = 0;
+  uint64_t maxNs = 0;
+  std::array<uint64_t, c_buckets> histogram{};
+};
+
 /**
  * @brief The SyscallManager class
  *
@@ -84,13 +128,45 @@ public:
    */
   bool execute(SyscallID id);
 
+  /**
+   * @brief isBlocking
+   * Returns true if the syscall identified by id may block, given the current
+   * argument values. Unknown syscalls are non-blocking.
+   */
+  bool isBlocking(SyscallID id) const {
+    auto it = m_syscalls.find(id);
+    return it != m_syscalls.end() && it->second->blocking();
+  }
+
   const std::map<SyscallID, std::unique_ptr<Syscall>> &getSyscalls() const {
     return m_syscalls;
   }
 
+  /// Returns the profile of each known syscall executed since the last call
+  /// to resetStats(). The profile may be read while the syscalls execute.
+  std::map<SyscallID, SyscallStats> stats() const {
+    std::lock_guard lock(m_statsMutex);
+    return m_stats;
+  }
+  /// Records the latency of an execution of the syscall identified by id,
+  /// which was dispatched to another thread if @p async.
+  void recordLatency(SyscallID id, uint64_t ns, bool async);
+  void resetStats() {
+    std::lock_guard lock(m_statsMutex);
+    m_stats.clear();
+  }
+
+  /// Anonymous memory mappings of the program, which are reset alongside the
+  /// processor.
+  AnonymousMemory &anonymousMemory() { return m_anonymousMemory; }
+  const AnonymousMemory &anonymousMemory() const { return m_anonymousMemory; }
+
 protected:
   SyscallManager() {}
   std::map<SyscallID, std::unique_ptr<Syscall>> m_syscalls;
+  mutable std::mutex m_statsMutex;
+  std::map<SyscallID, SyscallStats> m_stats;
+  AnonymousMemory m_anonymousMemory;
 };
 
 template <class T>
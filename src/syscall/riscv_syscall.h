@@ -7,6 +7,7 @@
 // Syscall headers
 #include "control.h"
 #include "file.h"
+#include "mmap.h"
 #include "print.h"
 #include "syscall_time.h"
 
@@ -57,6 +58,10 @@ public:
     emplace<Exit2Syscall<RISCVSyscall>>(RVABI::Exit2);
     emplace<BrkSyscall<RISCVSyscall>>(RVABI::brk);
 
+    // Memory syscalls
+    emplace<MmapSyscall<RISCVSyscall>>(RVABI::mmap);
+    emplace<MunmapSyscall<RISCVSyscall>>(RVABI::munmap);
+
     // File syscalls
     emplace<CloseSyscall<RISCVSyscall>>(RVABI::Close);
     emplace<LSeekSyscall<RISCVSyscall>>(RVABI::LSeek);
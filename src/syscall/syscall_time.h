@@ -2,6 +2,7 @@
 
 #include <type_traits>
 
+#include "inputlog.h"
 #include "processorhandler.h"
 #include "ripes_syscall.h"
 #include "systemio.h"
@@ -40,7 +41,7 @@ public:
                     {{0, "low 32 bits of milliseconds since epoch"},
                      {1, "high 32 bits of milliseconds since epoch"}}) {}
   void execute() {
-    long long ms = QDateTime::currentMSecsSinceEpoch();
+    long long ms = InputLog::time(QDateTime::currentMSecsSinceEpoch());
     BaseSyscall::setRet(BaseSyscall::REG_FILE, 0, ms & 0xFFFFFFFF);
     BaseSyscall::setRet(BaseSyscall::REG_FILE, 1, (ms >> 32) & 0xFFFFFFFF);
   }
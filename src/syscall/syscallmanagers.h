@@ -0,0 +1,20 @@
+#pragma once
+
+#include "mips_syscall.h"
+#include "riscv_syscall.h"
+
+namespace Ripes {
+
+/// Returns a manager of the system calls of the ABI of @p isa.
+inline std::unique_ptr<SyscallManager> createSyscallManager(ISA isa) {
+  switch (isa) {
+  case ISA::RV32I:
+  case ISA::RV64I:
+    return std::make_unique<RISCVSyscallManager>();
+  case ISA::MIPS32I:
+    return std::make_unique<MIPSSyscallManager>();
+  }
+  Q_UNREACHABLE();
+}
+
+} // namespace Ripes
@@ -23,20 +23,26 @@ SyscallViewer::SyscallViewer(QWidget *parent)
 
   const auto &syscallManager = ProcessorHandler::getSyscallManager();
 
-  // Setup syscall list
-  m_ui->syscallList->setColumnCount(2);
+  // Setup syscall list. The profile of the syscalls is the profile at the
+  // time of opening the viewer.
+  m_ui->syscallList->setColumnCount(4);
   m_ui->syscallList->setSortingEnabled(false);
+  const auto stats = syscallManager.stats();
   for (const auto &iter : syscallManager.getSyscalls()) {
-    addSyscall(iter.first, iter.second.get());
+    auto it = stats.find(iter.first);
+    addSyscall(iter.first, iter.second.get(),
+               it != stats.end() ? it->second : SyscallStats());
   }
   m_ui->syscallList->setSelectionBehavior(QAbstractItemView::SelectRows);
   m_ui->syscallList->verticalHeader()->hide();
   if (auto reg = ProcessorHandler::currentISA()->syscallReg();
       reg.has_value()) {
     m_ui->syscallList->setHorizontalHeaderLabels(
-        {"Func. (" + reg->file->regAlias(reg->index) + ")", "Name"});
+        {"Func. (" + reg->file->regAlias(reg->index) + ")", "Name", "Calls",
+         "Mean latency"});
   }
   m_ui->syscallList->horizontalHeader()->setStretchLastSection(true);
+  m_ui->syscallList->resizeColumnToContents(2);
   connect(m_ui->syscallList, &QTableWidget::currentItemChanged, this,
           &SyscallViewer::handleItemChanged);
 
@@ -116,22 +122,47 @@ void SyscallViewer::addItemToTable(QTableWidget *table, unsigned int idx,
   table->setItem(row, 2, textItem);
 }
 
-void SyscallViewer::addSyscall(unsigned id, const Syscall *syscall) {
+static QString formatLatency(double ns) {
+  if (ns < 1e3)
+    return QString::number(ns, 'f', 0) + " ns";
+  if (ns < 1e6)
+    return QString::number(ns / 1e3, 'f', 1) + " us";
+  return QString::number(ns / 1e6, 'f', 1) + " ms";
+}
+
+void SyscallViewer::addSyscall(unsigned id, const Syscall *syscall,
+                               const SyscallStats &stats) {
   m_ui->syscallList->setRowCount(m_ui->syscallList->rowCount() + 1);
   QTableWidgetItem *idItem = new QTableWidgetItem();
   QTableWidgetItem *textItem = new QTableWidgetItem();
+  QTableWidgetItem *countItem = new QTableWidgetItem();
+  QTableWidgetItem *latencyItem = new QTableWidgetItem();
 
   idItem->setData(Qt::EditRole, QString::number(id));
   textItem->setData(Qt::DisplayRole, syscall->name());
-  idItem->setData(Qt::UserRole, QVariant::fromValue(syscall));
-  textItem->setData(Qt::UserRole, QVariant::fromValue(syscall));
-
-  idItem->setFlags(idItem->flags() ^ Qt::ItemIsEditable);
-  textItem->setFlags(textItem->flags() ^ Qt::ItemIsEditable);
+  countItem->setData(Qt::DisplayRole, QString::number(stats.count));
+  if (stats.timed != 0) {
+    latencyItem->setData(Qt::DisplayRole, formatLatency(stats.meanNs()));
+    // The latency histogram is shown as the tooltip of the latency.
+    QStringList histogram = {"Max: " + formatLatency(stats.maxNs),
+                             "Dispatched to another thread: " +
+                                 QString::number(stats.asyncCount)};
+    for (unsigned i = 0; i < SyscallStats::c_buckets; ++i)
+      if (stats.histogram.at(i) != 0)
+        histogram << ">= " + formatLatency(SyscallStats::bucketStart(i)) +
+                         ": " + QString::number(stats.histogram.at(i));
+    latencyItem->setToolTip(histogram.join('\n'));
+  }
+  for (auto *item : {idItem, textItem, countItem, latencyItem}) {
+    item->setData(Qt::UserRole, QVariant::fromValue(syscall));
+    item->setFlags(item->flags() ^ Qt::ItemIsEditable);
+  }
 
   const int row = m_ui->syscallList->rowCount() - 1;
   m_ui->syscallList->setItem(row, 0, idItem);
   m_ui->syscallList->setItem(row, 1, textItem);
+  m_ui->syscallList->setItem(row, 2, countItem);
+  m_ui->syscallList->setItem(row, 3, latencyItem);
 }
 
 SyscallViewer::~SyscallViewer() { delete m_ui; }
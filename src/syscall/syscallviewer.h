@@ -19,7 +19,8 @@ public:
 
 private:
   void handleItemChanged(QTableWidgetItem *current, QTableWidgetItem *previous);
-  void addSyscall(unsigned id, const Syscall *syscall);
+  void addSyscall(unsigned id, const Syscall *syscall,
+                  const SyscallStats &stats);
   void addItemToTable(QTableWidget *table, unsigned idx,
                       const QString &description);
   void setCurrentSyscall(const Syscall *syscall);
@@ -1,14 +1,72 @@
 #include "systemio.h"
+#include "processorhandler.h"
+
+#include <vector>
 
 namespace Ripes {
 QString SystemIO::s_fileErrorString;
 
 std::map<int, QString> SystemIO::FileIOData::fileNames;
 std::map<int, unsigned> SystemIO::FileIOData::fileFlags;
-std::map<int, QTextStream> SystemIO::FileIOData::streams;
-std::map<int, QFile> SystemIO::FileIOData::files;
+std::map<int, std::unique_ptr<SystemIOFile>> SystemIO::FileIOData::files;
+SPSCChunkQueue<QByteArray> SystemIO::FileIOData::s_stdinQueue;
 QByteArray SystemIO::FileIOData::s_stdinBuffer;
+qsizetype SystemIO::FileIOData::s_stdinPos = 0;
 QMutex SystemIO::FileIOData::s_stdioMutex;
 QWaitCondition SystemIO::FileIOData::s_stdinBufferEmpty;
 bool SystemIO::s_abortSyscall = false;
+QIODevice *SystemIO::s_stdinSource = nullptr;
+QString SystemIO::s_pendingOutput;
+QMutex SystemIO::s_outputMutex;
+QMutex SystemIO::s_flushMutex;
+bool SystemIO::s_retainOutput = false;
+
+int SystemIO::readToMemory(int fd, AInt address, int lengthRequested) {
+  SystemIO::get(); // Ensure that SystemIO is constructed
+  if (fd == STDIN || !FileIOData::readable(fd)) {
+    QByteArray buffer;
+    const int length = readFromFile(fd, buffer, lengthRequested);
+    if (length > 0)
+      ProcessorHandler::writeMemBlock(address, buffer.constData(), length);
+    return length;
+  }
+
+  // Chunks of the file are written to memory as they are read.
+  AInt dest = address;
+  const qint64 length = FileIOData::files.at(fd)->read(
+      std::max(lengthRequested, 0), [&](const char *data, qint64 size) {
+        ProcessorHandler::writeMemBlock(dest, data, size);
+        dest += size;
+      });
+  if (length > 0)
+    return length;
+
+  // End of file - write EOF file character into memory, as readFromFile.
+  const QByteArray eof(sizeof(int), EOF);
+  ProcessorHandler::writeMemBlock(address, eof.constData(), eof.size());
+  return eof.size();
+}
+
+int SystemIO::writeFromMemory(int fd, AInt address, int lengthRequested) {
+  SystemIO::get(); // Ensure that SystemIO is constructed
+  if (fd == STDOUT || fd == STDERR || !FileIOData::writable(fd)) {
+    QByteArray buffer(std::max(lengthRequested, 0), '\0');
+    ProcessorHandler::readMemBlock(address, buffer.data(), buffer.size());
+    return writeToFile(fd, QString::fromLatin1(buffer), lengthRequested);
+  }
+
+  // Bytes are copied from memory in chunks, and written unmodified.
+  constexpr int chunkSize = 1 << 16;
+  std::vector<char> chunk(std::min(std::max(lengthRequested, 0), chunkSize));
+  auto &file = *FileIOData::files.at(fd);
+  for (int written = 0; written < lengthRequested;) {
+    const int size = std::min(lengthRequested - written, chunkSize);
+    ProcessorHandler::readMemBlock(address + written, chunk.data(), size);
+    if (file.write(chunk.data(), size) != size)
+      return -1;
+    written += size;
+  }
+  return lengthRequested;
+}
+
 } // namespace Ripes
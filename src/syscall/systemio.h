@@ -8,14 +8,21 @@
 #include <QObject>
 #include <QTemporaryFile>
 #include <QTextStream>
+#include <QTimer>
 #include <QWaitCondition>
 
 #include <set>
 #include <stdexcept>
 #include <sys/stat.h>
+#include <utility>
 
 #include "STLExtras.h"
+#include "inputlog.h"
+#include "isa/isa_types.h"
+#include "simulationcontext.h"
+#include "spscchunkqueue.h"
 #include "statusmanager.h"
+#include "systemiofile.h"
 
 namespace Ripes {
 
@@ -69,11 +76,27 @@ private:
   // Flag used for aborting waiting for I/O
   static bool s_abortSyscall;
 
+  // Source of console input of headless runs, if set (see setStdInSource).
+  static QIODevice *s_stdinSource;
+
+  // Output printed by the simulated program, which is yet to be emitted
+  // through doPrint. Output is emitted in chunks about once per frame, such
+  // that programs printing a character at a time do not flood the event loop.
+  static QString s_pendingOutput;
+  static QMutex s_outputMutex;
+  // Serializes the emission of pending output, which headless runs may flush
+  // from the simulating thread.
+  static QMutex s_flushMutex;
+  // Maximum number of pending characters. Once exceeded, the oldest pending
+  // output is discarded, given that the console of the GUI only retains the
+  // latest output anyway, unless output is retained (see setRetainOutput).
+  static constexpr int s_maxPendingOutput = 1 << 20;
+  static bool s_retainOutput;
+  static constexpr int s_outputInterval = 16; // ms
+
   // Standard I/O Channels
   enum STDIO { STDIN = 0, STDOUT = 1, STDERR = 2, STDIO_END };
 
-  // Buffer size for syscalls for file I/O
-  static constexpr int SYSCALL_BUFSIZE = 128;
   // Maximum number of files that can be open
   static constexpr int SYSCALL_MAXFILES = 32;
 
@@ -98,18 +121,22 @@ private:
     static std::map<int, QString> fileNames;
     // The flags of this file. Invalid if this file descriptor is not in use.
     static std::map<int, unsigned> fileFlags;
-    // The streams in use, associated with the filenames
-    static std::map<int, QTextStream> streams;
-    // The file pointers in use
-    static std::map<int, QFile> files;
-    // QByteArray to use as a stdin buffer
+    // The files in use, associated with the filenames
+    static std::map<int, std::unique_ptr<SystemIOFile>> files;
+    // Console input pushed by the GUI thread, which is yet to be received by
+    // the simulation thread (see putStdInData and receiveStdIn).
+    static SPSCChunkQueue<QByteArray> s_stdinQueue;
+    // All console input received, and the position of the next read of stdin
+    // within it.
     static QByteArray s_stdinBuffer;
+    static qsizetype s_stdinPos;
 
     /**
      * @brief s_stdioMutex
      * Used for implementing the waitCondition between the producer/consumer
-     * scenario where ecall handling is blocking while waiting for the
-     * stdinBuffer to be non-empty.
+     * scenario where ecall handling is blocking while waiting for console
+     * input. The input itself is passed through s_stdinQueue, such that the
+     * mutex is never held while input is copied.
      */
     static QMutex s_stdioMutex;
     static QWaitCondition s_stdinBufferEmpty;
@@ -130,19 +157,14 @@ private:
       fileFlags[STDOUT] = SystemIO::O_WRONLY;
       fileFlags[STDERR] = SystemIO::O_WRONLY;
 
-      if (streams.count(STDIN) == 0) {
-        // stdin stream has not yet been created
-        streams.emplace(STDIN, &s_stdinBuffer);
-      } else {
-        // Clear stdin stream and reset stream
-        s_stdinBuffer.clear();
-        auto success = streams[STDIN].seek(0);
-        Q_ASSERT(success);
-      }
+      // Discard any console input. Stdio is only reset while no read of stdin
+      // is in progress, such that the queue may be drained here.
+      receiveStdIn();
+      s_stdinBuffer.clear();
+      s_stdinPos = 0;
 
       // stdout/stderr will be handled via. signal/slots internally in the
-      // application streams.emplace(STDOUT, stdout); streams.emplace(STDERR,
-      // stderr);
+      // application.
     }
 
     // Open a file stream assigned to the given file descriptor
@@ -165,27 +187,52 @@ private:
           (flags & O_APPEND ? QIODevice::Append : QIODevice::NotOpen);
 
       // Try to open file with the given flags
-      files.emplace(fd, filename);
       auto &file = files[fd];
-      file.open(qtOpenFlags);
+      file = std::make_unique<SystemIOFile>(filename);
+      file->open(qtOpenFlags);
 
-      if (!file.exists() && !(flags & O_CREAT)) {
+      if (!file->exists() && !(flags & O_CREAT)) {
         throw std::runtime_error("Could not create file");
       }
 
-      if (!file.exists()) {
+      if (!file->exists()) {
         throw std::runtime_error("File not found");
       }
 
-      if (!file.isOpen()) {
+      if (!file->isOpen()) {
         throw std::runtime_error("File could not be opened");
       }
-
-      streams.emplace(fd, &files[fd]);
     }
 
     // Retrieve a stream for use
-    static QTextStream &getStreamInUse(int fd) { return streams[fd]; }
+    // Appends all queued console input to s_stdinBuffer.
+    static void receiveStdIn() {
+      QByteArray data;
+      while (s_stdinQueue.pop(data))
+        s_stdinBuffer.append(data);
+    }
+
+    // Appends received console input to @p buffer, up to and including the
+    // next newline, until @p buffer holds @p length bytes. Returns whether the
+    // read is complete.
+    static bool readStdIn(QByteArray &buffer, int length) {
+      const qsizetype end =
+          std::min<qsizetype>(s_stdinBuffer.size(),
+                              s_stdinPos + (length - buffer.size()));
+      const qsizetype newline = s_stdinBuffer.indexOf('\n', s_stdinPos);
+      const qsizetype last = newline >= 0 && newline < end ? newline + 1 : end;
+      buffer.append(s_stdinBuffer.constData() + s_stdinPos, last - s_stdinPos);
+      s_stdinPos = last;
+      return buffer.size() >= length || buffer.endsWith('\n');
+    }
+
+    // Determine whether a given fd is open for reading, or for writing.
+    static bool readable(int fd) {
+      return fdInUse(fd, O_RDONLY) || fdInUse(fd, O_RDWR);
+    }
+    static bool writable(int fd) {
+      return fdInUse(fd, O_WRONLY) || fdInUse(fd, O_RDWR);
+    }
 
     // Determine whether a given filename is already in use.
     static bool filenameInUse(const QString &requestedFilename) {
@@ -215,8 +262,6 @@ private:
         return;
 
       fileFlags[fd] = O_ACCMODE; // set flag to invalid read/write mode
-      files[fd].close();
-      streams.erase(fd);
       files.erase(fd);
       fileNames.erase(fd);
     }
@@ -270,6 +315,13 @@ public:
     int retValue = -1;
     int fdToUse;
 
+    auto *context = SimulationContext::active();
+    if (context && !context->mayOpenFile()) {
+      s_fileErrorString = "File name " + filename +
+                          " exceeds the open file limit of the simulation";
+      return -1;
+    }
+
     // Check internal plausibility of opening this file
     fdToUse = FileIOData::nowOpening(filename, flags);
     retValue = fdToUse; // return value is the fd
@@ -285,6 +337,8 @@ public:
           "File " + filename + " could not be opened: " + error.what();
       retValue = -1;
     }
+    if (context && retValue >= 0)
+      context->fileOpened(retValue);
 
     return retValue; // return the "file descriptor"
   }
@@ -310,21 +364,33 @@ public:
     }
     if (fd < 0 || fd >= SYSCALL_MAXFILES)
       return -1;
-    auto &stream = FileIOData::getStreamInUse(fd);
+    if (fd == STDIN) {
+      // Console input is seekable within the input received so far.
+      FileIOData::receiveStdIn();
+      if (base == SEEK_CUR)
+        offset += FileIOData::s_stdinPos;
+      else if (base != SEEK_SET)
+        return -1;
+      if (offset < 0 || offset > FileIOData::s_stdinBuffer.size())
+        return -1;
+      FileIOData::s_stdinPos = offset;
+      return offset;
+    }
+    auto &file = *FileIOData::files.at(fd);
 
     if (base == SEEK_SET) {
       offset += 0;
     } else if (base == SEEK_CUR) {
-      offset += stream.pos();
+      offset += file.pos();
     } else if (base == SEEK_END) {
-      offset += FileIOData::files[fd].size();
+      offset += file.size();
     } else {
       return -1;
     }
     if (offset < 0) {
       return -1;
     }
-    stream.seek(offset);
+    file.seek(offset);
     return offset;
   }
 
@@ -337,56 +403,80 @@ public:
    * @return number of bytes read, 0 on EOF, or -1 on error
    */
   static int readFromFile(int fd, QByteArray &myBuffer, int lengthRequested) {
+    // Console input is replayed from, or recorded to, the input log.
+    if (fd == STDIN) {
+      if (auto replayed = InputLog::replayStdIn()) {
+        myBuffer = *replayed;
+        return myBuffer.size();
+      }
+    }
+    const int read = readFromFileLive(fd, myBuffer, lengthRequested);
+    if (fd == STDIN && read >= 0)
+      InputLog::recordStdIn(myBuffer);
+    return read;
+  }
+
+  /**
+   * Read bytes from file, bypassing the input log. See readFromFile.
+   */
+  static int readFromFileLive(int fd, QByteArray &myBuffer,
+                              int lengthRequested) {
     s_abortSyscall = false; // Reset any stale abort requests
     SystemIO::get();        // Ensure that SystemIO is constructed
     /////////////// DPS 8-Jan-2013
     /////////////////////////////////////////////////////
     /// Read from STDIN file descriptor while using IDE - get input from
     /// Messages pane.
-    if (!(FileIOData::fdInUse(fd, O_RDONLY) ||
-          FileIOData::fdInUse(fd,
-                              O_RDWR))) // Check the existence of the "read" fd
+    if (!FileIOData::readable(fd)) // Check the existence of the "read" fd
     {
       s_fileErrorString =
           "File descriptor " + QString::number(fd) + " is not open for reading";
       return -1;
     }
-    // retrieve FileInputStream from storage
-    auto &InputStream = FileIOData::getStreamInUse(fd);
 
-    if (fd == STDIN) {
+    if (fd == STDIN && SimulationContext::active()) {
+      // Headless contexts read from their own stdin buffer without blocking.
+      // An empty read signals EOF to the program.
+      myBuffer = SimulationContext::active()->readStdIn(lengthRequested);
+      return myBuffer.size();
+    } else if (fd == STDIN && s_stdinSource) {
+      // As with console input, reads end after a newline.
+      myBuffer = lengthRequested > 0 ? s_stdinSource->readLine(lengthRequested)
+                                     : QByteArray();
+      return myBuffer.size();
+    } else if (fd == STDIN) {
       // systemIO might be called from non-gui thread, so be threadsafe in
       // interacting with the ui.
       postToGUIThread([=] {
         SystemIOStatusManager::setStatusTimed("Waiting for user input...",
                                               99999999);
       });
-      while (myBuffer.size() < lengthRequested) {
-        // Lock the stdio objects and try to read from stdio. If no data is
-        // present, wait until so.
-        FileIOData::s_stdioMutex.lock();
+      // As with a stdin source, reads end after a newline, such that input
+      // pasted in bulk is consumed a line at a time.
+      while (lengthRequested > 0) {
         if (s_abortSyscall) {
-          FileIOData::s_stdioMutex.unlock();
           s_abortSyscall = false;
           postToGUIThread([=] { SystemIOStatusManager::clearStatus(); });
           return -1;
         }
-        auto readData = InputStream.read(lengthRequested).toUtf8();
-        myBuffer.append(readData);
-        lengthRequested -= readData.length();
+        FileIOData::receiveStdIn();
+        if (FileIOData::readStdIn(myBuffer, lengthRequested))
+          break;
 
         /** We spin on a wait condition with a timeout. The timeout is required
          * to ensure that we may observe any abort flags (ie. if execution is
          * stopped while waiting for IO */
-        FileIOData::s_stdinBufferEmpty.wait(&FileIOData::s_stdioMutex, 100);
-        FileIOData::s_stdioMutex.unlock();
-        if (myBuffer.endsWith('\n'))
-          break;
+        QMutexLocker lock(&FileIOData::s_stdioMutex);
+        if (FileIOData::s_stdinQueue.empty())
+          FileIOData::s_stdinBufferEmpty.wait(&FileIOData::s_stdioMutex, 100);
       }
     } else {
-      // Reads up to lengthRequested bytes of data from this Input stream into
-      // an array of bytes.
-      myBuffer = InputStream.read(lengthRequested).toUtf8();
+      // Reads up to lengthRequested bytes of data from this file into an
+      // array of bytes.
+      myBuffer.resize(std::max(lengthRequested, 0));
+      const qint64 read =
+          FileIOData::files.at(fd)->read(myBuffer.data(), myBuffer.size());
+      myBuffer.resize(std::max<qint64>(read, 0));
     }
 
     if (myBuffer.size() == 0) {
@@ -401,7 +491,7 @@ public:
     postToGUIThread([=] { SystemIOStatusManager::clearStatus(); });
     return myBuffer.size();
 
-  } // end readFromFile
+  } // end readFromFileLive
 
   /**
    * Write bytes to file.
@@ -415,55 +505,226 @@ public:
   static int writeToFile(int fd, const QString &myBuffer, int lengthRequested) {
     SystemIO::get(); // Ensure that SystemIO is constructed
     if (fd == STDOUT || fd == STDERR) {
-      emit get().doPrint(myBuffer);
+      printString(myBuffer);
       return myBuffer.size();
     }
 
-    if (!(FileIOData::fdInUse(fd, O_WRONLY) ||
-          FileIOData::fdInUse(fd,
-                              O_RDWR))) // Check the existence of the "write" fd
+    if (!FileIOData::writable(fd)) // Check the existence of the "write" fd
     {
       s_fileErrorString =
           "File descriptor " + QString::number(fd) + " is not open for writing";
       return -1;
     }
-    // retrieve FileOutputStream from storage
-    auto &outputStream = FileIOData::getStreamInUse(fd);
 
-    outputStream << myBuffer;
-    outputStream.flush();
+    const QByteArray data = myBuffer.toUtf8();
+    if (FileIOData::files.at(fd)->write(data.constData(), data.size()) < 0)
+      return -1;
     return lengthRequested;
 
   } // end writeToFile
 
+  /**
+   * @brief readToMemory
+   * Reads up to @p lengthRequested bytes from file @p fd into the memory of
+   * the simulator at @p address. Bytes of files are transferred directly from
+   * the mapping or buffer of the file. Otherwise behaves as readFromFile.
+   * @return number of bytes read, or -1 on error
+   */
+  static int readToMemory(int fd, AInt address, int lengthRequested);
+
+  /**
+   * @brief writeFromMemory
+   * Writes @p lengthRequested bytes from the memory of the simulator at
+   * @p address to file @p fd. Bytes are written to files unmodified.
+   * @return number of bytes written, or -1 on error
+   */
+  static int writeFromMemory(int fd, AInt address, int lengthRequested);
+
   /**
    * Close the file with specified file descriptor
    *
    * @param fd the file descriptor of an open file
    */
-  static void closeFile(int fd) { FileIOData::close(fd); }
+  static void closeFile(int fd) {
+    if (auto *context = SimulationContext::active())
+      context->fileClosed(fd);
+    FileIOData::close(fd);
+  }
+
+  /**
+   * @brief printString
+   * Prints @p string to the output of the simulated program. Output of a
+   * SimulationContext is captured by the context. Otherwise, the output is
+   * buffered and emitted through doPrint once per output interval, on the
+   * thread of SystemIO.
+   */
+  static void printString(const QString &string) {
+    if (auto *context = SimulationContext::active()) {
+      context->print(string);
+      return;
+    }
+    bool wasEmpty;
+    bool flush = false;
+    {
+      QMutexLocker lock(&s_outputMutex);
+      wasEmpty = s_pendingOutput.isEmpty();
+      s_pendingOutput += string;
+      if (s_pendingOutput.size() > s_maxPendingOutput) {
+        if (s_retainOutput)
+          flush = true;
+        else
+          s_pendingOutput.remove(0,
+                                 s_pendingOutput.size() - s_maxPendingOutput);
+      }
+    }
+    if (flush) {
+      flushOutput();
+      return;
+    }
+    // The first pending output schedules the emission of all output pending
+    // by then.
+    if (wasEmpty) {
+      auto &sio = get();
+      QMetaObject::invokeMethod(&sio, [&sio] {
+        if (!sio.m_outputTimer.isActive())
+          sio.m_outputTimer.start();
+      });
+    }
+  }
+
+  /// Emits all pending output through doPrint immediately. Must be called on
+  /// the thread of SystemIO, or on the simulating thread if output is retained.
+  static void flushOutput() {
+    QMutexLocker flushLock(&s_flushMutex);
+    QString output;
+    {
+      QMutexLocker lock(&s_outputMutex);
+      output = std::exchange(s_pendingOutput, QString());
+    }
+    if (!output.isEmpty())
+      emit get().doPrint(output);
+  }
+
+  /**
+   * @brief setRetainOutput
+   * If enabled, output pending beyond s_maxPendingOutput characters is flushed
+   * through doPrint by the printing thread instead of being discarded, such
+   * that receivers of doPrint must be connected directly. Enabled by headless
+   * runs, of which the output may be compared in full.
+   */
+  static void setRetainOutput(bool enabled) { s_retainOutput = enabled; }
 
-  static void printString(const QString &string) { emit get().doPrint(string); }
   static void reset() { FileIOData::resetFiles(); }
   static void abortSyscall() { s_abortSyscall = true; }
 
+  /**
+   * @brief setStdInSource
+   * Sets the source of console input of headless runs, such as a file, a pipe
+   * or an in-memory buffer. While set, reads of STDIN are served directly from
+   * @p source rather than waiting for console input, and an empty read
+   * signals EOF to the program. @p source is not owned, and nullptr reverts
+   * to console input.
+   */
+  static void setStdInSource(QIODevice *source) { s_stdinSource = source; }
+  static bool hasStdInSource() { return s_stdinSource != nullptr; }
+
+  /// State of an open (non-stdio) file descriptor.
+  struct FileState {
+    int fd;
+    QString name;
+    unsigned flags;
+    qint64 pos;
+  };
+
+  /**
+   * @brief openFiles
+   * @returns the state of all currently open, non-stdio file descriptors.
+   */
+  static std::vector<FileState> openFiles() {
+    std::vector<FileState> state;
+    for (const auto &it : FileIOData::fileNames) {
+      if (it.first < STDIO_END || it.second.isEmpty())
+        continue;
+      const auto file = FileIOData::files.find(it.first);
+      state.push_back({it.first, it.second, FileIOData::fileFlags[it.first],
+                       file != FileIOData::files.end() ? file->second->pos()
+                                                       : 0});
+    }
+    return state;
+  }
+
+  /**
+   * @brief restoreFiles
+   * Closes all open files, and reopens the files described by @p state at
+   * their recorded file descriptors and positions. Files are reopened without
+   * truncation. Returns false if any of the files could not be reopened.
+   */
+  static bool restoreFiles(const std::vector<FileState> &state) {
+    reset();
+    bool success = true;
+    for (const auto &file : state)
+      success &= restoreFile(file);
+    return success;
+  }
+
+  /**
+   * @brief restoreFile
+   * Reopens the file described by @p file at its recorded file descriptor and
+   * position, which must not be open. Returns false if the file could not be
+   * reopened.
+   */
+  static bool restoreFile(const FileState &file) {
+    if (file.fd < STDIO_END || file.fd >= SYSCALL_MAXFILES ||
+        FileIOData::files.count(file.fd) != 0)
+      return false;
+    FileIOData::fileNames[file.fd] = file.name;
+    FileIOData::fileFlags[file.fd] = file.flags & ~(O_TRUNC | O_EXCL);
+    try {
+      FileIOData::openFilestream(file.fd, file.name);
+      FileIOData::files.at(file.fd)->seek(file.pos);
+    } catch (const std::runtime_error &) {
+      FileIOData::files.erase(file.fd);
+      FileIOData::fileNames.erase(file.fd);
+      return false;
+    }
+    return true;
+  }
+
 signals:
+  /// Emitted with the output of the simulated program, in chunks of all output
+  /// printed since the previous emission.
   void doPrint(const QString &);
 
 public slots:
   /**
    * @brief putStdInData
-   * Pushes @p data onto the stdin buffer object
+   * Pushes @p data onto the console input, in a single operation regardless
+   * of its size, and wakes any read waiting for input. Must only be called
+   * from the GUI thread, being the single producer of console input.
    */
   void putStdInData(const QByteArray &data) {
-    FileIOData::s_stdioMutex.lock();
-    FileIOData::s_stdinBuffer.append(data);
+    if (data.isEmpty())
+      return;
+    FileIOData::s_stdinQueue.push(data);
+    // The mutex is only taken to not wake a read between its check of the
+    // queue and its wait.
+    QMutexLocker lock(&FileIOData::s_stdioMutex);
     FileIOData::s_stdinBufferEmpty.wakeAll();
-    FileIOData::s_stdioMutex.unlock();
   }
 
 private:
-  SystemIO() { reset(); }
+  SystemIO() {
+    // Output is emitted on the GUI thread, regardless of the thread which
+    // first accessed SystemIO.
+    if (QCoreApplication::instance())
+      moveToThread(QCoreApplication::instance()->thread());
+    m_outputTimer.setSingleShot(true);
+    m_outputTimer.setInterval(s_outputInterval);
+    connect(&m_outputTimer, &QTimer::timeout, this, [] { flushOutput(); });
+    reset();
+  }
+
+  QTimer m_outputTimer{this};
 };
 
 } // namespace Ripes
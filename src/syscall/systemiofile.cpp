@@ -0,0 +1,131 @@
+#include "systemiofile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+namespace Ripes {
+
+static constexpr std::align_val_t s_bufferAlignment{4096};
+
+void SystemIOFile::AlignedDelete::operator()(char *p) const {
+  ::operator delete(p, s_bufferAlignment);
+}
+
+bool SystemIOFile::open(QIODevice::OpenMode mode) {
+  const bool readOnly = (mode & QIODevice::ReadWrite) == QIODevice::ReadOnly;
+  // Read-only files are buffered by this class rather than by QFile.
+  if (!m_file.open(readOnly ? mode | QIODevice::Unbuffered : mode))
+    return false;
+  if (!readOnly) {
+    m_pos = m_file.pos();
+    return true;
+  }
+
+  if (const qint64 size = m_file.size(); size > 0) {
+    if (uchar *map = m_file.map(0, size)) {
+      m_map = reinterpret_cast<const char *>(map);
+      m_mapSize = size;
+      return true;
+    }
+  }
+  m_buffer.reset(
+      static_cast<char *>(::operator new(s_bufferSize, s_bufferAlignment)));
+  return true;
+}
+
+void SystemIOFile::close() {
+  if (m_map)
+    m_file.unmap(reinterpret_cast<uchar *>(const_cast<char *>(m_map)));
+  m_map = nullptr;
+  m_mapSize = 0;
+  m_buffer.reset();
+  m_bufferFill = 0;
+  m_file.close();
+  m_pos = 0;
+}
+
+bool SystemIOFile::seek(qint64 pos) {
+  if (pos < 0)
+    return false;
+  // Mapped and buffered files are positioned upon being read.
+  if (!m_map && !m_buffer && !m_file.seek(pos))
+    return false;
+  m_pos = pos;
+  return true;
+}
+
+bool SystemIOFile::fillBuffer() {
+  if (m_file.pos() != m_pos && !m_file.seek(m_pos))
+    return false;
+  m_bufferPos = m_pos;
+  m_bufferFill = m_file.read(m_buffer.get(), s_bufferSize);
+  if (m_bufferFill < 0) {
+    m_bufferFill = 0;
+    return false;
+  }
+  return true;
+}
+
+qint64 SystemIOFile::read(qint64 size, const ReadSink &sink) {
+  if (size <= 0)
+    return 0;
+
+  if (m_map) {
+    const qint64 bytes = std::clamp<qint64>(m_mapSize - m_pos, 0, size);
+    if (bytes > 0)
+      sink(m_map + m_pos, bytes);
+    m_pos += bytes;
+    return bytes;
+  }
+
+  if (m_buffer) {
+    qint64 read = 0;
+    while (read < size) {
+      if (m_pos < m_bufferPos || m_pos >= m_bufferPos + m_bufferFill) {
+        if (!fillBuffer())
+          return read == 0 ? -1 : read;
+        if (m_bufferFill == 0)
+          break; // End of file
+      }
+      const qint64 offset = m_pos - m_bufferPos;
+      const qint64 bytes = std::min(size - read, m_bufferFill - offset);
+      sink(m_buffer.get() + offset, bytes);
+      m_pos += bytes;
+      read += bytes;
+    }
+    return read;
+  }
+
+  // Files opened for writing are read in chunks through QFile.
+  char chunk[4096];
+  qint64 read = 0;
+  while (read < size) {
+    const qint64 bytes =
+        m_file.read(chunk, std::min<qint64>(sizeof(chunk), size - read));
+    if (bytes < 0)
+      return read == 0 ? -1 : read;
+    if (bytes == 0)
+      break;
+    sink(chunk, bytes);
+    read += bytes;
+  }
+  m_pos = m_file.pos();
+  return read;
+}
+
+qint64 SystemIOFile::read(char *data, qint64 size) {
+  return read(size, [&data](const char *chunk, qint64 bytes) {
+    std::memcpy(data, chunk, bytes);
+    data += bytes;
+  });
+}
+
+qint64 SystemIOFile::write(const char *data, qint64 size) {
+  const qint64 written = m_file.write(data, size);
+  if (written > 0)
+    m_pos = m_file.pos();
+  return written;
+}
+
+} // namespace Ripes
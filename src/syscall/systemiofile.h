@@ -0,0 +1,73 @@
+#pragma once
+
+#include <QFile>
+
+#include <functional>
+#include <memory>
+
+namespace Ripes {
+
+/**
+ * @brief The SystemIOFile class
+ * Binary backend of a file opened by a simulated program. Files opened for
+ * reading only are mapped into memory, if possible, such that reads are served
+ * directly from the mapping. Otherwise, reads of read-only files are served
+ * from a large read-ahead buffer, such that programs reading a few bytes at a
+ * time do not issue a system call per read. Files opened for writing are
+ * accessed through the buffering of QFile.
+ */
+class SystemIOFile {
+public:
+  /// Receives each chunk of @p size bytes read from the file.
+  using ReadSink = std::function<void(const char *data, qint64 size)>;
+
+  explicit SystemIOFile(const QString &name) : m_file(name) {}
+  ~SystemIOFile() { close(); }
+
+  bool open(QIODevice::OpenMode mode);
+  void close();
+
+  bool exists() const { return m_file.exists(); }
+  bool isOpen() const { return m_file.isOpen(); }
+  qint64 size() const { return m_file.size(); }
+  qint64 pos() const { return m_pos; }
+  bool seek(qint64 pos);
+
+  /// Reads up to @p size bytes into @p data. Returns the number of bytes read,
+  /// or -1 on error.
+  qint64 read(char *data, qint64 size);
+
+  /// Reads up to @p size bytes, passing them to @p sink in one or more chunks
+  /// without copying them into an intermediate buffer where possible. Returns
+  /// the number of bytes read, or -1 on error.
+  qint64 read(qint64 size, const ReadSink &sink);
+
+  /// Writes @p size bytes of @p data. Returns the number of bytes written, or
+  /// -1 on error.
+  qint64 write(const char *data, qint64 size);
+
+private:
+  static constexpr qint64 s_bufferSize = 1 << 16;
+
+  /// Refills the read-ahead buffer from the current position.
+  bool fillBuffer();
+
+  QFile m_file;
+  // Position of the file, as seen by the simulated program.
+  qint64 m_pos = 0;
+
+  // Mapping of the file, if mapped.
+  const char *m_map = nullptr;
+  qint64 m_mapSize = 0;
+
+  // Read-ahead buffer of unmapped, read-only files, holding the bytes of the
+  // file at [m_bufferPos : m_bufferPos + m_bufferFill[.
+  struct AlignedDelete {
+    void operator()(char *p) const;
+  };
+  std::unique_ptr<char, AlignedDelete> m_buffer;
+  qint64 m_bufferPos = 0;
+  qint64 m_bufferFill = 0;
+};
+
+} // namespace Ripes
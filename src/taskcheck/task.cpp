@@ -1,9 +1,36 @@
 #include "task.h"
 
-TestCase::TestCase(TestType testtype, std::string input, std::string output){
+#include <random>
+
+std::string InputGenerator::generate(unsigned index) const
+{
+    std::seed_seq seeds{seed, index};
+    std::mt19937_64 random(seeds);
+    unsigned size = index == 0 ? minSize : index == 1 ? maxSize
+                  : std::uniform_int_distribution<unsigned>(minSize, maxSize)(random);
+
+    std::vector<long long> edges = {minValue, maxValue};
+    for (const long long value : {0LL, 1LL, -1LL}){
+        if (value > minValue && value < maxValue){
+            edges.push_back(value);
+        }
+    }
+    std::uniform_int_distribution<long long> values(minValue, maxValue);
+    std::uniform_int_distribution<size_t> edge(0, edges.size() - 1);
+    std::bernoulli_distribution isEdge(edgeRate);
+
+    std::string input = sized ? std::to_string(size) + "\n" : std::string();
+    for (unsigned i = 0; i < size; i++){
+        input += std::to_string(isEdge(random) ? edges.at(edge(random)) : values(random)) + "\n";
+    }
+    return input;
+}
+
+TestCase::TestCase(TestType testtype, std::string input, std::string output, TestBudget budget){
     this->testtype = testtype;
     this->input = input;
     this->output = output;
+    this->budget = budget;
 }
 
 TestCase::~TestCase(){
@@ -25,12 +52,17 @@ TestType TestCase::getType() const
     return this->testtype;
 };
 
-Task::Task(unsigned int section, unsigned int number, std::string text, std::string name)
+const TestBudget &TestCase::getBudget() const
+{
+    return this->budget;
+}
+
+Task::Task(unsigned int section, unsigned int number, std::string name, std::string text)
 {
     this->section = section;
     this->number = number;
+    this->name = name;
     this->text = text;
-    this->text = name;
 }
 
 Task::~Task()
@@ -63,7 +95,37 @@ std::string Task::getText() const
     return this->text;
 }
 
-std::vector<TestCase> Task::getTests() const
+const std::vector<TestCase> &Task::getTests() const
 {
     return this->tests;
-}
\ No newline at end of file
+}
+
+void Task::setProcessor(Ripes::ProcessorID id)
+{
+    this->processor = id;
+}
+
+std::optional<Ripes::ProcessorID> Task::getProcessor() const
+{
+    return this->processor;
+}
+
+void Task::setReference(std::string reference)
+{
+    this->reference = reference;
+}
+
+std::string Task::getReference() const
+{
+    return this->reference;
+}
+
+void Task::setGenerator(InputGenerator generator)
+{
+    this->generator = generator;
+}
+
+const std::optional<InputGenerator> &Task::getGenerator() const
+{
+    return this->generator;
+}
@@ -2,24 +2,82 @@
 #include <vector>
 
 #pragma once
+
+#include <optional>
+
+#include "processorregistry.h"
+
 enum class TestType {
   returnValue,
   printValue
 };
 
+// Performance limits and targets of a test case, measured on the processor of
+// its task. A test exceeding a limit fails, and runs exceeding the cycle,
+// instruction or cache miss limits are aborted early. Targets score the
+// performance of a passing test. Limits and targets of 0 are not applied.
+struct TestBudget {
+	long long maxCycles = 0;
+	long long maxInstructions = 0;
+	double maxCPI = 0;
+	long long maxCacheMisses = 0;
+
+	long long targetCycles = 0;
+	long long targetInstructions = 0;
+	double targetCPI = 0;
+	long long targetCacheMisses = 0;
+
+	// Geometry (as log2 values, see CachePreset) of the LRU data cache whose
+	// misses are counted.
+	int cacheBlocks = 2;
+	int cacheLines = 5;
+	int cacheWays = 0;
+
+	bool countsCacheMisses() const { return maxCacheMisses != 0 || targetCacheMisses != 0; }
+	bool isScored() const {
+		return targetCycles != 0 || targetInstructions != 0 || targetCPI != 0 || targetCacheMisses != 0;
+	}
+};
+
+// Generator of random test inputs of a task, whose expected results are those
+// of the reference solution of the task on the same inputs. Each input is a
+// list of integers, one per line, preceded by their number if sized. Values
+// are drawn uniformly from [minValue; maxValue], except for a share edgeRate
+// of edge values: the bounds, and 0, 1 and -1 within the bounds. The first two
+// inputs are of minSize and maxSize values, and the others of a uniformly
+// drawn size.
+struct InputGenerator {
+	unsigned count = 0;
+	unsigned seed = 1;
+	TestType type = TestType::printValue;
+	bool sized = true;
+	unsigned minSize = 1;
+	unsigned maxSize = 16;
+	long long minValue = -1000;
+	long long maxValue = 1000;
+	double edgeRate = 0.1;
+	// Budget of each generated input.
+	TestBudget budget;
+
+	// Returns generated input index, which only depends on the seed and index.
+	std::string generate(unsigned index) const;
+};
+
 class TestCase {
 
 public:
-	TestCase(TestType testtype, std::string input, std::string output);
+	TestCase(TestType testtype, std::string input, std::string output, TestBudget budget = TestBudget());
 	~TestCase();
 	std::string getInput() const;
 	std::string getOutput() const;
 	TestType getType() const;
+	const TestBudget &getBudget() const;
 
 private:
 	TestType testtype;
 	std::string input;
 	std::string output;
+	TestBudget budget;
 };
 
 class Task {
@@ -32,7 +90,19 @@ public:
 	unsigned int getSection() const;
 	std::string getName() const;
 	std::string getText() const;
-	std::vector<TestCase> getTests() const;
+	const std::vector<TestCase> &getTests() const;
+	// The processor on which the tests are run. Defaults to the current
+	// processor.
+	void setProcessor(Ripes::ProcessorID id);
+	std::optional<Ripes::ProcessorID> getProcessor() const;
+	// Assembly of a reference solution, whose console output the output of a
+	// graded program must follow while both run. Empty if the task has none.
+	void setReference(std::string reference);
+	std::string getReference() const;
+	// Generated inputs, checked in addition to the tests of the task. Requires
+	// a reference solution.
+	void setGenerator(InputGenerator generator);
+	const std::optional<InputGenerator> &getGenerator() const;
 	
 private:
 	unsigned int number;
@@ -40,5 +110,8 @@ private:
 	std::string name;
 	std::string text;
 	std::vector<TestCase> tests;
+	std::optional<Ripes::ProcessorID> processor;
+	std::string reference;
+	std::optional<InputGenerator> generator;
 
 };
\ No newline at end of file
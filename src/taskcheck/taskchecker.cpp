@@ -1,12 +1,43 @@
 #include <algorithm>
 
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QMetaEnum>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QThreadPool>
+
 #include "taskchecker.h"
 #include "taskinit.h"
+#include "assembler/assembler.h"
+#include "binutils.h"
+#include "cachesim/cachesweep.h"
+#include "io/iomanager.h"
+#include "isa/rvisainfo_common.h"
+#include "processorhandler.h"
+#include "processorpool.h"
+
+static std::string percentage(double fraction)
+{
+    return QString::number(fraction * 100, 'f', 0).toStdString() + "%";
+}
+
+QString TaskChecker::cataloguePath;
+QString TaskChecker::resultCacheDirectory;
+std::mutex TaskChecker::resultCacheMutex;
+TaskChecker::ResultCacheList TaskChecker::resultCacheLru;
+std::unordered_map<std::string, TaskChecker::ResultCacheList::iterator> TaskChecker::resultCache;
+size_t TaskChecker::resultCacheEntries = TaskChecker::s_resultCacheEntries;
 
 TaskChecker::TaskChecker()
 {
-    setTasks();
-    setSections();
+    loadCatalogue(cataloguePath.isEmpty() ? defaultTaskCataloguePath : cataloguePath);
+}
+
+TaskChecker::TaskChecker(const QString &cataloguePath)
+{
+    loadCatalogue(cataloguePath);
 }
 
 TaskChecker::~TaskChecker()
@@ -16,77 +47,577 @@ TaskChecker::~TaskChecker()
 
 std::string TaskChecker::checkTask(QString program, unsigned int section, unsigned int number)
 {
-    auto check = [section, number](const Task& task) {
-        return section == task.getSection() && number == task.getNumber();
-    };
-    auto taskIt = find_if(this->tasks.begin(), this->tasks.end(), check);
-
-    if (taskIt !=  tasks.end() ){
-        bool passed = true;
-        std::string curAnswer;
-        auto testIt = taskIt->getTests().begin();
-
-        while(testIt != taskIt->getTests().end() && passed){
-	    TestCase test = (*testIt);
-            if(test.getType() == TestType::returnValue){
-                passed = checkReturnVal(program, test.getInput(), test.getOutput(), curAnswer);
-            } else {
-                passed = checkPrintVal(program, test.getInput(), test.getOutput(), curAnswer);
-            }
-            testIt++;
-        }
-        return curAnswer;
+    Task *task = findTask(section, number);
+    if (task != nullptr){
+        return checkTask(program, *task);
     }
     return "No task with these numbers\n";
 }
 
-void TaskChecker::setTasks()
+std::string TaskChecker::checkTask(QString program, const Task &task)
+{
+    cancelled = false;
+    const std::string key = resultKey(program, task);
+    {
+        std::lock_guard<std::mutex> lock(resultCacheMutex);
+        if (const std::string *cached = cachedResult(key)){
+            return *cached;
+        }
+        QFile file(QDir(resultCacheDirectory).filePath(QString::fromStdString(key) + ".txt"));
+        if (!resultCacheDirectory.isEmpty() && file.open(QIODevice::ReadOnly)){
+            return cacheResult(key, file.readAll().toStdString());
+        }
+    }
+
+    const std::string answer = gradeTask(program, task);
+    if (cancelled){
+        return answer;
+    }
+    std::lock_guard<std::mutex> lock(resultCacheMutex);
+    cacheResult(key, answer);
+    if (!resultCacheDirectory.isEmpty()){
+        // Written through a temporary file, such that concurrent graders never
+        // read a partially written report.
+        QSaveFile file(QDir(resultCacheDirectory).filePath(QString::fromStdString(key) + ".txt"));
+        if (file.open(QIODevice::WriteOnly)){
+            file.write(QByteArray::fromStdString(answer));
+            file.commit();
+        }
+    }
+    return answer;
+}
+
+std::string TaskChecker::resultKey(const QString &program, const Task &task) const
+{
+    // Submissions differing only in indentation, trailing whitespace or blank
+    // lines are graded alike.
+    QStringList lines;
+    for (const QString &line : program.split(QRegularExpression("\\r?\\n"))){
+        if (!line.trimmed().isEmpty()){
+            lines << line.trimmed();
+        }
+    }
+    const Ripes::ProcessorID id = task.getProcessor().value_or(Ripes::ProcessorHandler::getID());
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(lines.join("\n").toUtf8());
+    hash.addData(QString("\n%1.%2\n%3\n%4\n%5")
+                     .arg(task.getSection())
+                     .arg(task.getNumber())
+                     .arg(QMetaEnum::fromType<Ripes::ProcessorID>().valueToKey(id))
+                     .arg(Ripes::ProcessorHandler::currentISA()->enabledExtensions().join(","))
+                     .arg(QString::fromStdString(catalogue.version))
+                     .toUtf8());
+    return hash.result().toHex().toStdString();
+}
+
+std::string TaskChecker::gradeTask(QString program, const Task &task)
+{
+    const auto check = prepareCheck(program, task);
+    if (!check->error.empty()){
+        return check->error;
+    }
+    QThreadPool pool;
+    for (size_t i = 0; i < check->contexts.size(); i++){
+        pool.start([&, i] { runCheckTest(*check, i); });
+    }
+    pool.waitForDone();
+    return checkReport(*check);
+}
+
+std::unique_ptr<TaskChecker::Check> TaskChecker::prepareCheck(const QString &program, const Task &task)
+{
+    auto check = std::make_unique<Check>();
+    check->task = &task;
+    // Checks assemble with an assembler of their own, such that they may run
+    // alongside the assembly of the editor.
+    const Ripes::ProcessorID id = task.getProcessor().value_or(Ripes::ProcessorHandler::getID());
+    const QStringList extensions = Ripes::ProcessorHandler::currentISA()->enabledExtensions();
+    auto processor = Ripes::ProcessorPool::get().acquire(id, extensions);
+    const auto isa = processor->fullISA();
+    Ripes::ProcessorPool::get().release(id, extensions, std::move(processor));
+    if (!assembler || assembler->getISA() != isa->isaID()){
+        assembler = Ripes::Assembler::constructAssemblerDynamic(isa);
+        // Reference solutions are assembled for every check.
+        assembler->setProgramCaching(true);
+    }
+    auto res = assembler->assembleRaw(program, &Ripes::IOManager::get().assemblerSymbols());
+    if (res.errors.size() != 0){
+        check->error = "No check for program with syntax errors\n";
+        return check;
+    }
+    const auto assembled = std::make_shared<Ripes::Program>(res.program);
+    std::shared_ptr<Ripes::Program> reference;
+    if (!task.getReference().empty()){
+        auto referenceRes = assembler->assembleRaw(
+            QString::fromStdString(task.getReference()), &Ripes::IOManager::get().assemblerSymbols());
+        if (referenceRes.errors.size() != 0){
+            check->error = "No check for task with a reference solution with syntax errors\n";
+            return check;
+        }
+        reference = std::make_shared<Ripes::Program>(referenceRes.program);
+    }
+
+    const std::vector<TestCase> &tests = task.getTests();
+    check->references.resize(tests.size());
+    for (size_t i = 0; i < tests.size(); i++){
+        check->contexts.push_back(std::make_unique<Ripes::SimulationContext>(id, extensions));
+        check->contexts.back()->loadProgram(std::make_shared<Ripes::Program>(*assembled));
+        check->contexts.back()->setLimits(s_limits);
+        if (reference){
+            check->references.at(i) = std::make_unique<Ripes::SimulationContext>(id, extensions);
+            check->references.at(i)->setLimits(s_limits);
+            check->references.at(i)->loadProgram(std::make_shared<Ripes::Program>(*reference));
+        }
+    }
+    // Generated inputs are checked as one more test, whose contexts are reset
+    // to their loaded program for each input rather than reloaded.
+    const auto &generator = task.getGenerator();
+    if (reference && generator && generator->count != 0){
+        check->contexts.push_back(std::make_unique<Ripes::SimulationContext>(id, extensions));
+        check->contexts.back()->loadProgram(std::make_shared<Ripes::Program>(*assembled));
+        check->contexts.back()->setLimits(s_limits);
+        check->references.push_back(std::make_unique<Ripes::SimulationContext>(id, extensions));
+        check->references.back()->setLimits(s_limits);
+        check->references.back()->loadProgram(std::make_shared<Ripes::Program>(*reference));
+    }
+    check->answers.resize(check->contexts.size());
+    check->passed.resize(check->contexts.size());
+    check->scores.resize(check->contexts.size());
+    return check;
+}
+
+void TaskChecker::runCheckTest(Check &check, size_t i) const
 {
-    this->tasks = createTaskList();
+    const std::vector<TestCase> &tests = check.task->getTests();
+    std::string &answer = check.answers.at(i);
+    TestRun run;
+    if (cancelled){
+        answer = "cancelled";
+    } else if (i == tests.size()){
+        check.passed.at(i) = runGeneratedTests(check, answer);
+    } else if (runTest(*check.contexts.at(i), check.references.at(i).get(), tests.at(i), run, answer)){
+        const TestCase &test = tests.at(i);
+        auto &context = *check.contexts.at(i);
+        bool passed;
+        if(test.getType() == TestType::returnValue){
+            passed = checkReturnVal(context, test.getOutput(), answer);
+        } else {
+            passed = checkPrintVal(context, test.getOutput(), answer);
+        }
+        if (passed){
+            passed = checkBudget(test.getBudget(), run, answer, check.scores.at(i));
+        }
+        check.passed.at(i) = passed;
+    }
+    if (testObserver){
+        testObserver(i, check.contexts.size(), answer);
+    }
 }
 
-void TaskChecker::setSections()
+// Returns input as a line, abbreviated if long.
+static std::string describeInput(const std::string &input)
 {
-    this->sections = createSectionNames();
+    constexpr int maxLength = 60;
+    QString line = QString::fromStdString(input).simplified();
+    if (line.size() > maxLength){
+        line = line.left(maxLength) + "...";
+    }
+    return line.toStdString();
 }
 
-bool TaskChecker::checkPrintVal(QString program, std::string input, std::string output, std::string &answer)
+bool TaskChecker::runGeneratedTests(Check &check, std::string &answer) const
 {
-    answer = "tests havent been implemented yet \n";
+    const InputGenerator &generator = *check.task->getGenerator();
+    const size_t i = check.task->getTests().size();
+    auto &context = *check.contexts.at(i);
+    auto &reference = *check.references.at(i);
+    unsigned passed = 0;
+    unsigned skipped = 0;
+    for (unsigned index = 0; index < generator.count && !cancelled; index++){
+        // The expected result of an input is that of the reference solution.
+        // Both programs restart from their loaded state for each input.
+        const std::string input = generator.generate(index);
+        reference.reset();
+        reference.clearOutput();
+        reference.clearStdIn();
+        reference.putStdInData(QByteArray::fromStdString(input));
+        const bool referenceFinished = reference.run(s_maxCycles);
+        std::optional<long long> expectedValue;
+        if (referenceFinished && generator.type == TestType::returnValue){
+            expectedValue = returnValue(reference);
+        }
+        if (!referenceFinished || (generator.type == TestType::returnValue && !expectedValue)){
+            skipped++;
+            continue;
+        }
+        const std::string expected = generator.type == TestType::returnValue
+                                         ? std::to_string(*expectedValue)
+                                         : reference.output().toStdString();
+
+        context.reset();
+        context.clearOutput();
+        context.clearStdIn();
+        const TestCase test(generator.type, input, expected, generator.budget);
+        TestRun run;
+        std::string result;
+        double score = 0;
+        bool ok = runTest(context, nullptr, test, run, result);
+        if (ok){
+            ok = generator.type == TestType::returnValue ? checkReturnVal(context, expected, result)
+                                                         : checkPrintVal(context, expected, result);
+        }
+        if (ok){
+            ok = checkBudget(generator.budget, run, result, score);
+        }
+        if (!ok && !cancelled){
+            answer = "failed on generated input " + std::to_string(index + 1) + " of " +
+                     std::to_string(generator.count) + " (" + describeInput(input) + "): " + result;
+            return false;
+        }
+        passed++;
+    }
+    if (cancelled){
+        answer = "cancelled";
+        return false;
+    }
+    answer = "passed, " + std::to_string(passed) + " generated inputs";
+    if (skipped != 0){
+        answer += " (" + std::to_string(skipped) + " skipped, on which the reference solution failed)";
+    }
     return true;
 }
 
-bool TaskChecker::checkReturnVal(QString program, std::string input, std::string output, std::string &answer)
+std::string TaskChecker::checkReport(const Check &check) const
+{
+    if (!check.error.empty()){
+        return check.error;
+    }
+    const std::vector<TestCase> &tests = check.task->getTests();
+    std::string answer;
+    size_t passedTests = 0;
+    size_t scoredTests = 0;
+    double score = 0;
+    for (size_t i = 0; i < check.answers.size(); i++){
+        passedTests += check.passed[i];
+        // Generated inputs are not scored.
+        if (i < tests.size() && tests.at(i).getBudget().isScored()){
+            scoredTests++;
+            score += check.scores[i];
+        }
+        answer += "Test " + std::to_string(i + 1) + ": " + check.answers[i] + "\n";
+    }
+    answer += std::to_string(passedTests) + " of " + std::to_string(check.answers.size()) + " tests passed\n";
+    if (scoredTests != 0){
+        answer += "Performance score: " + percentage(score / scoredTests) + "\n";
+    }
+    if (cancelled){
+        answer += "Check cancelled\n";
+    }
+    return answer;
+}
+
+void TaskChecker::setTestObserver(TestObserver observer)
+{
+    testObserver = observer;
+}
+
+void TaskChecker::cancel()
+{
+    cancelled = true;
+}
+
+void TaskChecker::setCataloguePath(const QString &path)
+{
+    cataloguePath = path;
+}
+
+void TaskChecker::setResultCacheDirectory(const QString &path)
+{
+    std::lock_guard<std::mutex> lock(resultCacheMutex);
+    resultCacheDirectory = path;
+    if (!path.isEmpty()){
+        QDir().mkpath(path);
+    }
+}
+
+void TaskChecker::setResultCacheEntries(size_t entries)
+{
+    std::lock_guard<std::mutex> lock(resultCacheMutex);
+    resultCacheEntries = std::max<size_t>(entries, 1);
+    while (resultCacheLru.size() > resultCacheEntries){
+        resultCache.erase(resultCacheLru.back().first);
+        resultCacheLru.pop_back();
+    }
+}
+
+size_t TaskChecker::cachedResults()
+{
+    std::lock_guard<std::mutex> lock(resultCacheMutex);
+    return resultCacheLru.size();
+}
+
+const std::string *TaskChecker::cachedResult(const std::string &key)
+{
+    auto it = resultCache.find(key);
+    if (it == resultCache.end()){
+        return nullptr;
+    }
+    resultCacheLru.splice(resultCacheLru.begin(), resultCacheLru, it->second);
+    return &it->second->second;
+}
+
+const std::string &TaskChecker::cacheResult(const std::string &key, const std::string &answer)
+{
+    if (auto it = resultCache.find(key); it != resultCache.end()){
+        resultCacheLru.erase(it->second);
+        resultCache.erase(it);
+    }
+    resultCacheLru.emplace_front(key, answer);
+    resultCache[key] = resultCacheLru.begin();
+    while (resultCacheLru.size() > resultCacheEntries){
+        resultCache.erase(resultCacheLru.back().first);
+        resultCacheLru.pop_back();
+    }
+    return resultCacheLru.front().second;
+}
+
+void TaskChecker::loadCatalogue(const QString &path)
+{
+    QString errorMessage;
+    if (!loadTaskCatalogue(path, catalogue, errorMessage)){
+        qWarning() << errorMessage;
+    }
+}
+
+const std::string &TaskChecker::getCatalogueVersion() const
+{
+    return catalogue.version;
+}
+
+TaskChecker::Grade TaskChecker::parseGrade(const std::string &report)
+{
+    // Reports are cached as text, and are thus summarized from their last
+    // lines.
+    Grade grade;
+    const QString text = QString::fromStdString(report);
+    const auto tests = QRegularExpression("^(\\d+) of (\\d+) tests passed$",
+                                          QRegularExpression::MultilineOption).match(text);
+    if (tests.hasMatch()){
+        grade.passed = tests.captured(1).toUInt();
+        grade.tests = tests.captured(2).toUInt();
+    }
+    const auto score = QRegularExpression("^Performance score: (\\d+)%$",
+                                          QRegularExpression::MultilineOption).match(text);
+    if (score.hasMatch()){
+        grade.score = score.captured(1).toDouble() / 100;
+    }
+    return grade;
+}
+
+double TaskChecker::TestRun::cpi() const
+{
+    return instructions == 0 ? 0 : static_cast<double>(cycles) / instructions;
+}
+
+bool TaskChecker::runTest(Ripes::SimulationContext &context, Ripes::SimulationContext *reference, const TestCase &test, TestRun &run, std::string &answer) const
+{
+    const TestBudget &budget = test.getBudget();
+    auto *processor = context.processor();
+    std::optional<Ripes::CacheSweep> cache;
+    if (budget.countsCacheMisses()){
+        cache.emplace(Ripes::log2Ceil(processor->implementsISA()->bytes()),
+                      Ripes::CacheSweep::Range{budget.cacheBlocks, budget.cacheBlocks},
+                      Ripes::CacheSweep::Range{budget.cacheLines, budget.cacheLines},
+                      Ripes::CacheSweep::Range{budget.cacheWays, budget.cacheWays});
+    }
+    long long maxCycles = budget.maxCycles != 0 ? std::min(budget.maxCycles, s_maxCycles) : s_maxCycles;
+
+    const QByteArray input = QByteArray::fromStdString(test.getInput());
+    context.putStdInData(input);
+    // Cache misses are counted per batch of cycles, and thus abort the run
+    // within a batch of exceeding their limit.
+    const auto exceeded = [&] {
+        return cancelled || processor->getCycleCount() >= maxCycles ||
+               (budget.maxInstructions != 0 &&
+                processor->getInstructionsRetired() >= budget.maxInstructions) ||
+               (budget.maxCacheMisses != 0 && run.cacheMisses > budget.maxCacheMisses);
+    };
+    const auto observer = [&] {
+        if (!cache){
+            return;
+        }
+        for (const auto &record : processor->clockBatch()){
+            if (record.dataAccess.type != Ripes::MemoryAccess::None){
+                cache->access(record.dataAccess.address);
+            }
+        }
+        run.cacheMisses = cache->results().front().misses;
+    };
+
+    bool finished;
+    if (!reference){
+        finished = context.runUntil(exceeded, observer);
+    } else {
+        // The program runs in slices of s_lockstepCycles cycles, after each of
+        // which the reference solution runs until its output covers that of
+        // the program. The run stops at the first diverging character.
+        reference->putStdInData(input);
+        auto *referenceProcessor = reference->processor();
+        const QString &output = context.output();
+        const QString &expected = reference->output();
+        bool referenceFinished = false;
+        qsizetype compared = 0;
+        for (;;){
+            const long long sliceEnd = processor->getCycleCount() + s_lockstepCycles;
+            finished = context.runUntil(
+                [&] { return exceeded() || processor->getCycleCount() >= sliceEnd || output.size() > compared; },
+                observer);
+            // Otherwise the program stopped at a failing system call.
+            const bool resumable = processor->getCycleCount() >= sliceEnd || output.size() > compared;
+            if (!referenceFinished){
+                referenceFinished = reference->runUntil([&] {
+                    return cancelled || referenceProcessor->getCycleCount() >= s_maxCycles ||
+                           (expected.size() >= output.size() &&
+                            referenceProcessor->getCycleCount() >= processor->getCycleCount());
+                });
+                // The program may take a multiple of the cycles of the
+                // reference solution.
+                if (referenceFinished){
+                    maxCycles = std::min(maxCycles, s_referenceCycleFactor * referenceProcessor->getCycleCount() + s_lockstepCycles);
+                }
+            }
+            for (; compared < output.size(); compared++){
+                // As for the final output, trailing whitespace is not significant.
+                if (compared >= expected.size() ? !output.at(compared).isSpace()
+                                                : output.at(compared) != expected.at(compared)){
+                    answer = "failed, the output diverges from the reference solution after " +
+                             std::to_string(compared) + " characters";
+                    return false;
+                }
+            }
+            if (finished || exceeded() || !resumable){
+                break;
+            }
+        }
+    }
+    run.cycles = processor->getCycleCount();
+    run.instructions = processor->getInstructionsRetired();
+    if (finished){
+        return true;
+    }
+
+    const auto limit = context.limitExceeded();
+    if (cancelled){
+        answer = "cancelled";
+    } else if (limit != Ripes::SimulationContext::Limit::None && limit != Ripes::SimulationContext::Limit::Cycles){
+        answer = "failed, the program exceeded " + context.describeLimit(limit).toStdString();
+    } else if (budget.maxCacheMisses != 0 && run.cacheMisses > budget.maxCacheMisses){
+        answer = "failed, the program exceeded the budget of " + std::to_string(budget.maxCacheMisses) + " cache misses";
+    } else if (budget.maxInstructions != 0 && run.instructions >= budget.maxInstructions){
+        answer = "failed, the program exceeded the budget of " + std::to_string(budget.maxInstructions) + " instructions";
+    } else if (run.cycles >= maxCycles){
+        answer = "failed, the program did not finish within " + std::to_string(maxCycles) + " cycles";
+    } else {
+        answer = "failed, the program stopped at a failing system call";
+    }
+    return false;
+}
+
+bool TaskChecker::checkBudget(const TestBudget &budget, const TestRun &run, std::string &answer, double &score)
 {
-    answer = "tests havent been implemented yet \n";
+    answer += ", " + std::to_string(run.cycles) + " cycles, " + std::to_string(run.instructions) +
+              " instructions, CPI " + QString::number(run.cpi(), 'f', 2).toStdString();
+    if (budget.countsCacheMisses()){
+        answer += ", " + std::to_string(run.cacheMisses) + " cache misses";
+    }
+    if (budget.maxCPI != 0 && run.cpi() > budget.maxCPI){
+        answer += "; failed, CPI exceeds the budget of " + QString::number(budget.maxCPI, 'f', 2).toStdString();
+        return false;
+    }
+
+    // Each target scores the ratio of the target to the measured value, up to
+    // a full score for meeting the target.
+    double total = 0;
+    unsigned targets = 0;
+    const auto addTarget = [&](double target, double actual) {
+        if (target == 0){
+            return;
+        }
+        targets++;
+        total += actual <= target ? 1 : target / actual;
+    };
+    addTarget(budget.targetCycles, run.cycles);
+    addTarget(budget.targetInstructions, run.instructions);
+    addTarget(budget.targetCPI, run.cpi());
+    addTarget(budget.targetCacheMisses, run.cacheMisses);
+    if (targets != 0){
+        score = total / targets;
+        answer += "; score " + percentage(score);
+    }
     return true;
 }
 
+static bool compareVal(const std::string &expected, const std::string &actual, std::string &answer)
+{
+    if (expected == actual){
+        answer = "passed";
+        return true;
+    }
+    answer = "failed, expected '" + expected + "' but got '" + actual + "'";
+    return false;
+}
+
+bool TaskChecker::checkPrintVal(Ripes::SimulationContext &context, std::string output, std::string &answer)
+{
+    // Trailing whitespace of the output is not significant.
+    return compareVal(QString::fromStdString(output).trimmed().toStdString(),
+                      context.output().trimmed().toStdString(), answer);
+}
+
+std::optional<long long> TaskChecker::returnValue(const Ripes::SimulationContext &context)
+{
+    const auto *processor = context.processor();
+    const auto reg = processor->implementsISA()->syscallArgReg(0);
+    if (!reg.has_value()){
+        return {};
+    }
+    const Ripes::VInt raw = processor->getRegister(Ripes::RVISA::GPR, *reg);
+    // Return values are compared as signed values of the register width.
+    return processor->implementsISA()->bits() == 32 ? static_cast<int32_t>(raw)
+                                                    : static_cast<int64_t>(raw);
+}
+
+bool TaskChecker::checkReturnVal(Ripes::SimulationContext &context, std::string output, std::string &answer)
+{
+    const auto value = returnValue(context);
+    if (!value){
+        answer = "failed, the processor has no return value register";
+        return false;
+    }
+    return compareVal(QString::fromStdString(output).trimmed().toStdString(),
+                      std::to_string(*value), answer);
+}
+
 unsigned int TaskChecker::getSectionNum() const{
-    return sections.size();
+    return catalogue.sections.size();
 }
 
 std::vector<unsigned int> TaskChecker::getSectionTasks(unsigned int section) const
 {
     std::vector<unsigned int> sectionTaskNums;
-    for (const Task& task : tasks){
-        if(task.getSection() == section){
-            sectionTaskNums.push_back(task.getNumber());
-        }
+    // Tasks are ordered by section, and then by number.
+    auto it = catalogue.tasks.lower_bound(std::make_pair(section, 0u));
+    for (; it != catalogue.tasks.end() && it->first.first == section; it++){
+        sectionTaskNums.push_back(it->first.second);
     }
     return sectionTaskNums;
 }
 
 Task* TaskChecker::findTask(unsigned int section, unsigned int number)
 {
-     auto check = [section, number](const Task& task) {
-        return section == task.getSection() && number == task.getNumber();
-    };
-
-    auto taskIt = find_if(this->tasks.begin(), this->tasks.end(), check);
-
-    if (taskIt != tasks.end()){
-        return &(*taskIt);
+    auto taskIt = catalogue.tasks.find(std::make_pair(section, number));
+    if (taskIt != catalogue.tasks.end()){
+        return &taskIt->second;
     }
-    return nullptr;    
+    return nullptr;
 }
@@ -1,21 +1,148 @@
+#pragma once
+
 #include <QString>
+#include <atomic>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include "assembler/assemblerbase.h"
 #include "task.h"
+#include "taskinit.h"
+#include "simulationcontext.h"
 class TaskChecker {
 
 public:
+	// Loads the catalogue at the path set by setCataloguePath, or the bundled
+	// catalogue.
 	TaskChecker();
+	TaskChecker(const QString &cataloguePath);
 	~TaskChecker();
+	// Sets the path of the catalogue loaded by TaskCheckers, given at startup.
+	static void setCataloguePath(const QString &path);
+	// Sets the directory in which reports are persisted, such that identical
+	// submissions are graded once across runs and processes of Ripes. Reports
+	// are cached in memory regardless.
+	static void setResultCacheDirectory(const QString &path);
+	// Sets the number of reports cached in memory, beyond which the least
+	// recently used reports are evicted. Defaults to s_resultCacheEntries.
+	static void setResultCacheEntries(size_t entries);
+	static size_t cachedResults();
+	// Returns the key identifying the grading of program for task: a hash of
+	// the normalized program, the task, the processor and the catalogue version.
+	std::string resultKey(const QString &program, const Task &task) const;
 	std::string checkTask(QString program, unsigned int section, unsigned int number);
+	// Assembles the program once, and runs each test of the task in its own
+	// headless simulation of the processor of the task. Tests run in parallel, each
+	// in lockstep with the reference solution of the task if it has one.
+	std::string checkTask(QString program, const Task &task);
+	// Called with the index and answer of each test of checkTask as it
+	// completes, from the thread running the test. Not called for cached
+	// reports.
+	using TestObserver = std::function<void(size_t test, size_t tests, const std::string &answer)>;
+	void setTestObserver(TestObserver observer);
+	// A check of a program against the tests of a task, for running the tests
+	// of many checks on a shared set of threads. Checks are prepared on the
+	// calling thread by prepareCheck, after which each test may be run by
+	// runCheckTest on any thread. The checked task must outlive the check. A
+	// task with generated inputs has one more test, following its tests, which
+	// checks the generated inputs.
+	struct Check {
+		const Task *task = nullptr;
+		// The report of a program which cannot be checked, such as a program
+		// with syntax errors. No tests are run if set.
+		std::string error;
+		std::vector<std::unique_ptr<Ripes::SimulationContext>> contexts;
+		std::vector<std::unique_ptr<Ripes::SimulationContext>> references;
+		std::vector<std::string> answers;
+		std::vector<char> passed;
+		std::vector<double> scores;
+	};
+	std::unique_ptr<Check> prepareCheck(const QString &program, const Task &task);
+	void runCheckTest(Check &check, size_t test) const;
+	// Returns the report of a check whose tests have all been run.
+	std::string checkReport(const Check &check) const;
+	// Stops a checkTask in progress on another thread. The remaining tests are
+	// reported as cancelled, and the report is not cached.
+	void cancel();
 	unsigned int getSectionNum() const;
 	std::vector<unsigned int> getSectionTasks(unsigned int section) const;
 	Task* findTask(unsigned int section, unsigned int number);
+	const std::string &getCatalogueVersion() const;
+
+	// Summary of a report of checkTask.
+	struct Grade {
+		unsigned int passed = 0;
+		unsigned int tests = 0;
+		// Mean performance score of the scored tests, in [0; 1].
+		std::optional<double> score;
+	};
+	static Grade parseGrade(const std::string &report);
+
+	// Maximum number of cycles of a test, after which the test fails.
+	static constexpr long long s_maxCycles = 1000000;
+	// Cycles of a program between comparisons of its output to that of the
+	// reference solution of its task.
+	static constexpr long long s_lockstepCycles = 1024;
+	// A program may take this many times the cycles of the reference solution
+	// (plus a slice), after which the test fails.
+	static constexpr long long s_referenceCycleFactor = 10;
+	// Resource limits of each simulated program, such that no submission can
+	// exhaust the memory or files of the grading process.
+	static constexpr Ripes::SimulationContext::Limits s_limits{s_maxCycles, 1024, 8, 64 * 1024};
+	// Default number of reports cached in memory. Grading workers are long
+	// lived, such that the cache must be bounded.
+	static constexpr size_t s_resultCacheEntries = 4096;
 private:
-	std::vector<Task> tasks;
-	std::vector<std::string> sections;
+	TaskCatalogue catalogue;
+	static QString cataloguePath;
+	static QString resultCacheDirectory;
+	static std::mutex resultCacheMutex;
+	// Cached reports by key, in order of use, the most recently used first.
+	using ResultCacheList = std::list<std::pair<std::string, std::string>>;
+	static ResultCacheList resultCacheLru;
+	static std::unordered_map<std::string, ResultCacheList::iterator> resultCache;
+	static size_t resultCacheEntries;
+	// Returns the cached report of key, if any. Must hold resultCacheMutex.
+	static const std::string *cachedResult(const std::string &key);
+	// Caches answer as the report of key. Must hold resultCacheMutex.
+	static const std::string &cacheResult(const std::string &key, const std::string &answer);
+	TestObserver testObserver;
+	std::atomic<bool> cancelled = false;
+	// Assembler of the ISA of the latest graded task.
+	std::shared_ptr<Ripes::Assembler::AssemblerBase> assembler;
+
+	// Grades program without consulting the result cache.
+	std::string gradeTask(QString program, const Task &task);
 
-	void setTasks();
-	void setSections();
-	bool checkPrintVal(QString program, std::string input, std::string output, std::string &answer);
-	bool checkReturnVal(QString program, std::string input, std::string output, std::string &answer);	
+	void loadCatalogue(const QString &path);
+	// Performance of a test run.
+	struct TestRun {
+		long long cycles = 0;
+		long long instructions = 0;
+		long long cacheMisses = 0;
+		double cpi() const;
+	};
+	// Runs the program loaded into context on the input of test, within the
+	// limits of its budget. If given, the reference solution loaded into
+	// reference runs in lockstep, and the run fails at the first character of
+	// output diverging from that of the reference. Returns false and describes
+	// the failure in answer if the program did not finish.
+	bool runTest(Ripes::SimulationContext &context, Ripes::SimulationContext *reference, const TestCase &test, TestRun &run, std::string &answer) const;
+	// Appends the performance of run to answer, and scores it against the
+	// targets of budget. Returns false if run exceeds the CPI limit.
+	static bool checkBudget(const TestBudget &budget, const TestRun &run, std::string &answer, double &score);
+	// Compares the console output or the return value (a0) of the program run
+	// in context to output.
+	static bool checkPrintVal(Ripes::SimulationContext &context, std::string output, std::string &answer);
+	static bool checkReturnVal(Ripes::SimulationContext &context, std::string output, std::string &answer);
+	// Returns the return value (a0) of the program run in context, as a signed
+	// value of the register width.
+	static std::optional<long long> returnValue(const Ripes::SimulationContext &context);
+	// Checks the program against the result of the reference solution on each
+	// generated input of the task of check, in the contexts of the generated
+	// test. Stops at the first failing input, which is described in answer.
+	bool runGeneratedTests(Check &check, std::string &answer) const;
 
 };
@@ -1,16 +1,194 @@
-#include "task.h"
-
-std::vector<Task> createTaskList(){
-	std::vector<Task> list;
-	list.push_back(Task(1, 1, "Задание ветвление 1","Задание ветвление 1 текст"));
-	list.push_back(Task(1, 2, "Задание ветвление 2","Задание ветвление 2 текст"));
-	list.push_back(Task(2, 1, "Задание циклы","Задание циклы"));
-	return list;
+#include "taskinit.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMetaEnum>
+
+#include <algorithm>
+
+const QString defaultTaskCataloguePath = ":/tasks/tasks.json";
+
+static bool parseBudget(const QJsonObject &object, TestBudget &budget, QString &errorMessage)
+{
+	const std::map<QString, long long *> counts = {
+		{"maxCycles", &budget.maxCycles},
+		{"maxInstructions", &budget.maxInstructions},
+		{"maxCacheMisses", &budget.maxCacheMisses},
+		{"targetCycles", &budget.targetCycles},
+		{"targetInstructions", &budget.targetInstructions},
+		{"targetCacheMisses", &budget.targetCacheMisses}};
+	const std::map<QString, double *> ratios = {
+		{"maxCPI", &budget.maxCPI},
+		{"targetCPI", &budget.targetCPI}};
+	const std::map<QString, int *> geometry = {
+		{"cacheBlocks", &budget.cacheBlocks},
+		{"cacheLines", &budget.cacheLines},
+		{"cacheWays", &budget.cacheWays}};
+
+	for (auto it = object.begin(); it != object.end(); it++){
+		if (!it.value().isDouble() || it.value().toDouble() < 0){
+			errorMessage = "Invalid budget value '" + it.key() + "'";
+			return false;
+		}
+		if (auto count = counts.find(it.key()); count != counts.end()){
+			*count->second = it.value().toInteger();
+		} else if (auto ratio = ratios.find(it.key()); ratio != ratios.end()){
+			*ratio->second = it.value().toDouble();
+		} else if (auto log2 = geometry.find(it.key()); log2 != geometry.end()){
+			*log2->second = it.value().toInt();
+		} else {
+			errorMessage = "Unknown budget field '" + it.key() + "'";
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool parseTest(const QJsonObject &object, Task &task, QString &errorMessage)
+{
+	const QString type = object.value("type").toString();
+	if (type != "return" && type != "print"){
+		errorMessage = "Invalid test type '" + type + "'";
+		return false;
+	}
+	TestBudget budget;
+	if (!parseBudget(object.value("budget").toObject(), budget, errorMessage)){
+		return false;
+	}
+	task.addTest(TestCase(type == "return" ? TestType::returnValue : TestType::printValue,
+	                      object.value("input").toString().toStdString(),
+	                      object.value("output").toString().toStdString(), budget));
+	return true;
 }
 
-std::vector<std::string> createSectionNames(){
-	std::vector<std::string> list;
-	list.push_back("Ветвление");
-	list.push_back("Циклы");
-	return list;
+static bool parseGenerator(const QJsonObject &object, InputGenerator &generator, QString &errorMessage)
+{
+	const std::map<QString, unsigned *> counts = {
+		{"count", &generator.count},
+		{"seed", &generator.seed},
+		{"minSize", &generator.minSize},
+		{"maxSize", &generator.maxSize}};
+	const std::map<QString, long long *> values = {
+		{"minValue", &generator.minValue},
+		{"maxValue", &generator.maxValue}};
+
+	for (auto it = object.begin(); it != object.end(); it++){
+		if (it.key() == "type"){
+			const QString type = it.value().toString();
+			if (type != "return" && type != "print"){
+				errorMessage = "Invalid generator type '" + type + "'";
+				return false;
+			}
+			generator.type = type == "return" ? TestType::returnValue : TestType::printValue;
+		} else if (it.key() == "sized"){
+			generator.sized = it.value().toBool();
+		} else if (it.key() == "budget"){
+			if (!parseBudget(it.value().toObject(), generator.budget, errorMessage)){
+				return false;
+			}
+		} else if (!it.value().isDouble()){
+			errorMessage = "Invalid generator value '" + it.key() + "'";
+			return false;
+		} else if (auto count = counts.find(it.key()); count != counts.end()){
+			if (it.value().toDouble() < 0){
+				errorMessage = "Invalid generator value '" + it.key() + "'";
+				return false;
+			}
+			*count->second = static_cast<unsigned>(it.value().toInteger());
+		} else if (auto value = values.find(it.key()); value != values.end()){
+			*value->second = it.value().toInteger();
+		} else if (it.key() == "edgeRate"){
+			generator.edgeRate = std::clamp(it.value().toDouble(), 0.0, 1.0);
+		} else {
+			errorMessage = "Unknown generator field '" + it.key() + "'";
+			return false;
+		}
+	}
+	if (generator.minSize > generator.maxSize || generator.minValue > generator.maxValue){
+		errorMessage = "Empty generator range";
+		return false;
+	}
+	return true;
+}
+
+static bool parseTask(const QJsonObject &object, unsigned int section, TaskIndex &tasks, QString &errorMessage)
+{
+	const int number = object.value("number").toInt(-1);
+	if (number < 0){
+		errorMessage = "Invalid task number in section " + QString::number(section);
+		return false;
+	}
+	Task task(section, number, object.value("name").toString().toStdString(),
+	          object.value("text").toString().toStdString());
+	if (object.contains("processor")){
+		bool ok;
+		const int id = QMetaEnum::fromType<Ripes::ProcessorID>().keyToValue(
+			object.value("processor").toString().toStdString().c_str(), &ok);
+		if (!ok){
+			errorMessage = "Invalid processor '" + object.value("processor").toString() + "'";
+			return false;
+		}
+		task.setProcessor(static_cast<Ripes::ProcessorID>(id));
+	}
+	task.setReference(object.value("reference").toString().toStdString());
+	if (object.contains("generator")){
+		InputGenerator generator;
+		if (!parseGenerator(object.value("generator").toObject(), generator, errorMessage)){
+			errorMessage += " of task " + QString::number(section) + "." + QString::number(number);
+			return false;
+		}
+		if (task.getReference().empty()){
+			errorMessage = "Generated inputs of task " + QString::number(section) + "." +
+			               QString::number(number) + " require a reference solution";
+			return false;
+		}
+		task.setGenerator(generator);
+	}
+	for (const auto &test : object.value("tests").toArray()){
+		if (!parseTest(test.toObject(), task, errorMessage)){
+			errorMessage += " of task " + QString::number(section) + "." + QString::number(number);
+			return false;
+		}
+	}
+	if (!tasks.emplace(std::make_pair(section, number), std::move(task)).second){
+		errorMessage = "Duplicate task " + QString::number(section) + "." + QString::number(number);
+		return false;
+	}
+	return true;
+}
+
+bool loadTaskCatalogue(const QString &path, TaskCatalogue &catalogue, QString &errorMessage)
+{
+	QFile file(path);
+	if (!file.open(QIODevice::ReadOnly)){
+		errorMessage = "Failed to open task catalogue '" + path + "'";
+		return false;
+	}
+	QJsonParseError parseError;
+	const auto doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+	if (parseError.error != QJsonParseError::NoError || !doc.isObject()){
+		errorMessage = "Invalid task catalogue '" + path + "'";
+		if (parseError.error != QJsonParseError::NoError){
+			errorMessage += " (" + parseError.errorString() + ")";
+		}
+		return false;
+	}
+
+	TaskCatalogue result;
+	result.version = doc.object().value("version").toString().toStdString();
+	unsigned int section = 0;
+	for (const auto &value : doc.object().value("sections").toArray()){
+		const QJsonObject object = value.toObject();
+		result.sections.push_back(object.value("name").toString().toStdString());
+		section++;
+		for (const auto &task : object.value("tasks").toArray()){
+			if (!parseTask(task.toObject(), section, result.tasks, errorMessage)){
+				return false;
+			}
+		}
+	}
+	catalogue = std::move(result);
+	return true;
 }
@@ -1,3 +1,32 @@
+#include <QString>
+#include <map>
 #include "task.h"
-std::vector<Task> createTaskList();
-std::vector<std::string> createSectionNames();
\ No newline at end of file
+
+#pragma once
+
+// Tasks of a catalogue, indexed by (section, number).
+using TaskIndex = std::map<std::pair<unsigned int, unsigned int>, Task>;
+
+struct TaskCatalogue {
+	std::string version;
+	std::vector<std::string> sections;
+	TaskIndex tasks;
+};
+
+// Path of the catalogue bundled as a resource.
+extern const QString defaultTaskCataloguePath;
+
+// Loads the JSON task catalogue at path, which is a file or a resource. The
+// catalogue is an object with a version and an array of sections, numbered from
+// 1, each with a name and an array of tasks:
+//   {"number": 1, "name": "...", "text": "...", "processor": "RV32_5S",
+//    "tests": [{"type": "return" | "print", "input": "...", "output": "...",
+//               "budget": {"maxCycles": 1000, "targetCPI": 1.2, ...}}]}
+// The processor and the budget are optional; budget fields are named as the
+// fields of TestBudget. A task with a "reference" solution may generate inputs,
+// whose fields are named as those of InputGenerator and are optional:
+//   "generator": {"count": 200, "type": "print", "sized": true, "maxSize": 64,
+//                 "minValue": -100, "maxValue": 100, "edgeRate": 0.1,
+//                 "budget": {...}}
+// Returns false and sets errorMessage on failure.
+bool loadTaskCatalogue(const QString &path, TaskCatalogue &catalogue, QString &errorMessage);
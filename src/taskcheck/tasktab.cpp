@@ -6,6 +6,7 @@
 #include <QObject>
 #include <QComboBox>
 #include <QPushButton>
+#include <QtConcurrent/QtConcurrent>
 
 namespace Ripes {
 TaskTab::TaskTab(QToolBar *toolbar, EditTab *edittab, QWidget *parent)
@@ -19,6 +20,12 @@ TaskTab::TaskTab(QToolBar *toolbar, EditTab *edittab, QWidget *parent)
 	connect(m_ui->numberBox, &QComboBox::currentIndexChanged,
 	this, &TaskTab::changeTask);
 	connect(m_ui->checkButton, &QPushButton::clicked, this, &TaskTab::checkTask);
+	connect(m_ui->cancelButton, &QPushButton::clicked, this, &TaskTab::cancelCheck);
+	connect(&checkWatcher, &QFutureWatcher<std::string>::finished, this, &TaskTab::checkFinished);
+	taskchecker.setTestObserver([this](size_t test, size_t tests, const std::string &answer) {
+		const QString text = QString::fromStdString(answer);
+		QMetaObject::invokeMethod(this, [=] { testChecked(test, tests, text); }, Qt::QueuedConnection);
+	});
 	
 	m_ui->sectionBox->setEditable(true);
 	m_ui->sectionBox->setInsertPolicy(QComboBox::NoInsert);
@@ -31,6 +38,8 @@ TaskTab::TaskTab(QToolBar *toolbar, EditTab *edittab, QWidget *parent)
 	m_ui->taskText->setReadOnly(true);
 	m_ui->answerText->setReadOnly(true);
 	m_ui->checkButton->setEnabled(false);	
+	m_ui->cancelButton->setEnabled(false);
+	m_ui->checkProgress->setVisible(false);
 
 	for (unsigned int i = 0; i < taskchecker.getSectionNum(); i++){
 		m_ui->sectionBox->addItem(QString::number(i+1), 0);
@@ -38,7 +47,11 @@ TaskTab::TaskTab(QToolBar *toolbar, EditTab *edittab, QWidget *parent)
 
 }
 
-TaskTab::~TaskTab() { delete m_ui; }
+TaskTab::~TaskTab() {
+	taskchecker.cancel();
+	checkWatcher.waitForFinished();
+	delete m_ui;
+}
 
 void TaskTab::changeSection(){
 	if(m_ui->sectionBox->currentIndex() > -1){
@@ -55,24 +68,46 @@ void TaskTab::changeSection(){
 }
 
 void TaskTab::checkTask(){
-	std::string answer;
-	auto res = ProcessorHandler::getAssembler()->assembleRaw(
-      edittab->getAssemblyText(), &IOManager::get().assemblerSymbols());
-  	
-  	if (res.errors.size() == 0) {
-		answer = taskchecker.checkTask(edittab->getAssemblyText(), currentNumber, currentSection);
-	} else {
-		answer = "No check for program with syntax errors";
+	if (checkWatcher.isRunning()){
+		return;
 	}
-	m_ui->answerText->setPlainText(QString::fromStdString(answer) + " - answer\n" + 
-	"Current program is:\n" + edittab->getAssemblyText() );
+	checkedProgram = edittab->getAssemblyText();
+	m_ui->answerText->clear();
+	m_ui->checkButton->setEnabled(false);
+	m_ui->cancelButton->setEnabled(true);
+	m_ui->checkProgress->setValue(0);
+	m_ui->checkProgress->setVisible(true);
+	const unsigned int section = currentSection;
+	const unsigned int number = currentNumber;
+	checkWatcher.setFuture(QtConcurrent::run([=] {
+		return taskchecker.checkTask(checkedProgram, section, number);
+	}));
+}
+
+void TaskTab::cancelCheck(){
+	taskchecker.cancel();
+	m_ui->cancelButton->setEnabled(false);
+}
+
+void TaskTab::testChecked(size_t test, size_t tests, const QString &answer){
+	m_ui->checkProgress->setMaximum(static_cast<int>(tests));
+	m_ui->checkProgress->setValue(m_ui->checkProgress->value() + 1);
+	m_ui->answerText->append("Test " + QString::number(test + 1) + ": " + answer);
+}
+
+void TaskTab::checkFinished(){
+	m_ui->answerText->setPlainText(QString::fromStdString(checkWatcher.result()) + " - answer\n" +
+	"Current program is:\n" + checkedProgram);
+	m_ui->checkButton->setEnabled(m_ui->numberBox->currentIndex() > -1);
+	m_ui->cancelButton->setEnabled(false);
+	m_ui->checkProgress->setVisible(false);
 }
 
 void TaskTab::changeTask(){
 	if(m_ui->numberBox->currentIndex() > -1){
 		currentNumber = std::stoi(m_ui->numberBox->currentText().toStdString());
 
-		m_ui->checkButton->setEnabled(true);
+		m_ui->checkButton->setEnabled(!checkWatcher.isRunning());
 		Task *current = taskchecker.findTask(currentSection, currentNumber);
 		if (current != nullptr) {
 			m_ui->taskText->setPlainText(QString::fromStdString(current->getText()));
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <QFutureWatcher>
+
 #include "ripestab.h"
 #include "edittab.h"
 #include "taskchecker.h"
@@ -17,12 +19,21 @@ public slots:
   void changeSection();
   void changeTask();
   void checkTask();
+  void cancelCheck();
 
 public:
   TaskTab(QToolBar *toolbar, EditTab *edittab, QWidget *parent = nullptr);
   ~TaskTab() override;
 
 private:
+  // Shows the answer of a test of the running check.
+  void testChecked(size_t test, size_t tests, const QString &answer);
+  void checkFinished();
+
+  // Checks run on a background thread, such that the program may be edited
+  // while it is checked.
+  QFutureWatcher<std::string> checkWatcher;
+  QString checkedProgram;
   unsigned int currentNumber;
   unsigned int currentSection;
   TaskChecker taskchecker;
@@ -0,0 +1,85 @@
+#include "tracespans.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+
+#include <map>
+#include <mutex>
+#include <set>
+#include <vector>
+
+namespace Ripes {
+
+std::atomic<bool> TraceSpans::s_enabled = false;
+QElapsedTimer TraceSpans::s_clock;
+
+namespace {
+struct TraceEvent {
+  const char *name;
+  qint64 begin;
+  // Negative for instant events.
+  qint64 duration;
+  int tid;
+};
+
+std::mutex s_mutex;
+std::vector<TraceEvent> s_events;
+std::set<QString> s_marks;
+// Threads are numbered in the order of their first event.
+std::map<Qt::HANDLE, int> s_threads;
+
+int currentThread() {
+  auto it = s_threads.try_emplace(QThread::currentThreadId(),
+                                  static_cast<int>(s_threads.size()));
+  return it.first->second;
+}
+} // namespace
+
+void TraceSpans::enable() {
+  s_clock.start();
+  s_enabled = true;
+}
+
+void TraceSpans::record(const char *name, qint64 beginUs, qint64 endUs) {
+  std::lock_guard lock(s_mutex);
+  s_events.push_back({name, beginUs, endUs - beginUs, currentThread()});
+}
+
+void TraceSpans::markOnce(const char *name) {
+  if (!enabled())
+    return;
+  const qint64 time = now();
+  std::lock_guard lock(s_mutex);
+  if (s_marks.insert(name).second)
+    s_events.push_back({name, time, -1, currentThread()});
+}
+
+QString TraceSpans::write(const QString &path) {
+  QFile file(path);
+  if (!file.open(QIODevice::Truncate | QIODevice::WriteOnly))
+    return "Failed to open trace file '" + path + "'";
+
+  std::lock_guard lock(s_mutex);
+  QJsonArray events;
+  for (const auto &event : s_events) {
+    QJsonObject json{{"name", event.name},
+                     {"pid", 0},
+                     {"tid", event.tid},
+                     {"ts", event.begin}};
+    if (event.duration < 0) {
+      json["ph"] = "i";
+      json["s"] = "g";
+    } else {
+      json["ph"] = "X";
+      json["dur"] = event.duration;
+    }
+    events.append(json);
+  }
+  file.write(QJsonDocument(QJsonObject{{"traceEvents", events}}).toJson());
+  return QString();
+}
+
+} // namespace Ripes
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QString>
+
+#include <atomic>
+
+namespace Ripes {
+
+/**
+ * @brief The TraceSpans class
+ * Records the durations of the phases of starting Ripes and of loading
+ * processors and programs, for finding where the time is spent. Spans are
+ * recorded by the scoped TraceSpan, and are written in the Chrome Trace Event
+ * format, which is read by chrome://tracing and the Perfetto UI.
+ *
+ * Recording is disabled by default, in which case a span costs a single
+ * relaxed atomic load.
+ */
+class TraceSpans {
+public:
+  /// Starts recording spans, timed relative to the call.
+  static void enable();
+  static bool enabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+  /// Records a span named @p name from @p beginUs to @p endUs.
+  static void record(const char *name, qint64 beginUs, qint64 endUs);
+  /// Records an instant event named @p name, unless already recorded.
+  static void markOnce(const char *name);
+  /// Microseconds since recording was enabled.
+  static qint64 now() { return s_clock.nsecsElapsed() / 1000; }
+
+  /// Writes the recorded spans to @p path. @returns an error message on
+  /// failure.
+  static QString write(const QString &path);
+
+private:
+  static std::atomic<bool> s_enabled;
+  static QElapsedTimer s_clock;
+};
+
+/// Records the lifetime of the scope as a span, if recording is enabled.
+class TraceSpan {
+public:
+  explicit TraceSpan(const char *name)
+      : m_name(TraceSpans::enabled() ? name : nullptr) {
+    if (m_name)
+      m_begin = TraceSpans::now();
+  }
+  ~TraceSpan() {
+    if (m_name)
+      TraceSpans::record(m_name, m_begin, TraceSpans::now());
+  }
+  TraceSpan(const TraceSpan &) = delete;
+  TraceSpan &operator=(const TraceSpan &) = delete;
+
+private:
+  const char *m_name;
+  qint64 m_begin = 0;
+};
+
+} // namespace Ripes
@@ -2,6 +2,12 @@
 
 #include <QWidget>
 
+// Without threads (see RIPES_WASM_THREADS), the processor is run on the GUI
+// thread in cooperative time slices.
+#if defined(__EMSCRIPTEN__) && !defined(RIPES_WASM_THREADS)
+#define RIPES_COOPERATIVE_RUN
+#endif
+
 namespace Ripes {
 
 // Disable a widget if we are running in a wasm environment.
@@ -0,0 +1,224 @@
+#include "watchpoints.h"
+
+#include <algorithm>
+
+namespace Ripes {
+
+namespace {
+
+/// Returns the address of the instruction in the last stage of @p proc.
+AInt lastStagePc(const RipesProcessor &proc) {
+  return proc.getPcForStage({0, proc.structure().at(0) - 1});
+}
+
+} // namespace
+
+QString Watchpoints::Hit::describe(const ISAInfoBase *isa) const {
+  QString what;
+  if (kind == Kind::Memory) {
+    what = QString(access == MemoryAccess::Write ? "write of" : "read of") +
+           " " + QString::number(bytes) + " bytes at 0x" +
+           QString::number(address, 16);
+  } else {
+    QString name = QString::number(index);
+    if (isa) {
+      if (auto regInfo = isa->regInfo(rfid))
+        name = regInfo.value()->regName(index);
+    }
+    what = "write of register " + name;
+  }
+  return "Watchpoint hit: " + what + " by the instruction at 0x" +
+         QString::number(pc, 16) + " in cycle " + QString::number(cycle);
+}
+
+void Watchpoints::addMemory(const MemoryWatchpoint &watchpoint) {
+  m_memory.push_back(watchpoint);
+  if (m_memory.back().last < m_memory.back().first)
+    std::swap(m_memory.back().first, m_memory.back().last);
+  rebuildPageMap();
+}
+
+void Watchpoints::removeMemory(AInt address) {
+  m_memory.erase(std::remove_if(m_memory.begin(), m_memory.end(),
+                                [=](const MemoryWatchpoint &watchpoint) {
+                                  return watchpoint.first <= address &&
+                                         address <= watchpoint.last;
+                                }),
+                 m_memory.end());
+  rebuildPageMap();
+}
+
+unsigned Watchpoints::memoryAccess(AInt address) const {
+  unsigned access = 0;
+  for (const auto &watchpoint : m_memory) {
+    if (watchpoint.first <= address && address <= watchpoint.last)
+      access |= watchpoint.access;
+  }
+  return access;
+}
+
+bool Watchpoints::addRegister(const RegisterWatchpoint &watchpoint) {
+  if (watchpoint.index >= 64)
+    return false;
+  auto it = std::find_if(
+      m_registers.begin(), m_registers.end(),
+      [&](const RegisterFile &file) { return file.rfid == watchpoint.rfid; });
+  if (it == m_registers.end()) {
+    it = m_registers.insert(m_registers.end(), RegisterFile());
+    it->rfid = watchpoint.rfid;
+  }
+  it->mask |= uint64_t(1) << watchpoint.index;
+  it->values.clear();
+  return true;
+}
+
+void Watchpoints::removeRegister(const RegisterWatchpoint &watchpoint) {
+  for (auto &file : m_registers) {
+    if (file.rfid == watchpoint.rfid && watchpoint.index < 64) {
+      file.mask &= ~(uint64_t(1) << watchpoint.index);
+      file.values.clear();
+    }
+  }
+  m_registers.erase(
+      std::remove_if(m_registers.begin(), m_registers.end(),
+                     [](const RegisterFile &file) { return file.mask == 0; }),
+      m_registers.end());
+}
+
+bool Watchpoints::hasRegister(const RegisterWatchpoint &watchpoint) const {
+  for (const auto &file : m_registers) {
+    if (file.rfid == watchpoint.rfid && watchpoint.index < 64)
+      return (file.mask >> watchpoint.index) & 1;
+  }
+  return false;
+}
+
+void Watchpoints::clear() {
+  m_memory.clear();
+  m_registers.clear();
+  rebuildPageMap();
+}
+
+void Watchpoints::rebuildPageMap() {
+  m_pageMap.clear();
+  if (m_memory.empty())
+    return;
+  m_pageMap.resize(s_mapPages);
+  for (const auto &watchpoint : m_memory) {
+    const AInt first = watchpoint.first >> s_pageBits;
+    const AInt last = watchpoint.last >> s_pageBits;
+    if (last - first >= s_mapPages - 1) {
+      m_pageMap.assign(s_mapPages, true);
+      return;
+    }
+    for (AInt page = first; page != last + 1; page++)
+      m_pageMap[page & (s_mapPages - 1)] = true;
+  }
+}
+
+void Watchpoints::sync(const RipesProcessor &proc) {
+  m_syncCycle = proc.getCycleCount();
+  for (auto &file : m_registers) {
+    if (proc.tracksRegisterWrites(file.rfid)) {
+      proc.writtenRegisters(file.rfid, file.cursor);
+      continue;
+    }
+    snapshotValues(proc, file);
+  }
+  if (!m_registers.empty())
+    m_writebackPc = lastStagePc(proc);
+}
+
+void Watchpoints::snapshotValues(const RipesProcessor &proc,
+                                 RegisterFile &file) {
+  file.values.clear();
+  file.handle = proc.registerFile(file.rfid);
+  if (!file.handle.valid())
+    return;
+  // Registers beyond the register file are never written.
+  if (file.handle.count < 64)
+    file.mask &= (uint64_t(1) << file.handle.count) - 1;
+  for (unsigned i = 0; i < 64; i++) {
+    if ((file.mask >> i) & 1)
+      file.values.push_back(proc.readRegister(file.handle, i));
+  }
+}
+
+std::optional<Watchpoints::Hit> Watchpoints::check(const RipesProcessor &proc) {
+  if (empty() || proc.getCycleCount() == m_syncCycle)
+    return {};
+  std::optional<Hit> hit;
+  if (!m_memory.empty())
+    hit = checkMemory(proc);
+  // Registers are checked regardless, to keep up with their writes.
+  if (!m_registers.empty()) {
+    auto registerHit = checkRegisters(proc);
+    if (!hit)
+      hit = registerHit;
+  }
+  if (hit)
+    hit->cycle = proc.getCycleCount();
+  return hit;
+}
+
+std::optional<Watchpoints::Hit>
+Watchpoints::checkMemory(const RipesProcessor &proc) {
+  const MemoryAccess access = proc.dataMemAccess();
+  if (access.type == MemoryAccess::None)
+    return {};
+  const AInt last = access.address + std::max(access.bytes, 1u) - 1;
+  if (!pageWatched(access.address) && !pageWatched(last))
+    return {};
+
+  const unsigned type =
+      access.type == MemoryAccess::Write ? Access::Write : Access::Read;
+  for (const auto &watchpoint : m_memory) {
+    if ((watchpoint.access & type) && watchpoint.first <= last &&
+        access.address <= watchpoint.last) {
+      Hit hit;
+      hit.kind = Hit::Kind::Memory;
+      hit.pc = access.pc;
+      hit.access = access.type;
+      hit.address = access.address;
+      hit.bytes = access.bytes;
+      return hit;
+    }
+  }
+  return {};
+}
+
+std::optional<Watchpoints::Hit>
+Watchpoints::checkRegisters(const RipesProcessor &proc) {
+  std::optional<Hit> hit;
+  for (auto &file : m_registers) {
+    uint64_t written = 0;
+    if (proc.tracksRegisterWrites(file.rfid)) {
+      written = proc.writtenRegisters(file.rfid, file.cursor) & file.mask;
+    } else if (file.values.empty()) {
+      // Registers watched since the latest sync are observed from now on.
+      snapshotValues(proc, file);
+    } else {
+      auto value = file.values.begin();
+      for (unsigned i = 0; i < 64; i++) {
+        if (((file.mask >> i) & 1) == 0)
+          continue;
+        const VInt current = proc.readRegister(file.handle, i);
+        if (current != *value)
+          written |= uint64_t(1) << i;
+        *value++ = current;
+      }
+    }
+    if (written != 0 && !hit) {
+      hit = Hit();
+      hit->kind = Hit::Kind::Register;
+      hit->pc = m_writebackPc;
+      hit->rfid = file.rfid;
+      while (((written >> hit->index) & 1) == 0)
+        hit->index++;
+    }
+  }
+  m_writebackPc = lastStagePc(proc);
+  return hit;
+}
+
+} // namespace Ripes
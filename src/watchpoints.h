@@ -0,0 +1,127 @@
+#pragma once
+
+#include <QMetaType>
+#include <QString>
+
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "processors/interface/ripesprocessor.h"
+
+namespace Ripes {
+
+/**
+ * @brief The Watchpoints class
+ * Watches the memory accesses and register writes of a processor. Memory
+ * watchpoints are looked up through a bitmap of the pages holding watched
+ * addresses, such that accesses to unwatched pages cost a single lookup, and
+ * no cost is incurred by the processor if nothing is watched.
+ *
+ * Register watchpoints are triggered by the writes reported by the processor
+ * (see RipesProcessor::writtenRegisters), or, for register files for which
+ * writes are not tracked, by changes to the values of the registers.
+ */
+class Watchpoints {
+public:
+  enum Access : unsigned { Read = 0b01, Write = 0b10, ReadWrite = 0b11 };
+
+  /// Watches the accesses of @p access to the bytes [first, last].
+  struct MemoryWatchpoint {
+    AInt first = 0;
+    AInt last = 0;
+    unsigned access = ReadWrite;
+  };
+
+  struct RegisterWatchpoint {
+    std::string_view rfid;
+    unsigned index = 0;
+  };
+
+  struct Hit {
+    enum class Kind { Memory, Register };
+    Kind kind = Kind::Memory;
+    long long cycle = 0;
+    /// Address of the instruction which accessed memory or wrote the register.
+    AInt pc = 0;
+    // Memory watchpoints only.
+    MemoryAccess::Type access = MemoryAccess::None;
+    AInt address = 0;
+    unsigned bytes = 0;
+    // Register watchpoints only.
+    std::string_view rfid;
+    unsigned index = 0;
+
+    /// Describes the hit, naming registers after @p isa if provided.
+    QString describe(const ISAInfoBase *isa = nullptr) const;
+  };
+
+  void addMemory(const MemoryWatchpoint &watchpoint);
+  /// Removes the memory watchpoints covering @p address.
+  void removeMemory(AInt address);
+  /// Returns the accesses watched at @p address.
+  unsigned memoryAccess(AInt address) const;
+  const std::vector<MemoryWatchpoint> &memory() const { return m_memory; }
+
+  /// Watches register @p index of @p rfid. Returns false for registers beyond
+  /// the 64th, which are not tracked.
+  bool addRegister(const RegisterWatchpoint &watchpoint);
+  void removeRegister(const RegisterWatchpoint &watchpoint);
+  bool hasRegister(const RegisterWatchpoint &watchpoint) const;
+
+  void clear();
+  bool empty() const { return m_memory.empty() && m_registers.empty(); }
+
+  /**
+   * @brief sync
+   * Starts observing @p proc from its current state. Register writes made
+   * before the call are discarded, and the current cycle is not checked, such
+   * that runs resumed at a watchpoint do not stop at it again.
+   */
+  void sync(const RipesProcessor &proc);
+
+  /**
+   * @brief check
+   * Checks the data access and the register writes of the latest cycle of
+   * @p proc against the watchpoints. Must be called for every cycle whilst
+   * register watchpoints are set.
+   */
+  std::optional<Hit> check(const RipesProcessor &proc);
+
+private:
+  void rebuildPageMap();
+  bool pageWatched(AInt address) const {
+    return m_pageMap[(address >> s_pageBits) & (s_mapPages - 1)];
+  }
+  std::optional<Hit> checkMemory(const RipesProcessor &proc);
+  std::optional<Hit> checkRegisters(const RipesProcessor &proc);
+
+  static constexpr unsigned s_pageBits = 12;
+  // Pages are mapped by their page number modulo the size of the map; pages
+  // aliasing a watched page are rejected by the watchpoints themselves.
+  static constexpr AInt s_mapPages = AInt(1) << 20;
+
+  std::vector<MemoryWatchpoint> m_memory;
+  std::vector<bool> m_pageMap;
+
+  struct RegisterFile {
+    std::string_view rfid;
+    uint64_t mask = 0;
+    uint64_t cursor = 0;
+    // Values of the watched registers, for files not tracked by the processor,
+    // read through the handle resolved when the values were snapshot.
+    std::vector<VInt> values;
+    RegisterFileHandle handle;
+  };
+  static void snapshotValues(const RipesProcessor &proc, RegisterFile &file);
+  std::vector<RegisterFile> m_registers;
+  // The instruction in the last stage of the processor before the latest
+  // cycle, which wrote the registers of the cycle.
+  AInt m_writebackPc = 0;
+
+  long long m_syncCycle = -1;
+};
+
+} // namespace Ripes
+
+Q_DECLARE_METATYPE(Ripes::Watchpoints::Hit);
@@ -0,0 +1,235 @@
+#include "waveformtrace.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+
+namespace Ripes {
+
+namespace {
+
+/// Returns the VCD identifier of the signal at @p index.
+std::string vcdID(size_t index) {
+  // Identifiers are printable ASCII characters from '!' to '~'.
+  std::string id;
+  do {
+    id += static_cast<char>('!' + index % 94);
+    index /= 94;
+  } while (index != 0);
+  return id;
+}
+
+std::vector<std::string> scopesOf(const std::string &path) {
+  std::vector<std::string> scopes;
+  size_t start = 0;
+  for (size_t dot = path.find('.'); dot != std::string::npos;
+       dot = path.find('.', start)) {
+    scopes.push_back(path.substr(start, dot - start));
+    start = dot + 1;
+  }
+  scopes.push_back(path.substr(start));
+  return scopes;
+}
+
+uint32_t crc32(const QByteArray &data) {
+  static const auto table = [] {
+    std::array<uint32_t, 256> table;
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t crc = i;
+      for (int bit = 0; bit < 8; bit++)
+        crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+      table[i] = crc;
+    }
+    return table;
+  }();
+  uint32_t crc = 0xFFFFFFFF;
+  for (const char byte : data)
+    crc = table[(crc ^ static_cast<uint8_t>(byte)) & 0xFF] ^ (crc >> 8);
+  return crc ^ 0xFFFFFFFF;
+}
+
+void appendLE32(QByteArray &out, uint32_t value) {
+  for (int i = 0; i < 4; i++)
+    out.append(static_cast<char>((value >> (8 * i)) & 0xFF));
+}
+
+/// Compresses @p data as a gzip member. The deflate stream is that of
+/// qCompress, less its length prefix, zlib header and checksum.
+QByteArray gzipMember(const QByteArray &data) {
+  const QByteArray zlib = qCompress(data);
+  QByteArray member("\x1f\x8b\x08\x00\x00\x00\x00\x00\x00\xff", 10);
+  member.append(zlib.mid(6, zlib.size() - 10));
+  appendLE32(member, crc32(data));
+  appendLE32(member, static_cast<uint32_t>(data.size()));
+  return member;
+}
+
+} // namespace
+
+WaveformTrace::Filter::Filter(const QStringList &patterns) {
+  for (const auto &pattern : patterns) {
+    if (!pattern.trimmed().isEmpty())
+      m_patterns.emplace_back(
+          QRegularExpression::wildcardToRegularExpression(pattern.trimmed()));
+  }
+}
+
+bool WaveformTrace::Filter::matches(const QString &path) const {
+  if (m_patterns.empty())
+    return true;
+  for (const auto &pattern : m_patterns) {
+    if (pattern.match(path).hasMatch())
+      return true;
+  }
+  return false;
+}
+
+WaveformTrace::WaveformTrace(std::vector<Signal> traced, bool compressed)
+    : m_signals(std::move(traced)), m_compressed(compressed),
+      m_queue(std::max<size_t>(1 << 16, (m_signals.size() + 1) * 1024)) {
+  for (size_t i = 0; i < m_signals.size(); i++)
+    m_ids.push_back(vcdID(i));
+  m_values.resize(m_signals.size());
+}
+
+WaveformTrace::~WaveformTrace() { close(); }
+
+std::unique_ptr<WaveformTrace> WaveformTrace::open(const QString &filename,
+                                                   std::vector<Signal> traced,
+                                                   QString &error) {
+  std::unique_ptr<WaveformTrace> trace(new WaveformTrace(
+      std::move(traced), filename.endsWith(".gz", Qt::CaseInsensitive)));
+  trace->m_file.setFileName(filename);
+  if (!trace->m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    error = "Failed to open waveform trace '" + filename +
+            "': " + trace->m_file.errorString();
+    return nullptr;
+  }
+  trace->writeHeader();
+  trace->m_thread = std::thread([trace = trace.get()] { trace->run(); });
+  return trace;
+}
+
+void WaveformTrace::sample(long long cycle, const Value *values) {
+  if (cycle <= m_lastCycle)
+    return;
+  m_lastCycle = cycle;
+  const auto push = [&](Value value) {
+    while (!m_queue.push(value)) {
+      m_wake.notify_one();
+      std::this_thread::yield();
+    }
+  };
+  push(static_cast<Value>(cycle));
+  for (size_t i = 0; i < m_signals.size(); i++)
+    push(values[i]);
+  if (++m_unnotified == s_notifyInterval) {
+    m_unnotified = 0;
+    m_wake.notify_one();
+  }
+}
+
+QString WaveformTrace::close() {
+  if (m_thread.joinable()) {
+    {
+      std::lock_guard lock(m_mutex);
+      m_stop = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+    flush();
+    m_file.close();
+  }
+  return m_writeFailed ? "Failed to write waveform trace '" +
+                             m_file.fileName() + "'"
+                       : QString();
+}
+
+void WaveformTrace::run() {
+  Value value;
+  while (true) {
+    while (m_queue.pop(value)) {
+      m_pending.push_back(value);
+      if (m_pending.size() == m_signals.size() + 1) {
+        writeSample(m_pending.data());
+        m_pending.clear();
+      }
+    }
+    if (m_buffer.size() >= s_blockSize)
+      flush();
+
+    // The producer only notifies the writer periodically, so the writer
+    // wakes up by itself as well.
+    std::unique_lock lock(m_mutex);
+    if (m_stop && m_queue.empty())
+      return;
+    m_wake.wait_for(lock, std::chrono::milliseconds(10),
+                    [this] { return m_stop || !m_queue.empty(); });
+  }
+}
+
+void WaveformTrace::writeHeader() {
+  m_buffer += "$version Ripes $end\n$timescale 1ns $end\n";
+  std::vector<std::string> scopes;
+  for (size_t i = 0; i < m_signals.size(); i++) {
+    std::vector<std::string> path = scopesOf(m_signals[i].path);
+    const std::string name = path.back();
+    path.pop_back();
+    size_t common = 0;
+    while (common < scopes.size() && common < path.size() &&
+           scopes[common] == path[common])
+      common++;
+    for (size_t j = common; j < scopes.size(); j++)
+      m_buffer += "$upscope $end\n";
+    for (size_t j = common; j < path.size(); j++)
+      m_buffer += "$scope module " + path[j] + " $end\n";
+    scopes = std::move(path);
+    m_buffer += "$var wire " + std::to_string(m_signals[i].width) + " " +
+                m_ids[i] + " " + name + " $end\n";
+  }
+  for (size_t j = 0; j < scopes.size(); j++)
+    m_buffer += "$upscope $end\n";
+  m_buffer += "$enddefinitions $end\n";
+}
+
+void WaveformTrace::writeSample(const Value *sample) {
+  const std::string time = "#" + std::to_string(sample[0]) + "\n";
+  bool timeWritten = false;
+  for (size_t i = 0; i < m_signals.size(); i++) {
+    const unsigned width = m_signals[i].width;
+    const Value mask = width >= 64 ? ~Value(0) : (Value(1) << width) - 1;
+    const Value value = sample[i + 1] & mask;
+    if (!m_firstSample && value == m_values[i])
+      continue;
+    m_values[i] = value;
+    if (!timeWritten) {
+      m_buffer += time;
+      timeWritten = true;
+    }
+    if (width == 1) {
+      m_buffer += value ? '1' : '0';
+    } else {
+      m_buffer += 'b';
+      int bit = 63;
+      while (bit > 0 && ((value >> bit) & 1) == 0)
+        bit--;
+      for (; bit >= 0; bit--)
+        m_buffer += ((value >> bit) & 1) ? '1' : '0';
+      m_buffer += ' ';
+    }
+    m_buffer += m_ids[i] + "\n";
+  }
+  m_firstSample = false;
+}
+
+void WaveformTrace::flush() {
+  if (m_buffer.empty())
+    return;
+  const QByteArray data = QByteArray::fromStdString(m_buffer);
+  const QByteArray out = m_compressed ? gzipMember(data) : data;
+  if (m_file.write(out) != out.size())
+    m_writeFailed = true;
+  m_buffer.clear();
+}
+
+} // namespace Ripes
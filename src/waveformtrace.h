@@ -0,0 +1,110 @@
+#pragma once
+
+#include <QFile>
+#include <QRegularExpression>
+#include <QStringList>
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cachesim/spscqueue.h"
+
+namespace Ripes {
+
+/**
+ * @brief The WaveformTrace class
+ * Writes the values of a set of signals in each cycle as a VCD trace, which is
+ * gzip-compressed if the name of the trace file ends with ".gz". Samples are
+ * passed from the simulation thread to a writer thread through a lock-free
+ * queue, such that the simulation thread only copies the values of the
+ * signals, and only changes of values are encoded and written.
+ *
+ * The trace is compressed in blocks, each written as a gzip member, such that
+ * the memory of the writer is bounded for long runs. Concatenated members form
+ * a valid gzip file, which is read by waveform viewers and by vcd2fst.
+ */
+class WaveformTrace {
+public:
+  using Value = uint64_t;
+  struct Signal {
+    /// Hierarchical path of the signal; scopes are separated by '.'.
+    std::string path;
+    unsigned width = 1;
+  };
+
+  /**
+   * @brief The Filter class
+   * Selects signals by the paths of their components, as a list of wildcard
+   * patterns. A component matching any pattern is traced along with all of
+   * its subcomponents. An empty list selects all components.
+   */
+  class Filter {
+  public:
+    explicit Filter(const QStringList &patterns = {});
+    bool matches(const QString &path) const;
+
+  private:
+    std::vector<QRegularExpression> m_patterns;
+  };
+
+  ~WaveformTrace();
+
+  /// Opens @p filename for tracing the signals of @p traced. Returns nullptr
+  /// and sets @p error if the file could not be opened.
+  static std::unique_ptr<WaveformTrace>
+  open(const QString &filename, std::vector<Signal> traced, QString &error);
+
+  /// Records @p values, holding a value per signal, as the values of
+  /// @p cycle. Samples of cycles preceding the latest sample are ignored, as
+  /// when reversing. Waits for the writer if the queue is full.
+  void sample(long long cycle, const Value *values);
+
+  /// Writes the outstanding samples and closes the trace. Returns an error
+  /// message if writing failed.
+  QString close();
+
+  const std::vector<Signal> &tracedSignals() const { return m_signals; }
+
+private:
+  WaveformTrace(std::vector<Signal> traced, bool compressed);
+
+  void run();
+  void writeHeader();
+  void writeSample(const Value *sample);
+  /// Writes the encoded trace to the file, compressing it if requested.
+  void flush();
+
+  // Samples between notifications of the writer.
+  static constexpr unsigned s_notifyInterval = 256;
+  // Bytes of encoded trace compressed as a single block.
+  static constexpr size_t s_blockSize = 4 << 20;
+
+  std::vector<Signal> m_signals;
+  std::vector<std::string> m_ids;
+  const bool m_compressed;
+  QFile m_file;
+
+  // Each sample is enqueued as its cycle followed by the value of each signal.
+  SPSCQueue<Value> m_queue;
+  long long m_lastCycle = -1;
+  unsigned m_unnotified = 0;
+
+  // Writer state.
+  std::vector<Value> m_pending;
+  std::vector<Value> m_values;
+  bool m_firstSample = true;
+  std::string m_buffer;
+  bool m_writeFailed = false;
+
+  std::mutex m_mutex;
+  std::condition_variable m_wake;
+  bool m_stop = false;
+  std::thread m_thread;
+};
+
+} // namespace Ripes
@@ -0,0 +1,303 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <random>
+
+#include "elfio/elfio.hpp"
+
+#include "assembler/assembler.h"
+#include "isa/rv32isainfo.h"
+#include "isa/rv64isainfo.h"
+
+using namespace Ripes;
+using namespace Assembler;
+
+/**
+ * Throughput benchmarks of the assembler, the disassembler and the instruction
+ * matcher. Each benchmark is repeated a number of times, and the fastest
+ * repetition is reported, such that results are comparable across runs on a
+ * loaded machine. Results are written as JSON, for tracking regressions across
+ * releases.
+ */
+
+namespace {
+
+struct BenchInput {
+  QString name;
+  QStringList lines;
+};
+
+struct BenchISA {
+  std::shared_ptr<const ISAInfoBase> isa;
+  std::shared_ptr<AssemblerBase> assembler;
+};
+
+std::vector<BenchISA> benchISAs(unsigned bits) {
+  std::vector<std::shared_ptr<const ISAInfoBase>> isas;
+  if (bits == 32) {
+    isas = {std::make_shared<ISAInfo<ISA::RV32I>>(QStringList{"M"}),
+            std::make_shared<ISAInfo<ISA::RV32I>>(QStringList{"M", "C"})};
+  } else {
+    isas = {std::make_shared<ISAInfo<ISA::RV64I>>(QStringList{"M"}),
+            std::make_shared<ISAInfo<ISA::RV64I>>(QStringList{"M", "C"})};
+  }
+  std::vector<BenchISA> res;
+  for (const auto &isa : isas)
+    res.push_back({isa, constructAssemblerDynamic(isa)});
+  return res;
+}
+
+QStringList readLines(const QString &path) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    return {};
+  return QString(file.readAll()).split(QRegularExpression("[\r\n]"));
+}
+
+/// Returns each assembly file within @p dir as a separate input.
+std::vector<BenchInput> directoryInputs(const QString &name,
+                                        const QString &dir) {
+  std::vector<BenchInput> inputs;
+  for (const auto &file :
+       QDir(dir).entryInfoList({"*.s"}, QDir::Files, QDir::Name))
+    inputs.push_back({name + "/" + file.baseName(),
+                      readLines(file.absoluteFilePath())});
+  return inputs;
+}
+
+/// Returns a program of approximately @p lines lines, mixing instructions,
+/// pseudo-instructions, labels, expressions and data directives.
+BenchInput generatedInput(int lines) {
+  BenchInput input{"generated/" + QString::number(lines), {}};
+  auto &out = input.lines;
+  out << ".data";
+  for (int i = 0; i < lines / 10; i++)
+    out << "D" + QString::number(i) + ": .word " + QString::number(i) +
+               ", 0x10, " + QString::number(i * 3);
+  out << ".text";
+  for (int i = 0; out.size() < lines; i++) {
+    const QString label = "L" + QString::number(i);
+    out << label + ":"
+        << "addi a0, a0, " + QString::number(i % 1024)
+        << "lw a1, 8(sp)"
+        << "add a2, a0, a1"
+        << "la a3, D" + QString::number(i % (lines / 10))
+        << "li a4, " + QString::number(i * 4096 + 5)
+        << "slli a5, a4, (2 + 1)"
+        << "sw a5, 12(sp)"
+        << "beq a0, a1, " + label
+        << "jal ra, " + label;
+  }
+  return input;
+}
+
+template <typename F>
+double bestOf(int iterations, const F &f) {
+  double best = std::numeric_limits<double>::max();
+  for (int i = 0; i < iterations; i++) {
+    QElapsedTimer timer;
+    timer.start();
+    f();
+    best = std::min(best, timer.nsecsElapsed() / 1e9);
+  }
+  return best;
+}
+
+QJsonObject benchAssemble(const BenchISA &isa, const BenchInput &input,
+                          int iterations) {
+  AssembleResult res;
+  const double seconds = bestOf(iterations, [&] {
+    res = isa.assembler->assemble(input.lines);
+  });
+  const double instructions = res.program.sourceMapping.size();
+  QJsonObject obj;
+  obj["isa"] = isa.isa->name();
+  obj["input"] = input.name;
+  obj["lines"] = input.lines.size();
+  obj["instructions"] = instructions;
+  obj["errors"] = static_cast<int>(res.errors.size());
+  obj["seconds"] = seconds;
+  obj["linesPerSec"] = input.lines.size() / seconds;
+  obj["instructionsPerSec"] = instructions / seconds;
+  return obj;
+}
+
+QJsonObject benchDisassemble(const BenchISA &isa, const QString &name,
+                             const QByteArray &text, AInt address,
+                             int iterations) {
+  const ReverseSymbolMap symbols;
+  const unsigned alignment = isa.isa->instrByteAlignment();
+  unsigned instructions = 0;
+  const double seconds = bestOf(iterations, [&] {
+    instructions = 0;
+    for (int offset = 0; offset < text.size();) {
+      VInt word = 0;
+      const int bytes = std::min<int>(sizeof(uint32_t), text.size() - offset);
+      memcpy(&word, text.constData() + offset, bytes);
+      const auto res =
+          isa.assembler->disassemble(word, symbols, address + offset);
+      offset += std::max(res.bytesDisassembled, alignment);
+      instructions++;
+    }
+  });
+  QJsonObject obj;
+  obj["isa"] = isa.isa->name();
+  obj["input"] = name;
+  obj["bytes"] = text.size();
+  obj["instructions"] = static_cast<int>(instructions);
+  obj["seconds"] = seconds;
+  obj["instructionsPerSec"] = instructions / seconds;
+  return obj;
+}
+
+QJsonObject benchMatcher(const BenchISA &isa, int words, int iterations) {
+  // Words are drawn such that roughly half of them match an instruction; the
+  // opcodes of uniformly random words are mostly unused.
+  std::mt19937 gen(1);
+  std::vector<VInt> input;
+  const auto &instructions = isa.assembler->getInstructionSet();
+  for (int i = 0; i < words; i++) {
+    VInt word = gen();
+    if (i % 2 == 0) {
+      const auto &instr = instructions.at(gen() % instructions.size());
+      word = (word & ~instr->opcodeMask()) | instr->opcodeValue();
+    }
+    input.push_back(word);
+  }
+
+  unsigned matched = 0;
+  const double seconds = bestOf(iterations, [&] {
+    matched = 0;
+    for (const VInt word : input)
+      matched += isa.assembler->instructionSize(word) != 0;
+  });
+  QJsonObject obj;
+  obj["isa"] = isa.isa->name();
+  obj["words"] = words;
+  obj["matched"] = static_cast<int>(matched);
+  obj["seconds"] = seconds;
+  obj["wordsPerSec"] = words / seconds;
+  return obj;
+}
+
+/// Returns the .text section of the ELF file at @p path, and whether it is a
+/// 64-bit ELF file.
+bool loadText(const QString &path, QByteArray &text, AInt &address,
+              bool &is64) {
+  ELFIO::elfio reader;
+  if (!reader.load(path.toStdString()))
+    return false;
+  for (const auto &section : reader.sections) {
+    if (section->get_name() != ".text")
+      continue;
+    text = QByteArray(section->get_data(),
+                      static_cast<int>(section->get_size()));
+    address = section->get_address();
+    is64 = reader.get_class() == ELFIO::ELFCLASS64;
+    return true;
+  }
+  return false;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  QCoreApplication app(argc, argv);
+  QCommandLineParser parser;
+  parser.setApplicationDescription(
+      "Measures the throughput of the Ripes assembler and disassembler.");
+  parser.addHelpOption();
+  QCommandLineOption jsonOption("json", "Write the results to <path>.",
+                                "path");
+  QCommandLineOption iterationsOption(
+      "iterations", "Repetitions of each benchmark (default: 5).", "n", "5");
+  QCommandLineOption linesOption(
+      "lines", "Lines of the generated program (default: 100000).", "n",
+      "100000");
+  QCommandLineOption elfOption(
+      "elf", "Additionally disassemble the .text section of <path>.", "path");
+  parser.addOptions({jsonOption, iterationsOption, linesOption, elfOption});
+  parser.process(app);
+
+  const int iterations = std::max(1, parser.value(iterationsOption).toInt());
+  const int lines = std::max(100, parser.value(linesOption).toInt());
+
+  std::map<unsigned, std::vector<BenchInput>> inputs;
+  for (unsigned bits : {32, 64}) {
+    auto &bitInputs = inputs[bits];
+    for (const auto &input :
+         directoryInputs("examples", EXAMPLES_DIR "/assembly"))
+      bitInputs.push_back(input);
+    bitInputs.push_back(generatedInput(lines));
+  }
+  const std::map<unsigned, QStringList> testDirs = {
+      {32, {RISCV32_TEST_DIR, RISCV32_C_TEST_DIR}},
+      {64, {RISCV64_TEST_DIR, RISCV64_C_TEST_DIR}}};
+  for (const auto &[bits, dirs] : testDirs) {
+    for (const auto &dir : dirs) {
+      for (const auto &input :
+           directoryInputs("riscv-tests/" + QDir(dir).dirName(), dir))
+        inputs[bits].push_back(input);
+    }
+  }
+
+  QJsonArray assembleResults, disassembleResults, matcherResults;
+  std::map<unsigned, std::vector<BenchISA>> isas;
+  for (unsigned bits : {32, 64}) {
+    isas[bits] = benchISAs(bits);
+    for (const auto &isa : isas[bits]) {
+      for (const auto &input : inputs[bits])
+        assembleResults.append(benchAssemble(isa, input, iterations));
+      matcherResults.append(benchMatcher(isa, 1 << 20, iterations));
+    }
+  }
+
+  QStringList elfFiles = {EXAMPLES_DIR "/ELF/RanPi-RV32",
+                          EXAMPLES_DIR "/ELF/RanPi-RV64"};
+  elfFiles << parser.values(elfOption);
+  for (const auto &elfFile : elfFiles) {
+    QByteArray text;
+    AInt address;
+    bool is64;
+    if (!loadText(elfFile, text, address, is64)) {
+      std::cerr << "Could not load .text of " << elfFile.toStdString()
+                << std::endl;
+      return 1;
+    }
+    // Compressed instructions are to be expected in any compiled program.
+    const auto &isa = isas.at(is64 ? 64 : 32).back();
+    disassembleResults.append(benchDisassemble(
+        isa, QFileInfo(elfFile).fileName(), text, address, iterations));
+  }
+
+  QJsonObject results;
+  results["iterations"] = iterations;
+  results["assemble"] = assembleResults;
+  results["disassemble"] = disassembleResults;
+  results["matcher"] = matcherResults;
+  const QByteArray json = QJsonDocument(results).toJson();
+
+  if (parser.isSet(jsonOption)) {
+    QFile file(parser.value(jsonOption));
+    if (!file.open(QIODevice::WriteOnly)) {
+      std::cerr << "Could not write " << file.fileName().toStdString()
+                << std::endl;
+      return 1;
+    }
+    file.write(json);
+  } else {
+    std::cout << json.toStdString();
+  }
+  return 0;
+}
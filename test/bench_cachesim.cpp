@@ -0,0 +1,284 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+#include <random>
+
+#include "benchutils.h"
+#include "cachesim/cachesim.h"
+#include "processorhandler.h"
+
+using namespace Ripes;
+
+/**
+ * Throughput benchmarks of the cache simulator, independent of the processor
+ * models. Synthetic access patterns are driven through CacheSim::access for
+ * each combination of cache geometry and replacement policy, first for a
+ * number of untimed warmup runs and then for a number of timed repetitions, of
+ * which the fastest and the median are reported.
+ *
+ * The caches are configured as for trace-driven simulation, ie. without access
+ * history. The addresses of a pattern are generated before timing. Results are
+ * written as JSON, for tracking regressions of the cache data structures.
+ */
+
+namespace {
+
+// Size of the nodes visited by the pointer-chasing pattern.
+constexpr unsigned s_nodeBytes = 64;
+// Every s_writeInterval'th access of a writing pattern is a write.
+constexpr unsigned s_writeInterval = 4;
+
+struct Pattern {
+  QString name;
+  std::vector<AInt> addresses;
+  bool writes;
+};
+
+struct Geometry {
+  QString name;
+  int blocks; // log2
+  int lines;  // log2
+  int ways;   // log2
+};
+
+struct RunResult {
+  double seconds = 0;
+  unsigned hits = 0;
+  unsigned misses = 0;
+  unsigned writebacks = 0;
+  size_t stateBytes = 0;
+};
+
+std::vector<Pattern> buildPatterns(size_t accesses, AInt footprint,
+                                   AInt stride) {
+  std::vector<Pattern> patterns;
+  std::mt19937 rng(1);
+  const AInt words = footprint / 4;
+
+  Pattern sequential{"sequential", {}, true};
+  Pattern strided{"strided", {}, true};
+  Pattern random{"random", {}, true};
+  for (size_t i = 0; i < accesses; ++i) {
+    sequential.addresses.push_back((i % words) * 4);
+    strided.addresses.push_back((i * stride) % footprint);
+    random.addresses.push_back((rng() % words) * 4);
+  }
+
+  // The nodes are linked in a single cycle of random order (Sattolo's
+  // algorithm), such that each access depends on the node loaded by the
+  // preceding access.
+  const unsigned nodes = std::max<AInt>(footprint / s_nodeBytes, 2);
+  std::vector<unsigned> next(nodes);
+  std::iota(next.begin(), next.end(), 0);
+  for (unsigned i = nodes - 1; i > 0; --i)
+    std::swap(next[i], next[rng() % i]);
+  Pattern chase{"pointerchase", {}, false};
+  unsigned node = 0;
+  for (size_t i = 0; i < accesses; ++i) {
+    chase.addresses.push_back(AInt(node) * s_nodeBytes);
+    node = next[node];
+  }
+
+  patterns.push_back(std::move(sequential));
+  patterns.push_back(std::move(strided));
+  patterns.push_back(std::move(random));
+  patterns.push_back(std::move(chase));
+  return patterns;
+}
+
+RunResult run(const Geometry &geometry, ReplPolicy policy,
+              const Pattern &pattern) {
+  CacheSim cache(nullptr);
+  cache.setPreset({"", geometry.blocks, geometry.lines, geometry.ways,
+                   WritePolicy::WriteBack, WriteAllocPolicy::WriteAllocate,
+                   policy});
+  cache.setRecordHistory(false);
+
+  RunResult res;
+  QElapsedTimer timer;
+  timer.start();
+  const auto &addresses = pattern.addresses;
+  for (size_t i = 0; i < addresses.size(); ++i) {
+    const bool write = pattern.writes && i % s_writeInterval == 0;
+    cache.access(addresses[i],
+                 write ? MemoryAccess::Write : MemoryAccess::Read);
+  }
+  res.seconds = timer.nsecsElapsed() / 1e9;
+  res.hits = cache.getHits();
+  res.misses = cache.getMisses();
+  res.writebacks = cache.getWritebacks();
+  res.stateBytes = cache.getStateBytes();
+  return res;
+}
+
+QJsonObject benchmark(const Geometry &geometry,
+                      const std::pair<QString, ReplPolicy> &policy,
+                      const Pattern &pattern, int warmup, int repetitions) {
+  for (int i = 0; i < warmup; i++)
+    run(geometry, policy.second, pattern);
+  std::vector<double> seconds;
+  RunResult res;
+  for (int i = 0; i < repetitions; i++) {
+    res = run(geometry, policy.second, pattern);
+    seconds.push_back(res.seconds);
+  }
+  std::sort(seconds.begin(), seconds.end());
+  const double best = seconds.front();
+  const double median = seconds.at(seconds.size() / 2);
+  const double accesses = pattern.addresses.size();
+
+  QJsonObject obj;
+  obj["geometry"] = geometry.name;
+  obj["policy"] = policy.first;
+  obj["pattern"] = pattern.name;
+  obj["accesses"] = accesses;
+  obj["hits"] = qint64(res.hits);
+  obj["misses"] = qint64(res.misses);
+  obj["writebacks"] = qint64(res.writebacks);
+  obj["hitRate"] = accesses == 0 ? 0 : res.hits / accesses;
+  obj["seconds"] = best;
+  obj["medianSeconds"] = median;
+  obj["accessesPerSec"] = best == 0 ? 0 : accesses / best;
+  obj["stateBytes"] = qint64(res.stateBytes);
+  // The peak of the process, ie. of this and all preceding benchmarks.
+  obj["peakRSSBytes"] = peakRSS();
+  return obj;
+}
+
+/// Parses a geometry given as <blocks>:<lines>:<ways> in log2 values, as the
+/// --cache option of the CLI.
+bool parseGeometry(const QString &spec, Geometry &geometry) {
+  const QStringList values = spec.split(":");
+  if (values.size() != 3)
+    return false;
+  bool ok[3];
+  geometry = {spec, values[0].toInt(&ok[0]), values[1].toInt(&ok[1]),
+              values[2].toInt(&ok[2])};
+  return ok[0] && ok[1] && ok[2] && geometry.blocks >= 0 &&
+         geometry.lines >= 0 && geometry.ways >= 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  QCoreApplication app(argc, argv);
+  QCommandLineParser parser;
+  parser.setApplicationDescription(
+      "Measures the throughput of the Ripes cache simulator.");
+  parser.addHelpOption();
+  QCommandLineOption jsonOption("json", "Write the results to <path>.",
+                                "path");
+  QCommandLineOption warmupOption(
+      "warmup", "Untimed runs of each benchmark (default: 1).", "n", "1");
+  QCommandLineOption repetitionsOption(
+      "repetitions", "Timed runs of each benchmark (default: 3).", "n", "3");
+  QCommandLineOption accessesOption(
+      "accesses", "Accesses of each pattern (default: 4000000).", "n",
+      "4000000");
+  QCommandLineOption footprintOption(
+      "footprint", "Bytes spanned by each pattern (default: 1048576).", "n",
+      "1048576");
+  QCommandLineOption strideOption(
+      "stride", "Bytes between accesses of the strided pattern (default: 256).",
+      "n", "256");
+  QCommandLineOption geometriesOption(
+      "geometries",
+      "Comma-separated cache geometries, as <blocks>:<lines>:<ways> in log2 "
+      "values (default: 2:5:0,2:5:2,3:7:3,4:8:4).",
+      "specs", "2:5:0,2:5:2,3:7:3,4:8:4");
+  QCommandLineOption policiesOption(
+      "policies", "Comma-separated replacement policies (default: all).",
+      "names");
+  parser.addOptions({jsonOption, warmupOption, repetitionsOption,
+                     accessesOption, footprintOption, strideOption,
+                     geometriesOption, policiesOption});
+  parser.process(app);
+
+  const int warmup = std::max(0, parser.value(warmupOption).toInt());
+  const int repetitions = std::max(1, parser.value(repetitionsOption).toInt());
+  const size_t accesses =
+      std::max(1LL, parser.value(accessesOption).toLongLong());
+  const AInt footprint =
+      std::max(4LL, parser.value(footprintOption).toLongLong()) & ~AInt(3);
+  const AInt stride =
+      std::max(4LL, parser.value(strideOption).toLongLong()) & ~AInt(3);
+
+  std::vector<Geometry> geometries;
+  for (const auto &spec : parser.value(geometriesOption).split(',')) {
+    Geometry geometry;
+    if (!parseGeometry(spec, geometry)) {
+      std::cerr << "Invalid cache geometry: " << spec.toStdString()
+                << std::endl;
+      return 1;
+    }
+    geometries.push_back(geometry);
+  }
+
+  const std::vector<std::pair<QString, ReplPolicy>> allPolicies = {
+      {"random", ReplPolicy::Random}, {"lru", ReplPolicy::LRU},
+      {"plru", ReplPolicy::PLRU},     {"fifo", ReplPolicy::FIFO},
+      {"srrip", ReplPolicy::SRRIP},   {"brrip", ReplPolicy::BRRIP}};
+  std::vector<std::pair<QString, ReplPolicy>> policies;
+  if (parser.isSet(policiesOption)) {
+    for (const auto &name : parser.value(policiesOption).split(',')) {
+      auto it = std::find_if(allPolicies.begin(), allPolicies.end(),
+                             [&](const auto &p) { return p.first == name; });
+      if (it == allPolicies.end()) {
+        std::cerr << "Invalid replacement policy: " << name.toStdString()
+                  << std::endl;
+        return 1;
+      }
+      policies.push_back(*it);
+    }
+  } else {
+    policies = allPolicies;
+  }
+
+  // Caches bind to the memory of the current processor.
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_SS);
+  const auto patterns = buildPatterns(accesses, footprint, stride);
+
+  QJsonArray results;
+  for (const auto &geometry : geometries) {
+    for (const auto &policy : policies) {
+      for (const auto &pattern : patterns) {
+        const auto result =
+            benchmark(geometry, policy, pattern, warmup, repetitions);
+        std::cerr << geometry.name.toStdString() << " "
+                  << policy.first.toStdString() << " "
+                  << pattern.name.toStdString() << ": "
+                  << qint64(result["accessesPerSec"].toDouble())
+                  << " accesses/s" << std::endl;
+        results.append(result);
+      }
+    }
+  }
+
+  QJsonObject report;
+  report["warmup"] = warmup;
+  report["repetitions"] = repetitions;
+  report["footprint"] = qint64(footprint);
+  report["results"] = results;
+  const QByteArray json = QJsonDocument(report).toJson();
+
+  if (parser.isSet(jsonOption)) {
+    QFile file(parser.value(jsonOption));
+    if (!file.open(QIODevice::WriteOnly)) {
+      std::cerr << "Could not write " << file.fileName().toStdString()
+                << std::endl;
+      return 1;
+    }
+    file.write(json);
+  } else {
+    std::cout << json.toStdString();
+  }
+  return 0;
+}
@@ -0,0 +1,398 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <set>
+
+#include "assembler/assembler.h"
+#include "isa/rv32isainfo.h"
+#include "isa/rv64isainfo.h"
+#include "processorhandler.h"
+#include "processorregistry.h"
+
+using namespace Ripes;
+using namespace Assembler;
+
+/**
+ * Stress benchmarks of the assembler, the disassembler and the processor
+ * models on randomly generated instruction streams. For each instruction set
+ * and set of extensions, random valid instruction words are drawn from the
+ * instructions of the enabled extensions, and are then
+ *  - disassembled to assembly source,
+ *  - assembled back, verifying that the encoding round-trips,
+ *  - assembled again interleaved with labels, forward branches and large
+ *    immediates, to stress the symbol table and the expression evaluator at
+ *    scale,
+ *  - run on the functional engine (the ISS) and on a pipelined model,
+ *    verifying that both end in the same register state.
+ *
+ * The throughput of each stage is reported, being the fastest of a number of
+ * repetitions. The executed instructions are restricted to those without
+ * memory, control flow or system effects, such that any random stream runs to
+ * completion. Results are written as JSON.
+ */
+
+namespace {
+
+struct Target {
+  QString name;
+  unsigned bits;
+  ProcessorID functional;
+  ProcessorID pipelined;
+};
+
+struct Stream {
+  std::vector<VInt> words;
+  std::vector<unsigned> sizes;
+  QStringList lines;
+  unsigned drawn = 0;
+};
+
+// Major opcodes of 32-bit instructions which only compute registers.
+const std::set<unsigned> s_computeOpcodes = {
+    0b0010011, // OP-IMM
+    0b0110011, // OP
+    0b0110111, // LUI
+    0b0010111, // AUIPC
+    0b0011011, // OP-IMM-32
+    0b0111011, // OP-32
+};
+
+// Compressed instructions which only compute registers.
+const std::set<QString> s_computeCompressed = {
+    "c.addi4spn", "c.nop", "c.addi", "c.addiw", "c.li",  "c.addi16sp",
+    "c.lui",      "c.srli", "c.srai", "c.andi", "c.sub", "c.xor",
+    "c.or",       "c.and",  "c.subw", "c.addw", "c.slli", "c.mv",
+    "c.add"};
+
+template <typename F>
+double bestOf(int iterations, const F &f) {
+  double best = std::numeric_limits<double>::max();
+  for (int i = 0; i < iterations; i++) {
+    QElapsedTimer timer;
+    timer.start();
+    f();
+    best = std::min(best, timer.nsecsElapsed() / 1e9);
+  }
+  return best;
+}
+
+std::shared_ptr<const ISAInfoBase> makeISA(unsigned bits,
+                                           const QStringList &extensions) {
+  if (bits == 32)
+    return std::make_shared<ISAInfo<ISA::RV32I>>(extensions);
+  return std::make_shared<ISAInfo<ISA::RV64I>>(extensions);
+}
+
+bool isCompute(VInt word, const QString &mnemonic) {
+  if ((word & 0b11) == 0b11)
+    return s_computeOpcodes.count(word & 0x7F) != 0;
+  return s_computeCompressed.count(mnemonic) != 0;
+}
+
+/// Draws @p count random instruction words which the matcher accepts and
+/// which disassemble without error. Only compute instructions are kept.
+Stream generate(const AssemblerBase &assembler, unsigned count,
+                std::mt19937_64 &rng) {
+  const ReverseSymbolMap symbols;
+  const auto &instructions = assembler.getInstructionSet();
+  Stream stream;
+  while (stream.words.size() < count) {
+    stream.drawn++;
+    const auto &instr = instructions.at(rng() % instructions.size());
+    VInt word = (rng() & ~VInt(instr->opcodeMask())) | instr->opcodeValue();
+    word &= instr->size() == 2 ? 0xFFFF : 0xFFFFFFFF;
+    const unsigned size = assembler.instructionSize(word);
+    if (size == 0)
+      continue;
+    const auto res = assembler.disassemble(word, symbols, 0);
+    if (res.err || !isCompute(word, res.repr.section(' ', 0, 0)))
+      continue;
+    stream.words.push_back(word);
+    stream.sizes.push_back(size);
+  }
+  return stream;
+}
+
+/// Returns the number of instructions of @p stream which were not encoded as
+/// drawn in @p text.
+unsigned roundtripMismatches(const Stream &stream, const QByteArray &text) {
+  unsigned mismatches = 0;
+  int offset = 0;
+  for (size_t i = 0; i < stream.words.size(); ++i) {
+    const unsigned size = stream.sizes[i];
+    VInt encoded = 0;
+    if (offset + static_cast<int>(size) <= text.size())
+      memcpy(&encoded, text.constData() + offset, size);
+    else
+      encoded = ~stream.words[i];
+    mismatches += encoded != stream.words[i];
+    offset += size;
+  }
+  return mismatches;
+}
+
+/// Interleaves the instructions of @p stream with a label every
+/// @p labelInterval instructions, each followed by a forward branch to one of
+/// the following labels and the load of a large immediate.
+QStringList stressProgram(const Stream &stream, unsigned bits,
+                          unsigned labelInterval, std::mt19937_64 &rng) {
+  // The branch targets are within the range of a conditional branch.
+  constexpr unsigned maxLabelDistance = 16;
+  const unsigned labels =
+      (stream.lines.size() + labelInterval - 1) / labelInterval;
+  auto reg = [&] { return "x" + QString::number(5 + rng() % 27); };
+
+  QStringList out = {".text"};
+  for (unsigned i = 0; i < stream.lines.size(); ++i) {
+    if (i % labelInterval == 0) {
+      const unsigned label = i / labelInterval;
+      const unsigned target =
+          std::min(labels, label + 1 + unsigned(rng() % maxLabelDistance));
+      const qint64 imm = bits == 32 ? qint64(qint32(rng())) : qint64(rng());
+      out << "L" + QString::number(label) + ":"
+          << "bne " + reg() + ", " + reg() + ", L" + QString::number(target)
+          << "li " + reg() + ", " + QString::number(imm)
+          << "addi " + reg() + ", " + reg() + ", ((" +
+                 QString::number(label % 64) + " << 4) - " +
+                 QString::number(label % 64) + " * 3) + 7";
+    }
+    out << stream.lines[i];
+  }
+  out << "L" + QString::number(labels) + ":"
+      << "li a7, 10"
+      << "ecall";
+  return out;
+}
+
+struct ExecResult {
+  double seconds = 0;
+  long long cycles = 0;
+  long long instructions = 0;
+  bool finished = false;
+  std::vector<VInt> gprs;
+};
+
+ExecResult execute(ProcessorID id, const QStringList &extensions,
+                   const QStringList &program, long long maxCycles,
+                   int iterations, QString &error) {
+  ProcessorHandler::selectProcessor(id, extensions);
+  const auto res = ProcessorHandler::getAssembler()->assemble(program);
+  if (!res.errors.empty()) {
+    error = "Failed to assemble: " + res.errors.front().errorMessage();
+    return {};
+  }
+  const auto shared = std::make_shared<Program>(res.program);
+
+  ExecResult exec;
+  exec.seconds = bestOf(iterations, [&] {
+    ProcessorHandler::loadProgram(shared);
+    auto *proc = ProcessorHandler::getProcessorNonConst();
+    if (auto *design = dynamic_cast<vsrtl::SimDesign *>(proc))
+      design->setEnableSignals(false);
+    while (!proc->finished() && proc->getCycleCount() < maxCycles) {
+      if (proc->clockN(std::min<long long>(
+              1024, maxCycles - proc->getCycleCount())) == 0)
+        break;
+    }
+  });
+  auto *proc = ProcessorHandler::getProcessorNonConst();
+  if (auto *design = dynamic_cast<vsrtl::SimDesign *>(proc))
+    design->setEnableSignals(true);
+  exec.cycles = proc->getCycleCount();
+  exec.instructions = proc->getInstructionsRetired();
+  exec.finished = proc->finished();
+  for (unsigned i = 0; i < 32; ++i)
+    exec.gprs.push_back(proc->getRegister(RVISA::GPR, i));
+  return exec;
+}
+
+QJsonObject benchmark(const Target &target, const QStringList &extensions,
+                      unsigned count, unsigned labelInterval, int iterations,
+                      std::mt19937_64 &rng) {
+  QJsonObject obj;
+  obj["target"] = target.name;
+  obj["extensions"] = extensions.join("");
+
+  const auto isa = makeISA(target.bits, extensions);
+  const auto assembler = constructAssemblerDynamic(isa);
+
+  QElapsedTimer timer;
+  timer.start();
+  Stream stream = generate(*assembler, count, rng);
+  QJsonObject gen;
+  gen["seconds"] = timer.nsecsElapsed() / 1e9;
+  gen["drawn"] = static_cast<qint64>(stream.drawn);
+  gen["accepted"] = static_cast<qint64>(stream.words.size());
+  obj["generate"] = gen;
+
+  const ReverseSymbolMap symbols;
+  QJsonObject dis;
+  dis["seconds"] = bestOf(iterations, [&] {
+    stream.lines.clear();
+    for (const VInt word : stream.words)
+      stream.lines << assembler->disassemble(word, symbols, 0).repr;
+  });
+  dis["instructionsPerSec"] = stream.words.size() / dis["seconds"].toDouble();
+  obj["disassemble"] = dis;
+
+  QStringList source = {".text"};
+  source << stream.lines;
+  AssembleResult res;
+  QJsonObject as;
+  as["seconds"] =
+      bestOf(iterations, [&] { res = assembler->assemble(source); });
+  as["linesPerSec"] = source.size() / as["seconds"].toDouble();
+  as["errors"] = static_cast<int>(res.errors.size());
+  const auto text = res.program.getSection(".text");
+  as["mismatches"] = static_cast<int>(
+      roundtripMismatches(stream, text ? text->data : QByteArray()));
+  obj["assemble"] = as;
+
+  const QStringList program =
+      stressProgram(stream, target.bits, labelInterval, rng);
+  QJsonObject stress;
+  stress["lines"] = program.size();
+  stress["labels"] = static_cast<qint64>(
+      (stream.lines.size() + labelInterval - 1) / labelInterval);
+  stress["seconds"] =
+      bestOf(iterations, [&] { res = assembler->assemble(program); });
+  stress["linesPerSec"] = program.size() / stress["seconds"].toDouble();
+  stress["errors"] = static_cast<int>(res.errors.size());
+  obj["stress"] = stress;
+  if (!res.errors.empty()) {
+    obj["status"] = "Failed to assemble: " + res.errors.front().errorMessage();
+    return obj;
+  }
+
+  // Each instruction retires at most once; the bound only guards against a
+  // model which stalls indefinitely.
+  const long long maxCycles = 64LL * program.size();
+  QJsonArray execs;
+  std::vector<std::vector<VInt>> gprs;
+  for (const auto id : {target.functional, target.pipelined}) {
+    QString error;
+    const ExecResult exec =
+        execute(id, extensions, program, maxCycles, iterations, error);
+    QJsonObject e;
+    e["processor"] = enumToString<ProcessorID>(id);
+    if (!error.isEmpty()) {
+      e["status"] = error;
+      execs.append(e);
+      continue;
+    }
+    e["status"] = exec.finished ? "ok" : "cycle limit";
+    e["cycles"] = exec.cycles;
+    e["instructions"] = exec.instructions;
+    e["seconds"] = exec.seconds;
+    e["instructionsPerSec"] = exec.instructions / exec.seconds;
+    execs.append(e);
+    gprs.push_back(exec.gprs);
+  }
+  obj["execute"] = execs;
+
+  int gprMismatches = 0;
+  if (gprs.size() == 2) {
+    for (unsigned i = 0; i < 32; ++i)
+      gprMismatches += gprs[0][i] != gprs[1][i];
+  }
+  obj["gprMismatches"] = gprMismatches;
+  obj["status"] = "ok";
+  return obj;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  QCoreApplication app(argc, argv);
+  QCommandLineParser parser;
+  parser.setApplicationDescription(
+      "Stresses the Ripes assembler, disassembler and processor models with "
+      "random instruction streams.");
+  parser.addHelpOption();
+  QCommandLineOption jsonOption("json", "Write the results to <path>.",
+                                "path");
+  QCommandLineOption iterationsOption(
+      "iterations", "Repetitions of each stage (default: 3).", "n", "3");
+  QCommandLineOption instructionsOption(
+      "instructions", "Instructions of each stream (default: 200000).", "n",
+      "200000");
+  QCommandLineOption labelsOption(
+      "labelinterval",
+      "Instructions between labels of the stress program (default: 4).", "n",
+      "4");
+  QCommandLineOption seedOption(
+      "seed", "Seed of the random generator (default: 1).", "n", "1");
+  parser.addOptions({jsonOption, iterationsOption, instructionsOption,
+                     labelsOption, seedOption});
+  parser.process(app);
+
+  const int iterations = std::max(1, parser.value(iterationsOption).toInt());
+  const unsigned count = std::max(1, parser.value(instructionsOption).toInt());
+  const unsigned labelInterval =
+      std::max(1, parser.value(labelsOption).toInt());
+  std::mt19937_64 rng(parser.value(seedOption).toULongLong());
+
+  const std::vector<Target> targets = {
+      {"rv32", 32, ProcessorID::RV32_ISS, ProcessorID::RV32_5S},
+      {"rv64", 64, ProcessorID::RV64_ISS, ProcessorID::RV64_5S}};
+
+  QJsonArray results;
+  for (const auto &target : targets) {
+    // Extensions are enabled incrementally, up to those supported by both
+    // models. The A and V extensions access memory, and are never drawn.
+    QStringList supported;
+    const auto functional =
+        ProcessorRegistry::getDescription(target.functional).isaInfo();
+    const auto pipelined =
+        ProcessorRegistry::getDescription(target.pipelined).isaInfo();
+    for (const auto &ext : pipelined.supportedExtensions)
+      if (functional.supportedExtensions.contains(ext) && ext != "A" &&
+          ext != "V")
+        supported << ext;
+
+    std::vector<QStringList> extensionSets = {{}};
+    for (const auto &ext : supported) {
+      QStringList next = extensionSets.back();
+      next << ext;
+      extensionSets.push_back(next);
+    }
+    for (const auto &extensions : extensionSets) {
+      const auto result = benchmark(target, extensions, count, labelInterval,
+                                    iterations, rng);
+      std::cerr << target.name.toStdString() << " "
+                << extensions.join("").toStdString() << ": "
+                << result["status"].toString().toStdString() << std::endl;
+      results.append(result);
+    }
+  }
+
+  QJsonObject report;
+  report["iterations"] = iterations;
+  report["instructions"] = static_cast<qint64>(count);
+  report["seed"] = parser.value(seedOption);
+  report["results"] = results;
+  const QByteArray json = QJsonDocument(report).toJson();
+
+  if (parser.isSet(jsonOption)) {
+    QFile file(parser.value(jsonOption));
+    if (!file.open(QIODevice::WriteOnly)) {
+      std::cerr << "Could not write " << file.fileName().toStdString()
+                << std::endl;
+      return 1;
+    }
+    file.write(json);
+  } else {
+    std::cout << json.toStdString();
+  }
+  return 0;
+}
@@ -0,0 +1,289 @@
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QFontDatabase>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTimer>
+#include <QToolBar>
+#include <QWindow>
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <vector>
+
+#include "cachetab.h"
+#include "cli/clioptions.h"
+#include "memorytab.h"
+#include "pipelinediagrammodel.h"
+#include "pipelinediagramwidget.h"
+#include "processorhandler.h"
+#include "processorregistry.h"
+#include "processortab.h"
+
+using namespace Ripes;
+
+/**
+ * Responsiveness benchmark of the GUI. The processor view, pipeline diagram,
+ * memory view and cache view are shown at once, each in a window of its own,
+ * whilst a workload is run for a number of cycles. A frame is the delivery of
+ * an update request to one of the windows, ie. the repaint of the window, and
+ * is timed from the event loop. The frames rendered, the mean and 99th
+ * percentile frame time, and the cycles simulated per second are reported for
+ * each processor model, such that changes to the refresh throttling of the
+ * ProcessorHandler, the diffing of the models and incremental repaints are
+ * measured objectively.
+ *
+ * Runs in display-less environments through the offscreen platform, ie. with
+ * QT_QPA_PLATFORM=offscreen.
+ */
+
+namespace {
+
+/// A workload of loads and stores to a buffer, looping until the run is
+/// stopped, such that the memory and cache views change with every iteration.
+const QString s_workload = QStringList{".data",
+                                       "buf: .zero 256",
+                                       ".text",
+                                       "  la t1, buf",
+                                       "  li t0, 0",
+                                       "loop:",
+                                       "  andi t2, t0, 63",
+                                       "  slli t2, t2, 2",
+                                       "  add t2, t1, t2",
+                                       "  sw t0, 0(t2)",
+                                       "  lw t3, 0(t2)",
+                                       "  addi t0, t0, 1",
+                                       "  j loop"}
+                               .join("\n");
+
+/// Times the delivery of update requests to the top-level windows of the
+/// views being benchmarked.
+class FrameTimingApplication : public QApplication {
+public:
+  using QApplication::QApplication;
+
+  void addView(const QString &name, QWidget *view) { m_views[view] = name; }
+  void setRecording(bool recording) { m_recording = recording; }
+  /// The recorded frame times in nanoseconds, per view.
+  std::map<QString, std::vector<qint64>> takeFrames() {
+    return std::move(m_frames);
+  }
+
+  bool notify(QObject *receiver, QEvent *event) override {
+    if (!m_recording || m_inFrame || event->type() != QEvent::UpdateRequest)
+      return QApplication::notify(receiver, event);
+    const QString *view = findView(receiver);
+    if (!view)
+      return QApplication::notify(receiver, event);
+
+    m_inFrame = true;
+    QElapsedTimer timer;
+    timer.start();
+    const bool result = QApplication::notify(receiver, event);
+    m_frames[*view].push_back(timer.nsecsElapsed());
+    m_inFrame = false;
+    return result;
+  }
+
+private:
+  /// Update requests are delivered to either the window of a view, or to the
+  /// top-level widget itself.
+  const QString *findView(QObject *receiver) const {
+    for (const auto &[widget, name] : m_views) {
+      if (receiver == widget ||
+          (receiver->isWindowType() && receiver == widget->windowHandle()))
+        return &name;
+    }
+    return nullptr;
+  }
+
+  std::map<QWidget *, QString> m_views;
+  std::map<QString, std::vector<qint64>> m_frames;
+  bool m_recording = false;
+  bool m_inFrame = false;
+};
+
+struct FrameStats {
+  long long frames = 0;
+  double meanMs = 0;
+  double p99Ms = 0;
+  double maxMs = 0;
+};
+
+FrameStats frameStats(std::vector<qint64> ns) {
+  FrameStats stats;
+  stats.frames = ns.size();
+  if (ns.empty())
+    return stats;
+  std::sort(ns.begin(), ns.end());
+  qint64 total = 0;
+  for (const auto frame : ns)
+    total += frame;
+  stats.meanMs = total / 1e6 / ns.size();
+  stats.p99Ms = ns.at(std::min(ns.size() - 1, ns.size() * 99 / 100)) / 1e6;
+  stats.maxMs = ns.back() / 1e6;
+  return stats;
+}
+
+QJsonObject toJson(const FrameStats &stats) {
+  QJsonObject obj;
+  obj["frames"] = stats.frames;
+  obj["meanFrameMs"] = stats.meanMs;
+  obj["p99FrameMs"] = stats.p99Ms;
+  obj["maxFrameMs"] = stats.maxMs;
+  return obj;
+}
+
+/// Runs the workload on the current processor for @p cycles cycles, with all
+/// views shown.
+QJsonObject benchmark(FrameTimingApplication &app, ProcessorID id,
+                      long long cycles) {
+  QJsonObject obj;
+  obj["processor"] = enumToString<ProcessorID>(id);
+  const auto res = ProcessorHandler::getAssembler()->assembleRaw(s_workload);
+  if (!res.errors.empty()) {
+    obj["status"] = "skipped";
+    obj["error"] = "Failed to assemble: " + res.errors.front().errorMessage();
+    return obj;
+  }
+  ProcessorHandler::loadProgram(std::make_shared<Program>(res.program));
+  // Let the views settle on the loaded program before timing them.
+  QEventLoop settle;
+  QTimer::singleShot(500, &settle, &QEventLoop::quit);
+  settle.exec();
+
+  QEventLoop loop;
+  QObject::connect(ProcessorHandler::get(), &ProcessorHandler::runFinished,
+                   &loop, &QEventLoop::quit);
+  ProcessorHandler::setRunLimits({cycles, 0});
+  app.setRecording(true);
+  QElapsedTimer timer;
+  timer.start();
+  // Started from the event loop, as the GUI does.
+  QTimer::singleShot(0, &loop, [] { ProcessorHandler::run(); });
+  loop.exec();
+  const double seconds = timer.nsecsElapsed() / 1e9;
+  app.setRecording(false);
+  ProcessorHandler::setRunLimits({});
+
+  const auto frames = app.takeFrames();
+  std::vector<qint64> allFrames;
+  QJsonObject views;
+  for (const auto &[name, ns] : frames) {
+    allFrames.insert(allFrames.end(), ns.begin(), ns.end());
+    views[name] = toJson(frameStats(ns));
+  }
+  const long long simulated = ProcessorHandler::getProcessor()->getCycleCount();
+  obj = toJson(frameStats(allFrames));
+  obj["processor"] = enumToString<ProcessorID>(id);
+  obj["status"] = "ok";
+  obj["cycles"] = simulated;
+  obj["seconds"] = seconds;
+  obj["cyclesPerSec"] = simulated / seconds;
+  obj["framesPerSec"] = allFrames.size() / seconds;
+  obj["views"] = views;
+  return obj;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  Q_INIT_RESOURCE(icons);
+  Q_INIT_RESOURCE(layouts);
+  Q_INIT_RESOURCE(fonts);
+  FrameTimingApplication app(argc, argv);
+  QCommandLineParser parser;
+  parser.setApplicationDescription(
+      "Measures the responsiveness of the Ripes GUI whilst simulating.");
+  parser.addHelpOption();
+  QCommandLineOption jsonOption("json", "Write the results to <path>.",
+                                "path");
+  QCommandLineOption cyclesOption(
+      "cycles", "Cycles simulated for each processor (default: 2000000).", "n",
+      "2000000");
+  QCommandLineOption processorsOption(
+      "processors",
+      "Comma-separated processor models (default: RV32_5S,RV32_ISS).", "ids",
+      "RV32_5S,RV32_ISS");
+  parser.addOptions({jsonOption, cyclesOption, processorsOption});
+  parser.process(app);
+
+  const long long cycles =
+      std::max(1LL, parser.value(cyclesOption).toLongLong());
+  std::vector<ProcessorID> processors;
+  for (const auto &name : parser.value(processorsOption).split(',')) {
+    ProcessorID id;
+    QString error;
+    if (!parseProcessorID(name, id, error)) {
+      std::cerr << error.toStdString() << std::endl;
+      return 1;
+    }
+    processors.push_back(id);
+  }
+
+  QFontDatabase::addApplicationFont(
+      ":/fonts/Inconsolata/Inconsolata-Regular.ttf");
+  QFontDatabase::addApplicationFont(":/fonts/Inconsolata/Inconsolata-Bold.ttf");
+  ProcessorHandler::selectProcessor(
+      processors.front(),
+      ProcessorRegistry::getDescription(processors.front())
+          .isaInfo()
+          .defaultExtensions);
+
+  // Each view is shown in a window of its own, such that all are visible.
+  QToolBar controlToolbar, processorToolbar, cacheToolbar, memoryToolbar;
+  ProcessorTab processorTab(&controlToolbar, &processorToolbar);
+  CacheTab cacheTab(&cacheToolbar);
+  MemoryTab memoryTab(&memoryToolbar);
+  PipelineDiagramModel diagramModel;
+  PipelineDiagramWidget diagram(&diagramModel);
+  // The diagram is published as it would be for a live view.
+  QObject::connect(ProcessorHandler::get(),
+                   &ProcessorHandler::runStateRefreshed, &diagramModel,
+                   &PipelineDiagramModel::prepareForView);
+  const std::vector<std::pair<QString, QWidget *>> views = {
+      {"processor", &processorTab},
+      {"pipeline", &diagram},
+      {"memory", &memoryTab},
+      {"cache", &cacheTab}};
+  for (const auto &[name, view] : views) {
+    app.addView(name, view);
+    view->resize(1024, 768);
+    view->show();
+  }
+  for (RipesTab *tab : std::initializer_list<RipesTab *>{
+           &processorTab, &cacheTab, &memoryTab})
+    tab->tabVisibilityChanged(true);
+
+  QJsonArray results;
+  for (const auto id : processors) {
+    ProcessorHandler::selectProcessor(
+        id, ProcessorRegistry::getDescription(id).isaInfo().defaultExtensions);
+    const auto result = benchmark(app, id, cycles);
+    std::cerr << result["processor"].toString().toStdString() << ": "
+              << result["status"].toString().toStdString() << std::endl;
+    results.append(result);
+  }
+
+  QJsonObject report;
+  report["cycles"] = cycles;
+  report["results"] = results;
+  const QByteArray json = QJsonDocument(report).toJson();
+  if (parser.isSet(jsonOption)) {
+    QFile file(parser.value(jsonOption));
+    if (!file.open(QIODevice::WriteOnly)) {
+      std::cerr << "Could not write " << file.fileName().toStdString()
+                << std::endl;
+      return 1;
+    }
+    file.write(json);
+  } else {
+    std::cout << json.toStdString();
+  }
+  return 0;
+}
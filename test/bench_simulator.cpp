@@ -0,0 +1,392 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <map>
+
+#include "benchutils.h"
+#include "ccmanager.h"
+#include "cli/clioptions.h"
+#include "cli/programutilities.h"
+#include "processorhandler.h"
+#include "processorregistry.h"
+
+using namespace Ripes;
+
+/**
+ * Throughput benchmarks of the processor models. Each workload is run on every
+ * processor model, first a number of untimed warmup runs and then a number of
+ * timed repetitions, of which the fastest and the median are reported. Runs
+ * clock the processor in batches, as the GUI and the CLI do.
+ *
+ * The time spent in signals and observers is derived from clocking the first
+ * cycles of the workload again one at a time with the signals of the processor
+ * enabled, and comparing the time per cycle. Results are written as JSON, for
+ * tracking regressions across releases.
+ *
+ * Given a baseline (the JSON output of a previous run), the results are
+ * compared to it, failing if the throughput of any benchmark dropped by more
+ * than a threshold, or if its simulated CPI changed at all. The latter
+ * indicates a change of the timing of a processor model.
+ */
+
+namespace {
+
+// Cycles clocked between each notification of the batch observers.
+constexpr unsigned s_batchCycles = 1024;
+
+struct Workload {
+  QString name;
+  // Builds the program for the current processor; returns an error message on
+  // failure.
+  std::function<QString(std::shared_ptr<Program> &)> build;
+};
+
+struct RunResult {
+  double seconds = 0;
+  long long cycles = 0;
+  long long instructions = 0;
+  bool finished = false;
+};
+
+QString assemble(const QString &source, std::shared_ptr<Program> &program) {
+  const auto res = ProcessorHandler::getAssembler()->assembleRaw(source);
+  if (!res.errors.empty())
+    return "Failed to assemble: " + res.errors.front().errorMessage();
+  program = std::make_shared<Program>(res.program);
+  return QString();
+}
+
+QString assembleFile(const QString &path, std::shared_ptr<Program> &program) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    return "Could not open " + path;
+  return assemble(QString(file.readAll()), program);
+}
+
+QString loadElf(const QString &path, std::shared_ptr<Program> &program) {
+  program = std::make_shared<Program>();
+  return loadElfFile(*program, path);
+}
+
+/// A loop retiring approximately @p instructions instructions.
+QString syntheticLoop(long long instructions) {
+  return QStringList{".text", "  li t0, " + QString::number(instructions / 2),
+                     "loop:", "  addi t0, t0, -1", "  bnez t0, loop",
+                     "  li a7, 10", "  ecall"}
+      .join("\n");
+}
+
+/// Runs @p program to completion, or for at most @p maxCycles cycles.
+/// Per-cycle observers are notified once per batch, and the signals of
+/// VSRTL processors are disabled, unless @p observed is set, in which case
+/// the processor is clocked one cycle at a time with its signals enabled.
+RunResult run(const std::shared_ptr<Program> &program, long long maxCycles,
+              bool observed) {
+  ProcessorHandler::loadProgram(program);
+  auto *proc = ProcessorHandler::getProcessorNonConst();
+  auto *design = dynamic_cast<vsrtl::SimDesign *>(proc);
+  if (design)
+    design->setEnableSignals(observed);
+
+  RunResult res;
+  QElapsedTimer timer;
+  timer.start();
+  if (observed) {
+    while (!proc->finished() && proc->getCycleCount() < maxCycles)
+      proc->clock();
+  } else {
+    while (!proc->finished() && proc->getCycleCount() < maxCycles) {
+      const long long remaining = maxCycles - proc->getCycleCount();
+      if (proc->clockN(std::min<long long>(s_batchCycles, remaining)) == 0)
+        break;
+    }
+  }
+  res.seconds = timer.nsecsElapsed() / 1e9;
+  res.cycles = proc->getCycleCount();
+  res.instructions = proc->getInstructionsRetired();
+  res.finished = proc->finished();
+  if (design)
+    design->setEnableSignals(true);
+  return res;
+}
+
+QJsonObject benchmark(ProcessorID id, const Workload &workload, int warmup,
+                      int repetitions, long long maxCycles,
+                      long long observedCycles) {
+  QJsonObject obj;
+  obj["processor"] = enumToString<ProcessorID>(id);
+  obj["workload"] = workload.name;
+
+  std::shared_ptr<Program> program;
+  if (const QString error = workload.build(program); !error.isEmpty()) {
+    obj["status"] = "skipped";
+    obj["error"] = error;
+    return obj;
+  }
+
+  for (int i = 0; i < warmup; i++)
+    run(program, maxCycles, false);
+  std::vector<double> seconds;
+  RunResult res;
+  for (int i = 0; i < repetitions; i++) {
+    res = run(program, maxCycles, false);
+    seconds.push_back(res.seconds);
+  }
+  std::sort(seconds.begin(), seconds.end());
+  const double best = seconds.front();
+  const double median = seconds.at(seconds.size() / 2);
+
+  // The first cycles are clocked again, one at a time and with signals
+  // enabled. The difference in time per cycle is spent in signals and
+  // observers.
+  const RunResult prefix =
+      run(program, std::min(observedCycles, res.cycles), false);
+  const RunResult observed =
+      run(program, std::min(observedCycles, res.cycles), true);
+  const double perCycle =
+      prefix.cycles == 0 ? 0 : prefix.seconds / prefix.cycles;
+  const double observedPerCycle =
+      observed.cycles == 0 ? 0 : observed.seconds / observed.cycles;
+
+  obj["status"] = res.finished ? "ok" : "cycle limit";
+  obj["cycles"] = res.cycles;
+  obj["instructions"] = res.instructions;
+  obj["seconds"] = best;
+  obj["medianSeconds"] = median;
+  obj["cyclesPerSec"] = res.cycles / best;
+  obj["instructionsPerSec"] = res.instructions / best;
+  obj["cpi"] =
+      res.instructions == 0 ? 0 : double(res.cycles) / res.instructions;
+  obj["propagationSecondsPerCycle"] = perCycle;
+  obj["observedSecondsPerCycle"] = observedPerCycle;
+  obj["observerShare"] = observedPerCycle == 0
+                             ? 0
+                             : std::max(0.0, 1 - perCycle / observedPerCycle);
+  // The peak of the process, ie. of this and all preceding benchmarks.
+  obj["peakRSSBytes"] = peakRSS();
+  return obj;
+}
+
+/// Compares @p results to the results of @p baseline, returning a description
+/// of each regression. Benchmarks which were skipped in either are ignored.
+QStringList compareToBaseline(const QJsonArray &results,
+                              const QJsonObject &baseline, double threshold) {
+  std::map<std::pair<QString, QString>, QJsonObject> baselineResults;
+  for (const auto &value : baseline["results"].toArray()) {
+    const QJsonObject obj = value.toObject();
+    baselineResults[{obj["processor"].toString(), obj["workload"].toString()}] =
+        obj;
+  }
+
+  QStringList regressions;
+  for (const auto &value : results) {
+    const QJsonObject obj = value.toObject();
+    const QString name =
+        obj["processor"].toString() + " " + obj["workload"].toString();
+    auto it = baselineResults.find(
+        {obj["processor"].toString(), obj["workload"].toString()});
+    if (it == baselineResults.end()) {
+      std::cerr << name.toStdString() << ": not in baseline" << std::endl;
+      continue;
+    }
+    const QJsonObject &base = it->second;
+    if (obj["status"].toString() == "skipped" ||
+        base["status"].toString() == "skipped")
+      continue;
+
+    const double cyclesPerSec = obj["cyclesPerSec"].toDouble();
+    const double baseCyclesPerSec = base["cyclesPerSec"].toDouble();
+    if (cyclesPerSec < baseCyclesPerSec * (1 - threshold)) {
+      regressions << QString("%1: %2 cycles/s, baseline %3 cycles/s")
+                         .arg(name)
+                         .arg(cyclesPerSec, 0, 'f', 0)
+                         .arg(baseCyclesPerSec, 0, 'f', 0);
+    }
+    // The CPI is deterministic; any change beyond rounding is a change of the
+    // timing model.
+    const double cpi = obj["cpi"].toDouble();
+    const double baseCPI = base["cpi"].toDouble();
+    if (std::abs(cpi - baseCPI) > 1e-9 * std::max(1.0, baseCPI)) {
+      regressions << QString("%1: CPI %2, baseline CPI %3")
+                         .arg(name)
+                         .arg(cpi, 0, 'f', 6)
+                         .arg(baseCPI, 0, 'f', 6);
+    }
+  }
+  return regressions;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  QCoreApplication app(argc, argv);
+  QCommandLineParser parser;
+  parser.setApplicationDescription(
+      "Measures the throughput of the Ripes processor models.");
+  parser.addHelpOption();
+  QCommandLineOption jsonOption("json", "Write the results to <path>.",
+                                "path");
+  QCommandLineOption warmupOption(
+      "warmup", "Untimed runs of each benchmark (default: 1).", "n", "1");
+  QCommandLineOption repetitionsOption(
+      "repetitions", "Timed runs of each benchmark (default: 3).", "n", "3");
+  QCommandLineOption loopOption(
+      "loopinstructions",
+      "Instructions of the synthetic loop (default: 100000000).", "n",
+      "100000000");
+  QCommandLineOption maxCyclesOption(
+      "maxcycles", "Cycles after which a run is stopped (default: 1000000000).",
+      "n", "1000000000");
+  QCommandLineOption observedOption(
+      "observedcycles",
+      "Cycles clocked with signals enabled, for measuring the time spent in "
+      "signals and observers (default: 100000).",
+      "n", "100000");
+  QCommandLineOption processorsOption(
+      "processors", "Comma-separated processor models (default: all).",
+      "ids");
+  QCommandLineOption baselineOption(
+      "baseline",
+      "Compare the results to the JSON results of a previous run at <path>.",
+      "path");
+  QCommandLineOption thresholdOption(
+      "threshold",
+      "Relative drop of throughput from the baseline which is considered a "
+      "regression (default: 0.1).",
+      "fraction", "0.1");
+  parser.addOptions({jsonOption, warmupOption, repetitionsOption, loopOption,
+                     maxCyclesOption, observedOption, processorsOption,
+                     baselineOption, thresholdOption});
+  parser.process(app);
+
+  const int warmup = std::max(0, parser.value(warmupOption).toInt());
+  const int repetitions = std::max(1, parser.value(repetitionsOption).toInt());
+  const long long loopInstructions =
+      std::max(2LL, parser.value(loopOption).toLongLong());
+  const long long maxCycles =
+      std::max(1LL, parser.value(maxCyclesOption).toLongLong());
+  const long long observedCycles =
+      std::max(1LL, parser.value(observedOption).toLongLong());
+
+  const double threshold =
+      std::clamp(parser.value(thresholdOption).toDouble(), 0.0, 1.0);
+
+  // The baseline is read up front, to not fail only after benchmarking.
+  QJsonObject baseline;
+  if (parser.isSet(baselineOption)) {
+    QFile file(parser.value(baselineOption));
+    if (!file.open(QIODevice::ReadOnly)) {
+      std::cerr << "Could not read " << file.fileName().toStdString()
+                << std::endl;
+      return 1;
+    }
+    QJsonParseError error;
+    baseline = QJsonDocument::fromJson(file.readAll(), &error).object();
+    if (error.error != QJsonParseError::NoError) {
+      std::cerr << "Invalid baseline: " << error.errorString().toStdString()
+                << std::endl;
+      return 1;
+    }
+  }
+
+  std::vector<ProcessorID> processors;
+  if (parser.isSet(processorsOption)) {
+    for (const auto &name : parser.value(processorsOption).split(',')) {
+      ProcessorID id;
+      QString error;
+      if (!parseProcessorID(name, id, error)) {
+        std::cerr << error.toStdString() << std::endl;
+        return 1;
+      }
+      processors.push_back(id);
+    }
+  } else {
+    // The workloads are RISC-V programs.
+    for (const auto &desc : ProcessorRegistry::getAvailableProcessors())
+      if (ProcessorRegistry::isaFamily(desc.first) == "RISC-V")
+        processors.push_back(desc.first);
+  }
+
+  // matrixmul.c is compiled for each ISA, if a compiler is available; the
+  // compilation cache of the CCManager avoids compiling it repeatedly.
+  QTemporaryDir outDir;
+  const std::vector<Workload> workloads = {
+      {"matrixmul",
+       [&](std::shared_ptr<Program> &program) {
+         if (!CCManager::hasValidCC())
+           return QString("No compiler available");
+         const auto res = CCManager::get().compile(
+             {EXAMPLES_DIR "/C/matrixmul.c"},
+             outDir.filePath("matrixmul.elf"), false);
+         if (!res.success)
+           return "Failed to compile: " + res.errorOutput._stderr;
+         return loadElf(res.outFile, program);
+       }},
+      {"ranpi",
+       [](std::shared_ptr<Program> &program) {
+         return loadElf(ProcessorHandler::currentISA()->bits() == 64
+                            ? EXAMPLES_DIR "/ELF/RanPi-RV64"
+                            : EXAMPLES_DIR "/ELF/RanPi-RV32",
+                        program);
+       }},
+      {"factorial",
+       [](std::shared_ptr<Program> &program) {
+         return assembleFile(EXAMPLES_DIR "/assembly/factorial.s", program);
+       }},
+      {"loop", [=](std::shared_ptr<Program> &program) {
+         return assemble(syntheticLoop(loopInstructions), program);
+       }}};
+
+  QJsonArray results;
+  for (const auto id : processors) {
+    ProcessorHandler::selectProcessor(
+        id, ProcessorRegistry::getDescription(id).isaInfo().defaultExtensions);
+    for (const auto &workload : workloads) {
+      const auto result = benchmark(id, workload, warmup, repetitions,
+                                    maxCycles, observedCycles);
+      std::cerr << result["processor"].toString().toStdString() << " "
+                << workload.name.toStdString() << ": "
+                << result["status"].toString().toStdString() << std::endl;
+      results.append(result);
+    }
+  }
+
+  QJsonObject report;
+  report["warmup"] = warmup;
+  report["repetitions"] = repetitions;
+  report["results"] = results;
+  const QByteArray json = QJsonDocument(report).toJson();
+
+  if (parser.isSet(jsonOption)) {
+    QFile file(parser.value(jsonOption));
+    if (!file.open(QIODevice::WriteOnly)) {
+      std::cerr << "Could not write " << file.fileName().toStdString()
+                << std::endl;
+      return 1;
+    }
+    file.write(json);
+  } else {
+    std::cout << json.toStdString();
+  }
+
+  if (parser.isSet(baselineOption)) {
+    const QStringList regressions =
+        compareToBaseline(results, baseline, threshold);
+    for (const auto &regression : regressions)
+      std::cerr << "Regression: " << regression.toStdString() << std::endl;
+    if (!regressions.empty())
+      return 2;
+  }
+  return 0;
+}
@@ -58,4 +58,35 @@ private:
   EditTab *m_editTab = nullptr;
 };
 
+/// Base class of tests which assemble programs and run them to completion on
+/// the processor models, without the edit tab.
+class ProcessorTest : public QObject {
+  Q_OBJECT
+
+protected:
+  /// Selects the processor @p id with @p extensions and loads @p program into
+  /// it. Returns the processor, or nullptr if the program does not assemble.
+  static RipesProcessor *load(ProcessorID id, const QStringList &program,
+                              const QStringList &extensions = {"M"}) {
+    ProcessorHandler::selectProcessor(id, extensions);
+    auto res =
+        ProcessorHandler::getAssembler()->assembleRaw(program.join("\n"));
+    if (!res.errors.empty())
+      return nullptr;
+    ProcessorHandler::loadProgram(std::make_shared<Program>(res.program));
+    auto *proc = ProcessorHandler::getProcessorNonConst();
+    proc->trapHandler = [] {};
+    return proc;
+  }
+
+  /// Clocks @p proc until it finishes, or until @p maxCycles cycles.
+  static void runToFinish(RipesProcessor *proc, long long maxCycles = 10000) {
+    while (!proc->finished() && proc->getCycleCount() < maxCycles)
+      proc->clock();
+  }
+
+private slots:
+  void cleanup() { ProcessorHandler::setPerformanceCounting(false); }
+};
+
 } // namespace Ripes
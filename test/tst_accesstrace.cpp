@@ -0,0 +1,92 @@
+#include <QTemporaryDir>
+#include <QtTest/QTest>
+
+#include <random>
+
+#include "cachesim/accesstrace.h"
+
+using namespace Ripes;
+
+// This test ensures that memory access traces are reproduced exactly when
+// read back, for both sequential and random access patterns.
+
+class tst_accesstrace : public QObject {
+  Q_OBJECT
+
+private slots:
+  void tst_roundtrip();
+  void tst_invalidFile();
+};
+
+void tst_accesstrace::tst_roundtrip() {
+  std::vector<std::pair<MemoryAccess, MemoryAccess>> records;
+  std::mt19937_64 rng(1);
+  AInt pc = 0x1000;
+  for (int i = 0; i < 5000; ++i) {
+    MemoryAccess instr, data;
+    if (i % 7 != 0) {
+      pc = i % 97 == 0 ? rng() : pc + 4;
+      instr = {MemoryAccess::Read, pc, static_cast<unsigned>(i % 3 ? 4 : 2)};
+    }
+    switch (rng() % 3) {
+    case 0:
+      break;
+    case 1:
+      data = {MemoryAccess::Read, rng(), 1u << (rng() % 4), pc};
+      break;
+    case 2:
+      data = {MemoryAccess::Write, 0x10000000 + (rng() % 256) * 4, 4};
+      break;
+    }
+    records.push_back({instr, data});
+  }
+
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  const QString path = dir.filePath("trace.bin");
+  QString errorMessage;
+  {
+    AccessTraceWriter writer;
+    QVERIFY(writer.open(path, errorMessage));
+    for (const auto &record : records)
+      writer.record(record.first, record.second);
+  }
+
+  AccessTraceReader reader;
+  QVERIFY2(reader.open(path, errorMessage), errorMessage.toStdString().c_str());
+  MemoryAccess instr, data;
+  for (const auto &record : records) {
+    QVERIFY(reader.next(instr, data));
+    for (const auto &[expected, actual] :
+         {std::make_pair(record.first, instr),
+          std::make_pair(record.second, data)}) {
+      QCOMPARE(actual.type, expected.type);
+      if (expected.type != MemoryAccess::None) {
+        QCOMPARE(actual.address, expected.address);
+        QCOMPARE(actual.bytes, expected.bytes);
+        QCOMPARE(actual.pc, expected.pc);
+      }
+    }
+  }
+  QVERIFY(!reader.next(instr, data));
+  QVERIFY(!reader.error());
+  QCOMPARE(reader.cycles(), static_cast<long long>(records.size()));
+}
+
+void tst_accesstrace::tst_invalidFile() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  const QString path = dir.filePath("invalid.bin");
+  QFile file(path);
+  QVERIFY(file.open(QIODevice::WriteOnly));
+  file.write("not a trace");
+  file.close();
+
+  AccessTraceReader reader;
+  QString errorMessage;
+  QVERIFY(!reader.open(path, errorMessage));
+  QVERIFY(!errorMessage.isEmpty());
+}
+
+QTEST_APPLESS_MAIN(tst_accesstrace)
+#include "tst_accesstrace.moc"
@@ -0,0 +1,137 @@
+#include <QtTest/QTest>
+
+#include "processorhandler.h"
+#include "processorregistry.h"
+#include "syscall/anonymousmemory.h"
+
+using namespace Ripes;
+
+// This test ensures that anonymous mappings are allocated and released at the
+// granularity of pages, and that memory mapped through mmap reads as zero,
+// including memory which was mapped and written before.
+
+class tst_anonymousmemory : public QObject {
+  Q_OBJECT
+
+private slots:
+  void tst_map();
+  void tst_unmap();
+  void tst_exhausted();
+  void tst_syscalls();
+};
+
+static constexpr AInt s_page = AnonymousMemory::s_pageSize;
+
+void tst_anonymousmemory::tst_map() {
+  AnonymousMemory memory(0x1000, 0x10000);
+  QVERIFY(!memory.map(0).has_value());
+
+  // Mappings are rounded up to whole pages, and placed back to back.
+  auto a = memory.map(1);
+  QVERIFY(a.has_value());
+  QCOMPARE(a->address, AInt(0x1000));
+  QCOMPARE(a->size, s_page);
+  QCOMPARE(a->staleBytes, AInt(0));
+  auto b = memory.map(s_page + 1);
+  QVERIFY(b.has_value());
+  QCOMPARE(b->address, AInt(0x2000));
+  QCOMPARE(b->size, 2 * s_page);
+  QCOMPARE(memory.mappedPages(), AInt(3));
+  QVERIFY(memory.isMapped(0x3FFF));
+  QVERIFY(!memory.isMapped(0x4000));
+  QVERIFY(!memory.isMapped(0x0FFF));
+}
+
+void tst_anonymousmemory::tst_unmap() {
+  AnonymousMemory memory(0x1000, 0x10000);
+  QVERIFY(memory.map(4 * s_page).has_value());
+
+  // Unaligned and out-of-region ranges are rejected.
+  QVERIFY(!memory.unmap(0x1001, s_page));
+  QVERIFY(!memory.unmap(0x20000, s_page));
+  QVERIFY(!memory.unmap(0x1000, 0));
+
+  // Unmapping the middle of a mapping splits it, and partial pages are
+  // unmapped entirely.
+  QVERIFY(memory.unmap(0x2000, s_page + 1));
+  QCOMPARE(memory.mappedPages(), AInt(2));
+  QCOMPARE(memory.peakMappedPages(), AInt(4));
+  QVERIFY(memory.isMapped(0x1000));
+  QVERIFY(!memory.isMapped(0x2000));
+  QVERIFY(!memory.isMapped(0x3000));
+  QVERIFY(memory.isMapped(0x4000));
+
+  // Unmapping pages which are not mapped has no effect.
+  QVERIFY(memory.unmap(0x2000, s_page));
+  QCOMPARE(memory.mappedPages(), AInt(2));
+
+  // The gap is reused by mappings which fit it, and holds stale values.
+  auto reused = memory.map(2 * s_page);
+  QVERIFY(reused.has_value());
+  QCOMPARE(reused->address, AInt(0x2000));
+  QCOMPARE(reused->staleBytes, 2 * s_page);
+  // The mapping after the last mapping is only partially stale.
+  QVERIFY(memory.unmap(0x4000, s_page));
+  auto tail = memory.map(3 * s_page);
+  QVERIFY(tail.has_value());
+  QCOMPARE(tail->address, AInt(0x4000));
+  QCOMPARE(tail->staleBytes, s_page);
+  QCOMPARE(memory.mappedPages(), AInt(6));
+
+  memory.reset();
+  QCOMPARE(memory.mappedPages(), AInt(0));
+  QCOMPARE(memory.peakMappedPages(), AInt(0));
+  auto fresh = memory.map(s_page);
+  QVERIFY(fresh.has_value());
+  QCOMPARE(fresh->address, AInt(0x1000));
+  QCOMPARE(fresh->staleBytes, AInt(0));
+}
+
+void tst_anonymousmemory::tst_exhausted() {
+  AnonymousMemory memory(0x1000, 0x4000);
+  QVERIFY(!memory.map(4 * s_page).has_value());
+  QVERIFY(memory.map(2 * s_page).has_value());
+  QVERIFY(memory.map(s_page).has_value());
+  QVERIFY(!memory.map(1).has_value());
+  QCOMPARE(memory.mappedPages(), AInt(3));
+}
+
+void tst_anonymousmemory::tst_syscalls() {
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_ISS, {"M"});
+  const QStringList mmap = {"li a0 0",  "li a1 8192", "li a2 3",  "li a3 0x22",
+                            "li a4 -1", "li a5 0",    "li a7 222", "ecall"};
+  QStringList program = {".text"};
+  program << mmap << "mv s0 a0"
+          << "li t0 42"
+          << "sw t0 4(s0)"
+          << "mv a0 s0"
+          << "li a1 8192"
+          << "li a7 215"
+          << "ecall"
+          << "mv s2 a0" << mmap << "mv s1 a0"
+          << "lw s3 4(s1)";
+  auto res = ProcessorHandler::getAssembler()->assembleRaw(program.join("\n"));
+  QVERIFY(res.errors.empty());
+  ProcessorHandler::loadProgram(std::make_shared<Program>(res.program));
+
+  auto *proc = ProcessorHandler::getProcessorNonConst();
+  while (!proc->finished() && proc->getCycleCount() < 100)
+    proc->clock();
+  QVERIFY(proc->finished());
+
+  const auto reg = [](unsigned idx) {
+    return ProcessorHandler::getRegisterValue(RVISA::GPR, idx);
+  };
+  QCOMPARE(reg(8), VInt(AnonymousMemory::s_defaultBase));
+  QCOMPARE(reg(18), VInt(0));
+  // The memory is reused, and reads as zero.
+  QCOMPARE(reg(9), reg(8));
+  QCOMPARE(reg(19), VInt(0));
+  const auto &anonymous =
+      ProcessorHandler::getSyscallManager().anonymousMemory();
+  QCOMPARE(anonymous.mappedPages(), AInt(2));
+  QCOMPARE(anonymous.peakMappedPages(), AInt(2));
+}
+
+QTEST_MAIN(tst_anonymousmemory)
+#include "tst_anonymousmemory.moc"
@@ -1,10 +1,20 @@
+#include <QElapsedTimer>
+#include <QTemporaryDir>
 #include <QtTest/QTest>
 
+#include <functional>
+#include <limits>
+#include <random>
+
 #include "assembler/matcher.h"
 #include "isa/isainfo.h"
+#include "isa/mips32isainfo.h"
 #include "isa/rv32isainfo.h"
+#include "isa/rv64isainfo.h"
 
 #include "assembler/assembler.h"
+#include "assembler/parserutilities.h"
+#include "assembler/programcache.h"
 
 #include "processorhandler.h"
 
@@ -32,6 +42,8 @@ private slots:
   void tst_simpleWithBranch();
   void tst_segment();
   void tst_matcher();
+  void tst_matcherTable();
+  void tst_opcodeMasks();
   void tst_label();
   void tst_labelWithPseudo();
   void tst_weirdImmediates();
@@ -43,10 +55,35 @@ private slots:
   void tst_invalidLabel();
   void tst_directives();
   void tst_stringDirectives();
+  void tst_bulkDirectives();
   void tst_riscv();
   void tst_relativeLabels();
+  void tst_incremental();
+  void tst_parallel();
+  void tst_programCache();
+  void tst_linking();
+  void tst_disassembledProgram();
+  void tst_tokenizer();
+  void tst_scalingLabels();
+  void tst_scalingExpressions();
+  void tst_scalingWordDirectives();
+  void tst_scalingStringDirectives();
+  void tst_scalingRepetition();
 
 private:
+  static std::vector<std::shared_ptr<const ISAInfoBase>> allISAs() {
+    return {std::make_shared<ISAInfo<ISA::RV32I>>(QStringList()),
+            std::make_shared<ISAInfo<ISA::RV32I>>(QStringList{"M", "C"}),
+            std::make_shared<ISAInfo<ISA::RV64I>>(QStringList{"M", "C"}),
+            std::make_shared<ISAInfo<ISA::RV32I>>(QStringList{"M", "V"}),
+            std::make_shared<ISAInfo<ISA::RV64I>>(QStringList{"M", "C", "V"}),
+            std::make_shared<ISAInfo<ISA::RV32I>>(
+                QStringList{"M", "Zba", "Zbb", "Zbs"}),
+            std::make_shared<ISAInfo<ISA::RV64I>>(
+                QStringList{"M", "C", "Zba", "Zbb", "Zbs"}),
+            std::make_shared<ISAInfo<ISA::MIPS32I>>(QStringList())};
+  }
+
   QString createProgram(int entries) {
     QString out;
     out += ".data\n";
@@ -62,6 +99,51 @@ private:
     return out;
   }
 
+  /// Assembles the programs generated by @p generate for sizes of 10^3 to
+  /// 10^6, and verifies that the assembly time grows near-linearly with the
+  /// size, such that quadratic behaviour is caught. Each size is timed as the
+  /// best of a few assemblies, against a floor which absorbs the timer noise
+  /// of the smallest sizes.
+  void verifyLinearScaling(const std::function<QString(int)> &generate) {
+    constexpr qint64 floorNs = 5'000'000;
+    constexpr double slack = 4;
+    auto isa = std::make_shared<ISAInfo<ISA::RV32I>>(QStringList());
+    int prevSize = 0;
+    qint64 prevNs = 0;
+    for (const int size : {1000, 10000, 100000, 1000000}) {
+      const QString program = generate(size);
+      qint64 ns = std::numeric_limits<qint64>::max();
+      for (int run = 0; run < (size < 100000 ? 3 : 1); run++) {
+        auto assembler = ISA_Assembler<ISA::RV32I>(isa);
+        QElapsedTimer timer;
+        timer.start();
+        const auto res = assembler.assembleRaw(program);
+        ns = std::min(ns, timer.nsecsElapsed());
+        if (!res.errors.empty()) {
+          res.errors.print();
+          QFAIL(QString("Failed to assemble program of size %1")
+                    .arg(size)
+                    .toStdString()
+                    .c_str());
+        }
+      }
+      if (prevSize != 0) {
+        const double growth = double(ns) / std::max(prevNs, floorNs);
+        QVERIFY2(growth < slack * size / prevSize,
+                 QString("Assembling size %1 took %2 ms, but size %3 took %4 "
+                         "ms")
+                     .arg(size)
+                     .arg(ns / 1e6)
+                     .arg(prevSize)
+                     .arg(prevNs / 1e6)
+                     .toStdString()
+                     .c_str());
+      }
+      prevSize = size;
+      prevNs = ns;
+    }
+  }
+
   enum class Expect { Fail, Success };
   void testAssemble(const QStringList &program, Expect expect,
                     QByteArray expectData = {}) {
@@ -260,6 +342,332 @@ void tst_Assembler::tst_benchmarkNew() {
   QBENCHMARK { assembler.assembleRaw(program); }
 }
 
+void tst_Assembler::tst_incremental() {
+  auto isa = std::make_shared<ISAInfo<ISA::RV32I>>(QStringList());
+  auto assembler = ISA_Assembler<ISA::RV32I>(isa);
+  assembler.setIncremental(true);
+
+  // Each edit must produce the same program as a non-incremental assembly,
+  // including edits which shift the addresses of all subsequent lines.
+  QString program = createProgram(100);
+  const auto check = [&] {
+    auto reference = ISA_Assembler<ISA::RV32I>(isa);
+    const auto expected = reference.assembleRaw(program);
+    const auto res = assembler.assembleRaw(program);
+    QCOMPARE(res.errors.size(), expected.errors.size());
+    if (!expected.errors.empty())
+      return;
+    for (const auto &section : expected.program.sections) {
+      QCOMPARE(res.program.getSection(section.first)->data,
+               section.second.data);
+    }
+  };
+  check();
+  program.replace("LA50: addi a0 a0 1", "LA50: addi a0 a0 2\nnop");
+  check();
+  program.replace("L10: .word 1 2 3 4", "L10: .word 1 2 3 4 5");
+  check();
+  program.replace("LA20: addi a0 a0 1", "LA20: addi a0 a0 0q1");
+  check();
+  program.replace("LA20: addi a0 a0 0q1", "LA20: addi a0 a0 1");
+  check();
+}
+
+void tst_Assembler::tst_parallel() {
+  auto isa = std::make_shared<ISAInfo<ISA::RV32I>>(QStringList());
+
+  // Programs of this size are tokenized and encoded in parallel. All entries
+  // of the program assemble to identical bytes, given that the branches are
+  // relative.
+  const int entries = 5000;
+  auto single = ISA_Assembler<ISA::RV32I>(isa).assembleRaw(createProgram(1));
+  auto res = ISA_Assembler<ISA::RV32I>(isa).assembleRaw(createProgram(entries));
+  QVERIFY(single.errors.empty());
+  QVERIFY(res.errors.empty());
+  for (const auto &section : single.program.sections) {
+    QCOMPARE(res.program.getSection(section.first)->data,
+             section.second.data.repeated(entries));
+  }
+
+  // Errors are reported in program order.
+  QString program = createProgram(entries);
+  for (int i = 0; i < entries; i += 997)
+    program.replace("LA" + QString::number(i) + ": addi a0 a0 1\n",
+                    "LA" + QString::number(i) + ": addi a0 a0 0q1\n");
+  res = ISA_Assembler<ISA::RV32I>(isa).assembleRaw(program);
+  QCOMPARE(res.errors.size(), size_t((entries + 996) / 997));
+  for (size_t i = 1; i < res.errors.size(); i++)
+    QVERIFY(res.errors.at(i - 1).sourceLine() < res.errors.at(i).sourceLine());
+}
+
+void tst_Assembler::tst_programCache() {
+  auto isa = std::make_shared<ISAInfo<ISA::RV32I>>(QStringList());
+  const QString source = createProgram(10);
+  const auto reference = ISA_Assembler<ISA::RV32I>(isa).assembleRaw(source);
+  QVERIFY(reference.errors.empty());
+  const auto verifyEqual = [&](const Program &program) {
+    QCOMPARE(program.sections.size(), reference.program.sections.size());
+    for (const auto &section : reference.program.sections) {
+      const auto *cached = program.getSection(section.first);
+      QVERIFY(cached);
+      QCOMPARE(cached->address, section.second.address);
+      QCOMPARE(cached->data, section.second.data);
+      QCOMPARE(cached->zeroBytes, section.second.zeroBytes);
+    }
+    QVERIFY(program.symbols == reference.program.symbols);
+    QVERIFY(program.sourceMapping == reference.program.sourceMapping);
+    QCOMPARE(program.entryPoint, reference.program.entryPoint);
+  };
+
+  // The second assembly is looked up in the cache.
+  ProgramCache::get().clear();
+  auto assembler = ISA_Assembler<ISA::RV32I>(isa);
+  assembler.setProgramCaching(true);
+  for (int i = 0; i < 2; i++)
+    verifyEqual(assembler.assembleRaw(source).program);
+
+  // Programs are persisted to, and reloaded from, the cache directory.
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  ProgramCache::get().setDirectory(dir.path());
+  const QStringList lines = source.split('\n');
+  const std::map<Section, AInt> bases = {{".text", 0}, {".data", 0x1000}};
+  const QString key = ProgramCache::key(lines, *isa, bases, nullptr);
+  ProgramCache::get().insert(key, reference.program);
+  ProgramCache::get().clear();
+  auto loaded = ProgramCache::get().find(key);
+  QVERIFY(loaded.has_value());
+  verifyEqual(*loaded);
+  ProgramCache::get().setDirectory(QString());
+  ProgramCache::get().clear();
+
+  // Anything affecting the assembled program changes the key.
+  auto rv32m = std::make_shared<ISAInfo<ISA::RV32I>>(QStringList{"M"});
+  QVERIFY(key != ProgramCache::key(lines, *rv32m, bases, nullptr));
+  QVERIFY(key != ProgramCache::key(lines, *isa, {{".text", 4}}, nullptr));
+  QVERIFY(key != ProgramCache::key(lines.mid(1), *isa, bases, nullptr));
+  SymbolMap symbols;
+  symbols.setAbsSymbol("A", 1);
+  QVERIFY(key != ProgramCache::key(lines, *isa, bases, &symbols));
+
+  // So does modifying a file included by .incbin.
+  QFile file(dir.filePath("data.bin"));
+  QVERIFY(file.open(QIODevice::WriteOnly));
+  file.write("ab");
+  file.close();
+  const QStringList incbin = {".data", ".incbin \"" + file.fileName() + "\""};
+  const QString incbinKey = ProgramCache::key(incbin, *isa, bases, nullptr);
+  QVERIFY(incbinKey == ProgramCache::key(incbin, *isa, bases, nullptr));
+  QVERIFY(file.open(QIODevice::Append));
+  file.write("c");
+  file.close();
+  QVERIFY(incbinKey != ProgramCache::key(incbin, *isa, bases, nullptr));
+}
+
+void tst_Assembler::tst_linking() {
+  auto isa = std::make_shared<ISAInfo<ISA::RV32I>>(QStringList());
+  const QStringList app = {".globl main",    "main:",         "  li a0, 4",
+                           "1:",             "  jal ra, inc", "  bnez a0, 1b",
+                           "  la a1, value", "  lw a1, 0(a1)", ".data",
+                           ".word 1"};
+  QStringList lib = {".text",          ".globl inc", ".globl value",
+                     ".equ STEP, -2",  "inc:",       "  addi a0, a0, STEP",
+                     "  bgez a0, 1f",  "  li a0, 0", "1:",
+                     "  ret",          ".data",      ".align 8",
+                     "value: .word 3"};
+
+  // Linking the objects of the files yields the program of their
+  // concatenation.
+  auto assembler = ISA_Assembler<ISA::RV32I>(isa);
+  auto linked = assembler.assembleFiles({{"main.s", app}, {"lib.s", lib}});
+  QVERIFY(linked.errors.empty());
+  QCOMPARE(assembler.assembledObjects(), 2U);
+  const auto reference = ISA_Assembler<ISA::RV32I>(isa).assemble(app + lib);
+  QVERIFY(reference.errors.empty());
+  const auto verifyEqual = [&](const Program &program,
+                               const Program &expected) {
+    QCOMPARE(program.sections.size(), expected.sections.size());
+    for (const auto &section : expected.sections) {
+      const auto *linkedSection = program.getSection(section.first);
+      QVERIFY(linkedSection);
+      QCOMPARE(linkedSection->address, section.second.address);
+      QCOMPARE(linkedSection->data, section.second.data);
+      QCOMPARE(linkedSection->zeroBytes, section.second.zeroBytes);
+    }
+    QVERIFY(program.symbols == expected.symbols);
+    QVERIFY(program.sourceMapping == expected.sourceMapping);
+    QCOMPARE(program.entryPoint, expected.entryPoint);
+  };
+  verifyEqual(linked.program, reference.program);
+
+  // The .align of the second object aligns the placement of its section.
+  const auto *data = linked.program.getSection(".data");
+  QVERIFY(data);
+  QCOMPARE(data->data.size(), qsizetype(12));
+  QVERIFY(linked.program.symbols.count(data->address + 8));
+
+  // Unchanged files are not reassembled.
+  linked = assembler.assembleFiles({{"main.s", app}, {"lib.s", lib}});
+  QVERIFY(linked.errors.empty());
+  QCOMPARE(assembler.assembledObjects(), 2U);
+  lib[3] = ".equ STEP, -1";
+  linked = assembler.assembleFiles({{"main.s", app}, {"lib.s", lib}});
+  QVERIFY(linked.errors.empty());
+  QCOMPARE(assembler.assembledObjects(), 3U);
+  verifyEqual(linked.program,
+              ISA_Assembler<ISA::RV32I>(isa).assemble(app + lib).program);
+
+  // Undefined and unexported symbols are reported at the line of the
+  // concatenated files.
+  QStringList local = lib;
+  local.removeAll(".globl inc");
+  auto failed = assembler.assembleFiles({{"main.s", app}, {"lib.s", local}});
+  QCOMPARE(failed.errors.size(), size_t(1));
+  QCOMPARE(failed.errors.at(0).sourceLine(),
+           int64_t(app.indexOf("  jal ra, inc")));
+  QVERIFY(failed.errors.at(0).errorMessage().startsWith("main.s: "));
+
+  // Global symbols are defined once.
+  failed = assembler.assembleFiles(
+      {{"main.s", app}, {"lib.s", lib}, {"dup.s", {".globl inc", "inc:"}}});
+  QCOMPARE(failed.errors.size(), size_t(1));
+  QCOMPARE(failed.errors.at(0).sourceLine(),
+           int64_t(app.size() + lib.size() + 1));
+}
+
+void tst_Assembler::tst_tokenizer() {
+  const auto tokenize = [](const QString &line) {
+    auto quoted = tokenizeQuotes(Location(0), line);
+    QStringList result;
+    if (quoted.isError())
+      return result;
+    auto joined = joinParentheses(Location(0), quoted.value());
+    if (joined.isError())
+      return result;
+    for (const auto &token : joined.value())
+      result << token;
+    return result;
+  };
+
+  // Tokens are split at whitespace and commas, outside of string literals.
+  QCOMPARE(tokenize("  addi\ta0,a0 , 1"),
+           QStringList({"addi", "a0", "a0", "1"}));
+  QCOMPARE(tokenize(".string \"a, (b\\\" c\"x"),
+           QStringList({".string", "\"a, (b\\\" c\"", "x"}));
+  // Top-level parentheses are removed, and the tokens within are joined.
+  QCOMPARE(tokenize("lw x10, (B + (3*2))(x10)"),
+           QStringList({"lw", "x10", "B+(3*2)", "x10"}));
+  QCOMPARE(tokenize("lw a0, 0(sp)"), QStringList({"lw", "a0", "0", "sp"}));
+
+  QVERIFY(tokenizeQuotes(Location(0), ".string \"abc").isError());
+  auto unmatched = tokenizeQuotes(Location(0), "lw a0, 0(sp");
+  QVERIFY(!unmatched.isError());
+  QVERIFY(joinParentheses(Location(0), unmatched.value()).isError());
+}
+
+void tst_Assembler::tst_disassembledProgram() {
+  unsigned disassembled = 0;
+  const auto disassemble = [&](VInt address) {
+    disassembled++;
+    return QString::number(address, 16);
+  };
+
+  // Fixed-width instructions are disassembled a page at a time, upon access.
+  DisassembledProgram program;
+  QVERIFY(program.empty());
+  program.setLayout(0x1000, 100000, 4, disassemble);
+  QVERIFY(!program.empty());
+  QCOMPARE(program.numInstructions(), 100000u);
+  QCOMPARE(disassembled, 0u);
+  QCOMPARE(program.getFromIdx(1000).value(), QString("1fa0"));
+  QCOMPARE(program.getFromAddr(0x1fa4).value(), QString("1fa4"));
+  const unsigned pageSize = disassembled;
+  QVERIFY(pageSize < 1000);
+  QCOMPARE(program.indexToAddress(99999).value(), VInt(0x1000 + 99999 * 4));
+  QCOMPARE(program.addressToIndex(0x1008).value(), 2u);
+  QVERIFY(!program.addressToIndex(0x1002).has_value());
+  QVERIFY(!program.addressToIndex(0xffc).has_value());
+  QVERIFY(!program.getFromIdx(100000).has_value());
+
+  // Evicted pages are disassembled again.
+  for (unsigned i = 0; i < 100000; i += pageSize)
+    program.getFromIdx(i);
+  disassembled = 0;
+  program.getFromIdx(1000);
+  QCOMPARE(disassembled, pageSize);
+
+  // Variable-width instructions are located through their offsets.
+  program.setLayout(0x0, {0, 2, 6, 8}, disassemble);
+  QCOMPARE(program.numInstructions(), 4u);
+  QCOMPARE(program.indexToAddress(2).value(), VInt(6));
+  QCOMPARE(program.addressToIndex(8).value(), 3u);
+  QVERIFY(!program.addressToIndex(4).has_value());
+  QCOMPARE(program.getFromAddr(6).value(), QString("6"));
+
+  // Disassembly is not copied along with its program.
+  DisassembledProgram copy(program);
+  QVERIFY(copy.empty());
+}
+
+void tst_Assembler::tst_scalingLabels() {
+  // Each label is referenced from a distant line, both before and after its
+  // definition.
+  verifyLinearScaling([](int size) {
+    QString out = ".text\n";
+    for (int i = 0; i < size; i++)
+      out += "L" + QString::number(i) + ": la a0 L" +
+             QString::number((i * 7919LL) % size) + "\n";
+    return out;
+  });
+}
+
+void tst_Assembler::tst_scalingExpressions() {
+  // Lines of deeply nested expressions; the size is the total number of
+  // nested parentheses.
+  constexpr int depth = 64;
+  QString expr = "1";
+  for (int i = 0; i < depth; i++)
+    expr = "(" + expr + "+1)";
+  verifyLinearScaling([&](int size) {
+    QString out = ".data\n";
+    for (int i = 0; i < size / depth; i++)
+      out += ".word " + expr + "\n";
+    return out;
+  });
+}
+
+void tst_Assembler::tst_scalingWordDirectives() {
+  verifyLinearScaling([](int size) {
+    QString out = ".data\n";
+    for (int i = 0; i < size; i += 64) {
+      out += ".word";
+      for (int j = i; j < std::min(i + 64, size); j++)
+        out += " " + QString::number(j);
+      out += "\n";
+    }
+    return out;
+  });
+}
+
+void tst_Assembler::tst_scalingStringDirectives() {
+  // A single string of the given size.
+  verifyLinearScaling([](int size) {
+    return ".data\n.string \"" + QString(size, 'a') + "\"\n";
+  });
+}
+
+void tst_Assembler::tst_scalingRepetition() {
+  // A repeated block of code, as expanded from a macro, where each repetition
+  // redefines the same relative labels.
+  const QString block = "1: addi a0 a0 1\n"
+                        "bne a0 a1 1b\n"
+                        "beqz a1 2f\n"
+                        "slli a2 a0 2\n"
+                        "2: add a3 a3 a2\n";
+  verifyLinearScaling(
+      [&](int size) { return ".text\n" + block.repeated(size / 5); });
+}
+
 void tst_Assembler::tst_simpleprogram() {
   testAssemble(QStringList() << ".data"
                              << "B: .word 1, 2, 2"
@@ -359,6 +767,73 @@ void tst_Assembler::tst_stringDirectives() {
   testAssemble(QStringList() << R"(A: .string "")", Expect::Success);
 }
 
+void tst_Assembler::tst_bulkDirectives() {
+  auto isa = std::make_shared<ISAInfo<ISA::RV32I>>(QStringList());
+  const auto assemble = [&](const QStringList &program) {
+    return ISA_Assembler<ISA::RV32I>(isa).assemble(program);
+  };
+
+  // .incbin places the bytes of a file, or a range of them, in the section.
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  const QString path = dir.filePath("image.raw");
+  QByteArray image;
+  for (int i = 0; i < 256; i++)
+    image.append(static_cast<char>(i));
+  QFile file(path);
+  QVERIFY(file.open(QIODevice::WriteOnly));
+  file.write(image);
+  file.close();
+  const QString incbin = ".incbin \"" + path + "\"";
+  auto res = assemble({".data", "a: .byte 1", "b: " + incbin,
+                       "c: " + incbin + ", 16", "d: " + incbin + ", 16, 4"});
+  QVERIFY(res.errors.empty());
+  QByteArray expectData = QByteArray(1, 1) + image + image.mid(16) +
+                          image.mid(16, 4);
+  QCOMPARE(res.program.getSection(".data")->data, expectData);
+  const AInt dataBase = res.program.getSection(".data")->address;
+  const auto symbol = [&](const QString &name) {
+    auto it = std::find_if(
+        res.program.symbols.begin(), res.program.symbols.end(),
+        [&](const auto &entry) { return entry.second.v == name; });
+    return it == res.program.symbols.end() ? AInt(-1) : it->first - dataBase;
+  };
+  QCOMPARE(symbol("c"), AInt(1 + 256));
+  QCOMPARE(symbol("d"), AInt(1 + 256 + 240));
+  testAssemble({".data", ".incbin \"" + dir.filePath("missing") + "\""},
+               Expect::Fail);
+  testAssemble({".data", incbin + ", 257"}, Expect::Fail);
+  testAssemble({".data", incbin + ", 16, 241"}, Expect::Fail);
+
+  // Zero bytes of .zero, .space and .fill are reserved without being
+  // materialized, unless followed by further bytes.
+  res = assemble({".data", "a: .zero 0x1000000", "b: .space 0x100",
+                  "c: .fill 0x10, 4", "d: .skip 8, 0"});
+  QVERIFY(res.errors.empty());
+  const auto *data = res.program.getSection(".data");
+  QVERIFY(data->data.isEmpty());
+  QCOMPARE(data->zeroBytes, AInt(0x1000000 + 0x100 + 0x40 + 8));
+  QCOMPARE(data->size(), data->zeroBytes);
+  QCOMPARE(symbol("d"), AInt(0x1000000 + 0x100 + 0x40));
+
+  res = assemble({".data", ".byte 1", ".space 3", ".word 2", ".space 4",
+                  ".fill 2, 2, 0x0102", ".space 2, 0xff", ".zero 4"});
+  QVERIFY(res.errors.empty());
+  data = res.program.getSection(".data");
+  QCOMPARE(data->data, QByteArray::fromHex("0100000002000000"
+                                           "0000000002010201ffff"));
+  QCOMPARE(data->zeroBytes, AInt(4));
+
+  // Alignment accounts for the reserved bytes.
+  res = assemble({".data", ".space 1", ".align 4", "a: .byte 1"});
+  QVERIFY(res.errors.empty());
+  QCOMPARE(symbol("a"), AInt(4));
+
+  testAssemble({".data", ".space -1"}, Expect::Fail);
+  testAssemble({".data", ".space 1, 256"}, Expect::Fail);
+  testAssemble({".data", ".fill 1, 9"}, Expect::Fail);
+}
+
 void tst_Assembler::tst_relativeLabels() {
   testAssemble(QStringList() << "1f:  bne x0 a0 1f", Expect::Fail);
   testAssemble(QStringList() << "1:  bne x0 a0 1f"
@@ -416,5 +891,55 @@ void tst_Assembler::tst_matcher() {
   }
 }
 
+void tst_Assembler::tst_matcherTable() {
+  // The dispatch table must match the same instructions as the match tree, for
+  // arbitrary words as well as words carrying the OpParts of each instruction.
+  std::mt19937 rng(0);
+  for (const auto &isa : allISAs()) {
+    const Matcher matcher(isa->instructions());
+    std::vector<Instr_T> words;
+    for (unsigned i = 0; i < 100000; i++)
+      words.push_back(rng());
+    for (const auto &instr : isa->instructions()) {
+      for (unsigned i = 0; i < 100; i++) {
+        Instr_T word = rng();
+        for (unsigned p = 0; p < instr->numOpParts(); p++) {
+          const auto part = instr->getOpPart(p);
+          word &= ~(part.range.getMask() << part.range.start);
+          word |= part.range.apply(part.value);
+        }
+        words.push_back(word);
+      }
+    }
+
+    for (const auto word : words) {
+      auto table = matcher.matchInstruction(word);
+      auto tree = matcher.matchInstructionTree(word);
+      QCOMPARE(table.isError(), tree.isError());
+      if (!tree.isError())
+        QCOMPARE(table.value(), tree.value());
+    }
+  }
+}
+
+void tst_Assembler::tst_opcodeMasks() {
+  // The opcode encodings derived at compile time must agree with the OpParts
+  // of each instruction.
+  for (const auto &isa : allISAs()) {
+    for (const auto &instr : isa->instructions()) {
+      Instr_T mask = 0;
+      Instr_T value = 0;
+      for (unsigned p = 0; p < instr->numOpParts(); p++) {
+        const auto part = instr->getOpPart(p);
+        mask |= part.range.getInstrMask();
+        value |= part.range.apply(part.value);
+      }
+      QCOMPARE(instr->opcodeMask(), mask);
+      QCOMPARE(instr->opcodeValue(), value);
+      QVERIFY(instr->matchesOpcode(value));
+    }
+  }
+}
+
 QTEST_APPLESS_MAIN(tst_Assembler)
 #include "tst_assembler.moc"
@@ -0,0 +1,222 @@
+#include <QtTest/QTest>
+
+#include <cstring>
+
+#include "assembler/assembler.h"
+#include "isa/rv32isainfo.h"
+#include "isa/rv64isainfo.h"
+#include "processorhandler.h"
+#include "processorregistry.h"
+
+using namespace Ripes;
+using namespace Assembler;
+
+// This test ensures that the bit-manipulation extensions (Zba/Zbb/Zbs) are
+// assembled and disassembled, and that the VSRTL models and the ISS-based
+// models agree on their execution.
+
+class tst_bitmanip : public QObject {
+  Q_OBJECT
+
+private slots:
+  void tst_encoding();
+  void tst_march();
+  void tst_execute();
+  void tst_execute_data();
+  void tst_execute64();
+  void tst_execute64_data();
+
+private:
+  template <ISA isa>
+  void verifyEncodings(
+      const std::vector<std::pair<QString, uint32_t>> &encodings);
+  static RipesProcessor *run(ProcessorID id, const QStringList &program);
+};
+
+static const QStringList s_extensions = {"M", "Zba", "Zbb", "Zbs"};
+
+template <ISA isa>
+void tst_bitmanip::verifyEncodings(
+    const std::vector<std::pair<QString, uint32_t>> &encodings) {
+  auto isaInfo = std::make_shared<ISAInfo<isa>>(s_extensions);
+  ISA_Assembler<isa> assembler(isaInfo);
+  for (const auto &[line, word] : encodings) {
+    const auto res = assembler.assembleRaw(".text\n" + line);
+    QVERIFY2(res.errors.empty(), qPrintable(line));
+    const auto &data = res.program.getSection(".text")->data;
+    QCOMPARE(data.size(), qsizetype(4));
+    uint32_t encoded;
+    std::memcpy(&encoded, data.data(), sizeof(encoded));
+    QCOMPARE(encoded, word);
+
+    // Disassembling the word and assembling the result yields the word.
+    const auto disassembled = assembler.disassemble(encoded, {});
+    QVERIFY(!disassembled.err.has_value());
+    const auto again = assembler.assembleRaw(".text\n" + disassembled.repr);
+    QVERIFY2(again.errors.empty(), qPrintable(disassembled.repr));
+    QCOMPARE(again.program.getSection(".text")->data, data);
+  }
+}
+
+void tst_bitmanip::tst_encoding() {
+  verifyEncodings<ISA::RV32I>({{"sh1add a0, a1, a2", 0x20C5A533},
+                               {"sh3add a0, a1, a2", 0x20C5E533},
+                               {"andn a0, a1, a2", 0x40C5F533},
+                               {"xnor a0, a1, a2", 0x40C5C533},
+                               {"min a0, a1, a2", 0x0AC5C533},
+                               {"maxu a0, a1, a2", 0x0AC5F533},
+                               {"clz a0, a1", 0x60059513},
+                               {"cpop a0, a1", 0x60259513},
+                               {"sext.h a0, a1", 0x60559513},
+                               {"zext.h a0, a1", 0x0805C533},
+                               {"rol a0, a1, a2", 0x60C59533},
+                               {"rori a0, a1, 31", 0x61F5D513},
+                               {"orc.b a0, a1", 0x2875D513},
+                               {"rev8 a0, a1", 0x6985D513},
+                               {"bclr a0, a1, a2", 0x48C59533},
+                               {"bext a0, a1, a2", 0x48C5D533},
+                               {"binvi a0, a1, 7", 0x68759513},
+                               {"bseti a0, a1, 31", 0x29F59513}});
+  verifyEncodings<ISA::RV64I>({{"add.uw a0, a1, a2", 0x08C5853B},
+                               {"sh2add.uw a0, a1, a2", 0x20C5C53B},
+                               {"slli.uw a0, a1, 40", 0x0A85951B},
+                               {"zext.h a0, a1", 0x0805C53B},
+                               {"clzw a0, a1", 0x6005951B},
+                               {"rorw a0, a1, a2", 0x60C5D53B},
+                               {"rori a0, a1, 63", 0x63F5D513},
+                               {"roriw a0, a1, 31", 0x61F5D51B},
+                               {"rev8 a0, a1", 0x6B85D513},
+                               {"bexti a0, a1, 63", 0x4BF5D513}});
+
+  // Bit-manipulation instructions are not available without the extensions.
+  auto base = std::make_shared<ISAInfo<ISA::RV32I>>(QStringList{"M"});
+  QVERIFY(!ISA_Assembler<ISA::RV32I>(base)
+               .assembleRaw(".text\nandn a0, a1, a2")
+               .errors.empty());
+}
+
+void tst_bitmanip::tst_march() {
+  QCOMPARE(ISAInfo<ISA::RV32I>(QStringList{"Zbs", "M", "Zba"}).CCmarch(),
+           QString("rv32im_zba_zbs"));
+  QCOMPARE(ISAInfo<ISA::RV64I>(s_extensions).CCmarch(),
+           QString("rv64im_zba_zbb_zbs"));
+}
+
+RipesProcessor *tst_bitmanip::run(ProcessorID id, const QStringList &program) {
+  ProcessorHandler::selectProcessor(id, s_extensions);
+  auto res = ProcessorHandler::getAssembler()->assembleRaw(program.join("\n"));
+  if (!res.errors.empty())
+    return nullptr;
+  ProcessorHandler::loadProgram(std::make_shared<Program>(res.program));
+  auto *proc = ProcessorHandler::getProcessorNonConst();
+  proc->trapHandler = [] {};
+  while (!proc->finished() && proc->getCycleCount() < 1000)
+    proc->clock();
+  return proc;
+}
+
+void tst_bitmanip::tst_execute_data() {
+  QTest::addColumn<int>("id");
+  QTest::addColumn<unsigned>("xlen");
+  for (auto id : {ProcessorID::RV32_SS, ProcessorID::RV32_5S,
+                  ProcessorID::RV32_5S_NO_FW_HZ, ProcessorID::RV32_ISS,
+                  ProcessorID::RV32_OOO_2W})
+    QTest::newRow(qPrintable(enumToString(id))) << int(id) << 32u;
+  for (auto id : {ProcessorID::RV64_SS, ProcessorID::RV64_5S,
+                  ProcessorID::RV64_ISS, ProcessorID::RV64_7S_GEN})
+    QTest::newRow(qPrintable(enumToString(id))) << int(id) << 64u;
+}
+
+void tst_bitmanip::tst_execute() {
+  QFETCH(int, id);
+  QFETCH(unsigned, xlen);
+
+  const QStringList program = {".text",
+                               "li a0 0xF0",
+                               "li a1 -5",
+                               "li a2 3",
+                               "sh1add s1, a0, a2",
+                               "clz s2, a0",
+                               "ctz s3, a0",
+                               "cpop s4, a1",
+                               "min s5, a1, a2",
+                               "maxu s6, a1, a2",
+                               "andn s7, a0, a2",
+                               "rori s8, a2, 1",
+                               "rev8 s9, a0",
+                               "bseti s10, a0, 0",
+                               "bext s11, a0, a2",
+                               "sext.b t3, a0",
+                               "orc.b t4, a1",
+                               "binv t5, a2, a2",
+                               "rol t6, a1, a2"};
+  auto *proc = run(ProcessorID(id), program);
+  QVERIFY(proc);
+  QVERIFY(proc->finished());
+
+  const VInt mask = xlen == 32 ? VInt(0xFFFFFFFF) : ~VInt(0);
+  const VInt minus5 = VInt(-5) & mask;
+  const VInt msb = VInt(1) << (xlen - 1);
+  const std::vector<std::pair<unsigned, VInt>> expected = {
+      {9, 0x1E3},
+      {18, xlen - 8},
+      {19, 4},
+      {20, xlen - 1},
+      {21, minus5},
+      {22, minus5},
+      {23, 0xF0},
+      {24, msb | 1},
+      {25, VInt(0xF0) << (xlen - 8)},
+      {26, 0xF1},
+      {27, 0},
+      {28, VInt(-16) & mask},
+      {29, mask},
+      {30, 0xB},
+      {31, ((minus5 << 3) | (minus5 >> (xlen - 3))) & mask}};
+  for (const auto &[reg, value] : expected)
+    QCOMPARE(proc->getRegister(RVISA::GPR, reg) & mask, value);
+}
+
+void tst_bitmanip::tst_execute64_data() {
+  QTest::addColumn<int>("id");
+  for (auto id : {ProcessorID::RV64_SS, ProcessorID::RV64_5S,
+                  ProcessorID::RV64_ISS})
+    QTest::newRow(qPrintable(enumToString(id))) << int(id);
+}
+
+void tst_bitmanip::tst_execute64() {
+  QFETCH(int, id);
+
+  const QStringList program = {".text",
+                               "li a0 -1",
+                               "li a1 5",
+                               "li a2 0x80000001",
+                               "add.uw s1, a0, a1",
+                               "sh3add.uw s2, a0, a1",
+                               "slli.uw s3, a0, 4",
+                               "clzw s4, a1",
+                               "cpopw s5, a0",
+                               "rolw s6, a2, a1",
+                               "roriw s7, a2, 1",
+                               "zext.h s8, a0",
+                               "bseti s9, zero, 63"};
+  auto *proc = run(ProcessorID(id), program);
+  QVERIFY(proc);
+  QVERIFY(proc->finished());
+
+  const std::vector<std::pair<unsigned, VInt>> expected = {
+      {9, 0x100000004},
+      {18, 0x7FFFFFFFD},
+      {19, 0xFFFFFFFF0},
+      {20, 29},
+      {21, 32},
+      {22, 0x30},
+      {23, 0xFFFFFFFFC0000000},
+      {24, 0xFFFF},
+      {25, 0x8000000000000000}};
+  for (const auto &[reg, value] : expected)
+    QCOMPARE(proc->getRegister(RVISA::GPR, reg), value);
+}
+
+QTEST_APPLESS_MAIN(tst_bitmanip)
+#include "tst_bitmanip.moc"
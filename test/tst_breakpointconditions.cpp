@@ -0,0 +1,124 @@
+#include <QSignalSpy>
+#include <QtTest/QTest>
+
+#include "processorhandler.h"
+#include "processorregistry.h"
+#include "ripessettings.h"
+
+using namespace Ripes;
+
+// This test ensures that conditional breakpoints only stop runs once their
+// condition held, that hit counts are counted once per instruction, and that
+// invalid conditions are rejected.
+
+class tst_breakpointconditions : public QObject {
+  Q_OBJECT
+
+private slots:
+  void init();
+  void cleanup();
+  void tst_condition();
+  void tst_memory();
+  void tst_hitCount_data();
+  void tst_hitCount();
+  void tst_invalid();
+
+private:
+  void load(ProcessorID id);
+  void run();
+  VInt a0() const {
+    return ProcessorHandler::getProcessor()->getRegister(RVISA::GPR, 10);
+  }
+  AInt m_loop = 0;
+};
+
+void tst_breakpointconditions::load(ProcessorID id) {
+  ProcessorHandler::selectProcessor(id, {"M"});
+  auto res = ProcessorHandler::getAssembler()->assembleRaw(
+      QStringList{".data", "count: .word 0", ".text", "la t1 count", "li a0 0",
+                  "li t0 20", "loop:", "addi a0 a0 1", "sw a0 0(t1)",
+                  "blt a0 t0 loop", "li a7 10", "ecall"}
+          .join("\n"));
+  QVERIFY(res.errors.empty());
+  auto program = std::make_shared<Program>(res.program);
+  ProcessorHandler::loadProgram(program);
+  m_loop = program->getSection(TEXT_SECTION_NAME)->address + 16;
+}
+
+void tst_breakpointconditions::run() {
+  QSignalSpy finished(ProcessorHandler::get(), &ProcessorHandler::runFinished);
+  ProcessorHandler::run();
+  QVERIFY(finished.wait(10000));
+  // Waits for the run to have finished entirely.
+  ProcessorHandler::stopRun();
+}
+
+void tst_breakpointconditions::init() { load(ProcessorID::RV32_ISS); }
+
+void tst_breakpointconditions::cleanup() {
+  ProcessorHandler::clearBreakpoints();
+}
+
+void tst_breakpointconditions::tst_condition() {
+  QCOMPARE(ProcessorHandler::setBreakpointCondition(m_loop, "a0 == 9"),
+           QString());
+  QVERIFY(ProcessorHandler::hasBreakpoint(m_loop));
+  run();
+  QCOMPARE(ProcessorHandler::getProcessor()->getPcForStage({0, 0}), m_loop);
+  QCOMPARE(a0(), VInt(9));
+  QCOMPARE(ProcessorHandler::breakpointCondition(m_loop)->hits, 1u);
+
+  // Runs resumed past the breakpoint run to completion.
+  ProcessorHandler::getProcessorNonConst()->clock();
+  run();
+  QVERIFY(ProcessorHandler::getProcessor()->finished());
+  QCOMPARE(a0(), VInt(20));
+
+  // Removing the breakpoint removes its condition.
+  ProcessorHandler::setBreakpoint(m_loop, false);
+  QVERIFY(!ProcessorHandler::breakpointCondition(m_loop));
+}
+
+void tst_breakpointconditions::tst_memory() {
+  QCOMPARE(ProcessorHandler::setBreakpointCondition(
+               m_loop, "[count] * 2 > t0 + pc - loop"),
+           QString());
+  run();
+  QCOMPARE(a0(), VInt(11));
+}
+
+void tst_breakpointconditions::tst_hitCount_data() {
+  QTest::addColumn<int>("id");
+  QTest::newRow("ISS") << int(ProcessorID::RV32_ISS);
+  QTest::newRow("5-stage") << int(ProcessorID::RV32_5S);
+}
+
+void tst_breakpointconditions::tst_hitCount() {
+  QFETCH(int, id);
+  load(ProcessorID(id));
+  QCOMPARE(ProcessorHandler::setBreakpointCondition(m_loop, "", 5), QString());
+  run();
+  QVERIFY(!ProcessorHandler::getProcessor()->finished());
+  QCOMPARE(ProcessorHandler::breakpointCondition(m_loop)->hits, 5u);
+
+  // Once reached, the hit count stops every hit.
+  ProcessorHandler::getProcessorNonConst()->clock();
+  run();
+  QCOMPARE(ProcessorHandler::breakpointCondition(m_loop)->hits, 6u);
+
+  RipesSettings::getObserver(RIPES_GLOBALSIGNAL_REQRESET)->trigger();
+  QCOMPARE(ProcessorHandler::breakpointCondition(m_loop)->hits, 0u);
+}
+
+void tst_breakpointconditions::tst_invalid() {
+  for (const QString &condition : {"b0 == 1", "a0 = 1", "[nothing] > 1"}) {
+    QVERIFY(!ProcessorHandler::setBreakpointCondition(m_loop, condition)
+                 .isEmpty());
+  }
+  QVERIFY(!ProcessorHandler::hasBreakpoint(m_loop));
+  // Data is not executable.
+  QVERIFY(!ProcessorHandler::setBreakpointCondition(0, "a0 == 1").isEmpty());
+}
+
+QTEST_MAIN(tst_breakpointconditions)
+#include "tst_breakpointconditions.moc"
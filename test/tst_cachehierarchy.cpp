@@ -0,0 +1,794 @@
+#include <QtTest/QTest>
+
+#include <map>
+#include <random>
+
+#include "cachesim/cachehierarchy.h"
+#include "cachesim/cachesim.h"
+#include "cachesim/cacheworker.h"
+#include "cachesim/dramsim.h"
+#include "cachesim/missattribution.h"
+#include "cachesim/mmu.h"
+#include "cachesim/victimcache.h"
+#include "processorhandler.h"
+#include "processors/RISC-V/rv_fetchqueue.h"
+
+using namespace Ripes;
+
+// This test ensures that the misses and writebacks of the L1 caches of a cache
+// hierarchy are propagated to the shared L2 cache, that prefetchers eliminate
+// the misses of regular access patterns, that the replacement policies select
+// the expected victims, that caches simulated on a worker thread match caches
+// simulated synchronously, that misses stall the processor when
+// configured to stall, that a store buffer hides the misses of stores, that
+// a fetch queue decouples the misses of the instruction cache from the
+// pipeline, that misses are attributed to the instructions and symbols
+// causing them, that the MMU translates accesses through its TLBs and page
+// tables, that the DRAM behind the caches rewards row-buffer locality, and
+// that victim caches and the inclusion policies of the L2 cache hold the
+// expected blocks.
+
+class tst_cachehierarchy : public QObject {
+  Q_OBJECT
+
+private slots:
+  void tst_propagation();
+  void tst_prefetch();
+  void tst_replacement();
+  void tst_worker();
+  void tst_stall();
+  void tst_storeBuffer();
+  void tst_fetchQueue();
+  void tst_missAttribution();
+  void tst_mmu();
+  void tst_dram();
+  void tst_victimCache();
+};
+
+void tst_cachehierarchy::tst_propagation() {
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_SS);
+
+  // Direct-mapped L1 caches of 4 lines of 1 word, and a 4-way L2 cache.
+  const CachePreset l1{"l1",
+                       0,
+                       2,
+                       0,
+                       WritePolicy::WriteBack,
+                       WriteAllocPolicy::WriteAllocate,
+                       ReplPolicy::LRU};
+  const CachePreset l2{"l2",
+                       2,
+                       4,
+                       2,
+                       WritePolicy::WriteBack,
+                       WriteAllocPolicy::WriteAllocate,
+                       ReplPolicy::LRU};
+  CacheHierarchyConfig config;
+  config.l1i = l1;
+  config.l1d = l1;
+  config.l2 = l2;
+  CacheHierarchy caches(config);
+
+  // Each data access conflicts with the previous one in the L1 data cache, and
+  // every access is a write, such that every eviction is a writeback.
+  for (unsigned i = 0; i < 64; ++i) {
+    const MemoryAccess instr{MemoryAccess::Read, 0x100 + (i % 8) * 4, 4};
+    const MemoryAccess data{MemoryAccess::Write, 0x1000 + (i % 2) * 0x10, 4};
+    caches.access(instr, data);
+  }
+
+  auto &l1i = caches.l1i();
+  auto &l1d = caches.l1d();
+  auto *l2Cache = caches.l2();
+  QVERIFY(l2Cache != nullptr);
+  QCOMPARE(l1d.getHits(), 0u);
+  QCOMPARE(l1d.getMisses(), 64u);
+  QCOMPARE(l1d.getWritebacks(), 63u);
+  // Both data addresses map to set 0.
+  QCOMPARE(l1d.getLineMisses().size(), size_t(4));
+  QCOMPARE(l1d.getLineMisses()[0], 64u);
+  const auto l1dReport = caches.report(/*json=*/false)["L1D"].toMap();
+  QCOMPARE(l1dReport["set misses"].toString(), QString("0:64"));
+  QCOMPARE(l2Cache->getHits() + l2Cache->getMisses(),
+           l1i.getMisses() + l1d.getMisses() + l1d.getWritebacks());
+
+  // Both L1 working sets fit in the L2 cache.
+  const unsigned l2Misses = l2Cache->getMisses();
+  QVERIFY(l2Misses <= 4);
+  QVERIFY(caches.amat(l1d) > config.l1Latency + config.l2Latency);
+  QVERIFY(caches.stallCycles() > 0);
+}
+
+void tst_cachehierarchy::tst_prefetch() {
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_SS);
+
+  // 2-way caches of 16 lines of 4 words.
+  const CachePreset l1{"l1",
+                       2,
+                       4,
+                       1,
+                       WritePolicy::WriteBack,
+                       WriteAllocPolicy::WriteAllocate,
+                       ReplPolicy::LRU};
+  const auto run = [&](const PrefetchConfig &prefetch, unsigned stride) {
+    CacheHierarchyConfig config;
+    config.l1i = l1;
+    config.l1d = l1;
+    config.l1dPrefetch = prefetch;
+    auto caches = std::make_unique<CacheHierarchy>(config);
+    for (unsigned i = 0; i < 1024; ++i) {
+      const MemoryAccess data{MemoryAccess::Read, 0x1000 + i * stride, 4,
+                              0x200};
+      caches->access(MemoryAccess(), data);
+    }
+    return caches;
+  };
+
+  // Without prefetching, every block of a sequential stream misses once.
+  auto caches = run(PrefetchConfig(), 4);
+  QCOMPARE(caches->l1d().getMisses(), 256u);
+  QCOMPARE(caches->l1d().getPrefetchStats().issued, 0LL);
+
+  // A tagged next-line prefetcher fetches every block ahead of its first use.
+  caches = run({PrefetcherType::NextLine, 1}, 4);
+  auto stats = caches->l1d().getPrefetchStats();
+  QCOMPARE(caches->l1d().getMisses(), 1u);
+  QCOMPARE(stats.issued, 256LL);
+  QCOMPARE(stats.useful, 255LL);
+  QCOMPARE(stats.pollution, 0LL);
+  QCOMPARE(stats.coverage(caches->l1d().getMisses()), 255.0 / 256);
+
+  // The stream prefetcher establishes the direction after two misses.
+  caches = run({PrefetcherType::Stream, 2}, 4);
+  QCOMPARE(caches->l1d().getMisses(), 2u);
+
+  // The stride prefetcher predicts a stride spanning multiple blocks once it
+  // has been observed twice.
+  caches = run({PrefetcherType::Stride, 1}, 64);
+  stats = caches->l1d().getPrefetchStats();
+  QCOMPARE(caches->l1d().getMisses(), 3u);
+  QCOMPARE(stats.useful, 1021LL);
+  QCOMPARE(stats.accuracy(), 1021.0 / 1022);
+}
+
+void tst_cachehierarchy::tst_replacement() {
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_SS);
+
+  // Returns the misses of a single-line cache of 2^waysBits ways of 1 word,
+  // accessing the words of @p pattern.
+  const auto misses = [](ReplPolicy policy, int waysBits,
+                         const QString &pattern) {
+    CacheSim cache(nullptr);
+    cache.setPreset({"", 0, 0, waysBits, WritePolicy::WriteBack,
+                     WriteAllocPolicy::WriteAllocate, policy});
+    cache.setRecordHistory(false);
+    for (const QChar c : pattern)
+      cache.access((c.unicode() - 'A') * 4, MemoryAccess::Read);
+    return cache.getMisses();
+  };
+
+  // FIFO evicts A, which LRU retains.
+  QCOMPARE(misses(ReplPolicy::LRU, 1, "ABACA"), 3u);
+  QCOMPARE(misses(ReplPolicy::FIFO, 1, "ABACA"), 4u);
+
+  // Tree-PLRU evicts C rather than the least recently used B.
+  QCOMPARE(misses(ReplPolicy::LRU, 2, "ABCDAEB"), 6u);
+  QCOMPARE(misses(ReplPolicy::PLRU, 2, "ABCDAEB"), 5u);
+
+  // SRRIP retains the reused blocks A and B across a scan, which LRU evicts.
+  QCOMPARE(misses(ReplPolicy::LRU, 2, "ABABWXYZAB"), 8u);
+  QCOMPARE(misses(ReplPolicy::SRRIP, 2, "ABABWXYZAB"), 6u);
+}
+
+void tst_cachehierarchy::tst_worker() {
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_SS);
+
+  const CachePreset preset{"",
+                           1,
+                           3,
+                           1,
+                           WritePolicy::WriteBack,
+                           WriteAllocPolicy::WriteAllocate,
+                           ReplPolicy::LRU};
+  const auto createCache = [&] {
+    auto cache = std::make_shared<CacheSim>(nullptr);
+    cache->setPreset(preset);
+    cache->setRecordHistory(false);
+    return cache;
+  };
+  auto syncCache = createCache();
+  auto asyncCache = createCache();
+
+  CacheWorker worker(asyncCache);
+  std::mt19937 rng(1);
+  for (unsigned i = 0; i < 100000; ++i) {
+    const AInt address = (rng() % 512) * 4;
+    const auto type = rng() % 4 == 0 ? MemoryAccess::Write : MemoryAccess::Read;
+    syncCache->access(address, type);
+    worker.push({address, 0, i, type});
+    if (i % 1000 == 0)
+      worker.notify();
+  }
+  worker.drain();
+
+  QCOMPARE(asyncCache->getHits(), syncCache->getHits());
+  QCOMPARE(asyncCache->getMisses(), syncCache->getMisses());
+  QCOMPARE(asyncCache->getWritebacks(), syncCache->getWritebacks());
+  QVERIFY(asyncCache->getLineMisses() == syncCache->getLineMisses());
+}
+
+void tst_cachehierarchy::tst_stall() {
+  // Loads 16 consecutive words, each of which misses the data cache.
+  const QString program = QStringList{".data",
+                                      "a: .zero 64",
+                                      ".text",
+                                      "la a0 a",
+                                      "li t1 16",
+                                      "loop:",
+                                      "lw t0 0(a0)",
+                                      "addi a0 a0 4",
+                                      "addi t1 t1 -1",
+                                      "bnez t1 loop",
+                                      "nop"}
+                              .join("\n");
+  const auto run = [&](CacheHierarchy *caches) {
+    ProcessorHandler::selectProcessor(ProcessorID::RV32_5S, {"M"});
+    ProcessorHandler::setPerformanceCounting(true);
+    auto res = ProcessorHandler::getAssembler()->assembleRaw(program);
+    if (!res.errors.empty())
+      return static_cast<RipesProcessor *>(nullptr);
+    ProcessorHandler::loadProgram(std::make_shared<Program>(res.program));
+    auto *proc = ProcessorHandler::getProcessorNonConst();
+    proc->trapHandler = [] {};
+    proc->setMaxReverseCycles(10000);
+    if (caches)
+      caches->attachToProcessor();
+    while (!proc->finished() && proc->getCycleCount() < 10000)
+      proc->clock();
+    return proc;
+  };
+
+  auto *proc = run(nullptr);
+  QVERIFY(proc && proc->finished());
+  const long long cycles = proc->getCycleCount();
+  const long long retired = proc->getInstructionsRetired();
+
+  const CachePreset l1{"l1",
+                       0,
+                       2,
+                       0,
+                       WritePolicy::WriteBack,
+                       WriteAllocPolicy::WriteAllocate,
+                       ReplPolicy::LRU};
+  CacheHierarchyConfig config;
+  config.l1i = l1;
+  config.l1d = l1;
+  config.memoryLatency = 20;
+  config.stall = true;
+  CacheHierarchy caches(config);
+  proc = run(&caches);
+  QVERIFY(proc && proc->finished());
+  QVERIFY(caches.stallsProcessor());
+  QCOMPARE(caches.l1d().getMisses(), 16u);
+
+  // The pipeline executes the same cycles, interleaved with memory stalls.
+  const long long stalls = proc->performanceCounters().memoryStalls;
+  QCOMPARE(proc->getInstructionsRetired(), retired);
+  QCOMPARE(proc->getCycleCount(), cycles + stalls);
+  QCOMPARE(caches.stallCycles(), double(stalls));
+  // Misses of the instruction and data caches in the same cycle overlap.
+  QVERIFY(stalls >= 16 * config.memoryLatency);
+  QVERIFY(stalls <= (caches.l1i().getMisses() + 16) * config.memoryLatency);
+
+  // Reversing undoes stalled cycles as any other cycle.
+  while (proc->getCycleCount() > 0) {
+    const long long cycle = proc->getCycleCount();
+    proc->reverseProcessor();
+    QCOMPARE(proc->getCycleCount(), cycle - 1);
+  }
+  QCOMPARE(proc->performanceCounters().memoryStalls, 0LL);
+  QCOMPARE(proc->getInstructionsRetired(), 0LL);
+  ProcessorHandler::setPerformanceCounting(false);
+}
+
+void tst_cachehierarchy::tst_storeBuffer() {
+  // Copies 16 words, reading back each copied word.
+  const QString program = QStringList{".data",
+                                      "a: .zero 64",
+                                      "b: .zero 64",
+                                      ".text",
+                                      "la a0 a",
+                                      "la a1 b",
+                                      "li t1 16",
+                                      "loop:",
+                                      "lw t0 0(a0)",
+                                      "sw t0 0(a1)",
+                                      "lw t2 0(a1)",
+                                      "addi a0 a0 4",
+                                      "addi a1 a1 4",
+                                      "addi t1 t1 -1",
+                                      "bnez t1 loop",
+                                      "nop"}
+                              .join("\n");
+  // Direct-mapped caches of 16 lines of 4 words, holding both arrays.
+  const CachePreset l1{"l1",
+                       2,
+                       4,
+                       0,
+                       WritePolicy::WriteBack,
+                       WriteAllocPolicy::WriteAllocate,
+                       ReplPolicy::LRU};
+  const auto run = [&](const StoreBufferConfig &storeBuffer) {
+    CacheHierarchyConfig config;
+    config.l1i = l1;
+    config.l1d = l1;
+    config.memoryLatency = 20;
+    config.stall = true;
+    config.storeBuffer = storeBuffer;
+    auto caches = std::make_unique<CacheHierarchy>(config);
+    ProcessorHandler::selectProcessor(ProcessorID::RV32_5S, {"M"});
+    auto res = ProcessorHandler::getAssembler()->assembleRaw(program);
+    if (!res.errors.empty())
+      return std::make_pair(-1LL, std::move(caches));
+    ProcessorHandler::loadProgram(std::make_shared<Program>(res.program));
+    auto *proc = ProcessorHandler::getProcessorNonConst();
+    proc->trapHandler = [] {};
+    caches->attachToProcessor();
+    while (!proc->finished() && proc->getCycleCount() < 10000)
+      proc->clock();
+    return std::make_pair(proc->finished() ? proc->getCycleCount() : -1LL,
+                          std::move(caches));
+  };
+  // Caches are reset along with the processor of the next run, such that
+  // their statistics are read before the next run.
+  const auto l1dAccesses = [](CacheHierarchy &caches) {
+    return static_cast<long long>(caches.l1d().getHits() +
+                                  caches.l1d().getMisses());
+  };
+
+  auto [unbuffered, caches] = run({});
+  QVERIFY(unbuffered > 0);
+  QVERIFY(caches->storeBuffer() == nullptr);
+  QCOMPARE(l1dAccesses(*caches), 48LL);
+  const long long unbufferedStalls = caches->stallCycles();
+
+  // Store misses drain in the background, and the read-back loads are
+  // forwarded the stored words without accessing the cache.
+  auto [buffered, bufferedCaches] = run({4, false});
+  QVERIFY(buffered > 0);
+  QVERIFY(buffered < unbuffered);
+  const StoreBuffer *buffer = bufferedCaches->storeBuffer();
+  QVERIFY(buffer);
+  QCOMPARE(buffer->stats().stores, 16LL);
+  QCOMPARE(buffer->stats().forwarded, 16LL);
+  QCOMPARE(buffer->stats().combined, 0LL);
+  QCOMPARE(buffer->stats().conflictStalls, 0LL);
+  QCOMPARE(buffer->stats().drained + buffer->occupancy(), 16LL);
+  const long long bufferedAccesses = l1dAccesses(*bufferedCaches);
+  QCOMPARE(bufferedAccesses, 16 + buffer->stats().drained);
+  QVERIFY(buffer->stats().maxOccupancy <= 4);
+  const auto report = bufferedCaches->report()["store buffer"].toMap();
+  QCOMPARE(report["forwarded loads"].toLongLong(), 16LL);
+
+  // Sequential stores arriving whilst a miss drains are merged.
+  auto [combining, combiningCaches] = run({4, true});
+  QVERIFY(combining > 0);
+  buffer = combiningCaches->storeBuffer();
+  QVERIFY(buffer->stats().combined > 0);
+  QCOMPARE(buffer->stats().forwarded, 16LL);
+  QCOMPARE(buffer->stats().drained + buffer->stats().combined +
+               buffer->occupancy(),
+           16LL);
+  QVERIFY(l1dAccesses(*combiningCaches) < bufferedAccesses);
+
+  // A single entry fills on every store miss.
+  auto [single, singleCaches] = run({1, false});
+  QVERIFY(single > 0);
+  buffer = singleCaches->storeBuffer();
+  QVERIFY(buffer->stats().fullStalls > 0);
+  QCOMPARE(buffer->stats().maxOccupancy, 1u);
+  // The pipeline executes the same cycles, interleaved with the stalls of the
+  // buffer.
+  QCOMPARE(singleCaches->stallCycles(),
+           double(single - unbuffered + unbufferedStalls));
+}
+
+void tst_cachehierarchy::tst_fetchQueue() {
+  // A loop of 20 instructions exceeding the instruction cache, of which two
+  // dependent multiplications at the start of a line hitting the cache.
+  QStringList lines = {".text", "li t1 3", "li t2 50", "loop:"};
+  for (int i = 0; i < 16; i++) {
+    if (i == 6)
+      lines << "mul t3 t3 t1"
+            << "mul t3 t3 t1";
+    lines << "addi t0 t0 1";
+  }
+  lines << "addi t2 t2 -1"
+        << "bnez t2 loop"
+        << "nop";
+  const QString program = lines.join("\n");
+  // A direct-mapped cache of 4 lines of 4 words.
+  const CachePreset l1{"l1",
+                       2,
+                       2,
+                       0,
+                       WritePolicy::WriteBack,
+                       WriteAllocPolicy::WriteAllocate,
+                       ReplPolicy::LRU};
+  const auto run = [&](const FetchQueueConfig &fetchQueue) {
+    CacheHierarchyConfig config;
+    config.l1i = l1;
+    config.l1d = l1;
+    config.memoryLatency = 20;
+    config.stall = true;
+    auto caches = std::make_unique<CacheHierarchy>(config);
+    ProcessorHandler::selectProcessor(ProcessorID::RV32_5S_GEN, {"M"});
+    ProcessorHandler::setPerformanceCounting(true);
+    auto *proc = ProcessorHandler::getProcessorNonConst();
+    dynamic_cast<FetchQueueProcessor *>(proc)->setFetchQueue(fetchQueue);
+    auto res = ProcessorHandler::getAssembler()->assembleRaw(program);
+    if (!res.errors.empty())
+      return std::make_pair(static_cast<RipesProcessor *>(nullptr),
+                            std::move(caches));
+    ProcessorHandler::loadProgram(std::make_shared<Program>(res.program));
+    proc->trapHandler = [] {};
+    caches->attachToProcessor();
+    while (!proc->finished() && proc->getCycleCount() < 100000)
+      proc->clock();
+    return std::make_pair(proc, std::move(caches));
+  };
+
+  // Without a queue, instruction misses stall the pipeline as a whole.
+  auto [proc, caches] = run({});
+  QVERIFY(proc && proc->finished());
+  const long long retired = proc->getInstructionsRetired();
+  const VInt result = proc->getRegister(RVISA::GPR, 5);
+  QCOMPARE(result, VInt(16 * 50));
+  QVERIFY(proc->performanceCounters().memoryStalls > 0);
+  QCOMPARE(proc->performanceCounters().fetchStalls, 0LL);
+  QCOMPARE(proc->performanceCounters().backendStalls, 0LL);
+
+  // With a queue, the misses delay the fetch unit, which fetches whole lines,
+  // and the pipeline starves on the empty queue instead. The instructions
+  // queued behind the multiplications wait on the stalled pipeline.
+  auto [queued, queuedCaches] = run({8, 16});
+  QVERIFY(queued && queued->finished());
+  QCOMPARE(queued->getInstructionsRetired(), retired);
+  QCOMPARE(queued->getRegister(RVISA::GPR, 5), result);
+  const auto &counters = queued->performanceCounters();
+  QCOMPARE(counters.memoryStalls, 0LL);
+  QVERIFY(counters.fetchStalls > 0);
+  QVERIFY(counters.backendStalls > 0);
+  const long long lineFetches =
+      queuedCaches->l1i().getHits() + queuedCaches->l1i().getMisses();
+  QVERIFY(lineFetches * 3 < retired);
+  ProcessorHandler::setPerformanceCounting(false);
+}
+
+void tst_cachehierarchy::tst_missAttribution() {
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_SS);
+
+  // Direct-mapped L1 caches of 4 lines of 1 word, and a 4-way L2 cache of 4
+  // lines of 4 words.
+  const CachePreset l1{"l1",
+                       0,
+                       2,
+                       0,
+                       WritePolicy::WriteBack,
+                       WriteAllocPolicy::WriteAllocate,
+                       ReplPolicy::LRU};
+  const CachePreset l2{"l2",
+                       2,
+                       2,
+                       2,
+                       WritePolicy::WriteBack,
+                       WriteAllocPolicy::WriteAllocate,
+                       ReplPolicy::LRU};
+  CacheHierarchyConfig config;
+  config.l1i = l1;
+  config.l1d = l1;
+  config.l2 = l2;
+  CacheHierarchy caches(config);
+
+  // The load at 0x100 alternates between two conflicting words of set 0, and
+  // thus always misses, whereas the load at 0x104 misses only once.
+  for (unsigned i = 0; i < 32; ++i) {
+    caches.access(MemoryAccess(), {MemoryAccess::Read,
+                                   0x1000 + (i % 2) * 0x10, 4, 0x100});
+    caches.access(MemoryAccess(), {MemoryAccess::Read, 0x1004, 4, 0x104});
+  }
+  // A miss outside of the sections of the program.
+  caches.access(MemoryAccess(), {MemoryAccess::Read, 0x2000, 4, 0x108});
+
+  const auto &l1d = caches.l1d().getPCAccesses();
+  QCOMPARE(l1d.size(), size_t(3));
+  QCOMPARE(l1d.at(0x100).accesses, 32u);
+  QCOMPARE(l1d.at(0x100).misses, 32u);
+  QCOMPARE(l1d.at(0x104).accesses, 32u);
+  QCOMPARE(l1d.at(0x104).misses, 1u);
+  QCOMPARE(caches.l1d().getAddressMisses().at(0x1010), 16u);
+  // The fetches of the L2 cache are attributed to the loads missing the L1
+  // cache; the L2 cache holds both blocks of the load at 0x100.
+  const auto &l2Accesses = caches.l2()->getPCAccesses();
+  QCOMPARE(l2Accesses.at(0x100).accesses, 32u);
+  QCOMPARE(l2Accesses.at(0x100).misses, 2u);
+  QCOMPARE(l2Accesses.at(0x104).accesses, 1u);
+  QCOMPARE(l2Accesses.at(0x104).misses, 0u);
+
+  // lw x1, 0(x2) at each of the loads, and two data symbols.
+  auto program = std::make_shared<Program>();
+  QByteArray text;
+  for (unsigned i = 0; i < 3; ++i)
+    text.append("\x83\x20\x01\x00", 4);
+  program->sections[".text"] = {".text", 0x100, text};
+  program->sections[".data"] = {".data", 0x1000, QByteArray(0x20, 0)};
+  program->symbols[0x100] = Symbol("main");
+  program->symbols[0x1000] = Symbol("a");
+  program->symbols[0x1010] = Symbol("b");
+
+  const MissAttribution attribution(caches.l1d(), program);
+  const auto instructions = attribution.instructions(2);
+  QCOMPARE(instructions.size(), size_t(2));
+  QCOMPARE(instructions[0].address, AInt(0x100));
+  QCOMPARE(instructions[0].missRate(), 1.0);
+  QVERIFY(instructions[0].name.startsWith("lw"));
+  QCOMPARE(instructions[1].address, AInt(0x104));
+
+  const auto symbols = attribution.symbols();
+  QCOMPARE(symbols.size(), size_t(3));
+  QCOMPARE(symbols[0].name, QString("a"));
+  QCOMPARE(symbols[0].misses, 17u);
+  QCOMPARE(symbols[1].name, QString("b"));
+  QCOMPARE(symbols[1].misses, 16u);
+  QCOMPARE(symbols[2].name, QString(MissAttribution::s_unmapped));
+  QCOMPARE(symbols[2].misses, 1u);
+
+  const auto report = attribution.report(1, /*json=*/true).toMap();
+  QCOMPARE(report["misses"].toUInt(), 34u);
+  QCOMPARE(report["instructions"].toList().size(), 1);
+
+  caches.reset();
+  QVERIFY(caches.l1d().getPCAccesses().empty());
+  QVERIFY(caches.l1d().getAddressMisses().empty());
+}
+
+void tst_cachehierarchy::tst_mmu() {
+  // Sv39 page tables rooted at 0x10000, mapping the base page at 0x1000 onto
+  // 0x80000 (RW), the megapage at 0x200000 onto 0x400000 (RX), and a
+  // misaligned megapage at 0x400000.
+  constexpr VInt valid = 1, read = 2, write = 4, execute = 8;
+  std::map<AInt, VInt> memory;
+  memory[0x10000] = (0x11 << 10) | valid;
+  memory[0x11000] = (0x12 << 10) | valid;
+  memory[0x11008] = (0x400 << 10) | valid | read | execute;
+  memory[0x11010] = (0x401 << 10) | valid | read;
+  memory[0x12008] = (0x80 << 10) | valid | read | write;
+
+  MMUConfig config;
+  config.mode = PagingMode::Sv39;
+  config.root = 0x10000;
+  config.walkLatency = 10;
+  MMU mmu(config, [&](AInt address, unsigned) {
+    auto it = memory.find(address);
+    return it == memory.end() ? VInt(0) : it->second;
+  });
+  // Returns the translation of an access, or 0 on a page fault.
+  const auto translate = [&](AInt address, MemoryAccess::Type type,
+                             bool fetch) {
+    return mmu.translate(address, type, fetch).value_or(0);
+  };
+
+  // A base page is walked through all three levels, and then hits.
+  QCOMPARE(translate(0x1234, MemoryAccess::Read, false), AInt(0x80234));
+  QCOMPARE(translate(0x1238, MemoryAccess::Write, false), AInt(0x80238));
+  QCOMPARE(mmu.dtlb().misses(), 1u);
+  QCOMPARE(mmu.dtlb().hits(), 1u);
+
+  // A megapage is walked through two levels, and one entry covers all of it.
+  QCOMPARE(translate(0x200010, MemoryAccess::Read, true), AInt(0x400010));
+  QCOMPARE(translate(0x3ffffc, MemoryAccess::Read, true), AInt(0x5ffffc));
+  QCOMPARE(mmu.itlb().misses(), 1u);
+  QCOMPARE(mmu.itlb().hits(), 1u);
+  QCOMPARE(mmu.itlb().reach(), AInt(0x200000));
+
+  // Stores to the read-only megapage, misaligned megapages and invalid entries
+  // fault.
+  QVERIFY(!mmu.translate(0x200000, MemoryAccess::Write, false));
+  QVERIFY(!mmu.translate(0x400000, MemoryAccess::Read, false));
+  QVERIFY(!mmu.translate(0x5000, MemoryAccess::Read, false));
+  QCOMPARE(mmu.pageFaults(), 3ull);
+  QCOMPARE(mmu.walks(), 5ull);
+  QCOMPARE(mmu.dtlb().reach(), AInt(0x201000));
+  QCOMPARE(mmu.stallCycles(), 12ull * 10);
+
+  // Loads striding over 64 base pages thrash a TLB of 4 entries, whereas a
+  // single entry of an Sv32 megapage covers them all.
+  for (const unsigned pageLevel : {0u, 1u}) {
+    MMUConfig identity;
+    identity.pageLevel = pageLevel;
+    identity.dtlb = {0, 2, ReplPolicy::LRU};
+    MMU identityMMU(identity);
+    for (unsigned i = 0; i < 2 * 64; ++i) {
+      const AInt address = 0x10000000 + (i % 64) * 0x1000;
+      QCOMPARE(
+          identityMMU.translate(address, MemoryAccess::Read, false).value_or(0),
+          address);
+    }
+    QCOMPARE(identityMMU.dtlb().misses(), pageLevel == 0 ? 128u : 1u);
+    QCOMPARE(identityMMU.stallCycles(),
+             identityMMU.dtlb().misses() * (2ull - pageLevel) *
+                 identity.walkLatency);
+  }
+
+  mmu.reset();
+  QCOMPARE(mmu.walks(), 0ull);
+  QCOMPARE(mmu.dtlb().reach(), AInt(0));
+}
+
+void tst_cachehierarchy::tst_dram() {
+  // Two banks of rows of 64 bytes.
+  DRAMConfig config;
+  config.banks = 2;
+  config.rowBytes = 64;
+  config.tRCD = 10;
+  config.tCAS = 20;
+  config.tRP = 30;
+  for (const auto policy : {RowPolicy::Open, RowPolicy::Closed}) {
+    config.policy = policy;
+    DRAMSim dram(config);
+    const bool open = policy == RowPolicy::Open;
+    const auto read = [&](AInt address) {
+      dram.markReads();
+      dram.access(address, MemoryAccess::Read);
+      return dram.firstReadLatency().value_or(0);
+    };
+    // An empty bank, a row hit, the other bank and a row conflict.
+    QCOMPARE(read(0x0), 30u);
+    QCOMPARE(read(0x4), open ? 20u : 30u);
+    QCOMPARE(read(0x40), 30u);
+    QCOMPARE(read(0x80), open ? 60u : 30u);
+    dram.access(0x0, MemoryAccess::Write);
+    QCOMPARE(dram.reads(), 4ull);
+    QCOMPARE(dram.writes(), 1ull);
+    QCOMPARE(dram.rowHits(), open ? 1ull : 0ull);
+    QCOMPARE(dram.rowConflicts(), open ? 2ull : 0ull);
+    QCOMPARE(dram.averageReadLatency(), open ? 35.0 : 30.0);
+    dram.reset();
+    QCOMPARE(dram.reads(), 0ull);
+    QCOMPARE(read(0x4), 30u);
+  }
+
+  // Direct-mapped L1 caches of 4 lines of 1 word in front of 8 banks of rows
+  // of 256 bytes. Reading a row of words in order hits its open row, whereas
+  // reading a column of words 8 rows apart conflicts in a single bank.
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_SS);
+  CacheHierarchyConfig hierarchy;
+  hierarchy.l1i = {"l1",
+                   0,
+                   2,
+                   0,
+                   WritePolicy::WriteBack,
+                   WriteAllocPolicy::WriteAllocate,
+                   ReplPolicy::LRU};
+  hierarchy.l1d = hierarchy.l1i;
+  hierarchy.dram = DRAMConfig{8, 256, RowPolicy::Open, 10, 20, 30};
+  double amat[2];
+  for (const unsigned stride : {4u, 8 * 256u}) {
+    CacheHierarchy caches(hierarchy);
+    for (unsigned i = 0; i < 64; ++i)
+      caches.access(MemoryAccess(),
+                    {MemoryAccess::Read, 0x1000 + i * stride, 4, 0x100});
+    const DRAMSim *dram = caches.dram();
+    QVERIFY(dram);
+    QCOMPARE(dram->reads(), 64ull);
+    QCOMPARE(dram->rowHits(), stride == 4 ? 63ull : 0ull);
+    QCOMPARE(dram->rowConflicts(), stride == 4 ? 0ull : 63ull);
+    amat[stride != 4] = caches.amat(caches.l1d());
+  }
+  QVERIFY(amat[0] < amat[1]);
+}
+
+void tst_cachehierarchy::tst_victimCache() {
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_SS);
+
+  // Direct-mapped L1 caches of 4 lines of 1 word, and a 4-way L2 cache of
+  // blocks of 1 word.
+  const CachePreset l1{"l1",
+                       0,
+                       2,
+                       0,
+                       WritePolicy::WriteBack,
+                       WriteAllocPolicy::WriteAllocate,
+                       ReplPolicy::LRU};
+  const CachePreset l2{"l2",
+                       0,
+                       2,
+                       2,
+                       WritePolicy::WriteBack,
+                       WriteAllocPolicy::WriteAllocate,
+                       ReplPolicy::LRU};
+  CacheHierarchyConfig config;
+  config.l1i = l1;
+  config.l1d = l1;
+  config.l2 = l2;
+  // Reads alternating between two addresses conflicting in set 0 of the L1
+  // data cache.
+  const auto conflictingReads = [](CacheHierarchy &caches) {
+    for (unsigned i = 0; i < 64; ++i)
+      caches.access(MemoryAccess(), {MemoryAccess::Read,
+                                     0x1000 + (i % 2) * 0x10, 4, 0x100});
+  };
+
+  // Every read misses in the L1 cache. Without a victim cache, every miss
+  // reaches the L2 cache, whereas the victim cache swaps the two blocks with
+  // the L1 cache after the first two misses.
+  double amat[2];
+  for (const unsigned entries : {0u, 2u}) {
+    config.l1dVictim = entries;
+    CacheHierarchy caches(config);
+    conflictingReads(caches);
+    QCOMPARE(caches.l1d().getMisses(), 64u);
+    QCOMPARE(caches.l1d().getEvictions(), 63u);
+    QCOMPARE(caches.l1d().getOccupancy(), 1u);
+    const VictimCache *victim = caches.victimCache(caches.l1d());
+    QCOMPARE(victim != nullptr, entries != 0);
+    const unsigned l2Accesses =
+        caches.l2()->getHits() + caches.l2()->getMisses();
+    QCOMPARE(l2Accesses, entries == 0 ? 64u : 2u);
+    if (victim) {
+      QCOMPARE(victim->hits(), 62u);
+      QCOMPARE(victim->misses(), 2u);
+      QCOMPARE(victim->insertions(), 63u);
+      QCOMPARE(victim->evictions(), 0u);
+      QCOMPARE(victim->occupancy(), 1u);
+      const auto report = caches.report()["L1D victim"].toMap();
+      QCOMPARE(report["hits"].toUInt(), 62u);
+    }
+    amat[entries != 0] = caches.amat(caches.l1d());
+  }
+  QVERIFY(amat[1] < amat[0]);
+  config.l1dVictim = 0;
+
+  // A single set of 2 ways in the L2 cache. Reading three blocks of distinct
+  // L1 sets evicts the first block from the L2 cache, which an inclusive L2
+  // cache invalidates in the L1 cache.
+  config.l2 = CachePreset{"l2",
+                          0,
+                          0,
+                          1,
+                          WritePolicy::WriteBack,
+                          WriteAllocPolicy::WriteAllocate,
+                          ReplPolicy::LRU};
+  for (const auto policy :
+       {InclusionPolicy::NonInclusive, InclusionPolicy::Inclusive}) {
+    config.l2Inclusion = policy;
+    CacheHierarchy caches(config);
+    const bool inclusive = policy == InclusionPolicy::Inclusive;
+    for (const AInt address : {0x1000, 0x1004, 0x1008, 0x1000})
+      caches.access(MemoryAccess(), {MemoryAccess::Read, address, 4, 0x100});
+    QCOMPARE(caches.backInvalidations(), inclusive ? 2u : 0u);
+    QCOMPARE(caches.l1d().getHits(), inclusive ? 0u : 1u);
+    QCOMPARE(caches.l1d().getOccupancy(), inclusive ? 2u : 3u);
+    QCOMPARE(caches.l2()->getEvictions(), inclusive ? 2u : 1u);
+    QCOMPARE(caches.l2()->getOccupancy(), 2u);
+  }
+
+  // An exclusive L2 cache only holds the blocks evicted from the L1 cache,
+  // such that the conflicting blocks swap between the levels, and either
+  // level holds one of them.
+  config.l2 = l2;
+  config.l2Inclusion = InclusionPolicy::Exclusive;
+  CacheHierarchy caches(config);
+  conflictingReads(caches);
+  QCOMPARE(caches.l2()->getHits(), 62u);
+  QCOMPARE(caches.l2()->getMisses(), 2u);
+  QCOMPARE(caches.l2()->getVictimFills(), 63u);
+  QCOMPARE(caches.l2()->getOccupancy(), 1u);
+  QCOMPARE(caches.l1d().getOccupancy(), 1u);
+  const auto l2Report = caches.report()["L2"].toMap();
+  QCOMPARE(l2Report["inclusion"].toString(), QString("exclusive"));
+  QCOMPARE(l2Report["victim fills"].toUInt(), 63u);
+}
+
+QTEST_MAIN(tst_cachehierarchy)
+#include "tst_cachehierarchy.moc"
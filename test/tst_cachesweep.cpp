@@ -0,0 +1,106 @@
+#include <QtTest/QTest>
+
+#include <algorithm>
+#include <list>
+#include <map>
+#include <random>
+
+#include "cachesim/cachesweep.h"
+#include "cachesim/reuseanalysis.h"
+
+using namespace Ripes;
+
+// This test verifies the single-pass stack distance analysis of CacheSweep
+// against a direct LRU simulation of each configuration of the sweep, and the
+// hit rates predicted by the reuse distances of ReuseAnalysis against the
+// fully associative configurations of a sweep.
+
+class tst_cachesweep : public QObject {
+  Q_OBJECT
+
+private slots:
+  void tst_lru();
+  void tst_reuse();
+};
+
+// Returns the number of hits of an LRU, write-allocate cache on @p trace.
+static long long lruHits(const std::vector<AInt> &trace, unsigned byteOffset,
+                         const CacheSweep::Result &config) {
+  std::map<AInt, std::list<AInt>> lines;
+  long long hits = 0;
+  for (const AInt address : trace) {
+    const AInt block = address >> (byteOffset + config.blocks);
+    auto &ways = lines[block & ((1u << config.lines) - 1)];
+    auto it = std::find(ways.begin(), ways.end(), block);
+    if (it != ways.end()) {
+      hits++;
+      ways.erase(it);
+    }
+    ways.push_front(block);
+    if (ways.size() > (1u << config.ways))
+      ways.pop_back();
+  }
+  return hits;
+}
+
+void tst_cachesweep::tst_lru() {
+  // A mix of random accesses and a sequential sweep, to exercise both
+  // conflict and capacity misses.
+  std::vector<AInt> trace;
+  std::mt19937 rng(42);
+  for (int i = 0; i < 10000; ++i)
+    trace.push_back((rng() % 2048) * 4);
+  for (int i = 0; i < 4096; ++i)
+    trace.push_back(i * 4);
+
+  const unsigned byteOffset = 2;
+  CacheSweep sweep(byteOffset, {0, 3}, {0, 6}, {0, 3});
+  for (const AInt address : trace)
+    sweep.access(address);
+
+  const auto results = sweep.results();
+  QCOMPARE(results.size(), static_cast<size_t>(4 * 7 * 4));
+  for (const auto &result : results) {
+    QCOMPARE(result.hits + result.misses,
+             static_cast<long long>(trace.size()));
+    QCOMPARE(result.hits, lruHits(trace, byteOffset, result));
+  }
+}
+
+void tst_cachesweep::tst_reuse() {
+  // More distinct blocks than the initial capacity of the reuse analysis, such
+  // that it compacts.
+  std::vector<AInt> trace;
+  std::mt19937 rng(42);
+  for (int i = 0; i < 10000; ++i)
+    trace.push_back((rng() % 4096) * 4);
+  for (int i = 0; i < 8192; ++i)
+    trace.push_back(i * 4);
+
+  const unsigned byteOffset = 2;
+  CacheSweep sweep(byteOffset, {1, 1}, {0, 0}, {0, 12});
+  ReuseAnalysis reuse(byteOffset, 1, 1000);
+  for (size_t i = 0; i < trace.size(); ++i) {
+    sweep.access(trace[i]);
+    reuse.access(trace[i], i);
+  }
+  QCOMPARE(reuse.accesses(), static_cast<long long>(trace.size()));
+  QCOMPARE(reuse.coldAccesses(), 4096LL);
+  for (const auto &result : sweep.results())
+    QCOMPARE(qRound64(reuse.hitRate(result.ways) * reuse.accesses()),
+             result.hits);
+
+  // Windows of 10 cycles, with no accesses in the third window.
+  ReuseAnalysis windows(byteOffset, 0, 10);
+  windows.access(0x0, 0);
+  windows.access(0x4, 1);
+  windows.access(0x0, 2);
+  windows.access(0x0, 12);
+  windows.access(0x8, 35);
+  QCOMPARE(windows.workingSets(), std::vector<unsigned>({2, 1, 0, 1}));
+  QCOMPARE(windows.coldAccesses(), 3LL);
+  QCOMPARE(windows.histogram(), std::vector<long long>({1, 1}));
+}
+
+QTEST_APPLESS_MAIN(tst_cachesweep)
+#include "tst_cachesweep.moc"
@@ -0,0 +1,132 @@
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QtTest/QTest>
+
+#include "commitlog.h"
+#include "processorhandler.h"
+#include "processorregistry.h"
+
+using namespace Ripes;
+
+// This test ensures that commit logs hold a record per retired instruction,
+// with the register writes and data accesses of each instruction, and that
+// pipelined processors log the same instructions as the ISS.
+
+class tst_commitlog : public QObject {
+  Q_OBJECT
+
+private slots:
+  void tst_spike();
+  void tst_binary();
+
+private:
+  QByteArray log(ProcessorID id, CommitLog::Format format);
+
+  QTemporaryDir m_dir;
+  AInt m_text = 0;
+  AInt m_data = 0;
+};
+
+QByteArray tst_commitlog::log(ProcessorID id, CommitLog::Format format) {
+  ProcessorHandler::selectProcessor(id, {"M"});
+  // The instruction following the jump is fetched by pipelines, but never
+  // retires.
+  auto res = ProcessorHandler::getAssembler()->assembleRaw(
+      QStringList{".data", "buf: .zero 8", ".text", "la t0 buf", "li t1 5",
+                  "sw t1 4(t0)", "j skip", "li t1 7", "skip:", "lw t2 4(t0)",
+                  "li a7 10", "ecall"}
+          .join("\n"));
+  if (!res.errors.empty())
+    qFatal("Failed to assemble the program");
+  auto program = std::make_shared<Program>(res.program);
+  ProcessorHandler::loadProgram(program);
+  m_text = program->getSection(TEXT_SECTION_NAME)->address;
+  m_data = program->getSection(".data")->address;
+
+  const QString path = m_dir.filePath("commits");
+  QString error;
+  std::shared_ptr<CommitLog> commitLog = CommitLog::open(
+      path, format, *ProcessorHandler::currentISA(), error);
+  if (!commitLog)
+    qFatal("%s", qPrintable(error));
+  ProcessorHandler::setCommitLog(commitLog);
+  QSignalSpy finished(ProcessorHandler::get(), &ProcessorHandler::runFinished);
+  ProcessorHandler::run();
+  if (!finished.wait(10000))
+    qFatal("The run did not finish");
+  ProcessorHandler::stopRun();
+  ProcessorHandler::setCommitLog(nullptr);
+  if (const QString err = commitLog->close(); !err.isEmpty())
+    qFatal("%s", qPrintable(err));
+  if (commitLog->commits() != 8)
+    qFatal("Logged %lld instructions", commitLog->commits());
+
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly))
+    qFatal("Failed to read %s", qPrintable(path));
+  return file.readAll();
+}
+
+void tst_commitlog::tst_spike() {
+  const QByteArray iss = log(ProcessorID::RV32_ISS, CommitLog::Format::Spike);
+  const auto hex = [](AInt value) {
+    return QByteArray::number(static_cast<qulonglong>(value), 16)
+        .rightJustified(8, '0');
+  };
+  const QList<QByteArray> lines = iss.split('\n');
+  QCOMPARE(lines.size(), 9);
+  const auto line = [&](AInt pc, const QByteArray &rest) {
+    return QByteArray("core   0: 3 0x") + hex(pc) + " " + rest;
+  };
+  QVERIFY(lines.at(0).startsWith(line(m_text, "(")));
+  QVERIFY(lines.at(1).endsWith(" x5  0x" + hex(m_data)));
+  QCOMPARE(lines.at(2), line(m_text + 8, "(0x00500313) x6  0x00000005"));
+  QCOMPARE(lines.at(3), line(m_text + 12, "(0x0062a223) mem 0x" +
+                                              hex(m_data + 4) + " 0x00000005"));
+  // The jump writes x0, which is not logged.
+  QCOMPARE(lines.at(4), line(m_text + 16, "(0x0080006f)"));
+  QCOMPARE(lines.at(5), line(m_text + 24, "(0x0042a383) x7  0x00000005 mem 0x" +
+                                              hex(m_data + 4)));
+  QVERIFY(lines.at(6).endsWith(" x17 0x0000000a"));
+  QVERIFY(lines.at(8).isEmpty());
+
+  QCOMPARE(log(ProcessorID::RV32_5S, CommitLog::Format::Spike), iss);
+}
+
+void tst_commitlog::tst_binary() {
+  const QByteArray bin = log(ProcessorID::RV32_5S, CommitLog::Format::Binary);
+  QVERIFY(bin.startsWith(QByteArray("RPCL\x01\x04\x04", 7)));
+  const auto le = [&](int offset, int bytes) {
+    AInt value = 0;
+    for (int i = bytes - 1; i >= 0; i--)
+      value = (value << 8) | static_cast<uchar>(bin.at(offset + i));
+    return value;
+  };
+
+  // Walks the records, checking the store.
+  int offset = 7;
+  int records = 0;
+  while (offset < bin.size()) {
+    const uint8_t flags = bin.at(offset);
+    const AInt pc = le(offset + 1, 4);
+    offset += 5 + ((flags & CommitLog::Compressed) ? 2 : 4);
+    if (flags & CommitLog::RegisterWrite)
+      offset += 5;
+    if (pc == m_text + 12) {
+      QCOMPARE(flags, uint8_t(CommitLog::MemoryWrite));
+      QCOMPARE(le(offset, 4), m_data + 4);
+      QCOMPARE(le(offset + 4, 1), AInt(4));
+      QCOMPARE(le(offset + 5, 4), AInt(5));
+    }
+    if (flags & (CommitLog::MemoryRead | CommitLog::MemoryWrite))
+      offset += 5;
+    if (flags & CommitLog::MemoryWrite)
+      offset += static_cast<int>(le(offset - 1, 1));
+    records++;
+  }
+  QCOMPARE(offset, bin.size());
+  QCOMPARE(records, 8);
+}
+
+QTEST_MAIN(tst_commitlog)
+#include "tst_commitlog.moc"
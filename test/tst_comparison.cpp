@@ -0,0 +1,115 @@
+#include <QtTest/QTest>
+
+#include "cli/comparison.h"
+#include "processorregistry.h"
+
+using namespace Ripes;
+
+// This test ensures that a comparison runs both variants to completion, and
+// attributes their differences to counters, symbols and caches.
+
+class tst_comparison : public QObject {
+  Q_OBJECT
+
+private slots:
+  void tst_identical();
+  void tst_symbols();
+  void tst_caches();
+
+private:
+  static std::shared_ptr<const Program> assemble(ProcessorID id,
+                                                 const QStringList &program);
+  static Comparison::Row find(const std::vector<Comparison::Row> &rows,
+                              const QString &name);
+};
+
+// Loads 16 words, @p stride bytes apart, within a loop. If @p extra is set, a
+// function is called once the loop is done.
+static QStringList program(int stride, bool extra) {
+  QStringList lines = {".data",      "a: .zero 1024", ".text",
+                       "la a0 a",    "li a1 16",      "loop:",
+                       "lw t0 0(a0)", "addi a0 a0 " + QString::number(stride),
+                       "addi a1 a1 -1", "bnez a1 loop", "done:"};
+  if (extra)
+    lines << "jal extra";
+  lines << "li a7 10"
+        << "ecall";
+  if (extra)
+    lines << "extra:"
+          << "addi t1 t1 1"
+          << "addi t1 t1 1"
+          << "ret";
+  return lines;
+}
+
+std::shared_ptr<const Program>
+tst_comparison::assemble(ProcessorID id, const QStringList &program) {
+  QStringList errors;
+  auto assembled = Comparison::assemble(id, {"M"}, program.join("\n"), errors);
+  if (!errors.isEmpty())
+    qWarning() << errors;
+  return assembled;
+}
+
+Comparison::Row tst_comparison::find(const std::vector<Comparison::Row> &rows,
+                                     const QString &name) {
+  for (const auto &row : rows)
+    if (row.name == name)
+      return row;
+  return Comparison::Row{"missing", -1, -1};
+}
+
+void tst_comparison::tst_identical() {
+  // Identical variants differ in nothing.
+  const auto p = assemble(ProcessorID::RV32_5S, program(4, false));
+  QVERIFY(p);
+  Comparison comparison({"a", ProcessorID::RV32_5S, {"M"}, p},
+                        {"b", ProcessorID::RV32_5S, {"M"}, p});
+  comparison.run();
+  QCOMPARE(comparison.status(false), QString("ok"));
+  QCOMPARE(comparison.status(true), QString("ok"));
+  for (const auto &rows :
+       {comparison.counters(), comparison.symbols(), comparison.caches()}) {
+    QVERIFY(!rows.empty());
+    for (const auto &row : rows)
+      QCOMPARE(row.delta(), 0.0);
+  }
+  QVERIFY(find(comparison.counters(), "cycles").a > 0);
+}
+
+void tst_comparison::tst_symbols() {
+  // The cycles of the loop are unchanged, and the cycles of B beyond those of
+  // A are spent within the added function.
+  const auto a = assemble(ProcessorID::RV32_ISS, program(4, false));
+  const auto b = assemble(ProcessorID::RV32_ISS, program(4, true));
+  QVERIFY(a && b);
+  Comparison comparison({"a", ProcessorID::RV32_ISS, {"M"}, a},
+                        {"b", ProcessorID::RV32_ISS, {"M"}, b});
+  comparison.run();
+  QCOMPARE(find(comparison.symbols(), "loop").delta(), 0.0);
+  const auto extra = find(comparison.symbols(), "extra");
+  QCOMPARE(extra.a, 0.0);
+  QVERIFY(extra.b > 0);
+  QVERIFY(find(comparison.counters(), "instructions").delta() > 0);
+  // The added function has the largest difference.
+  QCOMPARE(comparison.symbols().front().name, QString("extra"));
+}
+
+void tst_comparison::tst_caches() {
+  // Loading a word per block of the default L1 data cache misses on every
+  // load, whereas consecutive words share their blocks.
+  const auto a = assemble(ProcessorID::RV32_ISS, program(4, false));
+  const auto b = assemble(ProcessorID::RV32_ISS, program(64, false));
+  QVERIFY(a && b);
+  Comparison comparison({"a", ProcessorID::RV32_ISS, {"M"}, a},
+                        {"b", ProcessorID::RV32_ISS, {"M"}, b});
+  comparison.run();
+  const auto misses = find(comparison.caches(), "l1d misses");
+  QCOMPARE(misses.a, 4.0);
+  QCOMPARE(misses.b, 16.0);
+  QCOMPARE(find(comparison.caches(), "l1d accesses").delta(), 0.0);
+  QVERIFY(comparison.report().value("output equal").toBool());
+}
+
+QTEST_MAIN(tst_comparison)
+#include "tst_comparison.moc"
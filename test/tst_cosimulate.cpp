@@ -6,13 +6,14 @@
 
 #include <optional>
 
+#include "assembler/parallelfor.h"
 #include "processorhandler.h"
 #include "processorregistry.h"
 
 #include "edittab.h"
 #include "isa/rvisainfo_common.h"
 #include "programloader.h"
-#include "ripessettings.h"
+#include "simulationcontext.h"
 
 /**
  * Ripes co-simulation
@@ -21,6 +22,10 @@
  * its register trace is compared to the reference trace. From this, we can
  * detect whether (and where) register state divergence occurs, which indicates
  * an error in a processor implementation
+ *
+ * Each test program is loaded once, and is shared by the simulation contexts
+ * of all processor models. The tests of a processor model are co-simulated
+ * concurrently.
  */
 
 using namespace Ripes;
@@ -70,20 +75,21 @@ public:
 
 private:
   void cosimulate(const ProcessorID &id, const QStringList &extensions);
-  const Trace &generateReferenceTrace(const QStringList &extensions);
-  void trapHandler();
-  void executeSimulator(Trace &outTrace, const Trace *refTrace = nullptr);
-  Registers dumpRegs();
-  QString generateErrorReport(const RegisterChange &change,
-                              const TraceEntry &lhs,
-                              const TraceEntry &rhs) const;
-  void loadCurrentTest();
-
-  bool m_stop = false;
-  QString m_err;
-  LoadFileParams m_currentTest;
-  ProgramLoader *m_loader;
-
+  void generateReferenceTraces(const QStringList &extensions);
+  static QString executeSimulator(SimulationContext &context,
+                                  const QString &test, Trace &outTrace,
+                                  const Trace *refTrace = nullptr);
+  static Registers dumpRegs(const RipesProcessor *proc);
+  static QString generateErrorReport(const RipesProcessor *proc,
+                                     const QString &test,
+                                     const RegisterChange &change,
+                                     const TraceEntry &lhs,
+                                     const TraceEntry &rhs);
+
+  ProgramLoader *m_loader = nullptr;
+
+  // Test programs and reference traces, by the path of the test.
+  std::map<QString, std::shared_ptr<Program>> m_programs;
   std::map<QString, Trace> m_referenceTraces;
 
 private slots:
@@ -95,29 +101,15 @@ private slots:
   void testRV6SDual() { cosimulate(ProcessorID::RV32_6S_DUAL, {"M"}); }
   void testRV5S() { cosimulate(ProcessorID::RV32_5S, {"M"}); }
   void testRV5SNoFW() { cosimulate(ProcessorID::RV32_5S_NO_FW, {"M"}); }
+  void testRV5SBP() { cosimulate(ProcessorID::RV32_5S_BP_GSHARE, {"M"}); }
+  void testRVOOO() { cosimulate(ProcessorID::RV32_OOO_4W, {"M"}); }
 };
 
-void tst_Cosimulate::trapHandler() {
-  auto reg =
-      ProcessorHandler::get()->getProcessor()->implementsISA()->syscallReg();
-  assert(reg.has_value());
-
-  unsigned status = ProcessorHandler::get()->getProcessor()->getRegister(
-      reg->file->regFileName(), reg->index);
-
-  /// @todo: Generalize this by having ISA report exit syscall codes
-  if (status == RVABI::SysCall::Exit || status == RVABI::SysCall::Exit2) {
-    m_stop = true;
-  }
-}
-
-Registers tst_Cosimulate::dumpRegs() {
+Registers tst_Cosimulate::dumpRegs(const RipesProcessor *proc) {
   Registers regs;
-  for (const auto &regFile :
-       ProcessorHandler::get()->currentISA()->regInfos()) {
+  for (const auto &regFile : proc->implementsISA()->regInfos()) {
     for (unsigned i = 0; i < regFile->regCnt(); i++) {
-      regs[i] = ProcessorHandler::get()->getProcessor()->getRegister(
-          regFile->regFileName(), i);
+      regs[i] = proc->getRegister(regFile->regFileName(), i);
     }
   }
   return regs;
@@ -139,11 +131,11 @@ std::optional<std::vector<int>> regNeq(const Registers &lhs,
   }
 }
 
-std::vector<RegisterChange> registerChange(const Registers &before,
+std::vector<RegisterChange> registerChange(const RipesProcessor *proc,
+                                           const Registers &before,
                                            const Registers &after) {
   std::vector<RegisterChange> change;
-  for (const auto &regFile :
-       ProcessorHandler::get()->currentISA()->regInfos()) {
+  for (const auto &regFile : proc->implementsISA()->regInfos()) {
     for (unsigned i = 0; i < regFile->regCnt(); i++) {
       if (before.at(i) != after.at(i)) {
         change.push_back({regFile->regFileName(), i, after.at(i)});
@@ -153,15 +145,16 @@ std::vector<RegisterChange> registerChange(const Registers &before,
   return change;
 }
 
-QString tst_Cosimulate::generateErrorReport(const RegisterChange &change,
+QString tst_Cosimulate::generateErrorReport(const RipesProcessor *proc,
+                                            const QString &test,
+                                            const RegisterChange &change,
                                             const TraceEntry &lhs,
-                                            const TraceEntry &rhs) const {
+                                            const TraceEntry &rhs) {
   QString err;
   err += "\nRegister change discrepancy detected while executing test: " +
-         m_currentTest.filepath;
+         test;
   err += "\nUnexpected change was: ";
-  if (auto regInfo =
-          ProcessorHandler::get()->currentISA()->regInfo(change.fileName);
+  if (auto regInfo = proc->implementsISA()->regInfo(change.fileName);
       regInfo.has_value()) {
     err += (*regInfo)->regName(change.index);
   } else {
@@ -186,28 +179,21 @@ QString tst_Cosimulate::generateErrorReport(const RegisterChange &change,
 
 /**
  * @brief tst_Cosimulate::executeSimulator
- * Runs the currently loaded simulator on the currently loaded program,
- * generating a register trace while doing so. If @p refTrace is provided, the
- * generated trace is compared to the reference trace and the test fails if a
- * discrepancy is detected.
+ * Runs the processor of @p context on its loaded program, generating a
+ * register trace while doing so. If @p refTrace is provided, the generated
+ * trace is compared to the reference trace, and a description of the first
+ * discrepancy is returned.
  */
-void tst_Cosimulate::executeSimulator(Trace &trace, const Trace *refTrace) {
-  m_loader->loadTest(m_currentTest);
-
-  // Override the ProcessorHandler's ECALL handling. In doing so, we can hook
-  // into when the EXIT syscall was executed, to verify whether the correct test
-  // value was reached.
-  ProcessorHandler::get()->getProcessorNonConst()->trapHandler = [=] {
-    trapHandler();
-  };
-
-  m_stop = false;
-  m_err = QString();
+QString tst_Cosimulate::executeSimulator(SimulationContext &context,
+                                         const QString &test, Trace &trace,
+                                         const Trace *refTrace) {
+  // System calls are executed by the context, such that the EXIT syscall
+  // finishes the processor.
+  const auto *proc = context.processor();
   bool maxCyclesReached = false;
   unsigned cycles = 0;
-  trace.push_back(TraceEntry{
-      dumpRegs(), cycles,
-      ProcessorHandler::get()->getProcessor()->getPcForStage({0, 0})});
+  trace.push_back(
+      TraceEntry{dumpRegs(proc), cycles, proc->getPcForStage({0, 0})});
 
   decltype(refTrace->begin()) cmpRegState;
   if (refTrace) {
@@ -215,19 +201,19 @@ void tst_Cosimulate::executeSimulator(Trace &trace, const Trace *refTrace) {
     cmpRegState++; // skip initial state
   }
 
-  Registers preRegs = dumpRegs();
+  Registers preRegs = dumpRegs(proc);
 
+  bool stop = false;
   do {
-    ProcessorHandler::get()->getProcessorNonConst()->clock();
+    context.clock();
     cycles++;
 
-    Registers regs = dumpRegs();
-    auto regChange = registerChange(preRegs, regs);
+    Registers regs = dumpRegs(proc);
+    auto regChange = registerChange(proc, preRegs, regs);
     // Detect change in current register state
     if (regNeq(regs, trace.rbegin()->regs)) {
-      trace.push_back(TraceEntry{
-          dumpRegs(), cycles,
-          ProcessorHandler::get()->getProcessor()->getPcForStage({0, 0})});
+      trace.push_back(
+          TraceEntry{dumpRegs(proc), cycles, proc->getPcForStage({0, 0})});
 
       // Check whether change corresponds to expected change in comparison
       // trace. regChange might contain multiple register changes (for
@@ -249,9 +235,8 @@ void tst_Cosimulate::executeSimulator(Trace &trace, const Trace *refTrace) {
             }
           }
           if (!foundChange) {
-            const QString err = generateErrorReport(
-                *regChange.begin(), *trace.rbegin(), *cmpRegState);
-            QFAIL(err.toStdString().c_str());
+            return generateErrorReport(proc, test, *regChange.begin(),
+                                       *trace.rbegin(), *cmpRegState);
           }
         }
       }
@@ -259,58 +244,74 @@ void tst_Cosimulate::executeSimulator(Trace &trace, const Trace *refTrace) {
     preRegs = regs;
 
     maxCyclesReached = cycles >= s_maxCycles;
-    m_stop |=
-        maxCyclesReached || ProcessorHandler::get()->getProcessor()->finished();
-  } while (!m_stop);
+    stop = maxCyclesReached || proc->finished();
+  } while (!stop);
 
-  if (maxCyclesReached) {
-    QFAIL("Maximum cycles reached");
-  }
+  if (maxCyclesReached)
+    return "Maximum cycles reached while executing test: " + test;
+  return QString();
 }
 
 /**
- * @brief tst_Cosimulate::generateTrace
- * Executes program @p spProgram on the single-cycle processor model, to
- * generate a reference trace.
+ * @brief tst_Cosimulate::generateReferenceTraces
+ * Loads the test programs, and executes them on the single-cycle processor
+ * model to generate reference traces, unless already done.
  */
-const Trace &
-tst_Cosimulate::generateReferenceTrace(const QStringList &extensions) {
-  auto refTrace = m_referenceTraces.find(m_currentTest.filepath);
-  if (refTrace == m_referenceTraces.end()) {
-    std::cout << "First time running test; generating reference trace..."
-              << std::endl;
+void tst_Cosimulate::generateReferenceTraces(const QStringList &extensions) {
+  if (!m_loader)
+    m_loader = new ProgramLoader();
+  std::vector<QString> tests;
+  for (const auto &test : s_testFiles) {
+    if (m_programs.count(test.filepath))
+      continue;
     ProcessorHandler::get()->selectProcessor(s_referenceModel, extensions);
-    Trace trace;
-    executeSimulator(trace);
-    m_referenceTraces[m_currentTest.filepath] = trace;
-    refTrace = m_referenceTraces.find(m_currentTest.filepath);
+    m_loader->loadTest(test);
+    m_programs[test.filepath] =
+        std::make_shared<Program>(*ProcessorHandler::getProgram());
+    tests.push_back(test.filepath);
+  }
+  if (tests.empty())
+    return;
+
+  std::cout << "Generating reference traces..." << std::endl;
+  std::vector<Trace> traces(tests.size());
+  std::vector<QString> errors(tests.size());
+  parallelFor(tests.size(), [&](size_t i) {
+    SimulationContext context(s_referenceModel, extensions);
+    context.loadProgram(m_programs.at(tests[i]));
+    errors[i] = executeSimulator(context, tests[i], traces[i]);
+  });
+  for (size_t i = 0; i < tests.size(); ++i) {
+    if (!errors[i].isNull())
+      QFAIL(errors[i].toStdString().c_str());
+    m_referenceTraces[tests[i]] = std::move(traces[i]);
   }
-  return refTrace->second;
 }
 
 /**
  * @brief tst_Cosimulate::cosimulate
  * Cosimulate a given processor with a reference model.
- * The cosimulation is quite inefficient, since we don't concurrently execute
- * two processors but rather generate a reference trace from a reference model,
- * and then execute a test model, generate a trace for this, and comprare this
- * trace with the reference trace. The reason for this is, that only a single
- * processor model can be instantiated at once in Ripes, due to the static
- * nature of the ProcessorHandler.
+ * Rather than concurrently executing the two processors, a reference trace is
+ * generated once per test from the reference model, and is compared to the
+ * trace of the processor under test.
  */
 void tst_Cosimulate::cosimulate(const ProcessorID &id,
                                 const QStringList &extensions) {
-  m_loader = new ProgramLoader();
-  for (const auto &test : s_testFiles) {
-    m_currentTest = test;
-    std::cout << test.filepath.toStdString() << std::endl;
-    auto referenceTrace = generateReferenceTrace(extensions);
-    ProcessorHandler::get()->selectProcessor(id, extensions);
-    RipesSettings::getObserver(RIPES_GLOBALSIGNAL_REQRESET)->trigger();
+  generateReferenceTraces(extensions);
 
+  std::vector<QString> errors(s_testFiles.size());
+  parallelFor(s_testFiles.size(), [&](size_t i) {
+    const QString &test = s_testFiles.at(i).filepath;
+    SimulationContext context(id, extensions);
+    context.loadProgram(m_programs.at(test));
     Trace trace;
-    std::cout << "Cosimulating... " << std::flush;
-    executeSimulator(trace, &referenceTrace);
+    errors[i] =
+        executeSimulator(context, test, trace, &m_referenceTraces.at(test));
+  });
+  for (size_t i = 0; i < s_testFiles.size(); ++i) {
+    std::cout << s_testFiles.at(i).filepath.toStdString() << std::endl;
+    if (!errors[i].isNull())
+      QFAIL(errors[i].toStdString().c_str());
     std::cout << "PASS!\n" << std::endl;
   }
 }
@@ -0,0 +1,108 @@
+#include <QRegularExpression>
+#include <QTemporaryDir>
+#include <QtTest/QTest>
+
+#include "cli/cosimulator.h"
+#include "processorhandler.h"
+#include "processorregistry.h"
+
+using namespace Ripes;
+
+// This test ensures that co-simulation matches the register writes of a
+// processor model against the reference model, and that it reports the first
+// diverging write. Divergences are provoked by the 5-stage processor without
+// forwarding and hazard detection, which reads stale registers on data
+// hazards.
+
+class tst_cosimulator : public QObject {
+  Q_OBJECT
+
+private slots:
+  void tst_match();
+  void tst_valueMismatch();
+  void tst_referenceLeftOver();
+  void tst_openFile();
+
+private:
+  bool cosimulate(ProcessorID id, const QStringList &program,
+                  QString &errorMessage, long long *comparedWrites = nullptr);
+};
+
+bool tst_cosimulator::cosimulate(ProcessorID id, const QStringList &program,
+                                 QString &errorMessage,
+                                 long long *comparedWrites) {
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_SS, {"M"});
+  auto res = ProcessorHandler::getAssembler()->assembleRaw(program.join("\n"));
+  if (!res.errors.empty()) {
+    errorMessage = "Errors during assembly";
+    return false;
+  }
+
+  CLIModeOptions options;
+  options.proc = id;
+  options.isaExtensions = {"M"};
+  Cosimulator cosimulator(options, std::make_shared<Program>(res.program));
+  const bool matched = cosimulator.run(errorMessage);
+  if (comparedWrites)
+    *comparedWrites = cosimulator.comparedWrites();
+  return matched;
+}
+
+// a1 is written from a0 by the instruction following the write of a0.
+static const QStringList s_hazard = {".text", "li a0 1", "addi a1 a0 5"};
+
+void tst_cosimulator::tst_match() {
+  QString errorMessage;
+  long long comparedWrites = 0;
+  QVERIFY2(cosimulate(ProcessorID::RV32_5S, s_hazard, errorMessage,
+                      &comparedWrites),
+           errorMessage.toStdString().c_str());
+  QCOMPARE(comparedWrites, 2LL);
+}
+
+void tst_cosimulator::tst_valueMismatch() {
+  // The processor model writes a1 = 5 from a stale a0, against a1 = 6 of the
+  // reference, which is reported as is rather than after further writes.
+  QString errorMessage;
+  QVERIFY(!cosimulate(ProcessorID::RV32_5S_NO_FW_HZ, s_hazard, errorMessage));
+  QVERIFY2(errorMessage.contains("after 1 matching register writes"),
+           errorMessage.toStdString().c_str());
+  QVERIFY2(errorMessage.contains(QRegularExpression(
+               "Processor model wrote:\n *x11 \\(a1\\) = 0x5 ")),
+           errorMessage.toStdString().c_str());
+  QVERIFY2(errorMessage.contains(QRegularExpression(
+               "Reference model wrote:\n *x11 \\(a1\\) = 0x6 ")),
+           errorMessage.toStdString().c_str());
+}
+
+void tst_cosimulator::tst_referenceLeftOver() {
+  // The processor model copies the stale a0 = 0 to a1, which is not an
+  // observable write. The write of a1 = 1 by the reference is thus left once
+  // the processor model finishes.
+  QString errorMessage;
+  QVERIFY(!cosimulate(ProcessorID::RV32_5S_NO_FW_HZ,
+                      {".text", "li a0 1", "add a1 a0 zero"}, errorMessage));
+  QVERIFY2(errorMessage.contains("nothing (processor model finished)"),
+           errorMessage.toStdString().c_str());
+  QVERIFY2(errorMessage.contains(QRegularExpression(
+               "Reference model wrote:\n *x11 \\(a1\\) = 0x1 ")),
+           errorMessage.toStdString().c_str());
+}
+
+void tst_cosimulator::tst_openFile() {
+  // The file would be created by both models, and is rejected before the
+  // reference opens it.
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  const QString path = dir.filePath("out.txt");
+  QString errorMessage;
+  QVERIFY(!cosimulate(ProcessorID::RV32_5S,
+                      {".data", "name: .string \"" + path + "\"", ".text",
+                       "la a0 name", "li a1 0x1101", "li a7 1024", "ecall"},
+                      errorMessage));
+  QVERIFY2(errorMessage.contains("does not support programs which open files"),
+           errorMessage.toStdString().c_str());
+}
+
+QTEST_MAIN(tst_cosimulator)
+#include "tst_cosimulator.moc"
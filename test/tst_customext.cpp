@@ -0,0 +1,158 @@
+#include <QtTest/QTest>
+
+#include "isa/rv_custom_ext.h"
+#include "processorhandler.h"
+#include "processorregistry.h"
+#include "programloader.h"
+
+using namespace Ripes;
+using namespace RVISA;
+
+// This test ensures that custom instructions registered through
+// RVISA::ExtCustom are assembled, disassembled, executed by the functional and
+// timing processor models, timed in their functional unit and counted by the
+// performance counters.
+
+struct Mac : public ExtCustom::TypeR::Instr<Mac, OpcodeID::CUSTOM0, 0b000,
+                                            0b0000000> {
+  constexpr static std::string_view NAME = "cmac";
+};
+
+struct Scale : public ExtCustom::TypeI::Instr<Scale, OpcodeID::CUSTOM1, 0b001> {
+  constexpr static std::string_view NAME = "cscale";
+};
+
+class tst_customext : public ProcessorTest {
+  Q_OBJECT
+
+private slots:
+  void initTestCase();
+  void tst_assemble();
+  void tst_execute();
+  void tst_execute_data();
+  void tst_latency();
+  void tst_interval();
+
+private:
+  static RipesProcessor *load(ProcessorID id, const QStringList &program);
+  long long cycles(ProcessorID id, const QStringList &program);
+  static QStringList independent(const QString &op, const QString &src2,
+                                 int n);
+  static QStringList dependent(const QString &op, int n);
+
+  // Latency of both custom instructions; cmac is pipelined, whereas cscale is
+  // iterative. The default multiplier has the same latency.
+  static constexpr unsigned c_latency = 3;
+};
+
+RipesProcessor *tst_customext::load(ProcessorID id,
+                                    const QStringList &program) {
+  auto *proc = ProcessorTest::load(id, program);
+  if (proc)
+    proc->functionalUnitTiming = FunctionalUnitTiming();
+  return proc;
+}
+
+long long tst_customext::cycles(ProcessorID id, const QStringList &program) {
+  auto *proc = load(id, program);
+  if (!proc)
+    return -1;
+  runToFinish(proc);
+  return proc->finished() ? proc->getCycleCount() : -1;
+}
+
+QStringList tst_customext::independent(const QString &op, const QString &src2,
+                                       int n) {
+  QStringList program = {".text"};
+  for (int i = 0; i < n; ++i)
+    program << op + " x" + QString::number(5 + i % 2) + " x7 " + src2;
+  return program;
+}
+
+QStringList tst_customext::dependent(const QString &op, int n) {
+  QStringList program = {".text"};
+  for (int i = 0; i < n; ++i)
+    program << op + " x5 x5 x8";
+  return program;
+}
+
+void tst_customext::initTestCase() {
+  // Custom instructions are registered before the first ISA is constructed.
+  ExtCustom::registerInstruction<Mac>(
+      [](const ExtCustom::Operands &ops) { return ops.rs1 * ops.rs2 + 1; },
+      {c_latency, 1});
+  ExtCustom::registerInstruction<Scale>(
+      [](const ExtCustom::Operands &ops) { return ops.rs1 * ops.imm; },
+      {c_latency, c_latency});
+}
+
+void tst_customext::tst_assemble() {
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_ISS, {"M"});
+  const QStringList program = {".text", "cmac x5 x6 x7", "cscale x5 x6 -3"};
+  auto res = ProcessorHandler::getAssembler()->assembleRaw(program.join("\n"));
+  QVERIFY(res.errors.empty());
+  QCOMPARE(res.program.getSection(".text")->data.size(), 8);
+  ProcessorHandler::loadProgram(std::make_shared<Program>(res.program));
+  QVERIFY(ProcessorHandler::disassembleInstr(0).startsWith("cmac"));
+  QVERIFY(ProcessorHandler::disassembleInstr(4).startsWith("cscale"));
+  QCOMPARE(ExtCustom::find(0b0000000'00111'00110'000'00101'0001011), 0);
+  QCOMPARE(ExtCustom::find(0b0000000'00111'00110'001'00101'0001011), -1);
+}
+
+void tst_customext::tst_execute_data() {
+  QTest::addColumn<int>("id");
+  QTest::newRow("ISS") << int(ProcessorID::RV32_ISS);
+  QTest::newRow("ISS RV64") << int(ProcessorID::RV64_ISS);
+  QTest::newRow("5-stage") << int(ProcessorID::RV32_5S_GEN);
+  QTest::newRow("out-of-order") << int(ProcessorID::RV32_OOO_2W);
+}
+
+void tst_customext::tst_execute() {
+  QFETCH(int, id);
+  auto *proc = load(ProcessorID(id), {".text", "li x6 5", "li x7 7",
+                                      "cmac x5 x6 x7", "cscale x8 x5 -2"});
+  QVERIFY(proc);
+  ProcessorHandler::setPerformanceCounting(true);
+  runToFinish(proc);
+  QVERIFY(proc->finished());
+  QCOMPARE(proc->getRegister(RVISA::GPR, 5), VInt(36));
+  QCOMPARE(static_cast<int32_t>(proc->getRegister(RVISA::GPR, 8)), -72);
+  if (proc->features() & RipesProcessor::hasFunctionalUnitTiming) {
+    const auto &counters = proc->performanceCounters().customInstructions;
+    QCOMPARE(counters.at("cmac"), 1LL);
+    QCOMPARE(counters.at("cscale"), 1LL);
+  }
+}
+
+void tst_customext::tst_latency() {
+  // Like the operations of the M extension, independent custom instructions
+  // hide their latency in the stages following the EX stage, whereas a
+  // dependency chain exposes it...
+  constexpr long long n = 20;
+  QCOMPARE(cycles(ProcessorID::RV32_7S_GEN, independent("cmac", "x8", n)), n + 7);
+  QCOMPARE(cycles(ProcessorID::RV32_7S_GEN, dependent("cmac", n)),
+           n + 7 + (n - 1) * (c_latency - 1));
+
+  // ... and out of order, a chain of custom instructions executes like a
+  // chain of multiplications of the same latency.
+  QCOMPARE(cycles(ProcessorID::RV32_OOO_2W, dependent("cmac", n)),
+           cycles(ProcessorID::RV32_OOO_2W, dependent("mul", n)));
+}
+
+void tst_customext::tst_interval() {
+  // cscale occupies its unit for its full latency, stalling each following
+  // cscale in the ID stage.
+  constexpr long long n = 20;
+  auto *proc = load(ProcessorID::RV32_7S_GEN, independent("cscale", "8", n));
+  QVERIFY(proc);
+  ProcessorHandler::setPerformanceCounting(true);
+  runToFinish(proc);
+  QVERIFY(proc->finished());
+  QCOMPARE(proc->getCycleCount(), n + 7 + (n - 1) * (c_latency - 1));
+  const auto &counters = proc->performanceCounters();
+  QCOMPARE(counters.functionalUnitStalls, (n - 1) * (c_latency - 1));
+  QCOMPARE(counters.customInstructions.at("cscale"), n);
+}
+
+QTEST_MAIN(tst_customext)
+#include "tst_customext.moc"
@@ -0,0 +1,122 @@
+#include <QJsonArray>
+#include <QtTest/QTest>
+
+#include "io/ioconfig.h"
+#include "io/iomanager.h"
+#include "isa/rvisainfo_common.h"
+#include "processorhandler.h"
+#include "processorregistry.h"
+
+using namespace Ripes;
+
+// This test ensures that the DMA controller copies memory in the background of
+// the processor, at its bandwidth, and yields the memory port to the data
+// accesses of the processor with core priority.
+
+class tst_dma : public QObject {
+  Q_OBJECT
+
+private slots:
+  void initTestCase();
+  void tst_transfer();
+  void tst_transfer_data();
+
+private:
+  /// Runs the loaded program to completion.
+  void runProgram();
+};
+
+static constexpr unsigned c_words = 16;
+
+// Copies c_words words from src to dst, and polls STATUS until the transfer
+// has completed. The last copied word is loaded to a0, and CYCLES and YIELDED
+// to a1 and a2.
+static QString program() {
+  QStringList words, zeros;
+  for (unsigned i = 0; i < c_words; ++i) {
+    words << QString::number(i + 1);
+    zeros << "0";
+  }
+  return QStringList{".data",
+                     "src: .word " + words.join(", "),
+                     "dst: .word " + zeros.join(", "),
+                     ".text",
+                     "la t0 src",
+                     "li t1 DMA_0_SRC",
+                     "sw t0 0(t1)",
+                     "la t0 dst",
+                     "li t1 DMA_0_DST",
+                     "sw t0 0(t1)",
+                     "li t0 " + QString::number(c_words * 4),
+                     "li t1 DMA_0_LEN",
+                     "sw t0 0(t1)",
+                     "li t0 1",
+                     "li t1 DMA_0_CTRL",
+                     "sw t0 0(t1)",
+                     "li t1 DMA_0_STATUS",
+                     "wait:",
+                     "lw t0 0(t1)",
+                     "andi t0 t0 2",
+                     "beqz t0 wait",
+                     "la t2 dst",
+                     "lw a0 " + QString::number(c_words * 4 - 4) + "(t2)",
+                     "li t1 DMA_0_CYCLES",
+                     "lw a1 0(t1)",
+                     "li t1 DMA_0_YIELDED",
+                     "lw a2 0(t1)"}
+      .join("\n");
+}
+
+void tst_dma::initTestCase() {
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_ISS, {"M"});
+}
+
+void tst_dma::runProgram() {
+  auto *proc = ProcessorHandler::getProcessorNonConst();
+  while (!proc->finished() && proc->getCycleCount() < 10000)
+    proc->clockN(100);
+  QVERIFY(proc->finished());
+}
+
+void tst_dma::tst_transfer_data() {
+  QTest::addColumn<int>("bandwidth");
+  QTest::addColumn<int>("priority");
+  QTest::newRow("word per cycle") << 4 << 0;
+  QTest::newRow("byte per cycle") << 1 << 0;
+  QTest::newRow("core priority") << 4 << 1;
+}
+
+void tst_dma::tst_transfer() {
+  QFETCH(int, bandwidth);
+  QFETCH(int, priority);
+  IOConfig io;
+  const QString error = io.load(QJsonObject{
+      {"peripherals",
+       QJsonArray{QJsonObject{
+           {"type", "DMA"},
+           {"parameters",
+            QJsonObject{{"Bandwidth (bytes/cycle)", bandwidth},
+                        {"Core priority (0: off, 1: on)", priority}}}}}}});
+  QCOMPARE(error, QString());
+
+  auto res = ProcessorHandler::getAssembler()->assembleRaw(
+      program(), &IOManager::get().assemblerSymbols());
+  QVERIFY(res.errors.empty());
+  ProcessorHandler::loadProgram(std::make_shared<Program>(res.program));
+  runProgram();
+
+  const auto reg = [](unsigned i) {
+    return ProcessorHandler::getRegisterValue(RVISA::GPR, i);
+  };
+  QCOMPARE(reg(10), VInt(c_words));
+  const VInt transferCycles = c_words * 4 / bandwidth;
+  QCOMPARE(reg(11), transferCycles + reg(12));
+  // The polling loads of STATUS contend with the transfer.
+  if (priority)
+    QVERIFY(reg(12) > 0);
+  else
+    QCOMPARE(reg(12), VInt(0));
+}
+
+QTEST_MAIN(tst_dma)
+#include "tst_dma.moc"
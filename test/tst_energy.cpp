@@ -0,0 +1,143 @@
+#include <QtTest/QTest>
+
+#include "cachesim/cachehierarchy.h"
+#include "cli/energy.h"
+#include "processorhandler.h"
+#include "processorregistry.h"
+
+using namespace Ripes;
+
+// This test ensures that the energy estimate counts the instructions of each
+// class, the register file accesses and the memory accesses of a run.
+
+class tst_energy : public QObject {
+  Q_OBJECT
+
+private slots:
+  void tst_classify();
+  void tst_registerAccesses();
+  void tst_model();
+  void tst_estimate();
+
+private:
+  static long long events(const EnergyEstimate &estimate, const QString &name);
+};
+
+// Four iterations of a loop of a multiplication, an addition and a branch.
+static const QStringList s_program = {"li t0 4", "loop:", "mul t1 t0 t0",
+                                      "addi t0 t0 -1", "bnez t0 loop"};
+
+long long tst_energy::events(const EnergyEstimate &estimate,
+                             const QString &name) {
+  for (const auto &component : estimate.components())
+    if (component.name == name)
+      return component.events;
+  return -1;
+}
+
+void tst_energy::tst_classify() {
+  QCOMPARE(EnergyEstimate::classify("add a0 a1 a2"), EnergyEstimate::ALU);
+  QCOMPARE(EnergyEstimate::classify("mulh a0 a1 a2"), EnergyEstimate::MulDiv);
+  QCOMPARE(EnergyEstimate::classify("remu a0 a1 a2"), EnergyEstimate::MulDiv);
+  QCOMPARE(EnergyEstimate::classify("fmul.s ft0 ft1 ft2"), EnergyEstimate::FP);
+  QCOMPARE(EnergyEstimate::classify("vadd.vv v1 v2 v3"),
+           EnergyEstimate::Vector);
+  QCOMPARE(EnergyEstimate::classify("lw a0 0(sp)"), EnergyEstimate::Load);
+  QCOMPARE(EnergyEstimate::classify("flw ft0 0(sp)"), EnergyEstimate::Load);
+  QCOMPARE(EnergyEstimate::classify("sc.w a0 a1 (a2)"), EnergyEstimate::Load);
+  QCOMPARE(EnergyEstimate::classify("sw a0 0(sp)"), EnergyEstimate::Store);
+  QCOMPARE(EnergyEstimate::classify("c.fsdsp ft0 8(sp)"),
+           EnergyEstimate::Store);
+  QCOMPARE(EnergyEstimate::classify("vse32.v v1 (a0)"), EnergyEstimate::Store);
+  QCOMPARE(EnergyEstimate::classify("jalr ra 0(a0)"), EnergyEstimate::Control);
+  QCOMPARE(EnergyEstimate::classify("ecall"), EnergyEstimate::System);
+}
+
+void tst_energy::tst_registerAccesses() {
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_SS, {"M"});
+  const auto &isa = *ProcessorHandler::currentISA();
+  using Accesses = std::pair<unsigned, unsigned>;
+  QCOMPARE(EnergyEstimate::registerAccesses("add a0 a1 a2", isa),
+           Accesses(2, 1));
+  QCOMPARE(EnergyEstimate::registerAccesses("addi x5 x0 4", isa),
+           Accesses(1, 1));
+  // Writes to the zero register are discarded.
+  QCOMPARE(EnergyEstimate::registerAccesses("addi x0 x0 0", isa),
+           Accesses(1, 0));
+  QCOMPARE(EnergyEstimate::registerAccesses("lw a0 4(sp)", isa),
+           Accesses(1, 1));
+  QCOMPARE(EnergyEstimate::registerAccesses("sw a0 4(sp)", isa),
+           Accesses(2, 0));
+  QCOMPARE(EnergyEstimate::registerAccesses("bne t0 x0 -8", isa),
+           Accesses(2, 0));
+  QCOMPARE(EnergyEstimate::registerAccesses("ecall", isa), Accesses(0, 0));
+}
+
+void tst_energy::tst_model() {
+  EnergyModel model;
+  QVERIFY(model.set("dram", 1000));
+  QCOMPARE(model.dram, 1000.0);
+  QVERIFY(model.set("static", 0));
+  QCOMPARE(model.staticPower, 0.0);
+  QVERIFY(!model.set("l3", 100));
+}
+
+void tst_energy::tst_estimate() {
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_SS, {"M"});
+  auto res =
+      ProcessorHandler::getAssembler()->assembleRaw(s_program.join("\n"));
+  QVERIFY(res.errors.empty());
+  auto program = std::make_shared<Program>(res.program);
+  ProcessorHandler::loadProgram(program);
+
+  CacheHierarchyConfig config;
+  config.l1i = CachePreset{"l1",
+                           0,
+                           2,
+                           0,
+                           WritePolicy::WriteBack,
+                           WriteAllocPolicy::WriteAllocate,
+                           ReplPolicy::LRU};
+  config.l1d = config.l1i;
+  CacheHierarchy caches(config);
+  caches.attachToProcessor();
+
+  auto *proc = ProcessorHandler::getProcessorNonConst();
+  proc->trapHandler = [] {};
+  Profiler profiler(program, 20);
+  profiler.attach(proc);
+  while (!proc->finished() && proc->getCycleCount() < 1000)
+    proc->clock();
+  profiler.detach();
+  QVERIFY(proc->finished());
+
+  EnergyModel model;
+  const EnergyEstimate estimate(model, profiler, nullptr);
+  QCOMPARE(estimate.instructions(), 13LL);
+  QCOMPARE(estimate.cycles(), proc->getCycleCount());
+  QCOMPARE(events(estimate, "alu"), 5LL);
+  QCOMPARE(events(estimate, "muldiv"), 4LL);
+  QCOMPARE(events(estimate, "control"), 4LL);
+  // li: 1 read and 1 write, mul: 2 reads and 1 write, addi: 1 read and 1
+  // write, bnez: 2 reads.
+  QCOMPARE(events(estimate, "register file"), 2LL + 4 * (3 + 2 + 2));
+  // Without caches, neither the caches nor main memory are estimated.
+  QCOMPARE(events(estimate, "DRAM"), -1LL);
+  const double dynamic = 5 * model.alu + 4 * model.muldiv +
+                         4 * model.control + 30 * model.reg;
+  QCOMPARE(estimate.energy(),
+           dynamic + proc->getCycleCount() * model.staticPower);
+  QCOMPARE(estimate.energyDelayProduct(),
+           estimate.energy() * proc->getCycleCount());
+
+  // Every miss of the caches without an L2 cache accesses main memory.
+  const EnergyEstimate withCaches(model, profiler, &caches);
+  QVERIFY(events(withCaches, "L1I") > 0);
+  QCOMPARE(events(withCaches, "DRAM"),
+           static_cast<long long>(caches.l1i().getMisses() +
+                                  caches.l1d().getMisses()));
+  QVERIFY(withCaches.energy() > estimate.energy());
+}
+
+QTEST_MAIN(tst_energy)
+#include "tst_energy.moc"
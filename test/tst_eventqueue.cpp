@@ -0,0 +1,180 @@
+#include <QtTest/QTest>
+
+#include "processorhandler.h"
+#include "processorregistry.h"
+#include "processors/RISC-V/rviss/rviss.h"
+#include "ripessettings.h"
+
+using namespace Ripes;
+
+// This test ensures that events scheduled with the processor run in the order
+// of their cycles, and that they are run by the processor at their cycle, and
+// that natively clocked idle loops are skipped until the next event.
+
+class tst_eventqueue : public QObject {
+  Q_OBJECT
+
+private slots:
+  void tst_order();
+  void tst_reschedule();
+  void tst_clock();
+  void tst_idle();
+  void tst_native();
+  void tst_idleLoop();
+
+private:
+  RipesProcessor *load();
+};
+
+RipesProcessor *tst_eventqueue::load() {
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_ISS, {"M"});
+  auto res = ProcessorHandler::getAssembler()->assembleRaw(
+      QStringList{".text", "loop:", "addi t0 t0 1", "j loop"}.join("\n"));
+  if (!res.errors.empty())
+    return nullptr;
+  ProcessorHandler::loadProgram(std::make_shared<Program>(res.program));
+  return ProcessorHandler::getProcessorNonConst();
+}
+
+void tst_eventqueue::tst_order() {
+  EventQueue queue;
+  QCOMPARE(queue.nextCycle(), LLONG_MAX);
+  std::vector<int> order;
+  int a, b, c;
+  queue.schedule(&a, 30, [&] { order.push_back(30); });
+  queue.schedule(&b, 10, [&] { order.push_back(10); });
+  queue.schedule(&c, 20, [&] { order.push_back(20); });
+  QCOMPARE(queue.nextCycle(), 10ll);
+
+  queue.run(20);
+  QCOMPARE(order, (std::vector<int>{10, 20}));
+  QCOMPARE(queue.nextCycle(), 30ll);
+  queue.run(100);
+  QCOMPARE(order, (std::vector<int>{10, 20, 30}));
+  QCOMPARE(queue.nextCycle(), LLONG_MAX);
+}
+
+void tst_eventqueue::tst_reschedule() {
+  EventQueue queue;
+  int a, b;
+  int runs = 0;
+  queue.schedule(&a, 10, [&] { runs += 1; });
+  // Rescheduling replaces the event of the key.
+  queue.schedule(&a, 5, [&] { runs += 10; });
+  queue.schedule(&b, 7, [&] { runs += 100; });
+  queue.cancel(&b);
+  QCOMPARE(queue.nextCycle(), 5ll);
+  queue.run(100);
+  QCOMPARE(runs, 10);
+
+  // Events may schedule further events, which run if already due.
+  queue.schedule(&a, 1, [&] { queue.schedule(&b, 2, [&] { runs = -1; }); });
+  queue.run(2);
+  QCOMPARE(runs, -1);
+  QCOMPARE(queue.nextCycle(), LLONG_MAX);
+}
+
+void tst_eventqueue::tst_clock() {
+  auto *proc = load();
+  QVERIFY(proc);
+  long long ranAt = -1;
+  int key;
+  proc->events().schedule(&key, 17, [&] { ranAt = proc->getCycleCount(); });
+  proc->clockN(10);
+  QCOMPARE(ranAt, -1ll);
+  proc->clockN(10);
+  QCOMPARE(ranAt, 17ll);
+
+  // Events are cleared when the processor is reset.
+  proc->events().schedule(&key, 30, [&] { ranAt = 0; });
+  RipesSettings::getObserver(RIPES_GLOBALSIGNAL_REQRESET)->trigger();
+  QCOMPARE(proc->events().nextCycle(), LLONG_MAX);
+}
+
+void tst_eventqueue::tst_idle() {
+  auto *proc = load();
+  QVERIFY(proc);
+  QVERIFY(proc->features() & RipesProcessor::hasInterrupts);
+  long long ranAt = -1;
+  int key;
+  proc->events().schedule(&key, 1000, [&] { ranAt = proc->getCycleCount(); });
+  proc->clock();
+  proc->idleUntil(proc->events().nextCycle());
+  // The idle cycles are skipped, without executing instructions.
+  proc->clock();
+  QCOMPARE(proc->getCycleCount(), 1000ll);
+  QCOMPARE(proc->getInstructionsRetired(), 2ll);
+  proc->clock();
+  QCOMPARE(ranAt, 1000ll);
+}
+
+void tst_eventqueue::tst_native() {
+  const auto run = [&](bool native) {
+    auto *proc = load();
+    proc->setNativeClocking(native);
+    long long ranAt = -1;
+    int key;
+    proc->events().schedule(&key, 1500,
+                            [&, proc] { ranAt = proc->getCycleCount(); });
+    const unsigned cycles = proc->clockN(3000);
+    return std::make_tuple(cycles, ranAt, proc->getCycleCount(),
+                           proc->getInstructionsRetired(),
+                           proc->getRegister(RVISA::GPR, 5),
+                           proc->clockBatch().size());
+  };
+  QVERIFY(load()->features() & RipesProcessor::hasNativeClocking);
+
+  // Native slices end at scheduled events, which run at their cycle, and
+  // leave the same state as clocking each cycle. No per-cycle state is
+  // recorded.
+  const auto [cycles, ranAt, cycleCount, retired, t0, batch] = run(true);
+  const auto expected = run(false);
+  QCOMPARE(cycles, 3000u);
+  QCOMPARE(ranAt, 1500ll);
+  QCOMPARE(cycleCount, std::get<2>(expected));
+  QCOMPARE(retired, std::get<3>(expected));
+  QCOMPARE(t0, std::get<4>(expected));
+  QCOMPARE(batch, size_t(0));
+  QCOMPARE(std::get<5>(expected), size_t(3000));
+}
+
+void tst_eventqueue::tst_idleLoop() {
+  // Polls a flag, which is set by an event, and spins once it is set.
+  const auto run = [&](bool native) {
+    ProcessorHandler::selectProcessor(ProcessorID::RV32_ISS, {"M"});
+    auto res = ProcessorHandler::getAssembler()->assembleRaw(
+        QStringList{".data", "flag: .word 0", ".text", "la t2 flag", "poll:",
+                    "lw t0 0(t2)", "beqz t0 poll", "addi t1 t1 1", "spin:",
+                    "j spin"}
+            .join("\n"));
+    auto program = std::make_shared<Program>(res.program);
+    ProcessorHandler::loadProgram(program);
+    auto *proc = ProcessorHandler::getProcessorNonConst();
+    proc->setNativeClocking(native);
+    const AInt flag = *program->symbolIndex().address("flag");
+    int key;
+    proc->events().schedule(&key, 2500, [proc, flag] {
+      proc->getMemory().writeMem(flag, 1, 4);
+    });
+    const unsigned cycles = proc->clockN(5000);
+    const auto *iss = dynamic_cast<RVISS<uint32_t> *>(proc);
+    return std::make_tuple(cycles, proc->getCycleCount(),
+                           proc->getInstructionsRetired(),
+                           proc->getRegister(RVISA::GPR, 6),
+                           iss ? iss->idleCyclesSkipped() : -1);
+  };
+
+  // The skipped iterations leave the same state as executing them.
+  const auto [cycles, cycleCount, retired, t1, skipped] = run(true);
+  const auto expected = run(false);
+  QCOMPARE(cycles, 5000u);
+  QCOMPARE(cycleCount, std::get<1>(expected));
+  QCOMPARE(retired, std::get<2>(expected));
+  QCOMPARE(t1, VInt(1));
+  QCOMPARE(std::get<3>(expected), VInt(1));
+  QVERIFY(skipped > 4000);
+  QCOMPARE(std::get<4>(expected), 0ll);
+}
+
+QTEST_MAIN(tst_eventqueue)
+#include "tst_eventqueue.moc"
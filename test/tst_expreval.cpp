@@ -10,6 +10,9 @@ class tst_ExprEval : public QObject {
 
 private slots:
   void tst_binops();
+  void tst_symbols();
+  void tst_reevaluate();
+  void tst_compiled();
 };
 
 void expect(const ExprEvalRes &res, const ExprEvalVT &expected) {
@@ -24,8 +27,96 @@ void tst_ExprEval::tst_binops() {
   expect(evaluate(Location::unknown(), "(0x2*(3+4))+4"), 18);
   expect(evaluate(Location::unknown(), "2+3*7*5"), 107);
   SymbolMap symbols;
-  Location::unknown(), symbols.abs["B"] = 2;
-  expect(evaluate(Location::unknown(), "(B *(3+ 4))+4", &symbols.abs), 18);
+  symbols.setAbsSymbol("B", 2);
+  expect(evaluate(Location::unknown(), "(B *(3+ 4))+4", symbols), 18);
+}
+
+void tst_ExprEval::tst_symbols() {
+  SymbolMap symbols;
+  QVERIFY(!symbols.addAbsSymbol(1, Symbol("A"), 4).has_value());
+  QVERIFY(symbols.addAbsSymbol(2, Symbol("A"), 5).has_value());
+  symbols.setAbsSymbol("A", 6);
+  QCOMPARE(symbols.abs.size(), size_t(1));
+  QCOMPARE(symbols.value("A", 0).value(), VIntS(6));
+  QVERIFY(!symbols.value("B", 0).has_value());
+
+  // Relative symbols resolve to the nearest definition before or after a line,
+  // regardless of the order in which they were defined.
+  for (unsigned line : {30, 10, 20})
+    QVERIFY(!symbols.addRelSymbol(line, Symbol("1"), line * 2).has_value());
+  QVERIFY(symbols.addRelSymbol(20, Symbol("1"), 0).has_value());
+  QVERIFY(!symbols.value("1b", 5).has_value());
+  QCOMPARE(symbols.value("1f", 5).value(), VIntS(20));
+  QCOMPARE(symbols.value("1b", 20).value(), VIntS(40));
+  QCOMPARE(symbols.value("1f", 20).value(), VIntS(60));
+  QCOMPARE(symbols.value("1b", 25).value(), VIntS(40));
+  QVERIFY(!symbols.value("1f", 30).has_value());
+  QVERIFY(!symbols.value("2f", 0).has_value());
+  expect(evaluate(Location(25), "1f-1b+A", symbols), 26);
+}
+
+void tst_ExprEval::tst_reevaluate() {
+  // Parsed expressions are reused, but evaluated against the symbols of each
+  // evaluation.
+  SymbolMap symbols;
+  for (int i = 0; i < 3; ++i) {
+    symbols.setAbsSymbol("sym", i);
+    expect(evaluate(Location::unknown(), "(sym+4)*2", symbols), (i + 4) * 2);
+    expect(evaluate(Location::unknown(), "0x10-sym", symbols), 16 - i);
+  }
+  QVERIFY(evaluate(Location::unknown(), "(sym+4)*2").isError());
+
+  // Expressions failing to parse report the location of each evaluation.
+  for (unsigned line : {3, 7}) {
+    auto res = evaluate(Location(line), "(2+3))");
+    QVERIFY(res.isError());
+    QCOMPARE(res.error().sourceLine(), int64_t(line));
+  }
+}
+
+void tst_ExprEval::tst_compiled() {
+  // Symbols are bound once upon compilation, to constants or to operands read
+  // upon each evaluation.
+  const auto binder =
+      [](const QString &name) -> std::optional<CompiledExpr::Binding> {
+    if (name == "A")
+      return CompiledExpr::Binding{CompiledExpr::Binding::Constant, 4};
+    if (name == "x")
+      return CompiledExpr::Binding{CompiledExpr::Binding::Operand, 1};
+    return {};
+  };
+  const auto compile = [&](const QString &s) {
+    auto res = CompiledExpr::compile(Location::unknown(), s, binder);
+    if (res.isError())
+      qFatal("%s", qPrintable(res.error().errorMessage()));
+    return res.value();
+  };
+  const auto operands = [](ExprEvalVT x) {
+    return [=](unsigned i) { return i == 1 ? x : 0; };
+  };
+
+  QCOMPARE(compile("2+3*7*5").evaluate(operands(0)), ExprEvalVT(107));
+  QCOMPARE(compile("(x + A) * 2").evaluate(operands(3)), ExprEvalVT(14));
+  QCOMPARE(compile("-x").evaluate(operands(3)), ExprEvalVT(-3));
+  QCOMPARE(compile("x / 0").evaluate(operands(3)), ExprEvalVT(0));
+  QCOMPARE(compile("x % 0").evaluate(operands(3)), ExprEvalVT(0));
+  QCOMPARE(compile("x@8").evaluate(operands(0xFF)), ExprEvalVT(-1));
+
+  const auto condition = compile("x * 2 >= (A + 2)");
+  QCOMPARE(condition.evaluate(operands(2)), ExprEvalVT(0));
+  QCOMPARE(condition.evaluate(operands(3)), ExprEvalVT(1));
+  QCOMPARE(compile("x == A").evaluate(operands(4)), ExprEvalVT(1));
+  QCOMPARE(compile("x != A").evaluate(operands(4)), ExprEvalVT(0));
+  QCOMPARE(compile("x < 0").evaluate(operands(-1)), ExprEvalVT(1));
+  QCOMPARE(compile("x <= 0").evaluate(operands(1)), ExprEvalVT(0));
+  QCOMPARE(compile("x > -1").evaluate(operands(0)), ExprEvalVT(1));
+
+  for (const QString &invalid : {"y + 1", "x ==", "x == 1 == 1", "x = 1",
+                                 "< 2", "(x == 1)"}) {
+    QVERIFY2(CompiledExpr::compile(Location::unknown(), invalid, binder)
+                 .isError(),
+             qPrintable(invalid));
+  }
 }
 
 QTEST_APPLESS_MAIN(tst_ExprEval)
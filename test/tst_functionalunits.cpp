@@ -0,0 +1,150 @@
+#include <QtTest/QTest>
+
+#include "processorhandler.h"
+#include "processorregistry.h"
+#include "programloader.h"
+
+using namespace Ripes;
+
+// This test ensures that the multiplications and divisions of the M extension
+// are executed with the latency and issue interval of the functional unit
+// timing of the processor models.
+
+class tst_functionalunits : public ProcessorTest {
+  Q_OBJECT
+
+private slots:
+  void tst_inOrder();
+  void tst_inOrder_data();
+  void tst_exposedLatency();
+  void tst_outOfOrder();
+
+private:
+  static RipesProcessor *load(ProcessorID id, const QStringList &program,
+                              const FunctionalUnitTiming &timing);
+  long long cycles(ProcessorID id, const QStringList &program,
+                   const FunctionalUnitTiming &timing);
+  static QStringList independent(const QString &op, int n);
+  static QStringList dependent(const QString &op, int n);
+};
+
+RipesProcessor *tst_functionalunits::load(ProcessorID id,
+                                          const QStringList &program,
+                                          const FunctionalUnitTiming &timing) {
+  auto *proc = ProcessorTest::load(id, program);
+  if (proc)
+    proc->functionalUnitTiming = timing;
+  return proc;
+}
+
+long long tst_functionalunits::cycles(ProcessorID id,
+                                      const QStringList &program,
+                                      const FunctionalUnitTiming &timing) {
+  auto *proc = load(id, program, timing);
+  if (!proc)
+    return -1;
+  runToFinish(proc);
+  return proc->finished() ? proc->getCycleCount() : -1;
+}
+
+QStringList tst_functionalunits::independent(const QString &op, int n) {
+  QStringList program = {".text"};
+  for (int i = 0; i < n; ++i)
+    program << op + " x" + QString::number(5 + i % 2) + " x7 x8";
+  return program;
+}
+
+QStringList tst_functionalunits::dependent(const QString &op, int n) {
+  QStringList program = {".text"};
+  for (int i = 0; i < n; ++i)
+    program << op + " x5 x5 x8";
+  return program;
+}
+
+void tst_functionalunits::tst_inOrder_data() {
+  QTest::addColumn<int>("id");
+  QTest::addColumn<int>("depth");
+  QTest::addColumn<QString>("op");
+  QTest::addColumn<unsigned>("latency");
+  QTest::addColumn<unsigned>("interval");
+  QTest::newRow("7-stage pipelined mul")
+      << int(ProcessorID::RV32_7S_GEN) << 7 << "mul" << 3u << 1u;
+  QTest::newRow("7-stage single-cycle mul")
+      << int(ProcessorID::RV32_7S_GEN) << 7 << "mul" << 1u << 1u;
+  QTest::newRow("7-stage iterative div")
+      << int(ProcessorID::RV32_7S_GEN) << 7 << "div" << 4u << 4u;
+  QTest::newRow("9-stage pipelined mul")
+      << int(ProcessorID::RV32_9S_GEN) << 9 << "mulh" << 3u << 1u;
+  QTest::newRow("9-stage iterative rem")
+      << int(ProcessorID::RV32_9S_GEN) << 9 << "rem" << 5u << 5u;
+  QTest::newRow("9-stage iterative divu RV64")
+      << int(ProcessorID::RV64_9S_GEN) << 9 << "divu" << 5u << 5u;
+}
+
+void tst_functionalunits::tst_inOrder() {
+  QFETCH(int, id);
+  QFETCH(int, depth);
+  QFETCH(QString, op);
+  QFETCH(unsigned, latency);
+  QFETCH(unsigned, interval);
+  constexpr long long n = 20;
+  const auto processor = ProcessorID(id);
+  FunctionalUnitTiming timing;
+  timing.mul = timing.div = {latency, interval};
+
+  // Independent operations enter their unit once per issue interval; their
+  // latency is hidden by the stages following the EX stages...
+  QCOMPARE(cycles(processor, independent(op, n), timing),
+           n + depth + (n - 1) * (interval - 1));
+
+  // ... and is exposed by dependent operations, which stall until the result
+  // of the unit is forwarded.
+  QCOMPARE(cycles(processor, dependent(op, n), timing),
+           n + depth + (n - 1) * (latency - 1));
+}
+
+void tst_functionalunits::tst_exposedLatency() {
+  // Divisions reach the last stage 4 cycles before their result is computed,
+  // and stall the pipeline. The 4 stages following the EX stage hide half of
+  // the latency of the pipelined divider, such that each division costs 2
+  // cycles.
+  constexpr long long n = 20;
+  FunctionalUnitTiming timing;
+  timing.div = {8, 1};
+  auto *proc = load(ProcessorID::RV32_7S_GEN, independent("div", n), timing);
+  QVERIFY(proc);
+  ProcessorHandler::setPerformanceCounting(true);
+  runToFinish(proc);
+  QVERIFY(proc->finished());
+  QCOMPARE(proc->getCycleCount(), n + 7 + n);
+  const auto &counters = proc->performanceCounters();
+  QCOMPARE(counters.functionalUnitStalls, n);
+  QCOMPARE(counters.dataHazards, 0LL);
+  for (unsigned s = 0; s < 7; ++s)
+    QCOMPARE(counters.stages.at({0, s}).stalled, n);
+}
+
+void tst_functionalunits::tst_outOfOrder() {
+  constexpr long long n = 20;
+  const auto processor = ProcessorID::RV32_OOO_2W;
+  FunctionalUnitTiming fast;
+  FunctionalUnitTiming slow;
+  fast.mul = {3, 1};
+  slow.mul = {6, 1};
+
+  // Each operation of a dependency chain waits the full latency of its
+  // predecessor...
+  QCOMPARE(cycles(processor, dependent("mul", n), slow) -
+               cycles(processor, dependent("mul", n), fast),
+           n * 3);
+
+  // ... whereas independent operations are limited by the issue interval.
+  fast.div = {4, 1};
+  slow.div = {4, 4};
+  QCOMPARE(cycles(processor, independent("div", n), slow) -
+               cycles(processor, independent("div", n), fast),
+           (n - 1) * 3);
+}
+
+QTEST_MAIN(tst_functionalunits)
+#include "tst_functionalunits.moc"
@@ -0,0 +1,94 @@
+#include <QtTest/QTest>
+
+#include <QTemporaryDir>
+
+#include "inputlog.h"
+
+using namespace Ripes;
+
+// This test ensures that the inputs recorded to an input log are replayed in
+// order, and that a replay using more or fewer inputs than were recorded is
+// reported as diverged.
+
+class tst_inputlog : public QObject {
+  Q_OBJECT
+
+private slots:
+  void tst_roundtrip();
+  void tst_divergence();
+  void tst_invalid();
+
+private:
+  QString record(const QString &name);
+  QTemporaryDir m_dir;
+};
+
+QString tst_inputlog::record(const QString &name) {
+  InputLog::startRecording();
+  InputLog::time(1000);
+  InputLog::recordStdIn("hello\n");
+  InputLog::time(900);
+  InputLog::recordStdIn("");
+  InputLog::time(1LL << 40);
+  InputLog::stop();
+  const QString path = m_dir.filePath(name);
+  const QString err = InputLog::save(path);
+  if (!err.isEmpty())
+    qFatal("%s", qPrintable(err));
+  return path;
+}
+
+void tst_inputlog::tst_roundtrip() {
+  // Inputs pass through unchanged while no log is active.
+  QCOMPARE(InputLog::time(5), qint64(5));
+  QVERIFY(!InputLog::replayStdIn());
+
+  const QString path = record("roundtrip.inl");
+  QCOMPARE(InputLog::inputs(), 5LL);
+
+  QCOMPARE(InputLog::startReplay(path), QString());
+  QCOMPARE(InputLog::time(0), qint64(1000));
+  QCOMPARE(*InputLog::replayStdIn(), QByteArray("hello\n"));
+  QCOMPARE(InputLog::time(0), qint64(900));
+  QCOMPARE(*InputLog::replayStdIn(), QByteArray());
+  QCOMPARE(InputLog::time(0), qint64(1LL << 40));
+  QCOMPARE(InputLog::inputs(), 5LL);
+  QVERIFY(!InputLog::diverged());
+  InputLog::stop();
+}
+
+void tst_inputlog::tst_divergence() {
+  const QString path = record("divergence.inl");
+
+  // Recorded inputs left unused.
+  QCOMPARE(InputLog::startReplay(path), QString());
+  InputLog::time(0);
+  QVERIFY(InputLog::diverged());
+  InputLog::stop();
+
+  // More inputs requested than were recorded; the live inputs are used.
+  QCOMPARE(InputLog::startReplay(path), QString());
+  for (int i = 0; i < 3; ++i)
+    InputLog::time(0);
+  InputLog::replayStdIn();
+  InputLog::replayStdIn();
+  QVERIFY(!InputLog::diverged());
+  QCOMPARE(InputLog::time(42), qint64(42));
+  QVERIFY(!InputLog::replayStdIn());
+  QVERIFY(InputLog::diverged());
+  InputLog::stop();
+}
+
+void tst_inputlog::tst_invalid() {
+  QVERIFY(!InputLog::startReplay(m_dir.filePath("missing.inl")).isEmpty());
+
+  QFile file(m_dir.filePath("invalid.inl"));
+  QVERIFY(file.open(QIODevice::WriteOnly));
+  file.write("RIPESINL\x01\x02\x7f");
+  file.close();
+  QVERIFY(!InputLog::startReplay(file.fileName()).isEmpty());
+  QCOMPARE(InputLog::mode(), InputLog::Mode::Off);
+}
+
+QTEST_APPLESS_MAIN(tst_inputlog)
+#include "tst_inputlog.moc"
@@ -0,0 +1,123 @@
+#include <QJsonArray>
+#include <QtTest/QTest>
+
+#include "io/ioconfig.h"
+#include "io/iomanager.h"
+#include "isa/rvisainfo_common.h"
+#include "processorhandler.h"
+#include "processorregistry.h"
+#include "ripessettings.h"
+
+using namespace Ripes;
+
+// This test ensures that peripherals are instantiated without views from a
+// configuration, and that their inputs are set at the cycles of the timeline.
+
+class tst_ioconfig : public QObject {
+  Q_OBJECT
+
+private slots:
+  void initTestCase();
+  void tst_timeline();
+  void tst_errors();
+  void tst_errors_data();
+
+private:
+  QJsonObject config(const QJsonArray &timeline) const;
+  /// Runs the loaded program to completion.
+  void runProgram();
+};
+
+// Waits for a switch to be set, and then copies the switches to a0.
+static const QString s_program = QStringList{
+    ".text", "li t1 SWITCHES_0_BASE", "loop:", "lw a0 0(t1)", "beqz a0 loop",
+    "nop"}.join("\n");
+
+void tst_ioconfig::initTestCase() {
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_ISS, {"M"});
+}
+
+QJsonObject tst_ioconfig::config(const QJsonArray &timeline) const {
+  return QJsonObject{
+      {"peripherals",
+       QJsonArray{QJsonObject{{"type", "Switches"},
+                              {"parameters", QJsonObject{{"# Switches", 4}}}},
+                  QJsonObject{{"type", "D-Pad"}}}},
+      {"timeline", timeline}};
+}
+
+void tst_ioconfig::runProgram() {
+  auto *proc = ProcessorHandler::getProcessorNonConst();
+  while (!proc->finished() && proc->getCycleCount() < 10000)
+    proc->clockN(100);
+  QVERIFY(proc->finished());
+}
+
+void tst_ioconfig::tst_timeline() {
+  IOConfig io;
+  const QString error = io.load(config(QJsonArray{
+      QJsonObject{{"cycle", 500},
+                  {"peripheral", "Switches 0"},
+                  {"input", "2"},
+                  {"value", true}},
+      QJsonObject{{"cycle", 500},
+                  {"peripheral", "Switches 0"},
+                  {"input", 0},
+                  {"value", 1}},
+      QJsonObject{{"cycle", 200},
+                  {"peripheral", "D-Pad 0"},
+                  {"input", "UP"},
+                  {"value", true}}}));
+  QCOMPARE(error, QString());
+  QCOMPARE(io.peripherals().size(), size_t(2));
+  auto *dpad = io.peripherals().at(1);
+
+  auto res = ProcessorHandler::getAssembler()->assembleRaw(
+      s_program, &IOManager::get().assemblerSymbols());
+  QVERIFY(res.errors.empty());
+  ProcessorHandler::loadProgram(std::make_shared<Program>(res.program));
+  QVERIFY(!dpad->input(0));
+  runProgram();
+  QCOMPARE(ProcessorHandler::getRegisterValue(RVISA::GPR, 10), VInt(0b101));
+  QVERIFY(ProcessorHandler::getProcessor()->getCycleCount() > 500);
+  QVERIFY(dpad->input(0));
+
+  // The timeline is replayed upon reset, with the inputs released.
+  RipesSettings::getObserver(RIPES_GLOBALSIGNAL_REQRESET)->trigger();
+  QVERIFY(!dpad->input(0));
+  QCOMPARE(io.peripherals().at(0)->ioRead(0, 4), VInt(0));
+  runProgram();
+  QCOMPARE(ProcessorHandler::getRegisterValue(RVISA::GPR, 10), VInt(0b101));
+}
+
+void tst_ioconfig::tst_errors_data() {
+  QTest::addColumn<QJsonObject>("entry");
+  QTest::addColumn<QString>("error");
+  QTest::newRow("peripheral")
+      << QJsonObject{{"cycle", 0}, {"peripheral", "LED Matrix 0"},
+                     {"input", "0"}}
+      << "Unknown peripheral 'LED Matrix 0' in timeline";
+  QTest::newRow("input") << QJsonObject{{"cycle", 0},
+                                        {"peripheral", "Switches 0"},
+                                        {"input", "4"}}
+                         << "Unknown input '4' of Switches 0";
+  QTest::newRow("cycle") << QJsonObject{{"cycle", -1},
+                                        {"peripheral", "D-Pad 0"},
+                                        {"input", "UP"}}
+                         << "Invalid cycle in timeline";
+}
+
+void tst_ioconfig::tst_errors() {
+  QFETCH(QJsonObject, entry);
+  QFETCH(QString, error);
+  IOConfig io;
+  QCOMPARE(io.load(config(QJsonArray{entry})), error);
+
+  IOConfig unknown;
+  QCOMPARE(unknown.load(QJsonObject{
+               {"peripherals", QJsonArray{QJsonObject{{"type", "Radio"}}}}}),
+           QString("Unknown peripheral type 'Radio'"));
+}
+
+QTEST_MAIN(tst_ioconfig)
+#include "tst_ioconfig.moc"
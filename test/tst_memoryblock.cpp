@@ -0,0 +1,90 @@
+#include <QtTest/QTest>
+
+#include "memoryblock.h"
+#include "processorhandler.h"
+#include "processorregistry.h"
+
+using namespace Ripes;
+
+// This test ensures that bulk accesses of the memory of the processor are
+// equivalent to accessing the memory a byte at a time.
+
+class tst_memoryblock : public QObject {
+  Q_OBJECT
+
+private slots:
+  void initTestCase();
+  void tst_readString();
+  void tst_writeBlock();
+  void tst_writeBlock_data();
+  void tst_strnlen();
+
+private:
+  AInt m_stringAddress = 0;
+};
+
+static const QByteArray s_string = "Hello, block accesses!";
+
+void tst_memoryblock::initTestCase() {
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_SS, {"M"});
+  const QString string = "str: .string \"" + QString::fromUtf8(s_string) + "\"";
+  auto res = ProcessorHandler::getAssembler()->assembleRaw(
+      QStringList{".data", string, ".text", "nop"}.join("\n"));
+  QVERIFY(res.errors.empty());
+  ProcessorHandler::loadProgram(std::make_shared<Program>(res.program));
+  m_stringAddress = res.program.getSection(".data")->address;
+}
+
+void tst_memoryblock::tst_readString() {
+  QCOMPARE(ProcessorHandler::readMemString(m_stringAddress), s_string);
+  // Strings are read from any alignment, and limited by maxLength.
+  QCOMPARE(ProcessorHandler::readMemString(m_stringAddress + 3),
+           s_string.mid(3));
+  QCOMPARE(ProcessorHandler::readMemString(m_stringAddress + 1, 5),
+           s_string.mid(1, 5));
+}
+
+void tst_memoryblock::tst_writeBlock_data() {
+  QTest::addColumn<int>("offset");
+  QTest::addColumn<int>("size");
+  for (int offset : {0, 1, 7})
+    for (int size : {0, 1, 3, 8, 21})
+      QTest::addRow("offset %d, size %d", offset, size) << offset << size;
+}
+
+void tst_memoryblock::tst_writeBlock() {
+  QFETCH(int, offset);
+  QFETCH(int, size);
+  const AInt base = 0x10000000;
+  auto &memory = ProcessorHandler::getMemory();
+
+  // Surround the block with bytes which must be left untouched.
+  for (int i = -8; i < size + 8; ++i)
+    memory.writeMem(base + offset + i, 0xAA, 1);
+  QByteArray data(size, '\0');
+  for (int i = 0; i < size; ++i)
+    data[i] = static_cast<char>(i * 37 + 1);
+  ProcessorHandler::writeMemBlock(base + offset, data.constData(), size);
+
+  for (int i = -8; i < size + 8; ++i) {
+    const char expected = i < 0 || i >= size ? char(0xAA) : data.at(i);
+    QCOMPARE(static_cast<char>(memory.readMemConst(base + offset + i, 1)),
+             expected);
+  }
+  QByteArray read(size, '\0');
+  ProcessorHandler::readMemBlock(base + offset, read.data(), size);
+  QCOMPARE(read, data);
+}
+
+void tst_memoryblock::tst_strnlen() {
+  auto &memory = ProcessorHandler::getMemory();
+  QCOMPARE(MemoryBlock::strnlen(memory, m_stringAddress, 100),
+           size_t(s_string.size()));
+  QCOMPARE(MemoryBlock::strnlen(memory, m_stringAddress, 4), size_t(4));
+  QCOMPARE(MemoryBlock::strnlen(memory, m_stringAddress, 0), size_t(0));
+  QCOMPARE(MemoryBlock::strnlen(memory, m_stringAddress + s_string.size(), 10),
+           size_t(0));
+}
+
+QTEST_MAIN(tst_memoryblock)
+#include "tst_memoryblock.moc"
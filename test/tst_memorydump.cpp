@@ -0,0 +1,115 @@
+#include <QBuffer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtTest/QTest>
+
+#include "cli/memorydump.h"
+#include "pagedmemory.h"
+
+using namespace Ripes;
+
+// This test ensures that memory dumps hold the bytes of each region in each
+// format, that regions start at addresses or symbols, and that the options of
+// --dump are parsed.
+
+class tst_memorydump : public QObject {
+  Q_OBJECT
+
+private slots:
+  void initTestCase();
+  void tst_parse();
+  void tst_binary();
+  void tst_hex();
+  void tst_json();
+  void tst_unknownSymbol();
+
+private:
+  QByteArray dump(MemoryDump::Format format,
+                  const std::vector<MemoryDump::Region> &regions);
+
+  PagedMemory m_memory;
+  Program m_program;
+};
+
+void tst_memorydump::initTestCase() {
+  // A region larger than a chunk, spanning unallocated pages.
+  for (AInt i = 0; i < 0x30000; i += 0x1000)
+    m_memory.writeMem(0x10000 + i, i >> 12, 1);
+  m_memory.writeMem(0x100, 0x0403020100, 5);
+  m_program.symbols[0x100] = Symbol("result");
+}
+
+QByteArray
+tst_memorydump::dump(MemoryDump::Format format,
+                     const std::vector<MemoryDump::Region> &regions) {
+  QBuffer buffer;
+  buffer.open(QIODevice::WriteOnly);
+  QString error;
+  if (!MemoryDump(format, 4).write(buffer, m_memory, regions, &m_program,
+                                   error))
+    qFatal("%s", qPrintable(error));
+  return buffer.data();
+}
+
+void tst_memorydump::tst_parse() {
+  const auto region = MemoryDump::parseRegion("result:0x10");
+  QVERIFY(region);
+  QCOMPARE(region->start, QString("result"));
+  QCOMPARE(region->bytes, AInt(16));
+  QCOMPARE(MemoryDump::parseRegion("0x1000:4096")->start, QString("0x1000"));
+  for (const QString &invalid : {"result", ":4", "result:0", "result:x"})
+    QVERIFY2(!MemoryDump::parseRegion(invalid), qPrintable(invalid));
+
+  QCOMPARE(MemoryDump::parseFormat("json"), MemoryDump::Format::JSON);
+  QVERIFY(!MemoryDump::parseFormat("xml"));
+}
+
+void tst_memorydump::tst_binary() {
+  const QByteArray bytes =
+      dump(MemoryDump::Format::Binary, {{"0x10000", 0x30000}, {"result", 6}});
+  QCOMPARE(bytes.size(), 0x30006);
+  for (int page = 0; page < 0x30; page++) {
+    QCOMPARE(bytes.at(page * 0x1000), char(page));
+    QCOMPARE(bytes.at(page * 0x1000 + 1), char(0));
+  }
+  QCOMPARE(bytes.right(6), QByteArray("\x00\x01\x02\x03\x04\x00", 6));
+}
+
+void tst_memorydump::tst_hex() {
+  QCOMPARE(dump(MemoryDump::Format::Hex, {{"result", 18}}),
+           QByteArray("# result: 18 bytes at 0x00000100\n"
+                      "00000100: 00 01 02 03 04 00 00 00 00 00 00 00 00 00 "
+                      "00 00\n"
+                      "00000110: 00 00\n"));
+}
+
+void tst_memorydump::tst_json() {
+  const QJsonDocument doc = QJsonDocument::fromJson(
+      dump(MemoryDump::Format::JSON, {{"result", 3}, {"0x10000", 0x20000}}));
+  QVERIFY(doc.isArray());
+  const QJsonArray regions = doc.array();
+  QCOMPARE(regions.size(), 2);
+  const QJsonObject result = regions.at(0).toObject();
+  QCOMPARE(result.value("region").toString(), QString("result"));
+  QCOMPARE(result.value("address").toInt(), 0x100);
+  QCOMPARE(result.value("bytes").toArray(), QJsonArray({0, 1, 2}));
+  const QJsonArray bytes = regions.at(1).toObject().value("bytes").toArray();
+  QCOMPARE(bytes.size(), 0x20000);
+  QCOMPARE(bytes.at(0x1F000).toInt(), 0x1F);
+}
+
+void tst_memorydump::tst_unknownSymbol() {
+  QBuffer buffer;
+  buffer.open(QIODevice::WriteOnly);
+  QString error;
+  QVERIFY(!MemoryDump(MemoryDump::Format::Hex, 4)
+               .write(buffer, m_memory, {{"result", 4}, {"missing", 4}},
+                      &m_program, error));
+  QVERIFY(error.contains("missing"));
+  // Nothing is written if a region is invalid.
+  QVERIFY(buffer.data().isEmpty());
+}
+
+QTEST_APPLESS_MAIN(tst_memorydump)
+#include "tst_memorydump.moc"
@@ -0,0 +1,84 @@
+#include <QtTest/QTest>
+
+#include "memoryfootprint.h"
+#include "pagedmemory.h"
+#include "processorhandler.h"
+
+using namespace Ripes;
+
+// This test ensures that the memory footprint sums the sources of each
+// component for as long as they live, that budgets are checked, and that the
+// growing components of the simulator are accounted.
+
+class tst_memoryfootprint : public QObject {
+  Q_OBJECT
+
+private slots:
+  void tst_sources();
+  void tst_budgets();
+  void tst_guestMemory();
+  void tst_rewindStacks();
+};
+
+void tst_memoryfootprint::tst_sources() {
+  const size_t before = MemoryFootprint::measure()[MemoryFootprint::Console];
+  {
+    MemoryFootprint::Source a(MemoryFootprint::Console, [] { return 100; });
+    MemoryFootprint::Source b(MemoryFootprint::Console, [] { return 20; });
+    QCOMPARE(MemoryFootprint::measure()[MemoryFootprint::Console],
+             before + 120);
+  }
+  QCOMPARE(MemoryFootprint::measure()[MemoryFootprint::Console], before);
+}
+
+void tst_memoryfootprint::tst_budgets() {
+  MemoryFootprint::Measurement measurement{};
+  measurement[MemoryFootprint::CacheTraces] = 2048;
+  measurement[MemoryFootprint::Disassembly] = 512;
+  QVERIFY(MemoryFootprint::overBudget(measurement).empty());
+
+  MemoryFootprint::setBudget(MemoryFootprint::CacheTraces, 1024);
+  MemoryFootprint::setBudget(MemoryFootprint::Disassembly, 1024);
+  const auto over = MemoryFootprint::overBudget(measurement);
+  QCOMPARE(over.size(), size_t(1));
+  QCOMPARE(over.front(), MemoryFootprint::CacheTraces);
+
+  MemoryFootprint::setBudget(MemoryFootprint::CacheTraces, 0);
+  MemoryFootprint::setBudget(MemoryFootprint::Disassembly, 0);
+  QVERIFY(MemoryFootprint::overBudget(measurement).empty());
+}
+
+void tst_memoryfootprint::tst_guestMemory() {
+  PagedMemory memory;
+  const size_t empty = memory.bytes();
+  memory.writeMem(0x1000, 1, 4);
+  memory.writeMem(0x1004, 2, 4);
+  QVERIFY(memory.bytes() >= empty + PagedMemory::s_pageSize);
+  const size_t onePage = memory.bytes();
+  // The second page shares the page directory of the first.
+  memory.writeMem(0x3000, 3, 4);
+  QVERIFY(memory.bytes() - onePage >= PagedMemory::s_pageSize);
+  QVERIFY(memory.bytes() - onePage < onePage - empty);
+  QVERIFY(MemoryFootprint::measure()[MemoryFootprint::GuestMemory] >=
+          memory.bytes());
+  memory.reset();
+  QCOMPARE(memory.bytes(), empty);
+}
+
+void tst_memoryfootprint::tst_rewindStacks() {
+  // The functional model checkpoints its state for reversing cycles.
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_ISS);
+  auto *proc = ProcessorHandler::getProcessorNonConst();
+  proc->setMaxReverseCycles(100);
+  const auto program = ProcessorHandler::getAssembler()->assembleRaw(
+      ".text\nloop:\naddi a0, a0, 1\nj loop");
+  ProcessorHandler::loadProgram(std::make_shared<Program>(program.program));
+  for (int i = 0; i < 10; ++i)
+    proc->clock();
+  QVERIFY(proc->reverseStateBytes() > 0);
+  QCOMPARE(MemoryFootprint::measure()[MemoryFootprint::RewindStacks],
+           proc->reverseStateBytes());
+}
+
+QTEST_MAIN(tst_memoryfootprint)
+#include "tst_memoryfootprint.moc"
@@ -0,0 +1,126 @@
+#include <QtTest/QTest>
+
+#include "memorysearch.h"
+#include "pagedmemory.h"
+
+using namespace Ripes;
+
+// This test ensures that patterns are parsed as bytes, strings and masked
+// values, and that searches find every match in order, including matches
+// spanning pages, and none in unallocated memory.
+
+class tst_memorysearch : public QObject {
+  Q_OBJECT
+
+private slots:
+  void tst_parse();
+  void tst_find();
+  void tst_masked();
+  void tst_unpaged();
+
+private:
+  static MemorySearch::Pattern parse(MemorySearch::Kind kind,
+                                     const QString &text, unsigned width = 0,
+                                     const QString &mask = QString());
+  static std::vector<AInt> findAll(const MemorySearch &search,
+                                   const MemorySearch::Pattern &pattern);
+};
+
+static constexpr AInt s_page = MemorySearch::s_pageSize;
+
+MemorySearch::Pattern tst_memorysearch::parse(MemorySearch::Kind kind,
+                                              const QString &text,
+                                              unsigned width,
+                                              const QString &mask) {
+  QString error;
+  auto pattern = MemorySearch::parse(kind, text, width, mask, error);
+  if (!pattern)
+    qFatal("%s", qPrintable(error));
+  return *pattern;
+}
+
+std::vector<AInt>
+tst_memorysearch::findAll(const MemorySearch &search,
+                          const MemorySearch::Pattern &pattern) {
+  std::vector<AInt> matches;
+  for (auto match = search.findNext(pattern, 0); match;
+       match = search.findNext(pattern, *match + 1))
+    matches.push_back(*match);
+  return matches;
+}
+
+void tst_memorysearch::tst_parse() {
+  using Bytes = std::vector<uint8_t>;
+  auto pattern = parse(MemorySearch::Kind::Bytes, "de AD\tb? ef");
+  QCOMPARE(pattern.bytes, Bytes({0xDE, 0xAD, 0xB0, 0xEF}));
+  QCOMPARE(pattern.mask, Bytes({0xFF, 0xFF, 0xF0, 0xFF}));
+  QVERIFY(parse(MemorySearch::Kind::Bytes, "0102").mask.empty());
+  QCOMPARE(parse(MemorySearch::Kind::String, "hé").bytes,
+           Bytes({'h', 0xC3, 0xA9}));
+
+  pattern = parse(MemorySearch::Kind::Value, "0x1234", 4, "0xff00");
+  QCOMPARE(pattern.bytes, Bytes({0x34, 0x12, 0, 0}));
+  QCOMPARE(pattern.mask, Bytes({0, 0xFF, 0, 0}));
+  QCOMPARE(parse(MemorySearch::Kind::Value, "-2", 2).bytes,
+           Bytes({0xFE, 0xFF}));
+
+  QString error;
+  for (const auto &[kind, text] :
+       {std::make_pair(MemorySearch::Kind::Bytes, "abc"),
+        std::make_pair(MemorySearch::Kind::Bytes, "zz"),
+        std::make_pair(MemorySearch::Kind::String, ""),
+        std::make_pair(MemorySearch::Kind::Value, "0x100"),
+        std::make_pair(MemorySearch::Kind::Value, "one")}) {
+    QVERIFY(!MemorySearch::parse(kind, text, 1, QString(), error));
+    QVERIFY(!error.isEmpty());
+  }
+}
+
+void tst_memorysearch::tst_find() {
+  PagedMemory memory;
+  memory.writeMem(0x100, 0xEFBEADDE, 4);
+  // Spans pages 1 and 2.
+  memory.writeMem(2 * s_page - 2, 0xEFBEADDE, 4);
+  memory.writeMem(0x40000000, 0xEFBEADDE, 4);
+  memory.writeMem(0x200000000, 0xEFBEADDE, 4);
+  // Ends in an unallocated page, which is not searched.
+  memory.writeMem(4 * s_page - 2, 0xADDE, 2);
+  const MemorySearch search(memory);
+
+  const auto pattern = parse(MemorySearch::Kind::Bytes, "dead beef");
+  QCOMPARE(findAll(search, pattern),
+           std::vector<AInt>({0x100, 2 * s_page - 2, 0x40000000, 0x200000000}));
+  QCOMPARE(search.findNext(pattern, 0x101),
+           std::optional<AInt>(2 * s_page - 2));
+  QVERIFY(!search.findNext(pattern, 0x200000001));
+  QVERIFY(!search.findNext(parse(MemorySearch::Kind::String, "dead"), 0));
+}
+
+void tst_memorysearch::tst_masked() {
+  PagedMemory memory;
+  for (unsigned i = 0; i < 4; i++)
+    memory.writeMem(0x1000 + 8 * i, 0x1200 + i, 4);
+  const MemorySearch search(memory);
+
+  // Values are compared under their mask.
+  QCOMPARE(findAll(search, parse(MemorySearch::Kind::Value, "0x1201", 4,
+                                 "0xffffff01")),
+           std::vector<AInt>({0x1008, 0x1018}));
+  // Patterns without a byte compared in full are compared at every position.
+  QCOMPARE(findAll(search, parse(MemorySearch::Kind::Bytes, "?3 ?2")),
+           std::vector<AInt>({0x1018}));
+}
+
+void tst_memorysearch::tst_unpaged() {
+  // Memories other than PagedMemory are searched within the given pages.
+  vsrtl::core::AddressSpace memory;
+  memory.writeMem(0x10, 0x6f6c6c6568, 5);
+  memory.writeMem(3 * s_page - 3, 0x6f6c6c6568, 5);
+  memory.writeMem(8 * s_page, 0x6f6c6c6568, 5);
+  const MemorySearch search(memory, {2 * s_page, 0x20, 3 * s_page});
+  QCOMPARE(findAll(search, parse(MemorySearch::Kind::String, "hello")),
+           std::vector<AInt>({0x10, 3 * s_page - 3}));
+}
+
+QTEST_APPLESS_MAIN(tst_memorysearch)
+#include "tst_memorysearch.moc"
@@ -0,0 +1,192 @@
+#include <QTemporaryFile>
+#include <QtTest/QTest>
+
+#include "assembler/assembler.h"
+#include "cli/clirunner.h"
+#include "memoryblock.h"
+#include "processorregistry.h"
+#include "processors/MIPS/mipsiss/mipsiss.h"
+#include "simulationcontext.h"
+
+using namespace Ripes;
+
+// This test ensures that MIPS32 programs assembled through the MIPS ISA
+// description are executed by the MIPS functional model, through the
+// semantics attached to its instructions. MIPS programs are run end-to-end on
+// the registered model, with the system calls of MARS.
+
+class tst_mipsiss : public QObject {
+  Q_OBJECT
+
+private slots:
+  void tst_program();
+  void tst_native();
+  void tst_context();
+  void tst_cli();
+
+private:
+  std::unique_ptr<MIPSISS> load(const QStringList &program);
+  void run(MIPSISS &proc, bool native);
+};
+
+namespace {
+
+// Sums an array, calls a function doubling the sum, and divides and
+// multiplies through hi and lo, exiting through syscall 10.
+const QStringList c_program = {".data",
+                               "arr: .word 3, 4, 5",
+                               "res: .word 0",
+                               ".text",
+                               "la $a0 arr",
+                               "li $t0 3",
+                               "li $t1 0",
+                               "loop:",
+                               "lw $t2 0($a0)",
+                               "addu $t1 $t1 $t2",
+                               "addiu $a0 $a0 4",
+                               "addiu $t0 $t0 -1",
+                               "bnez $t0 loop",
+                               "la $a1 res",
+                               "sw $t1 0($a1)",
+                               "jal twice",
+                               "li $t3 7",
+                               "li $t4 3",
+                               "div $t3 $t4",
+                               "mflo $s0",
+                               "mfhi $s1",
+                               "li $t5 -2",
+                               "mult $t5 $t4",
+                               "mfhi $s2",
+                               "mflo $s3",
+                               "li $v0 10",
+                               "syscall",
+                               "twice:",
+                               "sll $s4 $t1 1",
+                               "jr $ra"};
+
+// Prints 24 and a string through the MARS system calls.
+const QStringList c_printProgram = {".data",
+                                    "msg: .string \"done\\n\"",
+                                    ".text",
+                                    "li $t0 20",
+                                    "addiu $a0 $t0 4",
+                                    "li $v0 1",
+                                    "syscall",
+                                    "li $a0 10",
+                                    "li $v0 11",
+                                    "syscall",
+                                    "la $a0 msg",
+                                    "li $v0 4",
+                                    "syscall",
+                                    "li $v0 10",
+                                    "syscall"};
+const QString c_printOutput = "24\ndone\n";
+
+} // namespace
+
+std::unique_ptr<MIPSISS> tst_mipsiss::load(const QStringList &program) {
+  const auto &isa = ISAInfoRegistry::getISA<ISA::MIPS32I>(QStringList());
+  auto res = Assembler::constructAssemblerDynamic(isa)->assembleRaw(
+      program.join("\n"));
+  if (!res.errors.empty())
+    return nullptr;
+  auto p = std::make_shared<Program>(res.program);
+
+  auto proc = std::make_unique<MIPSISS>(QStringList());
+  const ProgramSection *text = p->getSection(TEXT_SECTION_NAME);
+  const AInt textStart = text->address;
+  const AInt textEnd = textStart + text->data.length();
+  proc->isExecutableAddress = [=](AInt address) {
+    return address >= textStart && address < textEnd;
+  };
+  MIPSISS *procPtr = proc.get();
+  proc->trapHandler = [procPtr] {
+    if (procPtr->getRegister(MIPSISA::GPR, 2) == 10)
+      procPtr->finalize(RipesProcessor::FinalizeReason::exitSyscall);
+  };
+  for (const auto &seg : p->sections)
+    MemoryBlock::addInitializationMemory(proc->getMemory(), seg.second.address,
+                                         seg.second.data.constData(),
+                                         seg.second.data.length(), p);
+  proc->setPCInitialValue(p->entryPoint);
+  proc->resetProcessor();
+  return proc;
+}
+
+void tst_mipsiss::run(MIPSISS &proc, bool native) {
+  proc.setNativeClocking(native);
+  for (unsigned i = 0; i < 1000 && !proc.finished(); i++)
+    proc.clockN(10);
+}
+
+void tst_mipsiss::tst_program() {
+  auto proc = load(c_program);
+  QVERIFY(proc);
+  run(*proc, false);
+  QVERIFY(proc->finished());
+
+  const auto reg = [&](unsigned i) {
+    return proc->getRegister(MIPSISA::GPR, i);
+  };
+  QCOMPARE(reg(9), VInt(12));          // $t1
+  QCOMPARE(reg(20), VInt(24));         // $s4
+  QCOMPARE(reg(16), VInt(2));          // $s0
+  QCOMPARE(reg(17), VInt(1));          // $s1
+  QCOMPARE(reg(18), VInt(0xFFFFFFFF)); // $s2
+  QCOMPARE(reg(19), VInt(0xFFFFFFFA)); // $s3
+  QCOMPARE(reg(0), VInt(0));
+
+  // The sum is stored to res, following the 3 words of arr at the start of
+  // the data segment.
+  QCOMPARE(proc->getMemory().readMemConst(0x1000000C, 4), VInt(12));
+}
+
+void tst_mipsiss::tst_native() {
+  auto clocked = load(c_program);
+  auto native = load(c_program);
+  QVERIFY(clocked && native);
+  run(*clocked, false);
+  run(*native, true);
+  QVERIFY(native->finished());
+  QCOMPARE(native->getCycleCount(), clocked->getCycleCount());
+  QCOMPARE(native->getInstructionsRetired(),
+           clocked->getInstructionsRetired());
+  for (unsigned i = 0; i < 34; i++)
+    QCOMPARE(native->getRegister(MIPSISA::GPR, i),
+             clocked->getRegister(MIPSISA::GPR, i));
+}
+
+void tst_mipsiss::tst_context() {
+  const auto &isa = ISAInfoRegistry::getISA<ISA::MIPS32I>(QStringList());
+  auto res = Assembler::constructAssemblerDynamic(isa)->assembleRaw(
+      c_printProgram.join("\n"));
+  QVERIFY(res.errors.empty());
+
+  SimulationContext context(ProcessorID::MIPS32_ISS);
+  context.loadProgram(std::make_shared<Program>(res.program));
+  QVERIFY(context.run(1000));
+  QVERIFY(context.output().startsWith(c_printOutput));
+  QVERIFY(context.syscallManager().getSyscalls().count(MIPSABI::Exit));
+}
+
+void tst_mipsiss::tst_cli() {
+  QTemporaryFile source;
+  QVERIFY(source.open());
+  source.write(c_printProgram.join("\n").toUtf8());
+  source.flush();
+
+  CLIModeOptions options;
+  options.src = source.fileName();
+  options.srcType = SourceType::Assembly;
+  options.proc = ProcessorID::MIPS32_ISS;
+  options.captureOutput = true;
+  CLIRunner runner(options);
+  QCOMPARE(runner.simulate(), 0);
+  QVERIFY2(runner.output().startsWith(c_printOutput),
+           runner.output().toStdString().c_str());
+  QVERIFY(ProcessorHandler::getProcessor()->finished());
+  QCOMPARE(ProcessorHandler::getRegisterValue(MIPSISA::GPR, 9), VInt(20));
+}
+
+QTEST_MAIN(tst_mipsiss)
+#include "tst_mipsiss.moc"
@@ -0,0 +1,72 @@
+#include <QtTest/QTest>
+
+#include "io/mmiodecoder.h"
+
+#include <algorithm>
+
+using namespace Ripes;
+
+// This test ensures that the MMIO decoder decodes addresses into the same
+// peripherals as a linear search of the mapped regions.
+
+class tst_mmiodecoder : public QObject {
+  Q_OBJECT
+
+private slots:
+  void tst_decode();
+  void tst_runs();
+  void tst_empty();
+};
+
+// The decoder does not access the peripherals, such that any distinct handles
+// suffice.
+static IOBase *handle(uintptr_t id) { return reinterpret_cast<IOBase *>(id); }
+
+static const std::vector<MMIODecoder::Region> s_regions = {
+    // Regions within a single page, spanning pages and following a gap.
+    {0xF0000000, 0xF0000010, handle(1)},
+    {0xF0000010, 0xF0000014, handle(2)},
+    {0xF0000014, 0xF0000DB0, handle(3)},
+    {0xF0001000, 0xF0001001, handle(4)},
+    {0xF0001001, 0xF0001100, handle(5)}};
+
+void tst_mmiodecoder::tst_decode() {
+  MMIODecoder decoder;
+  // Regions are assigned in any order.
+  auto regions = s_regions;
+  std::reverse(regions.begin(), regions.end());
+  decoder.assign(regions);
+
+  for (AInt address = 0xEFFFFF00; address < 0xF0001200; ++address) {
+    IOBase *expected = nullptr;
+    for (const auto &region : s_regions)
+      if (region.start <= address && address < region.end)
+        expected = region.peripheral;
+    const auto *region = decoder.decode(address);
+    QCOMPARE(region ? region->peripheral : nullptr, expected);
+  }
+  QVERIFY(!decoder.decode(0));
+  QVERIFY(!decoder.decode(~AInt(0)));
+}
+
+void tst_mmiodecoder::tst_runs() {
+  MMIODecoder decoder;
+  decoder.assign(s_regions);
+  const std::vector<std::pair<AInt, AInt>> runs = {{0xF0000000, 0xDB0},
+                                                   {0xF0001000, 0x100}};
+  QCOMPARE(decoder.runs(), runs);
+}
+
+void tst_mmiodecoder::tst_empty() {
+  MMIODecoder decoder;
+  decoder.assign(s_regions);
+  // Empty regions are not mapped.
+  decoder.assign({{0x100, 0x100, handle(1)}});
+  QVERIFY(decoder.regions().empty());
+  QVERIFY(decoder.runs().empty());
+  QVERIFY(!decoder.decode(0x100));
+  QVERIFY(!decoder.decode(0xF0000000));
+}
+
+QTEST_MAIN(tst_mmiodecoder)
+#include "tst_mmiodecoder.moc"
@@ -0,0 +1,294 @@
+#include <QtTest/QTest>
+
+#include "processorhandler.h"
+#include "processorregistry.h"
+#include "processors/RISC-V/rvmh/coherence.h"
+#include "programloader.h"
+
+using namespace Ripes;
+
+// This test ensures that the atomic instructions of the A extension are
+// executed correctly, that the harts of the multi-hart processor models
+// synchronize through them, that executing quanta of the harts in parallel
+// does not affect the simulation, and that the coherence traffic of the
+// private caches of the harts is reported.
+
+class tst_multihart : public ProcessorTest {
+  Q_OBJECT
+
+private slots:
+  void tst_atomics();
+  void tst_synchronization();
+  void tst_synchronization_data();
+  void tst_determinism();
+  void tst_determinism_data();
+  void tst_falseSharing();
+  void tst_protocols();
+
+private:
+  static RipesProcessor *load(ProcessorID id, const QStringList &program);
+  static MultiHartProcessor *multiHart(RipesProcessor *proc);
+  static VInt readWord(RipesProcessor *proc, AInt address);
+
+  // Cycle limit of the programs, whose harts synchronize by spinning.
+  static constexpr long long c_maxCycles = 100000;
+};
+
+namespace {
+
+// Increments a counter 100 times per hart through amoadd.
+const QStringList c_amoCounter = {".data",
+                                  "counter: .word 0",
+                                  ".text",
+                                  "la a0 counter",
+                                  "li t0 100",
+                                  "loop:",
+                                  "li t1 1",
+                                  "amoadd.w x0 t1 (a0)",
+                                  "addi t0 t0 -1",
+                                  "bnez t0 loop",
+                                  "nop"};
+
+// Increments a counter 50 times per hart, in a critical section guarded by
+// an LR/SC spinlock.
+const QStringList c_spinlock = {".data",
+                                "counter: .word 0",
+                                "lock: .word 0",
+                                ".text",
+                                "la a0 counter",
+                                "la a1 lock",
+                                "li t0 50",
+                                "loop:",
+                                "lr.w t1 (a1)",
+                                "bnez t1 loop",
+                                "li t2 1",
+                                "sc.w t1 t2 (a1)",
+                                "bnez t1 loop",
+                                "lw t3 0(a0)",
+                                "addi t3 t3 1",
+                                "sw t3 0(a0)",
+                                "sw x0 0(a1)",
+                                "addi t0 t0 -1",
+                                "bnez t0 loop",
+                                "nop"};
+
+// Increments a private counter of each hart 200 times, the counters being
+// @p stride bytes apart.
+QStringList privateCounters(unsigned stride) {
+  return {".data",
+          "counters: .zero 256",
+          ".text",
+          "la a0 counters",
+          "li t0 " + QString::number(stride),
+          "mul t0 t0 tp",
+          "add a0 a0 t0",
+          "li t1 200",
+          "loop:",
+          "lw t2 0(a0)",
+          "addi t2 t2 1",
+          "sw t2 0(a0)",
+          "addi t1 t1 -1",
+          "bnez t1 loop",
+          "nop"};
+}
+
+} // namespace
+
+RipesProcessor *tst_multihart::load(ProcessorID id,
+                                    const QStringList &program) {
+  return ProcessorTest::load(id, program, {"M", "A"});
+}
+
+MultiHartProcessor *tst_multihart::multiHart(RipesProcessor *proc) {
+  return dynamic_cast<MultiHartProcessor *>(proc);
+}
+
+VInt tst_multihart::readWord(RipesProcessor *proc, AInt address) {
+  return proc->getMemory().readMemConst(address, 4) & 0xFFFFFFFF;
+}
+
+void tst_multihart::tst_atomics() {
+  const QStringList program = {".data",
+                               "a: .word 5",
+                               ".text",
+                               "la a0 a",
+                               "li t0 3",
+                               "amoadd.w t1 t0 (a0)",  // t1 = 5, a = 8
+                               "li t0 -1",
+                               "amomin.w t2 t0 (a0)",  // t2 = 8, a = -1
+                               "li t0 4",
+                               "amomaxu.w t3 t0 (a0)", // t3 = -1, a = -1
+                               "amomax.w t4 t0 (a0)",  // t4 = -1, a = 4
+                               "amoswap.w t5 x0 (a0)", // t5 = 4, a = 0
+                               "li t0 0xF0",
+                               "amoor.w x0 t0 (a0)", // a = 0xF0
+                               "li t0 0x3C",
+                               "amoxor.w x0 t0 (a0)",  // a = 0xCC
+                               "amoand.w s2 t0 (a0)",  // s2 = 0xCC, a = 0x0C
+                               "amominu.w s3 t0 (a0)", // s3 = 0x0C, a = 0x0C
+                               "lr.w s4 (a0)",         // s4 = 0x0C
+                               "sc.w s5 t0 (a0)",      // s5 = 0, a = 0x3C
+                               "sc.w s6 x0 (a0)",      // s6 = 1
+                               "lw s7 0(a0)",          // s7 = 0x3C
+                               "nop"};
+  // The out-of-order model executes atomics through the functional model, as
+  // all other instructions.
+  for (auto id : {ProcessorID::RV32_ISS, ProcessorID::RV32_OOO_2W}) {
+    auto *proc = load(id, program);
+    QVERIFY(proc);
+    runToFinish(proc, c_maxCycles);
+    QVERIFY(proc->finished());
+    const auto reg = [&](unsigned i) {
+      return proc->getRegister(RVISA::GPR, i);
+    };
+    QCOMPARE(reg(6), VInt(5));           // t1
+    QCOMPARE(reg(7), VInt(8));           // t2
+    QCOMPARE(reg(28), VInt(0xFFFFFFFF)); // t3
+    QCOMPARE(reg(29), VInt(0xFFFFFFFF)); // t4
+    QCOMPARE(reg(30), VInt(4));          // t5
+    QCOMPARE(reg(18), VInt(0xCC));       // s2
+    QCOMPARE(reg(19), VInt(0x0C));       // s3
+    QCOMPARE(reg(20), VInt(0x0C));       // s4
+    QCOMPARE(reg(21), VInt(0));          // s5
+    QCOMPARE(reg(22), VInt(1));          // s6
+    QCOMPARE(reg(23), VInt(0x3C));       // s7
+  }
+}
+
+void tst_multihart::tst_synchronization_data() {
+  QTest::addColumn<int>("id");
+  QTest::addColumn<QStringList>("program");
+  QTest::addColumn<unsigned>("perHart");
+  QTest::newRow("amoadd 2 harts")
+      << int(ProcessorID::RV32_MH_2) << c_amoCounter << 100u;
+  QTest::newRow("amoadd 4 harts")
+      << int(ProcessorID::RV32_MH_4) << c_amoCounter << 100u;
+  QTest::newRow("spinlock 4 harts")
+      << int(ProcessorID::RV32_MH_4) << c_spinlock << 50u;
+  QTest::newRow("spinlock 4 harts RV64")
+      << int(ProcessorID::RV64_MH_4) << c_spinlock << 50u;
+}
+
+void tst_multihart::tst_synchronization() {
+  QFETCH(int, id);
+  QFETCH(QStringList, program);
+  QFETCH(unsigned, perHart);
+  auto *proc = load(ProcessorID(id), program);
+  QVERIFY(proc);
+  auto *mh = multiHart(proc);
+  QVERIFY(mh);
+  runToFinish(proc, c_maxCycles);
+  QVERIFY(proc->finished());
+  // The registers shown are those of hart 0, which holds the address of the
+  // counter in a0.
+  const AInt counter = proc->getRegister(RVISA::GPR, 10);
+  QCOMPARE(readWord(proc, counter), VInt(perHart * mh->numHarts()));
+}
+
+void tst_multihart::tst_determinism_data() {
+  QTest::addColumn<QStringList>("program");
+  QTest::newRow("amoadd") << c_amoCounter;
+  QTest::newRow("spinlock") << c_spinlock;
+  QTest::newRow("false sharing") << privateCounters(4);
+  QTest::newRow("private") << privateCounters(64);
+}
+
+void tst_multihart::tst_determinism() {
+  QFETCH(QStringList, program);
+  struct Result {
+    long long cycles;
+    long long retired;
+    std::vector<VInt> regs;
+    std::vector<VInt> memory;
+    CoherenceSim::Stats stats;
+  };
+  const auto run = [&](unsigned quantum) {
+    auto *proc = load(ProcessorID::RV32_MH_4, program);
+    auto *mh = multiHart(proc);
+    mh->setQuantum(quantum);
+    // Cycles are batched, such that the harts may run ahead in parallel.
+    while (!proc->finished() && proc->getCycleCount() < 100000)
+      proc->clockN(1000);
+    Result result;
+    result.cycles = proc->getCycleCount();
+    result.retired = proc->getInstructionsRetired();
+    for (unsigned i = 0; i < 32; ++i)
+      result.regs.push_back(proc->getRegister(RVISA::GPR, i));
+    const AInt data = proc->getRegister(RVISA::GPR, 10) & ~AInt(0xFF);
+    for (unsigned i = 0; i < 256; i += 4)
+      result.memory.push_back(readWord(proc, data + i));
+    result.stats = mh->coherence().totals();
+    return result;
+  };
+
+  const Result serial = run(0);
+  const Result parallel = run(64);
+  QCOMPARE(parallel.cycles, serial.cycles);
+  QCOMPARE(parallel.retired, serial.retired);
+  QVERIFY(parallel.regs == serial.regs);
+  QVERIFY(parallel.memory == serial.memory);
+  QCOMPARE(parallel.stats.reads, serial.stats.reads);
+  QCOMPARE(parallel.stats.writes, serial.stats.writes);
+  QCOMPARE(parallel.stats.misses, serial.stats.misses);
+  QCOMPARE(parallel.stats.invalidations, serial.stats.invalidations);
+  QCOMPARE(parallel.stats.falseSharing, serial.stats.falseSharing);
+}
+
+void tst_multihart::tst_falseSharing() {
+  // Counters in the same cache line are invalidated back and forth, although
+  // the harts do not share any data...
+  auto *proc = load(ProcessorID::RV32_MH_4, privateCounters(4));
+  QVERIFY(proc);
+  runToFinish(proc, c_maxCycles);
+  QVERIFY(proc->finished());
+  auto stats = multiHart(proc)->coherence().totals();
+  QCOMPARE(stats.writes, 800LL);
+  QVERIFY(stats.invalidations > 0);
+  QCOMPARE(stats.falseSharing, stats.invalidations);
+  const AInt counters = proc->getRegister(RVISA::GPR, 10);
+  for (unsigned hart = 0; hart < 4; ++hart)
+    QCOMPARE(readWord(proc, counters + hart * 4), VInt(200));
+
+  // ... whereas padded counters stay in the caches of their harts.
+  proc = load(ProcessorID::RV32_MH_4, privateCounters(64));
+  QVERIFY(proc);
+  runToFinish(proc, c_maxCycles);
+  QVERIFY(proc->finished());
+  stats = multiHart(proc)->coherence().totals();
+  QCOMPARE(stats.invalidations, 0LL);
+  QCOMPARE(stats.misses, 4LL);
+
+  // Truly shared data is not reported as false sharing.
+  proc = load(ProcessorID::RV32_MH_4, c_amoCounter);
+  QVERIFY(proc);
+  runToFinish(proc, c_maxCycles);
+  stats = multiHart(proc)->coherence().totals();
+  QVERIFY(stats.invalidations > 0);
+  QCOMPARE(stats.falseSharing, 0LL);
+}
+
+void tst_multihart::tst_protocols() {
+  // Writes to private data read beforehand upgrade the line under MSI, but
+  // not under MESI, in which the line was filled as Exclusive.
+  for (const auto protocol :
+       {CoherenceProtocol::MSI, CoherenceProtocol::MESI}) {
+    auto *proc = load(ProcessorID::RV32_MH_2, privateCounters(64));
+    QVERIFY(proc);
+    CoherenceSim::Config config;
+    config.protocol = protocol;
+    multiHart(proc)->setCoherenceConfig(config);
+    runToFinish(proc, c_maxCycles);
+    QVERIFY(proc->finished());
+    const auto &coherence = multiHart(proc)->coherence();
+    const long long upgrades = protocol == CoherenceProtocol::MSI ? 1 : 0;
+    for (unsigned hart = 0; hart < 2; ++hart) {
+      QCOMPARE(coherence.stats(hart).misses, 1LL);
+      QCOMPARE(coherence.stats(hart).upgrades, upgrades);
+    }
+    const AInt counter = proc->getRegister(RVISA::GPR, 10);
+    QVERIFY(coherence.state(0, counter) == CoherenceSim::State::Modified);
+  }
+}
+
+QTEST_MAIN(tst_multihart)
+#include "tst_multihart.moc"
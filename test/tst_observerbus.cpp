@@ -0,0 +1,124 @@
+#include <QtTest/QTest>
+
+#include "processorhandler.h"
+#include "processorregistry.h"
+
+using namespace Ripes;
+
+// This test ensures that observers only receive the kinds of events which they
+// subscribed to, and that every processor publishes the retired instructions,
+// register writes, memory accesses and system calls of a program.
+
+class tst_observerbus : public QObject {
+  Q_OBJECT
+
+private slots:
+  void tst_subscriptions();
+  void tst_processor();
+  void tst_processor_data();
+};
+
+namespace {
+struct A {
+  int value;
+};
+struct B {
+  int value;
+};
+} // namespace
+
+// Stores to and loads from the data segment, and prints an integer.
+static const QString s_program =
+    QStringList{".data",   "x: .word 0",  ".text",       "la t0 x",
+                "li t1 7", "sw t1 0(t0)", "lw t2 0(t0)", "li a7 1",
+                "li a0 3", "ecall"}
+        .join("\n");
+
+void tst_observerbus::tst_subscriptions() {
+  ObserverBus<A, B> bus;
+  QCOMPARE(bus.kinds(), 0u);
+  QVERIFY(bus.kind<A>() != bus.kind<B>());
+
+  int sumA = 0, sumB = 0;
+  int first = 0, second = 0;
+  bus.subscribe<A>(&first, [&](const A &event) { sumA += event.value; });
+  bus.subscribe<B>(&first, [&](const B &event) { sumB += event.value; });
+  bus.subscribe<A>(&second, [&](const A &event) { sumA += 10 * event.value; });
+  QCOMPARE(bus.kinds(), bus.kind<A>() | bus.kind<B>());
+  bus.publish(A{1});
+  QCOMPARE(sumA, 11);
+  QCOMPARE(sumB, 0);
+
+  // Subscribing again replaces the subscription of the owner.
+  bus.subscribe<A>(&second, [&](const A &event) { sumA += 100 * event.value; });
+  bus.publish(A{1});
+  QCOMPARE(sumA, 112);
+
+  bus.unsubscribe<B>(&first);
+  QVERIFY(!bus.subscribed<B>());
+  bus.publish(B{1});
+  QCOMPARE(sumB, 0);
+
+  bus.unsubscribe(&second);
+  QVERIFY(bus.subscribed<A>());
+  bus.publish(A{1});
+  QCOMPARE(sumA, 113);
+
+  bus.clear();
+  QCOMPARE(bus.kinds(), 0u);
+}
+
+void tst_observerbus::tst_processor_data() {
+  QTest::addColumn<int>("id");
+  // The program is RISC-V assembly.
+  for (int id = 0; id < ProcessorID::NUM_PROCESSORS; ++id)
+    if (ProcessorRegistry::isaFamily(ProcessorID(id)) == "RISC-V")
+      QTest::addRow("processor %d", id) << id;
+}
+
+void tst_observerbus::tst_processor() {
+  QFETCH(int, id);
+  ProcessorHandler::selectProcessor(ProcessorID(id), {"M"});
+  auto res = ProcessorHandler::getAssembler()->assembleRaw(s_program);
+  QVERIFY(res.errors.empty());
+  ProcessorHandler::loadProgram(std::make_shared<Program>(res.program));
+  auto *proc = ProcessorHandler::getProcessorNonConst();
+
+  unsigned retired = 0, reads = 0, writes = 0, syscalls = 0;
+  bool wroteT1 = false;
+  auto &observers = proc->observers();
+  observers.subscribe<ProcessorEvent::Retire>(
+      this, [&](const ProcessorEvent::Retire &) { retired++; });
+  observers.subscribe<ProcessorEvent::DataAccess>(
+      this, [&](const ProcessorEvent::DataAccess &event) {
+        if (event.access.type == MemoryAccess::Read)
+          reads++;
+        else if (event.access.type == MemoryAccess::Write)
+          writes++;
+      });
+  observers.subscribe<ProcessorEvent::RegisterWrite>(
+      this, [&](const ProcessorEvent::RegisterWrite &event) {
+        if (event.rfid == RVISA::GPR && event.index == 6 && event.value == 7)
+          wroteT1 = true;
+      });
+  observers.subscribe<ProcessorEvent::Syscall>(
+      this, [&](const ProcessorEvent::Syscall &event) {
+        QCOMPARE(event.function, 1u);
+        syscalls++;
+      });
+
+  while (!proc->finished() && proc->getCycleCount() < 200)
+    proc->clockN(16);
+  observers.unsubscribe(this);
+  QVERIFY(proc->finished());
+
+  // la expands to two instructions.
+  QCOMPARE(retired, 8u);
+  QCOMPARE(reads, 1u);
+  QCOMPARE(writes, 1u);
+  QCOMPARE(syscalls, 1u);
+  QVERIFY(wroteT1);
+}
+
+QTEST_MAIN(tst_observerbus)
+#include "tst_observerbus.moc"
@@ -0,0 +1,145 @@
+#include <QtTest/QTest>
+
+#include "processorhandler.h"
+#include "processorregistry.h"
+#include "programloader.h"
+
+using namespace Ripes;
+
+// This test ensures that the out-of-order processor models exploit the
+// instruction-level parallelism of independent instructions, that their
+// committed state matches the functional model, and that performance counters
+// are maintained.
+
+class tst_outoforder : public ProcessorTest {
+  Q_OBJECT
+
+private slots:
+  void tst_parallelism();
+  void tst_parallelism_data();
+  void tst_state();
+  void tst_counters();
+};
+
+void tst_outoforder::tst_parallelism_data() {
+  QTest::addColumn<int>("id");
+  QTest::addColumn<double>("minIPC");
+  QTest::newRow("2-wide") << int(ProcessorID::RV32_OOO_2W) << 1.5;
+  QTest::newRow("4-wide") << int(ProcessorID::RV32_OOO_4W) << 2.5;
+}
+
+void tst_outoforder::tst_parallelism() {
+  QFETCH(int, id);
+  QFETCH(double, minIPC);
+  const auto ipc = [](RipesProcessor *proc) {
+    return static_cast<double>(proc->getInstructionsRetired()) /
+           proc->getCycleCount();
+  };
+
+  // Independent instructions are issued in parallel...
+  QStringList independent = {".text"};
+  for (unsigned i = 0; i < 200; ++i)
+    independent << "addi x" + QString::number(5 + i % 4) + " x0 1";
+  auto *proc = load(ProcessorID(id), independent);
+  QVERIFY(proc);
+  runToFinish(proc);
+  QVERIFY(proc->finished());
+  QCOMPARE(proc->getInstructionsRetired(), 200LL);
+  QVERIFY(ipc(proc) > minIPC);
+
+  // ... whereas a chain of dependent instructions is serialized.
+  QStringList dependent = {".text"};
+  for (unsigned i = 0; i < 200; ++i)
+    dependent << "addi x5 x5 1";
+  proc = load(ProcessorID(id), dependent);
+  QVERIFY(proc);
+  runToFinish(proc);
+  QVERIFY(proc->finished());
+  QVERIFY(ipc(proc) <= 1);
+  QCOMPARE(proc->getRegister(RVISA::GPR, 5), VInt(200));
+}
+
+void tst_outoforder::tst_state() {
+  // Stores are forwarded to younger loads, and long-latency instructions
+  // complete out of order.
+  const QStringList program = {".data",
+                               "a: .zero 16",
+                               ".text",
+                               "la a0 a",
+                               "li s0 100",
+                               "li s1 7",
+                               "loop:",
+                               "div t0 s0 s1",
+                               "sw s0 0(a0)",
+                               "lw t1 0(a0)",
+                               "mul t2 t1 s1",
+                               "add t3 t2 t0",
+                               "sw t3 4(a0)",
+                               "addi s0 s0 -1",
+                               "bnez s0 loop",
+                               "lw t4 4(a0)",
+                               "nop"};
+  const auto registers = [](RipesProcessor *proc) {
+    std::vector<VInt> regs;
+    for (unsigned i = 0; i < 32; ++i)
+      regs.push_back(proc->getRegister(RVISA::GPR, i));
+    return regs;
+  };
+
+  auto *proc = load(ProcessorID::RV32_ISS, program);
+  QVERIFY(proc);
+  runToFinish(proc);
+  QVERIFY(proc->finished());
+  const auto expected = registers(proc);
+  const long long retired = proc->getInstructionsRetired();
+
+  for (auto id : {ProcessorID::RV32_OOO_2W, ProcessorID::RV32_OOO_4W}) {
+    proc = load(id, program);
+    QVERIFY(proc);
+    runToFinish(proc);
+    QVERIFY(proc->finished());
+    QCOMPARE(proc->getInstructionsRetired(), retired);
+    QVERIFY(registers(proc) == expected);
+  }
+}
+
+void tst_outoforder::tst_counters() {
+  // Sums 1 (loaded from memory) until reaching 4.
+  const QStringList program = {".data",
+                               "a: .word 1",
+                               ".text",
+                               "la a0 a",
+                               "li s0 0",
+                               "li s1 4",
+                               "loop:",
+                               "lw t0 0(a0)",
+                               "add s0 s0 t0",
+                               "blt s0 s1 loop",
+                               "nop"};
+  auto *proc = load(ProcessorID::RV32_OOO_2W, program);
+  QVERIFY(proc);
+  ProcessorHandler::setPerformanceCounting(true);
+  QVERIFY(proc->features() & RipesProcessor::hasPerformanceCounters);
+  QVERIFY(!(proc->features() & RipesProcessor::isReversible));
+  runToFinish(proc);
+  QVERIFY(proc->finished());
+
+  const auto &counters = proc->performanceCounters();
+  QCOMPARE(counters.branches, 4LL);
+  QCOMPARE(counters.branchesTaken, 3LL);
+  // The first iteration misses the branch target buffer, after which the loop
+  // is predicted as taken, mispredicting only its exit.
+  QCOMPARE(counters.mispredicts, 2LL);
+  QVERIFY(counters.loadUseHazards > 0);
+  QVERIFY(counters.loadUseHazards <= counters.dataHazards);
+  QVERIFY(counters.forwards > 0);
+  QVERIFY(counters.dualIssueCycles <= counters.issueCycles);
+
+  // The pipeline stages are reported per lane, oldest instruction first.
+  QCOMPARE(proc->structure().size(), size_t(2));
+  QCOMPARE(proc->structure().numStages(), 12u);
+  QCOMPARE(proc->stageName({0, 2}), QString("IQ"));
+}
+
+QTEST_MAIN(tst_outoforder)
+#include "tst_outoforder.moc"
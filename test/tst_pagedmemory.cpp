@@ -0,0 +1,272 @@
+#include <QDir>
+#include <QtTest/QTest>
+
+#include "cli/programutilities.h"
+#include "elfio/elfio.hpp"
+#include "isa/rv32isainfo.h"
+#include "memoryblock.h"
+#include "pagedmemory.h"
+#include "processorhandler.h"
+#include "processorregistry.h"
+
+using namespace Ripes;
+
+// This test ensures that the paged memory backend behaves as a sparse byte
+// addressable memory, and that programs are loaded into it.
+
+class tst_pagedmemory : public QObject {
+  Q_OBJECT
+
+private slots:
+  void tst_lazyAllocation();
+  void tst_pageBoundaries();
+  void tst_highAddresses();
+  void tst_initialization();
+  void tst_sharedPages();
+  void tst_image();
+  void tst_loadProgram();
+  void tst_mappedElf();
+  void tst_codeWrites();
+  void tst_selfModifyingCode();
+};
+
+static constexpr AInt s_page = PagedMemory::s_pageSize;
+
+void tst_pagedmemory::tst_lazyAllocation() {
+  PagedMemory memory;
+  // Untouched memory reads as zero without allocating pages.
+  QCOMPARE(memory.readMemConst(0x1234, 4), VInt(0));
+  QVERIFY(!memory.contains(0x1234));
+  QCOMPARE(memory.allocatedPages(), size_t(0));
+
+  memory.writeMem(0x1234, 0xDEADBEEF, 4);
+  QCOMPARE(memory.allocatedPages(), size_t(1));
+  QCOMPARE(memory.readMem(0x1234, 4), VInt(0xDEADBEEF));
+  QCOMPARE(memory.readMemConst(0x1235, 2), VInt(0xADBE));
+  // Only the bytes written are contained, although the page is allocated.
+  QVERIFY(memory.contains(0x1237));
+  QVERIFY(!memory.contains(0x1238));
+  QCOMPARE(memory.readMemConst(0x1238, 4), VInt(0));
+
+  memory.reset();
+  QCOMPARE(memory.allocatedPages(), size_t(0));
+  QCOMPARE(memory.readMemConst(0x1234, 4), VInt(0));
+}
+
+void tst_pagedmemory::tst_pageBoundaries() {
+  PagedMemory memory;
+  // Accesses spanning two pages access the bytes of both.
+  memory.writeMem(3 * s_page - 2, 0x0807060504030201, 8);
+  QCOMPARE(memory.allocatedPages(), size_t(2));
+  QCOMPARE(memory.readMemConst(3 * s_page - 2, 8), VInt(0x0807060504030201));
+  QCOMPARE(memory.readMemConst(3 * s_page, 2), VInt(0x0403));
+  // A read spanning into an unallocated page reads zeros from it.
+  memory.writeMem(5 * s_page - 1, 0xFF, 1);
+  QCOMPARE(memory.readMemConst(5 * s_page - 1, 4), VInt(0xFF));
+
+  // Accesses to pages evicted from the TLB find them in the page table.
+  for (AInt i = 0; i < 16; ++i)
+    memory.writeMem(0x100000 + i * s_page, i, 4);
+  for (AInt i = 0; i < 16; ++i)
+    QCOMPARE(memory.readMemConst(0x100000 + i * s_page, 4), i);
+}
+
+void tst_pagedmemory::tst_highAddresses() {
+  PagedMemory memory;
+  const AInt high = 0x123456789000;
+  memory.writeMem(high + 4, 0xCAFEBABE12345678, 8);
+  memory.writeMem(high & 0xFFFFFFFF, 0x11, 1);
+  QCOMPARE(memory.allocatedPages(), size_t(2));
+  QCOMPARE(memory.readMemConst(high + 4, 8), VInt(0xCAFEBABE12345678));
+  QCOMPARE(memory.readMemConst(high & 0xFFFFFFFF, 1), VInt(0x11));
+  QCOMPARE(memory.readMemConst(high, 4), VInt(0));
+}
+
+void tst_pagedmemory::tst_initialization() {
+  PagedMemory memory;
+  QByteArray data(3 * s_page + 100, '\0');
+  for (int i = 0; i < data.size(); ++i)
+    data[i] = static_cast<char>(i * 7 + 3);
+  const AInt base = 0x10000000 - 50;
+  MemoryBlock::addInitializationMemory(memory, base, data.constData(),
+                                       data.size());
+  // Initialization memories are loaded upon reset.
+  QVERIFY(!memory.contains(base));
+  memory.reset();
+  QCOMPARE(memory.allocatedPages(), size_t(5));
+  for (int i = 0; i < data.size(); ++i)
+    QCOMPARE(static_cast<char>(memory.readMemConst(base + i, 1)), data.at(i));
+  QVERIFY(!memory.contains(base - 1));
+  QVERIFY(!memory.contains(base + data.size()));
+
+  // Writes are discarded by a reset, which restores the initialization.
+  memory.writeMem(base, 0, 4);
+  memory.writeMem(0x20000000, 1, 4);
+  memory.reset();
+  QCOMPARE(static_cast<char>(memory.readMemConst(base, 1)), data.at(0));
+  QVERIFY(!memory.contains(0x20000000));
+
+  MemoryBlock::clearInitializationMemories(memory);
+  memory.reset();
+  QCOMPARE(memory.allocatedPages(), size_t(0));
+}
+
+void tst_pagedmemory::tst_sharedPages() {
+  PagedMemory memory;
+  auto data = std::make_shared<QByteArray>(2 * s_page + 8, '\x5A');
+  const AInt base = 0x10000000;
+  MemoryBlock::addInitializationMemory(memory, base, data->constData(),
+                                       data->size(), data);
+  memory.reset();
+  // The fully covered pages reference the initialization memory...
+  QCOMPARE(memory.allocatedPages(), size_t(3));
+  QCOMPARE(memory.sharedPages(), size_t(2));
+  QCOMPARE(memory.readMemConst(base + s_page, 4), VInt(0x5A5A5A5A));
+
+  // ... until written, which copies the page and leaves the initialization
+  // memory untouched.
+  memory.writeMem(base + s_page + 4, 0, 4);
+  QCOMPARE(memory.sharedPages(), size_t(1));
+  QCOMPARE(memory.readMemConst(base + s_page, 8), VInt(0x5A5A5A5A));
+  QCOMPARE(data->at(s_page + 4), '\x5A');
+  memory.reset();
+  QCOMPARE(memory.sharedPages(), size_t(2));
+  QCOMPARE(memory.readMemConst(base + s_page + 4, 4), VInt(0x5A5A5A5A));
+}
+
+void tst_pagedmemory::tst_image() {
+  PagedMemory memory;
+  auto data = std::make_shared<QByteArray>(s_page + 16, '\x33');
+  const AInt base = 0x10000000;
+  MemoryBlock::addInitializationMemory(memory, base, data->constData(),
+                                       data->size(), data);
+  memory.reset();
+  QCOMPARE(memory.allocatedPages(), size_t(2));
+
+  // Resets restore the written pages of the image, and free all others.
+  memory.writeMem(base, 0, 4);
+  memory.writeMem(base + s_page + 8, 0, 8);
+  memory.writeMem(0x20000000, 1, 4);
+  memory.writeMem(0x123456789000, 1, 4);
+  QCOMPARE(memory.allocatedPages(), size_t(4));
+  memory.reset();
+  QCOMPARE(memory.allocatedPages(), size_t(2));
+  QCOMPARE(memory.sharedPages(), size_t(1));
+  QCOMPARE(memory.readMemConst(base, 4), VInt(0x33333333));
+  QCOMPARE(memory.readMemConst(base + s_page + 8, 8),
+           VInt(0x3333333333333333));
+  QVERIFY(!memory.contains(base + s_page + 16));
+  QVERIFY(!memory.contains(0x20000000));
+  QVERIFY(!memory.contains(0x123456789000));
+  QCOMPARE(memory.allocatedPageAddresses(),
+           std::vector<AInt>({base, base + s_page}));
+
+  // Adding the same initialization memories again keeps the image, whereas
+  // other initialization memories rebuild it.
+  MemoryBlock::clearInitializationMemories(memory);
+  MemoryBlock::addInitializationMemory(memory, base, data->constData(),
+                                       data->size(), data);
+  memory.reset();
+  QCOMPARE(memory.pageBytes(base),
+           reinterpret_cast<const uint8_t *>(data->constData()));
+  const QByteArray other(8, '\x44');
+  MemoryBlock::clearInitializationMemories(memory);
+  MemoryBlock::addInitializationMemory(memory, base + 4, other.constData(),
+                                       other.size());
+  memory.reset();
+  QCOMPARE(memory.allocatedPages(), size_t(1));
+  QCOMPARE(memory.readMemConst(base, 8), VInt(0x4444444400000000));
+}
+
+void tst_pagedmemory::tst_loadProgram() {
+  // The ISS keeps its memory in pages, and runs programs loaded into them.
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_ISS, {"M"});
+  QVERIFY(dynamic_cast<PagedMemory *>(&ProcessorHandler::getMemory()));
+  const QStringList program = {
+      ".data",          "values: .word 1, 2, 3, 4",
+      ".text",          "la a0, values",
+      "lw t0, 0(a0)",   "lw t1, 12(a0)",
+      "add t2, t0, t1", "sw t2, 4(a0)"};
+  auto res = ProcessorHandler::getAssembler()->assembleRaw(program.join("\n"));
+  QVERIFY(res.errors.empty());
+  ProcessorHandler::loadProgram(std::make_shared<Program>(res.program));
+  const AInt values = res.program.getSection(".data")->address;
+  auto *proc = ProcessorHandler::getProcessorNonConst();
+  while (!proc->finished() && proc->getCycleCount() < 100)
+    proc->clock();
+  QVERIFY(proc->finished());
+  auto &memory = ProcessorHandler::getMemory();
+  QCOMPARE(memory.readMemConst(values + 4, 4), VInt(5));
+  QCOMPARE(memory.readMemConst(values + 8, 4), VInt(3));
+}
+
+void tst_pagedmemory::tst_mappedElf() {
+  // The sections of a loaded ELF file reference the mapped file, and hold the
+  // contents of the sections.
+  const QString path = QString(RISCV32_TEST_DIR) + QDir::separator() +
+                       "../../examples/ELF/RanPi-RV32";
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_ISS, {"M"});
+  Program program;
+  QCOMPARE(loadElfFile(program, path), QString());
+  QVERIFY(program.backing);
+
+  ELFIO::elfio reader;
+  QVERIFY(reader.load(path.toStdString()));
+  const auto *elfText = reader.sections[".text"];
+  QVERIFY(elfText);
+  const auto *text = program.getSection(".text");
+  QVERIFY(text);
+  QCOMPARE(text->address, AInt(elfText->get_address()));
+  QCOMPARE(text->data, QByteArray(elfText->get_data(),
+                                  static_cast<int>(elfText->get_size())));
+}
+
+void tst_pagedmemory::tst_codeWrites() {
+  PagedMemory memory;
+  // Unallocated memory cannot be marked as code.
+  QVERIFY(!memory.markCode(0x1000, 4));
+  memory.writeMem(0x1000, 0x13, 4);
+  const auto writes = memory.codeWrites();
+  QVERIFY(memory.markCode(0x1000, 4));
+
+  // Writing data next to the code is not a write to the code.
+  memory.writeMem(0x1004, 0xFF, 4);
+  QCOMPARE(memory.codeWrites(), writes);
+  memory.writeMem(0x1003, 0x0, 1);
+  QCOMPARE(memory.codeWrites(), writes + 1);
+  // The code is unmarked by the write.
+  memory.writeMem(0x1000, 0x0, 4);
+  QCOMPARE(memory.codeWrites(), writes + 1);
+
+  QVERIFY(memory.markCode(0x1000, 4));
+  memory.reset();
+  QCOMPARE(memory.codeWrites(), writes + 2);
+}
+
+void tst_pagedmemory::tst_selfModifyingCode() {
+  // The ISS executes the instruction stored over a previously executed (and
+  // thereby translated) instruction of the loop.
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_ISS, {"M"});
+  const QStringList program = {".text",
+                               "la t0, target",
+                               "li t1, 0x00100513", // addi a0, zero, 1
+                               "li s0, 0",
+                               "li t2, 0",
+                               "li t3, 3",
+                               "target: addi a0, zero, 0",
+                               "add s0, s0, a0",
+                               "sw t1, 0(t0)",
+                               "addi t2, t2, 1",
+                               "blt t2, t3, target"};
+  auto res = ProcessorHandler::getAssembler()->assembleRaw(program.join("\n"));
+  QVERIFY(res.errors.empty());
+  ProcessorHandler::loadProgram(std::make_shared<Program>(res.program));
+  auto *proc = ProcessorHandler::getProcessorNonConst();
+  while (!proc->finished() && proc->getCycleCount() < 100)
+    proc->clock();
+  QVERIFY(proc->finished());
+  QCOMPARE(proc->getRegister(RVISA::GPR, 8), VInt(2));
+}
+
+QTEST_MAIN(tst_pagedmemory)
+#include "tst_pagedmemory.moc"
@@ -0,0 +1,316 @@
+#include <QtTest/QTest>
+
+#include "processorhandler.h"
+#include "processorregistry.h"
+#include "processors/RISC-V/rv_targetpredictor.h"
+#include "programloader.h"
+
+using namespace Ripes;
+
+// This test ensures that the performance counters of the processor models
+// count the events of a program with known hazards and branches, and that
+// counting is undone when reversing the processor.
+
+class tst_perfcounters : public ProcessorTest {
+  Q_OBJECT
+
+private slots:
+  void tst_rv5s();
+  void tst_dualIssue();
+  void tst_pairing();
+  void tst_pairing_data();
+  void tst_branchPrediction();
+  void tst_branchPrediction_data();
+  void tst_targetPrediction();
+  void tst_targetPrediction_data();
+  void tst_reverse();
+  void tst_disabled();
+
+private:
+  static RipesProcessor *load(ProcessorID id);
+  static RipesProcessor *load(ProcessorID id, const QStringList &program);
+};
+
+// Sums 1 (loaded from memory) until reaching 4, such that each of the 4
+// iterations incurs a load-use hazard and executes a branch, which is taken
+// in all but the last iteration.
+static const QStringList s_program = {".data",
+                                      "a: .word 1",
+                                      ".text",
+                                      "la a0 a",
+                                      "li s0 0",
+                                      "li s1 4",
+                                      "loop:",
+                                      "lw t0 0(a0)",
+                                      "add s0 s0 t0",
+                                      "blt s0 s1 loop",
+                                      "nop"};
+
+RipesProcessor *tst_perfcounters::load(ProcessorID id) {
+  return load(id, s_program);
+}
+
+RipesProcessor *tst_perfcounters::load(ProcessorID id,
+                                       const QStringList &program) {
+  // Counting is enabled for the processor selected by the load.
+  ProcessorHandler::setPerformanceCounting(true);
+  return ProcessorTest::load(id, program);
+}
+
+void tst_perfcounters::tst_rv5s() {
+  auto *proc = load(ProcessorID::RV32_5S);
+  QVERIFY(proc);
+  QVERIFY(proc->features() & RipesProcessor::hasPerformanceCounters);
+  runToFinish(proc);
+  QVERIFY(proc->finished());
+
+  const auto &counters = proc->performanceCounters();
+  QCOMPARE(counters.loadUseHazards, 4LL);
+  QCOMPARE(counters.dataHazards, 4LL);
+  QCOMPARE(counters.branches, 4LL);
+  QCOMPARE(counters.branchesTaken, 3LL);
+  QCOMPARE(counters.mispredicts, 3LL);
+  QVERIFY(counters.forwards > 0);
+  // Each load-use hazard inserts a bubble into the EX stage.
+  QCOMPARE(counters.stages.at({0, 2}).stalled, 4LL);
+  QCOMPARE(counters.issueCycles, 0LL);
+}
+
+void tst_perfcounters::tst_dualIssue() {
+  auto *proc = load(ProcessorID::RV32_6S_DUAL);
+  QVERIFY(proc);
+  runToFinish(proc);
+  QVERIFY(proc->finished());
+
+  const auto &counters = proc->performanceCounters();
+  QCOMPARE(counters.branches, 4LL);
+  QCOMPARE(counters.branchesTaken, 3LL);
+  QVERIFY(counters.issueCycles > 0);
+  QVERIFY(counters.dualIssueCycles > 0);
+  QVERIFY(counters.dualIssueCycles <= counters.issueCycles);
+}
+
+void tst_perfcounters::tst_pairing_data() {
+  QTest::addColumn<QStringList>("pair");
+  QTest::addColumn<bool>("dataWayArithmetic");
+  QTest::addColumn<bool>("pairControlflow");
+  QTest::addColumn<long long>("dependence");
+  QTest::addColumn<long long>("policy");
+  const QStringList arithmetic = {"addi x5 x0 1", "addi x6 x0 2"};
+  const QStringList branch = {"addi x5 x0 1", "bne x0 x0 end"};
+  QTest::newRow("arithmetic") << arithmetic << true << true << 0LL << 0LL;
+  QTest::newRow("arithmetic, memonly")
+      << arithmetic << false << true << 0LL << 4LL;
+  QTest::newRow("dependent") << QStringList{"addi x5 x0 1", "addi x6 x5 1"}
+                             << true << true << 4LL << 0LL;
+  QTest::newRow("branch") << branch << true << true << 0LL << 0LL;
+  QTest::newRow("branch, branchalone")
+      << branch << true << false << 0LL << 4LL;
+  QTest::newRow("load, memonly")
+      << QStringList{"lw x5 0(sp)", "addi x6 x0 2"} << false << false << 0LL
+      << 0LL;
+}
+
+void tst_perfcounters::tst_pairing() {
+  QFETCH(QStringList, pair);
+  QFETCH(bool, dataWayArithmetic);
+  QFETCH(bool, pairControlflow);
+  QFETCH(long long, dependence);
+  QFETCH(long long, policy);
+  QStringList program = {".text"};
+  for (int i = 0; i < 4; ++i)
+    program << pair;
+  program << "end:" << "nop";
+
+  auto *proc = load(ProcessorID::RV32_6S_DUAL, program);
+  QVERIFY(proc);
+  auto *dualIssue = dynamic_cast<DualIssueProcessor *>(proc);
+  QVERIFY(dualIssue);
+  WayPairingPolicy pairingPolicy;
+  pairingPolicy.dataWayArithmetic = dataWayArithmetic;
+  pairingPolicy.pairControlflow = pairControlflow;
+  dualIssue->setPairingPolicy(pairingPolicy);
+  runToFinish(proc);
+  QVERIFY(proc->finished());
+
+  // Each of the 4 pairs fails to issue together at most once.
+  const auto &failures = proc->performanceCounters().pairingFailures;
+  QCOMPARE(failures.dependence, dependence);
+  QCOMPARE(failures.policy, policy);
+  QCOMPARE(failures.controlflow, 0LL);
+  QCOMPARE(failures.structural, 0LL);
+  QCOMPARE(failures.ecall, 0LL);
+
+  while (proc->getCycleCount() > 0)
+    proc->reverseProcessor();
+  QCOMPARE(proc->performanceCounters().pairingFailures.policy, 0LL);
+  QCOMPARE(proc->performanceCounters().pairingFailures.dependence, 0LL);
+}
+
+void tst_perfcounters::tst_branchPrediction_data() {
+  QTest::addColumn<int>("id");
+  QTest::addColumn<long long>("mispredicts");
+  // The first iteration misses the BTB. The static and bimodal predictors
+  // then predict the loop as taken, mispredicting only its exit. The global
+  // history of gshare differs for each iteration, such that its counters
+  // remain untrained.
+  QTest::newRow("BTFN") << int(ProcessorID::RV32_5S_BP_BTFN) << 2LL;
+  QTest::newRow("1-bit") << int(ProcessorID::RV32_5S_BP_1BIT) << 2LL;
+  QTest::newRow("2-bit") << int(ProcessorID::RV32_5S_BP_2BIT) << 2LL;
+  QTest::newRow("gshare") << int(ProcessorID::RV32_5S_BP_GSHARE) << 3LL;
+}
+
+void tst_perfcounters::tst_branchPrediction() {
+  QFETCH(int, id);
+  QFETCH(long long, mispredicts);
+  auto *proc = load(ProcessorID(id));
+  QVERIFY(proc);
+  runToFinish(proc);
+  QVERIFY(proc->finished());
+
+  const auto &counters = proc->performanceCounters();
+  QCOMPARE(counters.loadUseHazards, 4LL);
+  QCOMPARE(counters.branches, 4LL);
+  QCOMPARE(counters.branchesTaken, 3LL);
+  QCOMPARE(counters.mispredicts, mispredicts);
+  const long long cycles = proc->getCycleCount();
+
+  // The predictor is restored when reversing, such that reexecuting the
+  // program predicts as the first execution.
+  while (proc->getCycleCount() > 0)
+    proc->reverseProcessor();
+  QCOMPARE(proc->performanceCounters().mispredicts, 0LL);
+  runToFinish(proc);
+  QCOMPARE(proc->performanceCounters().mispredicts, mispredicts);
+  QCOMPARE(proc->getCycleCount(), cycles);
+}
+
+void tst_perfcounters::tst_targetPrediction_data() {
+  QTest::addColumn<int>("id");
+  QTest::newRow("5-stage") << int(ProcessorID::RV32_5S_BP_2BIT);
+  QTest::newRow("out-of-order") << int(ProcessorID::RV32_OOO_2W);
+}
+
+void tst_perfcounters::tst_targetPrediction() {
+  QFETCH(int, id);
+  // Calls a function from two call sites in each of 4 iterations, such that
+  // its returns alternate between two return addresses.
+  const QStringList calls = {".text",
+                             "li s0 4",
+                             "loop:",
+                             "jal ra f",
+                             "jal ra f",
+                             "addi s0 s0 -1",
+                             "bnez s0 loop",
+                             "j end",
+                             "f:",
+                             "addi t0 t0 1",
+                             "ret",
+                             "end:",
+                             "nop"};
+  // Jumps to two targets in alternation, in each of 32 iterations.
+  constexpr long long n = 32;
+  const QStringList indirect = {".text",
+                                "li s0 32",
+                                "la t1 a",
+                                "la t2 b",
+                                "loop:",
+                                "jr t1",
+                                "a:",
+                                "j join",
+                                "b:",
+                                "nop",
+                                "join:",
+                                "mv t3 t1",
+                                "mv t1 t2",
+                                "mv t2 t3",
+                                "addi s0 s0 -1",
+                                "bnez s0 loop",
+                                "nop"};
+  const auto run = [&](const QStringList &program,
+                       const TargetPredictionConfig &config) {
+    auto *proc = load(ProcessorID(id), program);
+    if (auto *targets = dynamic_cast<TargetPredictionProcessor *>(proc))
+      targets->setTargetPrediction(config);
+    runToFinish(proc);
+    return proc;
+  };
+
+  // Without target predictors, the BTB predicts the last target of each
+  // jump...
+  auto *proc = run(calls, {});
+  QVERIFY(proc->finished());
+  const long long btbCycles = proc->getCycleCount();
+  QCOMPARE(proc->performanceCounters().returns.hits, 0LL);
+  QCOMPARE(proc->performanceCounters().returns.misses, 8LL);
+  proc = run(indirect, {});
+  QVERIFY(proc->finished());
+  QCOMPARE(proc->performanceCounters().indirectJumps.hits, 0LL);
+  QCOMPARE(proc->performanceCounters().indirectJumps.misses, n);
+
+  // ... whereas the return-address stack predicts all but the first return,
+  // which misses the BTB.
+  proc = run(calls, {4, 0});
+  QVERIFY(proc->finished());
+  QVERIFY(dynamic_cast<TargetPredictionProcessor *>(proc));
+  QCOMPARE(proc->performanceCounters().returns.hits, 7LL);
+  QCOMPARE(proc->performanceCounters().returns.misses, 1LL);
+  QCOMPARE(proc->performanceCounters().indirectJumps.misses, 0LL);
+  QVERIFY(proc->getCycleCount() < btbCycles);
+
+  // The stack is restored when reversing.
+  if (proc->features() & RipesProcessor::isReversible) {
+    while (proc->getCycleCount() > 0)
+      proc->reverseProcessor();
+    QCOMPARE(proc->performanceCounters().returns.hits, 0LL);
+    runToFinish(proc);
+    QCOMPARE(proc->performanceCounters().returns.hits, 7LL);
+    QCOMPARE(proc->performanceCounters().returns.misses, 1LL);
+  }
+
+  // The indirect-target predictor learns the alternation from the history of
+  // targets, once the history has filled.
+  proc = run(indirect, {0, 64});
+  QVERIFY(proc->finished());
+  const auto counters = proc->performanceCounters();
+  QCOMPARE(counters.indirectJumps.hits + counters.indirectJumps.misses, n);
+  QVERIFY(counters.indirectJumps.misses < n / 2);
+  QCOMPARE(counters.returns.hits + counters.returns.misses, 0LL);
+}
+
+void tst_perfcounters::tst_reverse() {
+  auto *proc = load(ProcessorID::RV32_5S);
+  QVERIFY(proc);
+  for (int i = 0; i < 12; ++i)
+    proc->clock();
+  const auto forwards = proc->performanceCounters().forwards;
+  const auto loadUseHazards = proc->performanceCounters().loadUseHazards;
+
+  for (int i = 0; i < 6; ++i)
+    proc->clock();
+  for (int i = 0; i < 6; ++i)
+    proc->reverseProcessor();
+  QCOMPARE(proc->performanceCounters().forwards, forwards);
+  QCOMPARE(proc->performanceCounters().loadUseHazards, loadUseHazards);
+
+  // Counting continues from the reversed state.
+  runToFinish(proc);
+  QCOMPARE(proc->performanceCounters().loadUseHazards, 4LL);
+}
+
+void tst_perfcounters::tst_disabled() {
+  auto *proc = load(ProcessorID::RV32_5S);
+  QVERIFY(proc);
+  ProcessorHandler::setPerformanceCounting(false);
+  runToFinish(proc);
+  QCOMPARE(proc->performanceCounters().branches, 0LL);
+  QVERIFY(proc->performanceCounters().stages.empty());
+
+  // Processors without performance counters do not advertise them.
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_SS, {"M"});
+  QVERIFY(!(ProcessorHandler::getProcessor()->features() &
+            RipesProcessor::hasPerformanceCounters));
+}
+
+QTEST_MAIN(tst_perfcounters)
+#include "tst_perfcounters.moc"
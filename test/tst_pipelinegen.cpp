@@ -0,0 +1,195 @@
+#include <QtTest/QTest>
+
+#include "processorhandler.h"
+#include "processorregistry.h"
+#include "programloader.h"
+
+using namespace Ripes;
+
+// This test ensures that the pipelines generated from pipeline descriptions
+// derive their structure and hazards from the description, and that their
+// committed state matches the functional model.
+
+class tst_pipelinegen : public ProcessorTest {
+  Q_OBJECT
+
+private slots:
+  void tst_structure();
+  void tst_timing();
+  void tst_timing_data();
+  void tst_state();
+  void tst_counters();
+
+private:
+  long long cycles(ProcessorID id, const QStringList &program);
+};
+
+long long tst_pipelinegen::cycles(ProcessorID id, const QStringList &program) {
+  auto *proc = load(id, program);
+  if (!proc)
+    return -1;
+  runToFinish(proc);
+  return proc->finished() ? proc->getCycleCount() : -1;
+}
+
+void tst_pipelinegen::tst_structure() {
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_3S_GEN, {"M"});
+  auto *proc = ProcessorHandler::getProcessor();
+  QCOMPARE(proc->structure().numStages(), 3u);
+  QCOMPARE(proc->stageName({0, 2}), QString("EX/MEM/WB"));
+
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_9S_GEN, {"M"});
+  proc = ProcessorHandler::getProcessor();
+  QCOMPARE(proc->structure().size(), size_t(1));
+  QCOMPARE(proc->structure().numStages(), 9u);
+  const QStringList names = {"IF1", "IF2", "IF3",  "ID", "EX1",
+                             "EX2", "MEM1", "MEM2", "WB"};
+  for (unsigned i = 0; i < 9; ++i)
+    QCOMPARE(proc->stageName({0, i}), names.at(i));
+}
+
+void tst_pipelinegen::tst_timing_data() {
+  QTest::addColumn<int>("id");
+  QTest::addColumn<int>("depth");
+  QTest::addColumn<int>("aluStalls");
+  QTest::addColumn<int>("loadUseStalls");
+  QTest::addColumn<int>("branchPenalty");
+  QTest::newRow("3-stage") << int(ProcessorID::RV32_3S_GEN) << 3 << 0 << 0
+                           << 2;
+  QTest::newRow("5-stage") << int(ProcessorID::RV32_5S_GEN) << 5 << 0 << 1
+                           << 2;
+  QTest::newRow("7-stage") << int(ProcessorID::RV32_7S_GEN) << 7 << 0 << 2
+                           << 3;
+  QTest::newRow("9-stage") << int(ProcessorID::RV32_9S_GEN) << 9 << 1 << 3
+                           << 5;
+  QTest::newRow("9-stage RV64") << int(ProcessorID::RV64_9S_GEN) << 9 << 1
+                                << 3 << 5;
+}
+
+void tst_pipelinegen::tst_timing() {
+  QFETCH(int, id);
+  QFETCH(int, depth);
+  QFETCH(int, aluStalls);
+  QFETCH(int, loadUseStalls);
+  QFETCH(int, branchPenalty);
+  constexpr long long n = 20;
+  const auto processor = ProcessorID(id);
+
+  // Independent instructions retire one per cycle, once the pipeline has
+  // filled.
+  QStringList independent = {".text"};
+  for (int i = 0; i < n; ++i)
+    independent << "addi x" + QString::number(5 + i % 2) + " x0 1";
+  QCOMPARE(cycles(processor, independent), n + depth);
+
+  // Dependent ALU instructions stall until the result of the ALU is
+  // forwarded...
+  QStringList dependent = {".text"};
+  for (int i = 0; i < n; ++i)
+    dependent << "addi x5 x5 1";
+  QCOMPARE(cycles(processor, dependent), n + depth + (n - 1) * aluStalls);
+
+  // ... and dependent loads until the loaded value is.
+  QStringList loads = {".data", "a: .word 1", ".text", "la a0 a"};
+  QStringList loadUses = loads;
+  for (int i = 0; i < n; ++i) {
+    loads << "lw t0 0(a0)" << "addi t1 t2 1";
+    loadUses << "lw t0 0(a0)" << "addi t1 t0 1";
+  }
+  QCOMPARE(cycles(processor, loadUses) - cycles(processor, loads),
+           n * loadUseStalls);
+
+  // Taken control flow flushes the stages preceding the branch stage. Each
+  // jump skips a nop.
+  QStringList jumps = {".text"};
+  QStringList nops = {".text"};
+  for (int i = 0; i < n; ++i) {
+    const QString label = "l" + QString::number(i);
+    jumps << "j " + label << "nop" << label + ":";
+    nops << "nop";
+  }
+  jumps << "nop";
+  nops << "nop";
+  QCOMPARE(cycles(processor, jumps) - cycles(processor, nops),
+           n * branchPenalty);
+}
+
+void tst_pipelinegen::tst_state() {
+  const QStringList program = {".data",
+                               "a: .zero 16",
+                               ".text",
+                               "la a0 a",
+                               "li s0 100",
+                               "li s1 7",
+                               "loop:",
+                               "div t0 s0 s1",
+                               "sw s0 0(a0)",
+                               "lw t1 0(a0)",
+                               "mul t2 t1 s1",
+                               "add t3 t2 t0",
+                               "sw t3 4(a0)",
+                               "addi s0 s0 -1",
+                               "bnez s0 loop",
+                               "lw t4 4(a0)",
+                               "nop"};
+  const auto registers = [](RipesProcessor *proc) {
+    std::vector<VInt> regs;
+    for (unsigned i = 0; i < 32; ++i)
+      regs.push_back(proc->getRegister(RVISA::GPR, i));
+    return regs;
+  };
+
+  auto *proc = load(ProcessorID::RV32_ISS, program);
+  QVERIFY(proc);
+  runToFinish(proc);
+  QVERIFY(proc->finished());
+  const auto expected = registers(proc);
+  const long long retired = proc->getInstructionsRetired();
+
+  for (auto id : {ProcessorID::RV32_3S_GEN, ProcessorID::RV32_5S_GEN,
+                  ProcessorID::RV32_7S_GEN, ProcessorID::RV32_9S_GEN}) {
+    proc = load(id, program);
+    QVERIFY(proc);
+    runToFinish(proc);
+    QVERIFY(proc->finished());
+    QCOMPARE(proc->getInstructionsRetired(), retired);
+    QVERIFY(registers(proc) == expected);
+  }
+}
+
+void tst_pipelinegen::tst_counters() {
+  // Sums 1 (loaded from memory) until reaching 4.
+  const QStringList program = {".data",
+                               "a: .word 1",
+                               ".text",
+                               "la a0 a",
+                               "li s0 0",
+                               "li s1 4",
+                               "loop:",
+                               "lw t0 0(a0)",
+                               "add s0 s0 t0",
+                               "blt s0 s1 loop",
+                               "nop"};
+  auto *proc = load(ProcessorID::RV32_7S_GEN, program);
+  QVERIFY(proc);
+  ProcessorHandler::setPerformanceCounting(true);
+  QVERIFY(proc->features() & RipesProcessor::hasPerformanceCounters);
+  QVERIFY(!(proc->features() & RipesProcessor::isReversible));
+  runToFinish(proc);
+  QVERIFY(proc->finished());
+
+  const auto &counters = proc->performanceCounters();
+  QCOMPARE(counters.branches, 4LL);
+  QCOMPARE(counters.branchesTaken, 3LL);
+  QCOMPARE(counters.mispredicts, 3LL);
+  // Each addition waits two cycles on its load.
+  QCOMPARE(counters.loadUseHazards, 8LL);
+  QVERIFY(counters.loadUseHazards <= counters.dataHazards);
+  QVERIFY(counters.forwards > 0);
+  // Each taken branch flushes the IF1, IF2 and ID stages once.
+  for (unsigned s = 0; s < 3; ++s)
+    QCOMPARE(counters.stages.at({0, s}).flushed, 3LL);
+}
+
+QTEST_MAIN(tst_pipelinegen)
+#include "tst_pipelinegen.moc"
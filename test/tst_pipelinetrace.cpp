@@ -0,0 +1,228 @@
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QtTest/QTest>
+
+#include "pipelinediagramexport.h"
+#include "pipelinediagrammodel.h"
+#include "pipelinetrace.h"
+#include "processorhandler.h"
+#include "processorregistry.h"
+
+using namespace Ripes;
+
+// This test ensures that pipeline traces record exactly the cycles of the
+// requested window, or the cycles around the requested breakpoints, that
+// Chrome traces hold the instructions of each stage, that the pipeline
+// diagram publishes the cycles recorded since it was last viewed, and that
+// exports of the pipeline diagram hold a tile per file or page.
+
+class tst_pipelinetrace : public QObject {
+  Q_OBJECT
+
+private slots:
+  void initTestCase();
+  void tst_window();
+  void tst_breakpoint();
+  void tst_chromeTrace();
+  void tst_diagramModel();
+  void tst_diagramExport();
+
+private:
+  /// Runs the program with a pipeline trace of @p options, and returns the
+  /// recorded cycles in @p cycles.
+  void trace(PipelineTraceOptions options, std::vector<long long> &cycles);
+  /// Runs the program whilst writing the trace of @p writer.
+  void run(PipelineTraceWriter &writer);
+
+  QTemporaryDir m_dir;
+  std::shared_ptr<Program> m_program;
+};
+
+void tst_pipelinetrace::initTestCase() {
+  QVERIFY(m_dir.isValid());
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_5S, {"M"});
+  const QString program = QStringList{".text",
+                                      "li s0 0",
+                                      "li s1 20",
+                                      "loop:",
+                                      "addi s0 s0 1",
+                                      "blt s0 s1 loop",
+                                      "li a7 10",
+                                      "ecall"}
+                              .join("\n");
+  auto res = ProcessorHandler::getAssembler()->assembleRaw(program);
+  QVERIFY(res.errors.empty());
+  m_program = std::make_shared<Program>(res.program);
+}
+
+void tst_pipelinetrace::run(PipelineTraceWriter &writer) {
+  QString errorMessage;
+  QVERIFY2(writer.open(errorMessage), errorMessage.toStdString().c_str());
+  QSignalSpy finished(ProcessorHandler::get(), &ProcessorHandler::runFinished);
+  ProcessorHandler::run();
+  QVERIFY(finished.wait(10000));
+  // Waits for the run to have finished entirely.
+  ProcessorHandler::stopRun();
+  writer.close();
+}
+
+void tst_pipelinetrace::trace(PipelineTraceOptions options,
+                              std::vector<long long> &cycles) {
+  ProcessorHandler::loadProgram(m_program);
+  options.path = m_dir.filePath("pipeline.tsv");
+  PipelineTraceWriter writer(options);
+  run(writer);
+  if (QTest::currentTestFailed())
+    return;
+
+  QFile file(options.path);
+  file.open(QIODevice::ReadOnly | QIODevice::Text);
+  const QStringList lines = QString(file.readAll()).split('\n');
+  // Header, one row per recorded cycle and a trailing newline.
+  const QStringList header = lines.front().split('\t');
+  QCOMPARE(header.size(), 6);
+  QCOMPARE(header.at(1), "IF");
+
+  for (int i = 1; i < lines.size() - 1; ++i) {
+    const QStringList columns = lines.at(i).split('\t');
+    QCOMPARE(columns.size(), header.size());
+    cycles.push_back(columns.at(0).toLongLong());
+  }
+  QCOMPARE(static_cast<long long>(cycles.size()), writer.cycles());
+}
+
+void tst_pipelinetrace::tst_window() {
+  PipelineTraceOptions options;
+  options.first = 10;
+  options.last = 19;
+  std::vector<long long> cycles;
+  trace(options, cycles);
+  std::vector<long long> expected;
+  for (long long cycle = 10; cycle <= 19; ++cycle)
+    expected.push_back(cycle);
+  QVERIFY(cycles == expected);
+}
+
+void tst_pipelinetrace::tst_breakpoint() {
+  // The second instruction is fetched once, in the first cycle.
+  PipelineTraceOptions options;
+  options.breakpoints = {m_program->getSection(TEXT_SECTION_NAME)->address +
+                         4};
+  options.context = 2;
+  std::vector<long long> cycles;
+  trace(options, cycles);
+  QVERIFY(cycles == std::vector<long long>({1, 2, 3}));
+}
+
+void tst_pipelinetrace::tst_chromeTrace() {
+  ProcessorHandler::loadProgram(m_program);
+  PipelineTraceOptions options;
+  options.path = m_dir.filePath("pipeline.json");
+  options.format = PipelineTraceOptions::Format::ChromeTrace;
+  PipelineTraceWriter writer(options);
+  run(writer);
+  if (QTest::currentTestFailed())
+    return;
+
+  QFile file(options.path);
+  QVERIFY(file.open(QIODevice::ReadOnly));
+  QJsonParseError parseError;
+  const auto doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+  QCOMPARE(parseError.error, QJsonParseError::NoError);
+
+  // A thread per stage and for system calls. Each instruction occupies the WB
+  // stage for a single cycle, and instructions retire in distinct cycles.
+  int threads = 0, retired = 0, syscalls = 0;
+  for (const auto &value : doc.object().value("traceEvents").toArray()) {
+    const auto event = value.toObject();
+    const QString phase = event.value("ph").toString();
+    threads += phase == "M";
+    syscalls += phase == "i" && event.value("name").toString() == "Exit";
+    if (phase == "X" && event.value("tid").toInt() == 4 &&
+        event.value("cat").toString() == "instruction") {
+      QCOMPARE(event.value("dur").toInt(), 1);
+      retired++;
+    }
+  }
+  QCOMPARE(threads, 6);
+  QCOMPARE(syscalls, 1);
+  QCOMPARE(static_cast<long long>(retired),
+           ProcessorHandler::getProcessor()->getInstructionsRetired());
+}
+
+void tst_pipelinetrace::tst_diagramModel() {
+  ProcessorHandler::loadProgram(m_program);
+  PipelineDiagramModel model;
+  auto *proc = ProcessorHandler::getProcessorNonConst();
+  for (int i = 0; i < 3; ++i)
+    proc->clock();
+  model.prepareForView();
+  QCOMPARE(model.columnCount(), 4);
+  QCOMPARE(model.data(model.index(0, 0)).toString(), "IF");
+  QCOMPARE(model.data(model.index(0, 1)).toString(), "ID");
+  QCOMPARE(model.data(model.index(1, 1)).toString(), "IF");
+
+  // Cycles clocked after the view was prepared are inserted, rather than
+  // resetting the model.
+  QSignalSpy inserted(&model, &PipelineDiagramModel::columnsInserted);
+  QSignalSpy reset(&model, &PipelineDiagramModel::modelReset);
+  for (int i = 0; i < 2; ++i)
+    proc->clock();
+  QCOMPARE(model.columnCount(), 4);
+  model.prepareForView();
+  QCOMPARE(model.columnCount(), 6);
+  QCOMPARE(inserted.count(), 1);
+  QCOMPARE(reset.count(), 0);
+  QCOMPARE(model.headerData(5, Qt::Horizontal).toString(), "5");
+  QCOMPARE(model.data(model.index(0, 4)).toString(), "WB");
+}
+
+void tst_pipelinetrace::tst_diagramExport() {
+  ProcessorHandler::loadProgram(m_program);
+  PipelineDiagramModel model;
+  auto *proc = ProcessorHandler::getProcessorNonConst();
+  for (int i = 0; i < 20; ++i)
+    proc->clock();
+
+  const auto exportDiagram = [](PipelineDiagramExporter &exporter) {
+    QSignalSpy finished(&exporter, &PipelineDiagramExporter::finished);
+    exporter.start();
+    QVERIFY(finished.wait(10000));
+    QCOMPARE(finished.at(0).at(0).toString(), QString());
+  };
+
+  // 6 instructions and 21 cycles, in tiles of 4 instructions and 8 cycles.
+  PipelineDiagramExportOptions options;
+  options.path = m_dir.filePath("diagram.png");
+  options.format = PipelineDiagramExportOptions::Format::PNG;
+  options.tileRows = 4;
+  options.tileColumns = 8;
+  PipelineDiagramExporter png(model, options);
+  QCOMPARE(png.tiles(), 6);
+  exportDiagram(png);
+  if (QTest::currentTestFailed())
+    return;
+  for (int row = 0; row < 2; ++row)
+    for (int column = 0; column < 3; ++column)
+      QVERIFY(!QImage(png.tilePath(row, column)).isNull());
+  // Tiles hold a header row, followed by their instructions.
+  QCOMPARE(QImage(png.tilePath(0, 0)).height() * 3,
+           QImage(png.tilePath(1, 0)).height() * 5);
+
+  // PDF exports are a single document.
+  options.path = m_dir.filePath("diagram.pdf");
+  options.format = PipelineDiagramExportOptions::Format::PDF;
+  PipelineDiagramExporter pdf(model, options);
+  QCOMPARE(pdf.tilePath(1, 2), options.path);
+  exportDiagram(pdf);
+  QFile file(options.path);
+  QVERIFY(file.open(QIODevice::ReadOnly));
+  QVERIFY(file.readAll().startsWith("%PDF"));
+}
+
+QTEST_MAIN(tst_pipelinetrace)
+#include "tst_pipelinetrace.moc"
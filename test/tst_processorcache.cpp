@@ -0,0 +1,101 @@
+#include <QtTest/QTest>
+
+#include "processorhandler.h"
+#include "processorregistry.h"
+
+using namespace Ripes;
+
+// This test ensures that processors which are selected again are reused from
+// the cache of the ProcessorHandler, and behave as freshly constructed ones.
+
+class tst_processorcache : public QObject {
+  Q_OBJECT
+
+private slots:
+  void initTestCase();
+  void cleanupTestCase();
+  void tst_reuse();
+  void tst_extensions();
+  void tst_eviction();
+
+private:
+  static RipesProcessor *run(const QStringList &program);
+};
+
+static const QStringList s_extensions = {"M"};
+
+void tst_processorcache::initTestCase() {
+  ProcessorHandler::setProcessorCaching(true);
+}
+
+void tst_processorcache::cleanupTestCase() {
+  ProcessorHandler::setProcessorCaching(false);
+}
+
+RipesProcessor *tst_processorcache::run(const QStringList &program) {
+  auto res = ProcessorHandler::getAssembler()->assembleRaw(program.join("\n"));
+  if (!res.errors.empty())
+    return nullptr;
+  ProcessorHandler::loadProgram(std::make_shared<Program>(res.program));
+  auto *proc = ProcessorHandler::getProcessorNonConst();
+  proc->trapHandler = [] {};
+  while (!proc->finished() && proc->getCycleCount() < 1000)
+    proc->clock();
+  return proc;
+}
+
+void tst_processorcache::tst_reuse() {
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_5S, s_extensions);
+  auto *proc = run({".text", "li a0 42", "li a1 7", "mul a2 a0 a1"});
+  QVERIFY(proc && proc->finished());
+  QCOMPARE(proc->getRegister(RVISA::GPR, 12), VInt(294));
+
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_SS, s_extensions);
+  QVERIFY(ProcessorHandler::getProcessor() != proc);
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_5S, s_extensions);
+  QCOMPARE(ProcessorHandler::getProcessor(), proc);
+
+  // The reused processor is reset, and does not retain the state of its
+  // previous selection.
+  QCOMPARE(proc->getCycleCount(), 0LL);
+  QCOMPARE(proc->getRegister(RVISA::GPR, 12), VInt(0));
+
+  proc = run({".text", "li a0 3", "li a1 5", "mul a2 a0 a1"});
+  QVERIFY(proc && proc->finished());
+  QCOMPARE(proc->getRegister(RVISA::GPR, 12), VInt(15));
+}
+
+void tst_processorcache::tst_extensions() {
+  // A processor is only reused for the ISA extensions it was constructed with.
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_SS, s_extensions);
+  const auto *proc = ProcessorHandler::getProcessor();
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_5S, s_extensions);
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_SS, {"M", "C"});
+  QVERIFY(ProcessorHandler::getProcessor() != proc);
+  QVERIFY(ProcessorHandler::currentISA()->extensionEnabled("C"));
+}
+
+void tst_processorcache::tst_eviction() {
+  std::vector<const RipesProcessor *> evicted;
+  auto conn = connect(ProcessorHandler::get(),
+                      &ProcessorHandler::processorEvicted, this,
+                      [&](const RipesProcessor *p) { evicted.push_back(p); });
+
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_SS, s_extensions);
+  const auto *first = ProcessorHandler::getProcessor();
+  for (auto id : {ProcessorID::RV32_5S, ProcessorID::RV32_5S_NO_FW_HZ,
+                  ProcessorID::RV32_5S_NO_HZ, ProcessorID::RV32_5S_NO_FW,
+                  ProcessorID::RV32_6S_DUAL, ProcessorID::RV32_ISS})
+    ProcessorHandler::selectProcessor(id, s_extensions);
+  QVERIFY(std::find(evicted.begin(), evicted.end(), first) != evicted.end());
+
+  // Disabling the cache destroys all cached processors.
+  evicted.clear();
+  ProcessorHandler::setProcessorCaching(false);
+  QVERIFY(!evicted.empty());
+  ProcessorHandler::setProcessorCaching(true);
+  disconnect(conn);
+}
+
+QTEST_APPLESS_MAIN(tst_processorcache)
+#include "tst_processorcache.moc"
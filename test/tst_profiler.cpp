@@ -0,0 +1,172 @@
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtTest/QTest>
+
+#include "cli/profiler.h"
+#include "processorhandler.h"
+#include "processorregistry.h"
+
+using namespace Ripes;
+
+// This test ensures that the profiler attributes every cycle and retired
+// instruction of a run to the instructions, symbols and source lines of the
+// program.
+
+class tst_profiler : public QObject {
+  Q_OBJECT
+
+private slots:
+  void tst_singleCycle();
+  void tst_pipelined();
+  void tst_blocks();
+
+private:
+  void run(ProcessorID id, std::shared_ptr<Profiler> &profiler);
+};
+
+// Four iterations of a loop of three instructions, following a prologue of
+// four instructions (la is expanded to two instructions).
+static const QStringList s_program = {".data",
+                                      "a: .word 1",
+                                      ".text",
+                                      "la a0 a",
+                                      "li s0 0",
+                                      "li s1 4",
+                                      "loop:",
+                                      "lw t0 0(a0)",
+                                      "add s0 s0 t0",
+                                      "blt s0 s1 loop",
+                                      "nop"};
+
+void tst_profiler::run(ProcessorID id, std::shared_ptr<Profiler> &profiler) {
+  ProcessorHandler::selectProcessor(id, {"M"});
+  auto res =
+      ProcessorHandler::getAssembler()->assembleRaw(s_program.join("\n"));
+  QVERIFY(res.errors.empty());
+  auto program = std::make_shared<Program>(res.program);
+  ProcessorHandler::loadProgram(program);
+
+  auto *proc = ProcessorHandler::getProcessorNonConst();
+  proc->trapHandler = [] {};
+  profiler = std::make_shared<Profiler>(program, 20);
+  profiler->attach(proc);
+  while (!proc->finished() && proc->getCycleCount() < 1000)
+    proc->clock();
+  profiler->detach();
+  QVERIFY(proc->finished());
+
+  QCOMPARE(profiler->totalCycles(), proc->getCycleCount());
+  long long retired = 0;
+  for (const auto &entry : profiler->instructions())
+    retired += entry.retired;
+  QCOMPARE(retired, proc->getInstructionsRetired());
+}
+
+void tst_profiler::tst_singleCycle() {
+  std::shared_ptr<Profiler> profiler;
+  run(ProcessorID::RV32_SS, profiler);
+  if (QTest::currentTestFailed())
+    return;
+
+  const auto symbols = profiler->symbols();
+  QCOMPARE(symbols.size(), size_t(2));
+  QCOMPARE(symbols.at(0).name, QString("loop"));
+  QCOMPARE(symbols.at(0).cycles, 13LL);
+  QCOMPARE(symbols.at(0).retired, 13LL);
+  QCOMPARE(symbols.at(1).name, QString(TEXT_SECTION_NAME));
+  QCOMPARE(symbols.at(1).retired, 4LL);
+
+  // The instructions of the loop body are each executed four times.
+  const auto lines = profiler->lines();
+  QCOMPARE(lines.at(0).retired, 4LL);
+  QCOMPARE(lines.at(0).name, QString("8"));
+}
+
+void tst_profiler::tst_pipelined() {
+  std::shared_ptr<Profiler> profiler;
+  run(ProcessorID::RV32_5S, profiler);
+  if (QTest::currentTestFailed())
+    return;
+
+  // The two bubbles following each of the three taken branches are attributed
+  // to the branch, and the bubble of each load-use hazard to the load.
+  const auto instructions = profiler->instructions();
+  QVERIFY(instructions.at(0).name.startsWith("blt"));
+  QCOMPARE(instructions.at(0).cycles, 10LL);
+  QCOMPARE(instructions.at(0).retired, 4LL);
+  QVERIFY(instructions.at(1).name.startsWith("lw"));
+  QCOMPARE(instructions.at(1).cycles, 8LL);
+
+  QString errorMessage;
+  const QString path = QDir::temp().filePath("tst_profiler.folded");
+  QVERIFY(profiler->writeFolded(path, errorMessage));
+  QFile file(path);
+  QVERIFY(file.open(QIODevice::ReadOnly | QIODevice::Text));
+  long long cycles = 0;
+  for (const auto &line : QString(file.readAll()).split('\n',
+                                                       Qt::SkipEmptyParts))
+    cycles += line.split(' ').last().toLongLong();
+  QCOMPARE(cycles, profiler->totalCycles());
+  file.remove();
+}
+
+void tst_profiler::tst_blocks() {
+  std::shared_ptr<Profiler> profiler;
+  run(ProcessorID::RV32_5S, profiler);
+  if (QTest::currentTestFailed())
+    return;
+
+  // The prologue falls through to the loop, which is entered four times: once
+  // by falling through and thrice by its back edge, after which it falls
+  // through to the final nop.
+  const auto [blocks, edges] = profiler->blocks();
+  QCOMPARE(blocks.size(), size_t(3));
+  QCOMPARE(blocks.at(0).instructions, 4u);
+  QCOMPARE(blocks.at(0).entries, 1LL);
+  QCOMPARE(blocks.at(1).symbol, QString("loop"));
+  QCOMPARE(blocks.at(1).address, blocks.at(0).end);
+  QCOMPARE(blocks.at(1).instructions, 3u);
+  QCOMPARE(blocks.at(1).entries, 4LL);
+  QCOMPARE(blocks.at(1).retired, 12LL);
+  QCOMPARE(blocks.at(2).entries, 1LL);
+  // The blocks hold the cycles attributed to their instructions.
+  long long blockCycles = 0;
+  for (const auto &block : blocks)
+    blockCycles += block.cycles;
+  long long instrCycles = 0;
+  for (const auto &entry : profiler->instructions())
+    instrCycles += entry.cycles;
+  QCOMPARE(blockCycles, instrCycles);
+
+  QCOMPARE(edges.size(), size_t(3));
+  QCOMPARE(edges.at(0).from, blocks.at(0).address);
+  QCOMPARE(edges.at(0).to, blocks.at(1).address);
+  QVERIFY(!edges.at(0).taken);
+  QCOMPARE(edges.at(0).count, 1LL);
+  QCOMPARE(edges.at(1).from, blocks.at(1).address);
+  QCOMPARE(edges.at(1).to, blocks.at(1).address);
+  QVERIFY(edges.at(1).taken);
+  QVERIFY(edges.at(1).backEdge());
+  QCOMPARE(edges.at(1).count, 3LL);
+  QCOMPARE(edges.at(2).to, blocks.at(2).address);
+  QVERIFY(!edges.at(2).taken);
+  QCOMPARE(edges.at(2).count, 1LL);
+
+  QString errorMessage;
+  const QString path = QDir::temp().filePath("tst_profiler_blocks.json");
+  QVERIFY(profiler->writeBlocks(path, errorMessage));
+  QFile file(path);
+  QVERIFY(file.open(QIODevice::ReadOnly | QIODevice::Text));
+  const auto report = QJsonDocument::fromJson(file.readAll()).object();
+  QCOMPARE(report["blocks"].toArray().size(), qsizetype(3));
+  const auto loops = report["loops"].toArray();
+  QCOMPARE(loops.size(), qsizetype(1));
+  QCOMPARE(loops.at(0).toObject()["symbol"].toString(), QString("loop"));
+  QCOMPARE(loops.at(0).toObject()["iterations"].toInteger(), 3LL);
+  file.remove();
+}
+
+QTEST_MAIN(tst_profiler)
+#include "tst_profiler.moc"
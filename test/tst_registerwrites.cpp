@@ -0,0 +1,123 @@
+#include <QtTest/QTest>
+
+#include "processorhandler.h"
+#include "processorregistry.h"
+
+using namespace Ripes;
+
+// This test ensures that the processor models report exactly the registers
+// written by a program, and that operations which may modify any register
+// report all registers as written. It also ensures that registers read through
+// register file handles match those read by register file name.
+
+class tst_registerwrites : public QObject {
+  Q_OBJECT
+
+private slots:
+  void tst_written();
+  void tst_written_data();
+  void tst_setRegister();
+  void tst_handles();
+  void tst_handles_data();
+  void tst_reverse();
+
+private:
+  RipesProcessor *load(ProcessorID id);
+};
+
+// Writes s0, s1 and t0.
+static const QString s_program =
+    QStringList{".text", "li s0 1", "li s1 2", "add t0 s0 s1", "nop"}.join(
+        "\n");
+
+static constexpr uint64_t s_allRegisters = ~uint64_t(0);
+
+RipesProcessor *tst_registerwrites::load(ProcessorID id) {
+  ProcessorHandler::selectProcessor(id, {"M"});
+  auto res = ProcessorHandler::getAssembler()->assembleRaw(s_program);
+  if (!res.errors.empty())
+    return nullptr;
+  ProcessorHandler::loadProgram(std::make_shared<Program>(res.program));
+  auto *proc = ProcessorHandler::getProcessorNonConst();
+  proc->trapHandler = [] {};
+  return proc;
+}
+
+void tst_registerwrites::tst_written_data() {
+  QTest::addColumn<int>("id");
+  // The program is RISC-V assembly.
+  for (int id = 0; id < ProcessorID::NUM_PROCESSORS; ++id)
+    if (ProcessorRegistry::isaFamily(ProcessorID(id)) == "RISC-V")
+      QTest::addRow("processor %d", id) << id;
+}
+
+void tst_registerwrites::tst_written() {
+  QFETCH(int, id);
+  auto *proc = load(ProcessorID(id));
+  QVERIFY(proc);
+  // The processor has been reset, which may have modified any register.
+  uint64_t cursor = 0;
+  QCOMPARE(proc->writtenRegisters(RVISA::GPR, cursor), s_allRegisters);
+  QCOMPARE(proc->writtenRegisters(RVISA::GPR, cursor), uint64_t(0));
+
+  while (!proc->finished() && proc->getCycleCount() < 100)
+    proc->clock();
+  QVERIFY(proc->finished());
+  const uint64_t expected = (1 << 8) | (1 << 9) | (1 << 5);
+  QCOMPARE(proc->writtenRegisters(RVISA::GPR, cursor), expected);
+
+  // Observers keep their own cursors.
+  uint64_t otherCursor = 0;
+  QCOMPARE(proc->writtenRegisters(RVISA::GPR, otherCursor), s_allRegisters);
+  QCOMPARE(proc->writtenRegisters(RVISA::GPR, cursor), uint64_t(0));
+}
+
+void tst_registerwrites::tst_handles_data() { tst_written_data(); }
+
+void tst_registerwrites::tst_handles() {
+  QFETCH(int, id);
+  auto *proc = load(ProcessorID(id));
+  QVERIFY(proc);
+  QVERIFY(!proc->registerFile("none").valid());
+  while (!proc->finished() && proc->getCycleCount() < 100)
+    proc->clock();
+
+  const RegisterFileHandles files(*proc);
+  for (const auto &rfid : proc->registerFiles()) {
+    const auto &file = files[rfid];
+    QVERIFY(file.valid());
+    const auto regInfo = proc->implementsISA()->regInfo(rfid);
+    QCOMPARE(file.count, regInfo.value()->regCnt());
+    std::vector<VInt> values(file.count);
+    proc->readRegisters(file, values.data());
+    for (unsigned i = 0; i < file.count; i++) {
+      QCOMPARE(proc->readRegister(file, i), proc->getRegister(rfid, i));
+      QCOMPARE(values[i], proc->getRegister(rfid, i));
+    }
+  }
+  const auto &gpr = files[RVISA::GPR];
+  QCOMPARE(proc->readRegister(gpr, 5), VInt(3));
+}
+
+void tst_registerwrites::tst_setRegister() {
+  auto *proc = load(ProcessorID::RV32_5S);
+  QVERIFY(proc);
+  uint64_t cursor = 0;
+  proc->writtenRegisters(RVISA::GPR, cursor);
+  proc->setRegister(RVISA::GPR, 10, 42);
+  QCOMPARE(proc->writtenRegisters(RVISA::GPR, cursor), uint64_t(1) << 10);
+}
+
+void tst_registerwrites::tst_reverse() {
+  auto *proc = load(ProcessorID::RV32_5S);
+  QVERIFY(proc);
+  for (int i = 0; i < 3; ++i)
+    proc->clock();
+  uint64_t cursor = 0;
+  proc->writtenRegisters(RVISA::GPR, cursor);
+  proc->reverseProcessor();
+  QCOMPARE(proc->writtenRegisters(RVISA::GPR, cursor), s_allRegisters);
+}
+
+QTEST_MAIN(tst_registerwrites)
+#include "tst_registerwrites.moc"
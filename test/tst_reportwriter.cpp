@@ -0,0 +1,109 @@
+#include <QtTest/QTest>
+
+#include <QBuffer>
+#include <QCborValue>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "cli/reportwriter.h"
+
+using namespace Ripes;
+
+// This test ensures that reports written by the streaming report writers are
+// identical to reports serialized as a QJsonDocument.
+
+class tst_reportwriter : public QObject {
+  Q_OBJECT
+
+private slots:
+  void tst_json();
+  void tst_json_data();
+  void tst_cbor();
+  void tst_members();
+  void tst_parseFormat();
+
+private:
+  static QVariantMap report();
+  static QByteArray write(ReportWriter::Format format, const QVariant &value);
+};
+
+QVariantMap tst_reportwriter::report() {
+  QVariantMap entry;
+  entry["symbol"] = "main";
+  entry["cycles"] = 42LL;
+  entry["share"] = 0.25;
+  entry["hot"] = true;
+  QVariantMap m;
+  m["entries"] = QVariantList{entry, entry};
+  m["empty list"] = QVariantList();
+  m["empty map"] = QVariantMap();
+  m["escaped \"\\\n\t\x01"] = QString("ünïcode");
+  m["names"] = QStringList{"a", "b"};
+  m["none"] = QVariant();
+  m["large"] = static_cast<qulonglong>(1) << 40;
+  m["negative"] = -7;
+  return m;
+}
+
+QByteArray tst_reportwriter::write(ReportWriter::Format format,
+                                   const QVariant &value) {
+  QBuffer buffer;
+  buffer.open(QIODevice::WriteOnly);
+  ReportWriter::create(format, buffer)->value(value);
+  return buffer.data();
+}
+
+void tst_reportwriter::tst_json_data() {
+  QTest::addColumn<ReportWriter::Format>("format");
+  QTest::addColumn<QJsonDocument::JsonFormat>("jsonFormat");
+  QTest::newRow("indented")
+      << ReportWriter::Format::Indented << QJsonDocument::Indented;
+  QTest::newRow("compact")
+      << ReportWriter::Format::Compact << QJsonDocument::Compact;
+}
+
+void tst_reportwriter::tst_json() {
+  QFETCH(ReportWriter::Format, format);
+  QFETCH(QJsonDocument::JsonFormat, jsonFormat);
+  const QByteArray expected =
+      QJsonDocument(QJsonObject::fromVariantMap(report())).toJson(jsonFormat);
+  QCOMPARE(write(format, report()), expected);
+}
+
+void tst_reportwriter::tst_cbor() {
+  const QByteArray cbor = write(ReportWriter::Format::CBOR, report());
+  QCborParserError error;
+  const QCborValue value = QCborValue::fromCbor(cbor, &error);
+  QVERIFY(error.error == QCborError::NoError);
+  QCOMPARE(value.toJsonValue(),
+           QJsonValue(QJsonObject::fromVariantMap(report())));
+}
+
+void tst_reportwriter::tst_members() {
+  // A report written member by member equals the report written at once.
+  QBuffer buffer;
+  buffer.open(QIODevice::WriteOnly);
+  auto writer = ReportWriter::create(ReportWriter::Format::Compact, buffer);
+  writer->beginObject();
+  writer->member("cycles", 10);
+  writer->key("entries");
+  writer->beginArray();
+  writer->value(1.5);
+  writer->value(QVariantMap{{"a", 1}});
+  writer->endArray();
+  writer->endObject();
+  QCOMPARE(buffer.data(),
+           QByteArray(R"({"cycles":10,"entries":[1.5,{"a":1}]})"));
+}
+
+void tst_reportwriter::tst_parseFormat() {
+  QCOMPARE(*ReportWriter::parseFormat("indented"),
+           ReportWriter::Format::Indented);
+  QCOMPARE(*ReportWriter::parseFormat("compact"),
+           ReportWriter::Format::Compact);
+  QCOMPARE(*ReportWriter::parseFormat("cbor"), ReportWriter::Format::CBOR);
+  QVERIFY(!ReportWriter::parseFormat("xml"));
+}
+
+QTEST_MAIN(tst_reportwriter)
+#include "tst_reportwriter.moc"
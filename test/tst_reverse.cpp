@@ -18,7 +18,8 @@ using namespace Ripes;
 using namespace Assembler;
 
 // This test ensures that the 'reverse' feature works across register and memory
-// writes.
+// writes, and that processors are reversed to the latest write of a register
+// or address.
 
 class tst_reverse : public QObject {
   Q_OBJECT
@@ -29,6 +30,7 @@ private slots:
                 bool toFinish);
   void tst_reverse_regs();
   void tst_reverse_mem();
+  void tst_reverse_to_write();
 };
 
 using Registers = std::map<int, VInt>;
@@ -79,7 +81,8 @@ void tst_reverse::run_test(const ProcessorID &id, const QStringList &program,
 }
 
 void tst_reverse::tst_reverse_regs() {
-  for (auto processor : {ProcessorID::RV32_SS, ProcessorID::RV32_5S}) {
+  for (auto processor : {ProcessorID::RV32_SS, ProcessorID::RV32_5S,
+                         ProcessorID::RV32_ISS}) {
     QStringList program = QStringList() << ".text"
                                         << "li x10 0"
                                         << "addi x10 x10 1"
@@ -94,7 +97,8 @@ void tst_reverse::tst_reverse_regs() {
 }
 
 void tst_reverse::tst_reverse_mem() {
-  for (auto processor : {ProcessorID::RV32_SS, ProcessorID::RV32_5S}) {
+  for (auto processor : {ProcessorID::RV32_SS, ProcessorID::RV32_5S,
+                         ProcessorID::RV32_ISS}) {
     QStringList program = QStringList() << ".data"
                                         << "a: .word 42"
                                         << ".text"
@@ -109,5 +113,67 @@ void tst_reverse::tst_reverse_mem() {
   }
 }
 
+void tst_reverse::tst_reverse_to_write() {
+  // The loop spans multiple checkpoints of the ISS, such that the writes are
+  // found in different intervals between checkpoints.
+  QStringList program = QStringList() << ".data"
+                                      << "a: .word 0"
+                                      << ".text"
+                                      << "la a0 a"
+                                      << "li a1 5"
+                                      << "sw a1 0 a0"
+                                      << "li t0 3000"
+                                      << "loop:"
+                                      << "addi t0 t0 -1"
+                                      << "bnez t0 loop"
+                                      << "li x10 7";
+  ProcessorHandler::get()->selectProcessor(ProcessorID::RV32_ISS, {});
+  RipesSettings::getObserver(RIPES_GLOBALSIGNAL_REQRESET)->trigger();
+  auto loader = new ProgramLoader();
+  loader->loadTest(program.join("\n"));
+  auto proc = ProcessorHandler::get()->getProcessorNonConst();
+  proc->setMaxReverseCycles(100000);
+  const auto loaded = ProcessorHandler::getProgram();
+  const AInt text = loaded->getSection(TEXT_SECTION_NAME)->address;
+  const AInt data = loaded->getSection(".data")->address;
+  const auto pc = [&] { return AInt(proc->getPcForStage({0, 0})); };
+  const auto finish = [&] {
+    while (!proc->finished() && proc->getCycleCount() < 10000)
+      proc->clock();
+    QVERIFY(proc->finished());
+  };
+  finish();
+
+  auto cycle = proc->reverseToLastWrite(
+      {WriteQuery::Kind::Register, RVISA::GPR, 10});
+  QCOMPARE(cycle, std::optional<long long>(6005));
+  QCOMPARE(proc->getCycleCount(), 6005LL);
+  QCOMPARE(pc(), text + 28);
+
+  cycle = proc->reverseToLastWrite(
+      {WriteQuery::Kind::Register, RVISA::GPR, 5});
+  QCOMPARE(cycle, std::optional<long long>(6003));
+  QCOMPARE(pc(), text + 20);
+  QCOMPARE(proc->getRegister(RVISA::GPR, 5), VInt(1));
+
+  cycle = proc->reverseToLastWrite({WriteQuery::Kind::Memory, {}, 0, data, 4});
+  QCOMPARE(cycle, std::optional<long long>(3));
+  QCOMPARE(pc(), text + 12);
+  QCOMPARE(proc->getMemory().readMemConst(data, 4), VInt(0));
+
+  // Nothing has written t0 and the neighbouring word yet.
+  QVERIFY(!proc->reverseToLastWrite(
+      {WriteQuery::Kind::Register, RVISA::GPR, 5}));
+  QVERIFY(!proc->reverseToLastWrite(
+      {WriteQuery::Kind::Memory, {}, 0, data + 4, 4}));
+  QCOMPARE(proc->getCycleCount(), 3LL);
+
+  // Execution resumes from the write.
+  finish();
+  QCOMPARE(proc->getCycleCount(), 6006LL);
+  QCOMPARE(proc->getRegister(RVISA::GPR, 10), VInt(7));
+  QCOMPARE(proc->getMemory().readMemConst(data, 4), VInt(5));
+}
+
 QTEST_MAIN(tst_reverse)
 #include "tst_reverse.moc"
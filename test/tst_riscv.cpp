@@ -3,11 +3,13 @@
 #include <QStringList>
 #include <QtTest/QTest>
 
+#include "assembler/parallelfor.h"
 #include "processorhandler.h"
 #include "processorregistry.h"
-#include "ripessettings.h"
+#include "processors/RISC-V/riscv.h"
+#include "processors/RISC-V/rv_uncompress.h"
 #include "rvisainfo_common.h"
-#include "systemio.h"
+#include "simulationcontext.h"
 
 #if !defined(RISCV32_TEST_DIR) || !defined(RISCV64_TEST_DIR) ||                \
     !defined(RISCV32_C_TEST_DIR) || !defined(RISCV64_C_TEST_DIR)
@@ -21,6 +23,10 @@ static_assert(false, "RISCV test directiories must be defined");
  * - No .data segment is contained within the resulting .ELF file
  * As such, we directly copy the .text segment into the simulator memory and
  * execute the test.
+ *
+ * Each test is assembled once per ISA, and the program is shared by all
+ * processor models. The tests of a processor model are executed concurrently,
+ * each in its own simulation context.
  */
 
 using namespace Ripes;
@@ -41,30 +47,39 @@ static constexpr unsigned s_ecallopreg = 17; // a7
 static constexpr unsigned s_maxCycles = 10000;
 
 // Tests which contains instructions or assembler directives not yet supported
-const auto s_excludedTests = {"f", "ldst", "move", "recoding",
-                              /* fails on CI, unknown as of know */ "memory"};
+const auto s_excludedTests = {/* fails on CI, unknown as of know */ "memory"};
+// Tests of the F and D extensions, only run with both extensions enabled
+const auto s_floatTests = {"f", "ldst", "move", "recoding"};
 
 class tst_RISCV : public QObject {
   Q_OBJECT
 
 private:
-  void loadBinaryToSimulator(const QString &binFile);
-  bool skipTest(const QString &test);
-  QString executeSimulator();
-  QString dumpRegs();
+  struct RISCVTest {
+    QString path;
+    std::shared_ptr<Program> program;
+  };
 
-  QString m_currentTest;
+  void loadBinaryToSimulator(const QString &binFile);
+  bool skipTest(const QString &test, const QStringList &extensions);
+  /// Executes @p test in a context of its own, and returns an error message
+  /// if the test failed.
+  static QString executeTest(const ProcessorID &id,
+                             const QStringList &extensions,
+                             const RISCVTest &test);
+  static QString dumpRegs(const RipesProcessor *proc, const QString &test);
 
   void runTests(const ProcessorID &id, const QStringList &extensions,
                 const QStringList &testdirs);
 
-  void trapHandler();
-
-  bool m_stop = false;
   std::shared_ptr<Program> m_program;
-  QString m_err;
+  // Assembled tests, by the name of their ISA and their path.
+  std::map<std::pair<QString, QString>, std::shared_ptr<Program>> m_programs;
 
 private slots:
+  void testInstrParser();
+  void testRVCTable();
+  void testISAInterning();
 
   void testRV64_SingleCycle() {
     runTests(ProcessorID::RV64_SS, {"M", "C"},
@@ -78,10 +93,22 @@ private slots:
     runTests(ProcessorID::RV64_5S_NO_FW, {"M", "C"},
              {RISCV64_TEST_DIR, RISCV64_C_TEST_DIR});
   }
+  void testRV64_5StagePipelineBPGShare() {
+    runTests(ProcessorID::RV64_5S_BP_GSHARE, {"M", "C"},
+             {RISCV64_TEST_DIR, RISCV64_C_TEST_DIR});
+  }
   void testRV64_6SDual() {
     runTests(ProcessorID::RV64_6S_DUAL, {"M", "C"},
              {RISCV64_TEST_DIR, RISCV64_C_TEST_DIR});
   }
+  void testRV64_OOO4W() {
+    runTests(ProcessorID::RV64_OOO_4W, {"M", "C"},
+             {RISCV64_TEST_DIR, RISCV64_C_TEST_DIR});
+  }
+  void testRV64_ISS() {
+    runTests(ProcessorID::RV64_ISS, {"M", "C"},
+             {RISCV64_TEST_DIR, RISCV64_C_TEST_DIR});
+  }
 
   void testRV32_SingleCycle() {
     runTests(ProcessorID::RV32_SS, {"M", "C"},
@@ -91,6 +118,14 @@ private slots:
     runTests(ProcessorID::RV32_5S, {"M", "C"},
              {RISCV32_TEST_DIR, RISCV32_C_TEST_DIR});
   }
+  void testRV32_5StagePipelineBP2Bit() {
+    runTests(ProcessorID::RV32_5S_BP_2BIT, {"M", "C"},
+             {RISCV32_TEST_DIR, RISCV32_C_TEST_DIR});
+  }
+  void testRV32_5StagePipelineBPGShare() {
+    runTests(ProcessorID::RV32_5S_BP_GSHARE, {"M", "C"},
+             {RISCV32_TEST_DIR, RISCV32_C_TEST_DIR});
+  }
   void testRV32_5StagePipelineNOFW() {
     runTests(ProcessorID::RV32_5S_NO_FW, {"M", "C"},
              {RISCV32_TEST_DIR, RISCV32_C_TEST_DIR});
@@ -99,28 +134,112 @@ private slots:
     runTests(ProcessorID::RV32_6S_DUAL, {"M", "C"},
              {RISCV32_TEST_DIR, RISCV32_C_TEST_DIR});
   }
+  void testRV32_OOO2W() {
+    runTests(ProcessorID::RV32_OOO_2W, {"M", "C"},
+             {RISCV32_TEST_DIR, RISCV32_C_TEST_DIR});
+  }
+  void testRV32_ISS() {
+    runTests(ProcessorID::RV32_ISS, {"M", "C"},
+             {RISCV32_TEST_DIR, RISCV32_C_TEST_DIR});
+  }
+  void testRV32_ISS_FD() {
+    runTests(ProcessorID::RV32_ISS, {"M", "F", "D", "C"},
+             {RISCV32_TEST_DIR, RISCV32_C_TEST_DIR});
+  }
+  void testRV32_5StageGeneratedFD() {
+    runTests(ProcessorID::RV32_5S_GEN, {"M", "F", "D", "C"},
+             {RISCV32_TEST_DIR, RISCV32_C_TEST_DIR});
+  }
 };
 
-bool tst_RISCV::skipTest(const QString &test) {
+template <typename Fields>
+static void compareParsers(const std::vector<int> &widths) {
+  const auto reference = generateInstrParser<uint32_t>(widths);
+  uint32_t word = 0x12345678;
+  for (int i = 0; i < 1000; ++i) {
+    word = word * 1664525 + 1013904223;
+    const auto fields = Fields::parse(word);
+    QCOMPARE(std::vector<uint32_t>(fields.begin(), fields.end()),
+             reference(word));
+  }
+}
+
+void tst_RISCV::testInstrParser() {
+  // The compile-time field extractors match the run-time parser of each
+  // format.
+  using P = RVInstrParser;
+  compareParsers<P::R32Fields>({7, 5, 3, 5, 5, 7});
+  compareParsers<P::I32Fields>({7, 5, 3, 5, 12});
+  compareParsers<P::B32Fields>({7, 1, 4, 3, 5, 5, 6, 1});
+  compareParsers<P::U32Fields>({7, 5, 20});
+  compareParsers<P::J32Fields>({7, 5, 8, 1, 10, 1});
+  compareParsers<P::CA16Fields>({2, 3, 2, 3, 2, 1, 3, 16});
+  compareParsers<P::CIW16Fields>({2, 3, 8, 3, 16});
+  compareParsers<P::CB216Fields>({2, 5, 3, 2, 1, 3, 16});
+
+  // addi x1, x2, 5
+  constexpr auto fields = P::decodeI32Instr(0x00510093);
+  static_assert(fields[0] == 5 && fields[1] == 2 && fields[2] == 0 &&
+                fields[3] == 1 && fields[4] == RVISA::OpcodeID::OPIMM);
+}
+
+template <unsigned XLEN>
+static void compareRVCTable() {
+  const auto &table = RVCTable<XLEN>::get();
+  for (VInt i = 0; i < 0x10000; ++i) {
+    const VInt expansion = uncompressRVC<XLEN>(i);
+    QCOMPARE(table.expand(i), expansion);
+    QCOMPARE(table.valid(i), expansion != i);
+  }
+}
+
+void tst_RISCV::testRVCTable() {
+  // The precomputed expansions match uncompressRVC for every encoding.
+  compareRVCTable<32>();
+  compareRVCTable<64>();
+  // The all-zero encoding is illegal, and uncompressed encodings are invalid.
+  QVERIFY(!RVCTable<32>::get().valid(0x0000));
+  QVERIFY(RVCTable<32>::get().valid(0x0040));
+  QVERIFY(!RVCTable<32>::get().valid(0x0003));
+}
+
+void tst_RISCV::testISAInterning() {
+  // ISAs are interned by their set of extensions, regardless of its order.
+  const auto isa = ISAInfoRegistry::getISA<ISA::RV32I>({"M", "C"});
+  QCOMPARE(isa.get(), ISAInfoRegistry::getISA<ISA::RV32I>({"C", "M"}).get());
+  QVERIFY(isa != ISAInfoRegistry::getISA<ISA::RV32I>({"M"}));
+  QVERIFY(isa != ISAInfoRegistry::getISA<ISA::RV64I>({"M", "C"}));
+
+  const auto base = ISAInfoRegistry::getISA<ISA::RV32I>(QStringList());
+  QVERIFY(isa->eq(base.get(), {"C", "M", "M"}));
+  QVERIFY(!isa->eq(base.get(), {"M"}));
+  QVERIFY(!isa->eq(ISAInfoRegistry::getISA<ISA::RV64I>({}).get(), {"M", "C"}));
+  QCOMPARE(RVISA::supportsISA<32>().isa.get(), base.get());
+}
+
+bool tst_RISCV::skipTest(const QString &test, const QStringList &extensions) {
   for (const auto &t : s_excludedTests) {
     if (test.startsWith(t)) {
       return true;
     }
   }
+  if (!extensions.contains("F") || !extensions.contains("D")) {
+    for (const auto &t : s_floatTests) {
+      if (test.startsWith(t)) {
+        return true;
+      }
+    }
+  }
   return false;
 }
 
-QString tst_RISCV::dumpRegs() {
-  QString str = "\n" + m_currentTest + "\nRegister dump:";
-  str += "\t PC:" +
-         QString::number(
-             ProcessorHandler::getProcessor()->getPcForStage({0, 0}), 16) +
-         "\n";
-  const auto *isa = ProcessorHandler::currentISA();
+QString tst_RISCV::dumpRegs(const RipesProcessor *proc, const QString &test) {
+  QString str = "\n" + test + "\nRegister dump:";
+  str += "\t PC:" + QString::number(proc->getPcForStage({0, 0}), 16) + "\n";
+  const auto *isa = proc->implementsISA();
   for (const auto &regFile : isa->regInfos()) {
     for (unsigned i = 0; i < regFile->regCnt(); i++) {
-      const auto value = ProcessorHandler::getProcessor()->getRegister(
-          regFile->regFileName(), i);
+      const auto value = proc->getRegister(regFile->regFileName(), i);
       str += "\t" + regFile->regName(i) + ":" + regFile->regAlias(i) + ":\t" +
              QString::number(value) + " (0x" + QString::number(value, 16) +
              ")\n";
@@ -133,7 +252,7 @@ void tst_RISCV::loadBinaryToSimulator(const QString &binFile) {
   // Read test file
   QFile testFile(binFile);
   if (!testFile.open(QIODevice::ReadOnly)) {
-    QString err = "Test: '" + m_currentTest +
+    QString err = "Test: '" + binFile +
                   "' failed: Could not read compiled test file.";
     QFAIL(err.toStdString().c_str());
   }
@@ -145,100 +264,73 @@ void tst_RISCV::loadBinaryToSimulator(const QString &binFile) {
   ProcessorHandler::get()->loadProgram(m_program);
 }
 
-void tst_RISCV::trapHandler() {
-  unsigned status =
-      ProcessorHandler::getProcessor()->getRegister(RVISA::GPR, s_ecallreg);
-  if (status != s_success) {
-    m_err = "Test: '" + m_currentTest +
-            "' failed: Internal test error.\n\t test number: " +
-            QString::number(ProcessorHandler::getProcessor()->getRegister(
-                RVISA::GPR, s_statusreg));
-    m_err += dumpRegs();
-  }
-  m_stop |= true;
-}
-
-QString tst_RISCV::executeSimulator() {
-  m_stop = false;
-  m_err = QString();
-  bool maxCyclesReached = false;
-  unsigned cycles = 0;
-  do {
-    ProcessorHandler::getProcessorNonConst()->clock();
-
-    cycles++;
-
-    maxCyclesReached |= cycles >= s_maxCycles;
-    m_stop |= maxCyclesReached;
-  } while (!m_stop);
-
-  if (maxCyclesReached) {
-    m_err = "Test: '" + m_currentTest +
-            "' failed: Maximum cycle count reached\n\t test number: " +
-            QString::number(ProcessorHandler::getProcessor()->getRegister(
-                RVISA::GPR, s_statusreg));
-    m_err += dumpRegs();
+QString tst_RISCV::executeTest(const ProcessorID &id,
+                               const QStringList &extensions,
+                               const RISCVTest &test) {
+  // The test exits through the Exit2 system call, with a status of s_success
+  // if all of its checks passed.
+  SimulationContext context(id, extensions);
+  context.loadProgram(test.program);
+  const bool finished = context.run(s_maxCycles);
+  const auto *proc = context.processor();
+  const QString testNumber =
+      QString::number(proc->getRegister(RVISA::GPR, s_statusreg));
+  if (!finished) {
+    return "Test: '" + test.path +
+           "' failed: Maximum cycle count reached\n\t test number: " +
+           testNumber + dumpRegs(proc, test.path);
   }
-
-  // Test successful
-  return m_err;
+  if (proc->getRegister(RVISA::GPR, s_ecallopreg) != RVABI::Exit2 ||
+      proc->getRegister(RVISA::GPR, s_ecallreg) != s_success) {
+    return "Test: '" + test.path +
+           "' failed: Internal test error.\n\t test number: " + testNumber +
+           dumpRegs(proc, test.path);
+  }
+  return QString();
 }
 
 void tst_RISCV::runTests(const ProcessorID &id, const QStringList &extensions,
                          const QStringList &testDirs) {
+  ProcessorHandler::selectProcessor(id, extensions);
+  const QString isa = ProcessorHandler::currentISA()->name();
+
+  std::vector<RISCVTest> tests;
   for (const auto &testDir : testDirs) {
     const auto dir = QDir(testDir);
-    const auto testFiles = dir.entryList({"*.s"});
-    ProcessorHandler::selectProcessor(id, extensions);
-
-    for (const auto &test : testFiles) {
-      auto testPath = testDir + QString(QDir::separator()) + test;
-      m_currentTest = testPath;
-      if (skipTest(test))
+    for (const auto &test : dir.entryList({"*.s"})) {
+      if (skipTest(test, extensions))
         continue;
-
-      qInfo() << "Running test: " << m_currentTest;
-
-      // Assemble test file
-      auto f = QFile(testPath);
-      if (!f.open(QIODevice::ReadOnly)) {
-        QFAIL("Could not open test file");
-      }
-      const auto program =
-          ProcessorHandler::getAssembler()->assembleRaw(QString(f.readAll()));
-      if (program.errors.size() != 0) {
-        QString err = "Could not assemble program";
-        err += "\n errors were:";
-        err += program.errors.toString();
-        QFAIL(err.toStdString().c_str());
-      }
-      auto spProgram = std::make_shared<Program>(program.program);
-
-      // Override the ProcessorHandler's ECALL Exit2 handling. In doing so, we
-      // verify whether the correct test value was reached.
-      ProcessorHandler::getProcessorNonConst()->trapHandler = [=] {
-        if (ProcessorHandler::getProcessor()->getRegister(
-                RVISA::GPR, s_ecallopreg) == RVABI::Exit2) {
-          trapHandler();
-        } else {
-          const unsigned int function =
-              ProcessorHandler::getProcessor()->getRegister(RVISA::GPR,
-                                                            s_ecallopreg);
-          ProcessorHandler::getSyscallManagerNonConst().execute(function);
+      const auto testPath = testDir + QString(QDir::separator()) + test;
+      auto &program = m_programs[{isa, testPath}];
+      if (!program) {
+        // Assemble test file
+        auto f = QFile(testPath);
+        if (!f.open(QIODevice::ReadOnly)) {
+          QFAIL("Could not open test file");
         }
-      };
-      ProcessorHandler::get()->loadProgram(spProgram);
-      RipesSettings::getObserver(RIPES_GLOBALSIGNAL_REQRESET)->trigger();
-
-      const QString err = executeSimulator();
-      if (!err.isNull()) {
-        QFAIL(err.toStdString().c_str());
+        const auto res =
+            ProcessorHandler::getAssembler()->assembleRaw(QString(f.readAll()));
+        if (res.errors.size() != 0) {
+          QString err = "Could not assemble program " + testPath;
+          err += "\n errors were:";
+          err += res.errors.toString();
+          QFAIL(err.toStdString().c_str());
+        }
+        program = std::make_shared<Program>(res.program);
       }
+      tests.push_back({testPath, program});
+    }
+  }
 
-      qInfo() << "Test '" << m_currentTest << "' succeeded.";
-
-      SystemIO::reset(); // Close open files in between tests
+  std::vector<QString> errors(tests.size());
+  parallelFor(tests.size(), [&](size_t i) {
+    errors[i] = executeTest(id, extensions, tests[i]);
+  });
+  for (size_t i = 0; i < tests.size(); ++i) {
+    if (!errors[i].isNull()) {
+      QFAIL(errors[i].toStdString().c_str());
     }
+    qInfo() << "Test '" << tests[i].path << "' succeeded.";
   }
 }
 
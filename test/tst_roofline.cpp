@@ -0,0 +1,140 @@
+#include <QtTest/QTest>
+
+#include "cachesim/cachehierarchy.h"
+#include "cli/roofline.h"
+#include "processorhandler.h"
+#include "processorregistry.h"
+
+using namespace Ripes;
+
+// This test ensures that the roofline counts the operations and memory
+// traffic of each symbol, and tells memory-bound from compute-bound code.
+
+class tst_roofline : public QObject {
+  Q_OBJECT
+
+private slots:
+  void tst_classify();
+  void tst_peak();
+  void tst_bounds();
+};
+
+void tst_roofline::tst_classify() {
+  using C = Roofline::InstrClass;
+  QCOMPARE(Roofline::classify("add a0 a1 a2"), C::Operation);
+  QCOMPARE(Roofline::classify("mul t0 t1 t2"), C::Operation);
+  QCOMPARE(Roofline::classify("fadd.s ft0 ft1 ft2"), C::Operation);
+  // Single-bit instructions are not branches.
+  QCOMPARE(Roofline::classify("bset a0 a0 a1"), C::Operation);
+  QCOMPARE(Roofline::classify("vsext.vf2 v1 v2"), C::Operation);
+  QCOMPARE(Roofline::classify("lw t0 0(a0)"), C::Memory);
+  QCOMPARE(Roofline::classify("c.swsp ra 12(sp)"), C::Memory);
+  QCOMPARE(Roofline::classify("amoadd.w t0 t1 (a0)"), C::Memory);
+  QCOMPARE(Roofline::classify("vle32.v v1 (a0)"), C::Memory);
+  QCOMPARE(Roofline::classify("bne t1 x0 -12"), C::Control);
+  QCOMPARE(Roofline::classify("jal ra 16"), C::Control);
+  QCOMPARE(Roofline::classify("ecall"), C::System);
+  QCOMPARE(Roofline::classify("csrrs a0 cycle x0"), C::System);
+  QCOMPARE(Roofline::classify("Unknown instruction"), C::System);
+}
+
+void tst_roofline::tst_peak() {
+  QCOMPARE(Roofline::peakOpsPerCycle(ProcessorID::RV32_5S), 1.0);
+  QCOMPARE(Roofline::peakOpsPerCycle(ProcessorID::RV64_6S_DUAL), 2.0);
+  QCOMPARE(Roofline::peakOpsPerCycle(ProcessorID::RV32_OOO_4W), 4.0);
+  QCOMPARE(Roofline::peakOpsPerCycle(ProcessorID::RV64_MH_2), 2.0);
+}
+
+void tst_roofline::tst_bounds() {
+  // "stream" loads 16 words, each missing the data cache of one-word blocks,
+  // whereas "compute" only performs arithmetic.
+  const QString program = QStringList{".data",
+                                      "a: .zero 64",
+                                      ".text",
+                                      "la a0 a",
+                                      "li t1 16",
+                                      "stream:",
+                                      "lw t0 0(a0)",
+                                      "addi a0 a0 4",
+                                      "addi t1 t1 -1",
+                                      "bnez t1 stream",
+                                      "li t1 256",
+                                      "compute:",
+                                      "addi t2 t2 1",
+                                      "addi t1 t1 -1",
+                                      "bnez t1 compute"}
+                              .join("\n");
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_SS);
+  auto res = ProcessorHandler::getAssembler()->assembleRaw(program);
+  QVERIFY(res.errors.empty());
+  auto loaded = std::make_shared<Program>(res.program);
+  ProcessorHandler::loadProgram(loaded);
+
+  CacheHierarchyConfig config;
+  config.l1i = CachePreset{"l1i",
+                           2,
+                           5,
+                           1,
+                           WritePolicy::WriteBack,
+                           WriteAllocPolicy::WriteAllocate,
+                           ReplPolicy::LRU};
+  config.l1d = CachePreset{"l1d",
+                           0,
+                           2,
+                           0,
+                           WritePolicy::WriteBack,
+                           WriteAllocPolicy::WriteAllocate,
+                           ReplPolicy::LRU};
+  config.memoryLatency = 20;
+  CacheHierarchy caches(config);
+  caches.attachToProcessor();
+
+  auto *proc = ProcessorHandler::getProcessorNonConst();
+  proc->trapHandler = [] {};
+  Profiler profiler(loaded, 20);
+  profiler.attach(proc);
+  while (!proc->finished() && proc->getCycleCount() < 10000)
+    proc->clock();
+  profiler.detach();
+  QVERIFY(proc->finished());
+
+  const Roofline roofline(profiler, caches, ProcessorID::RV32_SS);
+  // A block of 4 bytes per 20 cycles.
+  QCOMPARE(roofline.peak(), 1.0);
+  QCOMPARE(roofline.bandwidth(), 0.2);
+  QCOMPARE(roofline.ridge(), 5.0);
+
+  const auto find = [&](const QString &name) {
+    for (const auto &point : roofline.symbols())
+      if (point.name == name)
+        return point;
+    return Roofline::Point();
+  };
+  const auto stream = find("stream");
+  QCOMPARE(stream.ops, 33LL);
+  QVERIFY(stream.bytes >= 16 * 4);
+  QVERIFY(roofline.memoryBound(stream));
+  QVERIFY(roofline.attainable(stream) < roofline.peak());
+
+  const auto compute = find("compute");
+  QCOMPARE(compute.ops, 512LL);
+  QVERIFY(compute.bytes > 0);
+  QVERIFY(!roofline.memoryBound(compute));
+  QCOMPARE(roofline.attainable(compute), roofline.peak());
+  QVERIFY(compute.performance() <= roofline.peak());
+  // The hottest symbol is ranked first.
+  QCOMPARE(roofline.symbols().front().name, QString("compute"));
+
+  long long ops = 0, bytes = 0;
+  for (const auto &point : roofline.symbols()) {
+    ops += point.ops;
+    bytes += point.bytes;
+  }
+  QCOMPARE(roofline.total().ops, ops);
+  QVERIFY(roofline.total().bytes >= bytes);
+  QCOMPARE(roofline.total().cycles, proc->getCycleCount());
+  QVERIFY(roofline.report(false).toString().contains("ops/byte"));
+}
+
+QTEST_MAIN(tst_roofline)
+#include "tst_roofline.moc"
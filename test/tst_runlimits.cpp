@@ -0,0 +1,106 @@
+#include <QElapsedTimer>
+#include <QSignalSpy>
+#include <QtTest/QTest>
+
+#include "processorhandler.h"
+#include "processorregistry.h"
+
+using namespace Ripes;
+
+// This test ensures that runs are stopped exactly at the cycle and instruction
+// bounds, and that the reached bound is reported. It also ensures that paced
+// runs clock the processor at their rate.
+
+class tst_runlimits : public QObject {
+  Q_OBJECT
+
+private slots:
+  void cleanup();
+  void tst_cycleLimit_data();
+  void tst_cycleLimit();
+  void tst_instructionLimit();
+  void tst_finished();
+  void tst_paced();
+
+private:
+  void run(ProcessorID id, const QStringList &program,
+           const ProcessorHandler::RunLimits &limits, unsigned rate = 0);
+};
+
+// A program which never finishes.
+static const QStringList s_loop = {".text", "loop:", "addi a0 a0 1",
+                                   "j loop"};
+
+void tst_runlimits::run(ProcessorID id, const QStringList &program,
+                        const ProcessorHandler::RunLimits &limits,
+                        unsigned rate) {
+  ProcessorHandler::selectProcessor(id, {"M"});
+  auto res = ProcessorHandler::getAssembler()->assembleRaw(program.join("\n"));
+  QVERIFY(res.errors.empty());
+  ProcessorHandler::loadProgram(std::make_shared<Program>(res.program));
+
+  ProcessorHandler::setRunLimits(limits);
+  QSignalSpy finished(ProcessorHandler::get(), &ProcessorHandler::runFinished);
+  if (rate != 0)
+    ProcessorHandler::runPaced(rate);
+  else
+    ProcessorHandler::run();
+  QVERIFY(finished.wait(10000));
+  // Waits for the run to have finished entirely.
+  ProcessorHandler::stopRun();
+}
+
+void tst_runlimits::cleanup() { ProcessorHandler::setRunLimits({}); }
+
+void tst_runlimits::tst_cycleLimit_data() {
+  QTest::addColumn<long long>("cycles");
+  // Bounds below, at and beyond the size of the batches of the run loop.
+  QTest::newRow("partial batch") << 100LL;
+  QTest::newRow("full batch") << 1024LL;
+  QTest::newRow("several batches") << 5000LL;
+}
+
+void tst_runlimits::tst_cycleLimit() {
+  QFETCH(long long, cycles);
+  run(ProcessorID::RV32_5S, s_loop, {cycles, 0});
+  if (QTest::currentTestFailed())
+    return;
+  QCOMPARE(ProcessorHandler::getProcessor()->getCycleCount(), cycles);
+  QCOMPARE(ProcessorHandler::runLimitReached(),
+           ProcessorHandler::RunLimit::Cycles);
+}
+
+void tst_runlimits::tst_instructionLimit() {
+  run(ProcessorID::RV32_SS, s_loop, {0, 3000});
+  if (QTest::currentTestFailed())
+    return;
+  QCOMPARE(ProcessorHandler::getProcessor()->getInstructionsRetired(), 3000LL);
+  QCOMPARE(ProcessorHandler::runLimitReached(),
+           ProcessorHandler::RunLimit::Instructions);
+}
+
+void tst_runlimits::tst_finished() {
+  // A program finishing within the bounds is not reported as bounded.
+  run(ProcessorID::RV32_5S, {".text", "li a0 1", "li a7 10", "ecall"},
+      {10000, 10000});
+  if (QTest::currentTestFailed())
+    return;
+  QVERIFY(ProcessorHandler::getProcessor()->finished());
+  QCOMPARE(ProcessorHandler::runLimitReached(),
+           ProcessorHandler::RunLimit::None);
+}
+
+void tst_runlimits::tst_paced() {
+  // 200 cycles at 1 kHz take 200 ms, of which the first cycle is clocked
+  // immediately.
+  QElapsedTimer timer;
+  timer.start();
+  run(ProcessorID::RV32_5S, s_loop, {200, 0}, 1000);
+  if (QTest::currentTestFailed())
+    return;
+  QCOMPARE(ProcessorHandler::getProcessor()->getCycleCount(), 200LL);
+  QVERIFY(timer.elapsed() >= 199);
+}
+
+QTEST_MAIN(tst_runlimits)
+#include "tst_runlimits.moc"
@@ -0,0 +1,64 @@
+#include <QtTest/QTest>
+
+#include <thread>
+
+#include "assembler/assembler.h"
+#include "processorhandler.h"
+#include "processors/interface/simprofiler.h"
+
+using namespace Ripes;
+
+// This test ensures that the simulator profiler only records once enabled,
+// attributes the time of nested scopes exclusively, and profiles the clocking
+// of processors.
+
+class tst_simprofiler : public QObject {
+  Q_OBJECT
+
+private slots:
+  void tst_scopes();
+  void tst_clock();
+};
+
+void tst_simprofiler::tst_scopes() {
+  { SimProfiler::Scope scope(SimProfiler::Syscalls); }
+  QCOMPARE(SimProfiler::results()[SimProfiler::Syscalls].calls, uint64_t(0));
+
+  SimProfiler::enable();
+  {
+    SimProfiler::Scope outer(SimProfiler::Propagation);
+    {
+      SimProfiler::Scope inner(SimProfiler::Signals);
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+  }
+  auto results = SimProfiler::results();
+  QCOMPARE(results[SimProfiler::Propagation].calls, uint64_t(1));
+  QCOMPARE(results[SimProfiler::Signals].calls, uint64_t(1));
+  QVERIFY(results[SimProfiler::Signals].seconds >= 0.04);
+  // The time of the nested scope is not attributed to the enclosing scope.
+  QVERIFY(results[SimProfiler::Propagation].seconds < 0.04);
+
+  SimProfiler::reset();
+  QCOMPARE(SimProfiler::results()[SimProfiler::Signals].calls, uint64_t(0));
+  SimProfiler::disable();
+}
+
+void tst_simprofiler::tst_clock() {
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_5S);
+  auto res = ProcessorHandler::getAssembler()->assembleRaw(
+      ".text\nloop:\naddi a0, a0, 1\nj loop");
+  QVERIFY(res.errors.empty());
+  ProcessorHandler::loadProgram(std::make_shared<Program>(res.program));
+  auto *proc = ProcessorHandler::getProcessorNonConst();
+  SimProfiler::enable();
+  for (int i = 0; i < 10; ++i)
+    proc->clock();
+  SimProfiler::disable();
+  const auto results = SimProfiler::results();
+  QCOMPARE(results[SimProfiler::Propagation].calls, uint64_t(10));
+  QCOMPARE(results[SimProfiler::Signals].calls, uint64_t(10));
+}
+
+QTEST_MAIN(tst_simprofiler)
+#include "tst_simprofiler.moc"
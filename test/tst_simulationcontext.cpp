@@ -0,0 +1,154 @@
+#include <QtTest/QTest>
+
+#include <thread>
+
+#include "processorhandler.h"
+#include "processorpool.h"
+#include "processorregistry.h"
+#include "simulationcontext.h"
+
+using namespace Ripes;
+
+// This test ensures that independent simulation contexts can be executed
+// concurrently, without interfering with each other or with the
+// ProcessorHandler, that runs stop at the resource limits of a context, and
+// that pooled processors are reused in a clean state.
+
+class tst_simulationcontext : public QObject {
+  Q_OBJECT
+
+private slots:
+  void tst_concurrent();
+  void tst_limits();
+  void tst_pool();
+};
+
+// Prints the integers [0; n[, and exits with code n.
+static QString printLoop(unsigned n) {
+  return QStringList{".text",
+                     "li s0 0",
+                     "li s1 " + QString::number(n),
+                     "loop:",
+                     "mv a0 s0",
+                     "li a7 1",
+                     "ecall",
+                     "addi s0 s0 1",
+                     "blt s0 s1 loop",
+                     "mv a0 s1",
+                     "li a7 93",
+                     "ecall"}
+      .join("\n");
+}
+
+void tst_simulationcontext::tst_concurrent() {
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_SS, {"M"});
+  constexpr unsigned nContexts = 8;
+
+  std::vector<std::unique_ptr<SimulationContext>> contexts;
+  std::vector<QString> expected;
+  for (unsigned i = 0; i < nContexts; ++i) {
+    const unsigned n = 10 * (i + 1);
+    auto res = ProcessorHandler::getAssembler()->assembleRaw(printLoop(n));
+    QVERIFY(res.errors.empty());
+    const auto id = i % 2 ? ProcessorID::RV32_SS : ProcessorID::RV32_ISS;
+    auto &context = contexts.emplace_back(
+        std::make_unique<SimulationContext>(id, QStringList{"M"}));
+    context->loadProgram(std::make_shared<Program>(res.program));
+
+    QString out;
+    for (unsigned j = 0; j < n; ++j)
+      out += QString::number(j);
+    expected.push_back(out + "\nProgram exited with code: " +
+                       QString::number(n) + "\n");
+  }
+
+  std::vector<std::thread> threads;
+  std::vector<char> finished(nContexts, false);
+  for (unsigned i = 0; i < nContexts; ++i)
+    threads.emplace_back([&, i] { finished[i] = contexts[i]->run(100000); });
+  for (auto &thread : threads)
+    thread.join();
+
+  for (unsigned i = 0; i < nContexts; ++i) {
+    QVERIFY(finished[i]);
+    QCOMPARE(contexts[i]->output(), expected[i]);
+  }
+
+  // The ProcessorHandler processor must not have been affected.
+  QCOMPARE(ProcessorHandler::getProcessor()->getCycleCount(), 0);
+}
+
+void tst_simulationcontext::tst_limits() {
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_SS, {"M"});
+  const auto load = [](SimulationContext &context, const QString &program) {
+    auto res = ProcessorHandler::getAssembler()->assembleRaw(program);
+    QVERIFY(res.errors.empty());
+    context.loadProgram(std::make_shared<Program>(res.program));
+  };
+
+  SimulationContext context(ProcessorID::RV32_SS, {"M"});
+  load(context, printLoop(1000));
+  SimulationContext::Limits limits;
+  limits.maxOutputBytes = 10;
+  context.setLimits(limits);
+  QVERIFY(!context.run(100000));
+  QCOMPARE(context.limitExceeded(), SimulationContext::Limit::OutputBytes);
+  QCOMPARE(context.output(), QString("0123456789"));
+
+  // Resetting the context clears the exceeded limit.
+  limits.maxOutputBytes = 0;
+  limits.maxCycles = 100;
+  context.setLimits(limits);
+  context.reset();
+  QCOMPARE(context.limitExceeded(), SimulationContext::Limit::None);
+  QVERIFY(!context.run());
+  QCOMPARE(context.limitExceeded(), SimulationContext::Limit::Cycles);
+  QCOMPARE(context.processor()->getCycleCount(), 100LL);
+
+  // Writes a word to each subsequent page of memory.
+  load(context, QStringList{".text", "li s0 0x10000000", "li t0 4096", "loop:",
+                            "sw t0 0(s0)", "add s0 s0 t0", "j loop"}
+                    .join("\n"));
+  limits.maxCycles = 0;
+  limits.maxPages = 16;
+  context.setLimits(limits);
+  QVERIFY(!context.run(100000));
+  QCOMPARE(context.limitExceeded(), SimulationContext::Limit::Pages);
+  QVERIFY(context.writtenPages().size() > 16);
+  QVERIFY(context.processor()->getCycleCount() < 100000);
+  QCOMPARE(context.describeLimit(SimulationContext::Limit::Pages),
+           QString("the limit of 16 written memory pages"));
+}
+
+void tst_simulationcontext::tst_pool() {
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_5S, {"M"});
+  auto &pool = ProcessorPool::get();
+  pool.clear();
+  pool.prewarm(ProcessorID::RV32_5S, {"M"}, 1);
+  QCOMPARE(pool.size(ProcessorID::RV32_5S, {"M"}), 1u);
+
+  // Stores 42 to memory, and exits with the code previously stored there.
+  auto res = ProcessorHandler::getAssembler()->assembleRaw(
+      QStringList{".text", "li s0 0x10000000", "lw a0 0(s0)", "li t0 42",
+                  "sw t0 0(s0)", "li a7 93", "ecall"}
+          .join("\n"));
+  QVERIFY(res.errors.empty());
+  const auto program = std::make_shared<Program>(res.program);
+
+  const RipesProcessor *processor = nullptr;
+  for (int i = 0; i < 2; ++i) {
+    SimulationContext context(ProcessorID::RV32_5S, {"M"});
+    QCOMPARE(pool.size(ProcessorID::RV32_5S, {"M"}), 0u);
+    if (processor)
+      QVERIFY(context.processor() == processor);
+    processor = context.processor();
+    context.loadProgram(program);
+    QVERIFY(context.run(1000));
+    QCOMPARE(context.output(), QString("\nProgram exited with code: 0\n"));
+  }
+  QCOMPARE(pool.size(ProcessorID::RV32_5S, {"M"}), 1u);
+  pool.clear();
+}
+
+QTEST_MAIN(tst_simulationcontext)
+#include "tst_simulationcontext.moc"
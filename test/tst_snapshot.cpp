@@ -0,0 +1,133 @@
+#include <QTemporaryDir>
+#include <QtTest/QTest>
+
+#include "processorhandler.h"
+#include "processorregistry.h"
+#include "simulationcontext.h"
+#include "snapshot.h"
+
+using namespace Ripes;
+
+// This test ensures that a simulation restored from a snapshot taken partway
+// through a program continues as the simulation of which the snapshot was
+// taken, and that snapshots are refused by contexts of another processor.
+
+class tst_snapshot : public QObject {
+  Q_OBJECT
+
+private slots:
+  void tst_roundTrip_data();
+  void tst_roundTrip();
+  void tst_processorMismatch();
+};
+
+// Stores the squares of [0; 64[ to an array, and prints their sum.
+static const QStringList s_program = {".data",
+                                      "squares: .zero 256",
+                                      ".text",
+                                      "la s0 squares",
+                                      "li s1 0",
+                                      "li s2 64",
+                                      "loop:",
+                                      "mul t0 s1 s1",
+                                      "sw t0 0(s0)",
+                                      "addi s0 s0 4",
+                                      "addi s1 s1 1",
+                                      "blt s1 s2 loop",
+                                      "la s0 squares",
+                                      "li a0 0",
+                                      "li s1 0",
+                                      "sum:",
+                                      "lw t0 0(s0)",
+                                      "add a0 a0 t0",
+                                      "addi s0 s0 4",
+                                      "addi s1 s1 1",
+                                      "blt s1 s2 sum",
+                                      "li a7 1",
+                                      "ecall",
+                                      "li a7 10",
+                                      "ecall"};
+
+static std::shared_ptr<Program> assemble() {
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_SS, {"M"});
+  auto res =
+      ProcessorHandler::getAssembler()->assembleRaw(s_program.join("\n"));
+  if (!res.errors.empty())
+    return nullptr;
+  return std::make_shared<Program>(res.program);
+}
+
+void tst_snapshot::tst_roundTrip_data() {
+  QTest::addColumn<ProcessorID>("id");
+  QTest::newRow("RV32_SS") << ProcessorID::RV32_SS;
+  QTest::newRow("RV32_5S") << ProcessorID::RV32_5S;
+  QTest::newRow("RV32_ISS") << ProcessorID::RV32_ISS;
+}
+
+void tst_snapshot::tst_roundTrip() {
+  QFETCH(ProcessorID, id);
+  const auto program = assemble();
+  QVERIFY(program);
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  const QString path = dir.filePath("snapshot.bin");
+
+  // The snapshot is taken halfway through storing the squares.
+  SimulationContext original(id, {"M"});
+  original.setTrackWrittenPages(true);
+  original.loadProgram(program);
+  QVERIFY(!original.run(200));
+  QString errorMessage;
+  QVERIFY2(Snapshot::save(original, path, errorMessage),
+           errorMessage.toStdString().c_str());
+
+  SimulationContext restored(id, {"M"});
+  restored.setTrackWrittenPages(true);
+  restored.loadProgram(program);
+  QVERIFY2(Snapshot::load(restored, path, errorMessage),
+           errorMessage.toStdString().c_str());
+  const auto *origProc = original.processor();
+  const auto *restProc = restored.processor();
+  QCOMPARE(restProc->getCycleCount(), origProc->getCycleCount());
+  QCOMPARE(restProc->getInstructionsRetired(),
+           origProc->getInstructionsRetired());
+
+  QVERIFY(original.run(100000));
+  QVERIFY(restored.run(100000));
+  QCOMPARE(restored.output(), original.output());
+  QCOMPARE(restProc->getCycleCount(), origProc->getCycleCount());
+  for (const auto &regFile : origProc->implementsISA()->regInfos()) {
+    for (unsigned i = 0; i < regFile->regCnt(); i++)
+      QCOMPARE(restProc->getRegister(regFile->regFileName(), i),
+               origProc->getRegister(regFile->regFileName(), i));
+  }
+  // The squares are the only data of the program.
+  const AInt squares = program->getSection(".data")->address;
+  for (AInt i = 0; i < 64; i++)
+    QCOMPARE(restProc->getMemory().readMemConst(squares + 4 * i, 4),
+             VInt(i * i));
+}
+
+void tst_snapshot::tst_processorMismatch() {
+  const auto program = assemble();
+  QVERIFY(program);
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  const QString path = dir.filePath("snapshot.bin");
+
+  SimulationContext original(ProcessorID::RV32_ISS, {"M"});
+  original.loadProgram(program);
+  QVERIFY(!original.run(100));
+  QString errorMessage;
+  QVERIFY2(Snapshot::save(original, path, errorMessage),
+           errorMessage.toStdString().c_str());
+
+  SimulationContext other(ProcessorID::RV32_SS, {"M"});
+  other.loadProgram(program);
+  QVERIFY(!Snapshot::load(other, path, errorMessage));
+  QVERIFY2(errorMessage.contains("was taken with the"),
+           errorMessage.toStdString().c_str());
+}
+
+QTEST_MAIN(tst_snapshot)
+#include "tst_snapshot.moc"
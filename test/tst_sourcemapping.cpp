@@ -0,0 +1,91 @@
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QTemporaryDir>
+#include <QtTest/QTest>
+
+#include "cli/programutilities.h"
+#include "elfio/elfio.hpp"
+#include "processorhandler.h"
+#include "processorregistry.h"
+
+using namespace Ripes;
+
+// This test ensures that source mappings are loaded upon first use, and that
+// the source mappings of ELF files are loaded from their cache.
+
+class tst_sourcemapping : public QObject {
+  Q_OBJECT
+
+private slots:
+  void tst_lazyLoading();
+  void tst_elfCache();
+};
+
+void tst_sourcemapping::tst_lazyLoading() {
+  Program program;
+  int loads = 0;
+  program.setSourceLoader(
+      [&](Program::SourceMapping &mapping, QString &sourceHash) {
+        loads++;
+        mapping[0x10].insert(3);
+        sourceHash = Program::calculateHash("source");
+      });
+  QCOMPARE(loads, 0);
+  QVERIFY(program.isSameSource("source"));
+  QCOMPARE(loads, 1);
+  QCOMPARE(program.getSourceMapping().at(0x10), std::set<unsigned>{3});
+  QVERIFY(!program.isSameSource("other"));
+  QCOMPARE(loads, 1);
+}
+
+void tst_sourcemapping::tst_elfCache() {
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_ISS, {"M"});
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  const QString path = dir.filePath("RanPi-RV32");
+  QVERIFY(QFile::copy(QString(RISCV32_TEST_DIR) + QDir::separator() +
+                          "../../examples/ELF/RanPi-RV32",
+                      path));
+
+  // Loading the source mapping parses the debug information once, and caches
+  // it next to the executable.
+  const auto load = [&](Program &program) {
+    auto reader = std::make_shared<ELFIO::elfio>();
+    QVERIFY(reader->load(path.toStdString()));
+    loadElfSections(program, *reader);
+    loadElfSourceMapping(program, reader, path);
+  };
+  Program parsed;
+  load(parsed);
+  QVERIFY(!QFile::exists(path + ".srcmap"));
+  parsed.getSourceMapping();
+  QVERIFY(QFile::exists(path + ".srcmap"));
+
+  // A valid cache is used instead of the debug information.
+  QFile elf(path);
+  QVERIFY(elf.open(QIODevice::ReadOnly));
+  const QByteArray elfHash =
+      QCryptographicHash::hash(elf.readAll(), QCryptographicHash::Sha1);
+  QFile source(dir.filePath("Ripes.abc123.c"));
+  QVERIFY(source.open(QIODevice::WriteOnly));
+  source.write("int main() {}\n");
+  source.close();
+  {
+    QFile cache(path + ".srcmap");
+    QVERIFY(cache.open(QIODevice::WriteOnly));
+    QDataStream out(&cache);
+    out << quint32(0x52534d43) << quint32(1) << elfHash << source.fileName()
+        << QString() << quint32(2);
+    out << quint64(0x100) << quint32(0) << quint64(0x104) << quint32(0);
+  }
+  Program cached;
+  load(cached);
+  const auto &mapping = cached.getSourceMapping();
+  QCOMPARE(mapping.size(), size_t(2));
+  QCOMPARE(mapping.at(0x104), std::set<unsigned>{0});
+  QVERIFY(cached.isSameSource("int main() {}\n"));
+}
+
+QTEST_MAIN(tst_sourcemapping)
+#include "tst_sourcemapping.moc"
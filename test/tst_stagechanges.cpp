@@ -0,0 +1,108 @@
+#include <QtTest/QTest>
+
+#include "processorhandler.h"
+#include "processorregistry.h"
+
+using namespace Ripes;
+
+// This test ensures that the stage changes reported by the processor models
+// match the stage information of the processor, and that the instructions of
+// variable-width programs are located by their addresses.
+
+class tst_stagechanges : public QObject {
+  Q_OBJECT
+
+private slots:
+  void tst_changes();
+  void tst_changes_data();
+  void tst_compressedIndex();
+
+private:
+  RipesProcessor *load(ProcessorID id, const QStringList &extensions);
+};
+
+static const QString s_program =
+    QStringList{".text", "li s0 1", "li s1 2", "add t0 s0 s1", "nop"}.join(
+        "\n");
+
+RipesProcessor *tst_stagechanges::load(ProcessorID id,
+                                       const QStringList &extensions) {
+  ProcessorHandler::selectProcessor(id, extensions);
+  auto res = ProcessorHandler::getAssembler()->assembleRaw(s_program);
+  if (!res.errors.empty())
+    return nullptr;
+  ProcessorHandler::loadProgram(std::make_shared<Program>(res.program));
+  auto *proc = ProcessorHandler::getProcessorNonConst();
+  proc->trapHandler = [] {};
+  return proc;
+}
+
+void tst_stagechanges::tst_changes_data() {
+  QTest::addColumn<int>("id");
+  // The program is RISC-V assembly.
+  for (int id = 0; id < ProcessorID::NUM_PROCESSORS; ++id)
+    if (ProcessorRegistry::isaFamily(ProcessorID(id)) == "RISC-V")
+      QTest::addRow("processor %d", id) << id;
+}
+
+void tst_stagechanges::tst_changes() {
+  QFETCH(int, id);
+  auto *proc = load(ProcessorID(id), {"M"});
+  QVERIFY(proc);
+  const unsigned stages = proc->structure().numStages();
+
+  // Initially, changes are reported from default stage information.
+  std::vector<StageInfo> infos;
+  for (const auto &change : proc->stageChanges(infos)) {
+    QCOMPARE(change.oldPC, AInt(0));
+    QCOMPARE(change.newPC, proc->stageInfo(change.stage).pc);
+  }
+  QCOMPARE(infos.size(), stages);
+  QVERIFY(proc->stageChanges(infos).empty());
+
+  while (!proc->finished() && proc->getCycleCount() < 100) {
+    std::vector<StageInfo> before = infos;
+    proc->clock();
+    const auto changes = proc->stageChanges(infos);
+    auto change = changes.begin();
+    unsigned i = 0;
+    for (auto idx : proc->structure().stageIt()) {
+      const StageInfo info = proc->stageInfo(idx);
+      QVERIFY(infos.at(i) == info);
+      if (before.at(i) != info) {
+        QVERIFY(change != changes.end());
+        QCOMPARE(change->stage, idx);
+        QCOMPARE(change->oldPC, before.at(i).pc);
+        QCOMPARE(change->newPC, info.pc);
+        ++change;
+      }
+      ++i;
+    }
+    QVERIFY(change == changes.end());
+  }
+  QVERIFY(proc->finished());
+}
+
+void tst_stagechanges::tst_compressedIndex() {
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_5S, {"M", "C"});
+  auto res = ProcessorHandler::getAssembler()->assembleRaw(
+      QStringList{".text", "c.li s0 1", "addi s1 s0 1000", "c.nop", "nop"}.join(
+          "\n"));
+  QVERIFY(res.errors.empty());
+  ProcessorHandler::loadProgram(std::make_shared<Program>(res.program));
+  const auto &disassembled = ProcessorHandler::getProgram()->getDisassembled();
+  QCOMPARE(disassembled.numInstructions(), 4u);
+  const AInt base = *disassembled.indexToAddress(0);
+  const std::vector<AInt> offsets = {0, 2, 6, 8};
+  for (unsigned idx = 0; idx < offsets.size(); ++idx) {
+    QCOMPARE(*disassembled.indexToAddress(idx), base + offsets.at(idx));
+    QCOMPARE(disassembled.addressToIndex(base + offsets.at(idx)),
+             std::optional<unsigned>(idx));
+  }
+  // Addresses within or beyond instructions do not locate an instruction.
+  for (AInt offset : {1, 4, 12})
+    QVERIFY(!disassembled.addressToIndex(base + offset).has_value());
+}
+
+QTEST_MAIN(tst_stagechanges)
+#include "tst_stagechanges.moc"
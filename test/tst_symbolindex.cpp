@@ -0,0 +1,75 @@
+#include <QtTest/QTest>
+
+#include "assembler/program.h"
+#include "assembler/symbolindex.h"
+
+using namespace Ripes;
+
+// This test ensures that symbols are looked up by their exact names and
+// prefixes, and searched by prefix, substring and subsequence, in that order.
+
+class tst_symbolindex : public QObject {
+  Q_OBJECT
+
+private slots:
+  void tst_lookup();
+  void tst_search();
+  void tst_program();
+
+private:
+  static QStringList names(const SymbolIndex &index,
+                           const std::vector<unsigned> &matches);
+};
+
+static const ReverseSymbolMap s_symbols = {
+    {0x10, Symbol("main")},       {0x20, Symbol("print_string")},
+    {0x30, Symbol("Print")},      {0x40, Symbol("printf")},
+    {0x50, Symbol("sprintf")},    {0x60, Symbol("pst")},
+    {0x70, Symbol("memset")}};
+
+QStringList tst_symbolindex::names(const SymbolIndex &index,
+                                   const std::vector<unsigned> &matches) {
+  QStringList names;
+  for (const unsigned match : matches)
+    names << index.entries().at(match).name;
+  return names;
+}
+
+void tst_symbolindex::tst_lookup() {
+  const SymbolIndex index(s_symbols);
+  QCOMPARE(index.entries().size(), s_symbols.size());
+  QCOMPARE(index.entries().front().name, QString("main"));
+  QCOMPARE(index.address("printf"), std::optional<AInt>(0x40));
+  QCOMPARE(index.address("Print"), std::optional<AInt>(0x30));
+  // Exact lookups are case-sensitive.
+  QVERIFY(!index.address("print"));
+  QVERIFY(!index.address("x"));
+
+  QCOMPARE(names(index, index.withPrefix("PRINT")),
+           QStringList({"Print", "print_string", "printf"}));
+  QVERIFY(index.withPrefix("q").empty());
+}
+
+void tst_symbolindex::tst_search() {
+  const SymbolIndex index(s_symbols);
+  QCOMPARE(names(index, index.search("pr")),
+           QStringList({"Print", "print_string", "printf", "sprintf"}));
+  QCOMPARE(names(index, index.search("pst")),
+           QStringList({"pst", "print_string"}));
+  QCOMPARE(names(index, index.search("mst")), QStringList({"memset"}));
+  QVERIFY(index.search("zz").empty());
+  QCOMPARE(index.search(QString()).size(), s_symbols.size());
+}
+
+void tst_symbolindex::tst_program() {
+  // Indices are built once, and shared by copies of the program.
+  Program program;
+  program.symbols = s_symbols;
+  const SymbolIndex &index = program.symbolIndex();
+  QCOMPARE(&program.symbolIndex(), &index);
+  const Program copy = program;
+  QCOMPARE(&copy.symbolIndex(), &index);
+}
+
+QTEST_APPLESS_MAIN(tst_symbolindex)
+#include "tst_symbolindex.moc"
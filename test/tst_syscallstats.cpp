@@ -0,0 +1,78 @@
+#include <QtTest/QTest>
+
+#include "processorhandler.h"
+#include "processorregistry.h"
+#include "syscall/ripes_syscall.h"
+
+using namespace Ripes;
+
+// This test ensures that the latencies of system calls are binned by powers of
+// two, and that every system call trapped by the processor is counted and
+// timed.
+
+class tst_syscallstats : public QObject {
+  Q_OBJECT
+
+private slots:
+  void tst_bucket();
+  void tst_record();
+  void tst_trapped();
+};
+
+void tst_syscallstats::tst_bucket() {
+  QCOMPARE(SyscallStats::bucket(0), 0u);
+  QCOMPARE(SyscallStats::bucket(1), 0u);
+  QCOMPARE(SyscallStats::bucket(2), 1u);
+  QCOMPARE(SyscallStats::bucket(3), 1u);
+  QCOMPARE(SyscallStats::bucket(1023), 9u);
+  QCOMPARE(SyscallStats::bucket(1024), 10u);
+  // Latencies beyond the last bucket are held by the last bucket.
+  QCOMPARE(SyscallStats::bucket(~uint64_t(0)), SyscallStats::c_buckets - 1);
+  for (unsigned i = 1; i < SyscallStats::c_buckets; ++i)
+    QCOMPARE(SyscallStats::bucket(SyscallStats::bucketStart(i)), i);
+}
+
+void tst_syscallstats::tst_record() {
+  SyscallStats stats;
+  QCOMPARE(stats.meanNs(), 0.0);
+  stats.record(100, false);
+  stats.record(300, true);
+  QCOMPARE(stats.timed, uint64_t(2));
+  QCOMPARE(stats.asyncCount, uint64_t(1));
+  QCOMPARE(stats.totalNs, uint64_t(400));
+  QCOMPARE(stats.maxNs, uint64_t(300));
+  QCOMPARE(stats.meanNs(), 200.0);
+  QCOMPARE(stats.histogram.at(SyscallStats::bucket(100)), uint64_t(1));
+  QCOMPARE(stats.histogram.at(SyscallStats::bucket(300)), uint64_t(1));
+}
+
+void tst_syscallstats::tst_trapped() {
+  constexpr unsigned c_calls = 5;
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_ISS, {"M"});
+  QStringList program = {".text"};
+  for (unsigned i = 0; i < c_calls; ++i)
+    program << "li a7 1" << "li a0 " + QString::number(i) << "ecall";
+  auto res = ProcessorHandler::getAssembler()->assembleRaw(program.join("\n"));
+  QVERIFY(res.errors.empty());
+  ProcessorHandler::loadProgram(std::make_shared<Program>(res.program));
+  ProcessorHandler::getSyscallManagerNonConst().resetStats();
+
+  auto *proc = ProcessorHandler::getProcessorNonConst();
+  while (!proc->finished() && proc->getCycleCount() < 100)
+    proc->clock();
+  QVERIFY(proc->finished());
+
+  const auto stats = ProcessorHandler::getSyscallManager().stats();
+  QCOMPARE(stats.size(), size_t(1));
+  const SyscallStats &printInt = stats.at(1);
+  QCOMPARE(printInt.count, uint64_t(c_calls));
+  QCOMPARE(printInt.timed, uint64_t(c_calls));
+  QCOMPARE(printInt.asyncCount, uint64_t(0));
+  uint64_t binned = 0;
+  for (auto count : printInt.histogram)
+    binned += count;
+  QCOMPARE(binned, uint64_t(c_calls));
+}
+
+QTEST_MAIN(tst_syscallstats)
+#include "tst_syscallstats.moc"
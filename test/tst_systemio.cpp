@@ -0,0 +1,203 @@
+#include <QBuffer>
+#include <QScopeGuard>
+#include <QTemporaryFile>
+#include <QtTest/QSignalSpy>
+#include <QtTest/QTest>
+
+#include <thread>
+
+#include "syscall/systemio.h"
+
+using namespace Ripes;
+
+// This test ensures that the output printed through SystemIO is emitted in
+// chunks, in order, and that the pending output is bounded. Furthermore, it
+// ensures that files are read and written byte-exact, regardless of how they
+// are backed, that stdin is served from a stdin source if set, and that
+// console input pushed in bulk is read a line at a time, including by reads
+// waiting for input on another thread.
+
+class tst_systemio : public QObject {
+  Q_OBJECT
+
+private slots:
+  void tst_coalesced();
+  void tst_flush();
+  void tst_bounded();
+  void tst_readFile();
+  void tst_readFile_data();
+  void tst_writeFile();
+  void tst_stdinSource();
+  void tst_consoleInput();
+
+private:
+  QByteArray m_data;
+};
+
+void tst_systemio::tst_coalesced() {
+  QSignalSpy spy(&SystemIO::get(), &SystemIO::doPrint);
+  for (const char c : QByteArray("hello"))
+    SystemIO::printString(QChar(c));
+  QCOMPARE(spy.count(), 0);
+  QTRY_COMPARE(spy.count(), 1);
+  QCOMPARE(spy.at(0).at(0).toString(), "hello");
+}
+
+void tst_systemio::tst_flush() {
+  QSignalSpy spy(&SystemIO::get(), &SystemIO::doPrint);
+  SystemIO::printString("a");
+  SystemIO::printString("b");
+  SystemIO::flushOutput();
+  QCOMPARE(spy.count(), 1);
+  QCOMPARE(spy.at(0).at(0).toString(), "ab");
+
+  // Nothing is emitted once the pending output is flushed.
+  QTest::qWait(50);
+  QCOMPARE(spy.count(), 1);
+}
+
+void tst_systemio::tst_bounded() {
+  QSignalSpy spy(&SystemIO::get(), &SystemIO::doPrint);
+  const QString line = QString(1023, 'x') + "\n";
+  for (int i = 0; i < 2048; ++i)
+    SystemIO::printString(line);
+  SystemIO::printString("end");
+  SystemIO::flushOutput();
+  QCOMPARE(spy.count(), 1);
+  const QString output = spy.at(0).at(0).toString();
+  QCOMPARE(output.size(), 1 << 20);
+  QVERIFY(output.endsWith("x\nend"));
+}
+
+void tst_systemio::tst_readFile_data() {
+  QTest::addColumn<int>("flags");
+  QTest::addColumn<bool>("empty");
+  // Read-only files are mapped, unless empty, and buffered otherwise.
+  QTest::addRow("read-only") << int(SystemIO::O_RDONLY) << false;
+  QTest::addRow("read-only, empty") << int(SystemIO::O_RDONLY) << true;
+  QTest::addRow("read-write") << int(SystemIO::O_RDWR) << false;
+}
+
+void tst_systemio::tst_readFile() {
+  QFETCH(int, flags);
+  QFETCH(bool, empty);
+
+  // Data spanning several read-ahead buffers, including all byte values.
+  QByteArray data;
+  if (!empty)
+    for (int i = 0; i < 200000; ++i)
+      data.append(static_cast<char>(i * 131 + (i >> 8)));
+  QTemporaryFile file;
+  QVERIFY(file.open());
+  file.write(data);
+  file.close();
+
+  const int fd = SystemIO::openFile(file.fileName(), flags);
+  QVERIFY(fd >= 0);
+  QByteArray read;
+  for (int chunk = 1; read.size() < data.size(); chunk = chunk * 3 + 1) {
+    QByteArray buffer;
+    QVERIFY(SystemIO::readFromFile(fd, buffer, chunk) > 0);
+    read.append(buffer);
+  }
+  QCOMPARE(read, data);
+
+  // Reads at the end of the file return the EOF sentinel.
+  QByteArray buffer;
+  QCOMPARE(SystemIO::readFromFile(fd, buffer, 16), int(sizeof(int)));
+  QCOMPARE(buffer, QByteArray(sizeof(int), EOF));
+
+  if (!empty) {
+    // Reads continue from seeked positions, backwards and forwards.
+    QCOMPARE(SystemIO::seek(fd, 70000, SEEK_SET), 70000);
+    QCOMPARE(SystemIO::readFromFile(fd, buffer, 100), 100);
+    QCOMPARE(buffer, data.mid(70000, 100));
+    QCOMPARE(SystemIO::seek(fd, 65500, SEEK_CUR), 135600);
+    QCOMPARE(SystemIO::readFromFile(fd, buffer, 100), 100);
+    QCOMPARE(buffer, data.mid(135600, 100));
+    QCOMPARE(SystemIO::seek(fd, -10, SEEK_END), 199990);
+    QCOMPARE(SystemIO::readFromFile(fd, buffer, 100), 10);
+    QCOMPARE(buffer, data.right(10));
+  }
+  SystemIO::closeFile(fd);
+}
+
+void tst_systemio::tst_writeFile() {
+  QTemporaryFile file;
+  QVERIFY(file.open());
+  file.close();
+
+  const int fd = SystemIO::openFile(file.fileName(), SystemIO::O_WRONLY);
+  QVERIFY(fd >= 0);
+  const QString text = "written through SystemIO\n";
+  QCOMPARE(SystemIO::writeToFile(fd, text, text.size()), int(text.size()));
+  QCOMPARE(SystemIO::writeToFile(fd, text, text.size()), int(text.size()));
+  SystemIO::closeFile(fd);
+
+  QVERIFY(file.open());
+  QCOMPARE(file.readAll(), (text + text).toUtf8());
+}
+
+void tst_systemio::tst_stdinSource() {
+  QBuffer input;
+  input.setData("first line\nsecond\n");
+  QVERIFY(input.open(QIODevice::ReadOnly));
+  SystemIO::setStdInSource(&input);
+  const auto reset = qScopeGuard([] { SystemIO::setStdInSource(nullptr); });
+
+  // Reads end after a newline, or once the requested length is read.
+  QByteArray buffer;
+  QCOMPARE(SystemIO::readFromFile(SystemIO::STDIN, buffer, 100), 11);
+  QCOMPARE(buffer, "first line\n");
+  QCOMPARE(SystemIO::readFromFile(SystemIO::STDIN, buffer, 3), 3);
+  QCOMPARE(buffer, "sec");
+  QCOMPARE(SystemIO::readFromFile(SystemIO::STDIN, buffer, 100), 4);
+  QCOMPARE(buffer, "ond\n");
+  // Reads past the end of the input signal EOF.
+  QCOMPARE(SystemIO::readFromFile(SystemIO::STDIN, buffer, 100), 0);
+  QVERIFY(buffer.isEmpty());
+}
+
+void tst_systemio::tst_consoleInput() {
+  SystemIO::reset();
+  const auto read = [](int length) {
+    QByteArray buffer;
+    SystemIO::readFromFile(SystemIO::STDIN, buffer, length);
+    return buffer;
+  };
+
+  // Input pasted in bulk is pushed in a single operation.
+  SystemIO::get().putStdInData("3\n1 2\n");
+  QCOMPARE(read(100), "3\n");
+  QCOMPARE(read(2), "1 ");
+  QCOMPARE(read(100), "2\n");
+  QCOMPARE(SystemIO::seek(SystemIO::STDIN, 0, SEEK_SET), 0);
+  QCOMPARE(read(100), "3\n");
+  SystemIO::reset();
+
+  // A reader waiting for input receives all lines in order, whether pushed a
+  // line at a time or in bulk.
+  constexpr int lines = 1000;
+  QByteArrayList received;
+  std::thread reader([&] {
+    for (int i = 0; i < lines; ++i)
+      received << read(100);
+  });
+  QByteArray bulk;
+  for (int i = 0; i < lines; ++i) {
+    const QByteArray line = QByteArray::number(i) + "\n";
+    if (i < lines / 2)
+      SystemIO::get().putStdInData(line);
+    else
+      bulk += line;
+  }
+  SystemIO::get().putStdInData(bulk);
+  reader.join();
+  QCOMPARE(received.size(), lines);
+  for (int i = 0; i < lines; ++i)
+    QCOMPARE(received[i], QByteArray::number(i) + "\n");
+  SystemIO::reset();
+}
+
+QTEST_MAIN(tst_systemio)
+#include "tst_systemio.moc"
@@ -0,0 +1,297 @@
+#include <QDir>
+#include <QRegularExpression>
+#include <QTemporaryDir>
+#include <QtTest/QTest>
+
+#include <atomic>
+#include <mutex>
+
+#include "processorhandler.h"
+#include "processorregistry.h"
+#include "taskcheck/taskchecker.h"
+
+using namespace Ripes;
+
+// This test ensures that the test cases of a task are graded by running the
+// program on the input of each case, and comparing the console output or the
+// return value of the program, and that the performance of passing tests is
+// scored against the budgets of the tests, and that programs diverging from
+// the reference solution of a task fail early, and that checks report their
+// tests as they complete and may be cancelled, and that generated inputs are
+// checked against the reference solution. Furthermore ensures that task
+// catalogues are loaded and indexed, and that reports are cached per
+// normalized submission, of which the least recently used are evicted.
+
+class tst_taskchecker : public QObject {
+  Q_OBJECT
+
+private slots:
+  void tst_checkTask();
+  void tst_catalogue();
+  void tst_resultCache();
+  void tst_resultCacheBound();
+  void tst_reference();
+  void tst_cancel();
+  void tst_generated();
+};
+
+// Reads an integer n, prints 2n and exits with code n + 1.
+static const QString s_program = QStringList{".text",
+                                             "li a7 5",
+                                             "ecall",
+                                             "mv s0 a0",
+                                             "add a0 s0 s0",
+                                             "li a7 1",
+                                             "ecall",
+                                             "addi a0 s0 1",
+                                             "li a7 93",
+                                             "ecall"}
+                                     .join("\n");
+
+void tst_taskchecker::tst_checkTask() {
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_5S, {"M"});
+  Task task(1, 1, "task", "text");
+  task.addTest(TestCase(TestType::printValue, "4\n", "8"));
+  task.addTest(TestCase(TestType::returnValue, "4\n", "5"));
+  task.addTest(TestCase(TestType::printValue, "3\n", "7"));
+  task.addTest(TestCase(TestType::returnValue, "-3\n", "-2"));
+  TestBudget budget;
+  budget.targetCycles = 1000;
+  task.addTest(TestCase(TestType::printValue, "4\n", "8", budget));
+  budget.maxInstructions = 3;
+  task.addTest(TestCase(TestType::returnValue, "4\n", "5", budget));
+
+  TaskChecker checker;
+  const QString answer =
+      QString::fromStdString(checker.checkTask(s_program, task));
+  QVERIFY2(answer.contains("Test 1: passed"), answer.toStdString().c_str());
+  QVERIFY2(answer.contains("Test 2: passed"), answer.toStdString().c_str());
+  QVERIFY2(answer.contains("Test 3: failed, expected '7' but got '6'"),
+           answer.toStdString().c_str());
+  QVERIFY2(answer.contains("Test 4: passed"), answer.toStdString().c_str());
+  QVERIFY2(answer.contains(QRegularExpression("Test 5: passed, [0-9]+ "
+                                               "cycles, .*; score 100%")),
+           answer.toStdString().c_str());
+  QVERIFY2(answer.contains("Test 6: failed, the program exceeded the budget "
+                           "of 3 instructions"),
+           answer.toStdString().c_str());
+  QVERIFY2(answer.contains("4 of 6 tests passed"),
+           answer.toStdString().c_str());
+  // The failed scored test scores nothing.
+  QVERIFY2(answer.contains("Performance score: 50%"),
+           answer.toStdString().c_str());
+
+  QVERIFY(QString::fromStdString(checker.checkTask(".text\nfoo", task))
+              .contains("syntax errors"));
+}
+
+void tst_taskchecker::tst_catalogue() {
+  QTemporaryDir dir;
+  QFile file(dir.filePath("tasks.json"));
+  QVERIFY(file.open(QIODevice::WriteOnly));
+  file.write(R"({
+    "version": "2",
+    "sections": [
+      {"name": "first", "tasks": [
+        {"number": 2, "name": "b", "text": "second task", "tests": []},
+        {"number": 1, "name": "a", "text": "first task", "processor": "RV32_SS",
+         "reference": ".text",
+         "generator": {"count": 10, "type": "return", "maxValue": 5},
+         "tests": [
+           {"type": "print", "input": "4", "output": "8"},
+           {"type": "return", "input": "4", "output": "5",
+            "budget": {"maxCycles": 100, "targetCPI": 1.5}}]}]},
+      {"name": "second", "tasks": [
+        {"number": 1, "name": "c", "text": "third task", "tests": []}]}]})");
+  file.close();
+
+  TaskChecker checker(file.fileName());
+  QCOMPARE(checker.getCatalogueVersion(), std::string("2"));
+  QCOMPARE(checker.getSectionNum(), 2u);
+  QCOMPARE(checker.getSectionTasks(1), (std::vector<unsigned>{1, 2}));
+  QCOMPARE(checker.getSectionTasks(2), (std::vector<unsigned>{1}));
+  QVERIFY(checker.findTask(3, 1) == nullptr);
+
+  const Task *task = checker.findTask(1, 1);
+  QVERIFY(task != nullptr);
+  QCOMPARE(task->getName(), std::string("a"));
+  QCOMPARE(task->getText(), std::string("first task"));
+  QCOMPARE(task->getProcessor(), std::optional(ProcessorID::RV32_SS));
+  QCOMPARE(task->getReference(), std::string(".text"));
+  const auto &tests = task->getTests();
+  QCOMPARE(tests.size(), size_t(2));
+  QCOMPARE(tests.at(0).getType(), TestType::printValue);
+  QCOMPARE(tests.at(1).getType(), TestType::returnValue);
+  QCOMPARE(tests.at(1).getBudget().maxCycles, 100LL);
+  QCOMPARE(tests.at(1).getBudget().targetCPI, 1.5);
+  QVERIFY(task->getGenerator().has_value());
+  QCOMPARE(task->getGenerator()->count, 10u);
+  QCOMPARE(task->getGenerator()->type, TestType::returnValue);
+  QCOMPARE(task->getGenerator()->maxValue, 5LL);
+
+  QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+  file.write(R"({"sections": [{"tasks": [{"number": 1, "tests": [
+                 {"type": "print", "budget": {"maxCycle": 1}}]}]}]})");
+  file.close();
+  TaskCatalogue catalogue;
+  QString errorMessage;
+  QVERIFY(!loadTaskCatalogue(file.fileName(), catalogue, errorMessage));
+  QCOMPARE(errorMessage,
+           QString("Unknown budget field 'maxCycle' of task 1.1"));
+}
+
+void tst_taskchecker::tst_resultCache() {
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_SS, {"M"});
+  QTemporaryDir dir;
+  TaskChecker::setResultCacheDirectory(dir.path());
+  Task task(2, 1, "task", "text");
+  task.addTest(TestCase(TestType::printValue, "4\n", "8"));
+
+  TaskChecker checker;
+  const QString reformatted =
+      "\n  " + QString(s_program).replace("\n", "\r\n\n");
+  QCOMPARE(checker.resultKey(reformatted, task),
+           checker.resultKey(s_program, task));
+  QVERIFY(checker.resultKey(s_program, Task(2, 2, "task", "text")) !=
+          checker.resultKey(s_program, task));
+
+  const std::string answer = checker.checkTask(s_program, task);
+  QVERIFY(QString::fromStdString(answer).contains("1 of 1 tests passed"));
+  QCOMPARE(QDir(dir.path()).entryList(QDir::Files).size(), 1);
+  QCOMPARE(checker.checkTask(reformatted, task), answer);
+  QCOMPARE(QDir(dir.path()).entryList(QDir::Files).size(), 1);
+  TaskChecker::setResultCacheDirectory(QString());
+}
+
+void tst_taskchecker::tst_resultCacheBound() {
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_SS, {"M"});
+  TaskChecker::setResultCacheEntries(2);
+  const auto makeTask = [](unsigned number) {
+    Task task(5, number, "task", "text");
+    task.addTest(TestCase(TestType::printValue, "4\n", "8"));
+    return task;
+  };
+
+  // The observer is only called for reports which are graded anew.
+  TaskChecker checker;
+  std::atomic<int> graded = 0;
+  checker.setTestObserver(
+      [&](size_t, size_t, const std::string &) { graded++; });
+  for (unsigned number = 1; number <= 3; ++number)
+    checker.checkTask(s_program, makeTask(number));
+  QCOMPARE(graded.load(), 3);
+  QCOMPARE(TaskChecker::cachedResults(), size_t(2));
+  checker.checkTask(s_program, makeTask(3));
+  QCOMPARE(graded.load(), 3);
+  // The report of the least recently used task was evicted.
+  checker.checkTask(s_program, makeTask(1));
+  QCOMPARE(graded.load(), 4);
+  QCOMPARE(TaskChecker::cachedResults(), size_t(2));
+  TaskChecker::setResultCacheEntries(TaskChecker::s_resultCacheEntries);
+}
+
+void tst_taskchecker::tst_reference() {
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_SS, {"M"});
+  Task task(3, 1, "task", "text");
+  task.setReference(s_program.toStdString());
+  task.addTest(TestCase(TestType::returnValue, "4\n", "5"));
+  TaskChecker checker;
+  QVERIFY(QString::fromStdString(checker.checkTask(s_program, task))
+              .contains("1 of 1 tests passed"));
+
+  // Prints 2n + 1 and loops forever.
+  const QString diverging = QStringList{".text", "li a7 5", "ecall",
+                                        "add a0 a0 a0", "addi a0 a0 1",
+                                        "li a7 1", "ecall", "loop:", "j loop"}
+                                .join("\n");
+  const QString answer =
+      QString::fromStdString(checker.checkTask(diverging, task));
+  QVERIFY2(answer.contains("Test 1: failed, the output diverges from the "
+                           "reference solution after 0 characters"),
+           answer.toStdString().c_str());
+
+  // Loops forever without printing, and is stopped after a multiple of the
+  // cycles of the reference solution.
+  const QRegularExpression cycles("did not finish within ([0-9]+) cycles");
+  const auto match = cycles.match(
+      QString::fromStdString(checker.checkTask(".text\nloop:\nj loop", task)));
+  QVERIFY(match.hasMatch());
+  QVERIFY(match.captured(1).toLongLong() < TaskChecker::s_maxCycles);
+}
+
+void tst_taskchecker::tst_cancel() {
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_SS, {"M"});
+  QTemporaryDir dir;
+  TaskChecker::setResultCacheDirectory(dir.path());
+  Task task(4, 1, "task", "text");
+  task.addTest(TestCase(TestType::returnValue, "1\n", "1"));
+  task.addTest(TestCase(TestType::returnValue, "0\n", "0"));
+
+  // Exits with code n, or loops forever if n is 0.
+  const QString program =
+      QStringList{".text", "li a7 5", "ecall", "beqz a0 loop", "li a7 93",
+                  "ecall", "loop:", "j loop"}
+          .join("\n");
+  TaskChecker checker;
+  std::vector<std::pair<size_t, std::string>> answers;
+  size_t reportedTests = 0;
+  std::mutex mutex;
+  checker.setTestObserver(
+      [&](size_t test, size_t tests, const std::string &answer) {
+        std::lock_guard<std::mutex> lock(mutex);
+        reportedTests = tests;
+        answers.emplace_back(test, answer);
+        if (test == 0)
+          checker.cancel();
+      });
+  const QString answer =
+      QString::fromStdString(checker.checkTask(program, task));
+  QVERIFY2(answer.contains("Test 1: passed"), answer.toStdString().c_str());
+  QVERIFY2(answer.contains("Test 2: cancelled"), answer.toStdString().c_str());
+  QVERIFY2(answer.contains("Check cancelled"), answer.toStdString().c_str());
+  QCOMPARE(reportedTests, size_t(2));
+  QCOMPARE(answers.size(), size_t(2));
+  QCOMPARE(answers.front().first, size_t(0));
+  QCOMPARE(answers.back().second, std::string("cancelled"));
+  // Cancelled reports are not cached.
+  QCOMPARE(QDir(dir.path()).entryList(QDir::Files).size(), 0);
+  TaskChecker::setResultCacheDirectory(QString());
+}
+
+void tst_taskchecker::tst_generated() {
+  InputGenerator generator;
+  generator.count = 50;
+  generator.sized = false;
+  generator.minSize = 1;
+  generator.maxSize = 1;
+  generator.edgeRate = 0.5;
+  QCOMPARE(generator.generate(7), generator.generate(7));
+  QVERIFY(generator.generate(7) != generator.generate(8));
+
+  ProcessorHandler::selectProcessor(ProcessorID::RV32_SS, {"M"});
+  Task task(5, 1, "task", "text");
+  task.setReference(s_program.toStdString());
+  task.addTest(TestCase(TestType::printValue, "4\n", "8"));
+  task.setGenerator(generator);
+  TaskChecker checker;
+  QString answer = QString::fromStdString(checker.checkTask(s_program, task));
+  QVERIFY2(answer.contains("Test 2: passed, 50 generated inputs"),
+           answer.toStdString().c_str());
+  QVERIFY2(answer.contains("2 of 2 tests passed"),
+           answer.toStdString().c_str());
+
+  // Prints 2n for positive n, and n otherwise.
+  const QString wrong =
+      QStringList{".text",  "li a7 5", "ecall",    "blez a0 print",
+                  "add a0 a0 a0", "print:", "li a7 1", "ecall",
+                  "li a7 10", "ecall"}
+          .join("\n");
+  answer = QString::fromStdString(checker.checkTask(wrong, task));
+  QVERIFY2(answer.contains("Test 2: failed on generated input"),
+           answer.toStdString().c_str());
+  QVERIFY2(answer.contains("1 of 2 tests passed"),
+           answer.toStdString().c_str());
+}
+
+QTEST_MAIN(tst_taskchecker)
+#include "tst_taskchecker.moc"
@@ -0,0 +1,49 @@
+#include <QtTest/QTest>
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+
+#include "tracespans.h"
+
+using namespace Ripes;
+
+// This test ensures that trace spans are only recorded once enabled, and are
+// written in the Chrome Trace Event format.
+
+class tst_tracespans : public QObject {
+  Q_OBJECT
+
+private slots:
+  void tst_record();
+};
+
+void tst_tracespans::tst_record() {
+  { TraceSpan span("Disabled"); }
+  TraceSpans::markOnce("Disabled mark");
+
+  TraceSpans::enable();
+  { TraceSpan span("Span"); }
+  TraceSpans::markOnce("Mark");
+  TraceSpans::markOnce("Mark");
+
+  QTemporaryDir dir;
+  const QString path = dir.filePath("trace.json");
+  QVERIFY(TraceSpans::write(path).isEmpty());
+  QFile file(path);
+  QVERIFY(file.open(QIODevice::ReadOnly));
+  const auto events =
+      QJsonDocument::fromJson(file.readAll())["traceEvents"].toArray();
+  QCOMPARE(events.size(), 2);
+  QCOMPARE(events[0]["name"].toString(), QString("Span"));
+  QCOMPARE(events[0]["ph"].toString(), QString("X"));
+  QVERIFY(events[0]["dur"].toInteger() >= 0);
+  QCOMPARE(events[1]["name"].toString(), QString("Mark"));
+  QCOMPARE(events[1]["ph"].toString(), QString("i"));
+
+  QVERIFY(!TraceSpans::write(dir.filePath("missing/trace.json")).isEmpty());
+}
+
+QTEST_APPLESS_MAIN(tst_tracespans)
+#include "tst_tracespans.moc"
@@ -0,0 +1,305 @@
+#include <QtTest/QTest>
+
+#include <array>
+#include <cstring>
+#include <random>
+
+#include "assembler/assembler.h"
+#include "isa/rv32isainfo.h"
+#include "processorhandler.h"
+#include "processorregistry.h"
+#include "processors/RISC-V/rv_vector.h"
+#include "programloader.h"
+
+using namespace Ripes;
+using namespace Assembler;
+
+// This test ensures that the vector (V) extension subset is assembled and
+// disassembled, that the functional model executes it for any VLEN, and that
+// the SIMD element loops agree with the element operations.
+
+class tst_vector : public ProcessorTest {
+  Q_OBJECT
+
+private slots:
+  void tst_encoding();
+  void tst_addLoop();
+  void tst_addLoop_data();
+  void tst_reductions();
+  void tst_strided();
+  void tst_configuration();
+  void tst_kernels();
+
+private:
+  static RipesProcessor *load(ProcessorID id, const QStringList &program,
+                              unsigned vlen = RVVectorUnit::c_defaultVLEN);
+};
+
+RipesProcessor *tst_vector::load(ProcessorID id, const QStringList &program,
+                                 unsigned vlen) {
+  auto *proc = ProcessorTest::load(id, program, {"M", "V"});
+  auto *vector = dynamic_cast<VectorProcessor *>(proc);
+  if (!vector)
+    return nullptr;
+  vector->setVLEN(vlen);
+  return proc;
+}
+
+void tst_vector::tst_encoding() {
+  auto isa = std::make_shared<ISAInfo<ISA::RV32I>>(QStringList{"V"});
+  ISA_Assembler<ISA::RV32I> assembler(isa);
+  const std::vector<std::pair<QString, uint32_t>> encodings = {
+      {"vsetvli t0, a0, e32, m1, ta, ma", 0x0D0572D7},
+      {"vsetivli t0, 4, e8, mf2, tu, mu", 0xC07272D7},
+      {"vsetvl t0, a0, a1", 0x80B572D7},
+      {"vle32.v v1, (a0)", 0x02056087},
+      {"vse32.v v1, (a0)", 0x020560A7},
+      {"vlse64.v v2, (a0), a1", 0x0AB57107},
+      {"vadd.vv v1, v2, v3", 0x022180D7},
+      {"vadd.vx v1, v2, a0", 0x022540D7},
+      {"vadd.vi v1, v2, -1", 0x022FB0D7},
+      {"vmul.vv v1, v2, v3", 0x9621A0D7},
+      {"vredsum.vs v1, v2, v3", 0x0221A0D7},
+      {"vmv.x.s a0, v2", 0x42202557},
+      {"vmv.s.x v1, a0", 0x420560D7}};
+
+  for (const auto &[line, word] : encodings) {
+    const auto res = assembler.assembleRaw(".text\n" + line);
+    QVERIFY2(res.errors.empty(), qPrintable(line));
+    const auto &data = res.program.getSection(".text")->data;
+    QCOMPARE(data.size(), qsizetype(4));
+    uint32_t encoded;
+    std::memcpy(&encoded, data.data(), sizeof(encoded));
+    QCOMPARE(encoded, word);
+
+    // Disassembling the word and assembling the result yields the word.
+    const auto disassembled = assembler.disassemble(encoded, {});
+    QVERIFY(!disassembled.err.has_value());
+    const auto again = assembler.assembleRaw(".text\n" + disassembled.repr);
+    QVERIFY2(again.errors.empty(), qPrintable(disassembled.repr));
+    QCOMPARE(again.program.getSection(".text")->data, data);
+  }
+
+  // Vector instructions are not available without the V extension.
+  auto base = std::make_shared<ISAInfo<ISA::RV32I>>(QStringList());
+  QVERIFY(!ISA_Assembler<ISA::RV32I>(base)
+               .assembleRaw(".text\nvadd.vv v1, v2, v3")
+               .errors.empty());
+}
+
+void tst_vector::tst_addLoop_data() {
+  QTest::addColumn<int>("id");
+  QTest::addColumn<unsigned>("vlen");
+  QTest::addColumn<long long>("iterations");
+  QTest::newRow("RV32 VLEN=128") << int(ProcessorID::RV32_ISS) << 128u << 3LL;
+  QTest::newRow("RV32 VLEN=256") << int(ProcessorID::RV32_ISS) << 256u << 2LL;
+  QTest::newRow("RV64 VLEN=64") << int(ProcessorID::RV64_ISS) << 64u << 5LL;
+  QTest::newRow("RV64 VLEN=1024") << int(ProcessorID::RV64_ISS) << 1024u
+                                  << 1LL;
+}
+
+void tst_vector::tst_addLoop() {
+  QFETCH(int, id);
+  QFETCH(unsigned, vlen);
+  QFETCH(long long, iterations);
+
+  // Adds two arrays of 10 words, strip-mined by vsetvli.
+  const QStringList program = {".data",
+                               "a: .word 1, 2, 3, 4, 5, 6, 7, 8, 9, 10",
+                               "b: .word 10, 20, 30, 40, 50, 60, 70, 80, 90, "
+                               "-100",
+                               "c: .zero 44",
+                               ".text",
+                               "la a1 a",
+                               "la a2 b",
+                               "la a3 c",
+                               "li a0 10",
+                               "li s0 0",
+                               "loop:",
+                               "vsetvli t0, a0, e32, m1, ta, ma",
+                               "vle32.v v1, (a1)",
+                               "vle32.v v2, (a2)",
+                               "vadd.vv v3, v1, v2",
+                               "vse32.v v3, (a3)",
+                               "slli t1, t0, 2",
+                               "add a1, a1, t1",
+                               "add a2, a2, t1",
+                               "add a3, a3, t1",
+                               "sub a0, a0, t0",
+                               "addi s0, s0, 1",
+                               "bnez a0, loop"};
+  auto *proc = load(ProcessorID(id), program, vlen);
+  QVERIFY(proc);
+  runToFinish(proc);
+  QVERIFY(proc->finished());
+  QCOMPARE(proc->getRegister(RVISA::GPR, 8), VInt(iterations));
+
+  const AInt c = ProcessorHandler::getProgram()->getSection(".data")->address +
+                 20 * sizeof(uint32_t);
+  std::array<int32_t, 11> sums;
+  ProcessorHandler::readMemBlock(c, reinterpret_cast<char *>(sums.data()),
+                                 sizeof(sums));
+  for (int i = 0; i < 9; ++i)
+    QCOMPARE(sums[i], 11 * (i + 1));
+  QCOMPARE(sums[9], -90);
+  // Bytes following the last element are not written.
+  QCOMPARE(sums[10], 0);
+}
+
+void tst_vector::tst_reductions() {
+  const QStringList program = {".text",
+                               "li a0 8",
+                               "li a1 -7",
+                               "vsetvli t0, a0, e16, m1, ta, ma",
+                               "vmv.v.i v1, 3",
+                               "vmv.s.x v2, zero",
+                               "vredsum.vs v3, v1, v2",
+                               "vmv.x.s s1, v3",
+                               "vadd.vi v1, v1, -5",
+                               "vmv.x.s s2, v1",
+                               "vredmax.vs v4, v1, v2",
+                               "vmv.x.s s3, v4",
+                               "vredmaxu.vs v4, v1, v2",
+                               "vmv.x.s s4, v4",
+                               "vmul.vx v5, v1, a1",
+                               "vredsum.vs v5, v5, v2",
+                               "vmv.x.s s5, v5"};
+  for (auto id : {ProcessorID::RV32_ISS, ProcessorID::RV64_ISS}) {
+    auto *proc = load(id, program);
+    QVERIFY(proc);
+    runToFinish(proc);
+    QVERIFY(proc->finished());
+    const auto reg = [&](unsigned i) {
+      return static_cast<int32_t>(proc->getRegister(RVISA::GPR, i));
+    };
+    QCOMPARE(reg(5), 8);
+    QCOMPARE(reg(9), 24);
+    // Elements are sign-extended by vmv.x.s.
+    QCOMPARE(reg(18), -2);
+    QCOMPARE(reg(19), 0);
+    QCOMPARE(reg(20), -2);
+    QCOMPARE(reg(21), 8 * 14);
+  }
+}
+
+void tst_vector::tst_strided() {
+  // Sums every other doubleword through a strided load.
+  const QStringList program = {".data",
+                               "a: .dword 1, 2, 3, 4, 5, 6, 7, 8",
+                               ".text",
+                               "la a1 a",
+                               "li a2 16",
+                               "li a0 4",
+                               "vsetvli t0, a0, e64, m2, ta, ma",
+                               "vlse64.v v2, (a1), a2",
+                               "vmv.s.x v1, zero",
+                               "vredsum.vs v1, v2, v1",
+                               "vmv.x.s s1, v1",
+                               "vsse64.v v2, (a1), a2",
+                               "vle64.v v4, (a1)",
+                               "vredsum.vs v1, v4, v1",
+                               "vmv.x.s s2, v1"};
+  auto *proc = load(ProcessorID::RV64_ISS, program);
+  QVERIFY(proc);
+  runToFinish(proc);
+  QVERIFY(proc->finished());
+  QCOMPARE(proc->getRegister(RVISA::GPR, 9), VInt(1 + 3 + 5 + 7));
+  // The strided store leaves the array unchanged.
+  QCOMPARE(proc->getRegister(RVISA::GPR, 18), VInt(1 + 2 + 3 + 4 + 16));
+}
+
+void tst_vector::tst_configuration() {
+  const QStringList program = {".text",
+                               "li a0 100",
+                               "vsetvli t0, a0, e8, m8, tu, mu",
+                               "vsetvli t1, zero, e64, m1, tu, mu",
+                               "vsetvli zero, zero, e32, m2, tu, mu",
+                               "vsetivli t2, 3, e16, mf2, ta, ma",
+                               "vsetvli t3, a0, e64, mf8, ta, ma",
+                               "vsetvli t4, a0, e8, m1, ta, ma",
+                               "vadd.vi v1, v1, 1",
+                               "vmv.x.s t5, v1"};
+  auto *proc = load(ProcessorID::RV32_ISS, program, 256);
+  QVERIFY(proc);
+  runToFinish(proc);
+  QVERIFY(proc->finished());
+  // VLMAX = VLEN / SEW * LMUL
+  QCOMPARE(proc->getRegister(RVISA::GPR, 5), VInt(100));
+  QCOMPARE(proc->getRegister(RVISA::GPR, 6), VInt(4));
+  QCOMPARE(proc->getRegister(RVISA::GPR, 7), VInt(3));
+  // Unsupported settings set vill, and clear vl.
+  QCOMPARE(proc->getRegister(RVISA::GPR, 28), VInt(0));
+  QCOMPARE(proc->getRegister(RVISA::GPR, 29), VInt(32));
+  QCOMPARE(proc->getRegister(RVISA::GPR, 30), VInt(1));
+
+  // Resetting the processor clears the vector registers.
+  proc->resetProcessor();
+  runToFinish(proc);
+  QCOMPARE(proc->getRegister(RVISA::GPR, 30), VInt(1));
+}
+
+template <typename T, typename Op>
+static bool kernelMatches(std::mt19937_64 &rng) {
+  using namespace RVVector;
+  for (size_t n = 0; n < 40; ++n) {
+    std::vector<uint8_t> a(n * sizeof(T)), b(a.size()), d(a.size());
+    for (auto *bytes : {&a, &b, &d})
+      for (auto &byte : *bytes)
+        byte = static_cast<uint8_t>(rng());
+    const T s = static_cast<T>(rng());
+
+    binary<T, Op>(d.data(), a.data(), b.data(), s, n);
+    for (size_t i = 0; i < n; ++i)
+      if (element<T>(d.data(), i) !=
+          Op::template apply<T>(element<T>(a.data(), i),
+                                element<T>(b.data(), i)))
+        return false;
+    binary<T, Op>(d.data(), a.data(), nullptr, s, n);
+    for (size_t i = 0; i < n; ++i)
+      if (element<T>(d.data(), i) !=
+          Op::template apply<T>(element<T>(a.data(), i), s))
+        return false;
+
+    T expected = s;
+    for (size_t i = 0; i < n; ++i)
+      expected = Op::template apply<T>(expected, element<T>(a.data(), i));
+    if (reduce<T, Op>(a.data(), n, s) != expected)
+      return false;
+  }
+  return true;
+}
+
+template <typename T>
+static bool kernelsMatch(std::mt19937_64 &rng) {
+  using namespace RVVector;
+  return kernelMatches<T, Add>(rng) && kernelMatches<T, And>(rng) &&
+         kernelMatches<T, Or>(rng) && kernelMatches<T, Xor>(rng) &&
+         kernelMatches<T, Min<true>>(rng) &&
+         kernelMatches<T, Min<false>>(rng) &&
+         kernelMatches<T, Max<true>>(rng) && kernelMatches<T, Max<false>>(rng);
+}
+
+void tst_vector::tst_kernels() {
+  // The block operations agree with the element operations for all element
+  // widths and lengths, including partial blocks.
+  std::mt19937_64 rng(1);
+  QVERIFY(kernelsMatch<uint8_t>(rng));
+  QVERIFY(kernelsMatch<uint16_t>(rng));
+  QVERIFY(kernelsMatch<uint32_t>(rng));
+  QVERIFY(kernelsMatch<uint64_t>(rng));
+
+  // Non-associative operations are only applied elementwise.
+  std::vector<uint8_t> a(8 * sizeof(uint32_t)), d(a.size());
+  for (unsigned i = 0; i < 8; ++i)
+    RVVector::setElement<uint32_t>(a.data(), i, i * 0x10000001u);
+  RVVector::binary<uint32_t, RVVector::Mul>(d.data(), a.data(), nullptr, 3u, 8);
+  for (unsigned i = 0; i < 8; ++i)
+    QCOMPARE(RVVector::element<uint32_t>(d.data(), i), i * 0x30000003u);
+  RVVector::binary<uint32_t, RVVector::Sub>(d.data(), a.data(), a.data(), 0u,
+                                            8);
+  for (unsigned i = 0; i < 8; ++i)
+    QCOMPARE(RVVector::element<uint32_t>(d.data(), i), 0u);
+}
+
+QTEST_APPLESS_MAIN(tst_vector)
+#include "tst_vector.moc"
@@ -0,0 +1,138 @@
+#include <QSignalSpy>
+#include <QtTest/QTest>
+
+#include "processorhandler.h"
+#include "processorregistry.h"
+
+using namespace Ripes;
+
+// This test ensures that runs stop at the accesses of watched memory and at
+// the writes of watched registers, that the cycle and PC of the hit are
+// reported, and that resumed runs continue past the hit.
+
+class tst_watchpoints : public QObject {
+  Q_OBJECT
+
+private slots:
+  void cleanup();
+  void tst_memory_data();
+  void tst_memory();
+  void tst_register_data();
+  void tst_register();
+  void tst_lookup();
+
+private:
+  std::shared_ptr<Program> load(ProcessorID id, const QStringList &program);
+  void run();
+};
+
+std::shared_ptr<Program> tst_watchpoints::load(ProcessorID id,
+                                               const QStringList &program) {
+  ProcessorHandler::selectProcessor(id, {"M"});
+  auto res = ProcessorHandler::getAssembler()->assembleRaw(program.join("\n"));
+  if (!res.errors.empty())
+    return nullptr;
+  auto loaded = std::make_shared<Program>(res.program);
+  ProcessorHandler::loadProgram(loaded);
+  return loaded;
+}
+
+void tst_watchpoints::run() {
+  QSignalSpy finished(ProcessorHandler::get(), &ProcessorHandler::runFinished);
+  ProcessorHandler::run();
+  QVERIFY(finished.wait(10000));
+  // Waits for the run to have finished entirely.
+  ProcessorHandler::stopRun();
+}
+
+void tst_watchpoints::cleanup() { ProcessorHandler::watchpoints().clear(); }
+
+void tst_watchpoints::tst_memory_data() {
+  QTest::addColumn<int>("id");
+  QTest::newRow("ISS") << int(ProcessorID::RV32_ISS);
+  QTest::newRow("5-stage") << int(ProcessorID::RV32_5S);
+}
+
+void tst_watchpoints::tst_memory() {
+  QFETCH(int, id);
+  // The watched word is written twice and read once; the neighbouring word is
+  // written as well.
+  const auto program =
+      load(ProcessorID(id),
+           {".data", "buf: .zero 16", ".text", "la t0 buf", "li t1 2", "loop:",
+            "sw t1 8(t0)", "sw t1 4(t0)", "addi t1 t1 -1", "bnez t1 loop",
+            "lw t2 8(t0)", "li a7 10", "ecall"});
+  QVERIFY(program);
+  const AInt buf = program->getSection(".data")->address;
+  const AInt store = program->getSection(TEXT_SECTION_NAME)->address + 12;
+  ProcessorHandler::watchpoints().addMemory(
+      {buf + 8, buf + 11, Watchpoints::Write});
+
+  for (int i = 0; i < 2; i++) {
+    QSignalSpy triggered(ProcessorHandler::get(),
+                         &ProcessorHandler::watchpointTriggered);
+    run();
+    const auto &hit = ProcessorHandler::watchpointHit();
+    QVERIFY(hit);
+    QVERIFY(!ProcessorHandler::getProcessor()->finished());
+    QCOMPARE(hit->kind, Watchpoints::Hit::Kind::Memory);
+    QCOMPARE(hit->access, MemoryAccess::Write);
+    QCOMPARE(hit->address, buf + 8);
+    QCOMPARE(hit->pc, store);
+    QCOMPARE(hit->cycle, ProcessorHandler::getProcessor()->getCycleCount());
+    QCOMPARE(triggered.count(), 1);
+  }
+
+  // Reads are not watched.
+  run();
+  QVERIFY(!ProcessorHandler::watchpointHit());
+  QVERIFY(ProcessorHandler::getProcessor()->finished());
+}
+
+void tst_watchpoints::tst_register_data() { tst_memory_data(); }
+
+void tst_watchpoints::tst_register() {
+  QFETCH(int, id);
+  const auto program =
+      load(ProcessorID(id), {".text", "li a0 1", "li a1 5", "li a0 2",
+                             "li a1 6", "li a7 10", "ecall"});
+  QVERIFY(program);
+  const AInt text = program->getSection(TEXT_SECTION_NAME)->address;
+  QVERIFY(ProcessorHandler::watchpoints().addRegister({RVISA::GPR, 11}));
+
+  for (const AInt pc : {text + 4, text + 12}) {
+    run();
+    const auto &hit = ProcessorHandler::watchpointHit();
+    QVERIFY(hit);
+    QCOMPARE(hit->kind, Watchpoints::Hit::Kind::Register);
+    QCOMPARE(hit->index, 11u);
+    QCOMPARE(hit->pc, pc);
+  }
+  run();
+  QVERIFY(!ProcessorHandler::watchpointHit());
+  QVERIFY(ProcessorHandler::getProcessor()->finished());
+}
+
+void tst_watchpoints::tst_lookup() {
+  Watchpoints watchpoints;
+  QVERIFY(watchpoints.empty());
+  watchpoints.addMemory({0x2000, 0x2fff, Watchpoints::Read});
+  watchpoints.addMemory({0x2ffc, 0x3003, Watchpoints::Write});
+  QCOMPARE(watchpoints.memoryAccess(0x1fff), 0u);
+  QCOMPARE(watchpoints.memoryAccess(0x2000), unsigned(Watchpoints::Read));
+  QCOMPARE(watchpoints.memoryAccess(0x2ffc), unsigned(Watchpoints::ReadWrite));
+  QCOMPARE(watchpoints.memoryAccess(0x3003), unsigned(Watchpoints::Write));
+  watchpoints.removeMemory(0x2ffd);
+  QCOMPARE(watchpoints.memoryAccess(0x2000), 0u);
+  QVERIFY(watchpoints.memory().empty());
+
+  QVERIFY(watchpoints.addRegister({RVISA::GPR, 5}));
+  QVERIFY(!watchpoints.addRegister({RVISA::GPR, 64}));
+  QVERIFY(watchpoints.hasRegister({RVISA::GPR, 5}));
+  QVERIFY(!watchpoints.hasRegister({RVISA::GPR, 6}));
+  watchpoints.removeRegister({RVISA::GPR, 5});
+  QVERIFY(watchpoints.empty());
+}
+
+QTEST_MAIN(tst_watchpoints)
+#include "tst_watchpoints.moc"
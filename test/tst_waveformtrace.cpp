@@ -0,0 +1,104 @@
+#include <QtTest/QTest>
+
+#include <QTemporaryDir>
+
+#include "waveformtrace.h"
+
+using namespace Ripes;
+
+// This test ensures that waveform traces only record changes of values, that
+// compressed traces decompress to the plain trace, and that components are
+// selected by their paths.
+
+class tst_waveformtrace : public QObject {
+  Q_OBJECT
+
+private slots:
+  void tst_plain();
+  void tst_compressed();
+  void tst_filter();
+
+private:
+  QByteArray trace(const QString &name);
+  QTemporaryDir m_dir;
+};
+
+QByteArray tst_waveformtrace::trace(const QString &name) {
+  const QString path = m_dir.filePath(name);
+  QString error;
+  auto trace = WaveformTrace::open(path,
+                                   {{"cpu.pc_reg.out", 32},
+                                    {"cpu.pc_reg.enable", 1},
+                                    {"cpu.stall", 1}},
+                                   error);
+  if (!trace)
+    qFatal("%s", qPrintable(error));
+  const WaveformTrace::Value samples[][3] = {
+      {0, 1, 0}, {4, 1, 0}, {4, 0, 1}, {4, 0, 1}, {0x1FFFFFFFF, 1, 0}};
+  for (int cycle = 0; cycle < 5; cycle++)
+    trace->sample(cycle, samples[cycle]);
+  // Reversed cycles are not traced.
+  trace->sample(2, samples[0]);
+  if (const QString err = trace->close(); !err.isEmpty())
+    qFatal("%s", qPrintable(err));
+
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly))
+    qFatal("Failed to read %s", qPrintable(path));
+  return file.readAll();
+}
+
+void tst_waveformtrace::tst_plain() {
+  const QByteArray vcd = trace("plain.vcd");
+  QVERIFY(vcd.contains("$scope module cpu $end\n"
+                       "$scope module pc_reg $end\n"
+                       "$var wire 32 ! out $end\n"
+                       "$var wire 1 \" enable $end\n"
+                       "$upscope $end\n"
+                       "$var wire 1 # stall $end\n"
+                       "$upscope $end\n"));
+  // Values are masked to the width of their signal.
+  QVERIFY(vcd.endsWith("$enddefinitions $end\n"
+                       "#0\nb0 !\n1\"\n0#\n"
+                       "#1\nb100 !\n"
+                       "#2\n0\"\n1#\n"
+                       "#4\nb11111111111111111111111111111111 !\n1\"\n0#\n"));
+}
+
+void tst_waveformtrace::tst_compressed() {
+  const QByteArray gz = trace("compressed.vcd.gz");
+  QVERIFY(gz.startsWith("\x1f\x8b\x08"));
+
+  // The trace is a single gzip member, whose deflate stream is inflated by
+  // qUncompress when given a zlib header and checksum.
+  const QByteArray deflate = gz.mid(10, gz.size() - 18);
+  const QByteArray plain = trace("plain.vcd");
+  quint32 a = 1, b = 0;
+  for (const char byte : plain) {
+    a = (a + static_cast<uchar>(byte)) % 65521;
+    b = (b + a) % 65521;
+  }
+  QByteArray zlib;
+  const auto appendBE32 = [&](quint32 value) {
+    for (int i = 3; i >= 0; i--)
+      zlib.append(static_cast<char>((value >> (8 * i)) & 0xFF));
+  };
+  appendBE32(plain.size());
+  zlib.append("\x78\x9c", 2);
+  zlib.append(deflate);
+  appendBE32((b << 16) | a);
+  QCOMPARE(qUncompress(zlib), plain);
+}
+
+void tst_waveformtrace::tst_filter() {
+  QVERIFY(WaveformTrace::Filter().matches("cpu.alu"));
+  const WaveformTrace::Filter filter({"*_reg", "cpu.alu"});
+  QVERIFY(filter.matches("cpu.ifid_reg"));
+  QVERIFY(filter.matches("cpu.alu"));
+  QVERIFY(!filter.matches("cpu.alu_op1_src"));
+  QVERIFY(!filter.matches("cpu.ifid_reg.enable_reg_in"));
+  QVERIFY(!filter.matches("cpu.decode"));
+}
+
+QTEST_APPLESS_MAIN(tst_waveformtrace)
+#include "tst_waveformtrace.moc"